@@ -2611,6 +2611,24 @@ var authCommandsLib = {
                 }
             ]
         },
+        {
+            testname: "warmUpCache",
+            command: {warmUpCache: 1, namespaces: [firstDbName + ".x"]},
+            skipSharded: true,
+            setup: function (db) { db.getSisterDB(firstDbName).x.save( {} ); },
+            teardown: function (db) { db.getSisterDB(firstDbName).x.drop(); },
+            testcases: [
+                {
+                    runOnDb: adminDbName,
+                    roles: roles_hostManager,
+                    privileges: [
+                        { resource: {cluster: true}, actions: ["touch"] }
+                    ]
+                },
+                { runOnDb: firstDbName, roles: {} },
+                { runOnDb: secondDbName, roles: {} }
+            ]
+        },
         {
             testname: "whatsmyuri",
             command: {whatsmyuri: 1},
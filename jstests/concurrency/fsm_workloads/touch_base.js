@@ -9,7 +9,7 @@
 
 load('jstests/concurrency/fsm_libs/extend_workload.js'); // for extendWorkload
 load('jstests/concurrency/fsm_workloads/indexed_insert_where.js'); // for $config
-load('jstests/concurrency/fsm_workload_helpers/server_types.js'); // for isMongod and isMMAPv1
+load('jstests/concurrency/fsm_workload_helpers/server_types.js'); // for isMongod, isMMAPv1 and isWiredTiger
 
 var $config = extendWorkload($config, function($config, $super) {
     $config.data.generateDocumentToInsert = function generateDocumentToInsert() {
@@ -22,10 +22,10 @@ var $config = extendWorkload($config, function($config, $super) {
 
     $config.states.touch = function touch(db, collName) {
         var res = db.runCommand(this.generateTouchCmdObj(collName));
-        if (isMongod(db) && isMMAPv1(db)) {
+        if (isMongod(db) && (isMMAPv1(db) || isWiredTiger(db))) {
             assertAlways.commandWorked(res);
         } else {
-            // SERVER-16850 and SERVER-16797
+            // SERVER-16797
             assertAlways.commandFailed(res);
         }
     };
@@ -0,0 +1,68 @@
+// explain: "executionStats" runs the aggregation and reports, for each stage, the documents it got
+// and returned and the time it took.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_agg_explain_execution_stats;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, a: i % 10, b: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    var pipeline = [{$match: {b: {$lt: 500}}}, {$project: {a: 1, c: {$add: ["$b", 1]}}},
+                    {$group: {_id: "$a", n: {$sum: 1}}}, {$sort: {n: -1}}, {$limit: 3}];
+    var explain = coll.aggregate(pipeline, {explain: "executionStats"});
+    var stages = explain.stages;
+    assert(stages, tojson(explain));
+
+    // Returns the executionStats of the stage named 'name'.
+    function statsOf(name) {
+        for (var i = 0; i < stages.length; i++) {
+            if (stages[i].hasOwnProperty(name)) {
+                assert(stages[i].executionStats, tojson(explain));
+                return stages[i].executionStats;
+            }
+        }
+        assert(false, "no " + name + " in " + tojson(explain));
+    }
+
+    // The $match is part of the query.
+    var cursorStats = statsOf("$cursor");
+    assert.eq(500, cursorStats.nReturned, tojson(explain));
+    assert(!cursorStats.hasOwnProperty("nInput"), tojson(explain));
+
+    var projectStats = statsOf("$project");
+    assert.eq(500, projectStats.nInput, tojson(explain));
+    assert.eq(500, projectStats.nReturned, tojson(explain));
+
+    var groupStats = statsOf("$group");
+    assert.eq(500, groupStats.nInput, tojson(explain));
+    assert.eq(10, groupStats.nReturned, tojson(explain));
+    assert.gt(groupStats.peakMemoryBytes, 0, tojson(explain));
+    assert.gte(groupStats.executionTimeMillisEstimate, 0, tojson(explain));
+
+    // The $limit is handed to the $sort.
+    var sortStats = statsOf("$sort");
+    assert.eq(10, sortStats.nInput, tojson(explain));
+    assert.eq(3, sortStats.nReturned, tojson(explain));
+
+    // The plain explain doesn't run the pipeline.
+    explain = coll.aggregate(pipeline, {explain: true});
+    explain.stages.forEach(function(stage) {
+        assert(!stage.hasOwnProperty("executionStats"), tojson(explain));
+    });
+    explain = coll.aggregate(pipeline, {explain: "queryPlanner"});
+    explain.stages.forEach(function(stage) {
+        assert(!stage.hasOwnProperty("executionStats"), tojson(explain));
+    });
+
+    // Unknown verbosities, and $out, are rejected.
+    assert.commandFailed(db.runCommand({aggregate: coll.getName(), pipeline: pipeline,
+                                        explain: "allPlansExecution"}));
+    assert.commandFailed(db.runCommand({aggregate: coll.getName(),
+                                        pipeline: [{$out: "jstests_agg_explain_stats_out"}],
+                                        explain: "executionStats"}));
+})();
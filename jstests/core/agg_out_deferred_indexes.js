@@ -0,0 +1,73 @@
+// $out loads its output into a temporary collection without indexes and only then builds the
+// indexes of the output collection, so the results and index specs must be the same as before, and
+// duplicate _ids must still fail the aggregation.
+(function() {
+    'use strict';
+
+    var input = db.jstests_agg_out_deferred_indexes_in;
+    var output = db.jstests_agg_out_deferred_indexes_out;
+    input.drop();
+    output.drop();
+
+    var bulk = input.initializeUnorderedBulkOp();
+    for (var i = 0; i < 5000; i++) {
+        bulk.insert({_id: i, a: i % 100, s: "str" + i, loc: [i % 90, i % 45]});
+    }
+    assert.writeOK(bulk.execute());
+
+    function sortedIndexes() {
+        return output.getIndexes().sort(function(a, b) {
+            return a.name < b.name ? -1 : 1;
+        });
+    }
+
+    function tmpCollections() {
+        return db.getCollectionNames().filter(function(name) {
+            return name.indexOf("tmp.agg_out") == 0;
+        });
+    }
+
+    // A new output collection gets an _id index.
+    input.aggregate([{$out: output.getName()}]);
+    assert.eq(5000, output.count());
+    assert.eq([{_id: 1}], sortedIndexes().map(function(index) { return index.key; }));
+
+    // Secondary indexes of an existing output collection, including a unique, a sparse, a
+    // geo and a background one, are rebuilt with the same specs.
+    assert.commandWorked(output.ensureIndex({s: 1}, {unique: true}));
+    assert.commandWorked(output.ensureIndex({a: 1}, {sparse: true}));
+    assert.commandWorked(output.ensureIndex({loc: "2d"}));
+    assert.commandWorked(output.ensureIndex({a: -1, s: 1}, {background: true}));
+    var indexes = sortedIndexes();
+
+    input.aggregate([{$match: {a: {$lt: 50}}}, {$project: {a: 1, s: 1, loc: 1}},
+                     {$out: output.getName()}]);
+    assert.eq(2500, output.count());
+    assert.eq(indexes, sortedIndexes());
+    assert.eq(25, output.find({a: 7}).hint({a: 1}).itcount());
+    assert.eq(1, output.find({s: "str42"}).hint({s: 1}).itcount());
+
+    // Documents without an _id get one.
+    input.aggregate([{$project: {_id: 0, a: 1, s: 1}}, {$out: output.getName()}]);
+    assert.eq(5000, output.find({_id: {$type: 7}}).itcount());
+
+    // A unique index violated by the output fails the aggregation, leaving the output collection
+    // and no temporary collection behind.
+    assert.throws(function() {
+        input.aggregate([{$project: {a: 1, s: {$literal: "same"}}}, {$out: output.getName()}]);
+    });
+    assert.eq(5000, output.count());
+    assert.eq(indexes, sortedIndexes());
+
+    // So do duplicate _ids.
+    output.drop();
+    assert.throws(function() {
+        input.aggregate([{$project: {_id: "$a"}}, {$out: output.getName()}]);
+    });
+    assert.eq([], tmpCollections());
+
+    // Output that is empty still gets the indexes.
+    input.aggregate([{$match: {a: -1}}, {$out: output.getName()}]);
+    assert.eq(0, output.count());
+    assert.eq(1, output.getIndexes().length);
+})();
@@ -0,0 +1,65 @@
+// $push in $group takes the $sort and $slice modifiers of the update $push, to keep only the top
+// values of each group instead of all of them.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_agg_push_sort_slice;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, g: i % 10, score: (i * 37) % 1000, s: "str" + i});
+    }
+    assert.writeOK(bulk.execute());
+
+    // The top 3 scores of each group, computed with a query per group.
+    function expected(fields) {
+        var results = [];
+        for (var g = 0; g < 10; g++) {
+            results.push({_id: g, top: coll.find({g: g}, fields).sort({score: -1}).limit(3)
+                                                               .toArray()});
+        }
+        return results;
+    }
+
+    var results = coll.aggregate([
+        {$group: {_id: "$g", top: {$push: "$$ROOT", $sort: {score: -1}, $slice: 3}}},
+        {$sort: {_id: 1}}]).toArray();
+    assert.eq(expected({}), results);
+
+    results = coll.aggregate([
+        {$group: {_id: "$g", top: {$push: {_id: "$_id", score: "$score"},
+                                   $sort: {score: -1}, $slice: 3}}},
+        {$sort: {_id: 1}}], {allowDiskUse: true}).toArray();
+    assert.eq(expected({score: 1}), results);
+
+    // Sorting the values themselves, and $slice without $sort.
+    results = coll.aggregate([{$match: {g: 0}},
+                              {$group: {_id: null, low: {$push: "$score", $sort: 1, $slice: 2},
+                                        all: {$push: "$score", $sort: -1},
+                                        first: {$push: "$_id", $slice: 1}}}]).toArray();
+    assert.eq(1, results.length);
+    assert.eq([0, 10], results[0].low);
+    assert.eq(100, results[0].all.length);
+    assert.eq(990, results[0].all[0]);
+    assert.eq(1, results[0].first.length);
+
+    // The modifiers are kept by explain.
+    var explain = coll.aggregate([{$group: {_id: "$g", top: {$push: "$s", $sort: -1, $slice: 3}}}],
+                                 {explain: true});
+    var group = explain.stages[1].$group;
+    assert.eq(-1, group.top.$sort, tojson(explain));
+    assert.eq(3, group.top.$slice, tojson(explain));
+
+    // Bad modifiers.
+    function assertFails(accumulator) {
+        assert.commandFailed(db.runCommand({aggregate: coll.getName(),
+                                            pipeline: [{$group: {_id: "$g", x: accumulator}}]}));
+    }
+    assertFails({$push: "$s", $slice: 0});
+    assertFails({$push: "$s", $slice: "a"});
+    assertFails({$push: "$s", $sort: {score: 2}});
+    assertFails({$push: "$s", $sort: {}});
+    assertFails({$sum: "$s", $sort: 1});
+    assertFails({$sort: 1});
+})();
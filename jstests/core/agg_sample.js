@@ -0,0 +1,70 @@
+// $sample returns the given number of distinct documents picked at random. An initial $sample of
+// a small part of a collection reads random records where the storage engine can pick them, and
+// any other $sample keeps a reservoir sample of its input.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_agg_sample;
+    coll.drop();
+
+    function sample(pipeline) {
+        return coll.aggregate(pipeline).toArray();
+    }
+
+    function runPipeline(pipeline) {
+        return db.runCommand({aggregate: coll.getName(), pipeline: pipeline});
+    }
+
+    // Checks that 'docs' are 'n' distinct documents of the collection, all matching 'query'.
+    function checkSample(docs, n, query) {
+        assert.eq(n, docs.length, tojson(docs));
+        var ids = {};
+        docs.forEach(function(doc) {
+            assert(!ids.hasOwnProperty(doc._id), tojson(docs));
+            ids[doc._id] = true;
+            assert.eq(coll.findOne(Object.extend({_id: doc._id}, query || {})), doc);
+        });
+    }
+
+    assert.eq([], sample([{$sample: {size: 10}}]));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, x: i % 10});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Read from random records if possible.
+    var explain = coll.aggregate([{$sample: {size: 10}}], {explain: true});
+    var stageName = Object.keys(explain.stages[1])[0];
+    assert(stageName == "$sampleFromRandomCursor" || stageName == "$sample", tojson(explain));
+    checkSample(sample([{$sample: {size: 10}}]), 10);
+
+    // Samples of most of the collection, or of more than all of it.
+    explain = coll.aggregate([{$sample: {size: 500}}], {explain: true});
+    assert.eq(500, explain.stages[1].$sample.size, tojson(explain));
+    checkSample(sample([{$sample: {size: 500}}]), 500);
+    checkSample(sample([{$sample: {size: 2000}}]), 1000);
+    assert.eq([], sample([{$sample: {size: 0}}]));
+
+    // Reservoir samples after other stages.
+    checkSample(sample([{$match: {x: 3}}, {$sample: {size: 10}}]), 10, {x: 3});
+    checkSample(sample([{$match: {x: 3}}, {$sample: {size: 1000}}]), 100, {x: 3});
+    var projected = sample([{$sample: {size: 20}}, {$project: {x: 1}}, {$sample: {size: 5}}]);
+    assert.eq(5, projected.length, tojson(projected));
+
+    // Repeated samples don't all pick the same documents.
+    var seen = {};
+    for (i = 0; i < 10; i++) {
+        sample([{$sample: {size: 10}}]).forEach(function(doc) {
+            seen[doc._id] = true;
+        });
+    }
+    assert.gt(Object.keys(seen).length, 10, tojson(seen));
+
+    assert.commandFailedWithCode(runPipeline([{$sample: 10}]), 28789);
+    assert.commandFailedWithCode(runPipeline([{$sample: {size: -1}}]), 28790);
+    assert.commandFailedWithCode(runPipeline([{$sample: {size: "10"}}]), 28790);
+    assert.commandFailedWithCode(runPipeline([{$sample: {size: 10, other: 1}}]), 28791);
+    assert.commandFailedWithCode(runPipeline([{$sample: {}}]), 28792);
+})();
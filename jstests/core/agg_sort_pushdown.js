@@ -0,0 +1,63 @@
+// A $sort with a small $limit runs as a top-k sort in the query even without an index for it, and
+// a $sort right after a $project that only includes and renames fields is handed to the query too.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_agg_sort_pushdown;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        bulk.insert({_id: i, a: (i * 7) % 500, b: {c: i % 10}, d: i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+
+    // Returns the $cursor stage of the explain of 'pipeline', after checking that the $sort was
+    // pushed down into it.
+    function checkPushedDown(pipeline, sort) {
+        var explain = coll.aggregate(pipeline, {explain: true});
+        var stages = explain.stages;
+        assert(stages, tojson(explain));
+        assert.eq(sort, stages[0].$cursor.sort, tojson(explain));
+        stages.forEach(function(stage) {
+            assert(!stage.hasOwnProperty("$sort"), tojson(explain));
+        });
+        return stages[0].$cursor;
+    }
+
+    // No index on d: the limit allows a top-k sort in the query.
+    var pipeline = [{$sort: {d: -1}}, {$limit: 5}];
+    var cursorStage = checkPushedDown(pipeline, {d: -1});
+    assert.eq(5, cursorStage.limit);
+    assert.eq([499, 498, 497, 496, 495], coll.aggregate(pipeline).toArray().map(function(doc) {
+        return doc.d;
+    }));
+
+    // Without a limit, a sort no index provides stays in the pipeline.
+    var explain = coll.aggregate([{$sort: {d: -1}}], {explain: true});
+    assert(!explain.stages[0].$cursor.sort, tojson(explain));
+    assert.eq({d: -1}, explain.stages[1].$sort.sortKey, tojson(explain));
+
+    // Renamed fields are sorted on by their names before the $project.
+    pipeline = [{$project: {x: "$a", y: "$b", d: 1}}, {$sort: {x: 1}}];
+    checkPushedDown(pipeline, {a: 1});
+    var results = coll.aggregate(pipeline).toArray();
+    assert.eq(500, results.length);
+    for (var i = 0; i < results.length; i++) {
+        assert.eq(i, results[i].x);
+        assert.eq({_id: results[i]._id, x: results[i].x, y: results[i].y, d: results[i].d},
+                  results[i]);
+    }
+
+    pipeline = [{$match: {d: {$lt: 100}}}, {$project: {_id: 0, x: "$a", y: "$b"}},
+                {$sort: {"y.c": 1, x: -1}}, {$limit: 3}];
+    checkPushedDown(pipeline, {"b.c": 1, a: -1});
+    assert.eq([{x: 490, y: {c: 0}}, {x: 420, y: {c: 0}}, {x: 350, y: {c: 0}}],
+              coll.aggregate(pipeline).toArray());
+
+    // A $project that computes a sorted field keeps the $sort in the pipeline.
+    explain = coll.aggregate([{$project: {x: {$add: ["$a", 1]}}}, {$sort: {x: 1}}],
+                             {explain: true});
+    assert(!explain.stages[0].$cursor.sort, tojson(explain));
+})();
@@ -0,0 +1,70 @@
+// A $group whose input is sorted on its _id by an index which isn't multikey returns each group
+// as soon as the next one starts, rather than after grouping all of its input.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_agg_sorted_group;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, user: i % 7, v: i});
+    }
+    bulk.insert({_id: 1000, v: 1000});
+    bulk.insert({_id: 1001, user: null, v: 1001});
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({user: 1}));
+
+    var pipeline = [{$sort: {user: 1}},
+                    {$match: {v: {$gte: 0}}},
+                    {$group: {_id: "$user", n: {$sum: 1}, total: {$sum: "$v"}}}];
+
+    function groupStage(explain) {
+        for (var i = 0; i < explain.stages.length; i++) {
+            if (explain.stages[i].$group) {
+                return explain.stages[i].$group;
+            }
+        }
+        assert(false, tojson(explain));
+    }
+
+    function check(streaming) {
+        var explain = coll.aggregate(pipeline, {explain: true});
+        var group = groupStage(explain);
+        if (streaming) {
+            assert.eq(true, group.$streaming, tojson(explain));
+        }
+        else {
+            assert(!group.hasOwnProperty("$streaming"), tojson(explain));
+        }
+
+        var expected = {};
+        coll.find().forEach(function(doc) {
+            var id = doc.hasOwnProperty("user") ? tojson(doc.user) : tojson(null);
+            expected[id] = expected[id] || {n: 0, total: 0};
+            expected[id].n++;
+            expected[id].total += doc.v;
+        });
+
+        var results = coll.aggregate(pipeline).toArray();
+        assert.eq(Object.keys(expected).length, results.length, tojson(results));
+        results.forEach(function(result) {
+            var id = tojson(result._id);
+            assert.eq(expected[id].n, result.n, tojson(result));
+            assert.eq(expected[id].total, result.total, tojson(result));
+        });
+    }
+
+    // missing and null values of user are one group
+    check(true);
+
+    // only a $group on the leading field of the sort streams
+    pipeline[2].$group._id = {u: "$user", v: "$v"};
+    var explain = coll.aggregate(pipeline, {explain: true});
+    assert(!groupStage(explain).hasOwnProperty("$streaming"), tojson(explain));
+    pipeline[2].$group._id = "$user";
+
+    // an array sorts by its least element, splitting up the groups
+    assert.writeOK(coll.insert({_id: 1002, user: [5, 1], v: 1002}));
+    check(false);
+})();
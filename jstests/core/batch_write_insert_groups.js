@@ -0,0 +1,58 @@
+//
+// Inserts of a batch are grouped into a single write unit of work. Check that a failing document
+// in the middle of a group is still reported at its own index, and that ordered batches stop
+// right there while unordered ones insert everything else.
+//
+
+var coll = db.getCollection("batch_write_insert_groups");
+
+function makeDocs(n, dupIndex) {
+    var docs = [];
+    for (var i = 0; i < n; i++) {
+        docs.push({_id: (i == dupIndex ? 0 : i), x: i});
+    }
+    return docs;
+}
+
+// No errors
+coll.drop();
+var result = coll.runCommand({insert: coll.getName(), documents: makeDocs(200, -1)});
+assert.commandWorked(result);
+assert.eq(200, result.n);
+assert.eq(200, coll.count());
+
+// Unordered, duplicate _id at index 37
+coll.drop();
+result = coll.runCommand({insert: coll.getName(), documents: makeDocs(200, 37), ordered: false});
+assert.commandWorked(result);
+assert.eq(199, result.n);
+assert.eq(1, result.writeErrors.length, tojson(result));
+assert.eq(37, result.writeErrors[0].index);
+assert.eq(199, coll.count());
+assert.eq(null, coll.findOne({x: 37}));
+assert.neq(null, coll.findOne({x: 38}));
+
+// Ordered, duplicate _id at index 37
+coll.drop();
+result = coll.runCommand({insert: coll.getName(), documents: makeDocs(200, 37), ordered: true});
+assert.commandWorked(result);
+assert.eq(37, result.n);
+assert.eq(1, result.writeErrors.length, tojson(result));
+assert.eq(37, result.writeErrors[0].index);
+assert.eq(37, coll.count());
+assert.eq(null, coll.findOne({x: 38}));
+
+// Duplicates on a secondary unique index are found within a group and against existing keys
+coll.drop();
+assert.commandWorked(coll.ensureIndex({x: 1}, {unique: true}));
+assert.writeOK(coll.insert({_id: -1, x: 150}));
+var docs = makeDocs(200, -1);
+docs[60].x = 59;
+result = coll.runCommand({insert: coll.getName(), documents: docs, ordered: false});
+assert.commandWorked(result);
+assert.eq(198, result.n);
+assert.eq(2, result.writeErrors.length, tojson(result));
+assert.eq(60, result.writeErrors[0].index);
+assert.eq(150, result.writeErrors[1].index);
+assert.eq(199, coll.count());
+assert.eq(1, coll.find({x: 59}).itcount());
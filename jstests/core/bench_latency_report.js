@@ -0,0 +1,54 @@
+// benchRun reports latency percentiles per op type, the operations done in each interval, and can
+// write its result to a JSON file.
+
+var t = db.bench_latency_report;
+t.drop();
+assert.writeOK(t.insert({_id: 1, x: 1}));
+
+var reportFile = MongoRunner.dataPath + "bench_latency_report.json";
+var benchArgs = {
+    ops: [{op: "findOne", ns: t.getFullName(), query: {_id: 1}},
+          {op: "update", ns: t.getFullName(), query: {_id: 1}, update: {$inc: {x: 1}}}],
+    parallel: 2,
+    seconds: 2,
+    throughputIntervalSeconds: 0.5,
+    reportFile: reportFile,
+    host: db.getMongo().host
+};
+if (jsTest.options().auth) {
+    benchArgs['db'] = 'admin';
+    benchArgs['username'] = jsTest.options().adminUser;
+    benchArgs['password'] = jsTest.options().adminPassword;
+}
+var res = benchRun(benchArgs);
+
+["findOne", "update"].forEach(function(op) {
+    var latencies = res.latencies[op];
+    assert(latencies, tojson(res));
+    assert.gt(latencies.count, 0, tojson(latencies));
+    assert.lte(latencies.p50Micros, latencies.p95Micros, tojson(latencies));
+    assert.lte(latencies.p95Micros, latencies.p99Micros, tojson(latencies));
+    assert.lte(latencies.p99Micros, latencies.p999Micros, tojson(latencies));
+    // percentiles are bucket bounds, up to a quarter above the latencies in the bucket
+    assert.gte(latencies.maxMicros * 1.25 + 1, latencies.p999Micros, tojson(latencies));
+});
+assert.eq(undefined, res.latencies.insert);
+
+// Every operation falls in one of the intervals
+assert.eq(0.5, res.throughput.intervalSeconds);
+assert.gte(res.throughput.ops.length, 3, tojson(res.throughput));
+var total = res.throughput.ops.reduce(function(a, b) { return a + b; }, 0);
+assert.eq(res.latencies.findOne.count + res.latencies.update.count, total, tojson(res));
+
+// The report is extended JSON, which has 64 bit integers as {$numberLong: "..."}
+var report = JSON.parse(cat(reportFile));
+assert.eq(res.latencies.update.count, Number(report.latencies.update.count.$numberLong),
+          tojson(report));
+assert.eq(res.throughput.ops.length, report.throughput.ops.length, tojson(report));
+
+// The series can be left out
+benchArgs.throughputIntervalSeconds = 0;
+benchArgs.seconds = 0.5;
+delete benchArgs.reportFile;
+res = benchRun(benchArgs);
+assert.eq(undefined, res.throughput, tojson(res));
@@ -0,0 +1,36 @@
+// benchRun with opsPerSecond sends operations on a schedule rather than as fast as it can, so it
+// does about the requested number of them whatever the server's latency.
+
+var t = db.bench_open_loop;
+t.drop();
+assert.writeOK(t.insert({_id: 1}));
+
+var benchArgs = {
+    ops: [{op: "findOne", ns: t.getFullName(), query: {_id: 1}}],
+    parallel: 2,
+    seconds: 2,
+    opsPerSecond: 100,
+    host: db.getMongo().host
+};
+if (jsTest.options().auth) {
+    benchArgs['db'] = 'admin';
+    benchArgs['username'] = jsTest.options().adminUser;
+    benchArgs['password'] = jsTest.options().adminPassword;
+}
+
+["constant", "poisson"].forEach(function(arrivals) {
+    benchArgs.arrivals = arrivals;
+    var res = benchRun(benchArgs);
+    var count = res.latencies.findOne.count;
+    // the rate is shared by the workers; allow for slow starts and random gaps
+    assert.gte(count, 100, tojson(res));
+    assert.lte(count, 300, tojson(res));
+});
+
+delete benchArgs.arrivals;
+benchArgs.opsPerSecond = -1;
+assert.throws(function() { benchRun(benchArgs); });
+
+benchArgs.opsPerSecond = 100;
+benchArgs.arrivals = "bursty";
+assert.throws(function() { benchRun(benchArgs); });
@@ -0,0 +1,66 @@
+// A clustered collection keys its documents by their _id, which must be a positive integer, and
+// has no _id index. Lookups by _id go straight to the record store.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_clustered_collection;
+    coll.drop();
+
+    var res = db.createCollection(coll.getName(), {clustered: true});
+    if (!res.ok) {
+        // this storage engine can't insert records with a given RecordId
+        assert.commandFailedWithCode(res, 28795);
+        return;
+    }
+
+    var options = db.getCollectionInfos({name: coll.getName()})[0].options;
+    assert.eq(true, options.clustered, tojson(options));
+    assert.eq([], coll.getIndexes());
+
+    for (var i = 1; i <= 100; i++) {
+        assert.writeOK(coll.insert({_id: i, x: i % 10}));
+    }
+    assert.eq(100, coll.count());
+
+    // _id is unique, and must be a positive integer
+    assert.eq(11000, coll.insert({_id: 5}).getWriteError().code);
+    assert.eq(11000, coll.insert({_id: 5.0}).getWriteError().code);
+    assert.writeError(coll.insert({_id: 0}));
+    assert.writeError(coll.insert({_id: -1}));
+    assert.writeError(coll.insert({_id: 1.5}));
+    assert.writeError(coll.insert({_id: "a"}));
+    assert.writeError(coll.insert({x: 1}));
+    assert.writeOK(coll.insert({_id: NumberLong("1099511627776")}));
+    assert.eq(101, coll.count());
+
+    // find, update and remove by _id
+    var explain = coll.find({_id: 7}).explain();
+    assert.eq("IDHACK", explain.queryPlanner.winningPlan.stage, tojson(explain));
+    assert.eq({_id: 7, x: 7}, coll.findOne({_id: 7}));
+    assert.eq({_id: 7, x: 7}, coll.findOne({_id: NumberLong(7)}));
+    assert.eq({_id: 7, x: 7}, coll.findOne({_id: 7.0}));
+    assert.eq(null, coll.findOne({_id: 1000}));
+    assert.eq(null, coll.findOne({_id: "7"}));
+
+    assert.writeOK(coll.update({_id: 7}, {$set: {y: 1}}));
+    assert.eq({_id: 7, x: 7, y: 1}, coll.findOne({_id: 7}));
+    assert.writeOK(coll.update({_id: 1000}, {$set: {y: 1}}, {upsert: true}));
+    assert.eq({_id: 1000, y: 1}, coll.findOne({_id: 1000}));
+    assert.writeError(coll.update({_id: 8}, {$set: {_id: 9}}));
+
+    assert.writeOK(coll.remove({_id: 7}));
+    assert.eq(null, coll.findOne({_id: 7}));
+    assert.writeOK(coll.insert({_id: 7}));
+
+    // other queries scan the collection
+    assert.eq(10, coll.find({_id: {$gt: 10, $lte: 20}}).itcount());
+    assert.eq(10, coll.find({x: 3}).itcount());
+    assert.commandWorked(coll.ensureIndex({x: 1}));
+    assert.eq(10, coll.find({x: 3}).itcount());
+    assert.eq(1, coll.find({_id: 13, x: 3}).itcount());
+
+    coll.drop();
+    assert.commandFailed(db.createCollection(coll.getName(),
+                                             {clustered: true, capped: true, size: 4096}));
+    assert.commandFailed(db.createCollection(coll.getName(), {clustered: true, autoIndexId: true}));
+})();
@@ -0,0 +1,41 @@
+// Test that counts with multi-interval bounds, or with a key-only filter, use a COUNT_SCAN
+// rather than fetching the documents, and count correctly.
+load("jstests/libs/analyze_plan.js");
+
+(function() {
+    "use strict";
+    var t = db.jstests_count_scan_bounds;
+    t.drop();
+
+    for (var i = 0; i < 10; i++) {
+        for (var j = 0; j < 10; j++) {
+            assert.writeOK(t.insert({a: i, b: j}));
+        }
+    }
+    assert.commandWorked(t.ensureIndex({a: 1, b: 1}));
+
+    function assertCountScan(query, hint, expected) {
+        var explain = t.explain("executionStats").find(query).hint(hint).count();
+        assert.commandWorked(explain);
+        assert(planHasStage(explain.queryPlanner.winningPlan, "COUNT_SCAN"), tojson(explain));
+        assert(!planHasStage(explain.queryPlanner.winningPlan, "FETCH"), tojson(explain));
+        assert.eq(expected, t.find(query).hint(hint).count());
+    }
+
+    // $in on the leading field.
+    assertCountScan({a: {$in: [2, 5, 7]}}, {a: 1, b: 1}, 30);
+    assertCountScan({a: {$in: [2, 5]}, b: 3}, {a: 1, b: 1}, 2);
+
+    // Equality on a non-leading field only.
+    assertCountScan({b: 4}, {a: 1, b: 1}, 10);
+
+    // Range on both fields.
+    assertCountScan({a: {$gte: 3, $lt: 6}, b: {$gt: 7}}, {a: 1, b: 1}, 6);
+
+    // A predicate which can't be expressed as bounds is applied to the keys.
+    assertCountScan({a: 1, b: {$mod: [3, 0]}}, {a: 1, b: 1}, 4);
+
+    // With a multikey index, a document is counted once even if several of its keys match.
+    assert.writeOK(t.insert({a: [20, 21], b: 0}));
+    assertCountScan({a: {$in: [20, 21]}}, {a: 1, b: 1}, 1);
+})();
@@ -0,0 +1,41 @@
+// currentOp filters on the running time, op, ns and the client's identity are matched before the
+// full report of an operation is built. Check that they return the same reports as other filters.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_currentop_summary_filter;
+    coll.drop();
+    assert.writeOK(coll.insert({a: 1}));
+
+    var awaitShell = startParallelShell(
+        "db.jstests_currentop_summary_filter.find({$where: function() { sleep(100000); }})" +
+        ".itcount();");
+
+    var ns = coll.getFullName();
+    var op;
+    assert.soon(function() {
+        var inprog = db.currentOp({ns: ns,
+                                   op: {$in: ["query", "command"]},
+                                   secs_running: {$gte: 0}}).inprog;
+        if (inprog.length != 1) {
+            return false;
+        }
+        op = inprog[0];
+        return true;
+    });
+
+    // The report is complete, not just the fields filtered on
+    assert(op.hasOwnProperty("query"), tojson(op));
+    assert(op.hasOwnProperty("locks"), tojson(op));
+    assert(op.hasOwnProperty("threadId"), tojson(op));
+    assert.eq(true, op.active, tojson(op));
+
+    assert.eq(1, db.currentOp({opid: op.opid}).inprog.length);
+    assert.eq(1, db.currentOp({ns: ns, query: {$exists: true}}).inprog.length);
+    assert.eq(1, db.currentOp({$or: [{ns: ns}, {ns: "test.none"}]}).inprog.length);
+    assert.eq(0, db.currentOp({ns: "test.none"}).inprog.length);
+    assert.eq(0, db.currentOp({ns: ns, op: "insert"}).inprog.length);
+
+    assert.commandWorked(db.killOp(op.opid));
+    awaitShell();
+})();
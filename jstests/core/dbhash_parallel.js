@@ -0,0 +1,81 @@
+// dbHash can hash collections on several threads, with the cheaper murmur3 hash, and by _id
+// range, and validate can check the indexes on several threads.
+
+var mydb = db.getSiblingDB("dbhash_parallel");
+mydb.dropDatabase();
+
+for (var c = 0; c < 5; c++) {
+    var bulk = mydb["c" + c].initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        bulk.insert({_id: i, c: c, s: "str" + (i % 13)});
+    }
+    assert.writeOK(bulk.execute());
+}
+
+function dbHash(options) {
+    var cmd = {dbHash: 1};
+    Object.extend(cmd, options || {});
+    return assert.commandWorked(mydb.runCommand(cmd));
+}
+
+// The same hashes whatever the number of threads
+var serial = dbHash();
+var parallel = dbHash({parallelism: 4});
+assert.eq(serial.collections, parallel.collections);
+assert.eq(serial.md5, parallel.md5);
+
+// murmur3 hashes of equal collections are equal
+var murmur = dbHash({hash: "murmur3", parallelism: 4});
+assert.eq(32, murmur.collections.c0.length, tojson(murmur));
+assert.neq(serial.collections.c0, murmur.collections.c0);
+assert.neq(murmur.collections.c0, murmur.collections.c1);
+assert.eq(murmur.collections, dbHash({hash: "murmur3"}).collections);
+assert.writeOK(mydb.c4.remove({}));
+mydb.c1.find().sort({_id: 1}).forEach(function(doc) { assert.writeOK(mydb.c4.insert(doc)); });
+assert.eq(dbHash({hash: "murmur3"}).collections.c1, dbHash({hash: "murmur3"}).collections.c4);
+
+// Hashing a range gives the hash of a collection holding only the documents in the range
+assert.writeOK(mydb.c4.remove({$or: [{_id: {$lt: 100}}, {_id: {$gte: 200}}]}));
+var range = dbHash({collections: ["c1"], min: {_id: 100}, max: {_id: 200}});
+assert.eq(dbHash({collections: ["c4"]}).collections.c4, range.collections.c1);
+assert.eq(100, range.ranges.c1.nDocs, tojson(range));
+assert.eq(undefined, range.ranges.c1.next, tojson(range));
+
+// A range hash with maxDocs says where to go on from, so hashing can be resumed
+var min = undefined;
+var total = 0;
+var chunks = 0;
+do {
+    var options = {collections: ["c0"], maxDocs: 150, hash: "murmur3"};
+    if (min) {
+        options.min = min;
+    }
+    var res = dbHash(options);
+    total += res.ranges.c0.nDocs;
+    chunks++;
+    min = res.ranges.c0.next;
+} while (min);
+assert.eq(500, total);
+assert.eq(4, chunks);
+
+assert.commandFailed(mydb.runCommand({dbHash: 1, hash: "crc"}));
+assert.commandFailed(mydb.runCommand({dbHash: 1, parallelism: 0}));
+assert.commandFailed(mydb.runCommand({dbHash: 1, parallelism: 1000}));
+assert.commandFailed(mydb.runCommand({dbHash: 1, maxDocs: 0}));
+assert.commandFailed(mydb.runCommand({dbHash: 1, min: 5}));
+assert.commandFailed(mydb.runCommand({dbHash: 1, max: {x: 5}}));
+
+// validate checks the indexes on other threads, with the same results
+assert.commandWorked(mydb.c0.ensureIndex({c: 1}));
+assert.commandWorked(mydb.c0.ensureIndex({s: 1, c: 1}));
+[false, true].forEach(function(full) {
+    var one = assert.commandWorked(mydb.runCommand({validate: "c0", full: full}));
+    var four = assert.commandWorked(mydb.runCommand({validate: "c0", full: full,
+                                                     parallelism: 4}));
+    assert(four.valid, tojson(four));
+    assert.eq(one.nIndexes, four.nIndexes);
+    assert.eq(one.keysPerIndex, four.keysPerIndex);
+});
+assert.commandFailed(mydb.runCommand({validate: "c0", parallelism: 0}));
+
+mydb.dropDatabase();
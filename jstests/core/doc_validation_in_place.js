@@ -0,0 +1,53 @@
+// Updates of collections with a validator can be applied in place when they leave every field the
+// validator looks at alone, in which case the old document is validated instead of the new one.
+// Check that such updates are accepted and rejected exactly as the others are.
+(function() {
+    "use strict";
+
+    function assertFailsValidation(res) {
+        var DocumentValidationFailure = 121;
+        assert.writeError(res);
+        assert.eq(res.getWriteError().code, DocumentValidationFailure);
+    }
+
+    var collName = "doc_validation_in_place";
+    var coll = db[collName];
+    coll.drop();
+
+    assert.writeOK(coll.insert({_id: 'valid', a: 5, b: {c: "x"}, n: 0}));
+    assert.writeOK(coll.insert({_id: 'invalid', a: 50, b: {c: "x"}, n: 0}));
+    assert.commandWorked(db.runCommand({
+        collMod: collName,
+        validator: {$or: [{a: {$lt: 10}}, {"b.c": "y"}], n: {$type: 16}}
+    }));
+
+    // Fields the validator doesn't look at
+    assert.writeOK(coll.update({_id: 'valid'}, {$inc: {m: 1}}));
+    assert.writeOK(coll.update({_id: 'valid'}, {$set: {"b.d": 1}}));
+    assertFailsValidation(coll.update({_id: 'invalid'}, {$inc: {m: 1}}));
+    assertFailsValidation(coll.update({_id: 'invalid'}, {$set: {"b.d": 1}}));
+
+    // Fields the validator looks at, directly or through a parent
+    assert.writeOK(coll.update({_id: 'valid'}, {$inc: {n: NumberInt(1)}}));
+    assertFailsValidation(coll.update({_id: 'valid'}, {$inc: {a: 10}}));
+    assertFailsValidation(coll.update({_id: 'valid'}, {$set: {n: "one"}}));
+    assert.writeOK(coll.update({_id: 'invalid'}, {$set: {b: {c: "y"}}}));
+    assert.writeOK(coll.update({_id: 'invalid'}, {$inc: {m: 1}}));
+    assertFailsValidation(coll.update({_id: 'invalid'}, {$set: {"b.c": "z"}}));
+
+    assert.eq({_id: 'valid', a: 5, b: {c: "x", d: 1}, n: 1, m: 1}, coll.findOne({_id: 'valid'}));
+    assert.eq({_id: 'invalid', a: 50, b: {c: "y"}, n: 0, m: 1}, coll.findOne({_id: 'invalid'}));
+
+    // Parts of the validator not about any one field depend on every field
+    assert.commandWorked(db.runCommand({collMod: collName,
+                                        validator: {$where: "this.m < 2"}}));
+    assertFailsValidation(coll.update({_id: 'valid'}, {$inc: {m: 1}}));
+    assert.writeOK(coll.update({_id: 'valid'}, {$inc: {m: -1}}));
+
+    // Bypassing validation still works for updates in place
+    assert.commandWorked(db.runCommand({collMod: collName, validator: {a: {$lt: 10}}}));
+    assert.commandWorked(db.runCommand({update: collName,
+                                        updates: [{q: {_id: 'invalid'}, u: {$inc: {m: 1}}}],
+                                        bypassDocumentValidation: true}));
+    assert.eq(2, coll.findOne({_id: 'invalid'}).m);
+})();
@@ -0,0 +1,65 @@
+// COLLSCAN and FETCH read documents in place from storage engine memory, and only copy those
+// they pass on when that memory doesn't outlive the next read. Explain reports the documents
+// which were never copied as copiesAvoided.
+
+var t = db.explain_copies_avoided;
+t.drop();
+
+for (var i = 0; i < 100; i++) {
+    t.insert({_id: i, a: i, b: i % 2});
+}
+t.ensureIndex({a: 1});
+
+/**
+ * Returns the first stage named 'name' in the tree rooted at 'stage', or null.
+ */
+function findStage(stage, name) {
+    if (stage.stage == name) {
+        return stage;
+    }
+    var children = stage.inputStages || (stage.inputStage ? [stage.inputStage] : []);
+    if (stage.shards) {
+        children = stage.shards.map(function(shard) { return shard.executionStages; });
+    }
+    for (var i = 0; i < children.length; i++) {
+        var found = findStage(children[i], name);
+        if (found) {
+            return found;
+        }
+    }
+    return null;
+}
+
+var engine = db.serverStatus().storageEngine.name;
+
+var explain = t.find({a: {$gte: 90}}).hint({$natural: 1}).explain("executionStats");
+var collScan = findStage(explain.executionStats.executionStages, "COLLSCAN");
+assert(collScan, tojson(explain));
+assert.eq(100, collScan.docsExamined, tojson(collScan));
+assert.lte(collScan.copiesAvoided, collScan.docsExamined, tojson(collScan));
+if (engine == "wiredTiger") {
+    // Only the documents which were returned are copied.
+    assert.eq(90, collScan.copiesAvoided, tojson(collScan));
+}
+else if (engine == "mmapv1") {
+    assert.eq(100, collScan.copiesAvoided, tojson(collScan));
+}
+
+explain = t.find({a: {$gte: 80}, b: 0}).hint({a: 1}).explain("executionStats");
+var fetch = findStage(explain.executionStats.executionStages, "FETCH");
+assert(fetch, tojson(explain));
+assert.eq(20, fetch.docsExamined, tojson(fetch));
+assert.lte(fetch.copiesAvoided, fetch.docsExamined, tojson(fetch));
+if (engine == "wiredTiger") {
+    assert.eq(10, fetch.copiesAvoided, tojson(fetch));
+}
+else if (engine == "mmapv1") {
+    assert.eq(20, fetch.copiesAvoided, tojson(fetch));
+}
+
+// The documents which are returned are intact.
+assert.eq(10, t.find({a: {$gte: 90}}).hint({$natural: 1}).toArray().length);
+t.find({a: {$gte: 80}, b: 0}).hint({a: 1}).forEach(function(doc) {
+    assert.eq(0, doc.b, tojson(doc));
+    assert.gte(doc.a, 80, tojson(doc));
+});
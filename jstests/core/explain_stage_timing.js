@@ -0,0 +1,66 @@
+// Test that explain reports inclusive and exclusive execution time and working set allocations
+// for every stage.
+
+var t = db.explain_stage_timing;
+t.drop();
+
+for (var i = 0; i < 100; i++) {
+    t.insert({_id: i, a: i});
+}
+t.ensureIndex({a: 1});
+
+/**
+ * Checks the timing and allocation fields of 'stage' and of all stages below it.
+ */
+function checkStage(stage) {
+    assert.gte(stage.executionTimeNanos, stage.exclusiveTimeNanos, tojson(stage));
+    assert.gte(stage.exclusiveTimeNanos, 0, tojson(stage));
+    assert.gte(stage.workingSetAllocations, stage.exclusiveWorkingSetAllocations, tojson(stage));
+    assert.gte(stage.exclusiveWorkingSetAllocations, 0, tojson(stage));
+    assert.eq(Math.floor(stage.executionTimeNanos / (1000 * 1000)),
+              stage.executionTimeMillisEstimate,
+              tojson(stage));
+
+    var children = [];
+    if (stage.inputStage) {
+        children.push(stage.inputStage);
+    }
+    if (stage.inputStages) {
+        children = children.concat(stage.inputStages);
+    }
+    if (stage.shards) {
+        stage.shards.forEach(function(shard) { children.push(shard.executionStages); });
+        return;
+    }
+    children.forEach(checkStage);
+}
+
+/**
+ * Returns the first stage named 'name' in the tree rooted at 'stage', or null.
+ */
+function findStage(stage, name) {
+    if (stage.stage == name) {
+        return stage;
+    }
+    var children = stage.inputStages || (stage.inputStage ? [stage.inputStage] : []);
+    if (stage.shards) {
+        children = stage.shards.map(function(shard) { return shard.executionStages; });
+    }
+    for (var i = 0; i < children.length; i++) {
+        var found = findStage(children[i], name);
+        if (found) {
+            return found;
+        }
+    }
+    return null;
+}
+
+var explain = t.find({a: {$gte: 10}}).sort({_id: -1}).explain("executionStats");
+assert.commandWorked(explain);
+checkStage(explain.executionStats.executionStages);
+
+// The index scan allocates a working set member for each key it returns.
+var ixscan = findStage(explain.executionStats.executionStages, "IXSCAN");
+if (ixscan) {
+    assert.gte(ixscan.workingSetAllocations, ixscan.nReturned, tojson(ixscan));
+}
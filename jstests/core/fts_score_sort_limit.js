@@ -0,0 +1,53 @@
+// Sorting by text score with a limit lets the text stage stop once it knows the best scoring
+// documents. Check that it finds the same ones, with the same scores, as sorting all matches.
+
+var t = db.fts_score_sort_limit;
+t.drop();
+
+var words = ["apple", "banana", "cherry", "date", "elder", "fig", "grape"];
+var bulk = t.initializeUnorderedBulkOp();
+for (var i = 0; i < 2000; i++) {
+    var text = [];
+    for (var j = 0; j < words.length; j++) {
+        for (var n = (i * (j + 3)) % (j + 5); n > 0; n--) {
+            text.push(words[j]);
+        }
+    }
+    bulk.insert({_id: i, a: i % 10, text: text.join(" ") + " filler words here " + i});
+}
+assert.writeOK(bulk.execute());
+assert.commandWorked(t.ensureIndex({text: "text"}));
+
+function check(query, limit) {
+    var proj = {score: {$meta: "textScore"}};
+    var sort = {score: {$meta: "textScore"}};
+    var all = t.find(query, proj).sort(sort).toArray();
+    var best = t.find(query, proj).sort(sort).limit(limit).toArray();
+    assert.eq(Math.min(limit, all.length), best.length, tojson(query));
+    for (var i = 0; i < best.length; i++) {
+        assert.eq(all[i].score, best[i].score, tojson(query));
+    }
+    return all.length;
+}
+
+check({$text: {$search: "apple"}}, 5);
+check({$text: {$search: "apple banana cherry"}}, 20);
+check({$text: {$search: "fig grape"}}, 1);
+check({$text: {$search: "elder date -apple"}}, 10);
+check({$text: {$search: "\"banana cherry\" grape"}}, 10);
+check({$text: {$search: "cherry grape"}, a: 3}, 7);
+check({$text: {$search: "words"}}, 3000);
+check({$text: {$search: "nothing"}}, 5);
+
+// The stage reads fewer documents than match
+var explain = t.find({$text: {$search: "apple banana"}}, {score: {$meta: "textScore"}})
+               .sort({score: {$meta: "textScore"}})
+               .limit(5)
+               .explain("executionStats");
+var stage = explain.executionStats.executionStages;
+while (stage.stage != "TEXT") {
+    stage = stage.inputStage;
+}
+assert.eq(5, stage.limit, tojson(stage));
+assert.lt(stage.docsExamined, t.find({$text: {$search: "apple banana"}}).itcount(),
+          tojson(stage));
@@ -0,0 +1,47 @@
+// With the "parallelism" option of aggregate, $group partitions its input by _id over several
+// threads, and returns the same groups as without it.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_group_parallel;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 10000; i++) {
+        bulk.insert({_id: i, a: i % 1000, b: i % 7, s: "str" + (i % 13)});
+    }
+    assert.writeOK(bulk.execute());
+
+    function checkSameGroups(pipeline) {
+        pipeline = pipeline.concat([{$sort: {_id: 1}}]);
+        var serial = coll.aggregate(pipeline).toArray();
+        var res = db.runCommand({aggregate: coll.getName(), pipeline: pipeline, parallelism: 4});
+        assert.commandWorked(res);
+        assert.eq(serial, res.result);
+
+        res = db.runCommand({aggregate: coll.getName(), pipeline: pipeline, parallelism: 4,
+                             allowDiskUse: true});
+        assert.commandWorked(res);
+        assert.eq(serial, res.result);
+    }
+
+    // Many groups, so every partition gets some.
+    checkSameGroups([{$group: {_id: "$a", n: {$sum: 1}, total: {$sum: "$_id"},
+                               min: {$min: "$_id"}, max: {$max: "$_id"},
+                               strs: {$addToSet: "$s"}}}]);
+
+    // Fewer groups than threads.
+    checkSameGroups([{$group: {_id: {$gt: ["$b", 3]}, n: {$sum: 1}, avg: {$avg: "$a"}}}]);
+
+    // A compound _id, with documents missing parts of it.
+    checkSameGroups([{$group: {_id: {b: "$b", c: "$missing"}, n: {$sum: 1}}}]);
+
+    // A single group, and no input at all.
+    checkSameGroups([{$group: {_id: null, n: {$sum: 1}}}]);
+    checkSameGroups([{$match: {a: -1}}, {$group: {_id: "$a", n: {$sum: 1}}}]);
+
+    // Errors evaluating the accumulators on the grouping threads are reported.
+    var res = db.runCommand({aggregate: coll.getName(), parallelism: 4,
+                             pipeline: [{$group: {_id: "$a", x: {$sum: {$add: ["$s", 1]}}}}]});
+    assert.commandFailed(res);
+})();
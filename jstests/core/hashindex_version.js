@@ -0,0 +1,34 @@
+// Hashed indexes can be built with hash version 1, which finds the same documents as version 0
+// but stores different keys.
+var t = db.hashindex_version;
+t.drop();
+
+assert.commandWorked(t.ensureIndex({a: "hashed"}));
+assert.commandWorked(t.ensureIndex({b: "hashed"}, {hashVersion: 1}));
+assert.commandFailed(t.ensureIndex({c: "hashed"}, {hashVersion: 2}));
+
+for (var i = 0; i < 100; i++) {
+    assert.writeOK(t.insert({a: i, b: i}));
+}
+assert.writeOK(t.insert({a: 3.1, b: 3.1}));
+assert.writeOK(t.insert({c: 1}));
+
+["a", "b"].forEach(function(field) {
+    function query(value) {
+        var q = {};
+        q[field] = value;
+        return t.find(q).hint(field + "_hashed");
+    }
+    assert.eq(102, t.find().hint(field + "_hashed").itcount());
+    assert.eq(1, query(3.1).itcount());
+    assert.eq(3.1, query(3.1).next()[field]);
+    assert.eq(2, query({$in: [5, 50]}).itcount());
+    assert.eq(1, query(null).itcount());
+});
+
+var v0 = db.runCommand({_hashBSONElement: 42});
+var v1 = db.runCommand({_hashBSONElement: 42, hashVersion: 1});
+assert.commandWorked(v1);
+assert.eq(1, v1.hashVersion);
+assert.neq(v0.out, v1.out);
+assert.commandFailed(db.runCommand({_hashBSONElement: 42, hashVersion: 2}));
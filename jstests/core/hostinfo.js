@@ -31,3 +31,16 @@ if (hostinfo.os.type != "") {
     assert.neq( hostinfo.system.cpuArch, "" || null, "Missing CPU Architecture" );
     assert.neq( hostinfo.system.numaEnabled, "" || null, "Missing NUMA flag" );
 }
+
+// NUMA topology and placement; hosts without NUMA information report no nodes
+assert(hostinfo.system.numa, "Missing NUMA topology");
+assert(Array.isArray(hostinfo.system.numa.nodes), tojson(hostinfo.system.numa));
+hostinfo.system.numa.nodes.forEach(function(node) {
+    assert.gt(node.numCpus, 0, tojson(node));
+    assert.gte(node.threadsPlaced, 0, tojson(node));
+});
+if (hostinfo.os.type == "Linux" && hostinfo.system.numa.nodes.length > 0) {
+    var numaStatus = db.serverStatus({numa: 1}).numa;
+    assert.eq(hostinfo.system.numa.nodes.length, numaStatus.nodes.length, tojson(numaStatus));
+    assert.gte(numaStatus.nodes[0].residentMB, 0, tojson(numaStatus));
+}
@@ -0,0 +1,51 @@
+// createIndexes can generate and sort the keys of a foreground build on several threads, which
+// must build the same indexes as a single thread does.
+
+var t = db.index_build_parallel;
+t.drop();
+
+var bulk = t.initializeUnorderedBulkOp();
+for (var i = 0; i < 20000; i++) {
+    bulk.insert({a: i % 1000, b: [i, i + 1], c: i, s: "str" + (i % 37)});
+}
+assert.writeOK(bulk.execute());
+
+function createIndexes(indexes, parallelism) {
+    return t.runCommand({createIndexes: t.getName(), indexes: indexes, parallelism: parallelism});
+}
+
+assert.commandWorked(createIndexes([{key: {a: 1}, name: "a_1"},
+                                    {key: {b: 1}, name: "b_1"},
+                                    {key: {c: -1}, name: "c_-1", unique: true},
+                                    {key: {s: 1, c: 1}, name: "s_1_c_1"},
+                                    {key: {a: 1, c: 1}, name: "partial",
+                                     partialFilterExpression: {c: {$lt: 5000}}}],
+                                   8));
+
+assert.eq(20, t.find({a: 7}).hint("a_1").itcount());
+assert.eq(2, t.find({b: 500}).hint("b_1").itcount());
+assert.eq(20000, t.find().hint("c_-1").itcount());
+assert.eq(20000, t.find().sort({s: 1, c: 1}).hint("s_1_c_1").itcount());
+assert.eq(5000, t.find({a: {$gte: 0}, c: {$lt: 5000}}).hint("partial").itcount());
+
+// Keys come back in index order, although each thread sorted its own share of them
+var prev = null;
+t.find({}, {_id: 0, s: 1, c: 1}).sort({s: 1, c: 1}).hint("s_1_c_1").forEach(function(doc) {
+    if (prev) {
+        assert(prev.s < doc.s || (prev.s == doc.s && prev.c < doc.c), tojson([prev, doc]));
+    }
+    prev = doc;
+});
+
+// Duplicates still fail a unique build
+assert.writeOK(t.insert({d: 1}));
+assert.writeOK(t.insert({d: 1}));
+assert.commandFailed(createIndexes([{key: {d: 1}, name: "d_1", unique: true}], 4));
+
+// Errors generating keys are reported as with one thread
+assert.writeOK(t.insert({p: [1, 2], q: [1, 2]}));
+assert.commandFailed(createIndexes([{key: {p: 1, q: 1}, name: "p_1_q_1"}], 4));
+
+assert.commandFailed(createIndexes([{key: {e: 1}, name: "e_1"}], 0));
+assert.commandFailed(createIndexes([{key: {e: 1}, name: "e_1"}], 1000));
+assert.commandFailed(createIndexes([{key: {e: 1}, name: "e_1"}], "four"));
@@ -0,0 +1,81 @@
+// $lookup joins each input document with the matching documents of another collection, whether
+// it probes an index on the foreign field or builds a hash table of the foreign collection.
+(function() {
+    'use strict';
+
+    var parents = db.jstests_lookup_parents;
+    var children = db.jstests_lookup_children;
+    parents.drop();
+    children.drop();
+
+    var bulk = parents.initializeUnorderedBulkOp();
+    for (var i = 0; i < 3000; i++) {
+        bulk.insert({_id: i, key: i % 100});
+    }
+    bulk.insert({_id: "noKey"});
+    bulk.insert({_id: "arrayKey", key: [1, 2]});
+    assert.writeOK(bulk.execute());
+
+    bulk = children.initializeUnorderedBulkOp();
+    for (var i = 0; i < 300; i++) {
+        bulk.insert({_id: i, parent: i % 150});
+    }
+    bulk.insert({_id: "nullParent", parent: null});
+    bulk.insert({_id: "noParent"});
+    bulk.insert({_id: "manyParents", parent: [5, 5, 6]});
+    bulk.insert({_id: "arrayParent", parent: [1, 2]});
+    assert.writeOK(bulk.execute());
+
+    var lookup = {$lookup: {from: children.getName(), localField: "key",
+                            foreignField: "parent", as: "children"}};
+
+    // What the join should produce, computed with one query per input document.
+    function expected() {
+        return parents.find().sort({_id: 1}).toArray().map(function(parent) {
+            var key = parent.hasOwnProperty("key") ? parent.key : null;
+            parent.children = children.find({parent: key}).sort({_id: 1}).toArray();
+            return parent;
+        });
+    }
+
+    function sortChildren(results) {
+        results.forEach(function(parent) {
+            parent.children.sort(function(a, b) {
+                return bsonWoCompare({x: a._id}, {x: b._id});
+            });
+        });
+        return results;
+    }
+
+    function check() {
+        var results = parents.aggregate([{$sort: {_id: 1}}, lookup]).toArray();
+        assert.eq(expected(), sortChildren(results));
+
+        // The input order is kept.
+        results = parents.aggregate([{$sort: {_id: -1}}, lookup, {$limit: 10}]).toArray();
+        assert.eq(expected().reverse().slice(0, 10), sortChildren(results));
+    }
+
+    // Without an index on the foreign field.
+    check();
+
+    // With one.
+    assert.commandWorked(children.ensureIndex({parent: 1}));
+    check();
+
+    // A nested 'as' field, and a foreign collection that doesn't exist.
+    var results = parents.aggregate([{$match: {_id: 0}},
+                                     {$lookup: {from: "jstests_lookup_missing",
+                                                localField: "key", foreignField: "x",
+                                                as: "a.b"}}]).toArray();
+    assert.eq([{_id: 0, key: 0, a: {b: []}}], results);
+
+    // Bad specifications.
+    assert.commandFailed(db.runCommand({aggregate: parents.getName(),
+                                        pipeline: [{$lookup: {from: children.getName()}}]}));
+    assert.commandFailed(db.runCommand({aggregate: parents.getName(), pipeline: [
+        {$lookup: {from: children.getName(), localField: "key", foreignField: "parent",
+                   as: "children", other: "x"}}]}));
+    assert.commandFailed(db.runCommand({aggregate: parents.getName(), pipeline: [
+        {$lookup: {from: 1, localField: "key", foreignField: "parent", as: "children"}}]}));
+})();
@@ -0,0 +1,47 @@
+// The "parallelism" option of find and aggregate matches the documents of a collection or index
+// scan against the filter on several threads, and returns the same results in the same order.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_parallel_filter;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 5000; i++) {
+        bulk.insert({_id: i, a: i % 10, b: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    var filter = {b: {$mod: [7, 0]}};
+    var serial = coll.find(filter).toArray();
+
+    var res = db.runCommand({find: coll.getName(), filter: filter, parallelism: 4,
+                             batchSize: 10000});
+    assert.commandWorked(res);
+    assert.eq(serial, res.cursor.firstBatch);
+
+    var explain = db.runCommand({explain: {find: coll.getName(), filter: filter, parallelism: 4},
+                                 verbosity: "executionStats"});
+    assert.commandWorked(explain);
+    var stage = explain.queryPlanner.winningPlan;
+    assert.eq("PARALLEL_FILTER", stage.stage, tojson(explain));
+    assert.eq(4, stage.degree, tojson(explain));
+
+    // Index scans with a residual filter get the parallel filter above their fetch.
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    filter = {a: {$gte: 5}, b: {$mod: [7, 0]}};
+    serial = coll.find(filter).hint({a: 1}).toArray();
+    res = db.runCommand({find: coll.getName(), filter: filter, hint: {a: 1}, parallelism: 4,
+                         batchSize: 10000});
+    assert.commandWorked(res);
+    assert.eq(serial, res.cursor.firstBatch);
+
+    // Aggregation.
+    var pipeline = [{$match: {b: {$mod: [7, 0]}}}, {$group: {_id: "$a", n: {$sum: 1}}},
+                    {$sort: {_id: 1}}];
+    assert.eq(coll.aggregate(pipeline).toArray(),
+              db.runCommand({aggregate: coll.getName(), pipeline: pipeline, parallelism: 4})
+                  .result);
+    assert.commandFailed(db.runCommand({aggregate: coll.getName(), pipeline: pipeline,
+                                        parallelism: -1}));
+})();
@@ -48,3 +48,12 @@ assert.eq({query: {a: 1, b: 1}, sort: {a: -1}, projection: {_id: 1, a: 1}}, shap
 assert.eq(1, t.find({a: 1, b: 1}).itcount(), 'unexpected document count');
 shapes = getShapes();
 assert.eq(2, shapes.length, 'unexpected number of shapes in planCacheListQueryShapes result');
+
+// Running the first shape again uses its cache entry, which the counters reflect.
+var stats = t.runCommand('planCacheListQueryShapes').stats;
+assert.eq(2, stats.entries, tojson(stats));
+assert.eq(1, t.find({a: 1, b: 1}, {_id: 1, a: 1}).sort({a: -1}).itcount(),
+          'unexpected document count');
+var statsAfter = t.runCommand('planCacheListQueryShapes').stats;
+assert.eq(stats.hits + 1, statsAfter.hits, tojson(statsAfter));
+assert.eq(stats.evictions, statsAfter.evictions, tojson(statsAfter));
@@ -0,0 +1,43 @@
+// The planner sees indexes as they are now after they are created or dropped or become multikey,
+// even though each collection keeps the planner's view of its indexes between queries.
+(function() {
+    'use strict';
+
+    var t = db.jstests_planner_index_entries;
+    t.drop();
+    assert.writeOK(t.insert({a: 1, b: 1}));
+
+    function winningIndex(query) {
+        var explain = t.find(query).explain();
+        var stage = explain.queryPlanner.winningPlan;
+        while (stage.inputStage) {
+            stage = stage.inputStage;
+        }
+        return stage.stage == "IXSCAN" ? stage.indexName : null;
+    }
+
+    function isMultikey(query) {
+        var stage = t.find(query).explain().queryPlanner.winningPlan;
+        while (stage.inputStage) {
+            stage = stage.inputStage;
+        }
+        return stage.isMultiKey;
+    }
+
+    assert.eq(null, winningIndex({a: 1}));
+    assert.commandWorked(t.ensureIndex({a: 1}));
+    assert.eq("a_1", winningIndex({a: 1}));
+    assert.eq(false, isMultikey({a: 1}));
+
+    assert.writeOK(t.insert({a: [2, 3], b: 2}));
+    assert.eq(true, isMultikey({a: 1}));
+    assert.eq(1, t.find({a: {$gt: 1, $lt: 3}}).itcount());
+
+    assert.commandWorked(t.dropIndex({a: 1}));
+    assert.eq(null, winningIndex({a: 1}));
+    assert.eq(1, t.find({a: 1}).itcount());
+
+    assert.commandWorked(t.ensureIndex({b: 1}, {partialFilterExpression: {a: {$exists: true}}}));
+    assert.eq("b_1", winningIndex({b: 1, a: {$exists: true}}));
+    assert.eq(null, winningIndex({b: 1}));
+})();
@@ -0,0 +1,43 @@
+// The profiler records what the storage engine did for each operation under "storage": here, the
+// bytes written by inserts and updates.
+
+// special db so that it can be run in parallel tests
+var stddb = db;
+var db = db.getSisterDB("profile_storage");
+var t = db.profile_storage;
+
+try {
+    db.dropDatabase();
+    assert.commandWorked(t.ensureIndex({x: 1}));
+
+    db.setProfilingLevel(2);
+    assert.writeOK(t.insert({_id: 1, x: 1, s: new Array(1000).toString()}));
+    assert.writeOK(t.update({_id: 1}, {$set: {x: 2}}));
+    db.setProfilingLevel(0);
+
+    var engine = db.serverStatus().storageEngine.name;
+    // engines which keep everything in memory don't count what they write
+    if (engine == "wiredTiger" || engine == "mmapv1") {
+        var insert = db.system.profile.findOne({op: "insert", ns: t.getFullName()});
+        assert(insert, tojson(db.system.profile.find().toArray()));
+        assert.gte(insert.storage.bytesWritten, 1000, tojson(insert));
+
+        var update = db.system.profile.findOne({op: "update", ns: t.getFullName()});
+        assert(update, tojson(db.system.profile.find().toArray()));
+        assert.gt(update.storage.bytesWritten, 0, tojson(update));
+    }
+
+    // an operation which doesn't touch the storage engine's data has nothing to report
+    db.system.profile.drop();
+    db.setProfilingLevel(2);
+    assert.commandWorked(db.runCommand({isMaster: 1}));
+    db.setProfilingLevel(0);
+    var isMaster = db.system.profile.findOne({"command.isMaster": 1});
+    if (isMaster) {
+        assert.eq(undefined, isMaster.storage, tojson(isMaster));
+    }
+}
+finally {
+    db.setProfilingLevel(0);
+    db = stddb;
+}
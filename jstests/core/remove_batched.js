@@ -0,0 +1,33 @@
+// Multi-deletes remove documents in batches, taking their keys out of each index together. Check
+// that the indexes agree with the collection afterwards, including multikey and partial indexes.
+
+var t = db.remove_batched;
+t.drop();
+
+assert.commandWorked(t.ensureIndex({a: 1}));
+assert.commandWorked(t.ensureIndex({b: 1}));
+assert.commandWorked(t.ensureIndex({c: 1}, {unique: true}));
+assert.commandWorked(t.ensureIndex({a: 1, c: 1}, {partialFilterExpression: {c: {$lt: 500}}}));
+
+var bulk = t.initializeUnorderedBulkOp();
+for (var i = 0; i < 2000; i++) {
+    bulk.insert({_id: i, a: i % 10, b: [i, i + 1, "x" + i], c: i});
+}
+assert.writeOK(bulk.execute());
+
+var res = t.remove({a: {$in: [1, 3, 5]}});
+assert.writeOK(res);
+assert.eq(600, res.nRemoved);
+
+res = t.remove({c: {$gte: 1500}});
+assert.writeOK(res);
+assert.eq(350, res.nRemoved);
+
+assert.eq(1050, t.count());
+["_id_", "a_1", "b_1", "c_1"].forEach(function(index) {
+    assert.eq(1050, t.find().hint(index).itcount(), index);
+});
+assert.eq(350, t.find({a: {$gte: 0}, c: {$lt: 500}}).hint("a_1_c_1").itcount());
+assert.eq(1, t.find({b: "x2"}).itcount());
+assert.eq(0, t.find({b: "x3"}).itcount());
+assert(t.validate(true).valid);
@@ -0,0 +1,47 @@
+// An update only maintains the indexes on one of the updated paths. Check that the indexes on
+// other paths, including partial and text indexes which depend on more than their keys, still
+// agree with the collection afterwards.
+
+var t = db.update_index_selective;
+t.drop();
+
+assert.commandWorked(t.ensureIndex({a: 1}));
+assert.commandWorked(t.ensureIndex({"b.c": 1}));
+assert.commandWorked(t.ensureIndex({d: 1}, {partialFilterExpression: {e: {$gt: 5}}}));
+assert.commandWorked(t.ensureIndex({s: "text"}));
+
+for (var i = 0; i < 10; i++) {
+    assert.writeOK(t.insert({_id: i, a: i, b: {c: [i, i + 1]}, d: i, e: i, s: "foo", x: 0}));
+}
+
+// Touches none of the indexed paths
+assert.writeOK(t.update({}, {$inc: {x: 1}}, {multi: true}));
+assert.eq(10, t.find({x: 1}).itcount());
+
+// Key of one index
+assert.writeOK(t.update({_id: 1}, {$set: {a: 100}}));
+assert.eq(1, t.find({a: 100}).hint({a: 1}).itcount());
+assert.eq(0, t.find({a: 1}).hint({a: 1}).itcount());
+
+// Array element of a dotted key
+assert.writeOK(t.update({_id: 2}, {$set: {"b.c.1": 200}}));
+assert.eq(1, t.find({"b.c": 200}).hint({"b.c": 1}).itcount());
+assert.eq(1, t.find({"b.c": 3}).hint({"b.c": 1}).itcount());
+
+// Filter field of a partial index moves documents in and out of it
+assert.writeOK(t.update({_id: 3}, {$set: {e: 50}}));
+assert.writeOK(t.update({_id: 8}, {$set: {e: 0}}));
+assert.eq(1, t.find({d: 3, e: {$gt: 5}}).hint({d: 1}).itcount());
+assert.eq(0, t.find({d: 8, e: {$gt: 5}}).hint({d: 1}).itcount());
+
+// Text index
+assert.writeOK(t.update({_id: 4}, {$set: {s: "bar"}}));
+assert.eq(1, t.find({$text: {$search: "bar"}}).itcount());
+assert.eq(9, t.find({$text: {$search: "foo"}}).itcount());
+
+// Renaming onto an indexed path
+assert.writeOK(t.update({_id: 5}, {$rename: {x: "a"}}));
+assert.eq(1, t.find({a: 1}).hint({a: 1}).itcount());
+assert.eq(0, t.find({a: 5}).hint({a: 1}).itcount());
+
+assert(t.validate(true).valid);
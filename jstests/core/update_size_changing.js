@@ -0,0 +1,56 @@
+// Size changing updates of documents that no index depends on may be spliced into the stored
+// document. Check that the result is the same as a full rewrite would give.
+(function() {
+    'use strict';
+
+    var t = db.update_size_changing;
+    t.drop();
+    assert.commandWorked(t.ensureIndex({x: 1}));
+
+    var big = new Array(200 * 1024).join('b');
+    assert.writeOK(t.insert({_id: 1, x: 1, big: big, arr: [1, 2, 3], s: 'short',
+                             sub: {a: 1, b: 'two', c: [4]}, tail: 'end'}));
+
+    function check(update, expected) {
+        assert.writeOK(t.update({_id: 1}, update));
+        var doc = t.findOne({_id: 1});
+        assert.eq(expected, doc, tojson(update));
+        // The index on x is untouched by these updates but must still find the document.
+        assert.eq(1, t.find({x: 1}).hint({x: 1}).itcount());
+    }
+
+    var expected = t.findOne({_id: 1});
+
+    expected.arr.push(4);
+    check({$push: {arr: 4}}, expected);
+
+    expected.s = 'a considerably longer string';
+    check({$set: {s: expected.s}}, expected);
+
+    expected.sub.b = '';
+    expected.sub.c.push({d: [5, 6]});
+    check({$set: {'sub.b': ''}, $push: {'sub.c': {d: [5, 6]}}}, expected);
+
+    delete expected.sub.a;
+    check({$unset: {'sub.a': 1}}, expected);
+
+    expected.arr = expected.arr.slice(1);
+    check({$pop: {arr: -1}}, expected);
+
+    expected.added = {nested: true};
+    check({$set: {added: {nested: true}}}, expected);
+
+    // Enough growth that the document can no longer stay where it is.
+    for (var i = 0; i < 20; i++) {
+        expected.arr.push(big.substr(0, 10 * 1024));
+    }
+    check({$push: {arr: {$each: expected.arr.slice(3)}}}, expected);
+
+    // Changing the indexed field goes through the regular path.
+    expected.x = 'changed';
+    assert.writeOK(t.update({_id: 1}, {$set: {x: 'changed'}}));
+    assert.eq(expected, t.findOne({_id: 1}));
+    assert.eq(1, t.find({x: 'changed'}).hint({x: 1}).itcount());
+
+    assert(t.validate(true).valid);
+})();
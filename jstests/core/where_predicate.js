@@ -0,0 +1,31 @@
+// $where sees the document both as 'this' and as 'obj', and matches on the truth of what it
+// returns. Check that the cheaper predicate call keeps that, and still reports errors.
+
+var t = db.where_predicate;
+t.drop();
+
+for (var i = 0; i < 10; i++) {
+    assert.writeOK(t.insert({_id: i, a: i, s: "x" + i}));
+}
+
+assert.eq(5, t.find({$where: "this.a < 5"}).itcount());
+assert.eq(5, t.find({$where: "obj.a >= 5"}).itcount());
+assert.eq(10, t.find({$where: "this.a == obj.a && this.s == obj.s"}).itcount());
+assert.eq(1, t.find({$where: function() { return this.s == "x3"; }}).itcount());
+
+// The truth of the result, not just booleans
+assert.eq(9, t.find({$where: "return this.a"}).itcount());
+assert.eq(10, t.find({$where: "return this.s"}).itcount());
+assert.eq(0, t.find({$where: "return null"}).itcount());
+assert.eq(10, t.find({$where: "return {}"}).itcount());
+
+// Writes to 'this' don't change the document for later calls
+assert.eq(10, t.find({$where: "var before = this.a; this.a = -1; return before >= 0;"})
+                  .itcount());
+assert.eq(10, t.find({$where: "fullObject"}).itcount());
+
+// Combined with other predicates
+assert.eq(2, t.find({a: {$gt: 6}, $where: "this.a % 2 == 1"}).itcount());
+
+assert.throws(function() { t.find({$where: "throw 'oops'"}).itcount(); });
+assert.throws(function() { t.find({$where: "this.a.b.c.d"}).itcount(); });
@@ -0,0 +1,36 @@
+// Journal write concern waiters trigger early group commits (journalEarlyCommitWaiters), and the
+// pipelined journal writer reports its stage timings in serverStatus().dur.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({journal: "",
+                                      storageEngine: "mmapv1",
+                                      setParameter: "journalEarlyCommitWaiters=1"});
+    assert.neq(null, conn, "mongod failed to start");
+    var db = conn.getDB("test");
+
+    var dur = db.serverStatus().dur;
+    assert(dur, "no dur section in serverStatus");
+    assert.gte(dur.earlyCommits, 0);
+    ["prepLogBuffer", "waitForJournalBuffer", "writeToJournal", "writeToDataFiles",
+     "remapPrivateView"].forEach(function(stage) {
+        assert.gte(dur.timeMs[stage], 0, stage);
+    });
+
+    // With a threshold of one waiter every j:true write commits right away. A long commit
+    // interval makes writes waiting for the interval to be up easy to tell apart.
+    assert.commandWorked(db.adminCommand({setParameter: 1, journalCommitInterval: 300}));
+    var start = new Date();
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(db.early_commit.insert({i: i}, {writeConcern: {j: true}}));
+    }
+    var elapsedMs = new Date() - start;
+    assert.lt(elapsedMs, 20 * 40, "j:true writes were not committed early");
+
+    // Disabling it falls back to waiting for the next periodic check.
+    assert.commandWorked(db.adminCommand({setParameter: 1, journalEarlyCommitWaiters: 0}));
+    assert.writeOK(db.early_commit.insert({i: 20}, {writeConcern: {j: true}}));
+    assert.eq(21, db.early_commit.count());
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,54 @@
+// Journal recovery applies the writes of each section to different data files on different
+// threads (journalRecoveryThreads), and logs how much it applied and how fast.
+(function() {
+    'use strict';
+
+    var path = MongoRunner.dataPath + "parallel_recovery";
+    var dbNames = ["par_a", "par_b", "par_c", "par_d"];
+    var nDocs = 500;
+
+    var conn = MongoRunner.runMongod({dbpath: path,
+                                      journal: "",
+                                      smallfiles: "",
+                                      storageEngine: "mmapv1"});
+    assert.neq(null, conn, "mongod failed to start");
+
+    // Interleave the databases so that each group commit writes to several data files.
+    for (var i = 0; i < nDocs; i++) {
+        dbNames.forEach(function(name) {
+            conn.getDB(name).foo.insert({_id: i, name: name, pad: new Array(200).join("x")});
+        });
+    }
+    dbNames.forEach(function(name) {
+        assert.writeOK(conn.getDB(name).foo.insert({_id: nDocs},
+                                                   {writeConcern: {j: true}}));
+    });
+
+    MongoRunner.stopMongod(conn.port, /*signal*/9);
+
+    // Without the lsn file every section in the journal gets applied again.
+    removeFile(path + "/lsn");
+
+    clearRawMongoProgramOutput();
+    conn = MongoRunner.runMongod({restart: true,
+                                  cleanData: false,
+                                  dbpath: path,
+                                  journal: "",
+                                  smallfiles: "",
+                                  storageEngine: "mmapv1",
+                                  setParameter: "journalRecoveryThreads=4"});
+    assert.neq(null, conn, "mongod failed to recover");
+
+    dbNames.forEach(function(name) {
+        var coll = conn.getDB(name).foo;
+        assert.eq(nDocs + 1, coll.count(), name);
+        assert.eq(nDocs + 1, coll.find({name: name}).itcount() + 1, name);
+        assert(coll.validate(true).valid, name);
+    });
+
+    assert(/recover applied \d+ sections, \d+MB, in \d+ms \(\d+ MB\/s\) using 4 thread/.test(
+               rawMongoProgramOutput()),
+           "no recovery summary in the log");
+
+    MongoRunner.stopMongod(conn);
+})();
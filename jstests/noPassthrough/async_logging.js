@@ -0,0 +1,29 @@
+// With asyncLogging, the log file is written by a background thread. Check that the lines get to
+// the file, that serverStatus counts them, and that the last lines before exiting aren't lost.
+(function() {
+    "use strict";
+    var logpath = MongoRunner.dataPath + "jstests_async_logging.log";
+    removeFile(logpath);
+
+    var conn = MongoRunner.runMongod({logpath: logpath,
+                                      setParameter: {asyncLogging: true}});
+    assert.neq(null, conn, "mongod failed to start up");
+    var admin = conn.getDB("admin");
+
+    assert.commandWorked(admin.runCommand({setParameter: 1, logLevel: 1}));
+    for (var i = 0; i < 100; i++) {
+        admin.runCommand({ping: 1});
+    }
+    assert.commandWorked(admin.runCommand({setParameter: 1, logLevel: 0}));
+
+    var async = admin.serverStatus().metrics.log.async;
+    assert.gt(async.written, 0, tojson(async));
+    assert.eq(0, async.dropped, tojson(async));
+
+    MongoRunner.stopMongod(conn);
+
+    // The queue is written out at exit
+    var log = cat(logpath);
+    assert(/MongoDB starting/.test(log), log);
+    assert(/dbexit: .*rc: 0/.test(log), log);
+})();
@@ -0,0 +1,59 @@
+// Test that getCpuSamplingProfile returns the stacks sampled while mongod uses CPU, as folded
+// stacks labelled by the operation running.
+(function() {
+    "use strict";
+    if (_isWindows()) {
+        return;
+    }
+
+    var conn = MongoRunner.runMongod({setParameter: {cpuSamplingProfilerHz: 500}});
+    assert.neq(null, conn, "mongod failed to start up");
+    var admin = conn.getDB("admin");
+    var coll = conn.getDB("test").cpu_sampling_profile;
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i}));
+    }
+
+    function profile(reset) {
+        return assert.commandWorked(admin.runCommand({getCpuSamplingProfile: 1, reset: reset}));
+    }
+    // Running JS for every document keeps the queries busy
+    assert.soon(function() {
+                    for (var j = 0; j < 20; j++) {
+                        coll.find({$where: "for (var k = 0; k < 100; k++) {} return true;"})
+                            .itcount();
+                    }
+                    var ops = profile(false).ops;
+                    return ops.find > 0 || ops.query > 0;
+                },
+                "no samples of the queries");
+
+    var res = profile(true);
+    assert.eq(500, res.hz, tojson(res));
+    assert.gt(res.samples, 0, tojson(res));
+    assert(!res.truncated, tojson(res));
+
+    // Each line is "op;outermost;...;innermost count", and the counts add up to the samples
+    var total = 0;
+    res.folded.forEach(function(line) {
+        var match = /^([^;]+)(;.*)? (\d+)$/.exec(line);
+        assert(match, line);
+        assert.gt(res.ops[match[1]], 0, line);
+        total += Number(match[3]);
+    });
+    assert.eq(res.samples, total, tojson(res));
+
+    // The reset started a new profile, with no queries run since
+    res = profile(false);
+    assert.eq(undefined, res.ops.find, tojson(res));
+    assert.eq(undefined, res.ops.query, tojson(res));
+
+    MongoRunner.stopMongod(conn);
+
+    // With the profiler off, the command fails
+    conn = MongoRunner.runMongod({setParameter: {cpuSamplingProfilerHz: 0}});
+    assert.neq(null, conn, "mongod failed to start up");
+    assert.commandFailed(conn.getDB("admin").runCommand({getCpuSamplingProfile: 1}));
+    MongoRunner.stopMongod(conn);
+})();
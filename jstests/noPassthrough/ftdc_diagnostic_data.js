@@ -0,0 +1,56 @@
+// Test that mongod samples its diagnostic data into the diagnostic.data directory of its dbpath,
+// and that getDiagnosticData returns a sample.
+(function() {
+    "use strict";
+    var baseDir = "jstests_ftdc_diagnostic_data";
+    var dbpath = MongoRunner.dataPath + baseDir + "/";
+    var dataDir = dbpath + "diagnostic.data";
+
+    var conn = MongoRunner.runMongod({dbpath: dbpath,
+                                      setParameter: {
+                                          diagnosticDataCollectionPeriodMillis: 100,
+                                          diagnosticDataCollectionSamplesPerInterimUpdate: 1}});
+    assert.neq(null, conn, "mongod failed to start up");
+    var admin = conn.getDB("admin");
+
+    var res = assert.commandWorked(admin.runCommand({getDiagnosticData: 1}));
+    assert(res.data.serverStatus, tojson(res));
+    assert.eq(1, res.data.serverStatus.ok, tojson(res));
+    assert.lte(res.data.start, res.data.end, tojson(res));
+    assert.eq(undefined, res.data.replSetGetStatus, tojson(res));
+
+    function fileNames() {
+        return listFiles(dataDir).map(function(file) {
+            return file.name.substring(file.name.lastIndexOf("/") + 1);
+        });
+    }
+
+    // The samples go to a metrics file, and those not yet in it to the interim file
+    assert.soon(function() {
+                    var names = fileNames();
+                    return names.indexOf("metrics.interim") >= 0 &&
+                        names.some(function(name) {
+                            return /^metrics\.\d{4}-/.test(name);
+                        });
+                },
+                "diagnostic data files were not written");
+
+    // Turning collection off writes the samples of the interim file to the metrics file
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           diagnosticDataCollectionEnabled: false}));
+    assert.soon(function() {
+                    return fileNames().indexOf("metrics.interim") < 0;
+                },
+                "the interim file was not removed");
+
+    // and turning it on again starts a new file
+    var numFiles = fileNames().length;
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           diagnosticDataCollectionEnabled: true}));
+    assert.soon(function() {
+                    return fileNames().length == numFiles + 2;
+                },
+                "no new diagnostic data file was started");
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,46 @@
+// Test that the plan cache is saved periodically and reloaded after a restart.
+(function() {
+    "use strict";
+    var baseDir = "jstests_plan_cache_snapshot";
+    var dbpath = MongoRunner.dataPath + baseDir + "/";
+
+    var conn = MongoRunner.runMongod({dbpath: dbpath,
+                                      setParameter: {planCacheSnapshotIntervalSecs: 1}});
+    assert.neq(null, conn, "mongod failed to start up");
+    var coll = conn.getDB("test").plan_cache_snapshot;
+    coll.drop();
+
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1}));
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({a: i, b: i % 10}));
+    }
+
+    // Two indexed predicates make the query go through multi-planning, which caches the winner.
+    assert.eq(1, coll.find({a: 5, b: 5}).itcount());
+    var shapes = coll.getPlanCache().listQueryShapes();
+    assert.eq(1, shapes.length, tojson(shapes));
+
+    var snapshot = conn.getDB("local").system.plan_cache;
+    assert.soon(function() {
+                    return snapshot.find({_id: coll.getFullName()}).itcount() == 1;
+                },
+                "plan cache snapshot was not saved");
+    assert.eq(1, snapshot.findOne({_id: coll.getFullName()}).entries.length);
+
+    MongoRunner.stopMongod(conn);
+
+    conn = MongoRunner.runMongod({dbpath: dbpath,
+                                  restart: true,
+                                  setParameter: {planCacheSnapshotIntervalSecs: 1}});
+    assert.neq(null, conn, "mongod failed to restart");
+    coll = conn.getDB("test").plan_cache_snapshot;
+
+    assert.soon(function() {
+                    return coll.getPlanCache().listQueryShapes().length == 1;
+                },
+                "plan cache was not reloaded after a restart");
+    assert.eq(shapes, coll.getPlanCache().listQueryShapes());
+
+    MongoRunner.stopMongod(conn);
+})();
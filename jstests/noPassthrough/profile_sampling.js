@@ -0,0 +1,70 @@
+// Test the sampling profiler, which records operations into an in-memory ring instead of
+// system.profile.
+(function() {
+    "use strict";
+    var conn = MongoRunner.runMongod({setParameter: {profileSampleRate: 1,
+                                                     profileSampleBufferSize: 16}});
+    var db = conn.getDB("profile_sampling");
+    var coll = db.coll;
+    coll.drop();
+
+    function getSamples(afterSeq) {
+        var res = db.runCommand({getProfileSamples: 1, afterSeq: afterSeq});
+        assert.commandWorked(res);
+        return res;
+    }
+
+    var start = getSamples(0).lastSeq;
+    for (var i = 0; i < 5; i++) {
+        assert.writeOK(coll.insert({_id: i}));
+    }
+    assert.eq(5, coll.find().itcount());
+
+    // Every operation is sampled, and nothing is written to system.profile.
+    var res = getSamples(start);
+    var inserts = res.samples.filter(function(entry) {
+        return entry.op == "insert" && entry.ns == coll.getFullName();
+    });
+    assert.eq(5, inserts.length, tojson(res));
+    assert.eq(0, db.system.profile.count());
+
+    // Asking again after the last sequence number returns only newer entries.
+    var again = getSamples(res.lastSeq);
+    assert.eq(0, again.samples.filter(function(entry) {
+        return entry.op == "insert";
+    }).length, tojson(again));
+
+    // The ring only keeps the most recent entries.
+    for (var i = 0; i < 40; i++) {
+        coll.findOne({_id: i % 5});
+    }
+    assert.lte(getSamples(0).samples.length, 16);
+
+    // Samples of other databases are not returned.
+    var otherDb = conn.getDB("profile_sampling_other");
+    otherDb.coll.insert({});
+    getSamples(0).samples.forEach(function(entry) {
+        assert.neq(otherDb.coll.getFullName(), entry.ns);
+    });
+
+    // Only slow operations are sampled once the rate is turned off.
+    assert.commandWorked(db.adminCommand({setParameter: 1,
+                                          profileSampleRate: 0,
+                                          profileSampleSlowMS: 100}));
+    var beforeSlow = getSamples(0).lastSeq;
+    coll.findOne();
+    assert.eq(0, getSamples(beforeSlow).samples.length);
+    assert.eq(1, coll.find({$where: "sleep(200); return true;"}).limit(1).itcount());
+    var slow = getSamples(beforeSlow).samples;
+    assert.eq(1, slow.length, tojson(slow));
+    assert.gte(slow[0].millis, 100);
+
+    // Samples are flushed into system.profile when asked to.
+    assert.commandWorked(db.adminCommand({setParameter: 1, profileSampleFlushIntervalSecs: 1}));
+    assert.eq(1, coll.find({$where: "sleep(200); return true;"}).limit(1).itcount());
+    assert.soon(function() {
+        return db.system.profile.find({millis: {$gte: 100}}).itcount() > 0;
+    }, "sampled profile entries were not flushed");
+
+    MongoRunner.stopMongod(conn);
+})();
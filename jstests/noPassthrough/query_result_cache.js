@@ -0,0 +1,69 @@
+// Test the per-collection query result cache enabled by the 'queryResultCache' collection option.
+(function() {
+    "use strict";
+    var conn = MongoRunner.runMongod({});
+    var db = conn.getDB("test");
+    var coll = db.query_result_cache;
+    coll.drop();
+
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(coll.insert({_id: i, a: i % 2}));
+    }
+
+    function find(filter) {
+        var res = db.runCommand({find: coll.getName(), filter: filter});
+        assert.commandWorked(res);
+        assert.eq(0, res.cursor.id);
+        return res.cursor.firstBatch;
+    }
+
+    function cacheStats() {
+        return assert.commandWorked(coll.stats()).queryResultCache;
+    }
+
+    // Without the option there is no cache.
+    find({a: 1});
+    assert.eq(undefined, cacheStats());
+
+    var res = db.runCommand({collMod: coll.getName(), queryResultCache: true});
+    assert.commandWorked(res);
+    assert.eq(false, res.queryResultCache_old);
+    assert.eq(true, res.queryResultCache_new);
+
+    // The first query misses and fills the cache, the second hits.
+    assert.eq(5, find({a: 1}).length);
+    assert.eq(5, find({a: 1}).length);
+    var stats = cacheStats();
+    assert.eq(1, stats.entries);
+    assert.eq(1, stats.hits);
+    assert.eq(1, stats.misses);
+    assert.eq(0.5, stats.hitRatio);
+
+    // The same query in another form hits as well.
+    assert.eq(5, find({$and: [{a: 1}]}).length);
+    assert.eq(2, cacheStats().hits);
+
+    // Each kind of write invalidates the cache.
+    assert.writeOK(coll.insert({_id: 10, a: 1}));
+    assert.eq(0, cacheStats().entries);
+    assert.eq(6, find({a: 1}).length);
+
+    assert.writeOK(coll.update({_id: 10}, {$set: {a: 0}}));
+    assert.eq(0, cacheStats().entries);
+    assert.eq(5, find({a: 1}).length);
+
+    assert.writeOK(coll.remove({_id: 1}));
+    assert.eq(0, cacheStats().entries);
+    assert.eq(4, find({a: 1}).length);
+
+    // Queries that depend on more than the documents are never cached.
+    assert.eq(4, db.runCommand({find: coll.getName(), filter: {$where: "this.a == 1"}})
+                     .cursor.firstBatch.length);
+    assert.eq(1, cacheStats().entries);
+
+    // Disabling the option drops the cache.
+    assert.commandWorked(db.runCommand({collMod: coll.getName(), queryResultCache: false}));
+    assert.eq(undefined, cacheStats());
+
+    MongoRunner.stopMongod(conn);
+})();
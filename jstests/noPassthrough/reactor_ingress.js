@@ -0,0 +1,43 @@
+// Test servicing connections with messageServerIngressMode=reactor, where idle connections are
+// parked on a poller thread and requests are handled by a small pool of worker threads.
+(function() {
+    'use strict';
+
+    var mongo = MongoRunner.runMongod({setParameter: "messageServerIngressMode=reactor"});
+    assert.neq(null, mongo, "mongod failed to start with messageServerIngressMode=reactor");
+
+    var coll = mongo.getDB("test").reactor_ingress;
+    coll.drop();
+
+    // Connections used in an interleaved fashion, so that each one is parked and resumed many
+    // times, generally on a different worker thread each time.
+    var conns = [];
+    for (var i = 0; i < 20; i++) {
+        conns.push(new Mongo(mongo.host));
+    }
+
+    for (var round = 0; round < 10; round++) {
+        conns.forEach(function(conn, i) {
+            var c = conn.getDB("test").reactor_ingress;
+            assert.writeOK(c.insert({conn: i, round: round}));
+            assert.eq(round + 1, c.find({conn: i}).itcount());
+        });
+    }
+    assert.eq(conns.length * 10, coll.count());
+
+    // Per-connection state has to follow a connection across threads.
+    conns.forEach(function(conn, i) {
+        var res = conn.getDB("test").runCommand({whatsmyuri: 1});
+        assert.commandWorked(res);
+        assert.eq(res.you, conn.getDB("test").runCommand({whatsmyuri: 1}).you);
+    });
+
+    // Multi-batch cursors, including exhaust cursors.
+    assert.eq(coll.count(), coll.find().batchSize(2).itcount());
+    assert.eq(coll.count(), coll.find().batchSize(2).addOption(DBQuery.Option.exhaust).itcount());
+
+    MongoRunner.stopMongod(mongo);
+
+    // Unknown modes are rejected at startup.
+    assert.eq(null, MongoRunner.runMongod({setParameter: "messageServerIngressMode=bogus"}));
+})();
@@ -0,0 +1,40 @@
+// Test that the TTL monitor deletes expired documents in batches, and reports its backlog.
+(function() {
+    "use strict";
+    // Launch mongod with shorter TTL monitor sleep interval and small batches.
+    var runner = MongoRunner.runMongod({setParameter: {ttlMonitorSleepSecs: 1,
+                                                       ttlMonitorDeleteBatchSize: 10}});
+    var coll = runner.getDB("test").ttl_batched_delete;
+    coll.drop();
+
+    assert.commandWorked(coll.ensureIndex({x: 1}, {expireAfterSeconds: 0}));
+    var ttl = coll.getDB().serverStatus().metrics.ttl;
+
+    var expired = new Date(new Date().getTime() - 60 * 1000);
+    var future = new Date(new Date().getTime() + 60 * 60 * 1000);
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 95; i++) {
+        bulk.insert({x: expired});
+    }
+    for (var i = 0; i < 5; i++) {
+        bulk.insert({x: future});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Wait for the TTL monitor to run at least twice (in case we weren't finished setting up our
+    // collection when it ran the first time).
+    var ttlPass = coll.getDB().serverStatus().metrics.ttl.passes;
+    assert.soon(function() {
+                    return coll.getDB().serverStatus().metrics.ttl.passes >= ttlPass + 2;
+                },
+                "TTL monitor didn't run before timing out.");
+
+    assert.eq(5, coll.find().itcount(), "Wrong number of documents after TTL monitor run");
+
+    var newTtl = coll.getDB().serverStatus().metrics.ttl;
+    assert.eq(95, newTtl.deletedDocuments - ttl.deletedDocuments);
+    assert.gte(newTtl.deletedBatches - ttl.deletedBatches, 10);
+    assert.eq(0, newTtl.expiredBacklog);
+
+    MongoRunner.stopMongod(runner);
+})();
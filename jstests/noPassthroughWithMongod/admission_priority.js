@@ -0,0 +1,41 @@
+// Test tagging operations with an admission priority, which picks the lane they queue in for
+// WiredTiger transaction tickets.
+(function() {
+    'use strict';
+
+    var testDB = db.getSiblingDB("admission_priority");
+    var coll = testDB.coll;
+    coll.drop();
+    assert.writeOK(coll.insert({_id: 1}));
+
+    function runWithPriority(cmd, priority) {
+        return testDB.runCommand({$query: cmd, $admissionPriority: priority});
+    }
+
+    assert.commandWorked(runWithPriority({count: coll.getName()}, "interactive"));
+    assert.commandWorked(runWithPriority({count: coll.getName()}, "batch"));
+
+    // Only internal operations run at system priority.
+    assert.commandFailedWithCode(runWithPriority({count: coll.getName()}, "system"),
+                                 ErrorCodes.BadValue);
+    assert.commandFailedWithCode(runWithPriority({count: coll.getName()}, "urgent"),
+                                 ErrorCodes.BadValue);
+    assert.commandFailed(runWithPriority({count: coll.getName()}, 1));
+
+    var ss = db.serverStatus();
+    if (ss.storageEngine.name !== "wiredTiger") {
+        print("Skipping the ticket lane checks since this server does not use WiredTiger");
+        return;
+    }
+
+    function batchReadsAdmitted() {
+        var lanes = db.serverStatus().wiredTiger.concurrentTransactions.read.priorities;
+        assert(lanes.hasOwnProperty("system"), tojson(lanes));
+        assert(lanes.hasOwnProperty("interactive"), tojson(lanes));
+        return lanes.batch.admitted;
+    }
+
+    var before = batchReadsAdmitted();
+    assert.commandWorked(runWithPriority({count: coll.getName()}, "batch"));
+    assert.gt(batchReadsAdmitted(), before);
+})();
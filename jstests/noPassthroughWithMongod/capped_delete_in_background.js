@@ -0,0 +1,49 @@
+// With wiredTigerCappedDeleteInBackground, inserters leave deleting the excess documents of capped
+// collections to a background thread, and only delete them themselves when it falls so far behind
+// that the collection goes over its size by twice the slack.
+//
+// Start our own instance of mongod so that the setting does not affect other tests.
+//
+var ss = db.serverStatus();
+
+// Test is only valid in the WT suites which run against a mongod with WiredTiger enabled
+if (ss.storageEngine.name !== "wiredTiger") {
+    print("Skipping capped_delete_in_background.js since this server does not have WiredTiger " +
+          "enabled");
+}
+else {
+    var conn = MongoRunner.runMongod({setParameter: "wiredTigerCappedDeleteInBackground=true"});
+    var t = conn.getDB("test").capped_delete_in_background;
+
+    var maxSize = 1024 * 1024;
+    var slack = maxSize / 10;
+    assert.commandWorked(t.getDB().createCollection(t.getName(), {capped: true, size: maxSize}));
+
+    var padding = new Array(200).join("x");
+    var batchSize = 100;
+    for (var i = 0; i < 100; i++) {
+        var docs = [];
+        for (var j = 0; j < batchSize; j++) {
+            docs.push({_id: i * batchSize + j, padding: padding});
+        }
+        assert.writeOK(t.insert(docs));
+
+        var stats = t.stats();
+        assert.lte(stats.size, maxSize + 2 * slack + batchSize * (padding.length + 32),
+                   tojson(stats));
+    }
+
+    assert.soon(function() { return t.stats().size <= maxSize; },
+                "excess documents weren't deleted: " + tojson(t.stats()));
+
+    // The newest documents are the ones kept, in insertion order
+    var last = 100 * batchSize - 1;
+    var count = t.count();
+    assert.eq(last, t.find().sort({$natural: -1}).limit(1).next()._id);
+    var expected = last - count + 1;
+    t.find().forEach(function(doc) {
+        assert.eq(expected++, doc._id);
+    });
+
+    MongoRunner.stopMongod(conn);
+}
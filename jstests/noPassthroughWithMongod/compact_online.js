@@ -0,0 +1,31 @@
+// compact with online:true runs under intent locks, a time slice at a time, on storage engines
+// that can; others refuse it.
+(function() {
+    'use strict';
+
+    var t = db.compact_online;
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    var pad = new Array(1024).join("x");
+    for (var i = 0; i < 5000; i++) {
+        bulk.insert({_id: i, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+    assert.writeOK(t.remove({_id: {$mod: [2, 0]}}));
+
+    var res = db.runCommand({compact: t.getName(), online: true, timeSliceSecs: 1,
+                             maxBytesPerSecond: 64 * 1024 * 1024});
+    if (db.serverStatus().storageEngine.name != "wiredTiger") {
+        assert.commandFailedWithCode(res, ErrorCodes.CommandNotSupported);
+        return;
+    }
+    assert.commandWorked(res);
+    assert.gte(res.bytesFreed, 0, tojson(res));
+    assert.eq(2500, t.count());
+
+    assert.commandFailed(db.runCommand({compact: t.getName(), online: true, timeSliceSecs: 0}));
+    assert.commandFailed(db.runCommand({compact: t.getName(), online: true,
+                                        maxBytesPerSecond: -1}));
+    assert.commandFailed(db.runCommand({compact: "compact_online_missing", online: true}));
+})();
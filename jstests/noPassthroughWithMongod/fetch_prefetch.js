@@ -0,0 +1,47 @@
+// FETCH tells the storage engine which records each batch from its child is about to read, in
+// RecordId order, and still returns the documents in the order of its child. WiredTiger only
+// reads them ahead with wiredTigerPrefetchRecords set.
+(function() {
+    'use strict';
+
+    var t = db.fetch_prefetch;
+    t.drop();
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        // the index on 'a' lists the documents in the reverse of their insertion order
+        bulk.insert({_id: i, a: -i, b: i % 2});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({a: 1}));
+
+    var isWiredTiger = db.serverStatus().storageEngine.name == "wiredTiger";
+    if (isWiredTiger) {
+        assert.commandWorked(db.adminCommand({setParameter: 1, wiredTigerPrefetchRecords: true}));
+    }
+
+    function fetchStage(stage) {
+        while (stage.stage != "FETCH") {
+            assert(stage.inputStage, tojson(stage));
+            stage = stage.inputStage;
+        }
+        return stage;
+    }
+
+    var explain = t.find({a: {$lte: 0}, b: 0}).hint({a: 1}).explain("executionStats");
+    var fetch = fetchStage(explain.executionStats.executionStages);
+    assert.eq(1000, fetch.docsExamined, tojson(fetch));
+    assert.lte(fetch.prefetched, fetch.docsExamined, tojson(fetch));
+
+    var docs = t.find({a: {$lte: 0}, b: 0}).hint({a: 1}).toArray();
+    assert.eq(500, docs.length);
+    for (i = 0; i < docs.length; i++) {
+        assert.eq(0, docs[i].b, tojson(docs[i]));
+        if (i > 0) {
+            assert.lt(docs[i - 1].a, docs[i].a, tojson(docs.slice(i - 1, i + 1)));
+        }
+    }
+
+    if (isWiredTiger) {
+        assert.commandWorked(db.adminCommand({setParameter: 1, wiredTigerPrefetchRecords: false}));
+    }
+})();
@@ -0,0 +1,63 @@
+// findAndModify with skipLocked passes over documents that a concurrent findAndModify is claiming.
+// Several clients popping the same queue must still claim each job exactly once.
+(function() {
+    'use strict';
+
+    var t = db.find_and_modify_skip_locked;
+    t.drop();
+
+    var numJobs = 2000;
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < numJobs; i++) {
+        bulk.insert({_id: i, state: 'ready', pri: i % 10});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({state: 1, pri: -1}));
+
+    assert.commandFailed(t.runCommand({findAndModify: t.getName(),
+                                       query: {state: 'ready'},
+                                       update: {$set: {state: 'taken'}},
+                                       upsert: true,
+                                       skipLocked: true}));
+
+    var worker = function() {
+        var coll = db.find_and_modify_skip_locked;
+        var claimed = 0;
+        while (true) {
+            var res = coll.runCommand({findAndModify: coll.getName(),
+                                       query: {state: 'ready'},
+                                       sort: {pri: -1},
+                                       update: {$set: {state: 'taken'}, $inc: {claims: 1}},
+                                       skipLocked: true});
+            assert.commandWorked(res);
+            if (!res.value) {
+                // Jobs that were passed over may still be there
+                if (coll.count({state: 'ready'}) == 0) {
+                    break;
+                }
+                continue;
+            }
+            assert.eq('ready', res.value.state, tojson(res));
+            claimed++;
+        }
+        print('claimed ' + claimed);
+    };
+
+    var joins = [];
+    for (var i = 0; i < 4; i++) {
+        joins.push(startParallelShell('(' + worker.toString() + ')();'));
+    }
+    joins.forEach(function(join) { join(); });
+
+    assert.eq(numJobs, t.count({state: 'taken'}));
+    assert.eq(numJobs, t.count({claims: 1}));
+
+    // A removal claims too
+    assert.writeOK(t.insert({_id: 'last', state: 'ready', pri: 0}));
+    var res = t.runCommand({findAndModify: t.getName(),
+                            query: {state: 'ready'},
+                            remove: true,
+                            skipLocked: true});
+    assert.commandWorked(res);
+    assert.eq('last', res.value._id);
+})();
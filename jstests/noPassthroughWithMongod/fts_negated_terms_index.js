@@ -0,0 +1,73 @@
+// Text queries with negated terms rule out the documents holding them from the index keys of those
+// terms, rather than fetching and matching them. Check that they find the same documents as when
+// matching them, and that the ruled out documents aren't fetched.
+(function() {
+    'use strict';
+
+    var t = db.fts_negated_terms_index;
+    t.drop();
+
+    var words = ["apple", "banana", "cherry", "date", "elder"];
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        var text = [];
+        for (var j = 0; j < words.length; j++) {
+            if ((i >> j) & 1) {
+                text.push(words[j]);
+            }
+        }
+        // some also say it in capitals, which only a case insensitive query takes as "banana"
+        if (i % 7 == 0) {
+            text.push("Bananas");
+        }
+        bulk.insert({_id: i, text: text.join(" ")});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({text: "text"}));
+
+    function setMaxKeys(n) {
+        assert.commandWorked(db.adminCommand({setParameter: 1,
+                                              internalQueryTextMaxNegatedTermKeys: n}));
+    }
+
+    function ids(query, caseSensitive) {
+        var q = {$text: {$search: query}};
+        if (caseSensitive) {
+            q.$text.$caseSensitive = true;
+        }
+        return t.find(q, {_id: 1}).sort({_id: 1}).toArray();
+    }
+
+    function textStage(query) {
+        var explain = t.find({$text: {$search: query}}).explain("executionStats");
+        var stage = explain.executionStats.executionStages;
+        while (stage.stage != "TEXT") {
+            stage = stage.inputStage;
+        }
+        return stage;
+    }
+
+    var queries = ["apple -banana", "apple cherry -date -elder", "\"apple\" -cherry",
+                   "date -bananas", "elder -nothing", "apple -apple"];
+    queries.forEach(function(query) {
+        setMaxKeys(0);
+        var expected = ids(query);
+        var expectedCaseSensitive = ids(query, true);
+        setMaxKeys(100 * 1000);
+        assert.eq(expected, ids(query), query);
+        assert.eq(expectedCaseSensitive, ids(query, true), query);
+    });
+
+    // Only the documents returned are fetched
+    var stage = textStage("apple -banana");
+    assert.gt(stage.negatedKeysExamined, 0, tojson(stage));
+    assert.eq(ids("apple -banana").length, stage.docsExamined, tojson(stage));
+
+    // Past the limit on negated keys, the documents are matched instead
+    setMaxKeys(10);
+    assert.eq(ids("apple -banana").length, t.find({$text: {$search: "apple -banana"}}).itcount());
+    stage = textStage("apple -banana");
+    assert.gt(stage.docsExamined, ids("apple -banana").length, tojson(stage));
+
+    setMaxKeys(100 * 1000);
+})();
@@ -0,0 +1,35 @@
+// Background builds of indexes that aren't unique are hybrid: their keys are bulk loaded from the
+// collection scan while writes meanwhile are set aside and applied afterwards. Check that the
+// resulting index agrees with the collection despite writes of all kinds during the build.
+(function() {
+    'use strict';
+
+    var t = db.indexbg_hybrid;
+    t.drop();
+
+    var size = 100000;
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < size; i++) {
+        bulk.insert({_id: i, a: i % 100, b: [i, -i]});
+    }
+    assert.writeOK(bulk.execute());
+
+    var join = startParallelShell(
+        'assert.commandWorked(db.indexbg_hybrid.ensureIndex({a: 1, b: 1}, {background: true}));');
+
+    assert.soon(function() { return t.getIndexes().length == 2; }, "index build didn't start");
+    for (var i = 0; i < 2000; i++) {
+        assert.writeOK(t.insert({_id: size + i, a: i % 100, b: [i]}));
+        assert.writeOK(t.update({_id: i}, {$set: {a: 1000 + i}}));
+        assert.writeOK(t.remove({_id: size / 2 + i}));
+    }
+
+    join();
+
+    assert.eq(t.find().itcount(), t.find().hint({a: 1, b: 1}).itcount());
+    for (var a = 0; a < 100; a += 7) {
+        assert.eq(t.find({a: a}).itcount(), t.find({a: a}).hint({a: 1, b: 1}).itcount(), a);
+    }
+    assert.eq(2000, t.find({a: {$gte: 1000}}).hint({a: 1, b: 1}).itcount());
+    assert(t.validate(true).valid);
+})();
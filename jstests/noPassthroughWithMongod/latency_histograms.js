@@ -0,0 +1,56 @@
+// Test the latencyHistograms serverStatus section, which reports operation latencies per opcode,
+// per class of operation and per command.
+(function() {
+    'use strict';
+
+    var testDB = db.getSiblingDB("latency_histograms");
+    var coll = testDB.coll;
+    coll.drop();
+
+    function getHistograms() {
+        var res = testDB.adminCommand({serverStatus: 1, latencyHistograms: 1});
+        assert.commandWorked(res);
+        return res.latencyHistograms;
+    }
+
+    // The section is large, so it is only reported on request.
+    assert(!testDB.adminCommand({serverStatus: 1}).hasOwnProperty("latencyHistograms"));
+
+    // Start from a clean slate.
+    assert.commandWorked(testDB.adminCommand({serverStatus: 1, latencyHistograms: {reset: true}}));
+    var before = getHistograms();
+
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(coll.insert({_id: i}));
+    }
+    assert.eq(10, coll.find().itcount());
+    assert.commandWorked(testDB.runCommand({find: coll.getName()}));
+    assert.commandWorked(testDB.runCommand({count: coll.getName()}));
+
+    var after = getHistograms();
+
+    // Inserts and the find command are classed as writes and reads respectively, whichever
+    // protocol the shell used to send them.
+    assert.gte(after.writes.count - before.writes.count, 10, tojson(after.writes));
+    assert.gte(after.reads.count - before.reads.count, 2, tojson(after.reads));
+    assert.gte(after.commands.count - before.commands.count, 1, tojson(after.commands));
+
+    assert(after.perCommand.hasOwnProperty("find"), tojson(after.perCommand));
+    assert(after.perCommand.hasOwnProperty("count"), tojson(after.perCommand));
+    assert.gte(after.perCommand.count.count, 1);
+
+    var findHistogram = after.perCommand.find;
+    var bucketTotal = 0;
+    findHistogram.buckets.forEach(function(bucket) {
+        assert.gt(bucket.count, 0, tojson(findHistogram));
+        bucketTotal += bucket.count;
+    });
+    assert.eq(findHistogram.count, bucketTotal, tojson(findHistogram));
+    assert.lte(findHistogram.p50Micros, findHistogram.p99Micros, tojson(findHistogram));
+
+    // Resetting clears everything, including the per-command histograms.
+    assert.commandWorked(testDB.adminCommand({serverStatus: 1, latencyHistograms: {reset: true}}));
+    var reset = getHistograms();
+    assert(!reset.perCommand.hasOwnProperty("find"), tojson(reset.perCommand));
+    assert.eq(0, reset.writes.count, tojson(reset.writes));
+})();
@@ -0,0 +1,52 @@
+// serverStatus mem.accounted reports the memory held by the plan caches, cursors, clients and
+// other subsystems, as counted by the objects holding it.
+(function() {
+    'use strict';
+
+    var t = db.mem_accounted;
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({a: i, b: i % 10, s: "x"});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({a: 1}));
+    assert.commandWorked(t.ensureIndex({b: 1}));
+
+    function accounted() {
+        return db.serverStatus().mem.accounted;
+    }
+
+    var before = accounted();
+    ["planCache", "cursors", "clients", "aggregationGroups", "replBuffer"].forEach(function(name) {
+        assert(before[name], tojson(before));
+        assert.gte(before[name].bytes, 0, tojson(before));
+    });
+    assert.gte(before.clients.objects, 1, tojson(before));
+    assert.gt(before.clients.bytes, 0, tojson(before));
+
+    // An open cursor is counted until it is exhausted
+    var cursor = t.find().batchSize(2);
+    cursor.next();
+    var during = accounted();
+    assert.eq(before.cursors.objects + 1, during.cursors.objects, tojson(during));
+    assert.gt(during.cursors.bytes, before.cursors.bytes, tojson(during));
+    cursor.itcount();
+    assert.eq(before.cursors.objects, accounted().cursors.objects);
+
+    // A query planned from more than one index is cached
+    t.getPlanCache().clear();
+    assert.eq(1, t.find({a: 5, b: 5}).itcount());
+    var cached = accounted();
+    assert.gt(cached.planCache.bytes, 0, tojson(cached));
+    t.getPlanCache().clear();
+
+    // The sorters' account appears once something was sorted
+    assert.eq(1000, t.aggregate([{$group: {_id: "$a"}}, {$sort: {_id: -1}}]).itcount());
+    assert(accounted().sorters, tojson(accounted()));
+
+    // Groups release their memory when done
+    assert.eq(10, t.aggregate([{$group: {_id: "$b", n: {$sum: 1}}}]).itcount());
+    assert.eq(0, accounted().aggregationGroups.bytes);
+})();
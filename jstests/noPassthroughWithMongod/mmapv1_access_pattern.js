@@ -0,0 +1,62 @@
+// mmapv1AccessPattern sets the madvise() advice for the data files of all databases, or of
+// particular ones, and "auto" picks it from the record accesses seen.
+(function() {
+    'use strict';
+
+    function setPattern(value) {
+        return db.adminCommand({setParameter: 1, mmapv1AccessPattern: value});
+    }
+
+    var original = db.adminCommand({getParameter: 1, mmapv1AccessPattern: 1});
+    assert.commandWorked(original);
+    assert.eq("normal", original.mmapv1AccessPattern);
+
+    ["random", "sequential", "auto", "normal,test:random", "auto,logs:sequential,other:normal"
+    ].forEach(function(value) {
+        assert.commandWorked(setPattern(value), value);
+        assert.eq(value,
+                  db.adminCommand({getParameter: 1, mmapv1AccessPattern: 1}).mmapv1AccessPattern);
+    });
+
+    ["", "fast", "auto,test", "auto,test:fast", "auto,,random"].forEach(function(value) {
+        assert.commandFailed(setPattern(value), value);
+    });
+
+    // huge pages can only be chosen at startup
+    assert.commandFailed(db.adminCommand({setParameter: 1, mmapv1HugePages: "transparent"}));
+
+    if (db.serverStatus().storageEngine.name != "mmapv1") {
+        assert.commandWorked(setPattern(original.mmapv1AccessPattern));
+        return;
+    }
+
+    var t = db.mmapv1_access_pattern;
+    t.drop();
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 10000; i++) {
+        bulk.insert({_id: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    function adviceChanges() {
+        return db.serverStatus().metrics.storage.accessPattern.adviceChanges;
+    }
+
+    // the advice changes at the next record access
+    var before = adviceChanges();
+    assert.commandWorked(setPattern("normal," + db.getName() + ":random"));
+    assert.eq(10000, t.find().itcount());
+    assert.gt(adviceChanges(), before);
+
+    // setting the same advice again leaves the data files as they are
+    before = adviceChanges();
+    assert.commandWorked(setPattern("normal," + db.getName() + ":random"));
+    assert.eq(10000, t.find().itcount());
+    assert.eq(before, adviceChanges());
+
+    assert.commandWorked(setPattern("auto"));
+    assert.eq(10000, t.find().itcount());
+
+    assert.commandWorked(setPattern(original.mmapv1AccessPattern));
+    assert.eq(10000, t.find().itcount());
+})();
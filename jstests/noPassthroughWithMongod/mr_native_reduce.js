@@ -0,0 +1,72 @@
+// Reduce functions which sum their values or take their minimum or maximum run natively. Check
+// that they give the same results as running them in JS, including for keys whose values aren't
+// all numbers, which still go to the JS function.
+(function() {
+    'use strict';
+
+    var t = db.mr_native_reduce;
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 20000; i++) {
+        bulk.insert({k: i % 37, n: (i % 2 ? NumberInt(i % 11) : NumberLong(i % 13)), x: i / 7});
+    }
+    // key 5 also gets a string, so concatenates in JS
+    bulk.insert({k: 5, n: "str", x: "str"});
+    assert.writeOK(bulk.execute());
+
+    function setNative(on) {
+        assert.commandWorked(db.adminCommand({setParameter: 1,
+                                              internalMapReduceUseNativeReducers: on}));
+    }
+
+    var maps = [
+        function() { emit(this.k, this.n); },
+        function() { emit(this.k, this.x); },
+        function() { emit(this.k, 1); },
+    ];
+    var reduces = [
+        function(key, values) { return Array.sum(values); },
+        function(key, vals) {
+            var total = 0;
+            for (var i = 0; i < vals.length; i++) {
+                total += vals[i];
+            }
+            return total;
+        },
+        function(key, values) { return Math.max.apply(Math, values); },
+        function(key, values) { return Math.min.apply(null, values); },
+    ];
+    var finalize = function(key, value) { return {v: value}; };
+
+    function run(map, reduce, options) {
+        var res = t.mapReduce(map, reduce, options);
+        assert.commandWorked(res);
+        var out = options.out.inline ? res.results : db[options.out].find().toArray();
+        return out.sort(function(a, b) { return a._id - b._id; });
+    }
+
+    maps.forEach(function(map) {
+        reduces.forEach(function(reduce) {
+            [{out: {inline: 1}},
+             {out: "mr_native_reduce_out"},
+             {out: {inline: 1}, finalize: finalize},
+             {out: "mr_native_reduce_out", finalize: finalize, query: {k: {$lt: 10}}},
+            ].forEach(function(options) {
+                setNative(false);
+                var expected = run(map, reduce, options);
+                setNative(true);
+                var actual = run(map, reduce, options);
+                assert.eq(expected, actual, tojson({map: map, reduce: reduce, options: options}));
+            });
+        });
+    });
+
+    // A reduce function which isn't recognized runs in JS as before
+    var res = t.mapReduce(maps[2], function(key, values) { return values.length; },
+                          {out: {inline: 1}});
+    assert.commandWorked(res);
+    assert.eq(37, res.results.length);
+
+    db.mr_native_reduce_out.drop();
+})();
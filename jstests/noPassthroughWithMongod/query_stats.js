@@ -0,0 +1,78 @@
+// queryStats returns the execution statistics of the queries run on a database, summed by query
+// shape and command, and can reset them.
+(function() {
+    'use strict';
+
+    var t = db.query_stats;
+    t.drop();
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 100; i++) {
+        bulk.insert({_id: i, a: i % 10, b: i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({a: 1}));
+
+    function queryStats(reset) {
+        var res = db.runCommand({queryStats: 1, reset: reset});
+        assert.commandWorked(res);
+        return res;
+    }
+
+    function shapesOf(res, opTypes) {
+        return res.shapes.filter(function(entry) {
+            return entry.ns == t.getFullName() && opTypes.indexOf(entry.opType) >= 0;
+        });
+    }
+
+    queryStats(true);
+    assert.eq([], shapesOf(queryStats(false), ["query", "find"]));
+
+    // queries differing only in their constants share a shape
+    for (i = 0; i < 5; i++) {
+        assert.eq(10, t.find({a: i}).itcount());
+    }
+    assert.eq(1, t.find({b: 50}).itcount());
+    assert.eq(10, t.count({a: 3}));
+    assert.eq(10, t.distinct("b", {a: 3}).length);
+    assert.eq(10, t.aggregate([{$match: {a: 3}}, {$project: {b: 1}}]).itcount());
+
+    var res = queryStats(false);
+    var finds = shapesOf(res, ["query", "find"]);
+    assert.eq(2, finds.length, tojson(res));
+    var byA = finds.filter(function(entry) { return entry.shape.query.hasOwnProperty("a"); })[0];
+    assert(byA, tojson(finds));
+    assert.eq(5, byA.latency.count, tojson(byA));
+    assert.eq(50, byA.nreturned, tojson(byA));
+    assert.gte(byA.keysExamined, 50, tojson(byA));
+    assert.gte(byA.docsExamined, 50, tojson(byA));
+    assert.lte(byA.firstSeen, byA.lastSeen, tojson(byA));
+
+    var byB = finds.filter(function(entry) { return entry.shape.query.hasOwnProperty("b"); })[0];
+    assert(byB, tojson(finds));
+    assert.eq(1, byB.latency.count, tojson(byB));
+    assert.gte(byB.docsExamined, 100, tojson(byB));
+
+    ["count", "distinct", "aggregate"].forEach(function(opType) {
+        var entries = shapesOf(res, [opType]);
+        assert.eq(1, entries.length, opType + ": " + tojson(res));
+        assert.eq(1, entries[0].latency.count, tojson(entries[0]));
+        assert.gte(entries[0].keysExamined, 10, tojson(entries[0]));
+    });
+
+    // the costliest shapes come first
+    for (i = 1; i < res.shapes.length; i++) {
+        assert.gte(res.shapes[i - 1].latency.totalMicros, res.shapes[i].latency.totalMicros,
+                   tojson(res.shapes));
+    }
+
+    // the entries of other databases are left out
+    var other = db.getSiblingDB("query_stats_other");
+    assert.eq(0, other.c.find({x: 1}).itcount());
+    res = queryStats(true);
+    res.shapes.forEach(function(entry) {
+        assert.eq(0, entry.ns.indexOf(db.getName() + "."), tojson(entry));
+    });
+    assert.eq(0, shapesOf(queryStats(false), ["query", "find", "count"]).length);
+    assert.gt(other.runCommand({queryStats: 1}).shapes.length, 0);
+    other.dropDatabase();
+})();
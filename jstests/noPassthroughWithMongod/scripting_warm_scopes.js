@@ -0,0 +1,39 @@
+// The server keeps new JS scopes ready for operations which find none pooled for them, and
+// reuses the functions a scope compiled already. Check the counts serverStatus reports for both.
+(function() {
+    'use strict';
+
+    var t = db.scripting_warm_scopes;
+    t.drop();
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(t.insert({a: i}));
+    }
+
+    function scripting() {
+        return db.serverStatus().metrics.scripting;
+    }
+
+    assert.commandWorked(db.adminCommand({setParameter: 1, scriptingMinWarmScopes: 2}));
+    assert.commandFailed(db.adminCommand({setParameter: 1, scriptingMinWarmScopes: -1}));
+    assert.commandFailed(db.adminCommand({setParameter: 1, scriptingMinWarmScopes: 1000}));
+
+    // The first operation starts the warming, if nothing did before
+    assert.eq(5, t.find({$where: "this.a < 5"}).itcount());
+    var n = 0;
+    assert.soon(function() {
+        var before = scripting();
+        // scopes are pooled per database, so none is pooled for a new one
+        var other = db.getSiblingDB("scripting_warm_scopes_" + n++);
+        assert.commandWorked(other.runCommand({eval: "return 1;", nolock: true}));
+        return scripting().warmScopesUsed > before.warmScopesUsed;
+    }, "no warm scope was used");
+
+    // The same $where reuses the compiled function of its pooled scope
+    var before = scripting();
+    for (var i = 0; i < 5; i++) {
+        assert.eq(3, t.find({$where: "this.a > 6"}).itcount());
+    }
+    var after = scripting();
+    assert.gt(after.functionCacheHits, before.functionCacheHits, tojson([before, after]));
+    assert.gte(after.scopesCreated, before.scopesCreated);
+})();
@@ -0,0 +1,61 @@
+// splitVector can pick split points from a random sample of the shard key index instead of
+// counting its keys, where the storage engine can sample index keys.
+(function() {
+    'use strict';
+
+    var t = db.splitvector_sampled;
+    t.drop();
+    var padding = new Array(100).join("x");
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 20000; i++) {
+        bulk.insert({x: i, padding: padding});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({x: 1}));
+
+    var maxChunkSizeBytes = 200 * 1024;
+    function splitVector(sample, force) {
+        var cmd = {splitVector: t.getFullName(), keyPattern: {x: 1}, sample: sample};
+        if (force) {
+            cmd.force = true;
+        }
+        else {
+            cmd.maxChunkSizeBytes = maxChunkSizeBytes;
+        }
+        var res = db.adminCommand(cmd);
+        assert.commandWorked(res);
+        return res;
+    }
+
+    var scanned = splitVector(false);
+    assert.eq(false, scanned.sampled, tojson(scanned));
+    assert.gt(scanned.splitKeys.length, 10, tojson(scanned));
+    assert.gte(scanned.keysExamined, 20000, tojson(scanned));
+
+    var samplingsBefore = db.serverStatus().metrics.splitVector.samplings.num;
+    var sampled = splitVector(true);
+    if (!sampled.sampled) {
+        // this storage engine can't sample index keys
+        assert.eq(scanned.splitKeys, sampled.splitKeys);
+        return;
+    }
+    assert.lt(sampled.keysExamined, 20000, tojson(sampled));
+    assert.eq(samplingsBefore + 1, db.serverStatus().metrics.splitVector.samplings.num);
+
+    // About as many chunks, each within the error bound of the target size
+    var docsPerChunk = 20000 / (scanned.splitKeys.length + 1);
+    assert.lte(Math.abs(sampled.splitKeys.length - scanned.splitKeys.length),
+               scanned.splitKeys.length / 4, tojson(sampled));
+    var bounds = [-1].concat(sampled.splitKeys.map(function(key) { return key.x; }));
+    for (i = 1; i < bounds.length; i++) {
+        assert.lt(bounds[i - 1], bounds[i], tojson(sampled.splitKeys));
+        assert.lt(Math.abs(bounds[i] - bounds[i - 1] - docsPerChunk), docsPerChunk / 2,
+                  tojson(sampled.splitKeys));
+    }
+
+    var median = splitVector(true, true);
+    assert.eq(true, median.sampled, tojson(median));
+    assert.eq(1, median.splitKeys.length, tojson(median));
+    assert.gt(median.splitKeys[0].x, 8000, tojson(median));
+    assert.lt(median.splitKeys[0].x, 12000, tojson(median));
+})();
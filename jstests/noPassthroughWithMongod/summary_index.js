@@ -0,0 +1,98 @@
+// A summary index keeps the count of the documents of each group of values of its fields, and
+// the sum of its sumField over them, which answer counts and $group $sums by those fields
+// without scanning the documents.
+(function() {
+    'use strict';
+
+    var t = db.summary_index;
+    t.drop();
+    assert.commandWorked(t.ensureIndex({status: 1}));
+    assert.commandWorked(t.ensureIndex({tenant: "summary", status: "summary"},
+                                       {sumField: "amount"}));
+
+    var statuses = ["new", "paid", "shipped", null, undefined];
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        var doc = {_id: i, tenant: "t" + (i % 4)};
+        if (statuses[i % 5] !== undefined) {
+            doc.status = statuses[i % 5];
+        }
+        // ints, longs, doubles and non-numbers
+        switch (i % 7) {
+            case 0: doc.amount = NumberInt(i); break;
+            case 1: doc.amount = NumberLong(i); break;
+            case 2: doc.amount = i + 0.5; break;
+            case 3: doc.amount = "none"; break;
+            default: doc.amount = i;
+        }
+        bulk.insert(doc);
+    }
+    assert.writeOK(bulk.execute());
+
+    function sortById(docs) {
+        return docs.sort(function(a, b) {
+            return bsonWoCompare({x: a._id}, {x: b._id});
+        });
+    }
+
+    // Runs the [$match,] $group 'pipeline' from the summary, and scanning the documents.
+    function checkGroup(pipeline, fromSummary) {
+        var explain = t.aggregate(pipeline, {explain: true});
+        var firstStage = Object.keys(explain.stages[0])[0];
+        assert.eq(fromSummary ? "$summary" : "$cursor", firstStage, tojson(explain));
+
+        var scanned = t.aggregate([{$project: {tenant: 1, status: 1, amount: 1}}]
+                                  .concat(pipeline)).toArray();
+        assert.eq(sortById(scanned), sortById(t.aggregate(pipeline).toArray()));
+    }
+
+    function checkCount(query, fromSummary) {
+        var explain = t.explain().count(query);
+        assert.eq(fromSummary ? "summary_1" : undefined,
+                  explain.queryPlanner.winningPlan.summaryIndex, tojson(explain));
+        assert.eq(t.find(query).hint({_id: 1}).itcount(), t.count(query));
+    }
+
+    var sums = {n: {$sum: 1}, two: {$sum: 2}, total: {$sum: "$amount"}};
+    function checkAll() {
+        checkGroup([{$group: {_id: "$tenant", n: sums.n}}], true);
+        checkGroup([{$group: {_id: {t: "$tenant", s: "$status"}, n: sums.n, two: sums.two,
+                              total: sums.total}}], false); // missing and null look alike
+        checkGroup([{$group: {_id: "$status", n: sums.n, total: sums.total}}], true);
+        checkGroup([{$match: {tenant: "t1"}}, {$group: {_id: "$status", total: sums.total}}],
+                   true);
+        checkGroup([{$match: {tenant: {$in: ["t1", "t2"]}, status: null}},
+                    {$group: {_id: null, n: sums.n, total: sums.total}}], true);
+        checkGroup([{$match: {_id: {$lt: 100}}}, {$group: {_id: "$tenant", n: sums.n}}], false);
+        checkGroup([{$group: {_id: "$tenant", n: {$sum: "$_id"}}}], false);
+
+        checkCount({tenant: "t3"}, true);
+        checkCount({tenant: {$in: ["t0", "t3"]}, status: "paid"}, true);
+        checkCount({status: null}, true);
+        checkCount({status: {$gt: "a"}}, false);
+    }
+    checkAll();
+
+    // The groups follow updates and removes.
+    assert.writeOK(t.update({tenant: "t1"}, {$set: {status: "paid", amount: 2.5}},
+                            {multi: true}));
+    assert.writeOK(t.update({_id: 3}, {$set: {tenant: "t5"}}));
+    assert.writeOK(t.remove({tenant: "t2", status: "new"}));
+    assert.writeOK(t.insert({_id: 2000, tenant: "t6"}));
+    checkAll();
+    assert.eq(1, t.count({tenant: "t6"}));
+    assert.eq(0, t.count({tenant: "t2", status: "new"}));
+
+    // Group field values can't be arrays.
+    assert.writeErrorWithCode(t.insert({tenant: ["t1", "t2"]}), 28797);
+    assert.writeErrorWithCode(t.insert({tenant: "t1", status: ["paid"]}), 28797);
+
+    // Summary indexes can't be unique, sparse or partial, and sumField must name a field.
+    var u = db.summary_index_options;
+    u.drop();
+    assert.commandFailedWithCode(u.ensureIndex({a: "summary"}, {unique: true}), 28800);
+    assert.commandFailedWithCode(u.ensureIndex({a: "summary"}, {sparse: true}), 28801);
+    assert.commandFailedWithCode(u.ensureIndex({a: "summary"}, {sumField: "$b"}), 28799);
+    assert.commandFailedWithCode(u.ensureIndex({a: "summary"}, {sumField: 1}), 28799);
+    u.drop();
+})();
@@ -0,0 +1,59 @@
+// touch works on WiredTiger as well as MMAPv1, and warmUpCache touches a list of collections, or
+// the ones used the most, up to cacheWarmupMaxBytes.
+(function() {
+    'use strict';
+
+    var engine = db.serverStatus().storageEngine.name;
+    if (engine != "wiredTiger" && engine != "mmapv1") {
+        return;
+    }
+
+    var t = db.warm_up_cache;
+    var u = db.warm_up_cache_other;
+    t.drop();
+    u.drop();
+
+    var pad = new Array(256).join("x");
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 10000; i++) {
+        bulk.insert({_id: i, a: i, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({a: 1}));
+    assert.writeOK(u.insert({_id: 1}));
+
+    var res = assert.commandWorked(db.runCommand({touch: t.getName(), data: true, index: true}));
+    if (engine == "wiredTiger") {
+        assert.eq(10000, res.data.numRecords, tojson(res));
+        assert.eq(2, res.indexes.num, tojson(res));
+    }
+
+    // Throttled touches page through the collection and still see all of it
+    assert.commandWorked(db.adminCommand({setParameter: 1,
+                                          wiredTigerTouchMaxBytesPerSecond: 64 * 1024 * 1024}));
+    res = assert.commandWorked(db.runCommand({touch: t.getName(), data: true}));
+    if (engine == "wiredTiger") {
+        assert.eq(10000, res.data.numRecords, tojson(res));
+    }
+    assert.commandWorked(db.adminCommand({setParameter: 1, wiredTigerTouchMaxBytesPerSecond: 0}));
+
+    res = assert.commandWorked(db.adminCommand({warmUpCache: 1,
+                                                namespaces: [t.getFullName(), u.getFullName(),
+                                                             db.getName() + ".missing"]}));
+    assert.eq(2, res.namespaces.length, tojson(res));
+    assert.eq(t.getFullName(), res.namespaces[0].ns, tojson(res));
+    assert.eq(0, res.skipped, tojson(res));
+
+    // Namespaces that don't fit in the limit are skipped, and smaller ones after them touched
+    assert.commandWorked(db.adminCommand({setParameter: 1,
+                                          cacheWarmupMaxBytes: res.namespaces[1].storageBytes}));
+    res = assert.commandWorked(db.adminCommand({warmUpCache: 1,
+                                                namespaces: [t.getFullName(), u.getFullName()]}));
+    assert.eq(1, res.skipped, tojson(res));
+    assert.eq(u.getFullName(), res.namespaces[0].ns, tojson(res));
+    assert.commandWorked(db.adminCommand({setParameter: 1, cacheWarmupMaxBytes: 0}));
+
+    assert.commandFailed(db.adminCommand({warmUpCache: 1, namespaces: "notAnArray"}));
+    assert.commandFailed(db.adminCommand({warmUpCache: 1, namespaces: ["bad"]}));
+    assert.commandWorked(db.adminCommand({warmUpCache: 1}));
+})();
@@ -0,0 +1,57 @@
+// Per-table WiredTiger cache statistics in collStats, and the wiredTigerCacheResidency command
+// which ranks collections and indexes by them.
+var ss = db.serverStatus();
+
+// Test is only valid in the WT suites which run against a mongod with WiredTiger enabled
+if (ss.storageEngine.name !== "wiredTiger") {
+    print("Skipping wt_cache_residency.js since this server does not have WiredTiger enabled");
+}
+else {
+    var coll = db.wt_cache_residency;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({x: 1}));
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({x: i}));
+    }
+
+    function checkResidency(residency) {
+        assert(residency, "missing cacheResidency");
+        ["bytesReadIntoCache", "bytesWrittenFromCache", "pagesReadIntoCache", "pagesEvicted"]
+            .forEach(function(field) {
+                assert.gte(residency[field], 0, field);
+            });
+    }
+
+    var stats = coll.stats({indexDetails: true});
+    assert.commandWorked(stats);
+    checkResidency(stats.wiredTiger.cacheResidency);
+    checkResidency(stats.indexDetails.x_1.cacheResidency);
+
+    var admin = db.getSiblingDB("admin");
+    var res = admin.runCommand({wiredTigerCacheResidency: 1, limit: 0});
+    assert.commandWorked(res);
+    assert.eq("bytesReadIntoCache", res.sortBy);
+    assert.eq(res.tables, res.top.length);
+    checkResidency(res.totals);
+
+    var ns = coll.getFullName();
+    var entries = res.top.filter(function(entry) { return entry.ns === ns; });
+    assert.eq(3, entries.length, tojson(res.top));
+    assert.eq(1, entries.filter(function(entry) { return entry.index === undefined; }).length);
+    assert.eq(1, entries.filter(function(entry) { return entry.index === "x_1"; }).length);
+    assert.eq(1, entries.filter(function(entry) { return entry.index === "_id_"; }).length);
+
+    // Ranked in descending order of the requested field.
+    res = admin.runCommand({wiredTigerCacheResidency: 1, sortBy: "pagesEvicted", limit: 2});
+    assert.commandWorked(res);
+    assert.lte(res.top.length, 2);
+    for (var j = 1; j < res.top.length; j++) {
+        assert.gte(res.top[j - 1].pagesEvicted, res.top[j].pagesEvicted);
+    }
+
+    assert.commandFailed(admin.runCommand({wiredTigerCacheResidency: 1, sortBy: "bogus"}));
+    assert.commandFailed(admin.runCommand({wiredTigerCacheResidency: 1, limit: -1}));
+    assert.commandFailed(db.runCommand({wiredTigerCacheResidency: 1}));
+
+    coll.drop();
+}
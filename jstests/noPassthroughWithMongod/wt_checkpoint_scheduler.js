@@ -0,0 +1,56 @@
+// Runtime settings and serverStatus reporting of the WiredTiger checkpoint scheduler.
+//
+// Start our own instance of mongod so that the settings do not affect other tests.
+//
+var ss = db.serverStatus();
+
+// Test is only valid in the WT suites which run against a mongod with WiredTiger enabled
+if (ss.storageEngine.name !== "wiredTiger") {
+    print("Skipping wt_checkpoint_scheduler.js since this server does not have WiredTiger enabled");
+}
+else {
+    var conn = MongoRunner.runMongod();
+    var admin = conn.getDB("admin");
+
+    function setParam(name, value) {
+        var cmd = {setParameter: 1};
+        cmd[name] = value;
+        return admin.runCommand(cmd);
+    }
+
+    function getParam(name) {
+        var cmd = {getParameter: 1};
+        cmd[name] = 1;
+        var res = admin.runCommand(cmd);
+        assert.commandWorked(res);
+        return res[name];
+    }
+
+    ["wiredTigerCheckpointDelaySecs",
+     "wiredTigerCheckpointDirtyTriggerMB",
+     "wiredTigerCheckpointJournalTriggerMB",
+     "wiredTigerCheckpointMinIntervalSecs"].forEach(function(name) {
+        assert.commandWorked(setParam(name, 7));
+        assert.eq(7, getParam(name));
+        assert.commandWorked(setParam(name, NumberLong(8)));
+        assert.eq(8, getParam(name));
+        assert.commandFailed(setParam(name, -1));
+        assert.commandFailed(setParam(name, 1.5));
+        assert.commandFailed(setParam(name, "abc"));
+        assert.eq(8, getParam(name));
+    });
+
+    // Take time triggered checkpoints every second, and check they are reported.
+    assert.commandWorked(setParam("wiredTigerCheckpointDelaySecs", 1));
+    assert.writeOK(conn.getDB("test").wt_checkpoint_scheduler.insert({a: 1}));
+    assert.soon(function() {
+        var scheduler = admin.serverStatus().wiredTiger["checkpoint scheduler"];
+        return scheduler.checkpoints.time > 0 && scheduler.durationMicros.count > 0;
+    }, "no time triggered checkpoint was reported");
+
+    var scheduler = admin.serverStatus().wiredTiger["checkpoint scheduler"];
+    assert.eq(1, scheduler.settings.wiredTigerCheckpointDelaySecs);
+    assert(scheduler.bytesWritten.hasOwnProperty("totalBytes"), tojson(scheduler));
+
+    MongoRunner.stopMongod(conn.port);
+}
@@ -0,0 +1,75 @@
+// Cursors whose snapshot is pinned between getMores (wiredTigerMaxPinnedCursorSnapshots) continue
+// from their saved WiredTiger cursor position instead of re-seeking.
+//
+// Start our own instance of mongod so that the setting does not affect other tests.
+//
+var ss = db.serverStatus();
+
+// Test is only valid in the WT suites which run against a mongod with WiredTiger enabled
+if (ss.storageEngine.name !== "wiredTiger") {
+    print("Skipping wt_pinned_cursor_snapshots.js since this server does not have WiredTiger " +
+          "enabled");
+}
+else {
+    var conn = MongoRunner.runMongod();
+    var testDB = conn.getDB("test");
+    var coll = testDB.wt_pinned_cursor_snapshots;
+
+    function pinnedStats() {
+        return testDB.serverStatus().wiredTiger.pinnedCursorSnapshots;
+    }
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 100; i++) {
+        bulk.insert({_id: i, x: i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({x: 1}));
+
+    // Pinning is disabled by default.
+    assert.eq(0, pinnedStats().maximum);
+    assert.eq(100, coll.find().batchSize(10).itcount());
+    assert.eq(0, pinnedStats().reseeksAvoided);
+
+    assert.commandWorked(testDB.adminCommand({setParameter: 1,
+                                              wiredTigerMaxPinnedCursorSnapshots: 10}));
+    assert.eq(10, pinnedStats().maximum);
+
+    // Collection scans and index scans, through both the legacy and the command read paths.
+    ["legacy", "commands"].forEach(function(mode) {
+        testDB.getMongo().forceReadMode(mode);
+
+        var before = pinnedStats().reseeksAvoided;
+        assert.eq(100, coll.find().batchSize(10).itcount());
+        assert.gt(pinnedStats().reseeksAvoided, before);
+
+        before = pinnedStats().reseeksAvoided;
+        assert.eq(100, coll.find({x: {$gte: 0}}).hint({x: 1}).batchSize(10).itcount());
+        assert.gt(pinnedStats().reseeksAvoided, before);
+    });
+
+    // Exhausted cursors give their snapshot back.
+    assert.eq(0, pinnedStats().current);
+
+    // An idle cursor keeps its snapshot, so it does not see writes made after its first batch.
+    var cursor = coll.find().batchSize(10);
+    assert(cursor.hasNext());
+    assert.eq(1, pinnedStats().current);
+    assert.writeOK(coll.insert({_id: 100, x: 100}));
+    assert.eq(100, cursor.itcount());
+    assert.eq(0, pinnedStats().current);
+
+    // Pins beyond the limit are refused, and those cursors behave as before.
+    assert.commandWorked(testDB.adminCommand({setParameter: 1,
+                                              wiredTigerMaxPinnedCursorSnapshots: 1}));
+    var first = coll.find().batchSize(10);
+    var second = coll.find().batchSize(10);
+    assert(first.hasNext());
+    var refused = pinnedStats().refused;
+    assert(second.hasNext());
+    assert.eq(refused + 1, pinnedStats().refused);
+    assert.eq(101, first.itcount());
+    assert.eq(101, second.itcount());
+
+    MongoRunner.stopMongod(conn);
+}
@@ -0,0 +1,65 @@
+// Runtime settings and serverStatus reporting of the WiredTiger ticket controller, which resizes
+// wiredTigerConcurrentReadTransactions and wiredTigerConcurrentWriteTransactions.
+//
+// Start our own instance of mongod so that the settings do not affect other tests.
+//
+var ss = db.serverStatus();
+
+// Test is only valid in the WT suites which run against a mongod with WiredTiger enabled
+if (ss.storageEngine.name !== "wiredTiger") {
+    print("Skipping wt_ticket_controller.js since this server does not have WiredTiger enabled");
+}
+else {
+    var conn = MongoRunner.runMongod();
+    var admin = conn.getDB("admin");
+
+    function setParam(name, value) {
+        var cmd = {setParameter: 1};
+        cmd[name] = value;
+        return admin.runCommand(cmd);
+    }
+
+    function getParam(name) {
+        var cmd = {getParameter: 1};
+        cmd[name] = 1;
+        var res = admin.runCommand(cmd);
+        assert.commandWorked(res);
+        return res[name];
+    }
+
+    ["wiredTigerTicketControllerMinTickets",
+     "wiredTigerTicketControllerMaxTickets",
+     "wiredTigerTicketControllerIntervalMillis"].forEach(function(name) {
+        assert.commandWorked(setParam(name, 7));
+        assert.eq(7, getParam(name));
+        assert.commandFailed(setParam(name, 0));
+        assert.commandFailed(setParam(name, 1.5));
+        assert.commandFailed(setParam(name, "abc"));
+        assert.eq(7, getParam(name));
+    });
+    assert.commandFailed(setParam("wiredTigerTicketControllerEnabled", 2));
+    assert.eq(0, getParam("wiredTigerTicketControllerEnabled"));
+
+    // Disabled, the controller leaves the tickets alone.
+    assert.commandWorked(setParam("wiredTigerTicketControllerIntervalMillis", 100));
+    assert.commandWorked(setParam("wiredTigerTicketControllerMinTickets", 8));
+    assert.commandWorked(setParam("wiredTigerTicketControllerMaxTickets", 64));
+    sleep(500);
+    assert.eq(128, getParam("wiredTigerConcurrentReadTransactions"));
+
+    // Enabled, it brings them within its bounds.
+    assert.commandWorked(setParam("wiredTigerTicketControllerEnabled", true));
+    assert.soon(function() {
+        return getParam("wiredTigerConcurrentReadTransactions") <= 64 &&
+            getParam("wiredTigerConcurrentWriteTransactions") <= 64;
+    }, "the tickets were not brought within the controller's bounds");
+
+    var controller = admin.serverStatus().wiredTiger["ticket controller"];
+    assert.eq(1, controller.settings.wiredTigerTicketControllerEnabled, tojson(controller));
+    var read = controller.wiredTigerConcurrentReadTransactions;
+    assert.gte(read.tickets, 8, tojson(controller));
+    assert.lte(read.tickets, 64, tojson(controller));
+    assert.gt(read.adjustments.bounds, 0, tojson(controller));
+
+    MongoRunner.stopMongod(conn.port);
+}
@@ -0,0 +1,44 @@
+// Secondaries apply consecutive inserts into the same collection together. Check that the
+// documents and their index entries all make it to the secondary and that the grouped inserts
+// are reported in serverStatus.
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'applyGroupedInserts', nodes: 2});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getMaster();
+    replTest.awaitSecondaryNodes();
+    var secondary = replTest.liveNodes.slaves[0];
+
+    var primaryColl = primary.getDB("test").grouped;
+    assert.commandWorked(primaryColl.ensureIndex({a: 1}, {unique: true}));
+    assert.commandWorked(primaryColl.ensureIndex({b: 1}));
+
+    // Interleave another collection and some updates so that not all inserts are consecutive.
+    var bulk = primaryColl.initializeOrderedBulkOp();
+    for (var i = 0; i < 5000; i++) {
+        bulk.insert({_id: i, a: i, b: i % 7});
+        if (i % 1000 == 0) {
+            bulk.find({_id: i}).updateOne({$set: {updated: true}});
+        }
+    }
+    assert.writeOK(bulk.execute());
+    assert.writeOK(primary.getDB("test").other.insert({_id: 0}));
+    assert.writeOK(primaryColl.insert({_id: 5000, a: 5000, b: 0}, {writeConcern: {w: 2}}));
+
+    var secondaryColl = secondary.getDB("test").grouped;
+    secondary.setSlaveOk();
+    assert.eq(5001, secondaryColl.find().itcount());
+    assert.eq(5001, secondaryColl.find().hint({a: 1}).itcount());
+    assert.eq(716, secondaryColl.find({b: 0}).hint({b: 1}).itcount());
+    assert.eq(5, secondaryColl.find({updated: true}).itcount());
+    assert.eq(1, secondary.getDB("test").other.find().itcount());
+
+    var grouped = secondary.getDB("admin").serverStatus().metrics.repl.apply.groupedInserts;
+    assert.gt(grouped.groups, 0, tojson(grouped));
+    assert.gt(grouped.ops, grouped.groups, tojson(grouped));
+
+    replTest.stopSet();
+})();
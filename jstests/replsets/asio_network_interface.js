@@ -0,0 +1,40 @@
+// Test a replica set whose replication executor uses the asynchronous network interface
+// (taskExecutorNetworkInterface=asio) for heartbeats, elections and other remote commands.
+(function() {
+    "use strict";
+    var name = "asio_network_interface";
+    var replTest = new ReplSetTest({
+        name: name,
+        nodes: 3,
+        oplogSize: 5,
+        nodeOptions: {setParameter: "taskExecutorNetworkInterface=asio"}
+    });
+    replTest.startSet();
+    replTest.initiate();
+
+    // Heartbeats have to flow for the set to come up and elect a primary at all.
+    var master = replTest.getMaster();
+    assert.writeOK(master.getDB("test").foo.insert({a: 1},
+                                                   {writeConcern: {w: 3, wtimeout: 60000}}));
+
+    replTest.nodes.forEach(function(node) {
+        var status = assert.commandWorked(node.getDB("admin").runCommand({replSetGetStatus: 1}));
+        status.members.forEach(function(member) {
+            assert.contains(member.state, [1, 2], tojson(status));
+        });
+    });
+
+    // A new primary is elected, and learned about by everyone, after the current one steps down.
+    try {
+        master.getDB("admin").runCommand({replSetStepDown: 60, force: true});
+    }
+    catch (e) {
+        // The step down closes the connection.
+    }
+    var newMaster = replTest.getMaster();
+    assert.neq(master.host, newMaster.host);
+    assert.writeOK(newMaster.getDB("test").foo.insert({a: 2},
+                                                      {writeConcern: {w: 3, wtimeout: 60000}}));
+
+    replTest.stopSet();
+})();
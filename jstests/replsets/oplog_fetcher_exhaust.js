@@ -0,0 +1,40 @@
+// With oplogFetcherUsesExhaust, a secondary tails its sync source's oplog with an exhaust cursor.
+// It must keep up with writes, and pick the stream back up after its sync source restarts.
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'oplogFetcherExhaust', nodes: 2,
+                                    nodeOptions: {setParameter: "oplogFetcherUsesExhaust=true"}});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getMaster();
+    replTest.awaitSecondaryNodes();
+    var secondary = replTest.liveNodes.slaves[0];
+    secondary.setSlaveOk();
+
+    function insertDocs(start, n) {
+        var bulk = primary.getDB("test").exhaust.initializeUnorderedBulkOp();
+        for (var i = start; i < start + n; i++) {
+            bulk.insert({_id: i, s: new Array(100).join("x")});
+        }
+        assert.writeOK(bulk.execute({w: 2, wtimeout: 60 * 1000}));
+    }
+
+    // Several batches in a row, then a pause longer than an awaitData wait, then more.
+    insertDocs(0, 20000);
+    sleep(6000);
+    insertDocs(20000, 1000);
+    assert.eq(21000, secondary.getDB("test").exhaust.count());
+
+    // The exhaust connection goes down with the sync source, and is opened again afterwards.
+    replTest.restart(replTest.getNodeId(primary));
+    primary = replTest.getMaster();
+    replTest.awaitSecondaryNodes();
+    secondary = replTest.liveNodes.slaves[0];
+    secondary.setSlaveOk();
+    insertDocs(21000, 1000);
+    assert.eq(22000, secondary.getDB("test").exhaust.count());
+
+    replTest.stopSet();
+})();
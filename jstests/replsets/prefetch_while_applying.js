@@ -0,0 +1,67 @@
+// Secondaries prefetch the documents and index keys of each batch with every storage engine:
+// MMAPv1 before applying the batch, other engines while the writer threads apply it, unless
+// replPrefetchWhileApplying is turned off.
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'prefetchWhileApplying', nodes: 2});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getMaster();
+    replTest.awaitSecondaryNodes();
+    var secondary = replTest.liveNodes.slaves[0];
+    var secondaryAdmin = secondary.getDB("admin");
+    var coll = primary.getDB("test").prefetch;
+    assert.commandWorked(coll.ensureIndex({x: 1}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, x: i});
+    }
+    assert.writeOK(bulk.execute({w: 2}));
+
+    function preloadStats() {
+        return secondaryAdmin.serverStatus().metrics.repl.preload;
+    }
+
+    function updateAndRemove() {
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 500; i++) {
+            bulk.find({_id: i}).updateOne({$inc: {x: 1}});
+            bulk.find({_id: i + 500}).removeOne();
+        }
+        assert.writeOK(bulk.execute({w: 2}));
+    }
+
+    // Every op is either prefetched or skipped, having been applied first
+    var before = preloadStats();
+    updateAndRemove();
+    var after = preloadStats();
+    assert.gt(after.docs.num + after.skippedOps, before.docs.num + before.skippedOps,
+              tojson(after));
+
+    var mmapv1 = secondaryAdmin.serverStatus().storageEngine.name == "mmapv1";
+    if (!mmapv1) {
+        assert.commandWorked(secondaryAdmin.runCommand({setParameter: 1,
+                                                        replPrefetchWhileApplying: false}));
+        before = preloadStats();
+        bulk = coll.initializeUnorderedBulkOp();
+        for (i = 0; i < 500; i++) {
+            bulk.find({_id: i}).updateOne({$inc: {x: 1}});
+        }
+        assert.writeOK(bulk.execute({w: 2}));
+        after = preloadStats();
+        assert.eq(before.docs.num, after.docs.num, tojson(after));
+        assert.eq(before.indexes.num, after.indexes.num, tojson(after));
+    }
+
+    assert.eq(500, secondary.getDB("test").prefetch.count());
+    // the first updates changed x by 1, and those without prefetching by 1 more
+    var expected = mmapv1 ? 1 : 2;
+    secondary.getDB("test").prefetch.find().forEach(function(doc) {
+        assert.eq(doc._id + expected, doc.x, tojson(doc));
+    });
+
+    replTest.stopSet();
+})();
@@ -0,0 +1,49 @@
+// Queries on secondaries read from a snapshot taken between two oplog batches instead of locking
+// batch application out for as long as they run. Each batch of a find should therefore see every
+// document of an insert batch or none of them, with the parameter turned on or off.
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'readFromBatchBoundarySnapshot', nodes: 2});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getMaster();
+    replTest.awaitSecondaryNodes();
+    var secondary = replTest.liveNodes.slaves[0];
+    secondary.setSlaveOk();
+
+    var primaryColl = primary.getDB("test").snapshotReads;
+    var secondaryColl = secondary.getDB("test").snapshotReads;
+    var secondaryAdmin = secondary.getDB("admin");
+
+    function insertDocs(start, n) {
+        var bulk = primaryColl.initializeUnorderedBulkOp();
+        for (var i = start; i < start + n; i++) {
+            bulk.insert({_id: i, x: i});
+        }
+        assert.writeOK(bulk.execute());
+    }
+
+    function checkReads(param) {
+        assert.commandWorked(secondaryAdmin.runCommand(
+            {setParameter: 1, readFromBatchBoundarySnapshotsOnSecondaries: param}));
+
+        insertDocs(0, 1000);
+        for (var i = 1; i < 20; i++) {
+            insertDocs(i * 1000, 1000);
+            var count = secondaryColl.find().batchSize(100000).itcount();
+            assert.gte(count, 0);
+            assert.lte(count, (i + 1) * 1000);
+        }
+        assert.writeOK(primaryColl.insert({_id: -1}, {writeConcern: {w: 2}}));
+        assert.eq(20001, secondaryColl.find().itcount());
+        assert.eq(20001, secondaryColl.find().hint({_id: 1}).itcount());
+        assert.writeOK(primaryColl.remove({}, {writeConcern: {w: 2}}));
+    }
+
+    checkReads(true);
+    checkReads(false);
+
+    replTest.stopSet();
+})();
@@ -0,0 +1,43 @@
+// serverStatus.metrics.repl reports histograms of each stage of the replication pipeline on a
+// secondary: fetching from the sync source, waiting in the buffer, forming and applying batches.
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'replMetricsHistograms', nodes: 2});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getMaster();
+    replTest.awaitSecondaryNodes();
+    var secondary = replTest.liveNodes.slaves[0];
+
+    var bulk = primary.getDB("test").histograms.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({x: i});
+    }
+    assert.writeOK(bulk.execute({w: 2}));
+
+    var repl = secondary.getDB("admin").serverStatus().metrics.repl;
+
+    function checkHistogram(histogram, totalFieldName) {
+        assert(histogram, tojson(repl));
+        assert.gt(histogram.count, 0, tojson(histogram));
+        assert(histogram.hasOwnProperty(totalFieldName), tojson(histogram));
+        assert(Array.isArray(histogram.buckets), tojson(histogram));
+    }
+
+    checkHistogram(repl.network.getmoreMicros, "totalMicros");
+    checkHistogram(repl.network.getmoreBytes, "totalBytes");
+    checkHistogram(repl.buffer.occupancy.count, "totalCount");
+    checkHistogram(repl.buffer.occupancy.sizeBytes, "totalBytes");
+    checkHistogram(repl.buffer.waitMicros, "totalMicros");
+    checkHistogram(repl.apply.batchFormationMicros, "totalMicros");
+    checkHistogram(repl.apply.batchSizeOps, "totalOps");
+    checkHistogram(repl.apply.batchSizeBytes, "totalBytes");
+    checkHistogram(repl.apply.batchMicros, "totalMicros");
+    checkHistogram(repl.apply.fsyncLockWaitMicros, "totalMicros");
+    assert.gte(repl.apply.batchSizeOps.totalOps, 1000, tojson(repl.apply.batchSizeOps));
+    assert(repl.apply.writers[0].applyMicros, tojson(repl.apply.writers));
+
+    replTest.stopSet();
+})();
@@ -0,0 +1,50 @@
+// replWriterThreadCount sets the number of threads which apply oplog batches on secondaries, both
+// at startup and at runtime, and serverStatus reports the work done by each of them.
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'replWriterThreadCount', nodes: 2,
+                                    nodeOptions: {setParameter: "replWriterThreadCount=4"}});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getMaster();
+    replTest.awaitSecondaryNodes();
+    var secondary = replTest.liveNodes.slaves[0];
+    var secondaryAdmin = secondary.getDB("admin");
+
+    function insertDocs(n) {
+        var bulk = primary.getDB("test").writers.initializeUnorderedBulkOp();
+        for (var i = 0; i < n; i++) {
+            bulk.insert({x: i});
+        }
+        assert.writeOK(bulk.execute({w: 2}));
+    }
+
+    function writerStats() {
+        return secondaryAdmin.serverStatus().metrics.repl.apply.writers;
+    }
+
+    insertDocs(1000);
+    var writers = writerStats();
+    assert.eq(4, writers.length, tojson(writers));
+    var ops = writers.reduce(function(sum, writer) { return sum + writer.ops; }, 0);
+    assert.gte(ops, 1000, tojson(writers));
+    var writerPool = secondaryAdmin.serverStatus().metrics.repl.apply.writerPool;
+    assert.gt(writerPool.tasks, 0, tojson(writerPool));
+    assert.eq(0, writerPool.queued, tojson(writerPool));
+
+    // Resizing at runtime takes effect from the next batch on.
+    assert.commandWorked(secondaryAdmin.runCommand({setParameter: 1, replWriterThreadCount: 32}));
+    insertDocs(1000);
+    assert.eq(32, writerStats().length);
+    assert.eq(2000, secondary.getDB("test").writers.count());
+
+    assert.commandFailed(secondaryAdmin.runCommand({setParameter: 1, replWriterThreadCount: 0}));
+    assert.commandFailed(secondaryAdmin.runCommand({setParameter: 1,
+                                                    replWriterThreadCount: 1000}));
+    assert.eq(32, secondaryAdmin.runCommand({getParameter: 1,
+                                             replWriterThreadCount: 1}).replWriterThreadCount);
+
+    replTest.stopSet();
+})();
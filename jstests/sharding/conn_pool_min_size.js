@@ -0,0 +1,49 @@
+// Tests that mongos opens connections to a shard ahead of demand when
+// connPoolMinShardedConnsPerHost is set, and that connection pool stats report connections in use
+// and a histogram of connection creation times.
+(function() {
+    'use strict';
+
+    var kMinConns = 4;
+
+    var st = new ShardingTest({shards: 1,
+                               mongos: 1,
+                               other: {mongosOptions: {
+                                   setParameter: "connPoolMinShardedConnsPerHost=" + kMinConns}}});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var coll = mongos.getCollection("test.conn_pool_min_size");
+    assert.writeOK(coll.insert({x: 1}));
+
+    function getShardPoolStats() {
+        var stats = assert.commandWorked(mongos.adminCommand({shardConnPoolStats: 1}));
+        assert(stats.hasOwnProperty("totalInUse"), tojson(stats));
+        for (var key in stats.hosts) {
+            if (key.indexOf(st.shard0.host) === 0) {
+                return stats.hosts[key];
+            }
+        }
+        return null;
+    }
+
+    // Using the shard once is enough for the pool to be topped up in the background.
+    assert.soon(function() {
+        var hostStats = getShardPoolStats();
+        return hostStats !== null && hostStats.inUse + hostStats.available >= kMinConns;
+    }, "pool for " + st.shard0.host + " was not filled up to " + kMinConns + " connections");
+
+    var hostStats = getShardPoolStats();
+    printjson(hostStats);
+    var histogramTotal = 0;
+    for (var bucket in hostStats.creationTimeMillis) {
+        histogramTotal += hostStats.creationTimeMillis[bucket];
+    }
+    assert.eq(hostStats.created, histogramTotal, tojson(hostStats));
+
+    // The unsharded pool reports the same fields.
+    var stats = assert.commandWorked(mongos.adminCommand({connPoolStats: 1}));
+    assert(stats.hasOwnProperty("totalInUse"), tojson(stats));
+
+    st.stop();
+})();
@@ -0,0 +1,71 @@
+// Newly sharded collections on a hashed key use hash version 1, collections whose hashed index
+// already exists keep its hash version, and both route and migrate documents correctly.
+// @tags : [ hashed ]
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({shards: 2, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var admin = mongos.getDB('admin');
+    var configDB = mongos.getDB('config');
+    var testDB = mongos.getDB('test');
+
+    assert.commandWorked(admin.runCommand({enableSharding: 'test'}));
+    st.ensurePrimaryShard('test', 'shard0000');
+
+    function getHashedIndex(coll) {
+        return coll.getIndexes().filter(function(idx) { return idx.key.x === 'hashed'; })[0];
+    }
+
+    function checkCollection(coll, hashVersion) {
+        for (var i = 0; i < 200; i++) {
+            assert.writeOK(coll.insert({x: i}));
+        }
+        assert.eq(200, coll.find().itcount());
+
+        // Equality on the shard key must target a single shard.
+        for (var i = 0; i < 200; i += 37) {
+            var explain = coll.find({x: i}).explain();
+            assert.eq(1, explain.queryPlanner.winningPlan.shards.length, tojson(explain));
+            assert.eq(1, coll.find({x: i}).itcount());
+        }
+        assert.eq(2, coll.find({x: {$in: [1, 2]}}).itcount());
+
+        // Moving a chunk must move exactly the documents whose hashes fall in it.
+        var chunk = configDB.chunks.find({ns: coll.getFullName()}).sort({min: 1}).next();
+        var otherShard = chunk.shard == 'shard0000' ? 'shard0001' : 'shard0000';
+        assert.commandWorked(admin.runCommand({moveChunk: coll.getFullName(),
+                                               bounds: [chunk.min, chunk.max],
+                                               to: otherShard,
+                                               _waitForDelete: true}));
+        assert.eq(200, coll.find().itcount());
+        for (var i = 0; i < 200; i++) {
+            assert.eq(1, coll.find({x: i}).itcount(), 'x: ' + i);
+        }
+
+        var hash = testDB.runCommand({_hashBSONElement: 7, hashVersion: hashVersion}).out;
+        var owner = configDB.chunks.find({ns: coll.getFullName()}).toArray().filter(
+            function(c) {
+                return bsonWoCompare({x: hash}, c.min) >= 0 && bsonWoCompare({x: hash}, c.max) < 0;
+            })[0].shard;
+        var shardConn = owner == 'shard0000' ? st.shard0 : st.shard1;
+        assert.eq(1, shardConn.getDB('test')[coll.getName()].find({x: 7}).itcount());
+    }
+
+    // A new collection gets hash version 1 for both its index and its shard key.
+    assert.commandWorked(admin.runCommand({shardCollection: 'test.fresh', key: {x: 'hashed'}}));
+    assert.eq(1, configDB.collections.findOne({_id: 'test.fresh'}).hashVersion);
+    assert.eq(1, getHashedIndex(testDB.fresh).hashVersion);
+    checkCollection(testDB.fresh, 1);
+
+    // An existing hashed index keeps hash version 0.
+    assert.commandWorked(testDB.existing.ensureIndex({x: 'hashed'}));
+    assert.commandWorked(admin.runCommand({shardCollection: 'test.existing',
+                                           key: {x: 'hashed'}}));
+    assert.eq(undefined, configDB.collections.findOne({_id: 'test.existing'}).hashVersion);
+    checkCollection(testDB.existing, 0);
+
+    st.stop();
+})();
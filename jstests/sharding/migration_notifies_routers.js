@@ -0,0 +1,55 @@
+//
+// Tests that the donor of a migration pushes the new collection version to the other routers, so
+// that they refresh their routing table without first hitting a stale config error.
+//
+
+var st = new ShardingTest({ shards : 2, mongos : 2 });
+st.stopBalancer();
+
+var admin = st.s0.getDB( "admin" );
+var shards = st.s0.getCollection( "config.shards" ).find().toArray();
+var coll = st.s0.getCollection( "foo.bar" );
+
+assert.commandWorked( admin.runCommand({ enableSharding : coll.getDB() + "" }) );
+printjson( admin.runCommand({ movePrimary : coll.getDB() + "", to : shards[0]._id }) );
+assert.commandWorked( admin.runCommand({ shardCollection : coll + "", key : { _id : 1 } }) );
+assert.commandWorked( admin.runCommand({ split : coll + "", middle : { _id : 0 } }) );
+
+// Load the collection on the second router, and wait for it to have pinged the config servers
+var otherAdmin = st.s1.getDB( "admin" );
+assert.eq( null, st.s1.getCollection( coll + "" ).findOne({ _id : 1 }) );
+assert.soon( function() {
+    return st.s0.getCollection( "config.mongos" ).count() == 2;
+}, "both routers should ping" );
+
+function routerVersion( routerAdmin ) {
+    var res = routerAdmin.runCommand({ getShardVersion : coll + "" });
+    assert.commandWorked( res );
+    return res.version;
+}
+
+var oldVersion = routerVersion( otherAdmin );
+
+assert.commandWorked( admin.runCommand({ moveChunk : coll + "",
+                                         find : { _id : 0 },
+                                         to : shards[1]._id,
+                                         _waitForDelete : true }) );
+
+var newVersion = routerVersion( admin );
+assert.neq( tojson( oldVersion ), tojson( newVersion ) );
+
+// The second router catches up without any request for the collection
+assert.soon( function() {
+    return tojson( routerVersion( otherAdmin ) ) == tojson( newVersion );
+}, "second router should refresh after the migration" );
+
+// Versions it already has, and bad requests, are refused or ignored
+var res = otherAdmin.runCommand({ _noteCollectionVersion : coll + "",
+                                  version : newVersion,
+                                  versionEpoch : otherAdmin.runCommand(
+                                      { getShardVersion : coll + "" }).versionEpoch });
+assert.commandWorked( res );
+assert( !res.refreshed, tojson( res ) );
+assert.commandFailed( otherAdmin.runCommand({ _noteCollectionVersion : coll + "" }) );
+
+st.stop();
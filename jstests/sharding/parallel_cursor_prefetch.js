@@ -0,0 +1,58 @@
+// Tests merging multi-batch results from several shards through mongos, which keeps the next
+// batch from every shard in flight while merging the current ones.
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({name: "parallel_cursor_prefetch", shards: 3, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var coll = mongos.getDB("test").prefetch;
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: "test"}));
+    st.ensurePrimaryShard("test", "shard0000");
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(),
+                                              key: {_id: 1}}));
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {_id: 300}}));
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {_id: 600}}));
+    assert.commandWorked(mongos.adminCommand({moveChunk: coll.getFullName(),
+                                              find: {_id: 400},
+                                              to: "shard0001"}));
+    assert.commandWorked(mongos.adminCommand({moveChunk: coll.getFullName(),
+                                              find: {_id: 700},
+                                              to: "shard0002"}));
+
+    var N = 900;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < N; i++) {
+        bulk.insert({_id: i, x: N - i});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Unsorted and sorted merges, with batch sizes small enough to need many getMores per shard.
+    [1, 2, 7, 50].forEach(function(batchSize) {
+        assert.eq(N, coll.find().batchSize(batchSize).itcount());
+
+        var results = coll.find().sort({x: 1}).batchSize(batchSize).toArray();
+        assert.eq(N, results.length);
+        for (var i = 0; i < N; i++) {
+            assert.eq(i + 1, results[i].x, "batchSize " + batchSize);
+        }
+    });
+
+    // Shard cursors abandoned part way through, while getMores on them are outstanding, are
+    // cleaned up on every shard once mongos has returned the limit.
+    for (var i = 0; i < 5; i++) {
+        var results = coll.find().sort({x: -1}).batchSize(5).limit(20).toArray();
+        assert.eq(20, results.length);
+        assert.eq(N, results[0].x);
+    }
+
+    assert.soon(function() {
+        return [st.shard0, st.shard1, st.shard2].every(function(shard) {
+            return shard.getDB("admin").serverStatus().metrics.cursor.open.total == 0;
+        });
+    }, "cursors left open on the shards");
+
+    st.stop();
+})();
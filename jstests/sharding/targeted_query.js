@@ -0,0 +1,53 @@
+//
+// Tests queries which target a single shard, which mongos forwards to the shard as they are,
+// including their getMores, skips and limits, and after the chunk they target has moved.
+//
+
+var st = new ShardingTest({ shards : 2, mongos : 2 });
+st.stopBalancer();
+
+var admin = st.s0.getDB( "admin" );
+var shards = st.s0.getCollection( "config.shards" ).find().toArray();
+var coll = st.s0.getCollection( "foo.bar" );
+var unsharded = st.s0.getCollection( "foo.unsharded" );
+
+assert.commandWorked( admin.runCommand({ enableSharding : coll.getDB() + "" }) );
+printjson( admin.runCommand({ movePrimary : coll.getDB() + "", to : shards[0]._id }) );
+assert.commandWorked( admin.runCommand({ shardCollection : coll + "", key : { a : 1 } }) );
+assert.commandWorked( admin.runCommand({ split : coll + "", middle : { a : 5 } }) );
+assert.commandWorked( admin.runCommand({ moveChunk : coll + "",
+                                         find : { a : 5 },
+                                         to : shards[1]._id,
+                                         _waitForDelete : true }) );
+
+var bulk = coll.initializeUnorderedBulkOp();
+for ( var i = 0; i < 1000; i++ ) {
+    bulk.insert({ _id : i, a : i % 10 });
+}
+assert.writeOK( bulk.execute() );
+assert.writeOK( unsharded.insert({ _id : 1 }) );
+
+// Both sides of the split, with getMores
+for ( var a = 0; a < 10; a++ ) {
+    assert.eq( 100, coll.find({ a : a }).batchSize( 7 ).itcount() );
+}
+
+assert.eq( 5, coll.find({ a : 3 }).sort({ _id : 1 }).skip( 10 ).limit( 5 ).itcount() );
+assert.eq( 107, coll.find({ a : 7 }, { _id : 1 }).sort({ _id : 1 }).skip( 10 ).next()._id );
+assert.eq( 1, unsharded.find({ _id : 1 }).itcount() );
+
+// Other queries still go to every shard
+assert.eq( 1000, coll.find().itcount() );
+assert.eq( 300, coll.find({ a : { $in : [ 2, 5, 8 ] } }).itcount() );
+
+// Move a chunk through the other router, so that the first one targets the wrong shard
+assert.commandWorked( st.s1.getDB( "admin" ).runCommand({ moveChunk : coll + "",
+                                                          find : { a : 0 },
+                                                          to : shards[1]._id,
+                                                          _waitForDelete : true }) );
+
+for ( var a = 0; a < 10; a++ ) {
+    assert.eq( 100, coll.find({ a : a }).batchSize( 7 ).itcount() );
+}
+
+st.stop();
@@ -0,0 +1,85 @@
+// mongos traces one in traceSampleRate of the operations it routes. Each node records the spans of
+// a traced operation, which getTraceSpans returns, and the spans a shard records for a request
+// from mongos are children of the mongos span that sent it.
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({shards: 2, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var admin = mongos.getDB('admin');
+    var coll = mongos.getCollection('test.trace_spans');
+
+    assert.commandWorked(admin.runCommand({enableSharding: 'test'}));
+    st.ensurePrimaryShard('test', 'shard0000');
+    assert.commandWorked(admin.runCommand({shardCollection: coll.getFullName(), key: {x: 1}}));
+    assert.commandWorked(admin.runCommand({split: coll.getFullName(), middle: {x: 0}}));
+    assert.commandWorked(admin.runCommand({moveChunk: coll.getFullName(),
+                                           find: {x: 0},
+                                           to: 'shard0001',
+                                           _waitForDelete: true}));
+    for (var i = -5; i < 5; i++) {
+        assert.writeOK(coll.insert({x: i}));
+    }
+
+    function getSpans(conn, traceId) {
+        var res = assert.commandWorked(conn.getDB('admin').runCommand({getTraceSpans: 1,
+                                                                      traceId: traceId}));
+        assert.gte(res.numRecorded, res.spans.length, tojson(res));
+        return res.spans;
+    }
+
+    // Nothing is traced by default
+    assert.eq(2, coll.find({x: {$in: [-1, 1]}}).itcount());
+    var untraced = getSpans(mongos, 0).filter(function(span) {
+        return span.name == 'mongos' && span.ns == coll.getFullName();
+    });
+    assert.eq(0, untraced.length, tojson(untraced));
+
+    assert.commandWorked(admin.runCommand({setParameter: 1, traceSampleRate: 1}));
+    assert.eq(2, coll.find({x: {$in: [-1, 1]}}).itcount());
+    assert.writeOK(coll.insert([{x: -10}, {x: 10}], {ordered: false}));
+    assert.commandWorked(admin.runCommand({setParameter: 1, traceSampleRate: 0}));
+
+    // Checks the trace of the mongos operation on "ns", which sent a request to each shard.
+    function checkTrace(op, ns) {
+        var roots = getSpans(mongos, 0).filter(function(span) {
+            return span.name == 'mongos' && span.op == op && span.ns == ns;
+        });
+        assert.eq(1, roots.length, tojson(roots));
+        var root = roots[0];
+        assert.eq(0, root.parent, tojson(root));
+
+        var mongosSpans = getSpans(mongos, root.trace);
+        var targeting = mongosSpans.filter(function(span) { return span.name == 'targeting'; });
+        assert.gt(targeting.length, 0, tojson(mongosSpans));
+        targeting.forEach(function(span) { assert.eq(root.span, span.parent, tojson(span)); });
+
+        var requests = mongosSpans.filter(function(span) { return span.name == 'shardRequest'; });
+        assert.eq(2, requests.length, tojson(mongosSpans));
+        var requestIds = requests.map(function(span) { return span.span; });
+        requests.forEach(function(span) {
+            assert.eq(root.span, span.parent, tojson(span));
+            assert.lte(span.micros, root.micros, tojson(span));
+        });
+
+        [st.shard0, st.shard1].forEach(function(shard) {
+            var shardSpans = getSpans(shard, root.trace).filter(function(span) {
+                return requestIds.indexOf(span.parent) != -1;
+            });
+            assert.eq(1, shardSpans.length, tojson(shardSpans));
+            assert.eq('mongod', shardSpans[0].name, tojson(shardSpans));
+            assert.eq(shard.host.split(':')[1], shardSpans[0].host.split(':')[1],
+                      tojson(shardSpans));
+        });
+    }
+
+    checkTrace('query', coll.getFullName());
+    checkTrace('query', 'test.$cmd');
+
+    assert.commandFailedWithCode(admin.runCommand({getTraceSpans: 1, traceId: 'x'}),
+                                 ErrorCodes.TypeMismatch);
+
+    st.stop();
+})();
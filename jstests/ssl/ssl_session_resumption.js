@@ -0,0 +1,38 @@
+// Test that connections from the same client resume their TLS session instead of performing a
+// full handshake each time, and that serverStatus reports both kinds of handshake.
+(function() {
+    'use strict';
+
+    var SERVER_CERT = "jstests/libs/server.pem";
+    var CA_CERT = "jstests/libs/ca.pem";
+
+    var mongod = MongoRunner.runMongod({sslMode: "requireSSL",
+                                        sslPEMKeyFile: SERVER_CERT,
+                                        sslCAFile: CA_CERT});
+    assert.neq(null, mongod, "mongod failed to start with requireSSL");
+
+    function getHandshakes() {
+        var status = assert.commandWorked(mongod.getDB("admin").runCommand({serverStatus: 1}));
+        assert(status.security.hasOwnProperty("SSLHandshakes"), tojson(status.security));
+        return status.security.SSLHandshakes;
+    }
+
+    var before = getHandshakes();
+
+    var kNumConns = 10;
+    for (var i = 0; i < kNumConns; i++) {
+        var conn = new Mongo(mongod.host);
+        assert.commandWorked(conn.getDB("admin").runCommand({ping: 1}));
+    }
+
+    var after = getHandshakes();
+    printjson(after);
+    assert.eq(kNumConns,
+              (after.serverFull - before.serverFull) +
+                  (after.serverResumed - before.serverResumed),
+              tojson(after));
+    assert.gt(after.serverResumed, before.serverResumed,
+              "no connection resumed an earlier session: " + tojson(after));
+
+    MongoRunner.stopMongod(mongod);
+})();
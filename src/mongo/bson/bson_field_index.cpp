@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_index.h"
+
+#include <cstring>
+
+namespace mongo {
+
+    namespace {
+
+        // 32 bit FNV-1a.
+        uint32_t hashFieldName(const char* name, size_t size) {
+            uint32_t hash = 2166136261U;
+            for (size_t i = 0; i < size; i++) {
+                hash ^= static_cast<unsigned char>(name[i]);
+                hash *= 16777619U;
+            }
+            return hash;
+        }
+
+    }  // namespace
+
+    void BSONFieldIndex::reset(const BSONObj& obj) {
+        _obj = obj;
+        _state = kScanning;
+        _lookups = 0;
+        _slots.clear();
+    }
+
+    void BSONFieldIndex::_build() const {
+        const int numFields = _obj.nFields();
+        if (numFields < kMinIndexedFields) {
+            _state = kTooSmall;
+            return;
+        }
+
+        // Keep the table at most half full so that probe sequences stay short.
+        size_t numSlots = 1;
+        while (numSlots < 2 * static_cast<size_t>(numFields)) {
+            numSlots *= 2;
+        }
+        _slots.assign(numSlots, Slot());
+
+        const size_t mask = numSlots - 1;
+        BSONObjIterator it(_obj);
+        while (it.more()) {
+            const BSONElement e = it.next();
+            const uint32_t hash = hashFieldName(e.fieldName(), e.fieldNameSize() - 1);
+            for (size_t i = hash & mask;; i = (i + 1) & mask) {
+                Slot& slot = _slots[i];
+                if (slot.offset == 0) {
+                    slot.hash = hash;
+                    slot.offset = e.rawdata() - _obj.objdata();
+                    break;
+                }
+                if (slot.hash == hash &&
+                    std::strcmp(_obj.objdata() + slot.offset + 1, e.fieldName()) == 0) {
+                    // A duplicate field name. getField() finds the first one, so keep that.
+                    break;
+                }
+            }
+        }
+
+        _state = kBuilt;
+    }
+
+    BSONElement BSONFieldIndex::getField(StringData name) const {
+        if (_state == kScanning && ++_lookups > kScannedLookups) {
+            _build();
+        }
+
+        if (_state != kBuilt) {
+            return _obj.getField(name);
+        }
+
+        const uint32_t hash = hashFieldName(name.rawData(), name.size());
+        const size_t mask = _slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& slot = _slots[i];
+            if (slot.offset == 0) {
+                return BSONElement();
+            }
+            if (slot.hash == hash) {
+                const BSONElement e(_obj.objdata() + slot.offset);
+                if (name == e.fieldName()) {
+                    return e;
+                }
+            }
+        }
+    }
+
+    BSONElement BSONFieldIndex::getFieldDotted(StringData path) const {
+        BSONElement e = getField(path);
+        if (e.eoo()) {
+            size_t dotOffset = path.find('.');
+            if (dotOffset != std::string::npos) {
+                BSONElement left = getField(path.substr(0, dotOffset));
+                if (left.type() != Object && left.type() != Array) {
+                    return BSONElement();
+                }
+                BSONObj sub = left.embeddedObject();
+                return sub.isEmpty() ? BSONElement()
+                                     : sub.getFieldDotted(path.substr(dotOffset + 1));
+            }
+        }
+
+        return e;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+    /**
+     * Speeds up repeated field lookups on one BSONObj.
+     *
+     * BSONObj::getField() scans the elements of the object, so code looking up many fields of a
+     * wide document in turn does work proportional to the number of lookups times the number of
+     * fields. A BSONFieldIndex wraps the object and, once it has seen enough lookups to pay for
+     * it, builds a small open-addressed hash table from top level field names to element
+     * offsets which later lookups probe instead.
+     *
+     * Objects with few fields are always scanned, as a scan is as cheap as probing the table.
+     * The wrapped object must stay alive, and the index is not thread safe.
+     */
+    class BSONFieldIndex {
+        MONGO_DISALLOW_COPYING(BSONFieldIndex);
+    public:
+        // Lookups done by scanning before the table is built.
+        static const int kScannedLookups = 2;
+
+        // Objects with fewer fields than this never get a table.
+        static const int kMinIndexedFields = 16;
+
+        BSONFieldIndex() = default;
+        explicit BSONFieldIndex(const BSONObj& obj) : _obj(obj) {}
+
+        /**
+         * Switches to indexing 'obj', keeping the table's memory for reuse.
+         */
+        void reset(const BSONObj& obj);
+
+        const BSONObj& obj() const { return _obj; }
+
+        /**
+         * Same as obj().getField(name): the first element named 'name', or EOO.
+         */
+        BSONElement getField(StringData name) const;
+
+        /**
+         * Same as obj().getFieldDotted(path). Uses the table for the first component only.
+         */
+        BSONElement getFieldDotted(StringData path) const;
+
+        /**
+         * Whether the table has been built, for testing.
+         */
+        bool isBuilt() const { return _state == kBuilt; }
+
+    private:
+        enum State { kScanning, kBuilt, kTooSmall };
+
+        struct Slot {
+            uint32_t hash;
+            uint32_t offset; // from the start of the object, 0 for an empty slot
+        };
+
+        void _build() const;
+
+        BSONObj _obj;
+        mutable State _state = kScanning;
+        mutable int _lookups = 0;
+        mutable std::vector<Slot> _slots; // the size is a power of two
+    };
+
+}  // namespace mongo
@@ -0,0 +1,128 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_index.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+    using namespace mongo;
+
+    BSONObj makeWideObj(int numFields) {
+        BSONObjBuilder b;
+        for (int i = 0; i < numFields; i++) {
+            b.append(std::string(str::stream() << "f" << i), i);
+        }
+        return b.obj();
+    }
+
+    TEST(BSONFieldIndex, SmallObjectIsNeverIndexed) {
+        BSONObj obj = fromjson("{a: 1, b: 2, c: {d: 3}}");
+        BSONFieldIndex index(obj);
+        for (int i = 0; i < 10; i++) {
+            ASSERT_EQUALS(2, index.getField("b").numberInt());
+            ASSERT_EQUALS(3, index.getFieldDotted("c.d").numberInt());
+            ASSERT(index.getField("x").eoo());
+        }
+        ASSERT_FALSE(index.isBuilt());
+    }
+
+    TEST(BSONFieldIndex, WideObjectIsIndexedAfterSomeLookups) {
+        BSONObj obj = makeWideObj(200);
+        BSONFieldIndex index(obj);
+        for (int i = 0; i < BSONFieldIndex::kScannedLookups; i++) {
+            ASSERT_EQUALS(i, index.getField(std::string(str::stream() << "f" << i)).numberInt());
+            ASSERT_FALSE(index.isBuilt());
+        }
+
+        for (int i = 0; i < 200; i++) {
+            BSONElement e = index.getField(std::string(str::stream() << "f" << i));
+            ASSERT_EQUALS(i, e.numberInt());
+            ASSERT_EQUALS(obj.getField(e.fieldName()).rawdata(), e.rawdata());
+        }
+        ASSERT(index.isBuilt());
+
+        ASSERT(index.getField("f200").eoo());
+        ASSERT(index.getField("").eoo());
+        ASSERT(index.getField("f1.x").eoo());
+        ASSERT(index.getFieldDotted("f1.x").eoo());
+    }
+
+    TEST(BSONFieldIndex, DuplicateFieldNamesFindTheFirst) {
+        BSONObjBuilder b;
+        b.appendElements(makeWideObj(20));
+        b.append("dup", 1);
+        b.append("dup", 2);
+        BSONObj obj = b.obj();
+
+        BSONFieldIndex index(obj);
+        for (int i = 0; i < 5; i++) {
+            ASSERT_EQUALS(1, index.getField("dup").numberInt());
+        }
+        ASSERT(index.isBuilt());
+    }
+
+    TEST(BSONFieldIndex, GetFieldDottedMatchesBSONObj) {
+        BSONObjBuilder b;
+        b.appendElements(makeWideObj(20));
+        b.append("a", BSON("b" << BSON("c" << 5)));
+        b.append("arr", BSON_ARRAY(10 << 11));
+        b.append("x.y", 7);
+        BSONObj obj = b.obj();
+
+        BSONFieldIndex index(obj);
+        const char* paths[] = {"a.b.c", "a.b", "arr.1", "x.y", "a.z", "f3.y", "nope.x", "f19"};
+        for (int round = 0; round < 3; round++) {
+            for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+                BSONElement expected = obj.getFieldDotted(paths[i]);
+                BSONElement actual = index.getFieldDotted(paths[i]);
+                ASSERT_EQUALS(expected.rawdata(), actual.rawdata());
+            }
+        }
+        ASSERT(index.isBuilt());
+    }
+
+    TEST(BSONFieldIndex, Reset) {
+        BSONObj wide = makeWideObj(50);
+        BSONFieldIndex index(wide);
+        for (int i = 0; i < 5; i++) {
+            index.getField("f1");
+        }
+        ASSERT(index.isBuilt());
+
+        BSONObj other = fromjson("{f1: 'other'}");
+        index.reset(other);
+        ASSERT_FALSE(index.isBuilt());
+        ASSERT_EQUALS("other", index.getField("f1").str());
+    }
+
+}  // namespace
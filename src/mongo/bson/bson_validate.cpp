@@ -28,8 +28,12 @@
  */
 
 #include <cstring>
-#include <deque>
 #include <limits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_validate.h"
@@ -54,6 +58,41 @@ namespace mongo {
             return Status(ErrorCodes::InvalidBSON, baseMsg);
         }
 
+        /**
+         * Returns a pointer to the first NUL byte in [p, end), or NULL if there is none.
+         *
+         * Field names are usually just a few bytes long, so the per-call setup of memchr dominates
+         * the scan itself. Instead this looks at 16 bytes at a time with SSE2 where available and
+         * 8 bytes at a time otherwise, never reading at or past 'end'.
+         */
+        const char* findNul(const char* p, const char* end) {
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            while (end - p >= 16) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+                if (mask)
+                    return p + __builtin_ctz(mask);
+                p += 16;
+            }
+#endif
+            const uint64_t kLows = 0x0101010101010101ULL;
+            const uint64_t kHighs = 0x8080808080808080ULL;
+            while (end - p >= 8) {
+                uint64_t word;
+                std::memcpy(&word, p, sizeof(word));
+                // Nonzero iff some byte of 'word' is zero.
+                if ((word - kLows) & ~word & kHighs)
+                    break;
+                p += 8;
+            }
+            for (; p < end; ++p) {
+                if (*p == '\0')
+                    return p;
+            }
+            return NULL;
+        }
+
         class Buffer {
         public:
             Buffer( const char* buffer, uint64_t maxLength )
@@ -72,10 +111,12 @@ namespace mongo {
             }
 
             Status readCString( StringData* out ) {
-                const void* x = memchr( _buffer + _position, 0, _maxLength - _position );
+                if ( _position >= _maxLength )
+                    return makeError("no end of c-string", _idElem);
+                const char* x = findNul( _buffer + _position, _buffer + _maxLength );
                 if ( !x )
                     return makeError("no end of c-string", _idElem);
-                uint64_t len = static_cast<uint64_t>( static_cast<const char*>(x) - ( _buffer + _position ) );
+                uint64_t len = static_cast<uint64_t>( x - ( _buffer + _position ) );
 
                 StringData data( _buffer + _position, len );
                 _position += len + 1;
@@ -173,6 +214,43 @@ namespace mongo {
             int _startPosition;
         };
 
+        /**
+         * Stack of the objects currently being validated. Real documents rarely nest more than a
+         * few levels deep, so the first kInlineFrames frames live inside the stack itself and
+         * validating a document does not touch the heap.
+         */
+        class ValidationFrameStack {
+        public:
+            ValidationFrameStack() : _size(0) {}
+
+            void push() {
+                if (_size >= kInlineFrames)
+                    _overflow.push_back(ValidationObjectFrame());
+                ++_size;
+            }
+
+            void pop() {
+                if (_size > kInlineFrames)
+                    _overflow.pop_back();
+                --_size;
+            }
+
+            /** Invalidated by push() and pop(). */
+            ValidationObjectFrame& back() {
+                return _size > kInlineFrames ? _overflow.back() : _inline[_size - 1];
+            }
+
+            size_t size() const { return _size; }
+            bool empty() const { return _size == 0; }
+
+        private:
+            static const size_t kInlineFrames = 32;
+
+            ValidationObjectFrame _inline[kInlineFrames];
+            std::vector<ValidationObjectFrame> _overflow;
+            size_t _size;
+        };
+
         /**
          * WARNING: only pass in a non-EOO idElem if it has been fully validated already!
          */
@@ -275,7 +353,7 @@ namespace mongo {
         }
 
         Status validateBSONIterative(Buffer* buffer) {
-            std::deque<ValidationObjectFrame> frames;
+            ValidationFrameStack frames;
             ValidationObjectFrame* curr = NULL;
             ValidationState::State state = ValidationState::BeginObj;
 
@@ -285,7 +363,7 @@ namespace mongo {
             while (state != ValidationState::Done) {
                 switch (state) {
                 case ValidationState::BeginObj:
-                    frames.push_back(ValidationObjectFrame());
+                    frames.push();
                     curr = &frames.back();
                     curr->setStartPosition(buffer->position());
                     curr->setIsCodeWithScope(false);
@@ -325,7 +403,7 @@ namespace mongo {
                     if ( actualLength != curr->expectedSize ) {
                         return makeError("bson length doesn't match what we found", idElem);
                     }
-                    frames.pop_back();
+                    frames.pop();
                     if (frames.empty()) {
                         state = ValidationState::Done;
                     }
@@ -339,7 +417,7 @@ namespace mongo {
                     break;
                 }
                 case ValidationState::BeginCodeWScope: {
-                    frames.push_back(ValidationObjectFrame());
+                    frames.push();
                     curr = &frames.back();
                     curr->setStartPosition(buffer->position());
                     curr->setIsCodeWithScope(true);
@@ -357,7 +435,7 @@ namespace mongo {
                         return makeError("bson length for CodeWScope doesn't match what we found",
                                          idElem);
                     }
-                    frames.pop_back();
+                    frames.pop();
                     if (frames.empty())
                         return makeError("unnested CodeWScope", idElem);
                     curr = &frames.back();
@@ -307,4 +307,35 @@ namespace {
         ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize()));
     }
 
+    TEST(BSONValidateFast, LongFieldNames) {
+        // Field names straddling the 8 and 16 byte blocks the NUL scan looks at.
+        for (size_t len = 1; len < 70; ++len) {
+            const std::string name(len, 'f');
+            BSONObj x = BSON(name << 1 << "y" << BSON(name << "z"));
+            ASSERT_OK(validateBSON(x.objdata(), x.objsize()));
+            for (int size = 5; size < x.objsize(); ++size) {
+                ASSERT_NOT_OK(validateBSON(x.objdata(), size));
+            }
+        }
+    }
+
+    TEST(BSONValidateFast, NoEndOfFieldName) {
+        BufBuilder bb;
+        bb.appendNum(0);
+        bb.appendChar(NumberInt);
+        bb.appendStr(std::string(40, 'x'), /*withNUL*/false);
+        DataView(bb.buf()).write(tagLittleEndian(bb.len()));
+        ASSERT_NOT_OK(validateBSON(bb.buf(), bb.len()));
+    }
+
+    TEST(BSONValidateFast, DeeplyNested) {
+        // Deeper than the frames the validator keeps inline.
+        BSONObj x = BSON("leaf" << 1);
+        for (int i = 0; i < 100; ++i) {
+            x = BSON("a" << x << "b" << i);
+        }
+        ASSERT_OK(validateBSON(x.objdata(), x.objsize()));
+        ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize() - 1));
+    }
+
 }
@@ -525,7 +525,8 @@ namespace mongo {
         BSONObjIterator begin() const;
         BSONObjIterator end() const;
 
-        void appendSelfToBufBuilder(BufBuilder& b) const {
+        template <typename Builder>
+        void appendSelfToBufBuilder(Builder& b) const {
             verify( objsize() );
             b.appendBuf(objdata(), objsize());
         }
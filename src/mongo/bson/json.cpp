@@ -103,6 +103,35 @@ namespace mongo {
 
     Status JParse::value(StringData fieldName, BSONObjBuilder& builder) {
         MONGO_JSON_DEBUG("fieldName: " << fieldName);
+
+        // Strings and numbers are most values, and none of the keywords tried below begin like
+        // them, so recognize them by their first character before trying the keywords one by
+        // one.
+        const char* next = _input;
+        while (next < _input_end && isspace(*reinterpret_cast<const unsigned char*>(next))) {
+            ++next;
+        }
+        if (next < _input_end) {
+            if (*next == '"' || *next == '\'') {
+                StringData unescaped;
+                if (readUnescapedQuotedString(&unescaped)) {
+                    builder.append(fieldName, unescaped);
+                    return Status::OK();
+                }
+            }
+            else if (isdigit(static_cast<unsigned char>(*next)) ||
+                     (*next == '-' && next + 1 < _input_end &&
+                      isdigit(static_cast<unsigned char>(next[1])))) {
+                if (readSimpleInteger(fieldName, builder)) {
+                    if (_input >= _input_end) {
+                        return parseError("Trailing number at end of input");
+                    }
+                    return Status::OK();
+                }
+                return number(fieldName, builder);
+            }
+        }
+
         if (peekToken(LBRACE)) {
             Status ret = object(fieldName, builder);
             if (ret != Status::OK()) {
@@ -337,9 +366,11 @@ namespace mongo {
             if (valueRet != Status::OK()) {
                 return valueRet;
             }
+            // Reused for every field so that its memory is only allocated once per object.
+            std::string fieldName;
+            fieldName.reserve(FIELD_RESERVE_SIZE);
             while (readToken(COMMA)) {
-                std::string fieldName;
-                fieldName.reserve(FIELD_RESERVE_SIZE);
+                fieldName.clear();
                 Status fieldRet = field(&fieldName);
                 if (fieldRet != Status::OK()) {
                     return fieldRet;
@@ -1025,6 +1056,46 @@ namespace mongo {
         return Status::OK();
     }
 
+    bool JParse::readSimpleInteger(StringData fieldName, BSONObjBuilder& builder) {
+        const char* q = _input;
+        while (q < _input_end && isspace(*reinterpret_cast<const unsigned char*>(q))) {
+            ++q;
+        }
+        const bool negative = q < _input_end && *q == '-';
+        if (negative) {
+            ++q;
+        }
+
+        const char* const digits = q;
+        long long value = 0;
+        while (q < _input_end && isdigit(static_cast<unsigned char>(*q))) {
+            value = value * 10 + (*q - '0');
+            ++q;
+        }
+        if (q == digits || q - digits > 18) {
+            return false;
+        }
+        // Anything strtod would take as more of the number: a fraction, an exponent, more
+        // digits of a hex number.
+        if (q < _input_end && (*q == '.' || *q == 'e' || *q == 'E' || *q == 'x' || *q == 'X')) {
+            return false;
+        }
+
+        if (negative) {
+            value = -value;
+        }
+        if (value == static_cast<int>(value)) {
+            MONGO_JSON_DEBUG("Type: 32 bit int");
+            builder.append(fieldName, static_cast<int>(value));
+        }
+        else {
+            MONGO_JSON_DEBUG("Type: 64 bit int");
+            builder.append(fieldName, value);
+        }
+        _input = q;
+        return true;
+    }
+
     Status JParse::field(std::string* result) {
         MONGO_JSON_DEBUG("");
         if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
@@ -1047,7 +1118,22 @@ namespace mongo {
             if (!match(*_input, ALPHA "_$")) {
                 return parseError("First character in field must be [A-Za-z$_]");
             }
-            return chars(result, "", ALPHA DIGIT "_$");
+            // Same as chars(result, "", ALPHA DIGIT "_$"), without a strchr per character.
+            const char* q = _input;
+            while (q < _input_end && (isalnum(static_cast<unsigned char>(*q)) || *q == '_' ||
+                                       *q == '$')) {
+                ++q;
+            }
+            if (q >= _input_end) {
+                return parseError("Unexpected end of input");
+            }
+            if (*q == '\0') {
+                // match() takes the terminating NUL of the allowed set to be in it.
+                return parseError("Invalid control character");
+            }
+            result->append(_input, q - _input);
+            _input = q;
+            return Status::OK();
         }
     }
 
@@ -1077,6 +1163,30 @@ namespace mongo {
         return Status::OK();
     }
 
+    bool JParse::readUnescapedQuotedString(StringData* result) {
+        const char* q = _input;
+        while (q < _input_end && isspace(*reinterpret_cast<const unsigned char*>(q))) {
+            ++q;
+        }
+        if (q >= _input_end || (*q != '"' && *q != '\'')) {
+            return false;
+        }
+
+        const char quote = *q++;
+        const char* const start = q;
+        while (q < _input_end && *q != quote && *q != '\\' &&
+               static_cast<unsigned char>(*q) >= 0x20) {
+            ++q;
+        }
+        if (q >= _input_end || *q != quote) {
+            return false;
+        }
+
+        *result = StringData(start, q - start);
+        _input = q + 1;
+        return true;
+    }
+
     /*
      * terminalSet are characters that signal end of string (e.g.) [ :\0]
      * allowedSet are the characters that are allowed, if this is set
@@ -1090,6 +1200,19 @@ namespace mongo {
         const char* q = _input;
         while (q < _input_end && !match(*q, terminalSet)) {
             MONGO_JSON_DEBUG("q: " << q);
+            if (allowedSet == NULL && terminalSet[0] != '\0' && terminalSet[1] == '\0') {
+                // Copy the run of plain characters up to the terminator, the next escape
+                // sequence or control character at once.
+                const char* run = q;
+                while (q < _input_end && *q != terminalSet[0] && *q != '\\' &&
+                       static_cast<unsigned char>(*q) >= 0x20) {
+                    ++q;
+                }
+                if (q != run) {
+                    result->append(run, q - run);
+                    continue;
+                }
+            }
             if (allowedSet != NULL) {
                 if (!match(*q, allowedSet)) {
                     _input = q;
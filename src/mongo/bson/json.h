@@ -369,6 +369,20 @@ namespace mongo {
              */
             Status quotedString(std::string* result);
 
+            /**
+             * If the next token is a quoted string without escape sequences, points 'result' at
+             * its characters in the input, consumes it and returns true. Otherwise returns false
+             * without consuming anything, and quotedString() must be used instead.
+             */
+            bool readUnescapedQuotedString(StringData* result);
+
+            /**
+             * Parses a value that is a plain decimal integer of at most 18 digits, which covers
+             * most numbers in practice, without the two strtod/strtoll passes number() needs.
+             * Returns false without consuming anything if the next token is anything else.
+             */
+            bool readSimpleInteger(StringData fieldName, BSONObjBuilder& builder);
+
             /*
              * CHARS :
              *     CHAR
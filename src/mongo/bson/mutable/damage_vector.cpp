@@ -0,0 +1,208 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/mutable/damage_vector.h"
+
+#include <cstring>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace mutablebson {
+
+namespace {
+
+    // Accumulates the damage events of computeDamages, merging events that are adjacent in both
+    // the target and the source.
+    class DamageBuilder {
+    public:
+        DamageBuilder(const char* fromBase, const char* toBase, DamageVector* damages)
+            : _fromBase(fromBase)
+            , _toBase(toBase)
+            , _damages(damages) {}
+
+        // Records that the 'fromSize' bytes at 'from' are replaced by the 'toSize' bytes at 'to'.
+        void replace(const char* from, size_t fromSize, const char* to, size_t toSize) {
+            if (fromSize == 0 && toSize == 0)
+                return;
+
+            const DamageEvent::OffsetSizeType targetOffset = from - _fromBase;
+            const DamageEvent::OffsetSizeType sourceOffset = to - _toBase;
+            const int32_t growth = static_cast<int32_t>(toSize) - static_cast<int32_t>(fromSize);
+
+            if (!_damages->empty()) {
+                DamageEvent& last = _damages->back();
+                if ((last.targetOffset + last.targetSize() == targetOffset) &&
+                    (last.sourceOffset + last.size == sourceOffset)) {
+                    last.size += toSize;
+                    last.growth += growth;
+                    return;
+                }
+            }
+
+            _damages->push_back(DamageEvent());
+            _damages->back().targetOffset = targetOffset;
+            _damages->back().sourceOffset = sourceOffset;
+            _damages->back().size = toSize;
+            _damages->back().growth = growth;
+        }
+
+    private:
+        const char* const _fromBase;
+        const char* const _toBase;
+        DamageVector* const _damages;
+    };
+
+    bool isNamed(const char* element, const char* end, StringData fieldName) {
+        return (element < end) && (BSONElement(element).fieldNameStringData() == fieldName);
+    }
+
+    void diffObjects(const BSONObj& from, const BSONObj& to, DamageBuilder* builder) {
+        if ((from.objsize() == to.objsize()) &&
+            (std::memcmp(from.objdata(), to.objdata(), from.objsize()) == 0))
+            return;
+
+        if (from.objsize() != to.objsize())
+            builder->replace(from.objdata(), sizeof(int32_t), to.objdata(), sizeof(int32_t));
+
+        // Walk both element lists up to, but not including, their EOO bytes, which match.
+        const char* f = from.objdata() + sizeof(int32_t);
+        const char* const fEnd = from.objdata() + from.objsize() - 1;
+        const char* t = to.objdata() + sizeof(int32_t);
+        const char* const tEnd = to.objdata() + to.objsize() - 1;
+
+        while ((f < fEnd) && (t < tEnd)) {
+            const BSONElement fromElt(f);
+            const BSONElement toElt(t);
+            const int fromSize = fromElt.size();
+            const int toSize = toElt.size();
+
+            if ((fromSize == toSize) && (std::memcmp(f, t, fromSize) == 0)) {
+                f += fromSize;
+                t += toSize;
+                continue;
+            }
+
+            const StringData fromName = fromElt.fieldNameStringData();
+            const StringData toName = toElt.fieldNameStringData();
+
+            if (fromName == toName) {
+                if ((fromElt.type() == toElt.type()) &&
+                    ((fromElt.type() == Object) || (fromElt.type() == Array))) {
+                    diffObjects(fromElt.embeddedObject(), toElt.embeddedObject(), builder);
+                }
+                else {
+                    builder->replace(f, fromSize, t, toSize);
+                }
+                f += fromSize;
+                t += toSize;
+            }
+            else if (isNamed(f + fromSize, fEnd, toName)) {
+                // The 'from' element was removed.
+                builder->replace(f, fromSize, t, 0);
+                f += fromSize;
+            }
+            else if (isNamed(t + toSize, tEnd, fromName)) {
+                // The 'to' element was inserted.
+                builder->replace(f, 0, t, toSize);
+                t += toSize;
+            }
+            else {
+                builder->replace(f, fromSize, t, toSize);
+                f += fromSize;
+                t += toSize;
+            }
+        }
+
+        // Whatever is left over was either removed or appended.
+        builder->replace(f, fEnd - f, t, tEnd - t);
+    }
+
+}  // namespace
+
+    bool hasSplices(const DamageVector& damages) {
+        for (DamageVector::const_iterator it = damages.begin(); it != damages.end(); ++it) {
+            if (it->growth != 0)
+                return true;
+        }
+        return false;
+    }
+
+    size_t sizeAfterDamages(size_t targetSize, const DamageVector& damages) {
+        for (DamageVector::const_iterator it = damages.begin(); it != damages.end(); ++it) {
+            targetSize += it->growth;
+        }
+        return targetSize;
+    }
+
+    void applyDamages(const char* target,
+                      size_t targetSize,
+                      const char* source,
+                      const DamageVector& damages,
+                      char* out) {
+        DamageVector::const_iterator where = damages.begin();
+        const DamageVector::const_iterator end = damages.end();
+
+        if (!hasSplices(damages)) {
+            // In-place damages may overlap, so they are applied in order over a copy.
+            std::memcpy(out, target, targetSize);
+            for( ; where != end; ++where ) {
+                invariant(where->targetOffset + where->size <= targetSize);
+                std::memcpy(out + where->targetOffset, source + where->sourceOffset, where->size);
+            }
+            return;
+        }
+
+        size_t consumed = 0;
+        for( ; where != end; ++where ) {
+            invariant(where->targetOffset >= consumed);
+            invariant(where->targetOffset + where->targetSize() <= targetSize);
+
+            const size_t unchanged = where->targetOffset - consumed;
+            std::memcpy(out, target + consumed, unchanged);
+            out += unchanged;
+
+            std::memcpy(out, source + where->sourceOffset, where->size);
+            out += where->size;
+
+            consumed = where->targetOffset + where->targetSize();
+        }
+        std::memcpy(out, target + consumed, targetSize - consumed);
+    }
+
+    void computeDamages(const BSONObj& from, const BSONObj& to, DamageVector* damages) {
+        damages->clear();
+        DamageBuilder builder(from.objdata(), to.objdata(), damages);
+        diffObjects(from, to, &builder);
+    }
+
+} // namespace mutablebson
+} // namespace mongo
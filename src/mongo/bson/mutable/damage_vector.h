@@ -27,17 +27,26 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include "mongo/platform/cstdint.h"
 
 namespace mongo {
+
+    class BSONObj;
+
 namespace mutablebson {
 
     // A damage event represents a change of size 'size' byte at starting at offset
     // 'target_offset' in some target buffer, with the replacement data being 'size' bytes of
     // data from the 'source' offset. The base addresses against which these offsets are to be
     // applied are not captured here.
+    //
+    // A damage event with a non-zero 'growth' is a splice: its 'size' bytes of source data
+    // replace 'size - growth' bytes of the target, and everything in the target after them
+    // moves by 'growth' bytes. The offsets in a damage vector that contains splices all refer
+    // to the original target, and its events are sorted by target offset and do not overlap.
     struct DamageEvent {
         typedef uint32_t OffsetSizeType;
 
@@ -49,9 +58,38 @@ namespace mutablebson {
 
         // Size of the damage region.
         size_t size;
+
+        // Number of bytes by which this damage grows the target (negative if it shrinks it).
+        int32_t growth;
+
+        // Size of the region of the target that this damage replaces.
+        size_t targetSize() const {
+            return size - static_cast<std::ptrdiff_t>(growth);
+        }
     };
 
     typedef std::vector<DamageEvent> DamageVector;
 
+    // Returns true if any of 'damages' changes the size of the target.
+    bool hasSplices(const DamageVector& damages);
+
+    // Returns the size of a target of 'targetSize' bytes once 'damages' are applied to it.
+    size_t sizeAfterDamages(size_t targetSize, const DamageVector& damages);
+
+    // Writes to 'out', which must have room for sizeAfterDamages(targetSize, damages) bytes and
+    // must not overlap 'target', the result of applying 'damages' with data from 'source' to the
+    // 'targetSize' bytes at 'target'.
+    void applyDamages(const char* target,
+                      size_t targetSize,
+                      const char* source,
+                      const DamageVector& damages,
+                      char* out);
+
+    // Fills 'damages' with the events that turn 'from' into 'to', with 'to.objdata()' as the
+    // damage source. Subobjects and arrays present in both are compared element by element, so
+    // that e.g. appending to an array or resizing a single string only damages the bytes that
+    // actually changed (plus the sizes of the enclosing objects), wherever they are.
+    void computeDamages(const BSONObj& from, const BSONObj& to, DamageVector* damages);
+
 } // namespace mutablebson
 } // namespace mongo
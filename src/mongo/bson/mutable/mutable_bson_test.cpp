@@ -3003,6 +3003,79 @@ namespace {
         ASSERT_EQUALS(mmb::unordered(b1), mmb::unordered(b2));
     }
 
+    // Computes the damages between 'from' and the document 'doc' turned it into, checks that
+    // applying them to 'from' yields exactly that document, and returns how many bytes of the
+    // new document they carry.
+    size_t checkComputedDamages(const mongo::BSONObj& from, mmb::Document& doc) {
+        const mongo::BSONObj to = doc.getObject();
+        mmb::DamageVector damages;
+        mmb::computeDamages(from, to, &damages);
+
+        const size_t newSize = mmb::sizeAfterDamages(from.objsize(), damages);
+        ASSERT_EQUALS(static_cast<size_t>(to.objsize()), newSize);
+        std::vector<char> result(newSize);
+        mmb::applyDamages(from.objdata(), from.objsize(), to.objdata(), damages, &result[0]);
+        ASSERT_EQUALS(0, std::memcmp(&result[0], to.objdata(), newSize));
+
+        size_t damagedBytes = 0;
+        for (mmb::DamageVector::const_iterator it = damages.begin(); it != damages.end(); ++it)
+            damagedBytes += it->size;
+        return damagedBytes;
+    }
+
+    TEST(DocumentSplice, PushOntoArrayOnlyDamagesTheEnd) {
+        const std::string big(100 * 1024, 'x');
+        mongo::BSONObjBuilder builder;
+        builder.append("_id", 1);
+        builder.append("big", big);
+        builder.append("arr", BSON_ARRAY(1 << 2 << 3));
+        builder.append("tail", "tail");
+        const mongo::BSONObj obj = builder.obj();
+
+        mmb::Document doc(obj, mmb::Document::kInPlaceEnabled);
+        mmb::Element arr = doc.root()["arr"];
+        ASSERT_OK(arr.appendInt("3", 4));
+        ASSERT_FALSE(doc.isInPlaceModeEnabled());
+
+        // The sizes of the document and the array, plus the new array element.
+        ASSERT_LESS_THAN(checkComputedDamages(obj, doc), 32U);
+    }
+
+    TEST(DocumentSplice, SizeChangingSetValue) {
+        const mongo::BSONObj obj =
+            mongo::fromjson("{ _id : 1, a : 'short', b : { c : 'x', d : [ 1, 2 ] }, e : 5 }");
+        mmb::Document doc(obj, mmb::Document::kInPlaceEnabled);
+        ASSERT_OK(doc.root()["a"].setValueString("a much longer string"));
+        ASSERT_OK(doc.root()["b"]["c"].setValueString(""));
+        ASSERT_FALSE(doc.isInPlaceModeEnabled());
+        checkComputedDamages(obj, doc);
+    }
+
+    TEST(DocumentSplice, AddAndRemoveFields) {
+        const mongo::BSONObj obj = mongo::fromjson("{ _id : 1, a : 1, b : { c : 2 }, d : 3 }");
+        mmb::Document doc(obj, mmb::Document::kInPlaceEnabled);
+        ASSERT_OK(doc.root()["a"].remove());
+        ASSERT_OK(doc.root()["b"].appendString("e", "new"));
+        ASSERT_OK(doc.root()["d"].addSiblingLeft(doc.makeElementInt("f", 4)));
+        ASSERT_OK(doc.root().appendBool("g", true));
+        checkComputedDamages(obj, doc);
+    }
+
+    TEST(DocumentSplice, TypeChanges) {
+        const mongo::BSONObj obj = mongo::fromjson("{ _id : 1, a : [ 1, 2 ], b : { c : 1 } }");
+        mmb::Document doc(obj, mmb::Document::kInPlaceEnabled);
+        ASSERT_OK(doc.root()["a"].setValueInt(1));
+        ASSERT_OK(doc.root()["b"].setValueString("now a string"));
+        checkComputedDamages(obj, doc);
+    }
+
+    TEST(DocumentSplice, UnchangedDocumentHasNoDamages) {
+        const mongo::BSONObj obj = mongo::fromjson("{ _id : 1, a : [ 1, 2 ], b : { c : 1 } }");
+        mmb::DamageVector damages;
+        mmb::computeDamages(obj, obj.copy(), &damages);
+        ASSERT_TRUE(damages.empty());
+    }
+
     TEST(UnorderedEqualityChecker, ArrayOrderingIsConsidered) {
         const mongo::BSONObj b1 = mongo::fromjson(
             "{ a : [ 1, 2, { 'a' : 'b', 'x' : 'y' } ], b : { x : 1, y : 2, z : 3 } }");
@@ -0,0 +1,197 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/util/buffer_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "mongo/base/init.h"
+#include "mongo/base/status.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"  // TODO: remove apple dep for this in threadlocal.h
+#include "mongo/util/concurrency/threadlocal.h"
+
+namespace mongo {
+
+namespace {
+
+    const int kMinPooledShift = 6;
+    const int kMaxPooledShift = 17;
+    const int kNumSizeClasses = kMaxPooledShift - kMinPooledShift + 1;
+
+    static_assert(BufferPool::kMinPooledSize == (size_t(1) << kMinPooledShift),
+                  "kMinPooledShift must match kMinPooledSize");
+    static_assert(BufferPool::kMaxPooledSize == (size_t(1) << kMaxPooledShift),
+                  "kMaxPooledShift must match kMaxPooledSize");
+
+    /// Like the ostringstream cache in LogstreamBuilder, the thread caches may only be used
+    /// between global initialization and static finalization. Outside of that window buffers
+    /// still come from, and go back to, malloc directly.
+    bool isBufferPoolInitialized = false;
+
+    MONGO_INITIALIZER(BufferPool)(InitializerContext*) {
+        isBufferPoolInitialized = true;
+        return Status::OK();
+    }
+
+    bool isPoolable(size_t size) {
+        return size <= BufferPool::kMaxPooledSize;
+    }
+
+    /**
+     * Index of the size class holding requests of 'size' bytes. 'size' must be poolable.
+     */
+    int sizeClassIndex(size_t size) {
+        int shift = kMinPooledShift;
+        while ((size_t(1) << shift) < size) {
+            ++shift;
+        }
+        return shift - kMinPooledShift;
+    }
+
+}  // namespace
+
+    struct BufferPoolThreadCache {
+        BufferPoolThreadCache() : bytes(0) {
+            memset(counts, 0, sizeof(counts));
+        }
+
+        ~BufferPoolThreadCache() {
+            clear();
+        }
+
+        size_t clear() {
+            const size_t released = bytes;
+            for (int i = 0; i < kNumSizeClasses; ++i) {
+                for (size_t j = 0; j < counts[i]; ++j) {
+                    free(buffers[i][j]);
+                }
+                counts[i] = 0;
+            }
+            bytes = 0;
+            return released;
+        }
+
+        void* buffers[kNumSizeClasses][BufferPool::kMaxBuffersPerClass];
+        size_t counts[kNumSizeClasses];
+        size_t bytes;
+    };
+
+    TSP_DECLARE(BufferPoolThreadCache, bufferPoolThreadCache);
+    TSP_DEFINE(BufferPoolThreadCache, bufferPoolThreadCache);
+
+namespace {
+    // This must be after the TSP_DEFINE so that it is destroyed first.
+    struct BufferPoolFinalizer {
+        ~BufferPoolFinalizer() {
+            isBufferPoolInitialized = false;
+        }
+    } bufferPoolFinalizer;
+
+    BufferPoolThreadCache* threadCache() {
+        if (!isBufferPoolInitialized) {
+            return NULL;
+        }
+        return bufferPoolThreadCache.getMake();
+    }
+}  // namespace
+
+    size_t BufferPool::sizeClassFor(size_t size) {
+        if (!isPoolable(size)) {
+            return size;
+        }
+        return size_t(1) << (sizeClassIndex(size) + kMinPooledShift);
+    }
+
+    void* BufferPool::allocate(size_t size) {
+        if (!isPoolable(size)) {
+            return mongoMalloc(size);
+        }
+
+        const int index = sizeClassIndex(size);
+        if (BufferPoolThreadCache* cache = threadCache()) {
+            if (cache->counts[index] > 0) {
+                cache->bytes -= sizeClassFor(size);
+                return cache->buffers[index][--cache->counts[index]];
+            }
+        }
+        return mongoMalloc(sizeClassFor(size));
+    }
+
+    void BufferPool::release(void* buffer, size_t size) {
+        if (!buffer) {
+            return;
+        }
+
+        if (isPoolable(size)) {
+            const int index = sizeClassIndex(size);
+            const size_t classSize = sizeClassFor(size);
+            BufferPoolThreadCache* cache = threadCache();
+            if (cache &&
+                cache->counts[index] < kMaxBuffersPerClass &&
+                cache->bytes + classSize <= kMaxCachedBytesPerThread) {
+                cache->buffers[index][cache->counts[index]++] = buffer;
+                cache->bytes += classSize;
+                return;
+            }
+        }
+        free(buffer);
+    }
+
+    void* BufferPool::grow(void* buffer, size_t oldSize, size_t newSize) {
+        if (!buffer) {
+            return allocate(newSize);
+        }
+        if (!isPoolable(oldSize) && !isPoolable(newSize)) {
+            return mongoRealloc(buffer, newSize);
+        }
+        if (sizeClassFor(oldSize) == sizeClassFor(newSize)) {
+            return buffer;
+        }
+
+        void* newBuffer = allocate(newSize);
+        memcpy(newBuffer, buffer, std::min(oldSize, newSize));
+        release(buffer, oldSize);
+        return newBuffer;
+    }
+
+    size_t BufferPool::clearThreadCache() {
+        BufferPoolThreadCache* cache = threadCache();
+        return cache ? cache->clear() : 0;
+    }
+
+    size_t BufferPool::threadCacheBytes() {
+        BufferPoolThreadCache* cache = threadCache();
+        return cache ? cache->bytes : 0;
+    }
+
+} // namespace mongo
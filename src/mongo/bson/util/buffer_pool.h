@@ -0,0 +1,88 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace mongo {
+
+    /**
+     * A per-thread cache of recently released BufBuilder buffers, bucketed by power-of-two size
+     * class.
+     *
+     * Every buffer handed out is an ordinary malloc() block of exactly sizeClassFor() bytes, so
+     * whoever ends up owning one (for instance a Message after a decouple()) may always free() it.
+     * Giving it back through release() instead lets the next builder on the same thread reuse it
+     * rather than going through malloc, realloc and free again.
+     *
+     * Only buffers up to kMaxPooledSize are cached, and each thread keeps at most
+     * kMaxCachedBytesPerThread bytes around; anything else goes straight back to the allocator.
+     */
+    class BufferPool {
+    public:
+        static const size_t kMinPooledSize = 64;
+        static const size_t kMaxPooledSize = 128 * 1024;
+        static const size_t kMaxBuffersPerClass = 4;
+        static const size_t kMaxCachedBytesPerThread = 512 * 1024;
+
+        /**
+         * Returns the number of bytes actually allocated for a request of 'size' bytes: the next
+         * power of two for poolable sizes, 'size' itself for larger ones.
+         */
+        static size_t sizeClassFor(size_t size);
+
+        /**
+         * Returns a buffer of sizeClassFor(size) bytes, reusing one of this thread's cached
+         * buffers if possible.
+         */
+        static void* allocate(size_t size);
+
+        /**
+         * Gives back a buffer obtained from allocate(size) (or grow()) with the same 'size'.
+         */
+        static void release(void* buffer, size_t size);
+
+        /**
+         * Moves the contents of 'buffer', an allocation of 'oldSize' bytes, into an allocation of
+         * 'newSize' bytes and returns it. The first min(oldSize, newSize) bytes are preserved.
+         */
+        static void* grow(void* buffer, size_t oldSize, size_t newSize);
+
+        /**
+         * Frees every buffer cached by the calling thread. Returns the number of bytes released.
+         */
+        static size_t clearThreadCache();
+
+        /**
+         * Returns the number of bytes currently cached by the calling thread.
+         */
+        static size_t threadCacheBytes();
+    };
+
+} // namespace mongo
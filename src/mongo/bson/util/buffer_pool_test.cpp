@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/util/buffer_pool.h"
+
+#include <cstring>
+
+#include "mongo/bson/util/builder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    TEST(BufferPool, SizeClasses) {
+        ASSERT_EQUALS(64U, BufferPool::sizeClassFor(1));
+        ASSERT_EQUALS(64U, BufferPool::sizeClassFor(64));
+        ASSERT_EQUALS(128U, BufferPool::sizeClassFor(65));
+        ASSERT_EQUALS(32768U, BufferPool::sizeClassFor(32768));
+        ASSERT_EQUALS(BufferPool::kMaxPooledSize,
+                      BufferPool::sizeClassFor(BufferPool::kMaxPooledSize));
+        ASSERT_EQUALS(BufferPool::kMaxPooledSize + 1,
+                      BufferPool::sizeClassFor(BufferPool::kMaxPooledSize + 1));
+    }
+
+    TEST(BufferPool, ReleasedBufferIsReused) {
+        BufferPool::clearThreadCache();
+        void* first = BufferPool::allocate(1000);
+        BufferPool::release(first, 1000);
+        ASSERT_EQUALS(1024U, BufferPool::threadCacheBytes());
+
+        // Any request in the same size class gets the cached buffer back.
+        void* second = BufferPool::allocate(600);
+        ASSERT_EQUALS(first, second);
+        ASSERT_EQUALS(0U, BufferPool::threadCacheBytes());
+        BufferPool::release(second, 600);
+        ASSERT_EQUALS(1024U, BufferPool::clearThreadCache());
+    }
+
+    TEST(BufferPool, LargeBuffersAreNotCached) {
+        BufferPool::clearThreadCache();
+        const size_t size = BufferPool::kMaxPooledSize * 2;
+        BufferPool::release(BufferPool::allocate(size), size);
+        ASSERT_EQUALS(0U, BufferPool::threadCacheBytes());
+    }
+
+    TEST(BufferPool, CacheIsBounded) {
+        BufferPool::clearThreadCache();
+        const size_t n = BufferPool::kMaxBuffersPerClass + 2;
+        void* buffers[n];
+        for (size_t i = 0; i < n; ++i) {
+            buffers[i] = BufferPool::allocate(100);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            BufferPool::release(buffers[i], 100);
+        }
+        ASSERT_EQUALS(BufferPool::kMaxBuffersPerClass * 128, BufferPool::threadCacheBytes());
+
+        const size_t big = BufferPool::kMaxPooledSize;
+        for (size_t i = 0; i < n; ++i) {
+            buffers[i] = BufferPool::allocate(big);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            BufferPool::release(buffers[i], big);
+        }
+        ASSERT_LESS_THAN_OR_EQUALS(BufferPool::threadCacheBytes(),
+                                   BufferPool::kMaxCachedBytesPerThread);
+        BufferPool::clearThreadCache();
+    }
+
+    TEST(BufferPool, GrowPreservesContents) {
+        char* buffer = static_cast<char*>(BufferPool::allocate(64));
+        memset(buffer, 'x', 64);
+        buffer = static_cast<char*>(BufferPool::grow(buffer, 64, 100000));
+        for (int i = 0; i < 64; ++i) {
+            ASSERT_EQUALS('x', buffer[i]);
+        }
+        buffer = static_cast<char*>(BufferPool::grow(buffer, 100000, 1024 * 1024));
+        ASSERT_EQUALS('x', buffer[63]);
+        BufferPool::release(buffer, 1024 * 1024);
+    }
+
+    TEST(BufferPool, PooledBufBuilder) {
+        BufferPool::clearThreadCache();
+        {
+            PooledBufBuilder b;
+            for (int i = 0; i < 10000; ++i) {
+                b.appendNum(i);
+            }
+            for (int i = 0; i < 10000; ++i) {
+                int value;
+                memcpy(&value, b.buf() + i * sizeof(int), sizeof(int));
+                ASSERT_EQUALS(i, value);
+            }
+        }
+        // The builder's final 64KB buffer, and the smaller ones it outgrew, are cached for the
+        // next builders.
+        const size_t cached = BufferPool::threadCacheBytes();
+        ASSERT_GREATER_THAN_OR_EQUALS(cached, 65536U);
+        {
+            PooledBufBuilder b(40000);
+            ASSERT_EQUALS(cached - 65536, BufferPool::threadCacheBytes());
+        }
+        ASSERT_EQUALS(cached, BufferPool::clearThreadCache());
+    }
+
+    TEST(BufferPool, DecoupledBufferCanBeFreed) {
+        PooledBufBuilder b;
+        b.appendStr("decoupled");
+        char* buf = b.buf();
+        b.decouple();
+        ASSERT_EQUALS(0, strcmp(buf, "decoupled"));
+        free(buf);
+    }
+
+}  // namespace
+}  // namespace mongo
@@ -41,6 +41,7 @@
 #include "mongo/base/data_view.h"
 #include "mongo/base/string_data.h"
 #include "mongo/bson/inline_decls.h"
+#include "mongo/bson/util/buffer_pool.h"
 #include "mongo/util/allocator.h"
 #include "mongo/util/assert_util.h"
 
@@ -109,6 +110,29 @@ namespace mongo {
         char buf[SZ];
     };
 
+    /** Takes buffers from, and gives them back to, the calling thread's BufferPool. Remembers
+        the size of the block it currently owns, since BufferPool needs it on release.
+    */
+    class PooledAllocator {
+    public:
+        PooledAllocator() : _size(0) { }
+        void* Malloc(size_t sz) {
+            _size = sz;
+            return BufferPool::allocate(sz);
+        }
+        void* Realloc(void *p, size_t sz) {
+            void* d = BufferPool::grow(p, _size, sz);
+            _size = sz;
+            return d;
+        }
+        void Free(void *p) {
+            BufferPool::release(p, _size);
+            _size = 0;
+        }
+    private:
+        size_t _size;
+    };
+
     template< class Allocator >
     class _BufBuilder {
         // non-copyable, non-assignable
@@ -307,6 +331,17 @@ namespace mongo {
         void decouple(); // not allowed. not implemented.
     };
 
+    /** A BufBuilder whose buffers come from the thread's BufferPool, for short lived buffers
+          such as replies that are built, sent and thrown away once per request.
+        A decouple()d buffer is still an ordinary malloc() block and may be free()d, but handing
+          it to Message::setPooledData(buf(), getSize()) lets the Message give it back to the
+          pool when it is done with it.
+    */
+    class PooledBufBuilder : public _BufBuilder<PooledAllocator> {
+    public:
+        PooledBufBuilder(int initsize = 512) : _BufBuilder<PooledAllocator>(initsize) { }
+    };
+
 #if defined(_WIN32) && _MSC_VER < 1900
 #pragma push_macro("snprintf")
 #define snprintf _snprintf
@@ -38,8 +38,11 @@
 #include "mongo/client/global_conn_pool.h"
 #include "mongo/client/replica_set_monitor.h"
 #include "mongo/client/syncclusterconnection.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -50,8 +53,18 @@ namespace mongo {
     using std::string;
     using std::vector;
 
+namespace {
+
+    // How often the refresher thread checks the pools when nothing wakes it sooner
+    const Seconds kRefreshInterval(10);
+
+} // namespace
+
     // ------ PoolForHost ------
 
+    const int PoolForHost::kCreationTimeBucketBoundsMillis[] =
+        {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+
     PoolForHost::~PoolForHost() {
         clear();
     }
@@ -65,6 +78,7 @@ namespace mongo {
     }
 
     void PoolForHost::done(DBConnectionPool* pool, DBClientBase* c) {
+        decrementEgress();
 
         bool isFailed = c->isFailed();
 
@@ -117,6 +131,7 @@ namespace mongo {
             
             verify( sc.conn->getSoTimeout() == socketTimeout );
 
+            markCheckedOut();
             return sc.conn;
 
         }
@@ -162,10 +177,42 @@ namespace mongo {
         return conn->isStillConnected();
     }
 
-    void PoolForHost::createdOne( DBClientBase * base) {
+    void PoolForHost::createdOne(DBClientBase* base, Milliseconds creationTime) {
+        static_assert(sizeof(kCreationTimeBucketBoundsMillis) / sizeof(int) ==
+                          kNumCreationTimeBuckets - 1,
+                      "every creation time bucket but the last needs an upper bound");
+
         if ( _created == 0 )
             _type = base->type();
         _created++;
+
+        size_t bucket = 0;
+        while (bucket < kNumCreationTimeBuckets - 1 &&
+                creationTime.count() >= kCreationTimeBucketBoundsMillis[bucket]) {
+            bucket++;
+        }
+        _creationTimeHistogram[bucket]++;
+    }
+
+    void PoolForHost::decrementEgress() {
+        if (_checkedOut > 0) {
+            _checkedOut--;
+        }
+    }
+
+    void PoolForHost::appendCreationTimeHistogram(BSONObjBuilder* b) const {
+        int lowerBound = 0;
+        for (size_t i = 0; i < kNumCreationTimeBuckets - 1; i++) {
+            const int upperBound = kCreationTimeBucketBoundsMillis[i];
+            const std::string bucketName = str::stream() << lowerBound << "-" << upperBound;
+            b->appendNumber(bucketName,
+                            static_cast<long long>(_creationTimeHistogram[i]));
+            lowerBound = upperBound;
+        }
+        const std::string lastBucketName = str::stream() << lowerBound << "+";
+        b->appendNumber(lastBucketName,
+                        static_cast<long long>(
+                                _creationTimeHistogram[kNumCreationTimeBuckets - 1]));
     }
 
     void PoolForHost::initializeHostName(const std::string& hostName) {
@@ -181,6 +228,9 @@ namespace mongo {
     DBConnectionPool::DBConnectionPool()
         : _name( "dbconnectionpool" ) , 
           _maxPoolSize(PoolForHost::kPoolSizeUnlimited) ,
+          _minPoolSize(0),
+          _refresherStarted(false),
+          _refreshRequested(false),
           _hooks( new list<DBConnectionHook*>() ) {
     }
 
@@ -191,23 +241,41 @@ namespace mongo {
         PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
         p.setMaxPoolSize(_maxPoolSize);
         p.initializeHostName(ident);
-        return p.get( this , socketTimeout );
+
+        DBClientBase* c = p.get( this , socketTimeout );
+        if (!c) {
+            // The caller will have to connect in-line; make sure the next callers won't.
+            _requestRefreshIfNeeded_inlock(p);
+        }
+        return c;
     }
 
-    DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
+    DBClientBase* DBConnectionPool::_finishCreate(const string& host,
+                                                  double socketTimeout,
+                                                  DBClientBase* conn,
+                                                  const Timer& creationTimer) {
+        try {
+            onCreate( conn );
+        }
+        catch ( std::exception & ) {
+            delete conn;
+            throw;
+        }
+
         {
             boost::lock_guard<boost::mutex> L(_mutex);
             PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
             p.setMaxPoolSize(_maxPoolSize);
             p.initializeHostName(host);
-            p.createdOne( conn );
+            p.createdOne(conn, Milliseconds(creationTimer.millis()));
+            p.markCheckedOut();
         }
-        
+
         try {
-            onCreate( conn );
             onHandedOut( conn );
         }
         catch ( std::exception & ) {
+            decrementEgress(host, conn);
             delete conn;
             throw;
         }
@@ -215,6 +283,111 @@ namespace mongo {
         return conn;
     }
 
+    void DBConnectionPool::_requestRefreshIfNeeded_inlock(const PoolForHost& pool) {
+        if (_minPoolSize <= 0 || pool.numAvailable() + pool.numInUse() >= _minPoolSize) {
+            return;
+        }
+
+        if (!_refresherStarted) {
+            stdx::thread(stdx::bind(&DBConnectionPool::_refreshLoop, this)).detach();
+            _refresherStarted = true;
+        }
+
+        _refreshRequested = true;
+        _refreshRequestedCondition.notify_one();
+    }
+
+    void DBConnectionPool::_refreshLoop() {
+        while (!inShutdown()) {
+            {
+                boost::unique_lock<boost::mutex> lk(_mutex);
+                if (!_refreshRequested) {
+                    _refreshRequestedCondition.wait_for(lk, kRefreshInterval);
+                }
+                _refreshRequested = false;
+            }
+
+            if (inShutdown()) {
+                break;
+            }
+
+            try {
+                // Drop broken idle connections first, so that they get replaced.
+                taskDoWork();
+                _replenishPools();
+            }
+            catch (const std::exception& ex) {
+                warning() << _name << ": failed to refresh connections" << causedBy(ex);
+            }
+        }
+    }
+
+    void DBConnectionPool::_replenishPools() {
+        struct Shortfall {
+            PoolKey key;
+            int numMissing;
+        };
+        vector<Shortfall> shortfalls;
+
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            for (PoolMap::const_iterator i = _pools.begin(); i != _pools.end(); ++i) {
+                const PoolForHost& p = i->second;
+
+                // Only hosts which have actually been used get connections opened ahead of time.
+                if (p.numCreated() == 0) {
+                    continue;
+                }
+
+                const int numMissing = _minPoolSize - p.numAvailable() - p.numInUse();
+                if (numMissing > 0) {
+                    shortfalls.push_back(Shortfall{i->first, numMissing});
+                }
+            }
+        }
+
+        for (const Shortfall& shortfall : shortfalls) {
+            const string& host = shortfall.key.ident;
+            const double socketTimeout = shortfall.key.timeout;
+
+            auto cs = ConnectionString::parse(host);
+            if (!cs.isOK()) {
+                continue;
+            }
+
+            for (int n = 0; n < shortfall.numMissing && !inShutdown(); n++) {
+                Timer creationTimer;
+                string errmsg;
+                DBClientBase* c = cs.getValue().connect(errmsg, socketTimeout);
+                if (!c) {
+                    // Don't keep retrying a host which is down; the next pass will try again.
+                    LOG(1) << _name << ": failed to open connection ahead of time to " << host
+                           << causedBy(errmsg);
+                    break;
+                }
+
+                try {
+                    onCreate(c);
+                }
+                catch (const std::exception& ex) {
+                    LOG(1) << _name << ": failed to initialize connection to " << host
+                           << causedBy(ex);
+                    delete c;
+                    break;
+                }
+
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                PoolForHost& p = _pools[shortfall.key];
+                p.createdOne(c, Milliseconds(creationTimer.millis()));
+
+                // Count the connection as handed out and returned, so that done() applies the
+                // usual checks on pool size and known bad connections.
+                p.markCheckedOut();
+                p.done(this, c);
+            }
+        }
+    }
+
     DBClientBase* DBConnectionPool::get(const ConnectionString& url, double socketTimeout) {
         DBClientBase * c = _get( url.toString() , socketTimeout );
         if ( c ) {
@@ -222,17 +395,19 @@ namespace mongo {
                 onHandedOut( c );
             }
             catch ( std::exception& ) {
+                decrementEgress(url.toString(), c);
                 delete c;
                 throw;
             }
             return c;
         }
 
+        Timer creationTimer;
         string errmsg;
         c = url.connect( errmsg, socketTimeout );
         uassert( 13328 ,  _name + ": connect failed " + url.toString() + " : " + errmsg , c );
 
-        return _finishCreate( url.toString() , socketTimeout , c );
+        return _finishCreate(url.toString(), socketTimeout, c, creationTimer);
     }
 
     DBClientBase* DBConnectionPool::get(const string& host, double socketTimeout) {
@@ -242,6 +417,7 @@ namespace mongo {
                 onHandedOut( c );
             }
             catch ( std::exception& ) {
+                decrementEgress(host, c);
                 delete c;
                 throw;
             }
@@ -250,11 +426,12 @@ namespace mongo {
 
         const ConnectionString cs(uassertStatusOK(ConnectionString::parse(host)));
 
+        Timer creationTimer;
         string errmsg;
         c = cs.connect( errmsg, socketTimeout );
         if ( ! c )
             throw SocketException( SocketException::CONNECT_ERROR , host , 11002 , str::stream() << _name << " error: " << errmsg );
-        return _finishCreate( host , socketTimeout , c );
+        return _finishCreate(host, socketTimeout, c, creationTimer);
     }
 
     void DBConnectionPool::onRelease(DBClientBase* conn) {
@@ -271,7 +448,19 @@ namespace mongo {
         onRelease(c);
 
         boost::lock_guard<boost::mutex> L(_mutex);
-        _pools[PoolKey(host,c->getSoTimeout())].done(this,c);
+        PoolForHost& p = _pools[PoolKey(host,c->getSoTimeout())];
+        p.done(this,c);
+
+        // The pool may just have been cleared because of a bad connection.
+        _requestRefreshIfNeeded_inlock(p);
+    }
+
+    void DBConnectionPool::decrementEgress(const string& host, DBClientBase* conn) {
+        boost::lock_guard<boost::mutex> L(_mutex);
+        PoolMap::iterator i = _pools.find(PoolKey(host, conn->getSoTimeout()));
+        if (i != _pools.end()) {
+            i->second.decrementEgress();
+        }
     }
 
 
@@ -341,6 +530,7 @@ namespace mongo {
     void DBConnectionPool::appendInfo( BSONObjBuilder& b ) {
 
         int avail = 0;
+        int inUse = 0;
         long long created = 0;
 
 
@@ -356,10 +546,16 @@ namespace mongo {
                 string s = str::stream() << i->first.ident << "::" << i->first.timeout;
 
                 BSONObjBuilder temp( bb.subobjStart( s ) );
+                temp.append( "inUse" , i->second.numInUse() );
                 temp.append( "available" , i->second.numAvailable() );
                 temp.appendNumber( "created" , i->second.numCreated() );
+                {
+                    BSONObjBuilder histogram(temp.subobjStart("creationTimeMillis"));
+                    i->second.appendCreationTimeHistogram(&histogram);
+                }
                 temp.done();
 
+                inUse += i->second.numInUse();
                 avail += i->second.numAvailable();
                 created += i->second.numCreated();
 
@@ -382,6 +578,7 @@ namespace mongo {
             temp.done();
         }
 
+        b.append( "totalInUse" , inUse );
         b.append( "totalAvailable" , avail );
         b.appendNumber( "totalCreated" , created );
     }
@@ -522,6 +719,15 @@ namespace mongo {
         }
     }
 
+    void ScopedDbConnection::kill() {
+        if (_conn) {
+            globalConnPool.decrementEgress(_host, _conn);
+        }
+
+        delete _conn;
+        _conn = 0;
+    }
+
     void ScopedDbConnection::clearPool() {
         globalConnPool.clear();
     }
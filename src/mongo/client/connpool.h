@@ -35,12 +35,15 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/cstdint.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
     class DBConnectionPool;
+    class Timer;
 
     /**
      * not thread safe
@@ -54,16 +57,20 @@ namespace mongo {
 
         PoolForHost() :
             _created(0),
+            _checkedOut(0),
             _minValidCreationTimeMicroSec(0),
             _type(ConnectionString::INVALID),
-            _maxPoolSize(kPoolSizeUnlimited) {
+            _maxPoolSize(kPoolSizeUnlimited),
+            _creationTimeHistogram() {
         }
 
         PoolForHost(const PoolForHost& other) :
             _created(other._created),
+            _checkedOut(other._checkedOut),
             _minValidCreationTimeMicroSec(other._minValidCreationTimeMicroSec),
             _type(other._type),
-            _maxPoolSize(other._maxPoolSize) {
+            _maxPoolSize(other._maxPoolSize),
+            _creationTimeHistogram() {
             verify(_created == 0);
             verify(other._pool.size() == 0);
         }
@@ -82,13 +89,40 @@ namespace mongo {
 
         int numAvailable() const { return (int)_pool.size(); }
 
-        void createdOne( DBClientBase * base );
+        /**
+         * Records a newly created connection, which took 'creationTime' to connect and run the
+         * pool's onCreate hooks.
+         */
+        void createdOne(DBClientBase* base, Milliseconds creationTime);
         long long numCreated() const { return _created; }
 
+        /**
+         * Returns the number of connections handed out by the pool which have not yet been
+         * returned to it or destroyed.
+         */
+        int numInUse() const { return _checkedOut; }
+
+        /**
+         * Records that a connection has been handed out.
+         */
+        void markCheckedOut() { _checkedOut++; }
+
+        /**
+         * Records that a connection handed out by this pool was destroyed by its user rather than
+         * being returned with done().
+         */
+        void decrementEgress();
+
+        /**
+         * Appends a histogram of connection creation times, in milliseconds, to 'b'.
+         */
+        void appendCreationTimeHistogram(BSONObjBuilder* b) const;
+
         ConnectionString::ConnectionType type() const { verify(_created); return _type; }
 
         /**
-         * gets a connection or return NULL
+         * gets a connection or return NULL. A connection which is returned is counted as in use
+         * until it is passed back to done() or decrementEgress() is called.
          */
         DBClientBase * get( DBConnectionPool * pool , double socketTimeout );
 
@@ -129,15 +163,27 @@ namespace mongo {
             time_t when;
         };
 
+        // Upper bounds, in milliseconds, of all but the last bucket of the creation time
+        // histogram. The last bucket counts everything slower.
+        static const int kCreationTimeBucketBoundsMillis[];
+        static const size_t kNumCreationTimeBuckets = 13;
+
         std::string _hostName;
         std::stack<StoredConnection> _pool;
 
         int64_t _created;
+
+        // Connections handed out and not yet returned or destroyed
+        int _checkedOut;
+
         uint64_t _minValidCreationTimeMicroSec;
         ConnectionString::ConnectionType _type;
 
         // The maximum number of connections we'll save in the pool
         int _maxPoolSize;
+
+        // Number of connections created in each creation time bucket
+        int64_t _creationTimeHistogram[kNumCreationTimeBuckets];
     };
 
     class DBConnectionHook {
@@ -189,6 +235,20 @@ namespace mongo {
          */
         void setMaxPoolSize( int maxPoolSize ) { _maxPoolSize = maxPoolSize; }
 
+        /**
+         * Returns the number of connections per host, in use or idle, which the pool tries to
+         * keep open.
+         */
+        int getMinPoolSize() const { return _minPoolSize; }
+
+        /**
+         * Sets the number of connections per host, in use or idle, which the pool tries to keep
+         * open. Once a host has been used, a background thread opens connections to it ahead of
+         * demand whenever the pool for it falls below this size, for instance after its idle
+         * connections were dropped because one of them failed. The default of 0 disables this.
+         */
+        void setMinPoolSize(int minPoolSize) { _minPoolSize = minPoolSize; }
+
         void onCreate( DBClientBase * conn );
         void onHandedOut( DBClientBase * conn );
         void onDestroy( DBClientBase * conn );
@@ -201,6 +261,12 @@ namespace mongo {
 
         void release(const std::string& host, DBClientBase *c);
 
+        /**
+         * Tells the pool that a connection it handed out for 'host' has been destroyed by its user
+         * instead of being released back to the pool, so that it is no longer counted as in use.
+         */
+        void decrementEgress(const std::string& host, DBClientBase* conn);
+
         void addHook( DBConnectionHook * hook ); // we take ownership
         void appendInfo( BSONObjBuilder& b );
 
@@ -236,7 +302,29 @@ namespace mongo {
 
         DBClientBase* _get( const std::string& ident , double socketTimeout );
 
-        DBClientBase* _finishCreate( const std::string& ident , double socketTimeout, DBClientBase* conn );
+        DBClientBase* _finishCreate(const std::string& ident,
+                                    double socketTimeout,
+                                    DBClientBase* conn,
+                                    const Timer& creationTimer);
+
+        /**
+         * Wakes the refresher thread, starting it first if necessary, if a minimum pool size is
+         * set and 'pool' holds fewer connections than that. Expects _mutex to be held.
+         */
+        void _requestRefreshIfNeeded_inlock(const PoolForHost& pool);
+
+        /**
+         * Body of the refresher thread, which periodically, or when woken by a pool that had to
+         * create a connection on demand, drops broken idle connections and tops up every known
+         * pool to the minimum pool size.
+         */
+        void _refreshLoop();
+
+        /**
+         * Opens enough new connections to bring each pool up to the minimum pool size. Must be
+         * called without _mutex held, since it connects to the hosts.
+         */
+        void _replenishPools();
 
         struct PoolKey {
             PoolKey( const std::string& i , double t ) : ident( i ) , timeout( t ) {}
@@ -258,8 +346,16 @@ namespace mongo {
         // 0 effectively disables the pool
         int _maxPoolSize;
 
+        // The number of connections per host the refresher thread keeps open. 0 means none.
+        int _minPoolSize;
+
         PoolMap _pools;
 
+        // Whether the refresher thread has been started, and the condition used to wake it
+        bool _refresherStarted;
+        bool _refreshRequested;
+        stdx::condition_variable _refreshRequestedCondition;
+
         // pointers owned by me, right now they leak on shutdown
         // _hooks itself also leaks because it creates a shutdown race condition
         std::list<DBConnectionHook*> * _hooks;
@@ -337,10 +433,7 @@ namespace mongo {
         /** Force closure of the connection.  You should call this if you leave it in
             a bad state.  Destructor will do this too, but it is verbose.
         */
-        void kill() {
-            delete _conn;
-            _conn = 0;
-        }
+        void kill();
 
         /** Call this when you are done with the connection.
 
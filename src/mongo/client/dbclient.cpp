@@ -56,6 +56,7 @@
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/password_digest.h"
@@ -945,13 +946,43 @@ namespace {
         int sslModeVal = sslGlobalParams.sslMode.load();
         if (sslModeVal == SSLParams::SSLMode_preferSSL ||
             sslModeVal == SSLParams::SSLMode_requireSSL) {
-            return p->secure( sslManager(), _server.host() );
+            if (!p->secure( sslManager(), _server.host() )) {
+                return false;
+            }
         }
 #endif
 
+        if (!getConfiguredMessageCompressors().empty()) {
+            _negotiateMessageCompression();
+        }
+
         return true;
     }
 
+    void DBClientConnection::_negotiateMessageCompression() {
+        BSONObjBuilder isMasterCmd;
+        isMasterCmd.append("isMaster", 1);
+        appendMessageCompressionRequest(&isMasterCmd);
+
+        // Servers which do not support compression ignore the extra field, and failure here
+        // only means the connection stays uncompressed, so errors are not fatal.
+        BSONObj info;
+        try {
+            if (!DBClientWithCommands::runCommand("admin", isMasterCmd.obj(), info)) {
+                LOG(1) << "network message compression handshake with " << toString()
+                       << " failed: " << info;
+                return;
+            }
+        }
+        catch (const DBException& ex) {
+            LOG(1) << "network message compression handshake with " << toString()
+                   << " failed: " << ex.toString();
+            return;
+        }
+
+        finishMessageCompressionNegotiation(info, p.get());
+    }
+
     void DBClientConnection::logout(const string& dbname, BSONObj& info){
         authCache.erase(dbname);
         runCommand(dbname, BSON("logout" << 1), info);
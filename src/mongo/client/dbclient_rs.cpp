@@ -43,6 +43,7 @@
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -78,6 +79,29 @@ namespace {
         }
     } _populateReadPrefSecOkCmdList;
 
+    /**
+     * Reports an operation on a node selected for secondary or nearest reads to the
+     * ReplicaSetMonitor for the duration of its scope, for load-aware host selection.
+     */
+    class SelectedNodeOperation {
+        MONGO_DISALLOW_COPYING(SelectedNodeOperation);
+    public:
+        SelectedNodeOperation(const ReplicaSetMonitorPtr& monitor, const HostAndPort& host)
+            : _monitor(monitor),
+              _host(host) {
+            _monitor->startedOperation(_host);
+        }
+
+        ~SelectedNodeOperation() {
+            _monitor->finishedOperation(_host, _timer.micros());
+        }
+
+    private:
+        const ReplicaSetMonitorPtr _monitor;
+        const HostAndPort _host;
+        Timer _timer;
+    };
+
     /**
      * Extracts the read preference settings from the query document. Note that this method
      * assumes that the query is ok for secondaries so it defaults to
@@ -144,6 +168,10 @@ namespace {
         if (_lastSlaveOkConn.get() == _master.get()) {
             _lastSlaveOkConn.release();
         }
+        else if (_lastSlaveOkConn.get() != NULL) {
+            // The pooled secondary connection is destroyed rather than returned to the pool.
+            globalConnPool.decrementEgress(_lastSlaveOkHost.toString(), _lastSlaveOkConn.get());
+        }
     }
 
     ReplicaSetMonitorPtr DBClientReplicaSet::_getMonitor() const {
@@ -521,6 +549,7 @@ namespace {
                         break;
                     }
 
+                    SelectedNodeOperation operation(_getMonitor(), _lastSlaveOkHost);
                     unique_ptr<DBClientCursor> cursor = conn->query(ns, query,
                             nToReturn, nToSkip, fieldsToReturn, queryOptions,
                             batchSize);
@@ -581,6 +610,7 @@ namespace {
                         break;
                     }
 
+                    SelectedNodeOperation operation(_getMonitor(), _lastSlaveOkHost);
                     return conn->findOne(ns,query,fieldsToReturn,queryOptions);
                 }
                 catch ( const DBException &dbExcep ) {
@@ -941,6 +971,7 @@ namespace {
                             *actualServer = conn->getServerAddress();
                         }
 
+                        SelectedNodeOperation operation(_getMonitor(), _lastSlaveOkHost);
                         return conn->call(toSend, response, assertOk);
                     }
                     catch ( const DBException& dbExcep ) {
@@ -40,6 +40,7 @@
 #include "mongo/util/debug_util.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -50,6 +51,42 @@ namespace mongo {
 
     void assembleRequest( const string &ns, BSONObj query, int nToReturn, int nToSkip, const BSONObj *fieldsToReturn, int queryOptions, Message &toSend );
 
+    DBClientCursor::DBClientCursor( DBClientBase* client, const string &_ns, BSONObj _query,
+                                    int _nToReturn, int _nToSkip,
+                                    const BSONObj *_fieldsToReturn, int queryOptions , int bs ) :
+        _client(client),
+        ns(_ns),
+        query(_query),
+        nToReturn(_nToReturn),
+        haveLimit( _nToReturn > 0 && !(queryOptions & QueryOption_CursorTailable)),
+        nToSkip(_nToSkip),
+        fieldsToReturn(_fieldsToReturn),
+        opts(queryOptions),
+        batchSize(bs==1?2:bs),
+        resultFlags(0),
+        cursorId(),
+        _ownCursor( true ),
+        wasError( false ) {
+        _finishConsInit();
+    }
+
+    DBClientCursor::DBClientCursor( DBClientBase* client, const string &_ns, long long _cursorId,
+                                    int _nToReturn, int options ) :
+        _client(client),
+        ns(_ns),
+        nToReturn( _nToReturn ),
+        haveLimit( _nToReturn > 0 && !(options & QueryOption_CursorTailable)),
+        nToSkip(0),
+        fieldsToReturn(0),
+        opts( options ),
+        batchSize(0),
+        resultFlags(0),
+        cursorId(_cursorId),
+        _ownCursor(true),
+        wasError(false) {
+        _finishConsInit();
+    }
+
     void DBClientCursor::_finishConsInit() {
         _originalHost = _client->getServerAddress();
     }
@@ -79,6 +116,15 @@ namespace mongo {
         }
     }
 
+    void DBClientCursor::_assembleGetMore( Message& toSend ) {
+        BufBuilder b;
+        b.appendNum(opts);
+        b.appendStr(ns);
+        b.appendNum(nextBatchSize());
+        b.appendNum(cursorId);
+        toSend.setData(dbGetMore, b.buf(), b.len());
+    }
+
     bool DBClientCursor::init() {
         Message toSend;
         _assembleInit( toSend );
@@ -156,18 +202,24 @@ namespace mongo {
     void DBClientCursor::requestMore() {
         verify( cursorId && batch.pos == batch.nReturned );
 
+        if (_prefetchConn) {
+            receivePrefetchedMore();
+            return;
+        }
+
+        if (opts & QueryOption_Exhaust) {
+            // The server sends the next batch without being asked for it.
+            exhaustReceiveMore();
+            return;
+        }
+
         if (haveLimit) {
             nToReturn -= batch.nReturned;
             verify(nToReturn > 0);
         }
-        BufBuilder b;
-        b.appendNum(opts);
-        b.appendStr(ns);
-        b.appendNum(nextBatchSize());
-        b.appendNum(cursorId);
 
         Message toSend;
-        toSend.setData(dbGetMore, b.buf(), b.len());
+        _assembleGetMore(toSend);
         unique_ptr<Message> response(new Message());
 
         if ( _client ) {
@@ -187,6 +239,46 @@ namespace mongo {
         }
     }
 
+    void DBClientCursor::prefetchMore() {
+        if (_prefetchConn || !cursorId || _client || _scopedHost.empty() || haveLimit ||
+            (opts & (QueryOption_CursorTailable | QueryOption_Exhaust))) {
+            return;
+        }
+
+        // A failure here is not an error of the cursor; it surfaces, if it persists, when the
+        // batch is actually needed and requestMore() runs.
+        try {
+            unique_ptr<ScopedDbConnection> conn(new ScopedDbConnection(_scopedHost));
+            if (!conn->get()->lazySupported()) {
+                conn->done();
+                return;
+            }
+
+            Message toSend;
+            _assembleGetMore(toSend);
+            conn->get()->say(toSend);
+            _prefetchConn = std::move(conn);
+        }
+        catch (const DBException& e) {
+            LOG(1) << "failed to prefetch next batch of cursor " << cursorId << " from "
+                   << _scopedHost << causedBy(e);
+        }
+    }
+
+    void DBClientCursor::receivePrefetchedMore() {
+        unique_ptr<ScopedDbConnection> conn(std::move(_prefetchConn));
+        unique_ptr<Message> response(new Message());
+        uassert(28704,
+                str::stream() << "recv failed while receiving prefetched batch of cursor "
+                              << cursorId << " from " << _scopedHost,
+                conn->get()->recv(*response));
+        _client = conn->get();
+        ON_BLOCK_EXIT([this] { _client = 0; });
+        this->batch.m = std::move(response);
+        dataReceived();
+        conn->done();
+    }
+
     /** with QueryOption_Exhaust, the server just blasts data at us (marked at end with cursorid==0). */
     void DBClientCursor::exhaustReceiveMore() {
         verify( cursorId && batch.pos == batch.nReturned );
@@ -363,6 +455,12 @@ namespace mongo {
     DBClientCursor::~DBClientCursor() {
         DESTRUCTOR_GUARD (
 
+        // Collect the reply to an outstanding prefetch, so that the connection can go back to
+        // the pool and the server-side cursor is no longer in use when it is killed below.
+        if ( _prefetchConn && ! inShutdown() ) {
+            receivePrefetchedMore();
+        }
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <memory>
 #include <stack>
 
 #include "mongo/client/dbclientinterface.h"
@@ -40,6 +41,7 @@
 namespace mongo {
 
     class AScopedConnection;
+    class ScopedDbConnection;
 
     /** for mock purposes only -- do not create variants of DBClientCursor, nor hang code here
         @see DBClientMockCursor
@@ -136,38 +138,10 @@ namespace mongo {
         void setBatchSize(int newBatchSize) { batchSize = newBatchSize; }
 
         DBClientCursor( DBClientBase* client, const std::string &_ns, BSONObj _query, int _nToReturn,
-                        int _nToSkip, const BSONObj *_fieldsToReturn, int queryOptions , int bs ) :
-            _client(client),
-            ns(_ns),
-            query(_query),
-            nToReturn(_nToReturn),
-            haveLimit( _nToReturn > 0 && !(queryOptions & QueryOption_CursorTailable)),
-            nToSkip(_nToSkip),
-            fieldsToReturn(_fieldsToReturn),
-            opts(queryOptions),
-            batchSize(bs==1?2:bs),
-            resultFlags(0),
-            cursorId(),
-            _ownCursor( true ),
-            wasError( false ) {
-            _finishConsInit();
-        }
+                        int _nToSkip, const BSONObj *_fieldsToReturn, int queryOptions , int bs );
 
-        DBClientCursor( DBClientBase* client, const std::string &_ns, long long _cursorId, int _nToReturn, int options ) :
-            _client(client),
-            ns(_ns),
-            nToReturn( _nToReturn ),
-            haveLimit( _nToReturn > 0 && !(options & QueryOption_CursorTailable)),
-            nToSkip(0),
-            fieldsToReturn(0),
-            opts( options ),
-            batchSize(0),
-            resultFlags(0),
-            cursorId(_cursorId),
-            _ownCursor(true),
-            wasError(false) {
-            _finishConsInit();
-        }
+        DBClientCursor( DBClientBase* client, const std::string &_ns, long long _cursorId,
+                        int _nToReturn, int options );
 
         virtual ~DBClientCursor();
 
@@ -180,6 +154,14 @@ namespace mongo {
 
         void attach( AScopedConnection * conn );
 
+        /**
+         * Sends the getMore for the next batch without waiting for the reply, so that the server
+         * produces that batch while the current one is being consumed. The reply is received by
+         * the more() call which needs it. Does nothing unless the cursor has been attach()ed, is
+         * neither tailable, exhaust nor limited, and has no getMore outstanding already.
+         */
+        void prefetchMore();
+
         std::string originalHost() const { return _originalHost; }
 
         std::string getns() const { return ns; }
@@ -240,9 +222,13 @@ namespace mongo {
         std::string _lazyHost;
         bool wasError;
 
+        // Connection on which the getMore sent by prefetchMore() awaits its reply, if any.
+        std::unique_ptr<ScopedDbConnection> _prefetchConn;
+
         void dataReceived() { bool retry; std::string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, std::string& lazyHost );
         void requestMore();
+        void receivePrefetchedMore();
         void exhaustReceiveMore(); // for exhaust
 
         // Don't call from a virtual function
@@ -254,6 +240,7 @@ namespace mongo {
 
         // init pieces
         void _assembleInit( Message& toSend );
+        void _assembleGetMore( Message& toSend );
     };
 
     /** iterate over objects in current batch only - will not cause a network call
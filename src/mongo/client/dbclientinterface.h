@@ -1127,6 +1127,10 @@ namespace mongo {
         double _so_timeout;
         bool _connect( std::string& errmsg );
 
+        // Runs an isMaster offering the configured network message compressors and enables
+        // the one the server picks, if any.
+        void _negotiateMessageCompression();
+
         static AtomicInt32 _numConnections;
         static bool _lazyKillCursor; // lazy means we piggy back kill cursors on next op
 
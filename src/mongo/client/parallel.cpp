@@ -40,6 +40,7 @@
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/dbclient_rs.h"
 #include "mongo/client/replica_set_monitor.h"
+#include "mongo/db/client_basic.h"
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
@@ -667,6 +668,7 @@ namespace mongo {
         set<ShardId> shardIds;
         string vinfo;
 
+        rpc::ScopedTraceSpan targetingSpan(ClientBasic::getCurrent(), "targeting");
         {
             shared_ptr<DBConfig> config;
 
@@ -693,6 +695,7 @@ namespace mongo {
 
             shardIds.insert(primary->getId());
         }
+        targetingSpan.finish(BSON("nShards" << static_cast<int>(shardIds.size())));
 
         // Close all cursors on extra shards first, as these will be invalid
         for (map<ShardId, PCMData>::iterator i = _cursorMap.begin(), end = _cursorMap.end();
@@ -764,6 +767,9 @@ namespace mongo {
 
                 const string& ns = _qSpec.ns();
 
+                state->traceSpan.start(ClientBasic::getCurrent(), "shardRequest");
+                const BSONObj query = state->traceSpan.addToQuery(_qSpec.query());
+
                 // Setup cursor
                 if( ! state->cursor ){
 
@@ -779,7 +785,7 @@ namespace mongo {
 
                         // Query limits split for multiple shards
 
-                        state->cursor.reset( new DBClientCursor( state->conn->get(), ns, _qSpec.query(),
+                        state->cursor.reset( new DBClientCursor( state->conn->get(), ns, query,
                                                                  isCommand() ? 1 : 0, // nToReturn (0 if query indicates multi)
                                                                  0, // nToSkip
                                                                  // Does this need to be a ptr?
@@ -803,7 +809,7 @@ namespace mongo {
 
                         // Single shard query
 
-                        state->cursor.reset( new DBClientCursor( state->conn->get(), ns, _qSpec.query(),
+                        state->cursor.reset( new DBClientCursor( state->conn->get(), ns, query,
                                                                  _qSpec.ntoreturn(), // nToReturn
                                                                  _qSpec.ntoskip(), // nToSkip
                                                                  // Does this need to be a ptr?
@@ -844,6 +850,7 @@ namespace mongo {
                     mdata.retryNext = false;
                     mdata.initialized = true;
                     mdata.finished = true;
+                    state->traceSpan.finish(BSON("shard" << shardId));
                 }
 
 
@@ -1009,6 +1016,7 @@ namespace mongo {
                     }
 
                     mdata.completed = false;
+                    state->traceSpan.finish(BSON("shard" << shardId));
                 }
 
                 if( ! mdata.completed ){
@@ -1540,6 +1548,12 @@ namespace mongo {
                 continue;
             }
 
+            // Keep the next batch from every shard in flight while the current ones are merged,
+            // so that shards are waited on together rather than one after another. This is only
+            // done once merging starts, since a single shard cursor may instead be handed back
+            // to the client, which then issues its own getMores.
+            _cursors[i].get()->prefetchMore();
+
             // We know we have at least one result in this cursor
             BSONObj me = _cursors[i].get()->peekFirst();
 
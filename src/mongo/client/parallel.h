@@ -33,6 +33,7 @@
 
 
 #include "mongo/db/namespace_string.h"
+#include "mongo/rpc/metadata/trace_metadata.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/client/shard_connection.h"
 
@@ -82,6 +83,9 @@ namespace mongo {
         long long count;
         bool done;
 
+        // Times the query to the shard until its first batch is in
+        rpc::TraceSpan traceSpan;
+
         BSONObj toBSON() const;
 
         std::string toString() const {
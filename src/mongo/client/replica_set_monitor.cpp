@@ -202,6 +202,26 @@ namespace {
 
     bool hostsEqual(const Node& lhs, const HostAndPort& rhs) { return lhs.host == rhs; }
 
+    /**
+     * Sends isMaster to 'host'. Returns its reply and sets '*pingMicros', or returns an empty
+     * object if the host couldn't be contacted.
+     */
+    BSONObj callIsMaster(const HostAndPort& host, int64_t* pingMicros) {
+        BSONObj reply; // empty on error
+        try {
+            ScopedDbConnection conn(ConnectionString(host), socketTimeoutSecs);
+            bool ignoredOutParam = false;
+            Timer timer;
+            conn->isMaster(ignoredOutParam, &reply);
+            *pingMicros = timer.micros();
+            conn.done(); // return to pool on success.
+        }
+        catch (...) {
+            reply = BSONObj(); // should be a no-op but want to be sure
+        }
+        return reply;
+    }
+
     // Allows comparing two Nodes, or a HostAndPort and a Node.
     // NOTE: the two HostAndPort overload is only needed to support extra checks in some STL
     // implementations. For simplicity, no comparator should be used with collections of just
@@ -238,6 +258,8 @@ namespace {
     // Defaults to random selection as required by the spec
     bool ReplicaSetMonitor::useDeterministicHostSelection = false;
 
+    bool ReplicaSetMonitor::useLoadAwareHostSelection = true;
+
     ReplicaSetMonitor::ReplicaSetMonitor(StringData name, const std::set<HostAndPort>& seeds)
             : _state(std::make_shared<SetState>(name, seeds)) {
 
@@ -298,6 +320,34 @@ namespace {
         DEV _state->checkInvariants();
     }
 
+    void ReplicaSetMonitor::startedOperation(const HostAndPort& host) {
+        boost::lock_guard<boost::mutex> lk(_state->mutex);
+        Node* node = _state->findNode(host);
+        if (node)
+            node->operationsInProgress++;
+    }
+
+    void ReplicaSetMonitor::finishedOperation(const HostAndPort& host, int64_t latencyMicros) {
+        boost::lock_guard<boost::mutex> lk(_state->mutex);
+        Node* node = _state->findNode(host);
+        if (!node)
+            return; // removed from the set meanwhile
+
+        if (node->operationsInProgress > 0)
+            node->operationsInProgress--;
+
+        if (latencyMicros < 0)
+            return;
+        if (node->operationLatencyMicros == 0) {
+            node->operationLatencyMicros = std::max(latencyMicros, int64_t(1));
+        }
+        else {
+            // smoothed like the ping latency, but over more operations since there are more
+            node->operationLatencyMicros += (latencyMicros - node->operationLatencyMicros) / 8;
+            node->operationLatencyMicros = std::max(node->operationLatencyMicros, int64_t(1));
+        }
+    }
+
     bool ReplicaSetMonitor::isPrimary(const HostAndPort& host) const {
         boost::lock_guard<boost::mutex> lk(_state->mutex);
         Node* node = _state->findNode(host);
@@ -385,9 +435,18 @@ namespace {
                 builder.append("tags", node.tags);
             }
 
+            builder.append("operationsInProgress", node.operationsInProgress);
+            builder.append("operationLatencyMicros",
+                           static_cast<long long>(node.operationLatencyMicros));
+            builder.append("timesSelected", node.timesSelected);
+
             hosts.append(builder.obj());
         }
         hosts.done();
+
+        bsonObjBuilder.append("numRefreshes", _state->numScans);
+        bsonObjBuilder.append("lastRefreshMillis", static_cast<long long>(_state->lastScanMillis));
+        bsonObjBuilder.append("maxRefreshMillis", static_cast<long long>(_state->maxScanMillis));
     }
 
     void ReplicaSetMonitor::cleanup() {
@@ -458,6 +517,12 @@ namespace {
                       << " more failed checks";
             }
 
+            _set->numScans++;
+            _set->lastScanMillis = _scan->timer.millis();
+            _set->maxScanMillis = std::max(_set->maxScanMillis, _set->lastScanMillis);
+            LOG(2) << "Refresh of replica set " << _set->name << " took "
+                   << _set->lastScanMillis << "ms";
+
             _set->currentScan.reset(); // Makes sure all other Refreshers in this round return DONE
             return NextStep(NextStep::DONE);
         }
@@ -703,38 +768,79 @@ namespace {
                 continue;
 
             case NextStep::CONTACT_HOST: {
-                BSONObj reply; // empty on error
-                int64_t pingMicros = 0;
+                // Contact all the hosts this round can dispatch at once, so that slow or
+                // unreachable members don't hold up finding the others. All but one are
+                // contacted by threads of their own, which apply the replies like any other
+                // Refresher while this one waits on the condition variable for a matching host.
+                std::vector<HostAndPort> hosts(1, ns.host);
+                for (NextStep next = getNextStep();
+                        next.step == NextStep::CONTACT_HOST;
+                        next = getNextStep()) {
+                    hosts.push_back(next.host);
+                }
 
                 DEV _set->checkInvariants();
                 lk.unlock(); // relocked after attempting to call isMaster
-                try {
-                    ScopedDbConnection conn(ConnectionString(ns.host), socketTimeoutSecs);
-                    bool ignoredOutParam = false;
-                    Timer timer;
-                    conn->isMaster(ignoredOutParam, &reply);
-                    pingMicros = timer.micros();
-                    conn.done(); // return to pool on success.
-                }
-                catch (...) {
-                    reply = BSONObj(); // should be a no-op but want to be sure
+
+                std::vector<HostAndPort> inlineHosts(1, hosts.back());
+                hosts.pop_back();
+                for (size_t i = 0; i < hosts.size(); i++) {
+                    try {
+                        Refresher refresher(*this);
+                        const HostAndPort host = hosts[i];
+                        boost::thread([refresher, host]() mutable {
+                            refresher._contactHost(host);
+                        }).detach();
+                    }
+                    catch (const boost::thread_resource_error&) {
+                        inlineHosts.push_back(hosts[i]);
+                    }
                 }
-                lk.lock();
 
-                // Ignore the reply and return if we are no longer the current scan. This might
-                // happen if it was decided that the host we were contacting isn't part of the set.
-                if (_scan != _set->currentScan)
-                    return criteria ? _set->getMatchingHost(*criteria) : HostAndPort();
+                for (size_t i = 0; i < inlineHosts.size(); i++) {
+                    int64_t pingMicros = 0;
+                    const BSONObj reply = callIsMaster(inlineHosts[i], &pingMicros);
+                    lk.lock();
 
-                if (reply.isEmpty())
-                    failedHost(ns.host);
-                else
-                    receivedIsMaster(ns.host, pingMicros, reply);
+                    // Ignore the reply and return if we are no longer the current scan. This
+                    // might happen if it was decided that the host we were contacting isn't part
+                    // of the set.
+                    if (_scan != _set->currentScan)
+                        return criteria ? _set->getMatchingHost(*criteria) : HostAndPort();
+
+                    if (reply.isEmpty())
+                        failedHost(inlineHosts[i]);
+                    else
+                        receivedIsMaster(inlineHosts[i], pingMicros, reply);
+
+                    DEV _set->checkInvariants();
+                    lk.unlock();
+                }
+                lk.lock();
             }
             }
         }
     }
 
+    void Refresher::_contactHost(const HostAndPort& host) {
+        int64_t pingMicros = 0;
+        const BSONObj reply = callIsMaster(host, &pingMicros);
+
+        boost::lock_guard<boost::mutex> lk(_set->mutex);
+
+        // Ignore the reply if it was decided meanwhile that the host isn't part of the set, or
+        // the scan ended without it.
+        if (_scan != _set->currentScan)
+            return;
+
+        if (reply.isEmpty())
+            failedHost(host);
+        else
+            receivedIsMaster(host, pingMicros, reply);
+
+        DEV _set->checkInvariants();
+    }
+
     void IsMasterReply::parse(const BSONObj& obj) {
         try {
             raw = obj.getOwned(); // don't use obj again after this line
@@ -800,6 +906,10 @@ namespace {
         return true;
     }
 
+    int64_t Node::loadScore() const {
+        return (operationsInProgress + 1) * std::max(operationLatencyMicros, int64_t(1));
+    }
+
     void Node::update(const IsMasterReply& reply) {
         invariant(host == reply.host);
         invariant(reply.ok);
@@ -829,6 +939,9 @@ namespace {
     SetState::SetState(StringData name, const std::set<HostAndPort>& seedNodes)
         : name(name.toString())
         , consecutiveFailedScans(0)
+        , numScans(0)
+        , lastScanMillis(0)
+        , maxScanMillis(0)
         , seedNodes(seedNodes)
         , latencyThresholdMicros(serverGlobalParams.defaultLocalThresholdMillis * 1000)
         , rand(int64_t(time(0)))
@@ -881,6 +994,7 @@ namespace {
             Nodes::const_iterator it = std::find_if(nodes.begin(), nodes.end(), isMaster);
             if (it == nodes.end())
                 return HostAndPort();
+            it->timesSelected++;
             return it->host;
         }
 
@@ -900,7 +1014,10 @@ namespace {
 
                 // don't do more complicated selection if not needed
                 if (matchingNodes.empty()) continue;
-                if (matchingNodes.size() == 1) return matchingNodes.front()->host;
+                if (matchingNodes.size() == 1) {
+                    matchingNodes.front()->timesSelected++;
+                    return matchingNodes.front()->host;
+                }
 
                 // order by latency and don't consider hosts further than a threshold from the
                 // closest.
@@ -916,14 +1033,26 @@ namespace {
                 }
 
                 // of the remaining nodes, pick one at random (or use round-robin)
+                const Node* selected;
                 if (ReplicaSetMonitor::useDeterministicHostSelection) {
                     // only in tests
-                    return matchingNodes[roundRobin++ % matchingNodes.size()]->host;
+                    selected = matchingNodes[roundRobin++ % matchingNodes.size()];
                 }
                 else {
                     // normal case
-                    return matchingNodes[rand.nextInt32(matchingNodes.size())]->host;
-                };
+                    selected = matchingNodes[rand.nextInt32(matchingNodes.size())];
+
+                    // Power of two choices: the less loaded of two random nodes, so that a node
+                    // which is slow to serve its operations gets fewer than its ping would earn
+                    // it. Ties keep the first, so without load reported this stays uniform.
+                    if (ReplicaSetMonitor::useLoadAwareHostSelection) {
+                        const Node* other = matchingNodes[rand.nextInt32(matchingNodes.size())];
+                        if (other->loadScore() < selected->loadScore())
+                            selected = other;
+                    }
+                }
+                selected->timesSelected++;
+                return selected->host;
             }
 
             return HostAndPort();
@@ -95,6 +95,15 @@ namespace mongo {
          */
         void failedHost(const HostAndPort& host);
 
+        /**
+         * Notify this Monitor when an operation starts or finishes on a host it selected for
+         * secondary or nearest reads, with how long it took. The operations in progress on the
+         * hosts and their recent latency steer the host selection, see
+         * useLoadAwareHostSelection.
+         */
+        void startedOperation(const HostAndPort& host);
+        void finishedOperation(const HostAndPort& host, int64_t latencyMicros);
+
         /**
          * Returns true if this node is the master based ONLY on local data. Be careful, return may
          * be stale.
@@ -206,6 +215,13 @@ namespace mongo {
          */
         static bool useDeterministicHostSelection;
 
+        /**
+         * If true, secondary and nearest reads pick the less loaded of two random hosts within the
+         * latency window, by their operations in progress and recent operation latency, rather
+         * than any random one. Without operations reported, this is still a random choice.
+         */
+        static bool useLoadAwareHostSelection;
+
     private:
         const SetStatePtr _state; // never NULL
     };
@@ -326,6 +342,12 @@ namespace mongo {
          */
         HostAndPort _refreshUntilMatches(const ReadPreferenceSetting* criteria);
 
+        /**
+         * Calls isMaster on a host returned from getNextStep and applies the reply, for the
+         * threads _refreshUntilMatches contacts hosts on. Takes SetState::mutex.
+         */
+        void _contactHost(const HostAndPort& host);
+
         // Both pointers are never NULL
         SetStatePtr _set;
         ScanStatePtr _scan; // May differ from _set->currentScan if a new scan has started.
@@ -46,6 +46,7 @@
 #include "mongo/platform/cstdint.h"
 #include "mongo/platform/random.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -87,7 +88,10 @@ namespace mongo {
         struct Node {
             explicit Node(const HostAndPort& host)
                     : host(host)
-                    , latencyMicros(unknownLatency) {
+                    , latencyMicros(unknownLatency)
+                    , operationsInProgress(0)
+                    , operationLatencyMicros(0)
+                    , timesSelected(0) {
                 markFailed();
             }
 
@@ -118,6 +122,12 @@ namespace mongo {
              */
             void update(const IsMasterReply& reply);
 
+            /**
+             * Returns how loaded this node looks to host selection, from its operations in progress
+             * and their recent latency. Lower is better.
+             */
+            int64_t loadScore() const;
+
             // Intentionally chosen to compare worse than all known latencies.
             static const int64_t unknownLatency; // = numeric_limits<int64_t>::max()
 
@@ -126,6 +136,11 @@ namespace mongo {
             bool isMaster; // implies isUp
             int64_t latencyMicros; // unknownLatency if unknown
             BSONObj tags; // owned
+
+            // Reported through ReplicaSetMonitor::startedOperation() and finishedOperation()
+            int operationsInProgress;
+            int64_t operationLatencyMicros; // smoothed, 0 if unknown
+            mutable long long timesSelected; // by getMatchingHost
         };
 
         typedef std::vector<Node> Nodes;
@@ -175,6 +190,9 @@ namespace mongo {
 
         const std::string name; // safe to read outside lock since it is const
         int consecutiveFailedScans;
+        long long numScans; // completed scans
+        int64_t lastScanMillis; // duration of the last completed scan
+        int64_t maxScanMillis; // longest duration of a completed scan
         std::set<HostAndPort> seedNodes; // updated whenever a master reports set membership changes
         OID maxElectionId; // largest election id observed by this ReplicaSetMonitor
         HostAndPort lastSeenMaster; // empty if we have never seen a master. can be same as current
@@ -208,6 +226,8 @@ namespace mongo {
         // All responses go here until we find a master.
         typedef std::vector<IsMasterReply> UnconfirmedReplies;
         UnconfirmedReplies unconfirmedReplies;
+
+        Timer timer; // started with the scan
     };
 
 } // namespace mongo
@@ -1043,6 +1043,49 @@ namespace {
         ASSERT(host.empty());
     }
 
+    TEST(ReplSetMonitorReadPref, SecondaryOnlyPrefersLessLoaded) {
+        vector<Node> nodes = getThreeMemberWithTags();
+        nodes[0].latencyMicros = 1000;
+        nodes[2].latencyMicros = 1000;
+
+        // "c" is as close as "a" but serves its operations slowly
+        nodes[0].operationLatencyMicros = 1000;
+        nodes[2].operationLatencyMicros = 50 * 1000;
+        nodes[2].operationsInProgress = 10;
+
+        set<HostAndPort> seeds;
+        seeds.insert(nodes.front().host);
+        SetState set("name", seeds);
+        set.nodes = nodes;
+        set.latencyThresholdMicros = 15 * 1000;
+
+        // "c" is only selected when both random choices are "c", about a quarter of the time
+        const ReadPreferenceSetting criteria(mongo::ReadPreference::SecondaryOnly, TagSet());
+        int selectedC = 0;
+        for (int i = 0; i < 1000; i++) {
+            HostAndPort host = set.getMatchingHost(criteria);
+            ASSERT(host.host() == "a" || host.host() == "c");
+            if (host.host() == "c") {
+                selectedC++;
+            }
+        }
+        ASSERT_LESS_THAN(selectedC, 400);
+        ASSERT_GREATER_THAN(selectedC, 100);
+        ASSERT_EQUALS(1000, set.findNode(HostAndPort("a"))->timesSelected + selectedC);
+
+        // Without load aware selection the choice is uniform
+        ReplicaSetMonitor::useLoadAwareHostSelection = false;
+        selectedC = 0;
+        for (int i = 0; i < 1000; i++) {
+            if (set.getMatchingHost(criteria).host() == "c") {
+                selectedC++;
+            }
+        }
+        ReplicaSetMonitor::useLoadAwareHostSelection = true;
+        ASSERT_GREATER_THAN(selectedC, 400);
+        ASSERT_LESS_THAN(selectedC, 600);
+    }
+
     TEST(TagSet, DefaultConstructorMatchesAll) {
         TagSet tags;
         ASSERT_EQUALS(tags.getTagBSON(), BSON_ARRAY(BSONObj()));
@@ -248,6 +248,7 @@ namespace {
     TEST(ReplicaSetMonitor, CheckAllSeedsSerial) {
         SetStatePtr state = std::make_shared<SetState>("name", basicSeedsSet);
         Refresher refresher(state);
+        ASSERT_EQUALS(state->numScans, 0);
 
         set<HostAndPort> seen;
 
@@ -273,6 +274,11 @@ namespace {
         ASSERT_EQUALS(ns.step, NextStep::DONE);
         ASSERT(ns.host.empty());
 
+        // the completed scan is counted
+        ASSERT_EQUALS(state->numScans, 1);
+        ASSERT_GTE(state->lastScanMillis, 0);
+        ASSERT_EQUALS(state->maxScanMillis, state->lastScanMillis);
+
         // validate final state
         ASSERT_EQUALS(state->nodes.size(), basicSeeds.size());
         for (size_t i = 0; i < basicSeeds.size(); i++) {
@@ -30,17 +30,73 @@
 
 #include "mongo/crypto/mechanism_scram.h"
 
+#include <map>
 #include <vector>
 
 #include "mongo/crypto/crypto.h"
 #include "mongo/platform/random.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/base64.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 namespace scram {
 
     using std::unique_ptr;
 
+namespace {
+
+    // Upper limit of the entries of a DerivedKeyCache. Clients and servers seldom authenticate
+    // more than a few distinct users, and the cache is simply emptied when it fills up.
+    const size_t kMaxDerivedKeyCacheEntries = 64;
+
+    /**
+     * Remembers values derived from passwords, keyed by the SHA-1 of the inputs of the
+     * derivation.
+     */
+    template <typename Value>
+    class DerivedKeyCache {
+    public:
+        bool get(const std::string& key, Value* value) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            typename std::map<std::string, Value>::const_iterator it = _entries.find(key);
+            if (it == _entries.end())
+                return false;
+            *value = it->second;
+            return true;
+        }
+
+        void put(const std::string& key, const Value& value) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_entries.size() >= kMaxDerivedKeyCacheEntries)
+                _entries.clear();
+            _entries[key] = value;
+        }
+
+    private:
+        stdx::mutex _mutex;
+        std::map<std::string, Value> _entries;
+    };
+
+    DerivedKeyCache<std::string> saltedPasswordCache;
+    DerivedKeyCache<BSONObj> credentialsCache;
+
+    // The length prefixes keep different splits of the same bytes apart
+    std::string derivedKeyCacheKey(StringData hashedPassword,
+                                   StringData salt,
+                                   int iterationCount) {
+        const std::string input = mongoutils::str::stream() << iterationCount << ':'
+                                                            << salt.size() << ':' << salt
+                                                            << hashedPassword;
+        unsigned char digest[hashSize];
+        fassert(28788, crypto::sha1(reinterpret_cast<const unsigned char*>(input.data()),
+                                    input.size(),
+                                    digest));
+        return std::string(reinterpret_cast<const char*>(digest), hashSize);
+    }
+
+} // namespace
+
     // Compute the SCRAM step Hi() as defined in RFC5802
     static void HMACIteration(const unsigned char input[],
                               size_t inputLen,
@@ -102,6 +158,28 @@ namespace scram {
                       saltedPassword);
     }
 
+    void generateSaltedPasswordCached(StringData hashedPassword,
+                                      const unsigned char* salt,
+                                      const int saltLen,
+                                      const int iterationCount,
+                                      unsigned char saltedPassword[hashSize]) {
+        const std::string key = derivedKeyCacheKey(
+            hashedPassword,
+            StringData(reinterpret_cast<const char*>(salt), saltLen),
+            iterationCount);
+
+        std::string cached;
+        if (saltedPasswordCache.get(key, &cached)) {
+            memcpy(saltedPassword, cached.data(), hashSize);
+            return;
+        }
+
+        generateSaltedPassword(hashedPassword, salt, saltLen, iterationCount, saltedPassword);
+        saltedPasswordCache.put(key,
+                                std::string(reinterpret_cast<const char*>(saltedPassword),
+                                            hashSize));
+    }
+
     void generateSecrets(const std::string& hashedPassword,
                          const unsigned char salt[],
                          size_t saltLen,
@@ -113,11 +191,11 @@ namespace scram {
         unsigned char clientKey[hashSize];
         unsigned int hashLen = 0;
 
-        generateSaltedPassword(hashedPassword,
-                               salt,
-                               saltLen,
-                               iterationCount,
-                               saltedPassword);
+        generateSaltedPasswordCached(hashedPassword,
+                                     salt,
+                                     saltLen,
+                                     iterationCount,
+                                     saltedPassword);
 
         // clientKey = HMAC(saltedPassword, "Client Key")
         fassert(17498, 
@@ -177,6 +255,18 @@ namespace scram {
                     serverKeyFieldName << encodedServerKey);
     }
 
+    BSONObj generateCredentialsCached(const std::string& hashedPassword, int iterationCount) {
+        const std::string key = derivedKeyCacheKey(hashedPassword, StringData(), iterationCount);
+
+        BSONObj credentials;
+        if (credentialsCache.get(key, &credentials))
+            return credentials;
+
+        credentials = generateCredentials(hashedPassword, iterationCount);
+        credentialsCache.put(key, credentials);
+        return credentials;
+    }
+
     std::string generateClientProof(const unsigned char saltedPassword[hashSize],
                                     const std::string& authMessage) {
 
@@ -54,6 +54,18 @@ namespace scram {
                                 const int iterationCount,
                                 unsigned char saltedPassword[hashSize]);
 
+    /*
+     * Like generateSaltedPassword(), but remembers the SaltedPassword of recently used
+     * (password, salt, iterationCount) combinations in memory. Every connection authenticating
+     * as the same user derives the same SaltedPassword, and Hi() dominates the cost of SCRAM
+     * authentication. The cache is keyed by a digest of the inputs, not by the password.
+     */
+    void generateSaltedPasswordCached(StringData hashedPassword,
+                                      const unsigned char* salt,
+                                      const int saltLen,
+                                      const int iterationCount,
+                                      unsigned char saltedPassword[hashSize]);
+
     /*
      * Computes the SCRAM secrets storedKey and serverKey using the salt 'salt'
      * and iteration count 'iterationCount' as defined in RFC5802 (server side). 
@@ -71,6 +83,13 @@ namespace scram {
      */
     BSONObj generateCredentials(const std::string& hashedPassword, int iterationCount);
 
+    /*
+     * Like generateCredentials(), but returns the same credentials for a password and iteration
+     * count while they are remembered in memory, for servers which derive them on the fly from
+     * MONGODB-CR credentials on every authentication.
+     */
+    BSONObj generateCredentialsCached(const std::string& hashedPassword, int iterationCount);
+
     /*
      * Computes the ClientProof from SaltedPassword and authMessage (client side).
      */
@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/crypto/mechanism_scram.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    // A 16 byte salt, which is the length the server generates
+    const unsigned char salt[] = { 0x41, 0x00, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+                                   0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f };
+
+    TEST(SaltedPasswordCache, MatchesUncached) {
+        unsigned char expected[scram::hashSize];
+        unsigned char cached[scram::hashSize];
+        scram::generateSaltedPassword("password", salt, sizeof(salt), 100, expected);
+
+        // The first call derives and remembers it, the second returns the remembered one
+        for (int i = 0; i < 2; i++) {
+            memset(cached, 0, sizeof(cached));
+            scram::generateSaltedPasswordCached("password", salt, sizeof(salt), 100, cached);
+            ASSERT_EQUALS(0, memcmp(expected, cached, scram::hashSize));
+        }
+    }
+
+    TEST(SaltedPasswordCache, DistinguishesInputs) {
+        unsigned char first[scram::hashSize];
+        unsigned char other[scram::hashSize];
+        scram::generateSaltedPasswordCached("password", salt, sizeof(salt), 100, first);
+
+        scram::generateSaltedPasswordCached("password", salt, sizeof(salt), 101, other);
+        ASSERT_NOT_EQUALS(0, memcmp(first, other, scram::hashSize));
+
+        scram::generateSaltedPasswordCached("passwore", salt, sizeof(salt), 100, other);
+        ASSERT_NOT_EQUALS(0, memcmp(first, other, scram::hashSize));
+
+        unsigned char otherSalt[sizeof(salt)];
+        memcpy(otherSalt, salt, sizeof(salt));
+        otherSalt[1] = 0x01;
+        scram::generateSaltedPasswordCached("password", otherSalt, sizeof(salt), 100, other);
+        ASSERT_NOT_EQUALS(0, memcmp(first, other, scram::hashSize));
+    }
+
+    TEST(SaltedPasswordCache, SurvivesEviction) {
+        unsigned char expected[scram::hashSize];
+        unsigned char cached[scram::hashSize];
+        scram::generateSaltedPassword("password", salt, sizeof(salt), 10, expected);
+
+        // Many distinct iteration counts fill up the cache and empty it again
+        for (int i = 0; i < 200; i++) {
+            scram::generateSaltedPasswordCached("password", salt, sizeof(salt), i + 1, cached);
+        }
+        scram::generateSaltedPasswordCached("password", salt, sizeof(salt), 10, cached);
+        ASSERT_EQUALS(0, memcmp(expected, cached, scram::hashSize));
+    }
+
+    TEST(CredentialsCache, SameCredentialsForSamePassword) {
+        BSONObj first = scram::generateCredentialsCached("password", 100);
+        BSONObj second = scram::generateCredentialsCached("password", 100);
+        ASSERT_EQUALS(first, second);
+
+        // A new salt for another password or iteration count
+        BSONObj other = scram::generateCredentialsCached("passwore", 100);
+        ASSERT_NOT_EQUALS(first[scram::saltFieldName].String(),
+                          other[scram::saltFieldName].String());
+        other = scram::generateCredentialsCached("password", 101);
+        ASSERT_NOT_EQUALS(first[scram::saltFieldName].String(),
+                          other[scram::saltFieldName].String());
+        ASSERT_EQUALS(101, other[scram::iterationCountFieldName].Int());
+    }
+
+} // namespace
+} // namespace mongo
@@ -698,6 +698,7 @@ namespace {
 
     void AuthorizationManager::_updateCacheGeneration_inlock() {
         _cacheGeneration = OID::gen();
+        _cacheGenerationCount.fetchAndAdd(1);
     }
 
     void AuthorizationManager::_invalidateRelevantCacheData(const char* op,
@@ -45,6 +45,7 @@
 #include "mongo/db/auth/user_name_hash.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/unordered_map.h"
 #include "mongo/stdx/functional.h"
 
@@ -188,6 +189,15 @@ namespace mongo {
          */
         OID getCacheGeneration();
 
+        /**
+         * Returns a count which changes along with the user cache generation, read without the
+         * cache mutex, so that AuthorizationSession can check its cached decisions on every
+         * authorization check.
+         */
+        unsigned long long getCacheGenerationCount() const {
+            return _cacheGenerationCount.load();
+        }
+
         /**
          * Returns true if there exists at least one privilege document in the system.
          * Used by the AuthorizationSession to determine whether localhost connections should be
@@ -388,6 +398,11 @@ namespace mongo {
          */
         OID _cacheGeneration;
 
+        /**
+         * Incremented along with every update of _cacheGeneration.
+         */
+        AtomicUInt64 _cacheGenerationCount;
+
         /**
          * True if there is an update to the _userCache in progress, and that update is currently in
          * the "fetch phase", during which it does not hold the _cacheMutex.
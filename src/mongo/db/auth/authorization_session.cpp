@@ -60,6 +60,7 @@ namespace {
     AuthorizationSession::AuthorizationSession(
             std::unique_ptr<AuthzSessionExternalState> externalState)
         : _externalState(std::move(externalState)),
+          _authorizedActionsGeneration(0),
           _impersonationFlag(false) {}
 
     AuthorizationSession::~AuthorizationSession() {
@@ -92,6 +93,7 @@ namespace {
         if (replacedUser) {
             getAuthorizationManager().releaseUser(replacedUser);
         }
+        _clearAuthorizedActionsCache();
 
         // If there are any users and roles in the impersonation data, clear it out.
         clearImpersonatedUserData();
@@ -108,6 +110,7 @@ namespace {
         User* removedUser = _authenticatedUsers.removeByDBName(dbname);
         if (removedUser) {
             getAuthorizationManager().releaseUser(removedUser);
+            _clearAuthorizedActionsCache();
         }
         clearImpersonatedUserData();
         _buildAuthenticatedRolesVector();
@@ -136,6 +139,7 @@ namespace {
 
     void AuthorizationSession::grantInternalAuthorization() {
         _authenticatedUsers.add(internalSecurity.user);
+        _clearAuthorizedActionsCache();
         _buildAuthenticatedRolesVector();
     }
 
@@ -510,6 +514,7 @@ namespace {
                     // Success! Replace the old User object with the updated one.
                     fassert(17067, _authenticatedUsers.replaceAt(it, updatedUser) == user);
                     authMan.releaseUser(user);
+                    _clearAuthorizedActionsCache();
                     LOG(1) << "Updated session cache of user information for " << name;
                     break;
                 }
@@ -517,6 +522,7 @@ namespace {
                     // User does not exist anymore; remove it from _authenticatedUsers.
                     fassert(17068, _authenticatedUsers.removeAt(it) == user);
                     authMan.releaseUser(user);
+                    _clearAuthorizedActionsCache();
                     log() << "Removed deleted user " << name <<
                         " from session cache of user information.";
                     continue;  // No need to advance "it" in this case.
@@ -548,13 +554,42 @@ namespace {
         }
     }
 
+    // Bounds the resources a session caches the authorized actions of, which are usually the
+    // few namespaces its application works on.
+    static const size_t kMaxCachedAuthorizedResources = 128;
+
     bool AuthorizationSession::_isAuthorizedForPrivilege(const Privilege& privilege) {
         const ResourcePattern& target(privilege.getResourcePattern());
 
+        // The localhost exception ends when the first user is created, without necessarily
+        // invalidating the user cache, so its decisions aren't cached.
+        if (_externalState->shouldAllowLocalhost())
+            return _getAuthorizedActions(target).isSupersetOf(privilege.getActions());
+
+        const unsigned long long generation =
+            getAuthorizationManager().getCacheGenerationCount();
+        if (generation != _authorizedActionsGeneration) {
+            _authorizedActionsCache.clear();
+            _authorizedActionsGeneration = generation;
+        }
+
+        unordered_map<ResourcePattern, ActionSet>::const_iterator it =
+            _authorizedActionsCache.find(target);
+        if (it == _authorizedActionsCache.end()) {
+            if (_authorizedActionsCache.size() >= kMaxCachedAuthorizedResources)
+                _authorizedActionsCache.clear();
+            it = _authorizedActionsCache.insert(
+                std::make_pair(target, _getAuthorizedActions(target))).first;
+        }
+
+        return it->second.isSupersetOf(privilege.getActions());
+    }
+
+    ActionSet AuthorizationSession::_getAuthorizedActions(const ResourcePattern& target) {
         ResourcePattern resourceSearchList[resourceSearchListCapacity];
         const int resourceSearchListLength = buildResourceSearchList(target, resourceSearchList);
 
-        ActionSet unmetRequirements = privilege.getActions();
+        ActionSet authorizedActions;
 
         PrivilegeVector defaultPrivileges = getDefaultPrivileges();
         for (PrivilegeVector::iterator it = defaultPrivileges.begin();
@@ -564,11 +599,7 @@ namespace {
                 if (!(it->getResourcePattern() == resourceSearchList[i]))
                     continue;
 
-                ActionSet userActions = it->getActions();
-                unmetRequirements.removeAllActionsFromSet(userActions);
-
-                if (unmetRequirements.empty())
-                    return true;
+                authorizedActions.addAllActionsFromSet(it->getActions());
             }
         }
 
@@ -576,15 +607,16 @@ namespace {
                 it != _authenticatedUsers.end(); ++it) {
             User* user = *it;
             for (int i = 0; i < resourceSearchListLength; ++i) {
-                ActionSet userActions = user->getActionsForResource(resourceSearchList[i]);
-                unmetRequirements.removeAllActionsFromSet(userActions);
-
-                if (unmetRequirements.empty())
-                    return true;
+                authorizedActions.addAllActionsFromSet(
+                    user->getActionsForResource(resourceSearchList[i]));
             }
         }
 
-        return false;
+        return authorizedActions;
+    }
+
+    void AuthorizationSession::_clearAuthorizedActionsCache() {
+        _authorizedActionsCache.clear();
     }
 
     void AuthorizationSession::setImpersonatedUserData(std::vector<UserName> usernames,
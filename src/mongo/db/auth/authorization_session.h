@@ -42,6 +42,7 @@
 #include "mongo/db/auth/user_name.h"
 #include "mongo/db/auth/user_set.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
     class ClientBasic;
@@ -259,6 +260,13 @@ namespace mongo {
         // lock on the admin database (to update out-of-date user privilege information).
         bool _isAuthorizedForPrivilege(const Privilege& privilege);
 
+        // Returns all the actions the default privileges and the authenticated users grant on
+        // 'target', from the privileges on the resource patterns matching it.
+        ActionSet _getAuthorizedActions(const ResourcePattern& target);
+
+        // Forgets the cached authorized actions, for when the authenticated users change.
+        void _clearAuthorizedActionsCache();
+
         std::unique_ptr<AuthzSessionExternalState> _externalState;
 
         // All Users who have been authenticated on this connection.
@@ -267,6 +275,12 @@ namespace mongo {
         // users set is changed.
         std::vector<RoleName> _authenticatedRoleNames;
 
+        // The actions authorized on the resources checked recently, see _getAuthorizedActions().
+        // Only valid while the user cache generation count of the AuthorizationManager is
+        // _authorizedActionsGeneration.
+        unordered_map<ResourcePattern, ActionSet> _authorizedActionsCache;
+        unsigned long long _authorizedActionsGeneration;
+
         // A vector of impersonated UserNames and a vector of those users' RoleNames.
         // These are used in the auditing system. They are not used for authz checks.
         std::vector<UserName> _impersonatedUserNames;
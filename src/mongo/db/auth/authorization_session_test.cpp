@@ -394,6 +394,52 @@ namespace {
         ASSERT_FALSE(authzSession->lookupUser(UserName("spencer", "test")));
     }
 
+    TEST_F(AuthorizationSessionTest, CachedDecisionsFollowAuthenticatedUsers) {
+        ASSERT_OK(managerState->insertPrivilegeDocument(&_txn,
+                BSON("user" << "spencer" <<
+                     "db" << "test" <<
+                     "credentials" << BSON("MONGODB-CR" << "a") <<
+                     "roles" << BSON_ARRAY(BSON("role" << "read" <<
+                                                "db" << "test"))),
+                BSONObj()));
+        ASSERT_OK(managerState->insertPrivilegeDocument(&_txn,
+                BSON("user" << "andy" <<
+                     "db" << "other" <<
+                     "credentials" << BSON("MONGODB-CR" << "a") <<
+                     "roles" << BSON_ARRAY(BSON("role" << "readWrite" <<
+                                                "db" << "test"))),
+                BSONObj()));
+        ASSERT_OK(authzSession->addAndAuthorizeUser(&_txn, UserName("spencer", "test")));
+
+        ActionSet findAndInsert;
+        findAndInsert.addAction(ActionType::find);
+        findAndInsert.addAction(ActionType::insert);
+
+        // Asking twice answers from the cached actions the second time
+        for (int i = 0; i < 2; i++) {
+            ASSERT_TRUE(authzSession->isAuthorizedForActionsOnResource(
+                                testFooCollResource, ActionType::find));
+            ASSERT_FALSE(authzSession->isAuthorizedForActionsOnResource(
+                                testFooCollResource, findAndInsert));
+        }
+
+        // Another user adds its actions
+        ASSERT_OK(authzSession->addAndAuthorizeUser(&_txn, UserName("andy", "other")));
+        ASSERT_TRUE(authzSession->isAuthorizedForActionsOnResource(
+                            testFooCollResource, findAndInsert));
+
+        // and takes them away when logging out
+        authzSession->logoutDatabase("other");
+        ASSERT_TRUE(authzSession->isAuthorizedForActionsOnResource(
+                            testFooCollResource, ActionType::find));
+        ASSERT_FALSE(authzSession->isAuthorizedForActionsOnResource(
+                            testFooCollResource, findAndInsert));
+
+        authzSession->logoutDatabase("test");
+        ASSERT_FALSE(authzSession->isAuthorizedForActionsOnResource(
+                             testFooCollResource, ActionType::find));
+    }
+
     TEST_F(AuthorizationSessionTest, UseOldUserInfoInFaceOfConnectivityProblems) {
         // Add a readWrite user
         ASSERT_OK(managerState->insertPrivilegeDocument(&_txn,
@@ -0,0 +1,352 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/cache_warmup.h"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#include <map>
+
+#include "mongo/base/status.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/stats/top.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+    // How often the most used collections are saved, or 0 not to save them.
+    MONGO_EXPORT_SERVER_PARAMETER( cacheWarmupRecordIntervalSecs, int, 300 );
+
+    // Whether to read the collections saved by the last run into the cache at startup.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER( cacheWarmupAtStartup, bool, false );
+
+    // The most bytes, by storage size, a warm-up reads in, or 0 for no limit.
+    MONGO_EXPORT_SERVER_PARAMETER( cacheWarmupMaxBytes, long long, 0 );
+
+namespace {
+
+    const char kWarmupFileName[] = "cacheWarmup.bson";
+    const size_t kMaxRecordedNamespaces = 100;
+
+    /**
+     * How much each collection has been used lately: the operations on it in each recording
+     * interval, plus half its score of the interval before. Saved across restarts, so that the
+     * ranking of a restarted server is the one it had rather than that of its first few minutes.
+     */
+    class UsageScores {
+    public:
+        void update(const Top::UsageMap& usage) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            for (std::map<string, double>::iterator it = _scores.begin(); it != _scores.end();) {
+                it->second /= 2;
+                if (it->second < 1) {
+                    _scores.erase(it++);
+                }
+                else {
+                    ++it;
+                }
+            }
+
+            for (Top::UsageMap::const_iterator it = usage.begin(); it != usage.end(); ++it) {
+                const string ns = it->first;
+                const NamespaceString nss(ns);
+                if (!nss.isValid() || !nss.isNormal()) {
+                    continue;
+                }
+                // Top restarts from zero when a collection is dropped.
+                const long long count = it->second.total.count;
+                long long& last = _lastCounts[ns];
+                if (count > last) {
+                    _scores[ns] += count - last;
+                }
+                last = count;
+            }
+        }
+
+        void load(const BSONObj& saved) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            BSONObjIterator it(saved["namespaces"].Obj());
+            while (it.more()) {
+                const BSONObj entry = it.next().Obj();
+                _scores[entry["ns"].String()] = entry["score"].numberDouble();
+            }
+        }
+
+        /**
+         * The namespaces with the highest scores, the highest first.
+         */
+        vector<string> hottest() const {
+            vector<std::pair<double, string>> ranked;
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                for (std::map<string, double>::const_iterator it = _scores.begin();
+                     it != _scores.end(); ++it) {
+                    ranked.push_back(std::make_pair(-it->second, it->first));
+                }
+            }
+            std::sort(ranked.begin(), ranked.end());
+            if (ranked.size() > kMaxRecordedNamespaces) {
+                ranked.resize(kMaxRecordedNamespaces);
+            }
+
+            vector<string> namespaces;
+            for (size_t i = 0; i < ranked.size(); ++i) {
+                namespaces.push_back(ranked[i].second);
+            }
+            return namespaces;
+        }
+
+        BSONObj toBSON() const {
+            const vector<string> namespaces = hottest();
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            BSONObjBuilder b;
+            BSONArrayBuilder arr(b.subarrayStart("namespaces"));
+            for (size_t i = 0; i < namespaces.size(); ++i) {
+                std::map<string, double>::const_iterator it = _scores.find(namespaces[i]);
+                if (it != _scores.end()) {
+                    arr.append(BSON("ns" << it->first << "score" << it->second));
+                }
+            }
+            arr.doneFast();
+            return b.obj();
+        }
+
+    private:
+        mutable stdx::mutex _mutex;
+        std::map<string, double> _scores;
+        std::map<string, long long> _lastCounts;
+    };
+
+    UsageScores usageScores;
+
+    boost::filesystem::path warmupFilePath() {
+        return boost::filesystem::path(storageGlobalParams.dbpath) / kWarmupFileName;
+    }
+
+    Status readWarmupFile(BSONObj* out) {
+        const boost::filesystem::path path = warmupFilePath();
+        if (!boost::filesystem::exists(path)) {
+            return Status(ErrorCodes::NonExistentPath,
+                          str::stream() << path.string() << " not found");
+        }
+
+        const boost::uintmax_t fileSize = boost::filesystem::file_size(path);
+        if (fileSize < 5 || fileSize > BSONObjMaxUserSize) {
+            return Status(ErrorCodes::InvalidPath,
+                          str::stream() << path.string() << " has a bad size: " << fileSize);
+        }
+
+        vector<char> buffer(fileSize);
+        std::ifstream ifs(path.string().c_str(), std::ios_base::in | std::ios_base::binary);
+        ifs.read(&buffer[0], buffer.size());
+        if (!ifs) {
+            return Status(ErrorCodes::FileStreamFailed,
+                          str::stream() << "unable to read " << path.string());
+        }
+
+        const BSONObj obj(&buffer[0]);
+        if (static_cast<boost::uintmax_t>(obj.objsize()) != fileSize ||
+            !obj.valid() || obj["namespaces"].type() != Array) {
+            return Status(ErrorCodes::FailedToParse,
+                          str::stream() << path.string() << " is corrupt");
+        }
+        *out = obj.getOwned();
+        return Status::OK();
+    }
+
+    Status writeWarmupFile(const BSONObj& obj) {
+        const boost::filesystem::path path = warmupFilePath();
+        const boost::filesystem::path tempPath =
+            boost::filesystem::path(storageGlobalParams.dbpath) /
+            (string(kWarmupFileName) + ".tmp");
+        {
+            std::ofstream ofs(tempPath.string().c_str(),
+                              std::ios_base::out | std::ios_base::binary);
+            ofs.write(obj.objdata(), obj.objsize());
+            if (!ofs) {
+                return Status(ErrorCodes::FileStreamFailed,
+                              str::stream() << "unable to write " << tempPath.string());
+            }
+        }
+
+        try {
+            boost::filesystem::rename(tempPath, path);
+        }
+        catch (const std::exception& ex) {
+            return Status(ErrorCodes::FileRenameFailed,
+                          str::stream() << "unable to rename " << tempPath.string() << " to "
+                                        << path.string() << ": " << ex.what());
+        }
+        return Status::OK();
+    }
+
+    class CacheWarmupJob : public BackgroundJob {
+    public:
+        CacheWarmupJob() : BackgroundJob(true /* selfDelete */) {}
+
+        virtual string name() const { return "CacheWarmup"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            BSONObj saved;
+            Status status = readWarmupFile(&saved);
+            if (status.isOK()) {
+                usageScores.load(saved);
+            }
+            else if (status != ErrorCodes::NonExistentPath) {
+                warning() << "ignoring the saved cache warm-up namespaces: " << status;
+            }
+
+            if (cacheWarmupAtStartup && status.isOK()) {
+                warmUpAtStartup();
+            }
+
+            while (!inShutdown()) {
+                const int intervalSecs = cacheWarmupRecordIntervalSecs;
+                sleepsecs(intervalSecs > 0 ? intervalSecs : 60);
+                if (intervalSecs <= 0 || inShutdown()) {
+                    continue;
+                }
+
+                Top::UsageMap usage;
+                Top::get(getGlobalServiceContext()).cloneMap(usage);
+                usageScores.update(usage);
+
+                status = writeWarmupFile(usageScores.toBSON());
+                if (!status.isOK()) {
+                    warning() << "unable to save the cache warm-up namespaces: " << status;
+                }
+            }
+        }
+
+    private:
+        void warmUpAtStartup() {
+            OperationContextImpl txn;
+            BSONObjBuilder result;
+            try {
+                Status status = warmUpCache(&txn, vector<string>(), &result);
+                if (!status.isOK()) {
+                    warning() << "cache warm-up failed: " << status;
+                    return;
+                }
+                log() << "cache warm-up done: " << result.obj();
+            }
+            catch (const DBException& e) {
+                warning() << "cache warm-up failed: " << e.toString();
+            }
+        }
+    };
+
+} // namespace
+
+    void startCacheWarmup() {
+        (new CacheWarmupJob())->go();
+    }
+
+    Status warmUpCache(OperationContext* txn,
+                       const vector<string>& namespaces,
+                       BSONObjBuilder* result) {
+        const bool hottest = namespaces.empty();
+        const vector<string> toWarm = hottest ? usageScores.hottest() : namespaces;
+        const long long maxBytes = cacheWarmupMaxBytes;
+
+        Timer timer;
+        long long totalBytes = 0;
+        int skipped = 0;
+        BSONArrayBuilder touched(result->subarrayStart("namespaces"));
+        for (size_t i = 0; i < toWarm.size(); ++i) {
+            const NamespaceString nss(toWarm[i]);
+            if (!nss.isValid() || !nss.isNormal()) {
+                if (!hottest) {
+                    return Status(ErrorCodes::InvalidNamespace,
+                                  str::stream() << "bad namespace name: " << toWarm[i]);
+                }
+                continue;
+            }
+
+            txn->checkForInterrupt();
+
+            AutoGetCollectionForRead ctx(txn, nss);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                continue;
+            }
+
+            // Storage sizes can be compressed, so this undercounts the cache it takes.
+            const long long bytes = collection->getRecordStore()->storageSize(txn) +
+                                    collection->getIndexSize(txn);
+            if (maxBytes > 0 && totalBytes + bytes > maxBytes) {
+                skipped++;
+                continue;
+            }
+
+            BSONObjBuilder stats;
+            Status status = collection->touch(txn, true, true, &stats);
+            if (!status.isOK()) {
+                return status;
+            }
+            totalBytes += bytes;
+            touched.append(BSON("ns" << nss.ns() << "storageBytes" << bytes
+                                << "touch" << stats.obj()));
+        }
+        touched.doneFast();
+
+        result->appendNumber("storageBytes", totalBytes);
+        result->append("skipped", skipped);
+        result->append("millis", static_cast<int>(timer.millis()));
+        return Status::OK();
+    }
+
+} // namespace mongo
@@ -0,0 +1,58 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace mongo {
+
+    class BSONObjBuilder;
+    class OperationContext;
+    class Status;
+
+    /**
+     * Starts the thread that keeps track of which collections the server uses the most, saving
+     * them to the cacheWarmup.bson file in the dbpath every cacheWarmupRecordIntervalSecs. With
+     * cacheWarmupAtStartup set, it first reads the collections saved by the last run, and their
+     * indexes, back into the cache.
+     */
+    void startCacheWarmup();
+
+    /**
+     * Reads the collections 'namespaces' and their indexes into the storage engine's cache, or
+     * the most used collections if 'namespaces' is empty, as in a secondary that is about to
+     * step up. Stops short of cacheWarmupMaxBytes, as estimated from their storage sizes.
+     * Touching is throttled by the storage engine (wiredTigerTouchMaxBytesPerSecond).
+     */
+    Status warmUpCache(OperationContext* txn,
+                       const std::vector<std::string>& namespaces,
+                       BSONObjBuilder* result);
+
+} // namespace mongo
@@ -202,7 +202,8 @@ namespace mongo {
             catch (const WriteConflictException& wce) {
                 CurOp::get(txn)->debug().writeConflicts++;
                 retries++; // logAndBackoff expects this to be 1 on first call.
-                wce.logAndBackoff(retries, "cloneCollectionAsCapped", fromNs);
+                CurOp::get(txn)->debug().writeConflictBackoffMicros +=
+                    wce.logAndBackoff(retries, "cloneCollectionAsCapped", fromNs);
 
                 // Can't use WRITE_CONFLICT_RETRY_LOOP macros since we need to save/restore exec
                 // around call to abandonSnapshot.
@@ -143,6 +143,7 @@ namespace mongo {
                 const StringData name = e.fieldNameStringData();
                 const int flag = (name == "usePowerOf2Sizes") ? CO::Flag_UsePowerOf2Sizes :
                                  (name == "noPadding") ? CO::Flag_NoPadding :
+                                 (name == "queryResultCache") ? CO::Flag_QueryResultCache :
                                  0;
                 if (!flag) {
                     errorStatus = Status(ErrorCodes::InvalidOptions,
@@ -182,6 +183,9 @@ namespace mongo {
                                                               cmdObj);
 
         wunit.commit();
+
+        // The cache follows the committed options, so a rolled back collMod leaves it alone.
+        coll->infoCache()->updateQueryResultCache(txn);
         return Status::OK();
     }
 } // namespace mongo
@@ -34,20 +34,26 @@
 
 #include "mongo/db/catalog/collection.h"
 
+#include <cmath>
 
 #include "mongo/base/counter.h"
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
 #include "mongo/db/catalog/document_validation.h"
+#include "mongo/db/catalog/index_build_side_writes.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/field_ref_set.h"
 #include "mongo/db/keypattern.h"
+#include "mongo/db/matcher/expression_compiled.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/op_observer.h"
+#include "mongo/db/operation_context_impl.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/ops/update_driver.h"
 #include "mongo/db/ops/update_request.h"
@@ -57,7 +63,9 @@
 #include "mongo/db/storage/record_fetcher.h"
 
 #include "mongo/db/auth/user_document_parser.h" // XXX-ANDY
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -111,6 +119,9 @@ namespace {
 
         ss << " validateDocuments: " << validateDocuments;
 
+        if ( online )
+            ss << " online, timeSliceSecs: " << timeSliceSecs;
+
         return ss.str();
     }
 
@@ -119,13 +130,16 @@ namespace {
     //
 
     CappedInsertNotifier::CappedInsertNotifier()
-        : _cappedInsertCount(0) {
+        : _cappedInsertCount(0),
+          _waiters(0) {
     }
 
     void CappedInsertNotifier::notifyOfInsert() {
         stdx::lock_guard<stdx::mutex> lk(_cappedNewDataMutex);
         _cappedInsertCount++;
-        _cappedNewDataNotifier.notify_all();
+        if (_waiters > 0) {
+            _cappedNewDataNotifier.notify_all();
+        }
     }
 
     uint64_t CappedInsertNotifier::getCount() const {
@@ -136,6 +150,8 @@ namespace {
     void CappedInsertNotifier::waitForInsert(uint64_t referenceCount, Microseconds timeout) const {
         stdx::unique_lock<stdx::mutex> lk(_cappedNewDataMutex);
 
+        ++_waiters;
+        ON_BLOCK_EXIT([this] { --_waiters; });
         while (referenceCount == _cappedInsertCount) {
             if (stdx::cv_status::timeout == _cappedNewDataNotifier.wait_for(lk, timeout)) {
                 return;
@@ -143,6 +159,39 @@ namespace {
         }
     }
 
+namespace {
+
+    /**
+     * Notifies the waiters of a capped collection when the unit of work which inserted into it
+     * commits. Waking them any earlier would have them find nothing new and go back to sleep.
+     */
+    class CappedInsertCommitChange : public RecoveryUnit::Change {
+    public:
+        explicit CappedInsertCommitChange(std::shared_ptr<CappedInsertNotifier> notifier)
+            : _notifier(std::move(notifier)) { }
+
+        void commit() override {
+            _notifier->notifyOfInsert();
+        }
+
+        void rollback() override { }
+
+    private:
+        const std::shared_ptr<CappedInsertNotifier> _notifier;
+    };
+
+    void notifyOfCappedInsertOnCommit(OperationContext* txn,
+                                      const std::shared_ptr<CappedInsertNotifier>& notifier) {
+        if (txn->lockState()->inAWriteUnitOfWork()) {
+            txn->recoveryUnit()->registerChange(new CappedInsertCommitChange(notifier));
+        }
+        else {
+            notifier->notifyOfInsert();
+        }
+    }
+
+} // namespace
+
     // ----
 
     Collection::Collection( OperationContext* txn,
@@ -154,6 +203,7 @@ namespace {
           _details( details ),
           _recordStore( recordStore ),
           _dbce( dbce ),
+          _clustered(_details->getCollectionOptions(txn).clustered),
           _infoCache( this ),
           _indexCatalog( this ),
           _validatorDoc(_details->getCollectionOptions(txn).validator.getOwned()),
@@ -161,6 +211,7 @@ namespace {
           _cursorManager(fullNS),
           _cappedNotifier(_recordStore->isCapped() ? new CappedInsertNotifier() : nullptr) {
         _magic = 1357924;
+        _analyzeValidator();
         _indexCatalog.init(txn);
         if ( isCapped() )
             _recordStore->setCappedDeleteCallback( this );
@@ -174,6 +225,11 @@ namespace {
 
     bool Collection::requiresIdIndex() const {
 
+        if (_clustered) {
+            // the record store finds documents by _id
+            return false;
+        }
+
         if ( _ns.ns().find( '$' ) != string::npos ) {
             // no indexes on indexes
             return false;
@@ -239,12 +295,62 @@ namespace {
         if (documentValidationDisabled(txn))
             return Status::OK();
 
-        if (_validator->matchesBSON(document))
+        const bool matches = _compiledValidator ? _compiledValidator->matchesBSON(document)
+                                                : _validator->matchesBSON(document);
+        if (matches)
             return Status::OK();
 
         return {ErrorCodes::DocumentValidationFailure, "Document failed validation"};
     }
 
+    namespace {
+        void addValidatorPaths(const MatchExpression* expr, UpdateIndexData* paths) {
+            // The children of an $elemMatch are relative to its path, which covers them.
+            if (!expr->path().empty()) {
+                paths->addPath(expr->path());
+                return;
+            }
+
+            if (expr->numChildren() == 0) {
+                // Not about any one field, so any update may change the result.
+                paths->allPathsIndexed();
+                return;
+            }
+
+            for (size_t i = 0; i < expr->numChildren(); i++) {
+                addValidatorPaths(expr->getChild(i), paths);
+            }
+        }
+
+        bool anyPathMightBeIndexed(const UpdateIndexData& paths,
+                                   const FieldRefSet& updatedFields) {
+            for (FieldRefSet::const_iterator it = updatedFields.begin();
+                 it != updatedFields.end();
+                 ++it) {
+                if (paths.mightBeIndexed((*it)->dottedField()))
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    bool Collection::validatorDependsOn(const FieldRefSet& updatedFields) const {
+        if (!_validator)
+            return false;
+
+        return anyPathMightBeIndexed(_validatorPaths, updatedFields);
+    }
+
+    void Collection::_analyzeValidator() {
+        _compiledValidator.reset();
+        _validatorPaths.clear();
+        if (!_validator)
+            return;
+
+        _compiledValidator.reset(CompiledMatchExpression::compile(_validator.get()));
+        addValidatorPaths(_validator.get(), &_validatorPaths);
+    }
+
     StatusWith<std::unique_ptr<MatchExpression>> Collection::parseValidator(
             const BSONObj& validator) const {
         if (validator.isEmpty())
@@ -280,6 +386,7 @@ namespace {
         invariant(!_validator || documentValidationDisabled(txn));
         dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
         invariant( !_indexCatalog.haveAnyIndexes() ); // eventually can implement, just not done
+        invariant(!_clustered);
 
         StatusWith<RecordId> loc = _recordStore->insertRecord( txn,
                                                               doc,
@@ -322,16 +429,93 @@ namespace {
                                                                  fromMigrate);
 
             // If there is a notifier object and another thread is waiting on it, then we notify
-            // waiters of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so
-            // there are waiters if this Collection's shared_ptr is not unique.
+            // waiters of this document insert once it commits. Waiters keep a shared_ptr to
+            // '_cappedNotifier', so there are waiters if this Collection's shared_ptr is not unique.
             if (_cappedNotifier && !_cappedNotifier.unique()) {
-                _cappedNotifier->notifyOfInsert();
+                notifyOfCappedInsertOnCommit(txn, _cappedNotifier);
             }
         }
 
         return res;
     }
 
+    Status Collection::insertDocuments(OperationContext* txn,
+                                       std::vector<BSONObj>::const_iterator begin,
+                                       std::vector<BSONObj>::const_iterator end,
+                                       bool enforceQuota,
+                                       bool fromMigrate) {
+        invariant(txn->lockState()->inAWriteUnitOfWork());
+
+        // Capped deletes happen inside insertRecord() and need the indexes to be up to date,
+        // unless they run in a transaction of their own, which can't see the records inserted
+        // here. The documents of clustered collections are inserted at their own RecordIds.
+        if ((isCapped() && !supportsDocLocking()) || _clustered) {
+            for (std::vector<BSONObj>::const_iterator it = begin; it != end; ++it) {
+                StatusWith<RecordId> res = insertDocument(txn, *it, enforceQuota, fromMigrate);
+                if (!res.isOK())
+                    return res.getStatus();
+            }
+            return Status::OK();
+        }
+
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
+
+        const SnapshotId sid = txn->recoveryUnit()->getSnapshotId();
+        const bool needsId = _indexCatalog.findIdIndex( txn );
+
+        std::vector<BSONObj> docs(begin, end);
+        std::vector<Record> records;
+        records.reserve(docs.size());
+        for (size_t i = 0; i < docs.size(); ++i) {
+            const BSONObj& doc = docs[i];
+            {
+                auto status = checkValidation(txn, doc);
+                if (!status.isOK())
+                    return status;
+            }
+
+            if ( needsId && doc["_id"].eoo() ) {
+                return Status( ErrorCodes::InternalError,
+                               str::stream() << "Collection::insertDocument got "
+                               "document without _id for ns:" << _ns.ns() );
+            }
+
+            records.push_back(Record{RecordId(), RecordData(doc.objdata(), doc.objsize())});
+        }
+
+        {
+            auto status = _recordStore->insertRecords(txn, &records, _enforceQuota(enforceQuota));
+            if (!status.isOK())
+                return status;
+        }
+
+        std::vector<RecordId> locs;
+        locs.reserve(records.size());
+        for (const Record& record : records) {
+            invariant( RecordId::min() < record.id );
+            invariant( record.id < RecordId::max() );
+            locs.push_back(record.id);
+        }
+
+        _infoCache.notifyOfWriteOp();
+
+        Status s = _indexCatalog.indexRecords(txn, docs, locs);
+        if (!s.isOK())
+            return s;
+        invariant( sid == txn->recoveryUnit()->getSnapshotId() );
+
+        for (size_t i = 0; i < docs.size(); ++i) {
+            getGlobalServiceContext()->getOpObserver()->onInsert(txn, ns(), docs[i], fromMigrate);
+        }
+
+        // Waiters are notified once for the whole batch, see insertDocument().
+        if (_cappedNotifier && !_cappedNotifier.unique()) {
+            notifyOfCappedInsertOnCommit(txn, _cappedNotifier);
+        }
+
+        return Status::OK();
+    }
+
     StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
                                                     const BSONObj& doc,
                                                     MultiIndexBlock* indexBlock,
@@ -344,10 +528,7 @@ namespace {
 
         dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
 
-        StatusWith<RecordId> loc = _recordStore->insertRecord( txn,
-                                                              doc.objdata(),
-                                                              doc.objsize(),
-                                                              _enforceQuota(enforceQuota) );
+        StatusWith<RecordId> loc = _insertRecord(txn, doc, enforceQuota);
 
         if ( !loc.isOK() )
             return loc;
@@ -359,15 +540,29 @@ namespace {
         getGlobalServiceContext()->getOpObserver()->onInsert(txn, ns(), doc);
 
         // If there is a notifier object and another thread is waiting on it, then we notify waiters
-        // of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so there are
-        // waiters if this Collection's shared_ptr is not unique.
+        // of this document insert once it commits. Waiters keep a shared_ptr to '_cappedNotifier',
+        // so there are waiters if this Collection's shared_ptr is not unique.
         if (_cappedNotifier && !_cappedNotifier.unique()) {
-            _cappedNotifier->notifyOfInsert();
+            notifyOfCappedInsertOnCommit(txn, _cappedNotifier);
         }
 
         return loc;
     }
 
+    std::unique_ptr<RecordStoreBulkLoader> Collection::makeBulkLoader(OperationContext* txn) {
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_X));
+
+        if (txn->writesAreReplicated() ||
+                (_validator && !documentValidationDisabled(txn)) ||
+                _clustered ||
+                _indexCatalog.numIndexesTotal(txn) != 0 ||
+                _recordStore->numRecords(txn) != 0) {
+            return {};
+        }
+
+        return _recordStore->makeBulkLoader(txn);
+    }
+
     StatusWith<RecordId> Collection::_insertDocument( OperationContext* txn,
                                                      const BSONObj& docToInsert,
                                                      bool enforceQuota ) {
@@ -377,10 +572,7 @@ namespace {
         //       under the RecordStore, this feels broken since that should be a
         //       collection access method probably
 
-        StatusWith<RecordId> loc = _recordStore->insertRecord( txn,
-                                                              docToInsert.objdata(),
-                                                              docToInsert.objsize(),
-                                                              _enforceQuota( enforceQuota ) );
+        StatusWith<RecordId> loc = _insertRecord(txn, docToInsert, enforceQuota);
         if ( !loc.isOK() )
             return loc;
 
@@ -396,6 +588,66 @@ namespace {
         return loc;
     }
 
+    StatusWith<RecordId> Collection::_insertRecord(OperationContext* txn,
+                                                   const BSONObj& doc,
+                                                   bool enforceQuota) {
+        if (!_clustered) {
+            return _recordStore->insertRecord(txn,
+                                              doc.objdata(),
+                                              doc.objsize(),
+                                              _enforceQuota(enforceQuota));
+        }
+
+        const BSONElement id = doc["_id"];
+        const RecordId loc = recordIdForId(id);
+        if (loc.isNull()) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "the _id of a document in clustered collection "
+                                        << _ns.ns() << " must be a positive integer, not "
+                                        << id.toString(false));
+        }
+
+        Status status = _recordStore->insertRecordWithId(txn,
+                                                         loc,
+                                                         doc.objdata(),
+                                                         doc.objsize(),
+                                                         _enforceQuota(enforceQuota));
+        if (ErrorCodes::DuplicateKey == status.code()) {
+            return Status(ErrorCodes::DuplicateKey,
+                          str::stream() << "E11000 duplicate key error collection: " << _ns.ns()
+                                        << " dup key: " << id.wrap(""));
+        }
+        if (!status.isOK()) {
+            return status;
+        }
+        return loc;
+    }
+
+    // static
+    RecordId Collection::recordIdForId(const BSONElement& id) {
+        long long value;
+        switch (id.type()) {
+        case NumberInt:
+        case NumberLong:
+            value = id.numberLong();
+            break;
+        case NumberDouble: {
+            // the same _id as the integer it equals
+            const double d = id.numberDouble();
+            if (!(d >= 1 && d < 9007199254740992.0) || d != std::floor(d)) {
+                return RecordId();
+            }
+            value = static_cast<long long>(d);
+            break;
+        }
+        default:
+            return RecordId();
+        }
+
+        const RecordId loc(value);
+        return loc.isNormal() ? loc : RecordId();
+    }
+
     Status Collection::aboutToDeleteCapped( OperationContext* txn,
                                             const RecordId& loc,
                                             RecordData data ) {
@@ -445,6 +697,45 @@ namespace {
         }
     }
 
+    void Collection::deleteDocuments(OperationContext* txn,
+                                     const std::vector<RecordId>& locs,
+                                     bool noWarn) {
+        invariant(txn->lockState()->inAWriteUnitOfWork());
+        if ( isCapped() ) {
+            log() << "failing remove on a capped ns " << _ns << endl;
+            uasserted( 10089,  "cannot remove from a capped collection" );
+            return;
+        }
+
+        std::vector<BSONObj> docs;
+        std::vector<BSONObj> ids;
+        docs.reserve(locs.size());
+        ids.reserve(locs.size());
+        for (size_t i = 0; i < locs.size(); ++i) {
+            docs.push_back(docFor(txn, locs[i]).value());
+
+            BSONElement e = docs.back()["_id"];
+            ids.push_back(e.type() ? e.wrap() : BSONObj());
+
+            /* check if any cursors point to us.  if so, advance them. */
+            _cursorManager.invalidateDocument(txn, locs[i], INVALIDATION_DELETION);
+        }
+
+        _indexCatalog.unindexRecords(txn, docs, locs, noWarn);
+
+        for (size_t i = 0; i < locs.size(); ++i) {
+            _recordStore->deleteRecord(txn, locs[i]);
+        }
+
+        _infoCache.notifyOfWriteOp();
+
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (!ids[i].isEmpty()) {
+                getGlobalServiceContext()->getOpObserver()->onDelete(txn, ns().ns(), ids[i]);
+            }
+        }
+    }
+
     Counter64 moveCounter;
     ServerStatusMetricField<Counter64> moveCounterDisplay( "record.moves", &moveCounter );
 
@@ -455,7 +746,8 @@ namespace {
                                                      bool enforceQuota,
                                                      bool indexesAffected,
                                                      OpDebug* debug,
-                                                     oplogUpdateEntryArgs& args) {
+                                                     oplogUpdateEntryArgs& args,
+                                                     const FieldRefSet* updatedFields) {
         {
             auto status = checkValidation(txn, newDoc);
             if (!status.isOK())
@@ -484,6 +776,21 @@ namespace {
                 IndexCatalogEntry* entry = ii.catalogEntry(descriptor);
                 IndexAccessMethod* iam = ii.accessMethod( descriptor );
 
+                // Recorded as a removal of the old document and, once it is updated, an insertion
+                // of the new one. Done now as the old one may be overwritten in place.
+                if ( IndexBuildSideWrites* sideWrites = entry->sideWrites() ) {
+                    sideWrites->record(txn, IndexBuildSideWrites::kRemove,
+                                       oldDoc.value(), oldLocation);
+                    continue;
+                }
+
+                // An index none of whose paths were updated keeps its keys, so needs no ticket.
+                if ( updatedFields ) {
+                    const UpdateIndexData* indexPaths = _infoCache.indexKeys(txn, descriptor);
+                    if ( indexPaths && !anyPathMightBeIndexed(*indexPaths, *updatedFields) )
+                        continue;
+                }
+
                 InsertDeleteOptions options;
                 options.logIfError = false;
                 options.dupsAllowed =
@@ -551,11 +858,24 @@ namespace {
             IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator( txn, true );
             while ( ii.more() ) {
                 IndexDescriptor* descriptor = ii.next();
+                IndexCatalogEntry* entry = ii.catalogEntry(descriptor);
                 IndexAccessMethod* iam = ii.accessMethod(descriptor);
 
+                if ( IndexBuildSideWrites* sideWrites = entry->sideWrites() ) {
+                    const MatchExpression* filter = entry->getFilterExpression();
+                    if ( !filter || filter->matchesBSON(newDoc) ) {
+                        sideWrites->record(txn, IndexBuildSideWrites::kInsert,
+                                           newDoc, oldLocation);
+                    }
+                    continue;
+                }
+
+                auto ticket = updateTickets.mutableMap().find(descriptor);
+                if ( ticket == updateTickets.mutableMap().end() )
+                    continue;
+
                 int64_t updatedKeys;
-                Status ret = iam->update(
-                    txn, *updateTickets.mutableMap()[descriptor], &updatedKeys);
+                Status ret = iam->update(txn, *ticket->second, &updatedKeys);
                 if ( !ret.isOK() )
                     return StatusWith<RecordId>( ret );
                 if ( debug )
@@ -589,33 +909,42 @@ namespace {
 
 
     bool Collection::updateWithDamagesSupported() const {
-        if (_validator)
-            return false;
-
         return _recordStore->updateWithDamagesSupported();
     }
 
-    Status Collection::updateDocumentWithDamages( OperationContext* txn,
-                                                  const RecordId& loc,
-                                                  const Snapshotted<RecordData>& oldRec,
-                                                  const char* damageSource,
-                                                  const mutablebson::DamageVector& damages,
-                                                  oplogUpdateEntryArgs& args) {
+    bool Collection::updateWithSplicesSupported() const {
+        return updateWithDamagesSupported() && _recordStore->updateWithSplicesSupported();
+    }
+
+    StatusWith<RecordData> Collection::updateDocumentWithDamages(
+            OperationContext* txn,
+            const RecordId& loc,
+            const Snapshotted<RecordData>& oldRec,
+            const char* damageSource,
+            const mutablebson::DamageVector& damages,
+            oplogUpdateEntryArgs& args) {
         dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
         invariant(oldRec.snapshotId() == txn->recoveryUnit()->getSnapshotId());
         invariant(updateWithDamagesSupported());
 
+        {
+            // See validatorDependsOn().
+            auto status = checkValidation(txn, oldRec.value().toBson());
+            if (!status.isOK())
+                return status;
+        }
+
         // Broadcast the mutation so that query results stay correct.
         _cursorManager.invalidateDocument(txn, loc, INVALIDATION_MUTATION);
 
-        Status status = 
+        StatusWith<RecordData> newRecStatus =
             _recordStore->updateWithDamages(txn, loc, oldRec.value(), damageSource, damages);
 
-        if (status.isOK()) {
+        if (newRecStatus.isOK()) {
             args.ns = ns().ns();
             getGlobalServiceContext()->getOpObserver()->onUpdate(txn, args);
         }
-        return status;
+        return newRecStatus;
     }
 
     bool Collection::_enforceQuota( bool userEnforeQuota ) const {
@@ -743,6 +1072,7 @@ namespace {
 
         _validator = std::move(statusWithMatcher.getValue());
         _validatorDoc = std::move(validatorDoc);
+        _analyzeValidator();
         return Status::OK();
     }
 
@@ -760,66 +1090,134 @@ namespace {
             }
 
         };
+
+        /**
+         * The validation of one index of a collection.
+         */
+        struct IndexValidation {
+            IndexValidation(const IndexDescriptor* descriptor, IndexAccessMethod* iam)
+                : descriptor(descriptor), iam(iam), keys(0) {}
+
+            const IndexDescriptor* descriptor;
+            IndexAccessMethod* iam;
+            int64_t keys;
+            BSONObj details;    // only for full validation
+            std::string error;  // set if validating threw
+        };
+
+        void validateIndex(OperationContext* txn, bool full, IndexValidation* index) {
+            log(LogComponent::kIndex) << "validating index "
+                                      << index->descriptor->indexNamespace() << endl;
+            std::unique_ptr<BSONObjBuilder> bob(full ? new BSONObjBuilder() : NULL);
+            index->iam->validate(txn, full, &index->keys, bob.get());
+            if (bob) {
+                index->details = bob->obj();
+            }
+        }
+
+        /**
+         * Validates an index on a thread of the validation's pool, with an OperationContext of its
+         * own but under the collection lock held by the validating thread. Taking locks of its
+         * own could queue it behind an exclusive request waiting for that thread's lock.
+         */
+        void validateIndexOnWorker(bool full, IndexValidation* index) {
+            // ThreadPool only logs exceptions, so keep the error for the validating thread
+            try {
+                Client::initThreadIfNotAlready("validate");
+                OperationContextImpl txn;
+                validateIndex(&txn, full, index);
+            }
+            catch (const DBException& exc) {
+                index->error = exc.toString();
+            }
+            catch (const std::exception& exc) {
+                index->error = exc.what();
+            }
+        }
     }
 
     Status Collection::validate( OperationContext* txn,
                                  bool full, bool scanData,
-                                 ValidateResults* results, BSONObjBuilder* output ){
+                                 ValidateResults* results, BSONObjBuilder* output,
+                                 int parallelism ){
         dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IS));
 
+        std::vector<IndexValidation> indexes;
+        IndexCatalog::IndexIterator i = _indexCatalog.getIndexIterator(txn, false);
+        while( i.more() ) {
+            const IndexDescriptor* descriptor = i.next();
+            IndexAccessMethod* iam = _indexCatalog.getIndex( descriptor );
+            invariant( iam );
+            indexes.push_back(IndexValidation(descriptor, iam));
+        }
+
         MyValidateAdaptor adaptor;
-        Status status = _recordStore->validate( txn, full, scanData, &adaptor, results, output );
+        Status status = Status::OK();
+        parallelism = std::min(parallelism, static_cast<int>(indexes.size()));
+        if (parallelism > 1) {
+            // The indexes are validated on the pool's threads while this thread validates the
+            // record store.
+            ThreadPool pool(parallelism, "validate");
+            for (size_t idxn = 0; idxn < indexes.size(); idxn++) {
+                pool.schedule(&validateIndexOnWorker, full, &indexes[idxn]);
+            }
+            status = _recordStore->validate( txn, full, scanData, &adaptor, results, output );
+            pool.join();
+        }
+        else {
+            status = _recordStore->validate( txn, full, scanData, &adaptor, results, output );
+            for (size_t idxn = 0; status.isOK() && idxn < indexes.size(); idxn++) {
+                try {
+                    validateIndex(txn, full, &indexes[idxn]);
+                }
+                catch ( DBException& exc ) {
+                    indexes[idxn].error = exc.toString();
+                    break;
+                }
+            }
+        }
         if ( !status.isOK() )
             return status;
 
         { // indexes
             output->append("nIndexes", _indexCatalog.numIndexesReady( txn ) );
-            int idxn = 0;
-            try  {
-                // Only applicable when 'full' validation is requested.
-                std::unique_ptr<BSONObjBuilder> indexDetails(full ? new BSONObjBuilder() : NULL);
-                BSONObjBuilder indexes; // not using subObjStart to be exception safe
-
-                IndexCatalog::IndexIterator i = _indexCatalog.getIndexIterator(txn, false);
-                while( i.more() ) {
-                    const IndexDescriptor* descriptor = i.next();
-                    log(LogComponent::kIndex) << "validating index " << descriptor->indexNamespace() << endl;
-                    IndexAccessMethod* iam = _indexCatalog.getIndex( descriptor );
-                    invariant( iam );
-
-                    std::unique_ptr<BSONObjBuilder> bob(
-                        indexDetails.get() ? new BSONObjBuilder(
-                            indexDetails->subobjStart(descriptor->indexNamespace())) :
-                        NULL);
-
-                    int64_t keys;
-                    iam->validate(txn, full, &keys, bob.get());
-                    indexes.appendNumber(descriptor->indexNamespace(),
-                                         static_cast<long long>(keys));
-
-                    if (bob) {
-                        BSONObj obj = bob->done();
-                        BSONElement valid = obj["valid"];
-                        if (valid.ok() && !valid.trueValue()) {
-                            results->valid = false;
-                        }
-                    }
-                    idxn++;
-                }
 
-                output->append("keysPerIndex", indexes.done());
-                if (indexDetails.get()) {
-                    output->append("indexDetails", indexDetails->done());
+            // Only applicable when 'full' validation is requested.
+            std::unique_ptr<BSONObjBuilder> indexDetails(full ? new BSONObjBuilder() : NULL);
+            BSONObjBuilder keysPerIndex;
+
+            size_t idxn = 0;
+            for (; idxn < indexes.size(); idxn++) {
+                const IndexValidation& index = indexes[idxn];
+                if (!index.error.empty()) {
+                    break;
+                }
+                keysPerIndex.appendNumber(index.descriptor->indexNamespace(),
+                                          static_cast<long long>(index.keys));
+
+                if (indexDetails) {
+                    indexDetails->append(index.descriptor->indexNamespace(), index.details);
+                    BSONElement valid = index.details["valid"];
+                    if (valid.ok() && !valid.trueValue()) {
+                        results->valid = false;
+                    }
                 }
             }
-            catch ( DBException& exc ) {
+
+            if (idxn < indexes.size()) {
                 string err = str::stream() <<
                     "exception during index validate idxn "<<
                     BSONObjBuilder::numStr(idxn) <<
-                    ": " << exc.toString();
+                    ": " << indexes[idxn].error;
                 results->errors.push_back( err );
                 results->valid = false;
             }
+            else {
+                output->append("keysPerIndex", keysPerIndex.done());
+                if (indexDetails.get()) {
+                    output->append("indexDetails", indexDetails->done());
+                }
+            }
         }
 
         return Status::OK();
@@ -32,6 +32,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
@@ -54,8 +55,10 @@
 namespace mongo {
 
     class CollectionCatalogEntry;
+    class CompiledMatchExpression;
     class DatabaseCatalogEntry;
     class ExtentManager;
+    class FieldRefSet;
     class IndexCatalog;
     class MatchExpression;
     class MultiIndexBlock;
@@ -73,6 +76,8 @@ namespace mongo {
             validateDocuments = true;
             paddingFactor = 1;
             paddingBytes = 0;
+            online = false;
+            timeSliceSecs = 0;
         }
 
         // padding
@@ -92,15 +97,26 @@ namespace mongo {
         // other
         bool validateDocuments;
 
+        // online compaction runs under intent locks, for at most about timeSliceSecs at a time,
+        // and is called again until CompactStats::finished. Needs RecordStore::compactsOnline().
+        bool online;
+        int timeSliceSecs; // 0 for no limit
+
         std::string toString() const;
     };
 
     struct CompactStats {
         CompactStats() {
             corruptDocuments = 0;
+            finished = true;
+            bytesFreed = 0;
         }
 
         long long corruptDocuments;
+
+        // false if an online compaction ran out of its time slice with more left to do
+        bool finished;
+        long long bytesFreed;
     };
 
     /**
@@ -112,7 +128,12 @@ namespace mongo {
         CappedInsertNotifier();
 
         /**
-         * Wakes up threads waiting on this object for the arrival of new data.
+         * Wakes up threads waiting on this object for the arrival of new data. Should be called
+         * once the inserted data is committed, so that the waiters can see it when they wake up.
+         *
+         * Only threads blocked in waitForInsert() at the time of the call are woken. The ones
+         * busy reading the previous insert will see the new count when they come back, so a burst
+         * of inserts costs each reader a single wakeup.
          */
         void notifyOfInsert();
 
@@ -132,7 +153,8 @@ namespace mongo {
         // Signalled when a successful insert is made into a capped collection.
         mutable stdx::condition_variable _cappedNewDataNotifier;
 
-        // Mutex used with '_cappedNewDataNotifier'. Protects access to '_cappedInsertCount'.
+        // Mutex used with '_cappedNewDataNotifier'. Protects access to '_cappedInsertCount' and
+        // '_waiters'.
         mutable stdx::mutex _cappedNewDataMutex;
 
         // A counter, incremented on insertion of new data into the capped collection.
@@ -140,6 +162,9 @@ namespace mongo {
         // The condition which '_cappedNewDataNotifier' is being notified of is an increment of this
         // counter. Access to this counter is synchronized with '_cappedNewDataMutex'.
         uint64_t _cappedInsertCount;
+
+        // Number of threads blocked in waitForInsert().
+        mutable size_t _waiters;
     };
 
     /**
@@ -176,6 +201,18 @@ namespace mongo {
 
         bool requiresIdIndex() const;
 
+        /**
+         * Whether the record store keys the documents by their _id in place of an _id index, see
+         * CollectionOptions::clustered.
+         */
+        bool isClustered() const { return _clustered; }
+
+        /**
+         * Returns the RecordId of the document with the given _id in a clustered collection, or a
+         * null RecordId if no document can have that _id.
+         */
+        static RecordId recordIdForId(const BSONElement& id);
+
         Snapshotted<BSONObj> docFor(OperationContext* txn, const RecordId& loc) const;
 
         /**
@@ -198,6 +235,15 @@ namespace mongo {
                              bool noWarn = false,
                              BSONObj* deletedId = 0 );
 
+        /**
+         * Deletes the documents at 'locs' like deleteDocument() does for each of them, but
+         * removes all their index keys first, one index at a time in key order, and then the
+         * records. Must be called in a WriteUnitOfWork.
+         */
+        void deleteDocuments( OperationContext* txn,
+                              const std::vector<RecordId>& locs,
+                              bool noWarn = false );
+
         /**
          * this does NOT modify the doc before inserting
          * i.e. will not add an _id field for documents that are missing it
@@ -209,6 +255,21 @@ namespace mongo {
                                             bool enforceQuota,
                                             bool fromMigrate = false);
 
+        /**
+         * Inserts the documents in [begin, end) within the caller's write unit of work. Has the
+         * same requirements as insertDocument for each document and stops at the first one that
+         * fails, returning its error; the caller is expected to abandon the write unit of work
+         * then, as the documents before it have already been inserted.
+         *
+         * Unless the collection is capped, all the records are written first and then indexed
+         * together, one index at a time, so that an error can't be traced back to a document.
+         */
+        Status insertDocuments( OperationContext* txn,
+                                std::vector<BSONObj>::const_iterator begin,
+                                std::vector<BSONObj>::const_iterator end,
+                                bool enforceQuota,
+                                bool fromMigrate = false );
+
         /**
          * Callers must ensure no document validation is performed for this collection when calling
          * this method.
@@ -222,10 +283,22 @@ namespace mongo {
                                             MultiIndexBlock* indexBlock,
                                             bool enforceQuota );
 
+        /**
+         * Returns a loader for appending documents to this collection without a transaction per
+         * document, or nothing if this collection can't be bulk loaded. See RecordStoreBulkLoader.
+         *
+         * Documents added through the loader are neither indexed, validated nor observed by the
+         * OpObserver, so this is only possible on an empty collection without indexes whose
+         * writes aren't replicated and don't need validating.
+         */
+        std::unique_ptr<RecordStoreBulkLoader> makeBulkLoader(OperationContext* txn);
+
         /**
          * updates the document @ oldLocation with newDoc
          * if the document fits in the old space, it is put there
          * if not, it is moved
+         * if 'updatedFields' is given, only the indexes on one of these paths are updated, unless
+         * the document moves
          * @return the post update location of the doc (may or may not be the same as oldLocation)
          */
         StatusWith<RecordId> updateDocument(OperationContext* txn,
@@ -235,20 +308,38 @@ namespace mongo {
                                             bool enforceQuota,
                                             bool indexesAffected,
                                             OpDebug* debug,
-                                            oplogUpdateEntryArgs& args);
+                                            oplogUpdateEntryArgs& args,
+                                            const FieldRefSet* updatedFields = NULL);
 
         bool updateWithDamagesSupported() const;
 
+        /**
+         * Returns false if changing only 'updatedFields' of a document can't change whether
+         * it passes this collection's validator, in which case validating the old document
+         * validates the update too. Only such updates may use updateDocumentWithDamages().
+         */
+        bool validatorDependsOn(const FieldRefSet& updatedFields) const;
+
+        /**
+         * Whether updateDocumentWithDamages() also accepts damages that change the size of the
+         * document.
+         */
+        bool updateWithSplicesSupported() const;
+
         /**
          * Not allowed to modify indexes.
-         * Illegal to call if updateWithDamagesSupported() returns false.
+         * Validates the old document, see validatorDependsOn().
+         * Illegal to call if updateWithDamagesSupported() returns false, or with splices if
+         * updateWithSplicesSupported() returns false.
+         * @return the contents of the updated record, or NeedsDocumentMove if the spliced
+         * document does not fit where it lives and has to go through updateDocument() instead.
          */
-        Status updateDocumentWithDamages(OperationContext* txn,
-                                         const RecordId& loc,
-                                         const Snapshotted<RecordData>& oldRec,
-                                         const char* damageSource,
-                                         const mutablebson::DamageVector& damages,
-                                         oplogUpdateEntryArgs& args);
+        StatusWith<RecordData> updateDocumentWithDamages(OperationContext* txn,
+                                                         const RecordId& loc,
+                                                         const Snapshotted<RecordData>& oldRec,
+                                                         const char* damageSource,
+                                                         const mutablebson::DamageVector& damages,
+                                                         oplogUpdateEntryArgs& args);
 
         // -----------
 
@@ -264,13 +355,16 @@ namespace mongo {
         /**
          * @param full - does more checks
          * @param scanData - scans each document
+         * @param parallelism - how many threads validate the indexes, while the calling thread
+         *                      validates the records
          * @return OK if the validate run successfully
          *         OK will be returned even if corruption is found
          *         deatils will be in result
          */
         Status validate( OperationContext* txn,
                          bool full, bool scanData,
-                         ValidateResults* results, BSONObjBuilder* output );
+                         ValidateResults* results, BSONObjBuilder* output,
+                         int parallelism = 1 );
 
         /**
          * forces data into cache
@@ -341,6 +435,11 @@ namespace mongo {
          */
         StatusWith<std::unique_ptr<MatchExpression>> parseValidator(const BSONObj& validator) const;
 
+        /**
+         * Derives _compiledValidator and _validatorPaths from _validator.
+         */
+        void _analyzeValidator();
+
         Status recordStoreGoingToMove( OperationContext* txn,
                                        const RecordId& oldLocation,
                                        const char* oldBuffer,
@@ -360,6 +459,13 @@ namespace mongo {
                                              const BSONObj& doc,
                                              bool enforceQuota );
 
+        /**
+         * Writes 'doc' to the record store, keyed by its _id if the collection is clustered.
+         */
+        StatusWith<RecordId> _insertRecord(OperationContext* txn,
+                                           const BSONObj& doc,
+                                           bool enforceQuota);
+
         bool _enforceQuota( bool userEnforeQuota ) const;
 
         int _magic;
@@ -368,6 +474,7 @@ namespace mongo {
         CollectionCatalogEntry* _details;
         RecordStore* _recordStore;
         DatabaseCatalogEntry* _dbce;
+        const bool _clustered;
         CollectionInfoCache _infoCache;
         IndexCatalog _indexCatalog;
 
@@ -375,6 +482,10 @@ namespace mongo {
         BSONObj _validatorDoc;
         // Points into _validatorDoc. Null means no filter.
         std::unique_ptr<MatchExpression> _validator;
+        // Points into _validator. Null if no part of it could be compiled.
+        std::unique_ptr<CompiledMatchExpression> _compiledValidator;
+        // The paths the validator looks at, for validatorDependsOn().
+        UpdateIndexData _validatorPaths;
 
         // this is mutable because read only users of the Collection class
         // use it keep state.  This seems valid as const correctness of Collection
@@ -104,7 +104,9 @@ namespace mongo {
 
     StatusWith<CompactStats> Collection::compact( OperationContext* txn,
                                                   const CompactOptions* compactOptions ) {
-        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_X));
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(),
+                                                            compactOptions->online ? MODE_IX :
+                                                                                     MODE_X));
 
         DisableDocumentValidation validationDisabler(txn);
 
@@ -114,6 +116,12 @@ namespace mongo {
                                              "cannot compact collection with record store: " <<
                                              _recordStore->name() );
 
+        if ( compactOptions->online && !_recordStore->compactsOnline() )
+            return StatusWith<CompactStats>( ErrorCodes::CommandNotSupported,
+                                             str::stream() <<
+                                             "cannot compact online with record store: " <<
+                                             _recordStore->name() );
+
         if (_recordStore->compactsInPlace()) {
             // Since we are compacting in-place, we don't need to touch the indexes.
             // TODO SERVER-16856 compact indexes
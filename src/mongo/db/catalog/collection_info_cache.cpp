@@ -35,10 +35,12 @@
 #include "mongo/db/catalog/collection_info_cache.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index_legacy.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/planner_ixselect.h"
 #include "mongo/util/debug_util.h"
@@ -58,10 +60,90 @@ namespace mongo {
         _keysComputed = false;
         computeIndexKeys( txn );
         updatePlanCacheIndexEntries( txn );
+        discardDroppedIndexStats( txn );
+        updateQueryResultCache( txn );
         // query settings is not affected by info cache reset.
         // index filters should persist throughout life of collection
     }
 
+    std::shared_ptr<const IndexStats> CollectionInfoCache::getIndexStats(
+            const std::string& indexName) const {
+        stdx::lock_guard<stdx::mutex> lk(_indexStatsMutex);
+        auto it = _indexStats.find(indexName);
+        return (it == _indexStats.end()) ? std::shared_ptr<const IndexStats>() : it->second;
+    }
+
+    void CollectionInfoCache::setIndexStats(const std::string& indexName,
+                                            std::shared_ptr<const IndexStats> stats) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_indexStatsMutex);
+            _indexStats[indexName] = stats;
+        }
+        clearQueryCache();
+    }
+
+    std::shared_ptr<const std::vector<IndexEntry>> CollectionInfoCache::getPlannerIndexEntries(
+            OperationContext* txn) const {
+        unsigned long long version;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_plannerIndexEntriesMutex);
+            if (_plannerIndexEntries) {
+                return _plannerIndexEntries;
+            }
+            version = _plannerIndexEntriesVersion;
+        }
+
+        auto entries = std::make_shared<std::vector<IndexEntry>>();
+        IndexCatalog::IndexIterator ii = _collection->getIndexCatalog()->getIndexIterator(txn,
+                                                                                         false);
+        while (ii.more()) {
+            const IndexDescriptor* desc = ii.next();
+            if (IndexNames::SUMMARY == desc->getAccessMethodName()) {
+                // only answers counts and sums, see getExecutorCount() and PipelineD
+                continue;
+            }
+            const IndexCatalogEntry* ice = ii.catalogEntry(desc);
+            entries->emplace_back(desc->keyPattern(),
+                                  desc->getAccessMethodName(),
+                                  desc->isMultikey(txn),
+                                  desc->isSparse(),
+                                  desc->unique(),
+                                  desc->indexName(),
+                                  ice->getFilterExpression(),
+                                  desc->infoObj());
+
+            std::shared_ptr<const IndexStats> stats = getIndexStats(desc->indexName());
+            if (stats && 0 == stats->getKeyPattern().woCompare(desc->keyPattern())) {
+                entries->back().stats = stats;
+            }
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_plannerIndexEntriesMutex);
+        if (version == _plannerIndexEntriesVersion) {
+            _plannerIndexEntries = entries;
+        }
+        return entries;
+    }
+
+    void CollectionInfoCache::invalidatePlannerIndexEntries() {
+        stdx::lock_guard<stdx::mutex> lk(_plannerIndexEntriesMutex);
+        _plannerIndexEntries.reset();
+        _plannerIndexEntriesVersion++;
+    }
+
+    void CollectionInfoCache::discardDroppedIndexStats( OperationContext* txn ) {
+        stdx::lock_guard<stdx::mutex> lk(_indexStatsMutex);
+        auto it = _indexStats.begin();
+        while (it != _indexStats.end()) {
+            if (!_collection->getIndexCatalog()->findIndexByName(txn, it->first, true)) {
+                it = _indexStats.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
     const UpdateIndexData& CollectionInfoCache::indexKeys( OperationContext* txn ) const {
         // This requires "some" lock, and MODE_IS is an expression for that, for now.
         dassert(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_IS));
@@ -69,58 +151,78 @@ namespace mongo {
         return _indexedPaths;
     }
 
-    void CollectionInfoCache::computeIndexKeys( OperationContext* txn ) {
-        // This function modified objects attached to the Collection so we need a write lock
-        invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
-        _indexedPaths.clear();
+    const UpdateIndexData* CollectionInfoCache::indexKeys(
+            OperationContext* txn,
+            const IndexDescriptor* descriptor) const {
+        dassert(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_IS));
+        invariant(_keysComputed);
+        auto it = _indexedPathsByIndex.find(descriptor);
+        return (it == _indexedPathsByIndex.end()) ? NULL : &it->second;
+    }
 
-        IndexCatalog::IndexIterator i = _collection->getIndexCatalog()->getIndexIterator(txn, true);
-        while (i.more()) {
-            IndexDescriptor* descriptor = i.next();
+namespace {
 
-            if (descriptor->getAccessMethodName() != IndexNames::TEXT) {
-                BSONObj key = descriptor->keyPattern();
-                BSONObjIterator j(key);
-                while (j.more()) {
-                    BSONElement e = j.next();
-                    _indexedPaths.addPath(e.fieldName());
-                }
+    void addIndexPaths(const IndexDescriptor* descriptor,
+                       const IndexCatalogEntry* entry,
+                       UpdateIndexData* indexedPaths) {
+        if (descriptor->getAccessMethodName() != IndexNames::TEXT) {
+            BSONObj key = descriptor->keyPattern();
+            BSONObjIterator j(key);
+            while (j.more()) {
+                BSONElement e = j.next();
+                indexedPaths->addPath(e.fieldName());
             }
-            else {
-                fts::FTSSpec ftsSpec(descriptor->infoObj());
+        }
+        else {
+            fts::FTSSpec ftsSpec(descriptor->infoObj());
 
-                if (ftsSpec.wildcard()) {
-                    _indexedPaths.allPathsIndexed();
+            if (ftsSpec.wildcard()) {
+                indexedPaths->allPathsIndexed();
+            }
+            else {
+                for (size_t i = 0; i < ftsSpec.numExtraBefore(); ++i) {
+                    indexedPaths->addPath(ftsSpec.extraBefore(i));
                 }
-                else {
-                    for (size_t i = 0; i < ftsSpec.numExtraBefore(); ++i) {
-                        _indexedPaths.addPath(ftsSpec.extraBefore(i));
-                    }
-                    for (fts::Weights::const_iterator it = ftsSpec.weights().begin();
-                         it != ftsSpec.weights().end();
-                         ++it) {
-                        _indexedPaths.addPath(it->first);
-                    }
-                    for (size_t i = 0; i < ftsSpec.numExtraAfter(); ++i) {
-                        _indexedPaths.addPath(ftsSpec.extraAfter(i));
-                    }
-                    // Any update to a path containing "language" as a component could change the
-                    // language of a subdocument.  Add the override field as a path component.
-                    _indexedPaths.addPathComponent(ftsSpec.languageOverrideField());
+                for (fts::Weights::const_iterator it = ftsSpec.weights().begin();
+                     it != ftsSpec.weights().end();
+                     ++it) {
+                    indexedPaths->addPath(it->first);
                 }
+                for (size_t i = 0; i < ftsSpec.numExtraAfter(); ++i) {
+                    indexedPaths->addPath(ftsSpec.extraAfter(i));
+                }
+                // Any update to a path containing "language" as a component could change the
+                // language of a subdocument.  Add the override field as a path component.
+                indexedPaths->addPathComponent(ftsSpec.languageOverrideField());
             }
+        }
 
-            // handle partial indexes
-            const IndexCatalogEntry* entry = i.catalogEntry(descriptor);
-            const MatchExpression* filter = entry->getFilterExpression();
-            if (filter) {
-                unordered_set<std::string> paths;
-                QueryPlannerIXSelect::getFields(filter, "", &paths);
-                for (auto it = paths.begin(); it != paths.end(); ++it) {
-                    _indexedPaths.addPath(*it);
-                }
+        // handle partial indexes
+        const MatchExpression* filter = entry->getFilterExpression();
+        if (filter) {
+            unordered_set<std::string> paths;
+            QueryPlannerIXSelect::getFields(filter, "", &paths);
+            for (auto it = paths.begin(); it != paths.end(); ++it) {
+                indexedPaths->addPath(*it);
             }
         }
+    }
+
+} // namespace
+
+    void CollectionInfoCache::computeIndexKeys( OperationContext* txn ) {
+        // This function modified objects attached to the Collection so we need a write lock
+        invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
+        _indexedPaths.clear();
+        _indexedPathsByIndex.clear();
+
+        IndexCatalog::IndexIterator i = _collection->getIndexCatalog()->getIndexIterator(txn, true);
+        while (i.more()) {
+            IndexDescriptor* descriptor = i.next();
+            const IndexCatalogEntry* entry = i.catalogEntry(descriptor);
+            addIndexPaths(descriptor, entry, &_indexedPaths);
+            addIndexPaths(descriptor, entry, &_indexedPathsByIndex[descriptor]);
+        }
 
         _keysComputed = true;
 
@@ -133,6 +235,7 @@ namespace mongo {
     }
 
     void CollectionInfoCache::clearQueryCache() {
+        invalidatePlannerIndexEntries();
         if (NULL != _planCache.get()) {
             _planCache->clear();
         }
@@ -146,6 +249,21 @@ namespace mongo {
         return _querySettings.get();
     }
 
+    QueryResultCache* CollectionInfoCache::getQueryResultCache() const {
+        return _resultCache.get();
+    }
+
+    void CollectionInfoCache::updateQueryResultCache( OperationContext* txn ) {
+        invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
+        const int flags = _collection->getCatalogEntry()->getCollectionOptions(txn).flags;
+        if (!(flags & CollectionOptions::Flag_QueryResultCache)) {
+            _resultCache.reset();
+        }
+        else if (!_resultCache) {
+            _resultCache.reset(new QueryResultCache());
+        }
+    }
+
     void CollectionInfoCache::updatePlanCacheIndexEntries(OperationContext* txn) {
         std::vector<IndexEntry> indexEntries;
 
@@ -156,6 +274,9 @@ namespace mongo {
             _collection->getIndexCatalog()->getIndexIterator(txn, includeUnfinishedIndexes);
         while (ii.more()) {
             const IndexDescriptor* desc = ii.next();
+            if (IndexNames::SUMMARY == desc->getAccessMethodName()) {
+                continue;
+            }
             const IndexCatalogEntry* ice = ii.catalogEntry(desc);
             indexEntries.emplace_back(desc->keyPattern(),
                                       desc->getAccessMethodName(),
@@ -30,14 +30,23 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "mongo/db/query/index_entry.h"
+#include "mongo/db/query/index_stats.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/query_result_cache.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
     class Collection;
+    class IndexDescriptor;
 
     /**
      * this is for storing things that you want to cache about a single collection
@@ -67,6 +76,46 @@ namespace mongo {
          */
         QuerySettings* getQuerySettings() const;
 
+        /**
+         * Get the QueryResultCache for this collection, or NULL if it has no 'queryResultCache'
+         * option.
+         */
+        QueryResultCache* getQueryResultCache() const;
+
+        /**
+         * Creates or destroys the QueryResultCache according to the collection's options. Must be
+         * called under exclusive collection lock.
+         */
+        void updateQueryResultCache( OperationContext* txn );
+
+        /**
+         * Get the statistics that 'analyze' gathered for the index named 'indexName', or NULL if
+         * there are none. Callers should check that the statistics' key pattern matches that of
+         * the index, in case it was dropped and recreated under the same name. May be called
+         * under any collection lock.
+         */
+        std::shared_ptr<const IndexStats> getIndexStats(const std::string& indexName) const;
+
+        /**
+         * Replaces the statistics of the index named 'indexName' and clears the plan cache, so
+         * that the planner takes them into account. May be called under any collection lock.
+         */
+        void setIndexStats(const std::string& indexName, std::shared_ptr<const IndexStats> stats);
+
+        /**
+         * Returns the IndexEntry of every ready index, with its statistics, for the planner. They
+         * are built once and shared until the plan cache is cleared, which happens whenever an
+         * index is created or dropped, becomes multikey or gets new statistics. May be called
+         * under any collection lock.
+         */
+        std::shared_ptr<const std::vector<IndexEntry>> getPlannerIndexEntries(
+                OperationContext* txn) const;
+
+        /**
+         * Makes the next getPlannerIndexEntries() build the entries again.
+         */
+        void invalidatePlannerIndexEntries();
+
         // -------------------
 
         /* get set of index keys for this namespace.  handy to quickly check if a given
@@ -74,6 +123,13 @@ namespace mongo {
         */
         const UpdateIndexData& indexKeys( OperationContext* txn ) const;
 
+        /**
+         * Returns the paths of the single index 'descriptor', that is those of its keys and
+         * partial filter, or NULL if the cache doesn't know the index.
+         */
+        const UpdateIndexData* indexKeys( OperationContext* txn,
+                                          const IndexDescriptor* descriptor ) const;
+
         // ---------------------
 
         /**
@@ -93,6 +149,7 @@ namespace mongo {
         // ---  index keys cache
         bool _keysComputed;
         UpdateIndexData _indexedPaths;
+        std::map<const IndexDescriptor*, UpdateIndexData> _indexedPathsByIndex;
 
         // A cache for query plans.
         std::unique_ptr<PlanCache> _planCache;
@@ -101,12 +158,29 @@ namespace mongo {
         // Includes index filters.
         std::unique_ptr<QuerySettings> _querySettings;
 
+        // Complete query results, only for collections with the 'queryResultCache' option.
+        std::unique_ptr<QueryResultCache> _resultCache;
+
+        // Index statistics by index name. They outlive resets, but those of dropped indexes are
+        // discarded then.
+        mutable stdx::mutex _indexStatsMutex;
+        std::map<std::string, std::shared_ptr<const IndexStats>> _indexStats;
+
+        // What getPlannerIndexEntries() returns, or NULL until it builds the entries again.
+        // _plannerIndexEntriesVersion counts the invalidations, so that entries built from the
+        // catalog as it was before one aren't kept.
+        mutable stdx::mutex _plannerIndexEntriesMutex;
+        mutable std::shared_ptr<const std::vector<IndexEntry>> _plannerIndexEntries;
+        unsigned long long _plannerIndexEntriesVersion = 0;
+
         /**
          * Must be called under exclusive DB lock.
          */
         void computeIndexKeys( OperationContext* txn );
 
         void updatePlanCacheIndexEntries( OperationContext* txn );
+
+        void discardDroppedIndexStats( OperationContext* txn );
     };
 
 }  // namespace mongo
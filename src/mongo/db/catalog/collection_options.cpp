@@ -62,6 +62,7 @@ namespace mongo {
         flags = Flag_UsePowerOf2Sizes;
         flagsSet = false;
         temp = false;
+        clustered = false;
         storageEngine = BSONObj();
         validator = BSONObj();
     }
@@ -133,6 +134,9 @@ namespace mongo {
             else if ( fieldName == "temp" ) {
                 temp = e.trueValue();
             }
+            else if (fieldName == "clustered") {
+                clustered = e.trueValue();
+            }
             else if (fieldName == "storageEngine") {
                 // Storage engine-specific collection options.
                 // "storageEngine" field must be of type "document".
@@ -173,6 +177,13 @@ namespace mongo {
             }
         }
 
+        if (clustered && capped) {
+            return Status(ErrorCodes::BadValue, "a capped collection can't be clustered");
+        }
+        if (clustered && autoIndexId == YES) {
+            return Status(ErrorCodes::BadValue, "a clustered collection has no _id index");
+        }
+
         return Status::OK();
     }
 
@@ -200,6 +211,9 @@ namespace mongo {
         if ( temp )
             b.appendBool( "temp", true );
 
+        if (clustered)
+            b.appendBool("clustered", true);
+
         if (!storageEngine.isEmpty()) {
             b.append("storageEngine", storageEngine);
         }
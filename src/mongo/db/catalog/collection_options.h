@@ -87,12 +87,18 @@ namespace mongo {
         enum UserFlags {
             Flag_UsePowerOf2Sizes = 1 << 0,
             Flag_NoPadding = 1 << 1,
+            Flag_QueryResultCache = 1 << 2,
         };
         int flags; // a bitvector of UserFlags
         bool flagsSet;
 
         bool temp;
 
+        // Whether the record store keys the documents by their _id, which must then be a positive
+        // integer, in place of an _id index. Only for non-capped collections on storage engines
+        // that can insert records with a given RecordId.
+        bool clustered;
+
         // Storage engine collection options. Always owned or empty.
         BSONObj storageEngine;
 
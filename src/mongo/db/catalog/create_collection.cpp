@@ -42,7 +42,8 @@
 namespace mongo {
     Status createCollection(OperationContext* txn,
                             const std::string& dbName,
-                            const BSONObj& cmdObj) {
+                            const BSONObj& cmdObj,
+                            bool createDefaultIndexes) {
         BSONObjIterator it(cmdObj);
 
         // Extract ns from first cmdObj element.
@@ -83,7 +84,7 @@ namespace mongo {
             WriteUnitOfWork wunit(txn);
 
             // Create collection.
-            status = userCreateNS(txn, ctx.db(), nss.ns(), options);
+            status = userCreateNS(txn, ctx.db(), nss.ns(), options, createDefaultIndexes);
             if (!status.isOK()) {
                 return status;
             }
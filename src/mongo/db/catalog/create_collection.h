@@ -35,9 +35,11 @@ namespace mongo {
     class OperationContext;
 
     /**
-     * Creates a collection as described in "cmdObj" on the database "dbName".
+     * Creates a collection as described in "cmdObj" on the database "dbName". If
+     * "createDefaultIndexes" is false, the collection is created without its _id index.
      */
     Status createCollection(OperationContext* txn,
                             const std::string& dbName,
-                            const BSONObj& cmdObj);
+                            const BSONObj& cmdObj,
+                            bool createDefaultIndexes = true);
 } // namespace mongo
@@ -38,6 +38,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/client.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/operation_context.h"
@@ -227,7 +228,9 @@ namespace mongo {
         }
 
         // If not, then the cursor must be owned by a collection.  Erase the cursor under the
-        // collection lock (to prevent the collection from going away during the erase).
+        // collection lock (to prevent the collection from going away during the erase), once
+        // any prefetch of its next batch has let go of it.
+        CursorPrefetcher::get()->waitFor(id);
         AutoGetCollectionForRead ctx(txn, nss);
         Collection* collection = ctx.getCollection();
         if (!collection) {
@@ -317,10 +320,11 @@ namespace mongo {
 
 
     CursorManager::CursorManager( StringData ns )
-        : _nss( ns ),
-          _mutex( "CursorManager" ) {
+        : _nss( ns ) {
         _collectionCacheRuntimeId = globalCursorIdCache->created( _nss.ns() );
-        _random.reset( new PseudoRandom( globalCursorIdCache->nextSeed() ) );
+        for ( size_t i = 0; i < kNumPartitions; i++ ) {
+            _partitions[i].random.reset( new PseudoRandom( globalCursorIdCache->nextSeed() ) );
+        }
     }
 
     CursorManager::~CursorManager() {
@@ -330,71 +334,80 @@ namespace mongo {
 
     void CursorManager::invalidateAll(bool collectionGoingAway,
                                       const std::string& reason) {
-        SimpleMutex::scoped_lock lk( _mutex );
-
-        for ( ExecSet::iterator it = _nonCachedExecutors.begin();
-              it != _nonCachedExecutors.end();
-              ++it ) {
-
-            // we kill the executor, but it deletes itself
-            PlanExecutor* exec = *it;
-            exec->kill(reason);
-            invariant( exec->collection() == NULL );
-        }
-        _nonCachedExecutors.clear();
-
-        if ( collectionGoingAway ) {
-            // we're going to wipe out the world
-            for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-                ClientCursor* cc = i->second;
+        for ( size_t p = 0; p < kNumPartitions; p++ ) {
+            Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock lk( partition.mutex );
+
+            for ( ExecSet::iterator it = partition.nonCachedExecutors.begin();
+                  it != partition.nonCachedExecutors.end();
+                  ++it ) {
+
+                // we kill the executor, but it deletes itself
+                PlanExecutor* exec = *it;
+                exec->kill(reason);
+                invariant( exec->collection() == NULL );
+            }
+            partition.nonCachedExecutors.clear();
 
-                cc->kill();
+            if ( collectionGoingAway ) {
+                // we're going to wipe out the world
+                for ( CursorMap::const_iterator i = partition.cursors.begin();
+                      i != partition.cursors.end();
+                      ++i ) {
+                    ClientCursor* cc = i->second;
 
-                invariant( cc->getExecutor() == NULL || cc->getExecutor()->collection() == NULL );
+                    cc->kill();
 
-                // If the CC is pinned, somebody is actively using it and we do not delete it.
-                // Instead we notify the holder that we killed it.  The holder will then delete the
-                // CC.
-                //
-                // If the CC is not pinned, there is nobody actively holding it.  We can safely
-                // delete it.
-                if (!cc->isPinned()) {
-                    delete cc;
+                    invariant( cc->getExecutor() == NULL
+                               || cc->getExecutor()->collection() == NULL );
+
+                    // If the CC is pinned, somebody is actively using it and we do not delete it.
+                    // Instead we notify the holder that we killed it.  The holder will then
+                    // delete the CC.
+                    //
+                    // If the CC is not pinned, there is nobody actively holding it.  We can
+                    // safely delete it.
+                    if (!cc->isPinned()) {
+                        delete cc;
+                    }
                 }
             }
-        }
-        else {
-            CursorMap newMap;
+            else {
+                CursorMap newMap;
+
+                // collection will still be around, just all PlanExecutors are invalid
+                for ( CursorMap::const_iterator i = partition.cursors.begin();
+                      i != partition.cursors.end();
+                      ++i ) {
+                    ClientCursor* cc = i->second;
+
+                    // Note that a valid ClientCursor state is "no cursor no executor."  This is
+                    // because the set of active cursor IDs in ClientCursor is used as
+                    // representation of query state.  See sharding_block.h.  TODO(greg,hk): Move
+                    // this out.
+                    if (NULL == cc->getExecutor() ) {
+                        newMap.insert( *i );
+                        continue;
+                    }
+
+                    if (cc->isPinned() || cc->isAggCursor()) {
+                        // Pinned cursors need to stay alive, so we leave them around.
+                        // Aggregation cursors also can stay alive (since they don't have their
+                        // lifetime bound to the underlying collection).  However, if they have an
+                        // associated executor, we need to kill it, because it's now invalid.
+                        if ( cc->getExecutor() )
+                            cc->getExecutor()->kill(reason);
+                        newMap.insert( *i );
+                    }
+                    else {
+                        cc->kill();
+                        delete cc;
+                    }
 
-            // collection will still be around, just all PlanExecutors are invalid
-            for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-                ClientCursor* cc = i->second;
-
-                // Note that a valid ClientCursor state is "no cursor no executor."  This is because
-                // the set of active cursor IDs in ClientCursor is used as representation of query
-                // state.  See sharding_block.h.  TODO(greg,hk): Move this out.
-                if (NULL == cc->getExecutor() ) {
-                    newMap.insert( *i );
-                    continue;
-                }
-
-                if (cc->isPinned() || cc->isAggCursor()) {
-                    // Pinned cursors need to stay alive, so we leave them around.  Aggregation
-                    // cursors also can stay alive (since they don't have their lifetime bound to
-                    // the underlying collection).  However, if they have an associated executor, we
-                    // need to kill it, because it's now invalid.
-                    if ( cc->getExecutor() )
-                        cc->getExecutor()->kill(reason);
-                    newMap.insert( *i );
-                }
-                else {
-                    cc->kill();
-                    delete cc;
                 }
 
+                partition.cursors = newMap;
             }
-
-            _cursors = newMap;
         }
     }
 
@@ -407,61 +420,79 @@ namespace mongo {
             return;
         }
 
-        SimpleMutex::scoped_lock lk( _mutex );
-
-        for ( ExecSet::iterator it = _nonCachedExecutors.begin();
-              it != _nonCachedExecutors.end();
-              ++it ) {
+        for ( size_t p = 0; p < kNumPartitions; p++ ) {
+            Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock lk( partition.mutex );
 
-            PlanExecutor* exec = *it;
-            exec->invalidate(txn, dl, type);
-        }
+            for ( ExecSet::iterator it = partition.nonCachedExecutors.begin();
+                  it != partition.nonCachedExecutors.end();
+                  ++it ) {
 
-        for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-            PlanExecutor* exec = i->second->getExecutor();
-            if ( exec ) {
+                PlanExecutor* exec = *it;
                 exec->invalidate(txn, dl, type);
             }
+
+            for ( CursorMap::const_iterator i = partition.cursors.begin();
+                  i != partition.cursors.end();
+                  ++i ) {
+                PlanExecutor* exec = i->second->getExecutor();
+                if ( exec ) {
+                    exec->invalidate(txn, dl, type);
+                }
+            }
         }
     }
 
     std::size_t CursorManager::timeoutCursors( int millisSinceLastCall ) {
-        SimpleMutex::scoped_lock lk( _mutex );
+        size_t numTimedOut = 0;
 
-        vector<ClientCursor*> toDelete;
+        for ( size_t p = 0; p < kNumPartitions; p++ ) {
+            Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock lk( partition.mutex );
 
-        for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-            ClientCursor* cc = i->second;
-            if ( cc->shouldTimeout( millisSinceLastCall ) )
-                toDelete.push_back( cc );
-        }
+            vector<ClientCursor*> toDelete;
+
+            for ( CursorMap::const_iterator i = partition.cursors.begin();
+                  i != partition.cursors.end();
+                  ++i ) {
+                ClientCursor* cc = i->second;
+                if ( cc->shouldTimeout( millisSinceLastCall ) )
+                    toDelete.push_back( cc );
+            }
+
+            for ( vector<ClientCursor*>::const_iterator i = toDelete.begin();
+                    i != toDelete.end(); ++i ) {
+                ClientCursor* cc = *i;
+                _deregisterCursor_inlock( &partition, cc );
+                cc->kill();
+                delete cc;
+            }
 
-        for ( vector<ClientCursor*>::const_iterator i = toDelete.begin();
-                i != toDelete.end(); ++i ) {
-            ClientCursor* cc = *i;
-            _deregisterCursor_inlock( cc );
-            cc->kill();
-            delete cc;
+            numTimedOut += toDelete.size();
         }
 
-        return toDelete.size();
+        return numTimedOut;
     }
 
     void CursorManager::registerExecutor( PlanExecutor* exec ) {
-        SimpleMutex::scoped_lock lk(_mutex);
-        const std::pair<ExecSet::iterator, bool> result = _nonCachedExecutors.insert(exec);
+        Partition& partition = _partitions[_partitionNumForPointer( exec )];
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        const std::pair<ExecSet::iterator, bool> result =
+            partition.nonCachedExecutors.insert(exec);
         invariant(result.second); // make sure this was inserted
     }
 
     void CursorManager::deregisterExecutor( PlanExecutor* exec ) {
-        SimpleMutex::scoped_lock lk(_mutex);
-        _nonCachedExecutors.erase(exec);
+        Partition& partition = _partitions[_partitionNumForPointer( exec )];
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        partition.nonCachedExecutors.erase(exec);
     }
 
     ClientCursor* CursorManager::find( CursorId id, bool pin ) {
-        SimpleMutex::scoped_lock lk( _mutex );
-        CursorMap::const_iterator it = _cursors.find( id );
-        if ( it == _cursors.end() )
+        Partition& partition = _partitions[_partitionNumForCursorId( id )];
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        CursorMap::const_iterator it = partition.cursors.find( id );
+        if ( it == partition.cursors.end() )
             return NULL;
 
         ClientCursor* cursor = it->second;
@@ -476,7 +507,8 @@ namespace mongo {
     }
 
     void CursorManager::unpin( ClientCursor* cursor ) {
-        SimpleMutex::scoped_lock lk( _mutex );
+        Partition& partition = _partitions[_partitionNumForCursorId( cursor->cursorid() )];
+        SimpleMutex::scoped_lock lk( partition.mutex );
 
         invariant( cursor->isPinned() );
         cursor->unsetPinned();
@@ -487,24 +519,50 @@ namespace mongo {
     }
 
     void CursorManager::getCursorIds( std::set<CursorId>* openCursors ) const {
-        SimpleMutex::scoped_lock lk( _mutex );
+        for ( size_t p = 0; p < kNumPartitions; p++ ) {
+            const Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock lk( partition.mutex );
 
-        for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-            ClientCursor* cc = i->second;
-            openCursors->insert( cc->cursorid() );
+            for ( CursorMap::const_iterator i = partition.cursors.begin();
+                  i != partition.cursors.end();
+                  ++i ) {
+                ClientCursor* cc = i->second;
+                openCursors->insert( cc->cursorid() );
+            }
         }
     }
 
     size_t CursorManager::numCursors() const {
-        SimpleMutex::scoped_lock lk( _mutex );
-        return _cursors.size();
+        size_t num = 0;
+        for ( size_t p = 0; p < kNumPartitions; p++ ) {
+            const Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock lk( partition.mutex );
+            num += partition.cursors.size();
+        }
+        return num;
+    }
+
+    // static
+    size_t CursorManager::_partitionNumForPointer( const void* registered ) {
+        // Heap addresses share their low bits, so mix them before taking the remainder.
+        uint64_t x = reinterpret_cast<uintptr_t>( registered );
+        x *= 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>( x >> 32 ) % kNumPartitions;
+    }
+
+    // static
+    size_t CursorManager::_partitionNumForCursorId( CursorId id ) {
+        return static_cast<unsigned>( id ) % kNumPartitions;
     }
 
-    CursorId CursorManager::_allocateCursorId_inlock() {
+    CursorId CursorManager::_allocateCursorId_inlock( Partition* partition,
+                                                      size_t partitionNum ) {
         for ( int i = 0; i < 10000; i++ ) {
-            unsigned mypart = static_cast<unsigned>( _random->nextInt32() );
+            // The low bits of the cursor's part of the id name its partition.
+            unsigned mypart = static_cast<unsigned>( partition->random->nextInt32() );
+            mypart = static_cast<unsigned>( mypart - mypart % kNumPartitions + partitionNum );
             CursorId id = cursorIdFromParts( _collectionCacheRuntimeId, mypart );
-            if ( _cursors.count( id ) == 0 )
+            if ( partition->cursors.count( id ) == 0 )
                 return id;
         }
         fassertFailed( 17360 );
@@ -512,22 +570,26 @@ namespace mongo {
 
     CursorId CursorManager::registerCursor( ClientCursor* cc ) {
         invariant( cc );
-        SimpleMutex::scoped_lock lk( _mutex );
-        CursorId id = _allocateCursorId_inlock();
-        _cursors[id] = cc;
+        const size_t partitionNum = _partitionNumForPointer( cc );
+        Partition& partition = _partitions[partitionNum];
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        CursorId id = _allocateCursorId_inlock( &partition, partitionNum );
+        partition.cursors[id] = cc;
         return id;
     }
 
     void CursorManager::deregisterCursor( ClientCursor* cc ) {
-        SimpleMutex::scoped_lock lk( _mutex );
-        _deregisterCursor_inlock( cc );
+        Partition& partition = _partitions[_partitionNumForCursorId( cc->cursorid() )];
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        _deregisterCursor_inlock( &partition, cc );
     }
 
     bool CursorManager::eraseCursor(OperationContext* txn, CursorId id, bool checkAuth) {
-        SimpleMutex::scoped_lock lk( _mutex );
+        Partition& partition = _partitions[_partitionNumForCursorId( id )];
+        SimpleMutex::scoped_lock lk( partition.mutex );
 
-        CursorMap::iterator it = _cursors.find( id );
-        if ( it == _cursors.end() ) {
+        CursorMap::iterator it = partition.cursors.find( id );
+        if ( it == partition.cursors.end() ) {
             if ( checkAuth )
                 audit::logKillCursorsAuthzCheck( txn->getClient(),
                                                  _nss,
@@ -549,15 +611,15 @@ namespace mongo {
                  !cursor->isPinned() );
 
         cursor->kill();
-        _deregisterCursor_inlock( cursor );
+        _deregisterCursor_inlock( &partition, cursor );
         delete cursor;
         return true;
     }
 
-    void CursorManager::_deregisterCursor_inlock( ClientCursor* cc ) {
+    void CursorManager::_deregisterCursor_inlock( Partition* partition, ClientCursor* cc ) {
         invariant( cc );
         CursorId id = cc->cursorid();
-        _cursors.erase( id );
+        partition->cursors.erase( id );
     }
 
 }
@@ -138,20 +138,42 @@ namespace mongo {
         static std::size_t timeoutCursorsGlobal(OperationContext* txn, int millisSinceLastCall);
 
     private:
-        CursorId _allocateCursorId_inlock();
-        void _deregisterCursor_inlock( ClientCursor* cc );
+        typedef unordered_set<PlanExecutor*> ExecSet;
+        typedef std::map<CursorId,ClientCursor*> CursorMap;
 
-        NamespaceString _nss;
-        unsigned _collectionCacheRuntimeId;
-        std::unique_ptr<PseudoRandom> _random;
+        /**
+         * The registry is split into partitions, each with its own mutex, so that threads
+         * registering executors and cursors rarely wait for each other.  An executor lives in the
+         * partition its address hashes to.  A cursor lives in the partition given by the low bits
+         * of its id, which is allocated to match the partition its address hashes to.
+         *
+         * Operations on every executor or cursor, such as invalidation, lock each partition in
+         * turn rather than all of them at once.
+         */
+        struct Partition {
+            Partition() : mutex( "CursorManager" ) { }
 
-        mutable SimpleMutex _mutex;
+            mutable SimpleMutex mutex;
 
-        typedef unordered_set<PlanExecutor*> ExecSet;
-        ExecSet _nonCachedExecutors;
+            // Generates the random part of the ids of cursors in this partition.
+            std::unique_ptr<PseudoRandom> random;
 
-        typedef std::map<CursorId,ClientCursor*> CursorMap;
-        CursorMap _cursors;
+            ExecSet nonCachedExecutors;
+            CursorMap cursors;
+        };
+
+        static const size_t kNumPartitions = 16;
+
+        static size_t _partitionNumForPointer( const void* registered );
+        static size_t _partitionNumForCursorId( CursorId id );
+
+        CursorId _allocateCursorId_inlock( Partition* partition, size_t partitionNum );
+        void _deregisterCursor_inlock( Partition* partition, ClientCursor* cc );
+
+        NamespaceString _nss;
+        unsigned _collectionCacheRuntimeId;
+
+        Partition _partitions[kNumPartitions];
     };
 
 }
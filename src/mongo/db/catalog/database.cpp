@@ -520,6 +520,11 @@ namespace mongo {
         invariant(collection);
         _collections[ns] = collection;
 
+        uassert(28795,
+                str::stream() << "can't create clustered collection " << ns
+                              << " with this storage engine",
+                !options.clustered || collection->getRecordStore()->supportsInsertWithId());
+
         if ( createIdIndex ) {
             if ( collection->requiresIdIndex() ) {
                 if ( options.autoIndexId == CollectionOptions::YES ||
@@ -151,7 +151,7 @@ namespace mongo {
         // TODO: make sure deletes go through
         // this in some ways is a dupe of _namespaceIndex
         // but it points to a much more useful data structure
-        typedef StringMap< Collection* > CollectionMap;
+        typedef FlatStringMap< Collection* > CollectionMap;
         CollectionMap _collections;
 
         friend class Collection;
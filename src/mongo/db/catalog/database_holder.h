@@ -88,7 +88,7 @@ namespace mongo {
         }
 
     private:
-        typedef StringMap<Database*> DBs;
+        typedef FlatStringMap<Database*> DBs;
 
         mutable SimpleMutex _m;
         DBs _dbs;
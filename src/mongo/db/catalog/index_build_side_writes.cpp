@@ -0,0 +1,133 @@
+// index_build_side_writes.cpp
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/index_build_side_writes.h"
+
+#include <vector>
+
+#include "mongo/db/catalog/index_catalog_entry.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/operation_context.h"
+
+namespace mongo {
+
+    /**
+     * Makes a recorded write drainable once its write unit of work commits, or discards it.
+     */
+    class IndexBuildSideWrites::WriteChange : public RecoveryUnit::Change {
+    public:
+        WriteChange(IndexBuildSideWrites* sideWrites, uint64_t seq)
+            : _sideWrites(sideWrites), _seq(seq) {}
+
+        virtual void commit() { _sideWrites->_setState(_seq, kCommitted); }
+        virtual void rollback() { _sideWrites->_setState(_seq, kRolledBack); }
+
+    private:
+        IndexBuildSideWrites* const _sideWrites;
+        const uint64_t _seq;
+    };
+
+    void IndexBuildSideWrites::record(OperationContext* txn,
+                                      Op op,
+                                      const BSONObj& doc,
+                                      const RecordId& loc) {
+        invariant(txn->lockState()->inAWriteUnitOfWork());
+
+        uint64_t seq;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            seq = _frontSeq + _writes.size();
+            _writes.push_back(Write(op, doc.getOwned(), loc));
+        }
+        txn->recoveryUnit()->registerChange(new WriteChange(this, seq));
+    }
+
+    void IndexBuildSideWrites::_setState(uint64_t seq, State state) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        invariant(seq >= _frontSeq && seq - _frontSeq < _writes.size());
+        _writes[seq - _frontSeq].state = state;
+    }
+
+    size_t IndexBuildSideWrites::size() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _writes.size();
+    }
+
+    Status IndexBuildSideWrites::drain(OperationContext* txn,
+                                       IndexCatalogEntry* entry,
+                                       size_t maxWrites,
+                                       size_t* numApplied) {
+        std::vector<Write> toApply;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            while (!_writes.empty() && toApply.size() < maxWrites) {
+                const Write& write = _writes.front();
+                if (write.state == kPending)
+                    break;
+                if (write.state == kCommitted)
+                    toApply.push_back(write);
+                _writes.pop_front();
+                _frontSeq++;
+            }
+        }
+
+        // Only non-unique indexes are built this way, and keys inserted more than once while the
+        // index isn't ready are fine
+        InsertDeleteOptions options;
+        options.logIfError = false;
+        options.dupsAllowed = true;
+
+        IndexAccessMethod* const iam = entry->accessMethod();
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            WriteUnitOfWork wunit(txn);
+            for (size_t i = 0; i < toApply.size(); i++) {
+                const Write& write = toApply[i];
+                int64_t numKeys;
+                if (write.op == kInsert) {
+                    Status status = iam->insert(txn, write.doc, write.loc, options, &numKeys);
+                    if (!status.isOK())
+                        return status;
+                }
+                else {
+                    iam->remove(txn, write.doc, write.loc, options, &numKeys);
+                }
+            }
+            wunit.commit();
+        } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "drainIndexBuildSideWrites", entry->ns());
+
+        *numApplied = toApply.size();
+        return Status::OK();
+    }
+
+} // namespace mongo
@@ -0,0 +1,113 @@
+// index_build_side_writes.h
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+    class IndexCatalogEntry;
+    class OperationContext;
+
+    /**
+     * Captures the writes to an index that is being bulk built in the background, so that they
+     * can be applied to it once the bulk build is done instead of racing with it. This is what
+     * makes a background build "hybrid": keys are sorted and loaded like in a foreground build,
+     * while the collection stays writable.
+     *
+     * Writers record the documents whose keys they would have inserted or removed, from within
+     * their write unit of work. Writes become visible to drain() once their write unit of work
+     * commits, and vanish if it rolls back. drain() applies them in the order they were recorded,
+     * which for any one document is the order of its writes.
+     *
+     * All methods are thread safe.
+     */
+    class IndexBuildSideWrites {
+        MONGO_DISALLOW_COPYING(IndexBuildSideWrites);
+    public:
+        enum Op { kInsert, kRemove };
+
+        IndexBuildSideWrites() = default;
+
+        /**
+         * Records that 'doc' at 'loc' would have been inserted into or removed from the index.
+         * Must be called inside of a WriteUnitOfWork. Copies 'doc'.
+         */
+        void record(OperationContext* txn, Op op, const BSONObj& doc, const RecordId& loc);
+
+        /**
+         * Applies up to 'maxWrites' of the committed writes to the index of 'entry', in the order
+         * they were recorded, and sets 'numApplied' to how many that was. Stops early at a write
+         * whose write unit of work is still in progress, so none are left behind only when the
+         * caller excludes all writers.
+         */
+        Status drain(OperationContext* txn,
+                     IndexCatalogEntry* entry,
+                     size_t maxWrites,
+                     size_t* numApplied);
+
+        /**
+         * Returns the number of writes recorded but not drained yet.
+         */
+        size_t size() const;
+
+    private:
+        class WriteChange;
+
+        enum State { kPending, kCommitted, kRolledBack };
+
+        struct Write {
+            Write(Op op, const BSONObj& doc, const RecordId& loc)
+                : op(op), doc(doc), loc(loc) {}
+
+            Op op;
+            BSONObj doc;
+            RecordId loc;
+            State state = kPending;
+        };
+
+        void _setState(uint64_t seq, State state);
+
+        mutable stdx::mutex _mutex;
+
+        // Sequence number of _writes.front(), each write's being one more than the previous
+        uint64_t _frontSeq = 0;
+        std::deque<Write> _writes;
+    };
+
+} // namespace mongo
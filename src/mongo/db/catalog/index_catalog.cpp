@@ -41,6 +41,7 @@
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/catalog/index_build_side_writes.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/catalog/index_key_validate.h"
 #include "mongo/db/client.h"
@@ -50,6 +51,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/summary_access_method.h"
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/index_names.h"
 #include "mongo/db/jsobj.h"
@@ -175,6 +177,12 @@ namespace {
                                                         _collection->getCatalogEntry(),
                                                         entry.get() ) );
 
+        // The groups of a summary index are kept in memory. The collection is opened before
+        // anything can write to it, while new indexes start out empty.
+        if (initFromDisk && IndexNames::SUMMARY == descriptor->getAccessMethodName()) {
+            static_cast<SummaryAccessMethod*>(entry->accessMethod())->loadGroups(txn);
+        }
+
         IndexCatalogEntry* save = entry.get();
         _entries.add( entry.release() );
         
@@ -1149,6 +1157,11 @@ namespace {
             return Status::OK();
         }
 
+        if ( index->sideWrites() ) {
+            index->sideWrites()->record( txn, IndexBuildSideWrites::kInsert, obj, loc );
+            return Status::OK();
+        }
+
         InsertDeleteOptions options;
         options.logIfError = false;
         options.dupsAllowed = isDupsAllowed( index->descriptor() );
@@ -1162,6 +1175,11 @@ namespace {
                                         const BSONObj& obj,
                                         const RecordId &loc,
                                         bool logIfError) {
+        if ( index->sideWrites() ) {
+            index->sideWrites()->record( txn, IndexBuildSideWrites::kRemove, obj, loc );
+            return Status::OK();
+        }
+
         InsertDeleteOptions options;
         options.logIfError = logIfError;
         options.dupsAllowed = isDupsAllowed( index->descriptor() );
@@ -1199,6 +1217,54 @@ namespace {
         return Status::OK();
     }
 
+    Status IndexCatalog::indexRecords(OperationContext* txn,
+                                      const std::vector<BSONObj>& docs,
+                                      const std::vector<RecordId>& locs) {
+        invariant(docs.size() == locs.size());
+
+        std::vector<BSONObj> filteredDocs;
+        std::vector<RecordId> filteredLocs;
+        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
+              i != _entries.end();
+              ++i ) {
+            IndexCatalogEntry* index = *i;
+
+            const MatchExpression* filter = index->getFilterExpression();
+            if ( filter || index->sideWrites() ) {
+                filteredDocs.clear();
+                filteredLocs.clear();
+                for (size_t j = 0; j < docs.size(); ++j) {
+                    if ( filter && !filter->matchesBSON( docs[j] ) )
+                        continue;
+                    if ( index->sideWrites() ) {
+                        index->sideWrites()->record( txn, IndexBuildSideWrites::kInsert,
+                                                     docs[j], locs[j] );
+                        continue;
+                    }
+                    filteredDocs.push_back(docs[j]);
+                    filteredLocs.push_back(locs[j]);
+                }
+                if ( filteredDocs.empty() )
+                    continue;
+            }
+
+            InsertDeleteOptions options;
+            options.logIfError = false;
+            options.dupsAllowed = isDupsAllowed( index->descriptor() );
+
+            int64_t inserted;
+            Status s = index->accessMethod()->insertMany(txn,
+                                                         filter ? filteredDocs : docs,
+                                                         filter ? filteredLocs : locs,
+                                                         options,
+                                                         &inserted);
+            if (!s.isOK())
+                return s;
+        }
+
+        return Status::OK();
+    }
+
     void IndexCatalog::unindexRecord(OperationContext* txn,
                                      const BSONObj& obj,
                                      const RecordId& loc,
@@ -1216,6 +1282,42 @@ namespace {
         }
     }
 
+    void IndexCatalog::unindexRecords(OperationContext* txn,
+                                      const std::vector<BSONObj>& docs,
+                                      const std::vector<RecordId>& locs,
+                                      bool noWarn) {
+        invariant(docs.size() == locs.size());
+
+        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
+              i != _entries.end();
+              ++i ) {
+
+            IndexCatalogEntry* index = *i;
+
+            if ( index->sideWrites() ) {
+                for (size_t j = 0; j < docs.size(); ++j) {
+                    index->sideWrites()->record( txn, IndexBuildSideWrites::kRemove,
+                                                 docs[j], locs[j] );
+                }
+                continue;
+            }
+
+            // See _unindexRecord().
+            InsertDeleteOptions options;
+            options.logIfError = index->isReady(txn) ? !noWarn : false;
+            options.dupsAllowed = isDupsAllowed( index->descriptor() ) || !index->isReady(txn);
+
+            int64_t removed;
+            Status status = index->accessMethod()->removeMany(txn, docs, locs, options, &removed);
+
+            if ( !status.isOK() ) {
+                log() << "Couldn't unindex " << docs.size() << " records"
+                      << " from collection " << _collection->ns()
+                      << ". Status: " << status.toString();
+            }
+        }
+    }
+
     BSONObj IndexCatalog::fixIndexKey( const BSONObj& key ) {
         if ( IndexDescriptor::isIdIndexPattern( key ) ) {
             return _idObj;
@@ -269,11 +269,28 @@ namespace mongo {
         // this throws for now
         Status indexRecord(OperationContext* txn, const BSONObj& obj, const RecordId &loc);
 
+        /**
+         * Indexes each of 'docs' at the matching position of 'locs', one index at a time with
+         * IndexAccessMethod::insertMany(). The caller must abandon its WriteUnitOfWork on error.
+         */
+        Status indexRecords(OperationContext* txn,
+                            const std::vector<BSONObj>& docs,
+                            const std::vector<RecordId>& locs);
+
         void unindexRecord(OperationContext* txn,
                            const BSONObj& obj,
                            const RecordId& loc,
                            bool noWarn);
 
+        /**
+         * Unindexes each of 'docs' at the matching position of 'locs', one index at a time with
+         * IndexAccessMethod::removeMany().
+         */
+        void unindexRecords(OperationContext* txn,
+                            const std::vector<BSONObj>& docs,
+                            const std::vector<RecordId>& locs,
+                            bool noWarn);
+
         // ------- temp internal -------
 
         std::string getAccessMethodName(OperationContext* txn, const BSONObj& keyPattern) {
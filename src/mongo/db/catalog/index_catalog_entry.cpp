@@ -36,6 +36,7 @@
 
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/head_manager.h"
+#include "mongo/db/catalog/index_build_side_writes.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
@@ -125,6 +126,17 @@ namespace mongo {
         return _isReady;
     }
 
+    void IndexCatalogEntry::startCapturingSideWrites() {
+        invariant( !_sideWrites );
+        _sideWrites.reset( new IndexBuildSideWrites() );
+    }
+
+    void IndexCatalogEntry::stopCapturingSideWrites() {
+        invariant( _sideWrites );
+        invariant( _sideWrites->size() == 0 );
+        _sideWrites.reset();
+    }
+
     bool IndexCatalogEntry::isMultikey() const {
         return _isMultikey;
     }
@@ -226,6 +238,11 @@ namespace mongo {
         }
 
         _isMultikey = true;
+
+        // Planning that read the flag before it was set may have shared its index entries.
+        if (_infoCache) {
+            _infoCache->invalidatePlannerIndexEntries();
+        }
     }
 
     // ----
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "mongo/base/owned_pointer_vector.h"
@@ -41,6 +42,7 @@ namespace mongo {
     class CollectionCatalogEntry;
     class CollectionInfoCache;
     class HeadManager;
+    class IndexBuildSideWrites;
     class IndexAccessMethod;
     class IndexDescriptor;
     class MatchExpression;
@@ -90,6 +92,15 @@ namespace mongo {
         // if this ready is ready for queries
         bool isReady( OperationContext* txn ) const;
 
+        /**
+         * While capturing, writers record their writes to this index in sideWrites() instead of
+         * applying them, for a hybrid background build to apply later. Starting and stopping
+         * requires an exclusive lock on the collection.
+         */
+        void startCapturingSideWrites();
+        void stopCapturingSideWrites();
+        IndexBuildSideWrites* sideWrites() const { return _sideWrites.get(); }
+
     private:
 
         class SetMultikeyChange;
@@ -114,6 +125,7 @@ namespace mongo {
         // Owned here.
         HeadManager* _headManager;
         std::unique_ptr<MatchExpression> _filterExpression;
+        std::unique_ptr<IndexBuildSideWrites> _sideWrites;
 
         // cached stuff
 
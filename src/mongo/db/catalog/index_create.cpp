@@ -40,6 +40,7 @@
 #include "mongo/db/audit.h"
 #include "mongo/db/background.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_build_side_writes.h"
 #include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
@@ -48,6 +49,7 @@
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/progress_meter.h"
@@ -88,12 +90,167 @@ namespace mongo {
         MultiIndexBlock* const _indexer;
     };
 
+    /**
+     * Generates and sorts the keys of a foreground index build on several threads. The collection
+     * scan stays on the thread of the build's OperationContext, which holds its locks and
+     * snapshot, and hands off batches of owned documents. Each thread inserts into BulkBuilders of
+     * its own, which finish() hands over to the BulkBuilders of the build for commitBulk to merge.
+     *
+     * Documents go to the threads in rounds of one batch each, so that a thread never has two
+     * batches at a time. The next round is filled while the current one is being processed.
+     */
+    class MultiIndexBlock::ParallelKeyGenerator {
+        MONGO_DISALLOW_COPYING(ParallelKeyGenerator);
+    public:
+        ParallelKeyGenerator(MultiIndexBlock* indexer, int parallelism)
+            : _indexer(indexer),
+              _slots(parallelism),
+              _pending(parallelism),
+              _pool(parallelism, "indexBuild") {
+            // The sorters of all threads share the memory a single one would use
+            const size_t maxMemoryUsageBytes =
+                IndexAccessMethod::kDefaultBulkBuilderMaxMemoryUsageBytes / parallelism;
+            for (size_t i = 0; i < _slots.size(); i++) {
+                for (size_t j = 0; j < _indexer->_indexes.size(); j++) {
+                    _slots[i].bulks.push_back(
+                        _indexer->_indexes[j].real->initiateBulk(maxMemoryUsageBytes));
+                }
+            }
+        }
+
+        /**
+         * Queues 'doc' for its keys to be generated. Returns the first error any thread has run
+         * into so far.
+         */
+        Status add(const BSONObj& doc, const RecordId& loc) {
+            std::vector<Document>& batch = _pending[_pendingSlot];
+            batch.push_back(Document(doc.getOwned(), loc));
+            _pendingBytes += doc.objsize();
+
+            if (batch.size() < kBatchDocs && _pendingBytes < kBatchBytes)
+                return Status::OK();
+
+            _pendingBytes = 0;
+            if (++_pendingSlot < _pending.size())
+                return Status::OK();
+
+            return _dispatchRound();
+        }
+
+        /**
+         * Waits for the keys of all documents to be generated, then hands the BulkBuilders of all
+         * threads over to the indexer's.
+         */
+        Status finish() {
+            Status status = _dispatchRound();
+            _pool.join();
+            if (status.isOK())
+                status = _firstError();
+            if (!status.isOK())
+                return status;
+
+            for (size_t i = 0; i < _slots.size(); i++) {
+                for (size_t j = 0; j < _indexer->_indexes.size(); j++) {
+                    _indexer->_indexes[j].bulk->absorb(std::move(_slots[i].bulks[j]));
+                }
+            }
+            return Status::OK();
+        }
+
+    private:
+        typedef std::pair<BSONObj, RecordId> Document;
+
+        static const size_t kBatchDocs = 1000;
+        static const int kBatchBytes = 4 * 1024 * 1024;
+
+        struct Slot {
+            std::vector<Document> docs;
+            std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> bulks; // one per index
+
+            // ThreadPool only logs exceptions, so keep the error for the scanning thread
+            Status status = Status::OK();
+        };
+
+        Status _dispatchRound() {
+            _pool.join();
+            Status status = _firstError();
+            if (!status.isOK())
+                return status;
+
+            for (size_t i = 0; i < _slots.size(); i++) {
+                _slots[i].docs.clear();
+                _slots[i].docs.swap(_pending[i]);
+                if (!_slots[i].docs.empty()) {
+                    _pool.schedule(&ParallelKeyGenerator::_processBatch, &_indexer->_indexes,
+                                   &_slots[i]);
+                }
+            }
+            _pendingSlot = 0;
+            _pendingBytes = 0;
+            return Status::OK();
+        }
+
+        Status _firstError() const {
+            for (size_t i = 0; i < _slots.size(); i++) {
+                if (!_slots[i].status.isOK())
+                    return _slots[i].status;
+            }
+            return Status::OK();
+        }
+
+        static void _processBatch(const std::vector<IndexToBuild>* indexes, Slot* slot) {
+            try {
+                for (size_t i = 0; i < slot->docs.size(); i++) {
+                    const Document& doc = slot->docs[i];
+                    for (size_t j = 0; j < indexes->size(); j++) {
+                        const IndexToBuild& index = (*indexes)[j];
+                        if (index.filterExpression &&
+                                !index.filterExpression->matchesBSON(doc.first)) {
+                            continue;
+                        }
+
+                        // Bulk inserts only generate and sort keys, which needs no
+                        // OperationContext
+                        Status status = slot->bulks[j]->insert(NULL, doc.first, doc.second,
+                                                               index.options, NULL);
+                        if (!status.isOK()) {
+                            slot->status = status;
+                            return;
+                        }
+                    }
+                }
+            }
+            catch (const DBException& e) {
+                slot->status = e.toStatus();
+            }
+            catch (const std::exception& e) {
+                slot->status = Status(ErrorCodes::InternalError, e.what());
+            }
+        }
+
+        MultiIndexBlock* const _indexer;
+        std::vector<Slot> _slots;
+
+        // Batches of the next round, one per slot, filled up to '_pendingSlot'
+        std::vector<std::vector<Document>> _pending;
+        size_t _pendingSlot = 0;
+        int _pendingBytes = 0;
+
+        // Declared last so that destruction waits for all tasks, including on early returns
+        ThreadPool _pool;
+    };
+
+    const int MultiIndexBlock::kMaxParallelism;
+
     MultiIndexBlock::MultiIndexBlock(OperationContext* txn, Collection* collection)
         : _collection(collection),
           _txn(txn),
           _buildInBackground(false),
+          _allowHybrid(false),
+          _buildHybrid(false),
           _allowInterruption(false),
           _ignoreUnique(false),
+          _parallelism(1),
           _needToCleanup(true) {
     }
 
@@ -161,8 +318,21 @@ namespace mongo {
                     return s;
             }
 
-            // Any foreground indexes make all indexes be built in the foreground.
-            _buildInBackground = (_buildInBackground && info["background"].trueValue());
+            // Any foreground indexes make all indexes be built in the foreground. So do summary
+            // indexes, which count every key written to them, while a background build may
+            // index a document it already indexed, or unindex one it didn't get to yet.
+            _buildInBackground = (_buildInBackground && info["background"].trueValue()
+                                  && pluginName != IndexNames::SUMMARY);
+        }
+
+        // Writes applied after the bulk load can't tell a duplicate key from a key that was
+        // loaded and then moved, so unique indexes are built inserting into them directly.
+        _buildHybrid = _buildInBackground && _allowHybrid;
+        for ( size_t i = 0; i < indexSpecs.size(); i++ ) {
+            if ( indexSpecs[i]["unique"].trueValue()
+                 || IndexDescriptor::isIdIndexPattern( indexSpecs[i]["key"].Obj() ) ) {
+                _buildHybrid = false;
+            }
         }
 
         for ( size_t i = 0; i < indexSpecs.size(); i++ ) {
@@ -190,6 +360,11 @@ namespace mongo {
                 // under it.
                 index.bulk = index.real->initiateBulk();
             }
+            else if (_buildHybrid) {
+                // Or the writes changing things under it being set aside until it's done.
+                index.bulk = index.real->initiateBulk();
+                index.block->getEntry()->startCapturingSideWrites();
+            }
 
             const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
 
@@ -200,7 +375,9 @@ namespace mongo {
                                                     ->shouldIgnoreUniqueIndex(descriptor);
 
             log() << "build index on: " << ns << " properties: " << descriptor->toString();
-            if (index.bulk)
+            if (_buildHybrid)
+                log() << "\t building index using bulk method while capturing concurrent writes";
+            else if (index.bulk)
                 log() << "\t building index using bulk method";
 
             index.filterExpression = index.block->getEntry()->getFilterExpression();
@@ -246,6 +423,14 @@ namespace mongo {
             exec->setYieldPolicy(PlanExecutor::WRITE_CONFLICT_RETRY_ONLY);
         }
 
+        // Bulk builds only sort the keys until doneInserting(), so other threads can generate and
+        // sort them while the collection is scanned here
+        std::unique_ptr<ParallelKeyGenerator> parallelKeys;
+        if (_parallelism > 1 && (!_buildInBackground || _buildHybrid)) {
+            log() << "generating index keys on " << _parallelism << " threads";
+            parallelKeys.reset(new ParallelKeyGenerator(this, _parallelism));
+        }
+
         Snapshotted<BSONObj> objToIndex;
         RecordId loc;
         PlanExecutor::ExecState state;
@@ -268,6 +453,17 @@ namespace mongo {
                 // Done before insert so we can retry document if it WCEs.
                 progress->setTotalWhileRunning( _collection->numRecords(_txn) );
 
+                if (parallelKeys) {
+                    Status ret = parallelKeys->add(objToIndex.value(), loc);
+                    if (!ret.isOK())
+                        return ret;
+
+                    progress->hit();
+                    n++;
+                    retries = 0;
+                    continue;
+                }
+
                 WriteUnitOfWork wunit(_txn);
                 Status ret = insert(objToIndex.value(), loc);
                 if (ret.isOK()) {
@@ -291,7 +487,8 @@ namespace mongo {
             catch (const WriteConflictException& wce) {
                 CurOp::get(_txn)->debug().writeConflicts++;
                 retries++; // logAndBackoff expects this to be 1 on first call.
-                wce.logAndBackoff(retries, "index creation", _collection->ns().ns());
+                CurOp::get(_txn)->debug().writeConflictBackoffMicros +=
+                    wce.logAndBackoff(retries, "index creation", _collection->ns().ns());
 
                 // Can't use WRITE_CONFLICT_RETRY_LOOP macros since we need to save/restore exec
                 // around call to abandonSnapshot.
@@ -312,12 +509,26 @@ namespace mongo {
                       "Unable to complete index build as the collection is no longer readable");
         }
 
+        if (parallelKeys) {
+            Status ret = parallelKeys->finish();
+            if (!ret.isOK())
+                return ret;
+        }
+
         progress->finished();
 
         Status ret = doneInserting(dupsOut);
         if (!ret.isOK())
             return ret;
 
+        if (_buildHybrid) {
+            // Catch up with the writes made meanwhile while they're still allowed, so that few are
+            // left for drainSideWrites() to apply under the exclusive lock.
+            ret = _drainSideWrites(false);
+            if (!ret.isOK())
+                return ret;
+        }
+
         log() << "build index done.  scanned " << n << " total records. "
               << t.seconds() << " secs" << endl;
 
@@ -366,6 +577,49 @@ namespace mongo {
         return Status::OK();
     }
 
+    Status MultiIndexBlock::drainSideWrites() {
+        if (!_buildHybrid)
+            return Status::OK();
+
+        invariant(_txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
+
+        Status status = _drainSideWrites(true);
+        if (!status.isOK())
+            return status;
+
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            _indexes[i].block->getEntry()->stopCapturingSideWrites();
+        }
+        return Status::OK();
+    }
+
+    Status MultiIndexBlock::_drainSideWrites(bool untilEmpty) {
+        const size_t kBatchSize = 1000;
+
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            IndexCatalogEntry* entry = _indexes[i].block->getEntry();
+            size_t total = 0;
+            while (true) {
+                if (_allowInterruption)
+                    _txn->checkForInterrupt();
+
+                size_t numApplied;
+                Status status = entry->sideWrites()->drain(_txn, entry, kBatchSize, &numApplied);
+                if (!status.isOK())
+                    return status;
+
+                total += numApplied;
+                if (untilEmpty ? numApplied == 0 : numApplied < kBatchSize)
+                    break;
+            }
+
+            LOG(1) << "\t applied " << total << " side writes to index: "
+                   << entry->descriptor()->indexName();
+        }
+
+        return Status::OK();
+    }
+
     void MultiIndexBlock::abortWithoutCleanup() {
         _indexes.clear();
         _needToCleanup = false;
@@ -373,6 +627,8 @@ namespace mongo {
 
     void MultiIndexBlock::commit() {
         for ( size_t i = 0; i < _indexes.size(); i++ ) {
+            // drainSideWrites() must have been called
+            invariant(!_indexes[i].block->getEntry()->sideWrites());
             _indexes[i].block->success();
         }
 
@@ -77,6 +77,15 @@ namespace mongo {
          */
         void allowBackgroundBuilding() { _buildInBackground = true; }
 
+        /**
+         * If this is called before init(), background builds of indexes that aren't unique are
+         * hybrid: keys are sorted and bulk loaded from the collection scan like in a foreground
+         * build, while the writes to the collection meanwhile are captured in side tables (see
+         * IndexBuildSideWrites) and applied afterwards. Callers must call drainSideWrites() before
+         * commit().
+         */
+        void allowHybridBuilding() { _allowHybrid = true; }
+
         /**
          * Call this before init() to allow the index build to be interrupted.
          * This only affects builds using the insertAllDocumentsInCollection helper.
@@ -92,6 +101,16 @@ namespace mongo {
          */
         void ignoreUniqueConstraint() { _ignoreUnique = true; }
 
+        /**
+         * Call this before insertAllDocumentsInCollection() to generate and sort the keys of a
+         * foreground build on 'parallelism' threads, while the collection is scanned. Background
+         * builds insert into the indexes directly and always use a single thread.
+         */
+        void setParallelism(int parallelism) { _parallelism = parallelism; }
+
+        // Upper limit for setParallelism()
+        static const int kMaxParallelism = 64;
+
         /**
          * Removes pre-existing indexes from 'specs'. If this isn't done, init() may fail with
          * IndexAlreadyExists.
@@ -149,6 +168,17 @@ namespace mongo {
          */
         Status doneInserting(std::set<RecordId>* dupsOut = NULL);
 
+        /**
+         * Applies the last writes captured during a hybrid build and makes writers maintain the
+         * indexes directly again. Call after insertAllDocumentsInCollection() and before commit().
+         * Does nothing unless the build is hybrid.
+         *
+         * Requires holding an exclusive lock on the collection, so that no writes are left behind.
+         *
+         * Should not be called inside of a WriteUnitOfWork.
+         */
+        Status drainSideWrites();
+
         /**
          * Marks the index ready for use. Should only be called as the last method after
          * doneInserting() or insertAllDocumentsInCollection() return success.
@@ -178,9 +208,18 @@ namespace mongo {
 
         bool getBuildInBackground() const { return _buildInBackground; }
 
+        bool getBuildHybrid() const { return _buildHybrid; }
+
     private:
         class SetNeedToCleanupOnRollback;
         class CleanupIndexesVectorOnRollback;
+        class ParallelKeyGenerator;
+
+        /**
+         * Applies the writes captured during a hybrid build to each index. Unless 'untilEmpty',
+         * stops for each index once it caught up with the writers, which keep going.
+         */
+        Status _drainSideWrites(bool untilEmpty);
 
         struct IndexToBuild {
 #if defined(_MSC_VER) && _MSC_VER < 1900 // MVSC++ <= 2013 can't generate default move operations
@@ -221,8 +260,11 @@ namespace mongo {
         OperationContext* _txn;
 
         bool _buildInBackground;
+        bool _allowHybrid;
+        bool _buildHybrid;
         bool _allowInterruption;
         bool _ignoreUnique;
+        int _parallelism;
 
         bool _needToCleanup;
     };
@@ -42,6 +42,7 @@
 #include "mongo/base/status.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/service_context.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/exit.h"
@@ -54,6 +55,8 @@ namespace mongo {
     TSP_DECLARE(ServiceContext::UniqueClient, currentClient)
     TSP_DEFINE(ServiceContext::UniqueClient, currentClient)
 
+    static MemoryAccount clientMemory("clients");
+
     void Client::initThreadIfNotAlready(const char* desc) {
         if (currentClient.getMake()->get())
             return;
@@ -89,13 +92,32 @@ namespace mongo {
         *currentClient.get() = service->makeClient(fullDesc, mp);
     }
 
+    ServiceContext::UniqueClient Client::releaseCurrent() {
+        invariant(haveClient());
+        return std::move(*currentClient.get());
+    }
+
+    void Client::setCurrent(ServiceContext::UniqueClient client) {
+        invariant(client);
+        invariant(!haveClient());
+
+        setThreadName(client->desc().c_str());
+        {
+            stdx::lock_guard<Client> lk(*client);
+            client->_threadId = stdx::this_thread::get_id();
+        }
+        *currentClient.getMake() = std::move(client);
+    }
+
     Client::Client(std::string desc,
                    ServiceContext* serviceContext,
                    AbstractMessagingPort *p)
         : ClientBasic(serviceContext, p),
           _desc(std::move(desc)),
           _threadId(stdx::this_thread::get_id()),
-          _connectionId(p ? p->connectionId() : 0) {
+          _connectionId(p ? p->connectionId() : 0),
+          _memoryCharge(&clientMemory) {
+        _memoryCharge.set(sizeof(Client) + getDecorationsSizeBytes() + _desc.size());
     }
 
     void Client::reportState(BSONObjBuilder& builder) {
@@ -45,6 +45,7 @@
 #include "mongo/platform/unordered_set.h"
 #include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/concurrency/threadlocal.h"
+#include "mongo/util/memory_accounting.h"
 
 namespace mongo {
 
@@ -75,6 +76,20 @@ namespace mongo {
          */
         static void initThreadIfNotAlready();
 
+        /**
+         * Detaches the Client bound to the current thread and returns it, leaving the thread
+         * without a Client. Used by servers that service a connection from more than one thread
+         * over its lifetime; the returned Client may be re-attached to any thread with
+         * setCurrent().
+         */
+        static ServiceContext::UniqueClient releaseCurrent();
+
+        /**
+         * Binds "client" to the current thread, which must not already have a Client, and renames
+         * the thread after it.
+         */
+        static void setCurrent(ServiceContext::UniqueClient client);
+
         std::string clientAddress(bool includePort = false) const;
         const std::string& desc() const { return _desc; }
 
@@ -132,8 +147,9 @@ namespace mongo {
         // Description for the client (e.g. conn8)
         const std::string _desc;
 
-        // OS id of the thread, which owns this client
-        const boost::thread::id _threadId;
+        // OS id of the thread, which owns this client. Changes when the client is moved to
+        // another thread with setCurrent(), so it is protected by _lock.
+        boost::thread::id _threadId;
 
         // > 0 for things "conn", 0 otherwise
         const ConnectionId _connectionId;
@@ -146,6 +162,10 @@ namespace mongo {
 
         // If != NULL, then contains the currently active OperationContext
         OperationContext* _txn = nullptr;
+
+        // This client's share of the client memory, which counts the client and its decorations
+        // but not what they point to.
+        MemoryAccount::Charge _memoryCharge;
     };
 
     /** get the Client object for this thread. */
@@ -70,6 +70,8 @@ namespace mongo {
     static ServerStatusMetricField<Counter64> dCursorStatusTimedout( "cursor.timedOut",
                                                                      &cursorStatsTimedOut );
 
+    static MemoryAccount cursorMemory("cursors");
+
     MONGO_EXPORT_SERVER_PARAMETER(cursorTimeoutMillis, int, 10 * 60 * 1000 /* 10 minutes */);
 
     long long ClientCursor::totalOpen() {
@@ -86,7 +88,8 @@ namespace mongo {
           _cursorManager(cursorManager),
           _countedYet(false),
           _isAggCursor(isAggCursor),
-          _unownedRU(NULL) {
+          _unownedRU(NULL),
+          _memoryCharge(&cursorMemory) {
 
         _exec.reset(exec);
         _query = query;
@@ -103,7 +106,8 @@ namespace mongo {
           _countedYet(false),
           _queryOptions(QueryOption_NoCursorTimeout),
           _isAggCursor(false),
-          _unownedRU(NULL) {
+          _unownedRU(NULL),
+          _memoryCharge(&cursorMemory) {
         init();
     }
 
@@ -112,6 +116,7 @@ namespace mongo {
 
         _isPinned = false;
         _isNoTimeout = false;
+        _prefetchNextBatch = false;
 
         _idleAgeMillis = 0;
         _leftoverMaxTimeMicros = 0;
@@ -125,6 +130,7 @@ namespace mongo {
         }
 
         _cursorid = _cursorManager->registerCursor( this );
+        _memoryCharge.set(sizeof(ClientCursor) + _ns.size() + _query.objsize());
 
         cursorStatsOpen.increment();
         _countedYet = true;
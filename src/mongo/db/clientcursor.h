@@ -34,6 +34,7 @@
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/record_id.h"
 #include "mongo/s/collection_metadata.h"
+#include "mongo/util/memory_accounting.h"
 #include "mongo/util/net/message.h"
 
 namespace mongo {
@@ -117,6 +118,13 @@ namespace mongo {
         void setIdleTime( int millis );
         int idleTime() const { return _idleAgeMillis; }
 
+        /**
+         * If set, the next batch of this cursor is built by the CursorPrefetcher in the
+         * background after each batch is returned to the client.
+         */
+        bool prefetchNextBatch() const { return _prefetchNextBatch; }
+        void setPrefetchNextBatch(bool prefetch) { _prefetchNextBatch = prefetch; }
+
         uint64_t getLeftoverMaxTimeMicros() const { return _leftoverMaxTimeMicros; }
         void setLeftoverMaxTimeMicros( uint64_t leftoverMaxTimeMicros ) {
             _leftoverMaxTimeMicros = leftoverMaxTimeMicros;
@@ -245,6 +253,10 @@ namespace mongo {
         // deletion after an interval of inactivity.  Defaults to false.
         bool _isNoTimeout;
 
+        // Should the next batch be built in the background once a batch is returned?  See
+        // CursorPrefetcher.  Defaults to false.
+        bool _prefetchNextBatch;
+
         // The replication position only used in master-slave.
         Timestamp _slaveReadTill;
 
@@ -272,6 +284,10 @@ namespace mongo {
         // The underlying execution machinery.
         //
         std::unique_ptr<PlanExecutor> _exec;
+
+        // This cursor's share of the cursor memory. Only what the cursor itself holds is counted,
+        // not its executor's stages.
+        MemoryAccount::Charge _memoryCharge;
     };
 
     /**
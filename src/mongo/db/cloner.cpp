@@ -116,10 +116,15 @@ namespace mongo {
     Cloner::Cloner() { }
 
     struct Cloner::Fun {
-        Fun(OperationContext* txn, const string& dbName)
+        Fun(OperationContext* txn,
+            const string& dbName,
+            unique_ptr<RecordStoreBulkLoader>* bulkLoader)
             :lastLog(0),
              txn(txn),
-             _dbName(dbName)
+             _dbName(dbName),
+             _bulkLoader(bulkLoader),
+             _bulkLoadCollection(NULL),
+             _triedBulkLoad(false)
         {}
 
         void operator()( DBClientCursorBatchIterator &i ) {
@@ -155,6 +160,22 @@ namespace mongo {
                 } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createCollection", to_collection.ns());
             }
 
+            // Documents cloned into a new collection, before any of its indexes are built, can
+            // skip the per-document transactions.
+            if (!_triedBulkLoad) {
+                _triedBulkLoad = true;
+                *_bulkLoader = collection->makeBulkLoader(txn);
+                if (*_bulkLoader) {
+                    LOG(1) << "bulk loading documents cloned into " << to_collection;
+                    _bulkLoadCollection = collection;
+                }
+            }
+
+            massert(28705,
+                    str::stream() << "collection " << to_collection.ns()
+                                  << " was recreated while bulk loading it",
+                    !*_bulkLoader || collection == _bulkLoadCollection);
+
             while( i.moreInCurrentBatch() ) {
                 if ( numSeen % 128 == 127 ) {
                     time_t now = time(0);
@@ -199,6 +220,10 @@ namespace mongo {
                                 str::stream() << "Collection " << to_collection.ns()
                                               << " dropped while cloning",
                                 collection != NULL);
+                        massert(28706,
+                                str::stream() << "collection " << to_collection.ns()
+                                              << " was recreated while bulk loading it",
+                                !*_bulkLoader || collection == _bulkLoadCollection);
                     }
                 }
 
@@ -218,18 +243,30 @@ namespace mongo {
                 }
 
                 ++numSeen;
-                MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
-                    WriteUnitOfWork wunit(txn);
-
-                    BSONObj doc = tmp;
-                    StatusWith<RecordId> loc = collection->insertDocument( txn, doc, true );
+                if (*_bulkLoader) {
+                    StatusWith<RecordId> loc = (*_bulkLoader)->addRecord(tmp.objdata(),
+                                                                         tmp.objsize());
                     if ( !loc.isOK() ) {
                         error() << "error: exception cloning object in " << from_collection
-                                << ' ' << loc.getStatus() << " obj:" << doc;
+                                << ' ' << loc.getStatus() << " obj:" << tmp;
                     }
                     uassertStatusOK( loc.getStatus() );
-                    wunit.commit();
-                } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "cloner insert", to_collection.ns());
+                }
+                else {
+                    MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                        WriteUnitOfWork wunit(txn);
+
+                        BSONObj doc = tmp;
+                        StatusWith<RecordId> loc = collection->insertDocument( txn, doc, true );
+                        if ( !loc.isOK() ) {
+                            error() << "error: exception cloning object in " << from_collection
+                                    << ' ' << loc.getStatus() << " obj:" << doc;
+                        }
+                        uassertStatusOK( loc.getStatus() );
+                        wunit.commit();
+                    } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "cloner insert",
+                                                          to_collection.ns());
+                }
                 RARELY if ( time( 0 ) - saveLast > 60 ) {
                     log() << numSeen << " objects cloned so far from collection " << from_collection;
                     saveLast = time( 0 );
@@ -247,6 +284,11 @@ namespace mongo {
         time_t saveLast;
         bool _mayYield;
         bool _mayBeInterrupted;
+
+        // Owned by Cloner::copy(), since this object is copied into the query's callback.
+        unique_ptr<RecordStoreBulkLoader>* const _bulkLoader;
+        Collection* _bulkLoadCollection;
+        bool _triedBulkLoad;
     };
 
     /* copy the specified collection
@@ -262,7 +304,10 @@ namespace mongo {
                       Query query) {
         LOG(2) << "\t\tcloning collection " << from_collection << " to " << to_collection << " on " << _conn->getServerAddress() << " with filter " << query.toString() << endl;
 
-        Fun f(txn, toDBName);
+        // Destroyed after the locks released for the query are reacquired.
+        unique_ptr<RecordStoreBulkLoader> bulkLoader;
+
+        Fun f(txn, toDBName, &bulkLoader);
         f.numSeen = 0;
         f.from_collection = from_collection;
         f.to_collection = to_collection;
@@ -277,6 +322,10 @@ namespace mongo {
                          query, 0, options);
         }
 
+        if (bulkLoader) {
+            bulkLoader->commit();
+        }
+
         uassert(ErrorCodes::NotMaster,
                 str::stream() << "Not primary while cloning collection " << from_collection.ns()
                               << " to " << to_collection.ns() << " with filter "
@@ -327,6 +327,17 @@ namespace mongo {
         return Status(ErrorCodes::Unauthorized, "unauthorized");
     }
 
+    bool Command::runWithInputDocs(OperationContext* txn,
+                                   const std::string& db,
+                                   BSONObj& cmdObj,
+                                   const rpc::DocumentRange& inputDocs,
+                                   int options,
+                                   std::string& errmsg,
+                                   BSONObjBuilder& result) {
+        errmsg = str::stream() << "the " << name << " command does not accept input documents";
+        return false;
+    }
+
     void Command::redactForLogging(mutablebson::Document* cmdObj) {}
 
     BSONObj Command::getRedactedCopyForLogging(const BSONObj& cmdObj) {
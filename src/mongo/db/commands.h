@@ -41,6 +41,7 @@
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/rpc/reply_builder_interface.h"
 #include "mongo/rpc/request_interface.h"
 #include "mongo/util/string_map.h"
@@ -74,7 +75,7 @@ namespace mutablebson {
                                               const BSONObj& cmdObj) const;
     public:
 
-        typedef StringMap<Command*> CommandMap;
+        typedef FlatStringMap<Command*> CommandMap;
 
         // Return the namespace for the command. If the first field in 'cmdObj' is of type
         // mongo::String, then that field is interpreted as the collection name, and is
@@ -103,6 +104,21 @@ namespace mutablebson {
                          std::string& errmsg,
                          BSONObjBuilder& result) = 0;
 
+        /**
+         * Like run(), for an OP_COMMAND request which carries documents after the command
+         * arguments. 'inputDocs' is a view into the request message, so commands can use the
+         * documents in place for the duration of the call without copying them.
+         *
+         * Commands which accept input documents override this. By default it fails.
+         */
+        virtual bool runWithInputDocs(OperationContext* txn,
+                                      const std::string& db,
+                                      BSONObj& cmdObj,
+                                      const rpc::DocumentRange& inputDocs,
+                                      int options,
+                                      std::string& errmsg,
+                                      BSONObjBuilder& result);
+
         /**
          * Translation point between the new request/response types and the legacy types.
          *
@@ -160,6 +176,19 @@ namespace mutablebson {
          */
         virtual bool shouldAffectCommandCounter() const { return true; }
 
+        /**
+         * The class of operation this command is reported under in the "latencyHistograms"
+         * serverStatus section. Commands which only read or only write user data should
+         * override this, so that their latencies are grouped with the equivalent legacy opcodes.
+         */
+        enum class ReadWriteType { kCommand, kRead, kWrite };
+        virtual ReadWriteType getReadWriteType() const { return ReadWriteType::kCommand; }
+
+        /**
+         * Latencies of this command's executions, as reported by serverStatus.
+         */
+        LatencyHistogram* getLatencyHistogram() { return &_latencyHistogram; }
+
         virtual void help( std::stringstream& help ) const;
 
         /**
@@ -251,6 +280,9 @@ namespace mutablebson {
         Counter64 _commandsExecuted;
         Counter64 _commandsFailed;
 
+        // Latencies of every execution of this command, whether or not it succeeded
+        LatencyHistogram _latencyHistogram;
+
         // Pointers to hold the metrics tree references
         ServerStatusMetricField<Counter64> _commandsExecutedMetric;
         ServerStatusMetricField<Counter64> _commandsFailedMetric;
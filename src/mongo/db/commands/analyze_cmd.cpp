@@ -0,0 +1,209 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/query/index_stats.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::stringstream;
+
+    namespace {
+
+        const int kDefaultBuckets = 100;
+
+        // How many keys are read between checks for interruption.
+        const long long kKeysPerInterruptCheck = 1024;
+
+        /**
+         * Reads every key of the index described by 'desc', in ascending order of its leading
+         * field.
+         */
+        IndexStats* buildIndexStats(OperationContext* txn,
+                                    const IndexAccessMethod* iam,
+                                    const IndexDescriptor* desc,
+                                    size_t maxBuckets) {
+            const BSONObj& keyPattern = desc->keyPattern();
+            const bool isForward = keyPattern.firstElement().number() >= 0;
+
+            BSONObjBuilder startKey;
+            for (int i = 0; i < keyPattern.nFields(); ++i) {
+                if (isForward) {
+                    startKey.appendMinKey("");
+                }
+                else {
+                    startKey.appendMaxKey("");
+                }
+            }
+
+            std::unique_ptr<SortedDataInterface::Cursor> cursor(iam->newCursor(txn, isForward));
+            cursor->allowUnownedKeys();
+
+            const auto parts = SortedDataInterface::Cursor::kWantKey;
+            IndexStats::Builder builder(maxBuckets);
+            long long keys = 0;
+            for (auto kv = cursor->seek(startKey.obj(), true, parts); kv; kv = cursor->next(parts)) {
+                builder.addKey(kv->key);
+                if (0 == (++keys % kKeysPerInterruptCheck)) {
+                    txn->checkForInterrupt();
+                }
+            }
+
+            return builder.done(keyPattern);
+        }
+
+    }  // namespace
+
+    /**
+     * { analyze: <collection>, [index: <name>], [buckets: <n>], [verbose: <bool>] }
+     *
+     * Gathers IndexStats for the btree and hashed indexes of a collection (or for one of them) by
+     * reading all their keys, and hands them to the collection's CollectionInfoCache for the
+     * planner to use. The statistics are kept in memory only; they are not replicated and do not
+     * survive a restart, and they are not updated as the collection changes.
+     */
+    class AnalyzeCmd : public Command {
+    public:
+        AnalyzeCmd() : Command("analyze") { }
+
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+
+        virtual bool slaveOk() const { return true; }
+
+        virtual void help(stringstream& help) const {
+            help << "Gather key statistics of a collection's indexes for the query planner. "
+                    "Reads every key, so slow.\n"
+                    "{ analyze: <collection>, [index: <name>], [buckets: <n>], "
+                    "[verbose: <bool>] }";
+        }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::planCacheWrite);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const string& dbname,
+                         BSONObj& cmdObj,
+                         int options,
+                         string& errmsg,
+                         BSONObjBuilder& result) {
+            const NamespaceString nss(parseNsCollectionRequired(dbname, cmdObj));
+
+            int buckets = kDefaultBuckets;
+            BSONElement bucketsElt = cmdObj["buckets"];
+            if (!bucketsElt.eoo()) {
+                if (!bucketsElt.isNumber() || bucketsElt.numberInt() < 1 ||
+                    bucketsElt.numberInt() > internalQueryAnalyzeMaxBuckets) {
+                    return appendCommandStatus(result, Status(ErrorCodes::BadValue,
+                        str::stream() << "buckets must be a number between 1 and "
+                                      << internalQueryAnalyzeMaxBuckets));
+                }
+                buckets = bucketsElt.numberInt();
+            }
+
+            BSONElement indexElt = cmdObj["index"];
+            if (!indexElt.eoo() && String != indexElt.type()) {
+                return appendCommandStatus(result, Status(ErrorCodes::BadValue,
+                                                          "index must be an index name"));
+            }
+            const bool verbose = cmdObj["verbose"].trueValue();
+
+            AutoGetCollectionForRead ctx(txn, nss);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                return appendCommandStatus(result, Status(ErrorCodes::NamespaceNotFound,
+                                                          "ns not found"));
+            }
+
+            IndexCatalog* catalog = collection->getIndexCatalog();
+            std::vector<IndexDescriptor*> indexes;
+            if (!indexElt.eoo()) {
+                IndexDescriptor* desc = catalog->findIndexByName(txn, indexElt.valueStringData());
+                if (!desc) {
+                    return appendCommandStatus(result, Status(ErrorCodes::IndexNotFound,
+                        str::stream() << "index not found: " << indexElt.valueStringData()));
+                }
+                indexes.push_back(desc);
+            }
+            else {
+                IndexCatalog::IndexIterator ii = catalog->getIndexIterator(txn, false);
+                while (ii.more()) {
+                    indexes.push_back(ii.next());
+                }
+            }
+
+            LOG(0) << "CMD: analyze " << nss.ns();
+
+            Timer timer;
+            BSONObjBuilder indexesBuilder(result.subobjStart("indexes"));
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                const IndexDescriptor* desc = indexes[i];
+                const IndexType type = IndexNames::nameToType(desc->getAccessMethodName());
+                if (INDEX_BTREE != type && INDEX_HASHED != type) {
+                    // The planner cannot cost scans of the other index types.
+                    continue;
+                }
+
+                std::shared_ptr<const IndexStats> stats(
+                    buildIndexStats(txn, catalog->getIndex(desc), desc, buckets));
+                collection->infoCache()->setIndexStats(desc->indexName(), stats);
+                indexesBuilder.append(desc->indexName(), stats->toBSON(verbose));
+            }
+            indexesBuilder.doneFast();
+            result.append("millis", timer.millis());
+            return true;
+        }
+
+    } analyzeCmd;
+
+}  // namespace mongo
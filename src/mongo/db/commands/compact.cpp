@@ -45,6 +45,7 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/index_builder.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/online_compaction.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/util/log.h"
@@ -71,8 +72,11 @@ namespace mongo {
             help << "compact collection\n"
                 "warning: this operation locks the database and is slow. you can cancel with killOp()\n"
                 "{ compact : <collection_name>, [force:<bool>], [validate:<bool>],\n"
-                "  [paddingFactor:<num>], [paddingBytes:<num>] }\n"
+                "  [paddingFactor:<num>], [paddingBytes:<num>],\n"
+                "  [online:<bool>, [timeSliceSecs:<num>], [maxBytesPerSecond:<num>]] }\n"
                 "  force - allows to run on a replica set primary\n"
+                "  online - compact under intent locks, timeSliceSecs (default 5) at a time, if the"
+                " storage engine can. maxBytesPerSecond limits how fast space is given back\n"
                 "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n";
         }
         CompactCmd() : Command("compact") { }
@@ -84,9 +88,12 @@ namespace mongo {
                          string& errmsg,
                          BSONObjBuilder& result) {
             const std::string nsToCompact = parseNsCollectionRequired(db, cmdObj);
+            const bool online = cmdObj["online"].trueValue();
 
+            // Online compaction doesn't block the collection, so it may run on a primary.
             repl::ReplicationCoordinator* replCoord = repl::getGlobalReplicationCoordinator();
-            if (replCoord->getMemberState().primary() && !cmdObj["force"].trueValue()) {
+            if (!online &&
+                replCoord->getMemberState().primary() && !cmdObj["force"].trueValue()) {
                 errmsg = "will not run compact on an active replica set primary as this is a slow blocking operation. use force:true to force";
                 return false;
             }
@@ -137,6 +144,28 @@ namespace mongo {
             if ( cmdObj.hasElement("validate") )
                 compactOptions.validateDocuments = cmdObj["validate"].trueValue();
 
+            if ( online ) {
+                compactOptions.online = true;
+                compactOptions.timeSliceSecs = 5;
+                if ( cmdObj.hasElement("timeSliceSecs") ) {
+                    compactOptions.timeSliceSecs = cmdObj["timeSliceSecs"].numberInt();
+                    if ( compactOptions.timeSliceSecs < 1 ) {
+                        errmsg = "invalid timeSliceSecs";
+                        return false;
+                    }
+                }
+
+                long long maxBytesPerSecond = 0;
+                if ( cmdObj.hasElement("maxBytesPerSecond") ) {
+                    maxBytesPerSecond = cmdObj["maxBytesPerSecond"].safeNumberLong();
+                    if ( maxBytesPerSecond < 0 ) {
+                        errmsg = "invalid maxBytesPerSecond";
+                        return false;
+                    }
+                }
+
+                return runOnline(txn, ns, compactOptions, maxBytesPerSecond, errmsg, result);
+            }
 
             ScopedTransaction transaction(txn, MODE_IX);
             AutoGetDb autoDb(txn, db, MODE_X);
@@ -170,6 +199,43 @@ namespace mongo {
 
             return true;
         }
+
+    private:
+        bool runOnline(OperationContext* txn,
+                       const NamespaceString& ns,
+                       const CompactOptions& compactOptions,
+                       long long maxBytesPerSecond,
+                       string& errmsg,
+                       BSONObjBuilder& result) {
+            {
+                ScopedTransaction transaction(txn, MODE_IS);
+                AutoGetCollectionForRead autoColl(txn, ns);
+                Collection* collection = autoColl.getCollection();
+                if ( !collection ) {
+                    errmsg = "namespace does not exist";
+                    return false;
+                }
+                if ( collection->isCapped() ) {
+                    errmsg = "cannot compact a capped collection";
+                    return false;
+                }
+            }
+
+            log() << "compact " << ns << " begin, options: " << compactOptions.toString()
+                  << " maxBytesPerSecond: " << maxBytesPerSecond;
+
+            StatusWith<CompactStats> status =
+                compactCollectionOnline(txn, ns, compactOptions, maxBytesPerSecond);
+            if ( !status.isOK() )
+                return appendCommandStatus( result, status.getStatus() );
+
+            result.append("bytesFreed", status.getValue().bytesFreed);
+
+            log() << "compact " << ns << " end, freed " << status.getValue().bytesFreed
+                  << " bytes";
+
+            return true;
+        }
     };
     static CompactCmd compactCmd;
 
@@ -148,6 +148,15 @@ namespace {
                 return appendCommandStatus(result, execPlanStatus);
             }
 
+            if (NULL != CurOp::get(txn)) {
+                PlanSummaryStats summaryStats;
+                Explain::getSummaryStats(exec.get(), &summaryStats);
+                OpDebug& opDebug = CurOp::get(txn)->debug();
+                opDebug.nscanned = summaryStats.totalKeysExamined;
+                opDebug.nscannedObjects = summaryStats.totalDocsExamined;
+                opDebug.replanned = summaryStats.replanned;
+            }
+
             // Plan is done executing. We just need to pull the count out of the root stage.
             invariant(STAGE_COUNT == exec->getRootStage()->stageType());
             CountStage* countStage = static_cast<CountStage*>(exec->getRootStage());
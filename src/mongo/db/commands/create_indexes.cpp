@@ -47,6 +47,7 @@
 #include "mongo/db/op_observer.h"
 #include "mongo/db/ops/insert.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/d_state.h"
 #include "mongo/s/shard_key_pattern.h"
 
@@ -54,6 +55,10 @@ namespace mongo {
 
     using std::string;
 
+    // Whether background builds of indexes that aren't unique are hybrid, see
+    // MultiIndexBlock::allowHybridBuilding()
+    MONGO_EXPORT_SERVER_PARAMETER(hybridIndexBuilds, bool, true);
+
     /**
      * { createIndexes : "bar", indexes : [ { ns : "test.bar", key : { x : 1 }, name: "x_1" } ] }
      */
@@ -117,6 +122,19 @@ namespace mongo {
                 return false;
             }
 
+            // number of threads generating and sorting the keys of a foreground build
+            int parallelism = 1;
+            if ( cmdObj.hasField( "parallelism" ) ) {
+                BSONElement e = cmdObj["parallelism"];
+                if ( !e.isNumber() || e.numberInt() < 1
+                     || e.numberInt() > MultiIndexBlock::kMaxParallelism ) {
+                    return appendCommandStatus( result, Status( ErrorCodes::BadValue, str::stream()
+                        << "parallelism must be a number between 1 and "
+                        << MultiIndexBlock::kMaxParallelism ) );
+                }
+                parallelism = e.numberInt();
+            }
+
             // check specs
             for ( size_t i = 0; i < specs.size(); i++ ) {
                 BSONObj spec = specs[i];
@@ -167,7 +185,10 @@ namespace mongo {
 
             MultiIndexBlock indexer(txn, collection);
             indexer.allowBackgroundBuilding();
+            if (hybridIndexBuilds)
+                indexer.allowHybridBuilding();
             indexer.allowInterruption();
+            indexer.setParallelism(parallelism);
 
             const size_t origSpecsSize = specs.size();
             indexer.removeExistingIndexes(&specs);
@@ -252,6 +273,8 @@ namespace mongo {
                         db->getCollection(ns.ns()));
             }
 
+            uassertStatusOK(indexer.drainSideWrites());
+
             MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
                 WriteUnitOfWork wunit(txn);
 
@@ -284,7 +307,8 @@ namespace mongo {
                         shardingState.getCollectionMetadata( ns.toString() ));
 
                 if ( metadata ) {
-                    ShardKeyPattern shardKeyPattern(metadata->getKeyPattern());
+                    ShardKeyPattern shardKeyPattern(metadata->getKeyPattern(),
+                                                    metadata->getHashVersion());
                     if (!shardKeyPattern.isUniqueIndexCompatible(newIdxKey)) {
                         return Status(ErrorCodes::CannotCreateIndex,
                             str::stream() << "cannot create unique index over " << newIdxKey
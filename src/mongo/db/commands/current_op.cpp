@@ -31,12 +31,14 @@
 #include "mongo/platform/basic.h"
 
 #include <string>
+#include <vector>
 
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/fsync.h"
+#include "mongo/db/concurrency/admission_context.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
@@ -48,6 +50,59 @@
 
 namespace mongo {
 
+namespace {
+
+    // The fields of an operation's report which are cheap to produce, see appendSummary()
+    const char* const kSummaryFields[] = {
+        "desc", "connectionId", "active", "opid", "secs_running", "microsecs_running", "op", "ns"
+    };
+
+    /**
+     * Whether 'filter' can be matched against the summary of an operation, rather than its full
+     * report. Only plain conditions on summary fields qualify, not operators such as $or or
+     * $where.
+     */
+    bool filterUsesOnlySummaryFields(const BSONObj& filter) {
+        BSONObjIterator it(filter);
+        while (it.more()) {
+            const StringData fieldName = it.next().fieldNameStringData();
+            const StringData topLevelField = fieldName.substr(0, fieldName.find('.'));
+
+            bool isSummaryField = false;
+            for (size_t i = 0; i < sizeof(kSummaryFields) / sizeof(kSummaryFields[0]); i++) {
+                if (topLevelField == kSummaryFields[i]) {
+                    isSummaryField = true;
+                    break;
+                }
+            }
+
+            if (!isSummaryField) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Appends the summary fields of the report on 'client' and its operation 'opCtx', which may be
+     * NULL. The Client must be locked.
+     */
+    void appendSummary(Client* client, const OperationContext* opCtx, BSONObjBuilder* builder) {
+        builder->append("desc", client->desc());
+        if (client->getConnectionId()) {
+            builder->appendNumber("connectionId", client->getConnectionId());
+        }
+
+        builder->appendBool("active", static_cast<bool>(opCtx));
+        if (opCtx) {
+            builder->append("opid", opCtx->getOpID());
+            CurOp::get(opCtx)->reportSummary(builder);
+        }
+    }
+
+} // namespace
+
     class CurrentOpCommand : public Command {
     public:
 
@@ -98,8 +153,12 @@ namespace mongo {
 
             const WhereCallbackReal whereCallback(txn, db);
             const Matcher matcher(filter, whereCallback);
+            const bool matchSummaryOnly =
+                !includeAll && !filter.isEmpty() && filterUsesOnlySummaryFields(filter);
 
-            BSONArrayBuilder inprogBuilder(result.subarrayStart("inprog"));
+            // Clients are only locked while their information is copied out. Filters on anything
+            // but the summary, which may run JavaScript, only run once all locks are released.
+            std::vector<BSONObj> infos;
 
             for (ServiceContext::LockedClientsCursor cursor(txn->getClient()->getServiceContext());
                  Client* client = cursor.next();) {
@@ -115,6 +174,14 @@ namespace mongo {
                         continue;
                 }
 
+                if (matchSummaryOnly) {
+                    BSONObjBuilder summaryBuilder;
+                    appendSummary(client, opCtx, &summaryBuilder);
+                    if (!matcher.matches(summaryBuilder.done())) {
+                        continue;
+                    }
+                }
+
                 BSONObjBuilder infoBuilder;
 
                 // The client information
@@ -129,6 +196,16 @@ namespace mongo {
                     }
 
                     CurOp::get(opCtx)->reportState(&infoBuilder);
+                    AdmissionContext::get(opCtx).reportState(&infoBuilder);
+
+                    // Between releasing one RecoveryUnit and setting the next the operation has
+                    // none, and its counts so far aren't in view.
+                    if (const RecoveryUnit* ru = opCtx->recoveryUnit()) {
+                        OpDebug::appendStorageStats(
+                            ru->getStorageStats().since(
+                                CurOp::get(opCtx)->debug().storageStatsAtStart),
+                            &infoBuilder);
+                    }
 
                     // LockState
                     Locker::LockerInfo lockerInfo;
@@ -136,12 +213,14 @@ namespace mongo {
                     fillLockerInfo(lockerInfo, infoBuilder);
                 }
 
-                infoBuilder.done();
+                infos.push_back(infoBuilder.obj());
+            }
 
-                const BSONObj info = infoBuilder.obj();
+            BSONArrayBuilder inprogBuilder(result.subarrayStart("inprog"));
 
-                if (includeAll || matcher.matches(info)) {
-                    inprogBuilder.append(info);
+            for (size_t i = 0; i < infos.size(); i++) {
+                if (includeAll || matchSummaryOnly || matcher.matches(infos[i])) {
+                    inprogBuilder.append(infos[i]);
                 }
             }
 
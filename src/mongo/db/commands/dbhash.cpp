@@ -39,10 +39,16 @@
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/db_raii.h"
-#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/hex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/md5.hpp"
 #include "mongo/util/timer.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 
@@ -74,72 +80,162 @@ namespace mongo {
         out->push_back(Privilege(ResourcePattern::forDatabaseName(dbname), actions));
     }
 
-    std::string DBHashCmd::hashCollection(OperationContext* opCtx,
-                                          Database* db,
-                                          const std::string& fullCollectionName,
-                                          bool* fromCache) {
+namespace {
+
+    // The most threads hashing collections at once.
+    const int kMaxParallelism = 64;
+
+    /**
+     * Hashes the documents of a collection in order, with md5 or, which is cheaper,
+     * MurmurHash3_x64_128. The murmur hash of a collection is chained through the hashes of its
+     * documents, so it depends on their order as the md5 hash does.
+     */
+    class CollectionHasher {
+    public:
+        explicit CollectionHasher(bool murmur) : _murmur(murmur) {
+            md5_init(&_md5);
+            _murmurState[0] = 0;
+            _murmurState[1] = 0;
+        }
+
+        void append(const BSONObj& doc) {
+            if (!_murmur) {
+                md5_append(&_md5, reinterpret_cast<const md5_byte_t*>(doc.objdata()),
+                           doc.objsize());
+                return;
+            }
+            uint64_t chained[4];
+            chained[0] = _murmurState[0];
+            chained[1] = _murmurState[1];
+            MurmurHash3_x64_128(doc.objdata(), doc.objsize(), 0, &chained[2]);
+            MurmurHash3_x64_128(chained, sizeof(chained), 0, _murmurState);
+        }
+
+        std::string finish() {
+            if (!_murmur) {
+                md5digest d;
+                md5_finish(&_md5, d);
+                return digestToString(d);
+            }
+            return toHexLower(_murmurState, sizeof(_murmurState));
+        }
+
+    private:
+        const bool _murmur;
+        md5_state_t _md5;
+        uint64_t _murmurState[2];
+    };
+
+    /**
+     * Parses the {_id: <value>} bound 'name' of the command into 'out', if given.
+     */
+    Status parseIdBound(const BSONObj& cmdObj, StringData name, BSONObj* out) {
+        BSONElement e = cmdObj[name];
+        if (e.eoo())
+            return Status::OK();
+        if (e.type() != Object || e.Obj().nFields() != 1 || !e.Obj()["_id"].ok()) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << name << " has to be an object of the form "
+                                        << "{_id: <value>}");
+        }
+        *out = e.Obj().getOwned();
+        return Status::OK();
+    }
+
+}  // namespace
+
+    void DBHashCmd::hashCollection(OperationContext* opCtx,
+                                   Database* db,
+                                   const HashOptions& options,
+                                   CollectionHash* out) {
+        const std::string& fullCollectionName = out->fullCollectionName;
         boost::unique_lock<boost::mutex> cachedHashedLock(_cachedHashedMutex, boost::defer_lock);
 
-        if ( isCachable( fullCollectionName ) ) {
+        // Only whole collections hashed with md5 are cached
+        if ( isCachable( fullCollectionName ) && !options.murmur && !options.isRangeHash() ) {
             cachedHashedLock.lock();
             string hash = _cachedHashed[fullCollectionName];
             if ( hash.size() > 0 ) {
-                *fromCache = true;
-                return hash;
+                out->fromCache = true;
+                out->hash = hash;
+                return;
             }
         }
 
-        *fromCache = false;
+        out->fromCache = false;
         Collection* collection = db->getCollection( fullCollectionName );
         if ( !collection )
-            return "";
+            return;
 
         IndexDescriptor* desc = collection->getIndexCatalog()->findIdIndex( opCtx );
-
-        unique_ptr<PlanExecutor> exec;
-        if ( desc ) {
-            exec.reset(InternalPlanner::indexScan(opCtx,
-                                                  collection,
-                                                  desc,
-                                                  BSONObj(),
-                                                  BSONObj(),
-                                                  false,
-                                                  InternalPlanner::FORWARD,
-                                                  InternalPlanner::IXSCAN_FETCH));
-        }
-        else if ( collection->isCapped() ) {
-            exec.reset(InternalPlanner::collectionScan(opCtx,
-                                                       fullCollectionName,
-                                                       collection));
-        }
-        else {
+        if ( !desc && ( !collection->isCapped() || options.isRangeHash() ) ) {
             log() << "can't find _id index for: " << fullCollectionName << endl;
-            return "no _id _index";
+            out->hash = "no _id _index";
+            return;
         }
 
-        md5_state_t st;
-        md5_init(&st);
-
+        // The documents are read through the storage interfaces directly rather than through a
+        // PlanExecutor, as this may run on a worker thread holding no locks of its own.
+        RecordStore* recordStore = collection->getRecordStore();
+        CollectionHasher hasher( options.murmur );
         long long n = 0;
-        PlanExecutor::ExecState state;
-        BSONObj c;
-        verify(NULL != exec.get());
-        while (PlanExecutor::ADVANCED == (state = exec->getNext(&c, NULL))) {
-            md5_append( &st , (const md5_byte_t*)c.objdata() , c.objsize() );
-            n++;
+        if ( desc ) {
+            const IndexAccessMethod* iam = collection->getIndexCatalog()->getIndex( desc );
+            std::unique_ptr<SortedDataInterface::Cursor> cursor = iam->newCursor( opCtx );
+            if ( !options.max.isEmpty() ) {
+                cursor->setEndPosition( BSON( "" << options.max.firstElement() ), false );
+            }
+            const BSONObj start = options.min.isEmpty() ? BSON( "" << MINKEY )
+                                                        : BSON( "" << options.min.firstElement() );
+
+            for ( boost::optional<IndexKeyEntry> entry = cursor->seek( start, true );
+                  entry;
+                  entry = cursor->next() ) {
+                if ( options.maxDocs != 0 && n == options.maxDocs ) {
+                    out->next = BSON( "_id" << entry->key.firstElement() );
+                    break;
+                }
+                RecordData data;
+                if ( !recordStore->findRecord( opCtx, entry->loc, &data ) ) {
+                    warning() << "error while hashing, _id index entry without a document, ns="
+                              << fullCollectionName << endl;
+                    continue;
+                }
+                hasher.append( data.toBson() );
+                n++;
+            }
         }
-        if (PlanExecutor::IS_EOF != state) {
-            warning() << "error while hashing, db dropped? ns=" << fullCollectionName << endl;
+        else {
+            std::unique_ptr<RecordCursor> cursor = recordStore->getCursor( opCtx );
+            while ( boost::optional<Record> record = cursor->next() ) {
+                hasher.append( record->data.toBson() );
+                n++;
+            }
         }
-        md5digest d;
-        md5_finish(&st, d);
-        string hash = digestToString( d );
+
+        out->hash = hasher.finish();
+        out->nDocs = n;
 
         if (cachedHashedLock.owns_lock()) {
-            _cachedHashed[fullCollectionName] = hash;
+            _cachedHashed[fullCollectionName] = out->hash;
         }
+    }
 
-        return hash;
+    void DBHashCmd::hashCollectionOnWorker(Database* db,
+                                           const HashOptions* options,
+                                           CollectionHash* out) {
+        // ThreadPool only logs exceptions, so keep the error for the command's thread
+        try {
+            Client::initThreadIfNotAlready("dbHash");
+            OperationContextImpl txn;
+            hashCollection( &txn, db, *options, out );
+        }
+        catch (const DBException& e) {
+            out->error = e.toString();
+        }
+        catch (const std::exception& e) {
+            out->error = e.what();
+        }
     }
 
     bool DBHashCmd::run(OperationContext* txn,
@@ -163,6 +259,42 @@ namespace mongo {
             }
         }
 
+        HashOptions options;
+        if ( cmdObj.hasField( "hash" ) ) {
+            const string hashName = cmdObj["hash"].valuestrsafe();
+            if ( hashName != "md5" && hashName != "murmur3" ) {
+                errmsg = "hash has to be \"md5\" or \"murmur3\"";
+                return false;
+            }
+            options.murmur = hashName == "murmur3";
+        }
+
+        Status status = parseIdBound( cmdObj, "min", &options.min );
+        if ( status.isOK() )
+            status = parseIdBound( cmdObj, "max", &options.max );
+        if ( !status.isOK() )
+            return appendCommandStatus( result, status );
+
+        if ( cmdObj.hasField( "maxDocs" ) ) {
+            BSONElement e = cmdObj["maxDocs"];
+            if ( !e.isNumber() || e.numberLong() < 1 ) {
+                errmsg = "maxDocs has to be a positive number";
+                return false;
+            }
+            options.maxDocs = e.numberLong();
+        }
+
+        // number of threads hashing collections at once
+        int parallelism = 1;
+        if ( cmdObj.hasField( "parallelism" ) ) {
+            BSONElement e = cmdObj["parallelism"];
+            if ( !e.isNumber() || e.numberInt() < 1 || e.numberInt() > kMaxParallelism ) {
+                return appendCommandStatus( result, Status( ErrorCodes::BadValue, str::stream()
+                    << "parallelism must be a number between 1 and " << kMaxParallelism ) );
+            }
+            parallelism = e.numberInt();
+        }
+
         list<string> colls;
         const string ns = parseNs(dbname, cmdObj);
 
@@ -179,12 +311,8 @@ namespace mongo {
         result.appendNumber( "numCollections" , (long long)colls.size() );
         result.append( "host" , prettyHostName() );
 
-        md5_state_t globalState;
-        md5_init(&globalState);
-
-        vector<string> cached;
-
-        BSONObjBuilder bb( result.subobjStart( "collections" ) );
+        vector<CollectionHash> hashes;
+        vector<string> shortNames;
         for ( list<string>::iterator i=colls.begin(); i != colls.end(); i++ ) {
             string fullCollectionName = *i;
             if ( fullCollectionName.size() -1 <= dbname.size() ) {
@@ -200,17 +328,64 @@ namespace mongo {
                  desiredCollections.count( shortCollectionName ) == 0 )
                 continue;
 
-            bool fromCache = false;
-            string hash = hashCollection( txn, db, fullCollectionName, &fromCache );
+            hashes.push_back( CollectionHash() );
+            hashes.back().fullCollectionName = fullCollectionName;
+            shortNames.push_back( shortCollectionName );
+        }
 
-            bb.append( shortCollectionName, hash );
+        // The workers read under the database lock held here, with storage snapshots of their own
+        // which see the same data as this thread's would. Taking locks of their own instead could
+        // queue them behind an exclusive request waiting for this thread's lock.
+        parallelism = std::min( parallelism, static_cast<int>( hashes.size() ) );
+        if ( parallelism <= 1 ) {
+            for ( size_t i = 0; i < hashes.size(); i++ ) {
+                hashCollection( txn, db, options, &hashes[i] );
+            }
+        }
+        else {
+            ThreadPool pool( parallelism, "dbHash" );
+            for ( size_t i = 0; i < hashes.size(); i++ ) {
+                pool.schedule( &DBHashCmd::hashCollectionOnWorker, this, db, &options, &hashes[i] );
+            }
+            pool.join();
+
+            for ( size_t i = 0; i < hashes.size(); i++ ) {
+                if ( !hashes[i].error.empty() ) {
+                    errmsg = str::stream() << "error hashing " << hashes[i].fullCollectionName
+                                           << ": " << hashes[i].error;
+                    return false;
+                }
+            }
+        }
+
+        md5_state_t globalState;
+        md5_init(&globalState);
+
+        vector<string> cached;
+
+        BSONObjBuilder bb( result.subobjStart( "collections" ) );
+        for ( size_t i = 0; i < hashes.size(); i++ ) {
+            const string& hash = hashes[i].hash;
+            bb.append( shortNames[i], hash );
 
             md5_append( &globalState , (const md5_byte_t*)hash.c_str() , hash.size() );
-            if ( fromCache )
-                cached.push_back( fullCollectionName );
+            if ( hashes[i].fromCache )
+                cached.push_back( hashes[i].fullCollectionName );
         }
         bb.done();
 
+        // For range hashes, how many documents were hashed, and where to go on from
+        if ( options.isRangeHash() ) {
+            BSONObjBuilder ranges( result.subobjStart( "ranges" ) );
+            for ( size_t i = 0; i < hashes.size(); i++ ) {
+                BSONObjBuilder range( ranges.subobjStart( shortNames[i] ) );
+                range.appendNumber( "nDocs", hashes[i].nDocs );
+                if ( !hashes[i].next.isEmpty() ) {
+                    range.append( "next", hashes[i].next );
+                }
+            }
+        }
+
         md5digest d;
         md5_finish(&globalState, d);
         string hash = digestToString( d );
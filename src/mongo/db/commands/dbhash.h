@@ -62,9 +62,58 @@ namespace mongo {
          */
         class DBHashLogOpHandler;
 
+        /**
+         * What the command asked to hash, beyond which collections.
+         */
+        struct HashOptions {
+            HashOptions() : murmur(false), maxDocs(0) {}
+
+            // Whether the cheaper MurmurHash3_x64_128 is used rather than md5.
+            bool murmur;
+
+            // {_id: <value>} bounds of the documents hashed, min inclusive and max exclusive, if
+            // not empty.
+            BSONObj min;
+            BSONObj max;
+
+            // The most documents hashed per collection, if not 0.
+            long long maxDocs;
+
+            bool isRangeHash() const { return !min.isEmpty() || !max.isEmpty() || maxDocs != 0; }
+        };
+
+        /**
+         * The hash of one collection, or of its documents in the range of the HashOptions.
+         */
+        struct CollectionHash {
+            CollectionHash() : fromCache(false), nDocs(0) {}
+
+            std::string fullCollectionName;
+            std::string hash;
+            bool fromCache;
+            long long nDocs;
+
+            // {_id: <value>} to pass as min to hash the rest of the range, when maxDocs stopped it.
+            BSONObj next;
+
+            // Set if hashing on another thread failed.
+            std::string error;
+        };
+
         bool isCachable( StringData ns ) const;
 
-        std::string hashCollection( OperationContext* opCtx, Database* db, const std::string& fullCollectionName, bool* fromCache );
+        void hashCollection( OperationContext* opCtx,
+                             Database* db,
+                             const HashOptions& options,
+                             CollectionHash* out );
+
+        /**
+         * Hashes a collection on a thread of the command's pool, with an OperationContext of its
+         * own but under the locks held by the command.
+         */
+        void hashCollectionOnWorker( Database* db,
+                                     const HashOptions* options,
+                                     CollectionHash* out );
 
         std::map<std::string,std::string> _cachedHashed;
         mutex _cachedHashedMutex;
@@ -161,6 +161,10 @@ namespace mongo {
             // Get summary information about the plan.
             PlanSummaryStats stats;
             Explain::getSummaryStats(exec.get(), &stats);
+            OpDebug& opDebug = CurOp::get(txn)->debug();
+            opDebug.nscanned = stats.totalKeysExamined;
+            opDebug.nscannedObjects = stats.totalDocsExamined;
+            opDebug.replanned = stats.replanned;
 
             verify( start == bb.buf() );
 
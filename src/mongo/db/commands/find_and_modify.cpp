@@ -136,6 +136,7 @@ namespace {
                                   ? UpdateRequest::RETURN_NEW
                                   : UpdateRequest::RETURN_OLD);
         requestOut->setMulti(false);
+        requestOut->setSkipLocked(args.shouldSkipLocked());
         requestOut->setYieldPolicy(PlanExecutor::YIELD_AUTO);
         requestOut->setExplain(explain);
         requestOut->setLifecycle(updateLifecycle);
@@ -148,6 +149,7 @@ namespace {
         requestOut->setProj(args.getFields());
         requestOut->setSort(args.getSort());
         requestOut->setMulti(false);
+        requestOut->setSkipLocked(args.shouldSkipLocked());
         requestOut->setYieldPolicy(PlanExecutor::YIELD_AUTO);
         requestOut->setReturnDeleted(true);  // Always return the old value.
         requestOut->setExplain(explain);
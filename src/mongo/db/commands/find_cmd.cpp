@@ -39,6 +39,8 @@
 #include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/service_context.h"
@@ -46,6 +48,7 @@
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/find.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/query_result_cache.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/s/d_state.h"
@@ -55,6 +58,28 @@
 
 namespace mongo {
 
+namespace {
+
+    /**
+     * Would all of 'results' be returned in the first batch of 'pq'? Mirrors how the first batch
+     * is filled from a PlanExecutor below.
+     */
+    bool fitsInFirstBatch(const LiteParsedQuery& pq, const QueryResultCache::Results& results) {
+        int numResults = 0;
+        int bytes = 0;
+        for (const BSONObj& obj : results) {
+            if (enoughForFirstBatch(pq, numResults, bytes)
+                    || (bytes + obj.objsize() > BSONObjMaxUserSize && numResults > 0)) {
+                return false;
+            }
+            bytes += obj.objsize();
+            numResults++;
+        }
+        return true;
+    }
+
+} // namespace
+
     /**
      * A command for running .find() queries.
      */
@@ -83,6 +108,8 @@ namespace mongo {
          */
         bool shouldAffectCommandCounter() const override { return false; }
 
+        ReadWriteType getReadWriteType() const override { return ReadWriteType::kRead; }
+
         Status checkAuthForCommand(ClientBasic* client,
                                    const std::string& dbname,
                                    const BSONObj& cmdObj) override {
@@ -210,8 +237,19 @@ namespace mongo {
                 cq.reset(rawCq);
             }
 
+            // If the cursor asks for it, its second batch is prefetched once we have released our
+            // locks and unpinned it.
+            CursorId prefetchCursorId = 0;
+            int prefetchBatchSize = 0;
+            ON_BLOCK_EXIT([&] {
+                if (prefetchCursorId) {
+                    CursorPrefetcher::get()->schedule(nss, prefetchCursorId, prefetchBatchSize);
+                }
+            });
+
             // 2) Acquire locks.
-            AutoGetCollectionForRead ctx(txn, nss);
+            AutoGetCollectionForRead ctx(txn, nss,
+                                         AutoGetCollectionForRead::BatchBoundarySnapshot::kAllowed);
             Collection* collection = ctx.getCollection();
 
             const int dbProfilingLevel = ctx.getDb() ? ctx.getDb()->getProfilingLevel() :
@@ -222,6 +260,42 @@ namespace mongo {
             // retry.
             const ChunkVersion shardingVersionAtStart = shardingState.getVersion(nss.ns());
 
+            // 2a) If the collection caches query results, try to answer from the cache without
+            // planning or executing the query. Sharded collections are not cached, as which of
+            // their documents a shard returns depends on its chunks.
+            QueryResultCache* resultCache =
+                collection ? collection->infoCache()->getQueryResultCache() : NULL;
+            std::string resultCacheKey;
+            uint64_t resultCacheGeneration = 0;
+            if (resultCache
+                    && QueryResultCache::canCache(*cq)
+                    && !shardingState.needCollectionMetadata(txn->getClient(), nss.ns())) {
+                resultCacheKey = QueryResultCache::makeKey(*cq);
+
+                // The generation must be read before the snapshot that the query reads from is
+                // opened, so that writes committed in between are noticed.
+                txn->recoveryUnit()->abandonSnapshot();
+                resultCacheGeneration = resultCache->getGeneration();
+
+                std::shared_ptr<const QueryResultCache::Results> cached =
+                    resultCache->get(resultCacheKey);
+                if (cached && fitsInFirstBatch(cq->getParsed(), *cached)) {
+                    CursorResponseBuilder firstBatch(/*isInitialResponse*/ true, &result);
+                    for (const BSONObj& obj : *cached) {
+                        firstBatch.append(obj);
+                    }
+
+                    auto curop = CurOp::get(txn);
+                    curop->debug().nreturned = cached->size();
+                    curop->debug().cursorid = -1;
+                    curop->debug().cursorExhausted = true;
+                    curop->debug().planSummary = "QUERY_RESULT_CACHE";
+
+                    firstBatch.done(0, nss.ns());
+                    return true;
+                }
+            }
+
             // 3) Get the execution plan for the query.
             std::unique_ptr<PlanExecutor> execHolder;
             {
@@ -285,16 +359,18 @@ namespace mongo {
             invariant(!execHolder);
             PlanExecutor* exec = cursor->getExecutor();
 
-            // 5) Stream query results, adding them to a BSONArray as we go.
-            BSONArrayBuilder firstBatch;
+            // 5) Stream query results, adding them directly to the reply as we go.
+            CursorResponseBuilder firstBatch(/*isInitialResponse*/ true, &result);
             BSONObj obj;
             PlanExecutor::ExecState state;
             int numResults = 0;
-            while (!enoughForFirstBatch(pq, numResults, firstBatch.len())
+            QueryResultCache::Results resultsToCache;
+            while (!enoughForFirstBatch(pq, numResults, firstBatch.bytesUsed())
                     && PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
                 // If adding this object will cause us to exceed the BSON size limit, then we stash
                 // it for later.
-                if (firstBatch.len() + obj.objsize() > BSONObjMaxUserSize && numResults > 0) {
+                if (firstBatch.bytesUsed() + obj.objsize() > BSONObjMaxUserSize
+                        && numResults > 0) {
                     exec->enqueue(obj);
                     break;
                 }
@@ -302,6 +378,10 @@ namespace mongo {
                 // Add result to output buffer.
                 firstBatch.append(obj);
                 numResults++;
+
+                if (!resultCacheKey.empty()) {
+                    resultsToCache.push_back(obj.getOwned());
+                }
             }
 
             // Throw an assertion if query execution fails for any reason.
@@ -311,6 +391,7 @@ namespace mongo {
                         << PlanExecutor::statestr(state)
                         << ", stats: " << Explain::statsToBSON(*stats);
 
+                firstBatch.abandon();
                 return appendCommandStatus(result,
                                            Status(ErrorCodes::OperationFailed,
                                                   str::stream()
@@ -321,6 +402,7 @@ namespace mongo {
             // 6) Set up the cursor for getMore.
             if (shouldSaveCursor(txn, collection, state, exec)) {
                 // State will be restored on getMore.
+                pinSnapshotForNextGetMore(txn, state);
                 exec->saveState();
 
                 cursor->setLeftoverMaxTimeMicros(CurOp::get(txn)->getRemainingMaxTimeMicros());
@@ -331,22 +413,38 @@ namespace mongo {
                 if (!(pq.isTailable() && state == PlanExecutor::IS_EOF)) {
                     // We stash away the RecoveryUnit in the ClientCursor. It's used for
                     // subsequent getMore requests. The calling OpCtx gets a fresh RecoveryUnit.
-                    txn->recoveryUnit()->abandonSnapshot();
+                    if (!txn->recoveryUnit()->isSnapshotPinned()) {
+                        txn->recoveryUnit()->abandonSnapshot();
+                    }
                     cursor->setOwnedRecoveryUnit(txn->releaseRecoveryUnit());
                     StorageEngine* engine = getGlobalServiceContext()->getGlobalStorageEngine();
                     txn->setRecoveryUnit(engine->newRecoveryUnit(),
                                          OperationContext::kNotInUnitOfWork);
                 }
+
+                // Tailable cursors are not prefetched, as their next batch may not exist yet.
+                if (pq.isPrefetchNextBatch()
+                        && !pq.isTailable()
+                        && !txn->getClient()->isInDirectClient()) {
+                    cursor->setPrefetchNextBatch(true);
+                    prefetchCursorId = cursorId;
+                    prefetchBatchSize = pq.getBatchSize().value_or(0);
+                }
             }
             else {
                 cursorId = 0;
             }
 
+            // Only complete results are cached, which a query that returns no cursor has.
+            if (!resultCacheKey.empty() && PlanExecutor::IS_EOF == state && !cursorId) {
+                resultCache->add(resultCacheKey, resultCacheGeneration, std::move(resultsToCache));
+            }
+
             // Fill out curop based on the results.
             endQueryOp(txn, exec, dbProfilingLevel, numResults, cursorId);
 
             // 7) Generate the response object to send to the client.
-            appendCursorResponseObject(cursorId, nss.ns(), firstBatch.arr(), &result);
+            firstBatch.done(cursorId, nss.ns());
             if (cursorId) {
                 cursorFreer.Dismiss();
             }
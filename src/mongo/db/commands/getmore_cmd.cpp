@@ -41,6 +41,7 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/global_timestamp.h"
@@ -88,6 +89,8 @@ namespace mongo {
          */
         bool shouldAffectCommandCounter() const override { return false; }
 
+        ReadWriteType getReadWriteType() const override { return ReadWriteType::kRead; }
+
         std::string parseNs(const std::string& dbname, const BSONObj& cmdObj) const override {
             return GetMoreRequest::parseNs(dbname, cmdObj);
         }
@@ -126,6 +129,19 @@ namespace mongo {
             }
             const GetMoreRequest& request = parseStatus.getValue();
 
+            // The prefetch of this batch, if any, must be done with the cursor before we pin it.
+            // The prefetch of the batch after it is scheduled once we have released our locks and
+            // unpinned the cursor.
+            CursorPrefetcher::get()->waitFor(request.cursorid);
+            bool prefetchNextBatch = false;
+            ON_BLOCK_EXIT([&] {
+                if (prefetchNextBatch) {
+                    CursorPrefetcher::get()->schedule(request.nss,
+                                                      request.cursorid,
+                                                      request.batchSize.value_or(0));
+                }
+            });
+
             // Depending on the type of cursor being operated on, we hold locks for the whole
             // getMore, or none of the getMore, or part of the getMore.  The three cases in detail:
             //
@@ -228,31 +244,34 @@ namespace mongo {
             exec->restoreState(txn);
 
             // If we're tailing a capped collection, retrieve a monotonically increasing insert
-            // counter.
+            // counter. We hold on to the notifier from here on, so that inserts committed while we
+            // generate the batch are counted.
+            std::shared_ptr<CappedInsertNotifier> notifier;
             uint64_t lastInsertCount = 0;
             if (isCursorAwaitData(cursor)) {
                 invariant(ctx->getCollection()->isCapped());
-                lastInsertCount = ctx->getCollection()->getCappedInsertNotifier()->getCount();
+                notifier = ctx->getCollection()->getCappedInsertNotifier();
+                lastInsertCount = notifier->getCount();
             }
 
             CursorId respondWithId = 0;
-            BSONArrayBuilder nextBatch;
+            CursorResponseBuilder nextBatch(/*isInitialResponse*/ false, &result);
             BSONObj obj;
             PlanExecutor::ExecState state;
             int numResults = 0;
             Status batchStatus = generateBatch(cursor, request, &nextBatch, &state, &numResults);
             if (!batchStatus.isOK()) {
+                nextBatch.abandon();
                 return appendCommandStatus(result, batchStatus);
             }
 
             // If this is an await data cursor, and we hit EOF without generating any results, then
             // we block waiting for new oplog data to arrive.
             if (isCursorAwaitData(cursor) && state == PlanExecutor::IS_EOF && numResults == 0) {
-                // Retrieve the notifier which we will wait on until new data arrives. We make sure
-                // to do this in the lock because once we drop the lock it is possible for the
+                // We retrieved the notifier which we will wait on until new data arrives while
+                // holding the lock, because once we drop the lock it is possible for the
                 // collection to become invalid. The notifier itself will outlive the collection if
                 // the collection is dropped, as we keep a shared_ptr to it.
-                auto notifier = ctx->getCollection()->getCappedInsertNotifier();
 
                 // Save the PlanExecutor and drop our locks.
                 exec->saveState();
@@ -270,6 +289,7 @@ namespace mongo {
                 // way, attempt to generate another batch of results.
                 batchStatus = generateBatch(cursor, request, &nextBatch, &state, &numResults);
                 if (!batchStatus.isOK()) {
+                    nextBatch.abandon();
                     return appendCommandStatus(result, batchStatus);
                 }
             }
@@ -277,6 +297,9 @@ namespace mongo {
             if (shouldSaveCursorGetMore(state, exec, isCursorTailable(cursor))) {
                 respondWithId = request.cursorid;
 
+                if (!cursor->isAggCursor()) {
+                    pinSnapshotForNextGetMore(txn, state);
+                }
                 exec->saveState();
 
                 // If maxTimeMS was set directly on the getMore rather than being rolled over
@@ -288,6 +311,10 @@ namespace mongo {
 
                 cursor->incPos(numResults);
 
+                prefetchNextBatch = cursor->prefetchNextBatch()
+                                    && !isCursorTailable(cursor)
+                                    && !cursor->isAggCursor();
+
                 if (isCursorTailable(cursor) && state == PlanExecutor::IS_EOF) {
                     // Rather than swapping their existing RU into the client cursor, tailable
                     // cursors should get a new recovery unit.
@@ -298,7 +325,7 @@ namespace mongo {
                 CurOp::get(txn)->debug().cursorExhausted = true;
             }
 
-            appendGetMoreResponseObject(respondWithId, request.nss.ns(), nextBatch.arr(), &result);
+            nextBatch.done(respondWithId, request.nss.ns());
 
             if (respondWithId) {
                 cursorFreer.Dismiss();
@@ -329,7 +356,7 @@ namespace mongo {
          */
         Status generateBatch(ClientCursor* cursor,
                              const GetMoreRequest& request,
-                             BSONArrayBuilder* nextBatch,
+                             CursorResponseBuilder* nextBatch,
                              PlanExecutor::ExecState* state,
                              int* numResults) {
             PlanExecutor* exec = cursor->getExecutor();
@@ -343,7 +370,8 @@ namespace mongo {
                 while (PlanExecutor::ADVANCED == (*state = exec->getNext(&obj, NULL))) {
                     // If adding this object will cause us to exceed the BSON size limit, then we
                     // stash it for later.
-                    if (nextBatch->len() + obj.objsize() > BSONObjMaxUserSize && *numResults > 0) {
+                    if (nextBatch->bytesUsed() + obj.objsize() > BSONObjMaxUserSize
+                            && *numResults > 0) {
                         exec->enqueue(obj);
                         break;
                     }
@@ -353,7 +381,7 @@ namespace mongo {
                     (*numResults)++;
 
                     if (enoughForGetMore(request.batchSize.value_or(0),
-                                         *numResults, nextBatch->len())) {
+                                         *numResults, nextBatch->bytesUsed())) {
                         break;
                     }
                 }
@@ -32,6 +32,8 @@
 
 #include "mongo/db/commands/mr.h"
 
+#include <cmath>
+
 
 #include "mongo/client/connpool.h"
 #include "mongo/client/parallel.h"
@@ -56,6 +58,7 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/range_preserver.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/collection_metadata.h"
@@ -84,6 +87,9 @@ namespace mongo {
 
         AtomicUInt32 Config::JOB_NUMBER;
 
+        // Reduce functions which sum their values or take the minimum or maximum run natively
+        MONGO_EXPORT_SERVER_PARAMETER(internalMapReduceUseNativeReducers, bool, true);
+
         JSFunction::JSFunction( const std::string& type , const BSONElement& e ) {
             _type = type;
             _code = e._asCode();
@@ -261,6 +267,252 @@ namespace mongo {
             _reduce( x , key , endSizeEstimate );
         }
 
+        namespace {
+
+            bool isIdentifierStart( char c ) {
+                return isalpha( c ) || c == '_' || c == '$';
+            }
+
+            bool isIdentifierChar( char c ) {
+                return isIdentifierStart( c ) || isdigit( c );
+            }
+
+            /**
+             * Splits JS source into identifiers, numbers and operators, dropping whitespace and
+             * comments. '#' starts a placeholder identifier, which only templates use.
+             * @return false for source holding anything we don't need to understand, such as
+             * string literals or division.
+             */
+            bool tokenize( StringData code , vector<string>* tokens ) {
+                size_t i = 0;
+                while ( i < code.size() ) {
+                    const char c = code[i];
+                    if ( isspace( c ) ) {
+                        i++;
+                    }
+                    else if ( code.substr( i ).startsWith( "//" ) ) {
+                        while ( i < code.size() && code[i] != '\n' )
+                            i++;
+                    }
+                    else if ( code.substr( i ).startsWith( "/*" ) ) {
+                        const size_t end = code.substr( i + 2 ).find( "*/" );
+                        if ( end == string::npos )
+                            return false;
+                        i += end + 4;
+                    }
+                    else if ( isIdentifierChar( c ) || c == '#' ) {
+                        const size_t start = i++;
+                        while ( i < code.size() && isIdentifierChar( code[i] ) )
+                            i++;
+                        tokens->push_back( code.substr( start , i - start ).toString() );
+                    }
+                    else if ( strchr( "(){}[],;.=<" , c ) ) {
+                        tokens->push_back( string( 1 , c ) );
+                        i++;
+                    }
+                    else if ( c == '+' && i + 1 < code.size() &&
+                              ( code[i + 1] == '+' || code[i + 1] == '=' ) ) {
+                        tokens->push_back( code.substr( i , 2 ).toString() );
+                        i += 2;
+                    }
+                    else {
+                        return false;
+                    }
+                }
+
+                // semicolons are optional before the end of a block
+                vector<string> result;
+                for ( size_t j = 0; j < tokens->size(); j++ ) {
+                    if ( (*tokens)[j] == ";" &&
+                         ( j + 1 == tokens->size() || (*tokens)[j + 1] == "}" ) )
+                        continue;
+                    result.push_back( (*tokens)[j] );
+                }
+                tokens->swap( result );
+                return true;
+            }
+
+            /**
+             * Matches the tokens of a function body against a template, where each placeholder
+             * stands for one identifier. Placeholders already bound in 'names' must match the
+             * same identifier, and different placeholders must be different identifiers.
+             */
+            bool matchTemplate( const vector<string>& tokens ,
+                                size_t pos ,
+                                const char* pattern ,
+                                std::map<string, string> names ) {
+                vector<string> expected;
+                verify( tokenize( pattern , &expected ) );
+                if ( tokens.size() - pos != expected.size() )
+                    return false;
+
+                for ( size_t i = 0; i < expected.size(); i++ ) {
+                    const string& token = tokens[pos + i];
+                    if ( expected[i][0] != '#' ) {
+                        if ( token != expected[i] )
+                            return false;
+                        continue;
+                    }
+
+                    if ( !isIdentifierStart( token[0] ) || token == "Array" || token == "Math" )
+                        return false;
+                    std::map<string, string>::const_iterator it = names.find( expected[i] );
+                    if ( it != names.end() ) {
+                        if ( it->second != token )
+                            return false;
+                        continue;
+                    }
+                    for ( it = names.begin(); it != names.end(); ++it ) {
+                        if ( it->second == token )
+                            return false;
+                    }
+                    names[expected[i]] = token;
+                }
+                return true;
+            }
+
+            struct ReduceTemplate {
+                const char* body;
+                NativeReducer::Op op;
+            };
+
+            // #K is the key and #V the values argument, the others are local variables
+            const ReduceTemplate reduceTemplates[] = {
+                { "{ return Array.sum(#V); }", NativeReducer::SUM },
+                { "{ var #R = 0; for (var #I = 0; #I < #V.length; #I++) #R += #V[#I]; "
+                  "return #R; }", NativeReducer::SUM_FROM_ZERO },
+                { "{ var #R = 0; for (var #I = 0; #I < #V.length; #I++) { #R += #V[#I]; } "
+                  "return #R; }", NativeReducer::SUM_FROM_ZERO },
+                { "{ var #R = 0; for (var #I = 0; #I < #V.length; ++#I) #R += #V[#I]; "
+                  "return #R; }", NativeReducer::SUM_FROM_ZERO },
+                { "{ var #R = 0; for (var #I = 0; #I < #V.length; ++#I) { #R += #V[#I]; } "
+                  "return #R; }", NativeReducer::SUM_FROM_ZERO },
+                { "{ var #R = 0; #V.forEach(function(#X) { #R += #X; }); return #R; }",
+                  NativeReducer::SUM_FROM_ZERO },
+                { "{ return Math.min.apply(Math, #V); }", NativeReducer::MIN },
+                { "{ return Math.min.apply(null, #V); }", NativeReducer::MIN },
+                { "{ return Math.max.apply(Math, #V); }", NativeReducer::MAX },
+                { "{ return Math.max.apply(null, #V); }", NativeReducer::MAX },
+            };
+
+        } // namespace
+
+        NativeReducer::Op NativeReducer::recognize( const BSONElement& code ) {
+            // a CodeWScope could shadow Array or Math
+            if ( code.type() != Code && code.type() != String )
+                return NONE;
+
+            vector<string> tokens;
+            if ( !tokenize( code.valueStringData() , &tokens ) )
+                return NONE;
+
+            // function [name](key, values)
+            size_t pos = 0;
+            if ( tokens.size() < 6 || tokens[pos++] != "function" )
+                return NONE;
+            if ( tokens[pos] != "(" )
+                pos++;
+            if ( tokens.size() < pos + 5 || tokens[pos] != "(" || tokens[pos + 2] != "," ||
+                 tokens[pos + 4] != ")" )
+                return NONE;
+
+            std::map<string, string> names;
+            names["#K"] = tokens[pos + 1];
+            names["#V"] = tokens[pos + 3];
+            if ( !isIdentifierStart( names["#K"][0] ) || !isIdentifierStart( names["#V"][0] ) ||
+                 names["#K"] == names["#V"] )
+                return NONE;
+            pos += 5;
+
+            const size_t numTemplates = sizeof( reduceTemplates ) / sizeof( reduceTemplates[0] );
+            for ( size_t i = 0; i < numTemplates; i++ ) {
+                if ( matchTemplate( tokens , pos , reduceTemplates[i].body , names ) )
+                    return reduceTemplates[i].op;
+            }
+            return NONE;
+        }
+
+        bool NativeReducer::_reduceNumbers( const BSONList& tuples , double* out ) const {
+            double result = 0;
+            for ( size_t i = 0; i < tuples.size(); i++ ) {
+                BSONObjIterator it( tuples[i] );
+                it.next();
+                const BSONElement value = it.next();
+                if ( !value.isNumber() )
+                    return false;
+                const double x = value.numberDouble();
+
+                if ( i == 0 && _op != SUM_FROM_ZERO ) {
+                    result = x;
+                    continue;
+                }
+                switch ( _op ) {
+                case SUM:
+                case SUM_FROM_ZERO:
+                    result += x;
+                    break;
+                case MIN:
+                    // like Math.min, NaN wins and -0 is less than 0
+                    if ( std::isnan( x ) || x < result ||
+                         ( x == result && std::signbit( x ) ) )
+                        result = x;
+                    break;
+                case MAX:
+                    if ( std::isnan( x ) || x > result ||
+                         ( x == result && !std::signbit( x ) ) )
+                        result = x;
+                    break;
+                case NONE:
+                    invariant( false );
+                }
+            }
+            *out = result;
+            return true;
+        }
+
+        void NativeReducer::_collectJSReduces() {
+            numReduces += _js.numReduces;
+            _js.numReduces = 0;
+        }
+
+        BSONObj NativeReducer::reduce( const BSONList& tuples ) {
+            if ( tuples.size() <= 1 )
+                return tuples[0];
+
+            double value;
+            if ( !_reduceNumbers( tuples , &value ) ) {
+                BSONObj res = _js.reduce( tuples );
+                _collectJSReduces();
+                return res;
+            }
+            ++numReduces;
+
+            BSONObjBuilder b;
+            b.appendAs( tuples[0].firstElement() , "0" );
+            b.append( "1" , value );
+            return b.obj();
+        }
+
+        BSONObj NativeReducer::finalReduce( const BSONList& tuples , Finalizer * finalizer ) {
+            double value;
+            if ( tuples.size() == 1 || !_reduceNumbers( tuples , &value ) ) {
+                BSONObj res = _js.finalReduce( tuples , finalizer );
+                _collectJSReduces();
+                return res;
+            }
+            ++numReduces;
+
+            BSONObjBuilder b;
+            b.appendAs( tuples[0].firstElement() , "_id" );
+            b.append( "value" , value );
+            BSONObj res = b.obj();
+
+            if ( finalizer ) {
+                res = finalizer->finalize( res );
+            }
+            return res;
+        }
+
         Config::Config( const string& _dbname , const BSONObj& cmdObj )
         {
             dbname = _dbname;
@@ -307,7 +559,15 @@ namespace mongo {
                     scopeSetup = cmdObj["scope"].embeddedObjectUserCheck();
 
                 mapper.reset( new JSMapper( cmdObj["map"] ) );
-                reducer.reset( new JSReducer( cmdObj["reduce"] ) );
+
+                // the scope could redefine what the reduce function calls
+                const NativeReducer::Op nativeOp = internalMapReduceUseNativeReducers &&
+                        !scopeSetup.hasField( "Array" ) && !scopeSetup.hasField( "Math" ) ?
+                    NativeReducer::recognize( cmdObj["reduce"] ) : NativeReducer::NONE;
+                if ( nativeOp != NativeReducer::NONE )
+                    reducer.reset( new NativeReducer( nativeOp , cmdObj["reduce"] ) );
+                else
+                    reducer.reset( new JSReducer( cmdObj["reduce"] ) );
                 if ( cmdObj["finalize"].type() && cmdObj["finalize"].trueValue() )
                     finalizer.reset( new JSFinalizer( cmdObj["finalize"] ) );
 
@@ -1442,7 +1702,8 @@ namespace mongo {
                             // check to see if this is a new object we don't own yet
                             // because of a chunk migration
                             if ( collMetadata ) {
-                                ShardKeyPattern kp( collMetadata->getKeyPattern() );
+                                ShardKeyPattern kp( collMetadata->getKeyPattern(),
+                                                    collMetadata->getHashVersion() );
                                 if (!collMetadata->keyBelongsToMe(kp.extractShardKeyFromDoc(o))) {
                                     continue;
                                 }
@@ -146,6 +146,47 @@ namespace mongo {
             JSFunction _func;
         };
 
+        /**
+         * Stands in for a JS reduce function which was recognized as summing its values or taking
+         * their minimum or maximum. Lists of numbers are reduced natively, with the same double
+         * arithmetic as JS; lists holding anything else are passed to the JS function.
+         */
+        class NativeReducer : public Reducer {
+        public:
+            enum Op {
+                NONE,
+                SUM, // Array.sum(values), which starts at values[0]
+                SUM_FROM_ZERO, // a loop adding each value to 0
+                MIN,
+                MAX
+            };
+
+            /**
+             * @return the operation that the reduce function 'code' performs, or NONE if it
+             * doesn't look like one of the functions we know.
+             */
+            static Op recognize( const BSONElement& code );
+
+            NativeReducer( Op op , const BSONElement& code ) : _op( op ) , _js( code ) {}
+            virtual void init( State * state ) { _js.init( state ); }
+
+            virtual BSONObj reduce( const BSONList& tuples );
+            virtual BSONObj finalReduce( const BSONList& tuples , Finalizer * finalizer );
+
+        private:
+            /**
+             * @return false if some value isn't a number, in which case the JS function must be
+             * used for this list.
+             */
+            bool _reduceNumbers( const BSONList& tuples , double* out ) const;
+
+            /** Accounts the reduces the JS function did in our count. */
+            void _collectJSReduces();
+
+            const Op _op;
+            JSReducer _js;
+        };
+
         class JSFinalizer : public Finalizer  {
         public:
             JSFinalizer( const BSONElement& code ) : _func( "_finalize" , code ) {}
@@ -50,6 +50,7 @@
 #include "mongo/db/query/cursor_responses.h"
 #include "mongo/db/query/find_constants.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/storage_options.h"
 
 namespace mongo {
@@ -218,6 +219,7 @@ namespace mongo {
             PlanExecutor* exec = NULL;
             unique_ptr<ClientCursorPin> pin; // either this OR the execHolder will be non-null
             unique_ptr<PlanExecutor> execHolder;
+            bool profiling = false;
             {
                 // This will throw if the sharding version for this connection is out of date. The
                 // lock must be held continuously from now until we have we created both the output
@@ -237,6 +239,12 @@ namespace mongo {
                                                                                        pCtx);
                 pPipeline->stitch();
 
+                // Timing every getNext() isn't free, so only do it when someone will look.
+                profiling = ctx.getDb() && ctx.getDb()->getProfilingLevel() > 0;
+                if (pPipeline->isExplainExecutionStats() || profiling) {
+                    pPipeline->enableTiming();
+                }
+
                 // Create the PlanExecutor which returns results from the pipeline. The WorkingSet
                 // ('ws') and the PipelineProxyStage ('proxy') will be owned by the created
                 // PlanExecutor.
@@ -299,6 +307,9 @@ namespace mongo {
 
                 // If both explain and cursor are specified, explain wins.
                 if (pPipeline->isExplain()) {
+                    if (pPipeline->isExplainExecutionStats()) {
+                        pPipeline->runForExplain();
+                    }
                     result << "stages" << Value(pPipeline->writeExplainOps());
                 }
                 else if (isCursorCommand) {
@@ -313,6 +324,13 @@ namespace mongo {
                     pPipeline->run(result);
                 }
 
+                // For the slow query log and the profiler. With a cursor, this only covers the
+                // first batch.
+                CurOp* curOp = CurOp::get(txn);
+                if (profiling || curOp->elapsedMillis() > serverGlobalParams.slowMS) {
+                    curOp->debug().planSummary = pPipeline->getStatsSummary();
+                }
+
                 // Clean up our ClientCursorPin, if needed.  We must reacquire the collection lock
                 // in order to do so.
                 if (pin) {
@@ -267,6 +267,10 @@ namespace mongo {
         }
         arrayBuilder.doneFast();
 
+        BSONObjBuilder statsBuilder(bob->subobjStart("stats"));
+        planCache.appendStats(&statsBuilder);
+        statsBuilder.doneFast();
+
         return Status::OK();
     }
 
@@ -145,6 +145,18 @@ namespace {
         ASSERT_EQUALS(shapes[0].getObjectField("projection"), cq->getParsed().getProj());
     }
 
+    TEST(PlanCacheCommandsTest, planCacheListQueryShapesStats) {
+        PlanCache planCache;
+        BSONObjBuilder bob;
+        ASSERT_OK(PlanCacheListQueryShapes::list(planCache, &bob));
+        BSONObj stats = bob.obj().getObjectField("stats");
+        ASSERT_EQUALS(0, stats["entries"].numberInt());
+        ASSERT_TRUE(stats.hasField("hits"));
+        ASSERT_TRUE(stats.hasField("misses"));
+        ASSERT_TRUE(stats.hasField("evictions"));
+        ASSERT_TRUE(stats.hasField("replans"));
+    }
+
     /**
      * Tests for planCacheClear
      */
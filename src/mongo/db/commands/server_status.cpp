@@ -44,10 +44,13 @@
 #include "mongo/db/commands/server_status_internal.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/util/log.h"
+#include "mongo/util/memory_accounting.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/ssl_manager.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
 #include "mongo/util/version.h"
@@ -299,6 +302,19 @@ namespace mongo {
         } security;
 #endif
 
+        class Numa : public ServerStatusSection {
+        public:
+            Numa() : ServerStatusSection( "numa" ) {}
+            virtual bool includeByDefault() const { return false; }
+
+            BSONObj generateSection(OperationContext* txn,
+                                    const BSONElement& configElement) const {
+                BSONObjBuilder b;
+                appendNumaInfo( &b, true );
+                return b.obj();
+            }
+        } numa;
+
         class MemBase : public ServerStatusMetric {
         public:
             MemBase() : ServerStatusMetric(".mem.bits") {}
@@ -320,6 +336,34 @@ namespace mongo {
 
             }
         } memBase;
+
+        class MemAccounted : public ServerStatusMetric {
+        public:
+            MemAccounted() : ServerStatusMetric(".mem.accounted") {}
+            virtual void appendAtLeaf( BSONObjBuilder& b ) const {
+                BSONObjBuilder accounted( b.subobjStart( "accounted" ) );
+                const std::vector<const MemoryAccount*> accounts = MemoryAccount::getAll();
+                for ( size_t i = 0; i < accounts.size(); i++ ) {
+                    BSONObjBuilder account( accounted.subobjStart( accounts[i]->getName() ) );
+                    account.appendNumber( "bytes" , accounts[i]->getBytes() );
+                    account.appendNumber( "objects" , accounts[i]->getObjects() );
+                }
+            }
+        } memAccounted;
+
+        class AsyncLogStats : public ServerStatusMetric {
+        public:
+            AsyncLogStats() : ServerStatusMetric("log.async") {}
+            virtual void appendAtLeaf( BSONObjBuilder& b ) const {
+                const logger::AsyncLogWriter::Stats stats =
+                    logger::AsyncLogWriter::getCombinedStats();
+                BSONObjBuilder async( b.subobjStart( "async" ) );
+                async.appendNumber( "queuedBytes" , static_cast<long long>( stats.queuedBytes ) );
+                async.appendNumber( "written" , static_cast<long long>( stats.written ) );
+                async.appendNumber( "dropped" , static_cast<long long>( stats.dropped ) );
+                async.appendNumber( "blocked" , static_cast<long long>( stats.blocked ) );
+            }
+        } asyncLogStats;
     }
 
 }
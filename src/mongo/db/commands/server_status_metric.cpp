@@ -31,6 +31,7 @@
 #include "mongo/db/commands/server_status_metric.h"
 
 #include "mongo/db/commands/server_status_internal.h"
+#include "mongo/db/stats/latency_histogram.h"
 
 namespace mongo {
 
@@ -53,6 +54,18 @@ namespace mongo {
         return name.substr( idx + 1 );
     }
 
+    ServerStatusHistogramMetric::ServerStatusHistogramMetric(const string& name,
+                                                             const LatencyHistogram* histogram,
+                                                             StringData totalFieldName)
+        : ServerStatusMetric(name),
+          _histogram(histogram),
+          _totalFieldName(totalFieldName.toString()) {
+    }
+
+    void ServerStatusHistogramMetric::appendAtLeaf( BSONObjBuilder& b ) const {
+        BSONObjBuilder histogramBuilder(b.subobjStart(_leafName));
+        _histogram->append(&histogramBuilder, _totalFieldName);
+    }
 
 }
 
@@ -36,6 +36,8 @@
 
 namespace mongo {
 
+    class LatencyHistogram;
+
     class ServerStatusMetric {
     public:
         /**
@@ -87,5 +89,23 @@ namespace mongo {
         const T* _t;
     };
 
+    /**
+     * Shows a LatencyHistogram as a subdocument, see LatencyHistogram::append().
+     *
+     * Histograms of something other than microseconds can name their total 'totalFieldName'.
+     */
+    class ServerStatusHistogramMetric : public ServerStatusMetric {
+    public:
+        ServerStatusHistogramMetric(const std::string& name,
+                                    const LatencyHistogram* histogram,
+                                    StringData totalFieldName = "totalMicros");
+
+        virtual void appendAtLeaf( BSONObjBuilder& b ) const;
+
+    private:
+        const LatencyHistogram* const _histogram;
+        const std::string _totalFieldName;
+    };
+
 }
 
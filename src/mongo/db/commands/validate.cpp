@@ -54,7 +54,8 @@ namespace mongo {
         }
 
         virtual void help(stringstream& h) const { h << "Validate contents of a namespace by scanning its data structures for correctness.  Slow.\n"
-                                                        "Add full:true option to do a more thorough check"; }
+                                                        "Add full:true option to do a more thorough check.\n"
+            "Add parallelism:<n> to validate the indexes on n threads"; }
 
         virtual bool isWriteCommandForConfigServer() const { return false; }
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -64,7 +65,10 @@ namespace mongo {
             actions.addAction(ActionType::validate);
             out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
         }
-        //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool> } */
+        //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool>]
+        //  [, parallelism: <threads>] } */
+
+        static const int kMaxParallelism = 64;
 
         bool run(OperationContext* txn,
                  const string& dbname,
@@ -83,6 +87,17 @@ namespace mongo {
                 return false;
             }
 
+            // number of threads validating the indexes while this one validates the records
+            int parallelism = 1;
+            if ( cmdObj.hasField( "parallelism" ) ) {
+                BSONElement e = cmdObj["parallelism"];
+                if ( !e.isNumber() || e.numberInt() < 1 || e.numberInt() > kMaxParallelism ) {
+                    return appendCommandStatus( result, Status( ErrorCodes::BadValue, str::stream()
+                        << "parallelism must be a number between 1 and " << kMaxParallelism ) );
+                }
+                parallelism = e.numberInt();
+            }
+
             if (!serverGlobalParams.quiet) {
                 LOG(0) << "CMD: validate " << ns << endl;
             }
@@ -98,7 +113,8 @@ namespace mongo {
             result.append( "ns", ns );
 
             ValidateResults results;
-            Status status = collection->validate( txn, full, scanData, &results, &result );
+            Status status = collection->validate( txn, full, scanData, &results, &result,
+                                                 parallelism );
             if ( !status.isOK() )
                 return appendCommandStatus( result, status );
 
@@ -0,0 +1,94 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/cache_warmup.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::stringstream;
+
+    class WarmUpCacheCmd : public Command {
+    public:
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual bool adminOnly() const { return true; }
+        virtual bool slaveOk() const { return true; }
+        virtual void help( stringstream& help ) const {
+            help << "read collections and their indexes into the storage engine's cache\n"
+                "{ warmUpCache : 1, [namespaces : [<ns>, ...]] }\n"
+                " namespaces - defaults to the collections this server has used the most\n";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::touch);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        WarmUpCacheCmd() : Command("warmUpCache") { }
+
+        virtual bool run(OperationContext* txn,
+                         const string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         string& errmsg,
+                         BSONObjBuilder& result) {
+            std::vector<string> namespaces;
+            BSONElement namespacesElt = cmdObj["namespaces"];
+            if ( !namespacesElt.eoo() ) {
+                if ( namespacesElt.type() != Array ) {
+                    errmsg = "namespaces must be an array";
+                    return false;
+                }
+                BSONObjIterator it( namespacesElt.Obj() );
+                while ( it.more() ) {
+                    BSONElement e = it.next();
+                    if ( e.type() != String ) {
+                        errmsg = "namespaces must be strings";
+                        return false;
+                    }
+                    namespaces.push_back( e.String() );
+                }
+            }
+
+            return appendCommandStatus( result, warmUpCache( txn, namespaces, &result ) );
+        }
+
+    };
+    static WarmUpCacheCmd warmUpCacheCmd;
+}
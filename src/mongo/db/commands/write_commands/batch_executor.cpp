@@ -34,6 +34,7 @@
 
 #include <memory>
 
+#include "mongo/base/counter.h"
 #include "mongo/base/error_codes.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
@@ -41,6 +42,7 @@
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop_metrics.h"
 #include "mongo/db/db_raii.h"
@@ -115,6 +117,24 @@ namespace mongo {
     // TODO: Determine queueing behavior we want here
     MONGO_EXPORT_SERVER_PARAMETER( queueForMigrationCommit, bool, true );
 
+    // Maximum number of documents of an insert batch inserted within one write unit of work.  A
+    // value of 1 inserts every document in its own write unit of work.
+    MONGO_EXPORT_SERVER_PARAMETER( internalInsertMaxBatchSize, int, 64 );
+
+    // Maximum total size of the documents inserted within one write unit of work, which bounds the
+    // amount of work thrown away when one of them fails.
+    static const int kInsertGroupMaxBytes = 256 * 1024;
+
+    static Counter64 groupedInsertDocsStats;
+    static ServerStatusMetricField<Counter64> displayGroupedInsertDocs( "insert.grouped.docs",
+                                                                       &groupedInsertDocsStats );
+    static Counter64 groupedInsertGroupsStats;
+    static ServerStatusMetricField<Counter64> displayGroupedInsertGroups(
+            "insert.grouped.groups", &groupedInsertGroupsStats );
+    static Counter64 groupedInsertFallbacksStats;
+    static ServerStatusMetricField<Counter64> displayGroupedInsertFallbacks(
+            "insert.grouped.fallbacks", &groupedInsertFallbacksStats );
+
     using mongoutils::str::stream;
 
     WriteBatchExecutor::WriteBatchExecutor( OperationContext* txn,
@@ -477,7 +497,8 @@ namespace mongo {
             CollectionMetadataPtr metadata = shardingState->getCollectionMetadata( nss.ns() );
 
             if ( metadata ) {
-                ShardKeyPattern shardKeyPattern(metadata->getKeyPattern());
+                ShardKeyPattern shardKeyPattern(metadata->getKeyPattern(),
+                                                metadata->getHashVersion());
                 if (!shardKeyPattern.isUniqueIndexCompatible(request.getIndexKeyPattern())) {
 
                     result->setError(new WriteErrorDetail);
@@ -507,6 +528,7 @@ namespace mongo {
 
         currentOp->debug().ns = currentOp->getNS();
         currentOp->debug().op = currentOp->getOp();
+        currentOp->debug().storageStatsAtStart = txn->recoveryUnit()->getStorageStats();
 
         if ( currWrite.getOpType() == BatchedCommandRequest::BatchType_Insert ) {
             currentOp->setQuery_inlock( currWrite.getDocument() );
@@ -588,6 +610,8 @@ namespace mongo {
         CurOp* currentOp = CurOp::get(txn);
         currentOp->done();
         int executionTime = currentOp->debug().executionTime = currentOp->totalTimeMillis();
+        currentOp->debug().storageStats = txn->recoveryUnit()->getStorageStats().since(
+                currentOp->debug().storageStatsAtStart);
         recordCurOpMetrics(txn);
         Top::get(txn->getClient()->getServiceContext()).record(
                 currentOp->getNS(),
@@ -619,6 +643,10 @@ namespace mongo {
         if (currentOp->shouldDBProfile(executionTime)) {
             profile(txn, CurOp::get(txn)->getOp());
         }
+
+        if (shouldSampleProfile(executionTime)) {
+            profileSample(txn);
+        }
     }
 
     // END HELPERS
@@ -802,6 +830,14 @@ namespace mongo {
         }
     }
 
+    // Returns the insert-ready form of the insert at "index", which must have normalized fine
+    static const BSONObj& getNormalizedInsert( const WriteBatchExecutor::ExecInsertsState& state,
+                                               size_t index );
+
+    // Returns the end of the group of inserts starting at the current one which can be inserted
+    // in a single write unit of work: consecutive, well-formed documents, bounded in count and size
+    static size_t getInsertGroupEnd( const WriteBatchExecutor::ExecInsertsState& state );
+
     void WriteBatchExecutor::execInserts( const BatchedCommandRequest& request,
                                           std::vector<WriteErrorDetail*>* errors ) {
 
@@ -824,6 +860,12 @@ namespace mongo {
         // particularly on operation interruption.  These kinds of errors necessarily prevent
         // further insertOne calls, and stop the batch.  As a result, the only expected source of
         // such exceptions are interruptions.
+        //
+        // Runs of well-formed documents are first tried as a group, inserted by
+        // execInsertGroup() in a single write unit of work, which saves committing a storage
+        // transaction per document.  If anything in the group fails, none of it is kept and its
+        // documents go through insertOne() one at a time instead, so that errors are reported
+        // against the exact insert and ordered batches stop where they would have anyway.
         ExecInsertsState state(_txn, &request);
         normalizeInserts(request, &state.normalizedInserts);
 
@@ -842,6 +884,9 @@ namespace mongo {
         ElapsedTracker elapsedTracker(internalQueryExecYieldIterations,
                                       internalQueryExecYieldPeriodMS);
 
+        // Inserts before this index go one at a time, after their group failed
+        size_t oneAtATimeEnd = 0;
+
         for (state.currIndex = 0;
              state.currIndex < state.request->sizeWriteOps();
              ++state.currIndex) {
@@ -867,6 +912,23 @@ namespace mongo {
                 elapsedTracker.resetLastTime();
             }
 
+            if (!request.isInsertIndexRequest() && state.currIndex >= oneAtATimeEnd) {
+                const size_t groupEnd = getInsertGroupEnd(state);
+                if (groupEnd - state.currIndex > 1) {
+                    if (groupEnd == state.request->sizeWriteOps()) {
+                        setupSynchronousCommit(_txn);
+                    }
+
+                    if (execInsertGroup(&state, groupEnd)) {
+                        state.currIndex = groupEnd - 1;
+                        continue;
+                    }
+
+                    // Don't retry the rest of a failed group as a group again
+                    oneAtATimeEnd = groupEnd;
+                }
+            }
+
             WriteErrorDetail* error = NULL;
             execOneInsert(&state, &error);
             if (error) {
@@ -1063,9 +1125,7 @@ namespace mongo {
             return;
         }
 
-        const BSONObj& insertDoc = normalizedInsert.getValue().isEmpty() ?
-            state->request->getInsertRequest()->getDocumentsAt( state->currIndex ) :
-            normalizedInsert.getValue();
+        const BSONObj& insertDoc = getNormalizedInsert(*state, state->currIndex);
 
         int attempt = 0;
         while (true) {
@@ -1084,11 +1144,12 @@ namespace mongo {
                 state->unlock();
                 CurOp::get(state->txn)->debug().writeConflicts++;
                 state->txn->recoveryUnit()->abandonSnapshot();
-                WriteConflictException::logAndBackoff( attempt++,
-                                                       "insert",
-                                                       state->getCollection() ?
-                                                       state->getCollection()->ns().ns() :
-                                                       "index" );
+                CurOp::get(state->txn)->debug().writeConflictBackoffMicros +=
+                    WriteConflictException::logAndBackoff( attempt++,
+                                                           "insert",
+                                                           state->getCollection() ?
+                                                           state->getCollection()->ns().ns() :
+                                                           "index" );
             }
             catch (const StaleConfigException& staleExcep) {
                 result->setError(new WriteErrorDetail);
@@ -1114,6 +1175,93 @@ namespace mongo {
         }
     }
 
+    static const BSONObj& getNormalizedInsert( const WriteBatchExecutor::ExecInsertsState& state,
+                                               size_t index ) {
+        const StatusWith<BSONObj>& normalizedInsert(state.normalizedInserts[index]);
+        return normalizedInsert.getValue().isEmpty() ?
+            state.request->getInsertRequest()->getDocumentsAt( index ) :
+            normalizedInsert.getValue();
+    }
+
+    static size_t getInsertGroupEnd( const WriteBatchExecutor::ExecInsertsState& state ) {
+        const size_t maxDocs = std::max(internalInsertMaxBatchSize, 1);
+        size_t groupEnd = state.currIndex;
+        int groupBytes = 0;
+
+        while (groupEnd < state.normalizedInserts.size() &&
+               groupEnd - state.currIndex < maxDocs &&
+               state.normalizedInserts[groupEnd].isOK()) {
+            groupBytes += getNormalizedInsert(state, groupEnd).objsize();
+            if (groupBytes > kInsertGroupMaxBytes && groupEnd > state.currIndex)
+                break;
+            ++groupEnd;
+        }
+
+        return groupEnd;
+    }
+
+    bool WriteBatchExecutor::execInsertGroup(ExecInsertsState* state, size_t groupEnd) {
+        invariant(!_txn->lockState()->inAWriteUnitOfWork());
+
+        BatchItemRef firstInsertItem(state->request, state->currIndex);
+        CurOp currentOp(_txn);
+        beginCurrentOp(_txn, firstInsertItem);
+
+        // Errors acquiring the lock are reported by the one at a time path
+        WriteOpResult lockResult;
+        if (!state->lockAndCheck(&lockResult))
+            return false;
+
+        // Capped collections may delete documents of the group itself to make room for the later
+        // ones, which isn't worth second-guessing here
+        Collection* const collection = state->getCollection();
+        if (collection->isCapped())
+            return false;
+
+        std::vector<BSONObj> docs;
+        docs.reserve(groupEnd - state->currIndex);
+        for (size_t i = state->currIndex; i < groupEnd; ++i) {
+            docs.push_back(getNormalizedInsert(*state, i));
+        }
+
+        Status status = Status::OK();
+        try {
+            WriteUnitOfWork wunit(_txn);
+            status = collection->insertDocuments(_txn, docs.begin(), docs.end(), true);
+            if (status.isOK()) {
+                wunit.commit();
+            }
+        }
+        catch (const DBException& ex) {
+            // Write conflicts included, which the one at a time path retries
+            status = ex.toStatus();
+            if (ErrorCodes::isInterruption(status.code()))
+                throw;
+        }
+
+        if (!status.isOK()) {
+            LOG(2) << "inserting into " << state->request->getNS() << " one at a time"
+                   << causedBy(status);
+            _txn->recoveryUnit()->abandonSnapshot();
+            state->unlock();
+            groupedInsertFallbacksStats.increment();
+            return false;
+        }
+
+        for (size_t i = 0; i < docs.size(); ++i) {
+            incOpStats(firstInsertItem);
+        }
+
+        WriteOpStats stats;
+        stats.n = docs.size();
+        incWriteStats(firstInsertItem, stats, NULL, &currentOp);
+        finishCurrentOp(_txn, NULL);
+
+        groupedInsertDocsStats.increment(docs.size());
+        groupedInsertGroupsStats.increment();
+        return true;
+    }
+
     void WriteBatchExecutor::execOneInsert(ExecInsertsState* state, WriteErrorDetail** error) {
         BatchItemRef currInsertItem(state->request, state->currIndex);
         CurOp currentOp(_txn);
@@ -1346,7 +1494,8 @@ namespace mongo {
                 fakeLoop = -1;
                 txn->recoveryUnit()->abandonSnapshot();
 
-                WriteConflictException::logAndBackoff( attempt++, "update", nsString.ns() );
+                debug->writeConflictBackoffMicros +=
+                    WriteConflictException::logAndBackoff( attempt++, "update", nsString.ns() );
             }
             catch (const StaleConfigException& staleExcep) {
                 result->setError(new WriteErrorDetail);
@@ -1432,7 +1581,8 @@ namespace mongo {
             }
             catch ( const WriteConflictException& dle ) {
                 CurOp::get(txn)->debug().writeConflicts++;
-                WriteConflictException::logAndBackoff( attempt++, "delete", nss.ns() );
+                CurOp::get(txn)->debug().writeConflictBackoffMicros +=
+                    WriteConflictException::logAndBackoff( attempt++, "delete", nss.ns() );
             }
             catch (const StaleConfigException& staleExcep) {
                 result->setError(new WriteErrorDetail);
@@ -100,6 +100,14 @@ namespace mongo {
          */
         void execOneInsert( ExecInsertsState* state, WriteErrorDetail** error );
 
+        /**
+         * Executes the inserts from the current one up to, but not including, "groupEnd" as one
+         * insertDocuments call within a single write unit of work.  Returns false without having
+         * inserted anything if any of them fails, in which case the caller is expected to insert
+         * them one at a time with execOneInsert(), which reports the error of the exact insert.
+         */
+        bool execInsertGroup( ExecInsertsState* state, size_t groupEnd );
+
         /**
          * Executes an update item (which may update many documents or upsert), and returns the
          * upserted _id on upsert or error on failure.
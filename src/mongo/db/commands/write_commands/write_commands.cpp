@@ -28,9 +28,14 @@
 
 #include "mongo/db/commands/write_commands/write_commands.h"
 
+#include <algorithm>
+#include <memory>
+
 #include "mongo/base/init.h"
+#include "mongo/bson/bson_validate.h"
 #include "mongo/bson/mutable/document.h"
 #include "mongo/bson/mutable/element.h"
+#include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/write_commands/batch_executor.h"
@@ -46,9 +51,11 @@
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/write_concern.h"
+#include "mongo/rpc/document_range.h"
 #include "mongo/s/d_state.h"
 
 namespace mongo {
@@ -66,6 +73,92 @@ namespace mongo {
             return Status::OK();
         }
 
+        /**
+         * Adds the write operations carried as OP_COMMAND input documents to 'request', whose
+         * command object must not contain any itself. Documents to insert are not copied, so
+         * 'request' must not outlive the message which holds them.
+         */
+        Status addWriteOpsFromInputDocs(const rpc::DocumentRange& inputDocs,
+                                        BatchedCommandRequest* request) {
+            if (request->sizeWriteOps() != 0) {
+                return Status(ErrorCodes::FailedToParse,
+                              "write operations cannot be given both in the command object and "
+                              "as input documents");
+            }
+
+            for (auto&& doc : inputDocs) {
+                if (serverGlobalParams.objcheck) {
+                    Status status = validateBSON(doc.objdata(), doc.objsize());
+                    if (!status.isOK()) {
+                        return Status(ErrorCodes::FailedToParse,
+                                      str::stream() << "invalid input document: "
+                                                    << status.reason());
+                    }
+                }
+
+                string errMsg;
+                switch (request->getBatchType()) {
+                case BatchedCommandRequest::BatchType_Insert:
+                    request->getInsertRequest()->addToDocuments(doc);
+                    break;
+                case BatchedCommandRequest::BatchType_Update: {
+                    std::unique_ptr<BatchedUpdateDocument> update(new BatchedUpdateDocument);
+                    if (!update->parseBSON(doc, &errMsg) || !update->isValid(&errMsg)) {
+                        return Status(ErrorCodes::FailedToParse, errMsg);
+                    }
+                    request->getUpdateRequest()->addToUpdates(update.release());
+                    break;
+                }
+                case BatchedCommandRequest::BatchType_Delete: {
+                    std::unique_ptr<BatchedDeleteDocument> del(new BatchedDeleteDocument);
+                    if (!del->parseBSON(doc, &errMsg) || !del->isValid(&errMsg)) {
+                        return Status(ErrorCodes::FailedToParse, errMsg);
+                    }
+                    request->getDeleteRequest()->addToDeletes(del.release());
+                    break;
+                }
+                default:
+                    invariant(false);
+                }
+            }
+
+            return Status::OK();
+        }
+
+        /**
+         * checkAuthForCommand() only sees the command object, so for write operations given as
+         * input documents it cannot tell whether an update upserts, or which namespace an index
+         * is being built on. Checks those here, once the request has been fully parsed.
+         */
+        Status checkAuthForInputDocs(OperationContext* txn,
+                                     const BatchedCommandRequest& request) {
+            const NamespaceString& nss = request.getNSS();
+
+            if (request.getBatchType() == BatchedCommandRequest::BatchType_Insert &&
+                    nss.isSystemDotIndexes()) {
+                return Status(ErrorCodes::InvalidOptions,
+                              "index specifications cannot be given as input documents");
+            }
+
+            if (request.getBatchType() == BatchedCommandRequest::BatchType_Update) {
+                const std::vector<BatchedUpdateDocument*>& updates =
+                    request.getUpdateRequest()->getUpdates();
+                const bool containsUpserts = std::any_of(updates.begin(), updates.end(),
+                    [](const BatchedUpdateDocument* update) {
+                        return update->isUpsertSet() && update->getUpsert();
+                    });
+
+                // Upsert also requires insert privs
+                if (containsUpserts &&
+                        !AuthorizationSession::get(txn->getClient())
+                            ->isAuthorizedForActionsOnNamespace(nss, ActionType::insert)) {
+                    return Status(ErrorCodes::Unauthorized, "unauthorized");
+                }
+            }
+
+            return Status::OK();
+        }
+
     } // namespace
 
     WriteCmd::WriteCmd( StringData name, BatchedCommandRequest::BatchType writeType ) :
@@ -113,18 +206,50 @@ namespace mongo {
     // Write commands are counted towards their corresponding opcounters, not command opcounters.
     bool WriteCmd::shouldAffectCommandCounter() const { return false; }
 
+    Command::ReadWriteType WriteCmd::getReadWriteType() const { return ReadWriteType::kWrite; }
+
     bool WriteCmd::run(OperationContext* txn,
                        const string& dbName,
                        BSONObj& cmdObj,
                        int options,
                        string& errMsg,
                        BSONObjBuilder& result) {
+        return _runBatch(txn, dbName, cmdObj, NULL, result);
+    }
+
+    bool WriteCmd::runWithInputDocs(OperationContext* txn,
+                                    const string& dbName,
+                                    BSONObj& cmdObj,
+                                    const rpc::DocumentRange& inputDocs,
+                                    int options,
+                                    string& errMsg,
+                                    BSONObjBuilder& result) {
+        return _runBatch(txn, dbName, cmdObj, &inputDocs, result);
+    }
+
+    bool WriteCmd::_runBatch(OperationContext* txn,
+                             const string& dbName,
+                             const BSONObj& cmdObj,
+                             const rpc::DocumentRange* inputDocs,
+                             BSONObjBuilder& result) {
         // Can't be run on secondaries.
         dassert(txn->writesAreReplicated());
         BatchedCommandRequest request( _writeType );
         BatchedCommandResponse response;
 
-        if ( !request.parseBSON( cmdObj, &errMsg ) || !request.isValid( &errMsg ) ) {
+        string errMsg;
+        if ( !request.parseBSON( cmdObj, &errMsg ) ) {
+            return appendCommandStatus( result, Status( ErrorCodes::FailedToParse, errMsg ) );
+        }
+
+        if ( inputDocs ) {
+            Status status = addWriteOpsFromInputDocs( *inputDocs, &request );
+            if ( !status.isOK() ) {
+                return appendCommandStatus( result, status );
+            }
+        }
+
+        if ( !request.isValid( &errMsg ) ) {
             return appendCommandStatus( result, Status( ErrorCodes::FailedToParse, errMsg ) );
         }
 
@@ -136,6 +261,13 @@ namespace mongo {
         NamespaceString nss(dbName, request.getNS());
         request.setNSS(nss);
 
+        if ( inputDocs ) {
+            Status status = checkAuthForInputDocs( txn, request );
+            if ( !status.isOK() ) {
+                return appendCommandStatus( result, status );
+            }
+        }
+
         StatusWith<WriteConcernOptions> wcStatus = extractWriteConcern(cmdObj);
 
         if (!wcStatus.isOK()) {
@@ -71,6 +71,8 @@ namespace mongo {
 
         virtual bool shouldAffectCommandCounter() const;
 
+        virtual ReadWriteType getReadWriteType() const;
+
         // Write command entry point.
         virtual bool run(
                  OperationContext* txn,
@@ -80,6 +82,26 @@ namespace mongo {
                  std::string& errmsg,
                  BSONObjBuilder& result);
 
+        // Write command entry point for OP_COMMAND requests which carry the documents to insert,
+        // or the update or delete statements, as input documents rather than in 'cmdObj'.
+        virtual bool runWithInputDocs(OperationContext* txn,
+                                      const std::string& dbname,
+                                      BSONObj& cmdObj,
+                                      const rpc::DocumentRange& inputDocs,
+                                      int options,
+                                      std::string& errmsg,
+                                      BSONObjBuilder& result);
+
+        /**
+         * Runs the batch described by 'cmdObj', with its write operations taken from 'inputDocs'
+         * if it is not NULL.
+         */
+        bool _runBatch(OperationContext* txn,
+                       const std::string& dbname,
+                       const BSONObj& cmdObj,
+                       const rpc::DocumentRange* inputDocs,
+                       BSONObjBuilder& result);
+
         // Write commands can be explained.
         virtual Status explain(OperationContext* txn,
                                const std::string& dbname,
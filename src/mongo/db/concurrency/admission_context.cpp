@@ -0,0 +1,96 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/concurrency/admission_context.h"
+
+#include "mongo/base/status.h"
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/client.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    const OperationContext::Decoration<AdmissionContext> AdmissionContext::get =
+        OperationContext::declareDecoration<AdmissionContext>();
+
+    const char AdmissionContext::kMetadataFieldName[] = "$admissionPriority";
+
+    AdmissionPriority AdmissionContext::getPriority(OperationContext* txn) {
+        Client* client = txn->getClient();
+        if (!client || !client->isFromUserConnection()) {
+            return AdmissionPriority::kSystem;
+        }
+
+        const auto& requested = get(txn).getRequestedPriority();
+        return requested ? *requested : AdmissionPriority::kInteractive;
+    }
+
+    Status AdmissionContext::readFromMetadata(OperationContext* txn,
+                                              const BSONObj& metadataObj) {
+        std::string name;
+        Status status = bsonExtractStringField(metadataObj, kMetadataFieldName, &name);
+        if (status == ErrorCodes::NoSuchKey) {
+            return Status::OK();
+        }
+        if (!status.isOK()) {
+            return status;
+        }
+
+        AdmissionPriority priority;
+        if (!parseAdmissionPriority(name, &priority) || priority == AdmissionPriority::kSystem) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << kMetadataFieldName << " must be \"interactive\" or "
+                                        << "\"batch\"; given \"" << name << "\"");
+        }
+
+        get(txn).setRequestedPriority(priority);
+        return Status::OK();
+    }
+
+    void AdmissionContext::writeToMetadata(OperationContext* txn, BSONObjBuilder* metadataBob) {
+        const auto& requested = get(txn).getRequestedPriority();
+        if (requested) {
+            metadataBob->append(kMetadataFieldName, admissionPriorityName(*requested));
+        }
+    }
+
+    void AdmissionContext::reportState(BSONObjBuilder* builder) const {
+        if (_requestedPriority) {
+            builder->append("admissionPriority", admissionPriorityName(*_requestedPriority));
+        }
+
+        const long long ticketWaitMicros = getTicketWaitMicros();
+        if (ticketWaitMicros > 0) {
+            builder->append("ticketWaitMicros", ticketWaitMicros);
+        }
+    }
+
+}  // namespace mongo
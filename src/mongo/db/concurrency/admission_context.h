@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/priority_ticketholder.h"
+
+namespace mongo {
+
+    class BSONObj;
+    class BSONObjBuilder;
+    class Status;
+
+    /**
+     * Per-operation state for storage engine admission control: the admission priority a client
+     * requested for the operation, and how long the operation has waited for tickets so far.
+     */
+    class AdmissionContext {
+        MONGO_DISALLOW_COPYING(AdmissionContext);
+    public:
+        static const OperationContext::Decoration<AdmissionContext> get;
+
+        // The request metadata field clients set to one of "interactive" or "batch" to tag an
+        // operation with a priority. Legacy clients can send it alongside a $query wrapped
+        // command, like $readPreference.
+        static const char kMetadataFieldName[];
+
+        AdmissionContext() = default;
+
+        /**
+         * Returns the lane "txn" queues in for tickets. Operations from internal threads, such as
+         * replication, run at system priority. Client operations run at the priority they asked
+         * for, or interactive if they did not ask for one.
+         */
+        static AdmissionPriority getPriority(OperationContext* txn);
+
+        /**
+         * Reads the priority requested in "metadataObj" into the AdmissionContext of "txn".
+         * Clients cannot request system priority.
+         */
+        static Status readFromMetadata(OperationContext* txn, const BSONObj& metadataObj);
+
+        /**
+         * Forwards the priority requested for "txn", if any, to "metadataBob".
+         */
+        static void writeToMetadata(OperationContext* txn, BSONObjBuilder* metadataBob);
+
+        const boost::optional<AdmissionPriority>& getRequestedPriority() const {
+            return _requestedPriority;
+        }
+
+        void setRequestedPriority(AdmissionPriority priority) {
+            _requestedPriority = priority;
+        }
+
+        /**
+         * Adds "micros" to the time the operation spent waiting for tickets.
+         */
+        void recordTicketWait(long long micros) { _ticketWaitMicros.fetchAndAdd(micros); }
+
+        /**
+         * May be called from threads other than the one running the operation.
+         */
+        long long getTicketWaitMicros() const { return _ticketWaitMicros.load(); }
+
+        /**
+         * Appends the requested priority and the ticket wait time, for currentOp.
+         */
+        void reportState(BSONObjBuilder* builder) const;
+
+    private:
+        boost::optional<AdmissionPriority> _requestedPriority;
+        AtomicInt64 _ticketWaitMicros;
+    };
+
+}  // namespace mongo
@@ -75,7 +75,7 @@ namespace {
 
 
     void Lock::GlobalLock::_lock(LockMode lockMode, unsigned timeoutMs) {
-        if (!_locker->isBatchWriter()) {
+        if (!_locker->isBatchWriter() && !_locker->readsFromBatchBoundarySnapshot()) {
             _pbwm.lock(MODE_IS);
         }
 
@@ -84,7 +84,7 @@ namespace {
             _result = _locker->lockGlobalComplete(timeoutMs);
         }
 
-        if (_result != LOCK_OK && !_locker->isBatchWriter()) {
+        if (_result != LOCK_OK) {
             _pbwm.unlock();
         }
     }
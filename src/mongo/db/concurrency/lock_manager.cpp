@@ -32,6 +32,10 @@
 
 #include <vector>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 #include "mongo/db/concurrency/lock_manager.h"
 
 #include "mongo/config.h"
@@ -430,8 +434,9 @@ namespace {
     const unsigned LockManager::_numLockBuckets(128);
 
     // Balance scalability of intent locks against potential added cost of conflicting locks.
-    // The exact value doesn't appear very important, but should be power of two
-    const unsigned LockManager::_numPartitions = 32;
+    // There should be at least as many partitions as CPUs, so that each CPU has its own, and the
+    // value should be power of two
+    const unsigned LockManager::_numPartitions = 64;
 
     LockManager::LockManager() {
         _lockBuckets = new LockBucket[_numLockBuckets];
@@ -458,6 +463,7 @@ namespace {
 
         // For intent modes, try the PartitionedLockHead
         if (request->partitioned) {
+            request->partitionId = _choosePartition(request);
             Partition* partition = _getPartition(request);
             SimpleMutex::scoped_lock scopedLock(partition->mutex);
 
@@ -812,8 +818,18 @@ namespace {
         return &_lockBuckets[resId % _numLockBuckets];
     }
 
+    unsigned LockManager::_choosePartition(LockRequest* request) const {
+#if defined(__linux__)
+        const int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return static_cast<unsigned>(cpu) % _numPartitions;
+        }
+#endif
+        return request->locker->getId() % _numPartitions;
+    }
+
     LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
-        return &_partitions[request->locker->getId() % _numPartitions];
+        return &_partitions[request->partitionId];
     }
 
     void LockManager::dump() const {
@@ -1125,6 +1141,7 @@ namespace {
         next = NULL;
         status = STATUS_NEW;
         partitioned = false;
+        partitionId = 0;
         mode = MODE_NONE;
         convertMode = MODE_NONE;
     }
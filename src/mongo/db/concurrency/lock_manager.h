@@ -138,10 +138,11 @@ namespace mongo {
             LockHead* findOrInsert(ResourceId resId);
         };
 
-        // Each locker maps to a partition that is used for resources acquired in intent modes
+        // Each CPU maps to a partition that is used for resources acquired in intent modes
         // modes and potentially other modes that don't conflict with themselves. This avoids
-        // contention on the regular LockHead in the lock manager.
-        struct Partition {
+        // contention on the regular LockHead in the lock manager. Partitions are cache line
+        // aligned, so that the partitions of different CPUs don't share cache lines.
+        struct MONGO_COMPILER_ALIGN_TYPE(64) Partition {
             Partition() : mutex("LockManager") { }
             PartitionedLockHead* find(ResourceId resId);
             PartitionedLockHead* findOrInsert(ResourceId resId);
@@ -158,7 +159,15 @@ namespace mongo {
 
 
         /**
-         * Retrieves the Partition that a particular LockRequest should use for intent locking.
+         * Picks the partition that a LockRequest should use for intent locking: the one of the
+         * CPU which the calling thread runs on, where that is known. Its mutex is then only
+         * contended by threads which were moved between CPUs, and its lock heads mostly stay in
+         * that CPU's cache. Falls back to the partition of the request's locker.
+         */
+        unsigned _choosePartition(LockRequest* request) const;
+
+        /**
+         * Retrieves the Partition that _choosePartition() picked for a LockRequest.
          */
         Partition* _getPartition(LockRequest* request) const;
 
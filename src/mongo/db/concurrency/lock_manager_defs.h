@@ -351,6 +351,11 @@ namespace mongo {
         // each other, at the cost of extra overhead for conflicting modes.
         bool partitioned;
 
+        // The partition of the lock manager which a partitioned request uses, picked when it is
+        // first locked. Unlocking has to go through the same partition even if the thread has
+        // moved to another CPU since.
+        unsigned partitionId;
+
         // How many times has LockManager::lock been called for this request. Locks are released
         // when their recursive count drops to zero.
         unsigned recursiveCount;
@@ -315,6 +315,41 @@ namespace mongo {
         ASSERT(request2.numNotifies == 1);
     }
 
+    TEST(LockManager, ConflictWithPartitionedIntentLocks) {
+        LockManager lockMgr;
+        const ResourceId resId(RESOURCE_GLOBAL, ResourceId::SINGLETON_GLOBAL);
+
+        // More intent holders than partitions, so that some partitions get several of them.
+        const int numIntentLockers = 80;
+        std::vector<std::unique_ptr<MMAPV1LockerImpl>> lockers;
+        std::vector<std::unique_ptr<LockRequestCombo>> requests;
+        for (int i = 0; i < numIntentLockers; i++) {
+            lockers.emplace_back(new MMAPV1LockerImpl());
+            requests.emplace_back(new LockRequestCombo(lockers.back().get()));
+            ASSERT(LOCK_OK == lockMgr.lock(resId, requests.back().get(),
+                                           i % 2 ? MODE_IS : MODE_IX));
+        }
+
+        // The exclusive request waits for all of the intent holders to go away.
+        MMAPV1LockerImpl exclusiveLocker;
+        LockRequestCombo exclusiveRequest(&exclusiveLocker);
+        ASSERT(LOCK_WAITING == lockMgr.lock(resId, &exclusiveRequest, MODE_X));
+
+        for (int i = 0; i < numIntentLockers; i++) {
+            ASSERT(exclusiveRequest.numNotifies == 0);
+            lockMgr.unlock(requests[i].get());
+        }
+        ASSERT(exclusiveRequest.numNotifies == 1);
+        ASSERT(exclusiveRequest.lastResult == LOCK_OK);
+
+        // New intent requests wait for the exclusive one.
+        LockRequestCombo intentRequest(lockers[0].get());
+        ASSERT(LOCK_WAITING == lockMgr.lock(resId, &intentRequest, MODE_IS));
+        lockMgr.unlock(&exclusiveRequest);
+        ASSERT(intentRequest.numNotifies == 1);
+        lockMgr.unlock(&intentRequest);
+    }
+
     TEST(LockManager, MultipleConflict) {
         LockManager lockMgr;
         const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
@@ -126,6 +126,9 @@ namespace {
     // Partitioned global lock statistics, so we don't hit the same bucket
     PartitionedInstanceWideLockStats globalStats;
 
+    // Per database and collection wait times, for finding the most contended resources
+    ResourceWaitStats globalResourceWaitStats;
+
 
     /**
      * Whether the particular lock's release should be held until the end of the operation. We
@@ -256,7 +259,8 @@ namespace {
         : _id(idCounter.addAndFetch(1)),
           _requestStartTime(0),
           _wuowNestingLevel(0),
-          _batchWriter(false) {
+          _batchWriter(false),
+          _batchBoundarySnapshotReader(false) {
     }
 
     template<bool IsForMMAPV1>
@@ -721,6 +725,8 @@ namespace {
             }
         }
 
+        globalResourceWaitStats.recordWait(resId, curTimeMicros64() - _requestStartTime);
+
         // Cleanup the state, since this is an unused lock now
         if (result != LOCK_OK) {
             LockRequestsMap::Iterator it = _requests.find(resId);
@@ -902,8 +908,13 @@ namespace {
         globalStats.report(outStats);
     }
 
+    std::vector<ResourceWaitStats::Entry> reportTopResourceWaits(size_t k) {
+        return globalResourceWaitStats.getTopByWaitTime(k);
+    }
+
     void resetGlobalLockStats() {
         globalStats.reset();
+        globalResourceWaitStats.reset();
     }
 
     
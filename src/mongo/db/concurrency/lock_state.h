@@ -241,10 +241,16 @@ namespace mongo {
         virtual void setIsBatchWriter(bool newValue) { _batchWriter = newValue; }
         virtual bool isBatchWriter() const { return _batchWriter; }
 
+        virtual void setReadsFromBatchBoundarySnapshot(bool newValue) {
+            _batchBoundarySnapshotReader = newValue;
+        }
+        virtual bool readsFromBatchBoundarySnapshot() const { return _batchBoundarySnapshotReader; }
+
         virtual bool hasStrongLocks() const;
 
     private:
         bool _batchWriter;
+        bool _batchBoundarySnapshotReader;
     };
 
     typedef LockerImpl<false> DefaultLockerImpl;
@@ -30,6 +30,8 @@
 
 #include "mongo/db/concurrency/lock_stats.h"
 
+#include <algorithm>
+
 #include "mongo/bson/bsonobjbuilder.h"
 
 namespace mongo {
@@ -151,6 +153,70 @@ namespace mongo {
     }
 
 
+    void ResourceWaitStats::recordWait(ResourceId resId, uint64_t waitMicros) {
+        if (resId.getType() != RESOURCE_DATABASE && resId.getType() != RESOURCE_COLLECTION) {
+            return;
+        }
+
+        boost::mutex::scoped_lock lk(_mutex);
+
+        unordered_map<ResourceId, Entry>::iterator it = _entries.find(resId);
+        if (it == _entries.end()) {
+            if (_entries.size() >= kMaxResources) {
+                unordered_map<ResourceId, Entry>::iterator leastContended = _entries.begin();
+                for (it = _entries.begin(); it != _entries.end(); ++it) {
+                    if (it->second.combinedWaitTimeMicros <
+                            leastContended->second.combinedWaitTimeMicros) {
+                        leastContended = it;
+                    }
+                }
+                _entries.erase(leastContended);
+            }
+
+            it = _entries.insert(std::make_pair(resId, Entry())).first;
+            it->second.resId = resId;
+        }
+
+        it->second.numWaits++;
+        it->second.combinedWaitTimeMicros += waitMicros;
+    }
+
+    namespace {
+        bool hasMoreWaitTime(const ResourceWaitStats::Entry& lhs,
+                             const ResourceWaitStats::Entry& rhs) {
+            return lhs.combinedWaitTimeMicros > rhs.combinedWaitTimeMicros;
+        }
+    } // namespace
+
+    std::vector<ResourceWaitStats::Entry> ResourceWaitStats::getTopByWaitTime(size_t k) const {
+        std::vector<Entry> entries;
+        {
+            boost::mutex::scoped_lock lk(_mutex);
+            entries.reserve(_entries.size());
+            for (unordered_map<ResourceId, Entry>::const_iterator it = _entries.begin();
+                    it != _entries.end(); ++it) {
+                entries.push_back(it->second);
+            }
+        }
+
+        if (entries.size() > k) {
+            std::partial_sort(entries.begin(), entries.begin() + k, entries.end(),
+                              hasMoreWaitTime);
+            entries.resize(k);
+        }
+        else {
+            std::sort(entries.begin(), entries.end(), hasMoreWaitTime);
+        }
+
+        return entries;
+    }
+
+    void ResourceWaitStats::reset() {
+        boost::mutex::scoped_lock lk(_mutex);
+        _entries.clear();
+    }
+
+
     // Ensures that there are instances compiled for LockStats for AtomicInt64 and int64_t
     template class LockStats<int64_t>;
     template class LockStats<AtomicInt64>;
@@ -28,8 +28,13 @@
 
 #pragma once
 
+#include <boost/thread/mutex.hpp>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 
@@ -191,11 +196,63 @@ namespace mongo {
     typedef LockStats<AtomicInt64> AtomicLockStats;
 
 
+    /**
+     * Wait statistics of individual database and collection resources, so the most contended
+     * ones can be found. LockStats only aggregates per resource type, because the resource ids are
+     * not known in advance.
+     *
+     * Only requests which had to wait get recorded, once each, after the wait is over. These
+     * already went to sleep on the lock, so the mutex here is not on any fast path.
+     *
+     * At most kMaxResources resources are tracked. A wait on an untracked resource when the table
+     * is full evicts the tracked resource with the least combined wait time, so the resources which
+     * are contended the most stay in the table.
+     */
+    class ResourceWaitStats {
+        MONGO_DISALLOW_COPYING(ResourceWaitStats);
+    public:
+        static const size_t kMaxResources = 1000;
+
+        struct Entry {
+            Entry() : numWaits(0), combinedWaitTimeMicros(0) { }
+
+            ResourceId resId;
+            int64_t numWaits;
+            int64_t combinedWaitTimeMicros;
+        };
+
+        ResourceWaitStats() = default;
+
+        /**
+         * Accounts for a wait of 'waitMicros' on 'resId'. Waits on resources other than databases
+         * and collections are ignored.
+         */
+        void recordWait(ResourceId resId, uint64_t waitMicros);
+
+        /**
+         * Returns up to 'k' resources with the most combined wait time, in descending order.
+         */
+        std::vector<Entry> getTopByWaitTime(size_t k) const;
+
+        void reset();
+
+    private:
+        mutable boost::mutex _mutex;
+        unordered_map<ResourceId, Entry> _entries;
+    };
+
+
     /**
      * Reports instance-wide locking statistics, which can then be converted to BSON or logged.
      */
     void reportGlobalLockingStats(SingleThreadedLockStats* outStats);
 
+    /**
+     * Returns up to 'k' database and collection resources, which lock requests have waited for
+     * the longest in total since startup.
+     */
+    std::vector<ResourceWaitStats::Entry> reportTopResourceWaits(size_t k);
+
     /**
      * Currently used for testing only.
      */
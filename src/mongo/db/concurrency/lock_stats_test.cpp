@@ -31,6 +31,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -82,6 +83,60 @@ namespace mongo {
         ASSERT_GREATER_THAN(stats.get(resId, MODE_S).combinedWaitTimeMicros, 0);
     }
 
+    TEST(LockStats, TopResourceWaits) {
+        const ResourceId resId(RESOURCE_COLLECTION, std::string("LockStats.TopResourceWaits"));
+
+        resetGlobalLockStats();
+
+        LockerForTests locker(MODE_IX);
+        locker.lock(resId, MODE_X);
+
+        {
+            LockerForTests lockerConflict(MODE_IX);
+            ASSERT_EQUALS(LOCK_WAITING, lockerConflict.lockBegin(resId, MODE_S));
+            ASSERT_EQUALS(LOCK_TIMEOUT, lockerConflict.lockComplete(resId, MODE_S, 1, false));
+        }
+
+        // The global and database intent locks were granted right away
+        std::vector<ResourceWaitStats::Entry> top = reportTopResourceWaits(10);
+        ASSERT_EQUALS(1U, top.size());
+        ASSERT_EQUALS(resId, top[0].resId);
+        ASSERT_EQUALS(1, top[0].numWaits);
+        ASSERT_GREATER_THAN(top[0].combinedWaitTimeMicros, 0);
+    }
+
+    TEST(ResourceWaitStats, KeepsMostContendedResources) {
+        ResourceWaitStats stats;
+
+        stats.recordWait(ResourceId(RESOURCE_GLOBAL, 1), 1000);
+        ASSERT_EQUALS(0U, stats.getTopByWaitTime(10).size());
+
+        const ResourceId mostContended(RESOURCE_DATABASE, std::string("mostContended"));
+        stats.recordWait(mostContended, 100000);
+        stats.recordWait(mostContended, 100000);
+
+        for (size_t i = 0; i < ResourceWaitStats::kMaxResources + 10; i++) {
+            stats.recordWait(ResourceId(RESOURCE_COLLECTION, str::stream() << "test.c" << i),
+                             i + 1);
+        }
+
+        std::vector<ResourceWaitStats::Entry> top = stats.getTopByWaitTime(3);
+        ASSERT_EQUALS(3U, top.size());
+        ASSERT_EQUALS(mostContended, top[0].resId);
+        ASSERT_EQUALS(2, top[0].numWaits);
+        ASSERT_EQUALS(200000, top[0].combinedWaitTimeMicros);
+        ASSERT_EQUALS(ResourceId(RESOURCE_COLLECTION, std::string("test.c1009")), top[1].resId);
+        ASSERT_EQUALS(ResourceId(RESOURCE_COLLECTION, std::string("test.c1008")), top[2].resId);
+
+        // The table stays bounded by evicting the least contended resources
+        top = stats.getTopByWaitTime(ResourceWaitStats::kMaxResources * 2);
+        ASSERT_EQUALS(ResourceWaitStats::kMaxResources, top.size());
+        ASSERT_EQUALS(12, top.back().combinedWaitTimeMicros);
+
+        stats.reset();
+        ASSERT_EQUALS(0U, stats.getTopByWaitTime(10).size());
+    }
+
     TEST(LockStats, Reporting) {
         const ResourceId resId(RESOURCE_COLLECTION, std::string("LockStats.Reporting"));
 
@@ -283,6 +283,15 @@ namespace mongo {
         virtual void setIsBatchWriter(bool newValue) = 0;
         virtual bool isBatchWriter() const = 0;
 
+        /**
+         * Set on secondaries while a read uses a storage engine snapshot which was taken between
+         * two batches of replicated operations. Such reads don't need the parallel batch writer
+         * lock to be protected from half-applied batches, so global locks taken while this is set
+         * do not acquire it. See AutoGetCollectionForRead.
+         */
+        virtual void setReadsFromBatchBoundarySnapshot(bool newValue) = 0;
+        virtual bool readsFromBatchBoundarySnapshot() const = 0;
+
         /**
          * A string lock is MODE_X or MODE_S.
          * These are incompatible with other locks and therefore are strong.
@@ -166,6 +166,14 @@ namespace mongo {
             invariant(false);
         }
 
+        virtual void setReadsFromBatchBoundarySnapshot(bool newValue) {
+            invariant(false);
+        }
+
+        virtual bool readsFromBatchBoundarySnapshot() const {
+            invariant(false);
+        }
+
         virtual bool hasStrongLocks() const {
             return false;
         }
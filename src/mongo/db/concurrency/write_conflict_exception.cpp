@@ -30,13 +30,91 @@
 
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kWrite
 
+#include "mongo/platform/basic.h"
+
 #include "mongo/db/concurrency/write_conflict_exception.h"
+
+#include <algorithm>
+#include <boost/thread/tss.hpp>
+
 #include "mongo/db/server_parameters.h"
+#include "mongo/platform/random.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stacktrace.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
+    namespace {
+        // All numbers below chosen by guess and check against a few random benchmarks.
+
+        // Conflicts before the first attempts to retry straight away, since most conflicts
+        // are with a writer which is about to commit.
+        const int kImmediateRetries = 2;
+
+        // The backoff after the first of those retries is up to kBackoffBaseMicros, doubling
+        // with every further attempt up to kMaxBackoffMicros.
+        const long long kBackoffBaseMicros = 100;
+        const long long kMaxBackoffMicros = 10 * 1000;
+
+        // From this attempt on, writers wait for their turn to retry instead.
+        const int kEscalateAfterAttempts = 10;
+
+        // Writers waiting for their turn to the same namespace retry this far apart, and wait no
+        // longer than kMaxTurnWaitMicros for it.
+        const long long kTurnMicros = 1000;
+        const long long kMaxTurnWaitMicros = 100 * 1000;
+
+        boost::thread_specific_ptr<PseudoRandom> perThreadRandom;
+
+        /**
+         * Returns a random backoff for 'attempt', between zero and the exponential cap, so that
+         * writers which conflicted at the same time spread out their retries.
+         */
+        long long randomBackoffMicros(int attempt) {
+            if (!perThreadRandom.get()) {
+                perThreadRandom.reset(new PseudoRandom(static_cast<int32_t>(
+                    curTimeMicros64() ^ reinterpret_cast<uintptr_t>(&attempt))));
+            }
+
+            const int doublings = std::min(attempt - kImmediateRetries, 16);
+            const long long cap = std::min(kMaxBackoffMicros, kBackoffBaseMicros << doublings);
+            return static_cast<long long>(
+                static_cast<uint64_t>(perThreadRandom->nextInt64()) % (cap + 1));
+        }
+
+        /**
+         * The time at which the next writer waiting for its turn to a namespace may retry.
+         * Namespaces share slots by hash.
+         */
+        struct TurnSlot {
+            stdx::mutex mutex;
+            unsigned long long nextTurnMicros = 0;
+        };
+
+        const size_t kNumTurnSlots = 64;
+        TurnSlot turnSlots[kNumTurnSlots];
+
+        /**
+         * Takes the next turn to retry a write to 'ns', and returns how long to wait for it.
+         */
+        long long waitForTurn(StringData ns) {
+            TurnSlot& slot = turnSlots[StringData::Hasher()(ns) % kNumTurnSlots];
+
+            const unsigned long long now = curTimeMicros64();
+            stdx::lock_guard<stdx::mutex> lk(slot.mutex);
+            const unsigned long long turn = std::max(now, slot.nextTurnMicros);
+            if (turn - now > static_cast<unsigned long long>(kMaxTurnWaitMicros)) {
+                // Too many writers are waiting already. Wait as long as allowed, without
+                // pushing the writers behind this one back any further.
+                return kMaxTurnWaitMicros;
+            }
+            slot.nextTurnMicros = turn + kTurnMicros;
+            return static_cast<long long>(turn - now);
+        }
+    }
+
     bool WriteConflictException::trace = false;
 
     WriteConflictException::WriteConflictException()
@@ -48,30 +126,83 @@ namespace mongo {
 
     }
 
-    void WriteConflictException::logAndBackoff(int attempt,
-                                               StringData operation,
-                                               StringData ns) {
+    long long WriteConflictException::logAndBackoff(int attempt,
+                                                    StringData operation,
+                                                    StringData ns) {
 
         LOG(1) << "Caught WriteConflictException doing " << operation
                << " on " << ns
                << ", attempt: " << attempt << " retrying";
 
-        // All numbers below chosen by guess and check against a few random benchmarks.
-        if (attempt < 4) {
-            // no-op
+        if (attempt < kImmediateRetries) {
+            globalWriteConflictStats.record(ns, false, 0);
+            return 0;
         }
-        else if (attempt < 10) {
-            sleepmillis(1);
+
+        Timer timer;
+        const bool escalated = attempt >= kEscalateAfterAttempts;
+        long long sleepMicros = randomBackoffMicros(attempt);
+        if (escalated) {
+            sleepMicros = std::max(sleepMicros, waitForTurn(ns));
         }
-        else if (attempt < 100) {
-            sleepmillis(5);
+        sleepmicros(sleepMicros);
+
+        const long long backoffMicros = timer.micros();
+        globalWriteConflictStats.record(ns, escalated, backoffMicros);
+        return backoffMicros;
+    }
+
+    void WriteConflictStats::record(StringData ns, bool escalated, long long backoffMicros) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        if (_entries.size() >= kMaxNamespaces && _entries.find(ns) == _entries.end()) {
+            StringMap<Entry>::const_iterator fewest = _entries.begin();
+            for (StringMap<Entry>::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+                if (i->second.conflicts < fewest->second.conflicts) {
+                    fewest = i;
+                }
+            }
+            _entries.erase(fewest);
         }
-        else {
-            sleepmillis(10);
+
+        Entry& entry = _entries[ns];
+        if (entry.conflicts == 0) {
+            entry.ns = ns.toString();
+        }
+        entry.conflicts++;
+        if (escalated) {
+            entry.escalations++;
+        }
+        entry.backoffMicros += backoffMicros;
+    }
+
+    std::vector<WriteConflictStats::Entry> WriteConflictStats::getTopByConflicts(
+            size_t n) const {
+        std::vector<Entry> entries;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            entries.reserve(_entries.size());
+            for (StringMap<Entry>::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+                entries.push_back(i->second);
+            }
         }
 
+        n = std::min(n, entries.size());
+        std::partial_sort(entries.begin(), entries.begin() + n, entries.end(),
+                          [](const Entry& a, const Entry& b) {
+                              return a.conflicts > b.conflicts;
+                          });
+        entries.resize(n);
+        return entries;
+    }
+
+    void WriteConflictStats::reset() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _entries = StringMap<Entry>();
     }
 
+    WriteConflictStats globalWriteConflictStats;
+
     namespace {
         // for WriteConflictException
         ExportedServerParameter<bool> TraceWCExceptionsSetting(ServerParameterSet::getGlobal(),
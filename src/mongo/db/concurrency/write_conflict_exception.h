@@ -31,17 +31,24 @@
 #pragma once
 
 #include <exception>
+#include <string>
+#include <vector>
 
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/string_map.h"
 
 #define MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN do { int wcr__Attempts = 0; do { try
 #define MONGO_WRITE_CONFLICT_RETRY_LOOP_END(PTXN, OPSTR, NSSTR)         \
         catch (const ::mongo::WriteConflictException &wce) {            \
             const OperationContext* ptxn = (PTXN);                      \
             ++CurOp::get(ptxn)->debug().writeConflicts;      \
-            wce.logAndBackoff(wcr__Attempts, (OPSTR), (NSSTR));         \
-            ++wcr__Attempts;                                            \
             ptxn->recoveryUnit()->abandonSnapshot();                   \
+            CurOp::get(ptxn)->debug().writeConflictBackoffMicros +=     \
+                wce.logAndBackoff(wcr__Attempts, (OPSTR), (NSSTR));     \
+            ++wcr__Attempts;                                            \
             continue;                                                   \
         }                                                               \
         break;                                                          \
@@ -60,13 +67,18 @@ namespace mongo {
 
         /**
          * Will log a message if sensible and will do an exponential backoff to make sure
-         * we don't hammer the same doc over and over.
+         * we don't hammer the same doc over and over. The backoff is randomized, so that the
+         * writers which conflicted don't all retry at the same moment. Once an operation keeps
+         * conflicting, it instead waits for its turn among the other writers to 'ns' which keep
+         * conflicting, so that they retry one at a time. The conflict is counted against 'ns'
+         * in globalWriteConflictStats.
          * @param attempt - what attempt is this, 1 based
          * @param operation - e.g. "update"
+         * @return the number of microseconds spent backing off
          */
-        static void logAndBackoff(int attempt,
-                                  StringData operation,
-                                  StringData ns);
+        static long long logAndBackoff(int attempt,
+                                       StringData operation,
+                                       StringData ns);
 
         /**
          * If true, will call printStackTrace on every WriteConflictException created.
@@ -75,4 +87,41 @@ namespace mongo {
         static bool trace;
     };
 
+    /**
+     * Write conflicts counted per namespace, for finding the collections with hot documents.
+     * Once kMaxNamespaces are tracked, the namespace with the fewest conflicts makes room for new
+     * ones.
+     */
+    class WriteConflictStats {
+        MONGO_DISALLOW_COPYING(WriteConflictStats);
+    public:
+        static const size_t kMaxNamespaces = 1000;
+
+        struct Entry {
+            Entry() : conflicts(0), escalations(0), backoffMicros(0) { }
+
+            std::string ns;
+            long long conflicts;
+            long long escalations;      // Conflicts after which the writer waited for its turn.
+            long long backoffMicros;
+        };
+
+        WriteConflictStats() = default;
+
+        void record(StringData ns, bool escalated, long long backoffMicros);
+
+        /**
+         * Returns up to 'n' namespaces, those with the most conflicts first.
+         */
+        std::vector<Entry> getTopByConflicts(size_t n) const;
+
+        void reset();
+
+    private:
+        mutable stdx::mutex _mutex;
+        StringMap<Entry> _entries;
+    };
+
+    extern WriteConflictStats globalWriteConflictStats;
+
 }
@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+    TEST(WriteConflictStats, OrdersByConflicts) {
+        WriteConflictStats stats;
+        stats.record("test.a", false, 0);
+        stats.record("test.b", false, 0);
+        stats.record("test.b", true, 1000);
+        stats.record("test.b", false, 10);
+        stats.record("test.c", false, 0);
+        stats.record("test.c", false, 0);
+
+        std::vector<WriteConflictStats::Entry> top = stats.getTopByConflicts(2);
+        ASSERT_EQUALS(2U, top.size());
+        ASSERT_EQUALS("test.b", top[0].ns);
+        ASSERT_EQUALS(3, top[0].conflicts);
+        ASSERT_EQUALS(1, top[0].escalations);
+        ASSERT_EQUALS(1010, top[0].backoffMicros);
+        ASSERT_EQUALS("test.c", top[1].ns);
+        ASSERT_EQUALS(2, top[1].conflicts);
+
+        ASSERT_EQUALS(3U, stats.getTopByConflicts(10).size());
+        stats.reset();
+        ASSERT_TRUE(stats.getTopByConflicts(10).empty());
+    }
+
+    TEST(WriteConflictStats, KeepsMostConflictedNamespaces) {
+        WriteConflictStats stats;
+        for (int i = 0; i < 10; i++) {
+            stats.record("test.hot", false, 0);
+        }
+        for (size_t i = 0; i < WriteConflictStats::kMaxNamespaces + 10; i++) {
+            stats.record(std::string(mongoutils::str::stream() << "test.cold" << i), false, 0);
+        }
+
+        std::vector<WriteConflictStats::Entry> top =
+            stats.getTopByConflicts(WriteConflictStats::kMaxNamespaces + 10);
+        ASSERT_EQUALS(WriteConflictStats::kMaxNamespaces, top.size());
+        ASSERT_EQUALS("test.hot", top[0].ns);
+        ASSERT_EQUALS(10, top[0].conflicts);
+    }
+
+    TEST(WriteConflictException, BackoffEscalates) {
+        const std::string ns = "test.WriteConflictException.BackoffEscalates";
+
+        // The first retries don't back off at all.
+        ASSERT_EQUALS(0, WriteConflictException::logAndBackoff(0, "update", ns));
+        ASSERT_EQUALS(0, WriteConflictException::logAndBackoff(1, "update", ns));
+
+        for (int attempt = 2; attempt < 20; attempt++) {
+            const long long micros = WriteConflictException::logAndBackoff(attempt, "update", ns);
+            ASSERT_GREATER_THAN_OR_EQUALS(micros, 0);
+        }
+
+        std::vector<WriteConflictStats::Entry> top =
+            globalWriteConflictStats.getTopByConflicts(WriteConflictStats::kMaxNamespaces);
+        bool found = false;
+        for (size_t i = 0; i < top.size(); i++) {
+            if (top[i].ns == ns) {
+                found = true;
+                ASSERT_EQUALS(20, top[i].conflicts);
+                ASSERT_EQUALS(10, top[i].escalations);
+            }
+        }
+        ASSERT_TRUE(found);
+    }
+
+}  // namespace
+}  // namespace mongo
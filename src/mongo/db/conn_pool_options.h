@@ -49,6 +49,16 @@ namespace mongo {
          * Maximum connections per host the sharded conn pool should use
          */
         static int maxShardedConnsPerHost;
+
+        /**
+         * Connections per host the connection pool should keep open ahead of demand
+         */
+        static int minConnsPerHost;
+
+        /**
+         * Connections per host the sharded conn pool should keep open ahead of demand
+         */
+        static int minShardedConnsPerHost;
     };
 
 }
@@ -38,6 +38,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/json.h"
+#include "mongo/util/coarse_clock.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 
@@ -222,7 +223,7 @@ namespace mongo {
         _dbprofile = std::max(dbProfileLevel, _dbprofile);
     }
 
-    void CurOp::reportState(BSONObjBuilder* builder) {
+    void CurOp::reportSummary(BSONObjBuilder* builder) {
 
         if (_start) {
             builder->append("secs_running", elapsedSeconds() );
@@ -236,6 +237,10 @@ namespace mongo {
         // accessed namespace, while _debug.ns is set once at the start of the operation. However,
         // sometimes _ns is not yet set.
         builder->append("ns", !_ns.empty() ? _ns : _debug.ns);
+    }
+
+    void CurOp::reportState(BSONObjBuilder* builder) {
+        reportSummary(builder);
 
         if (_op == dbInsert) {
             _query.append(*builder, "insert");
@@ -264,6 +269,13 @@ namespace mongo {
         }
 
         builder->append( "numYields" , _numYields );
+
+        // Like numYields, these are updated by the operation's own thread without locking.
+        if (debug().writeConflicts > 0) {
+            builder->appendNumber("writeConflicts", debug().writeConflicts);
+            builder->appendNumber("writeConflictBackoffMicros",
+                                  debug().writeConflictBackoffMicros);
+        }
     }
 
     void CurOp::setMaxTimeMicros(uint64_t maxTimeMicros) {
@@ -308,7 +320,7 @@ namespace mongo {
     void CurOp::MaxTimeTracker::reset() {
         _enabled = false;
         _targetEpochMicros = 0;
-        _approxTargetServerMillis = 0;
+        _approxTargetEpochMillis = 0;
     }
 
     void CurOp::MaxTimeTracker::setTimeLimit(uint64_t startEpochMicros, uint64_t durationMicros) {
@@ -318,18 +330,10 @@ namespace mongo {
 
         _targetEpochMicros = startEpochMicros + durationMicros;
 
-        uint64_t now = curTimeMicros64();
-        // If our accurate time source thinks time is not up yet, calculate the next target for
-        // our approximate time source.
-        if (_targetEpochMicros > now) {
-            _approxTargetServerMillis = Listener::getElapsedTimeMillis() +
-                                        static_cast<int64_t>((_targetEpochMicros - now) / 1000);
-        }
-        // Otherwise, set our approximate time source target such that it thinks time is already
-        // up.
-        else {
-            _approxTargetServerMillis = Listener::getElapsedTimeMillis();
-        }
+        // The coarse clock lags behind the precise one, so only once it is within that lag of the
+        // target can time be up.
+        _approxTargetEpochMillis = static_cast<long long>(_targetEpochMicros / 1000) -
+                                   CoarseClock::kMaxLagMillis;
     }
 
     bool CurOp::MaxTimeTracker::checkTimeLimit() {
@@ -338,21 +342,12 @@ namespace mongo {
         }
 
         // Does our approximate time source think time is not up yet?  If so, return early.
-        if (_approxTargetServerMillis > Listener::getElapsedTimeMillis()) {
+        if (_approxTargetEpochMillis > CoarseClock::nowMillis()) {
             return false;
         }
 
-        uint64_t now = curTimeMicros64();
-        // Does our accurate time source think time is not up yet?  If so, readjust the target for
-        // our approximate time source and return early.
-        if (_targetEpochMicros > now) {
-            _approxTargetServerMillis = Listener::getElapsedTimeMillis() +
-                                        static_cast<int64_t>((_targetEpochMicros - now) / 1000);
-            return false;
-        }
-
-        // Otherwise, time is up.
-        return true;
+        // Otherwise, it's up to our accurate time source.
+        return _targetEpochMicros <= curTimeMicros64();
     }
 
     uint64_t CurOp::MaxTimeTracker::getRemainingMicros() const {
@@ -390,6 +385,8 @@ namespace mongo {
         nscannedObjects = -1;
         idhack = false;
         scanAndOrder = false;
+        sortSpills = -1;
+        sortSpilledBytes = -1;
         nMatched = -1;
         nModified = -1;
         ninserted = -1;
@@ -401,7 +398,16 @@ namespace mongo {
         cursorExhausted = false;
         keyUpdates = 0;  // unsigned, so -1 not possible
         writeConflicts = 0;
+        writeConflictBackoffMicros = 0;
+        ticketWaitMicros = 0;
+        fileAllocationMicros = 0;
+        storageStats = RecoveryUnit::StorageStats();
+        storageStatsAtStart = RecoveryUnit::StorageStats();
         planSummary = "";
+        replanned = false;
+        queryShapeNs.clear();
+        queryShapeKey.clear();
+        queryShape = BSONObj();
         execStats.reset();
 
         exceptionInfo.reset();
@@ -461,6 +467,8 @@ namespace mongo {
         OPDEBUG_TOSTRING_HELP( nscannedObjects );
         OPDEBUG_TOSTRING_HELP_BOOL( idhack );
         OPDEBUG_TOSTRING_HELP_BOOL( scanAndOrder );
+        OPDEBUG_TOSTRING_HELP( sortSpills );
+        OPDEBUG_TOSTRING_HELP( sortSpilledBytes );
         OPDEBUG_TOSTRING_HELP( nmoved );
         OPDEBUG_TOSTRING_HELP( nMatched );
         OPDEBUG_TOSTRING_HELP( nModified );
@@ -472,6 +480,20 @@ namespace mongo {
         OPDEBUG_TOSTRING_HELP_BOOL( cursorExhausted );
         OPDEBUG_TOSTRING_HELP( keyUpdates );
         OPDEBUG_TOSTRING_HELP( writeConflicts );
+        if (writeConflictBackoffMicros > 0) {
+            s << " writeConflictBackoffMicros:" << writeConflictBackoffMicros;
+        }
+        if (ticketWaitMicros > 0) {
+            s << " ticketWaitMicros:" << ticketWaitMicros;
+        }
+        if (fileAllocationMicros > 0) {
+            s << " fileAllocationMicros:" << fileAllocationMicros;
+        }
+        if (!storageStats.isEmpty()) {
+            BSONObjBuilder storage;
+            appendStorageStats(storageStats, &storage);
+            s << " storage:" << storage.done().firstElement().Obj().toString();
+        }
 
         if ( extra.len() )
             s << " " << extra.str();
@@ -568,6 +590,8 @@ namespace mongo {
         OPDEBUG_APPEND_NUMBER( nscannedObjects );
         OPDEBUG_APPEND_BOOL( idhack );
         OPDEBUG_APPEND_BOOL( scanAndOrder );
+        OPDEBUG_APPEND_NUMBER( sortSpills );
+        OPDEBUG_APPEND_NUMBER( sortSpilledBytes );
         OPDEBUG_APPEND_BOOL( moved );
         OPDEBUG_APPEND_NUMBER( nmoved );
         OPDEBUG_APPEND_NUMBER( nMatched );
@@ -580,6 +604,16 @@ namespace mongo {
         OPDEBUG_APPEND_BOOL( cursorExhausted );
         OPDEBUG_APPEND_NUMBER( keyUpdates );
         OPDEBUG_APPEND_NUMBER( writeConflicts );
+        if (writeConflictBackoffMicros > 0) {
+            b.appendNumber("writeConflictBackoffMicros", writeConflictBackoffMicros);
+        }
+        if (ticketWaitMicros > 0) {
+            b.appendNumber("ticketWaitMicros", ticketWaitMicros);
+        }
+        if (fileAllocationMicros > 0) {
+            b.appendNumber("fileAllocationMicros", fileAllocationMicros);
+        }
+        appendStorageStats(storageStats, &b);
         b.appendNumber("numYield", curop.numYields());
 
         {
@@ -598,4 +632,25 @@ namespace mongo {
         execStats.append(b, "execStats");
     }
 
+    void OpDebug::appendStorageStats(const RecoveryUnit::StorageStats& stats,
+                                     BSONObjBuilder* builder) {
+        if (stats.isEmpty()) {
+            return;
+        }
+
+        BSONObjBuilder storage(builder->subobjStart("storage"));
+        if (stats.bytesRead) {
+            storage.appendNumber("bytesRead", stats.bytesRead);
+        }
+        if (stats.pagesRead) {
+            storage.appendNumber("pagesRead", stats.pagesRead);
+        }
+        if (stats.cacheWaitMicros) {
+            storage.appendNumber("cacheWaitMicros", stats.cacheWaitMicros);
+        }
+        if (stats.bytesWritten) {
+            storage.appendNumber("bytesWritten", stats.bytesWritten);
+        }
+    }
+
 }  // namespace mongo
@@ -139,6 +139,13 @@ namespace mongo {
                     const SingleThreadedLockStats& lockStats,
                     BSONObjBuilder& builder) const;
 
+        /**
+         * Appends the nonzero counts of 'stats' to "builder" as the subobject "storage", if any
+         * are nonzero.
+         */
+        static void appendStorageStats(const RecoveryUnit::StorageStats& stats,
+                                       BSONObjBuilder* builder);
+
         // -------------------
         
         StringBuilder extra; // weird things we need to fix later
@@ -161,6 +168,8 @@ namespace mongo {
         long long nscannedObjects;
         bool idhack;         // indicates short circuited code path on an update to make the update faster
         bool scanAndOrder;   // scanandorder query plan aspect was used
+        long long sortSpills; // sorted runs written to disk by a blocking sort
+        long long sortSpilledBytes;
         long long  nMatched; // number of records that match the query
         long long  nModified; // number of records written (no no-ops)
         long long  nmoved;   // updates resulted in a move (moves are expensive)
@@ -172,7 +181,20 @@ namespace mongo {
         bool cursorExhausted; // true if the cursor has been closed at end a find/getMore operation
         int keyUpdates;
         long long writeConflicts;
+        long long writeConflictBackoffMicros; // time spent backing off after write conflicts
+        long long ticketWaitMicros; // time spent queued for storage engine tickets
+        long long fileAllocationMicros; // time spent waiting for new data files to be allocated
+        // what the storage engine did for the operation, and its counts as the operation began
+        RecoveryUnit::StorageStats storageStats;
+        RecoveryUnit::StorageStats storageStatsAtStart;
         ThreadSafeString planSummary; // a brief std::string describing the query solution
+        bool replanned; // a cached plan was abandoned for one planned from scratch
+
+        // The shape of the first query the operation planned, for the query stats store: the
+        // collection, the plan cache key, and the query, sort and projection it was seen with.
+        std::string queryShapeNs;
+        std::string queryShapeKey;
+        BSONObj queryShape;
 
         // New Query Framework debugging/profiling info
         // TODO: should this really be an opaque BSONObj?  Not sure.
@@ -342,6 +364,12 @@ namespace mongo {
          */
         void reportState(BSONObjBuilder* builder);
 
+        /**
+         * Appends the fields of reportState() which are cheap to produce: the running time, "op"
+         * and "ns". Has the same locking requirements as reportState().
+         */
+        void reportSummary(BSONObjBuilder* builder);
+
         /**
          * Sets the message and the progress meter for this CurOp.
          *
@@ -451,9 +479,9 @@ namespace mongo {
             // epoch.
             uint64_t _targetEpochMicros;
 
-            // Approximate point in time at which the time limit is hit.   Units of milliseconds
-            // since the server process was started.
-            int64_t _approxTargetServerMillis;
+            // Point in time, according to CoarseClock, from which on the time limit may have been
+            // hit. Units of milliseconds since the epoch.
+            long long _approxTargetEpochMillis;
         } _maxTimeTracker;
 
     };
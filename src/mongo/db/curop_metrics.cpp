@@ -52,6 +52,7 @@ namespace {
     Counter64 scanAndOrderCounter;
     Counter64 fastmodCounter;
     Counter64 writeConflictsCounter;
+    Counter64 writeConflictBackoffMicrosCounter;
 
     ServerStatusMetricField<Counter64> displayIdhack("operation.idhack", &idhackCounter);
     ServerStatusMetricField<Counter64> displayScanAndOrder("operation.scanAndOrder",
@@ -59,6 +60,8 @@ namespace {
     ServerStatusMetricField<Counter64> displayFastMod("operation.fastmod", &fastmodCounter);
     ServerStatusMetricField<Counter64> displayWriteConflicts("operation.writeConflicts",
                                                                      &writeConflictsCounter);
+    ServerStatusMetricField<Counter64> displayWriteConflictBackoffMicros(
+        "operation.writeConflictBackoffMicros", &writeConflictBackoffMicrosCounter);
 
 }  // namespace
 
@@ -85,6 +88,8 @@ namespace {
             fastmodCounter.increment();
         if (debug.writeConflicts)
             writeConflictsCounter.increment(debug.writeConflicts);
+        if (debug.writeConflictBackoffMicros)
+            writeConflictBackoffMicrosCounter.increment(debug.writeConflictBackoffMicros);
     }
 
 }  // namespace mongo
@@ -28,8 +28,6 @@
 
 #include "mongo/platform/basic.h"
 
-#include <boost/thread/thread.hpp>
-
 #include "mongo/base/init.h"
 #include "mongo/db/client.h"
 #include "mongo/db/curop.h"
@@ -38,6 +36,8 @@
 #include "mongo/db/service_context_noop.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/coarse_clock.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -46,31 +46,10 @@ namespace mongo {
         const long long intervalLong = 2000 * 1000; // 2s in micros
         const long long intervalShort = 10 * 1000; // 10ms in micros
 
-        //
-        // Before executing the TimeHasExpired suite, spawn a dummy listener thread to be the
-        // process time tracker (the tests rely on Listener::_timeTracker being available).
-        //
-
-        class TestListener : public Listener {
-        public:
-            TestListener() : Listener("test", "", 0) {} // port 0 => any available high port
-            virtual void acceptedMP(MessagingPort *mp) {}
-        };
-
-        void timeTrackerSetup() {
-            TestListener listener;
-            listener.setAsTimeTracker();
-            listener.setupSockets();
-            listener.initAndListen();
-        }
-
+        // The tests should also pass with the precise clock, but check the coarse clock is used
+        // like in the server.
         MONGO_INITIALIZER(CurOpTest)(InitializerContext* context) {
-            boost::thread t(timeTrackerSetup);
-
-            // Wait for listener thread to start tracking time.
-            while (Listener::getElapsedTimeMillis() == 0) {
-                sleepmillis(10);
-            }
+            CoarseClock::start();
             return Status::OK();
         }
 
@@ -0,0 +1,207 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/cursor_prefetcher.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/cursor_manager.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/find.h"
+#include "mongo/db/query/find_constants.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+    using std::vector;
+
+    // static
+    CursorPrefetcher* CursorPrefetcher::get() {
+        // Deliberately leaked, as pool threads may still be running at shutdown.
+        static CursorPrefetcher* prefetcher = new CursorPrefetcher();
+        return prefetcher;
+    }
+
+    void CursorPrefetcher::schedule(const NamespaceString& nss, CursorId id, int batchSize) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!_prefetches.insert(std::make_pair(id, kScheduled)).second) {
+            return;
+        }
+        _numPrefetches.fetchAndAdd(1);
+
+        if (!_pool) {
+            _pool.reset(new ThreadPool(std::max(internalQueryCursorPrefetchThreads, 1),
+                                       "cursorPrefetch"));
+        }
+        _pool->schedule(&CursorPrefetcher::_prefetch, this, nss.ns(), id, batchSize);
+    }
+
+    void CursorPrefetcher::waitFor(CursorId id) {
+        if (_numPrefetches.load() == 0) {
+            return;
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        auto it = _prefetches.find(id);
+        if (it == _prefetches.end()) {
+            return;
+        }
+
+        if (it->second == kScheduled) {
+            // Not started yet. The pool thread finds the entry gone and does nothing.
+            _prefetches.erase(it);
+            _numPrefetches.subtractAndFetch(1);
+            return;
+        }
+
+        _prefetchDone.wait(lk, [&] { return _prefetches.find(id) == _prefetches.end(); });
+    }
+
+    void CursorPrefetcher::_prefetch(const std::string& ns, CursorId id, int batchSize) {
+        Client::initThreadIfNotAlready("cursorPrefetch");
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            auto it = _prefetches.find(id);
+            if (it == _prefetches.end() || it->second != kScheduled) {
+                // Cancelled by a getMore or killCursors which got there first.
+                return;
+            }
+            it->second = kRunning;
+        }
+
+        ON_BLOCK_EXIT([&] {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _prefetches.erase(id);
+            _numPrefetches.subtractAndFetch(1);
+            _prefetchDone.notify_all();
+        });
+
+        try {
+            OperationContextImpl txn;
+            _buildBatch(&txn, NamespaceString(ns), id, batchSize);
+        }
+        catch (const DBException& ex) {
+            LOG(1) << "prefetch of cursor " << id << " on " << ns << " failed: " << ex.toString();
+        }
+    }
+
+    void CursorPrefetcher::_buildBatch(OperationContext* txn,
+                                       const NamespaceString& nss,
+                                       CursorId id,
+                                       int batchSize) {
+        // As in getMore, the locks are declared before the pin so that the unpin happens under
+        // the collection lock.
+        AutoGetCollectionForRead ctx(txn, nss);
+        Collection* collection = ctx.getCollection();
+        if (!collection) {
+            return;
+        }
+
+        ClientCursorPin ccPin(collection->getCursorManager(), id);
+        ClientCursor* cursor = ccPin.c();
+        if (!cursor || cursor->getUnownedRecoveryUnit()) {
+            return;
+        }
+
+        if (!cursor->hasRecoveryUnit()) {
+            cursor->setOwnedRecoveryUnit(
+                getGlobalServiceContext()->getGlobalStorageEngine()->newRecoveryUnit());
+        }
+
+        // Run on the cursor's own storage engine state, and hand it back, with the snapshot of
+        // a batch that was cut short still pinned, for the getMore.
+        ScopedRecoveryUnitSwapper ruSwapper(cursor, txn);
+
+        PlanExecutor* exec = cursor->getExecutor();
+        if (!exec->restoreState(txn)) {
+            // Killed; the getMore reports why.
+            return;
+        }
+
+        // Never prefetch more than a getMore would return, so that the whole stash fits in the
+        // reply of the getMore that drains it.
+        const int maxBytes = std::min(internalQueryCursorPrefetchMaxBytes,
+                                      MaxBytesToReturnToClientAtOnce);
+
+        vector<BSONObj> batch;
+        int bytesBuffered = 0;
+        BSONObj obj;
+        PlanExecutor::ExecState state;
+        try {
+            while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
+                // Results must not be enqueued until we're done, or getNext() would hand them
+                // back.
+                batch.push_back(obj.getOwned());
+                bytesBuffered += obj.objsize();
+
+                if (bytesBuffered >= maxBytes
+                        || enoughForGetMore(batchSize, batch.size(), bytesBuffered)) {
+                    break;
+                }
+            }
+        }
+        catch (const DBException& ex) {
+            // The executor is left mid-batch and cannot be saved.
+            exec->kill(str::stream() << "prefetch failed: " << ex.toString());
+            throw;
+        }
+
+        if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
+            // Report the error on the next getMore rather than the documents before it.
+            exec->kill(str::stream() << "prefetch failed: "
+                                     << WorkingSetCommon::toStatusString(obj));
+            return;
+        }
+
+        for (const BSONObj& doc : batch) {
+            exec->enqueue(doc);
+        }
+
+        pinSnapshotForNextGetMore(txn, state);
+        exec->saveState();
+
+        LOG(5) << "prefetched " << batch.size() << " results for cursor " << id;
+    }
+
+} // namespace mongo
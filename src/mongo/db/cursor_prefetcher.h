@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/clientcursor.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+    class NamespaceString;
+    class OperationContext;
+
+    /**
+     * Builds the next batch of a ClientCursor on a background thread once a batch has been
+     * returned to the client, so that the following getMore is answered from the PlanExecutor's
+     * stash instead of running the plan while the client waits.  Only cursors with
+     * prefetchNextBatch() set are prefetched.
+     *
+     * A prefetch pins its cursor for as long as it runs, under the collection lock and with the
+     * cursor's own RecoveryUnit, and saves the cursor again before unpinning it.  Anything about
+     * to pin a collection cursor (getMore, killCursors) first calls waitFor(), which cancels a
+     * prefetch that has not started yet and waits for one that has.
+     */
+    class CursorPrefetcher {
+        MONGO_DISALLOW_COPYING(CursorPrefetcher);
+    public:
+        static CursorPrefetcher* get();
+
+        /**
+         * Schedules building up to 'batchSize' documents (0 for as many as the byte budget
+         * allows) of cursor 'id' on collection 'nss'.  Does nothing if a prefetch of the cursor
+         * is already pending.
+         *
+         * The caller must have unpinned the cursor and must not hold any locks.
+         */
+        void schedule(const NamespaceString& nss, CursorId id, int batchSize);
+
+        /**
+         * Once this returns, no prefetch of cursor 'id' is pending or running.
+         *
+         * Must not be called with locks held, since a running prefetch holds the collection lock.
+         */
+        void waitFor(CursorId id);
+
+    private:
+        enum PrefetchState {
+            kScheduled,
+            kRunning,
+        };
+
+        CursorPrefetcher() = default;
+
+        /**
+         * Runs on a pool thread: the prefetch of cursor 'id', unless it was cancelled meanwhile.
+         */
+        void _prefetch(const std::string& ns, CursorId id, int batchSize);
+
+        void _buildBatch(OperationContext* txn,
+                         const NamespaceString& nss,
+                         CursorId id,
+                         int batchSize);
+
+        // The number of entries in '_prefetches', so that waitFor() is free when nothing is
+        // being prefetched.
+        AtomicUInt32 _numPrefetches;
+
+        // Protects everything below.
+        stdx::mutex _mutex;
+
+        // Signalled whenever a running prefetch is done.
+        stdx::condition_variable _prefetchDone;
+
+        // Prefetches which are pending or running, by cursor id.
+        std::map<CursorId, PrefetchState> _prefetches;
+
+        // Created by the first schedule().
+        std::unique_ptr<ThreadPool> _pool;
+    };
+
+} // namespace mongo
@@ -41,6 +41,7 @@
 #include <signal.h>
 #include <string>
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/init.h"
 #include "mongo/base/initializer.h"
 #include "mongo/base/status.h"
@@ -48,6 +49,7 @@
 #include "mongo/db/auth/auth_index_d.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/cache_warmup.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
@@ -61,6 +63,7 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/dbwebserver.h"
+#include "mongo/db/ftdc/ftdc_mongod.h"
 #include "mongo/db/service_context_d.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/index_names.h"
@@ -71,8 +74,10 @@
 #include "mongo/db/json.h"
 #include "mongo/db/log_process_details.h"
 #include "mongo/db/mongod_options.h"
+#include "mongo/db/online_compaction.h"
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/plan_cache_snapshotter.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repair_database.h"
@@ -84,6 +89,7 @@
 #include "mongo/db/repl/storage_interface_impl.h"
 #include "mongo/db/repl/topology_coordinator_impl.h"
 #include "mongo/db/restapi.h"
+#include "mongo/db/sampling_profiler.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/startup_warnings_mongod.h"
 #include "mongo/db/stats/counters.h"
@@ -92,20 +98,23 @@
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/ttl.h"
-#include "mongo/executor/network_interface_impl.h"
+#include "mongo/executor/network_interface_factory.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
+#include "mongo/util/coarse_clock.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exception_filter_win32.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message_server.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/ntservice.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/options_parser/startup_options.h"
 #include "mongo/util/quick_exit.h"
 #include "mongo/util/ramlog.h"
@@ -115,6 +124,7 @@
 #include "mongo/util/startup_test.h"
 #include "mongo/util/text.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 #include "mongo/util/version.h"
 
 #if !defined(_WIN32)
@@ -156,6 +166,16 @@ namespace mongo {
             Client::initThread("conn", p);
         }
 
+        virtual bool supportsSuspend() const { return true; }
+
+        virtual std::unique_ptr<ConnectionState> suspend(AbstractMessagingPort* p) {
+            return stdx::make_unique<SuspendedClient>(Client::releaseCurrent());
+        }
+
+        virtual void resume(AbstractMessagingPort* p, std::unique_ptr<ConnectionState> state) {
+            Client::setCurrent(std::move(checked_cast<SuspendedClient*>(state.get())->client));
+        }
+
         virtual void process(Message& m , AbstractMessagingPort* port) {
             while ( true ) {
                 if ( inShutdown() ) {
@@ -200,6 +220,14 @@ namespace mongo {
                 break;
             }
         }
+
+    private:
+        // All per-connection state of mongod hangs off the Client, so that is all a suspended
+        // connection needs to carry between threads.
+        struct SuspendedClient : public ConnectionState {
+            explicit SuspendedClient(ServiceContext::UniqueClient c) : client(std::move(c)) {}
+            ServiceContext::UniqueClient client;
+        };
     };
 
     static void logStartup() {
@@ -296,13 +324,108 @@ namespace mongo {
         return 0;
     }
 
+    /**
+     * Opens 'dbName' and runs the startup checks on it. Returns false if its files need an upgrade
+     * before this version can use them. Only locks 'dbName', so that several databases can be
+     * recovered at once.
+     */
+    static bool recoverDatabase(const string& dbName, bool shouldClearNonLocalTmpCollections) {
+        LOG(1) << "    Recovering database: " << dbName << endl;
+
+        // Startup worker threads have no Client of their own.
+        Client::initThreadIfNotAlready("storageStartup");
+
+        OperationContextImpl txn;
+        ScopedTransaction transaction(&txn, MODE_IX);
+        Lock::DBLock lk(txn.lockState(), dbName, MODE_X);
+
+        Database* db = dbHolder().openDb(&txn, dbName);
+        invariant(db);
+
+        // First thing after opening the database is to check for file compatibility,
+        // otherwise we might crash if this is a deprecated format.
+        if (!db->getDatabaseCatalogEntry()->currentFilesCompatible(&txn)) {
+            return false;
+        }
+
+        // Major versions match, check indexes
+        const string systemIndexes = db->name() + ".system.indexes";
+
+        Collection* coll = db->getCollection( systemIndexes );
+        unique_ptr<PlanExecutor> exec(
+            InternalPlanner::collectionScan(&txn, systemIndexes, coll));
+
+        BSONObj index;
+        PlanExecutor::ExecState state;
+        while (PlanExecutor::ADVANCED == (state = exec->getNext(&index, NULL))) {
+            const BSONObj key = index.getObjectField("key");
+            const string plugin = IndexNames::findPluginName(key);
+
+            if (db->getDatabaseCatalogEntry()->isOlderThan24(&txn)) {
+                if (IndexNames::existedBefore24(plugin)) {
+                    continue;
+                }
+
+                log() << "Index " << index << " claims to be of type '" << plugin << "', "
+                        << "which is either invalid or did not exist before v2.4. "
+                        << "See the upgrade section: "
+                        << "http://dochub.mongodb.org/core/upgrade-2.4"
+                        << startupWarningsLog;
+            }
+
+            const Status keyStatus = validateKeyPattern(key);
+            if (!keyStatus.isOK()) {
+                log() << "Problem with index " << index << ": " << keyStatus.reason()
+                        << " This index can still be used however it cannot be rebuilt."
+                        << " For more info see"
+                        << " http://dochub.mongodb.org/core/index-validation"
+                        << startupWarningsLog;
+            }
+        }
+
+        if (PlanExecutor::IS_EOF != state) {
+            warning() << "Internal error while reading collection " << systemIndexes;
+        }
+
+        if (repl::getGlobalReplicationCoordinator()->getSettings().usingReplSets()) {
+            // We only care about the _id index if we are in a replset
+            checkForIdIndexes(&txn, db);
+        }
+
+        if (shouldClearNonLocalTmpCollections || dbName == "local") {
+            db->clearTmpCollections(&txn);
+        }
+
+        return true;
+    }
+
+    namespace {
+        struct DatabaseToRecover {
+            string name;
+            bool compatible = true;
+            string error;
+        };
+    }
+
+    static void recoverDatabaseTask(DatabaseToRecover* toRecover,
+                                    bool shouldClearNonLocalTmpCollections) {
+        // ThreadPool only logs exceptions, so keep the error for the starting thread
+        try {
+            toRecover->compatible = recoverDatabase(toRecover->name,
+                                                    shouldClearNonLocalTmpCollections);
+        }
+        catch (const DBException& e) {
+            toRecover->error = e.toString();
+        }
+        catch (const std::exception& e) {
+            toRecover->error = e.what();
+        }
+    }
+
     static void repairDatabasesAndCheckVersion() {
         LOG(1) << "enter repairDatabases (to check pdfile version #)" << endl;
 
         OperationContextImpl txn;
-        ScopedTransaction transaction(&txn, MODE_X);
-        Lock::GlobalWrite lk(txn.lockState());
-
         vector<string> dbNames;
 
         StorageEngine* storageEngine = getGlobalServiceContext()->getGlobalStorageEngine();
@@ -310,6 +433,9 @@ namespace mongo {
 
         // Repair all databases first, so that we do not try to open them if they are in bad shape
         if (storageGlobalParams.repair) {
+            ScopedTransaction transaction(&txn, MODE_X);
+            Lock::GlobalWrite lk(txn.lockState());
+
             for (vector<string>::const_iterator i = dbNames.begin(); i != dbNames.end(); ++i) {
                 const string dbName = *i;
                 LOG(1) << "    Repairing database: " << dbName << endl;
@@ -329,78 +455,64 @@ namespace mongo {
                                                     || replSettings.usingReplSets()
                                                     || replSettings.slave == repl::SimpleSlave);
 
+        // mmapv1 must check the version of every database's files before serving any of them.
+        const bool lazy = storageGlobalParams.lazyOpen && !storageEngine->isMmapV1();
+
+        vector<DatabaseToRecover> toRecover;
         for (vector<string>::const_iterator i = dbNames.begin(); i != dbNames.end(); ++i) {
-            const string dbName = *i;
-            LOG(1) << "    Recovering database: " << dbName << endl;
+            if (lazy && *i != "local") {
+                continue;
+            }
+            toRecover.push_back(DatabaseToRecover());
+            toRecover.back().name = *i;
+        }
+
+        // Databases are opened under their own database locks, so they can be opened in parallel.
+        Timer recoverTimer;
+        const int nThreads = std::min(std::max(storageGlobalParams.startupThreads, 1),
+                                      static_cast<int>(toRecover.size()));
+        if (nThreads <= 1) {
+            for (size_t i = 0; i < toRecover.size(); ++i) {
+                toRecover[i].compatible = recoverDatabase(toRecover[i].name,
+                                                          shouldClearNonLocalTmpCollections);
+            }
+        }
+        else {
+            ThreadPool pool(nThreads, "storageStartup");
+            for (size_t i = 0; i < toRecover.size(); ++i) {
+                pool.schedule(&recoverDatabaseTask,
+                              &toRecover[i],
+                              shouldClearNonLocalTmpCollections);
+            }
+            pool.join();
+        }
 
-            Database* db = dbHolder().openDb(&txn, dbName);
-            invariant(db);
+        for (size_t i = 0; i < toRecover.size(); ++i) {
+            uassert(28709,
+                    str::stream() << "failed to open database " << toRecover[i].name << ": "
+                                  << toRecover[i].error,
+                    toRecover[i].error.empty());
 
-            // First thing after opening the database is to check for file compatibility,
-            // otherwise we might crash if this is a deprecated format.
-            if (!db->getDatabaseCatalogEntry()->currentFilesCompatible(&txn)) {
+            if (!toRecover[i].compatible) {
                 log() << "****";
                 log() << "cannot do this upgrade without an upgrade in the middle";
                 log() << "please do a --repair with 2.6 and then start this version";
                 dbexit(EXIT_NEED_UPGRADE);
                 return;
             }
-
-            // Major versions match, check indexes
-            const string systemIndexes = db->name() + ".system.indexes";
-
-            Collection* coll = db->getCollection( systemIndexes );
-            unique_ptr<PlanExecutor> exec(
-                InternalPlanner::collectionScan(&txn, systemIndexes, coll));
-
-            BSONObj index;
-            PlanExecutor::ExecState state;
-            while (PlanExecutor::ADVANCED == (state = exec->getNext(&index, NULL))) {
-                const BSONObj key = index.getObjectField("key");
-                const string plugin = IndexNames::findPluginName(key);
-
-                if (db->getDatabaseCatalogEntry()->isOlderThan24(&txn)) {
-                    if (IndexNames::existedBefore24(plugin)) {
-                        continue;
-                    }
-
-                    log() << "Index " << index << " claims to be of type '" << plugin << "', "
-                            << "which is either invalid or did not exist before v2.4. "
-                            << "See the upgrade section: "
-                            << "http://dochub.mongodb.org/core/upgrade-2.4"
-                            << startupWarningsLog;
-                }
-
-                const Status keyStatus = validateKeyPattern(key);
-                if (!keyStatus.isOK()) {
-                    log() << "Problem with index " << index << ": " << keyStatus.reason()
-                            << " This index can still be used however it cannot be rebuilt."
-                            << " For more info see"
-                            << " http://dochub.mongodb.org/core/index-validation"
-                            << startupWarningsLog;
-                }
-            }
-
-            if (PlanExecutor::IS_EOF != state) {
-                warning() << "Internal error while reading collection " << systemIndexes;
-            }
-
-            if (replSettings.usingReplSets()) {
-                // We only care about the _id index if we are in a replset
-                checkForIdIndexes(&txn, db);
-            }
-
-            if (shouldClearNonLocalTmpCollections || dbName == "local") {
-                db->clearTmpCollections(&txn);
-            }
         }
 
+        log() << "opened " << toRecover.size() << " of " << dbNames.size() << " database(s) in "
+              << recoverTimer.millis() << "ms using " << std::max(nThreads, 1) << " thread(s)";
+
         LOG(1) << "done repairDatabases" << endl;
     }
 
     static void _initAndListen(int listenPort ) {
         Client::initThread("initandlisten");
 
+        CoarseClock::start();
+
         // Due to SERVER-15389, we must setupSockets first thing at startup in order to avoid
         // obtaining too high a file descriptor for our calls to select().
         MessageServer::Options options;
@@ -595,6 +707,12 @@ namespace mongo {
         }
 
         startClientCursorMonitor();
+        startProfileSampleFlusher();
+        startPlanCacheSnapshotter();
+        startFTDC();
+        startSamplingProfiler();
+        startOnlineCompactionBackgroundJob();
+        startCacheWarmup();
 
         PeriodicTask::startRunningPeriodicTasks();
 
@@ -757,7 +875,7 @@ MONGO_INITIALIZER_WITH_PREREQUISITES(CreateReplicationManager, ("SetGlobalEnviro
     auto replCoord = stdx::make_unique<repl::ReplicationCoordinatorImpl>(
         getGlobalReplSettings(),
         new repl::ReplicationCoordinatorExternalStateImpl,
-        new executor::NetworkInterfaceImpl{},
+        executor::makeNetworkInterface().release(),
         new repl::StorageInterfaceImpl{},
         new repl::TopologyCoordinatorImpl(Seconds(repl::maxSyncSourceLagSecs)),
         static_cast<int64_t>(curTimeMillis64()));
@@ -833,6 +951,9 @@ static int mongoDbMain(int argc, char* argv[], char **envp) {
     if (!initializeServerGlobalState())
         quickExit(EXIT_FAILURE);
 
+    // Before any threads are started, so they all inherit the memory policy.
+    initializeNumaMemoryPolicy();
+
     // Per SERVER-7434, startSignalProcessingThread() must run after any forks
     // (initializeServerGlobalState()) and before creation of any other threads.
     startSignalProcessingThread();
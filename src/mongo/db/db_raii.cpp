@@ -33,11 +33,22 @@
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/s/d_state.h"
 
 namespace mongo {
 
+namespace {
+
+    // Lets queries on secondaries with document level locking read from a snapshot taken at the
+    // end of the last batch of replicated operations, rather than wait for batches to be applied.
+    MONGO_EXPORT_SERVER_PARAMETER(readFromBatchBoundarySnapshotsOnSecondaries, bool, true);
+
+} // namespace
+
     AutoGetDb::AutoGetDb(OperationContext* txn, StringData ns, LockMode mode)
             : _dbLock(txn->lockState(), ns, mode),
               _db(dbHolder().get(txn, ns)) {
@@ -62,10 +73,62 @@ namespace mongo {
         }
     }
 
+    AutoGetCollectionForRead::BatchBoundarySnapshotReader::BatchBoundarySnapshotReader(
+            OperationContext* txn,
+            BatchBoundarySnapshot batchBoundarySnapshot)
+        : _txn(txn),
+          _pbwm(txn->lockState(), resourceIdParallelBatchWriterMode),
+          _active(false) {
+
+        if (batchBoundarySnapshot != BatchBoundarySnapshot::kAllowed ||
+                !readFromBatchBoundarySnapshotsOnSecondaries) {
+            return;
+        }
+
+        // Only the outermost locks of an operation can give up the parallel batch writer lock,
+        // and snapshots can only be opened outside of a WriteUnitOfWork.
+        Locker* locker = _txn->lockState();
+        if (locker->isLocked() || locker->isBatchWriter() || locker->inAWriteUnitOfWork()) {
+            return;
+        }
+
+        // Without document level locking, batches are applied under collection or database locks
+        // which keep out readers anyway.
+        if (!supportsDocLocking() ||
+                !repl::getGlobalReplicationCoordinator()->getMemberState().secondary()) {
+            return;
+        }
+
+        // The global lock won't take the parallel batch writer lock now, we hold it ourselves
+        // until openSnapshot().
+        _pbwm.lock(MODE_IS);
+        locker->setReadsFromBatchBoundarySnapshot(true);
+        _active = true;
+    }
+
+    AutoGetCollectionForRead::BatchBoundarySnapshotReader::~BatchBoundarySnapshotReader() {
+        if (_active) {
+            _txn->lockState()->setReadsFromBatchBoundarySnapshot(false);
+        }
+    }
+
+    void AutoGetCollectionForRead::BatchBoundarySnapshotReader::openSnapshot() {
+        if (!_active) {
+            return;
+        }
+
+        // No batch is being applied while we hold the parallel batch writer lock, so the snapshot
+        // sees the state at the end of the last batch for as long as it stays open. Query yields
+        // make sure that new snapshots are also taken between batches.
+        _txn->recoveryUnit()->preallocateSnapshot(_txn);
+        _pbwm.unlock();
+    }
+
     AutoGetCollectionForRead::AutoGetCollectionForRead(OperationContext* txn,
                                                        const std::string& ns)
             : _txn(txn),
               _transaction(txn, MODE_IS),
+              _batchBoundarySnapshotReader(txn, BatchBoundarySnapshot::kNotAllowed),
               _db(_txn, nsToDatabaseSubstring(ns), MODE_IS),
               _collLock(_txn->lockState(), ns, MODE_IS),
               _coll(NULL) {
@@ -74,14 +137,17 @@ namespace mongo {
     }
 
     AutoGetCollectionForRead::AutoGetCollectionForRead(OperationContext* txn,
-                                                       const NamespaceString& nss)
+                                                       const NamespaceString& nss,
+                                                       BatchBoundarySnapshot batchBoundarySnapshot)
             : _txn(txn),
               _transaction(txn, MODE_IS),
+              _batchBoundarySnapshotReader(txn, batchBoundarySnapshot),
               _db(_txn, nss.db(), MODE_IS),
               _collLock(_txn->lockState(), nss.toString(), MODE_IS),
               _coll(NULL) {
 
         _init(nss.toString(), nss.coll());
+        _batchBoundarySnapshotReader.openSnapshot();
     }
 
     void AutoGetCollectionForRead::_init(const std::string& ns, StringData coll) {
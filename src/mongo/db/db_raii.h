@@ -104,8 +104,21 @@ namespace mongo {
     class AutoGetCollectionForRead {
         MONGO_DISALLOW_COPYING(AutoGetCollectionForRead);
     public:
+        /**
+         * Whether a read on a secondary may read from a snapshot taken between two batches of
+         * replicated operations, instead of keeping batches from being applied for as long as it
+         * holds its locks. Only for reads which do no writes of their own under these locks.
+         */
+        enum class BatchBoundarySnapshot {
+            kNotAllowed,
+            kAllowed
+        };
+
         AutoGetCollectionForRead(OperationContext* txn, const std::string& ns);
-        AutoGetCollectionForRead(OperationContext* txn, const NamespaceString& nss);
+        AutoGetCollectionForRead(OperationContext* txn,
+                                 const NamespaceString& nss,
+                                 BatchBoundarySnapshot batchBoundarySnapshot =
+                                     BatchBoundarySnapshot::kNotAllowed);
         ~AutoGetCollectionForRead();
 
         Database* getDb() const {
@@ -117,12 +130,33 @@ namespace mongo {
         }
 
     private:
+        /**
+         * Holds the parallel batch writer lock while the other locks are taken, then opens the
+         * storage snapshot and lets batch application go on. Does nothing unless the read is
+         * allowed to, and able to, read from a batch boundary snapshot.
+         */
+        class BatchBoundarySnapshotReader {
+            MONGO_DISALLOW_COPYING(BatchBoundarySnapshotReader);
+        public:
+            BatchBoundarySnapshotReader(OperationContext* txn,
+                                        BatchBoundarySnapshot batchBoundarySnapshot);
+            ~BatchBoundarySnapshotReader();
+
+            void openSnapshot();
+
+        private:
+            OperationContext* const _txn;
+            Lock::ResourceLock _pbwm;
+            bool _active;
+        };
+
         void _init(const std::string& ns,
                    StringData coll);
 
         const Timer _timer;
         OperationContext* const _txn;
         const ScopedTransaction _transaction;
+        BatchBoundarySnapshotReader _batchBoundarySnapshotReader;
         const AutoGetDb _db;
         const Lock::CollectionLock _collLock;
 
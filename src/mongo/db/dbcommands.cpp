@@ -83,6 +83,7 @@
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_result_cache.h"
 #include "mongo/db/repair_database.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/repl/read_after_optime_args.h"
@@ -90,9 +91,13 @@
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/sampling_profiler.h"
+#include "mongo/db/stats/profile_ring_buffer.h"
+#include "mongo/db/stats/query_stats_store.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/write_concern.h"
+#include "mongo/rpc/document_range.h"
 #include "mongo/rpc/request_interface.h"
 #include "mongo/rpc/reply_builder_interface.h"
 #include "mongo/rpc/metadata.h"
@@ -367,6 +372,148 @@ namespace mongo {
 
     } cmdProfile;
 
+    /**
+     * Returns the entries of this database's operations that the sampling profiler recorded, see
+     * profileSampleRate and profileSampleSlowMS.
+     */
+    class CmdGetProfileSamples : public Command {
+    public:
+        CmdGetProfileSamples() : Command("getProfileSamples") { }
+
+        virtual bool slaveOk() const {
+            return true;
+        }
+
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+
+        virtual void help( stringstream& help ) const {
+            help << "return the operations recorded by the sampling profiler\n";
+            help << "{ getProfileSamples : 1, afterSeq : <n> }\n";
+            help << "afterSeq is the lastSeq of a previous call, to get only newer entries";
+        }
+
+        virtual Status checkAuthForCommand(ClientBasic* client,
+                                           const std::string& dbname,
+                                           const BSONObj& cmdObj) {
+            // Reading the samples takes the same privilege as reading system.profile.
+            AuthorizationSession* authzSession = AuthorizationSession::get(client);
+            if (authzSession->isAuthorizedForActionsOnResource(
+                    ResourcePattern::forExactNamespace(NamespaceString(dbname, "system.profile")),
+                    ActionType::find)) {
+                return Status::OK();
+            }
+            return Status(ErrorCodes::Unauthorized, "unauthorized");
+        }
+
+        bool run(OperationContext* txn,
+                 const string& dbname,
+                 BSONObj& cmdObj,
+                 int options,
+                 string& errmsg,
+                 BSONObjBuilder& result) {
+            long long afterSeq = 0;
+            const BSONElement afterSeqElt = cmdObj["afterSeq"];
+            if (!afterSeqElt.eoo()) {
+                if (!afterSeqElt.isNumber()) {
+                    return appendCommandStatus(result,
+                                               Status(ErrorCodes::TypeMismatch,
+                                                      "afterSeq must be a number"));
+                }
+                afterSeq = afterSeqElt.numberLong();
+            }
+
+            std::vector<ProfileRingBuffer::Sample> samples;
+            long long lastSeq = getProfileSampleRing()->getSince(afterSeq, &samples);
+
+            // Leave room for the rest of the reply. Whatever does not fit is returned by the
+            // next call, starting after the last entry returned.
+            const int maxBytes = BSONObjMaxUserSize - 100 * 1024;
+            BSONArrayBuilder samplesBuilder(result.subarrayStart("samples"));
+            for (const ProfileRingBuffer::Sample& sample : samples) {
+                if (nsToDatabaseSubstring(sample.entry["ns"].valuestrsafe()) != dbname) {
+                    continue;
+                }
+                if (samplesBuilder.len() + sample.entry.objsize() > maxBytes) {
+                    lastSeq = sample.seq - 1;
+                    break;
+                }
+                samplesBuilder.append(sample.entry);
+            }
+            samplesBuilder.doneFast();
+
+            result.appendNumber("lastSeq", lastSeq);
+            result.appendNumber("numRecorded", getProfileSampleRing()->numRecorded());
+            return true;
+        }
+
+    } cmdGetProfileSamples;
+
+    class CmdQueryStats : public Command {
+    public:
+        CmdQueryStats() : Command("queryStats") { }
+
+        virtual bool slaveOk() const {
+            return true;
+        }
+
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+
+        virtual void help( stringstream& help ) const {
+            help << "return the execution statistics of this database's queries by query shape\n";
+            help << "{ queryStats : 1, reset : <bool> }\n";
+            help << "reset clears the statistics of this database after returning them";
+        }
+
+        virtual Status checkAuthForCommand(ClientBasic* client,
+                                           const std::string& dbname,
+                                           const BSONObj& cmdObj) {
+            // Like the profile samples, the statistics show the queries run on the database.
+            AuthorizationSession* authzSession = AuthorizationSession::get(client);
+            if (authzSession->isAuthorizedForActionsOnResource(
+                    ResourcePattern::forExactNamespace(NamespaceString(dbname, "system.profile")),
+                    ActionType::find)) {
+                return Status::OK();
+            }
+            return Status(ErrorCodes::Unauthorized, "unauthorized");
+        }
+
+        bool run(OperationContext* txn,
+                 const string& dbname,
+                 BSONObj& cmdObj,
+                 int options,
+                 string& errmsg,
+                 BSONObjBuilder& result) {
+            QueryStatsStore* store = getGlobalQueryStatsStore();
+            const std::vector<BSONObj> entries = store->getEntries(dbname);
+
+            // The entries are sorted by total time, so the shapes left out of a full reply are
+            // the cheapest ones.
+            const int maxBytes = BSONObjMaxUserSize - 100 * 1024;
+            bool truncated = false;
+            BSONArrayBuilder shapesBuilder(result.subarrayStart("shapes"));
+            for (const BSONObj& entry : entries) {
+                if (shapesBuilder.len() + entry.objsize() > maxBytes) {
+                    truncated = true;
+                    break;
+                }
+                shapesBuilder.append(entry);
+            }
+            shapesBuilder.doneFast();
+
+            if (truncated) {
+                result.appendBool("truncated", true);
+            }
+            result.appendNumber("numShapes", static_cast<long long>(store->numShapes()));
+            result.appendNumber("numEvicted", store->numEvicted());
+
+            if (cmdObj["reset"].trueValue()) {
+                store->reset(dbname);
+            }
+            return true;
+        }
+
+    } cmdQueryStats;
+
     class CmdDiagLogging : public Command {
     public:
         virtual bool slaveOk() const {
@@ -915,6 +1062,11 @@ namespace mongo {
             result.appendNumber("totalIndexSize", indexSize / scale);
             result.append("indexSizes", indexSizes.obj());
 
+            if (QueryResultCache* resultCache = collection->infoCache()->getQueryResultCache()) {
+                BSONObjBuilder resultCacheBob(result.subobjStart("queryResultCache"));
+                resultCache->appendStats(&resultCacheBob);
+            }
+
             return true;
         }
 
@@ -1183,6 +1335,7 @@ namespace {
                 stdx::lock_guard<Client> lk(*txn->getClient());
                 CurOp::get(txn)->setCommand_inlock(command);
             }
+            SamplingProfilerOpScope profilerOp(command->name.c_str());
             // TODO: move this back to runCommands when mongos supports OperationContext
             // see SERVER-18515 for details.
             uassertStatusOK(rpc::readRequestMetadata(txn, request.getMetadata()));
@@ -1372,7 +1525,11 @@ namespace {
             }
         }
 
-        bool result = this->run(txn, db, interposedCmd, queryFlags, errmsg, replyBuilderBob);
+        const rpc::DocumentRange inputDocs = request.getInputDocs();
+        bool result = (inputDocs.begin() == inputDocs.end())
+            ? this->run(txn, db, interposedCmd, queryFlags, errmsg, replyBuilderBob)
+            : this->runWithInputDocs(txn, db, interposedCmd, inputDocs, queryFlags, errmsg,
+                                     replyBuilderBob);
 
         // For commands from mongos, append some info to help getLastError(w) work.
         // TODO: refactor out of here as part of SERVER-18326
@@ -1386,6 +1543,12 @@ namespace {
 
         replyBuilder->setMetadata(rpc::makeEmptyMetadata());
 
+        // Add "ok" in place, so that setCommandReply() does not have to copy the whole response
+        // just to append it.
+        if (result && !replyBuilderBob.hasField("ok")) {
+            replyBuilderBob.append("ok", 1.0);
+        }
+
         auto cmdResponse = replyBuilderBob.done();
 
         if (result) {
@@ -53,6 +53,7 @@
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/rpc/metadata/trace_metadata.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point.h"
@@ -60,6 +61,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/md5.hpp"
 #include "mongo/util/ntservice.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
 #include "mongo/util/version.h"
@@ -184,6 +186,10 @@ namespace mongo {
             bSys.append( "numCores", p.getNumCores() );
             bSys.append( "cpuArch", p.getArch() );
             bSys.append( "numaEnabled", p.hasNumaEnabled() );
+            {
+                BSONObjBuilder bNuma( bSys.subobjStart( "numa" ) );
+                appendNumaInfo( &bNuma, false );
+            }
             bOs.append( "type", p.getOsType() );
             bOs.append( "name", p.getOsName() );
             bOs.append( "version", p.getOsVersion() );
@@ -400,6 +406,68 @@ namespace mongo {
 
     } getLogCmd;
 
+    class CmdGetTraceSpans : public Command {
+    public:
+        CmdGetTraceSpans() : Command("getTraceSpans") {}
+
+        virtual bool slaveOk() const { return true; }
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual bool adminOnly() const { return true; }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::serverStatus);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        virtual void help(stringstream& help) const {
+            help << "return the spans of traced operations recorded on this node\n";
+            help << "{ getTraceSpans : 1, traceId : <n>, afterSeq : <n> }\n";
+            help << "traceId picks one trace, afterSeq is the lastSeq of a previous call";
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         string& errmsg,
+                         BSONObjBuilder& result) {
+            long long traceId = 0;
+            const BSONElement traceIdElt = cmdObj["traceId"];
+            if (!traceIdElt.eoo()) {
+                if (!traceIdElt.isNumber()) {
+                    return appendCommandStatus(result,
+                                               Status(ErrorCodes::TypeMismatch,
+                                                      "traceId must be a number"));
+                }
+                traceId = traceIdElt.numberLong();
+            }
+
+            long long afterSeq = 0;
+            const BSONElement afterSeqElt = cmdObj["afterSeq"];
+            if (!afterSeqElt.eoo()) {
+                if (!afterSeqElt.isNumber()) {
+                    return appendCommandStatus(result,
+                                               Status(ErrorCodes::TypeMismatch,
+                                                      "afterSeq must be a number"));
+                }
+                afterSeq = afterSeqElt.numberLong();
+            }
+
+            // Leave room for the rest of the reply. Whatever does not fit is returned by the
+            // next call, starting after the last span returned.
+            const int maxBytes = BSONObjMaxUserSize - 100 * 1024;
+            BSONArrayBuilder spansBuilder(result.subarrayStart("spans"));
+            long long lastSeq = rpc::appendTraceSpans(traceId, afterSeq, maxBytes, &spansBuilder);
+            spansBuilder.doneFast();
+
+            result.appendNumber("lastSeq", lastSeq);
+            result.appendNumber("numRecorded", rpc::numTraceSpansRecorded());
+            return true;
+        }
+
+    } cmdGetTraceSpans;
+
     class CmdGetCmdLineOpts : Command {
     public:
         CmdGetCmdLineOpts(): Command("getCmdLineOpts") {}
@@ -38,6 +38,7 @@
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/introspect.h"
 #include "mongo/db/jsobj.h"
@@ -58,6 +59,18 @@ namespace {
 
     const int edebug=0;
 
+    // counts of the scripting engine behind eval, $where, mapReduce and group
+    ServerStatusMetricField<Counter64> displayScopesCreated("scripting.scopesCreated",
+                                                            &ScriptEngine::scopesCreated);
+    ServerStatusMetricField<Counter64> displayWarmScopesUsed("scripting.warmScopesUsed",
+                                                             &ScriptEngine::warmScopesUsed);
+    ServerStatusMetricField<Counter64> displayFunctionsCompiled(
+                                            "scripting.functionsCompiled",
+                                            &ScriptEngine::functionsCompiled);
+    ServerStatusMetricField<Counter64> displayFunctionCacheHits(
+                                            "scripting.functionCacheHits",
+                                            &ScriptEngine::functionCacheHits);
+
     bool dbEval(OperationContext* txn,
                 const string& dbName,
                 const BSONObj& cmd,
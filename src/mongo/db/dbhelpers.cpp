@@ -39,6 +39,7 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
@@ -58,6 +59,7 @@
 #include "mongo/db/range_arithmetic.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
@@ -65,6 +67,7 @@
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -75,6 +78,7 @@ namespace mongo {
     using std::set;
     using std::string;
     using std::stringstream;
+    using std::vector;
 
     using logger::LogComponent;
 
@@ -172,6 +176,16 @@ namespace mongo {
         if ( nsFound )
             *nsFound = true;
 
+        if (collection->isClustered()) {
+            const RecordId loc = Collection::recordIdForId(query["_id"]);
+            Snapshotted<BSONObj> doc;
+            if (loc.isNull() || !collection->findDoc(txn, loc, &doc)) {
+                return false;
+            }
+            result = doc.value();
+            return true;
+        }
+
         IndexCatalog* catalog = collection->getIndexCatalog();
         const IndexDescriptor* desc = catalog->findIdIndex( txn );
 
@@ -192,6 +206,15 @@ namespace mongo {
                               Collection* collection,
                               const BSONObj& idquery) {
         verify(collection);
+        if (collection->isClustered()) {
+            const RecordId loc = Collection::recordIdForId(idquery["_id"]);
+            Snapshotted<BSONObj> doc;
+            if (loc.isNull() || !collection->findDoc(txn, loc, &doc)) {
+                return RecordId();
+            }
+            return loc;
+        }
+
         IndexCatalog* catalog = collection->getIndexCatalog();
         const IndexDescriptor* desc = catalog->findIdIndex( txn );
         uassert(13430, "no _id index", desc);
@@ -309,6 +332,15 @@ namespace mongo {
         return true;
     }
 
+    // How many documents removeRange deletes in one storage transaction, and between
+    // secondaryThrottle waits.
+    MONGO_EXPORT_SERVER_PARAMETER( rangeDeleterBatchSize, int, 128 );
+
+    // The most documents, and document bytes, a removeRange deletes per second, or 0 for no
+    // limit. The limits apply to each range, so parallel range deleter workers add up.
+    MONGO_EXPORT_SERVER_PARAMETER( rangeDeleterMaxDocsPerSecond, int, 0 );
+    MONGO_EXPORT_SERVER_PARAMETER( rangeDeleterMaxBytesPerSecond, long long, 0 );
+
     long long Helpers::removeRange( OperationContext* txn,
                                     const KeyRange& range,
                                     bool maxInclusive,
@@ -350,11 +382,36 @@ namespace mongo {
                << "begin removal of " << min << " to " << max << " in " << ns
                << " with write concern: " << writeConcern.toBSON() << endl;
 
+        const size_t batchSize = std::max(rangeDeleterBatchSize, 1);
+
         long long numDeleted = 0;
-        
+        long long bytesDeleted = 0;
+        Timer throttleTimer;
+
         Milliseconds millisWaitingForReplication{0};
 
-        while ( 1 ) {
+        bool done = false;
+        int attempt = 1;
+        while ( !done ) {
+            // Sleep between batches, with no locks held, to stay under the rate limits.
+            long long dueMillis = 0;
+            if (rangeDeleterMaxDocsPerSecond > 0) {
+                dueMillis = numDeleted * 1000 / rangeDeleterMaxDocsPerSecond;
+            }
+            if (rangeDeleterMaxBytesPerSecond > 0) {
+                dueMillis = std::max(dueMillis,
+                                     bytesDeleted * 1000 / rangeDeleterMaxBytesPerSecond);
+            }
+            const long long elapsedMillis = throttleTimer.millis();
+            if (dueMillis > elapsedMillis) {
+                sleepmillis(dueMillis - elapsedMillis);
+            }
+
+            // The batch isn't collected by a yielding executor, so this is where killOp gets us.
+            txn->checkForInterrupt();
+
+            size_t batchDeleted = 0;
+
             // Scoping for write lock.
             {
                 OldClientWriteContext ctx(txn, ns);
@@ -366,20 +423,24 @@ namespace mongo {
                     collection->getIndexCatalog()->findIndexByKeyPattern( txn,
                                                                           indexKeyPattern.toBSON() );
 
+                // The batch is collected without yielding, so that none of its documents can
+                // change or go away before we delete them.
                 unique_ptr<PlanExecutor> exec(InternalPlanner::indexScan(txn, collection, desc,
                                                                        min, max,
                                                                        maxInclusive,
                                                                        InternalPlanner::FORWARD,
                                                                        InternalPlanner::IXSCAN_FETCH));
-                exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
 
+                vector<RecordId> locs;
+                vector<BSONObj> objs;
                 RecordId rloc;
                 BSONObj obj;
-                PlanExecutor::ExecState state;
-                // This may yield so we cannot touch nsd after this.
-                state = exec->getNext(&obj, &rloc);
-                exec.reset();
-                if (PlanExecutor::IS_EOF == state) { break; }
+                PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+                while (locs.size() < batchSize
+                        && PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &rloc))) {
+                    locs.push_back(rloc);
+                    objs.push_back(obj.getOwned());
+                }
 
                 if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
                     const std::unique_ptr<PlanStageStats> stats(exec->getStats());
@@ -391,12 +452,12 @@ namespace mongo {
                               << Explain::statsToBSON(*stats) << endl;
                     break;
                 }
+                exec.reset();
 
-                verify(PlanExecutor::ADVANCED == state);
-
-                WriteUnitOfWork wuow(txn);
+                // A short batch means the range has no more documents after it.
+                done = locs.size() < batchSize;
 
-                if ( onlyRemoveOrphanedDocs ) {
+                if ( onlyRemoveOrphanedDocs && !locs.empty() ) {
                     // Do a final check in the write lock to make absolutely sure that our
                     // collection hasn't been modified in a way that invalidates our migration
                     // cleanup.
@@ -408,26 +469,39 @@ namespace mongo {
                     // In write lock, so will be the most up-to-date version
                     CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
 
-                    bool docIsOrphan;
-                    if ( metadataNow ) {
-                        ShardKeyPattern kp( metadataNow->getKeyPattern() );
-                        BSONObj key = kp.extractShardKeyFromDoc(obj);
-                        docIsOrphan = !metadataNow->keyBelongsToMe( key )
-                            && !metadataNow->keyIsPending( key );
-                    }
-                    else {
-                        docIsOrphan = false;
-                    }
-
-                    if ( !docIsOrphan ) {
-                        warning(LogComponent::kSharding)
-                                  << "aborting migration cleanup for chunk " << min << " to " << max
-                                  << ( metadataNow ? (string) " at document " + obj.toString() : "" )
-                                  << ", collection " << ns << " has changed " << endl;
-                        break;
+                    for (size_t i = 0; i < objs.size(); ++i) {
+                        bool docIsOrphan;
+                        if ( metadataNow ) {
+                            ShardKeyPattern kp( metadataNow->getKeyPattern(),
+                                                metadataNow->getHashVersion() );
+                            BSONObj key = kp.extractShardKeyFromDoc(objs[i]);
+                            docIsOrphan = !metadataNow->keyBelongsToMe( key )
+                                && !metadataNow->keyIsPending( key );
+                        }
+                        else {
+                            docIsOrphan = false;
+                        }
+
+                        if ( !docIsOrphan ) {
+                            warning(LogComponent::kSharding)
+                                      << "aborting migration cleanup for chunk " << min << " to "
+                                      << max
+                                      << ( metadataNow ?
+                                           (string) " at document " + objs[i].toString() : "" )
+                                      << ", collection " << ns << " has changed " << endl;
+
+                            // The documents before this one are still ours to delete.
+                            locs.resize(i);
+                            objs.resize(i);
+                            done = true;
+                            break;
+                        }
                     }
                 }
 
+                if (locs.empty())
+                    break;
+
                 NamespaceString nss(ns);
                 if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
                     warning() << "stepped down from primary while deleting chunk; "
@@ -436,19 +510,39 @@ namespace mongo {
                     return numDeleted;
                 }
 
-                if ( callback )
-                    callback->goingToDelete( obj );
+                try {
+                    if ( callback ) {
+                        for (size_t i = 0; i < objs.size(); ++i) {
+                            callback->goingToDelete( objs[i] );
+                        }
+                    }
+
+                    WriteUnitOfWork wuow(txn);
+                    for (size_t i = 0; i < locs.size(); ++i) {
+                        BSONObj deletedId;
+                        collection->deleteDocument( txn, locs[i], false, false, &deletedId );
+                    }
+                    wuow.commit();
+                    attempt = 1;
+                }
+                catch (const WriteConflictException&) {
+                    // Nothing in the batch was deleted, so it is collected again.
+                    WriteConflictException::logAndBackoff(attempt++, "removeRange", ns);
+                    done = false;
+                    continue;
+                }
 
-                BSONObj deletedId;
-                collection->deleteDocument( txn, rloc, false, false, &deletedId );
-                wuow.commit();
-                numDeleted++;
+                batchDeleted = locs.size();
+                numDeleted += batchDeleted;
+                for (size_t i = 0; i < objs.size(); ++i) {
+                    bytesDeleted += objs[i].objsize();
+                }
             }
 
             // TODO remove once the yielding below that references this timer has been removed
             Timer secondaryThrottleTime;
 
-            if (writeConcern.shouldWaitForOtherNodes() && numDeleted > 0) {
+            if (writeConcern.shouldWaitForOtherNodes() && batchDeleted > 0) {
                 repl::ReplicationCoordinator::StatusAndDuration replStatus =
                         repl::getGlobalReplicationCoordinator()->awaitReplication(
                                 txn,
@@ -161,6 +161,10 @@ namespace mongo {
          *
          * Returns -1 when no usable index exists
          *
+         * Deletes rangeDeleterBatchSize documents per storage transaction, waits for
+         * secondaryThrottle after each batch, and sleeps between batches to stay under
+         * rangeDeleterMaxDocsPerSecond and rangeDeleterMaxBytesPerSecond.
+         *
          * Does oplog the individual document deletions.
          * // TODO: Refactor this mechanism, it is growing too large
          */
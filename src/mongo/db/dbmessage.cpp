@@ -176,7 +176,7 @@ namespace mongo {
                       int nReturned, int startingFrom,
                       long long cursorId 
                       ) {
-        BufBuilder b(32768);
+        PooledBufBuilder b(32768);
         b.skip(sizeof(QueryResult::Value));
         b.appendBuf(data, size);
         QueryResult::View qr = b.buf();
@@ -186,8 +186,9 @@ namespace mongo {
         qr.setCursorId(cursorId);
         qr.setStartingFrom(startingFrom);
         qr.setNReturned(nReturned);
+        Message resp;
+        resp.setPooledData(qr.view2ptr(), b.getSize());
         b.decouple();
-        Message resp(qr.view2ptr(), true);
         p->reply(requestMsg, resp, requestMsg.header().getId());
     }
 
@@ -207,13 +208,12 @@ namespace mongo {
     }
 
     void replyToQuery( int queryResultFlags, Message& response, const BSONObj& resultObj ) {
-        BufBuilder bufBuilder;
+        PooledBufBuilder bufBuilder;
         bufBuilder.skip( sizeof( QueryResult::Value ));
         bufBuilder.appendBuf( reinterpret_cast< void *>(
                 const_cast< char* >( resultObj.objdata() )), resultObj.objsize() );
 
         QueryResult::View queryResult = bufBuilder.buf();
-        bufBuilder.decouple();
 
         queryResult.setResultFlags(queryResultFlags);
         queryResult.msgdata().setLen(bufBuilder.len());
@@ -222,7 +222,9 @@ namespace mongo {
         queryResult.setStartingFrom(0);
         queryResult.setNReturned(1);
 
-        response.setData( queryResult.view2ptr(), true ); // transport will free
+        // transport will give the buffer back to the pool
+        response.setPooledData( queryResult.view2ptr(), bufBuilder.getSize() );
+        bufBuilder.decouple();
     }
 
 }
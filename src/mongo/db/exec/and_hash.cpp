@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/and_hash.h"
 
+#include <algorithm>
+
 #include "mongo/db/exec/and_common-inl.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -41,6 +43,15 @@ namespace {
     // Stage execution will fail once size of all buffered data exceeds this threshold.
     const size_t kDefaultMaxMemUsageBytes = 32 * 1024 * 1024;
 
+    // Flags of the RecordIds kept in compact mode: whether the child being read has returned the
+    // RecordId (or, for the last child, whether it was returned already), and whether it was
+    // invalidated.
+    const unsigned char kCompactSeen = 1;
+    const unsigned char kCompactInvalidated = 2;
+
+    // The memory each RecordId kept in compact mode counts for.
+    const size_t kCompactBytesPerLoc = sizeof(mongo::RecordId) + 1;
+
 } // namespace
 
 namespace mongo {
@@ -59,6 +70,8 @@ namespace mongo {
         : _collection(collection),
           _ws(ws),
           _filter(filter),
+          _compactAllowed(false),
+          _compact(false),
           _hashingChildren(true),
           _currentChild(0),
           _commonStats(kStageType),
@@ -72,6 +85,8 @@ namespace mongo {
         : _collection(collection),
           _ws(ws),
           _filter(filter),
+          _compactAllowed(false),
+          _compact(false),
           _hashingChildren(true),
           _currentChild(0),
           _commonStats(kStageType),
@@ -84,6 +99,11 @@ namespace mongo {
 
     void AndHashStage::addChild(PlanStage* child) { _children.push_back(child); }
 
+    void AndHashStage::allowCompactBuildSide() {
+        invariant(NULL == _filter);
+        _compactAllowed = true;
+    }
+
     size_t AndHashStage::getMemUsage() const {
         return _memUsage;
     }
@@ -98,7 +118,7 @@ namespace mongo {
         // Or we're streaming in results from the last child.
 
         // If there's nothing to probe against, we're EOF.
-        if (_dataMap.empty()) { return true; }
+        if (buildSideEmpty()) { return true; }
 
         // Otherwise, we're done when the last child is done.
         invariant(_children.size() >= 2);
@@ -109,8 +129,8 @@ namespace mongo {
     PlanStage::StageState AndHashStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -180,7 +200,11 @@ namespace mongo {
 
         // We read the first child into our hash table.
         if (_hashingChildren) {
-            // Check memory usage of previously hashed results.
+            // Check memory usage of previously hashed results. If we may, keep just their
+            // RecordIds instead.
+            if (_memUsage > _maxMemUsage && _compactAllowed && !_compact) {
+                switchToCompact();
+            }
             if (_memUsage > _maxMemUsage) {
                 mongoutils::str::stream ss;
                 ss << "hashed AND stage buffered data usage of " << _memUsage
@@ -208,7 +232,7 @@ namespace mongo {
         // hash map.
 
         // We should be EOF if we're not hashing results and the dataMap is empty.
-        verify(!_dataMap.empty());
+        verify(!buildSideEmpty());
 
         // We probe _dataMap with the last child.
         verify(_currentChild == _children.size() - 1);
@@ -229,6 +253,22 @@ namespace mongo {
             return PlanStage::NEED_TIME;
         }
 
+        if (_compact) {
+            // Return the child's output if it was in every previous child, and hasn't been
+            // returned or invalidated since.
+            const ptrdiff_t pos = findCompact(member->loc);
+            if (pos < 0 || _compactFlags[pos]) {
+                _ws->free(*out);
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+            _compactFlags[pos] = kCompactSeen;
+
+            // There's no filter in compact mode.
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+
         DataMap::iterator it = _dataMap.find(member->loc);
         if (_dataMap.end() == it) {
             // Child's output wasn't in every previous child.  Throw it out.
@@ -288,6 +328,15 @@ namespace mongo {
                 return PlanStage::NEED_TIME;
             }
 
+            if (_compact) {
+                // Duplicates are dropped when the RecordIds are sorted.
+                _compactLocs.push_back(member->loc);
+                _ws->free(id);
+                _memUsage += kCompactBytesPerLoc;
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+
             if (!_dataMap.insert(std::make_pair(member->loc, id)).second) {
                 // Didn't insert because we already had this loc inside the map. This should only
                 // happen if we're seeing a newer copy of the same doc in a more recent snapshot.
@@ -307,14 +356,19 @@ namespace mongo {
             // Done reading child 0.
             _currentChild = 1;
 
+            if (_compact) {
+                sortCompactLocs();
+            }
+
             // If our first child was empty, don't scan any others, no possible results.
-            if (_dataMap.empty()) {
+            if (buildSideEmpty()) {
                 _hashingChildren = false;
                 return PlanStage::IS_EOF;
             }
 
             ++_commonStats.needTime;
-            _specificStats.mapAfterChild.push_back(_dataMap.size());
+            _specificStats.mapAfterChild.push_back(_compact ? _compactLocs.size()
+                                                            : _dataMap.size());
 
             return PlanStage::NEED_TIME;
         }
@@ -361,7 +415,13 @@ namespace mongo {
             }
 
             verify(member->hasLoc());
-            if (_dataMap.end() == _dataMap.find(member->loc)) {
+            if (_compact) {
+                const ptrdiff_t pos = findCompact(member->loc);
+                if (pos >= 0) {
+                    _compactFlags[pos] |= kCompactSeen;
+                }
+            }
+            else if (_dataMap.end() == _dataMap.find(member->loc)) {
                 // Ignore.  It's not in any previous child.
             }
             else {
@@ -383,6 +443,19 @@ namespace mongo {
             // Finished with a child.
             ++_currentChild;
 
+            if (_compact) {
+                // Keep the RecordIds the child returned, unless they were invalidated.
+                size_t kept = 0;
+                for (size_t i = 0; i < _compactLocs.size(); ++i) {
+                    if (kCompactSeen == _compactFlags[i]) {
+                        _compactLocs[kept++] = _compactLocs[i];
+                    }
+                }
+                _compactLocs.resize(kept);
+                _compactFlags.assign(kept, 0);
+                _memUsage = kept * kCompactBytesPerLoc;
+            }
+
             // Keep elements of _dataMap that are in _seenMap.
             DataMap::iterator it = _dataMap.begin();
             while (it != _dataMap.end()) {
@@ -400,14 +473,15 @@ namespace mongo {
                 else { ++it; }
             }
 
-            _specificStats.mapAfterChild.push_back(_dataMap.size());
+            _specificStats.mapAfterChild.push_back(_compact ? _compactLocs.size()
+                                                            : _dataMap.size());
 
             _seenMap.clear();
 
             // _dataMap is now the intersection of the first _currentChild nodes.
 
             // If we have nothing to AND with after finishing any child, stop.
-            if (_dataMap.empty()) {
+            if (buildSideEmpty()) {
                 _hashingChildren = false;
                 return PlanStage::IS_EOF;
             }
@@ -447,6 +521,63 @@ namespace mongo {
         }
     }
 
+    void AndHashStage::switchToCompact() {
+        _compact = true;
+        _specificStats.compact = true;
+
+        _compactLocs.reserve(_dataMap.size());
+        for (DataMap::const_iterator it = _dataMap.begin(); it != _dataMap.end(); ++it) {
+            _compactLocs.push_back(it->first);
+            _ws->free(it->second);
+        }
+        _dataMap.clear();
+        _memUsage = _compactLocs.size() * kCompactBytesPerLoc;
+
+        // Past the first child, the RecordIds are sorted and flagged with what the child being
+        // read has returned so far.
+        if (_currentChild > 0) {
+            sortCompactLocs();
+            for (SeenMap::const_iterator it = _seenMap.begin(); it != _seenMap.end(); ++it) {
+                const ptrdiff_t pos = findCompact(*it);
+                if (pos >= 0) {
+                    _compactFlags[pos] = kCompactSeen;
+                }
+            }
+            _seenMap.clear();
+        }
+    }
+
+    void AndHashStage::sortCompactLocs() {
+        std::sort(_compactLocs.begin(), _compactLocs.end());
+        _compactLocs.erase(std::unique(_compactLocs.begin(), _compactLocs.end()),
+                           _compactLocs.end());
+        if (!_compactInvalidated.empty()) {
+            _compactLocs.erase(std::remove_if(_compactLocs.begin(),
+                                              _compactLocs.end(),
+                                              [this](const RecordId& loc) {
+                                                  return _compactInvalidated.count(loc) > 0;
+                                              }),
+                               _compactLocs.end());
+            _compactInvalidated.clear();
+        }
+        _compactFlags.assign(_compactLocs.size(), 0);
+        _memUsage = _compactLocs.size() * kCompactBytesPerLoc;
+    }
+
+    ptrdiff_t AndHashStage::findCompact(const RecordId& loc) const {
+        std::vector<RecordId>::const_iterator it = std::lower_bound(_compactLocs.begin(),
+                                                                    _compactLocs.end(),
+                                                                    loc);
+        if (_compactLocs.end() == it || *it != loc) {
+            return -1;
+        }
+        return it - _compactLocs.begin();
+    }
+
+    bool AndHashStage::buildSideEmpty() const {
+        return _compact ? _compactLocs.empty() : _dataMap.empty();
+    }
+
     void AndHashStage::saveState() {
         ++_commonStats.yields;
 
@@ -485,6 +616,20 @@ namespace mongo {
             }
         }
 
+        if (_compact) {
+            // We don't have a WSM to flag, so just forget about the RecordId.
+            if (0 == _currentChild) {
+                _compactInvalidated.insert(dl);
+            }
+            else {
+                const ptrdiff_t pos = findCompact(dl);
+                if (pos >= 0) {
+                    _compactFlags[pos] |= kCompactInvalidated;
+                }
+            }
+            return;
+        }
+
         // If it's a deletion, we have to forget about the RecordId, and since the AND-ing is by
         // RecordId we can't continue processing it even with the object.
         //
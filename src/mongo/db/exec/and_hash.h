@@ -67,6 +67,14 @@ namespace mongo {
 
         void addChild(PlanStage* child);
 
+        /**
+         * Lets the stage keep only the RecordIds of the results of all but the last child once
+         * they use more than the memory limit, instead of failing. Their index keys and objects
+         * are dropped then, and only the last child's data is returned with the intersection, so
+         * this is only for stages without a filter whose results are fetched.
+         */
+        void allowCompactBuildSide();
+
         /**
          * Returns memory usage.
          * For testing only.
@@ -99,6 +107,24 @@ namespace mongo {
         StageState hashOtherChildren(WorkingSetID* out);
         StageState workChild(size_t childNo, WorkingSetID* out);
 
+        /**
+         * Replaces _dataMap and _seenMap by _compactLocs and _compactFlags, freeing the buffered
+         * WSMs.
+         */
+        void switchToCompact();
+
+        /**
+         * Sorts the RecordIds read from the first child in compact mode.
+         */
+        void sortCompactLocs();
+
+        /**
+         * Returns the position of 'loc' in the sorted _compactLocs, or -1.
+         */
+        ptrdiff_t findCompact(const RecordId& loc) const;
+
+        bool buildSideEmpty() const;
+
         // Not owned by us.
         const Collection* _collection;
 
@@ -126,6 +152,17 @@ namespace mongo {
         typedef unordered_set<RecordId, RecordId::Hasher> SeenMap;
         SeenMap _seenMap;
 
+        // Whether the stage may switch to compact mode, and whether it has. In compact mode the
+        // intersection so far is kept in _compactLocs, unsorted while reading the first child and
+        // sorted once it's done, with the flags of each RecordId in _compactFlags. RecordIds
+        // invalidated while reading the first child are kept in _compactInvalidated until it's
+        // done.
+        bool _compactAllowed;
+        bool _compact;
+        std::vector<RecordId> _compactLocs;
+        std::vector<unsigned char> _compactFlags;
+        SeenMap _compactInvalidated;
+
         // True if we're still intersecting _children[0..._children.size()-1].
         bool _hashingChildren;
 
@@ -71,10 +71,10 @@ namespace mongo {
     }
 
     Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
-        // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
+        // Adds the amount of time taken by pickBestPlan() to executionTimeNanos. There's lots of
         // execution work that happens here, so this is needed for the time accounting to
         // make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         // If we work this many times during the trial period, then we will replan the
         // query from scratch.
@@ -214,6 +214,9 @@ namespace mongo {
         // Clear out the working set. We'll start with a fresh working set.
         _ws->clear();
 
+        _collection->infoCache()->getPlanCache()->notifyOfReplan();
+        _specificStats.replanned = true;
+
         // Use the query planning module to plan the whole query.
         std::vector<QuerySolution*> rawSolutions;
         Status status = QueryPlanner::plan(*_canonicalQuery, _plannerParams, &rawSolutions);
@@ -280,8 +283,8 @@ namespace mongo {
     PlanStage::StageState CachedPlanStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
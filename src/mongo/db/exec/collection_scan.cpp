@@ -38,6 +38,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -66,6 +67,10 @@ namespace mongo {
         // Explain reports the direction of the collection scan.
         _specificStats.direction = params.direction;
 
+        if (NULL != _filter && internalQueryCompileMatchExpressions) {
+            _compiledFilter.reset(CompiledMatchExpression::compile(_filter));
+        }
+
         // We pre-allocate a WSM and use it to pass up fetch requests. This should never be used
         // for anything other than passing up NEED_YIELD. We use the loc and owned obj state, but
         // the loc isn't really pointing at any obj. The obj field of the WSM should never be used.
@@ -76,9 +81,36 @@ namespace mongo {
     PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        return doWork(out);
+    }
+
+    PlanStage::StageState CollectionScan::workBatch(size_t maxWorks,
+                                        std::vector<WorkingSetID>* results,
+                                        WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        const size_t numBefore = results->size();
+        for (size_t i = 0; i < maxWorks; ++i) {
+            ++_commonStats.works;
+
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            const StageState state = doWork(&id);
+            if (PlanStage::ADVANCED == state) {
+                results->push_back(id);
+            }
+            else if (PlanStage::NEED_TIME != state) {
+                *out = id;
+                return state;
+            }
+        }
+        return results->size() > numBefore ? PlanStage::ADVANCED : PlanStage::NEED_TIME;
+    }
 
+    PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         if (_isDead) { 
             Status status(ErrorCodes::InternalError, "CollectionScan died");
             *out = WorkingSetCommon::allocateStatusMember(_workingSet, status);
@@ -97,6 +129,7 @@ namespace mongo {
             if (needToMakeCursor) {
                 const bool forward = _params.direction == CollectionScanParams::FORWARD;
                 _cursor = _params.collection->getCursor(_txn, forward);
+                _shortLivedData = _cursor->allowShortLivedData();
 
                 if (!_lastSeenId.isNull()) {
                     invariant(_params.tailable);
@@ -175,12 +208,26 @@ namespace mongo {
                                                           WorkingSetID* out) {
         ++_specificStats.docsTested;
 
-        if (Filter::passes(member, _filter)) {
+        // A document in storage engine memory which only lives until the cursor's next call is
+        // copied if, and only if, we pass it on.
+        const bool inPlace = !member->obj.value().isOwned();
+
+        if (Filter::passes(member, _filter, _compiledFilter.get())) {
+            if (inPlace && _shortLivedData) {
+                member->obj.setValue(member->obj.value().getOwned());
+            }
+            else if (inPlace) {
+                ++_specificStats.copiesAvoided;
+            }
+
             *out = memberID;
             ++_commonStats.advanced;
             return PlanStage::ADVANCED;
         }
         else {
+            if (inPlace) {
+                ++_specificStats.copiesAvoided;
+            }
             _workingSet->free(memberID);
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
@@ -33,6 +33,7 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/summary_access_method.h"
 
 namespace mongo {
 
@@ -46,19 +47,25 @@ namespace mongo {
                            Collection* collection,
                            const CountRequest& request,
                            WorkingSet* ws,
-                           PlanStage* child)
+                           PlanStage* child,
+                           const std::string& summaryIndex,
+                           const MatchExpression* summaryFilter)
         : _txn(txn),
           _collection(collection),
           _request(request),
           _leftToSkip(request.getSkip()),
           _ws(ws),
           _child(child),
-          _commonStats(kStageType) { }
+          _summaryFilter(summaryFilter),
+          _summaryCounted(false),
+          _commonStats(kStageType) {
+        _specificStats.summaryIndex = summaryIndex;
+    }
 
     CountStage::~CountStage() { }
 
     bool CountStage::isEOF() {
-        if (_specificStats.trivialCount) {
+        if (_specificStats.trivialCount || _summaryCounted) {
             return true;
         }
 
@@ -69,36 +76,57 @@ namespace mongo {
         return NULL != _child.get() && _child->isEOF();
     }
 
-    void CountStage::trivialCount() {
-        invariant(_collection);
-        long long nCounted = _collection->numRecords(_txn);
-
-        if (0 != _request.getSkip()) {
-            nCounted -= _request.getSkip();
-            if (nCounted < 0) {
-                nCounted = 0;
+    namespace {
+        // Applies the skip and limit of 'request' to a count of all the matching documents.
+        long long applySkipAndLimit(const CountRequest& request, long long nCounted) {
+            if (0 != request.getSkip()) {
+                nCounted -= request.getSkip();
+                if (nCounted < 0) {
+                    nCounted = 0;
+                }
             }
-        }
 
-        long long limit = _request.getLimit();
-        if (limit < 0) {
-            limit = -limit;
-        }
+            long long limit = request.getLimit();
+            if (limit < 0) {
+                limit = -limit;
+            }
 
-        if (limit < nCounted && 0 != limit) {
-            nCounted = limit;
+            if (limit < nCounted && 0 != limit) {
+                nCounted = limit;
+            }
+            return nCounted;
         }
+    }  // namespace
 
-        _specificStats.nCounted = nCounted;
+    void CountStage::trivialCount() {
+        invariant(_collection);
+        _specificStats.nCounted = applySkipAndLimit(_request, _collection->numRecords(_txn));
         _specificStats.nSkipped = _request.getSkip();
         _specificStats.trivialCount = true;
     }
 
+    bool CountStage::summaryCount() {
+        invariant(_collection);
+        invariant(_summaryFilter);
+        IndexCatalog* catalog = _collection->getIndexCatalog();
+        const IndexDescriptor* desc = catalog->findIndexByName(_txn, _specificStats.summaryIndex);
+        if (NULL == desc) {
+            return false;
+        }
+        const SummaryAccessMethod* sam =
+            static_cast<const SummaryAccessMethod*>(catalog->getIndex(desc));
+        _specificStats.nCounted = applySkipAndLimit(_request,
+                                                    sam->countMatching(_summaryFilter));
+        _specificStats.nSkipped = _request.getSkip();
+        _summaryCounted = true;
+        return true;
+    }
+
     PlanStage::StageState CountStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         // This stage never returns a working set member.
         *out = WorkingSet::INVALID_ID;
@@ -110,6 +138,17 @@ namespace mongo {
             return PlanStage::IS_EOF;
         }
 
+        if (!_specificStats.summaryIndex.empty() && !_summaryCounted) {
+            if (!summaryCount()) {
+                Status status(ErrorCodes::OperationFailed,
+                              "summary index dropped: " + _specificStats.summaryIndex);
+                *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+                return PlanStage::FAILURE;
+            }
+            _commonStats.isEOF = true;
+            return PlanStage::IS_EOF;
+        }
+
         if (isEOF()) {
             _commonStats.isEOF = true;
             return PlanStage::IS_EOF;
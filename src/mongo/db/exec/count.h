@@ -29,11 +29,15 @@
 #pragma once
 
 
+#include <string>
+
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/query/count_request.h"
 
 namespace mongo {
 
+    class MatchExpression;
+
     /**
      * Stage used by the count command. This stage sits at the root of a plan tree
      * and counts the number of results returned by its child stage.
@@ -44,6 +48,10 @@ namespace mongo {
      *
      * Only returns NEED_TIME until hitting EOF. The count result can be obtained by examining
      * the specific stats.
+     *
+     * Given the name of a summary index and a filter for which it can match groups, the stage
+     * has no child and counts the documents matching the filter from the groups of the index.
+     * The filter is not owned and must outlive the stage.
      */
     class CountStage : public PlanStage {
     public:
@@ -51,7 +59,9 @@ namespace mongo {
                    Collection* collection,
                    const CountRequest& request,
                    WorkingSet* ws,
-                   PlanStage* child);
+                   PlanStage* child,
+                   const std::string& summaryIndex = std::string(),
+                   const MatchExpression* summaryFilter = NULL);
 
         virtual ~CountStage();
 
@@ -81,6 +91,12 @@ namespace mongo {
          */
         void trivialCount();
 
+        /**
+         * Computes the count from the groups of the summary index, applying the skip and limit
+         * like trivialCount(). Returns false if the index was dropped.
+         */
+        bool summaryCount();
+
         // Transactional context for read locks. Not owned by us.
         OperationContext* _txn;
 
@@ -98,6 +114,10 @@ namespace mongo {
 
         std::unique_ptr<PlanStage> _child;
 
+        // Set to count from the groups of the summary index named in '_specificStats'
+        const MatchExpression* _summaryFilter;
+        bool _summaryCounted;
+
         CommonStats _commonStats;
         CountStats _specificStats;
     };
@@ -29,6 +29,7 @@
 #include "mongo/db/exec/count_scan.h"
 
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/index/index_descriptor.h"
 
@@ -47,6 +48,7 @@ namespace mongo {
           _workingSet(workingSet),
           _descriptor(params.descriptor),
           _iam(params.descriptor->getIndexCatalog()->getIndex(params.descriptor)),
+          _needSeek(false),
           _shouldDedup(params.descriptor->isMultikey(txn)),
           _params(params),
           _commonStats(kStageType) {
@@ -57,9 +59,12 @@ namespace mongo {
         _specificStats.isSparse = _params.descriptor->isSparse();
         _specificStats.isPartial = _params.descriptor->isPartial();
         _specificStats.indexVersion = _params.descriptor->version();
+        if (_params.useBounds) {
+            _specificStats.indexBounds = _params.bounds.toBSON();
+        }
 
         // endKey must be after startKey in index order since we only do forward scans.
-        dassert(_params.startKey.woCompare(_params.endKey,
+        dassert(_params.useBounds || _params.startKey.woCompare(_params.endKey,
                                            Ordering::make(params.descriptor->keyPattern()),
                                            /*compareFieldNames*/false) <= 0);
     }
@@ -69,24 +74,41 @@ namespace mongo {
         ++_commonStats.works;
         if (_commonStats.isEOF) return PlanStage::IS_EOF;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         boost::optional<IndexKeyEntry> entry;
         const bool needInit = !_cursor;
         try {
-            // We don't care about the keys.
-            const auto kWantLoc = SortedDataInterface::Cursor::kWantLoc;
+            // We only care about the keys when we have to check them against bounds or a filter.
+            const auto parts = (_params.useBounds || _params.filter)
+                             ? SortedDataInterface::Cursor::kKeyAndLoc
+                             : SortedDataInterface::Cursor::kWantLoc;
 
             if (needInit) {
                 // First call to work().  Perform cursor init.
-                _cursor = _iam->newCursor(_txn);
-                _cursor->setEndPosition(_params.endKey, _params.endKeyInclusive);
-
-                entry = _cursor->seek(_params.startKey, _params.startKeyInclusive, kWantLoc);
+                if (_params.useBounds) {
+                    _cursor = _iam->newCursor(_txn, _params.direction == 1);
+                    _checker.reset(new IndexBoundsChecker(&_params.bounds,
+                                                          _descriptor->keyPattern(),
+                                                          _params.direction));
+                    if (_checker->getStartSeekPoint(&_seekPoint)) {
+                        entry = _cursor->seek(_seekPoint, parts);
+                    }
+                }
+                else {
+                    _cursor = _iam->newCursor(_txn);
+                    _cursor->setEndPosition(_params.endKey, _params.endKeyInclusive);
+
+                    entry = _cursor->seek(_params.startKey, _params.startKeyInclusive, parts);
+                }
+            }
+            else if (_needSeek) {
+                entry = _cursor->seek(_seekPoint, parts);
+                _needSeek = false;
             }
             else {
-                entry = _cursor->next(kWantLoc);
+                entry = _cursor->next(parts);
             }
         }
         catch (const WriteConflictException& wce) {
@@ -100,12 +122,34 @@ namespace mongo {
 
         ++_specificStats.keysExamined;
 
+        if (entry && _checker) {
+            switch (_checker->checkKey(entry->key, &_seekPoint)) {
+            case IndexBoundsChecker::VALID:
+                break;
+
+            case IndexBoundsChecker::DONE:
+                entry = boost::none;
+                break;
+
+            case IndexBoundsChecker::MUST_ADVANCE:
+                _needSeek = true;
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+        }
+
         if (!entry) {
             _commonStats.isEOF = true;
             _cursor.reset();
             return PlanStage::IS_EOF;
         }
 
+        if (_params.filter
+            && !Filter::passes(entry->key, _descriptor->keyPattern(), _params.filter)) {
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
         if (_shouldDedup && !_returned.insert(entry->loc).second) {
             // *loc was already in _returned.
             ++_commonStats.needTime;
@@ -162,10 +206,18 @@ namespace mongo {
     }
 
     PlanStageStats* CountScan::getStats() {
+        // Add a BSON representation of the filter to the stats tree, if there is one.
+        if (NULL != _params.filter) {
+            BSONObjBuilder bob;
+            _params.filter->toBSON(&bob);
+            _commonStats.filter = bob.obj();
+        }
+
         unique_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_COUNT_SCAN));
 
         CountScanStats* countStats = new CountScanStats(_specificStats);
         countStats->keyPattern = _specificStats.keyPattern.getOwned();
+        countStats->indexBounds = _specificStats.indexBounds.getOwned();
         ret->specific.reset(countStats);
 
         return ret.release();
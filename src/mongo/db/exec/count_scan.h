@@ -34,6 +34,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
 #include "mongo/platform/unordered_set.h"
 
@@ -44,7 +45,12 @@ namespace mongo {
     class WorkingSet;
 
     struct CountScanParams {
-        CountScanParams() : descriptor(NULL) { }
+        CountScanParams() : descriptor(NULL),
+                            startKeyInclusive(true),
+                            endKeyInclusive(true),
+                            useBounds(false),
+                            direction(1),
+                            filter(NULL) { }
 
         // What index are we traversing?
         const IndexDescriptor* descriptor;
@@ -54,12 +60,24 @@ namespace mongo {
 
         BSONObj endKey;
         bool endKeyInclusive;
+
+        // If set, 'bounds' are scanned in 'direction' instead of the range from 'startKey' to
+        // 'endKey'.  Used for bounds with more than one interval, such as those of an $in or of a
+        // predicate on a trailing field only.
+        bool useBounds;
+        IndexBounds bounds;
+        int direction;
+
+        // Keys which don't match are not counted.  Only refers to fields of the index key.  Not
+        // owned.  May be NULL.
+        const MatchExpression* filter;
     };
 
     /**
-     * Used by the count command.  Scans an index from a start key to an end key.  Does not create
-     * any WorkingSetMember(s) for any of the data, instead returning ADVANCED to indicate to the
-     * caller that another result should be counted.
+     * Used by the count command.  Scans an index from a start key to an end key, or over
+     * arbitrary index bounds, counting the keys which match an optional key-only filter.  Does
+     * not create any WorkingSetMember(s) for any of the data, instead returning ADVANCED to
+     * indicate to the caller that another result should be counted.
      *
      * Only created through the getExecutorCount path, as count is the only operation that doesn't
      * care about its data.
@@ -100,6 +118,11 @@ namespace mongo {
 
         std::unique_ptr<SortedDataInterface::Cursor> _cursor;
 
+        // Set when scanning '_params.bounds', to skip over the keys outside of them.
+        std::unique_ptr<IndexBoundsChecker> _checker;
+        IndexSeekPoint _seekPoint;
+        bool _needSeek;
+
         // Could our index have duplicates?  If so, we use _returned to dedup.
         bool _shouldDedup;
         unordered_set<RecordId, RecordId::Hasher> _returned;
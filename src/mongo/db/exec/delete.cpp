@@ -32,6 +32,8 @@
 
 #include "mongo/db/exec/delete.h"
 
+#include <set>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -40,6 +42,7 @@
 #include "mongo/db/op_observer.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
@@ -48,6 +51,16 @@ namespace mongo {
     using std::unique_ptr;
     using std::vector;
 
+    // The most documents that a multi-delete deletes in one WriteUnitOfWork. 1 turns batching off.
+    MONGO_EXPORT_SERVER_PARAMETER(internalDeleteMaxBatchSize, int, 64);
+
+    namespace {
+
+        // The documents of a batch are held in memory until it's deleted.
+        const size_t kDeleteBatchMaxBytes = 4 * 1024 * 1024;
+
+    }  // namespace
+
     // static
     const char* DeleteStage::kStageType = "DELETE";
 
@@ -63,6 +76,10 @@ namespace mongo {
           _child(child),
           _idRetrying(WorkingSet::INVALID_ID),
           _idReturning(WorkingSet::INVALID_ID),
+          _batched(params.isMulti && !params.returnDeleted && !params.isExplain &&
+                   internalDeleteMaxBatchSize > 1),
+          _batchBytes(0),
+          _inFlush(false),
           _commonStats(kStageType) { }
 
     DeleteStage::~DeleteStage() {}
@@ -76,14 +93,20 @@ namespace mongo {
         }
         return _idRetrying == WorkingSet::INVALID_ID
             && _idReturning == WorkingSet::INVALID_ID
+            && _batch.empty()
             && _child->isEOF();
     }
 
+    bool DeleteStage::batchIsFull() const {
+        return _batch.size() >= static_cast<size_t>(internalDeleteMaxBatchSize) ||
+               _batchBytes >= kDeleteBatchMaxBytes;
+    }
+
     PlanStage::StageState DeleteStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
         invariant(_collection); // If isEOF() returns false, we must have a collection.
@@ -103,6 +126,10 @@ namespace mongo {
             return PlanStage::ADVANCED;
          }
 
+        if (!_batch.empty() && (batchIsFull() || _child->isEOF())) {
+            return flushBatch(out);
+        }
+
         // Either retry the last WSM we worked on or get a new one from our child.
         WorkingSetID id;
         StageState status;
@@ -133,6 +160,18 @@ namespace mongo {
             // a fetch. We should always get fetched data, and never just key data.
             invariant(member->hasObj());
 
+            if (_batched) {
+                // flushBatch() checks that the document still matches, if need be.
+                memberFreer.Dismiss();
+                _batch.push_back(id);
+                _batchBytes += member->obj.value().objsize();
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+
+            // Set once our child is saved for the write. A write conflict after that point may
+            // skip the document.
+            bool childSaved = false;
             try {
                 // If the snapshot changed, then we have to make sure we have the latest copy of the
                 // doc and that it still matches.
@@ -154,9 +193,6 @@ namespace mongo {
                     }
                 }
 
-                // TODO: Do we want to buffer docs and delete them in a group rather than
-                // saving/restoring state repeatedly?
-
                 try {
                     _child->saveState();
                     if (supportsDocLocking()) {
@@ -164,6 +200,7 @@ namespace mongo {
                         // invalidations.
                         WorkingSetCommon::prepareForSnapshotChange(_ws);
                     }
+                    childSaved = true;
                 }
                 catch ( const WriteConflictException& wce ) {
                     std::terminate();
@@ -194,6 +231,23 @@ namespace mongo {
                 ++_specificStats.docsDeleted;
             }
             catch ( const WriteConflictException& wce ) {
+                if (childSaved && _params.skipLocked && !_params.isMulti) {
+                    // Someone else is modifying this document, so leave it to them and go on
+                    // with the next one in the snapshot we'll open now.
+                    ++_specificStats.nSkippedLocked;
+                    _txn->recoveryUnit()->abandonSnapshot();
+                    try {
+                        _child->restoreState(_txn);
+                    }
+                    catch ( const WriteConflictException& wce ) {
+                        *out = WorkingSet::INVALID_ID;
+                        _commonStats.needYield++;
+                        return NEED_YIELD;
+                    }
+                    ++_commonStats.needTime;
+                    return PlanStage::NEED_TIME;
+                }
+
                 _idRetrying = id;
                 memberFreer.Dismiss(); // Keep this member around so we can retry deleting it.
                 *out = WorkingSet::INVALID_ID;
@@ -259,6 +313,93 @@ namespace mongo {
         return status;
     }
 
+    PlanStage::StageState DeleteStage::flushBatch(WorkingSetID* out) {
+        try {
+            _child->saveState();
+            if (supportsDocLocking()) {
+                // Doc-locking engines require this after saveState() since they don't use
+                // invalidations.
+                WorkingSetCommon::prepareForSnapshotChange(_ws);
+            }
+        }
+        catch ( const WriteConflictException& wce ) {
+            std::terminate();
+        }
+
+        std::vector<RecordId> locs;
+        size_t invalidateSkips = 0;
+        try {
+            // If the snapshot changed since a document was read, then we have to make sure we
+            // have the latest copy of it and that it still matches.
+            std::unique_ptr<RecordCursor> cursor;
+            std::set<RecordId> seen;
+            for (size_t i = 0; i < _batch.size(); ++i) {
+                WorkingSetMember* member = _ws->get(_batch[i]);
+                if (!member->hasLoc()) {
+                    // Invalidated while it was waiting in the batch.
+                    ++invalidateSkips;
+                    continue;
+                }
+
+                if (_txn->recoveryUnit()->getSnapshotId() != member->obj.snapshotId()) {
+                    if (!cursor) {
+                        cursor = _collection->getCursor(_txn);
+                    }
+                    if (!WorkingSetCommon::fetch(_txn, member, cursor)) {
+                        // Doc is already deleted.
+                        continue;
+                    }
+                    if (_params.canonicalQuery &&
+                        !_params.canonicalQuery->root()->matchesBSON(member->obj.value(), NULL)) {
+                        continue;
+                    }
+                }
+
+                if (seen.insert(member->loc).second) {
+                    locs.push_back(member->loc);
+                }
+            }
+
+            if (!locs.empty()) {
+                _inFlush = true;
+                ON_BLOCK_EXIT([this] { _inFlush = false; });
+
+                WriteUnitOfWork wunit(_txn);
+                const bool deleteNoWarn = false;
+                _collection->deleteDocuments(_txn, locs, deleteNoWarn);
+                wunit.commit();
+            }
+        }
+        catch ( const WriteConflictException& wce ) {
+            // Keep the batch to retry deleting it.
+            *out = WorkingSet::INVALID_ID;
+            _commonStats.needYield++;
+            return NEED_YIELD;
+        }
+
+        _specificStats.docsDeleted += locs.size();
+        _specificStats.nInvalidateSkips += invalidateSkips;
+        for (size_t i = 0; i < _batch.size(); ++i) {
+            _ws->free(_batch[i]);
+        }
+        _batch.clear();
+        _batchBytes = 0;
+
+        // See work() for why this happens outside of the WriteUnitOfWork.
+        try {
+            _child->restoreState(_txn);
+        }
+        catch ( const WriteConflictException& wce ) {
+            // The batch was committed, so there is nothing to retry.
+            *out = WorkingSet::INVALID_ID;
+            _commonStats.needYield++;
+            return NEED_YIELD;
+        }
+
+        ++_commonStats.needTime;
+        return PlanStage::NEED_TIME;
+    }
+
     void DeleteStage::saveState() {
         _txn = NULL;
         ++_commonStats.yields;
@@ -280,6 +421,18 @@ namespace mongo {
 
     void DeleteStage::invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {
         ++_commonStats.invalidates;
+
+        // Members waiting in the batch keep the document but won't be deleted, just like those
+        // our child force-fetches.
+        if (!_inFlush) {
+            for (size_t i = 0; i < _batch.size(); ++i) {
+                WorkingSetMember* member = _ws->get(_batch[i]);
+                if (member->hasLoc() && member->loc == dl) {
+                    WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+                }
+            }
+        }
+
         _child->invalidate(txn, dl, type);
     }
 
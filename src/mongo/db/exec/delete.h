@@ -29,6 +29,8 @@
 #pragma once
 
 
+#include <vector>
+
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
 
@@ -45,6 +47,7 @@ namespace mongo {
             fromMigrate(false),
             isExplain(false),
             returnDeleted(false),
+            skipLocked(false),
             canonicalQuery(NULL) { }
 
         // Should we delete all documents returned from the child (a "multi delete"), or at most one
@@ -64,6 +67,10 @@ namespace mongo {
         // Should we return the document we just deleted?
         bool returnDeleted;
 
+        // Should a single delete move on to the next document when it gets a write conflict,
+        // rather than yield and retry? Another operation is then modifying the document.
+        bool skipLocked;
+
         // The parsed query predicate for this delete. Not owned here.
         CanonicalQuery* canonicalQuery;
     };
@@ -73,6 +80,10 @@ namespace mongo {
      * document was requested to be returned, then ADVANCED is returned after deleting a document.
      * Otherwise, NEED_TIME is returned after deleting a document.
      *
+     * Multi-deletes which don't return the deleted documents hold on to the members they get from
+     * their child and delete them in batches, each in one WriteUnitOfWork with their index keys
+     * removed in key order.
+     *
      * Callers of work() must be holding a write lock (and, for shouldCallLogOp=true deletes,
      * callers must have had the replication coordinator approve the write).
      */
@@ -113,6 +124,14 @@ namespace mongo {
         static long long getNumDeleted(PlanExecutor* exec);
 
     private:
+        bool batchIsFull() const;
+
+        /**
+         * Deletes the documents in '_batch' that are still there and still match, in one
+         * WriteUnitOfWork. Returns NEED_YIELD on a write conflict, keeping the batch to retry.
+         */
+        StageState flushBatch(WorkingSetID* out);
+
         // Transactional context.  Not owned by us.
         OperationContext* _txn;
 
@@ -134,6 +153,15 @@ namespace mongo {
         // If not WorkingSet::INVALID_ID, we return this member to our caller.
         WorkingSetID _idReturning;
 
+        // Whether documents are deleted in batches, and the members waiting to be deleted and
+        // the size of their documents if so.
+        const bool _batched;
+        std::vector<WorkingSetID> _batch;
+        size_t _batchBytes;
+
+        // Set while flushBatch() deletes, so that invalidate() ignores our own deletions.
+        bool _inFlush;
+
         // Stats
         CommonStats _commonStats;
         DeleteStats _specificStats;
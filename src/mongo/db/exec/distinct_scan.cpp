@@ -64,12 +64,15 @@ namespace mongo {
         ++_commonStats.works;
         if (_commonStats.isEOF) return PlanStage::IS_EOF;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         boost::optional<IndexKeyEntry> kv;
         try {
-            if (!_cursor) _cursor = _iam->newCursor(_txn, _params.direction == 1);
+            if (!_cursor) {
+                _cursor = _iam->newCursor(_txn, _params.direction == 1);
+                _cursor->allowUnownedKeys();
+            }
             kv = _cursor->seek(_seekPoint);
         }
         catch (const WriteConflictException& wce) {
@@ -30,11 +30,14 @@
 
 #include "mongo/db/exec/fetch.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/mongoutils/str.h"
@@ -58,7 +61,14 @@ namespace mongo {
           _child(child),
           _filter(filter),
           _idRetrying(WorkingSet::INVALID_ID),
-          _commonStats(kStageType) { }
+          _hasPendingChildState(false),
+          _pendingChildState(PlanStage::NEED_TIME),
+          _pendingChildId(WorkingSet::INVALID_ID),
+          _commonStats(kStageType) {
+        if (NULL != _filter && internalQueryCompileMatchExpressions) {
+            _compiledFilter.reset(CompiledMatchExpression::compile(_filter));
+        }
+    }
 
     FetchStage::~FetchStage() { }
 
@@ -69,73 +79,203 @@ namespace mongo {
             return false;
         }
 
+        if (!_pending.empty() || _hasPendingChildState) {
+            // Part of the child's last batch hasn't been returned yet.
+            return false;
+        }
+
         return _child->isEOF();
     }
 
     PlanStage::StageState FetchStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
-        // Either retry the last WSM we worked on or get a new one from our child.
+        // Either retry the last WSM we worked on, finish the child's last batch, or get a new
+        // one from our child.
+        if (_idRetrying != WorkingSet::INVALID_ID) {
+            WorkingSetID id = _idRetrying;
+            _idRetrying = WorkingSet::INVALID_ID;
+            return fetchChildResult(id, out);
+        }
+
+        if (!_pending.empty()) {
+            WorkingSetID id = _pending.front();
+            _pending.pop_front();
+            return fetchChildResult(id, out);
+        }
+
         WorkingSetID id;
         StageState status;
-        if (_idRetrying == WorkingSet::INVALID_ID) {
-            status = _child->work(&id);
+        if (_hasPendingChildState) {
+            _hasPendingChildState = false;
+            status = _pendingChildState;
+            id = _pendingChildId;
         }
         else {
-            status = ADVANCED;
-            id = _idRetrying;
-            _idRetrying = WorkingSet::INVALID_ID;
+            status = _child->work(&id);
         }
 
         if (PlanStage::ADVANCED == status) {
-            WorkingSetMember* member = _ws->get(id);
+            return fetchChildResult(id, out);
+        }
+
+        return returnChildState(status, id, out);
+    }
 
-            // If there's an obj there, there is no fetching to perform.
-            if (member->hasObj()) {
-                ++_specificStats.alreadyHasObj;
+    PlanStage::StageState FetchStage::workBatch(size_t maxWorks,
+                                                std::vector<WorkingSetID>* results,
+                                                WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        if (isEOF()) {
+            ++_commonStats.works;
+            return PlanStage::IS_EOF;
+        }
+
+        // Results held from the last batch come first, so that a batch never overtakes them.
+        if (_idRetrying == WorkingSet::INVALID_ID && _pending.empty() && !_hasPendingChildState) {
+            _childResults.clear();
+            const size_t childWorksBefore = _child->getCommonStats()->works;
+            WorkingSetID childId = WorkingSet::INVALID_ID;
+            const StageState childState = _child->workBatch(maxWorks, &_childResults, &childId);
+            const size_t childWorks = _child->getCommonStats()->works - childWorksBefore;
+
+            _commonStats.works += childWorks;
+            _commonStats.needTime += childNeedTimes(childWorks, _childResults.size(), childState);
+
+            _pending.insert(_pending.end(), _childResults.begin(), _childResults.end());
+            prefetchPending();
+            if (PlanStage::ADVANCED != childState && PlanStage::NEED_TIME != childState) {
+                _hasPendingChildState = true;
+                _pendingChildState = childState;
+                _pendingChildId = childId;
+            }
+        }
+        else {
+            ++_commonStats.works;
+        }
+
+        const size_t numBefore = results->size();
+        while (_idRetrying != WorkingSet::INVALID_ID || !_pending.empty()) {
+            WorkingSetID id = _idRetrying;
+            if (id != WorkingSet::INVALID_ID) {
+                _idRetrying = WorkingSet::INVALID_ID;
             }
             else {
-                // We need a valid loc to fetch from and this is the only state that has one.
-                verify(WorkingSetMember::LOC_AND_IDX == member->state);
-                verify(member->hasLoc());
-
-                try {
-                    if (!_cursor) _cursor = _collection->getCursor(_txn);
-
-                    if (auto fetcher = _cursor->fetcherForId(member->loc)) {
-                        // There's something to fetch. Hand the fetcher off to the WSM, and pass up
-                        // a fetch request.
-                        _idRetrying = id;
-                        member->setFetcher(fetcher.release());
-                        *out = id;
-                        _commonStats.needYield++;
-                        return NEED_YIELD;
-                    }
-
-                    // The doc is already in memory, so go ahead and grab it. Now we have a RecordId
-                    // as well as an unowned object
-                    if (!WorkingSetCommon::fetch(_txn, member, _cursor)) {
-                        _ws->free(id);
-                        _commonStats.needTime++;
-                        return NEED_TIME;
-                    }
+                id = _pending.front();
+                _pending.pop_front();
+            }
+
+            WorkingSetID resultId = WorkingSet::INVALID_ID;
+            const StageState state = fetchChildResult(id, &resultId);
+            if (PlanStage::ADVANCED == state) {
+                results->push_back(resultId);
+            }
+            else if (PlanStage::NEED_TIME != state) {
+                // The rest of the batch waits for the yield.
+                *out = resultId;
+                return state;
+            }
+        }
+
+        if (_hasPendingChildState) {
+            _hasPendingChildState = false;
+            return returnChildState(_pendingChildState, _pendingChildId, out);
+        }
+
+        return results->size() > numBefore ? PlanStage::ADVANCED : PlanStage::NEED_TIME;
+    }
+
+    void FetchStage::prefetchPending() {
+        if (_pending.size() < 2) {
+            return;
+        }
+
+        _prefetchLocs.clear();
+        for (WorkingSetID id : _pending) {
+            const WorkingSetMember* member = _ws->get(id);
+            if (!member->hasObj() && member->hasLoc()) {
+                _prefetchLocs.push_back(member->loc);
+            }
+        }
+        if (_prefetchLocs.size() < 2) {
+            return;
+        }
+        std::sort(_prefetchLocs.begin(), _prefetchLocs.end());
+
+        try {
+            if (!_cursor) {
+                _cursor = _collection->getCursor(_txn);
+                _shortLivedData = _cursor->allowShortLivedData();
+            }
+            _cursor->prefetch(_prefetchLocs);
+            _specificStats.prefetched += _prefetchLocs.size();
+        }
+        catch (const WriteConflictException& wce) {
+            // Prefetching is only a hint, fetching the results retries as usual.
+        }
+    }
+
+    PlanStage::StageState FetchStage::fetchChildResult(WorkingSetID id, WorkingSetID* out) {
+        WorkingSetMember* member = _ws->get(id);
+
+        bool fetched = false;
+
+        // If there's an obj there, there is no fetching to perform.
+        if (member->hasObj()) {
+            ++_specificStats.alreadyHasObj;
+        }
+        else {
+            // We need a valid loc to fetch from and this is the only state that has one.
+            verify(WorkingSetMember::LOC_AND_IDX == member->state);
+            verify(member->hasLoc());
+
+            try {
+                if (!_cursor) {
+                    _cursor = _collection->getCursor(_txn);
+                    _shortLivedData = _cursor->allowShortLivedData();
                 }
-                catch (const WriteConflictException& wce) {
+
+                if (auto fetcher = _cursor->fetcherForId(member->loc)) {
+                    // There's something to fetch. Hand the fetcher off to the WSM, and pass up
+                    // a fetch request.
                     _idRetrying = id;
-                    *out = WorkingSet::INVALID_ID;
+                    member->setFetcher(fetcher.release());
+                    *out = id;
                     _commonStats.needYield++;
                     return NEED_YIELD;
                 }
-            }
 
-            return returnIfMatches(member, id, out);
+                // The doc is already in memory, so go ahead and grab it. Now we have a RecordId
+                // as well as an unowned object
+                if (!WorkingSetCommon::fetch(_txn, member, _cursor)) {
+                    _ws->free(id);
+                    _commonStats.needTime++;
+                    return NEED_TIME;
+                }
+                fetched = true;
+            }
+            catch (const WriteConflictException& wce) {
+                _idRetrying = id;
+                *out = WorkingSet::INVALID_ID;
+                _commonStats.needYield++;
+                return NEED_YIELD;
+            }
         }
-        else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+
+        return returnIfMatches(member, id, out, fetched);
+    }
+
+    PlanStage::StageState FetchStage::returnChildState(StageState status,
+                                                       WorkingSetID id,
+                                                       WorkingSetID* out) {
+        if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
             *out = id;
             // If a stage fails, it may create a status WSM to indicate why it
             // failed, in which case 'id' is valid.  If ID is invalid, we
@@ -188,11 +328,22 @@ namespace mongo {
                 WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
             }
         }
+
+        // The same goes for the results still held from the child's last batch.
+        for (std::deque<WorkingSetID>::const_iterator it = _pending.begin();
+             it != _pending.end();
+             ++it) {
+            WorkingSetMember* member = _ws->get(*it);
+            if (member->hasLoc() && (member->loc == dl)) {
+                WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+            }
+        }
     }
 
     PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID memberID,
-                                                      WorkingSetID* out) {
+                                                      WorkingSetID* out,
+                                                      bool fetched) {
         // We consider "examining a document" to be every time that we pass a document through
         // a filter by calling Filter::passes(...) below. Therefore, the 'docsExamined' metric
         // is not always equal to the number of documents that were fetched from the collection.
@@ -209,13 +360,27 @@ namespace mongo {
         // predicate.
         ++_specificStats.docsExamined;
 
-        if (Filter::passes(member, _filter)) {
+        // A document fetched from storage engine memory which only lives until our cursor's
+        // next call is copied if, and only if, we pass it on.
+        const bool inPlace = fetched && !member->obj.value().isOwned();
+
+        if (Filter::passes(member, _filter, _compiledFilter.get())) {
+            if (inPlace && _shortLivedData) {
+                member->obj.setValue(member->obj.value().getOwned());
+            }
+            else if (inPlace) {
+                ++_specificStats.copiesAvoided;
+            }
+
             *out = memberID;
 
             ++_commonStats.advanced;
             return PlanStage::ADVANCED;
         }
         else {
+            if (inPlace) {
+                ++_specificStats.copiesAvoided;
+            }
             _ws->free(memberID);
 
             ++_commonStats.needTime;
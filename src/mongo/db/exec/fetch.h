@@ -28,11 +28,13 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_compiled.h"
 #include "mongo/db/record_id.h"
 
 namespace mongo {
@@ -59,6 +61,9 @@ namespace mongo {
 
         virtual bool isEOF();
         virtual StageState work(WorkingSetID* out);
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out);
 
         virtual void saveState();
         virtual void restoreState(OperationContext* opCtx);
@@ -78,12 +83,33 @@ namespace mongo {
 
     private:
 
+        /**
+         * Fetches the document of the child's result 'id', unless it already has one, and passes
+         * it through returnIfMatches(). Returns NEED_YIELD, holding on to 'id' to try again, if
+         * the document has to be paged in or the storage engine says to.
+         */
+        StageState fetchChildResult(WorkingSetID id, WorkingSetID* out);
+
+        /**
+         * Passes on a 'status' other than ADVANCED that the child returned with 'id'.
+         */
+        StageState returnChildState(StageState status, WorkingSetID id, WorkingSetID* out);
+
         /**
          * If the member (with id memberID) passes our filter, set *out to memberID and return that
          * ADVANCED.  Otherwise, free memberID and return NEED_TIME.
+         *
+         * 'fetched' says whether we just read the member's obj with '_cursor', in which case it
+         * may have to be copied before it is passed on.
          */
         StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID,
-                                   WorkingSetID* out);
+                                   WorkingSetID* out, bool fetched);
+
+        /**
+         * Tells '_cursor' which records the results in '_pending' are about to be fetched from,
+         * in RecordId order, so that the storage engine can read them ahead.
+         */
+        void prefetchPending();
 
         OperationContext* _txn;
 
@@ -93,6 +119,9 @@ namespace mongo {
         // Used to fetch Records from _collection.
         std::unique_ptr<RecordCursor> _cursor;
 
+        // Whether documents fetched with _cursor are only valid until its next call.
+        bool _shortLivedData = false;
+
         // _ws is not owned by us.
         WorkingSet* _ws;
         std::unique_ptr<PlanStage> _child;
@@ -100,9 +129,25 @@ namespace mongo {
         // The filter is not owned by us.
         const MatchExpression* _filter;
 
+        // '_filter' compiled for matching fetched documents, or NULL.
+        std::unique_ptr<CompiledMatchExpression> _compiledFilter;
+
         // If not Null, we use this rather than asking our child what to do next.
         WorkingSetID _idRetrying;
 
+        // Results of the child's last workBatch() which haven't been fetched yet, and the state
+        // which ended that batch, if any, to return once they have been.
+        std::deque<WorkingSetID> _pending;
+        bool _hasPendingChildState;
+        StageState _pendingChildState;
+        WorkingSetID _pendingChildId;
+
+        // Receives each batch from the child, kept to reuse its storage.
+        std::vector<WorkingSetID> _childResults;
+
+        // The sorted locs passed to '_cursor' by prefetchPending(), kept to reuse its storage.
+        std::vector<RecordId> _prefetchLocs;
+
         // Stats
         CommonStats _commonStats;
         FetchStats _specificStats;
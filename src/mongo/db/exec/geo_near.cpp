@@ -45,9 +45,11 @@
 #include "mongo/db/query/expression_index.h"
 #include "mongo/db/query/expression_index_knobs.h"
 #include "mongo/db/index/expression_params.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/log.h"
 
 #include <algorithm>
+#include <map>
 
 namespace mongo {
 
@@ -1012,11 +1014,44 @@ namespace mongo {
         };
     }
 
+    namespace {
+
+        // The level at which the density estimator of the last query on each 2dsphere index
+        // found a document, by index namespace. Queries on an index tend to look at data of
+        // similar density, so the next one starts searching there.
+        stdx::mutex densityLevelsMutex;
+        std::map<std::string, int> densityLevels;
+
+        // Bounds the memory for namespaces of indexes that are gone.
+        const size_t kMaxDensityLevels = 10000;
+
+        int getDensityLevel(const IndexDescriptor* s2Index, int defaultLevel) {
+            stdx::lock_guard<stdx::mutex> lk(densityLevelsMutex);
+            std::map<std::string, int>::const_iterator it =
+                densityLevels.find(s2Index->indexNamespace());
+            return (it == densityLevels.end()) ? defaultLevel : std::min(it->second, defaultLevel);
+        }
+
+        void setDensityLevel(const IndexDescriptor* s2Index, int level) {
+            stdx::lock_guard<stdx::mutex> lk(densityLevelsMutex);
+            if (densityLevels.size() >= kMaxDensityLevels) {
+                densityLevels.clear();
+            }
+            densityLevels[s2Index->indexNamespace()] = level;
+        }
+
+    }  // namespace
+
     // Estimate the density of data by search the nearest cells level by level around center.
+    //
+    // The search starts at the level where it succeeded for the previous query on the index. If
+    // there is a document already, it goes on to finer levels until there is none, otherwise to
+    // coarser levels until there is one, so it finds the same level as searching from the finest.
     class GeoNear2DSphereStage::DensityEstimator {
     public:
         DensityEstimator(const IndexDescriptor* s2Index, const GeoNearParams* nearParams) :
-            _s2Index(s2Index), _nearParams(nearParams), _currentLevel(0)
+            _s2Index(s2Index), _nearParams(nearParams), _currentLevel(0), _finestLevel(0),
+            _foundLevel(-1), _coarsening(false)
         {
             S2IndexingParams params;
             ExpressionParams::parse2dsphereParams(_s2Index->infoObj(), &params);
@@ -1024,7 +1059,8 @@ namespace mongo {
             // we have to start to find documents at most S2::kMaxCellLevel - 1. Thus the finest
             // search area is 16 * finest cell area at S2::kMaxCellLevel, which is less than
             // (1.4 inch X 1.4 inch) on the earth.
-            _currentLevel = std::max(0, params.finestIndexedLevel - 1);
+            _finestLevel = std::max(0, params.finestIndexedLevel - 1);
+            _currentLevel = getDensityLevel(_s2Index, _finestLevel);
         }
 
         // Search for a document in neighbors at current level.
@@ -1045,6 +1081,14 @@ namespace mongo {
         const IndexDescriptor* _s2Index; // Not owned here.
         const GeoNearParams* _nearParams; // Not owned here.
         int _currentLevel;
+        int _finestLevel;
+
+        // The finest level at which a document was found so far, or -1.
+        int _foundLevel;
+
+        // Whether nothing was found at the level the search started at.
+        bool _coarsening;
+
         unique_ptr<IndexScan> _indexScan;
     };
 
@@ -1114,6 +1158,14 @@ namespace mongo {
 
         if (state == PlanStage::IS_EOF) {
             // We ran through the neighbors but found nothing.
+            if (_foundLevel >= 0) {
+                // The previous, coarser level is the finest with a document.
+                setDensityLevel(_s2Index, _foundLevel);
+                *estimatedDistance = S2::kAvgEdge.GetValue(_foundLevel) * kRadiusOfEarthInMeters;
+                return PlanStage::IS_EOF;
+            }
+
+            _coarsening = true;
             if (_currentLevel > 0) {
                 // Advance to the next level and search again.
                 _currentLevel--;
@@ -1123,13 +1175,24 @@ namespace mongo {
             }
 
             // We are already at the top level.
+            setDensityLevel(_s2Index, _currentLevel);
             *estimatedDistance = S2::kAvgEdge.GetValue(_currentLevel) * kRadiusOfEarthInMeters;
             return PlanStage::IS_EOF;
         } else if (state == PlanStage::ADVANCED) {
             // We found something!
-            *estimatedDistance = S2::kAvgEdge.GetValue(_currentLevel) * kRadiusOfEarthInMeters;
             // Clean up working set.
             workingSet->free(workingSetID);
+
+            if (!_coarsening && _currentLevel < _finestLevel) {
+                // There may be something at a finer level too.
+                _foundLevel = _currentLevel;
+                _currentLevel++;
+                _indexScan.reset(NULL);
+                return PlanStage::NEED_TIME;
+            }
+
+            setDensityLevel(_s2Index, _currentLevel);
+            *estimatedDistance = S2::kAvgEdge.GetValue(_currentLevel) * kRadiusOfEarthInMeters;
             return PlanStage::IS_EOF;
         } else if (state == PlanStage::NEED_YIELD) {
             *out = workingSetID;
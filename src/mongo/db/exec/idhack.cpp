@@ -91,8 +91,8 @@ namespace mongo {
     PlanStage::StageState IDHackStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (_done) { return PlanStage::IS_EOF; }
 
@@ -109,26 +109,39 @@ namespace mongo {
 
         WorkingSetID id = WorkingSet::INVALID_ID;
         try {
-            // Use the index catalog to get the id index.
-            const IndexCatalog* catalog = _collection->getIndexCatalog();
-
-            // Find the index we use.
-            IndexDescriptor* idDesc = catalog->findIdIndex(_txn);
-            if (NULL == idDesc) {
-                _done = true;
-                return PlanStage::IS_EOF;
+            RecordId loc;
+            if (_collection->isClustered()) {
+                // The _id is the key of the record. If there's no record there, fetching it
+                // fails below.
+                loc = Collection::recordIdForId(_key.firstElement());
+                if (loc.isNull()) {
+                    _done = true;
+                    return PlanStage::IS_EOF;
+                }
             }
-
-            // Look up the key by going directly to the index.
-            RecordId loc = catalog->getIndex(idDesc)->findSingle(_txn, _key);
-
-            // Key not found.
-            if (loc.isNull()) {
-                _done = true;
-                return PlanStage::IS_EOF;
+            else {
+                // Use the index catalog to get the id index.
+                const IndexCatalog* catalog = _collection->getIndexCatalog();
+
+                // Find the index we use.
+                IndexDescriptor* idDesc = catalog->findIdIndex(_txn);
+                if (NULL == idDesc) {
+                    _done = true;
+                    return PlanStage::IS_EOF;
+                }
+
+                // Look up the key by going directly to the index.
+                loc = catalog->getIndex(idDesc)->findSingle(_txn, _key);
+
+                // Key not found.
+                if (loc.isNull()) {
+                    _done = true;
+                    return PlanStage::IS_EOF;
+                }
+
+                ++_specificStats.keysExamined;
             }
 
-            ++_specificStats.keysExamined;
             ++_specificStats.docsExamined;
 
             // Create a new WSM for the result document.
@@ -32,6 +32,8 @@
 
 #include "mongo/db/exec/index_scan.h"
 
+#include <algorithm>
+
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -43,6 +45,9 @@
 
 namespace {
 
+    // Most keys buffered for IndexScans sharing them. Scans further behind read the index again.
+    const size_t kMaxSharedKeys = 4096;
+
     // Return a value in the set {-1, 0, 1} to represent the sign of parameter i.
     int sgn(int i) {
         if (i == 0)
@@ -70,6 +75,8 @@ namespace mongo {
           _shouldDedup(true),
           _forward(params.direction == 1),
           _params(params),
+          _sharedPos(0),
+          _skippingSharedKeys(false),
           _commonStats(kStageType),
           _endKeyInclusive(false) {
 
@@ -96,6 +103,9 @@ namespace mongo {
         // Perform the possibly heavy-duty initialization of the underlying index cursor.
         _indexCursor = _iam->newCursor(_txn, _forward);
 
+        // Keys which fail the bounds check, dedup or filter are dropped without being copied.
+        _indexCursor->allowUnownedKeys();
+
         if (_params.bounds.isSimpleRange) {
             // Start at one key, end at another.
             _endKey = _params.bounds.endKey;
@@ -134,9 +144,37 @@ namespace mongo {
     PlanStage::StageState IndexScan::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        return doWork(out);
+    }
+
+    PlanStage::StageState IndexScan::workBatch(size_t maxWorks,
+                                        std::vector<WorkingSetID>* results,
+                                        WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        const size_t numBefore = results->size();
+        for (size_t i = 0; i < maxWorks; ++i) {
+            ++_commonStats.works;
+
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            const StageState state = doWork(&id);
+            if (PlanStage::ADVANCED == state) {
+                results->push_back(id);
+            }
+            else if (PlanStage::NEED_TIME != state) {
+                *out = id;
+                return state;
+            }
+        }
+        return results->size() > numBefore ? PlanStage::ADVANCED : PlanStage::NEED_TIME;
+    }
 
+    PlanStage::StageState IndexScan::readKey(boost::optional<IndexKeyEntry>* out,
+                                             IndexScanStats* stats) {
         // Get the next kv pair from the index, if any.
         boost::optional<IndexKeyEntry> kv;
         try {
@@ -148,7 +186,6 @@ namespace mongo {
             }
         }
         catch (const WriteConflictException& wce) {
-            *out = WorkingSet::INVALID_ID;
             return PlanStage::NEED_YIELD;
         }
 
@@ -162,8 +199,8 @@ namespace mongo {
                 dassert(_forward ? cmp <= 0 : cmp >= 0);
             }
 
-            ++_specificStats.keysExamined;
-            if (_params.maxScan && _specificStats.keysExamined >= _params.maxScan) {
+            ++stats->keysExamined;
+            if (_params.maxScan && stats->keysExamined >= _params.maxScan) {
                 kv = boost::none;
             }
         }
@@ -179,19 +216,117 @@ namespace mongo {
 
             case IndexBoundsChecker::MUST_ADVANCE:
                 _scanState = NEED_SEEK;
-                _commonStats.needTime++;
                 return PlanStage::NEED_TIME;
             }
         }
 
         if (!kv) {
             _scanState = HIT_END;
-            _commonStats.isEOF = true;
             _indexCursor.reset();
             return PlanStage::IS_EOF;
         }
 
         _scanState = GETTING_NEXT;
+        *out = kv;
+        return PlanStage::ADVANCED;
+    }
+
+    PlanStage::StageState IndexScan::readSharedKey(boost::optional<IndexKeyEntry>* out) {
+        SharedKeys* shared = _shared.get();
+        if (_sharedPos < shared->firstPos) {
+            // The keys we need were dropped, so continue on our own.
+            stopSharing();
+            return readKey(out, &_specificStats);
+        }
+
+        while (_sharedPos < shared->firstPos + shared->entries.size()) {
+            const SharedKeys::Entry& entry = shared->entries[_sharedPos - shared->firstPos];
+            ++_sharedPos;
+            if (entry.invalidated) {
+                continue;
+            }
+
+            ++_specificStats.keysExamined;
+            ++_specificStats.keysShared;
+            *out = entry.kv;
+            _lastSharedKey = entry.kv.key;
+            _lastSharedLoc = entry.kv.loc;
+            releaseSharedKeys(shared);
+            return PlanStage::ADVANCED;
+        }
+
+        if (shared->hitEnd) {
+            return PlanStage::IS_EOF;
+        }
+
+        // We are ahead of every other scan, so read the next key for all of them.
+        boost::optional<IndexKeyEntry> kv;
+        const StageState state = shared->reader->readKey(&kv, &_specificStats);
+        if (PlanStage::IS_EOF == state) {
+            shared->hitEnd = true;
+            return state;
+        }
+        if (PlanStage::ADVANCED != state) {
+            return state;
+        }
+
+        // The reader's cursor moves on, so the buffered key must be owned.
+        if (!kv->key.isOwned()) kv->key = kv->key.getOwned();
+        shared->entries.push_back(SharedKeys::Entry(*kv));
+        ++_sharedPos;
+        *out = kv;
+        _lastSharedKey = kv->key;
+        _lastSharedLoc = kv->loc;
+        releaseSharedKeys(shared);
+        return PlanStage::ADVANCED;
+    }
+
+    // static
+    void IndexScan::releaseSharedKeys(SharedKeys* shared) {
+        size_t minPos = shared->firstPos + shared->entries.size();
+        for (size_t i = 0; i < shared->consumers.size(); ++i) {
+            minPos = std::min(minPos, shared->consumers[i]->_sharedPos);
+        }
+
+        while (!shared->entries.empty()
+               && (shared->firstPos < minPos || shared->entries.size() > kMaxSharedKeys)) {
+            shared->entries.pop_front();
+            ++shared->firstPos;
+        }
+    }
+
+    PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
+        if (_commonStats.isEOF) {
+            return PlanStage::IS_EOF;
+        }
+
+        boost::optional<IndexKeyEntry> kv;
+        const StageState state = _shared ? readSharedKey(&kv) : readKey(&kv, &_specificStats);
+        if (PlanStage::ADVANCED == state && _skippingSharedKeys) {
+            // Keys are ordered by key, then RecordId.
+            int cmp = kv->key.woCompare(_lastSharedKey, Ordering::make(_keyPattern), false);
+            if (0 == cmp) {
+                cmp = kv->loc.compare(_lastSharedLoc);
+            }
+            if ((_forward ? cmp : -cmp) <= 0) {
+                // Taken from other scans before we stopped sharing.
+                _commonStats.needTime++;
+                return PlanStage::NEED_TIME;
+            }
+            _skippingSharedKeys = false;
+        }
+        if (PlanStage::NEED_TIME == state) {
+            _commonStats.needTime++;
+            return state;
+        }
+        if (PlanStage::NEED_YIELD == state) {
+            *out = WorkingSet::INVALID_ID;
+            return state;
+        }
+        if (PlanStage::IS_EOF == state) {
+            _commonStats.isEOF = true;
+            return state;
+        }
 
         if (_shouldDedup) {
             ++_specificStats.dupsTested;
@@ -210,13 +345,12 @@ namespace mongo {
             }
         }
 
-        if (!kv->key.isOwned()) kv->key = kv->key.getOwned();
-
-        // We found something to return, so fill out the WSM.
+        // We found something to return, so fill out the WSM. The key is copied into storage the
+        // member reuses rather than into a fresh owned buffer.
         WorkingSetID id = _workingSet->allocate();
         WorkingSetMember* member = _workingSet->get(id);
         member->loc = kv->loc;
-        member->keyData.push_back(IndexKeyDatum(_keyPattern, kv->key, _iam));
+        member->appendKeyDatum(_keyPattern, kv->key, _iam);
         member->state = WorkingSetMember::LOC_AND_IDX;
 
         if (_params.addKeyMetadata) {
@@ -242,6 +376,10 @@ namespace mongo {
 
         _txn = NULL;
         ++_commonStats.yields;
+
+        // Every scan sharing keys saves the reader. Only the first one actually does.
+        if (_shared) _shared->reader->saveState();
+
         if (!_indexCursor) return;
 
         if (_scanState == NEED_SEEK) {
@@ -257,12 +395,26 @@ namespace mongo {
         _txn = opCtx;
         ++_commonStats.unyields;
 
+        if (_shared && !_shared->reader->_txn) _shared->reader->restoreState(opCtx);
+
         if (_indexCursor) _indexCursor->restore(opCtx);
     }
 
     void IndexScan::invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {
         ++_commonStats.invalidates;
 
+        // Keys read before the document changed may be stale, and we don't know where the
+        // document's new keys are, so scans which hadn't reached them yet skip them. This is no
+        // worse than what a yield allows anyway.
+        if (_shared) {
+            std::deque<SharedKeys::Entry>& entries = _shared->entries;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (entries[i].kv.loc == dl) {
+                    entries[i].invalidated = true;
+                }
+            }
+        }
+
         // The only state we're responsible for holding is what RecordIds to drop.  If a document
         // mutates the underlying index cursor will deal with it.
         if (INVALIDATION_MUTATION == type) {
@@ -278,6 +430,54 @@ namespace mongo {
         }
     }
 
+    bool IndexScan::canShareKeysWith(const IndexScan& other) const {
+        // A maxScan limit is counted per scan.
+        return _params.descriptor == other._params.descriptor
+            && _params.direction == other._params.direction
+            && _params.doNotDedup == other._params.doNotDedup
+            && 0 == _params.maxScan
+            && 0 == other._params.maxScan
+            && _params.bounds.equals(other._params.bounds);
+    }
+
+    // static
+    void IndexScan::shareKeys(const std::vector<IndexScan*>& scans) {
+        invariant(scans.size() > 1);
+
+        IndexScan* first = scans[0];
+        std::shared_ptr<SharedKeys> shared = std::make_shared<SharedKeys>();
+        shared->reader.reset(new IndexScan(first->_txn, first->_params, first->_workingSet, NULL));
+        shared->consumers = scans;
+
+        for (size_t i = 0; i < scans.size(); ++i) {
+            IndexScan* scan = scans[i];
+            invariant(INITIALIZING == scan->_scanState);
+            invariant(!scan->_shared);
+            invariant(first->canShareKeysWith(*scan));
+
+            // Only the reader initializes an index cursor, which is where the others would have
+            // found out whether to dedup.
+            scan->_shouldDedup = !scan->_params.doNotDedup
+                              && scan->_params.descriptor->isMultikey(scan->_txn);
+            scan->_shared = shared;
+        }
+    }
+
+    void IndexScan::stopSharing() {
+        if (!_shared) {
+            return;
+        }
+
+        std::shared_ptr<SharedKeys> shared;
+        shared.swap(_shared);
+        std::vector<IndexScan*>& consumers = shared->consumers;
+        consumers.erase(std::remove(consumers.begin(), consumers.end(), this), consumers.end());
+        releaseSharedKeys(shared.get());
+
+        // Our own cursor starts from the beginning of the bounds.
+        _skippingSharedKeys = !_lastSharedKey.isEmpty();
+    }
+
     std::vector<PlanStage*> IndexScan::getChildren() const {
         return {};
     }
@@ -29,6 +29,10 @@
 #pragma once
 
 
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/jsobj.h"
@@ -102,6 +106,9 @@ namespace mongo {
         virtual ~IndexScan() { }
 
         virtual StageState work(WorkingSetID* out);
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out);
         virtual bool isEOF();
         virtual void saveState();
         virtual void restoreState(OperationContext* opCtx);
@@ -117,9 +124,88 @@ namespace mongo {
 
         virtual const SpecificStats* getSpecificStats() const;
 
+        /**
+         * Returns true if 'other' reads exactly the same keys as this scan, so that the two can
+         * share them.
+         */
+        bool canShareKeysWith(const IndexScan& other) const;
+
+        /**
+         * Makes the scans in 'scans', which must all be able to share keys with each other and
+         * must not have been worked yet, read the index only once between them: the first scan
+         * to need a key reads it and the others take it from a buffer. Each scan still applies
+         * its own dedup and filter. A scan which falls too far behind the others goes back to
+         * reading the index itself.
+         *
+         * The scans must be saved and restored together.
+         */
+        static void shareKeys(const std::vector<IndexScan*>& scans);
+
+        /**
+         * Stops taking keys from the other scans, so that no keys are buffered for this one. If
+         * worked again, this scan reads the index itself from where it was.
+         */
+        void stopSharing();
+
         static const char* kStageType;
 
     private:
+        /**
+         * Keys read from the index on behalf of several IndexScans with the same index, bounds
+         * and direction. Keys are dropped once every scan still sharing has moved past them, or
+         * once there are too many.
+         */
+        struct SharedKeys {
+            struct Entry {
+                explicit Entry(const IndexKeyEntry& kv) : kv(kv), invalidated(false) { }
+
+                IndexKeyEntry kv;
+
+                // Set if the document was deleted or changed after its key was read. Since the
+                // key may be stale, the entry is skipped by scans which had not yet reached it.
+                bool invalidated;
+            };
+
+            SharedKeys() : firstPos(0), hitEnd(false) { }
+
+            // Reads the keys. Has no filter and does not dedup.
+            std::unique_ptr<IndexScan> reader;
+
+            // The scans reading from 'entries'. Not owned here.
+            std::vector<IndexScan*> consumers;
+
+            // Position in the index range of entries[0].
+            size_t firstPos;
+            std::deque<Entry> entries;
+
+            // Set once 'reader' reached the end of the range.
+            bool hitEnd;
+        };
+
+        /**
+         * One unit of work, without the accounting work() and workBatch() do per call.
+         */
+        StageState doWork(WorkingSetID* out);
+
+        /**
+         * Advances the index cursor to the next key within the bounds, or returns NEED_TIME if
+         * the cursor had to seek, NEED_YIELD on a write conflict or IS_EOF at the end. Keys
+         * retrieved are counted in '*stats'.
+         */
+        StageState readKey(boost::optional<IndexKeyEntry>* out, IndexScanStats* stats);
+
+        /**
+         * Like readKey(), but takes the key from '_shared', having '_shared->reader' read it from
+         * the index first if no other scan had.
+         */
+        StageState readSharedKey(boost::optional<IndexKeyEntry>* out);
+
+        /**
+         * Drops the shared entries which every consumer has moved past, and the oldest ones if
+         * there are too many.
+         */
+        static void releaseSharedKeys(SharedKeys* shared);
+
         /**
          * Initialize the underlying index Cursor, returning first result if any.
          */
@@ -151,6 +237,18 @@ namespace mongo {
         const bool _forward;
         const IndexScanParams _params;
 
+        // Set if this scan shares the keys it reads with others.
+        std::shared_ptr<SharedKeys> _shared;
+
+        // Position in the index range of the next shared key this scan takes.
+        size_t _sharedPos;
+
+        // The last key taken from other scans. Once this scan stops sharing, it reads the index
+        // itself and skips keys up to and including this one.
+        BSONObj _lastSharedKey;
+        RecordId _lastSharedLoc;
+        bool _skippingSharedKeys;
+
         // Stats
         CommonStats _commonStats;
         IndexScanStats _specificStats;
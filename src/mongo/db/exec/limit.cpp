@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/limit.h"
 
+#include <algorithm>
+
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/util/mongoutils/str.h"
@@ -55,8 +57,8 @@ namespace mongo {
     PlanStage::StageState LimitStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (0 == _numToReturn) {
             // We've returned as many results as we're limited to.
@@ -96,6 +98,61 @@ namespace mongo {
         return status;
     }
 
+    PlanStage::StageState LimitStage::workBatch(size_t maxWorks,
+                                                std::vector<WorkingSetID>* results,
+                                                WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        if (0 == _numToReturn) {
+            // We've returned as many results as we're limited to.
+            ++_commonStats.works;
+            return PlanStage::IS_EOF;
+        }
+
+        // Each work of the child produces at most one result, so don't ask for more works than
+        // there are results left to return.
+        const size_t numBefore = results->size();
+        const size_t childWorksBefore = _child->getCommonStats()->works;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState status = _child->workBatch(std::min(maxWorks, size_t(_numToReturn)),
+                                              results,
+                                              &id);
+        const size_t childWorks = _child->getCommonStats()->works - childWorksBefore;
+
+        // Drop anything past the limit, in case the child produced more results than works.
+        while (results->size() - numBefore > size_t(_numToReturn)) {
+            _ws->free(results->back());
+            results->pop_back();
+        }
+
+        const size_t numResults = results->size() - numBefore;
+        _numToReturn -= numResults;
+        _commonStats.works += childWorks;
+        _commonStats.advanced += numResults;
+        _commonStats.needTime += childNeedTimes(childWorks, numResults, status);
+
+        if (PlanStage::ADVANCED == status || PlanStage::NEED_TIME == status) {
+            return numResults > 0 ? PlanStage::ADVANCED : PlanStage::NEED_TIME;
+        }
+
+        if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+            *out = id;
+            if (WorkingSet::INVALID_ID == id) {
+                mongoutils::str::stream ss;
+                ss << "limit stage failed to read in results from child";
+                Status status(ErrorCodes::InternalError, ss);
+                *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+            }
+        }
+        else if (PlanStage::NEED_YIELD == status) {
+            ++_commonStats.needYield;
+            *out = id;
+        }
+
+        return status;
+    }
+
     void LimitStage::saveState() {
         ++_commonStats.yields;
         _child->saveState();
@@ -40,6 +40,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/client.h"
+#include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/explain.h"
@@ -48,6 +49,7 @@
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -56,6 +58,22 @@ namespace mongo {
     using std::list;
     using std::vector;
 
+    namespace {
+
+        void collectIndexScans(PlanStage* root, vector<IndexScan*>* out) {
+            if (STAGE_IXSCAN == root->stageType()) {
+                out->push_back(static_cast<IndexScan*>(root));
+                return;
+            }
+
+            vector<PlanStage*> children = root->getChildren();
+            for (size_t i = 0; i < children.size(); ++i) {
+                collectIndexScans(children[i], out);
+            }
+        }
+
+    }  // namespace
+
     // static
     const char* MultiPlanStage::kStageType = "MULTI_PLAN";
 
@@ -101,8 +119,8 @@ namespace mongo {
     }
 
     PlanStage::StageState MultiPlanStage::work(WorkingSetID* out) {
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (_failure) {
             *out = _statusMemberId;
@@ -135,6 +153,7 @@ namespace mongo {
 
             _collection->infoCache()->getPlanCache()->remove(*_query);
 
+            stopSharingIndexScans(_bestPlanIdx);
             _bestPlanIdx = _backupPlanIdx;
             _backupPlanIdx = kNoSuchPlan;
 
@@ -143,6 +162,7 @@ namespace mongo {
 
         if (hasBackupPlan() && PlanStage::ADVANCED == state) {
             LOG(5) << "Best plan had a blocking stage, became unblocked\n";
+            stopSharingIndexScans(_backupPlanIdx);
             _backupPlanIdx = kNoSuchPlan;
         }
 
@@ -222,19 +242,33 @@ namespace mongo {
     }
 
     Status MultiPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
-        // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
+        // Adds the amount of time taken by pickBestPlan() to executionTimeNanos. There's lots of
         // execution work that happens here, so this is needed for the time accounting to
         // make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         size_t numWorks = getTrialPeriodWorks(_txn, _collection);
         size_t numResults = getTrialPeriodNumToReturn(*_query);
 
+        if (internalQueryPlanEvaluationShareIndexScans) {
+            shareIndexScans();
+        }
+
         // Work the plans, stopping when a plan hits EOF or returns some
-        // fixed number of results.
-        for (size_t ix = 0; ix < numWorks; ++ix) {
-            bool moreToDo = workAllPlans(numResults, yieldPolicy);
-            if (!moreToDo) { break; }
+        // fixed number of results, or when all but one were abandoned.
+        {
+            Timer trialTimer;
+            for (size_t ix = 0; ix < numWorks; ++ix) {
+                bool moreToDo = workAllPlans(numResults, yieldPolicy);
+                if (!moreToDo) { break; }
+
+                if (!abandonDominatedPlans()) { break; }
+            }
+            _specificStats.trialMillis += trialTimer.millis();
+        }
+
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            _specificStats.trialWorks += _candidates[ix].root->getCommonStats()->works;
         }
 
         if (_failure) {
@@ -272,6 +306,13 @@ namespace mongo {
             }
         }
 
+        // Only the best and backup plans are worked from now on.
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            if (static_cast<int>(ix) != _bestPlanIdx && static_cast<int>(ix) != _backupPlanIdx) {
+                stopSharingIndexScans(ix);
+            }
+        }
+
         // Store the choice we just made in the cache, if the query is of a type that is safe to
         // cache.
         if (PlanCache::shouldCacheQuery(*_query) && _shouldCache) {
@@ -308,6 +349,108 @@ namespace mongo {
         return Status::OK();
     }
 
+    void MultiPlanStage::shareIndexScans() {
+        // Groups of scans from different candidates which read the same keys.
+        vector<vector<IndexScan*> > groups;
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            vector<IndexScan*> scans;
+            collectIndexScans(_candidates[ix].root, &scans);
+
+            for (size_t i = 0; i < scans.size(); ++i) {
+                bool grouped = false;
+                for (size_t j = 0; j < groups.size() && !grouped; ++j) {
+                    // Scans within one candidate are worked at different paces, e.g. by an
+                    // OR, so only one scan per candidate goes in each group.
+                    IndexScan* last = groups[j].back();
+                    if (last->canShareKeysWith(*scans[i]) &&
+                        std::find(scans.begin(), scans.end(), last) == scans.end()) {
+                        groups[j].push_back(scans[i]);
+                        grouped = true;
+                    }
+                }
+                if (!grouped) {
+                    groups.push_back(vector<IndexScan*>(1, scans[i]));
+                }
+            }
+        }
+
+        for (size_t j = 0; j < groups.size(); ++j) {
+            if (groups[j].size() > 1) {
+                IndexScan::shareKeys(groups[j]);
+                _specificStats.sharedIndexScans += groups[j].size() - 1;
+            }
+        }
+    }
+
+    void MultiPlanStage::stopSharingIndexScans(size_t candidateIdx) {
+        vector<IndexScan*> scans;
+        collectIndexScans(_candidates[candidateIdx].root, &scans);
+        for (size_t i = 0; i < scans.size(); ++i) {
+            scans[i]->stopSharing();
+        }
+    }
+
+    bool MultiPlanStage::abandonDominatedPlans() {
+        const int minWorks = internalQueryPlanEvaluationCutoffMinWorks;
+        const double confidence = internalQueryPlanEvaluationCutoffConfidence;
+        if (minWorks <= 0 || confidence <= 0 || confidence >= 1 || _candidates.size() < 2) {
+            return true;
+        }
+
+        // By Hoeffding's inequality, the productivity of a plan worked n times is within
+        // sqrt(ln(2 / (1 - confidence)) / 2n) of advanced / n with the given confidence.
+        const double logTerm = log(2 / (1 - confidence));
+
+        vector<double> productivity(_candidates.size());
+        vector<double> margin(_candidates.size());
+        double bestLowerBound = 0;
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            const CandidatePlan& candidate = _candidates[ix];
+            if (candidate.failed || candidate.abandoned) { continue; }
+
+            const CommonStats* stats = candidate.root->getCommonStats();
+            if (stats->works < static_cast<size_t>(minWorks)) {
+                return true;
+            }
+
+            productivity[ix] = static_cast<double>(stats->advanced) / stats->works;
+            margin[ix] = sqrt(logTerm / (2 * stats->works));
+            bestLowerBound = std::max(bestLowerBound, productivity[ix] - margin[ix]);
+        }
+
+        size_t remaining = 0;
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            CandidatePlan& candidate = _candidates[ix];
+            if (candidate.failed || candidate.abandoned) { continue; }
+
+            if (productivity[ix] + margin[ix] < bestLowerBound) {
+                LOG(2) << "Abandoning query plan " << Explain::getPlanSummary(candidate.root)
+                       << " with productivity " << productivity[ix];
+                candidate.abandoned = true;
+                ++_specificStats.plansAbandoned;
+                stopSharingIndexScans(ix);
+                continue;
+            }
+            ++remaining;
+        }
+
+        // Don't cut short trials in which nothing was abandoned, e.g. because all but one plan
+        // failed.
+        return remaining > 1 || 0 == _specificStats.plansAbandoned;
+    }
+
+    void MultiPlanStage::reinstateAbandonedPlans() {
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            if (!_candidates[ix].failed && !_candidates[ix].abandoned) {
+                return;
+            }
+        }
+
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            _candidates[ix].abandoned = false;
+        }
+    }
+
     vector<PlanStageStats*> MultiPlanStage::generateCandidateStats() {
         OwnedPointerVector<PlanStageStats> candidateStats;
 
@@ -327,7 +470,7 @@ namespace mongo {
 
         for (size_t ix = 0; ix < _candidates.size(); ++ix) {
             CandidatePlan& candidate = _candidates[ix];
-            if (candidate.failed) { continue; }
+            if (candidate.failed || candidate.abandoned) { continue; }
 
             // Might need to yield between calls to work due to the timer elapsing.
             if (!(tryYield(yieldPolicy)).isOK()) {
@@ -387,6 +530,8 @@ namespace mongo {
                     _failure = true;
                     return false;
                 }
+
+                reinstateAbandonedPlans();
             }
         }
 
@@ -170,6 +170,32 @@ namespace mongo {
          */
         Status tryYield(PlanYieldPolicy* yieldPolicy);
 
+        /**
+         * Makes the index scans of different candidates which read the same keys share them
+         * during the trial period.
+         */
+        void shareIndexScans();
+
+        /**
+         * Stops buffering shared index keys for the candidate at 'candidateIdx', which won't be
+         * worked anymore.
+         */
+        void stopSharingIndexScans(size_t candidateIdx);
+
+        /**
+         * Once the candidates were worked enough, marks as abandoned those whose productivity is
+         * lower than the best candidate's with internalQueryPlanEvaluationCutoffConfidence.
+         *
+         * Returns true if more than one candidate remains to be worked.
+         */
+        bool abandonDominatedPlans();
+
+        /**
+         * Called when a candidate failed. If only abandoned candidates are left, works them
+         * again rather than failing the query.
+         */
+        void reinstateAbandonedPlans();
+
         static const int kNoSuchPlan = -1;
 
         // Not owned here.
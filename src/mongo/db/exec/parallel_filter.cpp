@@ -0,0 +1,334 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/parallel_filter.h"
+
+#include <algorithm>
+
+#include "mongo/db/exec/scoped_timer.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using std::unique_ptr;
+    using std::vector;
+
+    const OperationContext::Decoration<int> requestedQueryParallelism =
+        OperationContext::declareDecoration<int>();
+
+    // static
+    const char* ParallelFilterStage::kStageType = "PARALLEL_FILTER";
+
+    ParallelFilterStage::ParallelFilterStage(WorkingSet* ws,
+                                             PlanStage* child,
+                                             const MatchExpression* filter,
+                                             const Collection* collection,
+                                             size_t degree)
+        : _ws(ws),
+          _child(child),
+          _filter(filter),
+          _collection(collection),
+          _degree(degree),
+          _nextInOldest(0),
+          _childEOF(false),
+          _commonStats(kStageType) {
+        invariant(_filter);
+        invariant(_degree > 1);
+        _specificStats.degree = _degree;
+    }
+
+    ParallelFilterStage::~ParallelFilterStage() {
+        // Wait for the workers before anything they use goes away.
+        _pool.reset();
+    }
+
+    // static
+    size_t ParallelFilterStage::getDegree(OperationContext* txn) {
+        const int degree = std::min(requestedQueryParallelism(txn),
+                                    internalQueryExecMaxParallelism);
+        return std::max(degree, 1);
+    }
+
+    // static
+    bool ParallelFilterStage::canRunInParallel(const MatchExpression* filter) {
+        // $where runs in the query's JavaScript scope, and $text has to be answered by the text
+        // stage.
+        if (MatchExpression::WHERE == filter->matchType()
+            || MatchExpression::TEXT == filter->matchType()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < filter->numChildren(); ++i) {
+            if (!canRunInParallel(filter->getChild(i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ParallelFilterStage::isEOF() {
+        return (_childEOF || _child->isEOF()) && _gathering.ids.empty() && _morsels.empty();
+    }
+
+    PlanStage::StageState ParallelFilterStage::work(WorkingSetID* out) {
+        ++_commonStats.works;
+
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        if (isEOF()) { return PlanStage::IS_EOF; }
+
+        // Once the child is done, hand out what's left of its results straight away.
+        if (!_childEOF && _child->isEOF()) {
+            _childEOF = true;
+        }
+        if (_childEOF) {
+            dispatch();
+        }
+
+        // Return the results of the oldest morsel once it's done. We only wait for it when there
+        // is nothing else to do: every worker is busy, or the child has no more results.
+        if (!_morsels.empty()) {
+            bool oldestDone;
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                oldestDone = _morsels.front()->done;
+            }
+
+            if (oldestDone || _morsels.size() >= _degree || _childEOF) {
+                return returnFromOldest(out);
+            }
+        }
+        invariant(!_childEOF);
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState status = _child->work(&id);
+
+        if (PlanStage::ADVANCED == status) {
+            WorkingSetMember* member = _ws->get(id);
+            invariant(member->hasObj());
+            _gathering.ids.push_back(id);
+            if (_gathering.ids.size() >= size_t(std::max(1, internalQueryExecParallelMorselDocs))) {
+                dispatch();
+            }
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+        else if (PlanStage::IS_EOF == status) {
+            // Our own EOF waits for the morsels still out.
+            _childEOF = true;
+            dispatch();
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+        else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+            *out = id;
+            // If a stage fails, it may create a status WSM to indicate why it
+            // failed, in which case 'id' is valid.  If ID is invalid, we
+            // create our own error message.
+            if (WorkingSet::INVALID_ID == id) {
+                mongoutils::str::stream ss;
+                ss << "parallel filter stage failed to read in results from child";
+                Status status(ErrorCodes::InternalError, ss);
+                *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+            }
+            return status;
+        }
+        else if (PlanStage::NEED_TIME == status) {
+            ++_commonStats.needTime;
+        }
+        else if (PlanStage::NEED_YIELD == status) {
+            ++_commonStats.needYield;
+            *out = id;
+        }
+
+        return status;
+    }
+
+    // static
+    void ParallelFilterStage::matchMorsel(ParallelFilterStage* stage, Morsel* morsel) {
+        try {
+            for (size_t i = 0; i < morsel->docs.size(); ++i) {
+                morsel->matched[i] = stage->_filter->matchesBSON(morsel->docs[i], NULL);
+            }
+        }
+        catch (const DBException& ex) {
+            morsel->status = ex.toStatus();
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(stage->_mutex);
+        morsel->done = true;
+        stage->_morselDone.notify_all();
+    }
+
+    void ParallelFilterStage::dispatch() {
+        if (_gathering.ids.empty()) {
+            return;
+        }
+
+        if (!_pool) {
+            _pool = stdx::make_unique<ThreadPool>(_degree, "parallelFilter");
+        }
+
+        unique_ptr<Morsel> morsel = stdx::make_unique<Morsel>();
+        morsel->ids.swap(_gathering.ids);
+        morsel->docs.reserve(morsel->ids.size());
+        for (size_t i = 0; i < morsel->ids.size(); ++i) {
+            morsel->docs.push_back(_ws->get(morsel->ids[i])->obj.value());
+        }
+        morsel->matched.resize(morsel->ids.size());
+
+        _specificStats.morsels++;
+        _specificStats.docsTested += morsel->ids.size();
+
+        Morsel* rawMorsel = morsel.get();
+        _morsels.push_back(std::move(morsel));
+        _pool->schedule(matchMorsel, this, rawMorsel);
+    }
+
+    void ParallelFilterStage::waitForOldest() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (!_morsels.front()->done) {
+            _morselDone.wait(lk);
+        }
+    }
+
+    void ParallelFilterStage::waitForAll() {
+        if (_morsels.empty()) {
+            return;
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        for (size_t i = 0; i < _morsels.size(); ++i) {
+            while (!_morsels[i]->done) {
+                _morselDone.wait(lk);
+            }
+        }
+    }
+
+    PlanStage::StageState ParallelFilterStage::returnFromOldest(WorkingSetID* out) {
+        waitForOldest();
+
+        Morsel* oldest = _morsels.front().get();
+        if (!oldest->status.isOK()) {
+            *out = WorkingSetCommon::allocateStatusMember(_ws, oldest->status);
+            return PlanStage::FAILURE;
+        }
+
+        while (_nextInOldest < oldest->ids.size()) {
+            const size_t i = _nextInOldest++;
+            if (oldest->matched[i]) {
+                *out = oldest->ids[i];
+                ++_commonStats.advanced;
+                return PlanStage::ADVANCED;
+            }
+            _ws->free(oldest->ids[i]);
+        }
+
+        _morsels.pop_front();
+        _nextInOldest = 0;
+        ++_commonStats.needTime;
+        return PlanStage::NEED_TIME;
+    }
+
+    void ParallelFilterStage::saveState() {
+        ++_commonStats.yields;
+
+        // The workers read the documents in place, so they have to be done with them before the
+        // child or the storage engine may move them.
+        waitForAll();
+        _child->saveState();
+    }
+
+    void ParallelFilterStage::restoreState(OperationContext* opCtx) {
+        ++_commonStats.unyields;
+        _child->restoreState(opCtx);
+    }
+
+    void ParallelFilterStage::invalidate(OperationContext* txn,
+                                         const RecordId& dl,
+                                         InvalidationType type) {
+        ++_commonStats.invalidates;
+
+        _child->invalidate(txn, dl, type);
+
+        // Keep the document of any result we still hold for the invalidated loc.
+        waitForAll();
+        for (size_t m = 0; m < _morsels.size(); ++m) {
+            const vector<WorkingSetID>& ids = _morsels[m]->ids;
+            for (size_t i = (0 == m ? _nextInOldest : 0); i < ids.size(); ++i) {
+                WorkingSetMember* member = _ws->get(ids[i]);
+                if (member->hasLoc() && member->loc == dl) {
+                    WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+                    ++_specificStats.forcedFetches;
+                }
+            }
+        }
+        for (size_t i = 0; i < _gathering.ids.size(); ++i) {
+            WorkingSetMember* member = _ws->get(_gathering.ids[i]);
+            if (member->hasLoc() && member->loc == dl) {
+                WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+                ++_specificStats.forcedFetches;
+            }
+        }
+    }
+
+    vector<PlanStage*> ParallelFilterStage::getChildren() const {
+        vector<PlanStage*> children;
+        children.push_back(_child.get());
+        return children;
+    }
+
+    PlanStageStats* ParallelFilterStage::getStats() {
+        _commonStats.isEOF = isEOF();
+
+        BSONObjBuilder bob;
+        _filter->toBSON(&bob);
+        _commonStats.filter = bob.obj();
+
+        unique_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_PARALLEL_FILTER));
+        ret->specific.reset(new ParallelFilterStats(_specificStats));
+        ret->children.push_back(_child->getStats());
+        return ret.release();
+    }
+
+    const CommonStats* ParallelFilterStage::getCommonStats() const {
+        return &_commonStats;
+    }
+
+    const SpecificStats* ParallelFilterStage::getSpecificStats() const {
+        return &_specificStats;
+    }
+
+}  // namespace mongo
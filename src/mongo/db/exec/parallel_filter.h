@@ -0,0 +1,182 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+    class Collection;
+
+    /**
+     * How many threads the client asked to run each filter of the current query on, through the
+     * "parallelism" option of find or aggregate. Values of 0 and 1 both mean one thread, and the
+     * internalQueryExecMaxParallelism knob further caps the degree actually used.
+     *
+     * Note that Decorations are value-constructed so this defaults to 0.
+     */
+    extern const OperationContext::Decoration<int> requestedQueryParallelism;
+
+    /**
+     * Tests the results of its child against a filter on several threads.
+     *
+     * The child's results are gathered into morsels of internalQueryExecParallelMorselDocs
+     * documents, and up to 'degree' morsels at a time are matched against the filter on worker
+     * threads. Those only read the documents, so they need neither locks nor a storage engine
+     * snapshot of their own. The child is always worked on the thread running the query, and the
+     * matching results are returned in the order the child produced them.
+     *
+     * The child's results must have objects, so it is a collection scan or a fetch which was built
+     * without the filter.
+     */
+    class ParallelFilterStage : public PlanStage {
+    public:
+        ParallelFilterStage(WorkingSet* ws,
+                            PlanStage* child,
+                            const MatchExpression* filter,
+                            const Collection* collection,
+                            size_t degree);
+
+        virtual ~ParallelFilterStage();
+
+        /**
+         * Returns the degree of parallelism to filter with for 'txn', or 1 to filter on the
+         * query's own thread.
+         */
+        static size_t getDegree(OperationContext* txn);
+
+        /**
+         * Returns true if 'filter' can be matched on several threads at once. Filters with $where
+         * or $text can't.
+         */
+        static bool canRunInParallel(const MatchExpression* filter);
+
+        virtual bool isEOF();
+        virtual StageState work(WorkingSetID* out);
+
+        virtual void saveState();
+        virtual void restoreState(OperationContext* opCtx);
+        virtual void invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type);
+
+        virtual std::vector<PlanStage*> getChildren() const;
+
+        virtual StageType stageType() const { return STAGE_PARALLEL_FILTER; }
+
+        PlanStageStats* getStats();
+
+        virtual const CommonStats* getCommonStats() const;
+
+        virtual const SpecificStats* getSpecificStats() const;
+
+        static const char* kStageType;
+
+    private:
+        struct Morsel {
+            std::vector<WorkingSetID> ids;
+
+            // Filled in when the morsel is handed to a worker, and only read by it.
+            std::vector<BSONObj> docs;
+
+            // Written by the worker. Only read once 'done' is set.
+            std::vector<char> matched;
+            Status status = Status::OK();
+
+            // Protected by _mutex.
+            bool done = false;
+        };
+
+        /**
+         * Runs on a worker thread to match the documents of 'morsel' against the filter.
+         */
+        static void matchMorsel(ParallelFilterStage* stage, Morsel* morsel);
+
+        /**
+         * Hands the morsel being gathered to a worker.
+         */
+        void dispatch();
+
+        /**
+         * Blocks until the oldest morsel, or every morsel handed out, has been matched.
+         */
+        void waitForOldest();
+        void waitForAll();
+
+        /**
+         * Frees the results of the oldest morsel which didn't match, up to the next one which did.
+         * Returns that as ADVANCED, or NEED_TIME once the morsel has no more.
+         */
+        StageState returnFromOldest(WorkingSetID* out);
+
+        // _ws is not owned by us.
+        WorkingSet* _ws;
+        std::unique_ptr<PlanStage> _child;
+
+        // The filter is not owned by us.
+        const MatchExpression* _filter;
+
+        // Used to save the documents of invalidated results.
+        const Collection* _collection;
+
+        const size_t _degree;
+
+        // The results of the child not yet handed out in a morsel.
+        Morsel _gathering;
+
+        // Morsels handed out, oldest first. The results of the oldest are returned from
+        // _nextInOldest on.
+        std::deque<std::unique_ptr<Morsel>> _morsels;
+        size_t _nextInOldest;
+
+        bool _childEOF;
+
+        // Protects Morsel::done, and is notified whenever a worker sets it.
+        stdx::mutex _mutex;
+        stdx::condition_variable _morselDone;
+
+        // Started with the first morsel. Declared after the morsels and the mutex so that it is
+        // destroyed, and its threads are joined, before them.
+        std::unique_ptr<ThreadPool> _pool;
+
+        // Stats
+        CommonStats _commonStats;
+        ParallelFilterStats _specificStats;
+    };
+
+}  // namespace mongo
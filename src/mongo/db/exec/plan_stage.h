@@ -184,6 +184,36 @@ namespace mongo {
          */
         virtual StageState work(WorkingSetID* out) = 0;
 
+        /**
+         * Batch form of work(): performs up to 'maxWorks' units of work, as that many calls to
+         * work() would, and appends each unit's result to 'results'.
+         *
+         * Stops early when a unit of work returns anything other than ADVANCED or NEED_TIME, and
+         * returns that state with '*out' set as work() would have set it. Otherwise returns
+         * ADVANCED if any results were appended and NEED_TIME if none were. Either way the
+         * appended results are valid, and come before the returned state.
+         *
+         * Stages which can produce a batch cheaper than one work() at a time override this. The
+         * rest keep this per-result adapter.
+         */
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out) {
+            const size_t numBefore = results->size();
+            for (size_t i = 0; i < maxWorks; ++i) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                const StageState state = work(&id);
+                if (ADVANCED == state) {
+                    results->push_back(id);
+                }
+                else if (NEED_TIME != state) {
+                    *out = id;
+                    return state;
+                }
+            }
+            return results->size() > numBefore ? ADVANCED : NEED_TIME;
+        }
+
         /**
          * Returns true if no more work can be done on the query / out of results.
          */
@@ -283,6 +313,19 @@ namespace mongo {
          */
         virtual const SpecificStats* getSpecificStats() const = 0;
 
+    protected:
+        /**
+         * For a stage which handles each result of its child's workBatch() as it would have in
+         * work(): returns how many of the 'childWorks' units of work the child performed
+         * produced neither one of its 'childResults' results nor the returned 'childState'.
+         * Each of those would have been a NEED_TIME of the stage's own.
+         */
+        static size_t childNeedTimes(size_t childWorks,
+                                     size_t childResults,
+                                     StageState childState) {
+            const size_t ended = (ADVANCED == childState || NEED_TIME == childState) ? 0 : 1;
+            return childWorks > childResults + ended ? childWorks - childResults - ended : 0;
+        }
     };
 
 }  // namespace mongo
@@ -64,7 +64,8 @@ namespace mongo {
                         advanced(0),
                         needTime(0),
                         needYield(0),
-                        executionTimeMillis(0),
+                        executionTimeNanos(0),
+                        workingSetAllocations(0),
                         isEOF(false) { }
         // String giving the type of the stage. Not owned.
         const char* stageTypeStr;
@@ -84,8 +85,13 @@ namespace mongo {
         // is no filter affixed, then 'filter' should be an empty BSONObj.
         BSONObj filter;
 
-        // Time elapsed while working inside this stage.
-        long long executionTimeMillis;
+        // Time elapsed while working inside this stage, in nanoseconds. Includes the time spent
+        // in the children that it worked.
+        long long executionTimeNanos;
+
+        // Working set members allocated while working inside this stage, including those that
+        // its children allocated.
+        long long workingSetAllocations;
 
         // TODO: have some way of tracking WSM sizes (or really any series of #s).  We can measure
         // the size of our inputs and the size of our outputs.  We can do a lot with the WS here.
@@ -146,7 +152,8 @@ namespace mongo {
         AndHashStats() : flaggedButPassed(0),
                          flaggedInProgress(0),
                          memUsage(0),
-                         memLimit(0) { }
+                         memLimit(0),
+                         compact(false) { }
 
         virtual ~AndHashStats() { }
 
@@ -175,6 +182,9 @@ namespace mongo {
 
         // What's our memory limit?
         size_t memLimit;
+
+        // Did we switch to keeping only the RecordIds of the intersection?
+        bool compact;
     };
 
     struct AndSortedStats : public SpecificStats {
@@ -195,15 +205,18 @@ namespace mongo {
     };
 
     struct CachedPlanStats : public SpecificStats {
-        CachedPlanStats() { }
+        CachedPlanStats() : replanned(false) { }
 
         virtual SpecificStats* clone() const {
             return new CachedPlanStats(*this);
         }
+
+        // Was the cached plan abandoned, and the query planned again from scratch?
+        bool replanned;
     };
 
     struct CollectionScanStats : public SpecificStats {
-        CollectionScanStats() : docsTested(0), direction(1) { }
+        CollectionScanStats() : docsTested(0), copiesAvoided(0), direction(1) { }
 
         virtual SpecificStats* clone() const {
             CollectionScanStats* specific = new CollectionScanStats(*this);
@@ -213,6 +226,9 @@ namespace mongo {
         // How many documents did we check against our filter?
         size_t docsTested;
 
+        // How many of those were read in place from storage engine memory and never copied?
+        size_t copiesAvoided;
+
         // >0 if we're traversing the collection forwards. <0 if we're traversing it
         // backwards.
         int direction;
@@ -235,6 +251,9 @@ namespace mongo {
         // A "trivial count" is one that we can answer by calling numRecords() on the
         // collection, without actually going through any query logic.
         bool trivialCount;
+
+        // The summary index whose groups the count is taken from, if any
+        std::string summaryIndex;
     };
 
     struct CountScanStats : public SpecificStats {
@@ -251,6 +270,7 @@ namespace mongo {
             CountScanStats* specific = new CountScanStats(*this);
             // BSON objects have to be explicitly copied.
             specific->keyPattern = keyPattern.getOwned();
+            specific->indexBounds = indexBounds.getOwned();
             return specific;
         }
 
@@ -258,6 +278,9 @@ namespace mongo {
 
         BSONObj keyPattern;
 
+        // Empty unless the scan is over index bounds rather than a single range of keys.
+        BSONObj indexBounds;
+
         int indexVersion;
 
         bool isMultiKey;
@@ -270,7 +293,7 @@ namespace mongo {
     };
 
     struct DeleteStats : public SpecificStats {
-        DeleteStats() : docsDeleted(0), nInvalidateSkips(0) { }
+        DeleteStats() : docsDeleted(0), nInvalidateSkips(0), nSkippedLocked(0) { }
 
         virtual SpecificStats* clone() const {
             return new DeleteStats(*this);
@@ -281,6 +304,9 @@ namespace mongo {
         // Invalidated documents can be force-fetched, causing the now invalid RecordId to
         // be thrown out. The delete stage skips over any results which do not have a RecordId.
         size_t nInvalidateSkips;
+
+        // Documents passed over by a skipLocked delete because of a write conflict.
+        size_t nSkippedLocked;
     };
 
     struct DistinctScanStats : public SpecificStats {
@@ -305,7 +331,9 @@ namespace mongo {
     struct FetchStats : public SpecificStats {
         FetchStats() : alreadyHasObj(0),
                        forcedFetches(0),
-                       docsExamined(0) { }
+                       docsExamined(0),
+                       copiesAvoided(0),
+                       prefetched(0) { }
 
         virtual ~FetchStats() { }
 
@@ -322,6 +350,39 @@ namespace mongo {
 
         // The total number of full documents touched by the fetch stage.
         size_t docsExamined;
+
+        // How many of the documents we fetched were read in place from storage engine memory
+        // and never copied?
+        size_t copiesAvoided;
+
+        // How many records were passed to the storage engine to read ahead of fetching them?
+        size_t prefetched;
+    };
+
+    struct ParallelFilterStats : public SpecificStats {
+        ParallelFilterStats() : degree(0),
+                                morsels(0),
+                                docsTested(0),
+                                forcedFetches(0) { }
+
+        virtual ~ParallelFilterStats() { }
+
+        virtual SpecificStats* clone() const {
+            ParallelFilterStats* specific = new ParallelFilterStats(*this);
+            return specific;
+        }
+
+        // How many threads the filter runs on.
+        size_t degree;
+
+        // How many batches of documents were handed to those threads?
+        size_t morsels;
+
+        // The number of documents in those batches.
+        size_t docsTested;
+
+        // How many records were we forced to fetch as the result of an invalidation?
+        size_t forcedFetches;
     };
 
     struct GroupStats : public SpecificStats {
@@ -367,7 +428,8 @@ namespace mongo {
                            dupsTested(0),
                            dupsDropped(0),
                            seenInvalidated(0),
-                           keysExamined(0) { }
+                           keysExamined(0),
+                           keysShared(0) { }
 
         virtual ~IndexScanStats() { }
 
@@ -413,6 +475,9 @@ namespace mongo {
         // Number of entries retrieved from the index during the scan.
         size_t keysExamined;
 
+        // Number of the keys examined which an identical index scan had already retrieved.
+        size_t keysShared;
+
     };
 
     struct LimitStats : public SpecificStats {
@@ -435,11 +500,25 @@ namespace mongo {
     };
 
     struct MultiPlanStats : public SpecificStats {
-        MultiPlanStats() { }
+        MultiPlanStats() : trialWorks(0),
+                           trialMillis(0),
+                           plansAbandoned(0),
+                           sharedIndexScans(0) { }
 
         virtual SpecificStats* clone() const {
             return new MultiPlanStats(*this);
         }
+
+        // Calls to work() on all candidate plans during the trial period.
+        size_t trialWorks;
+
+        long long trialMillis;
+
+        // Candidates no longer worked because another was clearly more productive.
+        size_t plansAbandoned;
+
+        // Index scans which read keys read by an identical index scan of another candidate.
+        size_t sharedIndexScans;
     };
 
     struct OrStats : public SpecificStats {
@@ -461,6 +540,34 @@ namespace mongo {
         size_t locsForgotten;
     };
 
+    struct PointLookupStats : public SpecificStats {
+        PointLookupStats() : indexVersion(0),
+                             keysRequested(0),
+                             keysExamined(0),
+                             docsExamined(0) { }
+
+        virtual SpecificStats* clone() const {
+            PointLookupStats* specific = new PointLookupStats(*this);
+            specific->keyPattern = keyPattern.getOwned();
+            return specific;
+        }
+
+        std::string indexName;
+
+        BSONObj keyPattern;
+
+        int indexVersion;
+
+        // Number of keys looked up.
+        size_t keysRequested;
+
+        // Number of keys found in the index.
+        size_t keysExamined;
+
+        // Number of documents fetched and tested against the filter.
+        size_t docsExamined;
+    };
+
     struct ProjectionStats : public SpecificStats {
         ProjectionStats() { }
 
@@ -474,7 +581,7 @@ namespace mongo {
     };
 
     struct SortStats : public SpecificStats {
-        SortStats() : forcedFetches(0), memUsage(0), memLimit(0) { }
+        SortStats() : forcedFetches(0), memUsage(0), memLimit(0), spills(0), spilledBytes(0) { }
 
         virtual ~SortStats() { }
 
@@ -492,6 +599,12 @@ namespace mongo {
         // What's our memory limit?
         size_t memLimit;
 
+        // How many sorted runs were written to disk after the memory limit was exceeded?
+        size_t spills;
+
+        // How many bytes did those runs take on disk?
+        unsigned long long spilledBytes;
+
         // The number of results to return from the sort.
         size_t limit;
 
@@ -543,6 +656,47 @@ namespace mongo {
         size_t skip;
     };
 
+    struct SkipScanStats : public SpecificStats {
+        SkipScanStats() : indexVersion(0),
+                          direction(1),
+                          keysExamined(0),
+                          seeks(0),
+                          prefixes(0),
+                          dupsTested(0),
+                          dupsDropped(0) { }
+
+        virtual SpecificStats* clone() const {
+            SkipScanStats* specific = new SkipScanStats(*this);
+            specific->keyPattern = keyPattern.getOwned();
+            specific->indexBounds = indexBounds.getOwned();
+            return specific;
+        }
+
+        std::string indexName;
+
+        BSONObj keyPattern;
+
+        int indexVersion;
+
+        int direction;
+
+        // A BSON (opaque, ie. hands off other than toString() it) representation of the bounds
+        // used.
+        BSONObj indexBounds;
+
+        // Number of keys read, including those outside the bounds.
+        size_t keysExamined;
+
+        // Number of times the cursor was repositioned.
+        size_t seeks;
+
+        // Number of distinct values of the leading field with keys in bounds.
+        size_t prefixes;
+
+        size_t dupsTested;
+        size_t dupsDropped;
+    };
+
     struct IntervalStats {
 
         IntervalStats() :
@@ -601,7 +755,8 @@ namespace mongo {
               fastmod(false),
               fastmodinsert(false),
               inserted(false),
-              nInvalidateSkips(0) { }
+              nInvalidateSkips(0),
+              nSkippedLocked(0) { }
 
         virtual SpecificStats* clone() const {
             return new UpdateStats(*this);
@@ -636,10 +791,14 @@ namespace mongo {
         // be thrown out. The update stage skips over any results which do not have the
         // RecordId to update.
         size_t nInvalidateSkips;
+
+        // Documents passed over by a skipLocked update because of a write conflict.
+        size_t nSkippedLocked;
     };
 
     struct TextStats : public SpecificStats {
-        TextStats() : keysExamined(0), fetches(0), parsedTextQuery() { }
+        TextStats() : keysExamined(0), negatedKeysExamined(0), fetches(0), limit(0),
+                      parsedTextQuery() { }
 
         virtual SpecificStats* clone() const {
             TextStats* specific = new TextStats(*this);
@@ -650,8 +809,14 @@ namespace mongo {
 
         size_t keysExamined;
 
+        // Keys read for negated terms, to rule out the documents holding them without a fetch.
+        size_t negatedKeysExamined;
+
         size_t fetches;
 
+        // Nonzero if only this many of the best scoring documents were looked for.
+        size_t limit;
+
         // Human-readable form of the FTSQuery associated with the text stage.
         BSONObj parsedTextQuery;
 
@@ -0,0 +1,299 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/point_lookup.h"
+
+#include <algorithm>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/scoped_timer.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/storage/record_fetcher.h"
+
+namespace mongo {
+
+    using std::unique_ptr;
+    using std::vector;
+
+    // static
+    const char* PointLookupStage::kStageType = "POINT_LOOKUP";
+
+    PointLookupStage::PointLookupStage(OperationContext* txn,
+                                       const PointLookupParams& params,
+                                       WorkingSet* ws,
+                                       const MatchExpression* filter)
+        : _txn(txn),
+          _ws(ws),
+          _filter(filter),
+          _params(params),
+          _iam(params.descriptor->getIndexCatalog()->getIndex(params.descriptor)),
+          _keysLookedUp(0),
+          _nextResult(0),
+          _idRetrying(WorkingSet::INVALID_ID),
+          _commonStats(kStageType) {
+        _specificStats.indexName = _params.descriptor->indexName();
+        _specificStats.keyPattern = _params.descriptor->keyPattern();
+        _specificStats.indexVersion = _params.descriptor->version();
+        _specificStats.keysRequested = _params.keys.size();
+    }
+
+    PointLookupStage::~PointLookupStage() {
+        // Free the members of documents fetched early and never returned.
+        for (size_t i = _nextResult; i < _results.size(); ++i) {
+            if (WorkingSet::INVALID_ID != _results[i].id) {
+                _ws->free(_results[i].id);
+            }
+        }
+    }
+
+    bool PointLookupStage::isEOF() {
+        if (WorkingSet::INVALID_ID != _idRetrying) {
+            // We asked the parent for a page-in, but still haven't had a chance to return the
+            // paged in document
+            return false;
+        }
+
+        return _keysLookedUp >= _params.keys.size() && _nextResult >= _results.size();
+    }
+
+    PlanStage::StageState PointLookupStage::work(WorkingSetID* out) {
+        ++_commonStats.works;
+
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        if (isEOF()) { return PlanStage::IS_EOF; }
+
+        if (WorkingSet::INVALID_ID != _idRetrying) {
+            WorkingSetID id = _idRetrying;
+            _idRetrying = WorkingSet::INVALID_ID;
+            return fetchResult(id, out);
+        }
+
+        if (_keysLookedUp < _params.keys.size()) {
+            return lookUpKeys(out);
+        }
+
+        Result& result = _results[_nextResult++];
+        WorkingSetID id = result.id;
+        if (WorkingSet::INVALID_ID == id) {
+            id = _ws->allocate();
+            WorkingSetMember* member = _ws->get(id);
+            member->loc = result.loc;
+            member->state = WorkingSetMember::LOC_AND_IDX;
+        }
+
+        return fetchResult(id, out);
+    }
+
+    PlanStage::StageState PointLookupStage::lookUpKeys(WorkingSetID* out) {
+        try {
+            if (!_indexCursor) {
+                _indexCursor = _iam->newCursor(_txn);
+            }
+
+            while (_keysLookedUp < _params.keys.size()) {
+                boost::optional<IndexKeyEntry> kv =
+                    _indexCursor->seekExact(_params.keys[_keysLookedUp],
+                                            SortedDataInterface::Cursor::kWantLoc);
+                ++_keysLookedUp;
+
+                if (kv) {
+                    ++_specificStats.keysExamined;
+                    _results.push_back(Result(kv->loc));
+                }
+            }
+        }
+        catch (const WriteConflictException& wce) {
+            // The lookups resume from the key that conflicted.
+            *out = WorkingSet::INVALID_ID;
+            ++_commonStats.needYield;
+            return PlanStage::NEED_YIELD;
+        }
+
+        // Every key has been looked up, so the index cursor is no longer needed.
+        _indexCursor.reset();
+
+        std::sort(_results.begin(), _results.end());
+
+        // Keep one entry per document, freeing the members of any duplicates fetched early.
+        size_t numKept = 0;
+        for (size_t i = 0; i < _results.size(); ++i) {
+            if (numKept > 0 && _results[numKept - 1] == _results[i]) {
+                if (WorkingSet::INVALID_ID != _results[i].id) {
+                    _ws->free(_results[i].id);
+                }
+                continue;
+            }
+            _results[numKept++] = _results[i];
+        }
+        _results.resize(numKept);
+
+        ++_commonStats.needTime;
+        return PlanStage::NEED_TIME;
+    }
+
+    PlanStage::StageState PointLookupStage::fetchResult(WorkingSetID id, WorkingSetID* out) {
+        WorkingSetMember* member = _ws->get(id);
+
+        // A member fetched when its RecordId was invalidated already has its document.
+        if (!member->hasObj()) {
+            verify(WorkingSetMember::LOC_AND_IDX == member->state);
+            verify(member->hasLoc());
+
+            try {
+                if (!_cursor) _cursor = _params.collection->getCursor(_txn);
+
+                if (auto fetcher = _cursor->fetcherForId(member->loc)) {
+                    // There's something to fetch. Hand the fetcher off to the WSM, and pass up
+                    // a fetch request.
+                    _idRetrying = id;
+                    member->setFetcher(fetcher.release());
+                    *out = id;
+                    _commonStats.needYield++;
+                    return NEED_YIELD;
+                }
+
+                if (!WorkingSetCommon::fetch(_txn, member, _cursor)) {
+                    _ws->free(id);
+                    _commonStats.needTime++;
+                    return NEED_TIME;
+                }
+            }
+            catch (const WriteConflictException& wce) {
+                _idRetrying = id;
+                *out = WorkingSet::INVALID_ID;
+                _commonStats.needYield++;
+                return NEED_YIELD;
+            }
+        }
+
+        ++_specificStats.docsExamined;
+
+        if (Filter::passes(member, _filter)) {
+            *out = id;
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+
+        _ws->free(id);
+        ++_commonStats.needTime;
+        return PlanStage::NEED_TIME;
+    }
+
+    void PointLookupStage::saveState() {
+        _txn = NULL;
+        ++_commonStats.yields;
+        if (_indexCursor) _indexCursor->saveUnpositioned();
+        if (_cursor) _cursor->saveUnpositioned();
+    }
+
+    void PointLookupStage::restoreState(OperationContext* opCtx) {
+        invariant(_txn == NULL);
+        _txn = opCtx;
+        ++_commonStats.unyields;
+        if (_indexCursor) _indexCursor->restore(opCtx);
+        if (_cursor) _cursor->restore(opCtx);
+    }
+
+    void PointLookupStage::invalidate(OperationContext* txn,
+                                      const RecordId& dl,
+                                      InvalidationType type) {
+        ++_commonStats.invalidates;
+
+        // A mutation leaves the document where it is, and the filter is applied after fetching.
+        if (INVALIDATION_MUTATION == type) { return; }
+
+        // It's possible that the loc getting invalidated is the one we're about to
+        // fetch. In this case we do a "forced fetch" and put the WSM in owned object state.
+        if (WorkingSet::INVALID_ID != _idRetrying) {
+            WorkingSetMember* member = _ws->get(_idRetrying);
+            if (member->hasLoc() && (member->loc == dl)) {
+                WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _params.collection);
+            }
+        }
+
+        // The same goes for the documents not yet returned. Once every key has been looked up
+        // they are sorted, and only the run of entries for 'dl' needs to be examined.
+        const bool sorted = _keysLookedUp >= _params.keys.size();
+        vector<Result>::iterator it = _results.begin() + _nextResult;
+        if (sorted) {
+            it = std::lower_bound(it, _results.end(), Result(dl));
+        }
+
+        for (; it != _results.end(); ++it) {
+            if (it->loc != dl) {
+                if (sorted) { break; }
+                continue;
+            }
+
+            if (WorkingSet::INVALID_ID != it->id) { continue; }
+
+            it->id = _ws->allocate();
+            WorkingSetMember* member = _ws->get(it->id);
+            member->loc = dl;
+            member->state = WorkingSetMember::LOC_AND_IDX;
+            WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _params.collection);
+        }
+    }
+
+    vector<PlanStage*> PointLookupStage::getChildren() const {
+        vector<PlanStage*> empty;
+        return empty;
+    }
+
+    PlanStageStats* PointLookupStage::getStats() {
+        _commonStats.isEOF = isEOF();
+
+        // Add a BSON representation of the filter to the stats tree, if there is one.
+        if (NULL != _filter) {
+            BSONObjBuilder bob;
+            _filter->toBSON(&bob);
+            _commonStats.filter = bob.obj();
+        }
+
+        unique_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_POINT_LOOKUP));
+        ret->specific.reset(new PointLookupStats(_specificStats));
+        return ret.release();
+    }
+
+    const CommonStats* PointLookupStage::getCommonStats() const {
+        return &_commonStats;
+    }
+
+    const SpecificStats* PointLookupStage::getSpecificStats() const {
+        return &_specificStats;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,156 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/sorted_data_interface.h"
+
+namespace mongo {
+
+    class Collection;
+    class IndexAccessMethod;
+    class IndexDescriptor;
+    class RecordCursor;
+    class WorkingSet;
+
+    struct PointLookupParams {
+        PointLookupParams() : collection(NULL), descriptor(NULL) { }
+
+        const Collection* collection;
+
+        // A unique index, so that each key finds at most one document.
+        const IndexDescriptor* descriptor;
+
+        // The keys to look up, without field names.  Looked up in this order, which should be
+        // the index's order so that neighbouring keys are found close together.
+        std::vector<BSONObj> keys;
+    };
+
+    /**
+     * Answers queries such as {_id: {$in: [...]}} on unique indexes.  The first call to work()
+     * looks up every key with an exact seek rather than scanning each as an interval, and sorts
+     * the RecordIds found.  Later calls fetch the documents in RecordId order, which reads them in
+     * the order they lie in the collection, and return those which pass the filter.
+     *
+     * Results are therefore not in index order.
+     */
+    class PointLookupStage : public PlanStage {
+    public:
+        /**
+         * 'filter' is not owned and may be NULL.
+         */
+        PointLookupStage(OperationContext* txn,
+                         const PointLookupParams& params,
+                         WorkingSet* ws,
+                         const MatchExpression* filter);
+
+        virtual ~PointLookupStage();
+
+        virtual bool isEOF();
+        virtual StageState work(WorkingSetID* out);
+
+        virtual void saveState();
+        virtual void restoreState(OperationContext* opCtx);
+        virtual void invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type);
+
+        virtual std::vector<PlanStage*> getChildren() const;
+
+        virtual StageType stageType() const { return STAGE_POINT_LOOKUP; }
+
+        virtual PlanStageStats* getStats();
+
+        virtual const CommonStats* getCommonStats() const;
+
+        virtual const SpecificStats* getSpecificStats() const;
+
+        static const char* kStageType;
+
+    private:
+        /**
+         * A document found in the index and not yet returned.
+         */
+        struct Result {
+            explicit Result(const RecordId& loc) : loc(loc), id(WorkingSet::INVALID_ID) { }
+
+            bool operator<(const Result& other) const { return loc < other.loc; }
+            bool operator==(const Result& other) const { return loc == other.loc; }
+
+            RecordId loc;
+
+            // Set if the document had to be fetched when its RecordId was invalidated.
+            WorkingSetID id;
+        };
+
+        /**
+         * Looks up the keys not yet looked up.  Returns NEED_YIELD if a write conflict
+         * interrupted the lookups, which resume where they stopped.
+         */
+        StageState lookUpKeys(WorkingSetID* out);
+
+        /**
+         * Fetches the document for 'id' and returns it if it passes the filter.
+         */
+        StageState fetchResult(WorkingSetID id, WorkingSetID* out);
+
+        // transactional context for read locks. Not owned by us
+        OperationContext* _txn;
+
+        // The WorkingSet we annotate with results.  Not owned by us.
+        WorkingSet* _ws;
+
+        // The filter is not owned by us.
+        const MatchExpression* _filter;
+
+        PointLookupParams _params;
+        const IndexAccessMethod* _iam; // owned by Collection -> IndexCatalog
+
+        std::unique_ptr<SortedDataInterface::Cursor> _indexCursor;
+        std::unique_ptr<RecordCursor> _cursor;
+
+        // How many of _params.keys have been looked up.
+        size_t _keysLookedUp;
+
+        // The documents found. Sorted by RecordId once every key has been looked up.
+        std::vector<Result> _results;
+        size_t _nextResult;
+
+        // The member whose document is being paged in, if any.
+        WorkingSetID _idRetrying;
+
+        CommonStats _commonStats;
+        PointLookupStats _specificStats;
+    };
+
+}  // namespace mongo
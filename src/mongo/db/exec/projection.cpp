@@ -205,8 +205,8 @@ namespace mongo {
     PlanStage::StageState ProjectionStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         WorkingSetID id = WorkingSet::INVALID_ID;
         StageState status = _child->work(&id);
@@ -250,6 +250,65 @@ namespace mongo {
         return status;
     }
 
+    PlanStage::StageState ProjectionStage::workBatch(size_t maxWorks,
+                                                     std::vector<WorkingSetID>* results,
+                                                     WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        // The child appends straight to 'results', and we transform its results in place.
+        const size_t numBefore = results->size();
+        const size_t childWorksBefore = _child->getCommonStats()->works;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState status = _child->workBatch(maxWorks, results, &id);
+        const size_t childWorks = _child->getCommonStats()->works - childWorksBefore;
+        const size_t numResults = results->size() - numBefore;
+
+        _commonStats.works += childWorks;
+        _commonStats.needTime += childNeedTimes(childWorks, numResults, status);
+
+        for (size_t i = numBefore; i < results->size(); ++i) {
+            Status projStatus = transform(_ws->get((*results)[i]));
+            if (!projStatus.isOK()) {
+                warning() << "Couldn't execute projection, status = "
+                          << projStatus.toString() << endl;
+                // Nothing in this batch gets returned, so free it along with the child's status
+                // member, if any.
+                for (size_t j = numBefore; j < results->size(); ++j) {
+                    _ws->free((*results)[j]);
+                }
+                results->resize(numBefore);
+                if (WorkingSet::INVALID_ID != id
+                    && (PlanStage::FAILURE == status || PlanStage::DEAD == status)) {
+                    _ws->free(id);
+                }
+                *out = WorkingSetCommon::allocateStatusMember(_ws, projStatus);
+                return PlanStage::FAILURE;
+            }
+        }
+        _commonStats.advanced += numResults;
+
+        if (PlanStage::ADVANCED == status || PlanStage::NEED_TIME == status) {
+            return numResults > 0 ? PlanStage::ADVANCED : PlanStage::NEED_TIME;
+        }
+
+        if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+            *out = id;
+            if (WorkingSet::INVALID_ID == id) {
+                mongoutils::str::stream ss;
+                ss << "projection stage failed to read in results from child";
+                Status status(ErrorCodes::InternalError, ss);
+                *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+            }
+        }
+        else if (PlanStage::NEED_YIELD == status) {
+            ++_commonStats.needYield;
+            *out = id;
+        }
+
+        return status;
+    }
+
     void ProjectionStage::saveState() {
         ++_commonStats.yields;
         _child->saveState();
@@ -178,6 +178,20 @@ namespace mongo {
                 _arrayOpType = ARRAY_OP_POSITIONAL;
             }
         }
+
+        // Is this just a list of top-level fields to include?
+        if (1 == include_exclude && !_hasNonSimple && !_hasDottedField
+            && ARRAY_OP_NORMAL == _arrayOpType
+            && _fields.size() + 1 <= kMaxSimpleInclusionFields) {
+            if (_includeID) {
+                _simpleInclusionFields.push_back("_id");
+            }
+            for (FieldMap::const_iterator it = _fields.begin(); it != _fields.end(); ++it) {
+                if (it->first != "_id") {
+                    _simpleInclusionFields.push_back(it->first);
+                }
+            }
+        }
     }
 
     ProjectionExec::~ProjectionExec() {
@@ -254,6 +268,15 @@ namespace mongo {
             return Status::OK();
         }
 
+        if (!_simpleInclusionFields.empty() && member->hasObj()) {
+            member->obj = Snapshotted<BSONObj>(SnapshotId(),
+                                               transformSimpleInclusion(member->obj.value()));
+            member->state = WorkingSetMember::OWNED_OBJ;
+            member->keyData.clear();
+            member->loc = RecordId();
+            return Status::OK();
+        }
+
         BSONObjBuilder bob;
         if (member->hasObj()) {
             MatchDetails matchDetails;
@@ -353,6 +376,11 @@ namespace mongo {
     }
 
     Status ProjectionExec::transform(const BSONObj& in, BSONObj* out) const {
+        if (!_simpleInclusionFields.empty()) {
+            *out = transformSimpleInclusion(in);
+            return Status::OK();
+        }
+
         // If it's a positional projection we need a MatchDetails.
         MatchDetails matchDetails;
         if (transformRequiresDetails()) {
@@ -370,6 +398,37 @@ namespace mongo {
         return Status::OK();
     }
 
+    BSONObj ProjectionExec::transformSimpleInclusion(const BSONObj& in) const {
+        const size_t numFields = _simpleInclusionFields.size();
+
+        // The elements to include, in document order.
+        BSONElement found[kMaxSimpleInclusionFields];
+        size_t numFound = 0;
+        unsigned int seen = 0;
+        int size = 0;
+
+        BSONObjIterator it(in);
+        while (numFound < numFields && it.more()) {
+            BSONElement elt = it.next();
+            const StringData name = elt.fieldNameStringData();
+            for (size_t i = 0; i < numFields; ++i) {
+                if (!(seen & (1U << i)) && name == _simpleInclusionFields[i]) {
+                    seen |= (1U << i);
+                    found[numFound++] = elt;
+                    size += elt.size();
+                    break;
+                }
+            }
+        }
+
+        // Room for the elements, the length prefix and the terminating EOO.
+        BSONObjBuilder bob(size + 5);
+        for (size_t i = 0; i < numFound; ++i) {
+            bob.append(found[i]);
+        }
+        return bob.obj();
+    }
+
     Status ProjectionExec::transform(const BSONObj& in,
                                      BSONObjBuilder* bob,
                                      const MatchDetails* details) const {
@@ -120,6 +120,13 @@ namespace mongo {
                          BSONObjBuilder* bob,
                          const MatchDetails* details = NULL) const;
 
+        /**
+         * The fast path for simple inclusion projections: a single scan of 'in' which stops once
+         * every included field has been seen.  Like BSONObj::getField(), only the first of several
+         * same-named fields is included.  The result is allocated at its exact size.
+         */
+        BSONObj transformSimpleInclusion(const BSONObj& in) const;
+
         /**
          * See transform(...) above.
          */
@@ -196,6 +203,13 @@ namespace mongo {
         // Do we have a returnKey projection?  If so we *only* output the index key metadata.  If
         // it's not found we output nothing.
         bool _hasReturnKey;
+
+        // At most this many fields are handled by transformSimpleInclusion().
+        static const size_t kMaxSimpleInclusionFields = 32;
+
+        // The top-level fields, including _id unless excluded, if this projection only includes
+        // top-level fields. Empty otherwise.
+        std::vector<std::string> _simpleInclusionFields;
     };
 
 }  // namespace mongo
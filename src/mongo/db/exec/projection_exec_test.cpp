@@ -200,6 +200,24 @@ namespace {
         testTransform("{a: {$slice: [10, 10]}}", "{}", "{a: [4, 6, 8]}", true, "{a: []}");
     }
 
+    //
+    // Simple inclusion
+    //
+
+    TEST(ProjectionExecTest, TransformSimpleInclusion) {
+        const char* s = "{_id: 1, a: 1, b: [1, 2], c: {d: 3}, e: 'x'}";
+
+        testTransform("{a: 1}", "{}", s, true, "{_id: 1, a: 1}");
+        testTransform("{e: 1, a: 1}", "{}", s, true, "{_id: 1, a: 1, e: 'x'}");
+        testTransform("{b: 1, c: true, _id: 0}", "{}", s, true, "{b: [1, 2], c: {d: 3}}");
+        testTransform("{_id: 1, e: 1}", "{}", s, true, "{_id: 1, e: 'x'}");
+        testTransform("{z: 1, _id: 0}", "{}", s, true, "{}");
+        testTransform("{a: 1, z: 1}", "{}", "{a: 2, _id: 1}", true, "{a: 2, _id: 1}");
+
+        // Only the first of several same-named fields is included.
+        testTransform("{a: 1, _id: 0}", "{}", "{a: 1, b: 2, a: 3}", true, "{a: 1}");
+    }
+
     //
     // $meta
     // $meta projections add computed values to the projected object.
@@ -30,18 +30,61 @@
 
 #include "mongo/db/exec/scoped_timer.h"
 
-#include "mongo/util/net/listen.h"
+#include "mongo/config.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/util/concurrency/threadlocal.h"
+#include "mongo/util/system_tick_source.h"
 
 namespace mongo {
 
-    ScopedTimer::ScopedTimer(long long* counter) :
-        _counter(counter),
-        _start(Listener::getElapsedTimeMillis()) {
+    // These need to be outside the unnamed namespace due to the way TSP_DEFINE is defined.
+#if defined(MONGO_CONFIG_HAVE___THREAD)
+    __thread long long workingSetAllocations;
+    long long* getWorkingSetAllocations() {
+        return &workingSetAllocations;
+    }
+#elif defined(MONGO_CONFIG_HAVE___DECLSPEC_THREAD)
+    __declspec( thread ) long long workingSetAllocations;
+    long long* getWorkingSetAllocations() {
+        return &workingSetAllocations;
+    }
+#else
+    TSP_DEFINE(long long, workingSetAllocations);
+    long long* getWorkingSetAllocations() {
+        return workingSetAllocations.getMake();
+    }
+#endif
+
+namespace {
+
+    const long long kNanosPerSecond = 1000 * 1000 * 1000;
+
+    long long ticksToNanos(TickSource::Tick ticks) {
+        const TickSource::Tick ticksPerSecond = SystemTickSource::get()->getTicksPerSecond();
+        if (ticksPerSecond == kNanosPerSecond) {
+            return ticks;
+        }
+        return static_cast<long long>(static_cast<double>(ticks) * kNanosPerSecond
+                                      / ticksPerSecond);
+    }
+
+} // namespace
+
+    ScopedTimer::ScopedTimer(CommonStats* stats) :
+        _stats(stats),
+        _startTicks(SystemTickSource::get()->getTicks()),
+        _startAllocations(*getWorkingSetAllocations()) {
     }
 
     ScopedTimer::~ScopedTimer() {
-        long long elapsed = Listener::getElapsedTimeMillis() - _start;
-        *_counter += elapsed;
+        const TickSource::Tick elapsed = SystemTickSource::get()->getTicks() - _startTicks;
+        _stats->executionTimeNanos += ticksToNanos(elapsed);
+        _stats->workingSetAllocations += *getWorkingSetAllocations() - _startAllocations;
+    }
+
+    // static
+    void ScopedTimer::noteWorkingSetAllocation() {
+        ++*getWorkingSetAllocations();
     }
 
 }  // namespace mongo
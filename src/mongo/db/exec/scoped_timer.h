@@ -29,29 +29,40 @@
 #pragma once
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/util/tick_source.h"
 
 namespace mongo {
 
+    struct CommonStats;
+
     /**
-     * This class increments a counter by a rough estimate of the time elapsed since its
-     * construction when it goes out of scope.
+     * This class adds the time elapsed since its construction, in nanoseconds, and the number of
+     * working set members allocated on this thread meanwhile, to a stage's CommonStats when it
+     * goes out of scope. Timers of child stages run within those of their parents, so both
+     * counts include the children's.
      */
     class ScopedTimer {
         MONGO_DISALLOW_COPYING(ScopedTimer);
     public:
-        ScopedTimer(long long* counter);
+        ScopedTimer(CommonStats* stats);
 
         ~ScopedTimer();
 
+        /**
+         * Counts an allocation from a WorkingSet on this thread.
+         */
+        static void noteWorkingSetAllocation();
+
     private:
         // Default constructor disallowed.
         ScopedTimer();
 
-        // Reference to the counter that we are incrementing with the elapsed time.
-        long long* _counter;
+        // The stats that we are adding to.
+        CommonStats* _stats;
 
-        // Time at which the timer was constructed.
-        long long _start;
+        // Tick count and allocation count at which the timer was constructed.
+        TickSource::Tick _startTicks;
+        long long _startAllocations;
     };
 
 }  // namespace mongo
@@ -27,6 +27,9 @@
 */
 
 #include "mongo/db/exec/skip.h"
+
+#include <algorithm>
+
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/util/mongoutils/str.h"
@@ -49,8 +52,8 @@ namespace mongo {
     PlanStage::StageState SkipStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         WorkingSetID id = WorkingSet::INVALID_ID;
         StageState status = _child->work(&id);
@@ -94,6 +97,56 @@ namespace mongo {
         return status;
     }
 
+    PlanStage::StageState SkipStage::workBatch(size_t maxWorks,
+                                               std::vector<WorkingSetID>* results,
+                                               WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        const size_t numBefore = results->size();
+        const size_t childWorksBefore = _child->getCommonStats()->works;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState status = _child->workBatch(maxWorks, results, &id);
+        const size_t childWorks = _child->getCommonStats()->works - childWorksBefore;
+        const size_t numProduced = results->size() - numBefore;
+
+        // Drop the results we're still skipping. Each counts as a NEED_TIME, as in work().
+        const size_t numSkipped = std::min(numProduced, size_t(_toSkip));
+        if (numSkipped > 0) {
+            for (size_t i = numBefore; i < numBefore + numSkipped; ++i) {
+                _ws->free((*results)[i]);
+            }
+            results->erase(results->begin() + numBefore,
+                           results->begin() + numBefore + numSkipped);
+            _toSkip -= numSkipped;
+        }
+
+        const size_t numResults = numProduced - numSkipped;
+        _commonStats.works += childWorks;
+        _commonStats.advanced += numResults;
+        _commonStats.needTime += numSkipped + childNeedTimes(childWorks, numProduced, status);
+
+        if (PlanStage::ADVANCED == status || PlanStage::NEED_TIME == status) {
+            return numResults > 0 ? PlanStage::ADVANCED : PlanStage::NEED_TIME;
+        }
+
+        if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+            *out = id;
+            if (WorkingSet::INVALID_ID == id) {
+                mongoutils::str::stream ss;
+                ss << "skip stage failed to read in results from child";
+                Status status(ErrorCodes::InternalError, ss);
+                *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+            }
+        }
+        else if (PlanStage::NEED_YIELD == status) {
+            ++_commonStats.needYield;
+            *out = id;
+        }
+
+        return status;
+    }
+
     void SkipStage::saveState() {
         ++_commonStats.yields;
         _child->saveState();
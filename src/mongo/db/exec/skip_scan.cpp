@@ -0,0 +1,215 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/skip_scan.h"
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/scoped_timer.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+
+namespace mongo {
+
+    using std::unique_ptr;
+    using std::vector;
+
+    // static
+    const char* SkipScan::kStageType = "SKIP_SCAN";
+
+    SkipScan::SkipScan(OperationContext* txn, const SkipScanParams& params, WorkingSet* workingSet)
+        : _txn(txn),
+          _workingSet(workingSet),
+          _descriptor(params.descriptor),
+          _iam(params.descriptor->getIndexCatalog()->getIndex(params.descriptor)),
+          _keyPattern(params.descriptor->keyPattern().getOwned()),
+          _params(params),
+          _checker(&_params.bounds, _keyPattern, _params.direction),
+          _needSeek(true),
+          _shouldDedup(false),
+          _commonStats(kStageType) {
+
+        _specificStats.keyPattern = _keyPattern;
+        _specificStats.indexName = _descriptor->indexName();
+        _specificStats.indexVersion = _descriptor->version();
+        _specificStats.direction = _params.direction;
+        _specificStats.indexBounds = _params.bounds.toBSON();
+
+        // Set up our initial seek. If there is no valid data, just mark as EOF.
+        _commonStats.isEOF = !_checker.getStartSeekPoint(&_seekPoint);
+    }
+
+    PlanStage::StageState SkipScan::work(WorkingSetID* out) {
+        ++_commonStats.works;
+        if (_commonStats.isEOF) return PlanStage::IS_EOF;
+
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
+
+        boost::optional<IndexKeyEntry> kv;
+        try {
+            if (!_cursor) {
+                _cursor = _iam->newCursor(_txn, _params.direction == 1);
+                _cursor->allowUnownedKeys();
+
+                // TODO it is incorrect to rely on this not changing. SERVER-17678
+                _shouldDedup = _descriptor->isMultikey(_txn);
+            }
+
+            if (_needSeek) {
+                ++_specificStats.seeks;
+                kv = _cursor->seek(_seekPoint);
+            }
+            else {
+                kv = _cursor->next();
+            }
+        }
+        catch (const WriteConflictException& wce) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+
+        if (!kv) {
+            _commonStats.isEOF = true;
+            _cursor.reset();
+            return PlanStage::IS_EOF;
+        }
+
+        ++_specificStats.keysExamined;
+
+        switch (_checker.checkKey(kv->key, &_seekPoint)) {
+        case IndexBoundsChecker::MUST_ADVANCE:
+            // Either the trailing fields are outside their bounds for this prefix, or we are
+            // done with the prefix. The checker has set the _seekPoint to the next possible key.
+            _needSeek = true;
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+
+        case IndexBoundsChecker::DONE:
+            // There won't be a next time.
+            _commonStats.isEOF = true;
+            _cursor.reset();
+            return PlanStage::IS_EOF;
+
+        case IndexBoundsChecker::VALID:
+            break;
+        }
+
+        // The following keys may be in bounds too, so step to them.
+        _needSeek = false;
+
+        const BSONElement prefix = kv->key.firstElement();
+        if (_lastPrefix.isEmpty() || 0 != prefix.woCompare(_lastPrefix.firstElement(), false)) {
+            ++_specificStats.prefixes;
+            _lastPrefix = prefix.wrap();
+        }
+
+        if (_shouldDedup) {
+            ++_specificStats.dupsTested;
+            if (!_returned.insert(kv->loc).second) {
+                // We've seen this RecordId before. Skip it this time.
+                ++_specificStats.dupsDropped;
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        // Package up the result for the caller.
+        WorkingSetID id = _workingSet->allocate();
+        WorkingSetMember* member = _workingSet->get(id);
+        member->loc = kv->loc;
+        member->appendKeyDatum(_keyPattern, kv->key, _iam);
+        member->state = WorkingSetMember::LOC_AND_IDX;
+
+        *out = id;
+        ++_commonStats.advanced;
+        return PlanStage::ADVANCED;
+    }
+
+    bool SkipScan::isEOF() {
+        return _commonStats.isEOF;
+    }
+
+    void SkipScan::saveState() {
+        _txn = NULL;
+        ++_commonStats.yields;
+
+        if (!_cursor) return;
+
+        // If we are going to seek anyway we don't care where the cursor is.
+        if (_needSeek) {
+            _cursor->saveUnpositioned();
+            return;
+        }
+
+        _cursor->savePositioned();
+    }
+
+    void SkipScan::restoreState(OperationContext* opCtx) {
+        invariant(_txn == NULL);
+        _txn = opCtx;
+        ++_commonStats.unyields;
+
+        if (_cursor) _cursor->restore(opCtx);
+    }
+
+    void SkipScan::invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {
+        ++_commonStats.invalidates;
+
+        // The only state we're responsible for holding is what RecordIds to drop.
+        if (INVALIDATION_MUTATION == type) {
+            return;
+        }
+
+        // If we see this RecordId again, it may not be the same document it was before, so we
+        // want to return it if we see it again.
+        _returned.erase(dl);
+    }
+
+    vector<PlanStage*> SkipScan::getChildren() const {
+        vector<PlanStage*> empty;
+        return empty;
+    }
+
+    PlanStageStats* SkipScan::getStats() {
+        unique_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_SKIP_SCAN));
+        ret->specific.reset(new SkipScanStats(_specificStats));
+        return ret.release();
+    }
+
+    const CommonStats* SkipScan::getCommonStats() const {
+        return &_commonStats;
+    }
+
+    const SpecificStats* SkipScan::getSpecificStats() const {
+        return &_specificStats;
+    }
+
+}  // namespace mongo
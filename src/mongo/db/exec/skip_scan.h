@@ -0,0 +1,133 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/platform/unordered_set.h"
+
+namespace mongo {
+
+    class IndexAccessMethod;
+    class IndexDescriptor;
+    class WorkingSet;
+
+    struct SkipScanParams {
+        SkipScanParams() : descriptor(NULL),
+                           direction(1) { }
+
+        // What index are we traversing?
+        const IndexDescriptor* descriptor;
+
+        // And in what direction?
+        int direction;
+
+        // What are the bounds?  The leading field is usually unbounded.
+        IndexBounds bounds;
+    };
+
+    /**
+     * Answers predicates on the trailing fields of a compound index which has no predicate on its
+     * leading field, e.g. {ts: {$gt: X}} with an index {tenant: 1, ts: 1}.  For each distinct
+     * value of the leading field, the stage seeks to the start of the trailing bounds, returns
+     * the keys within them and then seeks past that leading value.  This reads far fewer keys
+     * than a whole index scan when the leading field has few distinct values.
+     *
+     * Returns every key within the bounds, deduplicating on RecordId if the index is multikey.
+     *
+     * Only created by the planner when the index statistics show a leading field with few
+     * distinct values.  See QueryPlannerAccess::makeSkipScan().
+     */
+    class SkipScan : public PlanStage {
+    public:
+        SkipScan(OperationContext* txn, const SkipScanParams& params, WorkingSet* workingSet);
+        virtual ~SkipScan() { }
+
+        virtual StageState work(WorkingSetID* out);
+        virtual bool isEOF();
+        virtual void saveState();
+        virtual void restoreState(OperationContext* opCtx);
+        virtual void invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type);
+
+        virtual std::vector<PlanStage*> getChildren() const;
+
+        virtual StageType stageType() const { return STAGE_SKIP_SCAN; }
+
+        virtual PlanStageStats* getStats();
+
+        virtual const CommonStats* getCommonStats() const;
+
+        virtual const SpecificStats* getSpecificStats() const;
+
+        static const char* kStageType;
+
+    private:
+        // transactional context for read locks. Not owned by us
+        OperationContext* _txn;
+
+        // The WorkingSet we annotate with results.  Not owned by us.
+        WorkingSet* _workingSet;
+
+        // Index access.
+        const IndexDescriptor* _descriptor; // owned by Collection -> IndexCatalog
+        const IndexAccessMethod* _iam; // owned by Collection -> IndexCatalog
+        BSONObj _keyPattern;
+
+        // The cursor we use to navigate the tree.
+        std::unique_ptr<SortedDataInterface::Cursor> _cursor;
+
+        SkipScanParams _params;
+
+        // _checker gives us our start key, ensures we stay in bounds and tells us where to seek
+        // when a key is outside them.
+        IndexBoundsChecker _checker;
+        IndexSeekPoint _seekPoint;
+
+        // Is the next key found by seeking to _seekPoint rather than by advancing the cursor?
+        bool _needSeek;
+
+        // The leading field of the last key returned, used to count the distinct prefixes.
+        BSONObj _lastPrefix;
+
+        // Set if the index is multikey, in which case a document may have several keys in bounds.
+        bool _shouldDedup;
+        unordered_set<RecordId, RecordId::Hasher> _returned;
+
+        // Stats
+        CommonStats _commonStats;
+        SkipScanStats _specificStats;
+    };
+
+}  // namespace mongo
@@ -41,6 +41,7 @@
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage_options.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -49,6 +50,50 @@ namespace mongo {
     using std::endl;
     using std::vector;
 
+    /**
+     * Orders the (sort key + RecordId, document) pairs spilled by SortStage.  Equivalent to
+     * SortStage::WorkingSetComparator: 'pattern' is the sort comparator extended with an
+     * ascending field matching the trailing RecordId of each key.
+     */
+    class SortStageSpillComparator {
+    public:
+        typedef std::pair<BSONObj, BSONObj> Data;
+
+        explicit SortStageSpillComparator(const BSONObj& pattern) : _pattern(pattern) { }
+
+        int operator()(const Data& lhs, const Data& rhs) const {
+            // False means ignore field names.
+            return lhs.first.woCompare(rhs.first, _pattern, false);
+        }
+
+    private:
+        BSONObj _pattern;
+    };
+
+namespace {
+
+    /**
+     * Computed data such as text scores lives only in the WorkingSet, so a member carrying any
+     * cannot be spilled to disk.
+     */
+    bool hasComputedData(const WorkingSetMember& member) {
+        for (int i = 0; i < WSM_COMPUTED_NUM_TYPES; ++i) {
+            if (member.hasComputed(static_cast<WorkingSetComputedDataType>(i))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Status sortMemoryLimitStatus(size_t maxBytes) {
+        mongoutils::str::stream ss;
+        ss << "Sort operation used more than the maximum " << maxBytes
+           << " bytes of RAM. Add an index, or specify a smaller limit.";
+        return Status(ErrorCodes::OperationFailed, ss);
+    }
+
+}  // namespace
+
     // static
     const char* SortStage::kStageType = "SORT";
 
@@ -303,6 +348,11 @@ namespace mongo {
     SortStage::~SortStage() { }
 
     bool SortStage::isEOF() {
+        // Spilled results are only read back once the child is exhausted.
+        if (_spilledIterator) {
+            return !_spilledIterator->more();
+        }
+
         // We're done when our child has no more results, we've sorted the child's results, and
         // we've returned all sorted results.
         return _child->isEOF() && _sorted && (_data.end() == _resultIterator);
@@ -311,8 +361,8 @@ namespace mongo {
     PlanStage::StageState SortStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (NULL == _sortKeyGen) {
             // This is heavy and should be done as part of work().
@@ -329,12 +379,11 @@ namespace mongo {
 
         const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes);
         if (_memUsage > maxBytes) {
-            mongoutils::str::stream ss;
-            ss << "Sort operation used more than the maximum " << maxBytes
-               << " bytes of RAM. Add an index, or specify a smaller limit.";
-            Status status(ErrorCodes::OperationFailed, ss);
-            *out = WorkingSetCommon::allocateStatusMember( _ws, status);
-            return PlanStage::FAILURE;
+            if (!internalQueryExecAllowBlockingSortSpill || !spillBuffer()) {
+                *out = WorkingSetCommon::allocateStatusMember(_ws,
+                                                              sortMemoryLimitStatus(maxBytes));
+                return PlanStage::FAILURE;
+            }
         }
 
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -371,7 +420,17 @@ namespace mongo {
                     item.loc = member->loc;
                 }
 
-                addToBuffer(item);
+                if (_sorter) {
+                    if (hasComputedData(*member)) {
+                        *out = WorkingSetCommon::allocateStatusMember(_ws,
+                                                                      sortMemoryLimitStatus(maxBytes));
+                        return PlanStage::FAILURE;
+                    }
+                    addToSorter(id, item.sortKey);
+                }
+                else {
+                    addToBuffer(item);
+                }
 
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
@@ -379,8 +438,16 @@ namespace mongo {
             else if (PlanStage::IS_EOF == code) {
                 // TODO: We don't need the lock for this.  We could ask for a yield and do this work
                 // unlocked.  Also, this is performing a lot of work for one call to work(...)
-                sortBuffer();
-                _resultIterator = _data.begin();
+                if (_sorter) {
+                    _spilledIterator.reset(_sorter->done());
+                    _specificStats.spills = _sorter->numFiles();
+                    _specificStats.spilledBytes = _sorter->bytesSpilled();
+                    _sorter.reset();
+                }
+                else {
+                    sortBuffer();
+                    _resultIterator = _data.begin();
+                }
                 _sorted = true;
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
@@ -410,6 +477,36 @@ namespace mongo {
         }
 
         // Returning results.
+        if (_spilledIterator) {
+            SpillSorter::Data data = _spilledIterator->next();
+
+            // The last field of the key is the RecordId appended by addToSorter().
+            RecordId loc;
+            BSONObjIterator keyIt(data.first);
+            while (keyIt.more()) {
+                BSONElement elt = keyIt.next();
+                if (!keyIt.more()) {
+                    loc = RecordId(elt.numberLong());
+                }
+            }
+
+            *out = _ws->allocate();
+            WorkingSetMember* member = _ws->get(*out);
+            member->obj = Snapshotted<BSONObj>(SnapshotId(), data.second);
+            if (!loc.isNull() && 0 == _invalidatedSpilledLocs.erase(loc)) {
+                // The document may be older than what is now stored at 'loc', so it is owned
+                // and carries a null snapshot id, forcing anyone who writes to refetch it.
+                member->loc = loc;
+                member->state = WorkingSetMember::LOC_AND_OWNED_OBJ;
+            }
+            else {
+                member->state = WorkingSetMember::OWNED_OBJ;
+            }
+
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+
         verify(_resultIterator != _data.end());
         verify(_sorted);
         *out = _resultIterator->wsid;
@@ -461,6 +558,12 @@ namespace mongo {
             _wsidByDiskLoc.erase(it);
             ++_specificStats.forcedFetches;
         }
+        else if (_sorter || _spilledIterator) {
+            // The document may be sitting in a spill file. We can't reach it there, but the copy
+            // we wrote is exactly what fetchAndInvalidateLoc would have kept, so we only need to
+            // remember to drop its RecordId when we return it.
+            _invalidatedSpilledLocs.insert(dl);
+        }
     }
 
     vector<PlanStage*> SortStage::getChildren() const {
@@ -474,6 +577,11 @@ namespace mongo {
         const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes);
         _specificStats.memLimit = maxBytes;
         _specificStats.memUsage = _memUsage;
+        if (_sorter) {
+            _specificStats.memUsage += _sorter->memUsed();
+            _specificStats.spills = _sorter->numFiles();
+            _specificStats.spilledBytes = _sorter->bytesSpilled();
+        }
         _specificStats.limit = _limit;
         _specificStats.sortPattern = _pattern.getOwned();
 
@@ -574,6 +682,76 @@ namespace mongo {
         }
     }
 
+    bool SortStage::spillBuffer() {
+        invariant(!_sorter);
+
+        if (_limit > 1) {
+            for (SortableDataItemSet::const_iterator it = _dataSet->begin();
+                 it != _dataSet->end(); ++it) {
+                if (hasComputedData(*_ws->get(it->wsid))) {
+                    return false;
+                }
+            }
+        }
+        else {
+            for (size_t i = 0; i < _data.size(); ++i) {
+                if (hasComputedData(*_ws->get(_data[i].wsid))) {
+                    return false;
+                }
+            }
+        }
+
+        const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes);
+        SortOptions opts;
+        opts.limit = _limit;
+        opts.maxMemoryUsageBytes = maxBytes;
+        opts.extSortAllowed = true;
+        opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+
+        BSONObjBuilder patternBob;
+        patternBob.appendElements(_sortKeyGen->getSortComparator());
+        patternBob.append("$recordId", 1);
+        _sorter.reset(SpillSorter::make(opts, SortStageSpillComparator(patternBob.obj())));
+
+        LOG(1) << "Sort operation exceeded " << maxBytes << " bytes of RAM, spilling to "
+               << opts.tempDir;
+
+        if (_limit > 1) {
+            for (SortableDataItemSet::const_iterator it = _dataSet->begin();
+                 it != _dataSet->end(); ++it) {
+                addToSorter(it->wsid, it->sortKey);
+            }
+            _dataSet->clear();
+        }
+        else {
+            for (size_t i = 0; i < _data.size(); ++i) {
+                addToSorter(_data[i].wsid, _data[i].sortKey);
+            }
+            std::vector<SortableDataItem>().swap(_data);
+        }
+
+        _memUsage = 0;
+        return true;
+    }
+
+    void SortStage::addToSorter(WorkingSetID wsid, const BSONObj& sortKey) {
+        WorkingSetMember* member = _ws->get(wsid);
+
+        // Indices use RecordId as an additional sort key so our spilled keys must as well.
+        BSONObjBuilder keyBob;
+        keyBob.appendElements(sortKey);
+        const RecordId loc = member->hasLoc() ? member->loc : RecordId();
+        keyBob.append("", static_cast<long long>(loc.repr()));
+
+        if (member->hasLoc()) {
+            _wsidByDiskLoc.erase(member->loc);
+            _invalidatedSpilledLocs.erase(member->loc);
+        }
+
+        _sorter->add(keyBob.obj(), member->obj.value().getOwned());
+        _ws->free(wsid);
+    }
+
     void SortStage::sortBuffer() {
         if (_limit == 0) {
             const WorkingSetComparator& cmp = *_sortKeyComparator;
@@ -594,3 +772,6 @@ namespace mongo {
     }
 
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
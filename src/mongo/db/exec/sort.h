@@ -36,7 +36,9 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
+#include "mongo/platform/unordered_set.h"
 
 
 namespace mongo {
@@ -138,6 +140,12 @@ namespace mongo {
      *
      * Preconditions: For each field in 'pattern', all inputs in the child must handle a
      * getFieldDotted for that field.
+     *
+     * Results are buffered in the WorkingSet until they use more than
+     * internalQueryExecMaxBlockingSortBytes.  Past that point, if
+     * internalQueryExecAllowBlockingSortSpill is set, the buffered results are handed to an
+     * external Sorter which spills sorted runs to the temp directory and merges them once the
+     * child is exhausted.
      */
     class SortStage : public PlanStage {
     public:
@@ -231,6 +239,19 @@ namespace mongo {
          */
         void addToBuffer(const SortableDataItem& item);
 
+        /**
+         * Moves everything buffered so far into '_sorter', freeing the WSMs.  Returns false and
+         * leaves the buffer untouched if spilling isn't possible, e.g. because a buffered member
+         * carries computed data that cannot be written to disk.
+         */
+        bool spillBuffer();
+
+        /**
+         * Adds the member 'wsid' with sort key 'sortKey' to '_sorter' and frees it from the
+         * WorkingSet.
+         */
+        void addToSorter(WorkingSetID wsid, const BSONObj& sortKey);
+
         /**
          * Sorts data buffer.
          * Assumes no more items will be added to buffer.
@@ -261,6 +282,25 @@ namespace mongo {
         typedef unordered_map<RecordId, WorkingSetID, RecordId::Hasher> DataMap;
         DataMap _wsidByDiskLoc;
 
+        //
+        // External sort
+        //
+
+        // Keys are the sort key with the RecordId appended as a final tie-breaking field. Values
+        // are owned copies of the documents.
+        typedef Sorter<BSONObj, BSONObj> SpillSorter;
+
+        // Non-NULL once the buffered data has exceeded the memory limit and been spilled.
+        std::unique_ptr<SpillSorter> _sorter;
+
+        // Reads the merged output of '_sorter' once the child is exhausted.
+        std::unique_ptr<SpillSorter::Iterator> _spilledIterator;
+
+        // RecordIds invalidated after their documents were handed to '_sorter'. Those documents
+        // are returned as owned objects without a RecordId, like a fetched-and-invalidated WSM.
+        typedef unordered_set<RecordId, RecordId::Hasher> RecordIdSet;
+        RecordIdSet _invalidatedSpilledLocs;
+
         //
         // Stats
         //
@@ -108,9 +108,9 @@ namespace mongo {
     }
 
     Status SubplanStage::planSubqueries() {
-        // Adds the amount of time taken by planSubqueries() to executionTimeMillis. There's lots of
+        // Adds the amount of time taken by planSubqueries() to executionTimeNanos. There's lots of
         // work that happens here, so this is needed for the time accounting to make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         MatchExpression* orExpr = _query->root();
 
@@ -446,9 +446,9 @@ namespace mongo {
     }
 
     Status SubplanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
-        // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
+        // Adds the amount of time taken by pickBestPlan() to executionTimeNanos. There's lots of
         // work that happens here, so this is needed for the time accounting to make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats);
 
         // Plan each branch of the $or.
         Status subplanningStatus = planSubqueries();
@@ -475,8 +475,8 @@ namespace mongo {
     PlanStage::StageState SubplanStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/text.h"
 
+#include <algorithm>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
@@ -38,6 +40,7 @@
 #include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 
@@ -60,10 +63,17 @@ namespace mongo {
           _commonStats(kStageType),
           _internalState(INIT_SCANS),
           _currentIndexScanner(0),
-          _idRetrying(WorkingSet::INVALID_ID) {
+          _currentNegatedScanner(0),
+          _negatedTermsResolved(false),
+          _idRetrying(WorkingSet::INVALID_ID),
+          _topK(false),
+          _numScannersEOF(0),
+          _termKeysRead(0),
+          _nextTopKCheck(0) {
         _scoreIterator = _scores.end();
         _specificStats.indexPrefix = _params.indexPrefix;
         _specificStats.indexName = _params.index->indexName();
+        _specificStats.limit = _params.limit;
     }
 
     TextStage::~TextStage() { }
@@ -75,8 +85,8 @@ namespace mongo {
     PlanStage::StageState TextStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
         invariant(_internalState != DONE);
@@ -92,11 +102,15 @@ namespace mongo {
                 // Reset and try again next time.
                 _internalState = INIT_SCANS;
                 _scanners.clear();
+                _negatedScanners.clear();
                 *out = WorkingSet::INVALID_ID;
                 stageState = NEED_YIELD;
             }
             break;
 
+        case READING_NEGATED_TERMS:
+            stageState = readNegatedTerms(out);
+            break;
         case READING_TERMS:
             stageState = readFromSubScanners(out);
             break;
@@ -133,6 +147,9 @@ namespace mongo {
         for (size_t i = 0; i < _scanners.size(); ++i) {
             _scanners.mutableVector()[i]->saveState();
         }
+        for (size_t i = 0; i < _negatedScanners.size(); ++i) {
+            _negatedScanners.mutableVector()[i]->saveState();
+        }
 
         if (_recordCursor) _recordCursor->saveUnpositioned();
     }
@@ -145,6 +162,9 @@ namespace mongo {
         for (size_t i = 0; i < _scanners.size(); ++i) {
             _scanners.mutableVector()[i]->restoreState(opCtx);
         }
+        for (size_t i = 0; i < _negatedScanners.size(); ++i) {
+            _negatedScanners.mutableVector()[i]->restoreState(opCtx);
+        }
 
         if (_recordCursor) invariant(_recordCursor->restore(opCtx));
     }
@@ -156,6 +176,14 @@ namespace mongo {
         for (size_t i = 0; i < _scanners.size(); ++i) {
             _scanners.mutableVector()[i]->invalidate(txn, dl, type);
         }
+        for (size_t i = 0; i < _negatedScanners.size(); ++i) {
+            _negatedScanners.mutableVector()[i]->invalidate(txn, dl, type);
+        }
+
+        // The document may have gained or lost a negated term since its keys were read.
+        if (_negatedTermsResolved || READING_NEGATED_TERMS == _internalState) {
+            _negatedUnknown.insert(dl);
+        }
 
         // We store the score keyed by RecordId.  We have to toss out our state when the RecordId
         // changes.
@@ -210,21 +238,7 @@ namespace mongo {
         for (std::set<std::string>::const_iterator it = _params.query.getTermsForBounds().begin();
              it != _params.query.getTermsForBounds().end();
              ++it) {
-            const string& term = *it;
-            IndexScanParams params;
-            params.bounds.startKey = FTSIndexFormat::getIndexKey(MAX_WEIGHT,
-                                                                 term,
-                                                                 _params.indexPrefix,
-                                                                 _params.spec.getTextIndexVersion());
-            params.bounds.endKey = FTSIndexFormat::getIndexKey(0,
-                                                               term,
-                                                                _params.indexPrefix,
-                                                               _params.spec.getTextIndexVersion());
-            params.bounds.endKeyInclusive = true;
-            params.bounds.isSimpleRange = true;
-            params.descriptor = _params.index;
-            params.direction = -1;
-            _scanners.mutableVector().push_back(new IndexScan(_txn, params, _ws, NULL));
+            _scanners.mutableVector().push_back(newTermScan(*it));
         }
 
         // If we have no terms we go right to EOF.
@@ -233,15 +247,107 @@ namespace mongo {
             return PlanStage::IS_EOF;
         }
 
+        // Reading the keys of the negated terms first saves fetching the documents which hold
+        // them, and matching the others for them.
+        if (internalQueryTextMaxNegatedTermKeys > 0 && _ftsMatcher.negatedTermsAreIndexKeys()) {
+            const std::set<std::string>& negatedTerms = _params.query.getNegatedTerms();
+            for (std::set<std::string>::const_iterator it = negatedTerms.begin();
+                 it != negatedTerms.end();
+                 ++it) {
+                _negatedScanners.mutableVector().push_back(newTermScan(*it));
+            }
+        }
+
+        // Which terms were read for a document is kept in a 64 bit mask.
+        _topK = _params.limit > 0 && _scanners.size() <= 64;
+        if (_topK) {
+            _termScoreBounds.assign(_scanners.size(), MAX_WEIGHT);
+            _scannerEOF.assign(_scanners.size(), false);
+            _numScannersEOF = 0;
+            _termKeysRead = 0;
+            _nextTopKCheck = _params.limit * _scanners.size();
+        }
+
         // Transition to the next state.
-        _internalState = READING_TERMS;
+        _currentNegatedScanner = 0;
+        _internalState = _negatedScanners.empty() ? READING_TERMS : READING_NEGATED_TERMS;
         return PlanStage::NEED_TIME;
     }
 
+    PlanStage* TextStage::newTermScan(const string& term) {
+        IndexScanParams params;
+        params.bounds.startKey = FTSIndexFormat::getIndexKey(MAX_WEIGHT,
+                                                             term,
+                                                             _params.indexPrefix,
+                                                             _params.spec.getTextIndexVersion());
+        params.bounds.endKey = FTSIndexFormat::getIndexKey(0,
+                                                           term,
+                                                           _params.indexPrefix,
+                                                           _params.spec.getTextIndexVersion());
+        params.bounds.endKeyInclusive = true;
+        params.bounds.isSimpleRange = true;
+        params.descriptor = _params.index;
+        params.direction = -1;
+        return new IndexScan(_txn, params, _ws, NULL);
+    }
+
+    PlanStage::StageState TextStage::readNegatedTerms(WorkingSetID* out) {
+        if (_currentNegatedScanner == _negatedScanners.size()) {
+            // Every document with a negated term is known.
+            _negatedTermsResolved = true;
+            _negatedScanners.clear();
+            _internalState = READING_TERMS;
+            return PlanStage::NEED_TIME;
+        }
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState childState = _negatedScanners.vector()[_currentNegatedScanner]->work(&id);
+
+        if (PlanStage::ADVANCED == childState) {
+            _negatedDocs.insert(_ws->get(id)->loc);
+            _ws->free(id);
+
+            ++_specificStats.negatedKeysExamined;
+            if (_specificStats.negatedKeysExamined >
+                static_cast<size_t>(internalQueryTextMaxNegatedTermKeys)) {
+                // The negated terms are common enough that matching the documents for them is
+                // cheaper.
+                _negatedDocs.clear();
+                _negatedUnknown.clear();
+                _negatedScanners.clear();
+                _internalState = READING_TERMS;
+            }
+            return PlanStage::NEED_TIME;
+        }
+        else if (PlanStage::IS_EOF == childState) {
+            ++_currentNegatedScanner;
+            return PlanStage::NEED_TIME;
+        }
+
+        // Propagate WSID from below.
+        *out = id;
+        if (PlanStage::FAILURE == childState && WorkingSet::INVALID_ID == id) {
+            mongoutils::str::stream ss;
+            ss << "text stage failed to read in negated terms from child";
+            Status status(ErrorCodes::InternalError, ss);
+            *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+        }
+        return childState;
+    }
+
+    bool TextStage::mustMatchNegatedTerms(const RecordId& loc) const {
+        return !_negatedTermsResolved || _negatedUnknown.count(loc) > 0;
+    }
+
     PlanStage::StageState TextStage::readFromSubScanners(WorkingSetID* out) {
         // This should be checked before we get here.
         invariant(_currentIndexScanner < _scanners.size());
 
+        if (_topK && _idRetrying == WorkingSet::INVALID_ID &&
+            (_numScannersEOF == _scanners.size() || _termKeysRead >= _nextTopKCheck)) {
+            return checkTopK(out);
+        }
+
         // Either retry the last WSM we worked on or get a new one from our current scanner.
         WorkingSetID id;
         StageState childState;
@@ -255,7 +361,20 @@ namespace mongo {
         }
 
         if (PlanStage::ADVANCED == childState) {
-            return addTerm(id, out);
+            StageState stageState = addTerm(id, out);
+            if (_topK && NEED_YIELD != stageState) {
+                ++_termKeysRead;
+                nextTopKScanner();
+            }
+            return stageState;
+        }
+        else if (_topK && PlanStage::IS_EOF == childState) {
+            // No document scores anything for this term that wasn't read already.
+            _scannerEOF[_currentIndexScanner] = true;
+            _termScoreBounds[_currentIndexScanner] = 0;
+            ++_numScannersEOF;
+            nextTopKScanner();
+            return PlanStage::NEED_TIME;
         }
         else if (PlanStage::IS_EOF == childState) {
             // Done with this scan.
@@ -275,6 +394,10 @@ namespace mongo {
             return PlanStage::NEED_TIME;
         }
         else {
+            if (_topK && PlanStage::NEED_TIME == childState) {
+                nextTopKScanner();
+            }
+
             // Propagate WSID from below.
             *out = id;
             if (PlanStage::FAILURE == childState) {
@@ -299,6 +422,7 @@ namespace mongo {
         }
 
         // Filter for phrases and negative terms, score and truncate.
+        const RecordId loc = _scoreIterator->first;
         TextRecordData textRecordData = _scoreIterator->second;
 
         // Ignore non-matched documents.
@@ -326,8 +450,9 @@ namespace mongo {
 
         _scoreIterator++;
 
-        // Filter for phrases and negated terms
-        if (!_ftsMatcher.matches(wsm->obj.value())) {
+        // Filter for phrases and negated terms, unless checkTopK() did already.
+        if (!textRecordData.verified &&
+            !_ftsMatcher.matches(wsm->obj.value(), mustMatchNegatedTerms(loc))) {
             _ws->free(textRecordData.wsid);
             return PlanStage::NEED_TIME;
         }
@@ -411,9 +536,34 @@ namespace mongo {
         invariant(1 == wsm->keyData.size());
         const IndexKeyDatum newKeyData = wsm->keyData.back(); // copy to keep it around.
 
+        // Locate score within possibly compound key: {prefix,term,score,suffix}.
+        BSONObjIterator keyIt(newKeyData.keyData);
+        for (unsigned i = 0; i < _params.spec.numExtraBefore(); i++) {
+            keyIt.next();
+        }
+
+        keyIt.next(); // Skip past 'term'.
+
+        BSONElement scoreElement = keyIt.next();
+        double documentTermScore = scoreElement.number();
+
+        if (_topK) {
+            // The keys of a term come by decreasing score.
+            _termScoreBounds[_currentIndexScanner] = documentTermScore;
+        }
+
         TextRecordData* textRecordData = &_scores[wsm->loc];
         double* documentAggregateScore = &textRecordData->score;
 
+        if (WorkingSet::INVALID_ID == textRecordData->wsid && _negatedTermsResolved &&
+            _negatedDocs.count(wsm->loc) > 0 && !mustMatchNegatedTerms(wsm->loc)) {
+            // The document has a negated term, so is dropped without being fetched.
+            ++_specificStats.keysExamined;
+            _ws->free(wsid);
+            *documentAggregateScore = -1;
+            return NEED_TIME;
+        }
+
         if (WorkingSet::INVALID_ID == textRecordData->wsid) {
             // We haven't seen this RecordId before. Keep the working set member around
             // (it may be force-fetched on saveState()).
@@ -454,7 +604,7 @@ namespace mongo {
                     return NEED_TIME;
                 }
             }
-            else {
+            else if (!_topK) {
                 // If we're here, we're going to return the doc, and we do a fetch later.
                 ++_specificStats.fetches;
             }
@@ -477,20 +627,166 @@ namespace mongo {
             return NEED_TIME;
         }
 
-        // Locate score within possibly compound key: {prefix,term,score,suffix}.
-        BSONObjIterator keyIt(newKeyData.keyData);
-        for (unsigned i = 0; i < _params.spec.numExtraBefore(); i++) {
-            keyIt.next();
+        if (_topK) {
+            const uint64_t termBit = 1ULL << _currentIndexScanner;
+            if (textRecordData->termsSeen & termBit) {
+                // Already part of the score, which checkTopK() may have computed in full.
+                return NEED_TIME;
+            }
+            textRecordData->termsSeen |= termBit;
         }
 
-        keyIt.next(); // Skip past 'term'.
-
-        BSONElement scoreElement = keyIt.next();
-        double documentTermScore = scoreElement.number();
-
         // Aggregate relevance score, term keys.
         *documentAggregateScore += documentTermScore;
         return NEED_TIME;
     }
 
+    void TextStage::nextTopKScanner() {
+        if (_numScannersEOF == _scanners.size()) {
+            return;
+        }
+
+        do {
+            _currentIndexScanner = (_currentIndexScanner + 1) % _scanners.size();
+        } while (_scannerEOF[_currentIndexScanner]);
+    }
+
+    PlanStage::StageState TextStage::checkTopK(WorkingSetID* out) {
+        const size_t numTerms = _scanners.size();
+        const uint64_t allTerms = (64 == numTerms) ? ~0ULL : (1ULL << numTerms) - 1;
+
+        // The most a document none of whose keys were read yet can score.
+        double unseenBound = 0;
+        for (size_t i = 0; i < numTerms; ++i) {
+            unseenBound += _termScoreBounds[i];
+        }
+
+        typedef std::pair<double, ScoreMap::value_type*> Candidate;
+        vector<Candidate> candidates;
+        size_t numBest;
+        bool changed;
+        do {
+            candidates.clear();
+            for (ScoreMap::iterator it = _scores.begin(); it != _scores.end(); ++it) {
+                if (it->second.score >= 0) {
+                    candidates.push_back(Candidate(it->second.score, &*it));
+                }
+            }
+
+            numBest = std::min(_params.limit, candidates.size());
+            std::nth_element(candidates.begin(),
+                             candidates.begin() + numBest,
+                             candidates.end(),
+                             [](const Candidate& a, const Candidate& b) {
+                                 return a.first > b.first;
+                             });
+
+            // Fetch and match the best documents. If one is rejected or its score wasn't exact,
+            // the best ones must be chosen again.
+            changed = false;
+            for (size_t i = 0; i < numBest; ++i) {
+                TextRecordData* textRecordData = &candidates[i].second->second;
+                if (textRecordData->verified) {
+                    continue;
+                }
+
+                WorkingSetMember* wsm = _ws->get(textRecordData->wsid);
+                if (!wsm->hasObj()) {
+                    ++_specificStats.fetches;
+                }
+
+                bool matches;
+                try {
+                    matches = WorkingSetCommon::fetchIfUnfetched(_txn, wsm, _recordCursor)
+                              && _ftsMatcher.matches(wsm->obj.value(),
+                                                     mustMatchNegatedTerms(
+                                                         candidates[i].second->first));
+                }
+                catch (const WriteConflictException& wce) {
+                    *out = WorkingSet::INVALID_ID;
+                    return NEED_YIELD;
+                }
+
+                if (!matches) {
+                    _ws->free(textRecordData->wsid);
+                    textRecordData->wsid = WorkingSet::INVALID_ID;
+                    textRecordData->score = -1;
+                    changed = true;
+                    continue;
+                }
+
+                // Make it owned since we are buffering results.
+                wsm->obj.setValue(wsm->obj.value().getOwned());
+                textRecordData->verified = true;
+
+                // Score all terms, including those whose keys weren't read yet, as the index
+                // does, adding them up in the same order as when reading the terms one by one.
+                fts::TermFrequencyMap termFreqs;
+                _params.spec.scoreDocument(wsm->obj.value(), &termFreqs);
+                double score = 0;
+                for (std::set<std::string>::const_iterator it =
+                         _params.query.getTermsForBounds().begin();
+                     it != _params.query.getTermsForBounds().end();
+                     ++it) {
+                    fts::TermFrequencyMap::const_iterator freq = termFreqs.find(*it);
+                    if (freq != termFreqs.end()) {
+                        score += freq->second;
+                    }
+                }
+                if (score != textRecordData->score) {
+                    textRecordData->score = score;
+                    changed = true;
+                }
+                textRecordData->termsSeen = allTerms;
+            }
+        } while (changed);
+
+        bool done = (_numScannersEOF == numTerms);
+        if (!done && numBest == _params.limit) {
+            double worstBest = candidates[0].first;
+            for (size_t i = 1; i < numBest; ++i) {
+                worstBest = std::min(worstBest, candidates[i].first);
+            }
+
+            done = (worstBest >= unseenBound);
+            for (size_t i = numBest; done && i < candidates.size(); ++i) {
+                const TextRecordData& textRecordData = candidates[i].second->second;
+                double bound = textRecordData.score;
+                for (size_t term = 0; term < numTerms; ++term) {
+                    if (!(textRecordData.termsSeen & (1ULL << term))) {
+                        bound += _termScoreBounds[term];
+                    }
+                }
+                done = (worstBest >= bound);
+            }
+        }
+
+        if (!done) {
+            _nextTopKCheck = 2 * _termKeysRead;
+            return NEED_TIME;
+        }
+
+        // Only the best documents are returned.
+        for (size_t i = numBest; i < candidates.size(); ++i) {
+            const RecordId loc = candidates[i].second->first;
+            _ws->free(candidates[i].second->second.wsid);
+            _scores.erase(loc);
+        }
+        for (ScoreMap::iterator it = _scores.begin(); it != _scores.end();) {
+            if (it->second.score < 0) {
+                it = _scores.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        _scoreIterator = _scores.begin();
+        _internalState = RETURNING_RESULTS;
+
+        // Don't need to keep these around.
+        _scanners.clear();
+        return NEED_TIME;
+    }
+
 }  // namespace mongo
@@ -39,6 +39,7 @@
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
 #include "mongo/platform/unordered_map.h"
+#include "mongo/platform/unordered_set.h"
 
 #include <map>
 #include <queue>
@@ -55,7 +56,7 @@ namespace mongo {
     class OperationContext;
 
     struct TextStageParams {
-        TextStageParams(const FTSSpec& s) : spec(s) {}
+        TextStageParams(const FTSSpec& s) : spec(s), limit(0) {}
 
         // Text index descriptor.  IndexCatalog owns this.
         IndexDescriptor* index;
@@ -68,6 +69,10 @@ namespace mongo {
 
         // The text query.
         FTSQuery query;
+
+        // If nonzero, only the 'limit' documents with the highest scores are wanted, so the stage
+        // can stop reading the index once no other document can score higher.
+        size_t limit;
     };
 
     /**
@@ -88,13 +93,17 @@ namespace mongo {
             // 1. Initialize the index scans we use to retrieve term/score info.
             INIT_SCANS,
 
-            // 2. Read the terms/scores from the text index.
+            // 2. Read the keys of the negated terms from the text index, if that's how they are
+            // checked.
+            READING_NEGATED_TERMS,
+
+            // 3. Read the terms/scores from the text index.
             READING_TERMS,
 
-            // 3. Return results to our parent.
+            // 4. Return results to our parent.
             RETURNING_RESULTS,
 
-            // 4. Done.
+            // 5. Done.
             DONE,
         };
 
@@ -130,6 +139,23 @@ namespace mongo {
          */
         StageState initScans(WorkingSetID* out);
 
+        /**
+         * Returns a scan of the keys of 'term', by decreasing score.
+         */
+        PlanStage* newTermScan(const std::string& term);
+
+        /**
+         * Collects the documents which hold a negated term from the keys for those terms, so that
+         * they can be dropped without a fetch. Gives up if there are more keys than
+         * internalQueryTextMaxNegatedTermKeys, leaving the check to _ftsMatcher.
+         */
+        StageState readNegatedTerms(WorkingSetID* out);
+
+        /**
+         * Whether _ftsMatcher must check the document at 'loc' for negated terms.
+         */
+        bool mustMatchNegatedTerms(const RecordId& loc) const;
+
         /**
          * Helper for buffering results array.  Returns NEED_TIME (if any results were produced),
          * IS_EOF, or FAILURE.
@@ -143,6 +169,24 @@ namespace mongo {
          */
         StageState addTerm(WorkingSetID wsid, WorkingSetID* out);
 
+        /**
+         * Used instead of reading the sub-scanners one after the other when only the best
+         * _params.limit documents are wanted. Moves on to the next sub-scanner that isn't
+         * exhausted, so that they are read round-robin.
+         */
+        void nextTopKScanner();
+
+        /**
+         * Checks whether the best _params.limit documents are known already: each of them must
+         * score at least as high as any other document could, given the score of the last key
+         * read from each term's sub-scanner. As documents are only kept if they score highest,
+         * the candidates are fetched and matched here, which also yields their exact score.
+         *
+         * If so, drops the other documents and moves on to returning results. Returns NEED_TIME,
+         * or NEED_YIELD if a fetch must be retried.
+         */
+        StageState checkTopK(WorkingSetID* out);
+
         /**
          * Possibly return a result.  FYI, this may perform a fetch directly if it is needed to
          * evaluate all filters.
@@ -178,14 +222,36 @@ namespace mongo {
         // Which _scanners are we currently reading from?
         size_t _currentIndexScanner;
 
+        // Used in READING_NEGATED_TERMS. The index scans of the negated terms, and which of them
+        // we're reading from.
+        OwnedPointerVector<PlanStage> _negatedScanners;
+        size_t _currentNegatedScanner;
+
+        // Set once the keys of all negated terms were read, in which case _negatedDocs holds
+        // every document with a negated term. Documents invalidated since are in
+        // _negatedUnknown, and are still matched for negated terms.
+        typedef unordered_set<RecordId, RecordId::Hasher> RecordIdSet;
+        bool _negatedTermsResolved;
+        RecordIdSet _negatedDocs;
+        RecordIdSet _negatedUnknown;
+
         // If not Null, we use this rather than asking our child what to do next.
         WorkingSetID _idRetrying;
 
         // Map each buffered record id to this data.
         struct TextRecordData {
-            TextRecordData() : wsid(WorkingSet::INVALID_ID), score(0.0) { }
+            TextRecordData() : wsid(WorkingSet::INVALID_ID), score(0.0), termsSeen(0),
+                               verified(false) { }
             WorkingSetID wsid;
             double score;
+
+            // Only used when _topK. Bit i is set if 'score' includes the score for the term of
+            // the i-th sub-scanner.
+            uint64_t termsSeen;
+
+            // Only used when _topK. Whether the document was fetched and matched, in which case
+            // 'score' is exact.
+            bool verified;
         };
 
         // Temporary score data filled out by sub-scans.  Used in READING_TERMS and
@@ -197,6 +263,21 @@ namespace mongo {
 
         // Used for fetching records from the collection.
         std::unique_ptr<RecordCursor> _recordCursor;
+
+        // Whether to read only as much of the index as needed to find the best _params.limit
+        // documents. Each sub-scanner reads the keys of one term by decreasing score.
+        bool _topK;
+
+        // Used in READING_TERMS when _topK. The score of the last key read by each sub-scanner,
+        // which bounds the score for its term of any document not read from it yet.
+        std::vector<double> _termScoreBounds;
+        std::vector<bool> _scannerEOF;
+        size_t _numScannersEOF;
+
+        // Used in READING_TERMS when _topK. Keys read so far, and after how many checkTopK() is
+        // tried next.
+        size_t _termKeysRead;
+        size_t _nextTopKCheck;
     };
 
 } // namespace mongo
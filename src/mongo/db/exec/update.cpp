@@ -425,6 +425,18 @@ namespace mongo {
             return Status::OK();
         }
 
+        /**
+         * Whether writing 'damages' is worth it compared to writing all of 'newObj': they must
+         * not carry more than half of the new document.
+         */
+        bool worthSplicing(const mb::DamageVector& damages, const BSONObj& newObj) {
+            size_t damagedBytes = 0;
+            for (mb::DamageVector::const_iterator it = damages.begin(); it != damages.end(); ++it) {
+                damagedBytes += it->size;
+            }
+            return damagedBytes * 2 <= static_cast<size_t>(newObj.objsize());
+        }
+
     } // namespace
 
     // static
@@ -462,77 +474,115 @@ namespace mongo {
         // If asked to return new doc, default to the oldObj, in case nothing changes.
         BSONObj newObj = oldObj.value();
 
-        // Ask the driver to apply the mods. It may be that the driver can apply those "in
-        // place", that is, some values of the old document just get adjusted without any
-        // change to the binary layout on the bson layer. It may be that a whole new document
-        // is needed to accomodate the new bson layout of the resulting document. In any event,
-        // only enable in-place mutations if the underlying storage engine offers support for
-        // writing damage events.
-        _doc.reset(oldObj.value(),
-                   (_collection->updateWithDamagesSupported() ?
-                    mutablebson::Document::kInPlaceEnabled :
-                    mutablebson::Document::kInPlaceDisabled));
+        const std::vector<FieldRef*>* immutableFields = NULL;
+        if (lifecycle && _txn->writesAreReplicated() && !request->isFromMigration())
+            immutableFields = lifecycle->getImmutableFields();
 
         BSONObj logObj;
 
         FieldRefSet updatedFields;
         bool docWasModified = false;
 
-        Status status = Status::OK();
-        if (!driver->needMatchDetails()) {
-            // If we don't need match details, avoid doing the rematch
-            status = driver->update(StringData(), &_doc, &logObj, &updatedFields, &docWasModified);
-        }
-        else {
-            // If there was a matched field, obtain it.
-            MatchDetails matchDetails;
-            matchDetails.requestElemMatchKey();
+        // Simple updates of top-level fields can be applied to the old document directly, which
+        // saves building a mutable one. They don't make _id missing or change immutable fields
+        // and only write values that are valid for storage, so need no validation afterwards.
+        const char* source = NULL;
+        const bool simpleUpdate =
+            driver->isSimpleUpdate() &&
+            driver->updateSimple(oldObj.value(),
+                                 immutableFields,
+                                 _collection->updateWithDamagesSupported(),
+                                 &newObj,
+                                 &_damages,
+                                 &source,
+                                 &logObj,
+                                 &updatedFields,
+                                 &docWasModified);
+
+        bool inPlace = simpleUpdate && !_damages.empty();
+        if (!simpleUpdate) {
+            // Ask the driver to apply the mods. It may be that the driver can apply those "in
+            // place", that is, some values of the old document just get adjusted without any
+            // change to the binary layout on the bson layer. It may be that a whole new document
+            // is needed to accomodate the new bson layout of the resulting document. In any
+            // event, only enable in-place mutations if the underlying storage engine offers
+            // support for writing damage events.
+            _doc.reset(oldObj.value(),
+                       (_collection->updateWithDamagesSupported() ?
+                        mutablebson::Document::kInPlaceEnabled :
+                        mutablebson::Document::kInPlaceDisabled));
+
+            Status status = Status::OK();
+            if (!driver->needMatchDetails()) {
+                // If we don't need match details, avoid doing the rematch
+                status = driver->update(StringData(), &_doc, &logObj, &updatedFields,
+                                        &docWasModified);
+            }
+            else {
+                // If there was a matched field, obtain it.
+                MatchDetails matchDetails;
+                matchDetails.requestElemMatchKey();
 
-            dassert(cq);
-            verify(cq->root()->matchesBSON(oldObj.value(), &matchDetails));
+                dassert(cq);
+                verify(cq->root()->matchesBSON(oldObj.value(), &matchDetails));
 
-            string matchedField;
-            if (matchDetails.hasElemMatchKey())
-                matchedField = matchDetails.elemMatchKey();
+                string matchedField;
+                if (matchDetails.hasElemMatchKey())
+                    matchedField = matchDetails.elemMatchKey();
 
-            // TODO: Right now, each mod checks in 'prepare' that if it needs positional
-            // data, that a non-empty StringData() was provided. In principle, we could do
-            // that check here in an else clause to the above conditional and remove the
-            // checks from the mods.
+                // TODO: Right now, each mod checks in 'prepare' that if it needs positional
+                // data, that a non-empty StringData() was provided. In principle, we could do
+                // that check here in an else clause to the above conditional and remove the
+                // checks from the mods.
 
-            status = driver->update(matchedField, &_doc, &logObj, &updatedFields, &docWasModified);
-        }
+                status = driver->update(matchedField, &_doc, &logObj, &updatedFields,
+                                        &docWasModified);
+            }
 
-        if (!status.isOK()) {
-            uasserted(16837, status.reason());
-        }
+            if (!status.isOK()) {
+                uasserted(16837, status.reason());
+            }
 
-        // Ensure _id exists and is first
-        uassertStatusOK(ensureIdAndFirst(_doc));
+            // Ensure _id exists and is first
+            uassertStatusOK(ensureIdAndFirst(_doc));
 
-        // See if the changes were applied in place
-        const char* source = NULL;
-        const bool inPlace = _doc.getInPlaceUpdates(&_damages, &source);
+            // See if the changes were applied in place
+            inPlace = _doc.getInPlaceUpdates(&_damages, &source);
 
-        if (inPlace && _damages.empty()) {
-            // An interesting edge case. A modifier didn't notice that it was really a no-op
-            // during its 'prepare' phase. That represents a missed optimization, but we still
-            // shouldn't do any real work. Toggle 'docWasModified' to 'false'.
-            //
-            // Currently, an example of this is '{ $pushAll : { x : [] } }' when the 'x' array
-            // exists.
-            docWasModified = false;
+            if (inPlace && _damages.empty()) {
+                // An interesting edge case. A modifier didn't notice that it was really a no-op
+                // during its 'prepare' phase. That represents a missed optimization, but we still
+                // shouldn't do any real work. Toggle 'docWasModified' to 'false'.
+                //
+                // Currently, an example of this is '{ $pushAll : { x : [] } }' when the 'x'
+                // array exists.
+                docWasModified = false;
+            }
+        }
+
+        // Whether the new document must be validated as a whole, rather than by validating the
+        // old one, which passes the validator just the same if no field it looks at changed.
+        // Damages can only be used in the latter case.
+        const bool mustValidateNewDoc = driver->isDocReplacement() ||
+                                        _collection->validatorDependsOn(updatedFields);
+
+        if (inPlace && !_damages.empty() && mustValidateNewDoc) {
+            if (simpleUpdate) {
+                const BSONObj& old = oldObj.value();
+                SharedBuffer data =
+                    SharedBuffer::allocate(mb::sizeAfterDamages(old.objsize(), _damages));
+                mb::applyDamages(old.objdata(), old.objsize(), source, _damages, data.get());
+                newObj = BSONObj(data);
+            }
+            inPlace = false;
+            _damages.clear();
         }
 
         if (docWasModified) {
 
             // Verify that no immutable fields were changed and data is valid for storage.
 
-            if (!(!_txn->writesAreReplicated() || request->isFromMigration())) {
-                const std::vector<FieldRef*>* immutableFields = NULL;
-                if (lifecycle)
-                    immutableFields = lifecycle->getImmutableFields();
-
+            if (!simpleUpdate && _txn->writesAreReplicated() && !request->isFromMigration()) {
                 uassertStatusOK(validate(oldObj.value(),
                                          updatedFields,
                                          _doc,
@@ -550,20 +600,25 @@ namespace mongo {
                 // Don't actually do the write if this is an explain.
                 if (!request->isExplain()) {
                     invariant(_collection);
-                    newObj = oldObj.value();
                     const RecordData oldRec(oldObj.value().objdata(), oldObj.value().objsize());
-                    BSONObj idQuery = driver->makeOplogEntryQuery(newObj, request->isMulti());
+                    BSONObj idQuery = driver->makeOplogEntryQuery(oldObj.value(),
+                                                                  request->isMulti());
                     oplogUpdateEntryArgs args;
                     args.update = logObj;
                     args.criteria = idQuery;
                     args.fromMigrate = request->isFromMigration();
-                    _collection->updateDocumentWithDamages(
+                    StatusWith<RecordData> newRecStatus = _collection->updateDocumentWithDamages(
                             _txn,
                             loc,
                             Snapshotted<RecordData>(oldObj.snapshotId(), oldRec),
                             source,
                             _damages,
                             args);
+                    uassertStatusOK(newRecStatus.getStatus());
+
+                    // The record store may have written the new version of the document
+                    // somewhere other than where the old one lives.
+                    newObj = newRecStatus.getValue().releaseToBson();
                 }
 
                 _specificStats.fastmod = true;
@@ -572,14 +627,48 @@ namespace mongo {
             else {
                 // The updates were not in place. Apply them through the file manager.
 
-                newObj = _doc.getObject();
+                if (!simpleUpdate)
+                    newObj = _doc.getObject();
                 uassert(17419,
                         str::stream() << "Resulting document after update is larger than "
                         << BSONObjMaxUserSize,
                         newObj.objsize() <= BSONObjMaxUserSize);
 
+                // If no index is affected, the record store may be able to splice just the
+                // changed bytes into the old document instead of writing all of the new one.
+                bool spliced = false;
+                if (!request->isExplain() &&
+                    !driver->modsAffectIndices() &&
+                    !mustValidateNewDoc &&
+                    _collection->updateWithSplicesSupported()) {
+                    mb::computeDamages(oldObj.value(), newObj, &_damages);
+                    if (worthSplicing(_damages, newObj)) {
+                        const RecordData oldRec(oldObj.value().objdata(),
+                                                oldObj.value().objsize());
+                        BSONObj idQuery = driver->makeOplogEntryQuery(newObj, request->isMulti());
+                        oplogUpdateEntryArgs args;
+                        args.update = logObj;
+                        args.criteria = idQuery;
+                        args.fromMigrate = request->isFromMigration();
+                        StatusWith<RecordData> newRecStatus =
+                            _collection->updateDocumentWithDamages(
+                                _txn,
+                                loc,
+                                Snapshotted<RecordData>(oldObj.snapshotId(), oldRec),
+                                newObj.objdata(),
+                                _damages,
+                                args);
+                        if (newRecStatus.getStatus() != ErrorCodes::NeedsDocumentMove) {
+                            uassertStatusOK(newRecStatus.getStatus());
+                            spliced = true;
+                            newLoc = loc;
+                        }
+                    }
+                    _damages.clear();
+                }
+
                 // Don't actually do the write if this is an explain.
-                if (!request->isExplain()) {
+                if (!request->isExplain() && !spliced) {
                     invariant(_collection);
                     BSONObj idQuery = driver->makeOplogEntryQuery(newObj, request->isMulti());
                     oplogUpdateEntryArgs args;
@@ -594,7 +683,8 @@ namespace mongo {
                             true,
                             driver->modsAffectIndices(),
                             _params.opDebug,
-                            args);
+                            args,
+                            driver->isDocReplacement() ? NULL : &updatedFields);
                     uassertStatusOK(res.getStatus());
                     newLoc = res.getValue();
                 }
@@ -769,8 +859,8 @@ namespace mongo {
     PlanStage::StageState UpdateStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeNanos.
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -868,6 +958,9 @@ namespace mongo {
                 return PlanStage::NEED_TIME;
             }
 
+            // Set once our child is saved for the write. A write conflict after that point may
+            // skip the document.
+            bool childSaved = false;
             try {
                 std::unique_ptr<RecordCursor> cursor;
                 if (_txn->recoveryUnit()->getSnapshotId() != member->obj.snapshotId()) {
@@ -896,6 +989,7 @@ namespace mongo {
                         // invalidations.
                         WorkingSetCommon::prepareForSnapshotChange(_ws);
                     }
+                    childSaved = true;
                 }
                 catch ( const WriteConflictException& wce ) {
                     std::terminate();
@@ -925,6 +1019,24 @@ namespace mongo {
                 }
             }
             catch ( const WriteConflictException& wce ) {
+                if (childSaved && _params.request->shouldSkipLocked() &&
+                        !_params.request->isMulti()) {
+                    // Someone else is modifying this document, so leave it to them and go on
+                    // with the next one in the snapshot we'll open now.
+                    ++_specificStats.nSkippedLocked;
+                    _txn->recoveryUnit()->abandonSnapshot();
+                    try {
+                        _child->restoreState(_txn);
+                    }
+                    catch ( const WriteConflictException& wce ) {
+                        *out = WorkingSet::INVALID_ID;
+                        _commonStats.needYield++;
+                        return NEED_YIELD;
+                    }
+                    ++_commonStats.needTime;
+                    return PlanStage::NEED_TIME;
+                }
+
                 _idRetrying = id;
                 memberFreer.Dismiss(); // Keep this member around so we can retry updating it.
                 *out = WorkingSet::INVALID_ID;
@@ -1104,6 +1216,7 @@ namespace mongo {
         Explain::getSummaryStats(exec, &stats);
         opDebug->nscanned = stats.totalKeysExamined;
         opDebug->nscannedObjects = stats.totalDocsExamined;
+        opDebug->replanned = stats.replanned;
 
         return UpdateResult(updateStats->nMatched > 0 /* Did we update at least one obj? */,
                             !updateStats->isDocReplacement /* $mod or obj replacement */,
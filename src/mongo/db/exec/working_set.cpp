@@ -28,6 +28,7 @@
 
 #include "mongo/db/exec/working_set.h"
 
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/storage/record_fetcher.h"
 
@@ -47,6 +48,8 @@ namespace mongo {
     }
 
     WorkingSetID WorkingSet::allocate() {
+        ScopedTimer::noteWorkingSetAllocation();
+
         if (_freeList == INVALID_ID) {
             // The free list is empty so we need to make a single new WSM to return. This relies on
             // vector::resize being amortized O(1) for efficient allocation. Note that the free list
@@ -173,7 +176,9 @@ namespace mongo {
     // WorkingSetMember
     //
 
-    WorkingSetMember::WorkingSetMember() : state(WorkingSetMember::INVALID), isSuspicious(false) { }
+    WorkingSetMember::WorkingSetMember() : state(WorkingSetMember::INVALID),
+                                           isSuspicious(false),
+                                           _keyStorageUsed(0) { }
 
     WorkingSetMember::~WorkingSetMember() { }
 
@@ -183,10 +188,35 @@ namespace mongo {
         }
 
         keyData.clear();
+        _keyStorageUsed = 0;
         obj.reset();
         state = WorkingSetMember::INVALID;
     }
 
+    void WorkingSetMember::appendKeyDatum(const BSONObj& keyPattern,
+                                          const BSONObj& key,
+                                          const IndexAccessMethod* index) {
+        if (key.isOwned()) {
+            // Sharing the buffer is cheaper than copying it.
+            keyData.push_back(IndexKeyDatum(keyPattern, key, index));
+            return;
+        }
+
+        // Nothing references our storage once the key data has been dropped.
+        if (keyData.empty()) {
+            _keyStorageUsed = 0;
+        }
+
+        if (_keyStorageUsed == _keyStorage.size()) {
+            _keyStorage.push_back(std::vector<char>());
+        }
+
+        // Moving the outer vector doesn't move the inner buffers, so earlier keys stay valid.
+        std::vector<char>& buf = _keyStorage[_keyStorageUsed++];
+        buf.assign(key.objdata(), key.objdata() + key.objsize());
+        keyData.push_back(IndexKeyDatum(keyPattern, BSONObj(&buf[0]), index));
+    }
+
     bool WorkingSetMember::hasLoc() const {
         return state == LOC_AND_IDX || state == LOC_AND_UNOWNED_OBJ || state == LOC_AND_OWNED_OBJ;
     }
@@ -199,7 +199,8 @@ namespace mongo {
         // This is not owned and points into the IndexDescriptor's data.
         BSONObj indexKeyPattern;
 
-        // This is the BSONObj for the key that we put into the index.  Owned by us.
+        // This is the BSONObj for the key that we put into the index.  Either owned, or pointing
+        // into storage kept by the WorkingSetMember holding this datum (see appendKeyDatum()).
         BSONObj keyData;
 
         const IndexAccessMethod* index;
@@ -303,6 +304,18 @@ namespace mongo {
         bool hasOwnedObj() const;
         bool hasUnownedObj() const;
 
+        /**
+         * Appends an IndexKeyDatum for 'key' to 'keyData'.  An unowned 'key' is copied into
+         * storage which this member keeps across clear(), so a member recycled through the
+         * WorkingSet's free list reuses it instead of allocating an owned copy of every key.
+         *
+         * The copy is valid until this member is freed or 'keyData' is cleared.  Use getOwned()
+         * to keep it longer.
+         */
+        void appendKeyDatum(const BSONObj& keyPattern,
+                            const BSONObj& key,
+                            const IndexAccessMethod* index);
+
         //
         // Computed data
         //
@@ -339,6 +352,11 @@ namespace mongo {
     private:
         std::unique_ptr<WorkingSetComputedData> _computed[WSM_COMPUTED_NUM_TYPES];
 
+        // Buffers backing the unowned keys added by appendKeyDatum().  They are never released,
+        // only reused; the first '_keyStorageUsed' hold keys referenced by 'keyData'.
+        std::vector<std::vector<char> > _keyStorage;
+        size_t _keyStorageUsed;
+
         std::unique_ptr<RecordFetcher> _fetcher;
     };
 
@@ -119,7 +119,11 @@ namespace mongo {
     void WorkingSetCommon::initFrom(WorkingSetMember* dest, const WorkingSetMember& src) {
         dest->loc = src.loc;
         dest->obj = src.obj;
-        dest->keyData = src.keyData;
+        for (size_t i = 0; i < src.keyData.size(); ++i) {
+            // 'src' may not outlive 'dest', so keys in its storage are copied into 'dest'.
+            const IndexKeyDatum& datum = src.keyData[i];
+            dest->appendKeyDatum(datum.indexKeyPattern, datum.keyData, datum.index);
+        }
         dest->state = src.state;
 
         // Merge computed data.
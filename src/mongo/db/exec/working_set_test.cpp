@@ -148,6 +148,45 @@ namespace {
         ASSERT_FALSE(member->getFieldDotted("y", &elt));
     }
 
+    TEST_F(WorkingSetFixture, appendKeyDatumCopiesUnownedKey) {
+        BSONObj owned = BSON("" << 5 << "" << "abc");
+        BSONObj unowned(owned.objdata());
+        ASSERT_FALSE(unowned.isOwned());
+
+        member->appendKeyDatum(BSON("a" << 1 << "b" << 1), unowned, NULL);
+        member->state = WorkingSetMember::LOC_AND_IDX;
+        ASSERT_EQUALS(1U, member->keyData.size());
+        ASSERT_NOT_EQUALS(owned.objdata(), member->keyData[0].keyData.objdata());
+        ASSERT_EQUALS(owned, member->keyData[0].keyData);
+
+        BSONElement elt;
+        ASSERT_TRUE(member->getFieldDotted("b", &elt));
+        ASSERT_EQUALS("abc", elt.str());
+    }
+
+    TEST_F(WorkingSetFixture, appendKeyDatumSharesOwnedKey) {
+        BSONObj owned = BSON("" << 5);
+        member->appendKeyDatum(BSON("a" << 1), owned, NULL);
+        ASSERT_EQUALS(owned.objdata(), member->keyData[0].keyData.objdata());
+    }
+
+    TEST(WorkingSetKeyStorageTest, RecycledMemberReusesKeyStorage) {
+        WorkingSet ws;
+        BSONObj owned = BSON("" << 5);
+        BSONObj unowned(owned.objdata());
+
+        WorkingSetID id = ws.allocate();
+        ws.get(id)->appendKeyDatum(BSON("a" << 1), unowned, NULL);
+        const char* storage = ws.get(id)->keyData[0].keyData.objdata();
+        ws.free(id);
+
+        // The free list hands back the same member, which copies into the same buffer.
+        ASSERT_EQUALS(id, ws.allocate());
+        ws.get(id)->appendKeyDatum(BSON("a" << 1), unowned, NULL);
+        ASSERT_EQUALS(storage, ws.get(id)->keyData[0].keyData.objdata());
+        ASSERT_EQUALS(owned, ws.get(id)->keyData[0].keyData);
+    }
+
     //
     // WorkingSet::iterator tests
     //
@@ -0,0 +1,265 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ftdc/ftdc_compressor.h"
+
+#include <algorithm>
+#include <memory>
+#include <zlib.h>
+
+#include "mongo/base/data_range_cursor.h"
+#include "mongo/base/data_type_endian.h"
+#include "mongo/bson/bson_validate.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/db/ftdc/ftdc_util.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+    // Bounds on what a chunk claims to hold, to reject corrupt chunks before allocating for them
+    const int kMaxUncompressedChunkBytes = 64 * 1024 * 1024;
+    const size_t kMaxChunkDeltas = 16 * 1024 * 1024;
+
+    void appendVarint(BufBuilder* buf, std::uint64_t value) {
+        while (value >= 0x80) {
+            buf->appendChar(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        buf->appendChar(static_cast<char>(value));
+    }
+
+    Status readVarint(ConstDataRangeCursor* cursor, std::uint64_t* value) {
+        *value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            auto byte = cursor->readAndAdvance<std::uint8_t>();
+            if (!byte.isOK()) {
+                return byte.getStatus();
+            }
+            *value |= static_cast<std::uint64_t>(byte.getValue() & 0x7f) << shift;
+            if (!(byte.getValue() & 0x80)) {
+                return Status::OK();
+            }
+        }
+        return Status(ErrorCodes::FailedToParse, "varint in diagnostic data chunk is too long");
+    }
+
+    Status badChunk(StringData reason) {
+        return Status(ErrorCodes::FailedToParse,
+                      str::stream() << "invalid diagnostic data chunk: " << reason);
+    }
+
+}  // namespace
+
+    const size_t FTDCCompressor::kMaxSamplesPerChunk;
+
+    FTDCCompressor::FTDCCompressor(size_t maxSamplesPerChunk)
+        : _maxSamplesPerChunk(std::min(std::max<size_t>(maxSamplesPerChunk, 1),
+                                       kMaxSamplesPerChunk)) {
+    }
+
+    bool FTDCCompressor::addSample(const BSONObj& sample, Date_t date, BSONObj* chunk) {
+        if (_reference.isEmpty()) {
+            _start(sample, date);
+            return false;
+        }
+
+        if (numSamples() < _maxSamplesPerChunk) {
+            _current.clear();
+            if (extractFTDCMetrics(_reference, sample, &_current)) {
+                for (size_t i = 0; i < _current.size(); ++i) {
+                    _deltas.push_back(_current[i] - _previous[i]);
+                }
+                _previous.swap(_current);
+                ++_deltasCount;
+                return false;
+            }
+        }
+
+        invariant(getChunk(chunk));
+        _start(sample, date);
+        return true;
+    }
+
+    bool FTDCCompressor::getChunk(BSONObj* chunk) const {
+        if (_reference.isEmpty()) {
+            return false;
+        }
+
+        const size_t metricsCount = _previous.size();
+        BufBuilder uncompressed;
+        uncompressed.appendBuf(_reference.objdata(), _reference.objsize());
+        uncompressed.appendNum(static_cast<int>(metricsCount));
+        uncompressed.appendNum(static_cast<int>(_deltasCount));
+
+        // Metric after metric, so that the zero runs of metrics which don't change are long
+        for (size_t metric = 0; metric < metricsCount; ++metric) {
+            size_t zeros = 0;
+            for (size_t sample = 0; sample < _deltasCount; ++sample) {
+                const std::uint64_t delta = _deltas[sample * metricsCount + metric];
+                if (delta == 0) {
+                    ++zeros;
+                    continue;
+                }
+                if (zeros > 0) {
+                    appendVarint(&uncompressed, 0);
+                    appendVarint(&uncompressed, zeros - 1);
+                    zeros = 0;
+                }
+                appendVarint(&uncompressed, delta);
+            }
+            if (zeros > 0) {
+                appendVarint(&uncompressed, 0);
+                appendVarint(&uncompressed, zeros - 1);
+            }
+        }
+
+        uLongf compressedLength = compressBound(uncompressed.len());
+        std::unique_ptr<char[]> compressed(new char[sizeof(int) + compressedLength]);
+        const int zret = compress2(reinterpret_cast<Bytef*>(compressed.get() + sizeof(int)),
+                                   &compressedLength,
+                                   reinterpret_cast<const Bytef*>(uncompressed.buf()),
+                                   uncompressed.len(),
+                                   Z_DEFAULT_COMPRESSION);
+        invariant(zret == Z_OK);
+        DataView(compressed.get()).write<LittleEndian<int>>(uncompressed.len());
+
+        BSONObjBuilder chunkBuilder;
+        chunkBuilder.appendDate("_id", _referenceDate);
+        chunkBuilder.append("type", static_cast<int>(FTDCType::kMetricChunk));
+        chunkBuilder.appendBinData("data",
+                                   sizeof(int) + compressedLength,
+                                   BinDataGeneral,
+                                   compressed.get());
+        *chunk = chunkBuilder.obj();
+        return true;
+    }
+
+    void FTDCCompressor::reset() {
+        _reference = BSONObj();
+        _previous.clear();
+        _deltas.clear();
+        _deltasCount = 0;
+    }
+
+    void FTDCCompressor::_start(const BSONObj& sample, Date_t date) {
+        reset();
+        _reference = sample.getOwned();
+        _referenceDate = date;
+        invariant(extractFTDCMetrics(_reference, _reference, &_previous));
+    }
+
+    StatusWith<std::vector<BSONObj>> decompressFTDCChunk(const BSONObj& chunk) {
+        const BSONElement dataElt = chunk["data"];
+        if (dataElt.type() != BinData) {
+            return badChunk("no data");
+        }
+        int length;
+        const char* data = dataElt.binData(length);
+        if (length < static_cast<int>(sizeof(int))) {
+            return badChunk("data too short");
+        }
+
+        const int uncompressedLength = ConstDataView(data).read<LittleEndian<int>>();
+        if (uncompressedLength <= 0 || uncompressedLength > kMaxUncompressedChunkBytes) {
+            return badChunk("bad uncompressed length");
+        }
+        std::unique_ptr<char[]> uncompressed(new char[uncompressedLength]);
+        uLongf actualLength = uncompressedLength;
+        if (uncompress(reinterpret_cast<Bytef*>(uncompressed.get()), &actualLength,
+                       reinterpret_cast<const Bytef*>(data + sizeof(int)),
+                       length - sizeof(int)) != Z_OK ||
+                actualLength != static_cast<uLongf>(uncompressedLength)) {
+            return badChunk("could not uncompress");
+        }
+
+        ConstDataRangeCursor cursor(uncompressed.get(), uncompressed.get() + uncompressedLength);
+        if (!validateBSON(cursor.data(), cursor.length()).isOK()) {
+            return badChunk("bad reference document");
+        }
+        const BSONObj reference(cursor.data());
+        invariantOK(cursor.advance(reference.objsize()));
+
+        auto metricsCount = cursor.readAndAdvance<LittleEndian<int>>();
+        auto deltasCount = cursor.readAndAdvance<LittleEndian<int>>();
+        if (!metricsCount.isOK() || !deltasCount.isOK()) {
+            return badChunk("truncated");
+        }
+        const size_t numMetrics = static_cast<int>(metricsCount.getValue());
+        const int numDeltas = deltasCount.getValue();
+        if (numMetrics != countFTDCMetrics(reference) || numDeltas < 0 ||
+                numDeltas >= static_cast<int>(FTDCCompressor::kMaxSamplesPerChunk) ||
+                numMetrics * numDeltas > kMaxChunkDeltas) {
+            return badChunk("bad metric counts");
+        }
+
+        std::vector<std::uint64_t> deltas(numMetrics * numDeltas);
+        for (size_t metric = 0; metric < numMetrics; ++metric) {
+            for (int sample = 0; sample < numDeltas; ++sample) {
+                std::uint64_t delta;
+                Status status = readVarint(&cursor, &delta);
+                if (!status.isOK()) {
+                    return status;
+                }
+                if (delta != 0) {
+                    deltas[sample * numMetrics + metric] = delta;
+                    continue;
+                }
+
+                std::uint64_t moreZeros;
+                status = readVarint(&cursor, &moreZeros);
+                if (!status.isOK()) {
+                    return status;
+                }
+                if (moreZeros >= static_cast<std::uint64_t>(numDeltas - sample)) {
+                    return badChunk("run of zeros past the last sample");
+                }
+                sample += moreZeros;
+            }
+        }
+
+        std::vector<BSONObj> samples;
+        samples.push_back(reference.getOwned());
+
+        std::vector<std::uint64_t> metrics;
+        invariant(extractFTDCMetrics(reference, reference, &metrics));
+        for (int sample = 0; sample < numDeltas; ++sample) {
+            for (size_t metric = 0; metric < numMetrics; ++metric) {
+                metrics[metric] += deltas[sample * numMetrics + metric];
+            }
+            size_t pos = 0;
+            samples.push_back(constructFTDCSample(reference, metrics, &pos));
+        }
+        return StatusWith<std::vector<BSONObj>>(std::move(samples));
+    }
+
+}  // namespace mongo
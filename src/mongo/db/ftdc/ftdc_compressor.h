@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    /**
+     * The type field of the documents in a diagnostic data file.
+     */
+    enum class FTDCType {
+        // {_id: <date>, type: 0, doc: <document>} describes the server, written at the start of
+        // each file.
+        kMetadata = 0,
+
+        // {_id: <date of first sample>, type: 1, data: <BinData>} holds a chunk of samples.
+        kMetricChunk = 1,
+    };
+
+    /**
+     * Packs consecutive diagnostic data samples into compressed chunks.
+     *
+     * The samples of a chunk have the same fields as its first sample, the reference document.
+     * Each metric is stored as the difference from its value in the previous sample, and a run
+     * of samples in which a metric doesn't change takes two or three bytes, so counters that
+     * mostly stand still cost next to nothing even before zlib. The data of a chunk is
+     *
+     *     int32 uncompressedLength;
+     *     zlib {
+     *         BSONObj reference;        // the first sample
+     *         int32 metricsCount;       // metrics per sample
+     *         int32 deltasCount;        // samples after the first
+     *         varint deltas[];          // for each metric, its deltas in sample order
+     *     }
+     *
+     * where each delta is an unsigned LEB128 varint, and a run of n zero deltas is a 0 followed
+     * by n - 1.
+     */
+    class FTDCCompressor {
+        MONGO_DISALLOW_COPYING(FTDCCompressor);
+    public:
+        static const size_t kMaxSamplesPerChunk = 100 * 1000;
+
+        explicit FTDCCompressor(size_t maxSamplesPerChunk);
+
+        /**
+         * Adds a sample taken at "date". Returns true, with the chunk document of the samples
+         * added before it in "*chunk", if "sample" starts the next chunk, because the chunk
+         * being filled is full or "sample" does not have the fields of its reference document.
+         */
+        bool addSample(const BSONObj& sample, Date_t date, BSONObj* chunk);
+
+        /**
+         * Compresses the samples of the chunk being filled into "*chunk", without starting a new
+         * one. Returns false if there are none.
+         */
+        bool getChunk(BSONObj* chunk) const;
+
+        /**
+         * Drops the samples of the chunk being filled.
+         */
+        void reset();
+
+        size_t numSamples() const {
+            return _reference.isEmpty() ? 0 : _deltasCount + 1;
+        }
+
+    private:
+        void _start(const BSONObj& sample, Date_t date);
+
+        const size_t _maxSamplesPerChunk;
+
+        BSONObj _reference;
+        Date_t _referenceDate;
+
+        // The metrics of the last sample added
+        std::vector<std::uint64_t> _previous;
+
+        // The deltas of each sample after the reference, sample after sample
+        std::vector<std::uint64_t> _deltas;
+        size_t _deltasCount = 0;
+
+        // Scratch space for the metrics of the sample being added
+        std::vector<std::uint64_t> _current;
+    };
+
+    /**
+     * Returns the samples of a chunk document made by FTDCCompressor.
+     */
+    StatusWith<std::vector<BSONObj>> decompressFTDCChunk(const BSONObj& chunk);
+
+}  // namespace mongo
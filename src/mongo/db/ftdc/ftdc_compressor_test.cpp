@@ -0,0 +1,244 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <limits>
+#include <vector>
+
+#include "mongo/db/ftdc/ftdc_compressor.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+    using namespace mongo;
+
+    BSONObj makeSample(long long i) {
+        return BSON("start" << Date_t::fromMillisSinceEpoch(1000 * i) <<
+                    "host" << "localhost" <<
+                    "counters" << BSON("insert" << static_cast<int>(i * 3) <<
+                                       "bytes" << i * i * 1000 <<
+                                       "ratio" << static_cast<double>(i % 4)) <<
+                    "members" << BSON_ARRAY(BSON("state" << 1 << "up" << true) <<
+                                            BSON("state" << 2 << "up" << (i % 2 == 0))) <<
+                    "optime" << Timestamp(100 + i, 1));
+    }
+
+    std::vector<BSONObj> decompress(const BSONObj& chunk) {
+        auto samples = decompressFTDCChunk(chunk);
+        ASSERT_OK(samples.getStatus());
+        return samples.getValue();
+    }
+
+    void assertSamples(const std::vector<BSONObj>& samples, long long first, long long count) {
+        ASSERT_EQ(static_cast<size_t>(count), samples.size());
+        for (long long i = 0; i < count; ++i) {
+            ASSERT_EQ(makeSample(first + i), samples[i]);
+        }
+    }
+
+    TEST(FTDCCompressor, RoundTrip) {
+        FTDCCompressor compressor(100);
+        BSONObj chunk;
+        ASSERT_FALSE(compressor.getChunk(&chunk));
+
+        for (long long i = 0; i < 50; ++i) {
+            ASSERT_FALSE(compressor.addSample(makeSample(i), Date_t::fromMillisSinceEpoch(i),
+                                              &chunk));
+        }
+        ASSERT_EQ(50U, compressor.numSamples());
+
+        ASSERT_TRUE(compressor.getChunk(&chunk));
+        ASSERT_EQ(Date_t::fromMillisSinceEpoch(0), chunk["_id"].date());
+        ASSERT_EQ(static_cast<int>(FTDCType::kMetricChunk), chunk["type"].numberInt());
+        assertSamples(decompress(chunk), 0, 50);
+
+        // Getting the chunk doesn't start a new one
+        ASSERT_EQ(50U, compressor.numSamples());
+        compressor.reset();
+        ASSERT_EQ(0U, compressor.numSamples());
+        ASSERT_FALSE(compressor.getChunk(&chunk));
+    }
+
+    TEST(FTDCCompressor, FullChunkStartsTheNext) {
+        FTDCCompressor compressor(3);
+        std::vector<BSONObj> chunks;
+        for (long long i = 0; i < 7; ++i) {
+            BSONObj chunk;
+            if (compressor.addSample(makeSample(i), Date_t::fromMillisSinceEpoch(i), &chunk)) {
+                chunks.push_back(chunk);
+            }
+        }
+
+        ASSERT_EQ(2U, chunks.size());
+        assertSamples(decompress(chunks[0]), 0, 3);
+        assertSamples(decompress(chunks[1]), 3, 3);
+        ASSERT_EQ(Date_t::fromMillisSinceEpoch(3), chunks[1]["_id"].date());
+
+        BSONObj last;
+        ASSERT_TRUE(compressor.getChunk(&last));
+        assertSamples(decompress(last), 6, 1);
+    }
+
+    TEST(FTDCCompressor, DifferentFieldsStartTheNextChunk) {
+        const BSONObj samples[] = {
+            BSON("a" << 1 << "b" << 2),
+            BSON("a" << 2 << "b" << 3),
+            // new field
+            BSON("a" << 3 << "b" << 4 << "c" << 5),
+            // renamed field
+            BSON("a" << 4 << "d" << 5 << "c" << 6),
+            // changed type
+            BSON("a" << 5LL << "d" << 6 << "c" << 7),
+            // removed field
+            BSON("a" << 6LL << "d" << 7),
+            // a string may change within a chunk
+            BSON("a" << 7LL << "d" << "x"),
+            BSON("a" << 8LL << "d" << "y"),
+        };
+        const size_t chunkSizes[] = {2, 1, 1, 1, 1, 2};
+
+        FTDCCompressor compressor(100);
+        std::vector<BSONObj> chunks;
+        for (const BSONObj& sample : samples) {
+            BSONObj chunk;
+            if (compressor.addSample(sample, Date_t(), &chunk)) {
+                chunks.push_back(chunk);
+            }
+        }
+        BSONObj last;
+        ASSERT_TRUE(compressor.getChunk(&last));
+        chunks.push_back(last);
+
+        ASSERT_EQ(sizeof(chunkSizes) / sizeof(chunkSizes[0]), chunks.size());
+        size_t next = 0;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            std::vector<BSONObj> decompressed = decompress(chunks[i]);
+            ASSERT_EQ(chunkSizes[i], decompressed.size());
+            for (const BSONObj& sample : decompressed) {
+                // Strings are those of the first sample of the chunk
+                if (sample["d"].type() == String) {
+                    ASSERT_EQ("x", sample["d"].str());
+                    ++next;
+                    continue;
+                }
+                ASSERT_EQ(samples[next++], sample);
+            }
+        }
+        ASSERT_EQ(sizeof(samples) / sizeof(samples[0]), next);
+    }
+
+    TEST(FTDCCompressor, Extremes) {
+        const long long values[] = {
+            0,
+            10,
+            5,
+            -3,
+            std::numeric_limits<long long>::max(),
+            std::numeric_limits<long long>::min(),
+            0,
+        };
+
+        FTDCCompressor compressor(100);
+        BSONObj chunk;
+        for (long long value : values) {
+            ASSERT_FALSE(compressor.addSample(BSON("n" << value), Date_t(), &chunk));
+        }
+        ASSERT_TRUE(compressor.getChunk(&chunk));
+
+        std::vector<BSONObj> samples = decompress(chunk);
+        ASSERT_EQ(sizeof(values) / sizeof(values[0]), samples.size());
+        for (size_t i = 0; i < samples.size(); ++i) {
+            ASSERT_EQ(values[i], samples[i]["n"].numberLong());
+        }
+    }
+
+    TEST(FTDCCompressor, DoublesLoseTheirFraction) {
+        FTDCCompressor compressor(100);
+        BSONObj chunk;
+        ASSERT_FALSE(compressor.addSample(BSON("x" << 1.5), Date_t(), &chunk));
+        ASSERT_FALSE(compressor.addSample(BSON("x" << 2.75), Date_t(), &chunk));
+        ASSERT_FALSE(compressor.addSample(BSON("x" << -4.5), Date_t(), &chunk));
+        ASSERT_TRUE(compressor.getChunk(&chunk));
+
+        std::vector<BSONObj> samples = decompress(chunk);
+        ASSERT_EQ(3U, samples.size());
+        // The first sample is the reference document, which is kept whole
+        ASSERT_EQ(BSON("x" << 1.5), samples[0]);
+        ASSERT_EQ(BSON("x" << 2.0), samples[1]);
+        ASSERT_EQ(BSON("x" << -4.0), samples[2]);
+    }
+
+    TEST(FTDCCompressor, UnchangedMetricsAreSmall) {
+        BSONObjBuilder builder;
+        for (int i = 0; i < 1000; ++i) {
+            builder.append(std::string(str::stream() << "counter" << i), i);
+        }
+        const BSONObj sample = builder.obj();
+
+        FTDCCompressor compressor(300);
+        BSONObj chunk;
+        for (int i = 0; i < 300; ++i) {
+            ASSERT_FALSE(compressor.addSample(sample, Date_t(), &chunk));
+        }
+        ASSERT_TRUE(compressor.getChunk(&chunk));
+
+        // Little more than the compressed reference document, as each metric is one run of zeros
+        ASSERT_LESS_THAN(chunk.objsize(), sample.objsize() + 2 * 1000);
+
+        std::vector<BSONObj> samples = decompress(chunk);
+        ASSERT_EQ(300U, samples.size());
+        ASSERT_EQ(sample, samples.back());
+    }
+
+    TEST(FTDCCompressor, CorruptChunks) {
+        FTDCCompressor compressor(100);
+        BSONObj chunk;
+        for (long long i = 0; i < 10; ++i) {
+            ASSERT_FALSE(compressor.addSample(makeSample(i), Date_t(), &chunk));
+        }
+        ASSERT_TRUE(compressor.getChunk(&chunk));
+
+        int length;
+        const char* data = chunk["data"].binData(length);
+
+        ASSERT_NOT_OK(decompressFTDCChunk(BSON("_id" << 1)).getStatus());
+        ASSERT_NOT_OK(decompressFTDCChunk(BSON("data" << "abc")).getStatus());
+
+        BSONObjBuilder truncated;
+        truncated.appendBinData("data", length / 2, BinDataGeneral, data);
+        ASSERT_NOT_OK(decompressFTDCChunk(truncated.obj()).getStatus());
+
+        std::string flipped(data, length);
+        flipped[length - 5] ^= 0x5a;
+        BSONObjBuilder corrupt;
+        corrupt.appendBinData("data", length, BinDataGeneral, flipped.data());
+        ASSERT_NOT_OK(decompressFTDCChunk(corrupt.obj()).getStatus());
+    }
+
+}  // namespace
@@ -0,0 +1,301 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ftdc/ftdc_file_manager.h"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+
+#include "mongo/bson/bson_validate.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    namespace fs = boost::filesystem;
+
+    const char FTDCFileManager::kInterimFileName[] = "metrics.interim";
+
+namespace {
+
+    const char kFilePrefix[] = "metrics.";
+    const char kTempSuffix[] = ".tmp";
+
+    std::string fileNameForDate(Date_t date) {
+        std::string time = dateToISOStringUTC(date);
+        std::replace(time.begin(), time.end(), ':', '-');
+        return kFilePrefix + time;
+    }
+
+    Status writeFile(const fs::path& file, const BSONObj& doc) {
+        std::ofstream out(file.string().c_str(),
+                          std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        out.write(doc.objdata(), doc.objsize());
+        out.close();
+        if (!out) {
+            return Status(ErrorCodes::FileStreamFailed,
+                          str::stream() << "failed to write " << file.string());
+        }
+        return Status::OK();
+    }
+
+}  // namespace
+
+    FTDCFileManager::FTDCFileManager(const fs::path& directory, const FTDCConfig& config)
+        : _directory(directory),
+          _config(config),
+          _compressor(config.maxSamplesPerChunk) {
+    }
+
+    FTDCFileManager::~FTDCFileManager() {
+        Status status = close();
+        if (!status.isOK()) {
+            warning() << "Failed to write the last diagnostic data samples: " << status;
+        }
+    }
+
+    Status FTDCFileManager::open(const BSONObj& metadata, Date_t now) {
+        invariant(!_file.is_open());
+
+        boost::system::error_code ec;
+        fs::create_directories(_directory, ec);
+        if (ec) {
+            return Status(ErrorCodes::FileNotOpen,
+                          str::stream() << "failed to create " << _directory.string() << ": "
+                                        << ec.message());
+        }
+
+        _metadata = metadata.getOwned();
+        Status status = _openFile(now);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        // The samples a previous run had not written when it stopped
+        const fs::path interim = _directory / kInterimFileName;
+        if (fs::exists(interim)) {
+            std::vector<BSONObj> docs;
+            Status readStatus = readFTDCFile(interim, &docs);
+            if (!readStatus.isOK()) {
+                warning() << "Failed to read " << interim.string() << ": " << readStatus;
+            }
+            for (const BSONObj& doc : docs) {
+                status = _writeDocument(doc);
+                if (!status.isOK()) {
+                    return status;
+                }
+            }
+            fs::remove(interim, ec);
+        }
+        return Status::OK();
+    }
+
+    Status FTDCFileManager::writeSample(const BSONObj& sample, Date_t date) {
+        invariant(_file.is_open());
+
+        BSONObj chunk;
+        if (!_compressor.addSample(sample, date, &chunk)) {
+            if (++_samplesSinceInterim < _config.samplesPerInterimUpdate) {
+                return Status::OK();
+            }
+            return _writeInterim();
+        }
+
+        Status status = _writeDocument(chunk);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        if (_fileSize >= _config.maxFileSizeBytes) {
+            _file.close();
+            _pruneFiles();
+            status = _openFile(date);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+
+        // The interim file still has the samples just written
+        return _writeInterim();
+    }
+
+    Status FTDCFileManager::close() {
+        if (!_file.is_open()) {
+            return Status::OK();
+        }
+
+        Status status = Status::OK();
+        BSONObj chunk;
+        if (_compressor.getChunk(&chunk)) {
+            status = _writeDocument(chunk);
+        }
+        _compressor.reset();
+        _file.close();
+
+        if (status.isOK()) {
+            boost::system::error_code ec;
+            fs::remove(_directory / kInterimFileName, ec);
+        }
+        return status;
+    }
+
+    std::vector<fs::path> FTDCFileManager::listFiles(const fs::path& directory) {
+        std::vector<fs::path> files;
+        boost::system::error_code ec;
+        for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+            const std::string name = it->path().filename().string();
+            if (!str::startsWith(name, kFilePrefix) || name == kInterimFileName ||
+                    str::endsWith(name, kTempSuffix)) {
+                continue;
+            }
+            files.push_back(it->path());
+        }
+
+        // The names sort by the time the files were started
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    Status FTDCFileManager::_openFile(Date_t now) {
+        const std::string name = fileNameForDate(now);
+        fs::path file = _directory / name;
+        for (int i = 1; fs::exists(file); ++i) {
+            file = _directory / std::string(str::stream() << name << "-" << i);
+        }
+
+        _file.open(file.string().c_str(),
+                   std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        if (!_file) {
+            return Status(ErrorCodes::FileNotOpen,
+                          str::stream() << "failed to open " << file.string());
+        }
+        _currentPath = file;
+        _fileSize = 0;
+
+        BSONObjBuilder metadataDoc;
+        metadataDoc.appendDate("_id", now);
+        metadataDoc.append("type", static_cast<int>(FTDCType::kMetadata));
+        metadataDoc.append("doc", _metadata);
+        return _writeDocument(metadataDoc.obj());
+    }
+
+    Status FTDCFileManager::_writeDocument(const BSONObj& doc) {
+        _file.write(doc.objdata(), doc.objsize());
+        _file.flush();
+        if (!_file) {
+            return Status(ErrorCodes::FileStreamFailed,
+                          str::stream() << "failed to write " << _currentPath.string());
+        }
+        _fileSize += doc.objsize();
+        return Status::OK();
+    }
+
+    Status FTDCFileManager::_writeInterim() {
+        _samplesSinceInterim = 0;
+
+        BSONObj chunk;
+        if (!_compressor.getChunk(&chunk)) {
+            return Status::OK();
+        }
+
+        // Written aside and renamed, so that the interim file is always whole
+        const fs::path interim = _directory / kInterimFileName;
+        const fs::path temp = _directory / (std::string(kInterimFileName) + kTempSuffix);
+        Status status = writeFile(temp, chunk);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        boost::system::error_code ec;
+        fs::rename(temp, interim, ec);
+        if (ec) {
+            return Status(ErrorCodes::FileStreamFailed,
+                          str::stream() << "failed to rename " << temp.string() << " to "
+                                        << interim.string() << ": " << ec.message());
+        }
+        return Status::OK();
+    }
+
+    void FTDCFileManager::_pruneFiles() {
+        const std::vector<fs::path> files = listFiles(_directory);
+
+        std::vector<size_t> sizes;
+        size_t totalSize = 0;
+        for (const fs::path& file : files) {
+            boost::system::error_code ec;
+            const size_t size = fs::file_size(file, ec);
+            sizes.push_back(ec ? 0 : size);
+            totalSize += sizes.back();
+        }
+
+        // Leave room for the file about to be started
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (totalSize + _config.maxFileSizeBytes <= _config.maxDirectorySizeBytes) {
+                break;
+            }
+            boost::system::error_code ec;
+            fs::remove(files[i], ec);
+            if (ec) {
+                warning() << "Failed to remove " << files[i].string() << ": " << ec.message();
+                break;
+            }
+            LOG(1) << "Removed diagnostic data file " << files[i].string();
+            totalSize -= sizes[i];
+        }
+    }
+
+    Status readFTDCFile(const fs::path& file, std::vector<BSONObj>* docs) {
+        std::ifstream in(file.string().c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!in) {
+            return Status(ErrorCodes::FileNotOpen,
+                          str::stream() << "failed to open " << file.string());
+        }
+        const std::string contents((std::istreambuf_iterator<char>(in)),
+                                   std::istreambuf_iterator<char>());
+
+        size_t pos = 0;
+        while (pos < contents.size()) {
+            const size_t remaining = contents.size() - pos;
+            const char* data = contents.data() + pos;
+            if (remaining < sizeof(int) || !validateBSON(data, remaining).isOK()) {
+                return Status(ErrorCodes::FailedToParse,
+                              str::stream() << file.string() << " is cut short or corrupt at "
+                                            << "offset " << pos);
+            }
+            const BSONObj doc(data);
+            docs->push_back(doc.getOwned());
+            pos += doc.objsize();
+        }
+        return Status::OK();
+    }
+
+}  // namespace mongo
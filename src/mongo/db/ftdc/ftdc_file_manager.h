@@ -0,0 +1,117 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/db/ftdc/ftdc_compressor.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    struct FTDCConfig {
+        // A new file is started once the current one is this big
+        size_t maxFileSizeBytes = 10 * 1024 * 1024;
+
+        // The oldest files are removed to keep the directory under this size
+        size_t maxDirectorySizeBytes = 100 * 1024 * 1024;
+
+        size_t maxSamplesPerChunk = 300;
+
+        // How often the samples of the chunk being filled are saved to the interim file, so that
+        // a crash loses fewer of them
+        size_t samplesPerInterimUpdate = 10;
+    };
+
+    /**
+     * Writes diagnostic data samples into a directory of rotating files.
+     *
+     * Each file, named metrics.<time it was started>, is a sequence of BSON documents: a
+     * metadata document and then the chunks of samples made by FTDCCompressor. The chunk being
+     * filled is also saved every few samples to metrics.interim, which is moved into the next
+     * file when the directory is opened again after a crash.
+     */
+    class FTDCFileManager {
+        MONGO_DISALLOW_COPYING(FTDCFileManager);
+    public:
+        static const char kInterimFileName[];
+
+        FTDCFileManager(const boost::filesystem::path& directory, const FTDCConfig& config);
+        ~FTDCFileManager();
+
+        /**
+         * Creates the directory if needed, recovers the interim file of a previous run and
+         * starts a new file, which begins with "metadata".
+         */
+        Status open(const BSONObj& metadata, Date_t now);
+
+        Status writeSample(const BSONObj& sample, Date_t date);
+
+        /**
+         * Writes the samples of the chunk being filled and removes the interim file.
+         */
+        Status close();
+
+        /**
+         * Returns the metrics files of "directory", oldest first, without the interim file.
+         */
+        static std::vector<boost::filesystem::path> listFiles(
+            const boost::filesystem::path& directory);
+
+    private:
+        Status _openFile(Date_t now);
+        Status _writeDocument(const BSONObj& doc);
+        Status _writeInterim();
+        void _pruneFiles();
+
+        const boost::filesystem::path _directory;
+        const FTDCConfig _config;
+
+        FTDCCompressor _compressor;
+        BSONObj _metadata;
+
+        boost::filesystem::path _currentPath;
+        std::ofstream _file;
+        size_t _fileSize = 0;
+        size_t _samplesSinceInterim = 0;
+    };
+
+    /**
+     * Reads the documents of a diagnostic data file into "docs". A file cut short by a crash
+     * gives the documents before the cut and an error.
+     */
+    Status readFTDCFile(const boost::filesystem::path& file, std::vector<BSONObj>* docs);
+
+}  // namespace mongo
@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <vector>
+
+#include "mongo/db/ftdc/ftdc_compressor.h"
+#include "mongo/db/ftdc/ftdc_file_manager.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+    using namespace mongo;
+    namespace fs = boost::filesystem;
+
+    BSONObj makeSample(int i) {
+        return BSON("n" << i << "twice" << 2 * i << "name" << "test");
+    }
+
+    Date_t dateOf(int i) {
+        return Date_t::fromMillisSinceEpoch(1000LL * i);
+    }
+
+    /**
+     * Returns the samples in the files of "directory", checking that each file starts with the
+     * metadata document.
+     */
+    std::vector<BSONObj> readSamples(const fs::path& directory) {
+        std::vector<BSONObj> samples;
+        for (const fs::path& file : FTDCFileManager::listFiles(directory)) {
+            std::vector<BSONObj> docs;
+            ASSERT_OK(readFTDCFile(file, &docs));
+            ASSERT_FALSE(docs.empty());
+            ASSERT_EQ(static_cast<int>(FTDCType::kMetadata), docs[0]["type"].numberInt());
+            ASSERT_EQ(BSON("host" << "test"), docs[0]["doc"].Obj());
+
+            for (size_t i = 1; i < docs.size(); ++i) {
+                auto chunkSamples = decompressFTDCChunk(docs[i]);
+                ASSERT_OK(chunkSamples.getStatus());
+                samples.insert(samples.end(),
+                               chunkSamples.getValue().begin(),
+                               chunkSamples.getValue().end());
+            }
+        }
+        return samples;
+    }
+
+    void assertSamples(const std::vector<BSONObj>& samples, int first, int count) {
+        ASSERT_EQ(static_cast<size_t>(count), samples.size());
+        for (int i = 0; i < count; ++i) {
+            ASSERT_EQ(makeSample(first + i), samples[i]);
+        }
+    }
+
+    TEST(FTDCFileManager, WritesSamples) {
+        unittest::TempDir tempDir("ftdc_writes_samples");
+        const fs::path directory = fs::path(tempDir.path()) / "diagnostic.data";
+
+        FTDCConfig config;
+        config.maxSamplesPerChunk = 7;
+        {
+            FTDCFileManager files(directory, config);
+            ASSERT_OK(files.open(BSON("host" << "test"), dateOf(0)));
+            for (int i = 0; i < 30; ++i) {
+                ASSERT_OK(files.writeSample(makeSample(i), dateOf(i)));
+            }
+            ASSERT_OK(files.close());
+        }
+
+        ASSERT_EQ(1U, FTDCFileManager::listFiles(directory).size());
+        ASSERT_FALSE(fs::exists(directory / FTDCFileManager::kInterimFileName));
+        assertSamples(readSamples(directory), 0, 30);
+    }
+
+    TEST(FTDCFileManager, RotatesAndPrunesFiles) {
+        unittest::TempDir tempDir("ftdc_rotates_files");
+        const fs::path directory(tempDir.path());
+
+        // Every chunk starts a new file
+        FTDCConfig config;
+        config.maxSamplesPerChunk = 2;
+        config.maxFileSizeBytes = 1;
+        config.maxDirectorySizeBytes = 1024 * 1024;
+        {
+            FTDCFileManager files(directory, config);
+            ASSERT_OK(files.open(BSON("host" << "test"), dateOf(0)));
+            for (int i = 0; i < 10; ++i) {
+                ASSERT_OK(files.writeSample(makeSample(i), dateOf(i)));
+            }
+        }
+        ASSERT_EQ(5U, FTDCFileManager::listFiles(directory).size());
+        assertSamples(readSamples(directory), 0, 10);
+
+        // With no room for old files, only the last is kept
+        config.maxDirectorySizeBytes = 1;
+        {
+            FTDCFileManager files(directory, config);
+            ASSERT_OK(files.open(BSON("host" << "test"), dateOf(100)));
+            for (int i = 0; i < 10; ++i) {
+                ASSERT_OK(files.writeSample(makeSample(i), dateOf(100 + i)));
+            }
+        }
+        ASSERT_EQ(1U, FTDCFileManager::listFiles(directory).size());
+        assertSamples(readSamples(directory), 8, 2);
+    }
+
+    TEST(FTDCFileManager, RecoversInterimFile) {
+        unittest::TempDir tempDir("ftdc_recovers_interim");
+        const fs::path directory(tempDir.path());
+        const fs::path interim = directory / FTDCFileManager::kInterimFileName;
+        const fs::path saved = directory / "saved";
+
+        FTDCConfig config;
+        config.samplesPerInterimUpdate = 2;
+        {
+            FTDCFileManager files(directory, config);
+            ASSERT_OK(files.open(BSON("host" << "test"), dateOf(0)));
+            for (int i = 0; i < 5; ++i) {
+                ASSERT_OK(files.writeSample(makeSample(i), dateOf(i)));
+            }
+
+            // What a crash now would leave: the interim file has the samples up to the last
+            // update
+            ASSERT_TRUE(fs::exists(interim));
+            fs::copy_file(interim, saved);
+        }
+        for (const fs::path& file : FTDCFileManager::listFiles(directory)) {
+            fs::remove(file);
+        }
+        fs::rename(saved, interim);
+
+        {
+            FTDCFileManager files(directory, config);
+            ASSERT_OK(files.open(BSON("host" << "test"), dateOf(10)));
+            ASSERT_FALSE(fs::exists(interim));
+            ASSERT_OK(files.writeSample(makeSample(4), dateOf(10)));
+        }
+        assertSamples(readSamples(directory), 0, 5);
+    }
+
+}  // namespace
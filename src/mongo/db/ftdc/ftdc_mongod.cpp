@@ -0,0 +1,236 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ftdc/ftdc_mongod.h"
+
+#include <algorithm>
+#include <boost/filesystem/path.hpp>
+#include <memory>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/ftdc/ftdc_file_manager.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    // Whether diagnostic data is written to the diagnostic.data directory of the dbpath, and how
+    // often it is sampled.
+    MONGO_EXPORT_SERVER_PARAMETER(diagnosticDataCollectionEnabled, bool, true);
+    MONGO_EXPORT_SERVER_PARAMETER(diagnosticDataCollectionPeriodMillis, int, 1000);
+
+    // The files are rotated at diagnosticDataCollectionFileSizeMB, and the oldest removed to keep
+    // the directory under diagnosticDataCollectionDirectorySizeMB.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(diagnosticDataCollectionFileSizeMB, int, 10);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(diagnosticDataCollectionDirectorySizeMB, int, 100);
+
+    // Samples per compressed chunk, and how often the chunk being filled is saved in case of a
+    // crash.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(diagnosticDataCollectionSamplesPerChunk, int, 300);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(diagnosticDataCollectionSamplesPerInterimUpdate,
+                                          int,
+                                          10);
+
+namespace {
+
+    const char kDirectoryName[] = "diagnostic.data";
+
+    // The shortest period, so that a mistaken setting doesn't make the server busy sampling
+    const int kMinPeriodMillis = 100;
+
+    void appendCommandResult(DBDirectClient* client,
+                             const BSONObj& cmdObj,
+                             BSONObjBuilder* builder) {
+        BSONObj result;
+        if (client->runCommand("admin", cmdObj, result)) {
+            builder->append(cmdObj.firstElementFieldName(), result);
+        }
+    }
+
+    BSONObj collectSample(OperationContext* txn) {
+        BSONObjBuilder sample;
+        sample.appendDate("start", jsTime());
+
+        DBDirectClient client(txn);
+        appendCommandResult(&client, BSON("serverStatus" << 1), &sample);
+
+        repl::ReplicationCoordinator* replCoord = repl::getGlobalReplicationCoordinator();
+        if (replCoord->getReplicationMode() == repl::ReplicationCoordinator::modeReplSet) {
+            appendCommandResult(&client, BSON("replSetGetStatus" << 1), &sample);
+        }
+
+        sample.appendDate("end", jsTime());
+        return sample.obj();
+    }
+
+    BSONObj collectMetadata(OperationContext* txn) {
+        BSONObjBuilder metadata;
+        DBDirectClient client(txn);
+        appendCommandResult(&client, BSON("buildInfo" << 1), &metadata);
+        appendCommandResult(&client, BSON("getCmdLineOpts" << 1), &metadata);
+        appendCommandResult(&client, BSON("hostInfo" << 1), &metadata);
+        return metadata.obj();
+    }
+
+    FTDCConfig getConfig() {
+        FTDCConfig config;
+        config.maxFileSizeBytes =
+            static_cast<size_t>(std::max(diagnosticDataCollectionFileSizeMB, 1)) * 1024 * 1024;
+        config.maxDirectorySizeBytes =
+            static_cast<size_t>(std::max(diagnosticDataCollectionDirectorySizeMB, 1)) *
+            1024 * 1024;
+        config.maxSamplesPerChunk =
+            static_cast<size_t>(std::max(diagnosticDataCollectionSamplesPerChunk, 1));
+        config.samplesPerInterimUpdate =
+            static_cast<size_t>(std::max(diagnosticDataCollectionSamplesPerInterimUpdate, 1));
+        return config;
+    }
+
+    class DiagnosticDataCollector : public BackgroundJob {
+    public:
+        virtual std::string name() const { return "DiagnosticDataCollector"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            const boost::filesystem::path directory =
+                boost::filesystem::path(storageGlobalParams.dbpath) / kDirectoryName;
+            std::unique_ptr<FTDCFileManager> files;
+
+            // Once writing fails, it is left off until collection is turned off and on again,
+            // rather than failing and logging every period.
+            bool failed = false;
+
+            Date_t next = jsTime();
+            while (!inShutdown()) {
+                const Milliseconds period(std::max(diagnosticDataCollectionPeriodMillis,
+                                                   kMinPeriodMillis));
+                next += period;
+                const Date_t now = jsTime();
+                if (next > now) {
+                    sleepmillis(durationCount<Milliseconds>(next - now));
+                }
+                else {
+                    // Fell behind, as when the clock moved; start again from now
+                    next = now;
+                }
+
+                if (!diagnosticDataCollectionEnabled) {
+                    files.reset();
+                    failed = false;
+                    continue;
+                }
+                if (failed) {
+                    continue;
+                }
+
+                try {
+                    OperationContextImpl txn;
+                    const Date_t date = jsTime();
+                    const BSONObj sample = collectSample(&txn);
+
+                    Status status = Status::OK();
+                    if (!files) {
+                        files.reset(new FTDCFileManager(directory, getConfig()));
+                        status = files->open(collectMetadata(&txn), date);
+                    }
+                    if (status.isOK()) {
+                        status = files->writeSample(sample, date);
+                    }
+                    if (!status.isOK()) {
+                        warning() << "Stopped writing diagnostic data to " << directory.string()
+                                  << ": " << status;
+                        files.reset();
+                        failed = true;
+                    }
+                }
+                catch (const DBException& ex) {
+                    warning() << "Failed to collect diagnostic data: " << ex.toString();
+                }
+            }
+        }
+    };
+
+    class CmdGetDiagnosticData : public Command {
+    public:
+        CmdGetDiagnosticData() : Command("getDiagnosticData") {}
+
+        virtual bool slaveOk() const { return true; }
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual bool adminOnly() const { return true; }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::serverStatus);
+            actions.addAction(ActionType::replSetGetStatus);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        virtual void help(std::stringstream& help) const {
+            help << "{ getDiagnosticData : 1 } returns a sample of the diagnostic data that is\n";
+            help << "written to the diagnostic.data directory of the dbpath";
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const std::string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         std::string& errmsg,
+                         BSONObjBuilder& result) {
+            result.append("data", collectSample(txn));
+            return true;
+        }
+
+    } cmdGetDiagnosticData;
+
+}  // namespace
+
+    void startFTDC() {
+        DiagnosticDataCollector* collector = new DiagnosticDataCollector();
+        collector->go();
+    }
+
+}  // namespace mongo
@@ -0,0 +1,183 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ftdc/ftdc_util.h"
+
+#include <limits>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+    bool isMetric(BSONType type) {
+        switch (type) {
+        case NumberDouble:
+        case NumberInt:
+        case NumberLong:
+        case Bool:
+        case Date:
+        case bsonTimestamp:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    std::uint64_t metricValue(const BSONElement& elt) {
+        switch (elt.type()) {
+        case NumberDouble: {
+            // NaN and out of range values, which have no integer value, are recorded as 0
+            const double value = elt.numberDouble();
+            const double limit = static_cast<double>(std::numeric_limits<long long>::max());
+            if (!(value > -limit && value < limit)) {
+                return 0;
+            }
+            return static_cast<std::uint64_t>(static_cast<long long>(value));
+        }
+        case NumberInt:
+        case NumberLong:
+            return static_cast<std::uint64_t>(elt.numberLong());
+        case Bool:
+            return elt.boolean() ? 1 : 0;
+        case Date:
+            return static_cast<std::uint64_t>(elt.date().toMillisSinceEpoch());
+        case bsonTimestamp:
+            return elt.timestamp().asULL();
+        default:
+            invariant(false);
+            return 0;
+        }
+    }
+
+    void appendMetric(BSONObjBuilder* builder, const BSONElement& referenceElt,
+                      std::uint64_t value) {
+        const StringData name = referenceElt.fieldNameStringData();
+        switch (referenceElt.type()) {
+        case NumberDouble:
+            builder->append(name, static_cast<double>(static_cast<long long>(value)));
+            return;
+        case NumberInt:
+            builder->append(name, static_cast<int>(value));
+            return;
+        case NumberLong:
+            builder->append(name, static_cast<long long>(value));
+            return;
+        case Bool:
+            builder->append(name, value != 0);
+            return;
+        case Date:
+            builder->appendDate(name, Date_t::fromMillisSinceEpoch(static_cast<long long>(value)));
+            return;
+        case bsonTimestamp:
+            builder->append(name, Timestamp(static_cast<unsigned long long>(value)));
+            return;
+        default:
+            invariant(false);
+        }
+    }
+
+    bool isNested(BSONType type) {
+        return type == Object || type == Array;
+    }
+
+}  // namespace
+
+    bool extractFTDCMetrics(const BSONObj& reference,
+                            const BSONObj& sample,
+                            std::vector<std::uint64_t>* metrics) {
+        BSONObjIterator refIt(reference);
+        BSONObjIterator it(sample);
+        while (it.more()) {
+            if (!refIt.more()) {
+                return false;
+            }
+            const BSONElement refElt = refIt.next();
+            const BSONElement elt = it.next();
+            if (elt.type() != refElt.type() ||
+                    elt.fieldNameStringData() != refElt.fieldNameStringData()) {
+                return false;
+            }
+
+            if (isMetric(elt.type())) {
+                metrics->push_back(metricValue(elt));
+            }
+            else if (isNested(elt.type())) {
+                if (!extractFTDCMetrics(refElt.Obj(), elt.Obj(), metrics)) {
+                    return false;
+                }
+            }
+        }
+        return !refIt.more();
+    }
+
+    BSONObj constructFTDCSample(const BSONObj& reference,
+                                const std::vector<std::uint64_t>& metrics,
+                                size_t* pos) {
+        BSONObjBuilder builder;
+        BSONObjIterator it(reference);
+        while (it.more()) {
+            const BSONElement refElt = it.next();
+            if (isMetric(refElt.type())) {
+                invariant(*pos < metrics.size());
+                appendMetric(&builder, refElt, metrics[(*pos)++]);
+            }
+            else if (refElt.type() == Object) {
+                builder.append(refElt.fieldNameStringData(),
+                               constructFTDCSample(refElt.Obj(), metrics, pos));
+            }
+            else if (refElt.type() == Array) {
+                builder.appendArray(refElt.fieldNameStringData(),
+                                    constructFTDCSample(refElt.Obj(), metrics, pos));
+            }
+            else {
+                builder.append(refElt);
+            }
+        }
+        return builder.obj();
+    }
+
+    size_t countFTDCMetrics(const BSONObj& reference) {
+        size_t count = 0;
+        BSONObjIterator it(reference);
+        while (it.more()) {
+            const BSONElement elt = it.next();
+            if (isMetric(elt.type())) {
+                ++count;
+            }
+            else if (isNested(elt.type())) {
+                count += countFTDCMetrics(elt.Obj());
+            }
+        }
+        return count;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,67 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * The metrics of a diagnostic data sample are its numeric fields, booleans, dates and
+     * timestamps, in document order, as 64 bit integers. Doubles lose their fractional part.
+     * The other fields, such as strings, are kept once per chunk in its reference document, the
+     * first sample of the chunk.
+     */
+
+    /**
+     * Appends the metrics of "sample" to "metrics". Returns false, with "metrics" only partly
+     * filled, if "sample" does not have the same fields as "reference", in the same order and of
+     * the same types, so that it can't be rebuilt from the reference document and its metrics.
+     */
+    bool extractFTDCMetrics(const BSONObj& reference,
+                            const BSONObj& sample,
+                            std::vector<std::uint64_t>* metrics);
+
+    /**
+     * Rebuilds a sample from the reference document of its chunk and its metrics, starting at
+     * "*pos" in "metrics". Advances "*pos" past the metrics used.
+     */
+    BSONObj constructFTDCSample(const BSONObj& reference,
+                                const std::vector<std::uint64_t>& metrics,
+                                size_t* pos);
+
+    /**
+     * Returns how many metrics a sample with the fields of "reference" has.
+     */
+    size_t countFTDCMetrics(const BSONObj& reference);
+
+}  // namespace mongo
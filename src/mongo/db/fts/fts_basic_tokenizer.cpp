@@ -45,12 +45,14 @@ namespace fts {
     using std::string;
 
     BasicFTSTokenizer::BasicFTSTokenizer(const FTSLanguage* language)
-        : _language(language), _stemmer(language), _stopWords(StopWords::getStopWords(language)) {
+        : _language(language),
+          _stemmer(Stemmer::getThreadStemmer(language)),
+          _stopWords(StopWords::getStopWords(language)) {
     }
 
     void BasicFTSTokenizer::reset(StringData document, Options options) {
         _options = options;
-        _document = document.toString();
+        _document.assign(document.rawData(), document.size());
         _tokenizer = stdx::make_unique<Tokenizer>(_language, _document);
     }
 
@@ -69,22 +71,24 @@ namespace fts {
                 continue;
             }
 
-            string word = token.data.toString();
-
-            word = tolowerString(token.data);
+            _word.resize(token.data.size());
+            for (size_t i = 0; i < token.data.size(); ++i) {
+                _word[i] = (char)tolower((int)token.data[i]);
+            }
 
             // Stop words are case-sensitive so we need them to be lower cased to check
             // against the stop word list
             if ((_options & FTSTokenizer::FilterStopWords) &&
-                _stopWords->isStopWord(word)) {
+                _stopWords->isStopWord(_word)) {
                 continue;
             }
 
             if (_options & FTSTokenizer::GenerateCaseSensitiveTokens) {
-                word = token.data.toString();
+                _word.assign(token.data.rawData(), token.data.size());
             }
 
-            _stem = _stemmer.stem(word);
+            StringData stem = _stemmer->stemCached(_word);
+            _stem.assign(stem.rawData(), stem.size());
             return true;
         }
     }
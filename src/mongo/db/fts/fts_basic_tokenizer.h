@@ -47,7 +47,8 @@ namespace fts {
      * - Tokenizer for tokenizing words via ASCII space (ie, U+0020 space).
      * - tolower from the C standard libary to lower letters, ie, it only supports lower casing
      * -     ASCII letters (U+0000 - U+007F)
-     * - Stemmer (ie, Snowball Stemmer) to stem words.
+     * - Stemmer (ie, Snowball Stemmer) to stem words, shared by the tokenizers of a thread for
+     *     the same language so that its cache of recent stems carries over.
      * - Embeded stop word lists for each language in StopWord class
      *
      * For each word returns a stem version of a word optimized for full text indexing.
@@ -66,13 +67,15 @@ namespace fts {
 
     private:
         const FTSLanguage* const _language;
-        const Stemmer _stemmer;
+        Stemmer* const _stemmer;
         const StopWords* const _stopWords;
 
         std::string _document;
         std::unique_ptr<Tokenizer> _tokenizer;
         Options _options;
 
+        // Reused across words so as to keep their buffers.
+        std::string _word;
         std::string _stem;
     };
 
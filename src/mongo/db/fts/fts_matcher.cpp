@@ -60,6 +60,10 @@ namespace mongo {
         }
 
         bool FTSMatcher::matches( const BSONObj& obj ) const {
+            return matches( obj, true );
+        }
+
+        bool FTSMatcher::matches( const BSONObj& obj, bool checkNegatedTerms ) const {
             if ( canSkipPositiveTermCheck() ) {
                 // We can assume that 'obj' has at least one positive term, and dassert as a sanity
                 // check.
@@ -71,7 +75,7 @@ namespace mongo {
                 }
             }
 
-            if ( hasNegativeTerm( obj ) ) {
+            if ( checkNegatedTerms && hasNegativeTerm( obj ) ) {
                 return false;
             }
 
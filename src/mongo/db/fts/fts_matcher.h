@@ -53,6 +53,19 @@ namespace mongo {
              */
             bool matches( const BSONObj& obj ) const;
 
+            /**
+             * As above, but if 'checkNegatedTerms' is false condition 2) is assumed to hold, as
+             * when the caller has already ruled out the documents with negated terms.
+             */
+            bool matches( const BSONObj& obj, bool checkNegatedTerms ) const;
+
+            /**
+             * Whether a document contains a negated term exactly when the text index has a key
+             * for that term and document, so that negated terms can be checked from the index.
+             * Index keys are not case sensitive, so this is the case unless the query is.
+             */
+            bool negatedTermsAreIndexKeys() const { return !_query.getCaseSensitive(); }
+
             /**
              * Returns whether 'obj' contains at least one positive term.
              */
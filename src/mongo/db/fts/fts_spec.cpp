@@ -174,9 +174,15 @@ namespace mongo {
 
             FTSElementIterator it( *this, obj );
 
+            // The strings of a document mostly share a language, so keep the tokenizer around.
+            const FTSLanguage* tokenizerLanguage = NULL;
+            std::unique_ptr<FTSTokenizer> tokenizer;
             while ( it.more() ) {
                 FTSIteratorValue val = it.next();
-                std::unique_ptr<FTSTokenizer> tokenizer(val._language->createTokenizer());
+                if ( val._language != tokenizerLanguage ) {
+                    tokenizer = val._language->createTokenizer();
+                    tokenizerLanguage = val._language;
+                }
                 _scoreStringV2( tokenizer.get(), val._text, term_freqs, val._weight );
             }
         }
@@ -192,10 +198,13 @@ namespace mongo {
 
             tokenizer->reset(raw.rawData(), FTSTokenizer::FilterStopWords );
 
+            // Reused for each token, so that only terms seen first are copied.
+            string token;
             while (tokenizer->moveNext()) {
-                string term = tokenizer->get().toString();
+                StringData stem = tokenizer->get();
+                token.assign( stem.rawData(), stem.size() );
 
-                ScoreHelperStruct& data = terms[term];
+                ScoreHelperStruct& data = terms[token];
 
                 if ( data.exp ) {
                     data.exp *= 2;
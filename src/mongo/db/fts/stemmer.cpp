@@ -29,17 +29,34 @@
 */
 
 #include <cstdlib>
+#include <map>
+#include <memory>
 #include <string>
 
 #include "mongo/db/fts/stemmer.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
+    namespace fts {
+        struct ThreadStemmers {
+            std::map<const FTSLanguage*, std::unique_ptr<Stemmer> > stemmers;
+        };
+    }
+
+    // Outside of namespace fts due to the way TSP_DEFINE is defined.
+    TSP_DEFINE(fts::ThreadStemmers, threadStemmers);
+
     namespace fts {
 
         using std::string;
 
+        namespace {
+            // How many words each stemmer remembers the stem of.
+            const size_t kMaxRecentStems = 4096;
+        }
+
         Stemmer::Stemmer( const FTSLanguage* language ) {
             _stemmer = NULL;
             if ( language->str() != "none" )
@@ -69,6 +86,36 @@ namespace mongo {
             return string( (const char*)(sb_sym), sb_stemmer_length( _stemmer ) );
         }
 
+        StringData Stemmer::stemCached( StringData word ) {
+            if ( !_stemmer )
+                return word;
+
+            _lookupWord.assign( word.rawData(), word.size() );
+            unordered_map<string, RecentStems::iterator>::const_iterator it =
+                _recentStemsIndex.find( _lookupWord );
+            if ( it != _recentStemsIndex.end() ) {
+                _recentStems.splice( _recentStems.begin(), _recentStems, it->second );
+                return it->second->second;
+            }
+
+            if ( _recentStems.size() >= kMaxRecentStems ) {
+                _recentStemsIndex.erase( _recentStems.back().first );
+                _recentStems.pop_back();
+            }
+
+            _recentStems.push_front( std::make_pair( _lookupWord, stem( word ) ) );
+            _recentStemsIndex[_lookupWord] = _recentStems.begin();
+            return _recentStems.front().second;
+        }
+
+        // static
+        Stemmer* Stemmer::getThreadStemmer( const FTSLanguage* language ) {
+            std::unique_ptr<Stemmer>& stemmer = threadStemmers.getMake()->stemmers[language];
+            if ( !stemmer )
+                stemmer.reset( new Stemmer( language ) );
+            return stemmer.get();
+        }
+
     }
 
 }
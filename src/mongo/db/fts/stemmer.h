@@ -31,10 +31,13 @@
 
 #pragma once
 
+#include <list>
 #include <string>
+#include <utility>
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/fts/fts_language.h"
+#include "mongo/platform/unordered_map.h"
 #include "third_party/libstemmer_c/include/libstemmer.h"
 
 namespace mongo {
@@ -53,8 +56,29 @@ namespace mongo {
             ~Stemmer();
 
             std::string stem( StringData word ) const;
+
+            /**
+             * Same as stem(), but remembers the stems of the most recently stemmed words rather
+             * than running the stemmer on them again. The result is valid until the next call.
+             */
+            StringData stemCached( StringData word );
+
+            /**
+             * Returns the stemmer for 'language' of the calling thread, created on first use and
+             * kept with its cache for the life of the thread.
+             */
+            static Stemmer* getThreadStemmer( const FTSLanguage* language );
+
         private:
             struct sb_stemmer* _stemmer;
+
+            // Most recently used first, mapping each word to its stem.
+            typedef std::list<std::pair<std::string, std::string> > RecentStems;
+            RecentStems _recentStems;
+            unordered_map<std::string, RecentStems::iterator> _recentStemsIndex;
+
+            // Reused for looking up words in _recentStemsIndex.
+            std::string _lookupWord;
         };
     }
 }
@@ -33,6 +33,7 @@
 
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/fts/stemmer.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
     namespace fts {
@@ -49,5 +50,23 @@ namespace mongo {
             ASSERT_EQUALS( "Unite", s.stem( "United" ) );
         }
 
+        TEST( English, StemCached ) {
+            Stemmer s( &languageEnglishV2 );
+            for ( int i = 0; i < 10000; i++ ) {
+                std::string word = mongoutils::str::stream() << "running" << ( i % 5000 );
+                ASSERT_EQUALS( s.stem( word ), s.stemCached( word ).toString() );
+            }
+            ASSERT_EQUALS( "run", s.stemCached( "running" ) );
+            ASSERT_EQUALS( "run", s.stemCached( "running" ) );
+            ASSERT_EQUALS( "Run", s.stemCached( "Running" ) );
+        }
+
+        TEST( English, ThreadStemmer ) {
+            Stemmer* s = Stemmer::getThreadStemmer( &languageEnglishV2 );
+            ASSERT_EQUALS( s, Stemmer::getThreadStemmer( &languageEnglishV2 ) );
+            ASSERT_NOT_EQUALS( s, Stemmer::getThreadStemmer( &languagePorterV1 ) );
+            ASSERT_EQUALS( "run", s->stemCached( "running" ) );
+        }
+
     }
 }
@@ -49,20 +49,10 @@ namespace mongo {
     /* 
      * GeoBitSets fills out various bit patterns that are used by GeoHash.
      * What patterns?  Look at the comments next to the fields.
-     * TODO(hk): hashedToNormal is still a bit of a mystery.
      */
     class GeoBitSets {
     public:
         GeoBitSets() {
-            for (unsigned i = 0; i < 16; i++) {
-                unsigned fixed = 0;
-                for (int j = 0; j < 4; j++) {
-                    if (i & (1 << j))
-                        fixed |= (1 << (j * 2));
-                }
-                hashedToNormal[fixed] = i;
-            }
-
             // Generate all 32 + 1 all-on bit patterns by repeatedly shifting the next bit to the
             // correct position
 
@@ -94,8 +84,6 @@ namespace mongo {
         // allY[2] = 5000000000000000
         // allY[3] = 5400000000000000
         long long allY[33];
-
-        unsigned hashedToNormal[256];
     };
 
     // Oh global variables.
@@ -114,6 +102,29 @@ namespace mongo {
         return 1LL << (63 - i);
     }
 
+    // Moves bit i of 'v' to bit 2i of the result, leaving the odd bits clear.  Each step splits
+    // the runs of bits in half, so this takes five shifts rather than a loop over the bits.
+    inline static unsigned long long spreadBits(unsigned v) {
+        unsigned long long x = v;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+        x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+        x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        x = (x | (x << 2)) & 0x3333333333333333ULL;
+        x = (x | (x << 1)) & 0x5555555555555555ULL;
+        return x;
+    }
+
+    // The inverse of spreadBits: gathers the even bits of 'x', ignoring the odd ones.
+    inline static unsigned compactBits(unsigned long long x) {
+        x &= 0x5555555555555555ULL;
+        x = (x | (x >> 1)) & 0x3333333333333333ULL;
+        x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+        x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+        x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+        x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+        return static_cast<unsigned>(x);
+    }
+
     // Binary data is stored in some particular byte ordering that requires this.
     static void copyAndReverse(char *dst, const char *src) {
         for (unsigned a = 0; a < 8; a++) {
@@ -167,12 +178,11 @@ namespace mongo {
 
     GeoHash::GeoHash(unsigned x, unsigned y, unsigned bits) {
         verify(bits <= 32);
-        _hash = 0;
+        // The most significant bit of x is the most significant bit of the hash, followed by the
+        // most significant bit of y, and so on.
+        _hash = static_cast<long long>((spreadBits(x) << 1) | spreadBits(y));
         _bits = bits;
-        for (unsigned i = 0; i < bits; i++) {
-            if (isBitSet(x, i)) _hash |= mask64For(i * 2);
-            if (isBitSet(y, i)) _hash |= mask64For((i * 2) + 1);
-        }
+        clearUnusedBits();
     }
 
     GeoHash::GeoHash(const GeoHash& old) {
@@ -184,18 +194,10 @@ namespace mongo {
         clearUnusedBits();
     }
 
-    // TODO(hk): This is nasty and has no examples.
     void GeoHash::unhash_fast(unsigned *x, unsigned *y) const {
-        *x = 0;
-        *y = 0;
-        const char *c = reinterpret_cast<const char*>(&_hash);
-        for (int i = 0; i < 8; i++) {
-            unsigned t = (unsigned)(c[i]) & 0x55;
-            *y |= (geoBitSets.hashedToNormal[t] << (4 * i));
-
-            t = ((unsigned)(c[i]) >> 1) & 0x55;
-            *x |= (geoBitSets.hashedToNormal[t] << (4 * i));
-        }
+        const unsigned long long hash = static_cast<unsigned long long>(_hash);
+        *x = compactBits(hash >> 1);
+        *y = compactBits(hash);
     }
 
     void GeoHash::unhash_slow(unsigned *x, unsigned *y) const {
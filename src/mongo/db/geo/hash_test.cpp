@@ -76,6 +76,30 @@ namespace {
         }
     }
 
+    // The hash of (x, y) alternates the bits of x and y, most significant first.
+    TEST(GeoHash, InterleavesBits) {
+        mongo::PseudoRandom random(12345);
+        for (int i = 0; i < 1000; ++i) {
+            unsigned x = static_cast<unsigned>(random.nextInt32());
+            unsigned y = static_cast<unsigned>(random.nextInt32());
+            unsigned bits = static_cast<unsigned>(random.nextInt32(GeoHash::kMaxBits + 1));
+            string expected;
+            for (unsigned b = 0; b < bits; ++b) {
+                expected += GeoHash::isBitSet(x, b) ? "1" : "0";
+                expected += GeoHash::isBitSet(y, b) ? "1" : "0";
+            }
+            GeoHash hash(x, y, bits);
+            ASSERT_EQUALS(GeoHash(expected), hash);
+
+            // Unhashing gives back the bits that were kept
+            unsigned kept = bits == 0 ? 0 : 0xFFFFFFFFU << (32 - bits);
+            unsigned unhashedX, unhashedY;
+            hash.unhash(&unhashedX, &unhashedY);
+            ASSERT_EQUALS(x & kept, unhashedX);
+            ASSERT_EQUALS(y & kept, unhashedY);
+        }
+    }
+
     // ASSERT_THROWS does not work if we try to put GeoHash(a) in the macro.
     static GeoHash makeHash(const string& a) { return GeoHash(a); }
 
@@ -40,6 +40,7 @@ namespace mongo {
 
     // Definition
     int const R2RegionCoverer::kDefaultMaxCells = 8;
+    size_t const R2RegionCoverer::kNumInlineCandidates;
 
     // We define our own own comparison function on QueueEntries in order to
     // make the results deterministic.  Using the default less<QueueEntry>,
@@ -60,7 +61,8 @@ namespace mongo {
             _maxCells( kDefaultMaxCells ),
             _region( NULL ),
             _candidateQueue( new CandidateQueue ),
-            _results( new vector<GeoHash> )
+            _results( new vector<GeoHash> ),
+            _numInlineCandidatesUsed( 0 )
     {
     }
 
@@ -133,7 +135,7 @@ namespace mongo {
         cover->swap(*_results);
     }
 
-    // Caller owns the returned pointer
+    // Caller owns the returned pointer, and gives it back with deleteCandidate()
     R2RegionCoverer::Candidate* R2RegionCoverer::newCandidate( const GeoHash& cell ) {
         // Exclude the cell that doesn't intersect with the geometry.
         Box box = _hashConverter->unhashToBoxCovering(cell);
@@ -142,7 +144,16 @@ namespace mongo {
             return NULL;
         }
 
-        Candidate* candidate = new Candidate();
+        Candidate* candidate;
+        if (!_freeCandidates.empty()) {
+            candidate = _freeCandidates.back();
+            _freeCandidates.pop_back();
+        } else if (_numInlineCandidatesUsed < kNumInlineCandidates) {
+            candidate = &_inlineCandidates[_numInlineCandidatesUsed++];
+        } else {
+            _candidateArena.push_back(Candidate());
+            candidate = &_candidateArena.back();
+        }
         candidate->cell = cell;
         candidate->numChildren = 0;
         // Stop subdivision when we reach the max level or there is no need to do so.
@@ -215,7 +226,7 @@ namespace mongo {
             }
         }
 
-        delete candidate;
+        _freeCandidates.push_back(candidate);
     }
 
     void R2RegionCoverer::getInitialCandidates() {
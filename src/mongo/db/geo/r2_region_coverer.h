@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <deque>
 #include <queue>
 
 #include "mongo/db/geo/hash.h"
@@ -83,7 +84,7 @@ namespace mongo {
         // Passing an argument of NULL does nothing.
         void addCandidate(Candidate* candidate);
 
-        // Free the memory associated with a candidate.
+        // Return a candidate, and its children if "freeChildren", to the free list.
         void deleteCandidate( Candidate* candidate, bool freeChildren );
 
         // Populate the children of "candidate" by expanding from the given cell.
@@ -110,6 +111,16 @@ namespace mongo {
                                     CompareQueueEntries> CandidateQueue;
         std::unique_ptr<CandidateQueue> _candidateQueue;  // Priority queue owns candidate pointers.
         std::unique_ptr<std::vector<GeoHash> > _results;
+
+        // Candidates come from _inlineCandidates, which lives wherever the coverer does (usually
+        // the stack), then from _candidateArena once those run out.  Neither shrinks, and deleted
+        // candidates go on _freeCandidates for reuse, so a typical covering doesn't allocate
+        // candidates from the heap at all.
+        static const size_t kNumInlineCandidates = 128;
+        Candidate _inlineCandidates[kNumInlineCandidates];
+        size_t _numInlineCandidatesUsed;
+        std::deque<Candidate> _candidateArena;
+        std::vector<Candidate*> _freeCandidates;
     };
 
 
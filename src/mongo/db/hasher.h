@@ -39,6 +39,7 @@
 #include <boost/noncopyable.hpp>
 
 #include "mongo/bson/bsonelement.h"
+#include "mongo/bson/util/builder.h"
 #include "mongo/util/md5.hpp"
 
 namespace mongo {
@@ -46,10 +47,15 @@ namespace mongo {
     typedef int HashSeed;
     typedef unsigned char HashDigest[16];
 
+    /**
+     * Computes the digest used by hashed indexes and hashed shard keys. Hash version 0 is MD5 of
+     * the seed followed by the data; hash version 1 is MurmurHash3_x64_128 of the data, seeded
+     * with the seed.
+     */
     class Hasher : private boost::noncopyable {
     public:
 
-        explicit Hasher( HashSeed seed );
+        explicit Hasher( HashSeed seed, int hashVersion = 0 );
         ~Hasher() { };
 
         //pointer to next part of input key, length in bytes to read
@@ -60,7 +66,10 @@ namespace mongo {
         void finish( HashDigest out );
 
     private:
+        const int _hashVersion;
         md5_state_t _md5State;
+        // MurmurHash3 has no incremental interface, so version 1 gathers the data here first.
+        StackBufBuilder _data;
         HashSeed _seed;
     };
 
@@ -69,8 +78,8 @@ namespace mongo {
         /* Eventually this may be a more sophisticated factory
          * for creating other hashers, but for now use MD5.
          */
-        static Hasher* createHasher( HashSeed seed ) {
-            return new Hasher( seed );
+        static Hasher* createHasher( HashSeed seed, int hashVersion = 0 ) {
+            return new Hasher( seed, hashVersion );
         }
 
     private:
@@ -89,6 +98,20 @@ namespace mongo {
          */
         static const int DEFAULT_HASH_SEED = 0;
 
+        /* Hashed indexes without a "hashVersion" in their spec, and collections sharded on a
+         * hashed key before hash versions could be chosen, use version 0 (MD5). Version 1
+         * (MurmurHash3) is much cheaper to compute and is used for newly sharded collections.
+         *
+         * WARNING: the value a version computes for an element must never change, as it is
+         * stored in indexes and chunk boundaries.
+         */
+        static const int DEFAULT_HASH_VERSION = 0;
+        static const int LATEST_HASH_VERSION = 1;
+
+        static bool isValidHashVersion( int hashVersion ) {
+            return hashVersion == 0 || hashVersion == 1;
+        }
+
         /* This computes a 64-bit hash of the value part of BSONElement "e",
          * preceded by the seed "seed".  Squashes element (and any sub-elements)
          * of the same canonical type, so hash({a:{b:4}}) will be the same
@@ -101,7 +124,9 @@ namespace mongo {
          * the associated "getKeys" and "makeSingleKey" method in the
          * hashindex type is changed accordingly.
          */
-        static long long int hash64( const BSONElement& e , HashSeed seed );
+        static long long int hash64( const BSONElement& e ,
+                                     HashSeed seed ,
+                                     int hashVersion = DEFAULT_HASH_VERSION );
 
         /* This incrementally computes the hash of BSONElement "e"
          * using hash function "h".  If "includeFieldName" is true,
@@ -381,5 +381,32 @@ namespace {
         ASSERT_EQUALS( hashIt( o ), 501342939894575968LL );
     }
 
+    // Hash version 1 is a different function of the same canonical form
+    long long hashItV1( const BSONObj& object, int seed = 0 ) {
+        return BSONElementHasher::hash64( object.firstElement(), seed, 1 );
+    }
+
+    TEST( BSONElementHasher, HashVersion1IsStable ) {
+        ASSERT_EQUALS( hashItV1( BSON( "check" << 42 ) ), 8715208212397937794LL );
+        ASSERT_EQUALS( hashItV1( BSON( "" << BSONNULL ) ), 6655367218388208063LL );
+        ASSERT_EQUALS( hashItV1( BSON( "" << "12345" ) ), -779325806224266255LL );
+        ASSERT_EQUALS( hashItV1( BSON( "d" << BSON( "a" << 1 << "b" << "x" ) ) ),
+                       6528046657861061921LL );
+    }
+
+    TEST( BSONElementHasher, HashVersion1DiffersFromVersion0 ) {
+        BSONObj o = BSON( "check" << 42 );
+        ASSERT_NOT_EQUALS( hashIt( o ), hashItV1( o ) );
+    }
+
+    TEST( BSONElementHasher, HashVersion1SquashesNumbersAndUsesSeed ) {
+        ASSERT_EQUALS( hashItV1( BSON( "a" << 3 ) ), hashItV1( BSON( "a" << 3.1 ) ) );
+        ASSERT_EQUALS( hashItV1( BSON( "a" << 3 ) ), hashItV1( BSON( "a" << 3LL ) ) );
+        ASSERT_NOT_EQUALS( hashItV1( BSON( "a" << 3 ) ), hashItV1( BSON( "a" << "3" ) ) );
+        ASSERT_NOT_EQUALS( hashItV1( BSON( "a" << 4 ), 0 ), hashItV1( BSON( "a" << 4 ), 1 ) );
+        ASSERT_NOT_EQUALS( hashItV1( fromjson( "{a : {'0' : 0 , '1' : 1}}" ) ),
+                           hashItV1( fromjson( "{a : [0,1]}" ) ) );
+    }
+
 } // namespace
 } // namespace mongo
@@ -50,6 +50,9 @@ namespace mongo {
     private:
         virtual void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
 
+        virtual bool generatesKeyStrings() const { return true; }
+        virtual void getKeyStrings(const BSONObj& obj, KeyStringSet* keys) const;
+
         // Our keys differ for V0 and V1.
         std::unique_ptr<BtreeKeyGenerator> _keyGenerator;
     };
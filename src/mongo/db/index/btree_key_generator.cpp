@@ -55,23 +55,82 @@ namespace {
             nullKeyBuilder.appendNull("");
         }
         _nullKey = nullKeyBuilder.obj();
+        _nullKeyElements.assign(fieldNames.size(), nullElt);
 
         _isIdIndex = fieldNames.size() == 1 && std::string("_id") == fieldNames[0];
     }
 
+    /**
+     * Builds each key as a BSONObj with empty field names.
+     */
+    class BtreeKeyGenerator::BSONObjSetSink : public KeySink {
+    public:
+        BSONObjSetSink(BSONObjSet* keys, const BSONSizeTracker* sizeTracker)
+            : _keys(keys), _sizeTracker(sizeTracker) { }
+
+        virtual void addKey(const std::vector<BSONElement>& elements) {
+            BSONObjBuilder b(*_sizeTracker);
+            for (size_t i = 0; i < elements.size(); ++i) {
+                b.appendAs(elements[i], "");
+            }
+            _keys->insert(b.obj());
+        }
+
+        virtual bool empty() const { return _keys->empty(); }
+
+    private:
+        BSONObjSet* const _keys;
+        const BSONSizeTracker* const _sizeTracker;
+    };
+
+    /**
+     * Encodes each key into one reused KeyString and copies it into the set. Duplicates are
+     * only removed once all keys are in.
+     */
+    class BtreeKeyGenerator::KeyStringSetSink : public KeySink {
+    public:
+        KeyStringSetSink(KeyStringSet* keys, Ordering ord) : _keys(keys), _ord(ord) { }
+
+        virtual void addKey(const std::vector<BSONElement>& elements) {
+            // What the key would take as a BSONObj: a type byte, an empty field name and the
+            // value per element, plus the object's size and terminator.
+            int bsonSize = 5;
+            for (size_t i = 0; i < elements.size(); ++i) {
+                bsonSize += 2 + elements[i].valuesize();
+            }
+            _scratch.resetToKey(elements, _ord);
+            _keys->add(_scratch, bsonSize);
+        }
+
+        virtual bool empty() const { return _keys->empty(); }
+
+    private:
+        KeyStringSet* const _keys;
+        const Ordering _ord;
+        KeyString _scratch;
+    };
+
     void BtreeKeyGenerator::getKeys(const BSONObj &obj, BSONObjSet *keys) const {
+        BSONObjSetSink sink(keys, &_sizeTracker);
+        _getKeys(obj, &sink);
+    }
+
+    void BtreeKeyGenerator::getKeys(const BSONObj& obj, Ordering ord, KeyStringSet* keys) const {
+        keys->clear();
+        KeyStringSetSink sink(keys, ord);
+        _getKeys(obj, &sink);
+        keys->sortAndUnique();
+    }
+
+    void BtreeKeyGenerator::_getKeys(const BSONObj& obj, KeySink* keys) const {
         if (_isIdIndex) {
             // we special case for speed
             BSONElement e = obj["_id"];
             if ( e.eoo() ) {
-                keys->insert(_nullKey);
+                keys->addKey(_nullKeyElements);
             }
             else {
-                int size = e.size() + 5 /* bson over head*/ - 3 /* remove _id string */;
-                BSONObjBuilder b(size);
-                b.appendAs(e, "");
-                keys->insert(b.obj());
-                invariant(keys->begin()->objsize() == size);
+                keys->addKey(std::vector<BSONElement>(1, e));
             }
             return;
         }
@@ -80,7 +139,7 @@ namespace {
         // getKeys call.  :|
         getKeysImpl(_fieldNames, _fixed, obj, keys);
         if (keys->empty() && ! _isSparse) {
-            keys->insert(_nullKey);
+            keys->addKey(_nullKeyElements);
         }
     }
 
@@ -98,7 +157,7 @@ namespace {
     void BtreeKeyGeneratorV0::getKeysImpl(std::vector<const char*> fieldNames,
                                           std::vector<BSONElement> fixed,
                                           const BSONObj &obj,
-                                          BSONObjSet *keys) const {
+                                          KeySink* keys) const {
         BSONElement arrElt;
         unsigned arrIdx = ~0;
         unsigned numNotFound = 0;
@@ -153,24 +212,16 @@ namespace {
         if ( allFound ) {
             if ( arrElt.eoo() ) {
                 // no terminal array element to expand
-                BSONObjBuilder b(_sizeTracker);
-                for (std::vector< BSONElement >::iterator i = fixed.begin(); i != fixed.end(); ++i)
-                    b.appendAs( *i, "" );
-                keys->insert( b.obj() );
+                keys->addKey( fixed );
             }
             else {
                 // terminal array element to expand, so generate all keys
                 BSONObjIterator i( arrElt.embeddedObject() );
                 if ( i.more() ) {
+                    std::vector<BSONElement> key( fixed );
                     while (i.more()) {
-                        BSONObjBuilder b(_sizeTracker);
-                        for (unsigned j = 0; j < fixed.size(); ++j) {
-                            if ( j == arrIdx )
-                                b.appendAs( i.next(), "" );
-                            else
-                                b.appendAs( fixed[ j ], "" );
-                        }
-                        keys->insert( b.obj() );
+                        key[ arrIdx ] = i.next();
+                        keys->addKey( key );
                     }
                 }
                 else if ( fixed.size() > 1 ) {
@@ -197,20 +248,17 @@ namespace {
 
         if ( insertArrayNull ) {
             // x : [] - need to insert undefined
-            BSONObjBuilder b(_sizeTracker);
+            std::vector<BSONElement> key( fixed.size() );
             for (unsigned j = 0; j < fixed.size(); ++j) {
                 if ( j == arrIdx ) {
-                    b.appendUndefined( "" );
+                    key[ j ] = undefinedElt;
                 }
                 else {
                     BSONElement e = fixed[j];
-                    if ( e.eoo() )
-                        b.appendNull( "" );
-                    else
-                        b.appendAs( e , "" );
+                    key[ j ] = e.eoo() ? nullElt : e;
                 }
             }
-            keys->insert( b.obj() );
+            keys->addKey( key );
         }
     }
 
@@ -256,7 +304,7 @@ namespace {
             std::vector<const char*>* fieldNames,
             std::vector<BSONElement>* fixed,
             const BSONElement& arrEntry,
-            BSONObjSet* keys,
+            KeySink* keys,
             unsigned numNotFound,
             const BSONElement& arrObjElt,
             const std::set<unsigned>& arrIdxs,
@@ -282,7 +330,7 @@ namespace {
     void BtreeKeyGeneratorV1::getKeysImpl(std::vector<const char*> fieldNames,
                                           std::vector<BSONElement> fixed,
                                           const BSONObj& obj,
-                                          BSONObjSet* keys) const {
+                                          KeySink* keys) const {
         getKeysImplWithArray(fieldNames, fixed, obj, keys, 0, _emptyPositionalInfo);
     }
 
@@ -290,7 +338,7 @@ namespace {
             std::vector<const char*> fieldNames,
             std::vector<BSONElement> fixed,
             const BSONObj& obj,
-            BSONObjSet* keys,
+            KeySink* keys,
             unsigned numNotFound,
             const std::vector<PositionalPathInfo>& positionalInfo) const {
         BSONElement arrElt;
@@ -340,11 +388,7 @@ namespace {
             if ( _isSparse && numNotFound == fieldNames.size()) {
                 return;
             }
-            BSONObjBuilder b(_sizeTracker);
-            for (std::vector< BSONElement >::iterator i = fixed.begin(); i != fixed.end(); ++i) {
-                b.appendAs( *i, "" );
-            }
-            keys->insert( b.obj() );
+            keys->addKey( fixed );
         }
         else if ( arrElt.embeddedObject().firstElement().eoo() ) {
             // Empty array, so set matching fields to undefined.
@@ -31,6 +31,7 @@
 #include <vector>
 #include <set>
 #include "mongo/db/jsobj.h"
+#include "mongo/db/storage/key_string_set.h"
 
 namespace mongo {
 
@@ -48,22 +49,46 @@ namespace mongo {
 
         void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
 
+        /**
+         * Generates the same keys as above, but encodes each one straight to a KeyString under
+         * 'ord' instead of building it as a BSONObj. 'keys' is cleared first and is sorted and
+         * deduplicated on return.
+         */
+        void getKeys(const BSONObj& obj, Ordering ord, KeyStringSet* keys) const;
+
         static const int ParallelArraysCode;
 
     protected:
+        /**
+         * Receives the generated keys, each as the list of its values in key pattern order. The
+         * field names of those elements are ignored.
+         */
+        class KeySink {
+        public:
+            virtual ~KeySink() { }
+            virtual void addKey(const std::vector<BSONElement>& elements) = 0;
+            virtual bool empty() const = 0;
+        };
+
         // These are used by the getKeysImpl(s) below.
         std::vector<const char*> _fieldNames;
         bool _isIdIndex;
         bool _isSparse;
         BSONObj _nullKey; // a full key with all fields null
+        std::vector<BSONElement> _nullKeyElements; // the elements of _nullKey
         BSONSizeTracker _sizeTracker;
 
     private:
+        class BSONObjSetSink;
+        class KeyStringSetSink;
+
+        void _getKeys(const BSONObj& obj, KeySink* keys) const;
+
         // We have V0 and V1.  Sigh.
         virtual void getKeysImpl(std::vector<const char*> fieldNames,
                                  std::vector<BSONElement> fixed,
                                  const BSONObj& obj,
-                                 BSONObjSet* keys) const = 0;
+                                 KeySink* keys) const = 0;
 
         std::vector<BSONElement> _fixed;
     };
@@ -80,7 +105,7 @@ namespace mongo {
         virtual void getKeysImpl(std::vector<const char*> fieldNames,
                                  std::vector<BSONElement> fixed,
                                  const BSONObj& obj,
-                                 BSONObjSet* keys) const;
+                                 KeySink* keys) const;
     };
 
     class BtreeKeyGeneratorV1 : public BtreeKeyGenerator {
@@ -148,7 +173,7 @@ namespace mongo {
          * @param fieldNames - fields to index, may be postfixes in recursive calls
          * @param fixed - values that have already been identified for their index fields
          * @param obj - object from which keys should be extracted, based on names in fieldNames
-         * @param keys - set where index keys are written
+         * @param keys - sink where index keys are written
          * @param numNotFound - number of index fields that have already been identified as missing
          * @param array - array from which keys should be extracted, based on names in fieldNames
          *        If obj and array are both nonempty, obj will be one of the elements of array.
@@ -156,7 +181,7 @@ namespace mongo {
         virtual void getKeysImpl(std::vector<const char*> fieldNames,
                                  std::vector<BSONElement> fixed,
                                  const BSONObj& obj,
-                                 BSONObjSet* keys) const;
+                                 KeySink* keys) const;
 
         /**
          * This recursive method does the heavy-lifting for getKeysImpl().
@@ -164,7 +189,7 @@ namespace mongo {
         void getKeysImplWithArray(std::vector<const char*> fieldNames,
                                   std::vector<BSONElement> fixed,
                                   const BSONObj& obj,
-                                  BSONObjSet* keys,
+                                  KeySink* keys,
                                   unsigned numNotFound,
                                   const std::vector<PositionalPathInfo>& positionalInfo) const;
         /**
@@ -212,7 +237,7 @@ namespace mongo {
         void _getKeysArrEltFixed(std::vector<const char*>* fieldNames,
                                  std::vector<BSONElement>* fixed,
                                  const BSONElement& arrEntry,
-                                 BSONObjSet* keys,
+                                 KeySink* keys,
                                  unsigned numNotFound,
                                  const BSONElement& arrObjElt,
                                  const std::set<unsigned>& arrIdxs,
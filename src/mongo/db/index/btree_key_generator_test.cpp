@@ -104,7 +104,30 @@ namespace {
                  << "Actual: " << dumpKeyset(actualKeys) << endl;
         }
 
-        return match;
+        //
+        // Step 4: generating the keys straight to KeyStrings must give the same keys.
+        //
+        const Ordering ordering = Ordering::make(kp);
+        KeyStringSet actualKeyStrings;
+        keyGen->getKeys(obj, ordering, &actualKeyStrings);
+
+        BSONObjSet decodedKeys;
+        bool sizesMatch = true;
+        for (size_t i = 0; i < actualKeyStrings.size(); ++i) {
+            BSONObj key = actualKeyStrings[i].toBson(ordering);
+            sizesMatch = sizesMatch && key.objsize() == actualKeyStrings[i].getBsonSize();
+            decodedKeys.insert(key);
+        }
+
+        bool keyStringsMatch = sizesMatch
+            && actualKeyStrings.size() == decodedKeys.size()
+            && keysetsMatch(expectedKeys, decodedKeys);
+        if (!keyStringsMatch) {
+            cout << "Expected: " << dumpKeyset(expectedKeys) << ", "
+                 << "Actual KeyStrings: " << dumpKeyset(decodedKeys) << endl;
+        }
+
+        return match && keyStringsMatch;
     }
 
     //
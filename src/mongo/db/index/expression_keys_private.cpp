@@ -348,8 +348,54 @@ namespace mongo {
     long long int ExpressionKeysPrivate::makeSingleHashKey(const BSONElement& e,
                                                            HashSeed seed,
                                                            int v) {
-        massert(16767, "Only HashVersion 0 has been defined" , v == 0 );
-        return BSONElementHasher::hash64(e, seed);
+        massert(16767, "Only HashVersions 0 and 1 have been defined",
+                BSONElementHasher::isValidHashVersion(v));
+        return BSONElementHasher::hash64(e, seed, v);
+    }
+
+    const int ExpressionKeysPrivate::kSummaryKeyMaxBytes;
+
+    // static
+    void ExpressionKeysPrivate::getSummaryKeys(const BSONObj& obj,
+                                               const std::vector<std::string>& groupFields,
+                                               const std::string& sumField,
+                                               BSONObjSet* keys) {
+        BSONObjBuilder b;
+        for (size_t i = 0; i < groupFields.size(); ++i) {
+            // Each document is counted in exactly one group, so none can be in several.
+            const char* cstr = groupFields[i].c_str();
+            BSONElement fieldVal = obj.getFieldDottedOrArray(cstr);
+            uassert(28797, str::stream() << "summary indexes do not support array values, found"
+                                         << " one at " << groupFields[i],
+                    fieldVal.type() != Array);
+
+            if (fieldVal.eoo()) {
+                b.appendNull("");
+            }
+            else {
+                b.appendAs(fieldVal, "");
+            }
+        }
+
+        if (!sumField.empty()) {
+            // Like $sum, ignores values that aren't numbers.
+            const char* cstr = sumField.c_str();
+            BSONElement sumVal = obj.getFieldDottedOrArray(cstr);
+            if (sumVal.isNumber()) {
+                b.appendAs(sumVal, "");
+            }
+            else {
+                b.appendNull("");
+            }
+        }
+
+        // A key the storage engine refused as too long would leave the document out of the
+        // counts, so fail writes well before that limit.
+        BSONObj key = b.obj();
+        uassert(28798, str::stream() << "summary index key too large: " << key.objsize()
+                                     << " bytes, the limit is " << kSummaryKeyMaxBytes,
+                key.objsize() <= kSummaryKeyMaxBytes);
+        keys->insert(key);
     }
 
     // static
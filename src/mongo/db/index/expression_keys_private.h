@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "mongo/bson/bsonobj.h"
@@ -89,6 +90,22 @@ namespace mongo {
          */
         static long long int makeSingleHashKey(const BSONElement& e, HashSeed seed, int v);
 
+        //
+        // Summary
+        //
+
+        // The largest key of a summary index, in bytes, well below what storage engines accept
+        static const int kSummaryKeyMaxBytes = 512;
+
+        /**
+         * Generates the key of the summary access method: the values of 'groupFields', null if
+         * missing, followed by the value of 'sumField' if there is one, null unless a number.
+         */
+        static void getSummaryKeys(const BSONObj& obj,
+                                   const std::vector<std::string>& groupFields,
+                                   const std::string& sumField,
+                                   BSONObjSet* keys);
+
         //
         // Haystack
         //
@@ -122,6 +122,25 @@ namespace mongo {
             }
         }
 
+        static void parseSummaryParams(const BSONObj& infoObj,
+                                       std::vector<std::string>* groupFieldsOut,
+                                       std::string* sumFieldOut) {
+            // Example:
+            // db.foo.ensureIndex({ tenant : "summary", status : "summary" }, { sumField : "n" })
+            BSONObjIterator i(infoObj.getObjectField("key"));
+            while (i.more()) {
+                groupFieldsOut->push_back(i.next().fieldName());
+            }
+
+            BSONElement e = infoObj["sumField"];
+            if (!e.eoo()) {
+                uassert(28799, "sumField must be a field name",
+                        e.type() == String && !e.valueStringData().empty()
+                            && e.valueStringData()[0] != '$');
+                *sumFieldOut = e.String();
+            }
+        }
+
         static void parse2dsphereParams(const BSONObj& infoObj,
                                         S2IndexingParams* out) {
             // Set up basic params.
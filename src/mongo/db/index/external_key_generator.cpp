@@ -78,6 +78,12 @@ namespace {
             ExpressionParams::parseHashParams(infoObj, &seed, &version, &field);
             ExpressionKeysPrivate::getHashKeys(doc, field, seed, version, infoObj["sparse"].trueValue(), keys);
         }
+        else if (IndexNames::SUMMARY == type) {
+            vector<string> groupFields;
+            string sumField;
+            ExpressionParams::parseSummaryParams(infoObj, &groupFields, &sumField);
+            ExpressionKeysPrivate::getSummaryKeys(doc, groupFields, sumField, keys);
+        }
         else {
             invariant(IndexNames::BTREE == type);
 
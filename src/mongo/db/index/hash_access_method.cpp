@@ -49,6 +49,10 @@ namespace mongo {
                                           &_seed,
                                           &_hashVersion,
                                           &_hashedField);
+
+        uassert(28780, str::stream() << "Unknown hashVersion " << _hashVersion
+                                     << " for hashed index; known versions are 0 and 1",
+                BSONElementHasher::isValidHashVersion(_hashVersion));
     }
 
     void HashAccessMethod::getKeys(const BSONObj& obj, BSONObjSet* keys) const {
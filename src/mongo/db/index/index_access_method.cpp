@@ -32,6 +32,7 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/base/error_codes.h"
@@ -85,10 +86,44 @@ namespace mongo {
         const int _version;
     };
 
+    class KeyStringExternalSortComparison {
+    public:
+        typedef std::pair<SortableKeyString, RecordId> Data;
+
+        int operator() (const Data& l, const Data& r) const {
+            int x = l.first.compare(r.first);
+            if (x) { return x; }
+            return l.second.compare(r.second);
+        }
+    };
+
+    // Orders the keys of a batch of documents the way the index stores them, for insertMany()
+    // and removeMany().
+    class IndexKeyEntryLess {
+    public:
+        explicit IndexKeyEntryLess(const IndexDescriptor* descriptor)
+            : _comparison(descriptor->keyPattern(), descriptor->version()) {}
+
+        bool operator() (const IndexKeyEntry& l, const IndexKeyEntry& r) const {
+            return _comparison(std::make_pair(l.key, l.loc), std::make_pair(r.key, r.loc)) < 0;
+        }
+    private:
+        const BtreeExternalSortComparison _comparison;
+    };
+
+    static bool keyStringEntryLess(const KeyStringEntry& l, const KeyStringEntry& r) {
+        const size_t size = std::min(l.key.getSize(), r.key.getSize());
+        int x = memcmp(l.key.getBuffer(), r.key.getBuffer(), size);
+        if (x == 0 && l.key.getSize() != r.key.getSize())
+            x = l.key.getSize() < r.key.getSize() ? -1 : 1;
+        return x < 0 || (x == 0 && l.loc < r.loc);
+    }
+
     IndexAccessMethod::IndexAccessMethod(IndexCatalogEntry* btreeState,
                                          SortedDataInterface* btree)
         : _btreeState(btreeState),
           _descriptor(btreeState->descriptor()),
+          _ordering(Ordering::make(_descriptor->keyPattern())),
           _newInterface(btree) {
         verify(0 == _descriptor->version() || 1 == _descriptor->version());
     }
@@ -106,6 +141,12 @@ namespace mongo {
                                      int64_t* numInserted) {
         *numInserted = 0;
 
+        if (useKeyStrings()) {
+            KeyStringSet keys;
+            getKeyStrings(obj, &keys);
+            return insertKeyStrings(txn, keys, loc, options, numInserted);
+        }
+
         BSONObjSet keys;
         // Delegate to the subclass.
         getKeys(obj, &keys);
@@ -151,6 +192,117 @@ namespace mongo {
         return ret;
     }
 
+    Status IndexAccessMethod::insertKeyStrings(OperationContext* txn,
+                                               const KeyStringSet& keys,
+                                               const RecordId& loc,
+                                               const InsertDeleteOptions& options,
+                                               int64_t* numInserted) {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            Status status = _newInterface->insertKeyString(txn, keys[i], loc, options.dupsAllowed);
+
+            if (status.isOK()) {
+                ++*numInserted;
+                continue;
+            }
+
+            if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(txn)) {
+                continue;
+            }
+
+            if (status.code() == ErrorCodes::DuplicateKeyValue) {
+                // See insert().
+                if (!_btreeState->isReady(txn)) {
+                    LOG(3) << "key " << keys[i].toBson(_ordering)
+                           << " already in index during background indexing (ok)";
+                    continue;
+                }
+            }
+
+            for (size_t j = 0; j < i; ++j) {
+                removeOneKeyString(txn, keys[j], loc, options.dupsAllowed);
+                *numInserted = 0;
+            }
+
+            return status;
+        }
+
+        if (*numInserted > 1) {
+            _btreeState->setMultikey( txn );
+        }
+
+        return Status::OK();
+    }
+
+    Status IndexAccessMethod::insertMany(OperationContext* txn,
+                                         const std::vector<BSONObj>& docs,
+                                         const std::vector<RecordId>& locs,
+                                         const InsertDeleteOptions& options,
+                                         int64_t* numInserted) {
+        invariant(txn->lockState()->inAWriteUnitOfWork());
+        invariant(docs.size() == locs.size());
+        *numInserted = 0;
+
+        // Duplicate keys are fine while a background build is running, but a batch that fails
+        // can't tell which of its documents to skip.
+        if (!_btreeState->isReady(txn)) {
+            for (size_t i = 0; i < docs.size(); ++i) {
+                int64_t inserted;
+                Status status = insert(txn, docs[i], locs[i], options, &inserted);
+                if (!status.isOK())
+                    return status;
+                *numInserted += inserted;
+            }
+            return Status::OK();
+        }
+
+        bool multikey = false;
+
+        if (useKeyStrings()) {
+            // The entries point into the key sets, which must outlive them.
+            std::vector<KeyStringSet> keys(docs.size());
+            std::vector<KeyStringEntry> entries;
+            for (size_t i = 0; i < docs.size(); ++i) {
+                getKeyStrings(docs[i], &keys[i]);
+                multikey = multikey || keys[i].size() > 1;
+                for (size_t j = 0; j < keys[i].size(); ++j) {
+                    entries.push_back(KeyStringEntry(keys[i][j], locs[i]));
+                }
+            }
+
+            std::sort(entries.begin(), entries.end(), keyStringEntryLess);
+
+            Status status = _newInterface->insertManyKeyStrings(txn, entries,
+                                                                options.dupsAllowed);
+            if (!status.isOK())
+                return status;
+            *numInserted = entries.size();
+        }
+        else {
+            std::vector<IndexKeyEntry> entries;
+            for (size_t i = 0; i < docs.size(); ++i) {
+                BSONObjSet keys;
+                getKeys(docs[i], &keys);
+                multikey = multikey || keys.size() > 1;
+                for (BSONObjSet::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+                    entries.push_back(IndexKeyEntry(*it, locs[i]));
+                }
+            }
+
+            std::sort(entries.begin(), entries.end(), IndexKeyEntryLess(_descriptor));
+
+            Status status = _newInterface->insertMany(txn, entries, options.dupsAllowed);
+            if (!status.isOK())
+                return status;
+            *numInserted = entries.size();
+        }
+
+        if (multikey) {
+            _btreeState->setMultikey( txn );
+        }
+
+        return Status::OK();
+    }
+
     void IndexAccessMethod::removeOneKey(OperationContext* txn,
                                          const BSONObj& key,
                                          const RecordId& loc,
@@ -167,6 +319,22 @@ namespace mongo {
         }
     }
 
+    void IndexAccessMethod::removeOneKeyString(OperationContext* txn,
+                                               const KeyStringSet::Key& key,
+                                               const RecordId& loc,
+                                               bool dupsAllowed) {
+        try {
+            _newInterface->unindexKeyString(txn, key, loc, dupsAllowed);
+        } catch (AssertionException& e) {
+            log() << "Assertion failure: _unindex failed "
+                  << _descriptor->indexNamespace() << endl;
+            log() << "Assertion failure: _unindex failed: " << e.what()
+                  << "  key:" << key.toBson(_ordering).toString()
+                  << "  dl:" << loc;
+            logContext();
+        }
+    }
+
     std::unique_ptr<SortedDataInterface::Cursor> IndexAccessMethod::newCursor(
             OperationContext* txn,
             bool isForward) const {
@@ -179,10 +347,20 @@ namespace mongo {
                                      const RecordId& loc,
                                      const InsertDeleteOptions &options,
                                      int64_t* numDeleted) {
+        *numDeleted = 0;
+
+        if (useKeyStrings()) {
+            KeyStringSet keys;
+            getKeyStrings(obj, &keys);
+            for (size_t i = 0; i < keys.size(); ++i) {
+                removeOneKeyString(txn, keys[i], loc, options.dupsAllowed);
+                ++*numDeleted;
+            }
+            return Status::OK();
+        }
 
         BSONObjSet keys;
         getKeys(obj, &keys);
-        *numDeleted = 0;
 
         for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
             removeOneKey(txn, *i, loc, options.dupsAllowed);
@@ -192,6 +370,49 @@ namespace mongo {
         return Status::OK();
     }
 
+    Status IndexAccessMethod::removeMany(OperationContext* txn,
+                                         const std::vector<BSONObj>& docs,
+                                         const std::vector<RecordId>& locs,
+                                         const InsertDeleteOptions& options,
+                                         int64_t* numDeleted) {
+        invariant(docs.size() == locs.size());
+        *numDeleted = 0;
+
+        if (useKeyStrings()) {
+            std::vector<KeyStringSet> keys(docs.size());
+            std::vector<KeyStringEntry> entries;
+            for (size_t i = 0; i < docs.size(); ++i) {
+                getKeyStrings(docs[i], &keys[i]);
+                for (size_t j = 0; j < keys[i].size(); ++j) {
+                    entries.push_back(KeyStringEntry(keys[i][j], locs[i]));
+                }
+            }
+
+            std::sort(entries.begin(), entries.end(), keyStringEntryLess);
+            for (size_t i = 0; i < entries.size(); ++i) {
+                removeOneKeyString(txn, entries[i].key, entries[i].loc, options.dupsAllowed);
+            }
+            *numDeleted = entries.size();
+            return Status::OK();
+        }
+
+        std::vector<IndexKeyEntry> entries;
+        for (size_t i = 0; i < docs.size(); ++i) {
+            BSONObjSet keys;
+            getKeys(docs[i], &keys);
+            for (BSONObjSet::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+                entries.push_back(IndexKeyEntry(*it, locs[i]));
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(), IndexKeyEntryLess(_descriptor));
+        for (size_t i = 0; i < entries.size(); ++i) {
+            removeOneKey(txn, entries[i].key, entries[i].loc, options.dupsAllowed);
+        }
+        *numDeleted = entries.size();
+        return Status::OK();
+    }
+
     // Return keys in l that are not in r.
     // Lifted basically verbatim from elsewhere.
     static void setDifference(const BSONObjSet &l, const BSONObjSet &r, vector<BSONObj*> *diff) {
@@ -212,6 +433,17 @@ namespace mongo {
         }
     }
 
+    // Return the positions of the keys in l that are not in r.
+    static void setDifference(const KeyStringSet& l, const KeyStringSet& r, vector<size_t>* diff) {
+        size_t j = 0;
+        for (size_t i = 0; i < l.size(); ++i) {
+            while (j < r.size() && r.compare(j, l, i) < 0)
+                j++;
+            if (j == r.size() || l.compare(i, r, j) != 0)
+                diff->push_back(i);
+        }
+    }
+
     Status IndexAccessMethod::initializeAsEmpty(OperationContext* txn) {
         return _newInterface->initAsEmpty(txn);
     }
@@ -233,6 +465,12 @@ namespace mongo {
         return _newInterface->touch(txn);
     }
 
+    bool IndexAccessMethod::sampleKeys(OperationContext* txn,
+                                       int numKeys,
+                                       std::vector<BSONObj>* keys) const {
+        return _newInterface->sampleKeys(txn, numKeys, keys);
+    }
+
     RecordId IndexAccessMethod::findSingle(OperationContext* txn, const BSONObj& key) const {
         std::unique_ptr<SortedDataInterface::Cursor> cursor(_newInterface->newCursor(txn));
         const auto requestedInfo = kDebugBuild ? SortedDataInterface::Cursor::kKeyAndLoc
@@ -275,6 +513,25 @@ namespace mongo {
                                              UpdateTicket* ticket,
                                              const MatchExpression* indexFilter) {
 
+        if (useKeyStrings()) {
+            if (indexFilter == NULL || indexFilter->matchesBSON(from))
+                getKeyStrings(from, &ticket->oldKeyStrings);
+            if (indexFilter == NULL || indexFilter->matchesBSON(to))
+                getKeyStrings(to, &ticket->newKeyStrings);
+            ticket->loc = record;
+            ticket->dupsAllowed = options.dupsAllowed;
+            ticket->usesKeyStrings = true;
+
+            setDifference(ticket->oldKeyStrings, ticket->newKeyStrings,
+                          &ticket->removedKeyStrings);
+            setDifference(ticket->newKeyStrings, ticket->oldKeyStrings,
+                          &ticket->addedKeyStrings);
+
+            ticket->_isValid = true;
+
+            return Status::OK();
+        }
+
         if (indexFilter == NULL || indexFilter->matchesBSON(from))
             getKeys(from, &ticket->oldKeys);
         if (indexFilter == NULL || indexFilter->matchesBSON(to))
@@ -297,6 +554,10 @@ namespace mongo {
             return Status(ErrorCodes::InternalError, "Invalid UpdateTicket in update");
         }
 
+        if (ticket.usesKeyStrings) {
+            return updateKeyStrings(txn, ticket, numUpdated);
+        }
+
         if (ticket.oldKeys.size() + ticket.added.size() - ticket.removed.size() > 1) {
             _btreeState->setMultikey( txn );
         }
@@ -328,19 +589,131 @@ namespace mongo {
         return Status::OK();
     }
 
-    std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk() {
+    Status IndexAccessMethod::updateKeyStrings(OperationContext* txn,
+                                               const UpdateTicket& ticket,
+                                               int64_t* numUpdated) {
+        if (ticket.oldKeyStrings.size() + ticket.addedKeyStrings.size()
+                - ticket.removedKeyStrings.size() > 1) {
+            _btreeState->setMultikey( txn );
+        }
+
+        for (size_t i = 0; i < ticket.removedKeyStrings.size(); ++i) {
+            _newInterface->unindexKeyString(txn,
+                                            ticket.oldKeyStrings[ticket.removedKeyStrings[i]],
+                                            ticket.loc,
+                                            ticket.dupsAllowed);
+        }
+
+        for (size_t i = 0; i < ticket.addedKeyStrings.size(); ++i) {
+            Status status =
+                _newInterface->insertKeyString(txn,
+                                               ticket.newKeyStrings[ticket.addedKeyStrings[i]],
+                                               ticket.loc,
+                                               ticket.dupsAllowed);
+            if ( !status.isOK() ) {
+                if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(txn)) {
+                    // Ignore.
+                    continue;
+                }
+
+                return status;
+            }
+        }
+
+        *numUpdated = ticket.addedKeyStrings.size();
+
+        return Status::OK();
+    }
+
+    std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk(
+            size_t maxMemoryUsageBytes) {
 
-        return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor));
+        return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor,
+                                                            maxMemoryUsageBytes));
     }
 
     IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
-                                                const IndexDescriptor* descriptor)
-            : _sorter(Sorter::make(SortOptions().TempDir(storageGlobalParams.dbpath + "/_tmp")
-                                                .ExtSortAllowed()
-                                                .MaxMemoryUsageBytes(100*1024*1024),
-                                   BtreeExternalSortComparison(descriptor->keyPattern(),
-                                                               descriptor->version())))
+                                                const IndexDescriptor* descriptor,
+                                                size_t maxMemoryUsageBytes)
+            : _ordering(Ordering::make(descriptor->keyPattern()))
+            , _descriptor(descriptor)
+            , _sortOptions(SortOptions().TempDir(storageGlobalParams.dbpath + "/_tmp")
+                                        .ExtSortAllowed()
+                                        .MaxMemoryUsageBytes(maxMemoryUsageBytes)
+                                        .FileReadAhead())
             , _real(index) {
+        if (descriptor->version() == 0) {
+            _legacySorter.reset(LegacySorter::make(_sortOptions,
+                                                   BtreeExternalSortComparison(
+                                                       descriptor->keyPattern(), 0)));
+        }
+        else {
+            _sorter.reset(Sorter::make(_sortOptions, KeyStringExternalSortComparison()));
+        }
+    }
+
+    void IndexAccessMethod::BulkBuilder::absorb(std::unique_ptr<BulkBuilder> other) {
+        invariant(other->_real == _real);
+        invariant(other->_absorbed.empty());
+        _keysInserted += other->_keysInserted;
+        _isMultiKey = _isMultiKey || other->_isMultiKey;
+        _absorbed.push_back(std::move(other));
+    }
+
+    void IndexAccessMethod::BulkBuilder::add(const BSONObj& key, const RecordId& loc) {
+        if (_legacySorter) {
+            _legacySorter->add(key, loc);
+        }
+        else {
+            _sorter->add(SortableKeyString(key, _ordering), loc);
+        }
+    }
+
+    void IndexAccessMethod::BulkBuilder::done() {
+        if (_absorbed.empty()) {
+            if (_legacySorter) {
+                _legacySorted.reset(_legacySorter->done());
+            }
+            else {
+                _sorted.reset(_sorter->done());
+            }
+            return;
+        }
+
+        if (_legacySorter) {
+            std::vector<std::shared_ptr<LegacySorter::Iterator>> iters;
+            iters.emplace_back(_legacySorter->done());
+            for (size_t i = 0; i < _absorbed.size(); i++) {
+                iters.emplace_back(_absorbed[i]->_legacySorter->done());
+            }
+            _legacySorted.reset(LegacySorter::Iterator::merge(
+                                    iters,
+                                    _sortOptions,
+                                    BtreeExternalSortComparison(_descriptor->keyPattern(), 0)));
+        }
+        else {
+            std::vector<std::shared_ptr<Sorter::Iterator>> iters;
+            iters.emplace_back(_sorter->done());
+            for (size_t i = 0; i < _absorbed.size(); i++) {
+                iters.emplace_back(_absorbed[i]->_sorter->done());
+            }
+            _sorted.reset(Sorter::Iterator::merge(iters,
+                                                  _sortOptions,
+                                                  KeyStringExternalSortComparison()));
+        }
+    }
+
+    bool IndexAccessMethod::BulkBuilder::more() {
+        return _legacySorted ? _legacySorted->more() : _sorted->more();
+    }
+
+    std::pair<BSONObj, RecordId> IndexAccessMethod::BulkBuilder::next() {
+        if (_legacySorted) {
+            return _legacySorted->next();
+        }
+
+        const Sorter::Data d = _sorted->next();
+        return std::make_pair(d.first.toBson(_ordering), d.second);
     }
 
     Status IndexAccessMethod::BulkBuilder::insert(OperationContext* txn,
@@ -354,7 +727,7 @@ namespace mongo {
         _isMultiKey = _isMultiKey || (keys.size() > 1);
 
         for (BSONObjSet::iterator it = keys.begin(); it != keys.end(); ++it) {
-            _sorter->add(*it, loc);
+            add(*it, loc);
             _keysInserted++;
         }
 
@@ -374,7 +747,7 @@ namespace mongo {
 
         Timer timer;
 
-        std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+        bulk->done();
 
         stdx::unique_lock<Client> lk(*txn->getClient());
         ProgressMeterHolder pm(*txn->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
@@ -396,7 +769,7 @@ namespace mongo {
             wunit.commit();
         } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "setting index multikey flag", "");
 
-        while (i->more()) {
+        while (bulk->more()) {
             if (mayInterrupt) {
                 txn->checkForInterrupt();
             }
@@ -409,7 +782,7 @@ namespace mongo {
             txn->recoveryUnit()->setRollbackWritesDisabled();
 
             // Get the next datum and add it to the builder.
-            BulkBuilder::Sorter::Data d = i->next();
+            const std::pair<BSONObj, RecordId> d = bulk->next();
             Status status = builder->addKey(d.first, d.second);
 
             if (!status.isOK()) {
@@ -455,3 +828,6 @@ namespace mongo {
 
 #include "mongo/db/sorter/sorter.cpp"
 MONGO_CREATE_SORTER(mongo::BSONObj, mongo::RecordId, mongo::BtreeExternalSortComparison);
+MONGO_CREATE_SORTER(mongo::SortableKeyString,
+                    mongo::RecordId,
+                    mongo::KeyStringExternalSortComparison);
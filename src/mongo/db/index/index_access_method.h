@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/index/index_descriptor.h"
@@ -36,6 +37,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/storage/sortable_key_string.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 
 namespace mongo {
@@ -80,6 +82,20 @@ namespace mongo {
                       const InsertDeleteOptions& options,
                       int64_t* numInserted);
 
+        /**
+         * Like insert() for each of 'docs', at the matching position of 'locs', but sorts the
+         * keys of all of them and inserts them into the index in one pass, which lets the
+         * storage engine reuse a cursor and find duplicates among them without searching.
+         *
+         * Must be called in a WriteUnitOfWork, which the caller abandons on error: unlike
+         * insert(), keys already inserted are not removed again, and no error is ignored.
+         */
+        Status insertMany(OperationContext* txn,
+                          const std::vector<BSONObj>& docs,
+                          const std::vector<RecordId>& locs,
+                          const InsertDeleteOptions& options,
+                          int64_t* numInserted);
+
         /**
          * Analogous to above, but remove the records instead of inserting them.  If not NULL,
          * numDeleted will be set to the number of keys removed from the index for the document.
@@ -90,6 +106,16 @@ namespace mongo {
                       const InsertDeleteOptions& options,
                       int64_t* numDeleted);
 
+        /**
+         * Like remove() for each of 'docs', at the matching position of 'locs', but removes the
+         * keys of all of them in index order.
+         */
+        Status removeMany(OperationContext* txn,
+                          const std::vector<BSONObj>& docs,
+                          const std::vector<RecordId>& locs,
+                          const InsertDeleteOptions& options,
+                          int64_t* numDeleted);
+
         /**
          * Checks whether the index entries for the document 'from', which is placed at location
          * 'loc' on disk, can be changed to the index entries for the doc 'to'. Provides a ticket
@@ -147,6 +173,13 @@ namespace mongo {
          */
         Status touch(OperationContext* txn) const;
 
+        /**
+         * Appends up to 'numKeys' keys picked at random from the index to 'keys'.
+         * @return false if the storage engine can't pick keys at random
+         * See SortedDataInterface::sampleKeys.
+         */
+        bool sampleKeys(OperationContext* txn, int numKeys, std::vector<BSONObj>* keys) const;
+
         /**
          * Walk the entire index, checking the internal structure for consistency.
          * Set numKeys to the number of keys in the index.
@@ -193,27 +226,64 @@ namespace mongo {
                           const InsertDeleteOptions& options,
                           int64_t* numInserted);
 
+            /**
+             * Takes over the keys inserted into 'other', a BulkBuilder for the same index, so that
+             * commitBulk on this one merges them with its own. This lets several threads insert
+             * into BulkBuilders of their own for one index build.
+             */
+            void absorb(std::unique_ptr<BulkBuilder> other);
+
         private:
             friend class IndexAccessMethod;
 
-            using Sorter = mongo::Sorter<BSONObj, RecordId>;
+            // Keys are sorted as KeyStrings, so that comparing two keys is a memcmp rather than
+            // a walk over the elements of both. Version 0 indexes order keys in a way KeyStrings
+            // can't express and still sort the BSONObj keys.
+            using Sorter = mongo::Sorter<SortableKeyString, RecordId>;
+            using LegacySorter = mongo::Sorter<BSONObj, RecordId>;
+
+            BulkBuilder(const IndexAccessMethod* index,
+                        const IndexDescriptor* descriptor,
+                        size_t maxMemoryUsageBytes);
 
-            BulkBuilder(const IndexAccessMethod* index, const IndexDescriptor* descriptor);
+            void add(const BSONObj& key, const RecordId& loc);
 
+            /**
+             * Finishes sorting. Afterwards more() and next() return the keys in index order.
+             */
+            void done();
+            bool more();
+            std::pair<BSONObj, RecordId> next();
+
+            const Ordering _ordering;
+            const IndexDescriptor* const _descriptor;
+            const SortOptions _sortOptions;
             std::unique_ptr<Sorter> _sorter;
+            std::unique_ptr<Sorter::Iterator> _sorted;
+            std::unique_ptr<LegacySorter> _legacySorter;
+            std::unique_ptr<LegacySorter::Iterator> _legacySorted;
             const IndexAccessMethod* _real;
             int64_t _keysInserted = 0;
             bool _isMultiKey = false;
+
+            // BulkBuilders handed to absorb(), whose sorted keys done() merges with ours
+            std::vector<std::unique_ptr<BulkBuilder>> _absorbed;
         };
 
+        // Default memory limit of the sorter of a BulkBuilder, beyond which it spills to disk
+        static const size_t kDefaultBulkBuilderMaxMemoryUsageBytes = 100 * 1024 * 1024;
+
         /**
          * Starts a bulk operation.
          * You work on the returned BulkBuilder and then call commitBulk.
          * This can return NULL, meaning bulk mode is not available.
          *
          * It is only legal to initiate bulk when the index is new and empty.
+         *
+         * The sorter of the BulkBuilder holds up to 'maxMemoryUsageBytes' of keys in memory.
          */
-        std::unique_ptr<BulkBuilder> initiateBulk();
+        std::unique_ptr<BulkBuilder> initiateBulk(
+                size_t maxMemoryUsageBytes = kDefaultBulkBuilderMaxMemoryUsageBytes);
 
         /**
          * Call this when you are ready to finish your bulk work.
@@ -236,18 +306,52 @@ namespace mongo {
         virtual void getKeys(const BSONObj &obj, BSONObjSet *keys) const = 0;
 
     protected:
+        /**
+         * Returns true if getKeyStrings() is implemented. It is then used instead of getKeys()
+         * to maintain indexes whose storage supportsKeyStrings().
+         */
+        virtual bool generatesKeyStrings() const { return false; }
+
+        /**
+         * Fills 'keys' with the same keys getKeys() would, encoded as KeyStrings under
+         * '_ordering'.
+         */
+        virtual void getKeyStrings(const BSONObj& obj, KeyStringSet* keys) const {
+            invariant(false);
+        }
+
         // Determines whether it's OK to ignore ErrorCodes::KeyTooLong for this OperationContext
         bool ignoreKeyTooLong(OperationContext* txn);
 
         IndexCatalogEntry* _btreeState; // owned by IndexCatalogEntry
         const IndexDescriptor* _descriptor;
+        const Ordering _ordering;
 
     private:
+        bool useKeyStrings() const {
+            return generatesKeyStrings() && _newInterface->supportsKeyStrings();
+        }
+
+        Status insertKeyStrings(OperationContext* txn,
+                                const KeyStringSet& keys,
+                                const RecordId& loc,
+                                const InsertDeleteOptions& options,
+                                int64_t* numInserted);
+
+        Status updateKeyStrings(OperationContext* txn,
+                                const UpdateTicket& ticket,
+                                int64_t* numUpdated);
+
         void removeOneKey(OperationContext* txn,
                           const BSONObj& key,
                           const RecordId& loc,
                           bool dupsAllowed);
 
+        void removeOneKeyString(OperationContext* txn,
+                                const KeyStringSet::Key& key,
+                                const RecordId& loc,
+                                bool dupsAllowed);
+
         const std::unique_ptr<SortedDataInterface> _newInterface;
     };
 
@@ -269,6 +373,14 @@ namespace mongo {
         std::vector<BSONObj*> removed;
         std::vector<BSONObj*> added;
 
+        // Used instead of the above if the index generates KeyStrings. The removed and added
+        // keys are positions in oldKeyStrings and newKeyStrings.
+        bool usesKeyStrings = false;
+        KeyStringSet oldKeyStrings;
+        KeyStringSet newKeyStrings;
+        std::vector<size_t> removedKeyStrings;
+        std::vector<size_t> addedKeyStrings;
+
         RecordId loc;
         bool dupsAllowed;
     };
@@ -0,0 +1,411 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kIndex
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/summary_access_method.h"
+
+#include "mongo/db/catalog/index_catalog_entry.h"
+#include "mongo/db/index/expression_keys_private.h"
+#include "mongo/db/index/expression_params.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    /**
+     * The groups of a summary index, as of the writes to it which committed.
+     */
+    class SummaryAccessMethod::GroupTable {
+    public:
+        explicit GroupTable(size_t numGroupFields) : _numGroupFields(numGroupFields) { }
+
+        /**
+         * Adds the document of the index key 'key' to its group if 'sign' is 1, or removes it
+         * from the group if 'sign' is -1.
+         */
+        void apply(const BSONObj& key, int sign) {
+            BSONObjBuilder groupKey;
+            BSONObjIterator it(key);
+            for (size_t i = 0; i < _numGroupFields; ++i) {
+                groupKey.append(it.next());
+            }
+            const BSONElement summed = it.more() ? it.next() : BSONElement();
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            std::map<BSONObj, Group, BSONObjCmp>::iterator group =
+                _groups.insert(std::make_pair(groupKey.obj(), Group())).first;
+            group->second.count += sign;
+
+            if (summed.isNumber()) {
+                if (NumberLong == summed.type()) {
+                    group->second.numLongs += sign;
+                }
+                else if (NumberDouble == summed.type()) {
+                    group->second.numDoubles += sign;
+                }
+
+                if (NumberDouble != summed.type()) {
+                    // Wraps around on overflow like AccumulatorSum, and back on removal.
+                    const unsigned long long value = summed.numberLong();
+                    const unsigned long long total = group->second.longTotal;
+                    group->second.longTotal = sign > 0 ? total + value : total - value;
+                }
+                group->second.doubleTotal += sign * summed.numberDouble();
+            }
+
+            if (0 == group->second.count) {
+                _groups.erase(group);
+            }
+        }
+
+        Groups get() const {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            return Groups(_groups.begin(), _groups.end());
+        }
+
+    private:
+        const size_t _numGroupFields;
+
+        mutable stdx::mutex _mutex;
+        std::map<BSONObj, Group, BSONObjCmp> _groups;
+    };
+
+namespace {
+
+    // Applies a write to the groups once its write unit of work commits.
+    class ApplyOnCommit : public RecoveryUnit::Change {
+    public:
+        ApplyOnCommit(std::shared_ptr<SummaryAccessMethod::GroupTable> groups,
+                      const BSONObj& key,
+                      int sign)
+            : _groups(std::move(groups)),
+              _key(key.getOwned()),
+              _sign(sign) { }
+
+        virtual void commit() {
+            _groups->apply(_key, _sign);
+        }
+
+        virtual void rollback() { }
+
+    private:
+        const std::shared_ptr<SummaryAccessMethod::GroupTable> _groups;
+        const BSONObj _key;
+        const int _sign;
+    };
+
+    /**
+     * Counts the keys added to a summary index being built. A build which fails drops the index,
+     * so they are counted as soon as they are added.
+     */
+    class SummaryBulkBuilder : public SortedDataBuilderInterface {
+    public:
+        SummaryBulkBuilder(SortedDataBuilderInterface* builder,
+                           std::shared_ptr<SummaryAccessMethod::GroupTable> groups)
+            : _builder(builder),
+              _groups(std::move(groups)) { }
+
+        virtual Status addKey(const BSONObj& key, const RecordId& loc) {
+            Status status = _builder->addKey(key, loc);
+            if (status.isOK()) {
+                _groups->apply(key, 1);
+            }
+            return status;
+        }
+
+        virtual void commit(bool mayInterrupt) {
+            _builder->commit(mayInterrupt);
+        }
+
+    private:
+        const std::unique_ptr<SortedDataBuilderInterface> _builder;
+        const std::shared_ptr<SummaryAccessMethod::GroupTable> _groups;
+    };
+
+    /**
+     * The index of a SummaryAccessMethod, which keeps its groups up to date with each key
+     * written to it.
+     */
+    class SummarySortedDataInterface : public SortedDataInterface {
+    public:
+        SummarySortedDataInterface(SortedDataInterface* sdi,
+                                   std::shared_ptr<SummaryAccessMethod::GroupTable> groups)
+            : _sdi(sdi),
+              _groups(std::move(groups)) { }
+
+        virtual SortedDataBuilderInterface* getBulkBuilder(OperationContext* txn,
+                                                           bool dupsAllowed) {
+            return new SummaryBulkBuilder(_sdi->getBulkBuilder(txn, dupsAllowed), _groups);
+        }
+
+        virtual Status insert(OperationContext* txn,
+                              const BSONObj& key,
+                              const RecordId& loc,
+                              bool dupsAllowed) {
+            Status status = _sdi->insert(txn, key, loc, dupsAllowed);
+            if (status.isOK()) {
+                txn->recoveryUnit()->registerChange(new ApplyOnCommit(_groups, key, 1));
+            }
+            return status;
+        }
+
+        virtual void unindex(OperationContext* txn,
+                             const BSONObj& key,
+                             const RecordId& loc,
+                             bool dupsAllowed) {
+            _sdi->unindex(txn, key, loc, dupsAllowed);
+            txn->recoveryUnit()->registerChange(new ApplyOnCommit(_groups, key, -1));
+        }
+
+        virtual Status insertMany(OperationContext* txn,
+                                  const std::vector<IndexKeyEntry>& entries,
+                                  bool dupsAllowed) {
+            Status status = _sdi->insertMany(txn, entries, dupsAllowed);
+            if (status.isOK()) {
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    txn->recoveryUnit()->registerChange(
+                        new ApplyOnCommit(_groups, entries[i].key, 1));
+                }
+            }
+            return status;
+        }
+
+        virtual Status dupKeyCheck(OperationContext* txn,
+                                   const BSONObj& key,
+                                   const RecordId& loc) {
+            return _sdi->dupKeyCheck(txn, key, loc);
+        }
+
+        virtual void fullValidate(OperationContext* txn, bool full, long long* numKeysOut,
+                                  BSONObjBuilder* output) const {
+            _sdi->fullValidate(txn, full, numKeysOut, output);
+        }
+
+        virtual bool appendCustomStats(OperationContext* txn, BSONObjBuilder* output,
+                                       double scale) const {
+            return _sdi->appendCustomStats(txn, output, scale);
+        }
+
+        virtual long long getSpaceUsedBytes(OperationContext* txn) const {
+            return _sdi->getSpaceUsedBytes(txn);
+        }
+
+        virtual bool isEmpty(OperationContext* txn) {
+            return _sdi->isEmpty(txn);
+        }
+
+        virtual Status touch(OperationContext* txn) const {
+            return _sdi->touch(txn);
+        }
+
+        virtual bool sampleKeys(OperationContext* txn,
+                                int numKeys,
+                                std::vector<BSONObj>* keys) const {
+            return _sdi->sampleKeys(txn, numKeys, keys);
+        }
+
+        virtual long long numEntries(OperationContext* txn) const {
+            return _sdi->numEntries(txn);
+        }
+
+        virtual std::unique_ptr<Cursor> newCursor(OperationContext* txn,
+                                                  bool isForward = true) const {
+            return _sdi->newCursor(txn, isForward);
+        }
+
+        virtual Status initAsEmpty(OperationContext* txn) {
+            return _sdi->initAsEmpty(txn);
+        }
+
+    private:
+        const std::unique_ptr<SortedDataInterface> _sdi;
+        const std::shared_ptr<SummaryAccessMethod::GroupTable> _groups;
+    };
+
+    // Returns the position of 'path' in 'groupFields', or -1 if it isn't one of them.
+    int groupFieldPosition(const std::vector<std::string>& groupFields, StringData path) {
+        for (size_t i = 0; i < groupFields.size(); ++i) {
+            if (path == groupFields[i]) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    BSONElement elementAt(const BSONObj& key, int position) {
+        BSONObjIterator it(key);
+        for (int i = 0; i < position; ++i) {
+            it.next();
+        }
+        return it.next();
+    }
+
+}  // namespace
+
+    void SummaryAccessMethod::Group::appendSum(BSONObjBuilder* builder,
+                                               StringData fieldName) const {
+        if (numDoubles > 0) {
+            builder->append(fieldName, doubleTotal);
+        }
+        else if (numLongs > 0) {
+            builder->append(fieldName, longTotal);
+        }
+        else {
+            const int intTotal = longTotal;
+            if (intTotal == longTotal) {
+                builder->append(fieldName, intTotal);
+            }
+            else {
+                builder->append(fieldName, longTotal);
+            }
+        }
+    }
+
+    SummaryAccessMethod::SummaryAccessMethod(IndexCatalogEntry* btreeState,
+                                             SortedDataInterface* btree)
+        : SummaryAccessMethod(btreeState,
+                              btree,
+                              std::make_shared<GroupTable>(
+                                  btreeState->descriptor()->getNumFields())) { }
+
+    SummaryAccessMethod::SummaryAccessMethod(IndexCatalogEntry* btreeState,
+                                             SortedDataInterface* btree,
+                                             std::shared_ptr<GroupTable> groups)
+        : IndexAccessMethod(btreeState, new SummarySortedDataInterface(btree, groups)),
+          _groups(std::move(groups)) {
+
+        const IndexDescriptor* descriptor = btreeState->descriptor();
+
+        // Every document has to be counted in the group its fields are in.
+        uassert(28800, "summary indexes can't be unique", !descriptor->unique());
+        uassert(28801, "summary indexes can't be sparse or partial",
+                !descriptor->isSparse() && !descriptor->isPartial());
+
+        ExpressionParams::parseSummaryParams(descriptor->infoObj(), &_groupFields, &_sumField);
+    }
+
+    void SummaryAccessMethod::getKeys(const BSONObj& obj, BSONObjSet* keys) const {
+        ExpressionKeysPrivate::getSummaryKeys(obj, _groupFields, _sumField, keys);
+    }
+
+    void SummaryAccessMethod::loadGroups(OperationContext* txn) {
+        Timer timer;
+
+        BSONObjBuilder firstKey;
+        const size_t numKeyFields = _groupFields.size() + (_sumField.empty() ? 0 : 1);
+        for (size_t i = 0; i < numKeyFields; ++i) {
+            firstKey.appendMinKey("");
+        }
+
+        long long numKeys = 0;
+        std::unique_ptr<SortedDataInterface::Cursor> cursor(newCursor(txn));
+        const SortedDataInterface::Cursor::RequestedInfo parts =
+            SortedDataInterface::Cursor::kWantKey;
+        for (boost::optional<IndexKeyEntry> kv = cursor->seek(firstKey.obj(), true, parts);
+                kv;
+                kv = cursor->next(parts)) {
+            _groups->apply(kv->key, 1);
+            ++numKeys;
+        }
+
+        LOG(timer.seconds() > 10 ? 0 : 1) << "loaded the groups of " << numKeys
+                                          << " documents from summary index "
+                                          << _descriptor->indexNamespace() << " in "
+                                          << timer.millis() << "ms";
+    }
+
+    SummaryAccessMethod::Groups SummaryAccessMethod::getGroups() const {
+        return _groups->get();
+    }
+
+    bool SummaryAccessMethod::canMatchGroups(const MatchExpression* filter) const {
+        switch (filter->matchType()) {
+        case MatchExpression::AND:
+            for (size_t i = 0; i < filter->numChildren(); ++i) {
+                if (!canMatchGroups(filter->getChild(i))) {
+                    return false;
+                }
+            }
+            return true;
+        case MatchExpression::EQ:
+            return groupFieldPosition(_groupFields, filter->path()) >= 0;
+        case MatchExpression::MATCH_IN:
+            return groupFieldPosition(_groupFields, filter->path()) >= 0
+                && 0 == static_cast<const InMatchExpression*>(filter)->getData().numRegexes();
+        default:
+            return false;
+        }
+    }
+
+    bool SummaryAccessMethod::matchesGroup(const MatchExpression* filter,
+                                           const BSONObj& key) const {
+        // Group fields are never arrays, and missing ones are null in the key as well as to
+        // the matcher.
+        switch (filter->matchType()) {
+        case MatchExpression::AND:
+            for (size_t i = 0; i < filter->numChildren(); ++i) {
+                if (!matchesGroup(filter->getChild(i), key)) {
+                    return false;
+                }
+            }
+            return true;
+        case MatchExpression::EQ: {
+            const BSONElement value =
+                elementAt(key, groupFieldPosition(_groupFields, filter->path()));
+            return 0 == value.woCompare(
+                static_cast<const ComparisonMatchExpression*>(filter)->getData(), false);
+        }
+        case MatchExpression::MATCH_IN: {
+            const BSONElement value =
+                elementAt(key, groupFieldPosition(_groupFields, filter->path()));
+            return static_cast<const InMatchExpression*>(filter)->getData().contains(value);
+        }
+        default:
+            invariant(false);
+        }
+    }
+
+    long long SummaryAccessMethod::countMatching(const MatchExpression* filter) const {
+        long long count = 0;
+        const Groups groups = getGroups();
+        for (Groups::const_iterator it = groups.begin(); it != groups.end(); ++it) {
+            if (matchesGroup(filter, it->first)) {
+                count += it->second.count;
+            }
+        }
+        return count;
+    }
+
+}  // namespace mongo
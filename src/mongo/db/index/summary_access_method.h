@@ -0,0 +1,136 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+    class MatchExpression;
+
+    /**
+     * This is the access method for "summary" indexes, which keep the number of documents in each
+     * group of equal values of the indexed fields, and optionally the sum of a numeric field over
+     * each group, so that counts and $group $sums by those fields take time in the number of
+     * groups rather than of documents.
+     *
+     * The index has one key per document: its group, followed by the value it adds to the sum.
+     * The counts and sums are held in memory, loaded from the index when the collection is opened
+     * and updated as each write to the index commits.
+     */
+    class SummaryAccessMethod : public IndexAccessMethod {
+    public:
+        /**
+         * The count and sum of the documents of a group.
+         */
+        struct Group {
+            /**
+             * Appends the value of { $sum : "$<sumField>" } over the group, of the type
+             * AccumulatorSum would give it.
+             */
+            void appendSum(BSONObjBuilder* builder, StringData fieldName) const;
+
+            long long count = 0;
+
+            // Of the documents whose summed field is a number, those where it is a long or a
+            // double, the sum of the integers and the sum of all of them as doubles.
+            long long numLongs = 0;
+            long long numDoubles = 0;
+            long long longTotal = 0;
+            double doubleTotal = 0;
+        };
+
+        // Each group key, with empty field names in the order of getGroupFields(), and its group
+        typedef std::vector<std::pair<BSONObj, Group> > Groups;
+
+        SummaryAccessMethod(IndexCatalogEntry* btreeState, SortedDataInterface* btree);
+
+        /**
+         * Loads the groups from the index. Called when the collection is opened, before any
+         * write to the index.
+         */
+        void loadGroups(OperationContext* txn);
+
+        /**
+         * Returns the groups with at least one document, as of the last committed write.
+         */
+        Groups getGroups() const;
+
+        /**
+         * Returns whether 'filter' only compares group fields to values, with equalities and
+         * $in, so that the documents it matches are those of the groups matchesGroup() is true
+         * for.
+         */
+        bool canMatchGroups(const MatchExpression* filter) const;
+
+        /**
+         * Returns whether 'filter', for which canMatchGroups() is true, matches the documents of
+         * the group 'key'.
+         */
+        bool matchesGroup(const MatchExpression* filter, const BSONObj& key) const;
+
+        /**
+         * Returns the number of documents 'filter' matches, for which canMatchGroups() is true.
+         */
+        long long countMatching(const MatchExpression* filter) const;
+
+        const std::vector<std::string>& getGroupFields() const { return _groupFields; }
+
+        // Empty if the index only counts documents
+        const std::string& getSumField() const { return _sumField; }
+
+        // The groups, as of the writes to the index which committed
+        class GroupTable;
+
+    private:
+
+        SummaryAccessMethod(IndexCatalogEntry* btreeState,
+                            SortedDataInterface* btree,
+                            std::shared_ptr<GroupTable> groups);
+
+        virtual void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
+
+        std::vector<std::string> _groupFields;
+        std::string _sumField;
+
+        // Shared with the SortedDataInterface through which the index is written, and with the
+        // writes waiting to commit
+        const std::shared_ptr<GroupTable> _groups;
+    };
+
+}  // namespace mongo
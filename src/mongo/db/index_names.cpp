@@ -39,6 +39,7 @@ namespace mongo {
     const string IndexNames::GEO_2DSPHERE = "2dsphere";
     const string IndexNames::TEXT = "text";
     const string IndexNames::HASHED = "hashed";
+    const string IndexNames::SUMMARY = "summary";
     const string IndexNames::BTREE = "";
 
     // static
@@ -69,6 +70,7 @@ namespace mongo {
                || name == IndexNames::GEO_HAYSTACK
                || name == IndexNames::TEXT
                || name == IndexNames::HASHED
+               || name == IndexNames::SUMMARY
                || name == IndexNames::BTREE;
     }
 
@@ -89,6 +91,9 @@ namespace mongo {
         else if (IndexNames::HASHED == accessMethod) {
             return INDEX_HASHED;
         }
+        else if (IndexNames::SUMMARY == accessMethod) {
+            return INDEX_SUMMARY;
+        }
         else {
             return INDEX_BTREE;
         }
@@ -52,6 +52,7 @@ namespace mongo {
         INDEX_2DSPHERE,
         INDEX_TEXT,
         INDEX_HASHED,
+        INDEX_SUMMARY,
     };
 
     /**
@@ -65,6 +66,7 @@ namespace mongo {
         static const std::string GEO_2DSPHERE;
         static const std::string TEXT;
         static const std::string HASHED;
+        static const std::string SUMMARY;
         static const std::string BTREE;
 
         /**
@@ -40,15 +40,23 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -56,9 +64,55 @@ namespace mongo {
     using std::string;
     using std::vector;
 
+    // Number of threads generating and sorting the keys of the indexes rebuilt on each collection,
+    // see MultiIndexBlock::setParallelism().
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(indexRebuildParallelism, int, 1);
+
+    // If true, interrupted index builds are left unfinished at startup, where queries cannot use
+    // them, and rebuilt by a background thread once the server accepts connections. Indexes
+    // whose specs ask for background builds are then built without blocking their database.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(deferIndexRebuilds, bool, false);
+
 namespace {
-    void checkNS(OperationContext* txn, const std::list<std::string>& nsToCheck) {
-        bool firstTime = true;
+
+    // Only log the --noIndexBuildRetry note for the first collection found
+    AtomicUInt32 noteLogged;
+
+    /**
+     * The collections of one database. Databases are rebuilt in parallel, each under its own
+     * database lock, and the collections of a database one after another.
+     */
+    struct DatabaseToRebuild {
+        string name;
+        std::list<std::string> collNames;
+        string error;
+    };
+
+    /**
+     * Completes a background build of 'indexer' on 'ns', which drops the exclusive lock 'dbLock'
+     * of the database for the collection scan.
+     */
+    void buildInBackground(OperationContext* txn,
+                           const std::string& ns,
+                           Lock::DBLock* dbLock,
+                           MultiIndexBlock* indexer) {
+        txn->recoveryUnit()->abandonSnapshot();
+        dbLock->relockWithMode(MODE_IX);
+        {
+            Lock::CollectionLock colLock(txn->lockState(), ns, MODE_IX);
+            uassertStatusOK(indexer->insertAllDocumentsInCollection());
+        }
+
+        // The index catalog can only change under the exclusive lock
+        txn->recoveryUnit()->abandonSnapshot();
+        dbLock->relockWithMode(MODE_X);
+
+        Database* db = dbHolder().get(txn, nsToDatabaseSubstring(ns));
+        uassert(28784, "database dropped during index rebuild", db);
+        uassert(28785, "collection dropped during index rebuild", db->getCollection(ns));
+    }
+
+    void checkNS(OperationContext* txn, const std::list<std::string>& nsToCheck, bool deferred) {
         for (std::list<std::string>::const_iterator it = nsToCheck.begin();
                 it != nsToCheck.end();
                 ++it) {
@@ -68,7 +122,7 @@ namespace {
             LOG(3) << "IndexRebuilder::checkNS: " << ns;
 
             // This write lock is held throughout the index building process
-            // for this namespace.
+            // for this namespace, unless the rebuild was deferred to a background build.
             ScopedTransaction transaction(txn, MODE_IX);
             Lock::DBLock lk(txn->lockState(), nsToDatabaseSubstring(ns), MODE_X);
             OldClientContext ctx(txn, ns);
@@ -87,6 +141,15 @@ namespace {
 
 
             MultiIndexBlock indexer(txn, collection);
+            indexer.setParallelism(std::min(std::max(int(indexRebuildParallelism), 1),
+                                            MultiIndexBlock::kMaxParallelism));
+            if (deferred) {
+                // Clients are being served, so don't block them when the specs allow it, and
+                // let shutdown interrupt the build.
+                indexer.allowBackgroundBuilding();
+                indexer.allowHybridBuilding();
+                indexer.allowInterruption();
+            }
 
             {
                 WriteUnitOfWork wunit(txn);
@@ -107,10 +170,9 @@ namespace {
                 log() << "found " << indexesToBuild.size()
                       << " interrupted index build(s) on " << ns;
 
-                if (firstTime) {
+                if (noteLogged.swap(1) == 0) {
                     log() << "note: restart the server with --noIndexBuildRetry "
                           << "to skip index rebuilds";
-                    firstTime = false;
                 }
 
                 if (!serverGlobalParams.indexBuildRetry) {
@@ -125,18 +187,29 @@ namespace {
             }
 
             try {
-                uassertStatusOK(indexer.insertAllDocumentsInCollection());
+                if (indexer.getBuildInBackground()) {
+                    buildInBackground(txn, ns, &lk, &indexer);
+                }
+                else {
+                    uassertStatusOK(indexer.insertAllDocumentsInCollection());
+                }
+
+                uassertStatusOK(indexer.drainSideWrites());
 
                 WriteUnitOfWork wunit(txn);
                 indexer.commit();
                 wunit.commit();
             }
             catch (const DBException& e) {
-                error() << "Index rebuilding did not complete: " << e.toString();
-                log() << "note: restart the server with --noIndexBuildRetry to skip index rebuilds";
                 // If anything went wrong, leave the indexes partially built so that we pick them up
                 // again on restart.
                 indexer.abortWithoutCleanup();
+                if (deferred && inShutdown()) {
+                    log() << "index rebuild of " << ns << " interrupted by shutdown";
+                    return;
+                }
+                error() << "Index rebuilding did not complete: " << e.toString();
+                log() << "note: restart the server with --noIndexBuildRetry to skip index rebuilds";
                 fassertFailedNoTrace(26100);
             }
             catch (...) {
@@ -147,6 +220,87 @@ namespace {
             }
         }
     }
+
+    void checkDatabase(DatabaseToRebuild* toRebuild, bool deferred) {
+        // ThreadPool only logs exceptions, so keep the error for the starting thread
+        try {
+            Client::initThreadIfNotAlready("indexRebuilder");
+            OperationContextImpl txn;
+            AuthorizationSession::get(txn.getClient())->grantInternalAuthorization();
+            checkNS(&txn, toRebuild->collNames, deferred);
+        }
+        catch (const DBException& e) {
+            toRebuild->error = e.toString();
+        }
+        catch (const std::exception& e) {
+            toRebuild->error = e.what();
+        }
+    }
+
+    /**
+     * Rebuilds the interrupted index builds of 'toRebuild', running the databases on up to
+     * storageStartupThreads threads. The serial case runs on the calling thread's 'txn'.
+     */
+    void checkDatabases(OperationContext* txn,
+                        std::vector<DatabaseToRebuild>* toRebuild,
+                        bool deferred) {
+        Timer rebuildTimer;
+        const int nThreads = std::min(std::max(storageGlobalParams.startupThreads, 1),
+                                      static_cast<int>(toRebuild->size()));
+        if (nThreads <= 1) {
+            for (size_t i = 0; i < toRebuild->size(); ++i) {
+                checkNS(txn, (*toRebuild)[i].collNames, deferred);
+            }
+        }
+        else {
+            ThreadPool pool(nThreads, "indexRebuilder");
+            for (size_t i = 0; i < toRebuild->size(); ++i) {
+                pool.schedule(&checkDatabase, &(*toRebuild)[i], deferred);
+            }
+            pool.join();
+        }
+
+        for (size_t i = 0; i < toRebuild->size(); ++i) {
+            uassert(28786,
+                    str::stream() << "failed to check the indexes of database "
+                                  << (*toRebuild)[i].name << ": " << (*toRebuild)[i].error,
+                    (*toRebuild)[i].error.empty());
+        }
+
+        LOG(1) << "checked the indexes of " << toRebuild->size() << " database(s) in "
+               << rebuildTimer.millis() << "ms using " << std::max(nThreads, 1) << " thread(s)";
+    }
+
+    class IndexRebuilderJob : public BackgroundJob {
+    public:
+        explicit IndexRebuilderJob(const std::vector<DatabaseToRebuild>& toRebuild)
+            : BackgroundJob(true /* selfDelete */),
+              _toRebuild(toRebuild) {
+        }
+
+        virtual string name() const { return "IndexRebuilder"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            OperationContextImpl txn;
+            AuthorizationSession::get(txn.getClient())->grantInternalAuthorization();
+
+            try {
+                checkDatabases(&txn, &_toRebuild, true);
+            }
+            catch (const DBException& e) {
+                if (inShutdown()) {
+                    return;
+                }
+                error() << "Deferred index rebuild did not complete: " << e.toString();
+                fassertFailedNoTrace(28787);
+            }
+            log() << "deferred index rebuilds complete";
+        }
+
+    private:
+        std::vector<DatabaseToRebuild> _toRebuild;
+    };
 } // namespace
 
     void restartInProgressIndexesFromLastShutdown(OperationContext* txn) {
@@ -158,7 +312,7 @@ namespace {
         storageEngine->listDatabases( &dbNames );
 
         try {
-            std::list<std::string> collNames;
+            std::vector<DatabaseToRebuild> toRebuild;
             for (std::vector<std::string>::const_iterator dbName = dbNames.begin();
                  dbName < dbNames.end();
                  ++dbName) {
@@ -166,10 +320,27 @@ namespace {
                 ScopedTransaction scopedXact(txn, MODE_IS);
                 AutoGetDb autoDb(txn, *dbName, MODE_S);
 
+                // Databases left closed by storageLazyOpen are skipped, their interrupted builds
+                // stay unfinished until a restart which opens them.
                 Database* db = autoDb.getDb();
-                db->getDatabaseCatalogEntry()->getCollectionNamespaces(&collNames);
+                if (!db) {
+                    continue;
+                }
+
+                toRebuild.push_back(DatabaseToRebuild());
+                toRebuild.back().name = *dbName;
+                db->getDatabaseCatalogEntry()->getCollectionNamespaces(
+                    &toRebuild.back().collNames);
             }
-            checkNS(txn, collNames);
+
+            if (deferIndexRebuilds && serverGlobalParams.indexBuildRetry) {
+                log() << "deferring interrupted index builds until after startup";
+                IndexRebuilderJob* job = new IndexRebuilderJob(toRebuild);
+                job->go();
+                return;
+            }
+
+            checkDatabases(txn, &toRebuild, false);
         }
         catch (const DBException& e) {
             error() << "Index verification did not complete: " << e.toString();
@@ -33,7 +33,9 @@ namespace mongo {
     class OperationContext;
 
     /**
-     * Restarts building indexes that were in progress during shutdown.
+     * Restarts building indexes that were in progress during shutdown. Databases are rebuilt in
+     * parallel on up to storageStartupThreads threads. With deferIndexRebuilds, the builds are
+     * left unfinished and this returns at once, while a background thread rebuilds them.
      * Only call this at startup before taking requests.
      */
     void restartInProgressIndexesFromLastShutdown(OperationContext* txn);
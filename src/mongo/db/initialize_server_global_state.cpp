@@ -51,6 +51,9 @@
 #include "mongo/db/auth/internal_user_auth.h"
 #include "mongo/db/auth/security_key.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/logger/async_log_writer.h"
+#include "mongo/logger/async_rotatable_file_appender.h"
 #include "mongo/logger/logger.h"
 #include "mongo/logger/console_appender.h"
 #include "mongo/logger/message_event.h"
@@ -75,6 +78,13 @@ namespace mongo {
     using std::cout;
     using std::endl;
 
+    // With asyncLogging, lines for the log file are queued, up to asyncLoggingQueueSizeBytes, and
+    // written by a background thread rather than by the threads which log.  When the queue is
+    // full, logging waits for room, or with asyncLoggingDropWhenFull, drops the line.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(asyncLogging, bool, false);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(asyncLoggingQueueSizeBytes, int, 16 * 1024 * 1024);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(asyncLoggingDropWhenFull, bool, false);
+
 #ifndef _WIN32
     // support for exit value propagation with fork
     void launchSignal( int sig ) {
@@ -203,6 +213,8 @@ namespace mongo {
                               ("default"))(
             InitializerContext*) {
 
+        using logger::AsyncLogWriter;
+        using logger::AsyncRotatableFileAppender;
         using logger::LogManager;
         using logger::MessageEventEphemeral;
         using logger::MessageEventDetailsEncoder;
@@ -283,14 +295,36 @@ namespace mongo {
 
             LogManager* manager = logger::globalLogManager();
             manager->getGlobalDomain()->clearAppenders();
-            manager->getGlobalDomain()->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
-            manager->getNamedDomain("javascriptOutput")->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
+            if (asyncLogging) {
+                if (asyncLoggingQueueSizeBytes <= 0) {
+                    return Status(ErrorCodes::BadValue,
+                                  "asyncLoggingQueueSizeBytes must be greater than 0");
+                }
+                // Never deleted, as logging may go on until the process exits.
+                AsyncLogWriter* asyncWriter = new AsyncLogWriter(
+                        writer.getValue(),
+                        asyncLoggingQueueSizeBytes,
+                        asyncLoggingDropWhenFull ? AsyncLogWriter::kDrop : AsyncLogWriter::kBlock);
+                asyncWriter->start();
+                manager->getGlobalDomain()->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new AsyncRotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, asyncWriter)));
+                manager->getNamedDomain("javascriptOutput")->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new AsyncRotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, asyncWriter)));
+            }
+            else {
+                manager->getGlobalDomain()->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new RotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, writer.getValue())));
+                manager->getNamedDomain("javascriptOutput")->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new RotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, writer.getValue())));
+            }
 
             if (serverGlobalParams.logAppend && exists) {
                 log() << "***** SERVER RESTARTED *****" << endl;
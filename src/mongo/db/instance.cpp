@@ -32,6 +32,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <boost/thread/thread.hpp>
 #include <fstream>
 #include <memory>
@@ -44,10 +45,12 @@
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/authz_manager_external_state_d.h"
 #include "mongo/db/background.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/fsync.h"
+#include "mongo/db/concurrency/admission_context.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
@@ -81,9 +84,14 @@
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/sampling_profiler.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/db/stats/operation_latency_histograms.h"
+#include "mongo/db/stats/query_stats_store.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/rpc/command_reply_builder.h"
@@ -94,6 +102,7 @@
 #include "mongo/rpc/legacy_request_builder.h"
 #include "mongo/rpc/request_interface.h"
 #include "mongo/rpc/metadata.h"
+#include "mongo/rpc/metadata/trace_metadata.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/d_state.h"
 #include "mongo/s/grid.h"
@@ -162,6 +171,14 @@ namespace mongo {
 
     MONGO_FP_DECLARE(rsStopGetMore);
 
+    // The most query shapes the query stats store keeps, across all collections.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(queryStatsMaxShapes, int, 1000);
+
+    QueryStatsStore* getGlobalQueryStatsStore() {
+        static QueryStatsStore* const store = new QueryStatsStore(std::max(queryStatsMaxShapes, 1));
+        return store;
+    }
+
 namespace {
 
     std::unique_ptr<AuthzManagerExternalState> createAuthzManagerExternalStateMongod() {
@@ -399,6 +416,9 @@ namespace {
             audit::logQueryAuthzCheck(client, nss, q.query, status.code());
             uassertStatusOK(status);
 
+            // mongos sends the trace of a query next to its $query
+            uassertStatusOK(rpc::TraceMetadata::readFromMetadata(client, q.query));
+
             dbResponse.exhaustNS = runQuery(txn, q, nss, *resp);
             verify( !resp->empty() );
         }
@@ -438,6 +458,7 @@ namespace {
         if (!c.isInDirectClient()) {
             LastError::get(c).startRequest();
             AuthorizationSession::get(c)->startRequest(txn);
+            rpc::TraceMetadata::get(c).reset();
 
             // We should not be holding any locks at this point
             invariant(!txn->lockState()->isLocked());
@@ -514,9 +535,11 @@ namespace {
             stdx::lock_guard<Client> lk(*txn->getClient());
             currentOp.setOp_inlock(op);
         }
+        SamplingProfilerOpScope profilerOp(opToString(op));
 
         OpDebug& debug = currentOp.debug();
         debug.op = op;
+        debug.storageStatsAtStart = txn->recoveryUnit()->getStorageStats();
 
         long long logThreshold = serverGlobalParams.slowMS;
         LogComponent responseComponent(LogComponent::kQuery);
@@ -628,6 +651,51 @@ namespace {
         currentOp.ensureStarted();
         currentOp.done();
         debug.executionTime = currentOp.totalTimeMillis();
+        debug.ticketWaitMicros = AdmissionContext::get(txn).getTicketWaitMicros();
+        debug.storageStats =
+            txn->recoveryUnit()->getStorageStats().since(debug.storageStatsAtStart);
+
+        if (!c.isInDirectClient() && rpc::TraceMetadata::get(c).isTraced()) {
+            const long long micros = currentOp.totalTimeMicros();
+            BSONObjBuilder info;
+            info.append("op", opToString(op));
+            info.append("ns", currentOp.getNS());
+            if (debug.nscanned >= 0) {
+                info.appendNumber("keysExamined", debug.nscanned);
+            }
+            if (debug.nscannedObjects >= 0) {
+                info.appendNumber("docsExamined", debug.nscannedObjects);
+            }
+            if (debug.nreturned >= 0) {
+                info.append("nreturned", debug.nreturned);
+            }
+            rpc::recordTraceSpan(&c,
+                                 "mongod",
+                                 Date_t::now() - Microseconds(micros),
+                                 micros,
+                                 info.obj());
+        }
+
+        globalOperationLatencyHistograms.record(op,
+                                                currentOp.getCommand(),
+                                                currentOp.totalTimeMicros());
+
+        if (!debug.queryShapeKey.empty()) {
+            QueryStatsStore::OpStats stats;
+            stats.micros = currentOp.totalTimeMicros();
+            stats.keysExamined = debug.nscanned;
+            stats.docsExamined = debug.nscannedObjects;
+            stats.nreturned = debug.nreturned;
+            stats.yields = currentOp.numYields();
+            stats.replanned = debug.replanned;
+            getGlobalQueryStatsStore()->record(debug.queryShapeNs,
+                                               currentOp.getCommand()
+                                                   ? StringData(currentOp.getCommand()->name)
+                                                   : StringData(opToString(op)),
+                                               debug.queryShapeKey,
+                                               debug.queryShape,
+                                               stats);
+        }
 
         logThreshold += currentOp.getExpectedLatencyMs();
 
@@ -653,6 +721,10 @@ namespace {
             }
         }
 
+        if (shouldSampleProfile(debug.executionTime)) {
+            profileSample(txn);
+        }
+
         recordCurOpMetrics(txn);
         debug.reset();
     }
@@ -770,7 +842,9 @@ namespace {
                     log(LogComponent::kWrite) << "Had WriteConflict during multi update, aborting";
                     throw;
                 }
-                WriteConflictException::logAndBackoff( attempt++, "update", nsString.toString() );
+                op.debug().writeConflictBackoffMicros +=
+                    WriteConflictException::logAndBackoff( attempt++, "update",
+                                                           nsString.toString() );
             }
         }
 
@@ -880,7 +954,9 @@ namespace {
             }
             catch ( const WriteConflictException& dle ) {
                 op.debug().writeConflicts++;
-                WriteConflictException::logAndBackoff( attempt++, "delete", nsString.toString() );
+                op.debug().writeConflictBackoffMicros +=
+                    WriteConflictException::logAndBackoff( attempt++, "delete",
+                                                           nsString.toString() );
             }
         }
     }
@@ -908,7 +984,7 @@ namespace {
         int pass = 0;
         bool exhaust = false;
         QueryResult::View msgdata = 0;
-        Timestamp last;
+        AwaitDataWait awaitDataWait;
         while( 1 ) {
             bool isCursorAuthorized = false;
             try {
@@ -924,13 +1000,6 @@ namespace {
                     while (MONGO_FAIL_POINT(rsStopGetMore)) {
                         sleepmillis(0);
                     }
-
-                    if (pass == 0) {
-                        last = getLastSetTimestamp();
-                    }
-                    else {
-                        repl::waitUpToOneSecondForTimestampChange(last);
-                    }
                 }
 
                 msgdata = getMore(txn,
@@ -939,7 +1008,8 @@ namespace {
                                   cursorid,
                                   pass,
                                   exhaust,
-                                  &isCursorAuthorized);
+                                  &isCursorAuthorized,
+                                  &awaitDataWait);
             }
             catch ( AssertionException& e ) {
                 if ( isCursorAuthorized ) {
@@ -970,14 +1040,21 @@ namespace {
                     }
                 }
                 pass++;
-                if (kDebugBuild)
+                if (awaitDataWait.notifier) {
+                    // Sleep until something is committed to the capped collection, but no longer
+                    // than the point at which we return an empty batch anyway.
+                    const long long millisLeft = std::max(4000LL - timer->millis(), 1LL);
+                    awaitDataWait.notifier->waitForInsert(awaitDataWait.lastInsertCount,
+                                                          Microseconds(millisLeft * 1000));
+                    awaitDataWait.notifier.reset();
+                }
+                else if (kDebugBuild)
                     sleepmillis(20);
                 else
                     sleepmillis(2);
-                
-                // note: the 1100 is beacuse of the waitForDifferent above
-                // should eventually clean this up a bit
-                curop.setExpectedLatencyMs( 1100 + timer->millis() );
+
+                // An awaitData getMore may wait for up to about 4 seconds in all.
+                curop.setExpectedLatencyMs( 4000 );
                 
                 continue;
             }
@@ -1041,7 +1118,8 @@ namespace {
             catch( const WriteConflictException& e ) {
                 CurOp::get(txn)->debug().writeConflicts++;
                 txn->recoveryUnit()->abandonSnapshot();
-                WriteConflictException::logAndBackoff( attempt++, "insert", ns);
+                CurOp::get(txn)->debug().writeConflictBackoffMicros +=
+                    WriteConflictException::logAndBackoff( attempt++, "insert", ns);
             }
         }
     }
@@ -1348,6 +1426,7 @@ namespace {
         }
 #endif
 
+        logger::AsyncLogWriter::flushAll();
         quickExit(rc);
     }
 
@@ -67,6 +67,13 @@ namespace mongo {
 
     extern DiagLog _diaglog;
 
+    class QueryStatsStore;
+
+    /**
+     * The execution statistics of the queries mongod ran, by query shape.
+     */
+    QueryStatsStore* getGlobalQueryStatsStore();
+
     void assembleResponse( OperationContext* txn,
                            Message& m,
                            DbResponse& dbresponse,
@@ -32,6 +32,10 @@
 
 #include "mongo/db/introspect.h"
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -41,8 +45,15 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/profile_ring_buffer.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -50,8 +61,23 @@ namespace mongo {
     using std::endl;
     using std::string;
 
+    // The sampling profiler records the entries of one in 'profileSampleRate' operations, and of
+    // all those that take at least 'profileSampleSlowMS', into an in-memory ring rather than
+    // system.profile. Zero and negative values turn either off.
+    MONGO_EXPORT_SERVER_PARAMETER(profileSampleRate, int, 0);
+    MONGO_EXPORT_SERVER_PARAMETER(profileSampleSlowMS, int, -1);
+
+    // The number of entries the ring holds.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(profileSampleBufferSize, int, 4096);
+
+    // If positive, sampled entries are also inserted into the system.profile collection of their
+    // database this often, off the operations' path.
+    MONGO_EXPORT_SERVER_PARAMETER(profileSampleFlushIntervalSecs, int, 0);
+
 namespace {
 
+    AtomicUInt64 profileSampleCounter;
+
     void _appendUserInfo(const CurOp& c,
                          BSONObjBuilder& builder,
                          AuthorizationSession* authSession) {
@@ -80,15 +106,7 @@ namespace {
 
     }
 
-} // namespace
-
-
-    void profile(OperationContext* txn, int op) {
-        // Initialize with 1kb at start in order to avoid realloc later
-        BufBuilder profileBufBuilder(1024);
-
-        BSONObjBuilder b(profileBufBuilder);
-
+    void _appendProfileEntry(OperationContext* txn, BSONObjBuilder& b) {
         {
             Locker::LockerInfo lockerInfo;
             txn->lockState()->getLockerInfo(&lockerInfo);
@@ -100,7 +118,71 @@ namespace {
 
         AuthorizationSession * authSession = AuthorizationSession::get(txn->getClient());
         _appendUserInfo(*CurOp::get(txn), b, authSession);
+    }
+
+    /**
+     * Inserts 'p' into the system.profile collection of 'dbName', creating it if needed and
+     * possible. 'wasLocked' tells whether the caller already held locks before profiling.
+     */
+    void _insertProfileEntry(OperationContext* txn,
+                             const string& dbName,
+                             const BSONObj& p,
+                             bool wasLocked) {
+        bool acquireDbXLock = false;
+        while (true) {
+            ScopedTransaction scopedXact(txn, MODE_IX);
+
+            std::unique_ptr<AutoGetDb> autoGetDb;
+            if (acquireDbXLock) {
+                autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_X));
+                if (autoGetDb->getDb()) {
+                    createProfileCollection(txn, autoGetDb->getDb());
+                }
+            }
+            else {
+                autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_IX));
+            }
+
+            Database* const db = autoGetDb->getDb();
+            if (!db) {
+                // Database disappeared
+                log() << "note: not profiling because db went away for " << dbName;
+                break;
+            }
+
+            Lock::CollectionLock collLock(txn->lockState(), db->getProfilingNS(), MODE_IX);
+
+            Collection* const coll = db->getCollection(db->getProfilingNS());
+            if (coll) {
+                WriteUnitOfWork wuow(txn);
+                coll->insertDocument(txn, p, false);
+                wuow.commit();
+
+                break;
+            }
+            else if (!acquireDbXLock &&
+                        (!wasLocked || txn->lockState()->isDbLockedForMode(dbName, MODE_X))) {
+                // Try to create the collection only if we are not under lock, in order to
+                // avoid deadlocks due to lock conversion. This would only be hit if someone
+                // deletes the profiler collection after setting profile level.
+                acquireDbXLock = true;
+            }
+            else {
+                // Cannot write the profile information
+                break;
+            }
+        }
+    }
+
+} // namespace
+
+
+    void profile(OperationContext* txn, int op) {
+        // Initialize with 1kb at start in order to avoid realloc later
+        BufBuilder profileBufBuilder(1024);
 
+        BSONObjBuilder b(profileBufBuilder);
+        _appendProfileEntry(txn, b);
         const BSONObj p = b.done();
 
         const bool wasLocked = txn->lockState()->isLocked();
@@ -108,58 +190,108 @@ namespace {
         const string dbName(nsToDatabase(CurOp::get(txn)->getNS()));
 
         try {
-            bool acquireDbXLock = false;
-            while (true) {
-                ScopedTransaction scopedXact(txn, MODE_IX);
-
-                std::unique_ptr<AutoGetDb> autoGetDb;
-                if (acquireDbXLock) {
-                    autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_X));
-                    if (autoGetDb->getDb()) {
-                        createProfileCollection(txn, autoGetDb->getDb());
-                    }
+            _insertProfileEntry(txn, dbName, p, wasLocked);
+        }
+        catch (const AssertionException& assertionEx) {
+            warning() << "Caught Assertion while trying to profile "
+                      << opToString(op)
+                      << " against " << CurOp::get(txn)->getNS()
+                      << ": " << assertionEx.toString() << endl;
+        }
+    }
+
+    bool shouldSampleProfile(int millis) {
+        const int slowMS = profileSampleSlowMS;
+        if (slowMS > 0 && millis >= slowMS) {
+            return true;
+        }
+
+        const int rate = profileSampleRate;
+        return rate > 0 && profileSampleCounter.fetchAndAdd(1) % rate == 0;
+    }
+
+    void profileSample(OperationContext* txn) {
+        BSONObjBuilder b;
+        _appendProfileEntry(txn, b);
+        getProfileSampleRing()->record(b.obj());
+    }
+
+    ProfileRingBuffer* getProfileSampleRing() {
+        static ProfileRingBuffer* const ring =
+            new ProfileRingBuffer(std::max(profileSampleBufferSize, 1));
+        return ring;
+    }
+
+namespace {
+
+    /**
+     * Inserts the entries that the sampling profiler recorded since the last flush into the
+     * system.profile collections of their databases, if profileSampleFlushIntervalSecs is set.
+     */
+    class ProfileSampleFlusher : public BackgroundJob {
+    public:
+        ProfileSampleFlusher() : _lastSeq(0) { }
+
+        virtual std::string name() const { return "ProfileSampleFlusher"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            Date_t lastFlush = jsTime();
+            while (!inShutdown()) {
+                sleepsecs(1);
+
+                const int intervalSecs = profileSampleFlushIntervalSecs;
+                if (intervalSecs <= 0) {
+                    // Do not flush what was recorded while flushing was off.
+                    _lastSeq = getProfileSampleRing()->numRecorded();
+                    continue;
                 }
-                else {
-                    autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_IX));
+
+                if (jsTime() - lastFlush < Seconds(intervalSecs)) {
+                    continue;
                 }
+                lastFlush = jsTime();
 
-                Database* const db = autoGetDb->getDb();
-                if (!db) {
-                    // Database disappeared
-                    log() << "note: not profiling because db went away for "
-                          << CurOp::get(txn)->getNS();
-                    break;
+                if (lockedForWriting()) {
+                    continue;
                 }
 
-                Lock::CollectionLock collLock(txn->lockState(), db->getProfilingNS(), MODE_IX);
+                _flush();
+            }
+        }
 
-                Collection* const coll = db->getCollection(db->getProfilingNS());
-                if (coll) {
-                    WriteUnitOfWork wuow(txn);
-                    coll->insertDocument(txn, p, false);
-                    wuow.commit();
+    private:
+        void _flush() {
+            std::vector<ProfileRingBuffer::Sample> samples;
+            _lastSeq = getProfileSampleRing()->getSince(_lastSeq, &samples);
 
-                    break;
+            OperationContextImpl txn;
+            for (const ProfileRingBuffer::Sample& sample : samples) {
+                const string dbName(nsToDatabase(sample.entry["ns"].valuestrsafe()));
+                if (dbName.empty()) {
+                    continue;
                 }
-                else if (!acquireDbXLock &&
-                            (!wasLocked || txn->lockState()->isDbLockedForMode(dbName, MODE_X))) {
-                    // Try to create the collection only if we are not under lock, in order to
-                    // avoid deadlocks due to lock conversion. This would only be hit if someone
-                    // deletes the profiler collection after setting profile level.
-                    acquireDbXLock = true;
+
+                try {
+                    _insertProfileEntry(&txn, dbName, sample.entry, false);
                 }
-                else {
-                    // Cannot write the profile information
-                    break;
+                catch (const AssertionException& assertionEx) {
+                    warning() << "Caught Assertion while trying to flush a profile sample for "
+                              << dbName << ": " << assertionEx.toString();
                 }
             }
         }
-        catch (const AssertionException& assertionEx) {
-            warning() << "Caught Assertion while trying to profile "
-                      << opToString(op)
-                      << " against " << CurOp::get(txn)->getNS()
-                      << ": " << assertionEx.toString() << endl;
-        }
+
+        long long _lastSeq;
+    };
+
+} // namespace
+
+    void startProfileSampleFlusher() {
+        ProfileSampleFlusher* flusher = new ProfileSampleFlusher();
+        flusher->go();
     }
 
 
@@ -34,12 +34,36 @@ namespace mongo {
 
     class Database;
     class OperationContext;
+    class ProfileRingBuffer;
 
     /**
      * Invoked when database profile is enabled.
      */
     void profile(OperationContext* txn, int op);
 
+    /**
+     * Should the sampling profiler record the operation that just finished after 'millis'
+     * milliseconds? Counts the operation towards the sampling rate.
+     */
+    bool shouldSampleProfile(int millis);
+
+    /**
+     * Records the profile entry of the current operation in the sampling profiler's ring. Takes
+     * no locks, so unlike profile() it may be called under any.
+     */
+    void profileSample(OperationContext* txn);
+
+    /**
+     * The ring of entries that the sampling profiler recorded.
+     */
+    ProfileRingBuffer* getProfileSampleRing();
+
+    /**
+     * Starts the thread that copies sampled profile entries into system.profile when
+     * profileSampleFlushIntervalSecs is set.
+     */
+    void startProfileSampleFlusher();
+
     /**
      * Pre-creates the profile collection for the specified database.
      */
@@ -0,0 +1,275 @@
+// expression_compiled.cpp
+
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/expression_compiled.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "mongo/db/matcher/expression_leaf.h"
+
+namespace mongo {
+
+    using std::unique_ptr;
+    using std::vector;
+
+namespace {
+
+    int compareLongLongs(long long lhs, long long rhs) {
+        return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+    }
+
+    int compareDoubles(double lhs, double rhs) {
+        return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+    }
+
+    bool resultFromCompare(MatchExpression::MatchType type, int cmp) {
+        switch (type) {
+        case MatchExpression::LT:
+            return cmp < 0;
+        case MatchExpression::LTE:
+            return cmp <= 0;
+        case MatchExpression::EQ:
+            return cmp == 0;
+        case MatchExpression::GT:
+            return cmp > 0;
+        case MatchExpression::GTE:
+            return cmp >= 0;
+        default:
+            invariant(false);
+            return false;
+        }
+    }
+
+}  // namespace
+
+    CompiledMatchExpression::Predicate::Predicate(const ComparisonMatchExpression* expr)
+        : expr(expr),
+          type(expr->matchType()),
+          kind(kGeneric),
+          longValue(0),
+          doubleValue(0),
+          oidValue(NULL) {
+        const BSONElement& rhs = expr->getData();
+        switch (rhs.type()) {
+        case NumberInt:
+        case NumberLong:
+            kind = kLong;
+            longValue = rhs.numberLong();
+            break;
+        case NumberDouble:
+            // NaN has its own rules, which the leaf knows about.
+            if (!std::isnan(rhs.numberDouble())) {
+                kind = kDouble;
+                doubleValue = rhs.numberDouble();
+            }
+            break;
+        case String:
+            kind = kString;
+            stringValue = StringData(rhs.valuestr(), rhs.valuestrsize() - 1);
+            break;
+        case jstOID:
+            kind = kOID;
+            oidValue = rhs.value();
+            break;
+        default:
+            break;
+        }
+    }
+
+    // static
+    CompiledMatchExpression* CompiledMatchExpression::compile(const MatchExpression* expr) {
+        unique_ptr<CompiledMatchExpression> program(new CompiledMatchExpression());
+        program->addConjuncts(expr);
+        if (program->_groups.empty()) {
+            return NULL;
+        }
+        return program.release();
+    }
+
+    // static
+    bool CompiledMatchExpression::canCompile(const MatchExpression* expr) {
+        switch (expr->matchType()) {
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::EQ:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            break;
+        default:
+            return false;
+        }
+
+        // Only top-level fields are found by the single pass over the document.
+        const StringData path = expr->path();
+        return !path.empty() && std::string::npos == path.find('.');
+    }
+
+    void CompiledMatchExpression::addConjuncts(const MatchExpression* expr) {
+        if (MatchExpression::AND == expr->matchType()) {
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                addConjuncts(expr->getChild(i));
+            }
+            return;
+        }
+
+        if (!canCompile(expr)) {
+            _residual.push_back(expr);
+            return;
+        }
+
+        const ComparisonMatchExpression* cmp = static_cast<const ComparisonMatchExpression*>(expr);
+        const StringData field = cmp->path();
+
+        vector<FieldGroup>::iterator group = _groups.begin();
+        while (group != _groups.end() && group->field < field) {
+            ++group;
+        }
+
+        if (group == _groups.end() || group->field != field) {
+            if (_groups.size() == kMaxFieldGroups) {
+                _residual.push_back(expr);
+                return;
+            }
+
+            FieldGroup newGroup;
+            newGroup.field = field;
+            newGroup.matchesMissing = true;
+            group = _groups.insert(group, newGroup);
+        }
+
+        // A missing field is matched as a single EOO element.
+        group->matchesMissing = group->matchesMissing && cmp->matchesSingleElement(BSONElement());
+        group->predicates.push_back(Predicate(cmp));
+    }
+
+    size_t CompiledMatchExpression::numCompiled() const {
+        size_t count = 0;
+        for (size_t i = 0; i < _groups.size(); ++i) {
+            count += _groups[i].predicates.size();
+        }
+        return count;
+    }
+
+    // static
+    bool CompiledMatchExpression::matchesElement(const Predicate& pred, const BSONElement& elt) {
+        int cmp;
+        switch (pred.kind) {
+        case kLong:
+            if (NumberInt != elt.type() && NumberLong != elt.type()) {
+                return pred.expr->matchesSingleElement(elt);
+            }
+            cmp = compareLongLongs(elt.numberLong(), pred.longValue);
+            break;
+        case kDouble:
+            if (NumberDouble != elt.type() || std::isnan(elt.numberDouble())) {
+                return pred.expr->matchesSingleElement(elt);
+            }
+            cmp = compareDoubles(elt.numberDouble(), pred.doubleValue);
+            break;
+        case kString:
+            if (String != elt.type()) {
+                return pred.expr->matchesSingleElement(elt);
+            }
+            cmp = StringData(elt.valuestr(), elt.valuestrsize() - 1).compare(pred.stringValue);
+            break;
+        case kOID:
+            if (jstOID != elt.type()) {
+                return pred.expr->matchesSingleElement(elt);
+            }
+            cmp = memcmp(elt.value(), pred.oidValue, OID::kOIDSize);
+            break;
+        default:
+            return pred.expr->matchesSingleElement(elt);
+        }
+        return resultFromCompare(pred.type, cmp);
+    }
+
+    bool CompiledMatchExpression::matchesBSON(const BSONObj& doc) const {
+        unsigned long long seen = 0;
+        size_t numSeen = 0;
+
+        BSONObjIterator it(doc);
+        while (numSeen < _groups.size() && it.more()) {
+            const BSONElement elt = it.next();
+            const StringData name = elt.fieldNameStringData();
+
+            size_t i = 0;
+            while (i < _groups.size() && _groups[i].field < name) {
+                ++i;
+            }
+            if (i == _groups.size() || _groups[i].field != name) {
+                continue;
+            }
+
+            // Like BSONObj::getField(), only the first of several same-named fields counts.
+            const unsigned long long bit = 1ULL << i;
+            if (seen & bit) {
+                continue;
+            }
+            seen |= bit;
+            ++numSeen;
+
+            const vector<Predicate>& predicates = _groups[i].predicates;
+            for (size_t j = 0; j < predicates.size(); ++j) {
+                if (Array == elt.type()) {
+                    // Let the leaf walk the array for us.
+                    if (!predicates[j].expr->matchesBSON(doc)) {
+                        return false;
+                    }
+                }
+                else if (!matchesElement(predicates[j], elt)) {
+                    return false;
+                }
+            }
+        }
+
+        if (numSeen < _groups.size()) {
+            for (size_t i = 0; i < _groups.size(); ++i) {
+                if (!(seen & (1ULL << i)) && !_groups[i].matchesMissing) {
+                    return false;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < _residual.size(); ++i) {
+            if (!_residual[i]->matchesBSON(doc)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+}  // namespace mongo
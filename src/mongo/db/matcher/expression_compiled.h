@@ -0,0 +1,130 @@
+// expression_compiled.h
+
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+    class ComparisonMatchExpression;
+
+    /**
+     * A flat evaluation program for a MatchExpression over BSON documents.
+     *
+     * The conjuncts of the expression that compare a top-level field with a constant are grouped
+     * by field, so a document is checked against all of them in a single pass over its top-level
+     * elements.  Comparisons against numbers, strings and ObjectIds are specialized for elements
+     * of the same type; any other element, including arrays, goes through the leaf's own matching.
+     * The remaining conjuncts are matched through the tree once the compiled ones pass.
+     *
+     * Holds pointers into the MatchExpression it was compiled from, which must outlive it.
+     */
+    class CompiledMatchExpression {
+        MONGO_DISALLOW_COPYING(CompiledMatchExpression);
+    public:
+        /**
+         * Returns NULL if no part of 'expr' could be compiled, in which case callers should just
+         * use 'expr'.  Otherwise the caller owns the result.
+         */
+        static CompiledMatchExpression* compile(const MatchExpression* expr);
+
+        /**
+         * Equivalent to expr->matchesBSON(doc) for the 'expr' this was compiled from.
+         */
+        bool matchesBSON(const BSONObj& doc) const;
+
+        /**
+         * The number of conjuncts evaluated by the program, and the number left to the tree.
+         */
+        size_t numCompiled() const;
+        size_t numResidual() const { return _residual.size(); }
+
+    private:
+        // How a comparison's constant has been specialized.
+        enum ConstantKind {
+            kGeneric,
+            kLong,
+            kDouble,
+            kString,
+            kOID,
+        };
+
+        struct Predicate {
+            explicit Predicate(const ComparisonMatchExpression* expr);
+
+            const ComparisonMatchExpression* expr;
+            MatchExpression::MatchType type;
+            ConstantKind kind;
+            long long longValue;
+            double doubleValue;
+            StringData stringValue;
+            const char* oidValue;
+        };
+
+        struct FieldGroup {
+            // Points into the paths of the predicates.
+            StringData field;
+
+            // Whether every predicate accepts a document missing 'field'.  Computed once, since a
+            // missing field is matched as an EOO element no matter what the document holds.
+            bool matchesMissing;
+
+            std::vector<Predicate> predicates;
+        };
+
+        // At most this many fields are grouped, so that one word tracks the fields seen.
+        static const size_t kMaxFieldGroups = 64;
+
+        CompiledMatchExpression() { }
+
+        /**
+         * Adds the conjuncts of 'expr' to the program, flattening nested ANDs.
+         */
+        void addConjuncts(const MatchExpression* expr);
+
+        static bool canCompile(const MatchExpression* expr);
+
+        static bool matchesElement(const Predicate& pred, const BSONElement& elt);
+
+        // Sorted by field.
+        std::vector<FieldGroup> _groups;
+
+        // Not owned.
+        std::vector<const MatchExpression*> _residual;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,172 @@
+// expression_compiled_test.cpp
+
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/unittest/unittest.h"
+
+#include <memory>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_compiled.h"
+#include "mongo/db/matcher/expression_parser.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::unique_ptr;
+
+namespace {
+
+    /**
+     * Parses and compiles 'query', keeping the BSONObj alive as long as the expressions.
+     */
+    class CompiledQuery {
+    public:
+        explicit CompiledQuery(const string& query) : _obj(fromjson(query)) {
+            StatusWithMatchExpression result = MatchExpressionParser::parse(_obj);
+            ASSERT_OK(result.getStatus());
+            _expr.reset(result.getValue());
+            _compiled.reset(CompiledMatchExpression::compile(_expr.get()));
+        }
+
+        const CompiledMatchExpression* compiled() const { return _compiled.get(); }
+
+        /**
+         * Checks that the program and the tree agree on 'doc', returning the result.
+         */
+        bool matches(const string& doc) const {
+            ASSERT(_compiled);
+            BSONObj obj = fromjson(doc);
+            const bool expected = _expr->matchesBSON(obj);
+            ASSERT_EQUALS(expected, _compiled->matchesBSON(obj));
+            return expected;
+        }
+
+    private:
+        const BSONObj _obj;
+        unique_ptr<MatchExpression> _expr;
+        unique_ptr<CompiledMatchExpression> _compiled;
+    };
+
+    TEST(CompiledMatchExpressionTest, NothingToCompile) {
+        CompiledQuery empty("{}");
+        ASSERT(NULL == empty.compiled());
+
+        CompiledQuery dotted("{'a.b': 1}");
+        ASSERT(NULL == dotted.compiled());
+
+        CompiledQuery orQuery("{$or: [{a: 1}, {b: 1}]}");
+        ASSERT(NULL == orQuery.compiled());
+    }
+
+    TEST(CompiledMatchExpressionTest, GroupsByField) {
+        CompiledQuery query("{a: {$gt: 1, $lt: 10}, b: 'x', c: {$gte: 2.5}}");
+        ASSERT_EQUALS(4U, query.compiled()->numCompiled());
+        ASSERT_EQUALS(0U, query.compiled()->numResidual());
+
+        ASSERT_TRUE(query.matches("{a: 5, b: 'x', c: 3}"));
+        ASSERT_TRUE(query.matches("{c: 3, b: 'x', a: 5}"));
+        ASSERT_FALSE(query.matches("{a: 1, b: 'x', c: 3}"));
+        ASSERT_FALSE(query.matches("{a: 5, b: 'y', c: 3}"));
+        ASSERT_FALSE(query.matches("{a: 5, b: 'x', c: 2}"));
+        ASSERT_FALSE(query.matches("{a: 5, b: 'x'}"));
+    }
+
+    TEST(CompiledMatchExpressionTest, ResidualConjuncts) {
+        CompiledQuery query("{a: 1, 'b.c': 2, d: {$exists: true}}");
+        ASSERT_EQUALS(1U, query.compiled()->numCompiled());
+        ASSERT_EQUALS(2U, query.compiled()->numResidual());
+
+        ASSERT_TRUE(query.matches("{a: 1, b: {c: 2}, d: null}"));
+        ASSERT_FALSE(query.matches("{a: 1, b: {c: 2}}"));
+        ASSERT_FALSE(query.matches("{a: 1, b: {c: 3}, d: 1}"));
+        ASSERT_FALSE(query.matches("{a: 2, b: {c: 2}, d: 1}"));
+    }
+
+    TEST(CompiledMatchExpressionTest, NumericTypes) {
+        CompiledQuery query("{a: {$gte: 3}}");
+        ASSERT_TRUE(query.matches("{a: 3}"));
+        ASSERT_TRUE(query.matches("{a: NumberLong(4)}"));
+        ASSERT_TRUE(query.matches("{a: 3.5}"));
+        ASSERT_FALSE(query.matches("{a: 2.5}"));
+        ASSERT_FALSE(query.matches("{a: NaN}"));
+        ASSERT_FALSE(query.matches("{a: '4'}"));
+        ASSERT_FALSE(query.matches("{a: null}"));
+
+        CompiledQuery nan("{a: NaN}");
+        ASSERT_TRUE(nan.matches("{a: NaN}"));
+        ASSERT_FALSE(nan.matches("{a: 1}"));
+    }
+
+    TEST(CompiledMatchExpressionTest, Strings) {
+        CompiledQuery query("{a: {$lt: 'abc'}}");
+        ASSERT_TRUE(query.matches("{a: 'ab'}"));
+        ASSERT_TRUE(query.matches("{a: 'abb'}"));
+        ASSERT_FALSE(query.matches("{a: 'abc'}"));
+        ASSERT_FALSE(query.matches("{a: 'abcd'}"));
+        ASSERT_FALSE(query.matches("{a: 1}"));
+    }
+
+    TEST(CompiledMatchExpressionTest, ObjectIds) {
+        CompiledQuery query("{_id: {$gt: ObjectId('000000000000000000000001')}}");
+        ASSERT_TRUE(query.matches("{_id: ObjectId('000000000000000000000002')}"));
+        ASSERT_FALSE(query.matches("{_id: ObjectId('000000000000000000000001')}"));
+        ASSERT_FALSE(query.matches("{_id: 5}"));
+    }
+
+    TEST(CompiledMatchExpressionTest, MissingFields) {
+        CompiledQuery null("{a: null, b: 1}");
+        ASSERT_TRUE(null.matches("{b: 1}"));
+        ASSERT_TRUE(null.matches("{a: null, b: 1}"));
+        ASSERT_FALSE(null.matches("{a: 1, b: 1}"));
+        ASSERT_FALSE(null.matches("{a: null}"));
+
+        CompiledQuery maxKey("{a: {$lt: {$maxKey: 1}}}");
+        ASSERT_TRUE(maxKey.matches("{}"));
+    }
+
+    TEST(CompiledMatchExpressionTest, Arrays) {
+        CompiledQuery query("{a: 2, b: [1, 2]}");
+        ASSERT_TRUE(query.matches("{a: [1, 2], b: [1, 2]}"));
+        ASSERT_TRUE(query.matches("{a: 2, b: [[1, 2], 3]}"));
+        ASSERT_FALSE(query.matches("{a: [1, 3], b: [1, 2]}"));
+        ASSERT_FALSE(query.matches("{a: 2, b: [2, 1]}"));
+    }
+
+    TEST(CompiledMatchExpressionTest, DuplicateFieldNames) {
+        CompiledQuery query("{a: 1}");
+        ASSERT_TRUE(query.matches("{a: 1, a: 2}"));
+        ASSERT_FALSE(query.matches("{a: 2, a: 1}"));
+    }
+
+}  // namespace
+}  // namespace mongo
@@ -124,6 +124,8 @@ namespace mongo {
         if ( !_func )
             return Status( ErrorCodes::BadValue, "$where compile error" );
 
+        _scope->setBoolean( "fullObject" , true ); // this is a hack b/c fullObject used to be relevant
+
         return Status::OK();
     }
 
@@ -135,10 +137,8 @@ namespace mongo {
             _scope->init( &_userScope );
         }
 
-        _scope->setObject( "obj", const_cast< BSONObj & >( obj ) );
-        _scope->setBoolean( "fullObject" , true ); // this is a hack b/c fullObject used to be relevant
-
-        int err = _scope->invoke( _func, 0, &obj, 1000 * 60, false );
+        bool result = false;
+        int err = _scope->invokePredicate( _func, obj, 1000 * 60, &result );
         if ( err == -3 ) { // INVOKE_ERROR
             stringstream ss;
             ss << "error on invocation of $where function:\n"
@@ -149,7 +149,7 @@ namespace mongo {
             uassert( 16813, "unknown error in invocation of $where function", false);
         }
 
-        return _scope->getBoolean( "__returnValue" ) != 0;
+        return result;
     }
 
     void WhereMatchExpression::debugString( StringBuilder& debug, int level ) const {
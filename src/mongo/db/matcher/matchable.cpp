@@ -35,7 +35,7 @@
 namespace mongo {
 
     BSONMatchableDocument::BSONMatchableDocument( const BSONObj& obj )
-        : _obj( obj ) {
+        : _obj( obj ), _fieldIndex( _obj ) {
         _iteratorUsed = false;
     }
 
@@ -82,9 +82,9 @@ namespace mongo {
 
         virtual ElementIterator* allocateIterator( const ElementPath* path ) const {
             if ( _iteratorUsed )
-                return new BSONElementIterator( path, _obj );
+                return new BSONElementIterator( path, _obj, &_fieldIndex );
             _iteratorUsed = true;
-            _iterator.reset( path, _obj );
+            _iterator.reset( path, _obj, &_fieldIndex );
             return &_iterator;
         }
 
@@ -99,6 +99,11 @@ namespace mongo {
 
     private:
         BSONObj _obj;
+
+        // Shared by the iterators of all the leaves of an expression matched against _obj, so
+        // that wide documents get their top level fields indexed once.
+        BSONFieldIndex _fieldIndex;
+
         mutable BSONElementIterator _iterator;
         mutable bool _iteratorUsed;
     };
@@ -56,6 +56,8 @@ namespace mongo {
 
         const BSONObj* getQuery() const { return &_pattern; };
 
+        const MatchExpression* getMatchExpression() const { return _expression.get(); }
+
         std::string toString() const { return _pattern.toString(); }
 
     private:
@@ -88,10 +88,13 @@ namespace mongo {
     // ------
     BSONElementIterator::BSONElementIterator() {
         _path = NULL;
+        _contextIndex = NULL;
     }
 
-    BSONElementIterator::BSONElementIterator( const ElementPath* path, const BSONObj& context )
-        : _path( path ), _context( context ) {
+    BSONElementIterator::BSONElementIterator( const ElementPath* path,
+                                              const BSONObj& context,
+                                              const BSONFieldIndex* contextIndex )
+        : _path( path ), _context( context ), _contextIndex( contextIndex ) {
         _state = BEGIN;
         //log() << "path: " << path.fieldRef().dottedField() << " context: " << context << endl;
     }
@@ -99,9 +102,12 @@ namespace mongo {
     BSONElementIterator::~BSONElementIterator() {
     }
 
-    void BSONElementIterator::reset( const ElementPath* path, const BSONObj& context ) {
+    void BSONElementIterator::reset( const ElementPath* path,
+                                     const BSONObj& context,
+                                     const BSONFieldIndex* contextIndex ) {
         _path = path;
         _context = context;
+        _contextIndex = contextIndex;
         _state = BEGIN;
         _next.reset();
 
@@ -200,7 +206,8 @@ namespace mongo {
 
         if ( _state == BEGIN ) {
             size_t idxPath = 0;
-            BSONElement e = getFieldDottedOrArray( _context, _path->fieldRef(), &idxPath );
+            BSONElement e = getFieldDottedOrArray( _context, _path->fieldRef(), &idxPath,
+                                                   _contextIndex );
 
             if ( e.type() != Array ) {
                 _next.reset( e, BSONElement(), false );
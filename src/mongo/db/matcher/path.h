@@ -33,6 +33,7 @@
 
 #include "mongo/base/status.h"
 #include "mongo/base/string_data.h"
+#include "mongo/bson/bson_field_index.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/field_ref.h"
 
@@ -117,11 +118,19 @@ namespace mongo {
     class BSONElementIterator : public ElementIterator {
     public:
         BSONElementIterator();
-        BSONElementIterator( const ElementPath* path, const BSONObj& context );
+        /**
+         * If not NULL, 'contextIndex' must index 'context' and is used to look up the first part
+         * of the path.
+         */
+        BSONElementIterator( const ElementPath* path,
+                             const BSONObj& context,
+                             const BSONFieldIndex* contextIndex = NULL );
 
         virtual ~BSONElementIterator();
 
-        void reset( const ElementPath* path, const BSONObj& context );
+        void reset( const ElementPath* path,
+                    const BSONObj& context,
+                    const BSONFieldIndex* contextIndex = NULL );
 
         bool more();
         Context next();
@@ -135,6 +144,7 @@ namespace mongo {
 
         const ElementPath* _path;
         BSONObj _context;
+        const BSONFieldIndex* _contextIndex;
 
         enum State { BEGIN, IN_ARRAY, DONE } _state;
         Context _next;
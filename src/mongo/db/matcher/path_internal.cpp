@@ -42,9 +42,10 @@ namespace mongo {
 
     BSONElement getFieldDottedOrArray( const BSONObj& doc,
                                        const FieldRef& path,
-                                       size_t* idxPath ) {
+                                       size_t* idxPath,
+                                       const BSONFieldIndex* docIndex ) {
         if ( path.numParts() == 0 )
-            return doc.getField( "" );
+            return docIndex ? docIndex->getField( "" ) : doc.getField( "" );
 
         BSONElement res;
 
@@ -53,7 +54,10 @@ namespace mongo {
         size_t partNum = 0;
         while ( partNum < path.numParts() && !stop ) {
 
-            res = curr.getField( path.getPart( partNum ) );
+            if ( partNum == 0 && docIndex )
+                res = docIndex->getField( path.getPart( partNum ) );
+            else
+                res = curr.getField( path.getPart( partNum ) );
 
             switch ( res.type() ) {
 
@@ -31,6 +31,7 @@
 #pragma once
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/bson_field_index.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/cstdint.h"
@@ -41,8 +42,10 @@ namespace mongo {
 
     // XXX document me
     // Replaces getFieldDottedOrArray without recursion nor std::string manipulation
+    // If not NULL, 'docIndex' must index 'doc' and is used to find the first part of 'path'.
     BSONElement getFieldDottedOrArray( const BSONObj& doc,
                                        const FieldRef& path,
-                                       size_t* idxPath );
+                                       size_t* idxPath,
+                                       const BSONFieldIndex* docIndex = NULL );
 
 }  // namespace mongo
@@ -0,0 +1,312 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/online_compaction.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/base/counter.h"
+#include "mongo/base/status_with.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/fsync.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/progress_meter.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    using std::list;
+    using std::set;
+    using std::string;
+    using std::vector;
+
+    Counter64 onlineCompactionPasses;
+    Counter64 onlineCompactionCollections;
+    Counter64 onlineCompactionBytesFreed;
+
+    ServerStatusMetricField<Counter64> onlineCompactionPassesDisplay(
+        "onlineCompaction.passes", &onlineCompactionPasses);
+    ServerStatusMetricField<Counter64> onlineCompactionCollectionsDisplay(
+        "onlineCompaction.collectionsCompacted", &onlineCompactionCollections);
+    ServerStatusMetricField<Counter64> onlineCompactionBytesFreedDisplay(
+        "onlineCompaction.bytesFreed", &onlineCompactionBytesFreed);
+
+    MONGO_EXPORT_SERVER_PARAMETER( onlineCompactionMonitorEnabled, bool, false );
+    MONGO_EXPORT_SERVER_PARAMETER( onlineCompactionMonitorSleepSecs, int, 60 );
+
+    // The monitor compacts a collection once at least this fraction of its storage, and at least
+    // onlineCompactionMinFreeBytes, is free space.
+    MONGO_EXPORT_SERVER_PARAMETER( onlineCompactionFreeRatio, double, 0.5 );
+    MONGO_EXPORT_SERVER_PARAMETER( onlineCompactionMinFreeBytes, long long, 64 * 1024 * 1024 );
+
+    // The time slices and rate limit of the compactions the monitor runs.
+    MONGO_EXPORT_SERVER_PARAMETER( onlineCompactionTimeSliceSecs, int, 5 );
+    MONGO_EXPORT_SERVER_PARAMETER( onlineCompactionMaxBytesPerSecond, long long,
+                                   16 * 1024 * 1024 );
+
+namespace {
+
+    // Sleeps with no locks held, waking up now and then to notice killOp and shutdown.
+    void sleepInterruptibly(OperationContext* txn, long long millis) {
+        const long long kCheckIntervalMillis = 100;
+        while (millis > 0) {
+            txn->checkForInterrupt();
+            const long long step = std::min(millis, kCheckIntervalMillis);
+            sleepmillis(step);
+            millis -= step;
+        }
+    }
+
+    class OnlineCompactionMonitor : public BackgroundJob {
+    public:
+        OnlineCompactionMonitor() : BackgroundJob(true /* selfDelete */) {}
+
+        virtual string name() const { return "OnlineCompactionMonitor"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            while (!inShutdown()) {
+                sleepsecs(onlineCompactionMonitorSleepSecs);
+
+                if (!onlineCompactionMonitorEnabled) {
+                    continue;
+                }
+
+                if (lockedForWriting()) {
+                    LOG(3) << "online compaction skipped, locked for writing";
+                    continue;
+                }
+
+                try {
+                    doPass();
+                }
+                catch (const DBException& e) {
+                    if (inShutdown()) {
+                        return;
+                    }
+                    warning() << "online compaction pass failed: " << e.toString();
+                }
+            }
+        }
+
+    private:
+        void doPass() {
+            OperationContextImpl txn;
+
+            set<string> dbs;
+            dbHolder().getAllShortNames(dbs);
+
+            onlineCompactionPasses.increment();
+
+            for (set<string>::const_iterator i = dbs.begin(); i != dbs.end(); ++i) {
+                vector<NamespaceString> candidates;
+                getCandidates(&txn, *i, &candidates);
+
+                for (size_t j = 0; j < candidates.size(); ++j) {
+                    if (inShutdown() || !onlineCompactionMonitorEnabled) {
+                        return;
+                    }
+
+                    const NamespaceString& ns = candidates[j];
+                    CompactOptions options;
+                    options.online = true;
+                    options.timeSliceSecs = std::max(onlineCompactionTimeSliceSecs, 1);
+
+                    log() << "online compaction of " << ns << " begin, options: "
+                          << options.toString();
+                    StatusWith<CompactStats> status =
+                        compactCollectionOnline(&txn, ns, options,
+                                                onlineCompactionMaxBytesPerSecond);
+                    if (!status.isOK()) {
+                        warning() << "online compaction of " << ns << " failed: "
+                                  << status.getStatus();
+                        continue;
+                    }
+
+                    onlineCompactionCollections.increment();
+                    log() << "online compaction of " << ns << " end, freed "
+                          << status.getValue().bytesFreed << " bytes";
+                }
+            }
+        }
+
+        /**
+         * Appends to 'candidates' the collections of 'dbName' whose free space passes the
+         * onlineCompactionFreeRatio and onlineCompactionMinFreeBytes thresholds.
+         */
+        void getCandidates(OperationContext* txn,
+                           const string& dbName,
+                           vector<NamespaceString>* candidates) {
+            ScopedTransaction transaction(txn, MODE_IS);
+            Lock::DBLock dbLock(txn->lockState(), dbName, MODE_IS);
+
+            Database* db = dbHolder().get(txn, dbName);
+            if (!db) {
+                return;
+            }
+
+            list<string> namespaces;
+            db->getDatabaseCatalogEntry()->getCollectionNamespaces(&namespaces);
+
+            for (list<string>::const_iterator it = namespaces.begin();
+                 it != namespaces.end(); ++it) {
+
+                const NamespaceString ns(*it);
+                if (!ns.isNormal() || ns.isSystem()) {
+                    continue;
+                }
+
+                Lock::CollectionLock collLock(txn->lockState(), ns.ns(), MODE_IS);
+                Collection* collection = db->getCollection(ns);
+                if (!collection || collection->isCapped()) {
+                    continue;
+                }
+
+                RecordStore* rs = collection->getRecordStore();
+                if (!rs->compactSupported() || !rs->compactsInPlace() || !rs->compactsOnline()) {
+                    continue;
+                }
+
+                const int64_t freeBytes = rs->freeStorageSize(txn);
+                const int64_t storageBytes = rs->storageSize(txn);
+                if (freeBytes >= onlineCompactionMinFreeBytes &&
+                    freeBytes >= onlineCompactionFreeRatio * storageBytes) {
+                    LOG(1) << "online compaction candidate " << ns << ": " << freeBytes
+                           << " of " << storageBytes << " bytes free";
+                    candidates->push_back(ns);
+                }
+            }
+        }
+    };
+
+} // namespace
+
+    StatusWith<CompactStats> compactCollectionOnline(OperationContext* txn,
+                                                     const NamespaceString& ns,
+                                                     const CompactOptions& options,
+                                                     long long maxBytesPerSecond) {
+        invariant(options.online);
+
+        stdx::unique_lock<Client> lk(*txn->getClient());
+        ProgressMeterHolder progress(*txn->setMessage_inlock("compact (online)",
+                                                             "Compact Progress (bytes freed)"));
+        lk.unlock();
+
+        CompactStats total;
+        Timer throttleTimer;
+        for (int slice = 0; ; ++slice) {
+            // Stay under the rate limit with no locks held, so the reads and writes we let
+            // through while sleeping aren't held up.
+            if (maxBytesPerSecond > 0) {
+                const long long dueMillis = total.bytesFreed * 1000 / maxBytesPerSecond;
+                const long long elapsedMillis = throttleTimer.millis();
+                if (dueMillis > elapsedMillis) {
+                    sleepInterruptibly(txn, dueMillis - elapsedMillis);
+                }
+            }
+
+            txn->checkForInterrupt();
+
+            CompactStats stats;
+            {
+                ScopedTransaction transaction(txn, MODE_IX);
+                AutoGetDb autoDb(txn, ns.db(), MODE_IX);
+                Lock::CollectionLock collLock(txn->lockState(), ns.ns(), MODE_IX);
+
+                Database* const db = autoDb.getDb();
+                Collection* const collection = db ? db->getCollection(ns) : NULL;
+                if (!collection) {
+                    if (slice == 0) {
+                        return StatusWith<CompactStats>(ErrorCodes::NamespaceNotFound,
+                                                        "namespace does not exist");
+                    }
+                    // Dropped between slices, so there is nothing left to compact.
+                    break;
+                }
+
+                if (slice == 0) {
+                    progress->setTotalWhileRunning(
+                        collection->getRecordStore()->freeStorageSize(txn));
+                }
+
+                StatusWith<CompactStats> status = collection->compact(txn, &options);
+                if (!status.isOK()) {
+                    return status;
+                }
+                stats = status.getValue();
+            }
+
+            total.corruptDocuments += stats.corruptDocuments;
+            total.bytesFreed += stats.bytesFreed;
+            onlineCompactionBytesFreed.increment(stats.bytesFreed);
+            progress.hit(static_cast<int>(
+                std::min(stats.bytesFreed,
+                         static_cast<long long>(std::numeric_limits<int>::max()))));
+
+            LOG(1) << "online compaction of " << ns << " slice " << slice << " freed "
+                   << stats.bytesFreed << " bytes" << (stats.finished ? ", done" : "");
+
+            if (stats.finished) {
+                break;
+            }
+        }
+
+        progress.finished();
+        return StatusWith<CompactStats>(total);
+    }
+
+    void startOnlineCompactionBackgroundJob() {
+        (new OnlineCompactionMonitor())->go();
+    }
+
+} // namespace mongo
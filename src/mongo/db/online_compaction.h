@@ -0,0 +1,59 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+namespace mongo {
+
+    class NamespaceString;
+    class OperationContext;
+    struct CompactOptions;
+    struct CompactStats;
+    template <typename T> class StatusWith;
+
+    /**
+     * Compacts the collection 'ns' one time slice of options.timeSliceSecs at a time, holding only
+     * intent locks, so that its reads and writes carry on meanwhile. The locks are released
+     * between slices, and if 'maxBytesPerSecond' is set the compaction sleeps there for as long
+     * as it takes to give back no more than that many bytes a second, which bounds the I/O of
+     * moving them. Progress, in bytes freed, shows in currentOp.
+     *
+     * The storage engine must support online compaction (RecordStore::compactsOnline()).
+     */
+    StatusWith<CompactStats> compactCollectionOnline(OperationContext* txn,
+                                                     const NamespaceString& ns,
+                                                     const CompactOptions& options,
+                                                     long long maxBytesPerSecond);
+
+    /**
+     * Starts the thread that compacts collections online once enough of their storage is free
+     * space. It does nothing until the onlineCompactionMonitorEnabled parameter is set.
+     */
+    void startOnlineCompactionBackgroundJob();
+
+} // namespace mongo
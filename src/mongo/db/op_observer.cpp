@@ -31,11 +31,16 @@
 #include "mongo/db/op_observer.h"
 
 #include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/commands/dbhash.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_result_cache.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/s/d_state.h"
@@ -43,6 +48,50 @@
 
 namespace mongo {
 
+namespace {
+
+    void invalidateQueryResultCache(OperationContext* txn, StringData ns) {
+        Database* db = dbHolder().get(txn, nsToDatabaseSubstring(ns));
+        Collection* collection = db ? db->getCollection(ns) : NULL;
+        QueryResultCache* cache = collection ? collection->infoCache()->getQueryResultCache()
+                                             : NULL;
+        if (cache) {
+            cache->invalidate();
+        }
+    }
+
+    /**
+     * Drops the cached query results of the collection once a write to it commits, as queries
+     * running concurrently may have read and cached the old documents until then.
+     */
+    class QueryResultCacheInvalidator : public RecoveryUnit::Change {
+    public:
+        QueryResultCacheInvalidator(OperationContext* txn, StringData ns)
+            : _txn(txn), _ns(ns.toString()) { }
+
+        virtual void commit() { invalidateQueryResultCache(_txn, _ns); }
+        virtual void rollback() { }
+
+    private:
+        OperationContext* const _txn;
+        const std::string _ns;
+    };
+
+    void onQueryResultCacheWrite(OperationContext* txn, StringData ns) {
+        if (QueryResultCache::numCaches() == 0) {
+            return;
+        }
+
+        if (txn->lockState()->inAWriteUnitOfWork()) {
+            txn->recoveryUnit()->registerChange(new QueryResultCacheInvalidator(txn, ns));
+        }
+        else {
+            invalidateQueryResultCache(txn, ns);
+        }
+    }
+
+} // namespace
+
     void OpObserver::onCreateIndex(OperationContext* txn,
                                    const std::string& ns,
                                    BSONObj indexDoc,
@@ -63,6 +112,7 @@ namespace mongo {
         getGlobalAuthorizationManager()->logOp(txn, "i", ns.ns().c_str(), doc, nullptr);
         logOpForSharding(txn, "i", ns.ns().c_str(), doc, nullptr, fromMigrate);
         logOpForDbHash(txn, ns.ns().c_str());
+        onQueryResultCacheWrite(txn, ns.ns());
         if (strstr(ns.ns().c_str(), ".system.js")) {
             Scope::storedFuncMod(txn);
         }
@@ -79,6 +129,7 @@ namespace mongo {
                                                &args.criteria);
         logOpForSharding(txn, "u", args.ns.c_str(), args.update, &args.criteria, args.fromMigrate);
         logOpForDbHash(txn, args.ns.c_str());
+        onQueryResultCacheWrite(txn, args.ns);
         if (strstr(args.ns.c_str(), ".system.js")) {
             Scope::storedFuncMod(txn);
         }
@@ -93,6 +144,7 @@ namespace mongo {
         getGlobalAuthorizationManager()->logOp(txn, "d", ns.c_str(), idDoc, nullptr);
         logOpForSharding(txn, "d", ns.c_str(), idDoc, nullptr, fromMigrate);
         logOpForDbHash(txn, ns.c_str());
+        onQueryResultCacheWrite(txn, ns);
         if (strstr(ns.c_str(), ".system.js")) {
             Scope::storedFuncMod(txn);
         }
@@ -202,6 +254,7 @@ namespace mongo {
 
         getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
         logOpForDbHash(txn, dbName.c_str());
+        onQueryResultCacheWrite(txn, collectionName.ns());
     }
 
 } // namespace mongo
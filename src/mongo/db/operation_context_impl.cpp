@@ -54,6 +54,10 @@ namespace {
         return stdx::make_unique<DefaultLockerImpl>();
     }
 
+    /**
+     * The Locker and RecoveryUnit a Client reuses from one operation to the next, rather than
+     * allocating new ones for each operation.
+     */
     class ClientOperationInfo {
     public:
         Locker* getLocker() {
@@ -63,8 +67,24 @@ namespace {
             return _locker.get();
         }
 
+        RecoveryUnit* takeRecoveryUnit() {
+            if (_recoveryUnit) {
+                return _recoveryUnit.release();
+            }
+
+            StorageEngine* storageEngine = getGlobalServiceContext()->getGlobalStorageEngine();
+            return storageEngine->newRecoveryUnit();
+        }
+
+        void recycleRecoveryUnit(std::unique_ptr<RecoveryUnit> recoveryUnit) {
+            if (!_recoveryUnit && recoveryUnit && recoveryUnit->prepareForReuse()) {
+                _recoveryUnit = std::move(recoveryUnit);
+            }
+        }
+
     private:
         std::unique_ptr<Locker> _locker;
+        std::unique_ptr<RecoveryUnit> _recoveryUnit;
     };
 
     const auto clientOperationInfoDecoration = Client::declareDecoration<ClientOperationInfo>();
@@ -80,8 +100,7 @@ namespace {
                            clientOperationInfoDecoration(cc()).getLocker()),
           _writesAreReplicated(true) {
 
-        StorageEngine* storageEngine = getGlobalServiceContext()->getGlobalStorageEngine();
-        _recovery.reset(storageEngine->newRecoveryUnit());
+        _recovery.reset(clientOperationInfoDecoration(cc()).takeRecoveryUnit());
 
         auto client = getClient();
         stdx::lock_guard<Client> lk(*client);
@@ -91,8 +110,11 @@ namespace {
     OperationContextImpl::~OperationContextImpl() {
         lockState()->assertEmptyAndReset();
         auto client = getClient();
-        stdx::lock_guard<Client> lk(*client);
-        client->resetOperationContext();
+        {
+            stdx::lock_guard<Client> lk(*client);
+            client->resetOperationContext();
+        }
+        clientOperationInfoDecoration(*client).recycleRecoveryUnit(std::move(_recovery));
     }
 
     RecoveryUnit* OperationContextImpl::recoveryUnit() const {
@@ -100,8 +122,10 @@ namespace {
     }
 
     RecoveryUnit* OperationContextImpl::releaseRecoveryUnit() {
-        if ( _recovery.get() )
+        if ( _recovery.get() ) {
             _recovery->beingReleasedFromOperationContext();
+            _releasedStorageStats = _recovery->getStorageStats();
+        }
         return _recovery.release();
     }
 
@@ -110,8 +134,12 @@ namespace {
         _recovery.reset(unit);
         RecoveryUnitState oldState = _ruState;
         _ruState = state;
-        if ( unit )
+        if ( unit ) {
+            // Keeps the counts growing over the operation as a whole, whichever RecoveryUnit
+            // did the work.
+            *unit->storageStats() = _releasedStorageStats;
             unit->beingSetOnOperationContext();
+        }
         return oldState;
     }
 
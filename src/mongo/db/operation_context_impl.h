@@ -66,6 +66,9 @@ namespace mongo {
     private:
         std::unique_ptr<RecoveryUnit> _recovery;
         bool _writesAreReplicated;
+
+        // The storage stats of the RecoveryUnit last released, for the one set in its place.
+        RecoveryUnit::StorageStats _releasedStorageStats;
     };
 
 }  // namespace mongo
@@ -46,6 +46,7 @@ namespace mongo {
             _fromMigrate(false),
             _isExplain(false),
             _returnDeleted(false),
+            _skipLocked(false),
             _yieldPolicy(PlanExecutor::YIELD_MANUAL) {}
 
         void setQuery(const BSONObj& query) { _query = query; }
@@ -56,6 +57,7 @@ namespace mongo {
         void setFromMigrate(bool fromMigrate = true) { _fromMigrate = fromMigrate; }
         void setExplain(bool isExplain = true) { _isExplain = isExplain; }
         void setReturnDeleted(bool returnDeleted = true) { _returnDeleted = returnDeleted; }
+        void setSkipLocked(bool skipLocked = true) { _skipLocked = skipLocked; }
         void setYieldPolicy(PlanExecutor::YieldPolicy yieldPolicy) { _yieldPolicy = yieldPolicy; }
 
         const NamespaceString& getNamespaceString() const { return _nsString; }
@@ -67,6 +69,7 @@ namespace mongo {
         bool isFromMigrate() const { return _fromMigrate; }
         bool isExplain() const { return _isExplain; }
         bool shouldReturnDeleted() const { return _returnDeleted; }
+        bool shouldSkipLocked() const { return _skipLocked; }
         PlanExecutor::YieldPolicy getYieldPolicy() const { return _yieldPolicy; }
 
         std::string toString() const;
@@ -81,6 +84,8 @@ namespace mongo {
         bool _fromMigrate;
         bool _isExplain;
         bool _returnDeleted;
+        // Whether a single delete passes over documents it gets a write conflict on.
+        bool _skipLocked;
         PlanExecutor::YieldPolicy _yieldPolicy;
     };
 
@@ -140,9 +140,53 @@ namespace mongo {
         // replacement.
         _replacementMode = false;
 
+        parseSimpleMods(updateExpr);
+
         return Status::OK();
     }
 
+    void UpdateDriver::parseSimpleMods(const BSONObj& updateExpr) {
+        BSONObjIterator outerIter(updateExpr);
+        while (outerIter.more()) {
+            BSONElement outerModElem = outerIter.next();
+            modifiertable::ModifierType modType = modifiertable::getType(outerModElem.fieldName());
+            if (modType != modifiertable::MOD_SET &&
+                modType != modifiertable::MOD_INC &&
+                modType != modifiertable::MOD_UNSET) {
+                _simpleMods.clear();
+                return;
+            }
+
+            BSONObjIterator innerIter(outerModElem.embeddedObject());
+            while (innerIter.more()) {
+                BSONElement innerModElem = innerIter.next();
+                StringData fieldName = innerModElem.fieldNameStringData();
+
+                // Objects and arrays may not be valid for storage, and other mods of the same
+                // field are conflicts, let update() deal with those.
+                bool simple = !fieldName.empty() &&
+                              fieldName[0] != '$' &&
+                              fieldName.find('.') == std::string::npos &&
+                              fieldName != "_id" &&
+                              !(modType == modifiertable::MOD_SET &&
+                                (innerModElem.type() == Object || innerModElem.type() == Array));
+                for (size_t i = 0; simple && i < _simpleMods.size(); ++i) {
+                    simple = _simpleMods[i].elem.fieldNameStringData() != fieldName;
+                }
+                if (!simple) {
+                    _simpleMods.clear();
+                    return;
+                }
+
+                SimpleMod mod;
+                mod.type = modType;
+                mod.elem = innerModElem;
+                mod.fieldRef.reset(new FieldRef(fieldName));
+                _simpleMods.push_back(std::move(mod));
+            }
+        }
+    }
+
     inline Status UpdateDriver::addAndParse(const modifiertable::ModifierType type,
                                             const BSONElement& elem) {
         if (elem.eoo()) {
@@ -325,6 +369,180 @@ namespace mongo {
         return Status::OK();
     }
 
+    bool UpdateDriver::updateSimple(const BSONObj& oldObj,
+                                    const vector<FieldRef*>* immutableFields,
+                                    bool inPlaceAllowed,
+                                    BSONObj* newObj,
+                                    mb::DamageVector* damages,
+                                    const char** damageSource,
+                                    BSONObj* logOpRec,
+                                    FieldRefSet* updatedFields,
+                                    bool* docWasModified) {
+        dassert(isSimpleUpdate());
+
+        // Find the fields of the mods, which must appear only once.
+        vector<BSONElement> oldElems(_simpleMods.size());
+        BSONObjIterator it(oldObj);
+        if (!it.more() || it.next().fieldNameStringData() != "_id") {
+            return false;
+        }
+        while (it.more()) {
+            BSONElement elem = it.next();
+            for (size_t i = 0; i < _simpleMods.size(); ++i) {
+                if (_simpleMods[i].elem.fieldNameStringData() != elem.fieldNameStringData())
+                    continue;
+                if (!oldElems[i].eoo())
+                    return false;
+                oldElems[i] = elem;
+            }
+        }
+
+        // Work out the new values, under the names of the fields, in the order of the mods.
+        // Unchanged fields are left out.
+        vector<bool> changed(_simpleMods.size(), false);
+        BSONObjBuilder valuesBuilder;
+        bool affectIndices = false;
+        bool inPlace = inPlaceAllowed;
+        for (size_t i = 0; i < _simpleMods.size(); ++i) {
+            const SimpleMod& mod = _simpleMods[i];
+            const BSONElement& oldElem = oldElems[i];
+            StringData fieldName = mod.elem.fieldNameStringData();
+
+            if (mod.type == modifiertable::MOD_SET) {
+                if (!oldElem.eoo() && oldElem.woCompare(mod.elem, false) == 0)
+                    continue;
+                valuesBuilder.append(mod.elem);
+                inPlace = inPlace && !oldElem.eoo() && oldElem.type() == mod.elem.type() &&
+                          oldElem.valuesize() == mod.elem.valuesize();
+            }
+            else if (mod.type == modifiertable::MOD_INC) {
+                SafeNum newValue(mod.elem);
+                if (!oldElem.eoo()) {
+                    if (!oldElem.isNumber())
+                        return false;
+                    const SafeNum oldValue(oldElem);
+                    newValue += oldValue;
+                    if (!newValue.isValid())
+                        return false;
+                    if (newValue.isIdentical(oldValue))
+                        continue;
+                }
+                newValue.appendTo(&valuesBuilder, fieldName);
+                inPlace = inPlace && !oldElem.eoo() && oldElem.type() == newValue.type();
+            }
+            else {
+                dassert(mod.type == modifiertable::MOD_UNSET);
+                if (oldElem.eoo())
+                    continue;
+                inPlace = false;
+            }
+
+            if (immutableFields) {
+                for (size_t j = 0; j < immutableFields->size(); ++j) {
+                    if ((*immutableFields)[j]->getPart(0) == fieldName)
+                        return false;
+                }
+            }
+
+            changed[i] = true;
+            affectIndices = affectIndices ||
+                            (_indexedFields && _indexedFields->mightBeIndexed(fieldName));
+        }
+
+        // Nothing can go wrong from here on.
+        _affectIndices = affectIndices;
+        _simpleValues = valuesBuilder.obj();
+        damages->clear();
+        bool modified = false;
+        for (size_t i = 0; i < _simpleMods.size(); ++i) {
+            updatedFields->insert(_simpleMods[i].fieldRef.get());
+            modified = modified || changed[i];
+        }
+        if (docWasModified)
+            *docWasModified = modified;
+
+        BSONObjIterator newValues(_simpleValues);
+        if (modified && inPlace && !affectIndices) {
+            // Overwrite the values of the fields, which keep their layout.
+            for (size_t i = 0; i < _simpleMods.size(); ++i) {
+                if (!changed[i])
+                    continue;
+                const BSONElement newValue = newValues.next();
+                mb::DamageEvent damage;
+                damage.sourceOffset = newValue.value() - _simpleValues.objdata();
+                damage.targetOffset = oldElems[i].value() - oldObj.objdata();
+                damage.size = newValue.valuesize();
+                damage.growth = 0;
+                damages->push_back(damage);
+            }
+            *damageSource = _simpleValues.objdata();
+        }
+        else if (modified) {
+            // Build the new document with the changed fields where they were, and the new ones
+            // at the end, as update() does.
+            BSONObjBuilder newBuilder(oldObj.objsize() + _simpleValues.objsize());
+            vector<BSONElement> valueOf(_simpleMods.size());
+            for (size_t i = 0; i < _simpleMods.size(); ++i) {
+                if (changed[i] && _simpleMods[i].type != modifiertable::MOD_UNSET)
+                    valueOf[i] = newValues.next();
+            }
+
+            BSONObjIterator oldIt(oldObj);
+            while (oldIt.more()) {
+                BSONElement elem = oldIt.next();
+                size_t i = 0;
+                while (i < _simpleMods.size() && !(changed[i] && oldElems[i].rawdata() ==
+                                                                 elem.rawdata())) {
+                    ++i;
+                }
+                if (i == _simpleMods.size())
+                    newBuilder.append(elem);
+                else if (!valueOf[i].eoo())
+                    newBuilder.append(valueOf[i]);
+            }
+            for (size_t i = 0; i < _simpleMods.size(); ++i) {
+                if (changed[i] && oldElems[i].eoo())
+                    newBuilder.append(valueOf[i]);
+            }
+            *newObj = newBuilder.obj();
+        }
+
+        if (_logOp && logOpRec) {
+            // The sections come in the order of the mods that first write to them, as with the
+            // LogBuilder of update().
+            BSONObjBuilder setBuilder;
+            BSONObjBuilder unsetBuilder;
+            bool setFirst = true;
+            bool anySet = false;
+            bool anyUnset = false;
+            BSONObjIterator logValues(_simpleValues);
+            for (size_t i = 0; i < _simpleMods.size(); ++i) {
+                if (!changed[i])
+                    continue;
+                if (_simpleMods[i].type == modifiertable::MOD_UNSET) {
+                    setFirst = setFirst && anySet;
+                    anyUnset = true;
+                    unsetBuilder.append(_simpleMods[i].elem.fieldNameStringData(), true);
+                }
+                else {
+                    anySet = true;
+                    setBuilder.append(logValues.next());
+                }
+            }
+
+            BSONObjBuilder logBuilder;
+            if (anySet && setFirst)
+                logBuilder.append("$set", setBuilder.obj());
+            if (anyUnset)
+                logBuilder.append("$unset", unsetBuilder.obj());
+            if (anySet && !setFirst)
+                logBuilder.append("$set", setBuilder.obj());
+            *logOpRec = logBuilder.obj();
+        }
+
+        return true;
+    }
+
     size_t UpdateDriver::numMods() const {
         return _mods.size();
     }
@@ -389,6 +607,7 @@ namespace mongo {
             delete *it;
         }
         _mods.clear();
+        _simpleMods.clear();
         _indexedFields = NULL;
         _replacementMode = false;
         _positional = false;
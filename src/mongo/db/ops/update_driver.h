@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -101,6 +102,36 @@ namespace mongo {
                       FieldRefSet* updatedFields = NULL,
                       bool* docWasModified = NULL);
 
+        /**
+         * Returns true if the mods are only $set's to values other than objects and arrays,
+         * $inc's and $unset's of distinct top-level fields other than _id, in which case
+         * updateSimple() may be used instead of update().
+         */
+        bool isSimpleUpdate() const {
+            return !_simpleMods.empty();
+        }
+
+        /**
+         * Applies the mods of a simple update to 'oldObj' in a single pass over it, without a
+         * mutable document. If 'inPlaceAllowed', no index is affected, and every changed value
+         * keeps its type and size, fills 'damages' with the bytes to change, taken from
+         * '*damageSource', which stays valid until the next call. Otherwise sets 'newObj'.
+         * Fills the other arguments as update() does.
+         *
+         * Returns false, having done nothing, if update() has to be used for 'oldObj' instead,
+         * for instance because _id isn't its first field, or a mod would fail, or change one of
+         * 'immutableFields', all of which update() and validation report properly.
+         */
+        bool updateSimple(const BSONObj& oldObj,
+                          const std::vector<FieldRef*>* immutableFields,
+                          bool inPlaceAllowed,
+                          BSONObj* newObj,
+                          mutablebson::DamageVector* damages,
+                          const char** damageSource,
+                          BSONObj* logOpRec,
+                          FieldRefSet* updatedFields,
+                          bool* docWasModified);
+
         //
         // Accessors
         //
@@ -142,6 +173,9 @@ namespace mongo {
         inline Status addAndParse(const modifiertable::ModifierType type,
                                   const BSONElement& elem);
 
+        /** Fills in '_simpleMods' if the mods parsed from 'updateExpr' make a simple update. */
+        void parseSimpleMods(const BSONObj& updateExpr);
+
         //
         // immutable properties after parsing
         //
@@ -152,6 +186,17 @@ namespace mongo {
         // Collection of update mod instances. Owned here.
         std::vector<ModifierInterface*> _mods;
 
+        // The mods again, in the same order, if they make a simple update. Empty otherwise.
+        struct SimpleMod {
+            modifiertable::ModifierType type;
+            BSONElement elem;
+            std::unique_ptr<FieldRef> fieldRef;
+        };
+        std::vector<SimpleMod> _simpleMods;
+
+        // Holds the new values written by the last call to updateSimple().
+        BSONObj _simpleValues;
+
         // What are the list of fields in the collection over which the update is going to be
         // applied that participate in indices?
         //
@@ -33,6 +33,7 @@
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/string_data.h"
+#include "mongo/bson/mutable/damage_vector.h"
 #include "mongo/bson/mutable/document.h"
 #include "mongo/bson/mutable/mutable_bson_test_utils.h"
 #include "mongo/db/field_ref.h"
@@ -46,10 +47,12 @@ namespace {
     using mongo::BSONElement;
     using mongo::BSONObjIterator;
     using mongo::FieldRef;
+    using mongo::FieldRefSet;
     using mongo::fromjson;
     using mongo::OwnedPointerVector;
     using mongo::UpdateIndexData;
     using mongo::mutablebson::Document;
+    using mongo::SharedBuffer;
     using mongo::StringData;
     using mongo::UpdateDriver;
     using mongoutils::str::stream;
@@ -125,6 +128,138 @@ namespace {
         ASSERT_FALSE(driver.isDocReplacement());
     }
 
+    TEST(Parse, SimpleUpdate) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        ASSERT_OK(driver.parse(fromjson("{$set:{a:1, b:'x'}, $inc:{c:1}, $unset:{d:1}}")));
+        ASSERT_TRUE(driver.isSimpleUpdate());
+
+        const char* notSimple[] = {"{$set:{'a.b':1}}",
+                                   "{$set:{'a.$':1}}",
+                                   "{$set:{a:{b:1}}}",
+                                   "{$set:{a:[1]}}",
+                                   "{$set:{_id:1}}",
+                                   "{$inc:{a:1}, $set:{a:1}}",
+                                   "{$push:{a:1}}",
+                                   "{$set:{a:1}, $mul:{b:2}}"};
+        for (const char* update : notSimple) {
+            UpdateDriver other(opts);
+            ASSERT_OK(other.parse(fromjson(update)));
+            ASSERT_FALSE(other.isSimpleUpdate());
+        }
+    }
+
+    //
+    // Tests that updateSimple() agrees with update()
+    //
+
+    /**
+     * Applies 'update' to 'doc' with updateSimple() and update(), and checks that they give the
+     * same document, oplog entry and updated fields. Returns whether it went in place.
+     */
+    bool assertSameAsUpdate(const char* update, const char* doc, bool inPlaceAllowed = true) {
+        const BSONObj updateObj = fromjson(update);
+        const BSONObj docObj = fromjson(doc);
+        UpdateDriver::Options opts;
+        opts.logOp = true;
+
+        UpdateDriver simple(opts);
+        ASSERT_OK(simple.parse(updateObj));
+        ASSERT_TRUE(simple.isSimpleUpdate());
+        BSONObj simpleObj = docObj;
+        mongo::mutablebson::DamageVector damages;
+        const char* source = NULL;
+        BSONObj simpleLog;
+        FieldRefSet simpleFields;
+        bool simpleModified = false;
+        ASSERT_TRUE(simple.updateSimple(docObj, NULL, inPlaceAllowed, &simpleObj, &damages,
+                                        &source, &simpleLog, &simpleFields, &simpleModified));
+        if (!damages.empty()) {
+            ASSERT_EQUALS(docObj, simpleObj);
+            ASSERT_FALSE(mongo::mutablebson::hasSplices(damages));
+            SharedBuffer data = SharedBuffer::allocate(docObj.objsize());
+            mongo::mutablebson::applyDamages(docObj.objdata(), docObj.objsize(), source,
+                                             damages, data.get());
+            simpleObj = BSONObj(data);
+        }
+
+        UpdateDriver driver(opts);
+        ASSERT_OK(driver.parse(updateObj));
+        Document mutableDoc(docObj);
+        BSONObj log;
+        FieldRefSet fields;
+        bool modified = false;
+        ASSERT_OK(driver.update(StringData(), &mutableDoc, &log, &fields, &modified));
+
+        ASSERT_EQUALS(mutableDoc.getObject(), simpleObj);
+        ASSERT_EQUALS(mutableDoc.getObject().toString(), simpleObj.toString());
+        ASSERT_EQUALS(log, simpleLog);
+        ASSERT_EQUALS(modified, simpleModified);
+        ASSERT_EQUALS(fields.toString(), simpleFields.toString());
+        return !damages.empty();
+    }
+
+    TEST(UpdateSimple, SameAsUpdate) {
+        ASSERT_TRUE(assertSameAsUpdate("{$inc:{a:1}}", "{_id:0, a:1, b:2}"));
+        ASSERT_TRUE(assertSameAsUpdate("{$inc:{a:1.5}}", "{_id:0, a:1.5}"));
+        ASSERT_TRUE(assertSameAsUpdate("{$set:{b:'y'}}", "{_id:0, a:1, b:'x', c:3}"));
+        ASSERT_TRUE(assertSameAsUpdate("{$set:{b:3}, $inc:{a:-1}}", "{_id:0, a:1, b:2}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$inc:{a:1}}", "{_id:0, a:1}", false));
+
+        // The layout changes
+        ASSERT_FALSE(assertSameAsUpdate("{$inc:{a:1.5}}", "{_id:0, a:1, b:2}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$inc:{a:NumberLong(1)}}", "{_id:0, a:1}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$set:{b:'yy'}}", "{_id:0, a:1, b:'x', c:3}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$set:{d:1}}", "{_id:0, a:1}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$inc:{d:1}, $set:{c:2}}", "{_id:0, a:1}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$unset:{a:1}}", "{_id:0, a:1, b:2}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$unset:{a:1}, $set:{c:1, b:3}}", "{_id:0, a:1, b:2}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$set:{b:3}, $unset:{a:1}}", "{_id:0, a:1, b:2}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$set:{a:'x'}}", "{_id:0, a:{b:1}}"));
+
+        // No-ops
+        ASSERT_FALSE(assertSameAsUpdate("{$set:{a:1}}", "{_id:0, a:1}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$set:{a:1}}", "{_id:0, a:1.0}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$inc:{a:0}}", "{_id:0, a:1}"));
+        ASSERT_FALSE(assertSameAsUpdate("{$unset:{b:1}}", "{_id:0, a:1}"));
+        ASSERT_TRUE(assertSameAsUpdate("{$unset:{b:1}, $inc:{a:1}}", "{_id:0, a:1}"));
+    }
+
+    TEST(UpdateSimple, LeavesOtherDocumentsToUpdate) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        ASSERT_OK(driver.parse(fromjson("{$inc:{a:1}}")));
+
+        const char* docs[] = {"{_id:0, a:'x'}",        // update() reports the error
+                              "{a:1, _id:0}",          // update() moves _id first
+                              "{a:1}",
+                              "{_id:0, a:1, a:2}",
+                              "{_id:0, a:2147483647}"};  // fine, but not in place
+        for (size_t i = 0; i < 4; ++i) {
+            BSONObj newObj;
+            mongo::mutablebson::DamageVector damages;
+            const char* source = NULL;
+            FieldRefSet fields;
+            bool modified = false;
+            ASSERT_FALSE(driver.updateSimple(fromjson(docs[i]), NULL, true, &newObj, &damages,
+                                             &source, NULL, &fields, &modified));
+            ASSERT_TRUE(newObj.isEmpty());
+            ASSERT_TRUE(fields.empty());
+        }
+        ASSERT_FALSE(assertSameAsUpdate("{$inc:{a:1}}", docs[4]));
+
+        OwnedPointerVector<FieldRef> immutablePaths;
+        immutablePaths.push_back(new FieldRef("a.b"));
+        BSONObj newObj;
+        mongo::mutablebson::DamageVector damages;
+        const char* source = NULL;
+        FieldRefSet fields;
+        bool modified = false;
+        ASSERT_FALSE(driver.updateSimple(fromjson("{_id:0, a:1}"), &immutablePaths.vector(),
+                                         true, &newObj, &damages, &source, NULL, &fields,
+                                         &modified));
+    }
+
     //
     // Tests of creating a base for an upsert from a query document
     // $or, $and, $all get special handling, as does the _id field
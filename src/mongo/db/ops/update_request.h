@@ -63,6 +63,7 @@ namespace mongo {
             , _lifecycle(NULL)
             , _isExplain(false)
             , _returnDocs(ReturnDocOption::RETURN_NONE)
+            , _skipLocked(false)
             , _yieldPolicy(PlanExecutor::YIELD_MANUAL) {}
 
         const NamespaceString& getNamespaceString() const {
@@ -168,6 +169,14 @@ namespace mongo {
             return shouldReturnOldDocs() || shouldReturnNewDocs();
         }
 
+        inline void setSkipLocked(bool value = true) {
+            _skipLocked = value;
+        }
+
+        inline bool shouldSkipLocked() const {
+            return _skipLocked;
+        }
+
         inline void setYieldPolicy(PlanExecutor::YieldPolicy yieldPolicy) {
             _yieldPolicy = yieldPolicy;
         }
@@ -239,6 +248,11 @@ namespace mongo {
         // without another query before or after the update.
         ReturnDocOption _returnDocs;
 
+        // True if a single update should pass over documents it gets a write conflict on, which
+        // another operation is modifying, rather than wait to retry them. Doesn't apply to
+        // upserts.
+        bool _skipLocked;
+
         // Whether or not the update should yield. Defaults to YIELD_MANUAL.
         PlanExecutor::YieldPolicy _yieldPolicy;
 
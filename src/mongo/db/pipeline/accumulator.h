@@ -35,7 +35,10 @@
 #include <vector>
 
 #include "mongo/bson/bsontypes.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/stdx/functional.h"
 
 namespace mongo {
     class Accumulator : public RefCountable {
@@ -57,6 +60,13 @@ namespace mongo {
         /// The name of the op as used in a serialization of the pipeline.
         virtual const char* getOpName() const = 0;
 
+        /** Serializes the op applied to 'argument', the serialization of its expression, as in
+         *  {$sum: "$a"}. Accumulators with options add them here.
+         */
+        virtual Document serialize(const Value& argument) const {
+            return DOC(getOpName() << argument);
+        }
+
         int memUsageForSorter() const {
             dassert(_memUsageBytes != 0); // This would mean subclass didn't set it
             return _memUsageBytes;
@@ -73,6 +83,9 @@ namespace mongo {
         int _memUsageBytes = 0;
     };
 
+    /// Makes a new accumulator for each group. See DocumentSourceGroup::addAccumulator.
+    typedef stdx::function<boost::intrusive_ptr<Accumulator>()> AccumulatorFactory;
+
 
     class AccumulatorAddToSet final : public Accumulator {
     public:
@@ -86,8 +99,12 @@ namespace mongo {
         static boost::intrusive_ptr<Accumulator> create();
 
     private:
+        /// Recomputes _memUsageBytes from _valueBytes and the size of the set.
+        void updateMemUsage();
+
         typedef boost::unordered_set<Value, Value::Hash> SetType;
         SetType set;
+        size_t _valueBytes; // memory the values in the set own outside of their nodes
     };
 
 
@@ -177,10 +194,61 @@ namespace mongo {
         static boost::intrusive_ptr<Accumulator> create();
 
     private:
+        void add(const Value& value);
+
         std::vector<Value> vpValue;
     };
 
 
+    /** $push with the $sort and $slice modifiers of the update $push, as in
+     *  {$push: "$$ROOT", $sort: {score: -1}, $slice: 10}. It keeps only the first 'slice' values
+     *  in the order of 'sort', in a heap, rather than buffering all of them. 'sort' is 1 or -1 to
+     *  sort the values themselves, or a document of field paths in them and 1 or -1, or missing
+     *  to keep the first values pushed. 'slice' is 0 for no cap.
+     */
+    class AccumulatorPushSorted final : public Accumulator {
+    public:
+        AccumulatorPushSorted(const Value& sort, long long slice);
+
+        void processInternal(const Value& input, bool merging) final;
+        Value getValue(bool toBeMerged) const final;
+        const char* getOpName() const final;
+        Document serialize(const Value& argument) const final;
+        void reset() final;
+
+        /** Returns a factory for $push with the modifiers 'sort' and 'slice', either of which may
+         *  be EOO. Throws if they are invalid.
+         */
+        static AccumulatorFactory parseModifiers(BSONElement sort, BSONElement slice);
+
+    private:
+        static boost::intrusive_ptr<Accumulator> create(const Value& sort, long long slice);
+
+        /// Less than 0 if 'lhs' comes first in the order of _sort.
+        int compare(const Value& lhs, const Value& rhs) const;
+
+        // For the heap, which has the value that comes last on top.
+        class Less {
+        public:
+            explicit Less(const AccumulatorPushSorted* push) : _push(push) {}
+            bool operator()(const Value& lhs, const Value& rhs) const {
+                return _push->compare(lhs, rhs) < 0;
+            }
+        private:
+            const AccumulatorPushSorted* _push;
+        };
+
+        void add(const Value& value);
+
+        const Value _sort;
+        const long long _slice;
+        std::vector<FieldPath> _sortPaths; // empty if sorting the values themselves
+        std::vector<int> _sortDirections;
+
+        std::vector<Value> _values; // a heap if _sort is set
+    };
+
+
     class AccumulatorAvg final : public Accumulator {
     public:
         AccumulatorAvg();
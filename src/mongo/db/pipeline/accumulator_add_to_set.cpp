@@ -42,7 +42,7 @@ namespace mongo {
             if (!input.missing()) {
                 bool inserted = set.insert(input).second;
                 if (inserted) {
-                    _memUsageBytes += input.getApproximateSize();
+                    _valueBytes += input.getApproximateSize() - sizeof(Value);
                 }
             }
         }
@@ -57,23 +57,34 @@ namespace mongo {
             for (size_t i=0; i < array.size(); i++) {
                 bool inserted = set.insert(array[i]).second;
                 if (inserted) {
-                    _memUsageBytes += array[i].getApproximateSize();
+                    _valueBytes += array[i].getApproximateSize() - sizeof(Value);
                 }
             }
         }
+
+        updateMemUsage();
+    }
+
+    void AccumulatorAddToSet::updateMemUsage() {
+        // Each node holds a Value, the link to the next node and the hash of the Value.
+        const size_t nodeBytes = sizeof(Value) + sizeof(void*) + sizeof(size_t);
+        _memUsageBytes = sizeof(*this) + set.size() * nodeBytes
+                                       + set.bucket_count() * sizeof(void*)
+                                       + _valueBytes;
     }
 
     Value AccumulatorAddToSet::getValue(bool toBeMerged) const {
         return Value(vector<Value>(set.begin(), set.end()));
     }
 
-    AccumulatorAddToSet::AccumulatorAddToSet() {
-        _memUsageBytes = sizeof(*this);
+    AccumulatorAddToSet::AccumulatorAddToSet() : _valueBytes(0) {
+        updateMemUsage();
     }
 
     void AccumulatorAddToSet::reset() {
         SetType().swap(set);
-        _memUsageBytes = sizeof(*this);
+        _valueBytes = 0;
+        updateMemUsage();
     }
 
     intrusive_ptr<Accumulator> AccumulatorAddToSet::create() {
@@ -28,9 +28,12 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -40,8 +43,7 @@ namespace mongo {
     void AccumulatorPush::processInternal(const Value& input, bool merging) {
         if (!merging) {
             if (!input.missing()) {
-                vpValue.push_back(input);
-                _memUsageBytes += input.getApproximateSize();
+                add(input);
             }
         }
         else {
@@ -52,14 +54,20 @@ namespace mongo {
             verify(input.getType() == Array);
             
             const vector<Value>& vec = input.getArray();
-            vpValue.insert(vpValue.end(), vec.begin(), vec.end());
-
             for (size_t i=0; i < vec.size(); i++) {
-                _memUsageBytes += vec[i].getApproximateSize();
+                add(vec[i]);
             }
         }
     }
 
+    void AccumulatorPush::add(const Value& value) {
+        // Count the growth of the vector as well as what the value owns outside of it.
+        const size_t oldCapacity = vpValue.capacity();
+        vpValue.push_back(value);
+        _memUsageBytes += (vpValue.capacity() - oldCapacity) * sizeof(Value)
+                        + value.getApproximateSize() - sizeof(Value);
+    }
+
     Value AccumulatorPush::getValue(bool toBeMerged) const {
         return Value(vpValue);
     }
@@ -80,4 +88,146 @@ namespace mongo {
     const char *AccumulatorPush::getOpName() const {
         return "$push";
     }
+
+    AccumulatorPushSorted::AccumulatorPushSorted(const Value& sort, long long slice)
+        : _sort(sort)
+        , _slice(slice) {
+        if (_sort.getType() == Object) {
+            FieldIterator fields(_sort.getDocument());
+            while (fields.more()) {
+                const Document::FieldPair field = fields.next();
+                _sortPaths.push_back(FieldPath(field.first.toString()));
+                _sortDirections.push_back(field.second.coerceToInt());
+            }
+        }
+        else if (!_sort.missing()) {
+            _sortDirections.push_back(_sort.coerceToInt());
+        }
+
+        _memUsageBytes = sizeof(*this);
+    }
+
+    void AccumulatorPushSorted::processInternal(const Value& input, bool merging) {
+        if (!merging) {
+            if (!input.missing()) {
+                add(input);
+            }
+        }
+        else {
+            // The arrays from merge sources are in order and capped, but may together hold more
+            // than _slice values.
+            verify(input.getType() == Array);
+
+            const vector<Value>& vec = input.getArray();
+            for (size_t i=0; i < vec.size(); i++) {
+                add(vec[i]);
+            }
+        }
+    }
+
+    void AccumulatorPushSorted::add(const Value& value) {
+        const bool full = _slice && _values.size() >= size_t(_slice);
+        if (full && (_sort.missing() || compare(value, _values.front()) >= 0)) {
+            // Without a $sort, the first values pushed are kept. With one, this value would be
+            // the one dropped from the heap.
+            return;
+        }
+
+        const size_t oldCapacity = _values.capacity();
+        _values.push_back(value);
+        _memUsageBytes += (_values.capacity() - oldCapacity) * sizeof(Value)
+                        + value.getApproximateSize() - sizeof(Value);
+
+        if (_sort.missing())
+            return;
+
+        std::push_heap(_values.begin(), _values.end(), Less(this));
+        if (full) {
+            std::pop_heap(_values.begin(), _values.end(), Less(this));
+            _memUsageBytes -= _values.back().getApproximateSize() - sizeof(Value);
+            _values.pop_back();
+        }
+    }
+
+    int AccumulatorPushSorted::compare(const Value& lhs, const Value& rhs) const {
+        if (_sortPaths.empty())
+            return Value::compare(lhs, rhs) * _sortDirections[0];
+
+        for (size_t i = 0; i < _sortPaths.size(); i++) {
+            // Like the update $push, this sorts values that aren't documents as if they were
+            // missing the fields.
+            const Value left = lhs.getType() == Object
+                             ? lhs.getDocument().getNestedField(_sortPaths[i])
+                             : Value();
+            const Value right = rhs.getType() == Object
+                              ? rhs.getDocument().getNestedField(_sortPaths[i])
+                              : Value();
+            const int cmp = Value::compare(left, right) * _sortDirections[i];
+            if (cmp)
+                return cmp;
+        }
+        return 0;
+    }
+
+    Value AccumulatorPushSorted::getValue(bool toBeMerged) const {
+        if (_sort.missing())
+            return Value(_values);
+
+        vector<Value> sorted(_values);
+        std::sort_heap(sorted.begin(), sorted.end(), Less(this));
+        return Value(std::move(sorted));
+    }
+
+    void AccumulatorPushSorted::reset() {
+        vector<Value>().swap(_values);
+        _memUsageBytes = sizeof(*this);
+    }
+
+    const char *AccumulatorPushSorted::getOpName() const {
+        return "$push";
+    }
+
+    Document AccumulatorPushSorted::serialize(const Value& argument) const {
+        MutableDocument out;
+        out.addField(getOpName(), argument);
+        if (!_sort.missing())
+            out.addField("$sort", _sort);
+        if (_slice)
+            out.addField("$slice", Value(_slice));
+        return out.freeze();
+    }
+
+    intrusive_ptr<Accumulator> AccumulatorPushSorted::create(const Value& sort, long long slice) {
+        return new AccumulatorPushSorted(sort, slice);
+    }
+
+    AccumulatorFactory AccumulatorPushSorted::parseModifiers(BSONElement sort,
+                                                             BSONElement slice) {
+        long long sliceCount = 0;
+        if (!slice.eoo()) {
+            uassert(28766, str::stream() << "$slice of $push must be a positive integer, not "
+                                         << slice.toString(false),
+                    slice.isNumber() && slice.numberLong() > 0
+                                     && slice.numberDouble() == double(slice.numberLong()));
+            sliceCount = slice.numberLong();
+        }
+
+        if (sort.type() == Object) {
+            uassert(28767, "$sort of $push must not be an empty document", !sort.Obj().isEmpty());
+            BSONForEach(field, sort.Obj()) {
+                uassert(28768, str::stream() << "the direction of '" << field.fieldName()
+                                             << "' in the $sort of $push must be 1 or -1",
+                        field.isNumber() && (field.number() == 1 || field.number() == -1));
+                FieldPath path (field.fieldName()); // throws if it isn't a valid path
+            }
+        }
+        else if (!sort.eoo()) {
+            uassert(28769, "the $sort of $push must be 1, -1 or a document of fields and 1 or -1",
+                    sort.isNumber() && (sort.number() == 1 || sort.number() == -1));
+        }
+
+        return stdx::bind(&AccumulatorPushSorted::create,
+                          sort.eoo() ? Value() : Value(sort),
+                          sliceCount);
+    }
 }
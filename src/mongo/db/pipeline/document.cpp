@@ -43,6 +43,11 @@ namespace mongo {
     using std::vector;
 
     Position DocumentStorage::findField(StringData requested) const {
+        if (MONGO_unlikely(_overlayBase))
+            return _overlayBase->findField(requested); // positions are the same
+
+        loadLazyBson();
+
         int reqSize = requested.size(); // get size calculation out of the way if needed
 
         if (_numFields >= HASH_TAB_MIN) { // hash lookup
@@ -74,7 +79,7 @@ namespace mongo {
     }
 
     Value& DocumentStorage::appendField(StringData name) {
-        Position pos = getNextPosition();
+        Position pos = getNextPosition(); // also converts the fields of a lazy storage
         const int nameSize = name.size();
 
         // these are the same for everyone
@@ -184,35 +189,99 @@ namespace mongo {
         _bufferEnd = _buffer + newSize;
     }
 
-    intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
-        intrusive_ptr<DocumentStorage> out (new DocumentStorage());
+    void DocumentStorage::setLazyBson(const BSONObj& bson) {
+        fassert(16492, !_buffer && !_lazy);
+        dassert(bson.isOwned());
+        _lazy = true;
+        _lazyBson = bson;
+    }
+
+    void DocumentStorage::loadLazyBsonSlow() {
+        const BSONObj bson = _lazyBson;
+        _lazy = false;
+        _lazyBson = BSONObj();
+
+        reserveFields(bson.nFields());
+        BSONObjIterator it(bson);
+        while (it.more()) {
+            BSONElement elem(it.next());
+            appendField(elem.fieldNameStringData()) = Value(elem);
+        }
+    }
+
+    void DocumentStorage::setOverlay(const DocumentStorage* base, Position pos, const Value& val) {
+        fassert(28764, !_buffer && !_lazy && !_overlayBase
+                       && !base->isLazy() && !base->isOverlay());
 
+        // The replaced field is the only one in our buffer, so getField(pos) can find it first.
+        reserveFields(1);
+        appendField(base->getField(pos).nameSD()) = val;
+        copyMetaDataFrom(*base);
+
+        _overlayBase = base;
+        _overlayPos = pos;
+    }
+
+    void DocumentStorage::flattenOverlaySlow() {
+        const intrusive_ptr<const DocumentStorage> base = _overlayBase;
+        const Position pos = _overlayPos;
+        const Value val = _firstElement->val;
+        _overlayBase.reset();
+
+        // Drop our single field, then take a copy of the base's.
+        _firstElement->val.~Value();
+        delete[] _buffer;
+        _buffer = NULL;
+        _bufferEnd = NULL;
+        _usedBytes = 0;
+        _numFields = 0;
+        _hashTabMask = 0;
+
+        copyFieldsFrom(*base);
+        getField(pos).val = val;
+    }
+
+    void DocumentStorage::copyFieldsFrom(const DocumentStorage& source) {
         // Make a copy of the buffer.
         // It is very important that the positions of each field are the same after cloning.
-        const size_t bufferBytes = (_bufferEnd + hashTabBytes()) - _buffer;
-        out->_buffer = new char[bufferBytes];
-        out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
-        memcpy(out->_buffer, _buffer, bufferBytes);
+        const size_t bufferBytes = (source._bufferEnd + source.hashTabBytes()) - source._buffer;
+        _buffer = new char[bufferBytes];
+        _bufferEnd = _buffer + (source._bufferEnd - source._buffer);
+        memcpy(_buffer, source._buffer, bufferBytes);
 
         // Copy remaining fields
-        out->_usedBytes = _usedBytes;
-        out->_numFields = _numFields;
-        out->_hashTabMask = _hashTabMask;
-        out->_hasTextScore = _hasTextScore;
-        out->_textScore = _textScore;
+        _usedBytes = source._usedBytes;
+        _numFields = source._numFields;
+        _hashTabMask = source._hashTabMask;
 
         // Tell values that they have been memcpyed (updates ref counts)
-        for (DocumentStorageIterator it = out->iteratorAll(); !it.atEnd(); it.advance()) {
+        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
             it->val.memcpyed();
         }
+    }
+
+    intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
+        intrusive_ptr<DocumentStorage> out (new DocumentStorage());
 
+        if (_overlayBase) {
+            out->copyFieldsFrom(*_overlayBase);
+            out->getField(_overlayPos).val = _firstElement->val;
+        }
+        else {
+            loadLazyBson();
+            out->copyFieldsFrom(*this);
+        }
+
+        out->_hasTextScore = _hasTextScore;
+        out->_textScore = _textScore;
         return out;
     }
 
     DocumentStorage::~DocumentStorage() {
         std::unique_ptr<char[]> deleteBufferAtScopeEnd (_buffer);
 
-        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
+        // Don't use iteratorAll(), which would convert the fields of a lazy storage.
+        for (DocumentStorageIterator it(_firstElement, end(), true); !it.atEnd(); it.advance()) {
             it->val.~Value(); // explicit destructor call
         }
     }
@@ -237,12 +306,21 @@ namespace mongo {
     }
 
     void Document::toBson(BSONObjBuilder* pBuilder) const {
+        if (storage().isLazy()) {
+            pBuilder->appendElements(storage().lazyBson());
+            return;
+        }
+
         for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
             *pBuilder << it->nameSD() << it->val;
         }
     }
 
     BSONObj Document::toBson() const {
+        // Lazy documents were never modified, so their original BSON is still an exact copy.
+        if (storage().isLazy())
+            return storage().lazyBson();
+
         BSONObjBuilder bb;
         toBson(&bb);
         return bb.obj();
@@ -278,6 +356,19 @@ namespace mongo {
         return md.freeze();
     }
 
+    Document Document::fromBsonWithMetaDataLazy(const BSONObj& bson) {
+        // Metadata fields have to be parsed out, so documents with any are converted up front.
+        BSONObjIterator it(bson);
+        while (it.more()) {
+            if (it.next().fieldName()[0] == '$')
+                return fromBsonWithMetaData(bson);
+        }
+
+        intrusive_ptr<DocumentStorage> storage(new DocumentStorage());
+        storage->setLazyBson(bson.getOwned());
+        return Document(storage.get());
+    }
+
     MutableDocument::MutableDocument(size_t expectedFields)
         : _storageHolder(NULL)
         , _storage(_storageHolder)
@@ -349,6 +440,34 @@ namespace mongo {
         return getNestedFieldHelper(*this, fieldNames, positions, 0);
     }
 
+    Document Document::overlayNestedField(const vector<Position>& positions,
+                                          const Value& val) const {
+        fassert(28765, !positions.empty());
+        return overlayNestedFieldHelper(positions, 0, val);
+    }
+
+    Document Document::overlayNestedFieldHelper(const vector<Position>& positions,
+                                                size_t level,
+                                                const Value& val) const {
+        const Position pos = positions[level];
+        const Value newVal = (level == positions.size()-1)
+                           ? val
+                           : Value(getField(pos).getDocument().overlayNestedFieldHelper(positions,
+                                                                                        level+1,
+                                                                                        val));
+
+        if (storage().isLazy() || storage().isOverlay()) {
+            // Overlays aren't stacked, so fall back to a copy.
+            MutableDocument md (*this);
+            md.setField(pos, newVal);
+            return md.freeze();
+        }
+
+        intrusive_ptr<DocumentStorage> out (new DocumentStorage());
+        out->setOverlay(&storage(), pos, newVal);
+        return Document(out.get());
+    }
+
     size_t Document::getApproximateSize() const {
         if (!_storage)
             return 0; // we've allocated no memory
@@ -356,6 +475,9 @@ namespace mongo {
         size_t size = sizeof(DocumentStorage);
         size += storage().allocatedBytes();
 
+        if (storage().isLazy())
+            return size; // no Values yet
+
         for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
             size += it->val.getApproximateSize();
             size -= sizeof(Value); // already accounted for above
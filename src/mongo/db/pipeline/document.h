@@ -93,6 +93,19 @@ namespace mongo {
         const Value getNestedField(const FieldPath& fieldNames,
                                    std::vector<Position>* positions=NULL) const;
 
+        /** Returns a copy of this document with 'val' at the path of 'positions', which comes from
+         *  getNestedField and must be non-empty. Rather than copying the fields of this document,
+         *  the result only stores the replaced field and reads the others from this one, which
+         *  makes it cheap to emit many variations of a large document, as $unwind does.
+         *  Overlays aren't stacked: if this document is one, the fields are copied each time,
+         *  so clone() it first to emit many variations of it.
+         */
+        Document overlayNestedField(const std::vector<Position>& positions,
+                                    const Value& val) const;
+
+        /// True if this document was made by overlayNestedField.
+        bool isOverlay() const { return storage().isOverlay(); }
+
         /// Number of fields in this document. O(n)
         size_t size() const { return storage().size(); }
 
@@ -158,6 +171,14 @@ namespace mongo {
          */
         static Document fromBsonWithMetaData(const BSONObj& bson);
 
+        /**
+         * Like fromBsonWithMetaData but the fields are only converted when they are first
+         * iterated or modified. Looking up a top-level field by name reads it from the BSON, and
+         * toBson() returns the BSON itself as long as the document is not modified. Cheaper for
+         * wide documents of which only a few fields are used. Copies 'bson' if it is not owned.
+         */
+        static Document fromBsonWithMetaDataLazy(const BSONObj& bson);
+
         // Support BSONObjBuilder and BSONArrayBuilder "stream" API
         friend BSONObjBuilder& operator << (BSONObjBuilderValueStream& builder, const Document& d);
 
@@ -198,6 +219,10 @@ namespace mongo {
 
         explicit Document(const DocumentStorage* ptr) : _storage(ptr) {};
 
+        Document overlayNestedFieldHelper(const std::vector<Position>& positions,
+                                          size_t level,
+                                          const Value& val) const;
+
         const DocumentStorage& storage() const {
             return (_storage ? *_storage : DocumentStorage::emptyDoc());
         }
@@ -427,7 +452,9 @@ namespace mongo {
                 return clonedStorage();
 
             // This function exists to ensure this is safe
-            return const_cast<DocumentStorage&>(*storagePtr());
+            DocumentStorage& storage = const_cast<DocumentStorage&>(*storagePtr());
+            storage.flattenOverlay();
+            return storage;
         }
         DocumentStorage& newStorage() {
             reset(new DocumentStorage);
@@ -117,12 +117,17 @@ namespace mongo {
     class DocumentStorageIterator {
     public:
         // DocumentStorage::iterator() and iteratorAll() are easier to use
+        // If 'overlaid' is set, 'overlay' is returned in place of that element.
         DocumentStorageIterator(const ValueElement* first,
                                 const ValueElement* end,
-                                bool includeMissing)
+                                bool includeMissing,
+                                const ValueElement* overlaid = NULL,
+                                const ValueElement* overlay = NULL)
                 : _first(first)
                 , _it(first)
                 , _end(end)
+                , _overlaid(overlaid)
+                , _overlay(overlay)
                 , _includeMissing(includeMissing) {
             if (!_includeMissing)
                 skipMissing();
@@ -130,7 +135,7 @@ namespace mongo {
 
         bool atEnd() const { return _it == _end; }
 
-        const ValueElement& get() const { return *_it; }
+        const ValueElement& get() const { return *current(); }
 
         Position position() const { return Position(_it->ptr() - _first->ptr()); }
 
@@ -140,16 +145,20 @@ namespace mongo {
                 skipMissing();
         }
 
-        const ValueElement* operator-> () { return _it; }
-        const ValueElement& operator* () { return *_it; }
+        const ValueElement* operator-> () { return current(); }
+        const ValueElement& operator* () { return *current(); }
 
     private:
+        const ValueElement* current() const {
+            return MONGO_unlikely(_it == _overlaid) ? _overlay : _it;
+        }
+
         void advanceOne() {
             _it = _it->next();
         }
 
         void skipMissing() {
-            while (!atEnd() && _it->val.missing()) {
+            while (!atEnd() && current()->val.missing()) {
                 advanceOne();
             }
         }
@@ -157,6 +166,8 @@ namespace mongo {
         const ValueElement* _first;
         const ValueElement* _it;
         const ValueElement* _end;
+        const ValueElement* _overlaid;
+        const ValueElement* _overlay;
         bool _includeMissing;
     };
 
@@ -171,6 +182,7 @@ namespace mongo {
                           , _hashTabMask(0)
                           , _hasTextScore(false)
                           , _textScore(0)
+                          , _lazy(false)
         {}
         ~DocumentStorage();
 
@@ -179,6 +191,34 @@ namespace mongo {
             return *reinterpret_cast<const DocumentStorage*>(emptyBytes);
         }
 
+        /** Makes this storage hold the fields of 'bson' without converting them to Values yet.
+         *  'bson' must be owned and have no metadata fields. The fields are converted the first
+         *  time they are iterated, modified or looked up by Position. Until then, looking one up
+         *  by name reads it straight from 'bson'. Only valid on a new storage.
+         */
+        void setLazyBson(const BSONObj& bson);
+
+        /// True if the fields are still only in lazyBson(). See setLazyBson.
+        bool isLazy() const { return _lazy; }
+        const BSONObj& lazyBson() const { return _lazyBson; }
+
+        /** Makes this storage hold the fields of 'base', but with 'val' as the value of the field
+         *  at 'pos'. Only that field is stored here, the others are read from 'base', which is
+         *  shared rather than copied. Positions are the same as in 'base'. The fields are copied
+         *  by flattenOverlay() the first time the storage is modified. 'base' must be neither
+         *  lazy nor an overlay itself. Only valid on a new storage.
+         */
+        void setOverlay(const DocumentStorage* base, Position pos, const Value& val);
+
+        /// True if this overlays the fields of another storage. See setOverlay.
+        bool isOverlay() const { return _overlayBase.get(); }
+
+        /// Copies the fields of an overlay, so that this storage can be modified in place.
+        void flattenOverlay() {
+            if (MONGO_unlikely(_overlayBase))
+                flattenOverlaySlow();
+        }
+
         size_t size() const {
             // can't use _numFields because it includes removed Fields
             size_t count = 0;
@@ -188,7 +228,11 @@ namespace mongo {
         }
 
         /// Returns the position of the next field to be inserted
-        Position getNextPosition() const { return Position(_usedBytes); }
+        Position getNextPosition() const {
+            loadLazyBson();
+            dassert(!_overlayBase);
+            return Position(_usedBytes);
+        }
 
         /// Returns the position of the named field (may be missing) or Position()
         Position findField(StringData name) const;
@@ -196,18 +240,26 @@ namespace mongo {
         // Document uses these
         const ValueElement& getField(Position pos) const {
             verify(pos.found());
+            if (MONGO_unlikely(_overlayBase)) {
+                // The overlay's only field is its first one.
+                return pos == _overlayPos ? *_firstElement : _overlayBase->getField(pos);
+            }
             return *(_firstElement->plusBytes(pos.index));
         }
         Value getField(StringData name) const {
+            if (_lazy)
+                return Value(_lazyBson[name]);
+
             Position pos = findField(name);
             if (!pos.found())
                 return Value();
             return getField(pos).val;
         }
 
-        // MutableDocument uses these
+        // MutableDocument uses these, after flattenOverlay()
         ValueElement& getField(Position pos) {
             verify(pos.found());
+            dassert(!_overlayBase);
             return *(_firstElement->plusBytes(pos.index));
         }
         Value& getField(StringData name) {
@@ -227,11 +279,17 @@ namespace mongo {
 
         /// This skips missing values
         DocumentStorageIterator iterator() const {
+            if (MONGO_unlikely(_overlayBase))
+                return overlayIterator(false);
+            loadLazyBson();
             return DocumentStorageIterator(_firstElement, end(), false);
         }
 
         /// This includes missing values
         DocumentStorageIterator iteratorAll() const {
+            if (MONGO_unlikely(_overlayBase))
+                return overlayIterator(true);
+            loadLazyBson();
             return DocumentStorageIterator(_firstElement, end(), true);
         }
 
@@ -239,7 +297,10 @@ namespace mongo {
         boost::intrusive_ptr<DocumentStorage> clone() const;
 
         size_t allocatedBytes() const {
-            return !_buffer ? 0 : (_bufferEnd - _buffer + hashTabBytes());
+            if (_lazy)
+                return _lazyBson.objsize();
+            const size_t bytes = !_buffer ? 0 : (_bufferEnd - _buffer + hashTabBytes());
+            return _overlayBase ? _overlayBase->allocatedBytes() + bytes : bytes;
         }
 
         /**
@@ -261,6 +322,30 @@ namespace mongo {
 
     private:
 
+        /** Converts the fields of a lazy storage. This changes the representation but not the
+         *  contents, so it is done even through const methods. Like the copy-on-write in
+         *  MutableDocument, this relies on a Document not being used by several threads at once.
+         */
+        void loadLazyBson() const {
+            if (MONGO_unlikely(_lazy))
+                const_cast<DocumentStorage*>(this)->loadLazyBsonSlow();
+        }
+        void loadLazyBsonSlow();
+
+        void flattenOverlaySlow();
+
+        /// Iterates over the fields of _overlayBase, with the overlaid one replaced.
+        DocumentStorageIterator overlayIterator(bool includeMissing) const {
+            return DocumentStorageIterator(_overlayBase->_firstElement,
+                                           _overlayBase->end(),
+                                           includeMissing,
+                                           _overlayBase->_firstElement->plusBytes(_overlayPos.index),
+                                           _firstElement);
+        }
+
+        /// Makes this empty storage a copy of the fields of 'source', at the same positions.
+        void copyFieldsFrom(const DocumentStorage& source);
+
         /// Same as lastElement->next() or firstElement() if empty.
         const ValueElement* end() const { return _firstElement->plusBytes(_usedBytes); }
 
@@ -330,6 +415,16 @@ namespace mongo {
 
         bool _hasTextScore; // When adding more metadata fields, this should become a bitvector
         double _textScore;
+
+        // Set until the fields of _lazyBson are converted. Checked before _lazyBson is touched
+        // since emptyDoc() is only zeroed memory.
+        bool _lazy;
+        BSONObj _lazyBson;
+
+        // Set while this storage overlays the fields of _overlayBase. The value of the field at
+        // _overlayPos is then the one field in _buffer. Null in emptyDoc() since that is zeroed.
+        boost::intrusive_ptr<const DocumentStorage> _overlayBase;
+        Position _overlayPos;
         // When adding a field, make sure to update clone() method
     };
 }
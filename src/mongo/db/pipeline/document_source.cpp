@@ -31,6 +31,7 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -42,6 +43,29 @@ namespace mongo {
         , pExpCtx(pCtx)
     {}
 
+    boost::optional<Document> DocumentSource::getNextTimed() {
+        Timer timer;
+        boost::optional<Document> next = doGetNext();
+        _stats.executionMicros += timer.micros();
+        if (next)
+            _stats.nReturned++;
+        return next;
+    }
+
+    Document DocumentSource::serializeStats() const {
+        MutableDocument out;
+        if (pSource)
+            out.addField("nInput", Value(pSource->getStats().nReturned));
+        out.addField("nReturned", Value(_stats.nReturned));
+        if (_stats.timed)
+            out.addField("executionTimeMillisEstimate", Value(_stats.executionMicros / 1000));
+        if (_stats.peakMemoryBytes)
+            out.addField("peakMemoryBytes", Value(static_cast<long long>(_stats.peakMemoryBytes)));
+        if (_stats.bytesSpilled)
+            out.addField("bytesSpilled", Value(static_cast<long long>(_stats.bytesSpilled)));
+        return out.freeze();
+    }
+
     const char *DocumentSource::getSourceName() const {
         static const char unknown[] = "[UNKNOWN]";
         return unknown;
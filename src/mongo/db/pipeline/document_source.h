@@ -34,19 +34,25 @@
 #include <boost/intrusive_ptr.hpp>
 #include <boost/unordered_map.hpp>
 #include <deque>
+#include <map>
 
 #include "mongo/client/connpool.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression_compiled.h"
 #include "mongo/db/matcher/matcher.h"
+#include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/group_table.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/platform/random.h"
 #include "mongo/s/strategy.h"
 #include "mongo/util/intrusive_counter.h"
+#include "mongo/util/memory_accounting.h"
 
 
 namespace mongo {
@@ -64,9 +70,36 @@ namespace mongo {
         virtual ~DocumentSource() {}
 
         /** Returns the next Document if there is one or boost::none if at EOF.
-         *  Subclasses must call pExpCtx->checkForInterupt().
+         *  Counts the documents returned, and times doGetNext() once enableTiming() was called.
+         */
+        boost::optional<Document> getNext() {
+            if (MONGO_unlikely(_stats.timed))
+                return getNextTimed();
+
+            boost::optional<Document> next = doGetNext();
+            if (next)
+                _stats.nReturned++;
+            return next;
+        }
+
+        /// What explain's executionStats mode and the slow query log report about a stage.
+        struct Stats {
+            long long nReturned = 0;
+            long long executionMicros = 0; // includes the earlier stages, and only if timed
+            size_t peakMemoryBytes = 0; // for stages that hold on to documents or groups
+            unsigned long long bytesSpilled = 0;
+            bool timed = false;
+        };
+
+        const Stats& getStats() const { return _stats; }
+
+        /// Makes getNext() measure the time spent in this stage and the ones before it.
+        void enableTiming() { _stats.timed = true; }
+
+        /** Serializes getStats() for explain, with the documents this received from pSource.
+         *  Leaves out what this stage doesn't track.
          */
-        virtual boost::optional<Document> getNext() = 0;
+        Document serializeStats() const;
 
         /**
          * Inform the source that it is no longer needed and may release its resources.  After
@@ -164,6 +197,14 @@ namespace mongo {
          */
         DocumentSource(const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
 
+        /** Does the work of getNext().
+         *  Subclasses must call pExpCtx->checkForInterupt().
+         */
+        virtual boost::optional<Document> doGetNext() = 0;
+
+        /// Subclasses update peakMemoryBytes and bytesSpilled as they allocate memory and spill.
+        Stats _stats;
+
         /*
           Most DocumentSources have an underlying source they get their data
           from.  This is a convenience for them.
@@ -177,6 +218,8 @@ namespace mongo {
         boost::intrusive_ptr<ExpressionContext> pExpCtx;
 
     private:
+        boost::optional<Document> getNextTimed();
+
         /**
          * Create a Value that represents the document source.
          *
@@ -236,6 +279,35 @@ namespace mongo {
              */
             virtual BSONObj insert(const NamespaceString& ns, const std::vector<BSONObj>& objs) = 0;
 
+            /**
+             * Runs the "create" command 'cmdObj' on 'dbName', but without building the _id index,
+             * so that documents can be loaded before buildIndexes() builds all the indexes.
+             */
+            virtual void createCollectionWithoutIndexes(const std::string& dbName,
+                                                        const BSONObj& cmdObj) = 0;
+
+            /**
+             * Like insert(), for a collection without indexes. While that collection is empty and
+             * its writes aren't replicated, documents are appended through the storage engine's
+             * bulk loader instead, and only become visible once finishBulkInsert() is called.
+             * Returns an empty object for those, and throws if loading them fails.
+             */
+            virtual BSONObj bulkInsert(const NamespaceString& ns,
+                                       const std::vector<BSONObj>& objs) = 0;
+
+            /**
+             * Makes the documents bulk loaded by bulkInsert() visible. Does nothing if there are
+             * none.
+             */
+            virtual void finishBulkInsert() = 0;
+
+            /**
+             * Builds the indexes 'specs' on 'ns' at once, in the foreground, so that the keys of
+             * the existing documents are sorted with the external sorter and bulk loaded.
+             */
+            virtual void buildIndexes(const NamespaceString& ns,
+                                      const std::vector<BSONObj>& specs) = 0;
+
             // Add new methods as needed.
         };
 
@@ -256,7 +328,7 @@ namespace mongo {
         public DocumentSource {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual Value serialize(bool explain = false) const;
         virtual void setSource(DocumentSource *pSource);
         virtual bool isValidInitialSource() const { return true; }
@@ -293,7 +365,7 @@ namespace mongo {
         public DocumentSource {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual Value serialize(bool explain = false) const;
         virtual void setSource(DocumentSource *pSource);
         virtual bool isValidInitialSource() const { return true; }
@@ -352,7 +424,7 @@ namespace mongo {
     public:
         // virtuals from DocumentSource
         virtual ~DocumentSourceCursor();
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual Value serialize(bool explain = false) const;
         virtual void setSource(DocumentSource *pSource);
@@ -409,6 +481,12 @@ namespace mongo {
         /// returns -1 for no limit
         long long getLimit() const;
 
+        /**
+         * Caps each batch at 'docs' documents, rather than only by size, for executors that can
+         * return more than the pipeline is likely to use at a cost for each of them.
+         */
+        void setMaxBatchDocs(long long docs) { _maxBatchDocs = docs; }
+
     private:
         DocumentSourceCursor(
             const std::string& ns,
@@ -417,6 +495,12 @@ namespace mongo {
 
         void loadBatch();
 
+        /**
+         * Adds the keys and documents _exec examined since the last call to the OpDebug of the
+         * current operation, for the slow query log, the profiler and the query stats store.
+         */
+        void recordExecStats();
+
         std::deque<Document> _currentBatch;
 
         // BSONObj members must outlive _projection and cursor.
@@ -426,6 +510,11 @@ namespace mongo {
         boost::optional<ParsedDeps> _dependencies;
         boost::intrusive_ptr<DocumentSourceLimit> _limit;
         long long _docsAddedToBatches; // for _limit enforcement
+        long long _maxBatchDocs = 0; // 0 for no cap
+
+        // What _exec had examined by the last recordExecStats()
+        long long _keysExaminedRecorded = 0;
+        long long _docsExaminedRecorded = 0;
 
         const std::string _ns;
         std::shared_ptr<PlanExecutor> _exec; // PipelineProxyStage holds a weak_ptr to this.
@@ -436,7 +525,7 @@ namespace mongo {
                               , public SplittableDocumentSource {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual boost::intrusive_ptr<DocumentSource> optimize();
         virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
@@ -459,12 +548,41 @@ namespace mongo {
                 group field
          */
         void addAccumulator(const std::string& fieldName,
-                            boost::intrusive_ptr<Accumulator> (*pAccumulatorFactory)(),
+                            const AccumulatorFactory& pAccumulatorFactory,
                             const boost::intrusive_ptr<Expression> &pExpression);
 
         /// Tell this source if it is doing a merge from shards. Defaults to false.
         void setDoingMerge(bool doingMerge) { _doingMerge = doingMerge; }
 
+        /**
+         * Tells this source that its input comes sorted by 'sortKey', and that the fields of
+         * 'sortKey' are never arrays. If that keeps the documents of each group next to each
+         * other, each group is returned as soon as the first document of the next one is read,
+         * rather than after building all of them. Returns whether that is the case.
+         */
+        bool setInputSortedBy(const BSONObj& sortKey);
+
+        /**
+         * A { $sum : <expression> } of this group.
+         */
+        struct Sum {
+            std::string fieldName; // output field
+            std::string sumField; // the field summed, or empty to sum 'constant'
+            Value constant; // a number
+        };
+
+        /**
+         * If every accumulator is a $sum of a numeric constant or of a field, and the _id only
+         * depends on fields of its input, puts those fields in '*idFields' and the sums in
+         * '*sums' and returns true.
+         */
+        bool getSums(std::set<std::string>* idFields, std::vector<Sum>* sums) const;
+
+        /**
+         * Returns the _id of the group 'input' belongs to, as returned with the group.
+         */
+        Value computeIdOf(const Document& input);
+
         /**
           Create a grouping DocumentSource from BSON.
 
@@ -489,12 +607,21 @@ namespace mongo {
     private:
         DocumentSourceGroup(const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
 
-        /// Spill groups map to disk and returns an iterator to the file.
-        std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+        typedef std::vector<boost::intrusive_ptr<Accumulator> > Accumulators;
+        typedef GroupTable<boost::intrusive_ptr<Accumulator> > GroupsMap;
+
+        /** Spill a groups map to disk, emptying it, and returns an iterator to the file. Adds the
+         *  size of the file to '*bytesSpilled'.
+         */
+        std::shared_ptr<Sorter<Value, Value>::Iterator> spill(GroupsMap* table,
+                                                              unsigned long long* bytesSpilled);
 
         // Only used by spill. Would be function-local if that were legal in C++03.
         class SpillSTLComparator;
 
+        // Groups the input on several threads, for populateInParallel().
+        class ParallelGrouper;
+
         /*
           Before returning anything, this source must fetch everything from
           the underlying source and group it.  populate() is used to do that
@@ -504,6 +631,34 @@ namespace mongo {
         void populate();
         bool populated;
 
+        /**
+         * Returns the next group of input sorted on the _id, see setInputSortedBy(), reading
+         * only as far as the first document of the group after it.
+         */
+        boost::optional<Document> getNextStreaming();
+
+        /**
+         * Reads the next input document into _nextInput, and its _id into _nextId.
+         */
+        void readNextStreamingInput();
+
+        /**
+         * Like the grouping loop of populate(), but on 'degree' threads, each of which groups
+         * the documents whose _id hashes to it. Their groups are left in _partitions, or in
+         * 'sortedFiles' if any of them had to be spilled.
+         */
+        void populateInParallel(
+            size_t degree,
+            std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator> >* sortedFiles);
+
+        /**
+         * Processes the ROOT document of 'vars', whose _id is 'id', in the accumulators of its
+         * group in 'table'. Adds the change in memory usage to '*memoryUsageBytes'. Returns true
+         * if the group was new.
+         */
+        bool accumulate(GroupsMap* table, Variables* vars, const Value& id,
+                        int* memoryUsageBytes);
+
         /**
          * Parses the raw id expression into _idExpressions and possibly _idFieldNames.
          */
@@ -521,10 +676,13 @@ namespace mongo {
         Value expandId(const Value& val);
 
 
-        typedef std::vector<boost::intrusive_ptr<Accumulator> > Accumulators;
-        typedef boost::unordered_map<Value, Accumulators, Value::Hash> GroupsMap;
         GroupsMap groups;
 
+        // The groups of the other partitions when grouping in parallel. Each is moved into
+        // 'groups' once those before it were returned.
+        std::vector<GroupsMap> _partitions;
+        size_t _nextPartition;
+
         /*
           The field names for the result documents and the accumulator
           factories for the result documents.  The Expressions are the
@@ -538,35 +696,138 @@ namespace mongo {
           These three vectors parallel each other.
         */
         std::vector<std::string> vFieldName;
-        std::vector<boost::intrusive_ptr<Accumulator> (*)()> vpAccumulatorFactory;
+        std::vector<AccumulatorFactory> vpAccumulatorFactory;
         std::vector<boost::intrusive_ptr<Expression> > vpExpression;
 
 
-        Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
+        Document makeDocument(const Value& id,
+                              const boost::intrusive_ptr<Accumulator>* accums,
+                              bool mergeableOutput);
 
         bool _doingMerge;
         bool _spilled;
         const bool _extSortAllowed;
         const int _maxMemoryUsageBytes;
         std::unique_ptr<Variables> _variables;
+        size_t _numVariables; // to give each thread grouping in parallel its own Variables
         std::vector<std::string> _idFieldNames; // used when id is a document
         std::vector<boost::intrusive_ptr<Expression> > _idExpressions;
 
-        // only used when !_spilled
-        GroupsMap::iterator groupsIterator;
+        // only used when !_spilled, the index in groups of the next group to return
+        size_t groupsIterator;
 
         // only used when _spilled
         std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
         std::pair<Value, Value> _firstPartOfNextGroup;
         Value _currentId;
         Accumulators _currentAccumulators;
+
+        // Whether the input is sorted on the _id, and if so the first input document not
+        // accumulated yet, with its _id
+        bool _streaming;
+        boost::optional<Document> _nextInput;
+        Value _nextId;
+
+        // The memory of the groups held in memory, as counted against _maxMemoryUsageBytes
+        MemoryAccount::Charge _memoryCharge;
+    };
+
+
+    /**
+     * Joins each input document with the documents of another, unsharded, collection of the same
+     * database whose 'foreignField' equals the input's 'localField', adding them as an array in
+     * the 'as' field.
+     *
+     * If the foreign field is indexed, the input is read in batches and each batch probes the
+     * index with a single $in query over its sorted keys. Otherwise the whole foreign
+     * collection is loaded into a hash table, and if that exceeds the memory limit, both sides
+     * are sorted on their keys and merged instead, spilling to disk.
+     */
+    class DocumentSourceLookUp : public DocumentSource
+                               , public DocumentSourceNeedsMongod {
+    public:
+        // virtuals from DocumentSource
+        virtual boost::optional<Document> doGetNext();
+        virtual const char* getSourceName() const;
+        virtual Value serialize(bool explain = false) const;
+        virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
+        virtual void dispose();
+
+        const NamespaceString& getFromNs() const { return _fromNs; }
+
+        static boost::intrusive_ptr<DocumentSource> createFromBson(
+            BSONElement elem,
+            const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+        static const char lookupName[];
+
+    private:
+        DocumentSourceLookUp(const NamespaceString& fromNs,
+                             const std::string& as,
+                             const std::string& localField,
+                             const std::string& foreignField,
+                             const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+        enum Strategy {
+            kUninitialized,
+            kIndexProbe,
+            kHashTable,
+            kSortMerge,
+        };
+
+        // The foreign documents, as Values, of each key.
+        typedef boost::unordered_map<Value, std::vector<Value>, Value::Hash> HashTable;
+        typedef Sorter<Value, Document> MySorter;
+
+        /// Picks the strategy, and builds the hash table or sorts both sides if it needs to.
+        void initialize();
+
+        /// Loads the foreign collection into _table, or sorts and merges if it doesn't fit.
+        void buildHashTable();
+
+        /**
+         * Sorts the input and the foreign documents already in _table, then 'first', then the
+         * rest of 'cursor' on their keys and joins them, leaving the results in _sortedOutput.
+         */
+        void sortMerge(const BSONObj& first, DBClientCursor* cursor);
+
+        /// Joins the next batch of input by probing the foreign index, into _joined.
+        void probeNextBatch();
+
+        /// The key that foreign documents must match for 'input'. Missing is the same as null.
+        Value localKey(const Document& input) const;
+
+        /**
+         * The keys that 'foreign' matches: its foreign field and, if that is an array, each of
+         * its elements.
+         */
+        void foreignKeys(const BSONObj& foreign, std::vector<Value>* keys) const;
+
+        /// Adds 'foreign' to 'table' under each of its keys, returning the bytes it took.
+        int addToTable(HashTable* table, const BSONObj& foreign) const;
+
+        /// Returns 'input' with 'matches' in the 'as' field.
+        Document join(const Document& input, const std::vector<Value>& matches) const;
+
+        Document lookUp(const HashTable& table, const Document& input) const;
+
+        const NamespaceString _fromNs;
+        const FieldPath _as;
+        const FieldPath _localField;
+        const FieldPath _foreignField;
+        const int _maxMemoryUsageBytes;
+
+        Strategy _strategy;
+        HashTable _table; // for kHashTable
+        std::deque<Document> _joined; // for kIndexProbe, the rest of the current batch
+        std::unique_ptr<MySorter::Iterator> _sortedOutput; // for kSortMerge
     };
 
 
     class DocumentSourceMatch : public DocumentSource {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual bool coalesce(const boost::intrusive_ptr<DocumentSource>& nextSource);
         virtual Value serialize(bool explain = false) const;
@@ -607,7 +868,16 @@ namespace mongo {
         DocumentSourceMatch(const BSONObj &query,
             const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
 
+        /**
+         * Replaces 'matcher', recompiling its expression.
+         */
+        void resetMatcher(Matcher* newMatcher);
+
         std::unique_ptr<Matcher> matcher;
+
+        // The matcher's expression compiled into a flat program, or NULL.
+        std::unique_ptr<CompiledMatchExpression> _compiled;
+
         bool _isTextQuery;
     };
 
@@ -617,7 +887,7 @@ namespace mongo {
         typedef std::vector<std::pair<ConnectionString, CursorId> > CursorIds;
 
         // virtuals from DocumentSource
-        boost::optional<Document> getNext();
+        boost::optional<Document> doGetNext();
         virtual void setSource(DocumentSource *pSource);
         virtual const char *getSourceName() const;
         virtual void dispose();
@@ -648,6 +918,8 @@ namespace mongo {
 
     private:
 
+        // The connection only carries the first batch. The cursor is then attached to the pool,
+        // so that it can prefetch its later batches.
         struct CursorAndConnection {
             CursorAndConnection(ConnectionString host, NamespaceString ns, CursorId id);
             ScopedDbConnection connection;
@@ -680,7 +952,7 @@ namespace mongo {
     public:
         // virtuals from DocumentSource
         virtual ~DocumentSourceOut();
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual Value serialize(bool explain = false) const;
         virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
@@ -711,22 +983,28 @@ namespace mongo {
         DocumentSourceOut(const NamespaceString& outputNs,
                           const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
 
-        // Sets _tempsNs and prepares it to receive data.
+        // Sets _tempsNs and prepares it to receive data. Its indexes are only built by
+        // buildTempIndexes(), once all the data is in.
         void prepTempCollection();
 
+        void buildTempIndexes();
+
         void spill(const std::vector<BSONObj>& toInsert);
 
         bool _done;
 
         NamespaceString _tempNs; // output goes here as it is being processed.
         const NamespaceString _outputNs; // output will go here after all data is processed.
+
+        // The indexes of _outputNs, to be built on _tempNs.
+        std::vector<BSONObj> _tempIndexes;
     };
 
 
     class DocumentSourceProject : public DocumentSource {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual boost::intrusive_ptr<DocumentSource> optimize();
         virtual Value serialize(bool explain = false) const;
@@ -752,6 +1030,13 @@ namespace mongo {
         /** projection as specified by the user */
         BSONObj getRaw() const { return _raw; }
 
+        /**
+         * If this projection does nothing but include top-level fields, possibly under new
+         * names, fills 'fields' with the input field path of each output field, and returns
+         * true. Otherwise returns false.
+         */
+        bool getRenamedFields(std::map<std::string, std::string>* fields) const;
+
     private:
         DocumentSourceProject(const boost::intrusive_ptr<ExpressionContext>& pExpCtx,
                               const boost::intrusive_ptr<ExpressionObject>& exprObj);
@@ -765,7 +1050,7 @@ namespace mongo {
     class DocumentSourceRedact :
         public DocumentSource {
     public:
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char* getSourceName() const;
         virtual boost::intrusive_ptr<DocumentSource> optimize();
 
@@ -794,7 +1079,7 @@ namespace mongo {
                              , public SplittableDocumentSource {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual void serializeToArray(std::vector<Value>& array, bool explain = false) const;
         virtual bool coalesce(const boost::intrusive_ptr<DocumentSource> &pNextSource);
@@ -820,6 +1105,13 @@ namespace mongo {
         /// Write out a Document whose contents are the sort key.
         Document serializeSortKey(bool explain) const;
 
+        /**
+         * Returns the sort key in terms of the input of a stage that produces each top-level
+         * field in 'fields' from the field path it maps to, such as a renaming $project. Returns
+         * an empty object if some part of the key isn't a field path rooted in 'fields'.
+         */
+        BSONObj serializeSortKeyBefore(const std::map<std::string, std::string>& fields) const;
+
         /**
           Create a sorting DocumentSource from BSON.
 
@@ -909,7 +1201,7 @@ namespace mongo {
                               , public SplittableDocumentSource {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual bool coalesce(const boost::intrusive_ptr<DocumentSource> &pNextSource);
         virtual Value serialize(bool explain = false) const;
@@ -965,7 +1257,7 @@ namespace mongo {
                              , public SplittableDocumentSource {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual bool coalesce(const boost::intrusive_ptr<DocumentSource> &pNextSource);
         virtual Value serialize(bool explain = false) const;
@@ -1016,12 +1308,126 @@ namespace mongo {
         bool _needToSkip;
     };
 
+    /**
+     * $sample returns 'size' documents picked at random from its input, in random order, by
+     * keeping a reservoir sample of the input. PipelineD replaces an initial $sample by a cursor
+     * over random records followed by a DocumentSourceSampleFromRandomCursor, which only reads
+     * about 'size' documents, when the storage engine can pick records at random.
+     */
+    class DocumentSourceSample : public DocumentSource
+                               , public SplittableDocumentSource {
+    public:
+        // virtuals from DocumentSource
+        virtual boost::optional<Document> doGetNext();
+        virtual const char *getSourceName() const;
+        virtual Value serialize(bool explain = false) const;
+        virtual void dispose();
+
+        virtual GetDepsReturn getDependencies(DepsTracker* deps) const {
+            return SEE_NEXT; // This doesn't affect needed fields
+        }
+
+        // Virtuals for SplittableDocumentSource
+        // Samples of each shard aren't a sample of the collection, so can only run on the merger.
+        virtual boost::intrusive_ptr<DocumentSource> getShardSource() { return NULL; }
+        virtual boost::intrusive_ptr<DocumentSource> getMergeSource() { return this; }
+
+        long long getSampleSize() const { return _size; }
+
+        /**
+         * Parses {$sample: {size: <non-negative number>}}.
+         */
+        static boost::intrusive_ptr<DocumentSource> createFromBson(
+            BSONElement elem,
+            const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
+
+        static const char sampleName[];
+
+    private:
+        DocumentSourceSample(const boost::intrusive_ptr<ExpressionContext> &pExpCtx,
+                             long long size);
+
+        // Fills _reservoir from the whole input.
+        void populate();
+
+        const long long _size;
+        const int _maxMemoryUsageBytes;
+        PseudoRandom _random;
+
+        bool _populated = false;
+        std::vector<Document> _reservoir;
+        size_t _returned = 0;
+    };
+
+    /**
+     * Returns the first 'size' distinct documents, by _id, of an input that returns random
+     * documents of a collection, possibly some more than once.
+     */
+    class DocumentSourceSampleFromRandomCursor : public DocumentSource {
+    public:
+        // virtuals from DocumentSource
+        virtual boost::optional<Document> doGetNext();
+        virtual const char *getSourceName() const;
+        virtual Value serialize(bool explain = false) const;
+        virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
+
+        static boost::intrusive_ptr<DocumentSourceSampleFromRandomCursor> create(
+            const boost::intrusive_ptr<ExpressionContext> &pExpCtx,
+            long long size);
+
+        static const char sampleFromRandomCursorName[];
+
+    private:
+        DocumentSourceSampleFromRandomCursor(
+            const boost::intrusive_ptr<ExpressionContext> &pExpCtx,
+            long long size);
+
+        const long long _size;
+        long long _returned = 0;
+        ValueSet _seenIds;
+    };
+
+    /**
+     * An initial source which returns the partial results of a [$match,] $group of the pipeline,
+     * as computed by PipelineD from the groups of a summary index, for the merging half of that
+     * $group to finish.
+     */
+    class DocumentSourceSummary : public DocumentSource {
+    public:
+        // virtuals from DocumentSource
+        virtual boost::optional<Document> doGetNext();
+        virtual const char *getSourceName() const;
+        virtual Value serialize(bool explain = false) const;
+        virtual void setSource(DocumentSource *pSource);
+        virtual bool isValidInitialSource() const { return true; }
+        virtual void dispose();
+
+        static boost::intrusive_ptr<DocumentSourceSummary> create(
+            const boost::intrusive_ptr<ExpressionContext> &pExpCtx,
+            const std::string& indexName,
+            const BSONObj& query,
+            std::vector<Document> partialGroups);
+
+        static const char summaryName[];
+
+    private:
+        DocumentSourceSummary(const boost::intrusive_ptr<ExpressionContext> &pExpCtx,
+                              const std::string& indexName,
+                              const BSONObj& query,
+                              std::vector<Document> partialGroups);
+
+        const std::string _indexName;
+        const BSONObj _query;
+        std::vector<Document> _partialGroups;
+        size_t _returned = 0;
+    };
+
 
     class DocumentSourceUnwind :
         public DocumentSource {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual Value serialize(bool explain = false) const;
 
@@ -1062,7 +1468,7 @@ namespace mongo {
                                 , public DocumentSourceNeedsMongod {
     public:
         // virtuals from DocumentSource
-        virtual boost::optional<Document> getNext();
+        virtual boost::optional<Document> doGetNext();
         virtual const char *getSourceName() const;
         virtual void setSource(DocumentSource *pSource);
         virtual bool coalesce(const boost::intrusive_ptr<DocumentSource> &pNextSource);
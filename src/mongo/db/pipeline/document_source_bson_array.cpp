@@ -36,7 +36,7 @@ namespace mongo {
 
     using boost::intrusive_ptr;
 
-    boost::optional<Document> DocumentSourceBsonArray::getNext() {
+    boost::optional<Document> DocumentSourceBsonArray::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         if (!arrayIterator.more())
@@ -97,7 +97,7 @@ namespace {
         return out;
     }
 
-    boost::optional<Document> DocumentSourceCommandShards::getNext() {
+    boost::optional<Document> DocumentSourceCommandShards::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         while(true) {
@@ -32,6 +32,7 @@
 
 
 #include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/instance.h"
@@ -55,7 +56,7 @@ namespace mongo {
         return "$cursor";
     }
 
-    boost::optional<Document> DocumentSourceCursor::getNext() {
+    boost::optional<Document> DocumentSourceCursor::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         if (_currentBatch.empty()) {
@@ -77,6 +78,26 @@ namespace mongo {
         _currentBatch.clear();
     }
 
+    void DocumentSourceCursor::recordExecStats() {
+        CurOp* curOp = CurOp::get(pExpCtx->opCtx);
+        if (!curOp) {
+            return;
+        }
+
+        PlanSummaryStats stats;
+        Explain::getSummaryStats(_exec.get(), &stats);
+        const long long keysExamined = stats.totalKeysExamined;
+        const long long docsExamined = stats.totalDocsExamined;
+
+        OpDebug& opDebug = curOp->debug();
+        opDebug.nscanned = std::max(opDebug.nscanned, 0LL) + keysExamined - _keysExaminedRecorded;
+        opDebug.nscannedObjects =
+            std::max(opDebug.nscannedObjects, 0LL) + docsExamined - _docsExaminedRecorded;
+        opDebug.replanned = opDebug.replanned || stats.replanned;
+        _keysExaminedRecorded = keysExamined;
+        _docsExaminedRecorded = docsExamined;
+    }
+
     void DocumentSourceCursor::loadBatch() {
         if (!_exec) {
             dispose();
@@ -98,7 +119,9 @@ namespace mongo {
                 _currentBatch.push_back(_dependencies->extractFields(obj));
             }
             else {
-                _currentBatch.push_back(Document::fromBsonWithMetaData(obj));
+                // Stages needing the whole document often only look at a few of its fields, or
+                // pass it on unmodified, so only convert the fields when they're used.
+                _currentBatch.push_back(Document::fromBsonWithMetaDataLazy(obj));
             }
 
             if (_limit) {
@@ -110,8 +133,11 @@ namespace mongo {
 
             memUsageBytes += _currentBatch.back().getApproximateSize();
 
-            if (memUsageBytes > MaxBytesToReturnToClientAtOnce) {
+            if (memUsageBytes > MaxBytesToReturnToClientAtOnce
+                    || (_maxBatchDocs > 0
+                        && static_cast<long long>(_currentBatch.size()) >= _maxBatchDocs)) {
                 // End this batch and prepare PlanExecutor for yielding.
+                recordExecStats();
                 _exec->saveState();
                 return;
             }
@@ -119,6 +145,7 @@ namespace mongo {
 
         // If we got here, there won't be any more documents, so destroy the executor. Can't use
         // dispose since we want to keep the _currentBatch.
+        recordExecStats();
         _exec.reset();
 
         uassert(16028, str::stream() << "collection or index disappeared when cursor yielded: "
@@ -42,7 +42,7 @@ namespace mongo {
     char DocumentSourceGeoNear::geoNearName[] = "$geoNear";
     const char *DocumentSourceGeoNear::getSourceName() const { return geoNearName; }
 
-    boost::optional<Document> DocumentSourceGeoNear::getNext() {
+    boost::optional<Document> DocumentSourceGeoNear::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         if (!resultsIterator)
@@ -28,6 +28,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <deque>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -36,6 +37,11 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
 
@@ -44,15 +50,25 @@ namespace mongo {
     using std::pair;
     using std::vector;
 
+    // The most threads a $group runs on, whatever its "parallelism" option asked for.
+    MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupMaxParallelism, int, 4);
+
+namespace {
+    MemoryAccount groupMemory("aggregationGroups");
+}  // namespace
+
     const char DocumentSourceGroup::groupName[] = "$group";
 
     const char *DocumentSourceGroup::getSourceName() const {
         return groupName;
     }
 
-    boost::optional<Document> DocumentSourceGroup::getNext() {
+    boost::optional<Document> DocumentSourceGroup::doGetNext() {
         pExpCtx->checkForInterrupt();
 
+        if (_streaming)
+            return getNextStreaming();
+
         if (!populated)
             populate();
 
@@ -98,17 +114,23 @@ namespace mongo {
                 _firstPartOfNextGroup = _sorterIterator->next();
             }
 
-            return makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
+            return makeDocument(_currentId, _currentAccumulators.data(), pExpCtx->inShard);
 
         } else {
-            if (groups.empty())
+            // Move on to the next partition once all the groups of this one were returned.
+            while (groupsIterator >= groups.size() && _nextPartition < _partitions.size()) {
+                groups = std::move(_partitions[_nextPartition++]);
+                groupsIterator = 0;
+            }
+
+            if (groupsIterator >= groups.size())
                 return boost::none;
 
-            Document out = makeDocument(groupsIterator->first,
-                                        groupsIterator->second,
+            Document out = makeDocument(groups.idAt(groupsIterator),
+                                        groups.statesAt(groupsIterator),
                                         pExpCtx->inShard);
 
-            if (++groupsIterator == groups.end())
+            if (++groupsIterator == groups.size() && _nextPartition == _partitions.size())
                 dispose();
 
             return out;
@@ -117,11 +139,15 @@ namespace mongo {
 
     void DocumentSourceGroup::dispose() {
         // free our resources
-        GroupsMap().swap(groups);
+        groups.clear();
+        std::vector<GroupsMap>().swap(_partitions);
         _sorterIterator.reset();
+        _nextInput = boost::none;
+        _memoryCharge.set(0);
 
         // make us look done
-        groupsIterator = groups.end();
+        groupsIterator = 0;
+        _nextPartition = 0;
 
         // free our source's resources
         pSource->dispose();
@@ -164,8 +190,7 @@ namespace mongo {
         const size_t n = vFieldName.size();
         for(size_t i = 0; i < n; ++i) {
             intrusive_ptr<Accumulator> accum = vpAccumulatorFactory[i]();
-            insides[vFieldName[i]] =
-                Value(DOC(accum->getOpName() << vpExpression[i]->serialize(explain)));
+            insides[vFieldName[i]] = Value(accum->serialize(vpExpression[i]->serialize(explain)));
         }
 
         if (_doingMerge) {
@@ -175,6 +200,10 @@ namespace mongo {
             insides["$doingMerge"] = Value(true);
         }
 
+        if (explain && _streaming) {
+            insides["$streaming"] = Value(true);
+        }
+
         return Value(DOC(getSourceName() << insides.freeze()));
     }
 
@@ -203,15 +232,21 @@ namespace mongo {
     DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>& pExpCtx)
         : DocumentSource(pExpCtx)
         , populated(false)
+        , groups(0)
+        , _nextPartition(0)
         , _doingMerge(false)
         , _spilled(false)
         , _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter)
         , _maxMemoryUsageBytes(100*1024*1024)
+        , _numVariables(0)
+        , groupsIterator(0)
+        , _streaming(false)
+        , _memoryCharge(&groupMemory)
     {}
 
     void DocumentSourceGroup::addAccumulator(
             const std::string& fieldName,
-            intrusive_ptr<Accumulator> (*pAccumulatorFactory)(),
+            const AccumulatorFactory& pAccumulatorFactory,
             const intrusive_ptr<Expression> &pExpression) {
         vFieldName.push_back(fieldName);
         vpAccumulatorFactory.push_back(pAccumulatorFactory);
@@ -298,10 +333,20 @@ namespace mongo {
                         groupField.type() == Object);
 
                 BSONObj subField(groupField.Obj());
+
+                // $push takes the $sort and $slice modifiers of the update $push.
+                const bool pushModifiers = subField.hasField("$push")
+                        && (subField.hasField("$sort") || subField.hasField("$slice"));
+
                 BSONObjIterator subIterator(subField);
                 size_t subCount = 0;
-                for(; subIterator.more(); ++subCount) {
+                while (subIterator.more()) {
                     BSONElement subElement(subIterator.next());
+                    if (pushModifiers && (str::equals(subElement.fieldName(), "$sort")
+                                          || str::equals(subElement.fieldName(), "$slice"))) {
+                        continue;
+                    }
+                    ++subCount;
 
                     /* look for the specified operator */
                     GroupOpDesc key;
@@ -329,7 +374,15 @@ namespace mongo {
                         pGroupExpr = Expression::parseOperand(subElement, vps);
                     }
 
-                    pGroup->addAccumulator(pFieldName, pOp->factory, pGroupExpr);
+                    if (pushModifiers) {
+                        pGroup->addAccumulator(pFieldName,
+                                               AccumulatorPushSorted::parseModifiers(
+                                                   subField["$sort"], subField["$slice"]),
+                                               pGroupExpr);
+                    }
+                    else {
+                        pGroup->addAccumulator(pFieldName, pOp->factory, pGroupExpr);
+                    }
                 }
 
                 uassert(15954, str::stream() <<
@@ -342,7 +395,8 @@ namespace mongo {
         uassert(15955, "a group specification must include an _id",
                 !pGroup->_idExpressions.empty());
 
-        pGroup->_variables.reset(new Variables(idGenerator.getIdCount()));
+        pGroup->_numVariables = idGenerator.getIdCount();
+        pGroup->_variables.reset(new Variables(pGroup->_numVariables));
 
         return pGroup;
     }
@@ -357,74 +411,98 @@ namespace mongo {
         };
     }
 
-    void DocumentSourceGroup::populate() {
+    bool DocumentSourceGroup::accumulate(GroupsMap* table,
+                                         Variables* vars,
+                                         const Value& id,
+                                         int* memoryUsageBytes) {
         const size_t numAccumulators = vpAccumulatorFactory.size();
-        dassert(numAccumulators == vpExpression.size());
 
-        // pushed to on spill()
-        vector<shared_ptr<Sorter<Value, Value>::Iterator> > sortedFiles;
-        int memoryUsageBytes = 0;
+        /*
+          Look for the _id value in the map; if it's not there, add a
+          new entry with a blank accumulator.
+        */
+        bool inserted;
+        intrusive_ptr<Accumulator>* group = table->findOrInsert(id, &inserted);
 
-        // This loop consumes all input from pSource and buckets it based on pIdExpression.
-        while (boost::optional<Document> input = pSource->getNext()) {
-            if (memoryUsageBytes > _maxMemoryUsageBytes) {
-                uassert(16945, "Exceeded memory limit for $group, but didn't allow external sort."
-                               " Pass allowDiskUse:true to opt in.",
-                        _extSortAllowed);
-                sortedFiles.push_back(spill());
-                memoryUsageBytes = 0;
+        if (inserted) {
+            *memoryUsageBytes += id.getApproximateSize() + table->bytesPerGroup();
+
+            // Add the accumulators
+            for (size_t i = 0; i < numAccumulators; i++) {
+                group[i] = vpAccumulatorFactory[i]();
+            }
+        } else {
+            for (size_t i = 0; i < numAccumulators; i++) {
+                // subtract old mem usage. New usage added back after processing.
+                *memoryUsageBytes -= group[i]->memUsageForSorter();
             }
+        }
 
-            _variables->setRoot(*input);
+        /* tickle all the accumulators for the group we found */
+        for (size_t i = 0; i < numAccumulators; i++) {
+            group[i]->process(vpExpression[i]->evaluate(vars), _doingMerge);
+            *memoryUsageBytes += group[i]->memUsageForSorter();
+        }
 
-            /* get the _id value */
-            Value id = computeId(_variables.get());
+        return inserted;
+    }
 
-            /* treat missing values the same as NULL SERVER-4674 */
-            if (id.missing())
-                id = Value(BSONNULL);
+    void DocumentSourceGroup::populate() {
+        const size_t numAccumulators = vpAccumulatorFactory.size();
+        dassert(numAccumulators == vpExpression.size());
 
-            /*
-              Look for the _id value in the map; if it's not there, add a
-              new entry with a blank accumulator.
-            */
-            const size_t oldSize = groups.size();
-            vector<intrusive_ptr<Accumulator> >& group = groups[id];
-            const bool inserted = groups.size() != oldSize;
+        groups.reset(numAccumulators);
 
-            if (inserted) {
-                memoryUsageBytes += id.getApproximateSize();
+        // pushed to on spill()
+        vector<shared_ptr<Sorter<Value, Value>::Iterator> > sortedFiles;
 
-                // Add the accumulators
-                group.reserve(numAccumulators);
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    group.push_back(vpAccumulatorFactory[i]());
-                }
-            } else {
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    // subtract old mem usage. New usage added back after processing.
-                    memoryUsageBytes -= group[i]->memUsageForSorter();
+        const size_t degree = std::max(std::min(pExpCtx->parallelism,
+                                                internalDocumentSourceGroupMaxParallelism),
+                                       1);
+        if (degree > 1) {
+            populateInParallel(degree, &sortedFiles);
+        }
+        else {
+            int memoryUsageBytes = 0;
+
+            // This loop consumes all input from pSource and buckets it based on pIdExpression.
+            while (boost::optional<Document> input = pSource->getNext()) {
+                if (memoryUsageBytes > _maxMemoryUsageBytes) {
+                    uassert(16945, "Exceeded memory limit for $group, but didn't allow external"
+                                   " sort. Pass allowDiskUse:true to opt in.",
+                            _extSortAllowed);
+                    sortedFiles.push_back(spill(&groups, &_stats.bytesSpilled));
+                    memoryUsageBytes = 0;
                 }
-            }
-
-            /* tickle all the accumulators for the group we found */
-            dassert(numAccumulators == group.size());
-            for (size_t i = 0; i < numAccumulators; i++) {
-                group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
-                memoryUsageBytes += group[i]->memUsageForSorter();
-            }
-
-            // We are done with the ROOT document so release it.
-            _variables->clearRoot();
 
-            DEV {
-                // In debug mode, spill every time we have a duplicate id to stress merge logic.
-                if (!inserted // is a dup
-                        && !pExpCtx->inRouter // can't spill to disk in router
-                        && !_extSortAllowed // don't change behavior when testing external sort
-                        && sortedFiles.size() < 20 // don't open too many FDs
-                        ) {
-                    sortedFiles.push_back(spill());
+                _variables->setRoot(*input);
+
+                /* get the _id value */
+                Value id = computeId(_variables.get());
+
+                /* treat missing values the same as NULL SERVER-4674 */
+                if (id.missing())
+                    id = Value(BSONNULL);
+
+                const bool inserted = accumulate(&groups, _variables.get(), id,
+                                                 &memoryUsageBytes);
+                _memoryCharge.update(memoryUsageBytes);
+                _stats.peakMemoryBytes = std::max(_stats.peakMemoryBytes,
+                                                  size_t(memoryUsageBytes));
+
+                // We are done with the ROOT document so release it.
+                _variables->clearRoot();
+
+                DEV {
+                    // In debug mode, spill every time we have a duplicate id to stress merge
+                    // logic.
+                    if (!inserted // is a dup
+                            && !pExpCtx->inRouter // can't spill to disk in router
+                            && !_extSortAllowed // don't change behavior when testing external sort
+                            && sortedFiles.size() < 20 // don't open too many FDs
+                            ) {
+                        sortedFiles.push_back(spill(&groups, &_stats.bytesSpilled));
+                    }
                 }
             }
         }
@@ -433,11 +511,12 @@ namespace mongo {
         if (!sortedFiles.empty()) {
             _spilled = true;
             if (!groups.empty()) {
-                sortedFiles.push_back(spill());
+                sortedFiles.push_back(spill(&groups, &_stats.bytesSpilled));
             }
 
             // We won't be using groups again so free its memory.
-            GroupsMap().swap(groups);
+            groups.clear();
+            _memoryCharge.set(0);
 
             _sorterIterator.reset(
                     Sorter<Value,Value>::Iterator::merge(
@@ -453,57 +532,443 @@ namespace mongo {
             _firstPartOfNextGroup = _sorterIterator->next();
         } else {
             // start the group iterator
-            groupsIterator = groups.begin();
+            groupsIterator = 0;
         }
 
         populated = true;
     }
 
+    bool DocumentSourceGroup::setInputSortedBy(const BSONObj& sortKey) {
+        // The documents of a group are only next to each other if the _id is the leading field
+        // of the sort. Those missing the field sort with those where it is null, which is fine
+        // as both are in the null group, but not for the fields of a compound _id.
+        if (_idExpressions.size() != 1)
+            return false;
+
+        const ExpressionFieldPath* idPath =
+            dynamic_cast<const ExpressionFieldPath*>(_idExpressions[0].get());
+        if (!idPath)
+            return false;
+
+        DepsTracker deps;
+        idPath->addDependencies(&deps);
+        const BSONElement firstSortField = sortKey.firstElement();
+        if (deps.needWholeDocument || deps.fields.size() != 1 || !firstSortField.isNumber()
+                || *deps.fields.begin() != firstSortField.fieldNameStringData())
+            return false;
+
+        _streaming = true;
+        return true;
+    }
+
+    bool DocumentSourceGroup::getSums(std::set<std::string>* idFields, vector<Sum>* sums) const {
+        if (_doingMerge)
+            return false;
+
+        DepsTracker idDeps;
+        for (size_t i = 0; i < _idExpressions.size(); i++) {
+            _idExpressions[i]->addDependencies(&idDeps);
+        }
+        if (idDeps.needWholeDocument || idDeps.needTextScore)
+            return false;
+
+        vector<Sum> out;
+        for (size_t i = 0; i < vFieldName.size(); i++) {
+            if (!str::equals(vpAccumulatorFactory[i]()->getOpName(), "$sum"))
+                return false;
+
+            Sum sum;
+            sum.fieldName = vFieldName[i];
+            if (const ExpressionConstant* constant =
+                    dynamic_cast<const ExpressionConstant*>(vpExpression[i].get())) {
+                sum.constant = constant->getValue();
+                if (!sum.constant.numeric())
+                    return false;
+            }
+            else if (dynamic_cast<const ExpressionFieldPath*>(vpExpression[i].get())) {
+                DepsTracker deps;
+                vpExpression[i]->addDependencies(&deps);
+                if (deps.needWholeDocument || deps.fields.size() != 1)
+                    return false;
+                sum.sumField = *deps.fields.begin();
+            }
+            else {
+                return false;
+            }
+            out.push_back(sum);
+        }
+
+        *idFields = idDeps.fields;
+        sums->swap(out);
+        return true;
+    }
+
+    Value DocumentSourceGroup::computeIdOf(const Document& input) {
+        _variables->setRoot(input);
+        Value id = computeId(_variables.get());
+        _variables->clearRoot();
+
+        /* treat missing values the same as NULL SERVER-4674 */
+        if (id.missing())
+            id = Value(BSONNULL);
+        return expandId(id);
+    }
+
+    void DocumentSourceGroup::readNextStreamingInput() {
+        _nextInput = pSource->getNext();
+        if (!_nextInput)
+            return;
+
+        _variables->setRoot(*_nextInput);
+        _nextId = computeId(_variables.get());
+        _variables->clearRoot();
+
+        /* treat missing values the same as NULL SERVER-4674 */
+        if (_nextId.missing())
+            _nextId = Value(BSONNULL);
+
+        // A sort orders an array by its least element, which would put other documents between
+        // those of its group. The indexes providing the sort had no arrays when the query was
+        // planned, but documents written since may.
+        uassert(28796, "$group on sorted input found an array _id, which isn't sorted as such;"
+                       " the collection changed while aggregating it",
+                _nextId.getType() != Array);
+    }
+
+    boost::optional<Document> DocumentSourceGroup::getNextStreaming() {
+        const size_t numAccumulators = vpAccumulatorFactory.size();
+
+        if (!populated) {
+            _currentAccumulators.reserve(numAccumulators);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _currentAccumulators.push_back(vpAccumulatorFactory[i]());
+            }
+            readNextStreamingInput();
+            populated = true;
+        }
+
+        if (!_nextInput)
+            return boost::none;
+
+        for (size_t i = 0; i < numAccumulators; i++) {
+            _currentAccumulators[i]->reset(); // prep accumulators for a new group
+        }
+
+        _currentId = _nextId;
+        do {
+            _variables->setRoot(*_nextInput);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _currentAccumulators[i]->process(vpExpression[i]->evaluate(_variables.get()),
+                                                 _doingMerge);
+            }
+            _variables->clearRoot();
+
+            readNextStreamingInput();
+        } while (_nextInput && Value::compare(_nextId, _currentId) == 0);
+
+        // The group being returned is all this holds.
+        long long memoryUsageBytes = _currentId.getApproximateSize();
+        for (size_t i = 0; i < numAccumulators; i++) {
+            memoryUsageBytes += _currentAccumulators[i]->memUsageForSorter();
+        }
+        _memoryCharge.update(memoryUsageBytes);
+        _stats.peakMemoryBytes = std::max(_stats.peakMemoryBytes, size_t(memoryUsageBytes));
+
+        Document out = makeDocument(_currentId, _currentAccumulators.data(), pExpCtx->inShard);
+
+        if (!_nextInput)
+            dispose();
+
+        return out;
+    }
+
     class DocumentSourceGroup::SpillSTLComparator {
     public:
-        bool operator() (const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
-            return Value::compare(lhs->first, rhs->first) < 0;
+        explicit SpillSTLComparator(const GroupsMap& groups) : _groups(groups) {}
+        bool operator() (size_t lhs, size_t rhs) const {
+            return Value::compare(_groups.idAt(lhs), _groups.idAt(rhs)) < 0;
+        }
+    private:
+        const GroupsMap& _groups;
+    };
+
+    /**
+     * Fans the input of a $group out to one thread per partition of the _ids, by hash.
+     *
+     * The thread running the pipeline reads the input and computes the _ids, then hands the
+     * documents over in batches. Each worker thread accumulates the documents of its partition
+     * into a group table of its own, spilling it when it uses more than its share of the memory
+     * limit. Workers only evaluate the accumulator expressions, which don't need the operation's
+     * locks or its JavaScript scope.
+     */
+    class DocumentSourceGroup::ParallelGrouper {
+        MONGO_DISALLOW_COPYING(ParallelGrouper);
+    public:
+        struct Partition {
+            Partition(size_t numAccumulators, size_t numVariables)
+                : groups(numAccumulators)
+                , vars(numVariables)
+                , memoryUsageBytes(0)
+                , peakMemoryBytes(0)
+                , bytesSpilled(0)
+                , memoryCharge(&groupMemory) {}
+
+            // Only used by the partition's worker until it is joined.
+            GroupsMap groups;
+            Variables vars;
+            int memoryUsageBytes;
+            size_t peakMemoryBytes;
+            unsigned long long bytesSpilled;
+            vector<shared_ptr<Sorter<Value, Value>::Iterator> > sortedFiles;
+            MemoryAccount::Charge memoryCharge;
+
+            // Only used by the thread running the pipeline.
+            vector<pair<Value, Document> > gathering;
+
+            // Protected by _mutex.
+            std::deque<vector<pair<Value, Document> > > queued;
+            stdx::condition_variable workAvailable;
+            Status status = Status::OK();
+        };
+
+        ParallelGrouper(DocumentSourceGroup* group, size_t degree)
+            : _group(group)
+            , _maxMemoryUsageBytes(group->_maxMemoryUsageBytes / degree)
+            , _numQueued(0)
+            , _closed(false) {
+
+            for (size_t i = 0; i < degree; i++) {
+                _partitions.push_back(stdx::make_unique<Partition>(
+                    group->vpAccumulatorFactory.size(), group->_numVariables));
+            }
+
+            _pool = stdx::make_unique<ThreadPool>(degree, "groupPartition");
+            for (size_t i = 0; i < degree; i++) {
+                _pool->schedule(&ParallelGrouper::runPartition, this, _partitions[i].get());
+            }
+        }
+
+        ~ParallelGrouper() {
+            close();
+            _pool->join();
+        }
+
+        /// Hands 'doc', whose group key is 'id', to the worker of the partition of 'id'.
+        void add(const Value& id, const Document& doc) {
+            // Remix the hash so that the partition doesn't determine the low bits, which the
+            // group tables use.
+            const uint64_t hash = Value::Hash()(id) * 0x9E3779B97F4A7C15ULL;
+            Partition* partition = _partitions[(hash >> 32) % _partitions.size()].get();
+
+            partition->gathering.push_back(std::make_pair(id, doc));
+            if (partition->gathering.size() >= kBatchSize) {
+                dispatch(partition);
+            }
+        }
+
+        /// Waits until every document added has been accumulated, then returns the partitions.
+        vector<std::unique_ptr<Partition> >& finish() {
+            for (size_t i = 0; i < _partitions.size(); i++) {
+                if (!_partitions[i]->gathering.empty()) {
+                    dispatch(_partitions[i].get());
+                }
+            }
+            close();
+            _pool->join();
+
+            for (size_t i = 0; i < _partitions.size(); i++) {
+                uassertStatusOK(_partitions[i]->status);
+            }
+            return _partitions;
+        }
+
+    private:
+        // How many documents are handed to a worker at a time.
+        static const size_t kBatchSize = 256;
+
+        void dispatch(Partition* partition) {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+
+            // Bound the documents waiting for a worker to a couple of batches per thread.
+            while (_numQueued >= 2 * _partitions.size()) {
+                _spaceAvailable.wait(lk);
+            }
+
+            partition->queued.push_back(std::move(partition->gathering));
+            partition->gathering.clear();
+            ++_numQueued;
+            partition->workAvailable.notify_one();
+        }
+
+        void close() {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _closed = true;
+            for (size_t i = 0; i < _partitions.size(); i++) {
+                _partitions[i]->workAvailable.notify_one();
+            }
+        }
+
+        static void runPartition(ParallelGrouper* grouper, Partition* partition) {
+            while (true) {
+                vector<pair<Value, Document> > batch;
+                {
+                    stdx::unique_lock<stdx::mutex> lk(grouper->_mutex);
+                    while (partition->queued.empty() && !grouper->_closed) {
+                        partition->workAvailable.wait(lk);
+                    }
+                    if (partition->queued.empty()) {
+                        return;
+                    }
+
+                    batch = std::move(partition->queued.front());
+                    partition->queued.pop_front();
+                    --grouper->_numQueued;
+                    grouper->_spaceAvailable.notify_one();
+
+                    // After an error, drain the queue so that the pipeline's thread isn't blocked.
+                    if (!partition->status.isOK()) {
+                        continue;
+                    }
+                }
+
+                try {
+                    grouper->accumulateBatch(partition, batch);
+                }
+                catch (const DBException& ex) {
+                    stdx::lock_guard<stdx::mutex> lk(grouper->_mutex);
+                    partition->status = ex.toStatus();
+                }
+            }
         }
+
+        void accumulateBatch(Partition* partition, const vector<pair<Value, Document> >& batch) {
+            for (size_t i = 0; i < batch.size(); i++) {
+                if (partition->memoryUsageBytes > _maxMemoryUsageBytes) {
+                    uassert(16945, "Exceeded memory limit for $group, but didn't allow external"
+                                   " sort. Pass allowDiskUse:true to opt in.",
+                            _group->_extSortAllowed);
+                    partition->sortedFiles.push_back(_group->spill(&partition->groups,
+                                                                   &partition->bytesSpilled));
+                    partition->memoryUsageBytes = 0;
+                }
+
+                partition->vars.setRoot(batch[i].second);
+                _group->accumulate(&partition->groups, &partition->vars, batch[i].first,
+                                   &partition->memoryUsageBytes);
+                partition->memoryCharge.update(partition->memoryUsageBytes);
+                partition->vars.clearRoot();
+                partition->peakMemoryBytes = std::max(partition->peakMemoryBytes,
+                                                      size_t(partition->memoryUsageBytes));
+            }
+        }
+
+        DocumentSourceGroup* const _group;
+        const int _maxMemoryUsageBytes; // for each partition
+        vector<std::unique_ptr<Partition> > _partitions;
+
+        stdx::mutex _mutex;
+        stdx::condition_variable _spaceAvailable;
+        size_t _numQueued; // batches queued over all partitions
+        bool _closed;
+
+        // Declared last so that its threads are joined before the rest is destroyed.
+        std::unique_ptr<ThreadPool> _pool;
     };
 
-    shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
-        vector<const GroupsMap::value_type*> ptrs; // using pointers to speed sorting
-        ptrs.reserve(groups.size());
-        for (GroupsMap::const_iterator it=groups.begin(), end=groups.end(); it != end; ++it) {
-            ptrs.push_back(&*it);
+    void DocumentSourceGroup::populateInParallel(
+            size_t degree,
+            vector<shared_ptr<Sorter<Value, Value>::Iterator> >* sortedFiles) {
+        ParallelGrouper grouper(this, degree);
+
+        while (boost::optional<Document> input = pSource->getNext()) {
+            _variables->setRoot(*input);
+
+            /* get the _id value */
+            Value id = computeId(_variables.get());
+
+            /* treat missing values the same as NULL SERVER-4674 */
+            if (id.missing())
+                id = Value(BSONNULL);
+
+            _variables->clearRoot();
+
+            grouper.add(id, *input);
         }
 
-        stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator());
+        vector<std::unique_ptr<ParallelGrouper::Partition> >& partitions = grouper.finish();
+
+        bool spilled = false;
+        for (size_t i = 0; i < partitions.size(); i++) {
+            spilled = spilled || !partitions[i]->sortedFiles.empty();
+
+            // The partitions may have peaked at different times, so this is an upper bound.
+            _stats.peakMemoryBytes += partitions[i]->peakMemoryBytes;
+            _stats.bytesSpilled += partitions[i]->bytesSpilled;
+        }
+
+        // The partitions have no _id in common, so their groups are returned one partition after
+        // the other, or merged from the sorted files of all of them if any spilled.
+        for (size_t i = 0; i < partitions.size(); i++) {
+            ParallelGrouper::Partition& partition = *partitions[i];
+            if (spilled) {
+                sortedFiles->insert(sortedFiles->end(),
+                                    partition.sortedFiles.begin(),
+                                    partition.sortedFiles.end());
+                if (!partition.groups.empty()) {
+                    sortedFiles->push_back(spill(&partition.groups, &_stats.bytesSpilled));
+                }
+            }
+            else if (!partition.groups.empty()) {
+                _partitions.push_back(std::move(partition.groups));
+                _memoryCharge.add(partition.memoryUsageBytes);
+            }
+        }
+    }
+
+    shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill(
+            GroupsMap* table,
+            unsigned long long* bytesSpilled) {
+        vector<size_t> order; // sorting group indexes rather than the groups themselves
+        order.reserve(table->size());
+        for (size_t i = 0; i < table->size(); i++) {
+            order.push_back(i);
+        }
+
+        stable_sort(order.begin(), order.end(), SpillSTLComparator(*table));
 
         SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-        switch (vpAccumulatorFactory.size()) { // same as ptrs[i]->second.size() for all i.
+        switch (vpAccumulatorFactory.size()) { // the number of states of every group
         case 0: // no values, essentially a distinct
-            for (size_t i=0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
+            for (size_t i=0; i < order.size(); i++) {
+                writer.addAlreadySorted(table->idAt(order[i]), Value());
             }
             break;
 
         case 1: // just one value, use optimized serialization as single Value
-            for (size_t i=0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+            for (size_t i=0; i < order.size(); i++) {
+                writer.addAlreadySorted(table->idAt(order[i]),
+                                        table->statesAt(order[i])[0]->getValue(
+                                            /*toBeMerged=*/true));
             }
             break;
 
         default: // multiple values, serialize as array-typed Value
-            for (size_t i=0; i < ptrs.size(); i++) {
+            for (size_t i=0; i < order.size(); i++) {
+                const intrusive_ptr<Accumulator>* group = table->statesAt(order[i]);
                 vector<Value> accums;
-                for (size_t j=0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+                for (size_t j=0; j < vpAccumulatorFactory.size(); j++) {
+                    accums.push_back(group[j]->getValue(/*toBeMerged=*/true));
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+                writer.addAlreadySorted(table->idAt(order[i]), Value(std::move(accums)));
             }
             break;
         }
 
-        groups.clear();
+        table->clear();
 
-        return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+        shared_ptr<Sorter<Value, Value>::Iterator> file(writer.done());
+        *bytesSpilled += writer.bytesWritten();
+        return file;
     }
 
     void DocumentSourceGroup::parseIdExpression(BSONElement groupField,
@@ -574,7 +1039,7 @@ namespace mongo {
     }
 
     Document DocumentSourceGroup::makeDocument(const Value& id,
-                                               const Accumulators& accums,
+                                               const intrusive_ptr<Accumulator>* accums,
                                                bool mergeableOutput) {
         const size_t n = vFieldName.size();
         MutableDocument out (1 + n);
@@ -625,7 +1090,8 @@ namespace mongo {
                 ExpressionFieldPath::parse("$$ROOT." + vFieldName[i], vps));
         }
 
-        pMerger->_variables.reset(new Variables(idGenerator.getIdCount()));
+        pMerger->_numVariables = idGenerator.getIdCount();
+        pMerger->_variables.reset(new Variables(pMerger->_numVariables));
 
         return pMerger;
     }
@@ -67,7 +67,7 @@ namespace mongo {
         return true;
     }
 
-    boost::optional<Document> DocumentSourceLimit::getNext() {
+    boost::optional<Document> DocumentSourceLimit::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         if (++count > limit) {
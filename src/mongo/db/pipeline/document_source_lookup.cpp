@@ -0,0 +1,392 @@
+/**
+ * Copyright (C) 2015 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects for
+ * all of the code used other than as permitted herein. If you modify file(s)
+ * with this exception, you may extend this exception to your version of the
+ * file(s), but you are not obligated to do so. If you do not wish to do so,
+ * delete this exception statement from your version. If you delete this
+ * exception statement from all source files in the program, then also delete
+ * it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source.h"
+
+#include <algorithm>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+    using boost::intrusive_ptr;
+    using std::pair;
+    using std::string;
+    using std::unique_ptr;
+    using std::vector;
+
+    // How many input documents share one $in query against the foreign index.
+    MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupBatchSize, int, 1000);
+
+    const char DocumentSourceLookUp::lookupName[] = "$lookup";
+
+namespace {
+    // The probes of a batch are also cut short at this many bytes of keys.
+    const int kMaxBatchKeyBytes = BSONObjMaxUserSize / 2;
+
+    class KeyComparator {
+    public:
+        typedef pair<Value, Document> Data;
+        int operator()(const Data& lhs, const Data& rhs) const {
+            return Value::compare(lhs.first, rhs.first);
+        }
+    };
+
+    bool keyLessThan(const Value& lhs, const Value& rhs) {
+        return Value::compare(lhs, rhs) < 0;
+    }
+}
+
+    DocumentSourceLookUp::DocumentSourceLookUp(const NamespaceString& fromNs,
+                                               const string& as,
+                                               const string& localField,
+                                               const string& foreignField,
+                                               const intrusive_ptr<ExpressionContext>& pExpCtx)
+        : DocumentSource(pExpCtx)
+        , _fromNs(fromNs)
+        , _as(as)
+        , _localField(localField)
+        , _foreignField(foreignField)
+        , _maxMemoryUsageBytes(100*1024*1024)
+        , _strategy(kUninitialized)
+    {}
+
+    const char* DocumentSourceLookUp::getSourceName() const {
+        return lookupName;
+    }
+
+    boost::optional<Document> DocumentSourceLookUp::doGetNext() {
+        pExpCtx->checkForInterrupt();
+
+        if (_strategy == kUninitialized)
+            initialize();
+
+        switch (_strategy) {
+        case kIndexProbe:
+            if (_joined.empty())
+                probeNextBatch();
+            if (_joined.empty())
+                return boost::none;
+            {
+                Document out = _joined.front();
+                _joined.pop_front();
+                return out;
+            }
+
+        case kHashTable:
+            if (boost::optional<Document> input = pSource->getNext())
+                return lookUp(_table, *input);
+            return boost::none;
+
+        case kSortMerge:
+            if (!_sortedOutput || !_sortedOutput->more())
+                return boost::none;
+            return _sortedOutput->next().second;
+
+        case kUninitialized:
+            break;
+        }
+        MONGO_UNREACHABLE;
+    }
+
+    void DocumentSourceLookUp::initialize() {
+        uassert(28750, "$lookup can only run on a mongod", _mongod);
+        uassert(28751, str::stream() << "$lookup can't join against sharded collection "
+                                     << _fromNs.ns(),
+                !_mongod->isSharded(_fromNs));
+
+        // Any index that leads with the foreign field can answer equality probes on it.
+        DBClientBase* conn = _mongod->directClient();
+        const string foreignField = _foreignField.getPath(false);
+        const std::list<BSONObj> indexes = conn->getIndexSpecs(_fromNs.ns());
+        for (std::list<BSONObj>::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
+            const BSONElement firstKey = it->getObjectField("key").firstElement();
+            if (firstKey.fieldNameStringData() == foreignField
+                    && (firstKey.isNumber() || firstKey.str() == "hashed")) {
+                _strategy = kIndexProbe;
+                return;
+            }
+        }
+
+        _strategy = kHashTable;
+        buildHashTable();
+    }
+
+    void DocumentSourceLookUp::probeNextBatch() {
+        vector<Document> inputs;
+        vector<Value> keys;
+        int keyBytes = 0;
+        while (inputs.size() < static_cast<size_t>(internalDocumentSourceLookupBatchSize)
+                && keyBytes < kMaxBatchKeyBytes) {
+            boost::optional<Document> input = pSource->getNext();
+            if (!input)
+                break;
+
+            inputs.push_back(*input);
+            keys.push_back(localKey(*input));
+            keyBytes += keys.back().getApproximateSize();
+        }
+
+        if (inputs.empty())
+            return;
+
+        // Probing for the keys in order walks the index once, front to back, no matter what
+        // order the input is in.
+        vector<Value> sortedKeys(keys);
+        std::sort(sortedKeys.begin(), sortedKeys.end(), keyLessThan);
+        BSONArrayBuilder inArray;
+        for (size_t i = 0; i < sortedKeys.size(); i++) {
+            if (i == 0 || Value::compare(sortedKeys[i - 1], sortedKeys[i]) != 0)
+                sortedKeys[i].addToBsonArray(&inArray);
+        }
+
+        // The query may return more than the exact matches, such as for regular expressions in
+        // the $in, so the batch is still joined through a hash table of the results.
+        HashTable table;
+        unique_ptr<DBClientCursor> cursor = _mongod->directClient()->query(
+            _fromNs.ns(),
+            BSON(_foreignField.getPath(false) << BSON("$in" << inArray.arr())));
+        uassert(28752, str::stream() << "$lookup failed to query " << _fromNs.ns(), cursor);
+        while (cursor->more()) {
+            addToTable(&table, cursor->nextSafe().getOwned());
+        }
+
+        for (size_t i = 0; i < inputs.size(); i++) {
+            HashTable::const_iterator it = table.find(keys[i]);
+            _joined.push_back(join(inputs[i], it == table.end() ? vector<Value>() : it->second));
+        }
+    }
+
+    void DocumentSourceLookUp::buildHashTable() {
+        unique_ptr<DBClientCursor> cursor = _mongod->directClient()->query(_fromNs.ns(), Query());
+        uassert(28753, str::stream() << "$lookup failed to query " << _fromNs.ns(), cursor);
+
+        int memoryUsageBytes = 0;
+        while (cursor->more()) {
+            BSONObj foreign = cursor->nextSafe().getOwned();
+            if (memoryUsageBytes > _maxMemoryUsageBytes) {
+                uassert(28754, "Exceeded memory limit for $lookup, but didn't allow external"
+                               " sort. Pass allowDiskUse:true to opt in.",
+                        pExpCtx->extSortAllowed && !pExpCtx->inRouter);
+                _strategy = kSortMerge;
+                sortMerge(foreign, cursor.get());
+                return;
+            }
+
+            memoryUsageBytes += addToTable(&_table, foreign);
+        }
+    }
+
+    void DocumentSourceLookUp::sortMerge(const BSONObj& first, DBClientCursor* cursor) {
+        SortOptions opts;
+        opts.maxMemoryUsageBytes = _maxMemoryUsageBytes;
+        opts.extSortAllowed = true;
+        opts.tempDir = pExpCtx->tempDir;
+
+        // The foreign documents, by key.
+        unique_ptr<MySorter> foreignSorter(MySorter::make(opts, KeyComparator()));
+        for (HashTable::const_iterator it = _table.begin(); it != _table.end(); ++it) {
+            for (size_t i = 0; i < it->second.size(); i++) {
+                foreignSorter->add(it->first, it->second[i].getDocument());
+            }
+        }
+        HashTable().swap(_table);
+
+        vector<Value> keys;
+        BSONObj foreign = first;
+        while (true) {
+            const Document doc(foreign);
+            foreignKeys(foreign, &keys);
+            for (size_t i = 0; i < keys.size(); i++) {
+                foreignSorter->add(keys[i], doc);
+            }
+
+            if (!cursor->more())
+                break;
+            foreign = cursor->nextSafe().getOwned();
+        }
+
+        // The input, by key then by position so that the output can be put back in order.
+        unique_ptr<MySorter> inputSorter(MySorter::make(opts, KeyComparator()));
+        long long position = 0;
+        while (boost::optional<Document> input = pSource->getNext()) {
+            inputSorter->add(Value(DOC_ARRAY(localKey(*input) << position++)), *input);
+        }
+
+        unique_ptr<MySorter::Iterator> foreignIt(foreignSorter->done());
+        unique_ptr<MySorter::Iterator> inputIt(inputSorter->done());
+        unique_ptr<MySorter> outputSorter(MySorter::make(opts, KeyComparator()));
+
+        boost::optional<MySorter::Data> nextForeign;
+        if (foreignIt->more())
+            nextForeign = foreignIt->next();
+
+        vector<Value> matches;
+        boost::optional<Value> matchesKey;
+        while (inputIt->more()) {
+            const MySorter::Data input = inputIt->next();
+            const Value key = input.first[0];
+            if (!matchesKey || Value::compare(*matchesKey, key) != 0) {
+                matches.clear();
+                while (nextForeign && Value::compare(nextForeign->first, key) <= 0) {
+                    if (Value::compare(nextForeign->first, key) == 0)
+                        matches.push_back(Value(nextForeign->second));
+
+                    nextForeign = boost::none;
+                    if (foreignIt->more())
+                        nextForeign = foreignIt->next();
+                }
+                matchesKey = key;
+            }
+
+            outputSorter->add(input.first[1], join(input.second, matches));
+        }
+
+        _sortedOutput.reset(outputSorter->done());
+    }
+
+    Value DocumentSourceLookUp::localKey(const Document& input) const {
+        const Value key = input.getNestedField(_localField);
+        return key.missing() ? Value(BSONNULL) : key;
+    }
+
+    void DocumentSourceLookUp::foreignKeys(const BSONObj& foreign, vector<Value>* keys) const {
+        keys->clear();
+        const BSONElement elem = foreign.getFieldDotted(_foreignField.getPath(false));
+        if (elem.eoo()) {
+            keys->push_back(Value(BSONNULL));
+            return;
+        }
+
+        keys->push_back(Value(elem));
+        if (elem.type() == Array) {
+            // Like the query would, match arrays by each of their elements too, once each.
+            BSONForEach(arrayElem, elem.Obj()) {
+                keys->push_back(Value(arrayElem));
+            }
+            std::sort(keys->begin(), keys->end(), keyLessThan);
+            keys->erase(std::unique(keys->begin(), keys->end()), keys->end());
+        }
+    }
+
+    int DocumentSourceLookUp::addToTable(HashTable* table, const BSONObj& foreign) const {
+        vector<Value> keys;
+        foreignKeys(foreign, &keys);
+
+        const Value doc((Document(foreign)));
+        int bytes = foreign.objsize();
+        for (size_t i = 0; i < keys.size(); i++) {
+            (*table)[keys[i]].push_back(doc);
+            bytes += keys[i].getApproximateSize() + sizeof(Value);
+        }
+        return bytes;
+    }
+
+    Document DocumentSourceLookUp::join(const Document& input,
+                                        const vector<Value>& matches) const {
+        MutableDocument out(input);
+        out.setNestedField(_as, Value(matches));
+        return out.freeze();
+    }
+
+    Document DocumentSourceLookUp::lookUp(const HashTable& table, const Document& input) const {
+        HashTable::const_iterator it = table.find(localKey(input));
+        return join(input, it == table.end() ? vector<Value>() : it->second);
+    }
+
+    void DocumentSourceLookUp::dispose() {
+        HashTable().swap(_table);
+        _joined.clear();
+        _sortedOutput.reset();
+        pSource->dispose();
+    }
+
+    Value DocumentSourceLookUp::serialize(bool explain) const {
+        return Value(DOC(getSourceName() << DOC("from" << _fromNs.coll()
+                                             << "as" << _as.getPath(false)
+                                             << "localField" << _localField.getPath(false)
+                                             << "foreignField" << _foreignField.getPath(false))));
+    }
+
+    DocumentSource::GetDepsReturn DocumentSourceLookUp::getDependencies(DepsTracker* deps) const {
+        deps->fields.insert(_localField.getPath(false));
+        return SEE_NEXT;
+    }
+
+    intrusive_ptr<DocumentSource> DocumentSourceLookUp::createFromBson(
+            BSONElement elem,
+            const intrusive_ptr<ExpressionContext>& pExpCtx) {
+        uassert(28755, "the $lookup specification must be an Object",
+                elem.type() == Object);
+
+        string from;
+        string as;
+        string localField;
+        string foreignField;
+        BSONForEach(argument, elem.Obj()) {
+            const StringData name = argument.fieldNameStringData();
+            uassert(28756, str::stream() << "$lookup argument '" << argument
+                                         << "' must be a string, is type " << argument.type(),
+                    argument.type() == String);
+
+            if (name == "from") {
+                from = argument.String();
+            }
+            else if (name == "as") {
+                as = argument.String();
+            }
+            else if (name == "localField") {
+                localField = argument.String();
+            }
+            else if (name == "foreignField") {
+                foreignField = argument.String();
+            }
+            else {
+                uasserted(28757, str::stream() << "unknown argument to $lookup: " << name);
+            }
+        }
+
+        uassert(28758, "$lookup requires 'from', 'as', 'localField' and 'foreignField'",
+                !from.empty() && !as.empty() && !localField.empty() && !foreignField.empty());
+
+        NamespaceString fromNs(pExpCtx->ns.db(), from);
+        uassert(28759, str::stream() << "invalid $lookup namespace: " << fromNs.ns(),
+                fromNs.isValid());
+
+        return new DocumentSourceLookUp(fromNs, as, localField, foreignField, pExpCtx);
+    }
+}
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
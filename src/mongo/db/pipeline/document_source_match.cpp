@@ -57,7 +57,7 @@ namespace mongo {
         return getQuery().isEmpty() ? nullptr : this;
     }
 
-    boost::optional<Document> DocumentSourceMatch::getNext() {
+    boost::optional<Document> DocumentSourceMatch::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         // The user facing error should have been generated earlier.
@@ -66,7 +66,8 @@ namespace mongo {
 
         while (boost::optional<Document> next = pSource->getNext()) {
             // The matcher only takes BSON documents, so we have to make one.
-            if (matcher->matches(next->toBson()))
+            const BSONObj obj = next->toBson();
+            if (_compiled ? _compiled->matchesBSON(obj) : matcher->matches(obj))
                 return next;
         }
 
@@ -96,13 +97,22 @@ namespace mongo {
         }
 
         // Replace our matcher with the $and of ours and theirs.
-        matcher.reset(new Matcher(BSON("$and" << BSON_ARRAY(getQuery() 
-                                              << otherMatch->getQuery())),
-                                  MatchExpressionParser::WhereCallback()));
+        resetMatcher(new Matcher(BSON("$and" << BSON_ARRAY(getQuery()
+                                             << otherMatch->getQuery())),
+                                 MatchExpressionParser::WhereCallback()));
 
         return true;
     }
 
+    void DocumentSourceMatch::resetMatcher(Matcher* newMatcher) {
+        // The compiled program points into the old matcher's expression.
+        _compiled.reset();
+        matcher.reset(newMatcher);
+        if (matcher->getMatchExpression()) {
+            _compiled.reset(CompiledMatchExpression::compile(matcher->getMatchExpression()));
+        }
+    }
+
 namespace {
     // This block contains the functions that make up the implementation of
     // DocumentSourceMatch::redactSafePortion(). They will only be called after
@@ -352,7 +362,7 @@ namespace {
     DocumentSourceMatch::DocumentSourceMatch(const BSONObj &query,
                                              const intrusive_ptr<ExpressionContext> &pExpCtx)
         : DocumentSource(pExpCtx),
-          matcher(new Matcher(query.getOwned(), MatchExpressionParser::WhereCallback())),
-          _isTextQuery(isTextQuery(query))
-    {}
+          _isTextQuery(isTextQuery(query)) {
+        resetMatcher(new Matcher(query.getOwned(), MatchExpressionParser::WhereCallback()));
+    }
 }
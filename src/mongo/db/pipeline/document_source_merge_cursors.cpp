@@ -132,6 +132,10 @@ namespace mongo {
                     "error reading response from " + _cursors.back()->connection->toString(),
                     ok);
             verify(!retry);
+
+            // From here on the cursor gets its batches through the connection pool, which lets it
+            // have the next one in flight while this one is merged. See nextSafeFrom().
+            (*it)->cursor.attach(&(*it)->connection);
         }
 
         _currentCursor = _cursors.begin();
@@ -139,6 +143,12 @@ namespace mongo {
 
     Document DocumentSourceMergeCursors::nextSafeFrom(DBClientCursor* cursor) {
         const BSONObj next = cursor->next();
+
+        // Asks the shard for its next batch as soon as the current one is being consumed, so that
+        // every shard works on a batch while the merge goes on, rather than one shard at a time
+        // when its batch runs out. This is a no-op while a getMore is outstanding already.
+        cursor->prefetchMore();
+
         if (next.hasField("$err")) {
             const int code = next.hasField("code") ? next["code"].numberInt() : 17029;
             uasserted(code, str::stream() << "Received error in response from "
@@ -148,10 +158,25 @@ namespace mongo {
         return Document::fromBsonWithMetaData(next);
     }
 
-    boost::optional<Document> DocumentSourceMergeCursors::getNext() {
+    boost::optional<Document> DocumentSourceMergeCursors::doGetNext() {
         if (_unstarted)
             start();
 
+        // Prefer a cursor with documents already at hand, so that a shard whose next batch is
+        // still in flight doesn't hold up merging what the other shards have returned.
+        if (!_cursors.empty()) {
+            Cursors::iterator it = _currentCursor;
+            do {
+                if ((*it)->cursor.moreInCurrentBatch()) {
+                    _currentCursor = it;
+                    break;
+                }
+
+                if (++it == _cursors.end())
+                    it = _cursors.begin();
+            } while (it != _currentCursor);
+        }
+
         // purge eof cursors and release their connections
         while (!_cursors.empty() && !(*_currentCursor)->cursor.more()) {
             (*_currentCursor)->connection.done();
@@ -42,8 +42,10 @@ namespace mongo {
             // Make sure we drop the temp collection if anything goes wrong. Errors are ignored
             // here because nothing can be done about them. Additionally, if this fails and the
             // collection is left behind, it will be cleaned up next time the server is started.
-            if (_mongod && _tempNs.size())
+            if (_mongod && _tempNs.size()) {
+                _mongod->finishBulkInsert();
                 _mongod->directClient()->dropCollection(_tempNs.ns());
+            }
         )
     }
 
@@ -74,9 +76,9 @@ namespace mongo {
                                              ));
 
         // Create output collection, copying options from existing collection if any.
+        const auto infos = conn->getCollectionInfos(_outputNs.db().toString(),
+                                                    BSON("name" << _outputNs.coll()));
         {
-            const auto infos = conn->getCollectionInfos(_outputNs.db().toString(),
-                                                        BSON("name" << _outputNs.coll()));
             const auto options = infos.empty() ? BSONObj()
                                                : infos.front().getObjectField("options");
 
@@ -85,37 +87,55 @@ namespace mongo {
             cmd << "temp" << true;
             cmd.appendElementsUnique(options);
 
-            BSONObj info;
-            bool ok = conn->runCommand(_outputNs.db().toString(), cmd.done(), info);
-            uassert(16994, str::stream() << "failed to create temporary $out collection '"
-                                         << _tempNs.ns() << "': " << info.toString(),
-                    ok);
+            // Without any indexes, not even on _id, until all the output is in.
+            try {
+                _mongod->createCollectionWithoutIndexes(_outputNs.db().toString(), cmd.done());
+            }
+            catch (const DBException& e) {
+                uasserted(16994, str::stream() << "failed to create temporary $out collection '"
+                                               << _tempNs.ns() << "': " << e.toString());
+            }
         }
 
-        // copy indexes on _outputNs to _tempNs
+        // The indexes on _outputNs are built on _tempNs by buildTempIndexes().
         const std::list<BSONObj> indexes = conn->getIndexSpecs(_outputNs);
         for (std::list<BSONObj>::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
             MutableDocument index((Document(*it)));
             index.remove("_id"); // indexes shouldn't have _ids but some existing ones do
             index["ns"] = Value(_tempNs.ns());
+            _tempIndexes.push_back(index.freeze().toBson());
+        }
 
-            BSONObj indexBson = index.freeze().toBson();
-            conn->insert(_tempNs.getSystemIndexesCollection(), indexBson);
-            BSONObj err = conn->getLastErrorDetailed();
-            uassert(16995, str::stream() << "copying index for $out failed."
-                                         << " index: " << indexBson
-                                         << " error: " <<  err,
-                    DBClientWithCommands::getLastErrorString(err).empty());
+        // A new output collection gets the _id index creating it would have built.
+        if (infos.empty()) {
+            _tempIndexes.push_back(BSON("name" << "_id_"
+                                     << "ns" << _tempNs.ns()
+                                     << "key" << BSON("_id" << 1)));
         }
     }
 
     void DocumentSourceOut::spill(const vector<BSONObj>& toInsert) {
-        BSONObj err = _mongod->insert(_tempNs, toInsert);
+        BSONObj err = _mongod->bulkInsert(_tempNs, toInsert);
         uassert(16996, str::stream() << "insert for $out failed: " << err,
                 DBClientWithCommands::getLastErrorString(err).empty());
     }
 
-    boost::optional<Document> DocumentSourceOut::getNext() {
+    void DocumentSourceOut::buildTempIndexes() {
+        _mongod->finishBulkInsert();
+
+        if (_tempIndexes.empty())
+            return;
+
+        try {
+            _mongod->buildIndexes(_tempNs, _tempIndexes);
+        }
+        catch (const DBException& e) {
+            uasserted(16995, str::stream() << "building indexes for $out failed: "
+                                           << e.toString());
+        }
+    }
+
+    boost::optional<Document> DocumentSourceOut::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         // make sure we only write out once
@@ -145,6 +165,8 @@ namespace mongo {
         if (!bufferedObjects.empty())
             spill(bufferedObjects);
 
+        buildTempIndexes();
+
         // Checking again to make sure we didn't become sharded while running.
         uassert(17018, str::stream() << "namespace '" << _outputNs.ns()
                                      << "' became sharded so it can't be used for $out'",
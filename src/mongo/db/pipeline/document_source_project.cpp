@@ -54,7 +54,7 @@ namespace mongo {
         return projectName;
     }
 
-    boost::optional<Document> DocumentSourceProject::getNext() {
+    boost::optional<Document> DocumentSourceProject::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         boost::optional<Document> input = pSource->getNext();
@@ -82,6 +82,7 @@ namespace mongo {
     intrusive_ptr<DocumentSource> DocumentSourceProject::optimize() {
         intrusive_ptr<Expression> pE(pEO->optimize());
         pEO = boost::dynamic_pointer_cast<ExpressionObject>(pE);
+        pEO->compile();
         return this;
     }
 
@@ -120,6 +121,44 @@ namespace mongo {
         return pProject;
     }
 
+    bool DocumentSourceProject::getRenamedFields(std::map<string, string>* fields) const {
+        fields->clear();
+        bool includeId = true;
+        BSONForEach(elem, _raw) {
+            const StringData name = elem.fieldNameStringData();
+            if (name.find('.') != string::npos) {
+                return false;
+            }
+
+            if (elem.type() == String) {
+                const StringData path = elem.valueStringData();
+                if (!path.startsWith("$") || path.startsWith("$$")) {
+                    return false;
+                }
+                (*fields)[name.toString()] = path.substr(1).toString();
+            }
+            else if (elem.isBoolean() || elem.isNumber()) {
+                if (elem.trueValue()) {
+                    (*fields)[name.toString()] = name.toString();
+                }
+                else if (name == "_id") {
+                    includeId = false;
+                }
+                else {
+                    return false;
+                }
+            }
+            else {
+                return false;
+            }
+        }
+
+        if (includeId && !fields->count("_id")) {
+            (*fields)["_id"] = "_id";
+        }
+        return true;
+    }
+
     DocumentSource::GetDepsReturn DocumentSourceProject::getDependencies(DepsTracker* deps) const {
         vector<string> path; // empty == top-level
         pEO->addDependencies(deps, &path);
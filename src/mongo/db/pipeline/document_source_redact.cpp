@@ -58,7 +58,7 @@ namespace mongo {
     static const Value pruneVal = Value("prune");
     static const Value keepVal = Value("keep");
 
-    boost::optional<Document> DocumentSourceRedact::getNext() {
+    boost::optional<Document> DocumentSourceRedact::doGetNext() {
         while (boost::optional<Document> in = pSource->getNext()) {
             _variables->setRoot(*in);
             _variables->setValue(_currentId, Value(*in));
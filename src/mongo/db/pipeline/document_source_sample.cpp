@@ -0,0 +1,200 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using boost::intrusive_ptr;
+
+    const char DocumentSourceSample::sampleName[] = "$sample";
+
+    DocumentSourceSample::DocumentSourceSample(const intrusive_ptr<ExpressionContext> &pExpCtx,
+                                               long long size)
+        : DocumentSource(pExpCtx)
+        , _size(size)
+        , _maxMemoryUsageBytes(100*1024*1024)
+        , _random(std::unique_ptr<SecureRandom>(SecureRandom::create())->nextInt64())
+    {}
+
+    const char *DocumentSourceSample::getSourceName() const {
+        return sampleName;
+    }
+
+    boost::optional<Document> DocumentSourceSample::doGetNext() {
+        pExpCtx->checkForInterrupt();
+
+        if (!_populated)
+            populate();
+
+        if (_returned == _reservoir.size())
+            return boost::none;
+
+        return std::move(_reservoir[_returned++]);
+    }
+
+    void DocumentSourceSample::populate() {
+        _populated = true;
+
+        // Every document seen so far has had the same chance to be in the reservoir.
+        long long seen = 0;
+        size_t memoryUsageBytes = 0;
+        while (boost::optional<Document> input = pSource->getNext()) {
+            seen++;
+            size_t slot = _reservoir.size();
+            if (seen <= _size) {
+                _reservoir.push_back(Document());
+            }
+            else {
+                // This one replaces a kept one with a chance of _size / seen.
+                slot = static_cast<unsigned long long>(_random.nextInt64()) % seen;
+                if (slot >= _reservoir.size())
+                    continue;
+                memoryUsageBytes -= _reservoir[slot].getApproximateSize();
+            }
+
+            _reservoir[slot] = std::move(*input);
+            memoryUsageBytes += _reservoir[slot].getApproximateSize();
+            _stats.peakMemoryBytes = std::max(_stats.peakMemoryBytes, memoryUsageBytes);
+            uassert(28793, str::stream() << "Exceeded memory limit for " << sampleName
+                                         << " with a size of " << _size,
+                    memoryUsageBytes <= static_cast<size_t>(_maxMemoryUsageBytes));
+        }
+
+        // The reservoir holds the documents it kept in the order they came in.
+        std::random_shuffle(_reservoir.begin(), _reservoir.end(), _random);
+    }
+
+    void DocumentSourceSample::dispose() {
+        _reservoir.clear();
+        _returned = 0;
+        pSource->dispose();
+    }
+
+    Value DocumentSourceSample::serialize(bool explain) const {
+        return Value(DOC(getSourceName() << DOC("size" << _size)));
+    }
+
+    intrusive_ptr<DocumentSource> DocumentSourceSample::createFromBson(
+            BSONElement elem,
+            const intrusive_ptr<ExpressionContext> &pExpCtx) {
+        uassert(28789, str::stream() << sampleName
+                                     << " requires an object as its specification, like"
+                                     << " {size: 100}",
+                elem.type() == Object);
+
+        boost::optional<long long> size;
+        BSONForEach(option, elem.embeddedObject()) {
+            const StringData name = option.fieldNameStringData();
+            if (name == "size") {
+                uassert(28790, str::stream() << sampleName
+                                             << " size must be a non-negative number",
+                        option.isNumber() && option.numberLong() >= 0);
+                size = option.numberLong();
+            }
+            else {
+                uasserted(28791, str::stream() << "unrecognized option to " << sampleName
+                                               << ": " << name);
+            }
+        }
+        uassert(28792, str::stream() << sampleName << " requires a size", size);
+
+        return new DocumentSourceSample(pExpCtx, *size);
+    }
+
+namespace {
+    // How many duplicates in a row DocumentSourceSampleFromRandomCursor takes before giving up,
+    // which should only happen if there are far fewer documents than records were counted.
+    const int kMaxDuplicatesInARow = 100;
+}
+
+    const char DocumentSourceSampleFromRandomCursor::sampleFromRandomCursorName[] =
+        "$sampleFromRandomCursor";
+
+    DocumentSourceSampleFromRandomCursor::DocumentSourceSampleFromRandomCursor(
+            const intrusive_ptr<ExpressionContext> &pExpCtx,
+            long long size)
+        : DocumentSource(pExpCtx)
+        , _size(size)
+    {}
+
+    intrusive_ptr<DocumentSourceSampleFromRandomCursor>
+    DocumentSourceSampleFromRandomCursor::create(
+            const intrusive_ptr<ExpressionContext> &pExpCtx,
+            long long size) {
+        return new DocumentSourceSampleFromRandomCursor(pExpCtx, size);
+    }
+
+    const char *DocumentSourceSampleFromRandomCursor::getSourceName() const {
+        return sampleFromRandomCursorName;
+    }
+
+    boost::optional<Document> DocumentSourceSampleFromRandomCursor::doGetNext() {
+        pExpCtx->checkForInterrupt();
+
+        if (_returned >= _size)
+            return boost::none;
+
+        for (int i = 0; i < kMaxDuplicatesInARow; i++) {
+            boost::optional<Document> next = pSource->getNext();
+            if (!next) // an empty collection
+                return boost::none;
+
+            // Documents without an _id can't be told apart, so none of them are duplicates.
+            const Value id = (*next)["_id"];
+            if (id.missing() || _seenIds.insert(id).second) {
+                _returned++;
+                return next;
+            }
+        }
+
+        uasserted(28794, str::stream() << DocumentSourceSample::sampleName
+                                       << " found only duplicates of the "
+                                       << _returned << " documents returned in "
+                                       << kMaxDuplicatesInARow << " random documents");
+    }
+
+    Value DocumentSourceSampleFromRandomCursor::serialize(bool explain) const {
+        return Value(DOC(getSourceName() << DOC("size" << _size)));
+    }
+
+    DocumentSource::GetDepsReturn DocumentSourceSampleFromRandomCursor::getDependencies(
+            DepsTracker* deps) const {
+        deps->fields.insert("_id");
+        return SEE_NEXT;
+    }
+}
@@ -65,7 +65,7 @@ namespace mongo {
         return true;
     }
 
-    boost::optional<Document> DocumentSourceSkip::getNext() {
+    boost::optional<Document> DocumentSourceSkip::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         if (_needToSkip) {
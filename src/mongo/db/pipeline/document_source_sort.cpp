@@ -51,7 +51,7 @@ namespace mongo {
         return sortName;
     }
 
-    boost::optional<Document> DocumentSourceSort::getNext() {
+    boost::optional<Document> DocumentSourceSort::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         if (!populated)
@@ -137,6 +137,32 @@ namespace mongo {
         return keyObj.freeze();
     }
 
+    BSONObj DocumentSourceSort::serializeSortKeyBefore(
+            const std::map<string, string>& fields) const {
+        BSONObjBuilder keyObj;
+        for (size_t i = 0; i < vSortKey.size(); ++i) {
+            ExpressionFieldPath* efp = dynamic_cast<ExpressionFieldPath*>(vSortKey[i].get());
+            if (!efp) {
+                return BSONObj();
+            }
+
+            // The first field is ROOT and the second the one the stage before creates.
+            const FieldPath& withVariable = efp->getFieldPath();
+            const std::map<string, string>::const_iterator it =
+                fields.find(withVariable.getFieldName(1));
+            if (it == fields.end()) {
+                return BSONObj();
+            }
+
+            string fieldPath = it->second;
+            if (withVariable.getPathLength() > 2) {
+                fieldPath += "." + withVariable.tail().tail().getPath(false);
+            }
+            keyObj.append(fieldPath, vAscending[i] ? 1 : -1);
+        }
+        return keyObj.obj();
+    }
+
     DocumentSource::GetDepsReturn DocumentSourceSort::getDependencies(DepsTracker* deps) const {
         for(size_t i = 0; i < vSortKey.size(); ++i) {
             vSortKey[i]->addDependencies(deps);
@@ -220,6 +246,7 @@ namespace mongo {
         if (pExpCtx->extSortAllowed && !pExpCtx->inRouter) {
             opts.extSortAllowed = true;
             opts.tempDir = pExpCtx->tempDir;
+            opts.fileReadAhead = true;
         }
 
         return opts;
@@ -240,8 +267,10 @@ namespace mongo {
             unique_ptr<MySorter> sorter (MySorter::make(makeSortOptions(), Comparator(*this)));
             while (boost::optional<Document> next = pSource->getNext()) {
                 sorter->add(extractKey(*next), *next);
+                _stats.peakMemoryBytes = std::max(_stats.peakMemoryBytes, sorter->memUsed());
             }
             _output.reset(sorter->done());
+            _stats.bytesSpilled = sorter->bytesSpilled();
         }
         populated = true;
     }
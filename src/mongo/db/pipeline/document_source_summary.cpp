@@ -0,0 +1,93 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/value.h"
+
+namespace mongo {
+
+    using boost::intrusive_ptr;
+
+    const char DocumentSourceSummary::summaryName[] = "$summary";
+
+    DocumentSourceSummary::DocumentSourceSummary(const intrusive_ptr<ExpressionContext> &pExpCtx,
+                                                 const std::string& indexName,
+                                                 const BSONObj& query,
+                                                 std::vector<Document> partialGroups)
+        : DocumentSource(pExpCtx)
+        , _indexName(indexName)
+        , _query(query.getOwned())
+        , _partialGroups(std::move(partialGroups))
+    {}
+
+    intrusive_ptr<DocumentSourceSummary> DocumentSourceSummary::create(
+            const intrusive_ptr<ExpressionContext> &pExpCtx,
+            const std::string& indexName,
+            const BSONObj& query,
+            std::vector<Document> partialGroups) {
+        return new DocumentSourceSummary(pExpCtx, indexName, query, std::move(partialGroups));
+    }
+
+    const char *DocumentSourceSummary::getSourceName() const {
+        return summaryName;
+    }
+
+    boost::optional<Document> DocumentSourceSummary::doGetNext() {
+        pExpCtx->checkForInterrupt();
+
+        if (_returned == _partialGroups.size())
+            return boost::none;
+
+        return std::move(_partialGroups[_returned++]);
+    }
+
+    void DocumentSourceSummary::setSource(DocumentSource *pSource) {
+        /* this doesn't take a source */
+        verify(false);
+    }
+
+    void DocumentSourceSummary::dispose() {
+        _partialGroups.clear();
+        _returned = 0;
+    }
+
+    Value DocumentSourceSummary::serialize(bool explain) const {
+        if (!explain) {
+            // only ever created in place of the stages it stands for
+            return Value();
+        }
+        return Value(DOC(getSourceName() << DOC("index" << _indexName
+                                                << "query" << _query
+                                                << "groups" << static_cast<long long>(
+                                                    _partialGroups.size()))));
+    }
+}
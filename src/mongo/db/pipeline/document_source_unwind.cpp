@@ -61,7 +61,7 @@ namespace mongo {
         const FieldPath _unwindPath;
 
         Value _inputArray;
-        MutableDocument _output;
+        Document _input;
 
         // Document indexes of the field path components.
         vector<Position> _unwindPathFieldIndexes;
@@ -77,7 +77,7 @@ namespace mongo {
 
         // Reset document specific attributes.
         _inputArray = Value();
-        _output.reset(document);
+        _input = document;
         _unwindPathFieldIndexes.clear();
         _index = 0;
 
@@ -88,32 +88,33 @@ namespace mongo {
         }
 
         _inputArray = pathValue;
+
+        // The output of a previous $unwind can't be overlaid again, so copy its fields once here
+        // rather than for every element.
+        if (_input.isOverlay() && _inputArray.getType() == Array
+                               && _inputArray.getArrayLength() > 1) {
+            _input = _input.clone();
+        }
     }
 
     boost::optional<Document> DocumentSourceUnwind::Unwinder::getNext() {
         if (_inputArray.missing())
             return boost::none;
 
-        // If needed, this will automatically clone all the documents along the
-        // field path so that the end values are not shared across documents
-        // that have come out of this pipeline operator.  This is a partial deep
-        // clone. Because the value at the end will be replaced, everything
-        // along the path leading to that will be replaced in order not to share
-        // that change with any other clones (or the original).
+        // Each output document overlays the input document, and each document along the field
+        // path, with just the replaced field. The other fields are shared with the input rather
+        // than copied, so unwinding an array of n elements doesn't copy the document n times.
 
         if (_inputArray.getType() == Array) {
             if (_index == _inputArray.getArrayLength())
                 return boost::none;
-            _output.setNestedField(_unwindPathFieldIndexes, _inputArray[_index]);
+            return _input.overlayNestedField(_unwindPathFieldIndexes, _inputArray[_index++]);
         }
         else if (_index > 0) {
             return boost::none;
         }
-        else {
-            //_output.setNestedField(_unwindPathFieldIndexes, _inputArray);
-        }
         _index++;
-        return _output.peek();
+        return _input;
     }
 
     const char DocumentSourceUnwind::unwindName[] = "$unwind";
@@ -127,7 +128,7 @@ namespace mongo {
         return unwindName;
     }
 
-    boost::optional<Document> DocumentSourceUnwind::getNext() {
+    boost::optional<Document> DocumentSourceUnwind::doGetNext() {
         pExpCtx->checkForInterrupt();
 
         boost::optional<Document> out = _unwinder->getNext();
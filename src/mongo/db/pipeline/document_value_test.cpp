@@ -296,6 +296,103 @@ namespace DocumentTests {
             }
         };
 
+        /** Lazily converted Document. */
+        class LazyFromBson {
+        public:
+            void run() {
+                const BSONObj obj = fromjson( "{a:1,b:{c:'x'},d:[1,2],e:'lal'}" );
+                const Document document = Document::fromBsonWithMetaDataLazy( obj );
+
+                // Reading fields by name or converting back to BSON doesn't convert the fields.
+                ASSERT_EQUALS( Value(1), document["a"] );
+                ASSERT_EQUALS( Value("x"), document["b"].getDocument()["c"] );
+                ASSERT( document["z"].missing() );
+                ASSERT_EQUALS( obj.objdata(), document.toBson().objdata() );
+
+                // Equal to the same document converted up front, with its fields in order.
+                ASSERT_EQUALS( fromBson( obj ), document );
+                ASSERT_EQUALS( 4U, document.size() );
+                ASSERT_EQUALS( "d", getNthField(document, 2).first.toString() );
+                assertRoundTrips( document );
+
+                // Modifying a copy leaves the original unchanged.
+                const Document lazy = Document::fromBsonWithMetaDataLazy( obj );
+                MutableDocument md( lazy );
+                md.setField( "a", Value(2) );
+                md.addField( "f", Value(3) );
+                ASSERT_EQUALS( obj, lazy.toBson() );
+                ASSERT_EQUALS( fromjson( "{a:2,b:{c:'x'},d:[1,2],e:'lal',f:3}" ),
+                               md.freeze().toBson() );
+
+                // Metadata is still parsed out.
+                const Document withScore = Document::fromBsonWithMetaDataLazy(
+                        BSON( "a" << 1 << Document::metaFieldTextScore << 2.5 ) );
+                ASSERT( withScore.hasTextScore() );
+                ASSERT_EQUALS( 2.5, withScore.getTextScore() );
+                ASSERT_EQUALS( BSON( "a" << 1 ), withScore.toBson() );
+            }
+        };
+
+        /** Overlaying a nested field, as $unwind does. */
+        class OverlayNestedField {
+        public:
+            void run() {
+                MutableDocument base( fromBson( fromjson( "{a:1,b:{c:[1,2],d:'x'},e:'lal'}" ) ) );
+                base.setTextScore( 1.5 );
+                const Document input = base.freeze();
+
+                vector<Position> positions;
+                ASSERT_EQUALS( Value(BSON_ARRAY(1 << 2)),
+                               input.getNestedField( FieldPath( "b.c" ), &positions ) );
+                const Document overlay = input.overlayNestedField( positions, Value(2) );
+                ASSERT( overlay.isOverlay() );
+                ASSERT( !input.isOverlay() );
+
+                // Reads by name, by position and in order see the replaced field.
+                ASSERT_EQUALS( Value(1), overlay["a"] );
+                ASSERT_EQUALS( Value(2), overlay["b"].getDocument()["c"] );
+                ASSERT_EQUALS( Value(2), overlay.getNestedField( FieldPath( "b.c" ) ) );
+                ASSERT_EQUALS( Value("lal"), overlay[overlay.positionOf( "e" )] );
+                ASSERT_EQUALS( 3U, overlay.size() );
+                ASSERT_EQUALS( "e", getNthField(overlay, 2).first.toString() );
+                const BSONObj expected = fromjson( "{a:1,b:{c:2,d:'x'},e:'lal'}" );
+                ASSERT_EQUALS( expected, overlay.toBson() );
+                ASSERT_EQUALS( fromBson( expected ), overlay );
+                ASSERT( overlay.hasTextScore() );
+                ASSERT_EQUALS( 1.5, overlay.getTextScore() );
+                assertRoundTrips( overlay );
+
+                // A top-level field.
+                positions.clear();
+                input.getNestedField( FieldPath( "e" ), &positions );
+                ASSERT_EQUALS( fromjson( "{a:1,b:{c:[1,2],d:'x'},e:3}" ),
+                               input.overlayNestedField( positions, Value(3) ).toBson() );
+
+                // Modifying an overlay, or a copy of it, leaves the input unchanged.
+                MutableDocument md( overlay );
+                md.setField( "a", Value(5) );
+                md.addField( "f", Value(6) );
+                ASSERT_EQUALS( fromjson( "{a:5,b:{c:2,d:'x'},e:'lal',f:6}" ),
+                               md.freeze().toBson() );
+                ASSERT_EQUALS( expected, overlay.toBson() );
+                ASSERT_EQUALS( fromjson( "{a:1,b:{c:[1,2],d:'x'},e:'lal'}" ), input.toBson() );
+
+                // A clone isn't an overlay.
+                const Document cloned = overlay.clone();
+                ASSERT( !cloned.isOverlay() );
+                ASSERT_EQUALS( overlay, cloned );
+                ASSERT_EQUALS( 1.5, cloned.getTextScore() );
+
+                // Overlaying an overlay copies it instead.
+                positions.clear();
+                overlay.getNestedField( FieldPath( "a" ), &positions );
+                const Document twice = overlay.overlayNestedField( positions, Value(7) );
+                ASSERT( !twice.isOverlay() );
+                ASSERT_EQUALS( fromjson( "{a:7,b:{c:2,d:'x'},e:'lal'}" ), twice.toBson() );
+                ASSERT_EQUALS( expected, overlay.toBson() );
+            }
+        };
+
         /** FieldIterator for an empty Document. */
         class FieldIteratorEmpty {
         public:
@@ -1427,6 +1524,8 @@ namespace DocumentTests {
             add<Document::Compare>();
             add<Document::Clone>();
             add<Document::CloneMultipleFields>();
+            add<Document::LazyFromBson>();
+            add<Document::OverlayNestedField>();
             add<Document::FieldIteratorEmpty>();
             add<Document::FieldIteratorSingle>();
             add<Document::FieldIteratorMultiple>();
@@ -37,6 +37,7 @@
 #include "mongo/base/init.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression_compiled.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/stdx/functional.h"
@@ -305,7 +306,7 @@ namespace mongo {
 namespace {
     typedef stdx::function<intrusive_ptr<Expression>(BSONElement, const VariablesParseState&)>
             ExpressionParser;
-    StringMap<ExpressionParser> expressionParserMap;
+    FlatStringMap<ExpressionParser> expressionParserMap;
 }
 
 /** Registers an ExpressionParser so it can be called from parseExpression and friends.
@@ -316,7 +317,7 @@ namespace {
 #define REGISTER_EXPRESSION(key, parserFunc) \
     MONGO_INITIALIZER(BOOST_PP_CAT(addToExpressionParserMap, __LINE__))(InitializerContext*) { \
         /* prevent duplicate expressions */ \
-        StringMap<ExpressionParser>::const_iterator op = expressionParserMap.find(key); \
+        FlatStringMap<ExpressionParser>::const_iterator op = expressionParserMap.find(key); \
         massert(17064, str::stream() << "Duplicate expression (" << key << ") detected at " \
                                      << __FILE__ << ":" << __LINE__, \
                 op == expressionParserMap.end()); \
@@ -331,7 +332,7 @@ namespace {
 
         /* look for the specified operator */
         const char* opName = exprElement.fieldName();
-        StringMap<ExpressionParser>::const_iterator op = expressionParserMap.find(opName);
+        FlatStringMap<ExpressionParser>::const_iterator op = expressionParserMap.find(opName);
         uassert(15999, str::stream() << "invalid operator '" << opName << "'",
                 op != expressionParserMap.end());
 
@@ -1141,6 +1142,18 @@ namespace {
         return intrusive_ptr<Expression>(this);
     }
 
+    void ExpressionObject::compile() {
+        for (FieldMap::iterator it(_expressions.begin()); it!=_expressions.end(); ++it) {
+            if (!it->second)
+                continue; // an inclusion
+
+            if (ExpressionObject* nested = dynamic_cast<ExpressionObject*>(it->second.get()))
+                nested->compile();
+            else
+                it->second = ExpressionCompiled::compile(it->second);
+        }
+    }
+
     bool ExpressionObject::isSimple() {
         for (FieldMap::iterator it(_expressions.begin()); it!=_expressions.end(); ++it) {
             if (it->second && !it->second->isSimple())
@@ -323,6 +323,8 @@ namespace mongo {
             BSONElement bsonExpr,
             const VariablesParseState& vps);
 
+        const ExpressionVector& getOperands() const { return vpOperand; }
+
     protected:
         ExpressionNary() {}
 
@@ -414,6 +416,7 @@ namespace mongo {
         static boost::intrusive_ptr<ExpressionCoerceToBool> create(
             const boost::intrusive_ptr<Expression> &pExpression);
 
+        const boost::intrusive_ptr<Expression>& getOperand() const { return pExpression; }
 
     private:
         ExpressionCoerceToBool(const boost::intrusive_ptr<Expression> &pExpression);
@@ -449,6 +452,8 @@ namespace mongo {
 
         ExpressionCompare(CmpOp cmpOp);
 
+        CmpOp getOp() const { return cmpOp; }
+
     private:
         CmpOp cmpOp;
     };
@@ -903,6 +908,12 @@ namespace mongo {
 
         void excludeId(bool b) { _excludeId = b; }
 
+        /**
+         * Replaces the expression of each computed field, at any depth, with its
+         * ExpressionCompiled if it has one. Call after optimize().
+         */
+        void compile();
+
     private:
         ExpressionObject(bool atRoot);
 
@@ -0,0 +1,643 @@
+// expression_compiled.cpp
+
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/expression_compiled.h"
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <cmath>
+
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+    using boost::intrusive_ptr;
+    using std::string;
+    using std::vector;
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalAggregateCompileExpressions, bool, true);
+
+namespace {
+    // Truth values of -1, 0 and 1 for each ExpressionCompare::CmpOp but CMP.
+    const bool cmpTruthValues[6][3] = {
+        /* EQ  */ { false, true,  false },
+        /* NE  */ { true,  false, true },
+        /* GT  */ { false, false, true },
+        /* GTE */ { false, true,  true },
+        /* LT  */ { true,  false, false },
+        /* LTE */ { true,  true,  false },
+    };
+}
+
+    CompiledExpression* CompiledExpression::compile(const Expression* expr) {
+        if (!internalAggregateCompileExpressions) {
+            return NULL;
+        }
+
+        std::unique_ptr<CompiledExpression> program(new CompiledExpression());
+        program->_result = program->compileNode(expr);
+
+        // Nothing is gained over a constant, or over a node the tree evaluates anyway.
+        if (program->_program.empty()
+                || (program->_program.size() == 1 && program->_program[0].op == kEvaluate)) {
+            return NULL;
+        }
+
+        // The slots don't move from here on, so the strings loaded into them can be viewed.
+        program->_slots.resize(program->_numSlots);
+        for (size_t i = 0; i < program->_constants.size(); i++) {
+            load(&program->_slots[program->_constants[i].first], program->_constants[i].second);
+        }
+
+        return program.release();
+    }
+
+    size_t CompiledExpression::emit(const Instruction& instruction) {
+        _program.push_back(instruction);
+        return _program.size() - 1;
+    }
+
+    int CompiledExpression::compileNode(const Expression* expr) {
+        if (const ExpressionConstant* constant = dynamic_cast<const ExpressionConstant*>(expr)) {
+            const int slot = newSlot();
+            _constants.push_back(std::make_pair(slot, constant->getValue()));
+            return slot;
+        }
+
+        const int dst = newSlot();
+
+        if (const ExpressionCoerceToBool* coerce
+                = dynamic_cast<const ExpressionCoerceToBool*>(expr)) {
+            Instruction instruction(kCoerceToBool, dst);
+            instruction.args.push_back(compileNode(coerce->getOperand().get()));
+            emit(instruction);
+            return dst;
+        }
+
+        const ExpressionNary* nary = dynamic_cast<const ExpressionNary*>(expr);
+        if (!nary) {
+            Instruction instruction(kEvaluate, dst);
+            instruction.expr = expr;
+            emit(instruction);
+            return dst;
+        }
+
+        const vector<intrusive_ptr<Expression> >& operands = nary->getOperands();
+
+        const bool isAnd = dynamic_cast<const ExpressionAnd*>(expr);
+        if (isAnd || dynamic_cast<const ExpressionOr*>(expr)) {
+            // Stop at the first operand that decides the result, as the tree does.
+            vector<size_t> shortCircuits;
+            for (size_t i = 0; i < operands.size(); i++) {
+                Instruction test(isAnd ? kJumpIfFalse : kJumpIfTrue, dst);
+                test.args.push_back(compileNode(operands[i].get()));
+                shortCircuits.push_back(emit(test));
+            }
+
+            Instruction allPassed(kSetBool, dst);
+            allPassed.flag = isAnd;
+            emit(allPassed);
+            const size_t toEnd = emit(Instruction(kJump, dst));
+
+            Instruction shortCircuited(kSetBool, dst);
+            shortCircuited.flag = !isAnd;
+            const size_t shortCircuitTarget = emit(shortCircuited);
+            for (size_t i = 0; i < shortCircuits.size(); i++) {
+                _program[shortCircuits[i]].target = shortCircuitTarget;
+            }
+            _program[toEnd].target = _program.size();
+            return dst;
+        }
+
+        if (dynamic_cast<const ExpressionCond*>(expr)) {
+            Instruction test(kJumpIfFalse, dst);
+            test.args.push_back(compileNode(operands[0].get()));
+            const size_t toElse = emit(test);
+
+            Instruction moveThen(kMove, dst);
+            moveThen.args.push_back(compileNode(operands[1].get()));
+            emit(moveThen);
+            const size_t toEnd = emit(Instruction(kJump, dst));
+
+            _program[toElse].target = _program.size();
+            Instruction moveElse(kMove, dst);
+            moveElse.args.push_back(compileNode(operands[2].get()));
+            emit(moveElse);
+
+            _program[toEnd].target = _program.size();
+            return dst;
+        }
+
+        if (dynamic_cast<const ExpressionIfNull*>(expr)) {
+            const int left = compileNode(operands[0].get());
+            Instruction test(kJumpIfNotNullish, dst);
+            test.args.push_back(left);
+            const size_t toLeft = emit(test);
+
+            Instruction moveRight(kMove, dst);
+            moveRight.args.push_back(compileNode(operands[1].get()));
+            emit(moveRight);
+            const size_t toEnd = emit(Instruction(kJump, dst));
+
+            _program[toLeft].target = _program.size();
+            Instruction moveLeft(kMove, dst);
+            moveLeft.args.push_back(left);
+            emit(moveLeft);
+
+            _program[toEnd].target = _program.size();
+            return dst;
+        }
+
+        // The rest evaluate all their operands first.
+        Instruction instruction(kEvaluate, dst);
+        if (dynamic_cast<const ExpressionAdd*>(expr)) {
+            instruction.op = kAdd;
+        }
+        else if (dynamic_cast<const ExpressionMultiply*>(expr)) {
+            instruction.op = kMultiply;
+        }
+        else if (dynamic_cast<const ExpressionSubtract*>(expr)) {
+            instruction.op = kSubtract;
+        }
+        else if (dynamic_cast<const ExpressionDivide*>(expr)) {
+            instruction.op = kDivide;
+        }
+        else if (dynamic_cast<const ExpressionMod*>(expr)) {
+            instruction.op = kMod;
+        }
+        else if (const ExpressionCompare* compare = dynamic_cast<const ExpressionCompare*>(expr)) {
+            instruction.op = kCompare;
+            instruction.flag = compare->getOp();
+        }
+        else if (dynamic_cast<const ExpressionNot*>(expr)) {
+            instruction.op = kNot;
+        }
+        else if (dynamic_cast<const ExpressionConcat*>(expr)) {
+            instruction.op = kConcat;
+        }
+        else if (dynamic_cast<const ExpressionToLower*>(expr)) {
+            instruction.op = kToLower;
+        }
+        else if (dynamic_cast<const ExpressionToUpper*>(expr)) {
+            instruction.op = kToUpper;
+        }
+        else if (dynamic_cast<const ExpressionSubstr*>(expr)) {
+            instruction.op = kSubstr;
+        }
+        else {
+            instruction.expr = expr;
+            emit(instruction);
+            return dst;
+        }
+
+        for (size_t i = 0; i < operands.size(); i++) {
+            instruction.args.push_back(compileNode(operands[i].get()));
+        }
+        emit(instruction);
+        return dst;
+    }
+
+    void CompiledExpression::load(Slot* slot, const Value& value) {
+        switch (value.getType()) {
+        case EOO:
+            slot->kind = kMissing;
+            return;
+        case jstNULL:
+            slot->kind = kNull;
+            return;
+        case Bool:
+            slot->kind = kBool;
+            slot->boolValue = value.getBool();
+            return;
+        case NumberInt:
+            slot->kind = kInt;
+            slot->longValue = value.getInt();
+            return;
+        case NumberLong:
+            slot->kind = kLong;
+            slot->longValue = value.getLong();
+            return;
+        case NumberDouble:
+            slot->kind = kDouble;
+            slot->doubleValue = value.getDouble();
+            return;
+        case String:
+            slot->kind = kString;
+            slot->value = value;
+            slot->stringValue = slot->value.getStringData();
+            return;
+        default:
+            slot->kind = kValue;
+            slot->value = value;
+            return;
+        }
+    }
+
+    Value CompiledExpression::box(const Slot& slot) {
+        switch (slot.kind) {
+        case kMissing: return Value();
+        case kNull: return Value(BSONNULL);
+        case kBool: return Value(slot.boolValue);
+        case kInt: return Value(static_cast<int>(slot.longValue));
+        case kLong: return Value(slot.longValue);
+        case kDouble: return Value(slot.doubleValue);
+        case kString:
+            if (slot.value.getType() == String
+                    && slot.value.getStringData().rawData() == slot.stringValue.rawData()
+                    && slot.value.getStringData().size() == slot.stringValue.size()) {
+                return slot.value; // as loaded, no need to copy it
+            }
+            return Value(slot.stringValue);
+        case kValue: return slot.value;
+        }
+        MONGO_UNREACHABLE;
+    }
+
+    bool CompiledExpression::isNullish(const Slot& slot) {
+        return slot.kind == kMissing
+            || slot.kind == kNull
+            || (slot.kind == kValue && slot.value.nullish());
+    }
+
+    bool CompiledExpression::coerceToBool(const Slot& slot) {
+        switch (slot.kind) {
+        case kMissing:
+        case kNull:
+            return false;
+        case kBool:
+            return slot.boolValue;
+        case kInt:
+        case kLong:
+            return slot.longValue;
+        case kDouble:
+            return slot.doubleValue;
+        case kString:
+            return true;
+        case kValue:
+            return slot.value.coerceToBool();
+        }
+        MONGO_UNREACHABLE;
+    }
+
+    double CompiledExpression::coerceToDouble(const Slot& slot) {
+        return slot.kind == kDouble ? slot.doubleValue : static_cast<double>(slot.longValue);
+    }
+
+    long long CompiledExpression::coerceToLong(const Slot& slot) {
+        return slot.kind == kDouble ? static_cast<long long>(slot.doubleValue) : slot.longValue;
+    }
+
+    int CompiledExpression::coerceToInt(const Slot& slot) {
+        return static_cast<int>(slot.kind == kDouble ? slot.doubleValue : slot.longValue);
+    }
+
+    bool CompiledExpression::runArithmetic(const Instruction& instruction, Slot* dst) const {
+        if (instruction.op == kAdd || instruction.op == kMultiply) {
+            // Like the tree, compute in double and long at once while tracking the widest type.
+            const bool add = instruction.op == kAdd;
+            double doubleTotal = add ? 0 : 1;
+            long long longTotal = add ? 0 : 1;
+            Kind totalKind = kInt;
+            for (size_t i = 0; i < instruction.args.size(); i++) {
+                const Slot& arg = _slots[instruction.args[i]];
+                if (isNumeric(arg)) {
+                    totalKind = std::max(totalKind, arg.kind);
+                    const long long argLong = coerceToLong(arg);
+                    if (add) {
+                        doubleTotal += coerceToDouble(arg);
+                        longTotal += argLong;
+                    }
+                    else {
+                        doubleTotal *= coerceToDouble(arg);
+                        longTotal *= argLong;
+                    }
+                }
+                else if (isNullish(arg)) {
+                    dst->kind = kNull;
+                    return true;
+                }
+                else {
+                    return false; // dates, or an error
+                }
+            }
+
+            if (totalKind == kDouble) {
+                dst->kind = kDouble;
+                dst->doubleValue = doubleTotal;
+            }
+            else {
+                dst->kind = (totalKind == kInt && static_cast<int>(longTotal) == longTotal)
+                          ? kInt : kLong;
+                dst->longValue = longTotal;
+            }
+            return true;
+        }
+
+        const Slot& lhs = _slots[instruction.args[0]];
+        const Slot& rhs = _slots[instruction.args[1]];
+        if (!isNumeric(lhs) || !isNumeric(rhs)) {
+            if (isNullish(lhs) || isNullish(rhs)) {
+                dst->kind = kNull;
+                return true;
+            }
+            return false; // dates, or an error
+        }
+
+        if (instruction.op == kDivide) {
+            const double denom = coerceToDouble(rhs);
+            if (denom == 0)
+                return false; // leave the error to the tree
+
+            dst->kind = kDouble;
+            dst->doubleValue = coerceToDouble(lhs) / denom;
+            return true;
+        }
+
+        invariant(instruction.op == kSubtract);
+        const Kind diffKind = std::max(lhs.kind, rhs.kind);
+        if (diffKind == kDouble) {
+            dst->kind = kDouble;
+            dst->doubleValue = coerceToDouble(lhs) - coerceToDouble(rhs);
+        }
+        else {
+            const long long diff = lhs.longValue - rhs.longValue;
+            dst->kind = (diffKind == kInt && static_cast<int>(diff) == diff) ? kInt : kLong;
+            dst->longValue = diff;
+        }
+        return true;
+    }
+
+    bool CompiledExpression::runMod(const Instruction& instruction, Slot* dst) const {
+        const Slot& lhs = _slots[instruction.args[0]];
+        const Slot& rhs = _slots[instruction.args[1]];
+        if (!isNumeric(lhs) || !isNumeric(rhs)) {
+            if (isNullish(lhs) || isNullish(rhs)) {
+                dst->kind = kNull;
+                return true;
+            }
+            return false;
+        }
+
+        const double right = coerceToDouble(rhs);
+        if (right == 0)
+            return false; // leave the error to the tree
+
+        if (lhs.kind == kDouble
+                || (rhs.kind == kDouble && coerceToInt(rhs) != right)) {
+            dst->kind = kDouble;
+            dst->doubleValue = fmod(coerceToDouble(lhs), right);
+        }
+        else if (lhs.kind == kLong || rhs.kind == kLong) {
+            dst->kind = kLong;
+            dst->longValue = coerceToLong(lhs) % coerceToLong(rhs);
+        }
+        else {
+            dst->kind = kInt;
+            dst->longValue = coerceToInt(lhs) % coerceToInt(rhs);
+        }
+        return true;
+    }
+
+    bool CompiledExpression::runCompare(const Instruction& instruction, Slot* dst) const {
+        const Slot& lhs = _slots[instruction.args[0]];
+        const Slot& rhs = _slots[instruction.args[1]];
+
+        int cmp;
+        if (lhs.kind == kString && rhs.kind == kString) {
+            cmp = lhs.stringValue.compare(rhs.stringValue);
+        }
+        else {
+            // Only strings are expensive to box.
+            cmp = Value::compare(box(lhs), box(rhs));
+        }
+        cmp = cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+
+        if (instruction.flag == ExpressionCompare::CMP) {
+            dst->kind = kInt;
+            dst->longValue = cmp;
+        }
+        else {
+            dst->kind = kBool;
+            dst->boolValue = cmpTruthValues[instruction.flag][cmp + 1];
+        }
+        return true;
+    }
+
+    bool CompiledExpression::runString(const Instruction& instruction, Slot* dst) const {
+        dst->buffer.clear();
+        if (instruction.op == kConcat) {
+            for (size_t i = 0; i < instruction.args.size(); i++) {
+                const Slot& arg = _slots[instruction.args[i]];
+                if (isNullish(arg)) {
+                    dst->kind = kNull;
+                    return true;
+                }
+                if (arg.kind != kString)
+                    return false; // leave the error to the tree
+
+                dst->buffer.append(arg.stringValue.rawData(), arg.stringValue.size());
+            }
+        }
+        else {
+            // Nullish values convert to the empty string, other types are left to the tree.
+            const Slot& arg = _slots[instruction.args[0]];
+            if (arg.kind == kString) {
+                dst->buffer.assign(arg.stringValue.rawData(), arg.stringValue.size());
+            }
+            else if (!isNullish(arg)) {
+                return false;
+            }
+
+            if (instruction.op == kToLower) {
+                boost::to_lower(dst->buffer);
+            }
+            else {
+                boost::to_upper(dst->buffer);
+            }
+        }
+
+        dst->kind = kString;
+        dst->stringValue = StringData(dst->buffer);
+        return true;
+    }
+
+    bool CompiledExpression::runSubstr(const Instruction& instruction, Slot* dst) const {
+        const Slot& string = _slots[instruction.args[0]];
+        const Slot& lowerSlot = _slots[instruction.args[1]];
+        const Slot& lengthSlot = _slots[instruction.args[2]];
+
+        StringData str;
+        if (string.kind == kString) {
+            str = string.stringValue;
+        }
+        else if (!isNullish(string)) {
+            return false; // other types convert to strings through the tree
+        }
+
+        if (!isNumeric(lowerSlot) || !isNumeric(lengthSlot))
+            return false; // leave the error to the tree
+
+        const size_t lower = static_cast<size_t>(coerceToLong(lowerSlot));
+        const size_t length = static_cast<size_t>(coerceToLong(lengthSlot));
+
+        // Both ends must be on UTF-8 character boundaries, or the tree raises an error.
+        const auto isContinuationByte = [](char c) { return ((c & 0xc0) == 0x80); };
+        if ((lower < str.size() && isContinuationByte(str[lower]))
+                || (lower + length < str.size() && isContinuationByte(str[lower + length]))) {
+            return false;
+        }
+
+        // A view into the string's slot, which nothing writes to again during this evaluation.
+        dst->kind = kString;
+        dst->stringValue = lower >= str.size() ? StringData() : str.substr(lower, length);
+        return true;
+    }
+
+    bool CompiledExpression::evaluate(Variables* vars, Value* out) const {
+        try {
+            size_t pc = 0;
+            while (pc < _program.size()) {
+                const Instruction& instruction = _program[pc];
+                Slot* dst = &_slots[instruction.dst];
+                switch (instruction.op) {
+                case kEvaluate:
+                    load(dst, instruction.expr->evaluateInternal(vars));
+                    break;
+
+                case kAdd:
+                case kMultiply:
+                case kSubtract:
+                case kDivide:
+                    if (!runArithmetic(instruction, dst))
+                        return false;
+                    break;
+
+                case kMod:
+                    if (!runMod(instruction, dst))
+                        return false;
+                    break;
+
+                case kCompare:
+                    runCompare(instruction, dst);
+                    break;
+
+                case kCoerceToBool:
+                case kNot:
+                    dst->kind = kBool;
+                    dst->boolValue = coerceToBool(_slots[instruction.args[0]])
+                                  != (instruction.op == kNot);
+                    break;
+
+                case kConcat:
+                case kToLower:
+                case kToUpper:
+                    if (!runString(instruction, dst))
+                        return false;
+                    break;
+
+                case kSubstr:
+                    if (!runSubstr(instruction, dst))
+                        return false;
+                    break;
+
+                case kSetBool:
+                    dst->kind = kBool;
+                    dst->boolValue = instruction.flag;
+                    break;
+
+                case kMove: {
+                    // The source isn't written to again during this evaluation, so its string
+                    // can be viewed rather than copied.
+                    const Slot& src = _slots[instruction.args[0]];
+                    dst->kind = src.kind;
+                    dst->boolValue = src.boolValue;
+                    dst->longValue = src.longValue;
+                    dst->doubleValue = src.doubleValue;
+                    dst->stringValue = src.stringValue;
+                    if (src.kind == kValue)
+                        dst->value = src.value;
+                    break;
+                }
+
+                case kJump:
+                    pc = instruction.target;
+                    continue;
+
+                case kJumpIfFalse:
+                    if (!coerceToBool(_slots[instruction.args[0]])) {
+                        pc = instruction.target;
+                        continue;
+                    }
+                    break;
+
+                case kJumpIfTrue:
+                    if (coerceToBool(_slots[instruction.args[0]])) {
+                        pc = instruction.target;
+                        continue;
+                    }
+                    break;
+
+                case kJumpIfNotNullish:
+                    if (!isNullish(_slots[instruction.args[0]])) {
+                        pc = instruction.target;
+                        continue;
+                    }
+                    break;
+                }
+                ++pc;
+            }
+        }
+        catch (const DBException&) {
+            // An operand the tree might not have evaluated, or might evaluate to the same error.
+            return false;
+        }
+
+        *out = box(_slots[_result]);
+        return true;
+    }
+
+    intrusive_ptr<Expression> ExpressionCompiled::compile(const intrusive_ptr<Expression>& expr) {
+        CompiledExpression* program = CompiledExpression::compile(expr.get());
+        if (!program)
+            return expr;
+        return new ExpressionCompiled(expr, program);
+    }
+
+    Value ExpressionCompiled::evaluateInternal(Variables* vars) const {
+        Value result;
+        if (_program->evaluate(vars, &result))
+            return result;
+        return _expr->evaluateInternal(vars);
+    }
+
+}  // namespace mongo
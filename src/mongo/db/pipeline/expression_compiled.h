@@ -0,0 +1,214 @@
+// expression_compiled.h
+
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/value.h"
+
+namespace mongo {
+
+    /**
+     * A flat evaluation program for an aggregation Expression.
+     *
+     * Every node of the tree writes its result to a typed slot, so arithmetic, comparisons,
+     * boolean operators, $cond, $ifNull and string operations over numbers, booleans and strings
+     * don't box their intermediate results in Values, and strings are passed around as views.
+     * $and, $or, $cond and $ifNull jump over the operands they don't need.  Constants are loaded
+     * into their slots once; field paths and nodes that aren't compiled are evaluated through
+     * the tree into a slot.
+     *
+     * Whenever a compiled operation meets a type it doesn't specialize, or would fail, the
+     * program gives up and the caller evaluates the whole tree instead, which produces the same
+     * result or error.
+     *
+     * Holds pointers into the Expression it was compiled from, which must outlive it.  The slots
+     * belong to the program, so it must not be evaluated by two threads at once.
+     */
+    class CompiledExpression {
+        MONGO_DISALLOW_COPYING(CompiledExpression);
+    public:
+        /**
+         * Returns NULL if the root of 'expr' isn't an operation that can be compiled, in which
+         * case callers should just use 'expr'.  Otherwise the caller owns the result.
+         */
+        static CompiledExpression* compile(const Expression* expr);
+
+        /**
+         * Sets '*out' to what expr->evaluateInternal(vars) returns for the 'expr' this was
+         * compiled from, and returns true.  Returns false, leaving '*out' alone, if the tree has
+         * to evaluate this input.
+         */
+        bool evaluate(Variables* vars, Value* out) const;
+
+        size_t numInstructions() const { return _program.size(); }
+
+    private:
+        enum Kind {
+            kMissing,
+            kNull,
+            kBool,
+            kInt, // in longValue
+            kLong,
+            kDouble,
+            kString, // a view, valid until the next evaluation
+            kValue, // any other type, in value
+        };
+
+        struct Slot {
+            Slot() : kind(kMissing), boolValue(false), longValue(0), doubleValue(0) { }
+
+            Kind kind;
+            bool boolValue;
+            long long longValue;
+            double doubleValue;
+            StringData stringValue;
+
+            // Holds the Value loaded from the tree, which stringValue may point into.
+            Value value;
+
+            // Holds the strings the program builds, which stringValue may point into.
+            std::string buffer;
+        };
+
+        enum OpCode {
+            kEvaluate, // expr->evaluateInternal() into dst
+            kAdd,
+            kMultiply,
+            kSubtract,
+            kDivide,
+            kMod,
+            kCompare,
+            kCoerceToBool,
+            kNot,
+            kConcat,
+            kToLower,
+            kToUpper,
+            kSubstr,
+            kSetBool, // 'flag' into dst
+            kMove, // args[0] into dst
+            kJump, // to 'target'
+            kJumpIfFalse, // to 'target' unless args[0] is true
+            kJumpIfTrue,
+            kJumpIfNotNullish,
+        };
+
+        struct Instruction {
+            Instruction(OpCode op, int dst)
+                : op(op), dst(dst), target(0), flag(0), expr(NULL) { }
+
+            OpCode op;
+            int dst;
+            std::vector<int> args;
+            size_t target;
+            int flag; // the CmpOp of kCompare, the value of kSetBool
+            const Expression* expr; // for kEvaluate
+        };
+
+        CompiledExpression() { }
+
+        /**
+         * Appends the instructions that evaluate 'expr' and returns the slot holding its result.
+         */
+        int compileNode(const Expression* expr);
+
+        int newSlot() { return _numSlots++; }
+
+        /// Appends an instruction and returns its position in the program.
+        size_t emit(const Instruction& instruction);
+
+        /// Loads 'value' into 'slot', viewing any string in the Value it keeps.
+        static void load(Slot* slot, const Value& value);
+
+        /// The Value of 'slot'.  Only allocates for long strings.
+        static Value box(const Slot& slot);
+
+        static bool isNumeric(const Slot& slot) {
+            return slot.kind == kInt || slot.kind == kLong || slot.kind == kDouble;
+        }
+
+        static bool isNullish(const Slot& slot);
+        static bool coerceToBool(const Slot& slot);
+        static double coerceToDouble(const Slot& slot);
+        static long long coerceToLong(const Slot& slot);
+        static int coerceToInt(const Slot& slot);
+
+        bool runArithmetic(const Instruction& instruction, Slot* dst) const;
+        bool runMod(const Instruction& instruction, Slot* dst) const;
+        bool runCompare(const Instruction& instruction, Slot* dst) const;
+        bool runString(const Instruction& instruction, Slot* dst) const;
+        bool runSubstr(const Instruction& instruction, Slot* dst) const;
+
+        std::vector<Instruction> _program;
+        int _numSlots = 0;
+        int _result = 0;
+
+        // The constants the compiler found, loaded into their slots once they all exist.
+        std::vector<std::pair<int, Value> > _constants;
+
+        mutable std::vector<Slot> _slots;
+    };
+
+    /**
+     * Evaluates an Expression through its CompiledExpression, falling back to the Expression when
+     * the program gives up.  Otherwise behaves exactly like the Expression it wraps.
+     */
+    class ExpressionCompiled final : public Expression {
+    public:
+        /**
+         * Returns an ExpressionCompiled wrapping 'expr' if it compiles, or 'expr' if it doesn't.
+         */
+        static boost::intrusive_ptr<Expression> compile(const boost::intrusive_ptr<Expression>& expr);
+
+        boost::intrusive_ptr<Expression> optimize() final { return this; }
+        bool isSimple() final { return _expr->isSimple(); }
+        void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const final {
+            _expr->addDependencies(deps, path);
+        }
+        Value serialize(bool explain) const final { return _expr->serialize(explain); }
+        Value evaluateInternal(Variables* vars) const final;
+
+    private:
+        ExpressionCompiled(const boost::intrusive_ptr<Expression>& expr,
+                           CompiledExpression* program)
+            : _expr(expr), _program(program) { }
+
+        const boost::intrusive_ptr<Expression> _expr;
+        const std::unique_ptr<CompiledExpression> _program;
+    };
+
+}  // namespace mongo
@@ -59,6 +59,9 @@ namespace mongo {
         bool extSortAllowed = false;
         bool bypassDocumentValidation = false;
 
+        // How many threads the "parallelism" option asked to filter the input documents on.
+        int parallelism = 0;
+
         NamespaceString ns;
         std::string tempDir; // Defaults to empty to prevent external sorting in mongos.
 
@@ -0,0 +1,161 @@
+/**
+*    Copyright (C) 2015 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/db/pipeline/value.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    /**
+     * The groups of a $group, keyed on their _id.
+     *
+     * An open-addressing hash table with linear probing. The slots only hold the hash and the
+     * index of a group, so probing stays within a small contiguous array. The _ids and the
+     * per-group states (one per accumulator) are stored contiguously, in insertion order, rather
+     * than in one heap node and one vector per group.
+     *
+     * 'State' is what the table stores for each accumulator of each group. The states of a group
+     * are adjacent, so findOrInsert() returns a pointer to the first one. That pointer, like any
+     * returned by statesAt(), is only valid until the next insertion.
+     */
+    template <typename State>
+    class GroupTable {
+    public:
+        explicit GroupTable(size_t numStates) : _numStates(numStates), _mask(0) {}
+
+        size_t size() const { return _ids.size(); }
+        bool empty() const { return _ids.empty(); }
+
+        /**
+         * Returns the states of the group for 'id', adding a group with default constructed
+         * states if there is none yet. Sets '*inserted' to whether a group was added.
+         */
+        State* findOrInsert(const Value& id, bool* inserted) {
+            if ((_ids.size() + 1) * 2 > _slots.size()) {
+                grow();
+            }
+
+            const uint32_t hash = hashOf(id);
+            size_t slot = hash & _mask;
+            while (_slots[slot].group != kEmpty) {
+                if (_slots[slot].hash == hash && _ids[_slots[slot].group] == id) {
+                    *inserted = false;
+                    return statesAt(_slots[slot].group);
+                }
+                slot = (slot + 1) & _mask;
+            }
+
+            uassert(28631, "too many groups in $group", _ids.size() < kEmpty);
+            _slots[slot].hash = hash;
+            _slots[slot].group = _ids.size();
+            _ids.push_back(id);
+            _states.resize(_states.size() + _numStates);
+            *inserted = true;
+            return statesAt(_ids.size() - 1);
+        }
+
+        /// The _id of the 'group'-th group inserted.
+        const Value& idAt(size_t group) const { return _ids[group]; }
+
+        /// The states of the 'group'-th group inserted.
+        State* statesAt(size_t group) {
+            return _numStates ? &_states[group * _numStates] : NULL;
+        }
+        const State* statesAt(size_t group) const {
+            return _numStates ? &_states[group * _numStates] : NULL;
+        }
+
+        /**
+         * Bytes used by the table for each group, not counting what the _id and the states
+         * point to. Slots are kept at most half full, so each group accounts for two.
+         */
+        size_t bytesPerGroup() const {
+            return sizeof(Value) + _numStates * sizeof(State) + 2 * sizeof(Slot);
+        }
+
+        /// Removes all groups and frees the memory of the table.
+        void clear() {
+            std::vector<Slot>().swap(_slots);
+            std::vector<Value>().swap(_ids);
+            std::vector<State>().swap(_states);
+            _mask = 0;
+        }
+
+        /// Like clear(), also changing the number of states per group.
+        void reset(size_t numStates) {
+            clear();
+            _numStates = numStates;
+        }
+
+    private:
+        static const uint32_t kEmpty = static_cast<uint32_t>(-1);
+        static const size_t kInitialSlots = 16;
+
+        struct Slot {
+            Slot() : hash(0), group(kEmpty) {}
+            uint32_t hash;
+            uint32_t group;
+        };
+
+        static uint32_t hashOf(const Value& id) {
+            const size_t hash = Value::Hash()(id);
+            return static_cast<uint32_t>(hash ^ (static_cast<uint64_t>(hash) >> 32));
+        }
+
+        /// Doubles the number of slots, reinserting the groups from their saved hashes.
+        void grow() {
+            const size_t numSlots = _slots.empty() ? kInitialSlots : _slots.size() * 2;
+            std::vector<Slot> slots(numSlots);
+            const size_t mask = numSlots - 1;
+            for (size_t i = 0; i < _slots.size(); ++i) {
+                if (_slots[i].group == kEmpty) {
+                    continue;
+                }
+                size_t slot = _slots[i].hash & mask;
+                while (slots[slot].group != kEmpty) {
+                    slot = (slot + 1) & mask;
+                }
+                slots[slot] = _slots[i];
+            }
+            _slots.swap(slots);
+            _mask = mask;
+        }
+
+        size_t _numStates;
+        size_t _mask; // _slots.size() - 1, which is a power of 2
+        std::vector<Slot> _slots;
+        std::vector<Value> _ids;
+        std::vector<State> _states;
+    };
+
+} // namespace mongo
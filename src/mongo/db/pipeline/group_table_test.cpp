@@ -0,0 +1,103 @@
+/**
+*    Copyright (C) 2015 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/group_table.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    TEST(GroupTableTest, FindsInsertedGroups) {
+        GroupTable<int> table(2);
+        ASSERT(table.empty());
+
+        for (int i = 0; i < 1000; i++) {
+            bool inserted;
+            int* states = table.findOrInsert(Value(i), &inserted);
+            ASSERT(inserted);
+            ASSERT_EQUALS(0, states[0]);
+            ASSERT_EQUALS(0, states[1]);
+            states[0] = i;
+            states[1] = -i;
+        }
+        ASSERT_EQUALS(1000U, table.size());
+
+        for (int i = 0; i < 1000; i++) {
+            bool inserted;
+            int* states = table.findOrInsert(Value(i), &inserted);
+            ASSERT(!inserted);
+            ASSERT_EQUALS(i, states[0]);
+            ASSERT_EQUALS(-i, states[1]);
+        }
+        ASSERT_EQUALS(1000U, table.size());
+    }
+
+    TEST(GroupTableTest, IteratesInInsertionOrder) {
+        GroupTable<int> table(1);
+        bool inserted;
+        table.findOrInsert(Value("b"), &inserted)[0] = 1;
+        table.findOrInsert(Value("a"), &inserted)[0] = 2;
+        table.findOrInsert(Value("b"), &inserted)[0] += 10;
+
+        ASSERT_EQUALS(2U, table.size());
+        ASSERT_EQUALS(Value("b"), table.idAt(0));
+        ASSERT_EQUALS(11, table.statesAt(0)[0]);
+        ASSERT_EQUALS(Value("a"), table.idAt(1));
+        ASSERT_EQUALS(2, table.statesAt(1)[0]);
+    }
+
+    TEST(GroupTableTest, EqualNumbersAreOneGroup) {
+        GroupTable<int> table(0);
+        bool inserted;
+        table.findOrInsert(Value(1), &inserted);
+        ASSERT(inserted);
+        table.findOrInsert(Value(1LL), &inserted);
+        ASSERT(!inserted);
+        table.findOrInsert(Value(1.0), &inserted);
+        ASSERT(!inserted);
+        ASSERT_EQUALS(1U, table.size());
+        ASSERT(NULL == table.statesAt(0));
+    }
+
+    TEST(GroupTableTest, Reset) {
+        GroupTable<int> table(1);
+        bool inserted;
+        table.findOrInsert(Value(1), &inserted)[0] = 5;
+        table.reset(3);
+        ASSERT(table.empty());
+
+        int* states = table.findOrInsert(Value(1), &inserted);
+        ASSERT(inserted);
+        ASSERT_EQUALS(0, states[0] + states[1] + states[2]);
+    }
+
+} // namespace
+} // namespace mongo
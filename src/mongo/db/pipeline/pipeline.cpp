@@ -61,6 +61,7 @@ namespace mongo {
 
     Pipeline::Pipeline(const intrusive_ptr<ExpressionContext> &pTheCtx):
         explain(false),
+        _explainExecutionStats(false),
         pCtx(pTheCtx) {
     }
 
@@ -80,6 +81,8 @@ namespace mongo {
          DocumentSourceGroup::createFromBson},
         {DocumentSourceLimit::limitName,
          DocumentSourceLimit::createFromBson},
+        {DocumentSourceLookUp::lookupName,
+         DocumentSourceLookUp::createFromBson},
         {DocumentSourceMatch::matchName,
          DocumentSourceMatch::createFromBson},
         {DocumentSourceMergeCursors::name,
@@ -90,6 +93,8 @@ namespace mongo {
          DocumentSourceProject::createFromBson},
         {DocumentSourceRedact::redactName,
          DocumentSourceRedact::createFromBson},
+        {DocumentSourceSample::sampleName,
+         DocumentSourceSample::createFromBson},
         {DocumentSourceSkip::skipName,
          DocumentSourceSkip::createFromBson},
         {DocumentSourceSort::sortName,
@@ -144,7 +149,20 @@ namespace mongo {
 
             /* check for explain option */
             if (!strcmp(pFieldName, explainName)) {
-                pPipeline->explain = cmdElement.Bool();
+                if (cmdElement.type() == String) {
+                    // The verbosities of the explain command that apply to aggregate.
+                    uassert(28770,
+                            str::stream() << "explain must be a bool, \"queryPlanner\" or"
+                                          << " \"executionStats\", not \""
+                                          << cmdElement.valuestr() << "\"",
+                            cmdElement.str() == "queryPlanner"
+                                || cmdElement.str() == "executionStats");
+                    pPipeline->explain = true;
+                    pPipeline->_explainExecutionStats = cmdElement.str() == "executionStats";
+                }
+                else {
+                    pPipeline->explain = cmdElement.Bool();
+                }
                 continue;
             }
 
@@ -168,6 +186,15 @@ namespace mongo {
                 continue;
             }
 
+            if (str::equals(pFieldName, "parallelism")) {
+                uassert(28712,
+                        str::stream() << "parallelism must be a non-negative number, not "
+                                      << cmdElement.toString(false),
+                        cmdElement.isNumber() && cmdElement.numberInt() >= 0);
+                pCtx->parallelism = cmdElement.numberInt();
+                continue;
+            }
+
             /* we didn't recognize a field in the command */
             ostringstream sb;
             sb << "unrecognized field '" << cmdElement.fieldName() << "'";
@@ -217,6 +244,8 @@ namespace mongo {
             if (dynamic_cast<DocumentSourceOut*>(stage.get())) {
                 uassert(16991, "$out can only be the final stage in the pipeline",
                         iStep == nSteps - 1);
+                uassert(28771, "explain: \"executionStats\" can't run a pipeline with $out",
+                        !pPipeline->_explainExecutionStats);
             }
         }
 
@@ -365,6 +394,17 @@ namespace mongo {
 
                 out->push_back(Privilege(ResourcePattern::forExactNamespace(outputNs), actions));
             }
+            else if (str::equals(stage.firstElementFieldName(), "$lookup")
+                     && stage.firstElement().type() == Object) {
+                NamespaceString fromNs(db, stage.firstElement().Obj()["from"].str());
+                uassert(28760,
+                        mongoutils::str::stream() << "Invalid $lookup namespace, " <<
+                        fromNs.ns(),
+                        fromNs.isValid());
+
+                out->push_back(Privilege(ResourcePattern::forExactNamespace(fromNs),
+                                         ActionType::find));
+            }
         }
     }
 
@@ -374,6 +414,7 @@ namespace mongo {
         // the pipelines to be more efficient.
         intrusive_ptr<Pipeline> shardPipeline(new Pipeline(pCtx));
         shardPipeline->explain = explain;
+        shardPipeline->_explainExecutionStats = _explainExecutionStats;
 
         // The order in which optimizations are applied can have significant impact on the
         // efficiency of the final pipeline. Be Careful!
@@ -492,7 +533,10 @@ namespace mongo {
         serialized.setField(commandName, Value(pCtx->ns.coll()));
         serialized.setField(pipelineName, Value(array));
 
-        if (explain) {
+        if (_explainExecutionStats) {
+            serialized.setField(explainName, Value("executionStats"));
+        }
+        else if (explain) {
             serialized.setField(explainName, Value(explain));
         }
 
@@ -504,6 +548,10 @@ namespace mongo {
             serialized.setField(bypassDocumentValidationCommandOption(), Value(true));
         }
 
+        if (pCtx->parallelism > 0) {
+            serialized.setField("parallelism", Value(pCtx->parallelism));
+        }
+
         return serialized.freeze();
     }
 
@@ -550,11 +598,46 @@ namespace mongo {
     vector<Value> Pipeline::writeExplainOps() const {
         vector<Value> array;
         for(SourceContainer::const_iterator it = sources.begin(); it != sources.end(); ++it) {
+            const size_t first = array.size();
             (*it)->serializeToArray(array, /*explain=*/true);
+
+            if (_explainExecutionStats && array.size() > first) {
+                MutableDocument op (array[first].getDocument());
+                op.addField("executionStats", Value((*it)->serializeStats()));
+                array[first] = op.freezeToValue();
+            }
         }
         return array;
     }
 
+    void Pipeline::enableTiming() {
+        for (size_t i = 0; i < sources.size(); i++) {
+            sources[i]->enableTiming();
+        }
+    }
+
+    void Pipeline::runForExplain() {
+        verify(_explainExecutionStats);
+        DocumentSource* finalSource = sources.back().get();
+        while (finalSource->getNext()) {
+        }
+    }
+
+    string Pipeline::getStatsSummary() const {
+        StringBuilder sb;
+        for (size_t i = 0; i < sources.size(); i++) {
+            const DocumentSource::Stats& stats = sources[i]->getStats();
+            sb << (i ? ", " : "") << sources[i]->getSourceName() << ": " << stats.nReturned;
+            if (stats.timed) {
+                sb << " in " << stats.executionMicros / 1000 << "ms";
+            }
+            if (stats.bytesSpilled) {
+                sb << " spilled " << stats.bytesSpilled << " bytes";
+            }
+        }
+        return sb.str();
+    }
+
     void Pipeline::addInitialSource(intrusive_ptr<DocumentSource> source) {
         sources.push_front(source);
     }
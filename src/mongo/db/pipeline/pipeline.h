@@ -119,6 +119,20 @@ namespace mongo {
 
         bool isExplain() const { return explain; }
 
+        /// True for explain: "executionStats", which runs the pipeline to report on its stages.
+        bool isExplainExecutionStats() const { return _explainExecutionStats; }
+
+        /// Makes every stage time its getNext(). See DocumentSource::enableTiming().
+        void enableTiming();
+
+        /** Runs the pipeline to the end, discarding its results, so that writeExplainOps() can
+         *  report the stats of each stage. Only for explain: "executionStats".
+         */
+        void runForExplain();
+
+        /// The number of documents each stage returned, and its time if timed, on one line.
+        std::string getStatsSummary() const;
+
         /// The initial source is special since it varies between mongos and mongod.
         void addInitialSource(boost::intrusive_ptr<DocumentSource> source);
 
@@ -127,7 +141,8 @@ namespace mongo {
 
         /**
          * Write the pipeline's operators to a std::vector<Value>, with the
-         * explain flag true (for DocumentSource::serializeToArray()).
+         * explain flag true (for DocumentSource::serializeToArray()). With explain:
+         * "executionStats", the first operator of each stage also has its executionStats.
          */
         std::vector<Value> writeExplainOps() const;
 
@@ -179,6 +194,7 @@ namespace mongo {
         typedef std::deque<boost::intrusive_ptr<DocumentSource> > SourceContainer;
         SourceContainer sources;
         bool explain;
+        bool _explainExecutionStats;
 
         boost::intrusive_ptr<ExpressionContext> pCtx;
     };
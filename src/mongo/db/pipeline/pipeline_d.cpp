@@ -26,22 +26,48 @@
  * it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/pipeline/pipeline_d.h"
 
+#include <algorithm>
+#include <limits>
+
 
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/create_collection.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/document_validation.h"
+#include "mongo/db/catalog/index_create.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/multi_iterator.h"
+#include "mongo/db/exec/parallel_filter.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/exec/shard_filter.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/index/summary_access_method.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/op_observer.h"
+#include "mongo/db/ops/insert.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/s/d_state.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -84,10 +110,169 @@ namespace {
             return _client.getLastErrorDetailed();
         }
 
+        void createCollectionWithoutIndexes(const std::string& dbName,
+                                            const BSONObj& cmdObj) final {
+            uassertStatusOK(createCollection(_ctx->opCtx, dbName, cmdObj,
+                                             false)); // indexes are built by buildIndexes()
+        }
+
+        BSONObj bulkInsert(const NamespaceString& ns, const std::vector<BSONObj>& objs) final {
+            OperationContext* const txn = _ctx->opCtx;
+
+            boost::optional<DisableDocumentValidation> maybeDisableValidation;
+            if (_ctx->bypassDocumentValidation)
+                maybeDisableValidation.emplace(txn);
+
+            {
+                ScopedTransaction transaction(txn, MODE_IX);
+                Lock::DBLock dbLock(txn->lockState(), ns.db(), MODE_IX);
+                Lock::CollectionLock collLock(txn->lockState(), ns.ns(), MODE_X);
+
+                Database* db = dbHolder().get(txn, ns.db());
+                Collection* collection = db ? db->getCollection(ns) : NULL;
+                uassert(28761, str::stream() << "collection " << ns.ns()
+                                             << " was dropped while inserting into it",
+                        collection);
+
+                if (!_triedBulkLoad) {
+                    _triedBulkLoad = true;
+
+                    // The bulk loader skips the OpObserver, so it is only used when nothing is
+                    // replicated anyway.
+                    if (repl::getGlobalReplicationCoordinator()->getReplicationMode()
+                            == repl::ReplicationCoordinator::modeNone) {
+                        const bool shouldReplicateWrites = txn->writesAreReplicated();
+                        txn->setReplicatedWrites(false);
+                        ON_BLOCK_EXIT(&OperationContext::setReplicatedWrites,
+                                      txn, shouldReplicateWrites);
+                        _bulkLoader = collection->makeBulkLoader(txn);
+                    }
+
+                    if (_bulkLoader) {
+                        LOG(1) << "bulk loading documents inserted into " << ns;
+                        _bulkLoadCollection = collection;
+                    }
+                }
+
+                if (_bulkLoader) {
+                    massert(28762, str::stream() << "collection " << ns.ns()
+                                                 << " was recreated while bulk loading it",
+                            collection == _bulkLoadCollection);
+
+                    for (size_t i = 0; i < objs.size(); i++) {
+                        // Add the _id an insert would.
+                        StatusWith<BSONObj> fixed = fixDocumentForInsert(objs[i]);
+                        uassertStatusOK(fixed.getStatus());
+                        const BSONObj& doc = fixed.getValue().isEmpty() ? objs[i]
+                                                                        : fixed.getValue();
+                        uassertStatusOK(_bulkLoader->addRecord(doc.objdata(),
+                                                               doc.objsize()).getStatus());
+                    }
+                    return BSONObj();
+                }
+            }
+
+            return insert(ns, objs);
+        }
+
+        void finishBulkInsert() final {
+            if (_bulkLoader) {
+                _bulkLoader->commit();
+                _bulkLoader.reset();
+            }
+        }
+
+        void buildIndexes(const NamespaceString& ns, const std::vector<BSONObj>& specs) final {
+            OperationContext* const txn = _ctx->opCtx;
+
+            ScopedTransaction transaction(txn, MODE_IX);
+            Lock::DBLock dbLock(txn->lockState(), ns.db(), MODE_X);
+            uassert(ErrorCodes::NotMaster,
+                    str::stream() << "Not primary while building indexes on " << ns.ns(),
+                    repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(ns));
+
+            Database* db = dbHolder().get(txn, ns.db());
+            Collection* collection = db ? db->getCollection(ns) : NULL;
+            uassert(28763, str::stream() << "collection " << ns.ns()
+                                         << " was dropped before building its indexes",
+                    collection);
+
+            // Background building isn't allowed, so even indexes specified with background: true
+            // are bulk built from sorted keys.
+            MultiIndexBlock indexer(txn, collection);
+            indexer.allowInterruption();
+
+            MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                uassertStatusOK(indexer.init(specs));
+            } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "buildIndexes", ns.ns());
+
+            uassertStatusOK(indexer.insertAllDocumentsInCollection());
+
+            MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                WriteUnitOfWork wunit(txn);
+
+                indexer.commit();
+
+                for (size_t i = 0; i < specs.size(); i++) {
+                    getGlobalServiceContext()->getOpObserver()->onCreateIndex(
+                        txn, ns.getSystemIndexesCollection(), specs[i]);
+                }
+
+                wunit.commit();
+            } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "buildIndexes", ns.ns());
+        }
+
     private:
         intrusive_ptr<ExpressionContext> _ctx;
         DBDirectClient _client;
+
+        // Set by the first bulkInsert() when it can bulk load the collection.
+        std::unique_ptr<RecordStoreBulkLoader> _bulkLoader;
+        Collection* _bulkLoadCollection = NULL;
+        bool _triedBulkLoad = false;
     };
+
+    /**
+     * Returns whether the plan rooted at 'root' gets its sort from indexes which aren't
+     * multikey, so that the sorted fields are never arrays, rather than from a sort stage.
+     */
+    bool sortedWithoutArrays(const PlanStage* root) {
+        if (STAGE_SORT == root->stageType()) {
+            return false;
+        }
+        if (STAGE_IXSCAN == root->stageType()
+                && static_cast<const IndexScanStats*>(root->getSpecificStats())->isMultiKey) {
+            return false;
+        }
+
+        const std::vector<PlanStage*> children = root->getChildren();
+        for (size_t i = 0; i < children.size(); i++) {
+            if (!sortedWithoutArrays(children[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Lets the first $group of 'sources' stream its groups if its input is sorted by 'sortObj',
+     * i.e. only stages which keep the order of the documents come before it.
+     */
+    void groupSortedInput(const std::deque<intrusive_ptr<DocumentSource> >& sources,
+                          const BSONObj& sortObj) {
+        for (size_t i = 0; i < sources.size(); i++) {
+            DocumentSource* source = sources[i].get();
+            if (DocumentSourceGroup* group = dynamic_cast<DocumentSourceGroup*>(source)) {
+                group->setInputSortedBy(sortObj);
+                return;
+            }
+            if (!dynamic_cast<DocumentSourceMatch*>(source)
+                    && !dynamic_cast<DocumentSourceLimit*>(source)
+                    && !dynamic_cast<DocumentSourceSkip*>(source)) {
+                return;
+            }
+        }
+    }
 }
 
     shared_ptr<PlanExecutor> PipelineD::prepareCursorSource(
@@ -122,6 +307,18 @@ namespace {
             return std::shared_ptr<PlanExecutor>(); // don't need a cursor
         }
 
+        if (collection && !sources.empty()
+                && prepareSummarySource(txn, collection, pPipeline, pExpCtx)) {
+            return std::shared_ptr<PlanExecutor>(); // don't need a cursor
+        }
+
+        if (collection && !sources.empty()) {
+            std::shared_ptr<PlanExecutor> exec =
+                prepareRandomCursorSource(txn, collection, pPipeline, pExpCtx);
+            if (exec) {
+                return exec;
+            }
+        }
 
         // Look for an initial match. This works whether we got an initial query or not.
         // If not, it results in a "{}" query, which will be what we want in that case.
@@ -149,12 +346,29 @@ namespace {
         */
         intrusive_ptr<DocumentSourceSort> sortStage;
         BSONObj sortObj;
+        // Position of sortStage in sources. A $sort right after a $project that only includes
+        // and renames fields is looked at too, with its key translated to the input fields.
+        size_t sortPosition = 0;
         if (!sources.empty()) {
             sortStage = dynamic_cast<DocumentSourceSort*>(sources.front().get());
             if (sortStage) {
                 // build the sort key
                 sortObj = sortStage->serializeSortKey(/*explain*/false).toBson();
             }
+            else if (sources.size() >= 2) {
+                DocumentSourceProject* project =
+                    dynamic_cast<DocumentSourceProject*>(sources[0].get());
+                DocumentSourceSort* sortAfterProject =
+                    dynamic_cast<DocumentSourceSort*>(sources[1].get());
+                std::map<string, string> renamedFields;
+                if (project && sortAfterProject && project->getRenamedFields(&renamedFields)) {
+                    sortObj = sortAfterProject->serializeSortKeyBefore(renamedFields);
+                    if (!sortObj.isEmpty()) {
+                        sortStage = sortAfterProject;
+                        sortPosition = 1;
+                    }
+                }
+            }
         }
 
         // Create the PlanExecutor.
@@ -184,32 +398,60 @@ namespace {
 
         const WhereCallbackReal whereCallback(pExpCtx->opCtx, pExpCtx->ns.db());
 
+        // Read by the stage builder when it builds the filters of the plans.
+        requestedQueryParallelism(txn) = pExpCtx->parallelism;
+
         if (sortStage) {
-            CanonicalQuery* cq;
-            Status status =
-                CanonicalQuery::canonicalize(pExpCtx->ns,
-                                             queryObj,
-                                             sortObj,
-                                             projectionForQuery,
-                                             &cq,
-                                             whereCallback);
+            // A coalesced $limit goes to the query too, so that it can stop early. If no index
+            // provides the sort, a small enough limit still lets the query run a top-k sort,
+            // which only ever holds that many documents.
+            const long long limit = std::max(sortStage->getLimit(), 0LL);
+            // A negative ntoreturn is a hard limit, as opposed to a batch size.
+            const long long queryLimit =
+                limit <= std::numeric_limits<int>::max() ? -limit : 0;
+            std::vector<size_t> attempts;
+            attempts.push_back(runnerOptions);
+            if (limit > 0 && limit <= internalQueryAggMaxPushedDownTopK) {
+                attempts.push_back(runnerOptions & ~QueryPlannerParams::NO_BLOCKING_SORT);
+            }
 
-            PlanExecutor* rawExec;
-            if (status.isOK() && getExecutor(txn,
-                                             collection,
-                                             cq,
-                                             PlanExecutor::YIELD_AUTO,
-                                             &rawExec,
-                                             runnerOptions).isOK()) {
-                // success: The PlanExecutor will handle sorting for us using an index.
-                exec.reset(rawExec);
+            for (size_t i = 0; i < attempts.size() && !exec; i++) {
+                CanonicalQuery* cq;
+                Status status =
+                    CanonicalQuery::canonicalize(pExpCtx->ns,
+                                                 queryObj,
+                                                 sortObj,
+                                                 projectionForQuery,
+                                                 0,
+                                                 queryLimit,
+                                                 &cq,
+                                                 whereCallback);
+
+                PlanExecutor* rawExec;
+                if (status.isOK() && getExecutor(txn,
+                                                 collection,
+                                                 cq,
+                                                 PlanExecutor::YIELD_AUTO,
+                                                 &rawExec,
+                                                 attempts[i]).isOK()) {
+                    // success: The PlanExecutor will handle sorting for us.
+                    exec.reset(rawExec);
+                }
+            }
+
+            if (exec) {
                 sortInRunner = true;
 
-                sources.pop_front();
+                sources.erase(sources.begin() + sortPosition);
                 if (sortStage->getLimitSrc()) {
                     // need to reinsert coalesced $limit after removing $sort
                     sources.push_front(sortStage->getLimitSrc());
                 }
+
+                // A $project before the $sort would have renamed the fields the $group sees.
+                if (sortPosition == 0 && sortedWithoutArrays(exec->getRootStage())) {
+                    groupSortedInput(sources, sortObj);
+                }
             }
         }
 
@@ -260,4 +502,246 @@ namespace {
         return exec;
     }
 
+    std::shared_ptr<PlanExecutor> PipelineD::prepareRandomCursorSource(
+            OperationContext* txn,
+            Collection* collection,
+            const intrusive_ptr<Pipeline>& pPipeline,
+            const intrusive_ptr<ExpressionContext>& pExpCtx) {
+        Pipeline::SourceContainer& sources = pPipeline->sources;
+        DocumentSourceSample* sample = dynamic_cast<DocumentSourceSample*>(sources.front().get());
+        if (!sample) {
+            return std::shared_ptr<PlanExecutor>();
+        }
+
+        // A sample of most of the collection would mostly find records it already has.
+        const long long sampleSize = sample->getSampleSize();
+        RecordStore* rs = collection->getRecordStore();
+        if (sampleSize >= rs->numRecords(txn) * internalQueryAggSampleMaxRandomCursorRatio) {
+            return std::shared_ptr<PlanExecutor>();
+        }
+
+        std::unique_ptr<RecordCursor> cursor = rs->getRandomCursor(txn);
+        if (!cursor) {
+            return std::shared_ptr<PlanExecutor>();
+        }
+
+        LOG(1) << "sampling " << sampleSize << " documents of " << collection->ns()
+               << " from random records";
+
+        auto ws = stdx::make_unique<WorkingSet>();
+        auto iterator = stdx::make_unique<MultiIteratorStage>(txn, ws.get(), collection);
+        iterator->addIterator(std::move(cursor));
+        // Might have to filter out orphaned docs.
+        PlanStage* root =
+            new ShardFilterStage(shardingState.getCollectionMetadata(collection->ns().ns()),
+                                 ws.get(), iterator.release());
+
+        PlanExecutor* rawExec;
+        // Takes ownership of 'ws' and 'root'.
+        invariant(PlanExecutor::make(txn, ws.release(), root, collection,
+                                     PlanExecutor::YIELD_AUTO, &rawExec).isOK());
+        std::shared_ptr<PlanExecutor> exec(rawExec);
+
+        sources.pop_front();
+        sources.push_front(DocumentSourceSampleFromRandomCursor::create(pExpCtx, sampleSize));
+        const DepsTracker deps = pPipeline->getDependencies(BSONObj());
+
+        // DocumentSourceCursor expects a yielding PlanExecutor that has had its state saved. We
+        // deregister the PlanExecutor so that it can be registered with ClientCursor.
+        exec->deregisterExec();
+        exec->saveState();
+
+        // Only load about as many random documents at a time as the sample still needs.
+        intrusive_ptr<DocumentSourceCursor> pSource =
+            DocumentSourceCursor::create(pExpCtx->ns.ns(), exec, pExpCtx);
+        pSource->setProjection(deps.toProjection(), deps.toParsedDeps());
+        pSource->setMaxBatchDocs(sampleSize);
+
+        pPipeline->addInitialSource(pSource);
+
+        return exec;
+    }
+
+namespace {
+    // The most group fields of an _id which may be null in a group of a summary index. Each
+    // could be null or missing in the documents of the group, so the _id is computed for every
+    // combination of those.
+    const size_t kMaxNullIdFieldsPerSummaryGroup = 4;
+
+    /**
+     * Computes the partial result of 'group' over the documents of the summary index group
+     * 'key', whose fields are 'groupFields'. Returns false if that isn't the same for all of
+     * them, as when those missing the _id fields are given another _id than those where they
+     * are null.
+     */
+    bool summarizeGroup(DocumentSourceGroup* group,
+                        const std::set<string>& idFields,
+                        const std::vector<DocumentSourceGroup::Sum>& sums,
+                        const std::vector<string>& groupFields,
+                        const BSONObj& key,
+                        const SummaryAccessMethod::Group& counts,
+                        Document* out) {
+        std::vector<std::pair<string, Value> > idValues;
+        std::vector<size_t> nullIdFields;
+        size_t position = 0;
+        BSONForEach(elem, key) {
+            const string& field = groupFields[position++];
+            if (!idFields.count(field))
+                continue;
+            if (elem.isNull())
+                nullIdFields.push_back(idValues.size());
+            idValues.push_back(std::make_pair(field, Value(elem)));
+        }
+        if (nullIdFields.size() > kMaxNullIdFieldsPerSummaryGroup)
+            return false;
+
+        Value id;
+        for (size_t missing = 0; missing < (size_t(1) << nullIdFields.size()); missing++) {
+            std::vector<bool> isMissing(idValues.size(), false);
+            for (size_t i = 0; i < nullIdFields.size(); i++) {
+                isMissing[nullIdFields[i]] = missing & (size_t(1) << i);
+            }
+
+            MutableDocument doc;
+            for (size_t i = 0; i < idValues.size(); i++) {
+                if (!isMissing[i])
+                    doc.setNestedField(FieldPath(idValues[i].first), idValues[i].second);
+            }
+            const Value thisId = group->computeIdOf(doc.freeze());
+            if (missing == 0)
+                id = thisId;
+            else if (Value::compare(id, thisId) != 0)
+                return false;
+        }
+
+        MutableDocument partial;
+        partial.addField("_id", id);
+        for (size_t i = 0; i < sums.size(); i++) {
+            if (sums[i].sumField.empty()) {
+                // The type AccumulatorSum gives the sum of 'count' times the constant
+                const Value& constant = sums[i].constant;
+                if (constant.getType() == NumberDouble) {
+                    partial.addField(sums[i].fieldName,
+                                     Value(counts.count * constant.getDouble()));
+                    continue;
+                }
+                const long long factor = constant.coerceToLong();
+                const long long maxInt = std::numeric_limits<int>::max();
+                if (counts.count > maxInt || factor > maxInt || factor < -maxInt)
+                    return false; // the product might not fit in a long
+                const long long product = counts.count * factor;
+                partial.addField(sums[i].fieldName,
+                                 constant.getType() == NumberInt ? Value::createIntOrLong(product)
+                                                                 : Value(product));
+                continue;
+            }
+            BSONObjBuilder builder;
+            counts.appendSum(&builder, "");
+            partial.addField(sums[i].fieldName, Value(builder.obj().firstElement()));
+        }
+        *out = partial.freeze();
+        return true;
+    }
+} // namespace
+
+    bool PipelineD::prepareSummarySource(
+            OperationContext* txn,
+            Collection* collection,
+            const intrusive_ptr<Pipeline>& pPipeline,
+            const intrusive_ptr<ExpressionContext>& pExpCtx) {
+        Pipeline::SourceContainer& sources = pPipeline->sources;
+        DocumentSourceMatch* match = dynamic_cast<DocumentSourceMatch*>(sources.front().get());
+        const size_t groupPosition = match ? 1 : 0;
+        if (sources.size() <= groupPosition) {
+            return false;
+        }
+        DocumentSourceGroup* group =
+            dynamic_cast<DocumentSourceGroup*>(sources[groupPosition].get());
+        if (!group) {
+            return false;
+        }
+
+        std::set<string> idFields;
+        std::vector<DocumentSourceGroup::Sum> sums;
+        if (!group->getSums(&idFields, &sums)) {
+            return false;
+        }
+        string sumField;
+        for (size_t i = 0; i < sums.size(); i++) {
+            if (sums[i].sumField.empty()) {
+                continue;
+            }
+            if (!sumField.empty() && sumField != sums[i].sumField) {
+                return false;
+            }
+            sumField = sums[i].sumField;
+        }
+        // The documents of a field set on the _id couldn't be told from those of its subfields.
+        for (const string& field : idFields) {
+            for (const string& other : idFields) {
+                if (str::startsWith(other, field + '.')) {
+                    return false;
+                }
+            }
+        }
+
+        // The groups include orphaned documents, which the shards mustn't return.
+        if (shardingState.getCollectionMetadata(collection->ns().ns())) {
+            return false;
+        }
+
+        const BSONObj query = match ? match->getQuery() : BSONObj();
+        StatusWithMatchExpression parsed = MatchExpressionParser::parse(query);
+        if (!parsed.isOK()) {
+            return false;
+        }
+        std::unique_ptr<MatchExpression> filter(parsed.getValue());
+
+        IndexCatalog* catalog = collection->getIndexCatalog();
+        IndexCatalog::IndexIterator ii = catalog->getIndexIterator(txn, false);
+        while (ii.more()) {
+            const IndexDescriptor* desc = ii.next();
+            if (IndexNames::SUMMARY != desc->getAccessMethodName()) {
+                continue;
+            }
+            const SummaryAccessMethod* sam =
+                static_cast<const SummaryAccessMethod*>(catalog->getIndex(desc));
+            const std::vector<string>& groupFields = sam->getGroupFields();
+            bool covered = sumField.empty() || sumField == sam->getSumField();
+            for (const string& field : idFields) {
+                covered = covered && std::find(groupFields.begin(), groupFields.end(), field)
+                                     != groupFields.end();
+            }
+            if (!covered || !sam->canMatchGroups(filter.get())) {
+                continue;
+            }
+
+            std::vector<Document> partialGroups;
+            const SummaryAccessMethod::Groups groups = sam->getGroups();
+            for (size_t i = 0; i < groups.size(); i++) {
+                if (!sam->matchesGroup(filter.get(), groups[i].first)) {
+                    continue;
+                }
+                Document partial;
+                if (!summarizeGroup(group, idFields, sums, groupFields,
+                                    groups[i].first, groups[i].second, &partial)) {
+                    return false;
+                }
+                partialGroups.push_back(std::move(partial));
+            }
+
+            LOG(1) << "computing $group of " << collection->ns() << " from the "
+                   << partialGroups.size() << " matching groups of summary index "
+                   << desc->indexName();
+
+            const intrusive_ptr<DocumentSource> merger = group->getMergeSource();
+            sources.erase(sources.begin(), sources.begin() + groupPosition + 1);
+            sources.push_front(merger);
+            sources.push_front(DocumentSourceSummary::create(pExpCtx, desc->indexName(), query,
+                                                             std::move(partialGroups)));
+            return true;
+        }
+        return false;
+    }
+
 } // namespace mongo
@@ -80,6 +80,30 @@ namespace mongo {
 
     private:
         PipelineD(); // does not exist:  prevent instantiation
+
+        /**
+         * Replaces an initial $sample by a cursor over random records, followed by a stage
+         * dropping the duplicates among them, if the collection's storage engine can pick
+         * records at random and the sample is a small enough part of the collection. Returns
+         * the PlanExecutor of that cursor, or null if the pipeline was left as it was.
+         */
+        static std::shared_ptr<PlanExecutor> prepareRandomCursorSource(
+            OperationContext* txn,
+            Collection* collection,
+            const boost::intrusive_ptr<Pipeline> &pPipeline,
+            const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
+
+        /**
+         * Replaces an initial $group, or $match and $group, by its partial results computed
+         * from the groups of a summary index, followed by the merging half of the $group, if
+         * the $group only sums constants and the summed field of the index by group fields, and
+         * the $match only picks groups. Returns whether the pipeline was changed.
+         */
+        static bool prepareSummarySource(
+            OperationContext* txn,
+            Collection* collection,
+            const boost::intrusive_ptr<Pipeline> &pPipeline,
+            const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
     };
 
 } // namespace mongo
@@ -261,6 +261,7 @@ namespace mongo {
 
         ValueStorage _storage;
         friend class MutableValue; // gets and sets _storage.genericRCPtr
+        friend class CompiledExpression; // views strings with getStringData()
     };
     BOOST_STATIC_ASSERT(sizeof(Value) == 16);
 
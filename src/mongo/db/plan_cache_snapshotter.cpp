@@ -0,0 +1,312 @@
+// plan_cache_snapshotter.cpp
+
+/**
+*    Copyright (C) 2015 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/plan_cache_snapshotter.h"
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/fsync.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_cache_snapshot.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    using std::list;
+    using std::set;
+    using std::string;
+    using std::unique_ptr;
+    using std::vector;
+
+    // How often, in seconds, the plan cache of every collection is saved, or 0 to neither save
+    // nor reload it.
+    MONGO_EXPORT_SERVER_PARAMETER( planCacheSnapshotIntervalSecs, int, 0 );
+
+    // Whether the snapshot is kept in a replicated collection. If so, the primary saves it and
+    // the secondaries reload it every interval, so that a new primary starts with a warm cache.
+    MONGO_EXPORT_SERVER_PARAMETER( planCacheSnapshotReplicated, bool, false );
+
+namespace {
+
+    const char kLocalSnapshotNs[] = "local.system.plan_cache";
+    const char kReplicatedSnapshotNs[] = "admin.system.plan_cache";
+
+    // Leaves room under the document size limit for the _id and the timestamp.
+    const int kMaxSnapshotEntriesBytes = 8 * 1024 * 1024;
+
+    class PlanCacheSnapshotter : public BackgroundJob {
+    public:
+        virtual string name() const { return "PlanCacheSnapshotter"; }
+
+        virtual void run() {
+            Client::initThread( name().c_str() );
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            bool loaded = false;
+            Date_t lastPass = jsTime();
+
+            while ( ! inShutdown() ) {
+                sleepsecs( 1 );
+
+                const int intervalSecs = planCacheSnapshotIntervalSecs;
+                if ( intervalSecs <= 0 ) {
+                    continue;
+                }
+
+                const bool reloadOnly = !loaded;
+                if ( loaded && jsTime() - lastPass < Seconds(intervalSecs) ) {
+                    continue;
+                }
+                loaded = true;
+                lastPass = jsTime();
+
+                if ( lockedForWriting() ) {
+                    LOG(3) << "PlanCacheSnapshotter: locked for writing";
+                    continue;
+                }
+
+                try {
+                    doPass( reloadOnly );
+                }
+                catch ( const WriteConflictException& ) {
+                    LOG(1) << "Got WriteConflictException in plan cache snapshot thread";
+                }
+                catch ( const DBException& ex ) {
+                    warning() << "Error saving or reloading plan cache snapshot: " << ex.toString();
+                }
+            }
+        }
+
+    private:
+        void doPass( bool reloadOnly ) {
+            OperationContextImpl txn;
+
+            repl::ReplicationCoordinator* replCoord = repl::getGlobalReplicationCoordinator();
+            if ( replCoord->getReplicationMode() == repl::ReplicationCoordinator::modeReplSet &&
+                 !replCoord->getMemberState().readable() ) {
+                return;
+            }
+
+            const bool replicated = planCacheSnapshotReplicated;
+            const string snapshotNs = replicated ? kReplicatedSnapshotNs : kLocalSnapshotNs;
+
+            // A secondary can't write the replicated snapshot, so it follows the primary's.
+            if ( reloadOnly ||
+                 ( replicated && !replCoord->canAcceptWritesForDatabase( "admin" ) ) ) {
+                reload( &txn, snapshotNs );
+            }
+            else {
+                save( &txn, snapshotNs );
+            }
+        }
+
+        /**
+         * Saves the plan cache of every collection with cached plans into one document of
+         * 'snapshotNs' per collection. The document of a collection with an empty cache is kept,
+         * since the cache is emptied by writes and index changes and the entries it had most
+         * likely still apply.
+         */
+        void save( OperationContext* txn, const string& snapshotNs ) {
+            set<string> dbNames;
+            dbHolder().getAllShortNames( dbNames );
+
+            long long collections = 0;
+            for ( set<string>::const_iterator i = dbNames.begin(); i != dbNames.end(); ++i ) {
+                if ( *i == "local" ) {
+                    continue;
+                }
+
+                list<string> collNames;
+                {
+                    ScopedTransaction transaction( txn, MODE_IS );
+                    AutoGetDb autoDb( txn, *i, MODE_IS );
+                    Database* db = autoDb.getDb();
+                    if ( !db ) {
+                        continue;
+                    }
+                    db->getDatabaseCatalogEntry()->getCollectionNamespaces( &collNames );
+                }
+
+                for ( list<string>::const_iterator j = collNames.begin();
+                      j != collNames.end(); ++j ) {
+                    const NamespaceString nss( *j );
+                    if ( nss.isSystem() ) {
+                        continue;
+                    }
+
+                    BSONArray entries = getEntries( txn, nss );
+                    if ( entries.isEmpty() ) {
+                        continue;
+                    }
+
+                    DBDirectClient client( txn );
+                    client.update( snapshotNs,
+                                   QUERY( "_id" << nss.ns() ),
+                                   BSON( "_id" << nss.ns()
+                                         << "ts" << jsTime()
+                                         << "entries" << entries ),
+                                   true /* upsert */ );
+                    ++collections;
+                }
+            }
+
+            LOG(1) << "Saved the plan cache of " << collections << " collections to "
+                   << snapshotNs;
+        }
+
+        BSONArray getEntries( OperationContext* txn, const NamespaceString& nss ) {
+            AutoGetCollectionForRead ctx( txn, nss );
+            Collection* collection = ctx.getCollection();
+            if ( !collection ) {
+                return BSONArray();
+            }
+
+            OwnedPointerVector<PlanCacheEntry> cacheEntries(
+                collection->infoCache()->getPlanCache()->getAllEntries() );
+
+            BSONArrayBuilder entries;
+            for ( size_t i = 0; i < cacheEntries.size(); ++i ) {
+                BSONObj entryObj = PlanCacheSnapshot::entryToBSON( *cacheEntries[i] );
+                if ( entries.len() + entryObj.objsize() > kMaxSnapshotEntriesBytes ) {
+                    break;
+                }
+                entries.append( entryObj );
+            }
+            return entries.arr();
+        }
+
+        /**
+         * Adds the entries saved in 'snapshotNs' to the plan cache of their collections, skipping
+         * the query shapes that are already cached.
+         */
+        void reload( OperationContext* txn, const string& snapshotNs ) {
+            // Read the whole snapshot first, so that no collection lock is held while the cursor
+            // over the snapshot collection is open.
+            vector<BSONObj> docs;
+            {
+                DBDirectClient client( txn );
+                unique_ptr<DBClientCursor> cursor = client.query( snapshotNs, Query() );
+                while ( cursor && cursor->more() ) {
+                    docs.push_back( cursor->nextSafe().getOwned() );
+                }
+            }
+
+            long long added = 0;
+            for ( vector<BSONObj>::const_iterator i = docs.begin(); i != docs.end(); ++i ) {
+                BSONElement idElt = (*i)["_id"];
+                BSONElement entriesElt = (*i)["entries"];
+                if ( idElt.type() != String || entriesElt.type() != Array ) {
+                    continue;
+                }
+                added += reloadCollection( txn, idElt.String(), entriesElt.Obj() );
+            }
+
+            LOG(1) << "Reloaded " << added << " plan cache entries from " << snapshotNs;
+        }
+
+        long long reloadCollection( OperationContext* txn, const string& ns,
+                                    const BSONObj& entries ) {
+            AutoGetCollectionForRead ctx( txn, NamespaceString( ns ) );
+            Collection* collection = ctx.getCollection();
+            if ( !collection ) {
+                return 0;
+            }
+
+            vector<IndexEntry> indexes;
+            IndexCatalog::IndexIterator ii =
+                collection->getIndexCatalog()->getIndexIterator( txn, false );
+            while ( ii.more() ) {
+                const IndexDescriptor* desc = ii.next();
+                const IndexCatalogEntry* ice = ii.catalogEntry( desc );
+                indexes.emplace_back( desc->keyPattern(),
+                                      desc->getAccessMethodName(),
+                                      desc->isMultikey( txn ),
+                                      desc->isSparse(),
+                                      desc->unique(),
+                                      desc->indexName(),
+                                      ice->getFilterExpression(),
+                                      desc->infoObj() );
+            }
+
+            PlanCache* planCache = collection->infoCache()->getPlanCache();
+            long long added = 0;
+            BSONObjIterator it( entries );
+            while ( it.more() ) {
+                BSONElement entryElt = it.next();
+                if ( entryElt.type() != Object ) {
+                    continue;
+                }
+                Status status = PlanCacheSnapshot::addEntryFromBSON( ns, entryElt.Obj(),
+                                                                     indexes, planCache );
+                if ( status.isOK() ) {
+                    ++added;
+                }
+                else if ( status != ErrorCodes::DuplicateKey ) {
+                    LOG(1) << "Not reloading plan cache entry for " << ns << ": " << status;
+                }
+            }
+            return added;
+        }
+    };
+
+} // namespace
+
+    void startPlanCacheSnapshotter() {
+        PlanCacheSnapshotter* snapshotter = new PlanCacheSnapshotter();
+        snapshotter->go();
+    }
+
+} // namespace mongo
@@ -42,6 +42,7 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/util/log.h"
@@ -121,29 +122,30 @@ namespace {
         }
     }
 
-    // page in the data pages for a record associated with an object
+    // page in the data pages for a record associated with an object, returning the record in
+    // 'result' if there is one
     void prefetchRecordPages(OperationContext* txn,
                              Database* db,
                              const char* ns,
-                             const BSONObj& obj) {
+                             const BSONObj& obj,
+                             BSONObj* result) {
 
         BSONElement _id;
         if( obj.getObjectID(_id) ) {
             TimerHolder timer(&prefetchDocStats);
             BSONObjBuilder builder;
             builder.append(_id);
-            BSONObj result;
             try {
-                if (Helpers::findById(txn, db, ns, builder.done(), result)) {
+                if (Helpers::findById(txn, db, ns, builder.done(), *result)) {
                     // do we want to use Record::touch() here?  it's pretty similar.
                     volatile char _dummy_char = '\0';
 
                     // Touch the first word on every page in order to fault it into memory
-                    for (int i = 0; i < result.objsize(); i += g_minOSPageSizeBytes) {
-                        _dummy_char += *(result.objdata() + i);
+                    for (int i = 0; i < result->objsize(); i += g_minOSPageSizeBytes) {
+                        _dummy_char += *(result->objdata() + i);
                     }
                     // hit the last page, in case we missed it above
-                    _dummy_char += *(result.objdata() + result.objsize() - 1);
+                    _dummy_char += *(result->objdata() + result->objsize() - 1);
                 }
             }
             catch(const DBException& e) {
@@ -178,10 +180,12 @@ namespace {
         BSONObj obj = op.getObjectField(opField);
         const char *ns = op.getStringField("ns");
 
-        // This will have to change for engines other than MMAP V1, because they might not have
-        // means for directly prefetching pages from the collection. For this purpose, acquire S
-        // lock on the database, instead of optimizing with IS.
-        Lock::CollectionLock collLock(txn->lockState(), ns, MODE_S);
+        // MMAP V1 prefetches a batch before applying it and touches the pages of the collection
+        // directly, under an S lock. Other engines prefetch while the writer threads apply the
+        // batch, reading through the storage API under an IS lock, which the writers' IX locks
+        // do not conflict with.
+        const bool isMmapV1 = getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1();
+        Lock::CollectionLock collLock(txn->lockState(), ns, isMmapV1 ? MODE_S : MODE_IS);
 
         Collection* collection = db->getCollection( ns );
         if (!collection) {
@@ -201,24 +205,22 @@ namespace {
         //     will be an insert. to do that we could do the prefetchRecordPage first and if DNE
         //     then we do #1.
         // 
-        // note that on deletes 'obj' does not have all the keys we would want to prefetch on.
-        // a way to achieve that would be to prefetch the record first, and then afterwards do 
-        // this part.
+        // on updates and deletes 'obj' does not have all the keys we would want to prefetch on,
+        // so the record is prefetched first and its keys are the ones prefetched afterwards.
         //
-        prefetchIndexPages(txn, collection, prefetchConfig, obj);
-
         // do not prefetch the data for inserts; it doesn't exist yet
-        // 
-        // we should consider doing the record prefetch for the delete op case as we hit the record
-        // when we delete.  note if done we only want to touch the first page.
-        // 
-        // update: do record prefetch. 
-        if ((*opType == 'u') &&
+        //
+        // deletes read the record to unindex it, so engines other than MMAP V1 prefetch it too;
+        // with MMAP V1 the prefetch happens before the batch and would only delay it.
+        BSONObj record;
+        if ((*opType == 'u' || (*opType == 'd' && !isMmapV1)) &&
             // do not prefetch the data for capped collections because
             // they typically do not have an _id index for findById() to use.
             !collection->isCapped()) {
-            prefetchRecordPages(txn, db, ns, obj);
+            prefetchRecordPages(txn, db, ns, obj, &record);
         }
+
+        prefetchIndexPages(txn, collection, prefetchConfig, record.isEmpty() ? obj : record);
     }
 
     class ReplIndexPrefetch : public ServerParameter {
@@ -670,4 +670,24 @@ namespace {
         return ss;
     }
 
+    const std::string* CanonicalQuery::getMemoizedPlanCacheKey(const void* cache,
+                                                               unsigned long long generation,
+                                                               size_t* hashOut) const {
+        if (_planCacheKeyOwner != cache || _planCacheKeyGeneration != generation) {
+            return NULL;
+        }
+        *hashOut = _planCacheKeyHash;
+        return &_planCacheKey;
+    }
+
+    void CanonicalQuery::memoizePlanCacheKey(const void* cache,
+                                             unsigned long long generation,
+                                             const std::string& key,
+                                             size_t hash) const {
+        _planCacheKeyOwner = cache;
+        _planCacheKeyGeneration = generation;
+        _planCacheKey = key;
+        _planCacheKeyHash = hash;
+    }
+
 }  // namespace mongo
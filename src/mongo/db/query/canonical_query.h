@@ -165,6 +165,22 @@ namespace mongo {
         std::string toString() const;
         std::string toStringShort() const;
 
+        /**
+         * The plan cache key of this query, and its hash, are computed once by the PlanCache of
+         * the collection queried and kept here. The key also depends on the collection's
+         * indexes, so it is only handed back to the same 'cache' at the same index 'generation'.
+         *
+         * Returns NULL if there is no such key yet.
+         */
+        const std::string* getMemoizedPlanCacheKey(const void* cache,
+                                                   unsigned long long generation,
+                                                   size_t* hashOut) const;
+
+        void memoizePlanCacheKey(const void* cache,
+                                 unsigned long long generation,
+                                 const std::string& key,
+                                 size_t hash) const;
+
         /**
          * Validates match expression, checking for certain
          * combinations of operators in match expression and
@@ -205,7 +221,10 @@ namespace mongo {
         static MatchExpression* logicalRewrite(MatchExpression* tree);
     private:
         // You must go through canonicalize to create a CanonicalQuery.
-        CanonicalQuery() { }
+        CanonicalQuery()
+            : _planCacheKeyOwner(NULL),
+              _planCacheKeyGeneration(0),
+              _planCacheKeyHash(0) { }
 
         /**
          * Takes ownership of 'root' and 'lpq'.
@@ -220,6 +239,12 @@ namespace mongo {
         std::unique_ptr<MatchExpression> _root;
 
         std::unique_ptr<ParsedProjection> _proj;
+
+        // See getMemoizedPlanCacheKey(). Empty until a plan cache has computed the key.
+        mutable const void* _planCacheKeyOwner;
+        mutable unsigned long long _planCacheKeyGeneration;
+        mutable std::string _planCacheKey;
+        mutable size_t _planCacheKeyHash;
     };
 
 }  // namespace mongo
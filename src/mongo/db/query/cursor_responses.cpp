@@ -34,6 +34,38 @@
 
 namespace mongo {
 
+    CursorResponseBuilder::CursorResponseBuilder(bool isInitialResponse,
+                                                 BSONObjBuilder* commandResponse)
+        : _responseInitialLen(commandResponse->bb().len()),
+          _commandResponse(commandResponse),
+          _cursorObject(commandResponse->subobjStart("cursor")),
+          _batch(_cursorObject.subarrayStart(isInitialResponse ? "firstBatch" : "nextBatch")),
+          _batchStart(_batch.len()) {
+    }
+
+    CursorResponseBuilder::~CursorResponseBuilder() {
+        if (_active) {
+            abandon();
+        }
+    }
+
+    void CursorResponseBuilder::done(long long cursorId, StringData cursorNamespace) {
+        invariant(_active);
+        _batch.doneFast();
+        _cursorObject.append("id", cursorId);
+        _cursorObject.append("ns", cursorNamespace);
+        _cursorObject.doneFast();
+        _active = false;
+    }
+
+    void CursorResponseBuilder::abandon() {
+        invariant(_active);
+        _batch.doneFast();
+        _cursorObject.doneFast();
+        _commandResponse->bb().setlen(_responseInitialLen);  // Removes everything we've added.
+        _active = false;
+    }
+
     void appendCursorResponseObject(long long cursorId,
                                     StringData cursorNamespace,
                                     BSONArray firstBatch,
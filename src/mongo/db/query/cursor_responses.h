@@ -28,11 +28,60 @@
 
 #pragma once
 
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobjbuilder.h"
+
 namespace mongo {
 
-    class BSONObjBuilder;
-    class StringData;
-    struct BSONArray;
+    /**
+     * Builds the "cursor" field of a reply to a find or getMore command directly in the command
+     * response, so that each result document is copied once, into the reply, rather than first
+     * into a separate batch array which is then copied again.
+     *
+     * Documents are appended with append() as they are produced. Once the batch is complete,
+     * done() must be called with the cursor identifiers. If the command fails part way through
+     * the batch, abandon() removes everything this builder has written, so that the caller can
+     * append an error status to 'commandResponse' instead. A builder which is destroyed before
+     * either is called abandons the response.
+     *
+     * The response object has the following format:
+     *   { firstBatch|nextBatch: <Array>, id: <NumberLong>, ns: <String> }.
+     */
+    class CursorResponseBuilder {
+        MONGO_DISALLOW_COPYING(CursorResponseBuilder);
+    public:
+        /**
+         * The batch is named "firstBatch" if 'isInitialResponse' is true, and "nextBatch"
+         * otherwise. Nothing else may be appended to 'commandResponse' until done() or abandon()
+         * is called.
+         */
+        CursorResponseBuilder(bool isInitialResponse, BSONObjBuilder* commandResponse);
+
+        ~CursorResponseBuilder();
+
+        void append(const BSONObj& obj) {
+            _batch.append(obj);
+        }
+
+        /**
+         * Returns the number of bytes taken up by the batch so far.
+         */
+        int bytesUsed() const {
+            return _batch.len() - _batchStart;
+        }
+
+        void done(long long cursorId, StringData cursorNamespace);
+
+        void abandon();
+
+    private:
+        const int _responseInitialLen;
+        BSONObjBuilder* const _commandResponse;
+        BSONObjBuilder _cursorObject;
+        BSONArrayBuilder _batch;
+        const int _batchStart;
+        bool _active = true;
+    };
 
     /**
      * Builds a cursor response object from the provided cursor identifiers and "firstBatch",
@@ -0,0 +1,97 @@
+/**
+ *    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cursor_responses.h"
+#include "mongo/db/jsobj.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    TEST(CursorResponseBuilderTest, FirstBatch) {
+        BSONObjBuilder result;
+        result.append("before", 1);
+        {
+            CursorResponseBuilder firstBatch(true, &result);
+            firstBatch.append(BSON("_id" << 1));
+            firstBatch.append(BSON("_id" << 2));
+            ASSERT_GREATER_THAN(firstBatch.bytesUsed(), 0);
+            firstBatch.done(123LL, "db.coll");
+        }
+        result.append("after", 1);
+
+        ASSERT_EQUALS(BSON("before" << 1 <<
+                           "cursor" << BSON("firstBatch" << BSON_ARRAY(BSON("_id" << 1) <<
+                                                                       BSON("_id" << 2)) <<
+                                            "id" << 123LL <<
+                                            "ns" << "db.coll") <<
+                           "after" << 1),
+                      result.obj());
+    }
+
+    TEST(CursorResponseBuilderTest, NextBatchEmpty) {
+        BSONObjBuilder result;
+        CursorResponseBuilder nextBatch(false, &result);
+        ASSERT_EQUALS(0, nextBatch.bytesUsed());
+        nextBatch.done(0LL, "db.coll");
+
+        ASSERT_EQUALS(BSON("cursor" << BSON("nextBatch" << BSONArray() <<
+                                            "id" << 0LL <<
+                                            "ns" << "db.coll")),
+                      result.obj());
+    }
+
+    TEST(CursorResponseBuilderTest, AbandonRemovesPartialResponse) {
+        BSONObjBuilder result;
+        result.append("before", 1);
+        {
+            CursorResponseBuilder nextBatch(false, &result);
+            nextBatch.append(BSON("_id" << 1));
+            nextBatch.abandon();
+        }
+        result.append("ok", 0.0);
+
+        ASSERT_EQUALS(BSON("before" << 1 << "ok" << 0.0), result.obj());
+    }
+
+    TEST(CursorResponseBuilderTest, DestructorAbandons) {
+        BSONObjBuilder result;
+        {
+            CursorResponseBuilder firstBatch(true, &result);
+            firstBatch.append(BSON("_id" << 1));
+        }
+        result.append("ok", 0.0);
+
+        ASSERT_EQUALS(BSON("ok" << 0.0), result.obj());
+    }
+
+} // namespace
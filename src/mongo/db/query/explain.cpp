@@ -30,6 +30,7 @@
 
 #include "mongo/db/query/explain.h"
 
+#include <algorithm>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/exec/multi_plan.h"
@@ -52,6 +53,8 @@ namespace {
     using std::string;
     using std::vector;
 
+    const long long kNanosPerMilli = 1000 * 1000;
+
     /**
      * Traverse the tree rooted at 'root', and add all tree nodes into the list 'flattened'.
      */
@@ -124,6 +127,14 @@ namespace {
             const DistinctScanStats* spec = static_cast<const DistinctScanStats*>(specific);
             return spec->keysExamined;
         }
+        else if (STAGE_SKIP_SCAN == type) {
+            const SkipScanStats* spec = static_cast<const SkipScanStats*>(specific);
+            return spec->keysExamined;
+        }
+        else if (STAGE_POINT_LOOKUP == type) {
+            const PointLookupStats* spec = static_cast<const PointLookupStats*>(specific);
+            return spec->keysExamined;
+        }
 
         return 0;
      }
@@ -154,6 +165,10 @@ namespace {
             const CollectionScanStats* spec = static_cast<const CollectionScanStats*>(specific);
             return spec->docsTested;
         }
+        else if (STAGE_POINT_LOOKUP == type) {
+            const PointLookupStats* spec = static_cast<const PointLookupStats*>(specific);
+            return spec->docsExamined;
+        }
 
         return 0;
     }
@@ -188,6 +203,14 @@ namespace {
             const IndexScanStats* spec = static_cast<const IndexScanStats*>(specific);
             ss << " " << spec->keyPattern;
         }
+        else if (STAGE_POINT_LOOKUP == stage->stageType()) {
+            const PointLookupStats* spec = static_cast<const PointLookupStats*>(specific);
+            ss << " " << spec->keyPattern;
+        }
+        else if (STAGE_SKIP_SCAN == stage->stageType()) {
+            const SkipScanStats* spec = static_cast<const SkipScanStats*>(specific);
+            ss << " " << spec->keyPattern;
+        }
         else if (STAGE_TEXT == stage->stageType()) {
             const TextStats* spec = static_cast<const TextStats*>(specific);
             ss << " " << spec->indexPrefix;
@@ -226,7 +249,23 @@ namespace mongo {
         // Some top-level exec stats get pulled out of the root stage.
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("nReturned", stats.common.advanced);
-            bob->appendNumber("executionTimeMillisEstimate", stats.common.executionTimeMillis);
+            bob->appendNumber("executionTimeMillisEstimate",
+                              stats.common.executionTimeNanos / kNanosPerMilli);
+
+            // Time and allocations are counted inclusive of the children, as their work() calls
+            // are made from inside ours. The exclusive ones are what remains.
+            long long exclusiveTimeNanos = stats.common.executionTimeNanos;
+            long long exclusiveWorkingSetAllocations = stats.common.workingSetAllocations;
+            for (const PlanStageStats* child : stats.children) {
+                exclusiveTimeNanos -= child->common.executionTimeNanos;
+                exclusiveWorkingSetAllocations -= child->common.workingSetAllocations;
+            }
+            bob->appendNumber("executionTimeNanos", stats.common.executionTimeNanos);
+            bob->appendNumber("exclusiveTimeNanos", std::max(exclusiveTimeNanos, 0LL));
+            bob->appendNumber("workingSetAllocations", stats.common.workingSetAllocations);
+            bob->appendNumber("exclusiveWorkingSetAllocations",
+                              std::max(exclusiveWorkingSetAllocations, 0LL));
+
             bob->appendNumber("works", stats.common.works);
             bob->appendNumber("advanced", stats.common.advanced);
             bob->appendNumber("needTime", stats.common.needTime);
@@ -244,6 +283,7 @@ namespace mongo {
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("memUsage", spec->memUsage);
                 bob->appendNumber("memLimit", spec->memLimit);
+                bob->appendBool("compact", spec->compact);
 
                 bob->appendNumber("flaggedButPassed", spec->flaggedButPassed);
                 bob->appendNumber("flaggedInProgress", spec->flaggedInProgress);
@@ -269,11 +309,16 @@ namespace mongo {
             bob->append("direction", spec->direction > 0 ? "forward" : "backward");
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("docsExamined", spec->docsTested);
+                bob->appendNumber("copiesAvoided", spec->copiesAvoided);
             }
         }
         else if (STAGE_COUNT == stats.stageType) {
             CountStats* spec = static_cast<CountStats*>(stats.specific.get());
 
+            if (!spec->summaryIndex.empty()) {
+                bob->append("summaryIndex", spec->summaryIndex);
+            }
+
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("nCounted", spec->nCounted);
                 bob->appendNumber("nSkipped", spec->nSkipped);
@@ -293,6 +338,15 @@ namespace mongo {
             bob->appendBool("isSparse", spec->isSparse);
             bob->appendBool("isPartial", spec->isPartial);
             bob->append("indexVersion", spec->indexVersion);
+
+            if (!spec->indexBounds.isEmpty()) {
+                if ((topLevelBob->len() + spec->indexBounds.objsize()) > kMaxStatsBSONSize) {
+                    bob->append("warning", "index bounds omitted due to BSON size limit");
+                }
+                else {
+                    bob->append("indexBounds", spec->indexBounds);
+                }
+            }
         }
         else if (STAGE_DELETE == stats.stageType) {
             DeleteStats* spec = static_cast<DeleteStats*>(stats.specific.get());
@@ -300,6 +354,7 @@ namespace mongo {
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("nWouldDelete", spec->docsDeleted);
                 bob->appendNumber("nInvalidateSkips", spec->nInvalidateSkips);
+                bob->appendNumber("nSkippedLocked", spec->nSkippedLocked);
             }
         }
         else if (STAGE_FETCH == stats.stageType) {
@@ -307,6 +362,17 @@ namespace mongo {
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("docsExamined", spec->docsExamined);
                 bob->appendNumber("alreadyHasObj", spec->alreadyHasObj);
+                bob->appendNumber("copiesAvoided", spec->copiesAvoided);
+                bob->appendNumber("prefetched", spec->prefetched);
+            }
+        }
+        else if (STAGE_PARALLEL_FILTER == stats.stageType) {
+            ParallelFilterStats* spec = static_cast<ParallelFilterStats*>(stats.specific.get());
+            bob->appendNumber("degree", spec->degree);
+            if (verbosity >= ExplainCommon::EXEC_STATS) {
+                bob->appendNumber("morsels", spec->morsels);
+                bob->appendNumber("docsTested", spec->docsTested);
+                bob->appendNumber("forcedFetches", spec->forcedFetches);
             }
         }
         else if (STAGE_GEO_NEAR_2D == stats.stageType
@@ -362,6 +428,7 @@ namespace mongo {
 
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("keysExamined", spec->keysExamined);
+                bob->appendNumber("keysShared", spec->keysShared);
                 bob->appendNumber("dupsTested", spec->dupsTested);
                 bob->appendNumber("dupsDropped", spec->dupsDropped);
                 bob->appendNumber("seenInvalidated", spec->seenInvalidated);
@@ -380,6 +447,19 @@ namespace mongo {
             LimitStats* spec = static_cast<LimitStats*>(stats.specific.get());
             bob->appendNumber("limitAmount", spec->limit);
         }
+        else if (STAGE_POINT_LOOKUP == stats.stageType) {
+            PointLookupStats* spec = static_cast<PointLookupStats*>(stats.specific.get());
+
+            bob->append("keyPattern", spec->keyPattern);
+            bob->append("indexName", spec->indexName);
+            bob->append("indexVersion", spec->indexVersion);
+
+            if (verbosity >= ExplainCommon::EXEC_STATS) {
+                bob->appendNumber("keysRequested", spec->keysRequested);
+                bob->appendNumber("keysExamined", spec->keysExamined);
+                bob->appendNumber("docsExamined", spec->docsExamined);
+            }
+        }
         else if (STAGE_PROJECTION == stats.stageType) {
             ProjectionStats* spec = static_cast<ProjectionStats*>(stats.specific.get());
             bob->append("transformBy", spec->projObj);
@@ -395,6 +475,29 @@ namespace mongo {
             SkipStats* spec = static_cast<SkipStats*>(stats.specific.get());
             bob->appendNumber("skipAmount", spec->skip);
         }
+        else if (STAGE_SKIP_SCAN == stats.stageType) {
+            SkipScanStats* spec = static_cast<SkipScanStats*>(stats.specific.get());
+
+            bob->append("keyPattern", spec->keyPattern);
+            bob->append("indexName", spec->indexName);
+            bob->append("indexVersion", spec->indexVersion);
+            bob->append("direction", spec->direction > 0 ? "forward" : "backward");
+
+            if ((topLevelBob->len() + spec->indexBounds.objsize()) > kMaxStatsBSONSize) {
+                bob->append("warning", "index bounds omitted due to BSON size limit");
+            }
+            else {
+                bob->append("indexBounds", spec->indexBounds);
+            }
+
+            if (verbosity >= ExplainCommon::EXEC_STATS) {
+                bob->appendNumber("keysExamined", spec->keysExamined);
+                bob->appendNumber("seeks", spec->seeks);
+                bob->appendNumber("prefixes", spec->prefixes);
+                bob->appendNumber("dupsTested", spec->dupsTested);
+                bob->appendNumber("dupsDropped", spec->dupsDropped);
+            }
+        }
         else if (STAGE_SORT == stats.stageType) {
             SortStats* spec = static_cast<SortStats*>(stats.specific.get());
             bob->append("sortPattern", spec->sortPattern);
@@ -402,6 +505,9 @@ namespace mongo {
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("memUsage", spec->memUsage);
                 bob->appendNumber("memLimit", spec->memLimit);
+                bob->appendNumber("spills", spec->spills);
+                bob->appendNumber("spilledBytes",
+                                  static_cast<long long>(spec->spilledBytes));
             }
 
             if (spec->limit > 0) {
@@ -422,12 +528,18 @@ namespace mongo {
 
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("keysExamined", spec->keysExamined);
+                if (spec->negatedKeysExamined) {
+                    bob->appendNumber("negatedKeysExamined", spec->negatedKeysExamined);
+                }
                 bob->appendNumber("docsExamined", spec->fetches);
             }
 
             bob->append("indexPrefix", spec->indexPrefix);
             bob->append("indexName", spec->indexName);
             bob->append("parsedTextQuery", spec->parsedTextQuery);
+            if (spec->limit) {
+                bob->appendNumber("limit", spec->limit);
+            }
         }
         else if (STAGE_UPDATE == stats.stageType) {
             UpdateStats* spec = static_cast<UpdateStats*>(stats.specific.get());
@@ -436,6 +548,7 @@ namespace mongo {
                 bob->appendNumber("nMatched", spec->nMatched);
                 bob->appendNumber("nWouldModify", spec->nModified);
                 bob->appendNumber("nInvalidateSkips", spec->nInvalidateSkips);
+                bob->appendNumber("nSkippedLocked", spec->nSkippedLocked);
                 bob->appendBool("wouldInsert", spec->inserted);
                 bob->appendBool("fastmod", spec->fastmod);
                 bob->appendBool("fastmodinsert", spec->fastmodinsert);
@@ -549,7 +662,8 @@ namespace mongo {
             out->appendNumber("executionTimeMillis", totalTimeMillis);
         }
         else {
-            out->appendNumber("executionTimeMillisEstimate", stats->common.executionTimeMillis);
+            out->appendNumber("executionTimeMillisEstimate",
+                              stats->common.executionTimeNanos / kNanosPerMilli);
         }
 
         // Flatten the stats tree into a list.
@@ -649,6 +763,18 @@ namespace mongo {
             long long totalTimeMillis = CurOp::get(opCtx)->elapsedMillis();
             generateExecStats(winningStats.get(), verbosity, &execBob, totalTimeMillis);
 
+            // Report what it cost to pick the winning plan.
+            if (NULL != mps) {
+                const MultiPlanStats* trialStats =
+                    static_cast<const MultiPlanStats*>(mps->getSpecificStats());
+                BSONObjBuilder trialBob(execBob.subobjStart("trialPeriod"));
+                trialBob.appendNumber("works", trialStats->trialWorks);
+                trialBob.appendNumber("timeMillis", trialStats->trialMillis);
+                trialBob.appendNumber("plansAbandoned", trialStats->plansAbandoned);
+                trialBob.appendNumber("sharedIndexScans", trialStats->sharedIndexScans);
+                trialBob.doneFast();
+            }
+
             // Also generate exec stats for all plans, if the verbosity level is high enough.
             // These stats reflect what happened during the trial period that ranked the plans.
             if (verbosity >= ExplainCommon::EXEC_ALL_PLANS) {
@@ -717,7 +843,7 @@ namespace mongo {
         // root stage of the plan tree.
         const CommonStats* common = root->getCommonStats();
         statsOut->nReturned = common->advanced;
-        statsOut->executionTimeMillis = common->executionTimeMillis;
+        statsOut->executionTimeMillis = common->executionTimeNanos / kNanosPerMilli;
 
         // The other fields are aggregations over the stages in the plan tree. We flatten
         // the tree into a list and then compute these aggregations.
@@ -735,6 +861,16 @@ namespace mongo {
             }
             if (STAGE_SORT == stages[i]->stageType()) {
                 statsOut->hasSortStage = true;
+
+                const SortStats* spec =
+                    static_cast<const SortStats*>(stages[i]->getSpecificStats());
+                statsOut->sortSpills += spec->spills;
+                statsOut->sortSpilledBytes += spec->spilledBytes;
+            }
+            if (STAGE_CACHED_PLAN == stages[i]->stageType()) {
+                const CachedPlanStats* spec =
+                    static_cast<const CachedPlanStats*>(stages[i]->getSpecificStats());
+                statsOut->replanned = statsOut->replanned || spec->replanned;
             }
         }
     }
@@ -52,7 +52,10 @@ namespace mongo {
                              totalDocsExamined(0),
                              executionTimeMillis(0),
                              isIdhack(false),
-                             hasSortStage(false) { }
+                             hasSortStage(false),
+                             sortSpills(0),
+                             sortSpilledBytes(0),
+                             replanned(false) { }
 
         // The number of results returned by the plan.
         size_t nReturned;
@@ -71,6 +74,13 @@ namespace mongo {
 
         // Did this plan use an in-memory sort stage?
         bool hasSortStage;
+
+        // The number of sorted runs the plan's sort stages spilled to disk, and their total size.
+        size_t sortSpills;
+        unsigned long long sortSpilledBytes;
+
+        // Was a cached plan abandoned for one planned from scratch?
+        bool replanned;
     };
 
     /**
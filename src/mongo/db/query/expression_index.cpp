@@ -29,6 +29,7 @@
 #include "mongo/db/query/expression_index.h"
 
 #include <iostream>
+#include <list>
 
 #include "third_party/s2/s2regioncoverer.h"
 
@@ -36,14 +37,30 @@
 #include "mongo/db/geo/hash.h"
 #include "mongo/db/geo/r2_region_coverer.h"
 #include "mongo/db/hasher.h"
+#include "mongo/db/query/expression_index_knobs.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
     using std::set;
 
-    BSONObj ExpressionMapping::hash(const BSONElement& value) {
+namespace {
+
+    // Most recently used first, each key with the intervals of its covering.
+    typedef std::list<std::pair<std::string, std::vector<Interval> > > CachedCoverings;
+
+    stdx::mutex coveringCacheMutex;
+    CachedCoverings cachedCoverings;
+    unordered_map<std::string, CachedCoverings::iterator> cachedCoveringsIndex;
+
+}  // namespace
+
+    BSONObj ExpressionMapping::hash(const BSONElement& value, int hashVersion) {
         BSONObjBuilder bob;
-        bob.append("", BSONElementHasher::hash64(value, BSONElementHasher::DEFAULT_HASH_SEED));
+        bob.append("", BSONElementHasher::hash64(value,
+                                                 BSONElementHasher::DEFAULT_HASH_SEED,
+                                                 hashVersion));
         return bob.obj();
     }
 
@@ -209,4 +226,54 @@ namespace mongo {
         }
     }
 
+    // static
+    BSONObj GeoCoveringCache::makeKey(const BSONObj& geoQuery,
+                                      const BSONObj& indexInfoObj,
+                                      int maxCoveringCells) {
+        return BSON("q" << geoQuery << "i" << indexInfoObj << "c" << maxCoveringCells);
+    }
+
+    // static
+    bool GeoCoveringCache::get(const BSONObj& key, OrderedIntervalList* oilOut) {
+        stdx::lock_guard<stdx::mutex> lk(coveringCacheMutex);
+        auto it = cachedCoveringsIndex.find(std::string(key.objdata(), key.objsize()));
+        if (it == cachedCoveringsIndex.end()) {
+            return false;
+        }
+
+        cachedCoverings.splice(cachedCoverings.begin(), cachedCoverings, it->second);
+        const std::vector<Interval>& intervals = it->second->second;
+        oilOut->intervals.insert(oilOut->intervals.end(), intervals.begin(), intervals.end());
+        return true;
+    }
+
+    // static
+    void GeoCoveringCache::add(const BSONObj& key, const OrderedIntervalList& oil) {
+        const size_t maxSize = std::max(0, internalGeoCoveringCacheSize);
+        std::string keyData(key.objdata(), key.objsize());
+
+        stdx::lock_guard<stdx::mutex> lk(coveringCacheMutex);
+        if (cachedCoveringsIndex.count(keyData)) {
+            return;
+        }
+
+        while (!cachedCoverings.empty() && cachedCoverings.size() >= maxSize) {
+            cachedCoveringsIndex.erase(cachedCoverings.back().first);
+            cachedCoverings.pop_back();
+        }
+        if (0 == maxSize) {
+            return;
+        }
+
+        cachedCoverings.push_front(std::make_pair(keyData, oil.intervals));
+        cachedCoveringsIndex[keyData] = cachedCoverings.begin();
+    }
+
+    // static
+    void GeoCoveringCache::clear() {
+        stdx::lock_guard<stdx::mutex> lk(coveringCacheMutex);
+        cachedCoveringsIndex.clear();
+        cachedCoverings.clear();
+    }
+
 }  // namespace mongo
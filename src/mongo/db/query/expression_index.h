@@ -44,7 +44,10 @@ namespace mongo {
     class ExpressionMapping {
     public:
 
-        static BSONObj hash(const BSONElement& value);
+        /**
+         * Returns the key a hashed index with the given hashVersion stores for 'value'.
+         */
+        static BSONObj hash(const BSONElement& value, int hashVersion);
 
         static void cover2d(const R2Region& region,
                             const BSONObj& indexInfoObj,
@@ -57,4 +60,31 @@ namespace mongo {
                                   OrderedIntervalList* oilOut);
     };
 
+    /**
+     * Keeps the index intervals of recently planned geo predicate coverings, as computed by
+     * ExpressionMapping, for queries repeating the same geometry against the same index. Shared
+     * by the whole process and limited to the internalGeoCoveringCacheSize most recently used.
+     */
+    class GeoCoveringCache {
+    public:
+        /**
+         * Returns the key of the covering of the raw geo predicate 'geoQuery', as given to
+         * GeoMatchExpression, for the index 'indexInfoObj', with at most 'maxCoveringCells'
+         * cells for 2d indexes.
+         */
+        static BSONObj makeKey(const BSONObj& geoQuery,
+                               const BSONObj& indexInfoObj,
+                               int maxCoveringCells);
+
+        /**
+         * Appends the intervals cached for 'key' to 'oilOut' and returns true, or returns false
+         * if there are none.
+         */
+        static bool get(const BSONObj& key, OrderedIntervalList* oilOut);
+
+        static void add(const BSONObj& key, const OrderedIntervalList& oil);
+
+        static void clear();
+    };
+
 }  // namespace mongo
@@ -36,4 +36,6 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalGeoNearQuery2DMaxCoveringCells, int, 16);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalGeoCoveringCacheSize, int, 1000);
+
 }  // namespace mongo
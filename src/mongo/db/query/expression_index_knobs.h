@@ -44,4 +44,9 @@ namespace mongo {
      */
     extern int internalGeoNearQuery2DMaxCoveringCells;
 
+    /**
+     * The number of geo predicate coverings kept by GeoCoveringCache, 0 to disable it
+     */
+    extern int internalGeoCoveringCacheSize;
+
 }  // namespace mongo
@@ -40,6 +40,7 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/working_set_common.h"
@@ -92,7 +93,10 @@ namespace mongo {
     }
 
     ScopedRecoveryUnitSwapper::~ScopedRecoveryUnitSwapper() {
-        _txn->recoveryUnit()->abandonSnapshot();
+        // A snapshot pinned for the next getMore goes back into the ClientCursor still open.
+        if (_dismissed || !_txn->recoveryUnit()->isSnapshotPinned()) {
+            _txn->recoveryUnit()->abandonSnapshot();
+        }
 
         if (_dismissed) {
             // Just clean up the recovery unit which we originally got from the ClientCursor.
@@ -180,6 +184,19 @@ namespace mongo {
         return !exec->isEOF();
     }
 
+    void pinSnapshotForNextGetMore(OperationContext* txn, PlanExecutor::ExecState finalState) {
+        if (PlanExecutor::ADVANCED != finalState) {
+            return;
+        }
+
+        // The DBDirectClient shares its RecoveryUnit with the caller's operation.
+        if (txn->getClient()->isInDirectClient()) {
+            return;
+        }
+
+        txn->recoveryUnit()->pinSnapshot();
+    }
+
     void beginQueryOp(OperationContext* txn,
                       const NamespaceString& nss,
                       const BSONObj& queryObj,
@@ -211,9 +228,14 @@ namespace mongo {
         PlanSummaryStats summaryStats;
         Explain::getSummaryStats(exec, &summaryStats);
         curop->debug().scanAndOrder = summaryStats.hasSortStage;
+        if (summaryStats.sortSpills > 0) {
+            curop->debug().sortSpills = summaryStats.sortSpills;
+            curop->debug().sortSpilledBytes = summaryStats.sortSpilledBytes;
+        }
         curop->debug().nscanned = summaryStats.totalKeysExamined;
         curop->debug().nscannedObjects = summaryStats.totalDocsExamined;
         curop->debug().idhack = summaryStats.isIdhack;
+        curop->debug().replanned = summaryStats.replanned;
 
         const logger::LogComponent queryLogComponent = logger::LogComponent::kQuery;
         const logger::LogSeverity logLevelOne = logger::LogSeverity::Debug(1);
@@ -256,7 +278,8 @@ namespace mongo {
                               long long cursorid,
                               int pass,
                               bool& exhaust,
-                              bool* isCursorAuthorized) {
+                              bool* isCursorAuthorized,
+                              AwaitDataWait* awaitDataWait) {
 
         CurOp& curop = *CurOp::get(txn);
 
@@ -269,6 +292,9 @@ namespace mongo {
 
         const NamespaceString nss(ns);
 
+        // The prefetch of this batch, if any, must be done with the cursor before we pin it.
+        CursorPrefetcher::get()->waitFor(cursorid);
+
         // Depending on the type of cursor being operated on, we hold locks for the whole getMore,
         // or none of the getMore, or part of the getMore.  The three cases in detail:
         //
@@ -407,6 +433,14 @@ namespace mongo {
             // Get results out of the executor.
             exec->restoreState(txn);
 
+            // An awaitData cursor which finds nothing waits for the next insert. Take the insert
+            // count before running the executor so inserts committed meanwhile are not missed.
+            if ((queryOptions & QueryOption_AwaitData) && ctx && ctx->getCollection() &&
+                    ctx->getCollection()->isCapped()) {
+                awaitDataWait->notifier = ctx->getCollection()->getCappedInsertNotifier();
+                awaitDataWait->lastInsertCount = awaitDataWait->notifier->getCount();
+            }
+
             BSONObj obj;
             PlanExecutor::ExecState state;
             while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
@@ -471,6 +505,9 @@ namespace mongo {
             else {
                 // Continue caching the ClientCursor.
                 cc->incPos(numResults);
+                if (!cc->isAggCursor()) {
+                    pinSnapshotForNextGetMore(txn, state);
+                }
                 exec->saveState();
                 LOG(5) << "getMore saving client cursor ended with state "
                        << PlanExecutor::statestr(state)
@@ -547,7 +584,8 @@ namespace mongo {
         LOG(2) << "Running query: " << cq->toStringShort();
 
         // Parse, canonicalize, plan, transcribe, and get a plan executor.
-        AutoGetCollectionForRead ctx(txn, nss);
+        AutoGetCollectionForRead ctx(txn, nss,
+                                     AutoGetCollectionForRead::BatchBoundarySnapshot::kAllowed);
         Collection* collection = ctx.getCollection();
 
         const int dbProfilingLevel = ctx.getDb() ? ctx.getDb()->getProfilingLevel() :
@@ -690,6 +728,7 @@ namespace mongo {
 
         if (shouldSaveCursor(txn, collection, state, exec.get())) {
             // We won't use the executor until it's getMore'd.
+            pinSnapshotForNextGetMore(txn, state);
             exec->saveState();
 
             // Allocate a new ClientCursor.  We don't have to worry about leaking it as it's
@@ -711,7 +750,9 @@ namespace mongo {
             else {
                 // We stash away the RecoveryUnit in the ClientCursor.  It's used for subsequent
                 // getMore requests.  The calling OpCtx gets a fresh RecoveryUnit.
-                txn->recoveryUnit()->abandonSnapshot();
+                if (!txn->recoveryUnit()->isSnapshotPinned()) {
+                    txn->recoveryUnit()->abandonSnapshot();
+                }
                 cc->setOwnedRecoveryUnit(txn->releaseRecoveryUnit());
                 StorageEngine* storageEngine = getGlobalServiceContext()->getGlobalStorageEngine();
                 invariant(txn->setRecoveryUnit(storageEngine->newRecoveryUnit(),
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "mongo/db/clientcursor.h"
@@ -38,6 +39,7 @@
 
 namespace mongo {
 
+    class CappedInsertNotifier;
     class NamespaceString;
     class OperationContext;
 
@@ -109,6 +111,15 @@ namespace mongo {
                                  PlanExecutor* exec,
                                  bool isTailable);
 
+    /**
+     * Called just before saving a cursor's PlanExecutor between batches. If the batch was cut
+     * short (the executor had more results, 'finalState' is ADVANCED), asks the storage engine to
+     * keep the current snapshot open so that the next getMore continues from the saved position
+     * without re-seeking. Snapshots of cursors which hit EOF are never pinned, so that tailable
+     * and awaitData cursors see new data on their next getMore.
+     */
+    void pinSnapshotForNextGetMore(OperationContext* txn, PlanExecutor::ExecState finalState);
+
     /**
      * Fills out the CurOp for "txn" with information about this query.
      */
@@ -147,8 +158,21 @@ namespace mongo {
                              CanonicalQuery* cq,
                              PlanExecutor** execOut);
 
+    /**
+     * What a legacy awaitData getMore which found no new results waits on before trying again:
+     * the insert notifier of the capped collection and its insert count from before the getMore
+     * ran, so that inserts committed during the getMore are not missed.
+     */
+    struct AwaitDataWait {
+        std::shared_ptr<CappedInsertNotifier> notifier;
+        uint64_t lastInsertCount = 0;
+    };
+
     /**
      * Called from the getMore entry point in ops/query.cpp.
+     *
+     * Returns NULL when an awaitData getMore found no results, in which case 'awaitDataWait' says
+     * what to wait for before calling again.
      */
     QueryResult::View getMore(OperationContext* txn,
                               const char* ns,
@@ -156,7 +180,8 @@ namespace mongo {
                               long long cursorid,
                               int pass,
                               bool& exhaust,
-                              bool* isCursorAuthorized);
+                              bool* isCursorAuthorized,
+                              AwaitDataWait* awaitDataWait);
 
     /**
      * Run the query 'q' and place the result in 'result'.
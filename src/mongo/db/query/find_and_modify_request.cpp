@@ -45,6 +45,7 @@ namespace {
     const char kNewField[] = "new";
     const char kFieldProjectionField[] = "fields";
     const char kUpsertField[] = "upsert";
+    const char kSkipLockedField[] = "skipLocked";
     const char kWriteConcernField[] = "writeConcern";
 
 } // unnamed namespace
@@ -100,6 +101,10 @@ namespace {
             builder.append(kNewField, _shouldReturnNew.get());
         }
 
+        if (_skipLocked) {
+            builder.append(kSkipLockedField, _skipLocked.get());
+        }
+
         if (_writeConcern) {
             builder.append(kWriteConcernField, _writeConcern->toBSON());
         }
@@ -117,6 +122,7 @@ namespace {
         bool isUpsert = cmdObj[kUpsertField].trueValue();
         bool isRemove = cmdObj[kRemoveField].trueValue();
         bool isUpdate = cmdObj.hasField(kUpdateField);
+        bool skipLocked = cmdObj[kSkipLockedField].trueValue();
 
         if (!isRemove && !isUpdate) {
             return {ErrorCodes::FailedToParse,
@@ -141,10 +147,18 @@ namespace {
             }
         }
 
+        if (skipLocked && isUpsert) {
+            return {ErrorCodes::FailedToParse,
+                "Cannot specify both skipLocked=true and upsert=true"};
+        }
+
         FindAndModifyRequest request(std::move(fullNs), query, updateObj);
         request._isRemove = isRemove;
         request.setFieldProjection(fields);
         request.setSort(sort);
+        if (cmdObj.hasField(kSkipLockedField)) {
+            request.setSkipLocked(skipLocked);
+        }
 
         if (!isRemove) {
             request.setShouldReturnNew(shouldReturnNew);
@@ -172,6 +186,10 @@ namespace {
         _isUpsert = upsert;
     }
 
+    void FindAndModifyRequest::setSkipLocked(bool skipLocked) {
+        _skipLocked = skipLocked;
+    }
+
     void FindAndModifyRequest::setWriteConcern(WriteConcernOptions writeConcern) {
         _writeConcern = std::move(writeConcern);
     }
@@ -208,4 +226,8 @@ namespace {
         return _isRemove;
     }
 
+    bool FindAndModifyRequest::shouldSkipLocked() const {
+        return _skipLocked.value_or(false);
+    }
+
 }
@@ -75,7 +75,8 @@ namespace mongo {
          *   update: <document>,
          *   new: <boolean>,
          *   fields: <document>,
-         *   upsert: <boolean>
+         *   upsert: <boolean>,
+         *   skipLocked: <boolean>
          * }
          *
          * Note: does not parse the writeConcern field or the findAndModify field.
@@ -97,6 +98,7 @@ namespace mongo {
         bool shouldReturnNew() const;
         bool isUpsert() const;
         bool isRemove() const;
+        bool shouldSkipLocked() const;
 
         // Not implemented. Use extractWriteConcern() to get the setting instead.
         WriteConcernOptions getWriteConcern() const;
@@ -134,6 +136,14 @@ namespace mongo {
          */
         void setWriteConcern(WriteConcernOptions writeConcern);
 
+        /**
+         * If skipLocked is true, documents that another operation is modifying at the same time
+         * are passed over, rather than waited for, in favor of the next one that matches. This
+         * suits consumers of a queue of documents, which only need some matching document.
+         * Can't be combined with upsert.
+         */
+        void setSkipLocked(bool skipLocked);
+
     private:
         /**
          * Creates a new FindAndModifyRequest with the required fields.
@@ -153,6 +163,7 @@ namespace mongo {
         boost::optional<BSONObj> _fieldProjection;
         boost::optional<BSONObj> _sort;
         boost::optional<bool> _shouldReturnNew;
+        boost::optional<bool> _skipLocked;
         boost::optional<WriteConcernOptions> _writeConcern;
 
         // Flag used internally to differentiate whether this is an update or remove type request.
@@ -69,6 +69,24 @@ namespace {
         ASSERT_EQUALS(expectedObj, request.toBSON());
     }
 
+    TEST(FindAndModifyRequest, UpdateWithSkipLocked) {
+        const BSONObj query(BSON("x" << 1));
+        const BSONObj update(BSON("y" << 1));
+        auto request = FindAndModifyRequest::makeUpdate(NamespaceString("test.user"),
+                                                        query,
+                                                        update);
+        request.setSkipLocked(true);
+
+        BSONObj expectedObj(fromjson(R"json({
+            findAndModify: 'user',
+            query: { x: 1 },
+            update: { y: 1 },
+            skipLocked: true
+        })json"));
+
+        ASSERT_EQUALS(expectedObj, request.toBSON());
+    }
+
     TEST(FindAndModifyRequest, UpdateWithUpsertFalse) {
         const BSONObj query(BSON("x" << 1));
         const BSONObj update(BSON("y" << 1));
@@ -320,6 +338,7 @@ namespace {
         ASSERT_EQUALS(BSONObj(), request.getFields());
         ASSERT_EQUALS(BSONObj(), request.getSort());
         ASSERT_EQUALS(false, request.shouldReturnNew());
+        ASSERT_EQUALS(false, request.shouldSkipLocked());
     }
 
     TEST(FindAndModifyRequest, ParseWithUpdateFullSpec) {
@@ -423,6 +442,33 @@ namespace {
         ASSERT_NOT_OK(parseStatus.getStatus());
     }
 
+    TEST(FindAndModifyRequest, ParseWithSkipLocked) {
+        BSONObj cmdObj(fromjson(R"json({
+            query: { state: 'ready' },
+            update: { $set: { state: 'taken' } },
+            sort: { pri: -1 },
+            skipLocked: true
+        })json"));
+
+        auto parseStatus = FindAndModifyRequest::parseFromBSON(NamespaceString("a.b"), cmdObj);
+        ASSERT_OK(parseStatus.getStatus());
+        ASSERT_EQUALS(true, parseStatus.getValue().shouldSkipLocked());
+        ASSERT_EQUALS(false, parseStatus.getValue().isUpsert());
+    }
+
+    TEST(FindAndModifyRequest, ParseWithSkipLockedPlusUpsert) {
+        BSONObj cmdObj(fromjson(R"json({
+            findAndModify: 'user',
+            query: { x: 1 },
+            update: { y: 1 },
+            upsert: true,
+            skipLocked: true
+        })json"));
+
+        auto parseStatus = FindAndModifyRequest::parseFromBSON(NamespaceString("a.b"), cmdObj);
+        ASSERT_NOT_OK(parseStatus.getStatus());
+    }
+
     TEST(FindAndModifyRequest, ParseWithRemoveAndReturnNew) {
         BSONObj cmdObj(fromjson(R"json({
             findAndModify: 'user',
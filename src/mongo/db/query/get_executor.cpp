@@ -38,6 +38,7 @@
 #include "mongo/base/error_codes.h"
 #include "mongo/base/parse_number.h"
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/exec/cached_plan.h"
 #include "mongo/db/exec/count.h"
 #include "mongo/db/exec/delete.h"
@@ -46,17 +47,20 @@
 #include "mongo/db/exec/idhack.h"
 #include "mongo/db/exec/multi_plan.h"
 #include "mongo/db/exec/oplogstart.h"
+#include "mongo/db/exec/parallel_filter.h"
 #include "mongo/db/exec/projection.h"
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/subplan.h"
 #include "mongo/db/exec/update.h"
 #include "mongo/db/index_names.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/summary_access_method.h"
 #include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/index_stats.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_executor.h"
@@ -132,29 +136,26 @@ namespace mongo {
     }  // namespace
 
 
+    /**
+     * Returns whether an IDHackStage can look up documents by _id in 'collection'.
+     */
+    static bool canFindById(OperationContext* txn, const Collection* collection) {
+        return collection->isClustered() || collection->getIndexCatalog()->findIdIndex(txn);
+    }
+
     void fillOutPlannerParams(OperationContext* txn,
                               Collection* collection,
                               CanonicalQuery* canonicalQuery,
                               QueryPlannerParams* plannerParams) {
-        // If it's not NULL, we may have indices.  Access the catalog and fill out IndexEntry(s)
-        IndexCatalog::IndexIterator ii = collection->getIndexCatalog()->getIndexIterator(txn,
-                                                                                         false);
-        while (ii.more()) {
-            const IndexDescriptor* desc = ii.next();
-
-            IndexCatalogEntry* ice = ii.catalogEntry(desc);
-            if (filteredIndexBad(ice->getFilterExpression(), canonicalQuery)) {
+        // If it's not NULL, we may have indices. The collection keeps their IndexEntry(s).
+        std::shared_ptr<const std::vector<IndexEntry>> indexEntries =
+            collection->infoCache()->getPlannerIndexEntries(txn);
+        plannerParams->indices.reserve(indexEntries->size());
+        for (const IndexEntry& entry : *indexEntries) {
+            if (filteredIndexBad(entry.filterExpr, canonicalQuery)) {
                 continue;
             }
-
-            plannerParams->indices.push_back(IndexEntry(desc->keyPattern(),
-                                                        desc->getAccessMethodName(),
-                                                        desc->isMultikey(txn),
-                                                        desc->isSparse(),
-                                                        desc->unique(),
-                                                        desc->indexName(),
-                                                        ice->getFilterExpression(),
-                                                        desc->infoObj()));
+            plannerParams->indices.push_back(entry);
         }
 
         // If query supports index filters, filter params.indices by indices in query settings.
@@ -252,6 +253,18 @@ namespace mongo {
                 return Status::OK();
             }
 
+            // The query stats store aggregates the operation's statistics by this shape.
+            CurOp* curOp = CurOp::get(opCtx);
+            if (curOp && curOp->debug().queryShapeKey.empty()) {
+                OpDebug& opDebug = curOp->debug();
+                opDebug.queryShapeNs = canonicalQuery->ns();
+                opDebug.queryShapeKey =
+                    collection->infoCache()->getPlanCache()->computeKey(*canonicalQuery);
+                opDebug.queryShape = BSON("query" << canonicalQuery->getQueryObj()
+                                          << "sort" << canonicalQuery->getParsed().getSort()
+                                          << "projection" << canonicalQuery->getParsed().getProj());
+            }
+
             // Fill out the planning params.  We use these for both cached solutions and non-cached.
             QueryPlannerParams plannerParams;
             plannerParams.options = plannerOptions;
@@ -259,7 +272,7 @@ namespace mongo {
 
             // If we have an _id index we can use an idhack plan.
             if (IDHackStage::supportsQuery(*canonicalQuery) &&
-                collection->getIndexCatalog()->findIdIndex(opCtx)) {
+                canFindById(opCtx, collection)) {
 
                 LOG(2) << "Using idhack: " << canonicalQuery->toStringShort();
 
@@ -325,10 +338,11 @@ namespace mongo {
                                                             &qs);
 
                 if (status.isOK()) {
+                    const bool isFastCount =
+                        (plannerParams.options & QueryPlannerParams::PRIVATE_IS_COUNT)
+                        && turnIxscanIntoCount(qs);
                     verify(StageBuilder::build(opCtx, collection, *qs, ws, rootOut));
-                    if ((plannerParams.options & QueryPlannerParams::PRIVATE_IS_COUNT)
-                        && turnIxscanIntoCount(qs)) {
-
+                    if (isFastCount) {
                         LOG(2) << "Using fast count: " << canonicalQuery->toStringShort()
                                << ", planSummary: " << Explain::getPlanSummary(*rootOut);
                     }
@@ -477,7 +491,7 @@ namespace mongo {
         }
 
         if (!CanonicalQuery::isSimpleIdQuery(unparsedQuery) ||
-            !collection->getIndexCatalog()->findIdIndex(txn)) {
+            !canFindById(txn, collection)) {
 
             const WhereCallbackReal whereCallback(txn, collection->ns().db());
             CanonicalQuery* cq;
@@ -638,6 +652,10 @@ namespace {
         if (shardingState.needCollectionMetadata(txn->getClient(), nss.ns())) {
             options |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
         }
+
+        // Read by the stage builder when it builds the filters of the plans.
+        requestedQueryParallelism(txn) = cq->getParsed().getParallelism();
+
         return getExecutor(txn, collection, cq.release(), PlanExecutor::YIELD_AUTO, out, options);
     }
 
@@ -723,6 +741,7 @@ namespace {
         deleteStageParams.fromMigrate = request->isFromMigrate();
         deleteStageParams.isExplain = request->isExplain();
         deleteStageParams.returnDeleted = request->shouldReturnDeleted();
+        deleteStageParams.skipLocked = request->shouldSkipLocked();
 
         unique_ptr<WorkingSet> ws(new WorkingSet());
         PlanExecutor::YieldPolicy policy = parsedDelete->canYield() ? PlanExecutor::YIELD_AUTO :
@@ -747,7 +766,7 @@ namespace {
             }
 
             if (CanonicalQuery::isSimpleIdQuery(unparsedQuery)
-                    && collection->getIndexCatalog()->findIdIndex(txn)
+                    && canFindById(txn, collection)
                     && request->getProj().isEmpty()) {
                 LOG(2) << "Using idhack: " << unparsedQuery.toString();
 
@@ -903,7 +922,7 @@ namespace {
             }
 
             if (CanonicalQuery::isSimpleIdQuery(unparsedQuery)
-                    && collection->getIndexCatalog()->findIdIndex(txn)
+                    && canFindById(txn, collection)
                     && request->getProj().isEmpty()) {
 
                 LOG(2) << "Using idhack: " << unparsedQuery.toString();
@@ -1065,35 +1084,33 @@ namespace {
 
             IndexScanNode* isn = static_cast<IndexScanNode*>(root->children[0]);
 
-            // No filters allowed and side-stepping isSimpleRange for now.  TODO: do we ever see
-            // isSimpleRange here?  because we could well use it.  I just don't think we ever do see
-            // it.
-
-            if (NULL != isn->filter.get() || isn->bounds.isSimpleRange) {
+            // Side-stepping isSimpleRange for now.  TODO: do we ever see isSimpleRange here?
+            // because we could well use it.  I just don't think we ever do see it.
+            if (isn->bounds.isSimpleRange) {
                 return false;
             }
 
-            // Make sure the bounds are OK.
-            BSONObj startKey;
-            bool startKeyInclusive;
-            BSONObj endKey;
-            bool endKeyInclusive;
+            // Make the count node that we replace the fetch + ixscan with.
+            CountNode* cn = new CountNode();
+            cn->indexKeyPattern = isn->indexKeyPattern;
 
+            // A single interval is counted by seeking to its start and stopping at its end.  Any
+            // other bounds, such as those of an $in or of a predicate on a non-leading field of
+            // the index only, are walked with an IndexBoundsChecker.
             if (!IndexBoundsBuilder::isSingleInterval( isn->bounds,
-                                                       &startKey,
-                                                       &startKeyInclusive,
-                                                       &endKey,
-                                                       &endKeyInclusive )) {
-                return false;
+                                                       &cn->startKey,
+                                                       &cn->startKeyInclusive,
+                                                       &cn->endKey,
+                                                       &cn->endKeyInclusive )) {
+                cn->useBounds = true;
+                cn->bounds = isn->bounds;
+                cn->direction = isn->direction;
             }
 
-            // Make the count node that we replace the fetch + ixscan with.
-            CountNode* cn = new CountNode();
-            cn->indexKeyPattern = isn->indexKeyPattern;
-            cn->startKey = startKey;
-            cn->startKeyInclusive = startKeyInclusive;
-            cn->endKey = endKey;
-            cn->endKeyInclusive = endKeyInclusive;
+            // The filter of an ixscan only refers to the index key fields, so it can be applied
+            // to the keys as they are counted.
+            cn->filter.reset(isn->filter.release());
+
             // Takes ownership of 'cn' and deletes the old root.
             soln->root.reset(cn);
             return true;
@@ -1280,6 +1297,36 @@ namespace {
 
         invariant(cq.get());
 
+        // A summary index whose groups the query picks answers the count from its groups.
+        if (request.getHint().isEmpty()) {
+            IndexCatalog::IndexIterator ii =
+                collection->getIndexCatalog()->getIndexIterator(txn, false);
+            while (ii.more()) {
+                const IndexDescriptor* desc = ii.next();
+                if (IndexNames::SUMMARY != desc->getAccessMethodName()) {
+                    continue;
+                }
+                const SummaryAccessMethod* sam = static_cast<const SummaryAccessMethod*>(
+                    collection->getIndexCatalog()->getIndex(desc));
+                if (!sam->canMatchGroups(cq->root())) {
+                    continue;
+                }
+                LOG(2) << "Using summary index " << desc->indexName() << " to count "
+                       << cq->toStringShort();
+                // The filter is owned by 'cq', which the executor owns.
+                root = new CountStage(txn, collection, request, ws.get(), NULL,
+                                      desc->indexName(), cq->root());
+                return PlanExecutor::make(txn,
+                                          ws.release(),
+                                          root,
+                                          NULL,
+                                          cq.release(),
+                                          collection,
+                                          yieldPolicy,
+                                          execOut);
+            }
+        }
+
         const size_t plannerOptions = QueryPlannerParams::PRIVATE_IS_COUNT;
         Status prepStatus = prepareExecution(txn, collection, ws.get(), cq.get(), plannerOptions,
                                              &root, &querySolution);
@@ -1384,7 +1431,8 @@ namespace {
             const IndexDescriptor* desc = ii.next();
             // The distinct hack can work if any field is in the index but it's not always clear
             // if it's a win unless it's the first field.
-            if (desc->keyPattern().firstElement().fieldName() == field) {
+            if (desc->keyPattern().firstElement().fieldName() == field
+                && IndexNames::SUMMARY != desc->getAccessMethodName()) {
                 plannerParams.indices.push_back(IndexEntry(desc->keyPattern(),
                                                            desc->getAccessMethodName(),
                                                            desc->isMultikey(txn),
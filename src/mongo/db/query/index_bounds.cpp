@@ -67,6 +67,37 @@ namespace mongo {
 
     }  // namespace
 
+    bool IndexBounds::equals(const IndexBounds& other) const {
+        if (isSimpleRange != other.isSimpleRange) {
+            return false;
+        }
+
+        if (isSimpleRange) {
+            return endKeyInclusive == other.endKeyInclusive
+                && 0 == startKey.woCompare(other.startKey, BSONObj(), false)
+                && 0 == endKey.woCompare(other.endKey, BSONObj(), false);
+        }
+
+        if (fields.size() != other.fields.size()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < fields.size(); ++i) {
+            const vector<Interval>& intervals = fields[i].intervals;
+            const vector<Interval>& otherIntervals = other.fields[i].intervals;
+            if (intervals.size() != otherIntervals.size()) {
+                return false;
+            }
+            for (size_t j = 0; j < intervals.size(); ++j) {
+                if (!intervals[j].equals(otherIntervals[j])) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
     // For debugging.
     size_t IndexBounds::size() const {
         return fields.size();
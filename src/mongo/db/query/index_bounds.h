@@ -88,6 +88,12 @@ namespace mongo {
         // We can traverse this backwards if indexed descending.
         bool isValidFor(const BSONObj& keyPattern, int direction);
 
+        /**
+         * Returns true if 'other' allows exactly the same keys, listed the same way. Field names
+         * are ignored.
+         */
+        bool equals(const IndexBounds& other) const;
+
         // Methods below used for debugging purpose only. Do not use outside testing code.
         size_t size() const;
         std::string getFieldName(size_t i) const;
@@ -349,7 +349,7 @@ namespace mongo {
         }
         else if (MatchExpression::EQ == expr->matchType()) {
             const EqualityMatchExpression* node = static_cast<const EqualityMatchExpression*>(expr);
-            translateEquality(node->getData(), isHashed, oilOut, tightnessOut);
+            translateEquality(node->getData(), index, isHashed, oilOut, tightnessOut);
         }
         else if (MatchExpression::LTE == expr->matchType()) {
             const LTEMatchExpression* node = static_cast<const LTEMatchExpression*>(expr);
@@ -544,12 +544,43 @@ namespace mongo {
 
             // Create our various intervals.
 
-            IndexBoundsBuilder::BoundsTightness tightness;
+            // Equalities that aren't arrays are each indexed as themselves, so make point
+            // intervals that all point into the one BSONObj, instead of a BSONObj for each of
+            // what can be many thousands. The set holds them in interval order, without
+            // duplicates.
+            bool scalarEqualities = !isHashed;
             for (BSONElementSet::iterator it = afr.equalities().begin();
-                 it != afr.equalities().end(); ++it) {
-                translateEquality(*it, isHashed, oilOut, &tightness);
-                if (tightness != IndexBoundsBuilder::EXACT) {
-                    *tightnessOut = tightness;
+                 scalarEqualities && it != afr.equalities().end(); ++it) {
+                scalarEqualities = Array != it->type();
+            }
+
+            IndexBoundsBuilder::BoundsTightness tightness;
+            if (scalarEqualities) {
+                BSONObjBuilder bob;
+                for (BSONElementSet::iterator it = afr.equalities().begin();
+                     it != afr.equalities().end(); ++it) {
+                    bob.appendAs(*it, "");
+                }
+                const BSONObj points = bob.obj();
+
+                oilOut->intervals.reserve(afr.equalities().size() + afr.numRegexes() + 1);
+                BSONObjIterator it(points);
+                while (it.more()) {
+                    Interval ival;
+                    ival._intervalData = points;
+                    ival.start = ival.end = it.next();
+                    ival.startInclusive = ival.endInclusive = true;
+                    oilOut->intervals.push_back(ival);
+                }
+                // Null is the only one that isn't EXACT, which is dealt with below.
+            }
+            else {
+                for (BSONElementSet::iterator it = afr.equalities().begin();
+                     it != afr.equalities().end(); ++it) {
+                    translateEquality(*it, index, isHashed, oilOut, &tightness);
+                    if (tightness != IndexBoundsBuilder::EXACT) {
+                        *tightnessOut = tightness;
+                    }
                 }
             }
 
@@ -581,20 +612,39 @@ namespace mongo {
 
             const GeoMatchExpression* gme = static_cast<const GeoMatchExpression*>(expr);
 
-            if (mongoutils::str::equals("2dsphere", elt.valuestrsafe())) {
+            // Computing coverings is costly, and applications tend to repeat their geometries.
+            const BSONObj coveringKey =
+                GeoCoveringCache::makeKey(gme->getRawObj(),
+                                          index.infoObj,
+                                          internalGeoPredicateQuery2DMaxCoveringCells);
+
+            if (GeoCoveringCache::get(coveringKey, oilOut)) {
+                *tightnessOut = IndexBoundsBuilder::INEXACT_FETCH;
+            }
+            else if (mongoutils::str::equals("2dsphere", elt.valuestrsafe())) {
                 verify(gme->getGeoExpression().getGeometry().hasS2Region());
                 const S2Region& region = gme->getGeoExpression().getGeometry().getS2Region();
-                ExpressionMapping::cover2dsphere(region, index.infoObj, oilOut);
+                OrderedIntervalList covering;
+                ExpressionMapping::cover2dsphere(region, index.infoObj, &covering);
+                GeoCoveringCache::add(coveringKey, covering);
+                oilOut->intervals.insert(oilOut->intervals.end(),
+                                         covering.intervals.begin(),
+                                         covering.intervals.end());
                 *tightnessOut = IndexBoundsBuilder::INEXACT_FETCH;
             }
             else if (mongoutils::str::equals("2d", elt.valuestrsafe())) {
                 verify(gme->getGeoExpression().getGeometry().hasR2Region());
                 const R2Region& region = gme->getGeoExpression().getGeometry().getR2Region();
 
+                OrderedIntervalList covering;
                 ExpressionMapping::cover2d(region,
                                            index.infoObj,
                                            internalGeoPredicateQuery2DMaxCoveringCells,
-                                           oilOut);
+                                           &covering);
+                GeoCoveringCache::add(coveringKey, covering);
+                oilOut->intervals.insert(oilOut->intervals.end(),
+                                         covering.intervals.begin(),
+                                         covering.intervals.end());
 
                 *tightnessOut = IndexBoundsBuilder::INEXACT_FETCH;
             }
@@ -691,48 +741,50 @@ namespace mongo {
         // This can happen.
         if (iv.empty()) { return; }
 
-        // Step 1: sort.
-        std::sort(iv.begin(), iv.end(), IntervalComparison);
+        // Step 1: sort. Intervals of a large $in come sorted already.
+        if (!std::is_sorted(iv.begin(), iv.end(), IntervalComparison)) {
+            std::sort(iv.begin(), iv.end(), IntervalComparison);
+        }
 
-        // Step 2: Walk through and merge.
-        size_t i = 0;
-        while (i < iv.size() - 1) {
-            // Compare i with i + 1.
-            Interval::IntervalComparison cmp = iv[i].compare(iv[i + 1]);
+        // Step 2: Walk through and merge, into iv[0..last].
+        size_t last = 0;
+        for (size_t i = 1; i < iv.size(); ++i) {
+            // Compare the last merged interval with the next one.
+            Interval::IntervalComparison cmp = iv[last].compare(iv[i]);
 
             // This means our sort didn't work.
             verify(Interval::INTERVAL_SUCCEEDS != cmp);
 
             // Intervals are correctly ordered.
             if (Interval::INTERVAL_PRECEDES == cmp) {
-                // We can move to the next pair.
-                ++i;
+                // Keep interval i as the next one.
+                ++last;
+                if (last != i) {
+                    iv[last] = iv[i];
+                }
             }
             else if (Interval::INTERVAL_EQUALS == cmp || Interval::INTERVAL_WITHIN == cmp) {
-                // Interval 'i' is equal to i+1, or is contained within i+1.
-                // Remove interval i and don't move to the next value of 'i'.
-                iv.erase(iv.begin() + i);
+                // Interval 'last' is equal to i, or is contained within i.
+                // Replace interval 'last' by i.
+                iv[last] = iv[i];
             }
             else if (Interval::INTERVAL_CONTAINS == cmp) {
-                // Interval 'i' contains i+1, remove i+1 and don't move to the next value of 'i'.
-                iv.erase(iv.begin() + i + 1);
+                // Interval 'last' contains i: drop i.
             }
             else if (Interval::INTERVAL_OVERLAPS_BEFORE == cmp
                      || Interval::INTERVAL_PRECEDES_COULD_UNION == cmp) {
-                // We want to merge intervals i and i+1.
-                // Interval 'i' starts before interval 'i+1'.
+                // We want to merge intervals 'last' and i.
+                // Interval 'last' starts before interval i.
                 BSONObjBuilder bob;
-                bob.appendAs(iv[i].start, "");
-                bob.appendAs(iv[i + 1].end, "");
+                bob.appendAs(iv[last].start, "");
+                bob.appendAs(iv[i].end, "");
                 BSONObj data = bob.obj();
-                bool startInclusive = iv[i].startInclusive;
-                bool endInclusive = iv[i + 1].endInclusive;
-                iv.erase(iv.begin() + i);
-                // iv[i] is now the former iv[i + 1]
-                iv[i] = makeRangeInterval(data, startInclusive, endInclusive);
-                // Don't increment 'i'.
+                bool startInclusive = iv[last].startInclusive;
+                bool endInclusive = iv[i].endInclusive;
+                iv[last] = makeRangeInterval(data, startInclusive, endInclusive);
             }
         }
+        iv.resize(last + 1);
     }
 
     // static
@@ -813,14 +865,17 @@ namespace mongo {
     }
 
     // static
-    void IndexBoundsBuilder::translateEquality(const BSONElement& data, bool isHashed,
-                                               OrderedIntervalList* oil, BoundsTightness* tightnessOut) {
+    void IndexBoundsBuilder::translateEquality(const BSONElement& data,
+                                               const IndexEntry& index,
+                                               bool isHashed,
+                                               OrderedIntervalList* oil,
+                                               BoundsTightness* tightnessOut) {
         // We have to copy the data out of the parse tree and stuff it into the index
         // bounds.  BSONValue will be useful here.
         if (Array != data.type()) {
             BSONObj dataObj;
             if (isHashed) {
-                dataObj = ExpressionMapping::hash(data);
+                dataObj = ExpressionMapping::hash(data, index.infoObj["hashVersion"].numberInt());
             }
             else {
                 dataObj = objFromElement(data);
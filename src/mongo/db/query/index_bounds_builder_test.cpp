@@ -36,6 +36,8 @@
 #include <memory>
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/expression_index.h"
+#include "mongo/db/query/expression_index_knobs.h"
 #include "mongo/unittest/unittest.h"
 
 using namespace mongo;
@@ -511,6 +513,40 @@ namespace {
         ASSERT_EQUALS(tightness, IndexBoundsBuilder::EXACT);
     }
 
+    TEST(IndexBoundsBuilderTest, TranslateLargeIn) {
+        IndexEntry testIndex = IndexEntry(BSONObj());
+        BSONObjBuilder inBob;
+        {
+            BSONArrayBuilder values(inBob.subarrayStart("$in"));
+            for (int i = 0; i < 10000; i++) {
+                values.append((i * 7919) % 10000);
+                values.append((i * 7919) % 10000); // a duplicate
+            }
+            values.appendNull();
+            values.append("a");
+        }
+        BSONObj obj = BSON("a" << inBob.obj());
+        unique_ptr<MatchExpression> expr(parseMatchExpression(obj));
+        BSONElement elt = obj.firstElement();
+        OrderedIntervalList oil;
+        IndexBoundsBuilder::BoundsTightness tightness;
+        IndexBoundsBuilder::translate(expr.get(), elt, testIndex, &oil, &tightness);
+        ASSERT_EQUALS(oil.name, "a");
+        ASSERT_EQUALS(oil.intervals.size(), 10002U);
+        ASSERT_EQUALS(Interval::INTERVAL_EQUALS, oil.intervals[0].compare(
+            Interval(fromjson("{'': null, '': null}"), true, true)));
+        for (int i = 0; i < 10000; i++) {
+            ASSERT_EQUALS(Interval::INTERVAL_EQUALS, oil.intervals[i + 1].compare(
+                Interval(BSON("" << i << "" << i), true, true)));
+            // All the points share their data.
+            ASSERT_EQUALS(oil.intervals[0]._intervalData.objdata(),
+                          oil.intervals[i + 1]._intervalData.objdata());
+        }
+        ASSERT_EQUALS(Interval::INTERVAL_EQUALS, oil.intervals[10001].compare(
+            Interval(fromjson("{'': 'a', '': 'a'}"), true, true)));
+        ASSERT_EQUALS(tightness, IndexBoundsBuilder::INEXACT_FETCH);
+    }
+
     TEST(IndexBoundsBuilderTest, TranslateInArray) {
         IndexEntry testIndex = IndexEntry(BSONObj());
         BSONObj obj = fromjson("{a: {$in: [[1], 2]}}");
@@ -1391,4 +1427,70 @@ namespace {
         ASSERT(tightness == IndexBoundsBuilder::INEXACT_FETCH);
     }
 
+    //
+    // Caching of geo coverings
+    //
+
+    TEST(GeoCoveringCacheTest, GetReturnsAddedIntervals) {
+        GeoCoveringCache::clear();
+        BSONObj key =
+            GeoCoveringCache::makeKey(fromjson("{a: {$geoWithin: {$box: [[0, 0], [1, 1]]}}}"),
+                                      fromjson("{key: {a: '2d'}, name: 'a_2d'}"),
+                                      16);
+        OrderedIntervalList oil;
+        ASSERT_FALSE(GeoCoveringCache::get(key, &oil));
+
+        OrderedIntervalList covering;
+        covering.intervals.push_back(IndexBoundsBuilder::makeRangeInterval(
+            BSON("" << 1 << "" << 2), true, true));
+        covering.intervals.push_back(IndexBoundsBuilder::makeRangeInterval(
+            BSON("" << 5 << "" << 8), true, false));
+        GeoCoveringCache::add(key, covering);
+
+        ASSERT_TRUE(GeoCoveringCache::get(key, &oil));
+        ASSERT_EQUALS(2U, oil.intervals.size());
+        ASSERT_EQUALS(Interval::INTERVAL_EQUALS,
+                      oil.intervals[0].compare(covering.intervals[0]));
+        ASSERT_EQUALS(Interval::INTERVAL_EQUALS,
+                      oil.intervals[1].compare(covering.intervals[1]));
+
+        // The same geometry for another index is another covering
+        BSONObj otherKey =
+            GeoCoveringCache::makeKey(fromjson("{a: {$geoWithin: {$box: [[0, 0], [1, 1]]}}}"),
+                                      fromjson("{key: {a: '2d'}, name: 'a_2d', bits: 20}"),
+                                      16);
+        OrderedIntervalList otherOil;
+        ASSERT_FALSE(GeoCoveringCache::get(otherKey, &otherOil));
+        GeoCoveringCache::clear();
+    }
+
+    TEST(GeoCoveringCacheTest, EvictsLeastRecentlyUsed) {
+        GeoCoveringCache::clear();
+        const int oldSize = internalGeoCoveringCacheSize;
+        internalGeoCoveringCacheSize = 2;
+
+        OrderedIntervalList covering;
+        covering.intervals.push_back(IndexBoundsBuilder::makePointInterval(BSON("" << 1)));
+        BSONObj index = fromjson("{key: {a: '2dsphere'}, name: 'a_2dsphere'}");
+        BSONObj key1 = GeoCoveringCache::makeKey(BSON("a" << 1), index, 16);
+        BSONObj key2 = GeoCoveringCache::makeKey(BSON("a" << 2), index, 16);
+        BSONObj key3 = GeoCoveringCache::makeKey(BSON("a" << 3), index, 16);
+
+        OrderedIntervalList oil;
+        GeoCoveringCache::add(key1, covering);
+        GeoCoveringCache::add(key2, covering);
+        ASSERT_TRUE(GeoCoveringCache::get(key1, &oil));
+        GeoCoveringCache::add(key3, covering);
+        ASSERT_TRUE(GeoCoveringCache::get(key1, &oil));
+        ASSERT_FALSE(GeoCoveringCache::get(key2, &oil));
+        ASSERT_TRUE(GeoCoveringCache::get(key3, &oil));
+
+        internalGeoCoveringCacheSize = 0;
+        GeoCoveringCache::clear();
+        GeoCoveringCache::add(key1, covering);
+        ASSERT_FALSE(GeoCoveringCache::get(key1, &oil));
+
+        internalGeoCoveringCacheSize = oldSize;
+    }
+
 }  // namespace
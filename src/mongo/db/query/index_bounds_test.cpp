@@ -249,6 +249,48 @@ namespace {
             Interval(maxObj, true, true)));
     }
 
+    //
+    // Equality
+    //
+
+    TEST(IndexBoundsTest, EqualsSameIntervals) {
+        IndexBounds a;
+        a.fields.push_back(OrderedIntervalList("a"));
+        a.fields[0].intervals.push_back(Interval(BSON("" << 1 << "" << 5), true, false));
+        a.fields[0].intervals.push_back(Interval(BSON("" << 7 << "" << 7), true, true));
+
+        IndexBounds b;
+        b.fields.push_back(OrderedIntervalList("b"));
+        b.fields[0].intervals.push_back(Interval(BSON("" << 1 << "" << 5), true, false));
+        b.fields[0].intervals.push_back(Interval(BSON("" << 7 << "" << 7), true, true));
+        ASSERT(a.equals(b));
+
+        b.fields[0].intervals[0].endInclusive = true;
+        ASSERT_FALSE(a.equals(b));
+
+        b.fields[0].intervals.pop_back();
+        ASSERT_FALSE(a.equals(b));
+    }
+
+    TEST(IndexBoundsTest, EqualsSimpleRange) {
+        IndexBounds a;
+        a.isSimpleRange = true;
+        a.startKey = BSON("" << 1);
+        a.endKey = BSON("" << 10);
+        a.endKeyInclusive = true;
+
+        IndexBounds b = a;
+        ASSERT(a.equals(b));
+
+        b.endKeyInclusive = false;
+        ASSERT_FALSE(a.equals(b));
+
+        IndexBounds c;
+        c.fields.push_back(OrderedIntervalList("a"));
+        c.fields[0].intervals.push_back(Interval(BSON("" << 1 << "" << 10), true, true));
+        ASSERT_FALSE(a.equals(c));
+    }
+
     //
     // Iteration over
     //
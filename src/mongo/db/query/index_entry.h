@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "mongo/db/index_names.h"
@@ -36,6 +37,7 @@
 
 namespace mongo {
 
+    class IndexStats;
     class MatchExpression;
 
     /**
@@ -119,6 +121,10 @@ namespace mongo {
         // by the keyPattern?)
         IndexType type;
 
+        // Key statistics gathered by the 'analyze' command, or NULL if it has not been run on
+        // this index. Used to estimate the cost of candidate plans.
+        std::shared_ptr<const IndexStats> stats;
+
         std::string toString() const;
     };
 
@@ -0,0 +1,263 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_stats.h"
+
+#include <algorithm>
+
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/query/interval.h"
+
+namespace mongo {
+
+    namespace {
+
+        BSONObj ownedValue(const BSONElement& elt) {
+            BSONObjBuilder bob;
+            bob.appendAs(elt, "");
+            return bob.obj();
+        }
+
+        int compareValues(const BSONElement& a, const BSONElement& b) {
+            // false means ignore field names.
+            return a.woCompare(b, false);
+        }
+
+    }  // namespace
+
+    //
+    // IndexStats::Builder
+    //
+
+    IndexStats::Builder::Builder(size_t maxBuckets)
+        : _maxBuckets(std::max(maxBuckets, size_t(1))),
+          _depth(1),
+          _numKeys(0),
+          _numDistinct(0) { }
+
+    void IndexStats::Builder::addKey(const BSONObj& key) {
+        BSONElement value = key.firstElement();
+        ++_numKeys;
+
+        if (_open.count > 0 && 0 == compareValues(_open.upper.firstElement(), value)) {
+            ++_open.count;
+            ++_open.upperCount;
+            return;
+        }
+
+        // A new distinct value. Values never span buckets, so this is where a full bucket ends.
+        if (_open.count >= _depth) {
+            closeBucket();
+        }
+
+        ++_numDistinct;
+        _open.upper = ownedValue(value);
+        _open.upperCount = 1;
+        ++_open.count;
+        ++_open.distinct;
+
+        if (_lowest.isEmpty()) {
+            _lowest = _open.upper;
+        }
+    }
+
+    void IndexStats::Builder::closeBucket() {
+        _buckets.push_back(_open);
+        _open = Bucket();
+
+        if (_buckets.size() < 2 * _maxBuckets) {
+            return;
+        }
+
+        // Merge neighbouring buckets until they reach the new depth. A bucket bounded by a value
+        // which alone fills it is not merged into the next one, so that the count of that value
+        // stays exact.
+        const long long depth = _depth * 2;
+        std::vector<Bucket> merged;
+        merged.reserve(_maxBuckets);
+        for (size_t i = 0; i < _buckets.size(); ++i) {
+            const Bucket& b = _buckets[i];
+            if (merged.empty() || merged.back().count >= depth) {
+                merged.push_back(b);
+                continue;
+            }
+
+            Bucket& last = merged.back();
+            last.upper = b.upper;
+            last.count += b.count;
+            last.upperCount = b.upperCount;
+            last.distinct += b.distinct;
+        }
+        _buckets.swap(merged);
+        _depth = depth;
+    }
+
+    IndexStats* IndexStats::Builder::done(const BSONObj& keyPattern) {
+        if (_open.count > 0) {
+            _buckets.push_back(_open);
+            _open = Bucket();
+        }
+
+        IndexStats* stats = new IndexStats();
+        stats->_keyPattern = keyPattern.getOwned();
+        stats->_numKeys = _numKeys;
+        stats->_numDistinct = _numDistinct;
+        stats->_lowest = _lowest;
+        stats->_buckets.swap(_buckets);
+        return stats;
+    }
+
+    //
+    // IndexStats
+    //
+
+    double IndexStats::estimateKeys(const OrderedIntervalList& oil) const {
+        double keys = 0;
+        for (size_t i = 0; i < oil.intervals.size(); ++i) {
+            keys += estimateKeys(oil.intervals[i]);
+        }
+        return std::min(keys, static_cast<double>(_numKeys));
+    }
+
+    double IndexStats::estimateFraction(const OrderedIntervalList& oil) const {
+        if (0 == _numKeys) {
+            return 0;
+        }
+        return estimateKeys(oil) / _numKeys;
+    }
+
+    double IndexStats::estimateKeys(const Interval& interval) const {
+        if (_buckets.empty()) {
+            return 0;
+        }
+
+        // Intervals over a descending field run from high to low.
+        BSONElement lo = interval.start;
+        bool loInclusive = interval.startInclusive;
+        BSONElement hi = interval.end;
+        bool hiInclusive = interval.endInclusive;
+        if (compareValues(lo, hi) > 0) {
+            std::swap(lo, hi);
+            std::swap(loInclusive, hiInclusive);
+        }
+
+        const int loHi = compareValues(lo, hi);
+        if (0 == loHi) {
+            return (loInclusive && hiInclusive) ? estimateEquality(lo) : 0;
+        }
+
+        double keys = 0;
+        BSONElement prev = _lowest.firstElement();
+        for (size_t i = 0; i < _buckets.size(); ++i) {
+            const Bucket& bucket = _buckets[i];
+            BSONElement upper = bucket.upper.firstElement();
+
+            const int loUpper = compareValues(lo, upper);
+            const int hiUpper = compareValues(hi, upper);
+
+            // The bound itself is counted exactly.
+            if ((loUpper < 0 || (0 == loUpper && loInclusive)) &&
+                (hiUpper > 0 || (0 == hiUpper && hiInclusive))) {
+                keys += bucket.upperCount;
+            }
+
+            // The values below the bound are assumed to be spread evenly, and a partly covered
+            // bucket contributes half of them. In the first bucket they start at the lowest
+            // value, which is included.
+            const long long interior = bucket.count - bucket.upperCount;
+            if (interior > 0) {
+                const int loPrev = compareValues(lo, prev);
+                const int hiPrev = compareValues(hi, prev);
+                const bool coversLow = (0 == i) ? (loPrev < 0 || (0 == loPrev && loInclusive))
+                                                : loPrev <= 0;
+                const bool overlaps = loUpper < 0 && ((0 == i) ? hiPrev >= 0 : hiPrev > 0);
+
+                if (coversLow && hiUpper >= 0) {
+                    keys += interior;
+                }
+                else if (overlaps) {
+                    keys += interior / 2.0;
+                }
+            }
+
+            if (hiUpper <= 0) {
+                break;
+            }
+            prev = upper;
+        }
+
+        return keys;
+    }
+
+    double IndexStats::estimateEquality(const BSONElement& value) const {
+        if (compareValues(value, _lowest.firstElement()) < 0) {
+            return 0;
+        }
+
+        for (size_t i = 0; i < _buckets.size(); ++i) {
+            const Bucket& bucket = _buckets[i];
+            const int cmp = compareValues(value, bucket.upper.firstElement());
+            if (0 == cmp) {
+                return bucket.upperCount;
+            }
+            if (cmp < 0) {
+                const long long interiorDistinct = std::max(bucket.distinct - 1, 1LL);
+                return static_cast<double>(bucket.count - bucket.upperCount) / interiorDistinct;
+            }
+        }
+
+        // Above the highest value seen.
+        return 0;
+    }
+
+    BSONObj IndexStats::toBSON(bool includeBuckets) const {
+        BSONObjBuilder bob;
+        bob.append("keyPattern", _keyPattern);
+        bob.appendNumber("numKeys", _numKeys);
+        bob.appendNumber("distinct", _numDistinct);
+        if (!includeBuckets) {
+            bob.appendNumber("buckets", static_cast<long long>(_buckets.size()));
+            return bob.obj();
+        }
+
+        BSONArrayBuilder buckets(bob.subarrayStart("buckets"));
+        for (size_t i = 0; i < _buckets.size(); ++i) {
+            BSONObjBuilder bucket(buckets.subobjStart());
+            bucket.appendAs(_buckets[i].upper.firstElement(), "upper");
+            bucket.appendNumber("count", _buckets[i].count);
+            bucket.appendNumber("upperCount", _buckets[i].upperCount);
+            bucket.appendNumber("distinct", _buckets[i].distinct);
+            bucket.doneFast();
+        }
+        buckets.doneFast();
+        return bob.obj();
+    }
+
+}  // namespace mongo
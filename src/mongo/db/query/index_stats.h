@@ -0,0 +1,141 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    struct Interval;
+    struct OrderedIntervalList;
+
+    /**
+     * Statistics about the keys of one index, as gathered by the 'analyze' command: the number of
+     * keys, the number of distinct values of the leading key field, and an equi-depth histogram of
+     * the leading key field.
+     *
+     * Each bucket covers the values above the previous bucket's upper bound (or, for the first
+     * bucket, from the lowest value seen) up to and including its own upper bound. A value never
+     * spans buckets, so the count of keys equal to an upper bound is exact.
+     *
+     * Instances are immutable once built and are shared between the CollectionInfoCache which
+     * owns them and the IndexEntry objects handed to the planner.
+     */
+    class IndexStats {
+    public:
+        struct Bucket {
+            Bucket() : count(0), upperCount(0), distinct(0) { }
+
+            // A single-element object holding the largest leading value in the bucket.
+            BSONObj upper;
+
+            // Keys in the bucket, including those equal to 'upper'.
+            long long count;
+
+            // Keys whose leading value equals 'upper'.
+            long long upperCount;
+
+            // Distinct leading values in the bucket, including 'upper'.
+            long long distinct;
+        };
+
+        /**
+         * Builds IndexStats from keys in ascending order of their leading field. The histogram
+         * is built in one pass: when there are twice 'maxBuckets' buckets, the target depth of
+         * buckets doubles and neighbouring buckets are merged to reach it.
+         */
+        class Builder {
+        public:
+            explicit Builder(size_t maxBuckets);
+
+            void addKey(const BSONObj& key);
+
+            /**
+             * Returns the statistics for an index with key pattern 'keyPattern'. The builder
+             * must not be used afterwards.
+             */
+            IndexStats* done(const BSONObj& keyPattern);
+
+        private:
+            void closeBucket();
+
+            const size_t _maxBuckets;
+            long long _depth;
+
+            long long _numKeys;
+            long long _numDistinct;
+            BSONObj _lowest;
+
+            std::vector<Bucket> _buckets;
+
+            // The bucket receiving keys. Its 'upper' is the current leading value.
+            Bucket _open;
+        };
+
+        const BSONObj& getKeyPattern() const { return _keyPattern; }
+
+        long long getNumKeys() const { return _numKeys; }
+
+        long long getNumDistinct() const { return _numDistinct; }
+
+        const std::vector<Bucket>& getBuckets() const { return _buckets; }
+
+        /**
+         * Estimates the number of keys whose leading field falls within 'oil', the bounds on
+         * the leading field of an index scan.
+         */
+        double estimateKeys(const OrderedIntervalList& oil) const;
+
+        /**
+         * Estimates the fraction of the index's keys whose leading field falls within 'oil'.
+         */
+        double estimateFraction(const OrderedIntervalList& oil) const;
+
+        /**
+         * If 'includeBuckets' is false, the histogram is summarized by its number of buckets.
+         */
+        BSONObj toBSON(bool includeBuckets) const;
+
+    private:
+        IndexStats() : _numKeys(0), _numDistinct(0) { }
+
+        double estimateKeys(const Interval& interval) const;
+
+        double estimateEquality(const BSONElement& value) const;
+
+        BSONObj _keyPattern;
+        long long _numKeys;
+        long long _numDistinct;
+        BSONObj _lowest;
+        std::vector<Bucket> _buckets;
+    };
+
+}  // namespace mongo
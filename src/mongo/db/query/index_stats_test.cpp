@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/index_stats.h
+ */
+
+#include "mongo/db/query/index_stats.h"
+
+#include <memory>
+
+#include "mongo/db/json.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    /**
+     * Stats for an index on {a: 1} holding 'keysPerValue' keys for each of the values
+     * 0 .. 'numValues' - 1.
+     */
+    std::unique_ptr<IndexStats> uniformStats(int numValues, int keysPerValue, size_t buckets) {
+        IndexStats::Builder builder(buckets);
+        for (int i = 0; i < numValues; ++i) {
+            for (int j = 0; j < keysPerValue; ++j) {
+                builder.addKey(BSON("" << i));
+            }
+        }
+        return std::unique_ptr<IndexStats>(builder.done(BSON("a" << 1)));
+    }
+
+    OrderedIntervalList makeOil(const BSONObj& bounds, bool startInclusive, bool endInclusive) {
+        OrderedIntervalList oil("a");
+        oil.intervals.push_back(Interval(bounds, startInclusive, endInclusive));
+        return oil;
+    }
+
+    TEST(IndexStatsTest, EmptyIndex) {
+        std::unique_ptr<IndexStats> stats = uniformStats(0, 0, 10);
+        ASSERT_EQUALS(stats->getNumKeys(), 0);
+        ASSERT_EQUALS(stats->getNumDistinct(), 0);
+        ASSERT(stats->getBuckets().empty());
+        ASSERT_EQUALS(stats->estimateKeys(makeOil(BSON("" << 0 << "" << 10), true, true)), 0);
+        ASSERT_EQUALS(stats->estimateFraction(makeOil(BSON("" << 0 << "" << 0), true, true)), 0);
+    }
+
+    TEST(IndexStatsTest, CountsKeysAndDistinctValues) {
+        std::unique_ptr<IndexStats> stats = uniformStats(1000, 3, 10);
+        ASSERT_EQUALS(stats->getNumKeys(), 3000);
+        ASSERT_EQUALS(stats->getNumDistinct(), 1000);
+
+        const std::vector<IndexStats::Bucket>& buckets = stats->getBuckets();
+        ASSERT_LESS_THAN_OR_EQUALS(buckets.size(), 20U);
+        long long keys = 0;
+        long long distinct = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            keys += buckets[i].count;
+            distinct += buckets[i].distinct;
+            ASSERT_EQUALS(buckets[i].upperCount, 3);
+        }
+        ASSERT_EQUALS(keys, 3000);
+        ASSERT_EQUALS(distinct, 1000);
+        ASSERT_EQUALS(buckets.back().upper.firstElement().numberInt(), 999);
+    }
+
+    TEST(IndexStatsTest, EqualityEstimates) {
+        std::unique_ptr<IndexStats> stats = uniformStats(1000, 3, 10);
+
+        // An upper bound, which is exact, and a value inside a bucket.
+        int bound = stats->getBuckets()[0].upper.firstElement().numberInt();
+        ASSERT_EQUALS(stats->estimateKeys(makeOil(BSON("" << bound << "" << bound), true, true)),
+                      3);
+        ASSERT_APPROX_EQUAL(stats->estimateKeys(makeOil(BSON("" << 1 << "" << 1), true, true)),
+                            3, 0.01);
+
+        // Values which are not there.
+        ASSERT_EQUALS(stats->estimateKeys(makeOil(BSON("" << -1 << "" << -1), true, true)), 0);
+        ASSERT_EQUALS(stats->estimateKeys(makeOil(BSON("" << 1000 << "" << 1000), true, true)),
+                      0);
+        ASSERT_EQUALS(stats->estimateKeys(makeOil(BSON("" << 1 << "" << 1), true, false)), 0);
+    }
+
+    TEST(IndexStatsTest, RangeEstimates) {
+        std::unique_ptr<IndexStats> stats = uniformStats(1000, 1, 100);
+
+        ASSERT_APPROX_EQUAL(
+            stats->estimateFraction(makeOil(BSON("" << MINKEY << "" << MAXKEY), true, true)),
+            1.0, 0.001);
+        ASSERT_APPROX_EQUAL(
+            stats->estimateFraction(makeOil(BSON("" << 0 << "" << 500), true, false)),
+            0.5, 0.05);
+        ASSERT_APPROX_EQUAL(
+            stats->estimateFraction(makeOil(BSON("" << 900 << "" << 2000), false, true)),
+            0.1, 0.05);
+        ASSERT_EQUALS(
+            stats->estimateFraction(makeOil(BSON("" << 2000 << "" << 3000), true, true)),
+            0);
+
+        // Bounds of a descending index run from high to low.
+        ASSERT_APPROX_EQUAL(
+            stats->estimateFraction(makeOil(BSON("" << 500 << "" << 0), false, true)),
+            0.5, 0.05);
+    }
+
+    TEST(IndexStatsTest, FrequentValueIsCountedExactly) {
+        IndexStats::Builder builder(4);
+        for (int i = 0; i < 100; ++i) {
+            builder.addKey(BSON("" << i));
+        }
+        for (int i = 0; i < 500; ++i) {
+            builder.addKey(BSON("" << 100));
+        }
+        for (int i = 101; i < 200; ++i) {
+            builder.addKey(BSON("" << i));
+        }
+        std::unique_ptr<IndexStats> stats(builder.done(BSON("a" << 1)));
+
+        ASSERT_EQUALS(stats->getNumKeys(), 699);
+        ASSERT_EQUALS(stats->getNumDistinct(), 200);
+        ASSERT_EQUALS(stats->estimateKeys(makeOil(BSON("" << 100 << "" << 100), true, true)),
+                      500);
+    }
+
+    TEST(IndexStatsTest, ToBSON) {
+        std::unique_ptr<IndexStats> stats = uniformStats(10, 2, 100);
+        BSONObj summary = stats->toBSON(false);
+        ASSERT_EQUALS(summary["keyPattern"].Obj(), BSON("a" << 1));
+        ASSERT_EQUALS(summary["numKeys"].numberLong(), 20);
+        ASSERT_EQUALS(summary["distinct"].numberLong(), 10);
+        ASSERT_EQUALS(summary["buckets"].numberLong(), 10);
+
+        BSONObj full = stats->toBSON(true);
+        std::vector<BSONElement> buckets = full["buckets"].Array();
+        ASSERT_EQUALS(buckets.size(), 10U);
+        ASSERT_EQUALS(buckets[0].Obj(), fromjson("{upper: 0, count: 2, upperCount: 2, "
+                                                 "distinct: 1}"));
+    }
+
+}  // namespace
@@ -30,6 +30,8 @@
 
 #include "mongo/db/query/lite_parsed_query.h"
 
+#include <algorithm>
+
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
 #include "mongo/client/dbclientinterface.h"
@@ -81,6 +83,7 @@ namespace {
     const char kSingleBatchField[] = "singleBatch";
     const char kCommentField[] = "comment";
     const char kMaxScanField[] = "maxScan";
+    const char kParallelismField[] = "parallelism";
     const char kMaxField[] = "max";
     const char kMinField[] = "min";
     const char kReturnKeyField[] = "returnKey";
@@ -91,6 +94,7 @@ namespace {
     const char kNoCursorTimeoutField[] = "noCursorTimeout";
     const char kAwaitDataField[] = "awaitData";
     const char kPartialField[] = "partial";
+    const char kPrefetchNextBatchField[] = "prefetchNextBatch";
 
 } // namespace
 
@@ -236,6 +240,21 @@ namespace {
 
                 pq->_maxScan = maxScan;
             }
+            else if (str::equals(fieldName, kParallelismField)) {
+                if (!el.isNumber()) {
+                    str::stream ss;
+                    ss << "Failed to parse: " << cmdObj.toString() << ". "
+                       << "'parallelism' field must be numeric.";
+                    return Status(ErrorCodes::FailedToParse, ss);
+                }
+
+                int parallelism = el.numberInt();
+                if (parallelism < 0) {
+                    return Status(ErrorCodes::BadValue, "parallelism value must be non-negative");
+                }
+
+                pq->_parallelism = parallelism;
+            }
             else if (str::equals(fieldName, cmdOptionMaxTimeMS.c_str())) {
                 StatusWith<int> maxTimeMS = parseMaxTimeMS(el);
                 if (!maxTimeMS.isOK()) {
@@ -335,6 +354,14 @@ namespace {
 
                 pq->_partial = el.boolean();
             }
+            else if (str::equals(fieldName, kPrefetchNextBatchField)) {
+                Status status = checkFieldType(el, Bool);
+                if (!status.isOK()) {
+                    return status;
+                }
+
+                pq->_prefetchNextBatch = el.boolean();
+            }
             else if (str::equals(fieldName, "options")) {
                 // 3.0.x versions of the shell may generate an explain of a find command with an
                 // 'options' field. We accept this only if the 'options' field is empty so that
@@ -484,6 +511,10 @@ namespace {
             bob.append(kMaxScanField, _maxScan);
         }
 
+        if (_parallelism > 0) {
+            bob.append(kParallelismField, _parallelism);
+        }
+
         if (_maxTimeMS > 0) {
             bob.append(cmdOptionMaxTimeMS, _maxTimeMS);
         }
@@ -528,6 +559,10 @@ namespace {
             bob.append(kPartialField, true);
         }
 
+        if (_prefetchNextBatch) {
+            bob.append(kPrefetchNextBatchField, true);
+        }
+
         return bob.obj();
     }
 
@@ -896,6 +931,10 @@ namespace {
                     // Won't throw.
                     _maxScan = e.numberInt();
                 }
+                else if (str::equals("parallelism", name)) {
+                    // Won't throw.
+                    _parallelism = std::max(0, e.numberInt());
+                }
                 else if (str::equals("showDiskLoc", name)) {
                     // Won't throw.
                     if (e.trueValue()) {
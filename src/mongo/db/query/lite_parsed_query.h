@@ -152,6 +152,7 @@ namespace mongo {
         const std::string& getComment() const { return _comment; }
 
         int getMaxScan() const { return _maxScan; }
+        int getParallelism() const { return _parallelism; }
         int getMaxTimeMS() const { return _maxTimeMS; }
 
         const BSONObj& getMin() const { return _min; }
@@ -169,6 +170,7 @@ namespace mongo {
         bool isAwaitData() const { return _awaitData; }
         bool isExhaust() const { return _exhaust; }
         bool isPartial() const { return _partial; }
+        bool isPrefetchNextBatch() const { return _prefetchNextBatch; }
 
         /**
          * Return options as a bit vector.
@@ -241,6 +243,7 @@ namespace mongo {
         std::string _comment;
 
         int _maxScan = 0;
+        int _parallelism = 0;
         int _maxTimeMS = 0;
 
         BSONObj _min;
@@ -259,6 +262,9 @@ namespace mongo {
         bool _awaitData = false;
         bool _exhaust = false;
         bool _partial = false;
+
+        // Build each following batch of the cursor in the background. Find command only.
+        bool _prefetchNextBatch = false;
     };
 
 } // namespace mongo
@@ -343,7 +343,8 @@ namespace {
                                    "sort: {a: 1},"
                                    "projection: {_id: 0, a: 1},"
                                    "showRecordId: true,"
-                                   "maxScan: 1000}}");
+                                   "maxScan: 1000,"
+                                   "parallelism: 4}}");
         bool isExplain = false;
         unique_ptr<LiteParsedQuery> lpq(
             assertGet(LiteParsedQuery::fromFindCommand("testns", cmdObj, isExplain)));
@@ -351,6 +352,7 @@ namespace {
         // Make sure the values from the command BSON are reflected in the LPQ.
         ASSERT(lpq->showRecordId());
         ASSERT_EQUALS(1000, lpq->getMaxScan());
+        ASSERT_EQUALS(4, lpq->getParallelism());
     }
 
     TEST(LiteParsedQueryTest, ParseFromCommandHintAsString) {
@@ -518,6 +520,32 @@ namespace {
         ASSERT_NOT_OK(LiteParsedQuery::fromFindCommand("testns", cmdObj, isExplain).getStatus());
     }
 
+    TEST(LiteParsedQueryTest, ParseFromCommandParallelismNegative) {
+        BSONObj cmdObj = fromjson("{find: 'testns',"
+                                   "filter:  {a: 1},"
+                                   "parallelism: -1}");
+        bool isExplain = false;
+        ASSERT_NOT_OK(LiteParsedQuery::fromFindCommand("testns", cmdObj, isExplain).getStatus());
+    }
+
+    TEST(LiteParsedQueryTest, ParseFromCommandPrefetchNextBatch) {
+        BSONObj cmdObj = fromjson("{find: 'testns',"
+                                   "filter:  {a: 1},"
+                                   "prefetchNextBatch: true}");
+        bool isExplain = false;
+        unique_ptr<LiteParsedQuery> lpq(
+            assertGet(LiteParsedQuery::fromFindCommand("testns", cmdObj, isExplain)));
+        ASSERT(lpq->isPrefetchNextBatch());
+    }
+
+    TEST(LiteParsedQueryTest, ParseFromCommandPrefetchNextBatchWrongType) {
+        BSONObj cmdObj = fromjson("{find: 'testns',"
+                                   "filter:  {a: 1},"
+                                   "prefetchNextBatch: 1}");
+        bool isExplain = false;
+        ASSERT_NOT_OK(LiteParsedQuery::fromFindCommand("testns", cmdObj, isExplain).getStatus());
+    }
+
     TEST(LiteParsedQueryTest, ParseFromCommandMaxTimeMSWrongType) {
         BSONObj cmdObj = fromjson("{find: 'testns',"
                                    "filter:  {a: 1},"
@@ -43,6 +43,7 @@
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -50,6 +51,19 @@
 namespace mongo {
 namespace {
 
+    MemoryAccount planCacheMemory("planCache");
+
+    size_t estimateStatsSizeInBytes(const PlanStageStats* stats) {
+        if (!stats) {
+            return 0;
+        }
+        size_t size = sizeof(PlanStageStats);
+        for (size_t i = 0; i < stats->children.size(); ++i) {
+            size += estimateStatsSizeInBytes(stats->children[i]);
+        }
+        return size;
+    }
+
     // Delimiters for cache key encoding.
     const char kEncodeDiscriminatorsBegin = '<';
     const char kEncodeDiscriminatorsEnd = '>';
@@ -269,7 +283,8 @@ namespace {
     PlanCacheEntry::PlanCacheEntry(const std::vector<QuerySolution*>& solutions,
                                    PlanRankingDecision* why)
         : plannerData(solutions.size()),
-          decision(why) {
+          decision(why),
+          memoryCharge(&planCacheMemory) {
         invariant(why);
 
         // The caller of this constructor is responsible for ensuring
@@ -292,6 +307,21 @@ namespace {
         }
     }
 
+    size_t PlanCacheEntry::estimateObjectSizeInBytes() const {
+        size_t size = sizeof(PlanCacheEntry) + query.objsize() + sort.objsize() +
+            projection.objsize();
+        size += plannerData.size() * (sizeof(SolutionCacheData*) + sizeof(SolutionCacheData));
+        size += sizeof(PlanRankingDecision);
+        for (size_t i = 0; i < decision->stats.size(); ++i) {
+            size += estimateStatsSizeInBytes(decision->stats.vector()[i]);
+        }
+        for (size_t i = 0; i < feedback.size(); ++i) {
+            size += sizeof(PlanCacheEntryFeedback) + estimateStatsSizeInBytes(
+                feedback[i]->stats.get());
+        }
+        return size;
+    }
+
     PlanCacheEntry* PlanCacheEntry::clone() const {
         OwnedPointerVector<QuerySolution> solutions;
         for (size_t i = 0; i < plannerData.size(); ++i) {
@@ -401,6 +431,12 @@ namespace {
                 << ")";
         case COLLSCAN_SOLN:
             return "(collection scan)";
+        case SKIP_SCAN_SOLN:
+            verify(this->tree.get());
+            return str::stream()
+                << "(skip scan solution: "
+                << "tree=" << this->tree->toString()
+                << ")";
         case USE_INDEX_TAGS_SOLN:
             verify(this->tree.get());
             return str::stream()
@@ -415,9 +451,17 @@ namespace {
     // PlanCache
     //
 
-    PlanCache::PlanCache() : _cache(internalQueryCacheSize) { }
+    PlanCache::PlanCache() : PlanCache("") { }
 
-    PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize), _ns(ns) { }
+    PlanCache::PlanCache(const std::string& ns) : _ns(ns) {
+        // The shards share the configured capacity between them.
+        const size_t numShards = std::max(1, internalQueryCacheShards);
+        const size_t shardSize =
+            std::max(size_t(1), (size_t(internalQueryCacheSize) + numShards - 1) / numShards);
+        for (size_t i = 0; i < numShards; ++i) {
+            _shards.push_back(stdx::make_unique<Shard>(shardSize));
+        }
+    }
 
     PlanCache::~PlanCache() { }
 
@@ -581,10 +625,20 @@ namespace {
         entry->sort = pq.getSort().getOwned();
         entry->projection = pq.getProj().getOwned();
 
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
-        std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+        size_t hash;
+        const PlanCacheKey& key = getKey(query, &hash);
+        Shard& shard = getShard(hash);
+        // The LRU cache holds the key in both its list and its index
+        entry->memoryCharge.set(entry->estimateObjectSizeInBytes() + 2 * key.size());
+
+        std::unique_ptr<PlanCacheEntry> evictedEntry;
+        {
+            boost::lock_guard<boost::mutex> cacheLock(shard.mutex);
+            evictedEntry = shard.cache.add(key, entry);
+        }
 
         if (NULL != evictedEntry.get()) {
+            _evictions.fetchAndAdd(1);
             LOG(1) << _ns << ": plan cache maximum size exceeded - "
                    << "removed least recently used entry "
                    << evictedEntry->toString();
@@ -594,16 +648,20 @@ namespace {
     }
 
     Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const {
-        PlanCacheKey key = computeKey(query);
+        size_t hash;
+        const PlanCacheKey& key = getKey(query, &hash);
         verify(crOut);
 
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Shard& shard = getShard(hash);
+        boost::lock_guard<boost::mutex> cacheLock(shard.mutex);
         PlanCacheEntry* entry;
-        Status cacheStatus = _cache.get(key, &entry);
+        Status cacheStatus = shard.cache.get(key, &entry);
         if (!cacheStatus.isOK()) {
+            _misses.fetchAndAdd(1);
             return cacheStatus;
         }
         invariant(entry);
+        _hits.fetchAndAdd(1);
 
         *crOut = new CachedSolution(key, *entry);
 
@@ -615,11 +673,13 @@ namespace {
             return Status(ErrorCodes::BadValue, "feedback is NULL");
         }
         std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
-        PlanCacheKey ck = computeKey(cq);
+        size_t hash;
+        const PlanCacheKey& ck = getKey(cq, &hash);
 
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Shard& shard = getShard(hash);
+        boost::lock_guard<boost::mutex> cacheLock(shard.mutex);
         PlanCacheEntry* entry;
-        Status cacheStatus = _cache.get(ck, &entry);
+        Status cacheStatus = shard.cache.get(ck, &entry);
         if (!cacheStatus.isOK()) {
             return cacheStatus;
         }
@@ -628,37 +688,61 @@ namespace {
         // We store up to a constant number of feedback entries.
         if (entry->feedback.size() < size_t(internalQueryCacheFeedbacksStored)) {
             entry->feedback.push_back(autoFeedback.release());
+            entry->memoryCharge.add(sizeof(PlanCacheEntryFeedback) +
+                                    estimateStatsSizeInBytes(feedback->stats.get()));
         }
 
         return Status::OK();
     }
 
     Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
-        return _cache.remove(computeKey(canonicalQuery));
+        size_t hash;
+        const PlanCacheKey& key = getKey(canonicalQuery, &hash);
+
+        Shard& shard = getShard(hash);
+        boost::lock_guard<boost::mutex> cacheLock(shard.mutex);
+        return shard.cache.remove(key);
     }
 
     void PlanCache::clear() {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
-        _cache.clear();
+        for (size_t i = 0; i < _shards.size(); ++i) {
+            boost::lock_guard<boost::mutex> cacheLock(_shards[i]->mutex);
+            _shards[i]->cache.clear();
+        }
         _writeOperations.store(0);
     }
 
     PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
+        size_t hash;
+        return getKey(cq, &hash);
+    }
+
+    const PlanCacheKey& PlanCache::getKey(const CanonicalQuery& cq, size_t* hashOut) const {
+        const unsigned long long generation = _keyGeneration.load();
+        if (const PlanCacheKey* key = cq.getMemoizedPlanCacheKey(this, generation, hashOut)) {
+            return *key;
+        }
+
         StringBuilder keyBuilder;
         encodeKeyForMatch(cq.root(), &keyBuilder);
         encodeKeyForSort(cq.getParsed().getSort(), &keyBuilder);
         encodeKeyForProj(cq.getParsed().getProj(), &keyBuilder);
-        return keyBuilder.str();
+        const PlanCacheKey key = keyBuilder.str();
+
+        *hashOut = StringData::Hasher()(key);
+        cq.memoizePlanCacheKey(this, generation, key, *hashOut);
+        return *cq.getMemoizedPlanCacheKey(this, generation, hashOut);
     }
 
     Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOut) const {
-        PlanCacheKey key = computeKey(query);
+        size_t hash;
+        const PlanCacheKey& key = getKey(query, &hash);
         verify(entryOut);
 
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Shard& shard = getShard(hash);
+        boost::lock_guard<boost::mutex> cacheLock(shard.mutex);
         PlanCacheEntry* entry;
-        Status cacheStatus = _cache.get(key, &entry);
+        Status cacheStatus = shard.cache.get(key, &entry);
         if (!cacheStatus.isOK()) {
             return cacheStatus;
         }
@@ -670,25 +754,36 @@ namespace {
     }
 
     std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
         std::vector<PlanCacheEntry*> entries;
         typedef std::list< std::pair<PlanCacheKey, PlanCacheEntry*> >::const_iterator ConstIterator;
-        for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-            PlanCacheEntry* entry = i->second;
-            entries.push_back(entry->clone());
+        for (size_t s = 0; s < _shards.size(); ++s) {
+            boost::lock_guard<boost::mutex> cacheLock(_shards[s]->mutex);
+            const LRUKeyValue<PlanCacheKey, PlanCacheEntry>& cache = _shards[s]->cache;
+            for (ConstIterator i = cache.begin(); i != cache.end(); i++) {
+                PlanCacheEntry* entry = i->second;
+                entries.push_back(entry->clone());
+            }
         }
 
         return entries;
     }
 
     bool PlanCache::contains(const CanonicalQuery& cq) const {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
-        return _cache.hasKey(computeKey(cq));
+        size_t hash;
+        const PlanCacheKey& key = getKey(cq, &hash);
+
+        Shard& shard = getShard(hash);
+        boost::lock_guard<boost::mutex> cacheLock(shard.mutex);
+        return shard.cache.hasKey(key);
     }
 
     size_t PlanCache::size() const {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
-        return _cache.size();
+        size_t total = 0;
+        for (size_t i = 0; i < _shards.size(); ++i) {
+            boost::lock_guard<boost::mutex> cacheLock(_shards[i]->mutex);
+            total += _shards[i]->cache.size();
+        }
+        return total;
     }
 
     void PlanCache::notifyOfWriteOp() {
@@ -706,6 +801,19 @@ namespace {
 
     void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
         _indexabilityState.updateDiscriminators(indexEntries);
+        _keyGeneration.fetchAndAdd(1);
+    }
+
+    void PlanCache::notifyOfReplan() {
+        _replans.fetchAndAdd(1);
+    }
+
+    void PlanCache::appendStats(BSONObjBuilder* bob) const {
+        bob->appendNumber("entries", static_cast<long long>(size()));
+        bob->appendNumber("hits", static_cast<long long>(_hits.load()));
+        bob->appendNumber("misses", static_cast<long long>(_misses.load()));
+        bob->appendNumber("evictions", static_cast<long long>(_evictions.load()));
+        bob->appendNumber("replans", static_cast<long long>(_replans.load()));
     }
 
 }  // namespace mongo
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <set>
+#include <vector>
 #include <boost/optional/optional.hpp>
 #include <boost/thread/mutex.hpp>
 
@@ -39,6 +40,7 @@
 #include "mongo/db/query/plan_cache_indexability.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/util/memory_accounting.h"
 
 namespace mongo {
 
@@ -142,7 +144,8 @@ namespace mongo {
         // Owned here. If 'wholeIXSoln' is false, then 'tree'
         // can be used to tag an isomorphic match expression. If 'wholeIXSoln'
         // is true, then 'tree' is used to store the relevant IndexEntry.
-        // If 'collscanSoln' is true, then 'tree' should be NULL.
+        // If 'collscanSoln' is true, then 'tree' should be NULL. For a skip scan, 'tree' stores the
+        // IndexEntry scanned.
         std::unique_ptr<PlanCacheIndexTree> tree;
 
         enum SolutionType {
@@ -154,6 +157,9 @@ namespace mongo {
             // The cached plan is a collection scan.
             COLLSCAN_SOLN,
 
+            // The plan skip-scans the index stored in 'tree'.
+            SKIP_SCAN_SOLN,
+
             // Build the solution by using 'tree'
             // to tag the match expression.
             USE_INDEX_TAGS_SOLN
@@ -256,6 +262,15 @@ namespace mongo {
         // Annotations from cached runs.  The CachedPlanStage provides these stats about its
         // runs when they complete.
         std::vector<PlanCacheEntryFeedback*> feedback;
+
+        /**
+         * Returns an estimate of the bytes held by this entry, not counting its key.
+         */
+        size_t estimateObjectSizeInBytes() const;
+
+        // This entry's share of the plan cache memory, which is only set once the entry is in a
+        // cache, so that the copies handed out aren't counted.
+        MemoryAccount::Charge memoryCharge;
     };
 
     /**
@@ -392,15 +407,55 @@ namespace mongo {
          */
         void notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries);
 
+        /**
+         * Called by the CachedPlanStage each time a cached plan is abandoned and the query is
+         * planned again from scratch.
+         */
+        void notifyOfReplan();
+
+        /**
+         * Appends the hit, miss, eviction and replan counts since the cache was created, along
+         * with the number of entries, to 'bob'. Used by planCacheListQueryShapes.
+         */
+        void appendStats(BSONObjBuilder* bob) const;
+
     private:
+        /**
+         * A part of the cache, picked by the hash of the key, with its own lock so that queries of
+         * different shapes don't all contend on one mutex. Each shard evicts its least recently
+         * used entries on its own.
+         */
+        struct Shard {
+            explicit Shard(size_t maxSize) : cache(maxSize) { }
+
+            LRUKeyValue<PlanCacheKey, PlanCacheEntry> cache;
+
+            // Protects cache.
+            mutable boost::mutex mutex;
+        };
+
         void encodeKeyForMatch(const MatchExpression* tree, StringBuilder* keyBuilder) const;
         void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
         void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
 
-        LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
+        /**
+         * Returns the cache key of 'cq' and sets '*hashOut' to its hash. The key is only encoded
+         * the first time, after which the one memoized in 'cq' is returned.
+         */
+        const PlanCacheKey& getKey(const CanonicalQuery& cq, size_t* hashOut) const;
+
+        Shard& getShard(size_t keyHash) const { return *_shards[keyHash % _shards.size()]; }
+
+        std::vector<std::unique_ptr<Shard>> _shards;
+
+        // Bumped whenever the indexes change, as that invalidates the keys memoized in queries.
+        AtomicUInt64 _keyGeneration;
 
-        // Protects _cache.
-        mutable boost::mutex _cacheMutex;
+        // Statistics reported by appendStats().
+        mutable AtomicUInt64 _hits;
+        mutable AtomicUInt64 _misses;
+        AtomicUInt64 _evictions;
+        AtomicUInt64 _replans;
 
         // Counter for write notifications since initialization or last clear() invocation.  Starts
         // at 0.
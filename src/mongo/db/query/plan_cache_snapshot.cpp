@@ -0,0 +1,246 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cache_snapshot.h"
+
+#include <memory>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+    const char kQueryField[] = "query";
+    const char kSortField[] = "sort";
+    const char kProjectionField[] = "projection";
+    const char kWorksField[] = "works";
+    const char kPlansField[] = "plans";
+
+    const char kTypeField[] = "type";
+    const char kDirectionField[] = "direction";
+    const char kIndexFilterAppliedField[] = "indexFilterApplied";
+    const char kTreeField[] = "tree";
+
+    const char kIndexNameField[] = "indexName";
+    const char kKeyPatternField[] = "keyPattern";
+    const char kPositionField[] = "position";
+    const char kChildrenField[] = "children";
+
+    void appendTree(const PlanCacheIndexTree& tree, BSONObjBuilder* bob) {
+        if (tree.entry) {
+            bob->append(kIndexNameField, tree.entry->name);
+            bob->append(kKeyPatternField, tree.entry->keyPattern);
+            bob->appendNumber(kPositionField, static_cast<long long>(tree.index_pos));
+        }
+
+        BSONArrayBuilder childrenBob(bob->subarrayStart(kChildrenField));
+        for (const PlanCacheIndexTree* child : tree.children) {
+            BSONObjBuilder childBob(childrenBob.subobjStart());
+            appendTree(*child, &childBob);
+        }
+    }
+
+    Status parseTree(const BSONObj& obj,
+                     const std::vector<IndexEntry>& indexes,
+                     PlanCacheIndexTree* tree) {
+        const BSONElement nameElt = obj[kIndexNameField];
+        if (!nameElt.eoo()) {
+            const BSONObj keyPattern = obj[kKeyPatternField].Obj();
+            const IndexEntry* index = NULL;
+            for (const IndexEntry& candidate : indexes) {
+                if (candidate.name == nameElt.String() && candidate.keyPattern == keyPattern) {
+                    index = &candidate;
+                    break;
+                }
+            }
+            if (!index) {
+                return Status(ErrorCodes::IndexNotFound,
+                              str::stream() << "index " << nameElt.String() << " with key "
+                                            << keyPattern << " no longer exists");
+            }
+
+            tree->setIndexEntry(*index);
+            tree->index_pos = obj[kPositionField].numberLong();
+        }
+
+        for (const BSONElement& childElt : obj[kChildrenField].Obj()) {
+            std::unique_ptr<PlanCacheIndexTree> child(new PlanCacheIndexTree());
+            Status status = parseTree(childElt.Obj(), indexes, child.get());
+            if (!status.isOK()) {
+                return status;
+            }
+            tree->children.push_back(child.release());
+        }
+        return Status::OK();
+    }
+
+    const char* solutionTypeName(SolutionCacheData::SolutionType type) {
+        switch (type) {
+        case SolutionCacheData::WHOLE_IXSCAN_SOLN: return "wholeIndexScan";
+        case SolutionCacheData::COLLSCAN_SOLN: return "collectionScan";
+        case SolutionCacheData::SKIP_SCAN_SOLN: return "skipScan";
+        case SolutionCacheData::USE_INDEX_TAGS_SOLN: return "indexTags";
+        }
+        invariant(false);
+    }
+
+    Status parseSolutionType(StringData name, SolutionCacheData::SolutionType* type) {
+        if (name == "wholeIndexScan") {
+            *type = SolutionCacheData::WHOLE_IXSCAN_SOLN;
+        }
+        else if (name == "collectionScan") {
+            *type = SolutionCacheData::COLLSCAN_SOLN;
+        }
+        else if (name == "skipScan") {
+            *type = SolutionCacheData::SKIP_SCAN_SOLN;
+        }
+        else if (name == "indexTags") {
+            *type = SolutionCacheData::USE_INDEX_TAGS_SOLN;
+        }
+        else {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "unknown cached solution type: " << name);
+        }
+        return Status::OK();
+    }
+
+    Status parseSolution(const BSONObj& obj,
+                         const std::vector<IndexEntry>& indexes,
+                         SolutionCacheData* scd) {
+        Status status = parseSolutionType(obj[kTypeField].String(), &scd->solnType);
+        if (!status.isOK()) {
+            return status;
+        }
+        scd->wholeIXSolnDir = obj[kDirectionField].numberInt();
+        scd->indexFilterApplied = obj[kIndexFilterAppliedField].trueValue();
+
+        const BSONElement treeElt = obj[kTreeField];
+        if (!treeElt.eoo()) {
+            scd->tree.reset(new PlanCacheIndexTree());
+            return parseTree(treeElt.Obj(), indexes, scd->tree.get());
+        }
+        return Status::OK();
+    }
+
+} // namespace
+
+    // static
+    BSONObj PlanCacheSnapshot::entryToBSON(const PlanCacheEntry& entry) {
+        BSONObjBuilder bob;
+        bob.append(kQueryField, entry.query);
+        bob.append(kSortField, entry.sort);
+        bob.append(kProjectionField, entry.projection);
+        bob.appendNumber(kWorksField,
+                         static_cast<long long>(entry.decision->stats[0]->common.works));
+
+        BSONArrayBuilder plansBob(bob.subarrayStart(kPlansField));
+        for (const SolutionCacheData* scd : entry.plannerData) {
+            BSONObjBuilder planBob(plansBob.subobjStart());
+            planBob.append(kTypeField, solutionTypeName(scd->solnType));
+            planBob.append(kDirectionField, scd->wholeIXSolnDir);
+            planBob.append(kIndexFilterAppliedField, scd->indexFilterApplied);
+            if (scd->tree) {
+                BSONObjBuilder treeBob(planBob.subobjStart(kTreeField));
+                appendTree(*scd->tree, &treeBob);
+            }
+        }
+        plansBob.doneFast();
+
+        return bob.obj();
+    }
+
+    // static
+    Status PlanCacheSnapshot::addEntryFromBSON(const std::string& ns,
+                                               const BSONObj& entryObj,
+                                               const std::vector<IndexEntry>& indexes,
+                                               PlanCache* planCache) {
+        try {
+            CanonicalQuery* rawCq;
+            Status status = CanonicalQuery::canonicalize(ns,
+                                                         entryObj[kQueryField].Obj(),
+                                                         entryObj[kSortField].Obj(),
+                                                         entryObj[kProjectionField].Obj(),
+                                                         &rawCq);
+            if (!status.isOK()) {
+                return status;
+            }
+            std::unique_ptr<CanonicalQuery> cq(rawCq);
+
+            if (planCache->contains(*cq)) {
+                return Status(ErrorCodes::DuplicateKey, "query shape is already cached");
+            }
+
+            OwnedPointerVector<QuerySolution> solutions;
+            for (const BSONElement& planElt : entryObj[kPlansField].Obj()) {
+                std::unique_ptr<SolutionCacheData> scd(new SolutionCacheData());
+                status = parseSolution(planElt.Obj(), indexes, scd.get());
+                if (!status.isOK()) {
+                    return status;
+                }
+
+                QuerySolution* solution = new QuerySolution();
+                solution->cacheData.reset(scd.release());
+                solutions.mutableVector().push_back(solution);
+            }
+
+            // The original trial stats are not kept. The works of the winning plan are what the
+            // CachedPlanStage compares against to decide whether to replan.
+            const size_t works = entryObj[kWorksField].numberLong();
+            std::unique_ptr<PlanRankingDecision> decision(new PlanRankingDecision());
+            for (size_t i = 0; i < solutions.size(); ++i) {
+                PlanStageStats* stats = new PlanStageStats(CommonStats("CACHED_PLAN"),
+                                                           STAGE_CACHED_PLAN);
+                stats->common.works = works;
+                decision->stats.mutableVector().push_back(stats);
+                decision->scores.push_back(0);
+                decision->candidateOrder.push_back(i);
+            }
+
+            status = planCache->add(*cq, solutions.vector(), decision.get());
+            if (status.isOK()) {
+                // The cache took ownership of the decision.
+                decision.release();
+            }
+            return status;
+        }
+        catch (const DBException& ex) {
+            // A malformed entry, e.g. with a field of the wrong type.
+            return ex.toStatus();
+        }
+    }
+
+} // namespace mongo
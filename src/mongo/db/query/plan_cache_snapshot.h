@@ -0,0 +1,72 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/index_entry.h"
+
+namespace mongo {
+
+    class PlanCache;
+    class PlanCacheEntry;
+
+    /**
+     * Conversion of plan cache entries to and from BSON, so that the plan cache of a collection
+     * can be saved and reloaded after a restart or on another member of a replica set.
+     *
+     * Only the query shape, the data the planner needs to rebuild each candidate solution and
+     * the number of works it took to pick the winner are kept. Indexes are referred to by name
+     * and key pattern, so an entry whose indexes were dropped or recreated differently since it
+     * was saved is not reloaded. Reloaded entries are revalidated like any other when they are
+     * used: if the winning plan takes much longer than it originally did, the CachedPlanStage
+     * replans the query.
+     */
+    class PlanCacheSnapshot {
+    public:
+        /**
+         * Returns a BSON representation of 'entry'.
+         */
+        static BSONObj entryToBSON(const PlanCacheEntry& entry);
+
+        /**
+         * Adds the entry in 'entryObj', as returned by entryToBSON(), to 'planCache' for the
+         * collection 'ns' with the indexes 'indexes', unless the cache already has one for the
+         * same query shape.
+         */
+        static Status addEntryFromBSON(const std::string& ns,
+                                       const BSONObj& entryObj,
+                                       const std::vector<IndexEntry>& indexes,
+                                       PlanCache* planCache);
+    };
+
+} // namespace mongo
@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/plan_cache_snapshot.h
+ */
+
+#include "mongo/db/query/plan_cache_snapshot.h"
+
+#include <memory>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/json.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    static const char* ns = "somebogusns";
+
+    std::unique_ptr<CanonicalQuery> canonicalize(const char* queryStr) {
+        CanonicalQuery* cq;
+        ASSERT_OK(CanonicalQuery::canonicalize(ns, fromjson(queryStr), &cq));
+        return std::unique_ptr<CanonicalQuery>(cq);
+    }
+
+    PlanRankingDecision* createDecision(size_t numPlans, size_t works) {
+        std::unique_ptr<PlanRankingDecision> why(new PlanRankingDecision());
+        for (size_t i = 0; i < numPlans; ++i) {
+            std::unique_ptr<PlanStageStats> stats(
+                new PlanStageStats(CommonStats("COLLSCAN"), STAGE_COLLSCAN));
+            stats->specific.reset(new CollectionScanStats());
+            stats->common.works = works;
+            why->stats.mutableVector().push_back(stats.release());
+            why->scores.push_back(0U);
+            why->candidateOrder.push_back(i);
+        }
+        return why.release();
+    }
+
+    /**
+     * Caches a plan tagging {a: 1, b: 1} with the index 'a_1', and a collection scan, for the
+     * query {a: 1, b: 1}, then returns the entry.
+     */
+    PlanCacheEntry* addEntry(PlanCache* planCache, const IndexEntry& index) {
+        std::unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1, b: 1}"));
+
+        OwnedPointerVector<QuerySolution> solns;
+        QuerySolution* tagged = new QuerySolution();
+        tagged->cacheData.reset(new SolutionCacheData());
+        tagged->cacheData->solnType = SolutionCacheData::USE_INDEX_TAGS_SOLN;
+        tagged->cacheData->tree.reset(new PlanCacheIndexTree());
+        PlanCacheIndexTree* child = new PlanCacheIndexTree();
+        child->setIndexEntry(index);
+        child->index_pos = 0;
+        tagged->cacheData->tree->children.push_back(child);
+        tagged->cacheData->tree->children.push_back(new PlanCacheIndexTree());
+        solns.mutableVector().push_back(tagged);
+
+        QuerySolution* collscan = new QuerySolution();
+        collscan->cacheData.reset(new SolutionCacheData());
+        collscan->cacheData->solnType = SolutionCacheData::COLLSCAN_SOLN;
+        solns.mutableVector().push_back(collscan);
+
+        ASSERT_OK(planCache->add(*cq, solns.vector(), createDecision(2U, 17U)));
+
+        PlanCacheEntry* entry;
+        ASSERT_OK(planCache->getEntry(*cq, &entry));
+        return entry;
+    }
+
+    TEST(PlanCacheSnapshotTest, RoundTrip) {
+        const IndexEntry index(BSON("a" << 1), false, false, false, "a_1", NULL, BSONObj());
+        std::vector<IndexEntry> indexes;
+        indexes.push_back(index);
+
+        PlanCache planCache(ns);
+        std::unique_ptr<PlanCacheEntry> entry(addEntry(&planCache, index));
+        const BSONObj entryObj = PlanCacheSnapshot::entryToBSON(*entry);
+
+        PlanCache reloaded(ns);
+        ASSERT_OK(PlanCacheSnapshot::addEntryFromBSON(ns, entryObj, indexes, &reloaded));
+
+        std::unique_ptr<CanonicalQuery> cq(canonicalize("{b: 1, a: 1}"));
+        CachedSolution* rawCs;
+        ASSERT_OK(reloaded.get(*cq, &rawCs));
+        std::unique_ptr<CachedSolution> cs(rawCs);
+
+        ASSERT_EQUALS(17U, cs->decisionWorks);
+        ASSERT_EQUALS(2U, cs->plannerData.size());
+        ASSERT_EQUALS(entry->plannerData[0]->toString(), cs->plannerData[0]->toString());
+        ASSERT_EQUALS(SolutionCacheData::COLLSCAN_SOLN, cs->plannerData[1]->solnType);
+
+        const PlanCacheIndexTree* tree = cs->plannerData[0]->tree.get();
+        ASSERT_EQUALS(2U, tree->children.size());
+        ASSERT_EQUALS("a_1", tree->children[0]->entry->name);
+        ASSERT_FALSE(tree->children[1]->entry);
+
+        // Entries already in the cache are not replaced.
+        ASSERT_NOT_OK(PlanCacheSnapshot::addEntryFromBSON(ns, entryObj, indexes, &reloaded));
+    }
+
+    TEST(PlanCacheSnapshotTest, MissingIndex) {
+        const IndexEntry index(BSON("a" << 1), false, false, false, "a_1", NULL, BSONObj());
+        PlanCache planCache(ns);
+        std::unique_ptr<PlanCacheEntry> entry(addEntry(&planCache, index));
+        const BSONObj entryObj = PlanCacheSnapshot::entryToBSON(*entry);
+
+        // The index was dropped.
+        PlanCache reloaded(ns);
+        ASSERT_NOT_OK(PlanCacheSnapshot::addEntryFromBSON(ns,
+                                                          entryObj,
+                                                          std::vector<IndexEntry>(),
+                                                          &reloaded));
+        ASSERT_EQUALS(0U, reloaded.size());
+
+        // The index was recreated on different fields under the same name.
+        std::vector<IndexEntry> indexes;
+        indexes.push_back(IndexEntry(BSON("a" << -1), false, false, false, "a_1", NULL,
+                                     BSONObj()));
+        ASSERT_NOT_OK(PlanCacheSnapshot::addEntryFromBSON(ns, entryObj, indexes, &reloaded));
+        ASSERT_EQUALS(0U, reloaded.size());
+    }
+
+    TEST(PlanCacheSnapshotTest, MalformedEntry) {
+        PlanCache planCache(ns);
+        ASSERT_NOT_OK(PlanCacheSnapshot::addEntryFromBSON(ns,
+                                                          fromjson("{query: 1}"),
+                                                          std::vector<IndexEntry>(),
+                                                          &planCache));
+        ASSERT_NOT_OK(PlanCacheSnapshot::addEntryFromBSON(
+            ns,
+            fromjson("{query: {a: 1}, sort: {}, projection: {}, works: 1,"
+                     " plans: [{type: 'bogus', direction: 1, indexFilterApplied: false}]}"),
+            std::vector<IndexEntry>(),
+            &planCache));
+        ASSERT_EQUALS(0U, planCache.size());
+    }
+
+} // namespace
@@ -423,6 +423,97 @@ namespace {
         ASSERT_EQUALS(planCache.size(), 1U);
     }
 
+    /**
+     * Sets the plan cache size and shard count knobs for the lifetime of the object.
+     */
+    class ScopedCacheSize {
+    public:
+        ScopedCacheSize(int size, int shards)
+            : _oldSize(internalQueryCacheSize), _oldShards(internalQueryCacheShards) {
+            internalQueryCacheSize = size;
+            internalQueryCacheShards = shards;
+        }
+
+        ~ScopedCacheSize() {
+            internalQueryCacheSize = _oldSize;
+            internalQueryCacheShards = _oldShards;
+        }
+
+    private:
+        const int _oldSize;
+        const int _oldShards;
+    };
+
+    int getStat(const PlanCache& planCache, const char* name) {
+        BSONObjBuilder bob;
+        planCache.appendStats(&bob);
+        return bob.obj()[name].numberInt();
+    }
+
+    TEST(PlanCacheTest, ShardsShareCacheSize) {
+        ScopedCacheSize scopedSize(4, 4);
+        PlanCache planCache;
+        QuerySolution qs;
+        qs.cacheData.reset(new SolutionCacheData());
+        qs.cacheData->tree.reset(new PlanCacheIndexTree());
+        std::vector<QuerySolution*> solns;
+        solns.push_back(&qs);
+
+        // Some of the shards may fill up before others, but no more than 4 entries fit in all.
+        for (int i = 0; i < 20; ++i) {
+            unique_ptr<CanonicalQuery> cq(canonicalize(BSON("f" + std::to_string(i) << 1)));
+            ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+        }
+        ASSERT_LESS_THAN_OR_EQUALS(planCache.size(), 4U);
+        ASSERT_EQUALS(20, getStat(planCache, "entries") + getStat(planCache, "evictions"));
+        ASSERT_EQUALS(planCache.size(), planCache.getAllEntries().size());
+    }
+
+    TEST(PlanCacheTest, StatsCountHitsMissesAndReplans) {
+        PlanCache planCache;
+        unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+        QuerySolution qs;
+        qs.cacheData.reset(new SolutionCacheData());
+        qs.cacheData->tree.reset(new PlanCacheIndexTree());
+        std::vector<QuerySolution*> solns;
+        solns.push_back(&qs);
+
+        CachedSolution* rawSolution;
+        ASSERT_NOT_OK(planCache.get(*cq, &rawSolution));
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+        ASSERT_OK(planCache.get(*cq, &rawSolution));
+        delete rawSolution;
+        ASSERT_OK(planCache.get(*cq, &rawSolution));
+        delete rawSolution;
+        planCache.notifyOfReplan();
+
+        ASSERT_EQUALS(1, getStat(planCache, "entries"));
+        ASSERT_EQUALS(2, getStat(planCache, "hits"));
+        ASSERT_EQUALS(1, getStat(planCache, "misses"));
+        ASSERT_EQUALS(0, getStat(planCache, "evictions"));
+        ASSERT_EQUALS(1, getStat(planCache, "replans"));
+    }
+
+    // The key a query remembers is dropped once the indexes change, since they are part of it.
+    TEST(PlanCacheTest, ComputeKeyAfterIndexChange) {
+        PlanCache planCache;
+        unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+        const PlanCacheKey before = planCache.computeKey(*cq);
+        ASSERT_EQUALS(before, planCache.computeKey(*cq));
+
+        planCache.notifyOfIndexEntries({IndexEntry(BSON("a" << 1),
+                                                   false, // multikey
+                                                   true, // sparse
+                                                   false, // unique
+                                                   "", // name
+                                                   nullptr, // filterExpr
+                                                   BSONObj())});
+        ASSERT_NOT_EQUALS(before, planCache.computeKey(*cq));
+
+        unique_ptr<CanonicalQuery> sameShape(canonicalize("{a: 2}"));
+        ASSERT_EQUALS(planCache.computeKey(*sameShape), planCache.computeKey(*cq));
+    }
+
     /**
      * Each test in the CachePlanSelectionTest suite goes through
      * the following flow:
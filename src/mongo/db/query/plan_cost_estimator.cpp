@@ -0,0 +1,188 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include <algorithm>
+
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/index_stats.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+    using std::endl;
+
+    namespace {
+
+        const IndexStats* findStats(const BSONObj& keyPattern,
+                                    const std::vector<IndexEntry>& indices) {
+            for (size_t i = 0; i < indices.size(); ++i) {
+                const IndexStats* stats = indices[i].stats.get();
+                if (stats && 0 == indices[i].keyPattern.woCompare(keyPattern)) {
+                    return stats;
+                }
+            }
+            return NULL;
+        }
+
+        bool estimateIndexScan(const IndexScanNode* ixn,
+                               const std::vector<IndexEntry>& indices,
+                               PlanCostEstimator::Estimate* out) {
+            const IndexStats* stats = findStats(ixn->indexKeyPattern, indices);
+            if (!stats || ixn->bounds.isSimpleRange || ixn->bounds.fields.empty()) {
+                return false;
+            }
+
+            // Only the leading field is looked at, so scans with bounds on later fields of a
+            // compound index are overestimated.
+            const OrderedIntervalList& leading = ixn->bounds.fields[0];
+            out->works = stats->estimateKeys(leading);
+            out->docs = out->works;
+            out->selectivity = stats->estimateFraction(leading);
+            return true;
+        }
+
+    }  // namespace
+
+    // static
+    bool PlanCostEstimator::estimate(const QuerySolutionNode* node,
+                                     const std::vector<IndexEntry>& indices,
+                                     Estimate* out) {
+        const StageType type = node->getType();
+        if (STAGE_IXSCAN == type) {
+            return estimateIndexScan(static_cast<const IndexScanNode*>(node), indices, out);
+        }
+
+        std::vector<Estimate> children(node->children.size());
+        for (size_t i = 0; i < node->children.size(); ++i) {
+            if (!estimate(node->children[i], indices, &children[i])) {
+                return false;
+            }
+        }
+
+        if (STAGE_AND_HASH == type || STAGE_AND_SORTED == type) {
+            // Every child runs to completion. The intersection keeps the documents which all
+            // children produce, out of the smallest number any child had to choose from.
+            Estimate result;
+            double candidates = -1;
+            for (size_t i = 0; i < children.size(); ++i) {
+                result.works += children[i].works;
+                result.selectivity *= children[i].selectivity;
+                if (children[i].selectivity > 0) {
+                    double total = children[i].docs / children[i].selectivity;
+                    candidates = (candidates < 0) ? total : std::min(candidates, total);
+                }
+            }
+            result.docs = (result.selectivity > 0 && candidates > 0)
+                        ? candidates * result.selectivity : 0;
+            *out = result;
+            return true;
+        }
+
+        if (STAGE_OR == type || STAGE_SORT_MERGE == type) {
+            Estimate result;
+            result.selectivity = 0;
+            for (size_t i = 0; i < children.size(); ++i) {
+                result.works += children[i].works;
+                result.docs += children[i].docs;
+                result.selectivity += children[i].selectivity;
+            }
+            result.selectivity = std::min(result.selectivity, 1.0);
+            *out = result;
+            return true;
+        }
+
+        if (1 != children.size()) {
+            // Collection scans, text and geo stages, and anything else we know nothing about.
+            return false;
+        }
+
+        *out = children[0];
+        if (STAGE_FETCH == type) {
+            out->works += out->docs;
+        }
+        return true;
+    }
+
+    // static
+    void PlanCostEstimator::pruneSolutions(const CanonicalQuery& query,
+                                           const QueryPlannerParams& params,
+                                           std::vector<QuerySolution*>* solutions) {
+        const double ratio = internalQueryPlannerStatsPruningRatio;
+        if (ratio <= 0 || solutions->size() < 2) {
+            return;
+        }
+
+        const LiteParsedQuery& pq = query.getParsed();
+        if (!pq.getSort().isEmpty() || pq.getLimit()) {
+            return;
+        }
+
+        std::vector<bool> known(solutions->size(), false);
+        std::vector<Estimate> estimates(solutions->size());
+        double cheapest = -1;
+        for (size_t i = 0; i < solutions->size(); ++i) {
+            const QuerySolutionNode* root = (*solutions)[i]->root.get();
+            known[i] = root && estimate(root, params.indices, &estimates[i]);
+            if (known[i]) {
+                cheapest = (cheapest < 0) ? estimates[i].works
+                                          : std::min(cheapest, estimates[i].works);
+            }
+        }
+
+        if (cheapest < 0) {
+            return;
+        }
+
+        // Plans this cheap finish within the trial period anyway, so racing them costs little.
+        const double threshold = std::max(ratio * cheapest,
+                                          static_cast<double>(internalQueryPlanEvaluationWorks));
+
+        std::vector<QuerySolution*> kept;
+        for (size_t i = 0; i < solutions->size(); ++i) {
+            QuerySolution* soln = (*solutions)[i];
+            if (known[i] && estimates[i].works > threshold) {
+                LOG(2) << "Planner: pruning solution with estimated cost " << estimates[i].works
+                       << ", cheapest is " << cheapest << ":" << endl << soln->toString();
+                delete soln;
+                continue;
+            }
+            kept.push_back(soln);
+        }
+        solutions->swap(kept);
+    }
+
+}  // namespace mongo
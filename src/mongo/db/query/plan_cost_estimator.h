@@ -0,0 +1,88 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/query/index_entry.h"
+
+namespace mongo {
+
+    class CanonicalQuery;
+    struct QueryPlannerParams;
+    class QuerySolution;
+    struct QuerySolutionNode;
+
+    /**
+     * Estimates the cost of query solutions from the IndexStats of the indices they scan, so that
+     * the planner can drop candidates which are clearly worse than another before MultiPlanStage
+     * races them.
+     */
+    class PlanCostEstimator {
+    public:
+        struct Estimate {
+            Estimate() : works(0), docs(0), selectivity(1) { }
+
+            // Index keys examined plus documents fetched.
+            double works;
+
+            // Results produced.
+            double docs;
+
+            // Fraction of the collection produced, assuming independent predicates.
+            double selectivity;
+        };
+
+        /**
+         * Estimates the cost of the tree rooted at 'node'. Returns false if some part of the tree
+         * cannot be estimated, e.g. because it scans an index without statistics or the
+         * collection.
+         *
+         * Index intersections (AND_HASH and AND_SORTED) cost the sum of their children, and are
+         * assumed to produce the product of their children's selectivities.
+         */
+        static bool estimate(const QuerySolutionNode* node,
+                             const std::vector<IndexEntry>& indices,
+                             Estimate* out);
+
+        /**
+         * Deletes and removes from 'solutions' those whose estimated cost is more than
+         * internalQueryPlannerStatsPruningRatio times that of the cheapest solution. Solutions
+         * which cannot be estimated are kept, as are solutions cheaper than the trial period of
+         * MultiPlanStage.
+         *
+         * Nothing is pruned for queries with a sort or a limit, whose cost depends on how soon
+         * they can stop rather than on how much they would scan.
+         */
+        static void pruneSolutions(const CanonicalQuery& query,
+                                   const QueryPlannerParams& params,
+                                   std::vector<QuerySolution*>* solutions);
+    };
+
+}  // namespace mongo
@@ -42,6 +42,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 
 #include "mongo/util/stacktrace.h"
@@ -155,7 +156,10 @@ namespace mongo {
           _qs(qs),
           _root(rt),
           _ns(ns),
-          _yieldPolicy(new PlanYieldPolicy(this, YIELD_MANUAL)) {
+          _yieldPolicy(new PlanYieldPolicy(this, YIELD_MANUAL)),
+          _hasBatchState(false),
+          _batchState(PlanStage::NEED_TIME),
+          _batchStateId(WorkingSet::INVALID_ID) {
         // We may still need to initialize _ns from either _collection or _cq.
         if (!_ns.empty()) {
             // We already have an _ns set, so there's nothing more to do.
@@ -295,7 +299,21 @@ namespace mongo {
     }
 
     void PlanExecutor::invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {
-        if (!killed()) { _root->invalidate(txn, dl, type); }
+        if (killed()) { return; }
+
+        _root->invalidate(txn, dl, type);
+
+        // Results left over from the last batch are no longer owned by any stage, so we have to
+        // save their data ourselves.
+        for (std::deque<WorkingSetID>::const_iterator it = _batch.begin();
+             it != _batch.end();
+             ++it) {
+            if (WorkingSet::INVALID_ID == *it) { continue; }
+            WorkingSetMember* member = _workingSet->get(*it);
+            if (member->hasLoc() && member->loc == dl) {
+                WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+            }
+        }
     }
 
     PlanExecutor::ExecState PlanExecutor::getNext(BSONObj* objOut, RecordId* dlOut) {
@@ -334,7 +352,7 @@ namespace mongo {
         // just pass a NULL fetcher.
         std::unique_ptr<RecordFetcher> fetcher;
 
-        // Incremented on every writeConflict, reset to 0 on any successful call to _root->work.
+        // Incremented on every writeConflict, reset to 0 on any successful call to workRoot.
         size_t writeConflictsInARow = 0;
 
         for (;;) {
@@ -364,7 +382,7 @@ namespace mongo {
             fetcher.reset();
 
             WorkingSetID id = WorkingSet::INVALID_ID;
-            PlanStage::StageState code = _root->work(&id);
+            PlanStage::StageState code = workRoot(&id);
 
             if (code != PlanStage::NEED_YIELD)
                 writeConflictsInARow = 0;
@@ -389,8 +407,11 @@ namespace mongo {
                         else {
                             // TODO: currently snapshot ids are only associated with documents, and
                             // not with index keys.
+                            //
+                            // The key may live in the member's own storage, which is reused as
+                            // soon as the member is, so hand out an owned copy.
                             *objOut = Snapshotted<BSONObj>(SnapshotId(),
-                                                           member->keyData[0].keyData);
+                                                           member->keyData[0].keyData.getOwned());
                         }
                     }
                     else if (member->hasObj()) {
@@ -423,9 +444,10 @@ namespace mongo {
                     if (!_yieldPolicy->allowedToYield()) throw WriteConflictException();
                     CurOp::get(_opCtx)->debug().writeConflicts++;
                     writeConflictsInARow++;
-                    WriteConflictException::logAndBackoff(writeConflictsInARow,
-                                                          "plan execution",
-                                                          _collection->ns().ns());
+                    CurOp::get(_opCtx)->debug().writeConflictBackoffMicros +=
+                        WriteConflictException::logAndBackoff(writeConflictsInARow,
+                                                              "plan execution",
+                                                              _collection->ns().ns());
 
                 }
                 else {
@@ -459,8 +481,52 @@ namespace mongo {
         }
     }
 
+    PlanStage::StageState PlanExecutor::workRoot(WorkingSetID* out) {
+        if (!_batch.empty()) {
+            *out = _batch.front();
+            _batch.pop_front();
+            return PlanStage::ADVANCED;
+        }
+
+        if (_hasBatchState) {
+            _hasBatchState = false;
+            *out = _batchStateId;
+            return _batchState;
+        }
+
+        const int batchSize = internalQueryExecBatchSize;
+        if (batchSize <= 1) {
+            return _root->work(out);
+        }
+
+        _batchResults.clear();
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        const PlanStage::StageState state = _root->workBatch(batchSize, &_batchResults, &id);
+        _batch.insert(_batch.end(), _batchResults.begin(), _batchResults.end());
+
+        if (PlanStage::ADVANCED != state && PlanStage::NEED_TIME != state) {
+            if (_batch.empty()) {
+                *out = id;
+                return state;
+            }
+            // Hand out the results first.
+            _hasBatchState = true;
+            _batchState = state;
+            _batchStateId = id;
+        }
+
+        if (_batch.empty()) {
+            return PlanStage::NEED_TIME;
+        }
+
+        *out = _batch.front();
+        _batch.pop_front();
+        return PlanStage::ADVANCED;
+    }
+
     bool PlanExecutor::isEOF() {
-        return killed() || (_stash.empty() && _root->isEOF());
+        return killed() ||
+               (_stash.empty() && _batch.empty() && !_hasBatchState && _root->isEOF());
     }
 
     void PlanExecutor::registerExec() {
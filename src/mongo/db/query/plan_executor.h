@@ -29,9 +29,12 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 #include <queue>
+#include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/storage/snapshot.h"
@@ -411,6 +414,13 @@ namespace mongo {
          */
         Status pickBestPlan(YieldPolicy policy);
 
+        /**
+         * Returns the root stage's next result or state, as a call to its work() would. When the
+         * internalQueryExecBatchSize knob is above 1, takes them from a batch of that many units
+         * of work of the root, asking for a new batch once the last one has been handed out.
+         */
+        PlanStage::StageState workRoot(WorkingSetID* out);
+
         bool killed() { return static_cast<bool>(_killReason); };
 
         // The OperationContext that we're executing within.  We need this in order to release
@@ -445,6 +455,16 @@ namespace mongo {
         // to consume yet. We empty the queue before retrieving further results from the plan
         // stages.
         std::queue<BSONObj> _stash;
+
+        // Results of the root's last workBatch() which haven't been handed out yet, and the state
+        // which ended that batch, if any, to hand out after them. Only used when batching.
+        std::deque<WorkingSetID> _batch;
+        bool _hasBatchState;
+        PlanStage::StageState _batchState;
+        WorkingSetID _batchStateId;
+
+        // Receives each batch from the root, kept to reuse its storage.
+        std::vector<WorkingSetID> _batchResults;
     };
 
 }  // namespace mongo
@@ -69,7 +69,7 @@ namespace mongo {
      */
     struct CandidatePlan {
         CandidatePlan(QuerySolution* s, PlanStage* r, WorkingSet* w)
-            : solution(s), root(r), ws(w), failed(false) { }
+            : solution(s), root(r), ws(w), failed(false), abandoned(false) { }
 
         QuerySolution* solution;
         PlanStage* root;
@@ -79,6 +79,10 @@ namespace mongo {
         std::list<WorkingSetID> results;
 
         bool failed;
+
+        // Set if the plan was clearly less productive than another, and so was no longer worked
+        // during the trial period. It can still be picked, e.g. as a backup plan.
+        bool abandoned;
     };
 
     /**
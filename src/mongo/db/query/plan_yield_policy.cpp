@@ -101,9 +101,10 @@ namespace mongo {
             }
             catch (const WriteConflictException& wce) {
                 CurOp::get(opCtx)->debug().writeConflicts++;
-                WriteConflictException::logAndBackoff(attempt,
-                                                      "plan execution restoreState",
-                                                      _planYielding->collection()->ns().ns());
+                CurOp::get(opCtx)->debug().writeConflictBackoffMicros +=
+                    WriteConflictException::logAndBackoff(attempt,
+                                                          "plan execution restoreState",
+                                                          _planYielding->collection()->ns().ns());
                 // retry
             }
         }
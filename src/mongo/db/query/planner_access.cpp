@@ -1201,6 +1201,110 @@ namespace mongo {
         return solnRoot;
     }
 
+    namespace {
+
+        /**
+         * Can 'pred' bound one field of a skip scan?  These are the comparisons which translate
+         * to bounds on the value of a field without regard to the rest of the query.
+         */
+        bool canBoundSkipScan(const MatchExpression* pred) {
+            switch (pred->matchType()) {
+            case MatchExpression::EQ:
+            case MatchExpression::LT:
+            case MatchExpression::LTE:
+            case MatchExpression::GT:
+            case MatchExpression::GTE:
+            case MatchExpression::MATCH_IN:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+    }  // namespace
+
+    // static
+    QuerySolutionNode* QueryPlannerAccess::makeSkipScan(const IndexEntry& index,
+                                                        const CanonicalQuery& query,
+                                                        const QueryPlannerParams& params) {
+        // Sparse, partial and multikey indexes would need the bounds on each field to account
+        // for the others, so stick to indexes with exactly one key per document.
+        if (INDEX_BTREE != index.type || index.multikey || index.sparse
+            || NULL != index.filterExpr || index.keyPattern.nFields() < 2) {
+            return NULL;
+        }
+
+        vector<const MatchExpression*> preds;
+        const MatchExpression* root = query.root();
+        if (MatchExpression::AND == root->matchType()) {
+            for (size_t i = 0; i < root->numChildren(); ++i) {
+                preds.push_back(root->getChild(i));
+            }
+        }
+        else {
+            preds.push_back(root);
+        }
+
+        BSONObjIterator kpIt(index.keyPattern);
+        const BSONElement leadingElt = kpIt.next();
+
+        // A predicate on the leading field is better served by an ordinary index scan.
+        for (size_t i = 0; i < preds.size(); ++i) {
+            if (preds[i]->path() == leadingElt.fieldNameStringData()) {
+                return NULL;
+            }
+        }
+
+        IndexBounds bounds;
+        bounds.fields.resize(index.keyPattern.nFields());
+        IndexBoundsBuilder::allValuesForField(leadingElt, &bounds.fields[0]);
+
+        bool anyBounded = false;
+        for (size_t fieldNo = 1; kpIt.more(); ++fieldNo) {
+            const BSONElement kpElt = kpIt.next();
+            OrderedIntervalList* oil = &bounds.fields[fieldNo];
+
+            for (size_t i = 0; i < preds.size(); ++i) {
+                if (!canBoundSkipScan(preds[i])
+                    || preds[i]->path() != kpElt.fieldNameStringData()) {
+                    continue;
+                }
+
+                // The FETCH applies the whole query, so the bounds need not be exact.
+                IndexBoundsBuilder::BoundsTightness tightness;
+                if (oil->name.empty()) {
+                    IndexBoundsBuilder::translate(preds[i], kpElt, index, oil, &tightness);
+                }
+                else {
+                    IndexBoundsBuilder::translateAndIntersect(preds[i], kpElt, index, oil,
+                                                              &tightness);
+                }
+                anyBounded = true;
+            }
+
+            if (oil->name.empty()) {
+                IndexBoundsBuilder::allValuesForField(kpElt, oil);
+            }
+        }
+
+        if (!anyBounded) {
+            return NULL;
+        }
+
+        // We create bounds assuming a forward direction but can easily reverse bounds to align
+        // according to our desired direction.
+        IndexBoundsBuilder::alignBounds(&bounds, index.keyPattern);
+
+        SkipScanNode* ssn = new SkipScanNode();
+        ssn->indexKeyPattern = index.keyPattern;
+        ssn->bounds = bounds;
+
+        FetchNode* fetch = new FetchNode();
+        fetch->filter.reset(root->shallowClone());
+        fetch->children.push_back(ssn);
+        return fetch;
+    }
+
     // static
     void QueryPlannerAccess::addFilterToSolutionNode(QuerySolutionNode* node,
                                                      MatchExpression* match,
@@ -199,6 +199,17 @@ namespace mongo {
                                                  const QueryPlannerParams& params,
                                                  int direction = 1);
 
+        /**
+         * Return a plan that skip-scans the compound index 'index': it uses the top-level
+         * predicates of 'query' on the index's trailing fields as bounds within each value of
+         * its leading field, and fetches to apply the whole query.  Returns NULL if the query
+         * has a predicate on the leading field, none to bound the trailing fields with, or if
+         * the index is not a plain btree index with one key per document.
+         */
+        static QuerySolutionNode* makeSkipScan(const IndexEntry& index,
+                                               const CanonicalQuery& query,
+                                               const QueryPlannerParams& params);
+
         /**
          * Return a plan that scans the provided index from [startKey to endKey).
          */
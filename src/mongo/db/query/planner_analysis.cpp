@@ -33,6 +33,10 @@
 #include <vector>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/expression_tree.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/util/log.h"
@@ -258,6 +262,202 @@ namespace mongo {
             return false;
         }
 
+        /**
+         * If 'solnRoot' fetches several points from a unique btree index, returns an equivalent
+         * POINT_LOOKUP which looks each key up and fetches the documents in RecordId order, and
+         * deletes 'solnRoot'.  Otherwise returns 'solnRoot' unchanged.
+         *
+         * The lookup returns results in neither index nor RecordId order, so the caller must not
+         * need the order of the index scan.
+         */
+        QuerySolutionNode* tryPointLookup(const QueryPlannerParams& params,
+                                          QuerySolutionNode* solnRoot) {
+            if (!internalQueryPlannerEnablePointLookup) {
+                return solnRoot;
+            }
+
+            if (STAGE_FETCH != solnRoot->getType()
+                || STAGE_IXSCAN != solnRoot->children[0]->getType()) {
+                return solnRoot;
+            }
+
+            const IndexScanNode* isn = static_cast<const IndexScanNode*>(solnRoot->children[0]);
+            if (NULL != isn->filter || isn->maxScan || isn->addKeyMetadata) {
+                return solnRoot;
+            }
+
+            if (isn->bounds.isSimpleRange || 1 != isn->bounds.fields.size()) {
+                return solnRoot;
+            }
+
+            // A single point is no better off looked up than scanned.
+            const OrderedIntervalList& oil = isn->bounds.fields[0];
+            if (oil.intervals.size() < 2 || !isUnionOfPoints(oil)) {
+                return solnRoot;
+            }
+
+            bool isUniqueBtree = false;
+            for (size_t i = 0; i < params.indices.size(); ++i) {
+                const IndexEntry& index = params.indices[i];
+                if (0 == index.keyPattern.woCompare(isn->indexKeyPattern)) {
+                    isUniqueBtree = index.unique && INDEX_BTREE == index.type;
+                    break;
+                }
+            }
+            if (!isUniqueBtree) {
+                return solnRoot;
+            }
+
+            PointLookupNode* pln = new PointLookupNode();
+            pln->indexKeyPattern = isn->indexKeyPattern;
+            for (size_t i = 0; i < oil.intervals.size(); ++i) {
+                BSONObjBuilder keyBob;
+                keyBob.appendAs(oil.intervals[i].start, "");
+                pln->keys.push_back(keyBob.obj());
+            }
+            pln->filter.reset(solnRoot->filter.release());
+
+            delete solnRoot;
+            return pln;
+        }
+
+        /**
+         * Returns true if 'path' names one of the fields of 'keyPattern'.
+         */
+        bool isKeyField(StringData path, const BSONObj& keyPattern) {
+            BSONObjIterator it(keyPattern);
+            while (it.more()) {
+                if (path == it.next().fieldNameStringData()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Returns true if 'expr' only reads fields of 'keyPattern', and gives the same answer for
+         * the index key of a document as for the document.  The caller must make sure that the
+         * index is a btree index and is not multikey.
+         *
+         * An index key holds null for a missing field, which is matched the same as a missing
+         * field by every predicate here.  $exists and $type can tell them apart, so are excluded.
+         * Comparisons with arrays are left to the fetch as well, as they are about values which
+         * a single-key index does not hold.
+         */
+        bool isKeyPredicate(const MatchExpression* expr, const BSONObj& keyPattern) {
+            switch (expr->matchType()) {
+                case MatchExpression::EQ:
+                case MatchExpression::LT:
+                case MatchExpression::LTE:
+                case MatchExpression::GT:
+                case MatchExpression::GTE: {
+                    const ComparisonMatchExpression* cme =
+                        static_cast<const ComparisonMatchExpression*>(expr);
+                    return Array != cme->getData().type() && isKeyField(expr->path(), keyPattern);
+                }
+                case MatchExpression::MATCH_IN: {
+                    const InMatchExpression* ime = static_cast<const InMatchExpression*>(expr);
+                    const BSONElementSet& equalities = ime->getData().equalities();
+                    for (BSONElementSet::const_iterator it = equalities.begin();
+                         it != equalities.end();
+                         ++it) {
+                        if (Array == it->type()) {
+                            return false;
+                        }
+                    }
+                    return isKeyField(expr->path(), keyPattern);
+                }
+                case MatchExpression::REGEX:
+                case MatchExpression::MOD:
+                    return isKeyField(expr->path(), keyPattern);
+                case MatchExpression::AND:
+                case MatchExpression::OR:
+                case MatchExpression::NOR:
+                case MatchExpression::NOT: {
+                    if (0 == expr->numChildren()) {
+                        return false;
+                    }
+                    for (size_t i = 0; i < expr->numChildren(); ++i) {
+                        if (!isKeyPredicate(expr->getChild(i), keyPattern)) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        /**
+         * Adds 'expr' to the conjunction filtering 'node', taking ownership of it.
+         */
+        void andFilter(QuerySolutionNode* node, MatchExpression* expr) {
+            if (NULL == node->filter) {
+                node->filter.reset(expr);
+            }
+            else if (MatchExpression::AND == node->filter->matchType()) {
+                static_cast<AndMatchExpression*>(node->filter.get())->add(expr);
+            }
+            else {
+                AndMatchExpression* andExpr = new AndMatchExpression();
+                andExpr->add(node->filter.release());
+                andExpr->add(expr);
+                node->filter.reset(andExpr);
+            }
+        }
+
+        /**
+         * Moves the predicates of each FETCH in 'root' which can be answered from the keys of the
+         * IXSCAN beneath it onto that IXSCAN, so that their documents are not fetched only to be
+         * discarded.  Only single-key btree indexes qualify, since the key of a multikey index
+         * holds one element of an array rather than the array.
+         */
+        void pushDownKeyPredicates(const QueryPlannerParams& params, QuerySolutionNode* root) {
+            for (size_t i = 0; i < root->children.size(); ++i) {
+                pushDownKeyPredicates(params, root->children[i]);
+            }
+
+            if (STAGE_FETCH != root->getType() || NULL == root->filter
+                || STAGE_IXSCAN != root->children[0]->getType()) {
+                return;
+            }
+
+            IndexScanNode* isn = static_cast<IndexScanNode*>(root->children[0]);
+            if (isn->indexIsMultiKey
+                || INDEX_BTREE != IndexNames::nameToType(
+                                      IndexNames::findPluginName(isn->indexKeyPattern))) {
+                return;
+            }
+
+            if (MatchExpression::AND != root->filter->matchType()) {
+                if (isKeyPredicate(root->filter.get(), isn->indexKeyPattern)) {
+                    andFilter(isn, root->filter.release());
+                }
+                return;
+            }
+
+            std::vector<MatchExpression*>* conjuncts = root->filter->getChildVector();
+            for (size_t i = 0; i < conjuncts->size(); /* advanced below */) {
+                if (isKeyPredicate((*conjuncts)[i], isn->indexKeyPattern)) {
+                    andFilter(isn, (*conjuncts)[i]);
+                    conjuncts->erase(conjuncts->begin() + i);
+                }
+                else {
+                    ++i;
+                }
+            }
+
+            if (conjuncts->empty()) {
+                root->filter.reset();
+            }
+            else if (1 == conjuncts->size()) {
+                MatchExpression* remaining = (*conjuncts)[0];
+                conjuncts->clear();
+                root->filter.reset(remaining);
+            }
+        }
+
     }  // namespace
 
     // static
@@ -527,6 +727,14 @@ namespace mongo {
             sort->limit = 0;
         }
 
+        // The text stage can find the best scoring documents itself, reading no more of the
+        // index than it takes to know them.
+        if (sort->limit && 1 == sortObj.nFields()
+            && LiteParsedQuery::isTextScoreMeta(sortObj.firstElement())
+            && STAGE_TEXT == sort->children[0]->getType()) {
+            static_cast<TextNode*>(sort->children[0])->limit = sort->limit;
+        }
+
         *blockingSortOut = true;
 
         return solnRoot;
@@ -540,6 +748,15 @@ namespace mongo {
         soln->filterData = query.getQueryObj();
         soln->indexFilterApplied = params.indexFiltersApplied;
 
+        // Without a sort to preserve, a fetch of several unique keys can look them up instead.
+        if (query.getParsed().getSort().isEmpty()) {
+            solnRoot = tryPointLookup(params, solnRoot);
+        }
+
+        if (internalQueryPlannerPushDownKeyPredicates) {
+            pushDownKeyPredicates(params, solnRoot);
+        }
+
         solnRoot->computeProperties();
 
         // solnRoot finds all our results.  Let's see what transformations we must perform to the
@@ -614,7 +831,8 @@ namespace mongo {
         // to work(...) in order to possibly flag a result.
         bool couldProduceFlagged = hasAndHashStage
                                 || hasNode(solnRoot, STAGE_AND_SORTED)
-                                || hasNode(solnRoot, STAGE_FETCH);
+                                || hasNode(solnRoot, STAGE_FETCH)
+                                || hasNode(solnRoot, STAGE_POINT_LOOKUP);
 
         bool shouldAddMutation = !cannotKeepFlagged && couldProduceFlagged;
 
@@ -293,6 +293,9 @@ namespace mongo {
         else if (IndexNames::GEO_HAYSTACK == indexedFieldType) {
             return false;
         }
+        else if (IndexNames::SUMMARY == indexedFieldType) {
+            return false;
+        }
         else {
             warning() << "Unknown indexing for node " << node->toString()
                       << " and field " << elt.toString() << endl;
@@ -38,14 +38,24 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationCutoffMinWorks, int, 100);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationCutoffConfidence, double, 0.99);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationShareIndexScans, bool, true);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheSize, int, 5000);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheShards, int, 16);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheWriteOpsBetweenFlush, int, 1000);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryResultCacheMaxBytes, int, 16 * 1024 * 1024);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnumerationMaxOrSolutions, int, 10);
@@ -58,14 +68,41 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableHashIntersection, bool, false);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerStatsPruningRatio, double, 10.0);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryAnalyzeMaxBuckets, int, 1000);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxSkipScanPrefixes, int, 100);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnablePointLookup, bool, true);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerPushDownKeyPredicates, bool, true);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanOrChildrenIndependently, bool, true);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecAllowBlockingSortSpill, bool, true);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryCompileMatchExpressions, bool, true);
+
     // Yield every 128 cycles or 10ms.
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecBatchSize, int, 0);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxParallelism, int, 4);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecParallelMorselDocs, int, 1024);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryCursorPrefetchMaxBytes, int, 4 * 1024 * 1024);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryCursorPrefetchThreads, int, 4);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryAggMaxPushedDownTopK, int, 1000);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryAggSampleMaxRandomCursorRatio, double, 0.05);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryTextMaxNegatedTermKeys, int, 100 * 1000);
+
 }  // namespace mongo
@@ -45,6 +45,16 @@ namespace mongo {
     // Stop working plans once a plan returns this many results.
     extern int internalQueryPlanEvaluationMaxResults;
 
+    // Once candidates have been worked this many times, stop working those whose productivity
+    // is lower than that of the best candidate with internalQueryPlanEvaluationCutoffConfidence.
+    // Zero disables the cut-off.
+    extern int internalQueryPlanEvaluationCutoffMinWorks;
+
+    extern double internalQueryPlanEvaluationCutoffConfidence;
+
+    // Do candidate plans which scan the same index with the same bounds share the keys read?
+    extern bool internalQueryPlanEvaluationShareIndexScans;
+
     // Do we give a big ranking bonus to intersection plans?
     extern bool internalQueryForceIntersectionPlans;
 
@@ -54,6 +64,26 @@ namespace mongo {
     // Do we use hash-based intersection for rooted $and queries?
     extern bool internalQueryPlannerEnableHashIntersection;
 
+    // Candidate plans whose cost, estimated from index statistics gathered by 'analyze', is more
+    // than this many times that of the cheapest candidate are not raced. Zero disables pruning.
+    extern double internalQueryPlannerStatsPruningRatio;
+
+    // Maximum number of histogram buckets 'analyze' keeps per index.
+    extern int internalQueryAnalyzeMaxBuckets;
+
+    // A compound index whose leading field has at most this many distinct values, according to
+    // the statistics gathered by 'analyze', may be skip-scanned to answer predicates on its other
+    // fields. Zero disables skip scans.
+    extern int internalQueryPlannerMaxSkipScanPrefixes;
+
+    // Whether a fetch of several points in a unique index may look the keys up one by one and
+    // read the documents in RecordId order, when no sort is requested.
+    extern bool internalQueryPlannerEnablePointLookup;
+
+    // Whether predicates on the fields of a single-key btree index are applied to its keys,
+    // rather than to the documents fetched.
+    extern bool internalQueryPlannerPushDownKeyPredicates;
+
     //
     // plan cache
     //
@@ -61,6 +91,9 @@ namespace mongo {
     // How many entries in the cache?
     extern int internalQueryCacheSize;
 
+    // How many separately locked parts is each collection's cache split into?
+    extern int internalQueryCacheShards;
+
     // How many feedback entries do we collect before possibly evicting from the cache based on bad
     // performance?
     extern int internalQueryCacheFeedbacksStored;
@@ -72,6 +105,9 @@ namespace mongo {
     // How many write ops should we allow in a collection before tossing all cache entries?
     extern int internalQueryCacheWriteOpsBetweenFlush;
 
+    // How many bytes of results may the query result cache of one collection hold?
+    extern int internalQueryResultCacheMaxBytes;
+
     //
     // Planning and enumeration.
     //
@@ -98,10 +134,47 @@ namespace mongo {
 
     extern int internalQueryExecMaxBlockingSortBytes;
 
+    // Should a blocking sort that exceeds internalQueryExecMaxBlockingSortBytes spill to disk
+    // rather than fail?
+    extern bool internalQueryExecAllowBlockingSortSpill;
+
+    // Should collection scans and fetches compile their filters into a flat program?
+    extern bool internalQueryCompileMatchExpressions;
+
     // Yield after this many "should yield?" checks.
     extern int internalQueryExecYieldIterations;
 
     // Yield if it's been at least this many milliseconds since we last yielded.
     extern int internalQueryExecYieldPeriodMS;
 
+    // The most threads any one filter of a query may run on, whatever parallelism it asks for.
+    extern int internalQueryExecMaxParallelism;
+
+    // How many documents are matched at a time by each of those threads.
+    extern int internalQueryExecParallelMorselDocs;
+
+    // How many units of work the plan executor asks of the root stage at a time. At 1 or below
+    // the root is worked one result at a time.
+    extern int internalQueryExecBatchSize;
+
+    // The most bytes of results built ahead for a cursor with 'prefetchNextBatch' set, and how
+    // many threads build them.
+    extern int internalQueryCursorPrefetchMaxBytes;
+
+    extern int internalQueryCursorPrefetchThreads;
+
+    // The largest $limit of an aggregation $sort that no index provides which is still run as a
+    // top-k sort by the query, rather than by the pipeline. 0 disables the pushdown.
+    extern int internalQueryAggMaxPushedDownTopK;
+
+    // The largest part of a collection, as a fraction of its records, that an initial $sample
+    // reads from random records, where the storage engine can pick them. Larger samples, which
+    // would mostly find duplicates, come from a reservoir sample of a collection scan instead.
+    extern double internalQueryAggSampleMaxRandomCursorRatio;
+
+    // The most index keys a text query reads for its negated terms, so as to rule out the
+    // documents holding them without fetching those. Past this many, or at 0, the documents are
+    // fetched and matched for the negated terms instead.
+    extern int internalQueryTextMaxNegatedTermKeys;
+
 }  // namespace mongo
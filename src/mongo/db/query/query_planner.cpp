@@ -38,11 +38,14 @@
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/matcher/expression_text.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/index_stats.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
 #include "mongo/db/query/planner_ixselect.h"
+#include "mongo/db/query/plan_cost_estimator.h"
 #include "mongo/db/query/plan_enumerator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/util/log.h"
@@ -233,6 +236,17 @@ namespace mongo {
         return QueryPlannerAnalysis::analyzeDataAccess(query, params, solnRoot);
     }
 
+    QuerySolution* buildSkipScanSoln(const IndexEntry& index,
+                                     const CanonicalQuery& query,
+                                     const QueryPlannerParams& params) {
+
+        QuerySolutionNode* solnRoot = QueryPlannerAccess::makeSkipScan(index, query, params);
+        if (NULL == solnRoot) {
+            return NULL;
+        }
+        return QueryPlannerAnalysis::analyzeDataAccess(query, params, solnRoot);
+    }
+
     bool providesSort(const CanonicalQuery& query, const BSONObj& kp) {
         return query.getParsed().getSort().isPrefixOf(kp);
     }
@@ -364,6 +378,16 @@ namespace mongo {
                 return Status::OK();
             }
         }
+        else if (SolutionCacheData::SKIP_SCAN_SOLN == winnerCacheData.solnType) {
+            QuerySolution* soln = buildSkipScanSoln(*winnerCacheData.tree->entry, query, params);
+            if (soln == NULL) {
+                return Status(ErrorCodes::BadValue, "plan cache error: skip scan soln");
+            }
+            else {
+                *out = soln;
+                return Status::OK();
+            }
+        }
         else if (SolutionCacheData::COLLSCAN_SOLN == winnerCacheData.solnType) {
             // The cached solution is a collection scan. We don't cache collscans
             // with tailable==true, hence the false below.
@@ -898,6 +922,40 @@ namespace mongo {
             }
         }
 
+        // An index whose leading field has few distinct values can answer predicates on its
+        // other fields by seeking from one leading value to the next. Without statistics we
+        // don't know how many values there are, so such indexes are not considered.
+        const bool hadIndexedSolns = !out->empty();
+        if (internalQueryPlannerMaxSkipScanPrefixes > 0
+            && !QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR)
+            && !QueryPlannerCommon::hasNode(query.root(), MatchExpression::TEXT)) {
+            for (size_t i = 0; i < params.indices.size(); ++i) {
+                const IndexEntry& index = params.indices[i];
+                if (!index.stats || index.stats->getNumDistinct()
+                                    > internalQueryPlannerMaxSkipScanPrefixes) {
+                    continue;
+                }
+
+                QuerySolution* soln = buildSkipScanSoln(index, query, params);
+                if (NULL == soln) {
+                    continue;
+                }
+
+                LOG(5) << "Planner: outputting skip scan soln:" << endl << soln->toString();
+                PlanCacheIndexTree* indexTree = new PlanCacheIndexTree();
+                indexTree->setIndexEntry(index);
+                SolutionCacheData* scd = new SolutionCacheData();
+                scd->tree.reset(indexTree);
+                scd->solnType = SolutionCacheData::SKIP_SCAN_SOLN;
+
+                soln->cacheData.reset(scd);
+                out->push_back(soln);
+            }
+        }
+
+        // With index statistics, drop the indexed plans which are clearly worse than another.
+        PlanCostEstimator::pruneSolutions(query, params, out);
+
         // geoNear and text queries *require* an index.
         // Also, if a hint is specified it indicates that we MUST use it.
         bool possibleToCollscan = !QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR)
@@ -908,7 +966,8 @@ namespace mongo {
         bool collscanRequested = (params.options & QueryPlannerParams::INCLUDE_COLLSCAN);
 
         // No indexed plans?  We must provide a collscan if possible or else we can't run the query.
-        bool collscanNeeded = (0 == out->size() && canTableScan);
+        // A skip scan may read much of the index, so it also has to beat a collscan.
+        bool collscanNeeded = ((0 == out->size() || !hadIndexedSolns) && canTableScan);
 
         if (possibleToCollscan && (collscanRequested || collscanNeeded)) {
             QuerySolution* collscan = buildCollscanSoln(query, false, params);
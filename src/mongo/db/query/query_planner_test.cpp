@@ -34,6 +34,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
+#include "mongo/db/query/index_stats.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_test_fixture.h"
 
@@ -3468,4 +3469,289 @@ namespace {
         ASSERT_NOT_OK(s);
     }
 
+    //
+    // Pruning by index statistics
+    //
+
+    /**
+     * Stats for an index with one key for each of the values 0 .. 'numValues' - 1, except for
+     * 'value', which has 'repeats' keys.
+     */
+    std::shared_ptr<const IndexStats> makeStats(const BSONObj& keyPattern,
+                                                int numValues,
+                                                int value,
+                                                int repeats) {
+        IndexStats::Builder builder(100);
+        for (int i = 0; i < numValues; ++i) {
+            for (int j = 0; j < (i == value ? repeats : 1); ++j) {
+                builder.addKey(BSON("" << i));
+            }
+        }
+        return std::shared_ptr<const IndexStats>(builder.done(keyPattern));
+    }
+
+    TEST_F(QueryPlannerTest, StatsPruneUnselectiveIndex) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1));
+        params.indices.back().stats = makeStats(BSON("a" << 1), 20000, 1, 5);
+        addIndex(BSON("b" << 1));
+        params.indices.back().stats = makeStats(BSON("b" << 1), 20000, 1, 1);
+
+        runQuery(fromjson("{a: 1, b: {$gt: 1}}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {filter: {b: {$gt: 1}}, node: "
+                                "{ixscan: {filter: null, pattern: {a: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, StatsPruneIndexIntersection) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN | QueryPlannerParams::INDEX_INTERSECTION;
+        addIndex(BSON("a" << 1));
+        params.indices.back().stats = makeStats(BSON("a" << 1), 20000, 1, 5);
+        addIndex(BSON("b" << 1));
+        params.indices.back().stats = makeStats(BSON("b" << 1), 20000, 1, 1);
+
+        runQuery(fromjson("{a: 1, b: {$gt: 1}}"));
+
+        // Intersecting with the unselective index costs more than it saves.
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {filter: {b: {$gt: 1}}, node: "
+                                "{ixscan: {filter: null, pattern: {a: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, StatsKeepPlansWhichCannotBeEstimated) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1));
+        params.indices.back().stats = makeStats(BSON("a" << 1), 20000, 1, 5);
+        addIndex(BSON("b" << 1));
+
+        runQuery(fromjson("{a: 1, b: {$gt: 1}}"));
+
+        assertNumSolutions(2U);
+    }
+
+    TEST_F(QueryPlannerTest, StatsKeepPlansCheaperThanTrialPeriod) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1));
+        params.indices.back().stats = makeStats(BSON("a" << 1), 2000, 1, 5);
+        addIndex(BSON("b" << 1));
+        params.indices.back().stats = makeStats(BSON("b" << 1), 2000, 1, 1);
+
+        runQuery(fromjson("{a: 1, b: {$gt: 1}}"));
+
+        assertNumSolutions(2U);
+    }
+
+    TEST_F(QueryPlannerTest, StatsDoNotPruneSortedQueries) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1));
+        params.indices.back().stats = makeStats(BSON("a" << 1), 20000, 1, 5);
+        addIndex(BSON("b" << 1));
+        params.indices.back().stats = makeStats(BSON("b" << 1), 20000, 1, 1);
+
+        runQuerySortProj(fromjson("{a: 1, b: {$gt: 1}}"), BSON("b" << 1), BSONObj());
+
+        assertNumSolutions(2U);
+    }
+
+    //
+    // Skip scans
+    //
+
+    TEST_F(QueryPlannerTest, SkipScanLowCardinalityLeadingField) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("tenant" << 1 << "ts" << 1));
+        params.indices.back().stats = makeStats(BSON("tenant" << 1 << "ts" << 1), 10, 0, 1);
+
+        runQuery(fromjson("{ts: {$gt: 5}, x: 1}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {filter: {ts: {$gt: 5}, x: 1}, node: "
+                                "{skipScan: {pattern: {tenant: 1, ts: 1}, bounds: "
+                                    "{tenant: [['MinKey','MaxKey',true,true]], "
+                                    "ts: [[5,Infinity,false,true]]}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanIntersectsBoundsAndAlignsDescendingFields) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("tenant" << 1 << "ts" << -1 << "c" << 1));
+        params.indices.back().stats = makeStats(BSON("tenant" << 1 << "ts" << -1 << "c" << 1),
+                                                10, 0, 1);
+
+        runQuery(fromjson("{ts: {$gt: 5, $lte: 10}, c: {$in: [1, 2]}}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {node: "
+                                "{skipScan: {pattern: {tenant: 1, ts: -1, c: 1}, bounds: "
+                                    "{tenant: [['MinKey','MaxKey',true,true]], "
+                                    "ts: [[10,5,true,false]], "
+                                    "c: [[1,1,true,true], [2,2,true,true]]}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanRacesCollscan) {
+        addIndex(BSON("tenant" << 1 << "ts" << 1));
+        params.indices.back().stats = makeStats(BSON("tenant" << 1 << "ts" << 1), 10, 0, 1);
+
+        runQuery(fromjson("{ts: {$gt: 5}}"));
+
+        assertNumSolutions(2U);
+        assertSolutionExists("{cscan: {dir: 1, filter: {ts: {$gt: 5}}}}");
+        assertSolutionExists("{fetch: {filter: {ts: {$gt: 5}}, node: "
+                                "{skipScan: {pattern: {tenant: 1, ts: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanNotUsedWithoutStats) {
+        addIndex(BSON("tenant" << 1 << "ts" << 1));
+
+        runQuery(fromjson("{ts: {$gt: 5}}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{cscan: {dir: 1, filter: {ts: {$gt: 5}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanNotUsedForHighCardinalityLeadingField) {
+        addIndex(BSON("tenant" << 1 << "ts" << 1));
+        params.indices.back().stats = makeStats(BSON("tenant" << 1 << "ts" << 1), 1000, 0, 1);
+
+        runQuery(fromjson("{ts: {$gt: 5}}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{cscan: {dir: 1, filter: {ts: {$gt: 5}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanNotUsedWithLeadingFieldPredicate) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("tenant" << 1 << "ts" << 1));
+        params.indices.back().stats = makeStats(BSON("tenant" << 1 << "ts" << 1), 10, 0, 1);
+
+        runQuery(fromjson("{tenant: {$gt: 3}, ts: {$gt: 5}}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {node: {ixscan: {pattern: {tenant: 1, ts: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanNotUsedForMultikeyIndex) {
+        addIndex(BSON("tenant" << 1 << "ts" << 1), true);
+        params.indices.back().stats = makeStats(BSON("tenant" << 1 << "ts" << 1), 10, 0, 1);
+
+        runQuery(fromjson("{ts: {$gt: 5}}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{cscan: {dir: 1, filter: {ts: {$gt: 5}}}}");
+    }
+
+    //
+    // Point lookups
+    //
+
+    TEST_F(QueryPlannerTest, PointLookupForInOnUniqueIndex) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1),
+                 false, // multikey
+                 false, // sparse,
+                 true); // unique
+
+        runQuery(fromjson("{a: {$in: [3, 1, 2]}, b: 1}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{pointLookup: {pattern: {a: 1}, keys: [1, 2, 3], filter: {b: 1}}}");
+    }
+
+    TEST_F(QueryPlannerTest, PointLookupNotUsedWithSort) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1),
+                 false, // multikey
+                 false, // sparse,
+                 true); // unique
+
+        runQuerySortProj(fromjson("{a: {$in: [1, 2]}}"), BSON("a" << 1), BSONObj());
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {node: {ixscan: {pattern: {a: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, PointLookupNotUsedForNonUniqueIndex) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1));
+
+        runQuery(fromjson("{a: {$in: [1, 2]}}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {node: {ixscan: {pattern: {a: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, PointLookupNotUsedForSinglePoint) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1),
+                 false, // multikey
+                 false, // sparse,
+                 true); // unique
+
+        runQuery(fromjson("{a: {$in: [1]}}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {node: {ixscan: {pattern: {a: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, PointLookupNotUsedForRanges) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1),
+                 false, // multikey
+                 false, // sparse,
+                 true); // unique
+
+        runQuery(fromjson("{a: {$in: [1, /^x/]}}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {node: {ixscan: {pattern: {a: 1}}}}}");
+    }
+
+    //
+    // Predicates on index keys
+    //
+
+    TEST_F(QueryPlannerTest, KeyPredicatePushedDownForIndexedSort) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+
+        runQuerySortProj(fromjson("{b: 5}"), BSON("a" << 1), BSONObj());
+
+        assertNumSolutions(2U);
+        assertSolutionExists("{sort: {pattern: {a: 1}, limit: 0, node: "
+                                "{cscan: {dir: 1, filter: {b: 5}}}}}");
+        assertSolutionExists("{fetch: {filter: null, node: "
+                                "{ixscan: {filter: {b: 5}, pattern: {a: 1, b: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, KeyPredicatePushedDownLeavesOtherPredicates) {
+        params.options = QueryPlannerParams::NO_TABLE_SCAN;
+        addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+
+        runQuery(fromjson("{a: 5, $or: [{b: 1}, {c: 2}], d: 1}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {filter: {d: 1}, node: "
+                                "{ixscan: {filter: {$or: [{b: 1}, {c: 2}]}, "
+                                    "pattern: {a: 1, b: 1, c: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, KeyPredicateNotPushedDownForMultikeyIndex) {
+        addIndex(BSON("a" << 1 << "b" << 1), true);
+
+        runQuerySortProj(fromjson("{b: 5}"), BSON("a" << 1), BSONObj());
+
+        assertNumSolutions(2U);
+        assertSolutionExists("{fetch: {filter: {b: 5}, node: "
+                                "{ixscan: {filter: null, pattern: {a: 1, b: 1}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, KeyPredicateNotPushedDownForExists) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+
+        runQuerySortProj(fromjson("{b: {$exists: false}}"), BSON("a" << 1), BSONObj());
+
+        assertNumSolutions(2U);
+        assertSolutionExists("{fetch: {filter: {b: {$exists: false}}, node: "
+                                "{ixscan: {filter: null, pattern: {a: 1, b: 1}}}}}");
+    }
+
 }  // namespace
@@ -251,6 +251,66 @@ namespace mongo {
             }
             return filterMatches(filter.Obj(), trueSoln);
         }
+        else if (STAGE_SKIP_SCAN == trueSoln->getType()) {
+            const SkipScanNode* ssn = static_cast<const SkipScanNode*>(trueSoln);
+            BSONElement el = testSoln["skipScan"];
+            if (el.eoo() || !el.isABSONObj()) { return false; }
+            BSONObj skipScanObj = el.Obj();
+
+            BSONElement pattern = skipScanObj["pattern"];
+            if (pattern.eoo() || !pattern.isABSONObj()) { return false; }
+            if (pattern.Obj() != ssn->indexKeyPattern) { return false; }
+
+            BSONElement bounds = skipScanObj["bounds"];
+            if (!bounds.eoo()) {
+                if (!bounds.isABSONObj()) {
+                    return false;
+                }
+                else if (!boundsMatch(bounds.Obj(), ssn->bounds)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+        else if (STAGE_POINT_LOOKUP == trueSoln->getType()) {
+            // {pointLookup: {pattern: {_id: 1}, keys: [1, 2], filter: {...}}}
+            const PointLookupNode* pln = static_cast<const PointLookupNode*>(trueSoln);
+            BSONElement el = testSoln["pointLookup"];
+            if (el.eoo() || !el.isABSONObj()) { return false; }
+            BSONObj pointLookupObj = el.Obj();
+
+            BSONElement pattern = pointLookupObj["pattern"];
+            if (pattern.eoo() || !pattern.isABSONObj()) { return false; }
+            if (pattern.Obj() != pln->indexKeyPattern) { return false; }
+
+            BSONElement keys = pointLookupObj["keys"];
+            if (!keys.eoo()) {
+                if (Array != keys.type()) { return false; }
+                std::vector<BSONElement> expectedKeys = keys.Array();
+                if (expectedKeys.size() != pln->keys.size()) { return false; }
+                for (size_t i = 0; i < expectedKeys.size(); ++i) {
+                    if (0 != expectedKeys[i].woCompare(pln->keys[i].firstElement(), false)) {
+                        return false;
+                    }
+                }
+            }
+
+            BSONElement filter = pointLookupObj["filter"];
+            if (!filter.eoo()) {
+                if (filter.isNull()) {
+                    if (NULL != pln->filter) { return false; }
+                }
+                else if (!filter.isABSONObj()) {
+                    return false;
+                }
+                else if (!filterMatches(filter.Obj(), trueSoln)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
         else if (STAGE_GEO_NEAR_2D == trueSoln->getType()) {
             const GeoNear2DNode* node = static_cast<const GeoNear2DNode*>(trueSoln);
             BSONElement el = testSoln["geoNear2d"];
@@ -304,6 +364,13 @@ namespace mongo {
                 }
             }
 
+            BSONElement limitElt = textObj["limit"];
+            if (!limitElt.eoo()) {
+                if (!limitElt.isNumber() || size_t(limitElt.numberLong()) != node->limit) {
+                    return false;
+                }
+            }
+
             BSONElement filter = textObj["filter"];
             if (!filter.eoo()) {
                 if (filter.isNull()) {
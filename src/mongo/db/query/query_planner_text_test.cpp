@@ -340,4 +340,28 @@ namespace {
         assertSolutionExists("{text: {search: 'blah', caseSensitive: true}}");
     }
 
+    TEST_F(QueryPlannerTest, TextSortByScoreWithLimit) {
+        addIndex(BSON("_fts" << "text" << "_ftsx" << 1));
+        runQueryAsCommand(fromjson("{find: 'testns', filter: {$text: {$search: 'blah'}}, "
+                                   "sort: {s: {$meta: 'textScore'}}, "
+                                   "projection: {s: {$meta: 'textScore'}}, skip: 2, limit: 3}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{skip: {n: 2, node: {proj: {spec: {s: {$meta: 'textScore'}}, node: "
+                                "{sort: {pattern: {s: {$meta: 'textScore'}}, limit: 5, "
+                                    "node: {text: {search: 'blah', limit: 5}}}}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, TextSortByScoreAndFieldHasNoLimit) {
+        addIndex(BSON("_fts" << "text" << "_ftsx" << 1));
+        runQueryAsCommand(fromjson("{find: 'testns', filter: {$text: {$search: 'blah'}}, "
+                                   "sort: {s: {$meta: 'textScore'}, a: 1}, "
+                                   "projection: {s: {$meta: 'textScore'}}, limit: 3}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{proj: {spec: {s: {$meta: 'textScore'}}, node: "
+                                "{sort: {pattern: {s: {$meta: 'textScore'}, a: 1}, limit: 3, "
+                                    "node: {text: {search: 'blah', limit: 0}}}}}}");
+    }
+
 }  // namespace
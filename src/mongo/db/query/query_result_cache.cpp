@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_result_cache.h"
+
+#include <algorithm>
+
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_planner_common.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+namespace {
+
+    AtomicInt32 numResultCaches;
+
+    size_t resultsBytes(const QueryResultCache::Results& results) {
+        size_t bytes = 0;
+        for (const BSONObj& obj : results) {
+            bytes += obj.objsize();
+        }
+        return bytes;
+    }
+
+} // namespace
+
+    QueryResultCache::QueryResultCache()
+        : _generation(0),
+          _bytes(0),
+          _hits(0),
+          _misses(0) {
+        numResultCaches.fetchAndAdd(1);
+    }
+
+    QueryResultCache::~QueryResultCache() {
+        numResultCaches.fetchAndSubtract(1);
+    }
+
+    // static
+    int QueryResultCache::numCaches() {
+        return numResultCaches.load();
+    }
+
+    // static
+    bool QueryResultCache::canCache(const CanonicalQuery& query) {
+        const LiteParsedQuery& pq = query.getParsed();
+
+        // Tailable cursors are never done. For the others, the results must not depend on the
+        // plan (maxScan, returnKey, showRecordId) or on anything but the data ($where).
+        if (pq.isTailable() || pq.isExplain() || pq.getMaxScan() > 0 || pq.returnKey()
+                || pq.showRecordId()) {
+            return false;
+        }
+
+        return !QueryPlannerCommon::hasNode(query.root(), MatchExpression::WHERE);
+    }
+
+    // static
+    std::string QueryResultCache::makeKey(const CanonicalQuery& query) {
+        const LiteParsedQuery& pq = query.getParsed();
+
+        BSONObjBuilder bob;
+        {
+            BSONObjBuilder filterBob(bob.subobjStart("filter"));
+            query.root()->toBSON(&filterBob);
+        }
+        bob.append("projection", pq.getProj());
+        bob.append("sort", pq.getSort());
+        bob.append("hint", pq.getHint());
+        bob.append("min", pq.getMin());
+        bob.append("max", pq.getMax());
+        bob.append("skip", pq.getSkip());
+        bob.append("limit", pq.getLimit().value_or(0));
+        bob.append("snapshot", pq.isSnapshot());
+
+        const BSONObj key = bob.obj();
+        return std::string(key.objdata(), key.objsize());
+    }
+
+    uint64_t QueryResultCache::getGeneration() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _generation;
+    }
+
+    std::shared_ptr<const QueryResultCache::Results> QueryResultCache::get(
+            const std::string& key) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _index.find(key);
+        if (it == _index.end()) {
+            ++_misses;
+            return std::shared_ptr<const Results>();
+        }
+
+        ++_hits;
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return it->second->results;
+    }
+
+    void QueryResultCache::add(const std::string& key, uint64_t generation, Results results) {
+        const size_t bytes = key.size() + resultsBytes(results);
+        const size_t maxBytes = std::max(internalQueryResultCacheMaxBytes, 0);
+        if (bytes > maxBytes / 4) {
+            return;
+        }
+
+        auto shared = std::make_shared<const Results>(std::move(results));
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (generation != _generation) {
+            // Written to since the query started; its results may already be stale.
+            return;
+        }
+
+        auto it = _index.find(key);
+        if (it != _index.end()) {
+            _bytes -= it->second->bytes;
+            _entries.erase(it->second);
+            _index.erase(it);
+        }
+
+        while (!_entries.empty() && _bytes + bytes > maxBytes) {
+            _bytes -= _entries.back().bytes;
+            _index.erase(_entries.back().key);
+            _entries.pop_back();
+        }
+
+        _entries.push_front(Entry{key, std::move(shared), bytes});
+        _index[key] = _entries.begin();
+        _bytes += bytes;
+    }
+
+    void QueryResultCache::invalidate() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        ++_generation;
+        _entries.clear();
+        _index.clear();
+        _bytes = 0;
+    }
+
+    void QueryResultCache::appendStats(BSONObjBuilder* builder) const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        builder->appendNumber("entries", static_cast<long long>(_entries.size()));
+        builder->appendNumber("bytes", static_cast<long long>(_bytes));
+        builder->appendNumber("hits", _hits);
+        builder->appendNumber("misses", _misses);
+        const long long lookups = _hits + _misses;
+        builder->append("hitRatio", lookups ? static_cast<double>(_hits) / lookups : 0.0);
+    }
+
+} // namespace mongo
@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+    class CanonicalQuery;
+
+    /**
+     * Caches the complete results of queries against one collection, keyed by the canonical form
+     * of the query.  Only collections with the 'queryResultCache' option have one.  Bounded by
+     * internalQueryResultCacheMaxBytes, evicting the least recently used entries first.
+     *
+     * Any write to the collection drops every entry, see invalidate().  A query may read from a
+     * snapshot taken before a concurrent write committed, so it reads getGeneration() before it
+     * reads any data, and its results are only added if there was no invalidation since.
+     *
+     * Thread safe.
+     */
+    class QueryResultCache {
+        MONGO_DISALLOW_COPYING(QueryResultCache);
+    public:
+        typedef std::vector<BSONObj> Results;
+
+        QueryResultCache();
+        ~QueryResultCache();
+
+        /**
+         * The number of QueryResultCaches in existence, so that writes to collections without one
+         * need not look for it.
+         */
+        static int numCaches();
+
+        /**
+         * Can the results of 'query' be cached? Only those of queries whose results depend on
+         * nothing but the documents in the collection can.
+         */
+        static bool canCache(const CanonicalQuery& query);
+
+        /**
+         * The key under which the results of 'query', which must be cacheable, are cached.
+         */
+        static std::string makeKey(const CanonicalQuery& query);
+
+        uint64_t getGeneration() const;
+
+        /**
+         * Returns the results cached under 'key', or NULL if there are none. Counts a hit or a
+         * miss.
+         */
+        std::shared_ptr<const Results> get(const std::string& key);
+
+        /**
+         * Caches 'results' under 'key', unless the cache was invalidated after 'generation' was
+         * read, or they would take up more than a quarter of the cache.
+         */
+        void add(const std::string& key, uint64_t generation, Results results);
+
+        /**
+         * Drops all entries and starts a new generation.
+         */
+        void invalidate();
+
+        /**
+         * Appends the number of entries, their size, and the hit and miss counts and ratio.
+         */
+        void appendStats(BSONObjBuilder* builder) const;
+
+    private:
+        struct Entry {
+            std::string key;
+            std::shared_ptr<const Results> results;
+            size_t bytes;
+        };
+        typedef std::list<Entry> EntryList;
+
+        // Protects everything below.
+        mutable stdx::mutex _mutex;
+
+        uint64_t _generation;
+
+        // Most recently used first.
+        EntryList _entries;
+        std::unordered_map<std::string, EntryList::iterator> _index;
+        size_t _bytes;
+
+        long long _hits;
+        long long _misses;
+    };
+
+} // namespace mongo
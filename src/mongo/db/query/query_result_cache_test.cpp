@@ -0,0 +1,172 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/query_result_cache.h
+ */
+
+#include "mongo/db/query/query_result_cache.h"
+
+#include <memory>
+
+#include "mongo/db/json.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+using namespace mongo;
+
+namespace {
+
+    static const char* ns = "somebogusns";
+
+    std::unique_ptr<CanonicalQuery> canonicalize(const char* queryStr,
+                                                 const char* sortStr = "{}",
+                                                 const char* projStr = "{}") {
+        CanonicalQuery* cq;
+        Status result = CanonicalQuery::canonicalize(ns,
+                                                     fromjson(queryStr),
+                                                     fromjson(sortStr),
+                                                     fromjson(projStr),
+                                                     &cq);
+        ASSERT_OK(result);
+        return std::unique_ptr<CanonicalQuery>(cq);
+    }
+
+    std::string makeKey(const char* queryStr,
+                        const char* sortStr = "{}",
+                        const char* projStr = "{}") {
+        return QueryResultCache::makeKey(*canonicalize(queryStr, sortStr, projStr));
+    }
+
+    QueryResultCache::Results makeResults(int n) {
+        QueryResultCache::Results results;
+        for (int i = 0; i < n; ++i) {
+            results.push_back(BSON("_id" << i));
+        }
+        return results;
+    }
+
+    TEST(QueryResultCacheTest, KeyIsCanonical) {
+        ASSERT_EQUALS(makeKey("{a: 1, b: 2}"), makeKey("{b: 2, a: 1}"));
+        ASSERT_EQUALS(makeKey("{$and: [{a: 1}, {b: 2}]}"), makeKey("{a: 1, b: 2}"));
+        ASSERT_NOT_EQUALS(makeKey("{a: 1}"), makeKey("{a: 2}"));
+        ASSERT_NOT_EQUALS(makeKey("{a: 1}"), makeKey("{a: '1'}"));
+        ASSERT_NOT_EQUALS(makeKey("{a: 1}"), makeKey("{a: 1}", "{b: 1}"));
+        ASSERT_NOT_EQUALS(makeKey("{a: 1}"), makeKey("{a: 1}", "{}", "{b: 1}"));
+    }
+
+    TEST(QueryResultCacheTest, CanCache) {
+        ASSERT_TRUE(QueryResultCache::canCache(*canonicalize("{a: 1}")));
+
+        CanonicalQuery* cq;
+        ASSERT_OK(CanonicalQuery::canonicalize(ns, fromjson("{a: 1}"), true /* explain */, &cq));
+        std::unique_ptr<CanonicalQuery> explain(cq);
+        ASSERT_FALSE(QueryResultCache::canCache(*explain));
+    }
+
+    TEST(QueryResultCacheTest, HitAndMiss) {
+        QueryResultCache cache;
+        const std::string key = makeKey("{a: 1}");
+
+        ASSERT_FALSE(cache.get(key));
+        cache.add(key, cache.getGeneration(), makeResults(3));
+
+        std::shared_ptr<const QueryResultCache::Results> results = cache.get(key);
+        ASSERT_TRUE(results);
+        ASSERT_EQUALS(3U, results->size());
+        ASSERT_EQUALS(BSON("_id" << 2), (*results)[2]);
+
+        BSONObjBuilder bob;
+        cache.appendStats(&bob);
+        BSONObj stats = bob.obj();
+        ASSERT_EQUALS(1, stats["entries"].numberLong());
+        ASSERT_EQUALS(1, stats["hits"].numberLong());
+        ASSERT_EQUALS(1, stats["misses"].numberLong());
+        ASSERT_EQUALS(0.5, stats["hitRatio"].numberDouble());
+    }
+
+    TEST(QueryResultCacheTest, InvalidateDropsEntries) {
+        QueryResultCache cache;
+        const std::string key = makeKey("{a: 1}");
+        cache.add(key, cache.getGeneration(), makeResults(3));
+        cache.invalidate();
+        ASSERT_FALSE(cache.get(key));
+    }
+
+    TEST(QueryResultCacheTest, StaleResultsAreNotAdded) {
+        QueryResultCache cache;
+        const std::string key = makeKey("{a: 1}");
+
+        // A write committed while the query ran.
+        const uint64_t generation = cache.getGeneration();
+        cache.invalidate();
+        cache.add(key, generation, makeResults(3));
+        ASSERT_FALSE(cache.get(key));
+    }
+
+    TEST(QueryResultCacheTest, EvictsLeastRecentlyUsed) {
+        const int oldMaxBytes = internalQueryResultCacheMaxBytes;
+        ON_BLOCK_EXIT([oldMaxBytes] { internalQueryResultCacheMaxBytes = oldMaxBytes; });
+
+        const std::string key1 = makeKey("{a: 1}");
+        const std::string key2 = makeKey("{a: 2}");
+        const std::string key3 = makeKey("{a: 3}");
+        const std::string key4 = makeKey("{a: 4}");
+        const size_t entryBytes = key1.size() + makeResults(10).size() * BSON("_id" << 0).objsize();
+
+        // Room for four entries, each of them a quarter of the cache.
+        internalQueryResultCacheMaxBytes = 4 * entryBytes + entryBytes / 2;
+        QueryResultCache cache;
+        cache.add(key1, cache.getGeneration(), makeResults(10));
+        cache.add(key2, cache.getGeneration(), makeResults(10));
+        cache.add(key3, cache.getGeneration(), makeResults(10));
+        cache.add(key4, cache.getGeneration(), makeResults(10));
+
+        // Using key1 makes key2 the least recently used, evicted for the fifth entry.
+        ASSERT_TRUE(cache.get(key1));
+        cache.add(makeKey("{a: 5}"), cache.getGeneration(), makeResults(10));
+        ASSERT_TRUE(cache.get(key1));
+        ASSERT_FALSE(cache.get(key2));
+        ASSERT_TRUE(cache.get(key3));
+        ASSERT_TRUE(cache.get(key4));
+    }
+
+    TEST(QueryResultCacheTest, LargeResultsAreNotAdded) {
+        const int oldMaxBytes = internalQueryResultCacheMaxBytes;
+        ON_BLOCK_EXIT([oldMaxBytes] { internalQueryResultCacheMaxBytes = oldMaxBytes; });
+
+        internalQueryResultCacheMaxBytes = 1024;
+        QueryResultCache cache;
+        const std::string key = makeKey("{a: 1}");
+        cache.add(key, cache.getGeneration(), makeResults(100));
+        ASSERT_FALSE(cache.get(key));
+    }
+
+} // namespace
@@ -80,6 +80,10 @@ namespace mongo {
         *ss << "caseSensitive= " << caseSensitive << '\n';
         addIndent(ss, indent + 1);
         *ss << "indexPrefix = " << indexPrefix.toString() << '\n';
+        if (limit) {
+            addIndent(ss, indent + 1);
+            *ss << "limit = " << limit << '\n';
+        }
         if (NULL != filter) {
             addIndent(ss, indent + 1);
             *ss << " filter = " << filter->toString();
@@ -97,6 +101,7 @@ namespace mongo {
         copy->language = this->language;
         copy->caseSensitive = this->caseSensitive;
         copy->indexPrefix = this->indexPrefix;
+        copy->limit = this->limit;
 
         return copy;
     }
@@ -392,6 +397,38 @@ namespace mongo {
         return copy;
     }
 
+    //
+    // PointLookupNode
+    //
+
+    void PointLookupNode::appendToString(mongoutils::str::stream* ss, int indent) const {
+        addIndent(ss, indent);
+        *ss << "POINT_LOOKUP\n";
+        addIndent(ss, indent + 1);
+        *ss << "keyPattern = " << indexKeyPattern << '\n';
+        addIndent(ss, indent + 1);
+        *ss << "numKeys = " << keys.size() << '\n';
+        if (NULL != filter) {
+            addIndent(ss, indent + 1);
+            StringBuilder sb;
+            *ss << "filter:\n";
+            filter->debugString(sb, indent + 2);
+            *ss << sb.str();
+        }
+        addCommon(ss, indent);
+    }
+
+    QuerySolutionNode* PointLookupNode::clone() const {
+        PointLookupNode* copy = new PointLookupNode();
+        cloneBaseData(copy);
+
+        copy->_sorts = this->_sorts;
+        copy->indexKeyPattern = this->indexKeyPattern;
+        copy->keys = this->keys;
+
+        return copy;
+    }
+
     //
     // IndexScanNode
     //
@@ -846,6 +883,33 @@ namespace mongo {
         return copy;
     }
 
+    //
+    // SkipScanNode
+    //
+
+    void SkipScanNode::appendToString(mongoutils::str::stream* ss, int indent) const {
+        addIndent(ss, indent);
+        *ss << "SKIP_SCAN\n";
+        addIndent(ss, indent + 1);
+        *ss << "keyPattern = " << indexKeyPattern << '\n';
+        addIndent(ss, indent + 1);
+        *ss << "direction = " << direction << '\n';
+        addIndent(ss, indent + 1);
+        *ss << "bounds = " << bounds.toString() << '\n';
+    }
+
+    QuerySolutionNode* SkipScanNode::clone() const {
+        SkipScanNode* copy = new SkipScanNode();
+        cloneBaseData(copy);
+
+        copy->sorts = this->sorts;
+        copy->indexKeyPattern = this->indexKeyPattern;
+        copy->direction = this->direction;
+        copy->bounds = this->bounds;
+
+        return copy;
+    }
+
     //
     // CountNode
     //
@@ -855,10 +919,20 @@ namespace mongo {
         *ss << "COUNT\n";
         addIndent(ss, indent + 1);
         *ss << "keyPattern = " << indexKeyPattern << '\n';
-        addIndent(ss, indent + 1);
-        *ss << "startKey = " << startKey << '\n';
-        addIndent(ss, indent + 1);
-        *ss << "endKey = " << endKey << '\n';
+        if (useBounds) {
+            addIndent(ss, indent + 1);
+            *ss << "bounds = " << bounds.toString() << '\n';
+        }
+        else {
+            addIndent(ss, indent + 1);
+            *ss << "startKey = " << startKey << '\n';
+            addIndent(ss, indent + 1);
+            *ss << "endKey = " << endKey << '\n';
+        }
+        if (NULL != filter) {
+            addIndent(ss, indent + 1);
+            *ss << " filter = " << filter->toString() << '\n';
+        }
     }
 
     QuerySolutionNode* CountNode::clone() const {
@@ -871,6 +945,9 @@ namespace mongo {
         copy->startKeyInclusive = this->startKeyInclusive;
         copy->endKey = this->endKey;
         copy->endKeyInclusive = this->endKeyInclusive;
+        copy->useBounds = this->useBounds;
+        copy->bounds = this->bounds;
+        copy->direction = this->direction;
 
         return copy;
     }
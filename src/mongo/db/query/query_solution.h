@@ -217,7 +217,7 @@ namespace mongo {
     };
 
     struct TextNode : public QuerySolutionNode {
-        TextNode() { }
+        TextNode() : limit(0) { }
         virtual ~TextNode() { }
 
         virtual StageType getType() const { return STAGE_TEXT; }
@@ -244,6 +244,10 @@ namespace mongo {
         // text node while creating the text leaf node and convert them into a BSONObj index prefix
         // when we finish the text leaf node.
         BSONObj indexPrefix;
+
+        // If nonzero, only this many documents with the highest text scores are needed, as the
+        // node feeds a sort by text score with this limit.
+        size_t limit;
     };
 
     struct CollectionScanNode : public QuerySolutionNode {
@@ -383,6 +387,34 @@ namespace mongo {
         BSONObjSet _sorts;
     };
 
+    /**
+     * Replaces a FETCH over an IXSCAN of point intervals in a unique index, which is what
+     * {_id: {$in: [...]}} is planned as.  Looks each key up in the index, then fetches the
+     * documents found in RecordId order.
+     */
+    struct PointLookupNode : public QuerySolutionNode {
+        PointLookupNode() { }
+        virtual ~PointLookupNode() { }
+
+        virtual StageType getType() const { return STAGE_POINT_LOOKUP; }
+
+        virtual void appendToString(mongoutils::str::stream* ss, int indent) const;
+
+        bool fetched() const { return true; }
+        bool hasField(const std::string& field) const { return true; }
+        bool sortedByDiskLoc() const { return true; }
+        const BSONObjSet& getSort() const { return _sorts; }
+
+        QuerySolutionNode* clone() const;
+
+        BSONObjSet _sorts;
+
+        BSONObj indexKeyPattern;
+
+        // The keys to look up, in index order and without field names.
+        std::vector<BSONObj> keys;
+    };
+
     struct IndexScanNode : public QuerySolutionNode {
         IndexScanNode();
         virtual ~IndexScanNode() { }
@@ -699,12 +731,42 @@ namespace mongo {
         int fieldNo;
     };
 
+    /**
+     * Queries with predicates only on the trailing fields of a compound index can seek through
+     * the distinct values of its leading field, scanning the trailing bounds within each.
+     */
+    struct SkipScanNode : public QuerySolutionNode {
+        SkipScanNode() : direction(1) { }
+        virtual ~SkipScanNode() { }
+
+        virtual StageType getType() const { return STAGE_SKIP_SCAN; }
+        virtual void appendToString(mongoutils::str::stream* ss, int indent) const;
+
+        // This stage is created "on top" of normal planning, always beneath a FETCH which
+        // applies the whole query, so the properties below don't really matter.
+        bool fetched() const { return false; }
+        bool hasField(const std::string& field) const { return !indexKeyPattern[field].eoo(); }
+        bool sortedByDiskLoc() const { return false; }
+        const BSONObjSet& getSort() const { return sorts; }
+
+        QuerySolutionNode* clone() const;
+
+        BSONObjSet sorts;
+
+        BSONObj indexKeyPattern;
+        int direction;
+        IndexBounds bounds;
+    };
+
     /**
      * Some count queries reduce to counting how many keys are between two entries in a
-     * Btree.
+     * Btree, or within index bounds, that match a filter on the index key fields only.
      */
     struct CountNode : public QuerySolutionNode {
-        CountNode() { }
+        CountNode() : startKeyInclusive(true),
+                      endKeyInclusive(true),
+                      useBounds(false),
+                      direction(1) { }
         virtual ~CountNode() { }
 
         virtual StageType getType() const { return STAGE_COUNT_SCAN; }
@@ -726,6 +788,11 @@ namespace mongo {
 
         BSONObj endKey;
         bool endKeyInclusive;
+
+        // If set, 'bounds' are counted instead of the range from 'startKey' to 'endKey'.
+        bool useBounds;
+        IndexBounds bounds;
+        int direction;
     };
 
 }  // namespace mongo
@@ -30,9 +30,11 @@
 
 #include "mongo/db/query/query_yield.h"
 
+#include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/storage/record_fetcher.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -66,10 +68,25 @@ namespace mongo {
         CurOp::get(txn)->yielded();
 
         if (fetcher) {
+            // The fetcher touches a record the storage engine expects isn't in memory, so
+            // counts as a page read from disk and the time spent waiting on it.
+            Timer t;
             fetcher->fetch();
+            RecoveryUnit::StorageStats* storageStats = txn->recoveryUnit()->storageStats();
+            storageStats->pagesRead++;
+            storageStats->cacheWaitMicros += t.micros();
         }
 
+        if (!locker->readsFromBatchBoundarySnapshot()) {
+            locker->restoreLockState(snapshot);
+            return;
+        }
+
+        // Keep replication batches out only until the new snapshot is open, so that it is taken
+        // between two batches as well.
+        Lock::ResourceLock pbwm(locker, resourceIdParallelBatchWriterMode, MODE_IS);
         locker->restoreLockState(snapshot);
+        txn->recoveryUnit()->preallocateSnapshot(txn);
     }
 
 } // namespace mongo
@@ -43,10 +43,13 @@
 #include "mongo/db/exec/limit.h"
 #include "mongo/db/exec/merge_sort.h"
 #include "mongo/db/exec/or.h"
+#include "mongo/db/exec/parallel_filter.h"
+#include "mongo/db/exec/point_lookup.h"
 #include "mongo/db/exec/projection.h"
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/sort.h"
 #include "mongo/db/exec/skip.h"
+#include "mongo/db/exec/skip_scan.h"
 #include "mongo/db/exec/text.h"
 #include "mongo/db/index/fts_access_method.h"
 #include "mongo/db/catalog/collection.h"
@@ -70,6 +73,13 @@ namespace mongo {
             params.direction = (csn->direction == 1) ? CollectionScanParams::FORWARD
                                                      : CollectionScanParams::BACKWARD;
             params.maxScan = csn->maxScan;
+
+            const size_t degree = ParallelFilterStage::getDegree(txn);
+            if (degree > 1 && !csn->tailable && csn->filter
+                && ParallelFilterStage::canRunInParallel(csn->filter.get())) {
+                PlanStage* scan = new CollectionScan(txn, params, ws, NULL);
+                return new ParallelFilterStage(ws, scan, csn->filter.get(), collection, degree);
+            }
             return new CollectionScan(txn, params, ws, csn->filter.get());
         }
         else if (STAGE_IXSCAN == root->getType()) {
@@ -96,10 +106,43 @@ namespace mongo {
             params.addKeyMetadata = ixn->addKeyMetadata;
             return new IndexScan(txn, params, ws, ixn->filter.get());
         }
+        else if (STAGE_POINT_LOOKUP == root->getType()) {
+            const PointLookupNode* pln = static_cast<const PointLookupNode*>(root);
+
+            if (NULL == collection) {
+                warning() << "Can't look up keys in null namespace";
+                return NULL;
+            }
+
+            PointLookupParams params;
+            params.collection = collection;
+            params.descriptor =
+                collection->getIndexCatalog()->findIndexByKeyPattern(txn, pln->indexKeyPattern);
+            if (NULL == params.descriptor) {
+                warning() << "Can't find index " << pln->indexKeyPattern.toString()
+                          << "in namespace " << collection->ns() << endl;
+                return NULL;
+            }
+            params.keys = pln->keys;
+            return new PointLookupStage(txn, params, ws, pln->filter.get());
+        }
         else if (STAGE_FETCH == root->getType()) {
             const FetchNode* fn = static_cast<const FetchNode*>(root);
             PlanStage* childStage = buildStages(txn, collection, qsol, fn->children[0], ws);
             if (NULL == childStage) { return NULL; }
+
+            // A hashed AND whose results we fetch and that has no filter of its own doesn't need
+            // the index keys of its children, so it can keep only RecordIds when they get large.
+            if (STAGE_AND_HASH == fn->children[0]->getType() && !fn->children[0]->filter) {
+                static_cast<AndHashStage*>(childStage)->allowCompactBuildSide();
+            }
+
+            const size_t degree = ParallelFilterStage::getDegree(txn);
+            if (degree > 1 && fn->filter
+                && ParallelFilterStage::canRunInParallel(fn->filter.get())) {
+                PlanStage* fetch = new FetchStage(txn, ws, childStage, NULL, collection);
+                return new ParallelFilterStage(ws, fetch, fn->filter.get(), collection, degree);
+            }
             return new FetchStage(txn, ws, childStage, fn->filter.get(), collection);
         }
         else if (STAGE_SORT == root->getType()) {
@@ -259,6 +302,7 @@ namespace mongo {
             params.index = index;
             params.spec = fam->getSpec();
             params.indexPrefix = node->indexPrefix;
+            params.limit = node->limit;
 
             const std::string& language = ("" == node->language
                                            ? fam->getSpec().defaultLanguage().str()
@@ -305,6 +349,27 @@ namespace mongo {
             params.fieldNo = dn->fieldNo;
             return new DistinctScan(txn, params, ws);
         }
+        else if (STAGE_SKIP_SCAN == root->getType()) {
+            const SkipScanNode* ssn = static_cast<const SkipScanNode*>(root);
+
+            if (NULL == collection) {
+                warning() << "Can't skip-scan null namespace";
+                return NULL;
+            }
+
+            SkipScanParams params;
+
+            params.descriptor =
+                collection->getIndexCatalog()->findIndexByKeyPattern(txn, ssn->indexKeyPattern);
+            if (NULL == params.descriptor) {
+                warning() << "Can't find index " << ssn->indexKeyPattern.toString()
+                          << "in namespace " << collection->ns() << endl;
+                return NULL;
+            }
+            params.direction = ssn->direction;
+            params.bounds = ssn->bounds;
+            return new SkipScan(txn, params, ws);
+        }
         else if (STAGE_COUNT_SCAN == root->getType()) {
             const CountNode* cn = static_cast<const CountNode*>(root);
 
@@ -321,6 +386,10 @@ namespace mongo {
             params.startKeyInclusive = cn->startKeyInclusive;
             params.endKey = cn->endKey;
             params.endKeyInclusive = cn->endKeyInclusive;
+            params.useBounds = cn->useBounds;
+            params.bounds = cn->bounds;
+            params.direction = cn->direction;
+            params.filter = cn->filter.get();
 
             return new CountScan(txn, params, ws);
         }
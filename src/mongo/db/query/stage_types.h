@@ -81,14 +81,26 @@ namespace mongo {
         STAGE_MULTI_PLAN,
         STAGE_OPLOG_START,
         STAGE_OR,
+
+        // Matches the results of its child against a filter on several threads.
+        STAGE_PARALLEL_FILTER,
+
         STAGE_PROJECTION,
 
         // Stage for running aggregation pipelines.
         STAGE_PIPELINE_PROXY,
 
+        // Looks up a set of keys in a unique index and fetches the documents found.
+        STAGE_POINT_LOOKUP,
+
         STAGE_QUEUED_DATA,
         STAGE_SHARDING_FILTER,
         STAGE_SKIP,
+
+        // Answers predicates on the trailing fields of a compound index by seeking through the
+        // distinct values of its leading field.
+        STAGE_SKIP_SCAN,
+
         STAGE_SORT,
         STAGE_SORT_MERGE,
         STAGE_SUBPLAN,
@@ -38,6 +38,7 @@
 #include "mongo/db/client.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/util/concurrency/synchronization.h"
 #include "mongo/util/exit.h"
@@ -79,6 +80,8 @@ namespace mongo {
 
     namespace duration = boost::posix_time;
 
+    MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterWorkers, int, 1);
+
     static void logCursorsWaiting(RangeDeleteEntry* entry) {
 
         // We always log the first cursors waiting message (so we have cursor ids in the logs).
@@ -192,8 +195,12 @@ namespace mongo {
     }
 
     void RangeDeleter::startWorkers() {
-        if (!_worker) {
-            _worker.reset(new boost::thread(stdx::bind(&RangeDeleter::doWork, this)));
+        if (_workers.empty()) {
+            const int numWorkers = std::max(rangeDeleterWorkers, 1);
+            for (int i = 0; i < numWorkers; i++) {
+                _workers.emplace_back(
+                        new boost::thread(stdx::bind(&RangeDeleter::doWork, this)));
+            }
         }
     }
 
@@ -203,8 +210,8 @@ namespace mongo {
             _stopRequested = true;
         }
 
-        if (_worker) {
-            _worker->join();
+        for (size_t i = 0; i < _workers.size(); i++) {
+            _workers[i]->join();
         }
 
         boost::unique_lock<boost::mutex> sl(_queueMutex);
@@ -454,7 +461,8 @@ namespace {
 
             {
                 boost::unique_lock<boost::mutex> sl(_queueMutex);
-                while (_taskQueue.empty()) {
+                TaskList::iterator taskIter;
+                while ((taskIter = findReadyTask_inlock()) == _taskQueue.end()) {
                     _taskQueueNotEmptyCV.timed_wait(
                         sl, duration::milliseconds(kNotEmptyTimeoutMillis));
 
@@ -463,7 +471,7 @@ namespace {
                         return;
                     }
 
-                    if (_taskQueue.empty()) {
+                    if (findReadyTask_inlock() == _taskQueue.end()) {
                         // Try to check if some deletes are ready and move them to the
                         // ready queue.
 
@@ -508,9 +516,10 @@ namespace {
                     return;
                 }
 
-                nextTask = _taskQueue.front();
-                _taskQueue.pop_front();
+                nextTask = *taskIter;
+                _taskQueue.erase(taskIter);
 
+                _nsInProgress.insert(nextTask->options.range.ns);
                 _deletesInProgress++;
             }
 
@@ -547,6 +556,10 @@ namespace {
                 deletePtrElement(&_deleteSet, &setEntry);
                 _deletesInProgress--;
 
+                // Any queued task for this namespace can go to an idle worker now.
+                _nsInProgress.erase(nextTask->options.range.ns);
+                _taskQueueNotEmptyCV.notify_all();
+
                 if (nextTask->notifyDone) {
                     nextTask->notifyDone->notifyOne();
                 }
@@ -558,6 +571,14 @@ namespace {
         }
     }
 
+    RangeDeleter::TaskList::iterator RangeDeleter::findReadyTask_inlock() {
+        TaskList::iterator iter = _taskQueue.begin();
+        while (iter != _taskQueue.end() && _nsInProgress.count((*iter)->options.range.ns)) {
+            ++iter;
+        }
+        return iter;
+    }
+
     bool RangeDeleter::canEnqueue_inlock(StringData ns,
                                          const BSONObj& min,
                                          const BSONObj& max,
@@ -593,6 +614,28 @@ namespace {
         return _deletesInProgress;
     }
 
+    size_t RangeDeleter::getNumWorkers() const {
+        return _workers.size();
+    }
+
+    Date_t RangeDeleter::getOldestPendingQueueStart() const {
+        boost::lock_guard<boost::mutex> sl(_queueMutex);
+        Date_t oldest;
+        for (TaskList::const_iterator iter = _notReadyQueue.begin();
+                iter != _notReadyQueue.end(); ++iter) {
+            if (oldest == Date_t() || (*iter)->stats.queueStartTS < oldest) {
+                oldest = (*iter)->stats.queueStartTS;
+            }
+        }
+        for (TaskList::const_iterator iter = _taskQueue.begin();
+                iter != _taskQueue.end(); ++iter) {
+            if (oldest == Date_t() || (*iter)->stats.queueStartTS < oldest) {
+                oldest = (*iter)->stats.queueStartTS;
+            }
+        }
+        return oldest;
+    }
+
     void RangeDeleter::recordDelStats(DeleteJobStats* newStat) {
         boost::lock_guard<boost::mutex> sl(_statsHistoryMutex);
         if (_statsHistory.size() == kDeleteJobsHistory) {
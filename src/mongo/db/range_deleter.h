@@ -52,6 +52,9 @@ namespace mongo {
     struct RangeDeleterEnv;
     struct RangeDeleterOptions;
 
+    // How many worker threads startWorkers starts.
+    extern int rangeDeleterWorkers;
+
     /**
      * Class for deleting documents for a given namespace and range.  It contains a queue of
      * jobs to be deleted. Deletions can be "immediate", in which case they are going to be put
@@ -60,9 +63,11 @@ namespace mongo {
      *
      * Threading assumptions:
      *
-     *   This class has (currently) one worker thread attacking the queue, one
-     *   job at a time. If we want an immediate deletion, that job is going to
-     *   be performed on the thread that is requesting it.
+     *   This class has rangeDeleterWorkers worker threads attacking the queue, each
+     *   working on one job at a time. Jobs for the same namespace are never worked on
+     *   by two workers at once, so workers only run in parallel across collections. If
+     *   we want an immediate deletion, that job is going to be performed on the thread
+     *   that is requesting it.
      *
      *   All calls regarding deletion are synchronized.
      *
@@ -95,8 +100,8 @@ namespace mongo {
         //
 
         /**
-         * Starts the background thread to work on this queue. Does nothing if the worker
-         * thread is already active.
+         * Starts the background threads to work on this queue. Does nothing if the worker
+         * threads are already active.
          *
          * This call is _not_ thread safe and must be issued before any other call.
          */
@@ -162,6 +167,15 @@ namespace mongo {
         size_t getPendingDeletes() const;
         size_t getDeletesInProgress() const;
 
+        /** Returns the number of worker threads started by startWorkers. */
+        size_t getNumWorkers() const;
+
+        /**
+         * Returns when the longest waiting of the pending deletes was queued, or Date_t() if
+         * there are none.
+         */
+        Date_t getOldestPendingQueueStart() const;
+
         //
         // Methods meant to be only used for testing. Should be treated like private
         // methods.
@@ -185,9 +199,15 @@ namespace mongo {
 
         typedef std::set<NSMinMax*, NSMinMaxCmp> NSMinMaxSet; // owned here
 
-        /** Body of the worker thread */
+        /** Body of the worker threads */
         void doWork();
 
+        /**
+         * Returns the first task of _taskQueue whose namespace no worker is deleting from,
+         * or _taskQueue.end() if there is none.
+         */
+        TaskList::iterator findReadyTask_inlock();
+
         /** Returns true if the range doesn't intersect with one other range */
         bool canEnqueue_inlock(StringData ns,
                                const BSONObj& min,
@@ -200,7 +220,7 @@ namespace mongo {
         std::unique_ptr<RangeDeleterEnv> _env;
 
         // Initially not active. Must be started explicitly.
-        std::unique_ptr<boost::thread> _worker;
+        std::vector<std::unique_ptr<boost::thread>> _workers;
 
         // Protects _stopRequested.
         mutable mutex _stopMutex;
@@ -239,6 +259,10 @@ namespace mongo {
         // Keeps track of number of tasks that are in progress, including the inline deletes.
         size_t _deletesInProgress;
 
+        // Namespaces the workers are currently deleting from. Does not include the inline
+        // deletes.
+        std::set<std::string> _nsInProgress;
+
         // Protects _statsHistory
         mutable mutex _statsHistoryMutex;
         std::deque<DeleteJobStats*> _statsHistory;
@@ -404,4 +404,133 @@ namespace {
 
     }
 
+    // Sets the number of workers the deleters started by a test have.
+    class WorkersSetting {
+    public:
+        explicit WorkersSetting(int numWorkers): _oldNumWorkers(mongo::rangeDeleterWorkers) {
+            mongo::rangeDeleterWorkers = numWorkers;
+        }
+
+        ~WorkersSetting() {
+            mongo::rangeDeleterWorkers = _oldNumWorkers;
+        }
+
+    private:
+        const int _oldNumWorkers;
+    };
+
+    // Tests that deletes from different collections are worked on at the same time.
+    TEST(MultipleWorkers, DeletesAcrossCollections) {
+        WorkersSetting workersSetting(2);
+
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+
+        std::unique_ptr<mongo::repl::ReplicationCoordinatorMock> mock(
+            new mongo::repl::ReplicationCoordinatorMock(replSettings));
+
+        mongo::repl::ReplicationCoordinator::set(mongo::getGlobalServiceContext(),
+                                                 std::move(mock));
+
+        deleter.startWorkers();
+        ASSERT_EQUALS(2U, deleter.getNumWorkers());
+
+        env->pauseDeletes();
+
+        Notification notifyDone1;
+        RangeDeleterOptions deleterOption1(KeyRange("test.user",
+                                                    BSON("x" << 10),
+                                                    BSON("x" << 20),
+                                                    BSON("x" << 1)));
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        deleterOption1,
+                                        &notifyDone1,
+                                        NULL /* don't care errMsg */));
+        env->waitForNthPausedDelete(1u);
+
+        Notification notifyDone2;
+        RangeDeleterOptions deleterOption2(KeyRange("test.other",
+                                                    BSON("x" << 10),
+                                                    BSON("x" << 20),
+                                                    BSON("x" << 1)));
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        deleterOption2,
+                                        &notifyDone2,
+                                        NULL /* don't care errMsg */));
+
+        // The second delete starts while the first one is still paused.
+        env->waitForNthPausedDelete(2u);
+        ASSERT_EQUALS(2U, deleter.getDeletesInProgress());
+        ASSERT_EQUALS(0U, deleter.getPendingDeletes());
+
+        env->resumeOneDelete();
+        env->resumeOneDelete();
+        notifyDone1.waitToBeNotified();
+        notifyDone2.waitToBeNotified();
+
+        deleter.stopWorkers();
+    }
+
+    // Tests that deletes from the same collection are not worked on at the same time, even if
+    // there is an idle worker.
+    TEST(MultipleWorkers, OneDeletePerCollection) {
+        WorkersSetting workersSetting(2);
+        const string ns("test.user");
+
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+
+        std::unique_ptr<mongo::repl::ReplicationCoordinatorMock> mock(
+            new mongo::repl::ReplicationCoordinatorMock(replSettings));
+
+        mongo::repl::ReplicationCoordinator::set(mongo::getGlobalServiceContext(),
+                                                 std::move(mock));
+
+        deleter.startWorkers();
+
+        env->pauseDeletes();
+
+        Notification notifyDone1;
+        RangeDeleterOptions deleterOption1(KeyRange(ns,
+                                                    BSON("x" << 10),
+                                                    BSON("x" << 20),
+                                                    BSON("x" << 1)));
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        deleterOption1,
+                                        &notifyDone1,
+                                        NULL /* don't care errMsg */));
+        env->waitForNthPausedDelete(1u);
+
+        Notification notifyDone2;
+        RangeDeleterOptions deleterOption2(KeyRange(ns,
+                                                    BSON("x" << 20),
+                                                    BSON("x" << 30),
+                                                    BSON("x" << 1)));
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        deleterOption2,
+                                        &notifyDone2,
+                                        NULL /* don't care errMsg */));
+
+        // Give the idle worker a chance to (wrongly) pick up the second delete.
+        mongo::sleepmillis(500);
+        ASSERT_EQUALS(1U, deleter.getDeletesInProgress());
+        ASSERT_EQUALS(1U, deleter.getPendingDeletes());
+
+        env->resumeOneDelete();
+        notifyDone1.waitToBeNotified();
+
+        DeletedRange deleted1(env->getLastDelete());
+        ASSERT_TRUE(deleted1.min.equal(BSON("x" << 10)));
+
+        // The second delete starts once the first one is done.
+        env->waitForNthPausedDelete(2u);
+        env->resumeOneDelete();
+        notifyDone2.waitToBeNotified();
+
+        DeletedRange deleted2(env->getLastDelete());
+        ASSERT_TRUE(deleted2.min.equal(BSON("x" << 20)));
+
+        deleter.stopWorkers();
+    }
+
 } // unnamed namespace
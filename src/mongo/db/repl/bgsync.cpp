@@ -48,6 +48,8 @@
 #include "mongo/db/repl/rollback_source_impl.h"
 #include "mongo/db/repl/rs_rollback.h"
 #include "mongo/db/repl/rs_sync.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
@@ -63,6 +65,10 @@ namespace {
     const char hashFieldName[] = "h";
     int SleepToAllowBatchingMillis = 2;
     const int BatchIsSmallish = 40000; // bytes
+
+    // Tails the sync source's oplog with an exhaust cursor, which streams batches without a
+    // round trip for each getmore. Takes effect the next time a sync source is chosen.
+    MONGO_EXPORT_SERVER_PARAMETER(oplogFetcherUsesExhaust, bool, false);
 } // namespace
 
     MONGO_FP_DECLARE(rsBgSyncProduce);
@@ -75,6 +81,14 @@ namespace {
     static ServerStatusMetricField<TimerStats> displayBatchesRecieved(
                                                     "repl.network.getmores",
                                                     &getmoreReplStats );
+    //The distribution of the round trip time of each getmore, and of the bytes it returned
+    static LatencyHistogram getmoreLatencyHistogram;
+    static ServerStatusHistogramMetric displayGetmoreLatency( "repl.network.getmoreMicros",
+                                                              &getmoreLatencyHistogram );
+    static LatencyHistogram getmoreBytesHistogram;
+    static ServerStatusHistogramMetric displayGetmoreBytes( "repl.network.getmoreBytes",
+                                                            &getmoreBytesHistogram,
+                                                            "totalBytes" );
     //The oplog entries read via the oplog reader
     static Counter64 opsReadStats;
     static ServerStatusMetricField<Counter64> displayOpsRead( "repl.network.ops",
@@ -92,20 +106,76 @@ namespace {
     static Counter64 bufferSizeGauge;
     static ServerStatusMetricField<Counter64> displayBufferSize( "repl.buffer.sizeBytes",
                                                                 &bufferSizeGauge );
+    //The memory of the batches buffered or being applied
+    static MemoryAccount replBufferMemory("replBuffer");
     //The max size (bytes) of the buffer
     static int bufferMaxSizeGauge = 256*1024*1024;
     static ServerStatusMetricField<int> displayBufferMaxSize( "repl.buffer.maxSizeBytes",
                                                                 &bufferMaxSizeGauge );
+    //The count and size of the items in the buffer, sampled whenever a batch is buffered
+    static LatencyHistogram bufferCountHistogram;
+    static ServerStatusHistogramMetric displayBufferCountSamples( "repl.buffer.occupancy.count",
+                                                                  &bufferCountHistogram,
+                                                                  "totalCount" );
+    static LatencyHistogram bufferSizeHistogram;
+    static ServerStatusHistogramMetric displayBufferSizeSamples( "repl.buffer.occupancy.sizeBytes",
+                                                                 &bufferSizeHistogram,
+                                                                 "totalBytes" );
+    //The number of batches and time they spent in the buffer before the applier got to them
+    static TimerStats bufferWaitStats;
+    static ServerStatusMetricField<TimerStats> displayBufferWait( "repl.buffer.waitTime",
+                                                                &bufferWaitStats );
+    static LatencyHistogram bufferWaitHistogram;
+    static ServerStatusHistogramMetric displayBufferWaitLatency( "repl.buffer.waitMicros",
+                                                                 &bufferWaitHistogram );
+
+    //The timestamp (secs) of the last op fetched
+    static AtomicInt64 lastFetchedOpSecs;
+
+    /**
+     * How many seconds of oplog the buffer holds: the distance between the last op fetched and
+     * the last op applied.
+     */
+    class BufferLagMetric : public ServerStatusMetric {
+    public:
+        BufferLagMetric() : ServerStatusMetric("repl.buffer.lagSecs") {}
+
+        virtual void appendAtLeaf(BSONObjBuilder& b) const {
+            const long long fetchedSecs = lastFetchedOpSecs.load();
+            const long long appliedSecs =
+                getGlobalReplicationCoordinator()->getMyLastOptime().getSecs();
+            b.append(_leafName, fetchedSecs > appliedSecs ? fetchedSecs - appliedSecs : 0LL);
+        }
+    } bufferLagMetric;
 
 
     BackgroundSyncInterface::~BackgroundSyncInterface() {}
 
+    bool BackgroundSyncInterface::peek(BSONObj* op, OplogEntryHeader* header) {
+        if (!peek(op)) {
+            return false;
+        }
+
+        *header = OplogEntryHeader::parse(*op);
+        return true;
+    }
+
     size_t getSize(const BSONObj& o) {
         // SERVER-9808 Avoid Fortify complaint about implicit signed->unsigned conversion
         return static_cast<size_t>(o.objsize());
     }
 
-    BackgroundSync::BackgroundSync() : _buffer(bufferMaxSizeGauge, &getSize),
+    BackgroundSync::FetchedBatch::FetchedBatch()
+        : sizeBytes(0),
+          memoryCharge(&replBufferMemory) {
+    }
+
+    size_t BackgroundSync::_getBatchSize(const FetchedBatchPtr& batch) {
+        return batch->sizeBytes;
+    }
+
+    BackgroundSync::BackgroundSync() : _buffer(bufferMaxSizeGauge, &_getBatchSize),
+                                       _applierBatchPos(0),
                                        _lastOpTimeFetched(
                                                Timestamp(std::numeric_limits<int>::max(), 0),
                                                std::numeric_limits<long long>::max()),
@@ -131,7 +201,7 @@ namespace {
 
         // Clear the buffer in case the producerThread is waiting in push() due to a full queue.
         invariant(inShutdown());
-        _buffer.clear();
+        clearBuffer();
         _pause = true;
 
         // Wake up producerThread so it notices that we're in shutdown
@@ -143,7 +213,8 @@ namespace {
         boost::lock_guard<boost::mutex> lock(_mutex);
 
         // If all ops in the buffer have been applied, unblock waitForRepl (if it's waiting)
-        if (_buffer.empty()) {
+        boost::lock_guard<boost::mutex> applierLock(_applierMutex);
+        if (_buffer.empty() && !_applierBatch) {
             _appliedBuffer = true;
             _appliedBufferCondition.notify_all();
         }
@@ -253,7 +324,9 @@ namespace {
             _replCoord->signalUpstreamUpdater();
         }
 
-        _syncSourceReader.tailingQueryGTE(rsOplogName.c_str(), lastOpTimeFetched.getTimestamp());
+        _syncSourceReader.tailingQueryGTE(rsOplogName.c_str(),
+                                          lastOpTimeFetched.getTimestamp(),
+                                          oplogFetcherUsesExhaust);
 
         // if target cut connections between connecting and querying (for
         // example, because it stepped down) we might not have a cursor
@@ -300,12 +373,15 @@ namespace {
                 {
                     //record time for each getmore
                     TimerHolder batchTimer(&getmoreReplStats);
+                    Timer getmoreTimer;
                     
                     // This calls receiveMore() on the oplogreader cursor.
                     // It can wait up to five seconds for more data.
                     _syncSourceReader.more();
+                    getmoreLatencyHistogram.record(getmoreTimer.micros());
                 }
                 networkByteStats.increment(_syncSourceReader.currentBatchMessageSize());
+                getmoreBytesHistogram.record(_syncSourceReader.currentBatchMessageSize());
 
                 if (!_syncSourceReader.moreInCurrentBatch()) {
                     // If there is still no data from upstream, check a few more things
@@ -336,9 +412,18 @@ namespace {
             }
 
             // At this point, we are guaranteed to have at least one thing to read out
-            // of the oplogreader cursor.
-            BSONObj o = _syncSourceReader.nextSafe().getOwned();
-            opsReadStats.increment();
+            // of the oplogreader cursor. The whole batch is buffered at once, and the fields the
+            // applier batches and partitions ops on are parsed here rather than by the applier.
+            FetchedBatchPtr batch = std::make_shared<FetchedBatch>();
+            while (_syncSourceReader.moreInCurrentBatch()) {
+                BSONObj o = _syncSourceReader.nextSafe().getOwned();
+                batch->headers.push_back(OplogEntryHeader::parse(o));
+                batch->sizeBytes += getSize(o);
+                batch->ops.push_back(o);
+            }
+            opsReadStats.increment(batch->ops.size());
+            batch->memoryCharge.set(batch->sizeBytes +
+                                    batch->headers.size() * sizeof(OplogEntryHeader));
 
             {
                 boost::unique_lock<boost::mutex> lock(_mutex);
@@ -349,14 +434,19 @@ namespace {
                 LOG(2) << "bgsync buffer has " << _buffer.size() << " bytes";
             }
 
-            bufferCountGauge.increment();
-            bufferSizeGauge.increment(getSize(o));
-            _buffer.push(o);
+            bufferCountGauge.increment(batch->ops.size());
+            bufferSizeGauge.increment(batch->sizeBytes);
+            bufferCountHistogram.record(bufferCountGauge.get());
+            bufferSizeHistogram.record(bufferSizeGauge.get());
+            batch->bufferedAt = Date_t::now();
+            _buffer.push(batch);
 
             {
+                const BSONObj& lastOp = batch->ops.back();
                 boost::unique_lock<boost::mutex> lock(_mutex);
-                _lastFetchedHash = o["h"].numberLong();
-                _lastOpTimeFetched = extractOpTime(o);
+                _lastFetchedHash = lastOp["h"].numberLong();
+                _lastOpTimeFetched = extractOpTime(lastOp);
+                lastFetchedOpSecs.store(_lastOpTimeFetched.getSecs());
                 LOG(3) << "lastOpTimeFetched: " << _lastOpTimeFetched;
             }
         }
@@ -374,23 +464,72 @@ namespace {
     }
 
 
+    bool BackgroundSync::_nextApplierOp_inlock() {
+        if (_applierBatch && _applierBatchPos < _applierBatch->ops.size()) {
+            return true;
+        }
+
+        FetchedBatchPtr batch;
+        if (!_buffer.tryPop(batch)) {
+            _applierBatch.reset();
+            return false;
+        }
+
+        const Microseconds bufferWait = Date_t::now() - batch->bufferedAt;
+        bufferWaitStats.recordMillis(durationCount<Milliseconds>(bufferWait));
+        bufferWaitHistogram.record(std::max(0LL, durationCount<Microseconds>(bufferWait)));
+        _applierBatch = batch;
+        _applierBatchPos = 0;
+        return true;
+    }
+
     bool BackgroundSync::peek(BSONObj* op) {
-        return _buffer.peek(*op);
+        boost::lock_guard<boost::mutex> lock(_applierMutex);
+        if (!_nextApplierOp_inlock()) {
+            return false;
+        }
+
+        *op = _applierBatch->ops[_applierBatchPos];
+        return true;
+    }
+
+    bool BackgroundSync::peek(BSONObj* op, OplogEntryHeader* header) {
+        boost::lock_guard<boost::mutex> lock(_applierMutex);
+        if (!_nextApplierOp_inlock()) {
+            return false;
+        }
+
+        *op = _applierBatch->ops[_applierBatchPos];
+        *header = _applierBatch->headers[_applierBatchPos];
+        return true;
     }
 
     void BackgroundSync::waitForMore() {
-        BSONObj op;
+        {
+            boost::lock_guard<boost::mutex> lock(_applierMutex);
+            if (_applierBatch) {
+                return;
+            }
+        }
+
+        FetchedBatchPtr batch;
         // Block for one second before timing out.
-        // Ignore the value of the op we peeked at.
-        _buffer.blockingPeek(op, 1);
+        // Ignore the value of the batch we peeked at.
+        _buffer.blockingPeek(batch, 1);
     }
 
     void BackgroundSync::consume() {
         // this is just to get the op off the queue, it's been peeked at
         // and queued for application already
-        BSONObj op = _buffer.blockingPop();
+        boost::lock_guard<boost::mutex> lock(_applierMutex);
+        invariant(_nextApplierOp_inlock());
+
         bufferCountGauge.decrement(1);
-        bufferSizeGauge.decrement(getSize(op));
+        bufferSizeGauge.decrement(getSize(_applierBatch->ops[_applierBatchPos]));
+
+        if (++_applierBatchPos == _applierBatch->ops.size()) {
+            _applierBatch.reset();
+        }
     }
 
     bool BackgroundSync::_rollbackIfNeeded(OperationContext* txn, OplogReader& r) {
@@ -482,7 +621,11 @@ namespace {
     }
 
     void BackgroundSync::start(OperationContext* txn) {
-        massert(16235, "going to start syncing, but buffer is not empty", _buffer.empty());
+        {
+            boost::lock_guard<boost::mutex> applierLock(_applierMutex);
+            massert(16235, "going to start syncing, but buffer is not empty",
+                    _buffer.empty() && !_applierBatch);
+        }
 
         long long updatedLastAppliedHash = _readLastAppliedHash(txn);
         boost::lock_guard<boost::mutex> lk(_mutex);
@@ -511,6 +654,9 @@ namespace {
 
     void BackgroundSync::clearBuffer() {
         _buffer.clear();
+
+        boost::lock_guard<boost::mutex> lock(_applierMutex);
+        _applierBatch.reset();
     }
 
     void BackgroundSync::setLastAppliedHash(long long newHash) {
@@ -568,8 +714,15 @@ namespace {
     }
 
     void BackgroundSync::pushTestOpToBuffer(const BSONObj& op) {
+        FetchedBatchPtr batch = std::make_shared<FetchedBatch>();
+        batch->ops.push_back(op);
+        batch->headers.push_back(OplogEntryHeader::parse(op));
+        batch->sizeBytes = getSize(op);
+        batch->bufferedAt = Date_t::now();
+        batch->memoryCharge.set(batch->sizeBytes + sizeof(OplogEntryHeader));
+
         boost::lock_guard<boost::mutex> lock(_mutex);
-        _buffer.push(op);
+        _buffer.push(batch);
     }
 
 
@@ -29,11 +29,16 @@
 #pragma once
 
 #include <boost/thread/mutex.hpp>
+#include <memory>
+#include <vector>
 
 #include "mongo/util/queue.h"
+#include "mongo/db/repl/oplog_entry_header.h"
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/util/memory_accounting.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -55,6 +60,10 @@ namespace repl {
         // false if the queue was empty.
         virtual bool peek(BSONObj* op) = 0;
 
+        // Same as peek(op), also returning the parsed header of the op. By default the header
+        // is parsed here, implementations which parse their ops ahead of time override this.
+        virtual bool peek(BSONObj* op, OplogEntryHeader* header);
+
         // Deletes objects in the queue;
         // called by sync thread after it has applied an op
         virtual void consume() = 0;
@@ -101,6 +110,7 @@ namespace repl {
         // Interface implementation
 
         virtual bool peek(BSONObj* op);
+        virtual bool peek(BSONObj* op, OplogEntryHeader* header);
         virtual void consume();
         virtual void clearSyncTarget();
         virtual void waitForMore();
@@ -134,11 +144,40 @@ namespace repl {
         // protects creation of s_instance
         static boost::mutex s_mutex;
 
+        // The ops of one getMore batch from the sync source, with their parsed headers
+        struct FetchedBatch {
+            FetchedBatch();
+
+            std::vector<BSONObj> ops;
+            std::vector<OplogEntryHeader> headers;
+            size_t sizeBytes;
+
+            // When the batch was added to the buffer
+            Date_t bufferedAt;
+
+            // The batch's share of the buffer memory, held until its last op is applied
+            MemoryAccount::Charge memoryCharge;
+        };
+        typedef std::shared_ptr<FetchedBatch> FetchedBatchPtr;
+
+        static size_t _getBatchSize(const FetchedBatchPtr& batch);
+
+        // Makes the next op to apply available in _applierBatch, taking the next batch from the
+        // buffer if the current one is used up. Returns false if there are no more ops.
+        bool _nextApplierOp_inlock();
+
         // Production thread
-        BlockingQueue<BSONObj> _buffer;
+        BlockingQueue<FetchedBatchPtr> _buffer;
         OplogReader _syncSourceReader;
 
-        // _mutex protects all of the class variables except _syncSourceReader and _buffer
+        // The batch taken off the buffer whose ops the applier is consuming, and the position of
+        // the next op in it
+        boost::mutex _applierMutex;
+        FetchedBatchPtr _applierBatch;
+        size_t _applierBatchPos;
+
+        // _mutex protects all of the class variables except _syncSourceReader, _buffer and the
+        // applier batch
         mutable boost::mutex _mutex;
 
         OpTime _lastOpTimeFetched;
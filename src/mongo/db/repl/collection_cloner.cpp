@@ -74,6 +74,7 @@ namespace repl {
                                  stdx::placeholders::_3)),
           _indexSpecs(),
           _documents(),
+          _documentsCopied(0),
           _dbWorkCallbackHandle(),
           _scheduleDbWorkFn([this](const ReplicationExecutor::CallbackFn& work) {
               return _executor->scheduleDBWork(work);
@@ -98,6 +99,11 @@ namespace repl {
         return _sourceNss;
     }
 
+    size_t CollectionCloner::getDocumentsCopied() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _documentsCopied;
+    }
+
     std::string CollectionCloner::getDiagnosticString() const {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         str::stream output;
@@ -108,6 +114,7 @@ namespace repl {
         output << " destination namespace: " << _destNss.toString();
         output << " collection options: " << _options.toBSON();
         output << " active: " << _active;
+        output << " documents copied: " << _documentsCopied;
         output << " listIndexes fetcher: " << _listIndexesFetcher.getDiagnosticString();
         output << " find fetcher: " << _findFetcher.getDiagnosticString();
         output << " database worked callback handle: "
@@ -286,6 +293,11 @@ namespace repl {
             return;
         }
 
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _documentsCopied += _documents.size();
+        }
+
         if (!lastBatch) {
             return;
         }
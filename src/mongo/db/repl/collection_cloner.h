@@ -89,6 +89,11 @@ namespace repl {
 
         const NamespaceString& getSourceNamespace() const;
 
+        /**
+         * Returns the number of documents inserted into the destination collection so far.
+         */
+        size_t getDocumentsCopied() const;
+
         std::string getDiagnosticString() const override;
 
         bool isActive() const override;
@@ -193,6 +198,9 @@ namespace repl {
         // Current batch of documents read from fetcher to insert into collection.
         std::vector<BSONObj> _documents;
 
+        // Number of documents inserted by the storage interface so far.
+        size_t _documentsCopied;
+
         // Callback handle for database worker.
         ReplicationExecutor::CallbackHandle _dbWorkCallbackHandle;
 
@@ -219,6 +227,11 @@ namespace repl {
         /**
          * Creates a collection with the provided indexes.
          *
+         * Implementations should only create the _id index here and load the documents passed
+         * to insertDocuments() without maintaining the other indexes in 'indexSpecs'. Building
+         * those in bulk from the loaded data in commitCollection() is much cheaper than
+         * updating them a document at a time.
+         *
          * Assume that no database locks have been acquired prior to calling this
          * function.
          */
@@ -239,6 +252,8 @@ namespace repl {
 
         /**
          * Commits changes to collection. No effect if collection building has not begun.
+         * This is where the secondary indexes passed to beginCollection() are built, with the
+         * bulk index builder.
          * Operation context could be null.
          */
         virtual Status commitCollection(OperationContext* txn,
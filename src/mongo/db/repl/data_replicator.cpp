@@ -185,6 +185,7 @@ namespace {
                   _source(source),
                   _active(false),
                   _clonersActive(0),
+                  _collectionClonerConcurrency(1),
                   _finishFn(finishFn) {
             if (!_finishFn) {
                 _status = Status(ErrorCodes::InvalidOptions, "finishFn is not callable.");
@@ -219,7 +220,8 @@ namespace {
                         " status:" << _status.toString() <<
                         " source:" << _source.toString() <<
                         " db cloners active:" << _clonersActive <<
-                        " db count:" << _databaseCloners.size();
+                        " db count:" << _databaseCloners.size() <<
+                        " progress:" << _progressString();
         }
 
 
@@ -228,8 +230,18 @@ namespace {
             _storage = si;
         }
 
+        void setCollectionClonerConcurrency(size_t concurrency) {
+            _collectionClonerConcurrency = concurrency;
+        }
+
     private:
 
+        /**
+         * Collections and documents cloned so far, with an estimate of the time left based on the
+         * fraction of the collections which are done.
+         */
+        std::string _progressString();
+
         /**
          * Does the next action necessary for the initial sync process.
          *
@@ -278,6 +290,8 @@ namespace {
         bool _active; // false until we start
         std::vector<std::shared_ptr<DatabaseCloner>> _databaseCloners; // database cloners by name
         int _clonersActive;
+        size_t _collectionClonerConcurrency;
+        Date_t _startedAt;
 
         const stdx::function<void (const Status&)> _finishFn;
 
@@ -369,6 +383,7 @@ namespace {
         }
 
         _status = Status::OK();
+        _startedAt = Date_t::now();
 
         log() << "starting cloning of all databases";
         // Schedule listDatabase command which will kick off the database cloner per result db.
@@ -436,6 +451,10 @@ namespace {
                     // error creating, fails below.
                 }
 
+                if (dbCloner) {
+                    dbCloner->setCollectionClonerConcurrency(_collectionClonerConcurrency);
+                }
+
                 Status s = dbCloner ? dbCloner->start() : Status(ErrorCodes::UnknownError, "Bad!");
 
                 if (!s.isOK()) {
@@ -481,6 +500,27 @@ namespace {
         _doNextActions();
     }
 
+    std::string DatabasesCloner::_progressString() {
+        size_t collections = 0;
+        size_t collectionsCloned = 0;
+        size_t documentsCopied = 0;
+        for (auto&& dbCloner : _databaseCloners) {
+            collections += dbCloner->getCollectionCount();
+            collectionsCloned += dbCloner->getCollectionsCloned();
+            documentsCopied += dbCloner->getDocumentsCopied();
+        }
+
+        str::stream out;
+        out << " collections cloned: " << collectionsCloned << "/" << collections
+            << " documents copied: " << documentsCopied;
+        if (_active && collectionsCloned > 0 && collectionsCloned < collections) {
+            const auto elapsed = durationCount<Milliseconds>(Date_t::now() - _startedAt);
+            out << " estimated secs left: "
+                << elapsed * (collections - collectionsCloned) / collectionsCloned / 1000;
+        }
+        return out;
+    }
+
     void DatabasesCloner::_doNextActions() {
         // If we are no longer active or we had an error, stop doing more
         if (!(_active && _status.isOK())) {
@@ -572,7 +612,8 @@ namespace {
         switch (_state) {
             case DataReplicatorState::InitialSync:
                 out << " opsAppied: " << _initialSyncState->appliedOps
-                    << " status: " << _initialSyncState->status.toString();
+                    << " status: " << _initialSyncState->status.toString()
+                    << " cloner: " << _initialSyncState->dbsCloner.toString();
                 break;
             case DataReplicatorState::Steady:
                 // TODO: add more here
@@ -734,6 +775,8 @@ namespace {
                                  initialSyncFinishEvent));
 
                 _initialSyncState->dbsCloner.setStorageInterface(_storage);
+                _initialSyncState->dbsCloner.setCollectionClonerConcurrency(
+                                                        _opts.collectionClonerConcurrency);
                 const NamespaceString ns(_opts.remoteOplogNS);
                 TimestampStatus tsStatus = _initialSyncState->getLatestOplogTimestamp(
                                                                                 _exec,
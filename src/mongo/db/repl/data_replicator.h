@@ -103,6 +103,9 @@ struct DataReplicatorOptions {
     BSONObj filterCriteria;
     HostAndPort syncSource; // for use without replCoord -- maybe some kind of rsMonitor/interface
 
+    // Number of collections of a database cloned at the same time during initial sync.
+    size_t collectionClonerConcurrency = 4;
+
     // TODO: replace with real applier function
     Applier::ApplyOperationFn applierFn = [] (OperationContext*, const BSONObj&) -> Status {
         return Status::OK();
@@ -113,6 +116,7 @@ struct DataReplicatorOptions {
                              << " localOplogNs: " << localOplogNS.toString()
                              << " remoteOplogNS: " << remoteOplogNS.toString()
                              << " syncSource: " << syncSource.toString()
+                             << " collectionClonerConcurrency: " << collectionClonerConcurrency
                              << " startOptime: " << startOptime.toString();
     }
 };
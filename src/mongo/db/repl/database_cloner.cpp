@@ -88,6 +88,10 @@ namespace {
           _collectionWork(collWork),
           _onCompletion(onCompletion),
           _active(false),
+          _collectionClonerConcurrency(1),
+          _collectionClonersActive(0),
+          _collectionsCloned(0),
+          _startCollectionClonerStatus(Status::OK()),
           _listCollectionsFetcher(_executor,
                                   _source,
                                   _dbname,
@@ -121,6 +125,33 @@ namespace {
         return _collectionInfos;
     }
 
+    void DatabaseCloner::setCollectionClonerConcurrency(size_t concurrency) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_active) {
+            return;
+        }
+        _collectionClonerConcurrency = std::max(concurrency, size_t(1));
+    }
+
+    size_t DatabaseCloner::getCollectionCount() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _collectionCloners.size();
+    }
+
+    size_t DatabaseCloner::getCollectionsCloned() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _collectionsCloned;
+    }
+
+    size_t DatabaseCloner::getDocumentsCopied() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        size_t documentsCopied = 0;
+        for (auto&& collectionCloner : _collectionCloners) {
+            documentsCopied += collectionCloner.getDocumentsCopied();
+        }
+        return documentsCopied;
+    }
+
     std::string DatabaseCloner::getDiagnosticString() const {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         str::stream output;
@@ -132,6 +163,9 @@ namespace {
         output << " active: " << _active;
         output << " collection info objects (empty if listCollections is in progress): "
                << _collectionInfos.size();
+        output << " collection cloner concurrency: " << _collectionClonerConcurrency;
+        output << " collection cloners active: " << _collectionClonersActive;
+        output << " collections cloned: " << _collectionsCloned;
         return output;
     }
 
@@ -267,6 +301,7 @@ namespace {
             auto&& nss = *_collectionNamespaces.crbegin();
 
             try {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
                 _collectionCloners.emplace_back(
                     _executor,
                     _source,
@@ -288,19 +323,11 @@ namespace {
             collectionCloner.setScheduleDbWorkFn(_scheduleDbWorkFn);
         }
 
-        // Start first collection cloner.
-        _currentCollectionClonerIter = _collectionCloners.begin();
-
-        LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
-
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-        if (!startStatus.isOK()) {
-            LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace()
-                   << ": " << startStatus;
-            _finishCallback(startStatus);
-            return;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _nextCollectionClonerIter = _collectionCloners.begin();
         }
+        _startCollectionCloners();
     }
 
     void DatabaseCloner::_collectionClonerCallback(const Status& status,
@@ -310,23 +337,44 @@ namespace {
         // from cloning the rest of the collections in the listCollections result.
         _collectionWork(status, nss);
 
-        _currentCollectionClonerIter++;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            --_collectionClonersActive;
+            ++_collectionsCloned;
+        }
+        _startCollectionCloners();
+    }
 
-        LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+    void DatabaseCloner::_startCollectionCloners() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (_startCollectionClonerStatus.isOK() &&
+               _collectionClonersActive < _collectionClonerConcurrency &&
+               _nextCollectionClonerIter != _collectionCloners.end()) {
+            CollectionCloner& collectionCloner = *_nextCollectionClonerIter++;
+            ++_collectionClonersActive;
+
+            // The collection cloner may call back into us from start(), so we must not hold our
+            // mutex while starting it.
+            lk.unlock();
+            LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
+            Status startStatus = _startCollectionCloner(collectionCloner);
+            lk.lock();
 
-        if (_currentCollectionClonerIter != _collectionCloners.end()) {
-            Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
             if (!startStatus.isOK()) {
                 LOG(1) << "    failed to start collection cloning on "
-                       << _currentCollectionClonerIter->getSourceNamespace()
-                       << ": " << startStatus;
-                _finishCallback(startStatus);
-                return;
+                       << collectionCloner.getSourceNamespace() << ": " << startStatus;
+                --_collectionClonersActive;
+                _startCollectionClonerStatus = startStatus;
             }
+        }
+
+        if (_collectionClonersActive > 0) {
             return;
         }
 
-        _finishCallback(Status::OK());
+        const Status finishStatus = _startCollectionClonerStatus;
+        lk.unlock();
+        _finishCallback(finishStatus);
     }
 
     void DatabaseCloner::_finishCallback(const Status& status) {
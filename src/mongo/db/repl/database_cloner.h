@@ -105,6 +105,21 @@ namespace repl {
          */
         const std::vector<BSONObj>& getCollectionInfos() const;
 
+        /**
+         * Sets the number of collections cloned at the same time. Defaults to 1, which clones the
+         * collections one after the other. Has no effect once the cloner has started.
+         */
+        void setCollectionClonerConcurrency(size_t concurrency);
+
+        /**
+         * Progress of the clone: the number of collections to clone (0 until listCollections has
+         * returned), the number of those that are done and the number of documents copied into
+         * all of them so far.
+         */
+        size_t getCollectionCount() const;
+        size_t getCollectionsCloned() const;
+        size_t getDocumentsCopied() const;
+
         std::string getDiagnosticString() const override;
 
         bool isActive() const override;
@@ -148,6 +163,13 @@ namespace repl {
          */
         void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+        /**
+         * Starts collection cloners until '_collectionClonerConcurrency' of them are active or
+         * there are none left to start. Reports completion once the last one is done, or as soon
+         * as no cloner is active after one failed to start.
+         */
+        void _startCollectionCloners();
+
         /**
          * Reports completion status.
          * Sets cloner to inactive.
@@ -192,7 +214,19 @@ namespace repl {
         std::vector<NamespaceString> _collectionNamespaces;
 
         std::list<CollectionCloner> _collectionCloners;
-        std::list<CollectionCloner>::iterator _currentCollectionClonerIter;
+
+        // Next collection cloner to start.
+        std::list<CollectionCloner>::iterator _nextCollectionClonerIter;
+
+        // Maximum and current number of collection cloners running at the same time.
+        size_t _collectionClonerConcurrency;
+        size_t _collectionClonersActive;
+
+        size_t _collectionsCloned;
+
+        // Set when a collection cloner could not be started. No further cloners are started and
+        // this is reported once the active ones are done.
+        Status _startCollectionClonerStatus;
 
         // Function for scheduling database work using the executor.
         CollectionCloner::ScheduleDbWorkFn _scheduleDbWorkFn;
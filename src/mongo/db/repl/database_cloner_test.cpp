@@ -495,4 +495,60 @@ namespace {
         }
     }
 
+    TEST_F(DatabaseClonerTest, CreateCollectionsConcurrently) {
+        databaseCloner->setCollectionClonerConcurrency(2);
+        ASSERT_OK(databaseCloner->start());
+
+        // Replace scheduleDbWork function so that all callbacks (including exclusive tasks)
+        // will run through network interface.
+        auto&& executor = getExecutor();
+        databaseCloner->setScheduleDbWorkFn([&](const ReplicationExecutor::CallbackFn& workFn) {
+            return executor.scheduleWork(workFn);
+        });
+
+        const std::vector<BSONObj> sourceInfos = {
+            BSON("name" << "a" << "options" << BSONObj()),
+            BSON("name" << "b" << "options" << BSONObj()),
+            BSON("name" << "c" << "options" << BSONObj())};
+        processNetworkResponse(createListCollectionsResponse(0, BSON_ARRAY(sourceInfos[0] <<
+                                                                           sourceInfos[1] <<
+                                                                           sourceInfos[2])));
+
+        ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
+        ASSERT_TRUE(databaseCloner->isActive());
+        ASSERT_EQUALS(3U, databaseCloner->getCollectionCount());
+
+        // The first two collection cloners both send listIndexes before either of them gets to
+        // the find.
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        processNetworkResponse(createCursorResponse(0, BSON_ARRAY(BSON("_id" << 1) <<
+                                                                  BSON("_id" << 2))));
+        ASSERT_EQUALS(1U, databaseCloner->getCollectionsCloned());
+        ASSERT_EQUALS(2U, databaseCloner->getDocumentsCopied());
+
+        // The third one starts when the first one is done.
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        processNetworkResponse(createCursorResponse(0, BSON_ARRAY(BSON("_id" << 3))));
+
+        ASSERT_OK(getStatus());
+        ASSERT_FALSE(databaseCloner->isActive());
+        ASSERT_EQUALS(3U, databaseCloner->getCollectionsCloned());
+        ASSERT_EQUALS(3U, databaseCloner->getDocumentsCopied());
+
+        ASSERT_EQUALS(3U, collectionWorkResults.size());
+        {
+            auto i = collectionWorkResults.cbegin();
+            ASSERT_OK(i->first);
+            ASSERT_EQUALS(i->second.ns(), NamespaceString(dbname, "a").ns());
+            i++;
+            ASSERT_OK(i->first);
+            ASSERT_EQUALS(i->second.ns(), NamespaceString(dbname, "b").ns());
+            i++;
+            ASSERT_OK(i->first);
+            ASSERT_EQUALS(i->second.ns(), NamespaceString(dbname, "c").ns());
+        }
+    }
+
 } // namespace
@@ -0,0 +1,96 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_entry_header.h"
+
+#include "third_party/murmurhash3/MurmurHash3.h"
+
+#include <cstring>
+
+#include "mongo/base/string_data.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+namespace repl {
+
+    OplogEntryHeader::OplogEntryHeader()
+        : opType('\0'),
+          applyAlone(false),
+          version(0),
+          nsHash(0),
+          hasIdHash(false),
+          idHash(0) {
+    }
+
+    // static
+    OplogEntryHeader OplogEntryHeader::parse(const BSONObj& op) {
+        OplogEntryHeader header;
+
+        const BSONElement nsElem = op["ns"];
+        const char* ns = nsElem.valuestrsafe();
+        if (nsElem.type() == String) {
+            MurmurHash3_x86_32(ns, nsElem.valuestrsize(), 0, &header.nsHash);
+        }
+
+        const char* opType = op["op"].valuestrsafe();
+        header.opType = opType[0];
+
+        // Index builds are acheived through the use of an insert op, not a command op.
+        const char* dot = strchr(ns, '.');
+        header.applyAlone = header.opType == 'c' ||
+                            (dot && StringData(dot + 1) == "system.indexes");
+
+        // A missing version means version 1
+        const BSONElement versionElem = op["v"];
+        header.version = versionElem.eoo() ? 1 : versionElem.numberInt();
+
+        const bool isCrudOpType = (header.opType == 'd' ||
+                                   header.opType == 'i' ||
+                                   header.opType == 'u') && opType[1] == '\0';
+        if (isCrudOpType) {
+            const BSONElement idHolder = op[header.opType == 'u' ? "o2" : "o"];
+            const BSONElement id = idHolder.isABSONObj() ? idHolder.Obj()["_id"] : BSONElement();
+            header.hasIdHash = true;
+            header.idHash = BSONElement::Hasher()(id);
+        }
+
+        return header;
+    }
+
+    uint32_t OplogEntryHeader::partitionHash(bool supportsDocLocking) const {
+        uint32_t hash = nsHash;
+        if (supportsDocLocking && hasIdHash) {
+            MurmurHash3_x86_32(&idHash, sizeof(idHash), hash, &hash);
+        }
+        return hash;
+    }
+
+} // namespace repl
+} // namespace mongo
@@ -0,0 +1,72 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mongo {
+    class BSONObj;
+
+namespace repl {
+
+    /**
+     * The parts of an oplog entry which SyncTail looks at to batch it and to pick the writer
+     * thread which applies it. BackgroundSync parses them once, when the entry is fetched.
+     */
+    struct OplogEntryHeader {
+        OplogEntryHeader();
+
+        static OplogEntryHeader parse(const BSONObj& op);
+
+        /**
+         * Ops with the same partition hash must be applied in order by the same writer, the
+         * others may be applied concurrently. The _id only counts with document-level locking.
+         */
+        uint32_t partitionHash(bool supportsDocLocking) const;
+
+        // First character of the "op" field, '\0' if there is none
+        char opType;
+
+        // Commands and index builds, which are applied in batches of their own
+        bool applyAlone;
+
+        // Version of the oplog format the entry is in
+        int version;
+
+        // MurmurHash3 of the namespace
+        uint32_t nsHash;
+
+        // Hash of the _id of the document which an insert, update or delete is on
+        bool hasIdHash;
+        size_t idHash;
+    };
+
+} // namespace repl
+} // namespace mongo
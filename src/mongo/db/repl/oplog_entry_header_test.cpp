@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_entry_header.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+    TEST(OplogEntryHeader, Insert) {
+        const OplogEntryHeader header = OplogEntryHeader::parse(
+                BSON("ts" << Timestamp(1, 1) << "h" << 1LL << "v" << 2 << "op" << "i"
+                          << "ns" << "test.t" << "o" << BSON("_id" << 1 << "x" << 2)));
+        ASSERT_EQUALS('i', header.opType);
+        ASSERT_FALSE(header.applyAlone);
+        ASSERT_EQUALS(2, header.version);
+        ASSERT_TRUE(header.hasIdHash);
+        ASSERT_EQUALS(header.nsHash, header.partitionHash(false));
+        ASSERT_NOT_EQUALS(header.nsHash, header.partitionHash(true));
+    }
+
+    TEST(OplogEntryHeader, PartitionsByNamespaceAndId) {
+        const OplogEntryHeader insert = OplogEntryHeader::parse(
+                BSON("op" << "i" << "ns" << "test.t" << "o" << BSON("_id" << 1 << "x" << 2)));
+        const OplogEntryHeader update = OplogEntryHeader::parse(
+                BSON("op" << "u" << "ns" << "test.t" << "o2" << BSON("_id" << 1)
+                          << "o" << BSON("$set" << BSON("x" << 3))));
+        const OplogEntryHeader remove = OplogEntryHeader::parse(
+                BSON("op" << "d" << "ns" << "test.t" << "o" << BSON("_id" << 1)));
+        const OplogEntryHeader otherId = OplogEntryHeader::parse(
+                BSON("op" << "d" << "ns" << "test.t" << "o" << BSON("_id" << 2)));
+        const OplogEntryHeader otherNs = OplogEntryHeader::parse(
+                BSON("op" << "d" << "ns" << "test.u" << "o" << BSON("_id" << 1)));
+
+        ASSERT_EQUALS(insert.partitionHash(true), update.partitionHash(true));
+        ASSERT_EQUALS(insert.partitionHash(true), remove.partitionHash(true));
+        ASSERT_NOT_EQUALS(insert.partitionHash(true), otherId.partitionHash(true));
+        ASSERT_NOT_EQUALS(insert.partitionHash(true), otherNs.partitionHash(true));
+
+        ASSERT_EQUALS(insert.partitionHash(false), otherId.partitionHash(false));
+        ASSERT_NOT_EQUALS(insert.partitionHash(false), otherNs.partitionHash(false));
+    }
+
+    TEST(OplogEntryHeader, CommandsAndIndexBuildsAreAppliedAlone) {
+        const OplogEntryHeader command = OplogEntryHeader::parse(
+                BSON("op" << "c" << "ns" << "test.$cmd" << "o" << BSON("drop" << "t")));
+        ASSERT_TRUE(command.applyAlone);
+        ASSERT_FALSE(command.hasIdHash);
+
+        const OplogEntryHeader indexBuild = OplogEntryHeader::parse(
+                BSON("op" << "i" << "ns" << "test.system.indexes"
+                          << "o" << BSON("ns" << "test.t" << "key" << BSON("x" << 1)
+                                              << "name" << "x_1")));
+        ASSERT_TRUE(indexBuild.applyAlone);
+    }
+
+    TEST(OplogEntryHeader, MissingFields) {
+        const OplogEntryHeader noOp = OplogEntryHeader::parse(BSON("op" << "n"));
+        ASSERT_EQUALS('n', noOp.opType);
+        ASSERT_FALSE(noOp.applyAlone);
+        ASSERT_EQUALS(1, noOp.version);
+        ASSERT_FALSE(noOp.hasIdHash);
+        ASSERT_EQUALS(0U, noOp.partitionHash(true));
+
+        const OplogEntryHeader empty = OplogEntryHeader::parse(BSONObj());
+        ASSERT_EQUALS('\0', empty.opType);
+        ASSERT_FALSE(empty.applyAlone);
+    }
+
+} // namespace
+} // namespace repl
+} // namespace mongo
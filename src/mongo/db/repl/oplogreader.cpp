@@ -107,6 +107,32 @@ namespace repl {
         return true;
     }
 
+    void OplogReader::resetCursor() {
+        if (cursor && _exhaustConn) {
+            // The sync source may still be streaming batches of this cursor, so it can't be
+            // killed over _exhaustConn. Closing the connection ends it.
+            cursor->decouple();
+        }
+        cursor.reset();
+        _exhaustConn.reset();
+    }
+
+    bool OplogReader::_connectExhaustConn() {
+        _exhaustConn.reset(new DBClientConnection(false, tcp_timeout));
+        string errmsg;
+        if (!_exhaustConn->connect(_host, errmsg) ||
+            (getGlobalAuthorizationManager()->isAuthEnabled() &&
+             !replAuthenticate(_exhaustConn.get()))) {
+
+            warning() << "could not connect to " << _host << " to stream its oplog, "
+                      << "falling back to getmores: " << errmsg;
+            _exhaustConn.reset();
+            return false;
+        }
+        _exhaustConn->port().tag |= executor::NetworkInterface::kMessagingPortKeepOpen;
+        return true;
+    }
+
     void OplogReader::tailCheck() {
         if( cursor.get() && cursor->isDead() ) {
             log() << "old cursor isDead, will initiate a new one" << std::endl;
@@ -124,18 +150,27 @@ namespace repl {
         );
     }
 
-    void OplogReader::tailingQuery(const char *ns, const BSONObj& query) {
+    void OplogReader::tailingQuery(const char *ns, const BSONObj& query, bool exhaust) {
         verify( !haveCursor() );
-        LOG(2) << ns << ".find(" << query.toString() << ')' << endl;
+        LOG(2) << ns << ".find(" << query.toString() << ')' << (exhaust ? " exhaust" : "")
+               << endl;
+        if (exhaust && _connectExhaustConn()) {
+            cursor.reset(_exhaustConn->query(ns, query, 0, 0, nullptr,
+                                             _tailingQueryOptions | QueryOption_Exhaust).release());
+            if (!cursor) {
+                _exhaustConn.reset();
+            }
+            return;
+        }
         cursor.reset( _conn->query( ns, query, 0, 0, nullptr, _tailingQueryOptions ).release() );
     }
 
-    void OplogReader::tailingQueryGTE(const char *ns, Timestamp optime) {
+    void OplogReader::tailingQueryGTE(const char *ns, Timestamp optime, bool exhaust) {
         BSONObjBuilder gte;
         gte.append("$gte", optime);
         BSONObjBuilder query;
         query.append("ts", gte.done());
-        tailingQuery(ns, query.done());
+        tailingQuery(ns, query.done(), exhaust);
     }
 
     HostAndPort OplogReader::getHost() const {
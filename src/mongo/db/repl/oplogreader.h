@@ -62,6 +62,11 @@ namespace repl {
     class OplogReader {
     private:
         std::shared_ptr<DBClientConnection> _conn;
+
+        // The connection an exhaust tailing query streams its results over, so that _conn stays
+        // free for other requests. Only this cursor may ever use it.
+        std::unique_ptr<DBClientConnection> _exhaustConn;
+
         std::shared_ptr<DBClientCursor> cursor;
         int _tailingQueryOptions;
 
@@ -70,10 +75,10 @@ namespace repl {
         HostAndPort _host;
     public:
         OplogReader();
-        ~OplogReader() { }
-        void resetCursor() { cursor.reset(); }
+        ~OplogReader() { resetCursor(); }
+        void resetCursor();
         void resetConnection() {
-            cursor.reset();
+            resetCursor();
             _conn.reset();
             _host = HostAndPort();
         }
@@ -101,9 +106,18 @@ namespace repl {
                    int nToSkip,
                    const BSONObj* fields=0);
 
-        void tailingQuery(const char *ns, const BSONObj& query);
+        /**
+         * Opens a tailable, awaitData cursor on the oplog 'ns'.
+         *
+         * With 'exhaust', the cursor is an exhaust cursor on a connection of its own: the sync
+         * source sends each batch as soon as it has one, without a round trip per getmore. Not
+         * reading the cursor keeps the sync source from sending more, so a reader which only
+         * reads as fast as it buffers gets flow control from TCP. Falls back to a regular cursor
+         * if the extra connection can't be opened.
+         */
+        void tailingQuery(const char *ns, const BSONObj& query, bool exhaust = false);
 
-        void tailingQueryGTE(const char *ns, Timestamp t);
+        void tailingQueryGTE(const char *ns, Timestamp t, bool exhaust = false);
 
         bool more() {
             uassert( 15910, "Doesn't have cursor for reading oplog", cursor.get() );
@@ -148,6 +162,12 @@ namespace repl {
         void connectToSyncSource(OperationContext* txn,
                                  const OpTime& lastOpTimeFetched,
                                  ReplicationCoordinator* replCoord);
+
+    private:
+        /**
+         * Opens and authenticates _exhaustConn to _host. Returns false if that fails.
+         */
+        bool _connectExhaustConn();
     };
 
 } // namespace repl
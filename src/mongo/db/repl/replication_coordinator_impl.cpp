@@ -69,6 +69,7 @@
 #include "mongo/stdx/functional.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
@@ -111,13 +112,31 @@ namespace {
 
 } //namespace
 
+namespace {
+
+    /**
+     * Waiters whose write concerns have the same key are satisfied by the same set of member
+     * opTimes, so they can be ordered by opTime together.
+     */
+    std::string makeWriteConcernKey(const WriteConcernOptions* writeConcern) {
+        if (!writeConcern) {
+            return std::string();
+        }
+        if (!writeConcern->wMode.empty()) {
+            return "mode:" + writeConcern->wMode;
+        }
+        return str::stream() << "w:" << writeConcern->wNumNodes;
+    }
+
+} // namespace
+
     struct ReplicationCoordinatorImpl::WaiterInfo {
 
         /**
          * Constructor takes the list of waiters and enqueues itself on the list, removing itself
          * in the destructor.
          */
-        WaiterInfo(std::vector<WaiterInfo*>* _list,
+        WaiterInfo(WaiterList* _list,
                    unsigned int _opID,
                    const OpTime* _opTime,
                    const WriteConcernOptions* _writeConcern,
@@ -126,22 +145,77 @@ namespace {
                                                           opID(_opID),
                                                           opTime(_opTime),
                                                           writeConcern(_writeConcern),
+                                                          writeConcernKey(
+                                                              makeWriteConcernKey(_writeConcern)),
                                                           condVar(_condVar) {
-            list->push_back(this);
+            list->add(this);
         }
 
         ~WaiterInfo() {
-            list->erase(std::remove(list->begin(), list->end(), this), list->end());
+            list->remove(this);
         }
 
-        std::vector<WaiterInfo*>* list;
+        WaiterList* list;
         bool master; // Set to false to indicate that stepDown was called while waiting
         const unsigned int opID;
         const OpTime* opTime;
         const WriteConcernOptions* writeConcern;
+        const std::string writeConcernKey;
         boost::condition_variable* condVar;
     };
 
+    void ReplicationCoordinatorImpl::WaiterList::add(WaiterInfo* waiter) {
+        _waiters[waiter->writeConcernKey].emplace(*waiter->opTime, waiter);
+    }
+
+    void ReplicationCoordinatorImpl::WaiterList::remove(WaiterInfo* waiter) {
+        auto group = _waiters.find(waiter->writeConcernKey);
+        invariant(group != _waiters.end());
+        auto range = group->second.equal_range(*waiter->opTime);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == waiter) {
+                group->second.erase(it);
+                break;
+            }
+        }
+        if (group->second.empty()) {
+            _waiters.erase(group);
+        }
+    }
+
+    void ReplicationCoordinatorImpl::WaiterList::wakeReady(const IsDoneFn& isDone) {
+        for (auto&& group : _waiters) {
+            for (auto&& entry : group.second) {
+                if (!isDone(*entry.second)) {
+                    // Everyone after this one waits for a later opTime.
+                    break;
+                }
+                entry.second->condVar->notify_all();
+            }
+        }
+    }
+
+    void ReplicationCoordinatorImpl::WaiterList::forEach(
+            const stdx::function<void (WaiterInfo*)>& fn) {
+        for (auto&& group : _waiters) {
+            for (auto&& entry : group.second) {
+                fn(entry.second);
+            }
+        }
+    }
+
+    ReplicationCoordinatorImpl::WaiterInfo*
+            ReplicationCoordinatorImpl::WaiterList::findByOpId(unsigned int opID) {
+        for (auto&& group : _waiters) {
+            for (auto&& entry : group.second) {
+                if (entry.second->opID == opID) {
+                    return entry.second;
+                }
+            }
+        }
+        return nullptr;
+    }
+
 namespace {
     ReplicationCoordinator::Mode getReplicationModeFromSettings(const ReplSettings& settings) {
         if (settings.usingReplSets()) {
@@ -409,11 +483,9 @@ namespace {
                 return;
             }
             fassert(18823, _rsConfigState != kConfigStartingUp);
-            for (std::vector<WaiterInfo*>::iterator it = _replicationWaiterList.begin();
-                    it != _replicationWaiterList.end(); ++it) {
-                WaiterInfo* waiter = *it;
+            _replicationWaiterList.forEach([](WaiterInfo* waiter) {
                 waiter->condVar->notify_all();
-            }
+            });
         }
 
         _replExecutor.shutdown();
@@ -752,11 +824,9 @@ namespace {
             return;
         }
 
-        for (auto& opTimeWaiter : _opTimeWaiterList) {
-            if (*(opTimeWaiter->opTime) <= opTime) {
-                opTimeWaiter->condVar->notify_all();
-            }
-        }
+        _opTimeWaiterList.wakeReady([&opTime](const WaiterInfo& opTimeWaiter) {
+            return *(opTimeWaiter.opTime) <= opTime;
+        });
 
         if (_getMemberState_inlock().primary()) {
             return;
@@ -926,20 +996,14 @@ namespace {
 
     void ReplicationCoordinatorImpl::interrupt(unsigned opId) {
         boost::lock_guard<boost::mutex> lk(_mutex);
-        for (std::vector<WaiterInfo*>::iterator it = _replicationWaiterList.begin();
-                it != _replicationWaiterList.end(); ++it) {
-            WaiterInfo* info = *it;
-            if (info->opID == opId) {
-                info->condVar->notify_all();
-                return;
-            }
+        if (WaiterInfo* info = _replicationWaiterList.findByOpId(opId)) {
+            info->condVar->notify_all();
+            return;
         }
 
-        for (auto& opTimeWaiter : _opTimeWaiterList) {
-            if (opTimeWaiter->opID == opId) {
-                opTimeWaiter->condVar->notify_all();
-                return;
-            }
+        if (WaiterInfo* opTimeWaiter = _opTimeWaiterList.findByOpId(opId)) {
+            opTimeWaiter->condVar->notify_all();
+            return;
         }
 
         _replExecutor.scheduleWork(
@@ -950,15 +1014,9 @@ namespace {
 
     void ReplicationCoordinatorImpl::interruptAll() {
         boost::lock_guard<boost::mutex> lk(_mutex);
-        for (std::vector<WaiterInfo*>::iterator it = _replicationWaiterList.begin();
-                it != _replicationWaiterList.end(); ++it) {
-            WaiterInfo* info = *it;
-            info->condVar->notify_all();
-        }
-
-        for (auto& opTimeWaiter : _opTimeWaiterList) {
-            opTimeWaiter->condVar->notify_all();
-        }
+        const auto notify = [](WaiterInfo* waiter) { waiter->condVar->notify_all(); };
+        _replicationWaiterList.forEach(notify);
+        _opTimeWaiterList.forEach(notify);
 
         _replExecutor.scheduleWork(
                 stdx::bind(&ReplicationCoordinatorImpl::_signalStepDownWaitersFromCallback,
@@ -2066,12 +2124,10 @@ namespace {
         PostMemberStateUpdateAction result;
         if (_memberState.primary() || newState.removed() || newState.rollback()) {
             // Wake up any threads blocked in awaitReplication, close connections, etc.
-            for (std::vector<WaiterInfo*>::iterator it = _replicationWaiterList.begin();
-                 it != _replicationWaiterList.end(); ++it) {
-                WaiterInfo* info = *it;
+            _replicationWaiterList.forEach([](WaiterInfo* info) {
                 info->master = false;
                 info->condVar->notify_all();
-            }
+            });
             _isWaitingForDrainToComplete = false;
             _canAcceptNonLocalWrites = false;
             result = kActionCloseAllConnections;
@@ -2251,13 +2307,9 @@ namespace {
      }
 
     void ReplicationCoordinatorImpl::_wakeReadyWaiters_inlock(){
-        for (std::vector<WaiterInfo*>::iterator it = _replicationWaiterList.begin();
-                it != _replicationWaiterList.end(); ++it) {
-            WaiterInfo* info = *it;
-            if (_doneWaitingForReplication_inlock(*info->opTime, *info->writeConcern)) {
-                info->condVar->notify_all();
-            }
-        }
+        _replicationWaiterList.wakeReady([this](const WaiterInfo& info) {
+            return _doneWaitingForReplication_inlock(*info.opTime, *info.writeConcern);
+        });
     }
 
     Status ReplicationCoordinatorImpl::processReplSetUpdatePosition(
@@ -31,6 +31,7 @@
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
+#include <map>
 #include <vector>
 #include <memory>
 
@@ -49,6 +50,7 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/unordered_map.h"
 #include "mongo/platform/unordered_set.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/net/hostandport.h"
 
 namespace mongo {
@@ -346,6 +348,39 @@ namespace repl {
         // Struct that holds information about clients waiting for replication.
         struct WaiterInfo;
 
+        /**
+         * Set of WaiterInfos, grouped by the write concern they wait for and ordered by opTime
+         * within each group. Satisfying a write concern at some opTime satisfies it at every
+         * earlier opTime, so waking the ready waiters only needs to look at the waiters that are
+         * done, plus one per group. Does *not* own the WaiterInfos.
+         */
+        class WaiterList {
+        public:
+            using IsDoneFn = stdx::function<bool (const WaiterInfo&)>;
+
+            void add(WaiterInfo* waiter);
+            void remove(WaiterInfo* waiter);
+
+            /**
+             * Notifies the waiters for which 'isDone' returns true. 'isDone' must be monotonic in
+             * the opTime waited for by waiters with the same write concern.
+             */
+            void wakeReady(const IsDoneFn& isDone);
+
+            void forEach(const stdx::function<void (WaiterInfo*)>& fn);
+
+            /**
+             * Returns the waiter for operation 'opID', or nullptr if there is none.
+             */
+            WaiterInfo* findByOpId(unsigned int opID);
+
+        private:
+            using WaitersByOpTime = std::multimap<OpTime, WaiterInfo*>;
+
+            // Keyed by WaiterInfo::writeConcernKey. Empty groups are removed.
+            std::map<std::string, WaitersByOpTime> _waiters;
+        };
+
         // Struct that holds information about nodes in this replication group, mainly used for
         // tracking replication progress for write concern satisfaction.
         struct SlaveInfo {
@@ -942,11 +977,11 @@ namespace repl {
 
         // list of information about clients waiting on replication.  Does *not* own the
         // WaiterInfos.
-        std::vector<WaiterInfo*> _replicationWaiterList;                                  // (M)
+        WaiterList _replicationWaiterList;                                                // (M)
 
         // list of information about clients waiting for a particular opTime.
         // Does *not* own the WaiterInfos.
-        std::vector<WaiterInfo*> _opTimeWaiterList;                                       // (M)
+        WaiterList _opTimeWaiterList;                                                     // (M)
 
         // Set to true when we are in the process of shutting down replication.
         bool _inShutdown;                                                                 // (M)
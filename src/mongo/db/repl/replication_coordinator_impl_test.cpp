@@ -752,6 +752,53 @@ namespace {
         awaiter.reset();
     }
 
+    TEST_F(ReplCoordTest, AwaitReplicationWakesOnlySatisfiedWaiters) {
+        OperationContextNoop txn;
+        assertStartSuccess(
+                BSON("_id" << "mySet" <<
+                     "version" << 2 <<
+                     "members" << BSON_ARRAY(BSON("host" << "node1:12345" << "_id" << 0) <<
+                                             BSON("host" << "node2:12345" << "_id" << 1) <<
+                                             BSON("host" << "node3:12345" << "_id" << 2))),
+                HostAndPort("node1", 12345));
+        ASSERT(getReplCoord()->setFollowerMode(MemberState::RS_SECONDARY));
+        getReplCoord()->setMyLastOptime(OpTimeWithTermZero(100, 0));
+        simulateSuccessfulElection();
+
+        OpTimeWithTermZero time1(100, 1);
+        OpTimeWithTermZero time2(100, 2);
+        getReplCoord()->setMyLastOptime(time2);
+
+        WriteConcernOptions twoNodes;
+        twoNodes.wTimeout = WriteConcernOptions::kNoTimeout;
+        twoNodes.wNumNodes = 2;
+        WriteConcernOptions threeNodes = twoNodes;
+        threeNodes.wNumNodes = 3;
+
+        // Waiters for two write concerns, at several opTimes, all waiting at the same time.
+        ReplicationAwaiter awaiter1(getReplCoord(), &txn);
+        awaiter1.setOpTime(time1);
+        awaiter1.setWriteConcern(twoNodes);
+        ReplicationAwaiter awaiter2(getReplCoord(), &txn);
+        awaiter2.setOpTime(time2);
+        awaiter2.setWriteConcern(twoNodes);
+        ReplicationAwaiter awaiter3(getReplCoord(), &txn);
+        awaiter3.setOpTime(time1);
+        awaiter3.setWriteConcern(threeNodes);
+        awaiter1.start(&txn);
+        awaiter2.start(&txn);
+        awaiter3.start(&txn);
+
+        ASSERT_OK(getReplCoord()->setLastOptime_forTest(2, 1, time1));
+        ASSERT_OK(awaiter1.getResult().status);
+
+        ASSERT_OK(getReplCoord()->setLastOptime_forTest(2, 1, time2));
+        ASSERT_OK(awaiter2.getResult().status);
+
+        ASSERT_OK(getReplCoord()->setLastOptime_forTest(2, 2, time1));
+        ASSERT_OK(awaiter3.getResult().status);
+    }
+
     TEST_F(ReplCoordTest, AwaitReplicationTimeout) {
         OperationContextNoop txn;
         assertStartSuccess(
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/db/jsobj.h"
@@ -73,6 +75,24 @@ namespace repl {
          */
         virtual BSONObj findOne(const NamespaceString& nss, const BSONObj& filter) const = 0;
 
+        /**
+         * Fetches the documents of a collection with the given _ids from the sync source, in any
+         * order. Documents which don't exist on the sync source are left out, and documents whose
+         * _id is not one of 'ids' may be returned as well. The default implementation looks up
+         * the documents one at a time with findOne().
+         */
+        virtual std::vector<BSONObj> findByIds(const NamespaceString& nss,
+                                               const std::vector<BSONElement>& ids) const {
+            std::vector<BSONObj> docs;
+            for (const auto& id : ids) {
+                BSONObj doc = findOne(nss, id.wrap("_id"));
+                if (!doc.isEmpty()) {
+                    docs.push_back(doc);
+                }
+            }
+            return docs;
+        }
+
         /**
          * Clones a single collection from the sync source.
          */
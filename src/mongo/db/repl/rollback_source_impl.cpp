@@ -66,6 +66,28 @@ namespace repl {
         return _conn->findOne(nss.toString(), filter, NULL, QueryOption_SlaveOk).getOwned();
     }
 
+    std::vector<BSONObj> RollbackSourceImpl::findByIds(const NamespaceString& nss,
+                                                       const std::vector<BSONElement>& ids) const {
+        BSONObjBuilder query;
+        {
+            BSONObjBuilder idBuilder(query.subobjStart("_id"));
+            BSONArrayBuilder inBuilder(idBuilder.subarrayStart("$in"));
+            for (const auto& id : ids) {
+                inBuilder.append(id);
+            }
+        }
+
+        std::vector<BSONObj> docs;
+        std::unique_ptr<DBClientCursor> cursor =
+            _conn->query(nss.toString(), query.obj(), 0, 0, NULL, QueryOption_SlaveOk);
+        uassert(28775, str::stream() << "rollback could not query " << nss.ns()
+                                     << " on the sync source", cursor.get());
+        while (cursor->more()) {
+            docs.push_back(cursor->nextSafe().getOwned());
+        }
+        return docs;
+    }
+
     void RollbackSourceImpl::copyCollectionFromRemote(OperationContext* txn,
                                                       const NamespaceString& nss) const {
         std::string errmsg;
@@ -56,6 +56,9 @@ namespace repl {
 
         BSONObj findOne(const NamespaceString& nss, const BSONObj& filter) const override;
 
+        std::vector<BSONObj> findByIds(const NamespaceString& nss,
+                                       const std::vector<BSONElement>& ids) const override;
+
         void copyCollectionFromRemote(OperationContext* txn,
                                       const NamespaceString& nss) const override;
 
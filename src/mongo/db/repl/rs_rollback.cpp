@@ -35,6 +35,7 @@
 
 #include <memory>
 
+#include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/catalog/collection.h"
@@ -42,6 +43,7 @@
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/exec/working_set_common.h"
@@ -60,6 +62,7 @@
 #include "mongo/db/repl/roll_back_local_operations.h"
 #include "mongo/db/repl/rollback_source.h"
 #include "mongo/db/repl/rslog.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/log.h"
 
 /* Scenarios
@@ -114,6 +117,31 @@ namespace mongo {
 namespace repl {
 namespace {
 
+    // Most _ids of one collection refetched from the sync source with a single query
+    MONGO_EXPORT_SERVER_PARAMETER(rollbackRefetchBatchSize, int, 1000);
+
+    // Bounds the size of a refetch query when the _ids are large
+    const int kMaxRefetchBatchIdBytes = 1024 * 1024;
+
+    // Rollback progress: the documents which rollbacks had to put back in line with their sync
+    // source, how many of them were refetched so far, and how many were deleted or updated
+    static Counter64 documentsToFixStats;
+    static ServerStatusMetricField<Counter64> displayDocumentsToFix(
+                                                    "repl.rollback.documentsToFix",
+                                                    &documentsToFixStats );
+    static Counter64 documentsRefetchedStats;
+    static ServerStatusMetricField<Counter64> displayDocumentsRefetched(
+                                                    "repl.rollback.documentsRefetched",
+                                                    &documentsRefetchedStats );
+    static Counter64 documentsDeletedStats;
+    static ServerStatusMetricField<Counter64> displayDocumentsDeleted(
+                                                    "repl.rollback.documentsDeleted",
+                                                    &documentsDeletedStats );
+    static Counter64 documentsUpdatedStats;
+    static ServerStatusMetricField<Counter64> displayDocumentsUpdated(
+                                                    "repl.rollback.documentsUpdated",
+                                                    &documentsUpdatedStats );
+
     class RSFatalException : public std::exception {
     public:
         RSFatalException(std::string m = "replica set fatal exception")
@@ -281,27 +309,60 @@ namespace {
 
         BSONObj newMinValid;
 
-        // fetch all the goodVersions of each document from current primary
-        DocID doc;
+        documentsToFixStats.increment(fixUpInfo.toRefetch.size());
+
+        // fetch all the goodVersions of each document from current primary, with one query per
+        // batch of _ids of the same collection
+        const size_t refetchBatchSize = std::max(rollbackRefetchBatchSize, 1);
+        const char* batchNs = "";
         unsigned long long numFetched = 0;
+        time_t lastRefetchProgressUpdate = time(0);
         try {
-            for (set<DocID>::iterator it = fixUpInfo.toRefetch.begin();
-                    it != fixUpInfo.toRefetch.end();
-                    it++) {
-                doc = *it;
+            set<DocID>::const_iterator it = fixUpInfo.toRefetch.begin();
+            while (it != fixUpInfo.toRefetch.end()) {
+                // toRefetch is ordered by namespace first, so each batch is a run of it.
+                batchNs = it->ns;
+                std::vector<DocID> batch;
+                std::vector<BSONElement> ids;
+                int idBytes = 0;
+                for (; it != fixUpInfo.toRefetch.end() && strcmp(it->ns, batchNs) == 0 &&
+                            ids.size() < refetchBatchSize && idBytes < kMaxRefetchBatchIdBytes;
+                        ++it) {
+                    verify(!it->_id.eoo());
+                    batch.push_back(*it);
+                    ids.push_back(it->_id);
+                    idBytes += it->_id.size();
+                }
 
-                verify(!doc._id.eoo());
+                const std::vector<BSONObj> found =
+                    rollbackSource.findByIds(NamespaceString(batchNs), ids);
+                map<BSONElement, BSONObj, BSONElementCmpWithoutField> foundById;
+                for (const auto& good : found) {
+                    BSONElement id = good["_id"];
+                    if (!id.eoo()) {
+                        foundById[id] = good;
+                    }
+                }
 
-                {
-                    // TODO : slow.  lots of round trips.
+                for (const auto& doc : batch) {
                     numFetched++;
-                    BSONObj good = rollbackSource.findOne(NamespaceString(doc.ns), doc._id.wrap());
+                    auto foundIt = foundById.find(doc._id);
+
+                    // note good might be eoo, indicating we should delete it
+                    BSONObj good = foundIt == foundById.end() ? BSONObj() : foundIt->second;
                     totalSize += good.objsize();
                     uassert(13410, "replSet too much data to roll back",
                             totalSize < 300 * 1024 * 1024);
 
-                    // note good might be eoo, indicating we should delete it
-                    goodVersions.push_back(pair<DocID, BSONObj>(doc,good));
+                    goodVersions.push_back(pair<DocID, BSONObj>(doc, good));
+                }
+                documentsRefetchedStats.increment(batch.size());
+
+                time_t now = time(0);
+                if (now - lastRefetchProgressUpdate > 10) {
+                    log() << "rollback refetched " << numFetched << '/'
+                          << fixUpInfo.toRefetch.size() << " documents";
+                    lastRefetchProgressUpdate = now;
                 }
             }
             newMinValid = rollbackSource.getLastOperation();
@@ -312,7 +373,7 @@ namespace {
         }
         catch (const DBException& e) {
             LOG(1) << "rollback re-get objects: " << e.toString();
-            error() << "rollback couldn't re-get ns:" << doc.ns << " _id:" << doc._id << ' '
+            error() << "rollback couldn't re-get from ns:" << batchNs << ' '
                     << numFetched << '/' << fixUpInfo.toRefetch.size();
             throw e;
         }
@@ -560,6 +621,7 @@ namespace {
                     // wasn't on the primary; delete.
                     // TODO 1.6 : can't delete from a capped collection.  need to handle that here.
                     deletes++;
+                    documentsDeletedStats.increment();
 
                     if (collection) {
                         if (collection->isCapped()) {
@@ -636,6 +698,7 @@ namespace {
                     // TODO faster...
                     OpDebug debug;
                     updates++;
+                    documentsUpdatedStats.increment();
 
                     const NamespaceString requestNs(doc.ns);
                     UpdateRequest request(requestNs);
@@ -389,6 +389,63 @@ namespace {
         ASSERT_EQUALS(1, _testRollBackDelete(_txn.get(), _coordinator, doc));
     }
 
+    TEST_F(RSRollbackTest, RollBackDeletesRefetchesDocumentsOfACollectionTogether) {
+        createOplog(_txn.get());
+        _createCollection(_txn.get(), "test.t", CollectionOptions());
+        auto commonOperation =
+            std::make_pair(BSON("ts" << Timestamp(Seconds(1), 0) << "h" << 1LL), RecordId(1));
+        OplogInterfaceMock::Operations localOperations;
+        for (int i = 0; i < 3; i++) {
+            localOperations.push_back(
+                std::make_pair(BSON("ts" << Timestamp(Seconds(4 - i), 0) <<
+                                    "h" << 1LL <<
+                                    "op" << "d" <<
+                                    "ns" << "test.t" <<
+                                    "o" << BSON("_id" << 2 - i)),
+                               RecordId(4 - i)));
+        }
+        localOperations.push_back(commonOperation);
+        class RollbackSourceLocal : public RollbackSourceMock {
+        public:
+            RollbackSourceLocal(std::unique_ptr<OplogInterface> oplog)
+                : RollbackSourceMock(std::move(oplog)),
+                  calls(0) { }
+            std::vector<BSONObj> findByIds(const NamespaceString& nss,
+                                           const std::vector<BSONElement>& ids) const override {
+                calls++;
+                lastIds = ids.size();
+                // Only the first and last documents still exist on the sync source.
+                return {BSON("_id" << 2 << "a" << 2), BSON("_id" << 0 << "a" << 0)};
+            }
+            mutable int calls;
+            mutable size_t lastIds;
+        };
+        RollbackSourceLocal rollbackSource(
+            std::unique_ptr<OplogInterface>(new OplogInterfaceMock({
+                commonOperation,
+        })));
+        OpTime opTime(localOperations.front().first["ts"].timestamp(),
+                      localOperations.front().first["h"].Long());
+        ASSERT_OK(
+            syncRollback(
+                _txn.get(),
+                opTime,
+                OplogInterfaceMock(localOperations),
+                rollbackSource,
+                _coordinator,
+                noSleep));
+        ASSERT_EQUALS(1, rollbackSource.calls);
+        ASSERT_EQUALS(3U, rollbackSource.lastIds);
+
+        Lock::DBLock dbLock(_txn->lockState(), "test", MODE_S);
+        Lock::CollectionLock collLock(_txn->lockState(), "test.t", MODE_S);
+        auto db = dbHolder().get(_txn.get(), "test");
+        ASSERT_TRUE(db);
+        auto collection = db->getCollection("test.t");
+        ASSERT_TRUE(collection);
+        ASSERT_EQUALS(2, collection->getRecordStore()->numRecords(_txn.get()));
+    }
+
     TEST_F(RSRollbackTest, RollbackUnknownCommand) {
         createOplog(_txn.get());
         auto commonOperation =
@@ -33,10 +33,10 @@
 
 #include "mongo/db/repl/sync_tail.h"
 
+#include <algorithm>
 #include <boost/functional/hash.hpp>
-#include <boost/ref.hpp>
+#include <functional>
 #include <memory>
-#include "third_party/murmurhash3/MurmurHash3.h"
 
 #include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -58,7 +58,11 @@
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replica_set_config.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/db/stats/timer_stats.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -70,21 +74,133 @@ namespace mongo {
 
 namespace repl {
 #if defined(MONGO_PLATFORM_64)
-    const int replWriterThreadCount = 16;
+    const int kDefaultReplWriterThreadCount = 16;
     const int replPrefetcherThreadCount = 16;
 #elif defined(MONGO_PLATFORM_32)
-    const int replWriterThreadCount = 2;
+    const int kDefaultReplWriterThreadCount = 2;
     const int replPrefetcherThreadCount = 2;
 #else
 #error need to include something that defines MONGO_PLATFORM_XX
 #endif
 
+    const int kMaxReplWriterThreadCount = 256;
+
+    // Number of threads which apply the ops of each batch. Changes made at runtime take effect
+    // from the next batch on.
+    int replWriterThreadCount = kDefaultReplWriterThreadCount;
+
+    class ReplWriterThreadCountParameter : public ExportedServerParameter<int> {
+    public:
+        ReplWriterThreadCountParameter() :
+            ExportedServerParameter<int>(ServerParameterSet::getGlobal(),
+                                         "replWriterThreadCount",
+                                         &replWriterThreadCount,
+                                         true,
+                                         true) {}
+
+        virtual Status validate(const int& potentialNewValue) {
+            if (potentialNewValue < 1 || potentialNewValue > kMaxReplWriterThreadCount) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "replWriterThreadCount must be between 1 and "
+                                            << kMaxReplWriterThreadCount);
+            }
+            return Status::OK();
+        }
+    } replWriterThreadCountParameter;
+
+    // With storage engines other than MMAPv1, whether the prefetcher threads read the documents
+    // and index keys of a batch into the cache while the writer threads apply it.
+    MONGO_EXPORT_SERVER_PARAMETER(replPrefetchWhileApplying, bool, true);
+
+    // Ops which the writer threads finished applying before the prefetcher threads got to them
+    static Counter64 prefetchSkippedStats;
+    static ServerStatusMetricField<Counter64> displayPrefetchSkipped( "repl.preload.skippedOps",
+                                                                      &prefetchSkippedStats );
+
+    // A batch is repartitioned when its largest writer vector has more than this many times the
+    // average number of ops, and it has at least kMinOpsToRebalance ops.
+    const size_t kWriterSkewRatio = 2;
+    const size_t kMinOpsToRebalance = 100;
+
     static Counter64 opsAppliedStats;
 
     //The oplog entries applied
     static ServerStatusMetricField<Counter64> displayOpsApplied( "repl.apply.ops",
                                                                 &opsAppliedStats );
 
+    // Consecutive inserts into the same collection which the writer threads applied together,
+    // and the number of such groups
+    static Counter64 groupedInsertOpsStats;
+    static ServerStatusMetricField<Counter64> displayGroupedInsertOps(
+                                                    "repl.apply.groupedInserts.ops",
+                                                    &groupedInsertOpsStats );
+    static Counter64 groupedInsertGroupsStats;
+    static ServerStatusMetricField<Counter64> displayGroupedInsertGroups(
+                                                    "repl.apply.groupedInserts.groups",
+                                                    &groupedInsertGroupsStats );
+
+    // Most inserts applied in one write unit of work
+    const size_t kMaxInsertGroupSize = 64;
+
+    // Batches whose ops were repartitioned because they were skewed towards some writers
+    static Counter64 rebalancedBatchesStats;
+    static ServerStatusMetricField<Counter64> displayRebalancedBatches(
+                                                    "repl.apply.rebalancedBatches",
+                                                    &rebalancedBatchesStats );
+
+    // Time spent and ops applied by each writer thread, and the distribution of the time each
+    // writer spent on its part of a batch
+    static TimerStats writerApplyStats[kMaxReplWriterThreadCount];
+    static Counter64 writerOpsStats[kMaxReplWriterThreadCount];
+    static LatencyHistogram writerApplyHistograms[kMaxReplWriterThreadCount];
+
+    class WriterStatsMetric : public ServerStatusMetric {
+    public:
+        WriterStatsMetric() : ServerStatusMetric("repl.apply.writers") {}
+
+        virtual void appendAtLeaf(BSONObjBuilder& b) const {
+            BSONArrayBuilder writersB(b.subarrayStart(_leafName));
+            const int writerCount = replWriterThreadCount;
+            for (int i = 0; i < writerCount; i++) {
+                BSONObjBuilder writerB(writersB.subobjStart());
+                writerB.appendElements(writerApplyStats[i].getReport());
+                writerB.append("ops", writerOpsStats[i].get());
+                {
+                    BSONObjBuilder histogramB(writerB.subobjStart("applyMicros"));
+                    writerApplyHistograms[i].append(&histogramB);
+                }
+                writerB.done();
+            }
+            writersB.done();
+        }
+    } writerStatsMetric;
+
+    // Tasks queued, run and stolen by the threads of the writer and prefetcher pools, which last
+    // across the writer pool being resized
+    static WorkStealingPool::Stats writerPoolStats;
+    static WorkStealingPool::Stats prefetcherPoolStats;
+
+    class PoolStatsMetric : public ServerStatusMetric {
+    public:
+        PoolStatsMetric(const std::string& name, const WorkStealingPool::Stats* stats)
+            : ServerStatusMetric(name), _stats(stats) {}
+
+        virtual void appendAtLeaf(BSONObjBuilder& b) const {
+            BSONObjBuilder poolB(b.subobjStart(_leafName));
+            poolB.append("queued", _stats->queued.load());
+            poolB.append("tasks", _stats->tasksRun.load());
+            poolB.append("steals", _stats->steals.load());
+            poolB.done();
+        }
+
+    private:
+        const WorkStealingPool::Stats* const _stats;
+    };
+
+    static PoolStatsMetric displayWriterPool("repl.apply.writerPool", &writerPoolStats);
+    static PoolStatsMetric displayPrefetcherPool("repl.apply.prefetcherPool",
+                                                 &prefetcherPoolStats);
+
     MONGO_FP_DECLARE(rsSyncApplyStop);
 
     // Number and time of each ApplyOps worker pool round
@@ -92,6 +208,30 @@ namespace repl {
     static ServerStatusMetricField<TimerStats> displayOpBatchesApplied(
                                                     "repl.apply.batches",
                                                     &applyBatchStats );
+
+    // The distributions of how long a batch took to collect from the buffer, of its size, of how
+    // long it took to apply from start to end, and of the waits for the fsync lock and for the
+    // batch to be durable
+    static LatencyHistogram batchFormationHistogram;
+    static ServerStatusHistogramMetric displayBatchFormation( "repl.apply.batchFormationMicros",
+                                                              &batchFormationHistogram );
+    static LatencyHistogram batchOpsHistogram;
+    static ServerStatusHistogramMetric displayBatchOps( "repl.apply.batchSizeOps",
+                                                        &batchOpsHistogram,
+                                                        "totalOps" );
+    static LatencyHistogram batchBytesHistogram;
+    static ServerStatusHistogramMetric displayBatchBytes( "repl.apply.batchSizeBytes",
+                                                          &batchBytesHistogram,
+                                                          "totalBytes" );
+    static LatencyHistogram batchApplyHistogram;
+    static ServerStatusHistogramMetric displayBatchApply( "repl.apply.batchMicros",
+                                                          &batchApplyHistogram );
+    static LatencyHistogram fsyncLockWaitHistogram;
+    static ServerStatusHistogramMetric displayFsyncLockWait( "repl.apply.fsyncLockWaitMicros",
+                                                             &fsyncLockWaitHistogram );
+    static LatencyHistogram durableWaitHistogram;
+    static ServerStatusHistogramMetric displayDurableWait( "repl.apply.waitUntilDurableMicros",
+                                                           &durableWaitHistogram );
     void initializePrefetchThread() {
         if (!ClientBasic::getCurrent()) {
             Client::initThreadIfNotAlready();
@@ -113,16 +253,39 @@ namespace repl {
     SyncTail::SyncTail(BackgroundSyncInterface *q, MultiSyncApplyFunc func) :
         _networkQueue(q), 
         _applyFunc(func),
-        _writerPool(replWriterThreadCount, "repl writer worker "),
-        _prefetcherPool(replPrefetcherThreadCount, "repl prefetch worker ")
+        _writerPool(new WorkStealingPool(replWriterThreadCount,
+                                         "repl writer worker ",
+                                         &writerPoolStats)),
+        _prefetcherPool(replPrefetcherThreadCount,
+                        "repl prefetch worker ",
+                        &prefetcherPoolStats)
     {}
 
     SyncTail::~SyncTail() {}
 
+    WorkStealingPool* SyncTail::_getWriterPool() {
+        const int threadCount = replWriterThreadCount;
+        if (_writerPool->getNumThreads() != threadCount) {
+            log() << "changing the number of repl writer threads from "
+                  << _writerPool->getNumThreads() << " to " << threadCount;
+
+            // The pool is idle between batches, so its threads exit right away
+            _writerPool.reset(new WorkStealingPool(threadCount,
+                                                   "repl writer worker ",
+                                                   &writerPoolStats));
+        }
+
+        return _writerPool.get();
+    }
+
     bool SyncTail::peek(BSONObj* op) {
         return _networkQueue->peek(op);
     }
 
+    bool SyncTail::peek(BSONObj* op, OplogEntryHeader* header) {
+        return _networkQueue->peek(op, header);
+    }
+
     // static
     Status SyncTail::syncApply(OperationContext* txn,
                                const BSONObj &op,
@@ -248,7 +411,7 @@ namespace repl {
 namespace {
 
     // The pool threads call this to prefetch each op
-    void prefetchOp(const BSONObj& op) {
+    void prefetchOp(const BSONObj& op, bool whileApplying) {
         initializePrefetchThread();
 
         const char *ns = op.getStringField("ns");
@@ -257,6 +420,10 @@ namespace {
                 // one possible tweak here would be to stay in the read lock for this database 
                 // for multiple prefetches if they are for the same database.
                 OperationContextImpl txn;
+
+                // the applier holds the parallel batch writer mode lock, which keeps out
+                // everything but the batch's own threads
+                txn.lockState()->setIsBatchWriter(whileApplying);
                 AutoGetCollectionForRead ctx(&txn, ns);
                 Database* db = ctx.getDb();
                 if (db) {
@@ -273,67 +440,190 @@ namespace {
         }
     }
 
+    void prefetchOpTask(void* op) {
+        prefetchOp(*static_cast<const BSONObj*>(op), false);
+    }
+
     // Doles out all the work to the reader pool threads and waits for them to complete
     void prefetchOps(const std::deque<BSONObj>& ops,
-                               threadpool::ThreadPool* prefetcherPool) {
+                               WorkStealingPool* prefetcherPool) {
         invariant(prefetcherPool);
+        WorkStealingPool::TaskGroup prefetches;
         for (std::deque<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
              ++it) {
-            prefetcherPool->schedule(&prefetchOp, *it);
+            prefetcherPool->schedule(&prefetches, prefetchOpTask, const_cast<BSONObj*>(&*it));
         }
-        prefetcherPool->join();
+        prefetches.join();
     }
 
+    /**
+     * Prefetches the ops of a batch on the prefetcher pool while the writer threads apply it,
+     * through the storage API, for engines which do not prefetch the batch before applying it.
+     * The ops are scheduled in oplog order as soon as the batch is formed, so that they run
+     * ahead of the writers; the ones left when the writers are done are skipped.
+     */
+    class ConcurrentPrefetcher {
+        MONGO_DISALLOW_COPYING(ConcurrentPrefetcher);
+    public:
+        ConcurrentPrefetcher(const std::deque<BSONObj>& ops, WorkStealingPool* prefetcherPool)
+            : _tasks(ops.size()) {
+            for (size_t i = 0; i < ops.size(); i++) {
+                _tasks[i].op = &ops[i];
+                _tasks[i].applied = &_applied;
+                prefetcherPool->schedule(&_prefetches, _prefetchTask, &_tasks[i]);
+            }
+        }
+
+        ~ConcurrentPrefetcher() {
+            _applied.store(1);
+            _prefetches.join();
+        }
+
+    private:
+        struct Task {
+            const BSONObj* op;
+            const AtomicUInt32* applied;
+        };
+
+        static void _prefetchTask(void* arg) {
+            const Task* task = static_cast<const Task*>(arg);
+            if (task->applied->load()) {
+                prefetchSkippedStats.increment();
+                return;
+            }
+            prefetchOp(*task->op, true);
+        }
+
+        std::vector<Task> _tasks;
+        AtomicUInt32 _applied;
+        WorkStealingPool::TaskGroup _prefetches;
+    };
+
     // Doles out all the work to the writer pool threads and waits for them to complete
+    // The pool threads call this to apply the ops of writer vector 'writerId'
+    void applyWriterVector(SyncTail::MultiSyncApplyFunc func,
+                           const std::vector<BSONObj>& ops,
+                           SyncTail* sync,
+                           size_t writerId) {
+        TimerHolder timer(&writerApplyStats[writerId]);
+        Timer histogramTimer;
+        func(ops, sync);
+        writerOpsStats[writerId].increment(ops.size());
+        writerApplyHistograms[writerId].record(histogramTimer.micros());
+    }
+
+    // The arguments of applyWriterVector, for scheduling it on the writer pool
+    struct WriterVectorTask {
+        SyncTail::MultiSyncApplyFunc func;
+        const std::vector<BSONObj>* ops;
+        SyncTail* sync;
+        size_t writerId;
+    };
+
+    void applyWriterVectorTask(void* arg) {
+        const WriterVectorTask* task = static_cast<const WriterVectorTask*>(arg);
+        applyWriterVector(task->func, *task->ops, task->sync, task->writerId);
+    }
+
     void applyOps(const std::vector< std::vector<BSONObj> >& writerVectors,
-                            threadpool::ThreadPool* writerPool,
+                            WorkStealingPool* writerPool,
                             SyncTail::MultiSyncApplyFunc func,
                             SyncTail* sync) {
         TimerHolder timer(&applyBatchStats);
-        for (std::vector< std::vector<BSONObj> >::const_iterator it = writerVectors.begin();
-             it != writerVectors.end();
-             ++it) {
-            if (!it->empty()) {
-                writerPool->schedule(func, boost::cref(*it), sync);
+        WriterVectorTask tasks[kMaxReplWriterThreadCount];
+        invariant(writerVectors.size() <= static_cast<size_t>(kMaxReplWriterThreadCount));
+
+        WorkStealingPool::TaskGroup writes;
+        for (size_t i = 0; i < writerVectors.size(); i++) {
+            if (!writerVectors[i].empty()) {
+                tasks[i].func = func;
+                tasks[i].ops = &writerVectors[i];
+                tasks[i].sync = sync;
+                tasks[i].writerId = i;
+                writerPool->schedule(&writes, applyWriterVectorTask, &tasks[i]);
             }
         }
-        writerPool->join();
+        writes.join();
     }
 
-    void fillWriterVectors(const std::deque<BSONObj>& ops,
-                           std::vector< std::vector<BSONObj> >* writerVectors) {
+    bool isSkewed(const std::deque<BSONObj>& ops,
+                  const std::vector< std::vector<BSONObj> >& writerVectors) {
+        if (writerVectors.size() < 2 || ops.size() < kMinOpsToRebalance) {
+            return false;
+        }
 
-        for (std::deque<BSONObj>::const_iterator it = ops.begin();
-             it != ops.end();
-             ++it) {
-            const BSONElement e = it->getField("ns");
-            verify(e.type() == String);
-            const char* ns = e.valuestr();
-            int len = e.valuestrsize();
-            uint32_t hash = 0;
-            MurmurHash3_x86_32( ns, len, 0, &hash);
-
-            const char* opType = it->getField( "op" ).valuestrsafe();
-
-            if (getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking() &&
-                isCrudOpType(opType)) {
-                BSONElement id;
-                switch (opType[0]) {
-                case 'u':
-                    id = it->getField("o2").Obj()["_id"];
-                    break;
-                case 'd':
-                case 'i':
-                    id = it->getField("o").Obj()["_id"];
-                    break;
+        size_t largest = 0;
+        for (const auto& writerVector : writerVectors) {
+            largest = std::max(largest, writerVector.size());
+        }
+
+        return largest * writerVectors.size() > kWriterSkewRatio * ops.size();
+    }
+
+    /**
+     * Reassigns the partitions of a skewed batch, largest first, each to the writer which has the
+     * fewest ops so far. The ops of a partition stay together and in order, so this is as safe as
+     * the hashed assignment, but several large partitions no longer end up on the same writer.
+     */
+    void rebalanceWriterVectors(const std::deque<BSONObj>& ops,
+                                const std::vector<uint32_t>& hashes,
+                                std::vector< std::vector<BSONObj> >* writerVectors) {
+        unordered_map<uint32_t, std::vector<size_t>> partitions;
+        for (size_t i = 0; i < ops.size(); i++) {
+            partitions[hashes[i]].push_back(i);
+        }
+
+        std::vector<std::pair<size_t, uint32_t>> bySize;
+        bySize.reserve(partitions.size());
+        for (const auto& partition : partitions) {
+            bySize.push_back(std::make_pair(partition.second.size(), partition.first));
+        }
+        std::sort(bySize.begin(), bySize.end(), std::greater<std::pair<size_t, uint32_t>>());
+
+        for (auto& writerVector : *writerVectors) {
+            writerVector.clear();
+        }
+
+        for (const auto& partition : bySize) {
+            std::vector<BSONObj>* smallest = &writerVectors->front();
+            for (auto& writerVector : *writerVectors) {
+                if (writerVector.size() < smallest->size()) {
+                    smallest = &writerVector;
                 }
+            }
 
-                const size_t idHash = BSONElement::Hasher()( id );
-                MurmurHash3_x86_32(&idHash, sizeof(idHash), hash, &hash);
+            for (size_t i : partitions[partition.second]) {
+                smallest->push_back(ops[i]);
             }
+        }
+
+        rebalancedBatchesStats.increment();
+    }
+
+    void fillWriterVectors(const SyncTail::OpQueue& opQueue,
+                           std::vector< std::vector<BSONObj> >* writerVectors) {
+
+        const std::deque<BSONObj>& ops = opQueue.getDeque();
+        const std::deque<OplogEntryHeader>& headers = opQueue.getHeaders();
+        invariant(ops.size() == headers.size());
+
+        const bool supportsDocLocking =
+            getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking();
 
-            (*writerVectors)[hash % writerVectors->size()].push_back(*it);
+        // The partition of each op: ops of the same partition must be applied in order by the same
+        // writer, others may be applied concurrently
+        std::vector<uint32_t> hashes;
+        hashes.reserve(ops.size());
+
+        for (size_t i = 0; i < ops.size(); i++) {
+            const uint32_t hash = headers[i].partitionHash(supportsDocLocking);
+            (*writerVectors)[hash % writerVectors->size()].push_back(ops[i]);
+            hashes.push_back(hash);
+        }
+
+        if (isSkewed(ops, *writerVectors)) {
+            rebalanceWriterVectors(ops, hashes, writerVectors);
         }
     }
 
@@ -343,8 +633,8 @@ namespace {
     // static
     OpTime SyncTail::multiApply(OperationContext* txn,
                                 const OpQueue& ops,
-                                threadpool::ThreadPool* prefetcherPool,
-                                threadpool::ThreadPool* writerPool,
+                                WorkStealingPool* prefetcherPool,
+                                WorkStealingPool* writerPool,
                                 MultiSyncApplyFunc func,
                                 SyncTail* sync,
                                 bool supportsWaitingUntilDurable) {
@@ -353,19 +643,29 @@ namespace {
         invariant(func);
         invariant(sync);
 
+        Timer batchTimer;
+        batchOpsHistogram.record(ops.getDeque().size());
+        batchBytesHistogram.record(ops.getSize());
+
+        std::unique_ptr<ConcurrentPrefetcher> concurrentPrefetcher;
         if (getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
-            // Use a ThreadPool to prefetch all the operations in a batch.
+            // Use the prefetcher pool to prefetch all the operations in a batch.
             prefetchOps(ops.getDeque(), prefetcherPool);
         }
-        
-        std::vector< std::vector<BSONObj> > writerVectors(replWriterThreadCount);
+        else if (replPrefetchWhileApplying) {
+            concurrentPrefetcher.reset(new ConcurrentPrefetcher(ops.getDeque(), prefetcherPool));
+        }
+
+        std::vector< std::vector<BSONObj> > writerVectors(writerPool->getNumThreads());
 
-        fillWriterVectors(ops.getDeque(), &writerVectors);
+        fillWriterVectors(ops, &writerVectors);
         LOG(2) << "replication batch size is " << ops.getDeque().size() << endl;
         // We must grab this because we're going to grab write locks later.
         // We hold this mutex the entire time we're writing; it doesn't matter
         // because all readers are blocked anyway.
+        Timer fsyncLockWaitTimer;
         SimpleMutex::scoped_lock fsynclk(filesLockedFsync);
+        fsyncLockWaitHistogram.record(fsyncLockWaitTimer.micros());
 
         // stop all readers until we're done
         Lock::ParallelBatchWriterMode pbwm(txn->lockState());
@@ -379,6 +679,7 @@ namespace {
         }
 
         applyOps(writerVectors, writerPool, func, sync);
+        concurrentPrefetcher.reset();
 
         if (inShutdown()) {
             return OpTime();
@@ -393,7 +694,9 @@ namespace {
         OpTime lastOpTime = writeOpsToOplog(txn, ops.getDeque());
 
         if (mustWaitUntilDurable) {
+            Timer durableWaitTimer;
             txn->recoveryUnit()->waitUntilDurable();
+            durableWaitHistogram.record(durableWaitTimer.micros());
         }
         ReplClientInfo::forClient(txn->getClient()).setLastOp(lastOpTime);
         replCoord->setMyLastOptime(lastOpTime);
@@ -401,6 +704,7 @@ namespace {
 
         BackgroundSync::get()->notify(txn);
 
+        batchApplyHistogram.record(batchTimer.micros());
         return lastOpTime;
     }
 
@@ -454,7 +758,7 @@ namespace {
             const OpTime lastOpTime = multiApply(txn,
                                                  ops,
                                                  &_prefetcherPool,
-                                                 &_writerPool,
+                                                 _getWriterPool(),
                                                  _applyFunc,
                                                  this,
                                                  supportsWaitingUntilDurable());
@@ -570,6 +874,7 @@ namespace {
             if (ops.empty()) {
                 continue;
             }
+            batchFormationHistogram.record(batchTimer.micros());
 
             const BSONObj lastOp = ops.back();
             handleSlaveDelay(lastOp);
@@ -581,7 +886,7 @@ namespace {
             multiApply(&txn,
                        ops,
                        &_prefetcherPool,
-                       &_writerPool,
+                       _getWriterPool(),
                        _applyFunc,
                        this,
                        supportsWaitingUntilDurable());
@@ -599,8 +904,9 @@ namespace {
                                         SyncTail::OpQueue* ops,
                                         ReplicationCoordinator* replCoord) {
         BSONObj op;
+        OplogEntryHeader header;
         // Check to see if there are ops waiting in the bgsync queue
-        bool peek_success = peek(&op);
+        bool peek_success = peek(&op, &header);
 
         if (!peek_success) {
             // if we don't have anything in the queue, wait a bit for something to appear
@@ -624,17 +930,11 @@ namespace {
             return true;
         }
 
-        const char* ns = op["ns"].valuestrsafe();
-
-        // check for commands
-        if ((op["op"].valuestrsafe()[0] == 'c') ||
-            // Index builds are acheived through the use of an insert op, not a command op.
-            // The following line is the same as what the insert code uses to detect an index build.
-            ( *ns != '\0' && nsToCollectionSubstring(ns) == "system.indexes" )) {
-
+        // check for commands and index builds
+        if (header.applyAlone) {
             if (ops->empty()) {
                 // apply commands one-at-a-time
-                ops->push_back(op);
+                ops->push_back(op, header);
                 _networkQueue->consume();
             }
 
@@ -643,22 +943,14 @@ namespace {
         }
 
         // check for oplog version change
-        BSONElement elemVersion = op["v"];
-        int curVersion = 0;
-        if (elemVersion.eoo())
-            // missing version means version 1
-            curVersion = 1;
-        else
-            curVersion = elemVersion.Int();
-        
-        if (curVersion != OPLOG_VERSION) {
+        if (header.version != OPLOG_VERSION) {
             severe() << "expected oplog version " << OPLOG_VERSION << " but found version " 
-                     << curVersion << " in oplog entry: " << op;
+                     << header.version << " in oplog entry: " << op;
             fassertFailedNoTrace(18820);
         }
     
         // Copy the op to the deque and remove it from the bgsync queue.
-        ops->push_back(op);
+        ops->push_back(op, header);
         _networkQueue->consume();
 
         // Go back for more ops
@@ -816,6 +1108,92 @@ namespace {
         }
     }
 
+    static bool isGroupableInsert(const BSONObj& op) {
+        const char* ns = op.getStringField("ns");
+        return str::equals(op.getStringField("op"), "i") &&
+               nsIsFull(ns) &&
+               nsToCollectionSubstring(ns) != "system.indexes" &&
+               op["o"].isABSONObj();
+    }
+
+    /**
+     * Returns the end of the group of inserts into the same collection which starts at 'begin',
+     * which is 'begin' + 1 if 'begin' can't be applied as part of a group.
+     */
+    static std::vector<BSONObj>::const_iterator endOfInsertGroup(
+                                        std::vector<BSONObj>::const_iterator begin,
+                                        std::vector<BSONObj>::const_iterator end) {
+        std::vector<BSONObj>::const_iterator it = begin + 1;
+        if (!isGroupableInsert(*begin)) {
+            return it;
+        }
+
+        const char* ns = begin->getStringField("ns");
+        while (it != end &&
+               static_cast<size_t>(it - begin) < kMaxInsertGroupSize &&
+               isGroupableInsert(*it) &&
+               str::equals(it->getStringField("ns"), ns)) {
+            ++it;
+        }
+
+        return it;
+    }
+
+    /**
+     * Inserts the documents of the insert ops ['begin', 'end') into their collection in one write
+     * unit of work, instead of the upsert per op which syncApply() does.
+     *
+     * @return false if the collection doesn't exist yet or any document couldn't be inserted, in
+     *     which case nothing was and the ops must be applied one at a time.
+     */
+    static bool applyInsertGroup(OperationContext* txn,
+                                 std::vector<BSONObj>::const_iterator begin,
+                                 std::vector<BSONObj>::const_iterator end) {
+        const char* ns = begin->getStringField("ns");
+        const StringData dbName = nsToDatabaseSubstring(ns);
+
+        try {
+            MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                Lock::DBLock dbLock(txn->lockState(), dbName, MODE_IX);
+                Lock::CollectionLock collectionLock(txn->lockState(), ns, MODE_IX);
+
+                Database* const db = dbHolder().get(txn, dbName);
+                Collection* const collection = db ? db->getCollection(ns) : nullptr;
+                if (!collection || collection->isCapped()) {
+                    return false;
+                }
+
+                WriteUnitOfWork wunit(txn);
+
+                for (std::vector<BSONObj>::const_iterator it = begin; it != end; ++it) {
+                    BSONObj doc = (*it)["o"].Obj();
+                    if (!doc.hasField("_id")) {
+                        return false;
+                    }
+
+                    // Inserts which were already applied, e.g. when replaying the oplog, fail
+                    // with a duplicate key here and get applied as upserts instead
+                    if (!collection->insertDocument(txn, doc, false).isOK()) {
+                        return false;
+                    }
+                }
+
+                wunit.commit();
+            } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "syncApply_insertGroup", ns);
+        }
+        catch (const DBException& e) {
+            LOG(2) << "applying inserts into " << ns << " one at a time" << causedBy(e);
+            return false;
+        }
+
+        const size_t numOps = end - begin;
+        replOpCounters.incInsertInWriteLock(numOps);
+        opsAppliedStats.increment(numOps);
+        groupedInsertOpsStats.increment(numOps);
+        groupedInsertGroupsStats.increment();
+        return true;
+    }
+
     // This free function is used by the writer threads to apply each op
     void multiSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
         initializeWriterThread();
@@ -832,6 +1210,13 @@ namespace {
         for (std::vector<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
              ++it) {
+            // Consecutive inserts into the same collection are applied together
+            std::vector<BSONObj>::const_iterator groupEnd = endOfInsertGroup(it, ops.end());
+            if (groupEnd - it > 1 && applyInsertGroup(&txn, it, groupEnd)) {
+                it = groupEnd - 1;
+                continue;
+            }
+
             try {
                 if (!SyncTail::syncApply(&txn, *it, convertUpdatesToUpserts).isOK()) {
                     fassertFailedNoTrace(16359);
@@ -29,12 +29,14 @@
 #pragma once
 
 #include <deque>
+#include <memory>
 
 #include "mongo/base/status.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/db/repl/oplog_entry_header.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/stdx/functional.h"
-#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/work_stealing_pool.h"
 
 namespace mongo {
 
@@ -102,14 +104,17 @@ namespace repl {
 
         void oplogApplication();
         bool peek(BSONObj* obj);
+        bool peek(BSONObj* obj, OplogEntryHeader* header);
 
         class OpQueue {
         public:
             OpQueue() : _size(0) {}
             size_t getSize() const { return _size; }
             const std::deque<BSONObj>& getDeque() const { return _deque; }
-            void push_back(BSONObj& op) {
+            const std::deque<OplogEntryHeader>& getHeaders() const { return _headers; }
+            void push_back(BSONObj& op, const OplogEntryHeader& header) {
                 _deque.push_back(op);
+                _headers.push_back(header);
                 _size += op.objsize();
             }
             bool empty() const {
@@ -123,6 +128,7 @@ namespace repl {
 
         private:
             std::deque<BSONObj> _deque;
+            std::deque<OplogEntryHeader> _headers;
             size_t _size;
         };
 
@@ -159,8 +165,8 @@ namespace repl {
         // Returns the last OpTime applied.
         static OpTime multiApply(OperationContext* txn,
                                  const OpQueue& ops,
-                                 threadpool::ThreadPool* prefetcherPool,
-                                 threadpool::ThreadPool* writerPool,
+                                 WorkStealingPool* prefetcherPool,
+                                 WorkStealingPool* writerPool,
                                  MultiSyncApplyFunc func,
                                  SyncTail* sync,
                                  bool supportsAwaitingCommit);
@@ -182,10 +188,16 @@ namespace repl {
 
         void handleSlaveDelay(const BSONObj& op);
 
+        /**
+         * Returns the pool of writer threads, first resizing it to replWriterThreadCount if that
+         * was changed since the last batch. Must only be called between batches.
+         */
+        WorkStealingPool* _getWriterPool();
+
         // persistent pool of worker threads for writing ops to the databases
-        threadpool::ThreadPool _writerPool;
+        std::unique_ptr<WorkStealingPool> _writerPool;
         // persistent pool of worker threads for prefetching
-        threadpool::ThreadPool _prefetcherPool;
+        WorkStealingPool _prefetcherPool;
 
     };
 
@@ -0,0 +1,408 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sampling_profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+#include "mongo/config.h"
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/stacktrace.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    // How many times a second of CPU time the stack of the thread using it is sampled, or 0 to not
+    // sample. The _cpuProfilerStart command needs the same signal, so needs this to be 0.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(cpuSamplingProfilerHz, int, 19);
+
+namespace {
+
+#if defined(MONGO_CONFIG_HAVE___THREAD)
+    __thread const char* threadOp;
+#elif defined(MONGO_CONFIG_HAVE___DECLSPEC_THREAD)
+    __declspec( thread ) const char* threadOp;
+#else
+    // Without thread locals the samples aren't labelled
+    const char* const threadOp = NULL;
+#endif
+
+    void setThreadOp(const char* op) {
+#if defined(MONGO_CONFIG_HAVE___THREAD) || defined(MONGO_CONFIG_HAVE___DECLSPEC_THREAD)
+        threadOp = op;
+#endif
+    }
+
+#if !defined(_WIN32)
+    const int kMaxHz = 1000;
+    const int kMaxFrames = 64;
+
+    // The signal handler writes each sample to a free slot, which the aggregator empties every
+    // second, so that the handler neither locks nor allocates.
+    const size_t kNumSlots = 1024;
+
+    enum SlotState { kEmpty, kWriting, kFull };
+
+    struct Slot {
+        AtomicUInt32 state;
+        const char* op;
+        int numFrames;
+        void* frames[kMaxFrames];
+    };
+
+    Slot* slots = NULL;
+    AtomicUInt32 nextSlot;
+    AtomicUInt64 droppedSamples;
+
+    // Past this many distinct stacks, the samples of new ones are counted as their op only
+    const size_t kMaxStacks = 20 * 1000;
+
+    // Leaves room under the document size limit for the rest of the command's result
+    const int kMaxResultBytes = 8 * 1024 * 1024;
+
+    const char kNoOp[] = "other";
+    const char kTruncatedFrames[] = "[truncated]";
+    const char kTooManyStacks[] = "[too many stacks]";
+#endif
+
+}  // namespace
+
+#if !defined(_WIN32)
+    /**
+     * The SIGPROF handler. It is outside of the unnamed namespace so that it has a symbol, by which
+     * its frames and those of the signal delivery are left out of the samples.
+     */
+    void samplingProfilerSignalHandler(int) {
+        const int savedErrno = errno;
+        Slot& slot = slots[nextSlot.fetchAndAdd(1) % kNumSlots];
+        if (slot.state.compareAndSwap(kEmpty, kWriting) != kEmpty) {
+            droppedSamples.fetchAndAdd(1);
+        }
+        else {
+            slot.op = threadOp;
+            slot.numFrames = rawBacktrace(slot.frames, kMaxFrames);
+            slot.state.store(kFull);
+        }
+        errno = savedErrno;
+    }
+#endif
+
+namespace {
+
+#if !defined(_WIN32)
+    /**
+     * Folds the sampled stacks into one line per distinct stack, "op;outermost;...;innermost",
+     * and counts them.
+     */
+    class SampleAggregator {
+    public:
+        SampleAggregator() : _since(jsTime()), _samples(0) {}
+
+        /**
+         * Moves the samples written by the signal handler into the profile.
+         */
+        void drain() {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            for (size_t i = 0; i < kNumSlots; ++i) {
+                Slot& slot = slots[i];
+                if (slot.state.load() != kFull) {
+                    continue;
+                }
+                const char* op = slot.op ? slot.op : kNoOp;
+                _addSample(op, slot.frames, slot.numFrames);
+                slot.state.store(kEmpty);
+            }
+        }
+
+        /**
+         * Appends the profile to "result", the stacks most sampled first, and starts a new one if
+         * "reset" is true.
+         */
+        void append(bool reset, BSONObjBuilder* result) {
+            drain();
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            result->append("hz", cpuSamplingProfilerHz);
+            result->appendDate("since", _since);
+            result->append("samples", static_cast<long long>(_samples));
+            result->append("droppedSamples", static_cast<long long>(droppedSamples.load()));
+
+            BSONObjBuilder ops(result->subobjStart("ops"));
+            for (std::map<std::string, unsigned long long>::const_iterator it = _ops.begin();
+                 it != _ops.end(); ++it) {
+                ops.append(it->first, static_cast<long long>(it->second));
+            }
+            ops.done();
+
+            std::vector<std::pair<unsigned long long, const std::string*> > byCount;
+            byCount.reserve(_stacks.size());
+            for (std::map<std::string, unsigned long long>::const_iterator it = _stacks.begin();
+                 it != _stacks.end(); ++it) {
+                byCount.push_back(std::make_pair(it->second, &it->first));
+            }
+            std::sort(byCount.begin(), byCount.end(), MoreSamples());
+
+            bool truncated = false;
+            BSONArrayBuilder folded(result->subarrayStart("folded"));
+            for (size_t i = 0; i < byCount.size(); ++i) {
+                if (folded.len() + static_cast<int>(byCount[i].second->size()) >
+                    kMaxResultBytes) {
+                    truncated = true;
+                    break;
+                }
+                folded.append(str::stream() << *byCount[i].second << ' ' << byCount[i].first);
+            }
+            folded.done();
+            result->append("truncated", truncated);
+
+            if (reset) {
+                _stacks.clear();
+                _ops.clear();
+                _samples = 0;
+                _since = jsTime();
+                droppedSamples.store(0);
+            }
+        }
+
+    private:
+        struct MoreSamples {
+            bool operator()(const std::pair<unsigned long long, const std::string*>& lhs,
+                            const std::pair<unsigned long long, const std::string*>& rhs) const {
+                if (lhs.first != rhs.first) {
+                    return lhs.first > rhs.first;
+                }
+                return *lhs.second < *rhs.second;
+            }
+        };
+
+        void _addSample(const char* op, void* const* frames, int numFrames) {
+            // Leave out the handler, and the frames before it and after it for the delivery of
+            // the signal. Without the handler's symbol there is nothing to go by, so keep them.
+            int first = 0;
+            for (int i = 0; i < numFrames && i < 4; ++i) {
+                if (getStackFrameFunction(frames[i]) == _handlerAddress) {
+                    first = std::min(i + 2, numFrames);
+                    break;
+                }
+            }
+
+            std::string stack(op);
+            if (numFrames == kMaxFrames) {
+                stack.append(";").append(kTruncatedFrames);
+            }
+            for (int i = numFrames - 1; i >= first; --i) {
+                stack.append(";").append(_getName(frames[i]));
+            }
+
+            ++_samples;
+            ++_ops[op];
+            std::map<std::string, unsigned long long>::iterator it = _stacks.find(stack);
+            if (it != _stacks.end()) {
+                ++it->second;
+            }
+            else if (_stacks.size() < kMaxStacks) {
+                _stacks[stack] = 1;
+            }
+            else {
+                ++_stacks[std::string(op) + ";" + kTooManyStacks];
+            }
+        }
+
+        const std::string& _getName(void* address) {
+            std::unordered_map<void*, std::string>::iterator it = _names.find(address);
+            if (it != _names.end()) {
+                return it->second;
+            }
+            return _names[address] = getStackFrameName(address);
+        }
+
+        static void* const _handlerAddress;
+
+        stdx::mutex _mutex;
+        Date_t _since;
+        unsigned long long _samples;
+        std::map<std::string, unsigned long long> _ops;
+        std::map<std::string, unsigned long long> _stacks;
+
+        // The addresses sampled are code, so there are only so many of them to name
+        std::unordered_map<void*, std::string> _names;
+    };
+
+    void* const SampleAggregator::_handlerAddress =
+        reinterpret_cast<void*>(&samplingProfilerSignalHandler);
+
+    SampleAggregator* aggregator = NULL;
+
+    class SamplingProfilerAggregator : public BackgroundJob {
+    public:
+        virtual std::string name() const { return "SamplingProfilerAggregator"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            while (!inShutdown()) {
+                sleepsecs(1);
+                aggregator->drain();
+            }
+        }
+    };
+
+    bool startSampling(int hz) {
+        // The first call may load the unwinder, which allocates, so isn't made by the handler
+        void* frames[kMaxFrames];
+        if (rawBacktrace(frames, kMaxFrames) == 0) {
+            warning() << "Not sampling the CPU profile: stack traces aren't supported";
+            return false;
+        }
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = samplingProfilerSignalHandler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, NULL) != 0) {
+            warning() << "Not sampling the CPU profile: sigaction failed: "
+                      << errnoWithDescription();
+            return false;
+        }
+
+        struct itimerval timer;
+        const long periodMicros = 1000 * 1000 / hz;
+        timer.it_interval.tv_sec = periodMicros / (1000 * 1000);
+        timer.it_interval.tv_usec = periodMicros % (1000 * 1000);
+        timer.it_value = timer.it_interval;
+        if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+            warning() << "Not sampling the CPU profile: setitimer failed: "
+                      << errnoWithDescription();
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    class CmdGetCpuSamplingProfile : public Command {
+    public:
+        CmdGetCpuSamplingProfile() : Command("getCpuSamplingProfile") {}
+
+        virtual bool slaveOk() const { return true; }
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual bool adminOnly() const { return true; }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::cpuProfiler);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        virtual void help(std::stringstream& help) const {
+            help << "{ getCpuSamplingProfile : 1, reset : <bool> } returns the stacks sampled\n";
+            help << "cpuSamplingProfilerHz times a second of CPU time, as folded stacks labelled\n";
+            help << "by operation, and with reset starts a new profile";
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const std::string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         std::string& errmsg,
+                         BSONObjBuilder& result) {
+#if defined(_WIN32)
+            errmsg = "the CPU sampling profiler isn't supported on Windows";
+            return false;
+#else
+            if (!aggregator) {
+                errmsg = "the CPU sampling profiler isn't running, see cpuSamplingProfilerHz";
+                return false;
+            }
+            aggregator->append(cmdObj["reset"].trueValue(), &result);
+            return true;
+#endif
+        }
+
+    } cmdGetCpuSamplingProfile;
+
+}  // namespace
+
+    SamplingProfilerOpScope::SamplingProfilerOpScope(const char* op) : _previous(threadOp) {
+        setThreadOp(op);
+    }
+
+    SamplingProfilerOpScope::~SamplingProfilerOpScope() {
+        setThreadOp(_previous);
+    }
+
+    void startSamplingProfiler() {
+#if !defined(_WIN32)
+        const int hz = cpuSamplingProfilerHz;
+        if (hz <= 0) {
+            return;
+        }
+        if (hz > kMaxHz) {
+            warning() << "Not sampling the CPU profile: cpuSamplingProfilerHz is at most "
+                      << kMaxHz;
+            return;
+        }
+
+        slots = new Slot[kNumSlots];
+        aggregator = new SampleAggregator();
+        if (!startSampling(hz)) {
+            return;
+        }
+
+        SamplingProfilerAggregator* job = new SamplingProfilerAggregator();
+        job->go();
+#endif
+    }
+
+}  // namespace mongo
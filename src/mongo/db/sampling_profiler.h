@@ -0,0 +1,57 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+    /**
+     * Labels the CPU profile samples taken on this thread while it is in scope with "op", such as
+     * "query" or the name of a command, restoring the previous label when it goes out of scope.
+     * "op" must outlive every profile, so is a literal or the name of a registered command.
+     */
+    class SamplingProfilerOpScope {
+        MONGO_DISALLOW_COPYING(SamplingProfilerOpScope);
+    public:
+        explicit SamplingProfilerOpScope(const char* op);
+        ~SamplingProfilerOpScope();
+
+    private:
+        const char* const _previous;
+    };
+
+    /**
+     * Starts sampling the stacks of the threads using CPU cpuSamplingProfilerHz times a second,
+     * and the thread that aggregates the samples into the folded stacks returned by the
+     * getCpuSamplingProfile command.
+     */
+    void startSamplingProfiler();
+
+}  // namespace mongo
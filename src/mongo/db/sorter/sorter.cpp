@@ -48,7 +48,9 @@
 #include "mongo/db/sorter/sorter.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <future>
 #include <snappy.h>
+#include <third_party/murmurhash3/MurmurHash3.h>
 
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
@@ -151,6 +153,13 @@ namespace mongo {
             std::deque<Data> _data;
         };
 
+        /** Checksum of a spill file block, as written to the file. */
+        inline uint32_t blockChecksum(const char* data, int32_t size) {
+            uint32_t checksum;
+            MurmurHash3_x86_32(data, size, 0, &checksum);
+            return checksum;
+        }
+
         /** Returns results in order from a single file */
         template <typename Key, typename Value>
         class FileIterator : public SortIteratorInterface<Key, Value> {
@@ -161,14 +170,19 @@ namespace mongo {
             typedef std::pair<Key, Value> Data;
 
             FileIterator(const std::string& fileName,
+                         const SortOptions& opts,
                          const Settings& settings,
                          std::shared_ptr<FileDeleter> fileDeleter)
                 : _settings(settings)
+                , _checksummed(opts.checksumFiles)
+                , _readAhead(opts.fileReadAhead)
                 , _done(false)
                 , _fileName(fileName)
                 , _fileDeleter(fileDeleter)
-                , _file(_fileName.c_str(), std::ios::in | std::ios::binary)
             {
+                if (opts.unbufferedFileIO)
+                    _file.rdbuf()->pubsetbuf(0, 0);
+                _file.open(_fileName.c_str(), std::ios::in | std::ios::binary);
                 massert(16814, str::stream() << "error opening file \"" << _fileName << "\": "
                                              << myErrnoWithDescription(),
                         _file.good());
@@ -195,6 +209,16 @@ namespace mongo {
             }
 
         private:
+            /** A block as it is stored in the file. */
+            struct Block {
+                Block() : size(0), compressed(false), eof(false) {}
+
+                std::unique_ptr<char[]> data;
+                int32_t size;
+                bool compressed;
+                bool eof;
+            };
+
             void fillIfNeeded() {
                 verify(!_done);
 
@@ -203,33 +227,42 @@ namespace mongo {
             }
 
             void fill() {
-                int32_t rawSize;
-                read(&rawSize, sizeof(rawSize));
-                if (_done) return;
-
-                // negative size means compressed
-                const bool compressed = rawSize < 0;
-                const int32_t blockSize = std::abs(rawSize);
+                Block block;
+                if (_readAhead) {
+                    // The read of the next block overlaps with merging this one. Only one read is
+                    // ever outstanding, so _file is never used by two threads at once.
+                    if (!_nextBlock.valid())
+                        _nextBlock = std::async(std::launch::async, &FileIterator::readBlock, this);
+                    block = _nextBlock.get();
+                    if (!block.eof)
+                        _nextBlock = std::async(std::launch::async, &FileIterator::readBlock, this);
+                }
+                else {
+                    block = readBlock();
+                }
 
-                _buffer.reset(new char[blockSize]);
-                read(_buffer.get(), blockSize);
-                massert(16816, "file too short?", !_done);
+                if (block.eof) {
+                    _done = true;
+                    return;
+                }
 
-                if (!compressed) {
-                    _reader.reset(new BufReader(_buffer.get(), blockSize));
+                if (!block.compressed) {
+                    _buffer.swap(block.data);
+                    _reader.reset(new BufReader(_buffer.get(), block.size));
                     return;
                 }
 
-                dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+                dassert(snappy::IsValidCompressedBuffer(block.data.get(), block.size));
 
                 size_t uncompressedSize;
                 massert(17061, "couldn't get uncompressed length",
-                        snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+                        snappy::GetUncompressedLength(block.data.get(), block.size,
+                                                      &uncompressedSize));
 
                 std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
                 massert(17062, "decompression failed",
-                        snappy::RawUncompress(_buffer.get(),
-                                              blockSize,
+                        snappy::RawUncompress(block.data.get(),
+                                              block.size,
                                               decompressionBuffer.get()));
 
                 // hold on to decompressed data and throw out compressed data at block exit
@@ -237,13 +270,42 @@ namespace mongo {
                 _reader.reset(new BufReader(_buffer.get(), uncompressedSize));
             }
 
-            // sets _done to true on EOF - asserts on any other error
-            void read(void* out, size_t size) {
+            /** Reads the next block, verifying its checksum. May run on a read-ahead thread. */
+            Block readBlock() {
+                Block block;
+
+                int32_t rawSize;
+                if (!read(&rawSize, sizeof(rawSize))) {
+                    block.eof = true;
+                    return block;
+                }
+
+                uint32_t checksum = 0;
+                if (_checksummed)
+                    massert(28710, "file too short?", read(&checksum, sizeof(checksum)));
+
+                // negative size means compressed
+                block.compressed = rawSize < 0;
+                block.size = std::abs(rawSize);
+
+                block.data.reset(new char[block.size]);
+                massert(16816, "file too short?", read(block.data.get(), block.size));
+
+                if (_checksummed) {
+                    massert(28711, str::stream() << "checksum mismatch in file \"" << _fileName
+                                                 << "\", it may be corrupt",
+                            checksum == blockChecksum(block.data.get(), block.size));
+                }
+
+                return block;
+            }
+
+            // returns false on EOF - asserts on any other error
+            bool read(void* out, size_t size) {
                 _file.read(reinterpret_cast<char*>(out), size);
                 if (!_file.good()) {
                     if (_file.eof()) {
-                        _done = true;
-                        return;
+                        return false;
                     }
 
                     msgasserted(16817, str::stream() << "error reading file \""
@@ -251,15 +313,19 @@ namespace mongo {
                                                      << myErrnoWithDescription());
                 }
                 verify(_file.gcount() == static_cast<std::streamsize>(size));
+                return true;
             }
 
             const Settings _settings;
+            const bool _checksummed;
+            const bool _readAhead;
             bool _done;
             std::unique_ptr<char[]> _buffer;
             std::unique_ptr<BufReader> _reader;
             std::string _fileName;
             std::shared_ptr<FileDeleter> _fileDeleter; // Must outlive _file
             std::ifstream _file;
+            std::future<Block> _nextBlock; // Must be destroyed, waiting for its read, before _file
         };
 
         /** Merge-sorts results from 0 or more FileIterators */
@@ -402,6 +468,7 @@ namespace mongo {
                 , _settings(settings)
                 , _opts(opts)
                 , _memUsed(0)
+                , _bytesSpilled(0)
             { verify(_opts.limit == 0); }
 
             void add(const Key& key, const Value& val) {
@@ -410,6 +477,7 @@ namespace mongo {
                 _memUsed += key.memUsageForSorter();
                 _memUsed += val.memUsageForSorter();
 
+                this->_memoryCharge.update(_memUsed);
                 if (_memUsed > _opts.maxMemoryUsageBytes)
                     spill();
             }
@@ -427,6 +495,7 @@ namespace mongo {
             // TEMP these are here for compatibility. Will be replaced with a general stats API
             int numFiles() const { return _iters.size(); }
             size_t memUsed() const { return _memUsed; }
+            unsigned long long bytesSpilled() const { return _bytesSpilled; }
 
         private:
             class STLComparator {
@@ -473,14 +542,17 @@ namespace mongo {
                 }
 
                 _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+                _bytesSpilled += writer.bytesWritten();
 
                 _memUsed = 0;
+                this->_memoryCharge.set(0);
             }
 
             const Comparator _comp;
             const Settings _settings;
             SortOptions _opts;
             size_t _memUsed;
+            unsigned long long _bytesSpilled;
             std::deque<Data> _data; // the "current" data
             std::vector<std::shared_ptr<Iterator> > _iters; // data that has already been spilled
         };
@@ -524,6 +596,7 @@ namespace mongo {
             int numFiles() const { return 0; }
             size_t memUsed() const { return _best.first.memUsageForSorter()
                                           + _best.second.memUsageForSorter(); }
+            unsigned long long bytesSpilled() const { return 0; }
 
         private:
             const Comparator _comp;
@@ -547,6 +620,7 @@ namespace mongo {
                 , _settings(settings)
                 , _opts(opts)
                 , _memUsed(0)
+                , _bytesSpilled(0)
                 , _haveCutoff(false)
                 , _worstCount(0)
                 , _medianCount(0)
@@ -578,6 +652,7 @@ namespace mongo {
                     if (_data.size() == _opts.limit)
                         std::make_heap(_data.begin(), _data.end(), less);
 
+                    this->_memoryCharge.update(_memUsed);
                     if (_memUsed > _opts.maxMemoryUsageBytes)
                         spill();
 
@@ -601,6 +676,7 @@ namespace mongo {
                 _data.back() = contender;
                 std::push_heap(_data.begin(), _data.end(), less);
 
+                this->_memoryCharge.update(_memUsed);
                 if (_memUsed > _opts.maxMemoryUsageBytes)
                     spill();
             }
@@ -618,6 +694,7 @@ namespace mongo {
             // TEMP these are here for compatibility. Will be replaced with a general stats API
             int numFiles() const { return _iters.size(); }
             size_t memUsed() const { return _memUsed; }
+            unsigned long long bytesSpilled() const { return _bytesSpilled; }
 
         private:
             class STLComparator {
@@ -748,14 +825,17 @@ namespace mongo {
                 std::vector<Data>().swap(_data);
 
                 _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+                _bytesSpilled += writer.bytesWritten();
 
                 _memUsed = 0;
+                this->_memoryCharge.set(0);
             }
 
             const Comparator _comp;
             const Settings _settings;
             SortOptions _opts;
             size_t _memUsed;
+            unsigned long long _bytesSpilled;
             std::vector<Data> _data; // the "current" data. Organized as max-heap if size == limit.
             std::vector<std::shared_ptr<Iterator> > _iters; // data that has already been spilled
 
@@ -783,7 +863,9 @@ namespace mongo {
     template <typename Key, typename Value>
     SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts,
                                                    const Settings& settings)
-        : _settings(settings)
+        : _opts(opts)
+        , _settings(settings)
+        , _bytesWritten(0)
     {
         namespace str = mongoutils::str;
 
@@ -802,6 +884,8 @@ namespace mongo {
 
         boost::filesystem::create_directories(opts.tempDir);
 
+        if (opts.unbufferedFileIO)
+            _file.rdbuf()->pubsetbuf(0, 0);
         _file.open(_fileName.c_str(), std::ios::binary | std::ios::out);
         massert(16818, str::stream() << "error opening file \"" << _fileName << "\": "
                                      << sorter::myErrnoWithDescription(),
@@ -818,7 +902,7 @@ namespace mongo {
         key.serializeForSorter(_buffer);
         val.serializeForSorter(_buffer);
 
-        if (_buffer.len() > 64*1024)
+        if (size_t(_buffer.len()) > _opts.fileBlockBytes)
             spill();
     }
 
@@ -830,18 +914,28 @@ namespace mongo {
             return;
 
         std::string compressed;
-        snappy::Compress(_buffer.buf(), _buffer.len(), &compressed);
-        verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
+        if (_opts.compressFiles) {
+            snappy::Compress(_buffer.buf(), _buffer.len(), &compressed);
+            verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
+        }
+
+        // Only keep the compressed block if it saves at least 10%
+        const bool useCompressed = _opts.compressFiles
+                                && compressed.size() < size_t(_buffer.len()/10*9);
+        const char* data = useCompressed ? compressed.data() : _buffer.buf();
+        const int32_t dataSize = useCompressed ? int32_t(compressed.size()) : _buffer.len();
 
         try {
-            if (compressed.size() < size_t(_buffer.len()/10*9)) {
-                const int32_t size = -int32_t(compressed.size()); // negative means compressed
-                _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-                _file.write(compressed.data(), compressed.size());
-            } else {
-                const int32_t size = _buffer.len();
-                _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-                _file.write(_buffer.buf(), _buffer.len());
+            const int32_t size = useCompressed ? -dataSize : dataSize; // negative means compressed
+            _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            if (_opts.checksumFiles) {
+                const uint32_t checksum = sorter::blockChecksum(data, dataSize);
+                _file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+            }
+            _file.write(data, dataSize);
+            _bytesWritten += sizeof(size) + dataSize;
+            if (_opts.checksumFiles) {
+                _bytesWritten += sizeof(uint32_t);
             }
         } catch (const std::exception&) {
             msgasserted(16821, str::stream() << "error writing to file \"" << _fileName << "\": "
@@ -855,7 +949,7 @@ namespace mongo {
     SortIteratorInterface<Key, Value>* SortedFileWriter<Key, Value>::done() {
         spill();
         _file.close();
-        return new sorter::FileIterator<Key, Value>(_fileName, _settings, _fileDeleter);
+        return new sorter::FileIterator<Key, Value>(_fileName, _opts, _settings, _fileDeleter);
     }
 
     //
@@ -36,6 +36,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/util/builder.h"
+#include "mongo/util/memory_accounting.h"
 
 /**
  * This is the public API for the Sorter (both in-memory and external)
@@ -97,11 +98,23 @@ namespace mongo {
         bool extSortAllowed; /// If false, uassert if more mem needed than allowed.
         std::string tempDir; /// Directory to directly place files in.
                              /// Must be explicitly set if extSortAllowed is true.
+        size_t fileBlockBytes; /// Spill files are written in blocks of about this many bytes.
+        bool compressFiles; /// Snappy-compress spill file blocks which shrink by 10% or more.
+        bool checksumFiles; /// Checksum spill file blocks and verify them when read back.
+        bool unbufferedFileIO; /// Hand each spill file block straight to the OS, not through
+                               /// a stream buffer.
+        bool fileReadAhead; /// Read the next block of each spill file on a separate thread
+                            /// while the current one is merged.
 
         SortOptions()
             : limit(0)
             , maxMemoryUsageBytes(64*1024*1024)
             , extSortAllowed(false)
+            , fileBlockBytes(64*1024)
+            , compressFiles(true)
+            , checksumFiles(true)
+            , unbufferedFileIO(false)
+            , fileReadAhead(false)
         {}
 
         /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
@@ -125,6 +138,31 @@ namespace mongo {
             tempDir = newTempDir;
             return *this;
         }
+
+        SortOptions& FileBlockBytes(size_t newFileBlockBytes) {
+            fileBlockBytes = newFileBlockBytes;
+            return *this;
+        }
+
+        SortOptions& CompressFiles(bool newCompressFiles=true) {
+            compressFiles = newCompressFiles;
+            return *this;
+        }
+
+        SortOptions& ChecksumFiles(bool newChecksumFiles=true) {
+            checksumFiles = newChecksumFiles;
+            return *this;
+        }
+
+        SortOptions& UnbufferedFileIO(bool newUnbufferedFileIO=true) {
+            unbufferedFileIO = newUnbufferedFileIO;
+            return *this;
+        }
+
+        SortOptions& FileReadAhead(bool newFileReadAhead=true) {
+            fileReadAhead = newFileReadAhead;
+            return *this;
+        }
     };
 
     /// This is the output from the sorting framework
@@ -151,6 +189,13 @@ namespace mongo {
         SortIteratorInterface() {} // can only be constructed as a base
     };
 
+    /// The memory of the data held by sorters of every type. Constructed on first use, since the
+    /// sorters are templates instantiated in many files.
+    inline MemoryAccount* getSorterMemoryAccount() {
+        static MemoryAccount* account = new MemoryAccount("sorters");
+        return account;
+    }
+
     /// This is the main way to input data to the sorting framework
     template <typename Key, typename Value>
     class Sorter {
@@ -175,9 +220,13 @@ namespace mongo {
         // TEMP these are here for compatibility. Will be replaced with a general stats API
         virtual int numFiles() const =0;
         virtual size_t memUsed() const =0;
+        virtual unsigned long long bytesSpilled() const =0; /// Bytes written to spill files.
 
     protected:
-        Sorter() {} // can only be constructed as a base
+        Sorter() : _memoryCharge(getSorterMemoryAccount()) {} // can only be constructed as a base
+
+        /// Kept up to date with memUsed() by the implementations that hold more than one pair
+        MemoryAccount::Charge _memoryCharge;
     };
 
     /// Writes pre-sorted data to a sorted file and hands-back an Iterator over that file.
@@ -196,14 +245,18 @@ namespace mongo {
         void addAlreadySorted(const Key&, const Value&);
         Iterator* done(); /// Can't add more data after calling done()
 
+        unsigned long long bytesWritten() const { return _bytesWritten; }
+
     private:
         void spill();
 
+        const SortOptions _opts;
         const Settings _settings;
         std::string _fileName;
         std::shared_ptr<sorter::FileDeleter> _fileDeleter; // Must outlive _file
         std::ofstream _file;
         BufBuilder _buffer;
+        unsigned long long _bytesWritten;
     };
 }
 
@@ -244,6 +244,42 @@ namespace mongo {
             }
 
             ASSERT(boost::filesystem::is_empty(tempDir.path()));
+
+            // Every way of writing and reading the blocks gives the same results.
+            writeAndRead(SortOptions(opts).CompressFiles(false));
+            writeAndRead(SortOptions(opts).ChecksumFiles(false));
+            writeAndRead(SortOptions(opts).CompressFiles(false).ChecksumFiles(false));
+            writeAndRead(SortOptions(opts).FileBlockBytes(1024).UnbufferedFileIO());
+            writeAndRead(SortOptions(opts).FileBlockBytes(1024).FileReadAhead());
+            ASSERT(boost::filesystem::is_empty(tempDir.path()));
+
+            { // corrupt
+                SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+                for (int i=0; i< 1000; i++)
+                    sorter.addAlreadySorted(i,-i);
+                std::shared_ptr<IWIterator> iter(sorter.done());
+
+                const std::string fileName =
+                    boost::filesystem::directory_iterator(tempDir.path())->path().string();
+                {
+                    std::fstream file(fileName.c_str(),
+                                      std::ios::in | std::ios::out | std::ios::binary);
+                    file.seekp(20);
+                    file.put('x');
+                }
+
+                ASSERT_THROWS(iter->more(), MsgAssertionException);
+            }
+        }
+
+    private:
+        void writeAndRead(const SortOptions& opts) {
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+            for (int i=0; i< 100*1000; i++)
+                sorter.addAlreadySorted(i,-i);
+
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
+                                        make_shared<IntIterator>(0,100*1000));
         }
     };
 
@@ -499,6 +535,12 @@ namespace mongo {
         };
 
 
+        class LotsOfDataReadAhead : public LotsOfDataLittleMemory</*random=*/true> {
+            SortOptions adjustSortOptions(SortOptions opts) {
+                return LotsOfDataLittleMemory::adjustSortOptions(opts).FileReadAhead();
+            }
+        };
+
         template <long long Limit, bool Random=true>
         class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
             typedef LotsOfDataLittleMemory<Random> Parent;
@@ -539,6 +581,7 @@ namespace mongo {
             add<SorterTests::Dupes>();
             add<SorterTests::LotsOfDataLittleMemory</*random=*/false> >();
             add<SorterTests::LotsOfDataLittleMemory</*random=*/true> >();
+            add<SorterTests::LotsOfDataReadAhead>();
             add<SorterTests::LotsOfDataWithLimit<1,/*random=*/false> >(); // limit=1 is special case
             add<SorterTests::LotsOfDataWithLimit<1,/*random=*/true> >();  // limit=1 is special case
             add<SorterTests::LotsOfDataWithLimit<100,/*random=*/false> >(); // fits in mem
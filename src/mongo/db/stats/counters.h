@@ -30,19 +30,20 @@
 #pragma once
 
 #include "mongo/platform/basic.h"
+#include "mongo/base/disallow_copying.h"
 #include "mongo/db/jsobj.h"
-#include "mongo/platform/atomic_word.h"
+#include "mongo/db/stats/sharded_counter.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/processinfo.h"
-#include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 
     /**
      * for storing operation counters
-     * note: not thread safe.  ok with that for speed
+     * each counter is sharded by core, see ShardedCounter64
      */
     class OpCounters {
+        MONGO_DISALLOW_COPYING(OpCounters);
     public:
 
         OpCounters();
@@ -59,42 +60,35 @@ namespace mongo {
         BSONObj getObj() const;
         
         // thse are used by snmp, and other things, do not remove
-        const AtomicUInt32 * getInsert() const { return &_insert; }
-        const AtomicUInt32 * getQuery() const { return &_query; }
-        const AtomicUInt32 * getUpdate() const { return &_update; }
-        const AtomicUInt32 * getDelete() const { return &_delete; }
-        const AtomicUInt32 * getGetMore() const { return &_getmore; }
-        const AtomicUInt32 * getCommand() const { return &_command; }
+        long long getInsert() const { return _insert.get(); }
+        long long getQuery() const { return _query.get(); }
+        long long getUpdate() const { return _update.get(); }
+        long long getDelete() const { return _delete.get(); }
+        long long getGetMore() const { return _getmore.get(); }
+        long long getCommand() const { return _command.get(); }
 
     private:
-        void _checkWrap();
-        
-        // todo: there will be a lot of cache line contention on these.  need to do something 
-        //       else eventually.
-        AtomicUInt32 _insert;
-        AtomicUInt32 _query;
-        AtomicUInt32 _update;
-        AtomicUInt32 _delete;
-        AtomicUInt32 _getmore;
-        AtomicUInt32 _command;
+        ShardedCounter64 _insert;
+        ShardedCounter64 _query;
+        ShardedCounter64 _update;
+        ShardedCounter64 _delete;
+        ShardedCounter64 _getmore;
+        ShardedCounter64 _command;
     };
 
     extern OpCounters globalOpCounters;
     extern OpCounters replOpCounters;
 
     class NetworkCounter {
+        MONGO_DISALLOW_COPYING(NetworkCounter);
     public:
-        NetworkCounter() : _bytesIn(0), _bytesOut(0), _requests(0), _overflows(0) {}
+        NetworkCounter() = default;
         void hit( long long bytesIn , long long bytesOut );
         void append( BSONObjBuilder& b );
     private:
-        long long _bytesIn;
-        long long _bytesOut;
-        long long _requests;
-
-        long long _overflows;
-
-        SpinLock _lock;
+        ShardedCounter64 _bytesIn;
+        ShardedCounter64 _bytesOut;
+        ShardedCounter64 _requests;
     };
 
     extern NetworkCounter networkCounter;
@@ -0,0 +1,152 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+
+    namespace {
+
+        // Percentiles reported by append(), with the field name used for each.
+        const struct {
+            const char* name;
+            double fraction;
+        } kPercentiles[] = {
+            {"p50Micros", 0.5},
+            {"p90Micros", 0.9},
+            {"p95Micros", 0.95},
+            {"p99Micros", 0.99},
+            {"p999Micros", 0.999},
+        };
+
+    }  // namespace
+
+    int LatencyHistogram::bucketFor(unsigned long long micros) {
+        if (micros < 16) {
+            return static_cast<int>(micros);
+        }
+
+        const int exponent = 63 - countLeadingZeros64(micros);
+        if (exponent > kMaxExponent) {
+            return kNumBuckets - 1;
+        }
+
+        // The two bits below the leading one pick one of the four buckets for this power of two.
+        const int subBucket = static_cast<int>((micros >> (exponent - 2)) & 3);
+        return 16 + (exponent - 4) * 4 + subBucket;
+    }
+
+    unsigned long long LatencyHistogram::bucketUpperBound(int bucket) {
+        if (bucket < 16) {
+            return bucket + 1;
+        }
+        if (bucket >= kNumBuckets - 1) {
+            return std::numeric_limits<long long>::max();
+        }
+
+        const int exponent = 4 + (bucket - 16) / 4;
+        const int subBucket = (bucket - 16) % 4;
+        return static_cast<unsigned long long>(5 + subBucket) << (exponent - 2);
+    }
+
+    void LatencyHistogram::record(unsigned long long micros) {
+        _buckets[bucketFor(micros)].fetchAndAdd(1);
+        _totalMicros.fetchAndAdd(micros);
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        for (int i = 0; i < kNumBuckets; i++) {
+            _buckets[i].fetchAndAdd(other._buckets[i].loadRelaxed());
+        }
+        _totalMicros.fetchAndAdd(other._totalMicros.loadRelaxed());
+    }
+
+    void LatencyHistogram::reset() {
+        for (int i = 0; i < kNumBuckets; i++) {
+            _buckets[i].store(0);
+        }
+        _totalMicros.store(0);
+    }
+
+    unsigned long long LatencyHistogram::getCount() const {
+        unsigned long long count = 0;
+        for (int i = 0; i < kNumBuckets; i++) {
+            count += _buckets[i].loadRelaxed();
+        }
+        return count;
+    }
+
+    void LatencyHistogram::append(BSONObjBuilder* builder, StringData totalFieldName) const {
+        // Take one snapshot so that the count and the percentiles agree with each other.
+        unsigned long long snapshot[kNumBuckets];
+        unsigned long long count = 0;
+        for (int i = 0; i < kNumBuckets; i++) {
+            snapshot[i] = _buckets[i].loadRelaxed();
+            count += snapshot[i];
+        }
+
+        builder->append("count", static_cast<long long>(count));
+        builder->append(totalFieldName, static_cast<long long>(_totalMicros.loadRelaxed()));
+
+        if (count > 0) {
+            int bucket = 0;
+            unsigned long long seen = snapshot[0];
+            for (const auto& percentile : kPercentiles) {
+                // The rank of the operation at this percentile, counting from one.
+                const unsigned long long rank = std::max(
+                    1ULL, static_cast<unsigned long long>(std::ceil(percentile.fraction * count)));
+                while (seen < rank) {
+                    seen += snapshot[++bucket];
+                }
+                builder->append(percentile.name,
+                                static_cast<long long>(bucketUpperBound(bucket)));
+            }
+        }
+
+        BSONArrayBuilder bucketsBuilder(builder->subarrayStart("buckets"));
+        for (int i = 0; i < kNumBuckets; i++) {
+            if (snapshot[i] == 0) {
+                continue;
+            }
+            BSONObjBuilder bucketBuilder(bucketsBuilder.subobjStart());
+            bucketBuilder.append("lt", static_cast<long long>(bucketUpperBound(i)));
+            bucketBuilder.append("count", static_cast<long long>(snapshot[i]));
+        }
+        bucketsBuilder.doneFast();
+    }
+
+}  // namespace mongo
@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * A fixed-size histogram of operation latencies, in microseconds.
+     *
+     * Buckets are log-linear: latencies below 16 micros each get their own bucket, and every
+     * power of two above that is split into four equally sized buckets, so the relative error of
+     * any bucket is at most 25%. Latencies of 2^36 micros (about 19 hours) or more share a single
+     * overflow bucket.
+     *
+     * record() is lock-free and may be called concurrently from any number of threads. Readers
+     * see a snapshot that may be slightly out of date with respect to in-flight records, which
+     * is fine for monitoring.
+     */
+    class LatencyHistogram {
+        MONGO_DISALLOW_COPYING(LatencyHistogram);
+    public:
+        static const int kMaxExponent = 35;
+        static const int kNumBuckets = 16 + (kMaxExponent - 3) * 4 + 1;
+
+        LatencyHistogram() = default;
+
+        /**
+         * Records one operation which took "micros" microseconds.
+         */
+        void record(unsigned long long micros);
+
+        /**
+         * Adds the operations recorded in "other" into this histogram.
+         */
+        void merge(const LatencyHistogram& other);
+
+        /**
+         * Appends the count, the total time, estimated percentiles and the non-empty buckets to
+         * "builder". Each bucket is reported with the exclusive upper bound of the latencies it
+         * holds, and percentiles are reported as the upper bound of the bucket they fall in.
+         *
+         * Histograms of something other than microseconds can name the total 'totalFieldName'.
+         */
+        void append(BSONObjBuilder* builder, StringData totalFieldName = "totalMicros") const;
+
+        /**
+         * Clears all buckets. Operations recorded concurrently with a reset may be partially
+         * counted.
+         */
+        void reset();
+
+        unsigned long long getCount() const;
+
+        /**
+         * Returns the bucket that latencies of "micros" microseconds are recorded in.
+         */
+        static int bucketFor(unsigned long long micros);
+
+        /**
+         * Returns the smallest latency which is too large for "bucket". The overflow bucket has no
+         * upper bound, for which this returns the largest representable latency.
+         */
+        static unsigned long long bucketUpperBound(int bucket);
+
+    private:
+        AtomicUInt64 _buckets[kNumBuckets];
+        AtomicUInt64 _totalMicros;
+    };
+
+}  // namespace mongo
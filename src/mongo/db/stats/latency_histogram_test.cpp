@@ -0,0 +1,137 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    TEST(LatencyHistogramTest, SmallLatenciesHaveTheirOwnBuckets) {
+        for (unsigned long long micros = 0; micros < 16; micros++) {
+            ASSERT_EQUALS(static_cast<int>(micros), LatencyHistogram::bucketFor(micros));
+            ASSERT_EQUALS(micros + 1, LatencyHistogram::bucketUpperBound(micros));
+        }
+    }
+
+    TEST(LatencyHistogramTest, BucketsCoverEveryLatency) {
+        // Every latency must fall below the upper bound of its bucket and at or above the upper
+        // bound of the previous one.
+        for (unsigned long long micros = 0; micros < (1ULL << 20); micros++) {
+            const int bucket = LatencyHistogram::bucketFor(micros);
+            ASSERT_LESS_THAN(micros, LatencyHistogram::bucketUpperBound(bucket));
+            if (bucket > 0) {
+                ASSERT_GREATER_THAN_OR_EQUALS(micros,
+                                              LatencyHistogram::bucketUpperBound(bucket - 1));
+            }
+        }
+    }
+
+    TEST(LatencyHistogramTest, LargeLatenciesOverflow) {
+        const int lastBucket = LatencyHistogram::kNumBuckets - 1;
+        const unsigned long long maxBounded = 1ULL << (LatencyHistogram::kMaxExponent + 1);
+        ASSERT_EQUALS(maxBounded, LatencyHistogram::bucketUpperBound(lastBucket - 1));
+        ASSERT_EQUALS(lastBucket - 1, LatencyHistogram::bucketFor(maxBounded - 1));
+        ASSERT_EQUALS(lastBucket, LatencyHistogram::bucketFor(maxBounded));
+        ASSERT_EQUALS(lastBucket, LatencyHistogram::bucketFor(~0ULL));
+    }
+
+    TEST(LatencyHistogramTest, AppendReportsCountsAndPercentiles) {
+        LatencyHistogram histogram;
+        for (int i = 0; i < 98; i++) {
+            histogram.record(3);
+        }
+        histogram.record(100);
+        histogram.record(5000);
+        ASSERT_EQUALS(100ULL, histogram.getCount());
+
+        BSONObjBuilder builder;
+        histogram.append(&builder);
+        BSONObj obj = builder.obj();
+
+        ASSERT_EQUALS(100, obj["count"].numberLong());
+        ASSERT_EQUALS(98 * 3 + 100 + 5000, obj["totalMicros"].numberLong());
+        ASSERT_EQUALS(4, obj["p50Micros"].numberLong());
+        ASSERT_EQUALS(4, obj["p90Micros"].numberLong());
+        ASSERT_EQUALS(4, obj["p95Micros"].numberLong());
+        ASSERT_EQUALS(LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(100)),
+                      static_cast<unsigned long long>(obj["p99Micros"].numberLong()));
+        ASSERT_EQUALS(LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(5000)),
+                      static_cast<unsigned long long>(obj["p999Micros"].numberLong()));
+
+        // Only the three non-empty buckets are reported.
+        std::vector<BSONElement> buckets = obj["buckets"].Array();
+        ASSERT_EQUALS(3U, buckets.size());
+        ASSERT_EQUALS(4, buckets[0].Obj()["lt"].numberLong());
+        ASSERT_EQUALS(98, buckets[0].Obj()["count"].numberLong());
+    }
+
+    TEST(LatencyHistogramTest, Merge) {
+        LatencyHistogram histogram;
+        histogram.record(3);
+        histogram.record(100);
+
+        LatencyHistogram other;
+        other.record(3);
+        other.record(5000);
+        histogram.merge(other);
+        ASSERT_EQUALS(4ULL, histogram.getCount());
+        ASSERT_EQUALS(2ULL, other.getCount());
+
+        BSONObjBuilder builder;
+        histogram.append(&builder);
+        BSONObj obj = builder.obj();
+        ASSERT_EQUALS(3 + 100 + 3 + 5000, obj["totalMicros"].numberLong());
+        ASSERT_EQUALS(4, obj["p50Micros"].numberLong());
+
+        std::vector<BSONElement> buckets = obj["buckets"].Array();
+        ASSERT_EQUALS(3U, buckets.size());
+        ASSERT_EQUALS(2, buckets[0].Obj()["count"].numberLong());
+    }
+
+    TEST(LatencyHistogramTest, Reset) {
+        LatencyHistogram histogram;
+        histogram.record(10);
+        histogram.record(1000);
+        histogram.reset();
+        ASSERT_EQUALS(0ULL, histogram.getCount());
+
+        BSONObjBuilder builder;
+        histogram.append(&builder);
+        BSONObj obj = builder.obj();
+        ASSERT_EQUALS(0, obj["count"].numberLong());
+        ASSERT_EQUALS(0, obj["totalMicros"].numberLong());
+        ASSERT_FALSE(obj.hasField("p50Micros"));
+        ASSERT_TRUE(obj["buckets"].Array().empty());
+    }
+
+} // namespace
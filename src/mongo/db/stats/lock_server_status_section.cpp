@@ -28,11 +28,26 @@
 
 #include "mongo/platform/basic.h"
 
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/lock_stats.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 namespace {
@@ -135,5 +150,175 @@ namespace {
 
     } lockStatsServerStatusSection;
 
+
+    /**
+     * Reports the databases and collections which lock requests have waited for the longest.
+     * Resource ids are hashes of the names, so reporting them has to go through the catalog, which
+     * takes database locks. This is why the section has to be asked for explicitly.
+     */
+    class LockContentionServerStatusSection : public ServerStatusSection {
+    public:
+        static const size_t kNumReported = 20;
+
+        LockContentionServerStatusSection() : ServerStatusSection("lockContention") { }
+
+        virtual bool includeByDefault() const { return false; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            const std::vector<ResourceWaitStats::Entry> top = reportTopResourceWaits(kNumReported);
+
+            std::map<ResourceId, std::string> names;
+            if (!top.empty()) {
+                _resolveNames(txn, top, &names);
+            }
+
+            BSONArrayBuilder resources;
+            for (size_t i = 0; i < top.size(); i++) {
+                const ResourceWaitStats::Entry& entry = top[i];
+                std::map<ResourceId, std::string>::const_iterator name = names.find(entry.resId);
+
+                BSONObjBuilder resource(resources.subobjStart());
+                resource.append("type", resourceTypeName(entry.resId.getType()));
+                resource.append("name", name != names.end() ? name->second
+                                                             : entry.resId.toString());
+                resource.append("numWaits", static_cast<long long>(entry.numWaits));
+                resource.append("combinedWaitTimeMicros",
+                                static_cast<long long>(entry.combinedWaitTimeMicros));
+                resource.done();
+            }
+
+            BSONObjBuilder ret;
+            ret.append("maxTrackedResources", static_cast<int>(ResourceWaitStats::kMaxResources));
+            ret.append("resources", resources.arr());
+            return ret.obj();
+        }
+
+    private:
+        /**
+         * Finds the names of the databases and collections in 'entries' by hashing every database
+         * and collection name. Resources which were dropped in the meantime stay unresolved.
+         */
+        static void _resolveNames(OperationContext* txn,
+                                  const std::vector<ResourceWaitStats::Entry>& entries,
+                                  std::map<ResourceId, std::string>* names) {
+            std::set<ResourceId> unresolved;
+            for (size_t i = 0; i < entries.size(); i++) {
+                unresolved.insert(entries[i].resId);
+            }
+
+            std::vector<std::string> dbNames;
+            getGlobalServiceContext()->getGlobalStorageEngine()->listDatabases(&dbNames);
+
+            for (size_t i = 0; i < dbNames.size() && !unresolved.empty(); i++) {
+                const std::string& dbName = dbNames[i];
+
+                const ResourceId dbResId(RESOURCE_DATABASE, dbName);
+                if (unresolved.erase(dbResId)) {
+                    (*names)[dbResId] = dbName;
+                }
+
+                ScopedTransaction transaction(txn, MODE_IS);
+                Lock::DBLock dbLock(txn->lockState(), dbName, MODE_IS);
+
+                Database* db = dbHolder().get(txn, dbName);
+                if (!db) {
+                    continue;
+                }
+
+                std::list<std::string> collNames;
+                db->getDatabaseCatalogEntry()->getCollectionNamespaces(&collNames);
+
+                for (std::list<std::string>::const_iterator it = collNames.begin();
+                        it != collNames.end(); ++it) {
+                    const ResourceId collResId(RESOURCE_COLLECTION, *it);
+                    if (unresolved.erase(collResId)) {
+                        (*names)[collResId] = *it;
+                    }
+                }
+            }
+        }
+
+    } lockContentionServerStatusSection;
+
+    /**
+     * Reports the namespaces with the most write conflicts, and how long writers to them spent
+     * backing off. Not included by default.
+     */
+    class WriteConflictsServerStatusSection : public ServerStatusSection {
+    public:
+        static const size_t kNumReported = 20;
+
+        WriteConflictsServerStatusSection() : ServerStatusSection("writeConflicts") { }
+
+        virtual bool includeByDefault() const { return false; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            const std::vector<WriteConflictStats::Entry> top =
+                globalWriteConflictStats.getTopByConflicts(kNumReported);
+
+            BSONArrayBuilder namespaces;
+            for (size_t i = 0; i < top.size(); i++) {
+                const WriteConflictStats::Entry& entry = top[i];
+
+                BSONObjBuilder ns(namespaces.subobjStart());
+                ns.append("ns", entry.ns);
+                ns.append("conflicts", entry.conflicts);
+                ns.append("escalations", entry.escalations);
+                ns.append("backoffMicros", entry.backoffMicros);
+                ns.done();
+            }
+
+            BSONObjBuilder ret;
+            ret.append("maxTrackedNamespaces",
+                       static_cast<int>(WriteConflictStats::kMaxNamespaces));
+            ret.append("namespaces", namespaces.arr());
+            return ret.obj();
+        }
+
+    } writeConflictsServerStatusSection;
+
+    /**
+     * Reports contention on SpinLocks, in total and for each group of them.
+     */
+    class SpinLockStatsMetric : public ServerStatusMetric {
+    public:
+        SpinLockStatsMetric() : ServerStatusMetric("spinLocks") { }
+
+        virtual void appendAtLeaf(BSONObjBuilder& b) const {
+            BSONObjBuilder spinLocks(b.subobjStart(_leafName));
+
+            long long contended = 0;
+            long long parked = 0;
+            long long parkedMicros = 0;
+            for (const SpinLockStats* stats = SpinLockStats::first(); stats;
+                 stats = stats->next()) {
+                BSONObjBuilder group(spinLocks.subobjStart(stats->name()));
+                _append(&group,
+                        stats->contended.load(),
+                        stats->parked.load(),
+                        stats->parkedMicros.load());
+                contended += stats->contended.load();
+                parked += stats->parked.load();
+                parkedMicros += stats->parkedMicros.load();
+            }
+
+            BSONObjBuilder total(spinLocks.subobjStart("total"));
+            _append(&total, contended, parked, parkedMicros);
+        }
+
+    private:
+        static void _append(BSONObjBuilder* builder,
+                            long long contended,
+                            long long parked,
+                            long long parkedMicros) {
+            builder->append("contended", contended);
+            builder->append("parked", parked);
+            builder->append("parkedMicros", parkedMicros);
+        }
+
+    } spinLockStatsMetric;
+
 } // namespace
 } // namespace mongo
@@ -0,0 +1,173 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/operation_latency_histograms.h"
+
+#include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+    OperationLatencyHistograms globalOperationLatencyHistograms;
+
+    void OperationLatencyHistograms::record(int op, Command* command, long long micros) {
+        if (micros < 0) {
+            micros = 0;
+        }
+
+        OpIndex index;
+        switch (op) {
+        case dbQuery: index = kQuery; break;
+        case dbGetMore: index = kGetMore; break;
+        case dbInsert: index = kInsert; break;
+        case dbUpdate: index = kUpdate; break;
+        case dbDelete: index = kDelete; break;
+        case dbKillCursors: index = kKillCursors; break;
+        case dbCommand: index = kCommand; break;
+        default: return;
+        }
+        _ops[index].record(micros);
+
+        if (command) {
+            command->getLatencyHistogram()->record(micros);
+
+            switch (command->getReadWriteType()) {
+            case Command::ReadWriteType::kRead: _reads.record(micros); break;
+            case Command::ReadWriteType::kWrite: _writes.record(micros); break;
+            case Command::ReadWriteType::kCommand: _commands.record(micros); break;
+            }
+            return;
+        }
+
+        switch (index) {
+        case kQuery:
+        case kGetMore:
+            _reads.record(micros);
+            break;
+        case kInsert:
+        case kUpdate:
+        case kDelete:
+            _writes.record(micros);
+            break;
+        default:
+            _commands.record(micros);
+            break;
+        }
+    }
+
+    void OperationLatencyHistograms::append(BSONObjBuilder* builder) const {
+        // Indexed by OpIndex. The names match the ones used in the log and in currentOp.
+        static const int kOpcodes[kNumOps] = {
+            dbQuery, dbGetMore, dbInsert, dbUpdate, dbDelete, dbKillCursors, dbCommand
+        };
+
+        {
+            BSONObjBuilder opsBuilder(builder->subobjStart("opcodes"));
+            for (int i = 0; i < kNumOps; i++) {
+                BSONObjBuilder opBuilder(opsBuilder.subobjStart(opToString(kOpcodes[i])));
+                _ops[i].append(&opBuilder);
+            }
+        }
+
+        {
+            BSONObjBuilder readsBuilder(builder->subobjStart("reads"));
+            _reads.append(&readsBuilder);
+        }
+        {
+            BSONObjBuilder writesBuilder(builder->subobjStart("writes"));
+            _writes.append(&writesBuilder);
+        }
+        {
+            BSONObjBuilder commandsBuilder(builder->subobjStart("commands"));
+            _commands.append(&commandsBuilder);
+        }
+
+        BSONObjBuilder perCommandBuilder(builder->subobjStart("perCommand"));
+        const Command::CommandMap* commands = Command::commandsByBestName();
+        for (Command::CommandMap::const_iterator it = commands->begin();
+             it != commands->end();
+             ++it) {
+            LatencyHistogram* histogram = it->second->getLatencyHistogram();
+            if (histogram->getCount() == 0) {
+                continue;
+            }
+            BSONObjBuilder commandBuilder(perCommandBuilder.subobjStart(it->first));
+            histogram->append(&commandBuilder);
+        }
+    }
+
+    void OperationLatencyHistograms::reset() {
+        for (int i = 0; i < kNumOps; i++) {
+            _ops[i].reset();
+        }
+        _reads.reset();
+        _writes.reset();
+        _commands.reset();
+
+        const Command::CommandMap* commands = Command::commandsByBestName();
+        for (Command::CommandMap::const_iterator it = commands->begin();
+             it != commands->end();
+             ++it) {
+            it->second->getLatencyHistogram()->reset();
+        }
+    }
+
+namespace {
+
+    /**
+     * Reports the operation latency histograms. Not included by default, since it is large.
+     * Running serverStatus with {latencyHistograms: {reset: true}} clears the histograms after
+     * they have been reported, so that the next report only covers operations since then.
+     */
+    class LatencyHistogramsServerStatusSection : public ServerStatusSection {
+    public:
+        LatencyHistogramsServerStatusSection() : ServerStatusSection("latencyHistograms") { }
+
+        virtual bool includeByDefault() const { return false; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            BSONObjBuilder ret;
+            globalOperationLatencyHistograms.append(&ret);
+
+            if (configElement.type() == Object &&
+                configElement.Obj()["reset"].trueValue()) {
+                globalOperationLatencyHistograms.reset();
+            }
+
+            return ret.obj();
+        }
+
+    } latencyHistogramsServerStatusSection;
+
+}  // namespace
+}  // namespace mongo
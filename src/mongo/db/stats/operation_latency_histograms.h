@@ -0,0 +1,86 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/stats/latency_histogram.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+    class Command;
+
+    /**
+     * Latency histograms for every operation mongod serves, kept per wire protocol opcode and per
+     * class of operation (reads, writes and commands). Per-command histograms live on each
+     * Command and are recorded into from here as well.
+     */
+    class OperationLatencyHistograms {
+        MONGO_DISALLOW_COPYING(OperationLatencyHistograms);
+    public:
+        OperationLatencyHistograms() = default;
+
+        /**
+         * Records an operation received with opcode "op" which took "micros" microseconds.
+         * "command" is the command the operation ran, or NULL for legacy CRUD operations and for
+         * commands which could not be found.
+         */
+        void record(int op, Command* command, long long micros);
+
+        /**
+         * Appends the opcode, class and non-empty per-command histograms to "builder".
+         */
+        void append(BSONObjBuilder* builder) const;
+
+        /**
+         * Clears every histogram, including the per-command ones.
+         */
+        void reset();
+
+    private:
+        enum OpIndex {
+            kQuery,
+            kGetMore,
+            kInsert,
+            kUpdate,
+            kDelete,
+            kKillCursors,
+            kCommand,
+            kNumOps
+        };
+
+        LatencyHistogram _ops[kNumOps];
+        LatencyHistogram _reads;
+        LatencyHistogram _writes;
+        LatencyHistogram _commands;
+    };
+
+    extern OperationLatencyHistograms globalOperationLatencyHistograms;
+
+}  // namespace mongo
@@ -0,0 +1,74 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/profile_ring_buffer.h"
+
+#include <algorithm>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    ProfileRingBuffer::ProfileRingBuffer(size_t capacity)
+        : _capacity(capacity),
+          _slots(new Slot[capacity]) {
+        invariant(capacity > 0);
+    }
+
+    void ProfileRingBuffer::record(BSONObj entry) {
+        dassert(entry.isOwned());
+        const long long seq = _lastSeq.addAndFetch(1);
+        Slot& slot = _slots[seq % _capacity];
+
+        scoped_spinlock lk(slot.lock);
+        // A writer that lapped us may already have stored a newer entry.
+        if (slot.seq < seq) {
+            slot.seq = seq;
+            slot.entry = std::move(entry);
+        }
+    }
+
+    long long ProfileRingBuffer::getSince(long long afterSeq, std::vector<Sample>* out) const {
+        const long long lastSeq = _lastSeq.load();
+        const long long oldestSeq = std::max(afterSeq + 1,
+                                             lastSeq - static_cast<long long>(_capacity) + 1);
+        for (long long seq = oldestSeq; seq <= lastSeq; ++seq) {
+            const Slot& slot = _slots[seq % _capacity];
+
+            scoped_spinlock lk(slot.lock);
+            // Skip entries that were overwritten, or that are not stored yet.
+            if (slot.seq == seq) {
+                out->push_back(Sample{seq, slot.entry});
+            }
+        }
+        return lastSeq;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,91 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/spin_lock.h"
+
+namespace mongo {
+
+    /**
+     * A fixed-size ring of the most recent profile entries of sampled operations.
+     *
+     * Each entry gets a sequence number, starting at 1, from a single atomic counter, which also
+     * selects its slot. Recording only locks that slot, so concurrent writers do not contend
+     * unless the ring wraps around while one of them is still copying in. Readers copy one slot
+     * at a time and skip entries that were overwritten before they got to them, or that were
+     * still being recorded.
+     */
+    class ProfileRingBuffer {
+        MONGO_DISALLOW_COPYING(ProfileRingBuffer);
+    public:
+        struct Sample {
+            long long seq;
+            BSONObj entry;
+        };
+
+        explicit ProfileRingBuffer(size_t capacity);
+
+        /**
+         * Records 'entry', which must be owned, overwriting the oldest entry if the ring is full.
+         */
+        void record(BSONObj entry);
+
+        /**
+         * Appends the entries with sequence numbers above 'afterSeq' that are still in the ring
+         * to 'out', oldest first. Returns the sequence number of the last entry recorded so far,
+         * to be passed as 'afterSeq' next time.
+         */
+        long long getSince(long long afterSeq, std::vector<Sample>* out) const;
+
+        size_t capacity() const { return _capacity; }
+
+        /**
+         * The number of entries ever recorded, including those that were since overwritten.
+         */
+        long long numRecorded() const { return _lastSeq.load(); }
+
+    private:
+        struct Slot {
+            mutable SpinLock lock;
+            long long seq = 0;
+            BSONObj entry;
+        };
+
+        const size_t _capacity;
+        std::unique_ptr<Slot[]> _slots;
+        AtomicInt64 _lastSeq;
+    };
+
+}  // namespace mongo
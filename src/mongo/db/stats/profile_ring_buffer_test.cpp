@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/profile_ring_buffer.h"
+
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    typedef std::vector<ProfileRingBuffer::Sample> Samples;
+
+    TEST(ProfileRingBufferTest, Empty) {
+        ProfileRingBuffer ring(4);
+        Samples samples;
+        ASSERT_EQUALS(0, ring.getSince(0, &samples));
+        ASSERT_TRUE(samples.empty());
+        ASSERT_EQUALS(0, ring.numRecorded());
+    }
+
+    TEST(ProfileRingBufferTest, ReturnsEntriesOldestFirst) {
+        ProfileRingBuffer ring(4);
+        for (int i = 0; i < 3; i++) {
+            ring.record(BSON("op" << i));
+        }
+
+        Samples samples;
+        ASSERT_EQUALS(3, ring.getSince(0, &samples));
+        ASSERT_EQUALS(3U, samples.size());
+        for (int i = 0; i < 3; i++) {
+            ASSERT_EQUALS(i + 1, samples[i].seq);
+            ASSERT_EQUALS(BSON("op" << i), samples[i].entry);
+        }
+    }
+
+    TEST(ProfileRingBufferTest, OverwritesOldestEntries) {
+        ProfileRingBuffer ring(4);
+        for (int i = 0; i < 10; i++) {
+            ring.record(BSON("op" << i));
+        }
+        ASSERT_EQUALS(10, ring.numRecorded());
+
+        Samples samples;
+        ASSERT_EQUALS(10, ring.getSince(0, &samples));
+        ASSERT_EQUALS(4U, samples.size());
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQUALS(i + 7, samples[i].seq);
+            ASSERT_EQUALS(BSON("op" << i + 6), samples[i].entry);
+        }
+    }
+
+    TEST(ProfileRingBufferTest, GetSinceSkipsEntriesAlreadySeen) {
+        ProfileRingBuffer ring(8);
+        for (int i = 0; i < 5; i++) {
+            ring.record(BSON("op" << i));
+        }
+
+        Samples samples;
+        const long long lastSeq = ring.getSince(0, &samples);
+        ring.record(BSON("op" << 5));
+
+        samples.clear();
+        ASSERT_EQUALS(6, ring.getSince(lastSeq, &samples));
+        ASSERT_EQUALS(1U, samples.size());
+        ASSERT_EQUALS(6, samples[0].seq);
+        ASSERT_EQUALS(BSON("op" << 5), samples[0].entry);
+
+        samples.clear();
+        ASSERT_EQUALS(6, ring.getSince(6, &samples));
+        ASSERT_TRUE(samples.empty());
+    }
+
+}  // namespace
@@ -0,0 +1,183 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/query_stats_store.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+
+namespace {
+    // Whether 'ns' is the name of a collection of database 'db'.
+    bool isInDatabase(StringData ns, StringData db) {
+        return ns.size() > db.size() && ns.startsWith(db) && ns[db.size()] == '.';
+    }
+}  // namespace
+
+    QueryStatsStore::Entry::Entry(StringData ns, StringData opType, const BSONObj& shape)
+        : ns(ns.toString()),
+          opType(opType.toString()),
+          shape(shape.getOwned()) {
+    }
+
+    QueryStatsStore::QueryStatsStore(size_t maxShapes)
+        : _maxShapesPerPartition(std::max<size_t>(maxShapes / kNumPartitions, 1)),
+          _partitions(new Partition[kNumPartitions]) {
+    }
+
+    QueryStatsStore::Partition& QueryStatsStore::partitionFor(StringData key) const {
+        return _partitions[StringData::Hasher()(key) % kNumPartitions];
+    }
+
+    void QueryStatsStore::record(StringData ns,
+                                 StringData opType,
+                                 StringData shapeKey,
+                                 const BSONObj& shape,
+                                 const OpStats& stats) {
+        std::string key;
+        key.reserve(ns.size() + opType.size() + shapeKey.size() + 2);
+        key.append(ns.rawData(), ns.size());
+        key.push_back('\0');
+        key.append(opType.rawData(), opType.size());
+        key.push_back('\0');
+        key.append(shapeKey.rawData(), shapeKey.size());
+
+        const Date_t now = Date_t::now();
+        const unsigned long long used = _clock.addAndFetch(1);
+
+        Partition& partition = partitionFor(key);
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+
+        auto it = partition.entries.find(key);
+        if (it == partition.entries.end()) {
+            if (partition.entries.size() >= _maxShapesPerPartition) {
+                // Evict the shape recorded into least recently.
+                auto victim = partition.entries.begin();
+                for (auto other = partition.entries.begin(); other != partition.entries.end();
+                        ++other) {
+                    if (other->second->lastUsed < victim->second->lastUsed) {
+                        victim = other;
+                    }
+                }
+                partition.entries.erase(victim);
+                _numEvicted.addAndFetch(1);
+            }
+
+            it = partition.entries.emplace(key,
+                                           stdx::make_unique<Entry>(ns, opType, shape)).first;
+            it->second->firstSeen = now;
+        }
+
+        Entry* const e = it->second.get();
+        e->latency.record(std::max(stats.micros, 0LL));
+        e->totalMicros += std::max(stats.micros, 0LL);
+        e->keysExamined += std::max(stats.keysExamined, 0LL);
+        e->docsExamined += std::max(stats.docsExamined, 0LL);
+        e->nreturned += std::max(stats.nreturned, 0LL);
+        e->yields += std::max(stats.yields, 0LL);
+        if (stats.replanned) {
+            e->replans++;
+        }
+        e->lastSeen = now;
+        e->lastUsed = used;
+    }
+
+    std::vector<BSONObj> QueryStatsStore::getEntries(StringData db) const {
+        std::vector<std::pair<long long, BSONObj>> entries;
+        for (size_t i = 0; i < kNumPartitions; i++) {
+            const Partition& partition = _partitions[i];
+            stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+            for (const auto& kv : partition.entries) {
+                const Entry& e = *kv.second;
+                if (!isInDatabase(e.ns, db)) {
+                    continue;
+                }
+
+                BSONObjBuilder b;
+                b.append("ns", e.ns);
+                b.append("opType", e.opType);
+                b.append("shape", e.shape);
+                {
+                    BSONObjBuilder latency(b.subobjStart("latency"));
+                    e.latency.append(&latency);
+                }
+                b.appendNumber("keysExamined", e.keysExamined);
+                b.appendNumber("docsExamined", e.docsExamined);
+                b.appendNumber("nreturned", e.nreturned);
+                b.appendNumber("yields", e.yields);
+                b.appendNumber("replans", e.replans);
+                b.appendDate("firstSeen", e.firstSeen);
+                b.appendDate("lastSeen", e.lastSeen);
+                entries.emplace_back(e.totalMicros, b.obj());
+            }
+        }
+
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const std::pair<long long, BSONObj>& lhs,
+                            const std::pair<long long, BSONObj>& rhs) {
+                             return lhs.first > rhs.first;
+                         });
+
+        std::vector<BSONObj> out;
+        out.reserve(entries.size());
+        for (auto& entry : entries) {
+            out.push_back(std::move(entry.second));
+        }
+        return out;
+    }
+
+    void QueryStatsStore::reset(StringData db) {
+        for (size_t i = 0; i < kNumPartitions; i++) {
+            Partition& partition = _partitions[i];
+            stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+            for (auto it = partition.entries.begin(); it != partition.entries.end();) {
+                if (isInDatabase(it->second->ns, db)) {
+                    it = partition.entries.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    size_t QueryStatsStore::numShapes() const {
+        size_t n = 0;
+        for (size_t i = 0; i < kNumPartitions; i++) {
+            stdx::lock_guard<stdx::mutex> lk(_partitions[i].mutex);
+            n += _partitions[i].entries.size();
+        }
+        return n;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    /**
+     * Execution statistics of the queries run on each collection, aggregated by query shape and
+     * by the kind of operation which ran them, such as find, count, distinct or aggregate.
+     *
+     * The store holds at most a fixed number of shapes, evicting the one recorded into least
+     * recently to make room for a new one. It is split into partitions by the hash of the
+     * shape, each with its own mutex which is only held to update a single shape, so that
+     * operations of different shapes rarely contend.
+     */
+    class QueryStatsStore {
+        MONGO_DISALLOW_COPYING(QueryStatsStore);
+    public:
+        /**
+         * What one operation did, as recorded by record().
+         */
+        struct OpStats {
+            long long micros = 0;
+            long long keysExamined = 0;
+            long long docsExamined = 0;
+            long long nreturned = 0;
+            long long yields = 0;
+            bool replanned = false;
+        };
+
+        explicit QueryStatsStore(size_t maxShapes);
+
+        /**
+         * Records an operation of kind 'opType' on the collection 'ns', which ran a query whose
+         * shape is identified by 'shapeKey'. 'shape' describes that shape for reporting, and is
+         * only kept for the first operation of each shape.
+         */
+        void record(StringData ns,
+                    StringData opType,
+                    StringData shapeKey,
+                    const BSONObj& shape,
+                    const OpStats& stats);
+
+        /**
+         * Returns a document for each shape of the collections in database 'db', with the most
+         * total execution time first.
+         */
+        std::vector<BSONObj> getEntries(StringData db) const;
+
+        /**
+         * Discards the shapes of the collections in database 'db'.
+         */
+        void reset(StringData db);
+
+        size_t numShapes() const;
+
+        /**
+         * The number of shapes evicted to make room for others.
+         */
+        long long numEvicted() const { return _numEvicted.load(); }
+
+    private:
+        struct Entry {
+            Entry(StringData ns, StringData opType, const BSONObj& shape);
+
+            const std::string ns;
+            const std::string opType;
+            const BSONObj shape;
+
+            LatencyHistogram latency;
+            long long totalMicros = 0;
+            long long keysExamined = 0;
+            long long docsExamined = 0;
+            long long nreturned = 0;
+            long long yields = 0;
+            long long replans = 0;
+            Date_t firstSeen;
+            Date_t lastSeen;
+
+            // When the entry was last recorded into, by the store's clock, for eviction.
+            unsigned long long lastUsed = 0;
+        };
+
+        struct Partition {
+            mutable stdx::mutex mutex;
+            unordered_map<std::string, std::unique_ptr<Entry>> entries;
+        };
+
+        static const size_t kNumPartitions = 16;
+
+        Partition& partitionFor(StringData key) const;
+
+        const size_t _maxShapesPerPartition;
+        std::unique_ptr<Partition[]> _partitions;
+        AtomicUInt64 _clock;
+        AtomicInt64 _numEvicted;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/query_stats_store.h"
+
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    QueryStatsStore::OpStats opStats(long long micros, long long docsExamined) {
+        QueryStatsStore::OpStats stats;
+        stats.micros = micros;
+        stats.keysExamined = docsExamined;
+        stats.docsExamined = docsExamined;
+        stats.nreturned = 1;
+        return stats;
+    }
+
+    TEST(QueryStatsStoreTest, AggregatesOperationsOfAShape) {
+        QueryStatsStore store(100);
+        const BSONObj shape = BSON("query" << BSON("a" << 1));
+        store.record("test.coll", "find", "eqa", shape, opStats(10, 5));
+        QueryStatsStore::OpStats replanned = opStats(30, 7);
+        replanned.yields = 2;
+        replanned.replanned = true;
+        store.record("test.coll", "find", "eqa", BSON("query" << BSON("a" << 2)), replanned);
+
+        std::vector<BSONObj> entries = store.getEntries("test");
+        ASSERT_EQUALS(1U, entries.size());
+        const BSONObj& entry = entries[0];
+        ASSERT_EQUALS("test.coll", entry["ns"].String());
+        ASSERT_EQUALS("find", entry["opType"].String());
+        // the shape of the first operation is kept
+        ASSERT_EQUALS(shape, entry["shape"].Obj());
+        ASSERT_EQUALS(2, entry["latency"]["count"].numberLong());
+        ASSERT_EQUALS(40, entry["latency"]["totalMicros"].numberLong());
+        ASSERT_EQUALS(12, entry["docsExamined"].numberLong());
+        ASSERT_EQUALS(12, entry["keysExamined"].numberLong());
+        ASSERT_EQUALS(2, entry["nreturned"].numberLong());
+        ASSERT_EQUALS(2, entry["yields"].numberLong());
+        ASSERT_EQUALS(1, entry["replans"].numberLong());
+    }
+
+    TEST(QueryStatsStoreTest, KeysByNamespaceOpTypeAndShape) {
+        QueryStatsStore store(100);
+        store.record("test.coll", "find", "eqa", BSONObj(), opStats(1, 1));
+        store.record("test.coll", "count", "eqa", BSONObj(), opStats(1, 1));
+        store.record("test.coll", "find", "eqb", BSONObj(), opStats(1, 1));
+        store.record("test.other", "find", "eqa", BSONObj(), opStats(1, 1));
+        store.record("test2.coll", "find", "eqa", BSONObj(), opStats(1, 1));
+        ASSERT_EQUALS(5U, store.numShapes());
+        ASSERT_EQUALS(4U, store.getEntries("test").size());
+        ASSERT_EQUALS(1U, store.getEntries("test2").size());
+        ASSERT_EQUALS(0U, store.getEntries("tes").size());
+    }
+
+    TEST(QueryStatsStoreTest, MostExpensiveShapeFirst) {
+        QueryStatsStore store(100);
+        store.record("test.coll", "find", "cheap", BSONObj(), opStats(10, 1));
+        store.record("test.coll", "find", "costly", BSONObj(), opStats(1000, 1));
+        store.record("test.coll", "find", "many", BSONObj(), opStats(100, 1));
+        store.record("test.coll", "find", "many", BSONObj(), opStats(100, 1));
+
+        std::vector<BSONObj> entries = store.getEntries("test");
+        ASSERT_EQUALS(3U, entries.size());
+        ASSERT_EQUALS(1000, entries[0]["latency"]["totalMicros"].numberLong());
+        ASSERT_EQUALS(200, entries[1]["latency"]["totalMicros"].numberLong());
+        ASSERT_EQUALS(10, entries[2]["latency"]["totalMicros"].numberLong());
+    }
+
+    TEST(QueryStatsStoreTest, EvictsLeastRecentlyRecordedShapes) {
+        // one shape per partition
+        QueryStatsStore store(1);
+        for (int i = 0; i < 1000; i++) {
+            store.record("test.coll", "find", BSON("i" << i).toString(), BSONObj(),
+                         opStats(1, 1));
+        }
+        ASSERT_LESS_THAN_OR_EQUALS(store.numShapes(), 16U);
+        ASSERT_EQUALS(1000, store.numEvicted() + static_cast<long long>(store.numShapes()));
+
+        // the shape recorded last is still there
+        store.record("test.coll", "find", BSON("i" << 999).toString(), BSONObj(),
+                     opStats(1, 1));
+        ASSERT_EQUALS(1000, store.numEvicted() + static_cast<long long>(store.numShapes()));
+    }
+
+    TEST(QueryStatsStoreTest, ResetDiscardsTheShapesOfADatabase) {
+        QueryStatsStore store(100);
+        store.record("test.coll", "find", "eqa", BSONObj(), opStats(1, 1));
+        store.record("other.coll", "find", "eqa", BSONObj(), opStats(1, 1));
+        store.reset("test");
+        ASSERT_EQUALS(0U, store.getEntries("test").size());
+        ASSERT_EQUALS(1U, store.getEntries("other").size());
+    }
+
+}  // namespace
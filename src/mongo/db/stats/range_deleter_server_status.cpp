@@ -26,6 +26,8 @@
  *    it in the license file.
  */
 
+#include <algorithm>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/range_deleter_service.h"
@@ -38,6 +40,13 @@ namespace mongo {
      * Sample format:
      *
      * rangeDeleter: {
+     *   workers: 1,
+     *   queue: {
+     *     pending: 3,
+     *     inProgress: 1,
+     *     oldestQueued: ISODate("2014-06-11T22:40:12.003Z")
+     *   },
+     *   estimatedSecsToDrain: 12.5,
      *   lastDeleteStats: [
      *     {
      *       deleteDocs: NumberLong(5);
@@ -65,9 +74,43 @@ namespace mongo {
             }
 
             BSONObjBuilder result;
+            result.append("workers", static_cast<long long>(deleter->getNumWorkers()));
+
+            const size_t pending = deleter->getPendingDeletes();
+            const size_t inProgress = deleter->getDeletesInProgress();
+            {
+                BSONObjBuilder queueBuilder(result.subobjStart("queue"));
+                queueBuilder.append("pending", static_cast<long long>(pending));
+                queueBuilder.append("inProgress", static_cast<long long>(inProgress));
+                const Date_t oldestQueued = deleter->getOldestPendingQueueStart();
+                if (oldestQueued > Date_t()) {
+                    queueBuilder.append("oldestQueued", oldestQueued);
+                }
+                queueBuilder.doneFast();
+            }
 
             OwnedPointerVector<DeleteJobStats> statsList;
             deleter->getStatsHistory(&statsList.mutableVector());
+
+            // The queue is estimated to drain at the pace of the recently finished deletes,
+            // spread over the workers.
+            long long finishedMillis = 0;
+            long long finishedDeletes = 0;
+            for (OwnedPointerVector<DeleteJobStats>::const_iterator it = statsList.begin();
+                 it != statsList.end(); ++it) {
+                if ((*it)->deleteEndTS > Date_t()) {
+                    const Date_t end = std::max((*it)->deleteEndTS, (*it)->waitForReplEndTS);
+                    finishedMillis += durationCount<Milliseconds>(end - (*it)->deleteStartTS);
+                    finishedDeletes++;
+                }
+            }
+            if (finishedDeletes > 0) {
+                const double workers = std::max(deleter->getNumWorkers(), size_t(1));
+                result.append("estimatedSecsToDrain",
+                              (pending + inProgress) * (finishedMillis / 1000.0)
+                                  / finishedDeletes / workers);
+            }
+
             BSONArrayBuilder oldStatsBuilder;
             for (OwnedPointerVector<DeleteJobStats>::const_iterator it = statsList.begin();
                  it != statsList.end(); ++it) {
@@ -0,0 +1,76 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    const size_t kCacheLineSize = 64;
+
+    /**
+     * The number of shards of the stats which threads running on different cores update.
+     */
+    const unsigned kNumStatsShards = 32;
+
+    /**
+     * Returns the shard the calling thread should update, which is picked by the CPU it runs on
+     * where that is known, and otherwise by the thread.
+     */
+    unsigned currentStatsShard();
+
+    /**
+     * A 64-bit counter split into one cache line per shard, so threads on different cores don't
+     * contend for it. Adding is a single atomic add to the calling thread's shard, and reading sums
+     * up all shards, which is only consistent with concurrent adds as a whole, not per shard.
+     */
+    class ShardedCounter64 {
+        MONGO_DISALLOW_COPYING(ShardedCounter64);
+    public:
+        ShardedCounter64() = default;
+
+        void increment(long long n = 1) {
+            _shards[currentStatsShard()].value.fetchAndAdd(n);
+        }
+
+        long long get() const;
+
+        void reset();
+
+    private:
+        struct Shard {
+            AtomicInt64 value;
+            char pad[kCacheLineSize - sizeof(AtomicInt64)];
+        };
+
+        Shard _shards[kNumStatsShards];
+    };
+
+}  // namespace mongo
@@ -0,0 +1,83 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+#include "mongo/db/stats/sharded_counter.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    TEST(ShardedCounter64, StartsAtZero) {
+        ShardedCounter64 counter;
+        ASSERT_EQUALS(0, counter.get());
+    }
+
+    TEST(ShardedCounter64, IncrementAndReset) {
+        ShardedCounter64 counter;
+        counter.increment();
+        counter.increment(41);
+        ASSERT_EQUALS(42, counter.get());
+
+        counter.reset();
+        ASSERT_EQUALS(0, counter.get());
+    }
+
+    TEST(ShardedCounter64, ShardsDontShareCacheLines) {
+        ASSERT_EQUALS(kCacheLineSize * kNumStatsShards, sizeof(ShardedCounter64));
+        ASSERT_LESS_THAN(currentStatsShard(), kNumStatsShards);
+    }
+
+    void incrementMany(ShardedCounter64* counter) {
+        for (int i = 0; i < 100000; i++) {
+            counter->increment();
+        }
+    }
+
+    TEST(ShardedCounter64, ConcurrentIncrementsAddUp) {
+        ShardedCounter64 counter;
+
+        std::vector<boost::thread*> threads;
+        for (int i = 0; i < 8; i++) {
+            threads.push_back(new boost::thread(stdx::bind(incrementMany, &counter)));
+        }
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i]->join();
+            delete threads[i];
+        }
+
+        ASSERT_EQUALS(800000, counter.get());
+    }
+
+} // namespace
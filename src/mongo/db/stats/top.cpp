@@ -70,6 +70,18 @@ namespace {
 
     }
 
+    void Top::CollectionData::add( const CollectionData& other ) {
+        total.add( other.total );
+        readLock.add( other.readLock );
+        writeLock.add( other.writeLock );
+        queries.add( other.queries );
+        getmore.add( other.getmore );
+        insert.add( other.insert );
+        update.add( other.update );
+        remove.add( other.remove );
+        commands.add( other.commands );
+    }
+
     // static
     Top& Top::get(ServiceContext* service) {
         return getTop(service);
@@ -79,15 +91,19 @@ namespace {
         if ( ns[0] == '?' )
             return;
 
-        //cout << "record: " << ns << "\t" << op << "\t" << command << endl;
-        SimpleMutex::scoped_lock lk(_lock);
-
-        if ( ( command || op == dbQuery ) && ns == _lastDropped ) {
-            _lastDropped = "";
-            return;
+        if ( ( command || op == dbQuery ) && _hasLastDropped.loadRelaxed() ) {
+            SimpleMutex::scoped_lock lk(_lastDroppedLock);
+            if ( ns == _lastDropped ) {
+                _lastDropped = "";
+                _hasLastDropped.store(0);
+                return;
+            }
         }
 
-        CollectionData& coll = _usage[ns];
+        Shard& shard = _shards[currentStatsShard()];
+        SimpleMutex::scoped_lock lk(shard.lock);
+
+        CollectionData& coll = shard.usage[ns];
         _record( coll, op, lockType, micros, command );
     }
 
@@ -138,19 +154,35 @@ namespace {
     }
 
     void Top::collectionDropped( StringData ns ) {
-        SimpleMutex::scoped_lock lk(_lock);
-        _usage.erase(ns);
+        for ( unsigned i = 0; i < kNumStatsShards; i++ ) {
+            SimpleMutex::scoped_lock lk(_shards[i].lock);
+            _shards[i].usage.erase(ns);
+        }
+
+        SimpleMutex::scoped_lock lk(_lastDroppedLock);
         _lastDropped = ns.toString();
+        _hasLastDropped.store(1);
+    }
+
+    void Top::_mergeShards( UsageMap* out ) const {
+        *out = UsageMap();
+        for ( unsigned i = 0; i < kNumStatsShards; i++ ) {
+            SimpleMutex::scoped_lock lk(_shards[i].lock);
+            const UsageMap& usage = _shards[i].usage;
+            for ( UsageMap::const_iterator it = usage.begin(); it != usage.end(); ++it ) {
+                (*out)[it->first].add( it->second );
+            }
+        }
     }
 
     void Top::cloneMap(Top::UsageMap& out) const {
-        SimpleMutex::scoped_lock lk(_lock);
-        out = _usage;
+        _mergeShards( &out );
     }
 
     void Top::append( BSONObjBuilder& b ) {
-        SimpleMutex::scoped_lock lk( _lock );
-        _appendToUsageMap( b, _usage );
+        UsageMap usage;
+        _mergeShards( &usage );
+        _appendToUsageMap( b, usage );
     }
 
     void Top::_appendToUsageMap( BSONObjBuilder& b, const UsageMap& map ) const {
@@ -31,6 +31,9 @@
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/stats/sharded_counter.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
 
@@ -40,13 +43,17 @@ namespace mongo {
 
     /**
      * tracks usage by collection
+     *
+     * The usage is recorded into one map per shard, picked by the core the recording thread runs
+     * on, so that operations on different cores don't serialize on one mutex. Readers merge the
+     * shards.
      */
     class Top {
-
+        MONGO_DISALLOW_COPYING(Top);
     public:
         static Top& get(ServiceContext* service);
 
-        Top() : _lock("Top") { }
+        Top() : _lastDroppedLock("Top"), _hasLastDropped(0) { }
 
         struct UsageData {
             UsageData() : time(0), count(0) {}
@@ -58,6 +65,11 @@ namespace mongo {
                 count++;
                 time += micros;
             }
+
+            void add( const UsageData& other ) {
+                count += other.count;
+                time += other.time;
+            }
         };
 
         struct CollectionData {
@@ -78,9 +90,11 @@ namespace mongo {
             UsageData update;
             UsageData remove;
             UsageData commands;
+
+            void add( const CollectionData& other );
         };
 
-        typedef StringMap<CollectionData> UsageMap;
+        typedef FlatStringMap<CollectionData> UsageMap;
 
     public:
         void record( StringData ns, int op, int lockType, long long micros, bool command );
@@ -92,10 +106,26 @@ namespace mongo {
         void _appendToUsageMap( BSONObjBuilder& b, const UsageMap& map ) const;
         void _appendStatsEntry( BSONObjBuilder& b, const char * statsName, const UsageData& map ) const;
         void _record( CollectionData& c, int op, int lockType, long long micros, bool command );
+        void _mergeShards( UsageMap* out ) const;
+
+        struct Shard {
+            Shard() : lock("Top") { }
+
+            mutable SimpleMutex lock;
+            UsageMap usage;
+
+            // Keeps the next shard's mutex off the cache lines of this one's map
+            char pad[kCacheLineSize];
+        };
+
+        Shard _shards[kNumStatsShards];
 
-        mutable SimpleMutex _lock;
-        UsageMap _usage;
+        // The first query or command on a collection after it was dropped is not recorded. Only
+        // set and checked under _lastDroppedLock, which record() only takes while
+        // _hasLastDropped is set.
+        SimpleMutex _lastDroppedLock;
         std::string _lastDropped;
+        AtomicUInt32 _hasLastDropped;
     };
 
 } // namespace mongo
@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/stats/top.h"
+#include "mongo/util/net/message.h"
 #include "mongo/unittest/unittest.h"
 
 namespace {
@@ -39,4 +40,37 @@ namespace {
         Top().collectionDropped("coll");
     }
 
+    TEST(TopTest, MergesUsageOfAllShards) {
+        Top top;
+        for (int i = 0; i < 10; i++) {
+            top.record("test.coll", dbQuery, -1, 100, false);
+            top.record("test.coll", dbInsert, 1, 10, false);
+        }
+        top.record("test.other", dbUpdate, 1, 5, false);
+
+        Top::UsageMap usage;
+        top.cloneMap(usage);
+        ASSERT_EQUALS(2U, usage.size());
+        ASSERT_EQUALS(20, usage["test.coll"].total.count);
+        ASSERT_EQUALS(1100, usage["test.coll"].total.time);
+        ASSERT_EQUALS(10, usage["test.coll"].queries.count);
+        ASSERT_EQUALS(10, usage["test.coll"].writeLock.count);
+        ASSERT_EQUALS(1, usage["test.other"].update.count);
+    }
+
+    TEST(TopTest, SkipsFirstQueryAfterDrop) {
+        Top top;
+        top.record("test.coll", dbQuery, -1, 100, false);
+        top.collectionDropped("test.coll");
+
+        Top::UsageMap usage;
+        top.cloneMap(usage);
+        ASSERT_EQUALS(0U, usage.size());
+
+        top.record("test.coll", dbQuery, -1, 100, true);
+        top.record("test.coll", dbQuery, -1, 100, false);
+        top.cloneMap(usage);
+        ASSERT_EQUALS(1, usage["test.coll"].queries.count);
+    }
+
 } // namespace
@@ -32,11 +32,12 @@
 
 #include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
 
-#include <set>
-
 #include "mongo/db/catalog/index_catalog_entry.h"
 #include "mongo/db/storage/index_entry_comparison.h"
 #include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
+#include "mongo/db/storage/in_memory/in_memory_skip_list.h"
+#include "mongo/db/storage/in_memory/in_memory_versioned_value.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -69,7 +70,25 @@ namespace {
         return bb.obj();
     }
 
-    typedef std::set<IndexKeyEntry, IndexEntryComparison> IndexSet;
+    typedef InMemorySkipList<IndexKeyEntry, InMemoryVersionedValue, IndexEntryComparison>
+        IndexEntries;
+
+    // This is the "persistent" data.
+    struct IndexData {
+        explicit IndexData(const Ordering& ordering)
+            : entries(IndexEntryComparison(ordering)),
+              uniqueKeys(IndexEntryComparison(ordering)),
+              keySize(0) {}
+
+        IndexEntries entries;
+
+        // Every insert which does not allow duplicates writes the entry of its key here, with a
+        // null RecordId, so that concurrent inserts of the same key into a unique index conflict
+        // rather than both passing the duplicate check.
+        IndexEntries uniqueKeys;
+
+        AtomicInt64 keySize;
+    };
 
     // taken from btree_logic.cpp
     Status dupKeyError(const BSONObj& key) {
@@ -80,23 +99,42 @@ namespace {
         return Status(ErrorCodes::DuplicateKey, sb.str());
     }
 
-    bool isDup(const IndexSet& data, const BSONObj& key, RecordId loc) {
-        const IndexSet::const_iterator it = data.find(IndexKeyEntry(key, RecordId()));
-        if (it == data.end())
-            return false;
+    bool isDup(OperationContext* txn, const IndexData& data, const BSONObj& key, RecordId loc) {
+        const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(txn);
+        const IndexEntryComparison& comparator = data.entries.less();
+        const IndexKeyEntry anyLoc(key, RecordId());
 
-        // Not a dup if the entry is for the same loc.
-        return it->loc != loc;
+        for (const IndexEntries::Node* node = data.entries.lowerBound({key, RecordId::min()});
+                node && comparator.compare(node->key, anyLoc) == 0;
+                node = node->next()) {
+            // Not a dup if the entry is for the same loc.
+            if (node->key.loc != loc && node->value.read(snapshot))
+                return true;
+        }
+        return false;
     }
 
+    class KeySizeChange : public RecoveryUnit::Change {
+    public:
+        KeySizeChange(IndexData* data, int64_t keySize) : _data(data), _keySize(keySize) {}
+
+        virtual void commit() {}
+        virtual void rollback() {
+            _data->keySize.fetchAndSubtract(_keySize);
+        }
+
+    private:
+        IndexData* const _data;
+        const int64_t _keySize;
+    };
+
     class InMemoryBtreeBuilderImpl : public SortedDataBuilderInterface {
     public:
-        InMemoryBtreeBuilderImpl(IndexSet* data, long long* currentKeySize, bool dupsAllowed)
+        InMemoryBtreeBuilderImpl(IndexData* data, bool dupsAllowed)
                 : _data(data),
-                  _currentKeySize( currentKeySize ),
                   _dupsAllowed(dupsAllowed),
-                  _comparator(_data->key_comp()) {
-            invariant(_data->empty());
+                  _comparator(_data->entries.less()) {
+            invariant(!_data->entries.first());
         }
 
         Status addKey(const BSONObj& key, const RecordId& loc) {
@@ -109,44 +147,44 @@ namespace {
             invariant(loc.isNormal());
             invariant(!hasFieldNames(key));
 
-            if (!_data->empty()) {
+            if (_last) {
                 // Compare specified key with last inserted key, ignoring its RecordId
-                int cmp = _comparator.compare(IndexKeyEntry(key, RecordId()), *_last);
-                if (cmp < 0 || (_dupsAllowed && cmp == 0 && loc < _last->loc)) {
+                int cmp = _comparator.compare(IndexKeyEntry(key, RecordId()), _last->key);
+                if (cmp < 0 || (_dupsAllowed && cmp == 0 && loc < _last->key.loc)) {
                     return Status(ErrorCodes::InternalError,
                                   "expected ascending (key, RecordId) order in bulk builder");
                 }
-                else if (!_dupsAllowed && cmp == 0 && loc != _last->loc) {
+                else if (!_dupsAllowed && cmp == 0 && loc != _last->key.loc) {
                     return dupKeyError(key);
                 }
             }
 
-            BSONObj owned = key.getOwned();
-            _last = _data->insert(_data->end(), IndexKeyEntry(owned, loc));
-            *_currentKeySize += key.objsize();
+            // Nobody can see the index before it is built, so the entries are added as if they
+            // were always there.
+            _last = _data->entries.insert(IndexKeyEntry(key.getOwned(), loc));
+            _last->value.initialize(RecordData());
+            _data->keySize.fetchAndAdd(key.objsize());
 
             return Status::OK();
         }
 
     private:
-        IndexSet* const _data;
-        long long* _currentKeySize;
+        IndexData* const _data;
         const bool _dupsAllowed;
 
         IndexEntryComparison _comparator;  // used by the bulk builder to detect duplicate keys
-        IndexSet::const_iterator _last;    // or (key, RecordId) ordering violations
+        IndexEntries::Node* _last = nullptr; // or (key, RecordId) ordering violations
     };
 
     class InMemoryBtreeImpl : public SortedDataInterface {
     public:
-        InMemoryBtreeImpl(IndexSet* data)
+        InMemoryBtreeImpl(IndexData* data)
             : _data(data) {
-            _currentKeySize = 0;
         }
 
         virtual SortedDataBuilderInterface* getBulkBuilder(OperationContext* txn,
                                                            bool dupsAllowed) {
-            return new InMemoryBtreeBuilderImpl(_data, &_currentKeySize, dupsAllowed);
+            return new InMemoryBtreeBuilderImpl(_data, dupsAllowed);
         }
 
         virtual Status insert(OperationContext* txn,
@@ -164,15 +202,23 @@ namespace {
                 return Status(ErrorCodes::KeyTooLong, msg);
             }
 
-            // TODO optimization: save the iterator from the dup-check to speed up insert
-            if (!dupsAllowed && isDup(*_data, key, loc))
-                return dupKeyError(key);
+            if (!dupsAllowed) {
+                if (isDup(txn, *_data, key, loc))
+                    return dupKeyError(key);
 
-            IndexKeyEntry entry(key.getOwned(), loc);
-            if ( _data->insert(entry).second ) {
-                _currentKeySize += key.objsize();
-                txn->recoveryUnit()->registerChange(new IndexChange(_data, entry, true));
+                IndexEntries::Node* unique = _data->uniqueKeys.insert({key.getOwned(), RecordId()});
+                InMemoryRecoveryUnit::write(txn, &unique->value, true);
             }
+
+            const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(txn);
+            IndexEntries::Node* node = _data->entries.find({key, loc});
+            if (node && node->value.read(snapshot))
+                return Status::OK();
+
+            if (!node)
+                node = _data->entries.insert(IndexKeyEntry(key.getOwned(), loc));
+            InMemoryRecoveryUnit::write(txn, &node->value, true);
+            changeKeySize(txn, key.objsize());
             return Status::OK();
         }
 
@@ -183,19 +229,24 @@ namespace {
             invariant(loc.isNormal());
             invariant(!hasFieldNames(key));
 
-            IndexKeyEntry entry(key.getOwned(), loc);
-            const size_t numDeleted = _data->erase(entry);
-            invariant(numDeleted <= 1);
-            if ( numDeleted == 1 ) {
-                _currentKeySize -= key.objsize();
-                txn->recoveryUnit()->registerChange(new IndexChange(_data, entry, false));
+            IndexEntries::Node* node = _data->entries.find({key, loc});
+            if (node && node->value.read(InMemoryRecoveryUnit::getSnapshot(txn))) {
+                InMemoryRecoveryUnit::write(txn, &node->value, false);
+                changeKeySize(txn, -key.objsize());
             }
         }
 
         virtual void fullValidate(OperationContext* txn, bool full, long long *numKeysOut,
                                   BSONObjBuilder* output) const {
             // TODO check invariants?
-            *numKeysOut = _data->size();
+            const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(txn);
+            long long numKeys = 0;
+            for (const IndexEntries::Node* node = _data->entries.first(); node;
+                    node = node->next()) {
+                if (node->value.read(snapshot))
+                    numKeys++;
+            }
+            *numKeysOut = numKeys;
         }
 
         virtual bool appendCustomStats(OperationContext* txn, BSONObjBuilder* output, double scale)
@@ -204,18 +255,26 @@ namespace {
         }
 
         virtual long long getSpaceUsedBytes( OperationContext* txn ) const {
-            return _currentKeySize + ( sizeof(IndexKeyEntry) * _data->size() );
+            long long numKeys;
+            fullValidate(txn, false, &numKeys, NULL);
+            return _data->keySize.load() + ( sizeof(IndexEntries::Node) * numKeys );
         }
 
         virtual Status dupKeyCheck(OperationContext* txn, const BSONObj& key, const RecordId& loc) {
             invariant(!hasFieldNames(key));
-            if (isDup(*_data, key, loc))
+            if (isDup(txn, *_data, key, loc))
                 return dupKeyError(key);
             return Status::OK();
         }
 
         virtual bool isEmpty(OperationContext* txn) {
-            return _data->empty();
+            const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(txn);
+            for (const IndexEntries::Node* node = _data->entries.first(); node;
+                    node = node->next()) {
+                if (node->value.read(snapshot))
+                    return false;
+            }
+            return true;
         }
 
         virtual Status touch(OperationContext* txn) const{
@@ -225,50 +284,45 @@ namespace {
 
         class Cursor final : public SortedDataInterface::Cursor {
         public:
-            Cursor(OperationContext* txn, const IndexSet& data, bool isForward)
+            Cursor(OperationContext* txn, const IndexEntries& data, bool isForward)
                 : _txn(txn),
                   _data(data),
-                  _forward(isForward),
-                  _it(data.end())
+                  _forward(isForward)
             {}
-            
+
             boost::optional<IndexKeyEntry> next(RequestedInfo parts) override {
-                if (_lastMoveWasRestore) {
-                    // Return current position rather than advancing.
-                    _lastMoveWasRestore = false;
-                }
-                else {
-                    advance();
-                    if (atEndPoint()) _isEOF = true;
+                // Nodes are never removed, so we are still in place after a restore even if our
+                // entry was deleted, and simply move on to the entry after it.
+                if (!_isEOF) {
+                    advance(InMemoryRecoveryUnit::getSnapshot(_txn));
                 }
 
                 if (_isEOF) return {};
-                return *_it;
+                return _node->key;
             }
-        
+
             void setEndPosition(const BSONObj& key, bool inclusive) override {
                 if (key.isEmpty()) {
                     // This means scan to end of index.
                     _endState = {};
                     return;
                 }
-                
+
                 // NOTE: this uses the opposite min/max rules as a normal seek because a forward
                 // scan should land after the key if inclusive and before if exclusive.
-                _endState = EndState(stripFieldNames(key),
-                                     _forward == inclusive ? RecordId::max() : RecordId::min());
-                seekEndCursor();
+                _endState = IndexKeyEntry(stripFieldNames(key),
+                                          _forward == inclusive ? RecordId::max()
+                                                                : RecordId::min());
             }
 
             boost::optional<IndexKeyEntry> seek(const BSONObj& key, bool inclusive,
                                                 RequestedInfo parts) override {
                 const BSONObj query = stripFieldNames(key);
                 locate(query, _forward == inclusive ? RecordId::min() : RecordId::max());
-                _lastMoveWasRestore = false;
                 if (_isEOF) return {};
-                dassert(inclusive ? compareKeys(_it->key, query) >= 0
-                                  : compareKeys(_it->key, query) > 0);
-                return *_it;
+                dassert(inclusive ? compareKeys(_node->key.key, query) >= 0
+                                  : compareKeys(_node->key.key, query) > 0);
+                return _node->key;
             }
 
             boost::optional<IndexKeyEntry> seek(const IndexSeekPoint& seekPoint,
@@ -276,85 +330,48 @@ namespace {
                 // Query encodes exclusive case so it can be treated as an inclusive query.
                 const BSONObj query = IndexEntryComparison::makeQueryObject(seekPoint, _forward);
                 locate(query, _forward ? RecordId::min() : RecordId::max());
-                _lastMoveWasRestore = false;
                 if (_isEOF) return {};
-                dassert(compareKeys(_it->key, query) >= 0);
-                return *_it;
+                dassert(compareKeys(_node->key.key, query) >= 0);
+                return _node->key;
             }
 
             void savePositioned() override {
-                // Keep original position if we haven't moved since the last restore.
                 _txn = nullptr;
-                if (_lastMoveWasRestore) return;
-
-                if (_isEOF) {
-                    saveUnpositioned();
-                    return;
-                }
-
-                _savedAtEnd = false;
-                _savedKey = _it->key.getOwned();
-                _savedLoc = _it->loc;
-                // Doing nothing with end cursor since it will do full reseek on restore.
             }
 
             void saveUnpositioned() override {
                 _txn = nullptr;
-                _savedAtEnd = true;
-                // Doing nothing with end cursor since it will do full reseek on restore.
+                _isEOF = true;
             }
 
             void restore(OperationContext* txn) override {
+                // Entries inserted since we saved are linked in around our node, so new entries
+                // between here and the end point are seen without seeking again.
                 _txn = txn;
-
-                // Always do a full seek on restore. We cannot use our last position since index
-                // entries may have been inserted closer to our endpoint and we would need to move
-                // over them.
-                seekEndCursor();
-
-                if (_savedAtEnd) {
-                    _isEOF = true;
-                    return;
-                }
-                
-                // Need to find our position from the root.
-                locate(_savedKey, _savedLoc);
-
-                _lastMoveWasRestore = _isEOF // We weren't EOF but now are.
-                                   || _data.value_comp().compare(*_it, {_savedKey, _savedLoc}) != 0;
             }
 
         private:
-            bool atEndPoint() const {
-                return _endState && _it == _endState->it;
-            }
-
-            // Advances once in the direction of the scan, updating _isEOF as needed.
-            // Does nothing if already _isEOF.
-            void advance() {
-                if (_isEOF) return;
-                if (_forward) {
-                    if (_it != _data.end()) ++_it;
-                    if (_it == _data.end() || atEndPoint()) _isEOF = true;
-                }
-                else {
-                    if (_it == _data.begin() || _data.empty()) {
-                        _isEOF = true;
+            // Moves to the next entry in the direction of the scan which exists in 'snapshot',
+            // or to EOF.
+            void advance(const InMemorySnapshot& snapshot) {
+                do {
+                    if (_forward) {
+                        _node = _node ? _node->next() : _data.first();
                     }
                     else {
-                        --_it;
+                        _node = _node ? _data.lessThan(_node->key) : _data.last();
                     }
-                    if (atEndPoint()) _isEOF = true;
-                }
+                } while (_node && !atOrPastEndPoint() && !_node->value.read(snapshot));
+
+                if (!_node || atOrPastEndPoint()) _isEOF = true;
             }
 
-            bool atOrPastEndPointAfterSeeking() const {
-                if (_isEOF) return true;
+            bool atOrPastEndPoint() const {
                 if (!_endState) return false;
-               
-                const int cmp = _data.value_comp().compare(*_it, _endState->query);
 
-                // We set up _endState->query to be in between the last in-range value and the first
+                const int cmp = _data.less().compare(_node->key, *_endState);
+
+                // We set up _endState to be in between the last in-range value and the first
                 // out-of-range value. In particular, it is constructed to never equal any legal
                 // index key.
                 dassert(cmp != 0);
@@ -370,78 +387,44 @@ namespace {
             }
 
             void locate(const BSONObj& key, const RecordId& loc) {
+                const IndexKeyEntry query(key, loc);
+                const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(_txn);
                 _isEOF = false;
-                const auto query = IndexKeyEntry(key, loc);
-                _it = _data.lower_bound(query);
+
+                // Position on the last entry before the query in the direction of the scan, or on
+                // nothing to start from the beginning, and move onto the first visible entry.
                 if (_forward) {
-                    if (_it == _data.end()) _isEOF = true;
+                    _node = _data.lessThan(query);
                 }
                 else {
-                    // lower_bound lands us on or after query. Reverse cursors must be on or before.
-                    if (_it == _data.end() || _data.value_comp().compare(*_it, query) > 0)
-                        advance(); // sets _isEOF if there is nothing more to return.
+                    // The query never equals an entry as its RecordId is min or max.
+                    _node = _data.lowerBound(query);
                 }
-
-                if (atOrPastEndPointAfterSeeking()) _isEOF = true;
+                advance(snapshot);
             }
 
             // Returns comparison relative to direction of scan. If rhs would be seen later, returns
             // a positive value.
             int compareKeys(const BSONObj& lhs, const BSONObj& rhs) const {
-                int cmp = _data.value_comp().compare({lhs, RecordId()}, {rhs, RecordId()});
+                int cmp = _data.less().compare({lhs, RecordId()}, {rhs, RecordId()});
                 return _forward ? cmp : -cmp;
             }
 
-            void seekEndCursor() {
-                if (!_endState || _data.empty()) return;
-
-                auto it = _data.lower_bound(_endState->query);
-                if (!_forward) {
-                    // lower_bound lands us on or after query. Reverse cursors must be on or before.
-                    if (it == _data.end() || _data.value_comp().compare(*it,
-                                                                        _endState->query) > 0) {
-                        if (it == _data.begin()) {
-                            it = _data.end(); // all existing data in range.
-                        }
-                        else {
-                            --it;
-                        }
-                    }
-                }
-
-                if (it != _data.end()) dassert(compareKeys(it->key, _endState->query.key) >= 0);
-                _endState->it = it;
-            }
-
             OperationContext* _txn; // not owned
-            const IndexSet& _data;
+            const IndexEntries& _data;
             const bool _forward;
-            bool _isEOF = true;
-            IndexSet::const_iterator _it;
-            
-            struct EndState {
-                EndState(BSONObj key, RecordId loc) : query(std::move(key), loc) {}
-
-                IndexKeyEntry query;
-                IndexSet::const_iterator it;
-            };
-            boost::optional<EndState> _endState;
-
-            // Used by next to decide to return current position rather than moving. Should be reset
-            // to false by any operation that moves the cursor, other than subsequent save/restore
-            // pairs.
-            bool _lastMoveWasRestore = false;
-
-            // For save/restore since _it may be invalidated during a yield.
-            bool _savedAtEnd = false;
-            BSONObj _savedKey;
-            RecordId _savedLoc;
+
+            // The entry last returned, or for a new cursor NULL, meaning before the first entry.
+            const IndexEntries::Node* _node = nullptr;
+            bool _isEOF = false;
+
+            boost::optional<IndexKeyEntry> _endState;
         };
 
         virtual std::unique_ptr<SortedDataInterface::Cursor> newCursor(
                 OperationContext* txn,
                 bool isForward) const {
-            return stdx::make_unique<Cursor>(txn, *_data, isForward);
+            return stdx::make_unique<Cursor>(txn, _data->entries, isForward);
         }
 
         virtual Status initAsEmpty(OperationContext* txn) {
@@ -450,28 +433,12 @@ namespace {
         }
 
     private:
-        class IndexChange : public RecoveryUnit::Change {
-        public:
-            IndexChange(IndexSet* data, const IndexKeyEntry& entry, bool insert)
-                : _data(data), _entry(entry), _insert(insert)
-            {}
-
-            virtual void commit() {}
-            virtual void rollback() {
-                if (_insert)
-                    _data->erase(_entry);
-                else
-                    _data->insert(_entry);
-            }
-
-        private:
-            IndexSet* _data;
-            const IndexKeyEntry _entry;
-            const bool _insert;
-        };
+        void changeKeySize(OperationContext* txn, int64_t keySize) {
+            _data->keySize.fetchAndAdd(keySize);
+            txn->recoveryUnit()->registerChange(new KeySizeChange(_data, keySize));
+        }
 
-        IndexSet* _data;
-        long long _currentKeySize;
+        IndexData* _data;
     };
 } // namespace
 
@@ -481,9 +448,9 @@ namespace {
                                               std::shared_ptr<void>* dataInOut) {
         invariant(dataInOut);
         if (!*dataInOut) {
-            *dataInOut = std::make_shared<IndexSet>(IndexEntryComparison(ordering));
+            *dataInOut = std::make_shared<IndexData>(ordering);
         }
-        return new InMemoryBtreeImpl(static_cast<IndexSet*>(dataInOut->get()));
+        return new InMemoryBtreeImpl(static_cast<IndexData*>(dataInOut->get()));
     }
 
 }  // namespace mongo
@@ -52,6 +52,8 @@ namespace mongo {
             return stdx::make_unique<InMemoryRecoveryUnit>();
         }
 
+        bool supportsDocLocking() const final { return true; }
+
     private:
         std::shared_ptr<void> _data; // used by InMemoryBtreeImpl
         Ordering _order;
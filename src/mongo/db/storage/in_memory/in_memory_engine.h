@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
 
 #include "mongo/db/storage/kv/kv_engine.h"
@@ -62,7 +63,7 @@ namespace mongo {
         virtual Status dropIdent( OperationContext* opCtx,
                                   StringData ident );
 
-        virtual bool supportsDocLocking() const { return false; }
+        virtual bool supportsDocLocking() const { return true; }
 
         virtual bool supportsDirectoryPerDB() const { return false; }
 
@@ -82,7 +83,8 @@ namespace mongo {
         virtual void cleanShutdown() {};
 
         virtual bool hasIdent(OperationContext* opCtx, StringData ident) const {
-            return _dataMap.find(ident) != _dataMap.end();;
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            return _dataMap.find(ident) != _dataMap.end();
         }
 
         std::vector<std::string> getAllIdents( OperationContext* opCtx ) const;
@@ -47,6 +47,8 @@ namespace mongo {
                 KVStorageEngineOptions options;
                 options.directoryPerDB = params.directoryperdb;
                 options.forRepair = params.repair;
+                options.startupThreads = params.startupThreads;
+                options.lazyOpen = params.lazyOpen;
                 return new KVStorageEngine(new InMemoryEngine(), options);
             }
 
@@ -33,10 +33,13 @@
 
 #include "mongo/db/storage/in_memory/in_memory_record_store.h"
 
+#include <algorithm>
 
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/recovery_unit.h"
 #include "mongo/stdx/memory.h"
@@ -48,211 +51,164 @@ namespace mongo {
 
     using std::shared_ptr;
 
-    class InMemoryRecordStore::InsertChange : public RecoveryUnit::Change {
+    class InMemoryRecordStore::CountChange : public RecoveryUnit::Change {
     public:
-        InsertChange(Data* data, RecordId loc) :_data(data), _loc(loc) {}
+        CountChange(Data* data, int64_t numRecords, int64_t dataSize)
+            : _data(data), _numRecords(numRecords), _dataSize(dataSize) {}
+
         virtual void commit() {}
         virtual void rollback() {
-            Records::iterator it = _data->records.find(_loc);
-            if (it != _data->records.end()) {
-                _data->dataSize -= it->second.size;
-                _data->records.erase(it);
-            }
+            _data->numRecords.fetchAndSubtract(_numRecords);
+            _data->dataSize.fetchAndSubtract(_dataSize);
         }
 
     private:
         Data* const _data;
-        const RecordId _loc;
+        const int64_t _numRecords;
+        const int64_t _dataSize;
     };
 
-    // Works for both removes and updates
-    class InMemoryRecordStore::RemoveChange : public RecoveryUnit::Change {
+    class InMemoryRecordStore::UncommittedIdChange : public RecoveryUnit::Change {
     public:
-        RemoveChange(Data* data, RecordId loc, const InMemoryRecord& rec)
-            :_data(data), _loc(loc), _rec(rec)
-        {}
-
-        virtual void commit() {}
-        virtual void rollback() {
-            Records::iterator it = _data->records.find(_loc);
-            if (it != _data->records.end()) {
-                _data->dataSize -= it->second.size;
-            }
+        UncommittedIdChange(Data* data, RecordId loc) : _data(data), _loc(loc) {}
 
-            _data->dataSize += _rec.size;
-            _data->records[_loc] = _rec;
-        }
+        virtual void commit() { done(); }
+        virtual void rollback() { done(); }
 
     private:
-        Data* const _data;
-        const RecordId _loc;
-        const InMemoryRecord _rec;
-    };
-
-    class InMemoryRecordStore::TruncateChange : public RecoveryUnit::Change {
-    public:
-        TruncateChange(Data* data) : _data(data), _dataSize(0) {
-            using std::swap;
-            swap(_dataSize, _data->dataSize);
-            swap(_records, _data->records);
+        void done() {
+            boost::lock_guard<boost::mutex> lk(_data->uncommittedIdsMutex);
+            auto it = std::find(_data->uncommittedIds.begin(), _data->uncommittedIds.end(), _loc);
+            invariant(it != _data->uncommittedIds.end());
+            _data->uncommittedIds.erase(it);
         }
 
-        virtual void commit() {}
-        virtual void rollback() {
-            using std::swap;
-            swap(_dataSize, _data->dataSize);
-            swap(_records, _data->records);
-        }
-
-    private:
         Data* const _data;
-        int64_t _dataSize;
-        Records _records;
+        const RecordId _loc;
     };
 
     class InMemoryRecordStore::Cursor final : public RecordCursor {
     public:
         Cursor(OperationContext* txn, const InMemoryRecordStore& rs)
                 : _txn(txn)
+                , _rs(rs)
                 , _records(rs._data->records)
-                , _isCapped(rs.isCapped())
         {}
 
         boost::optional<Record> next() final {
-            if (_needFirstSeek) {
-                _needFirstSeek = false;
-                _it = _records.begin();
-            }
-            else if (!_lastMoveWasRestore && _it != _records.end()) {
-                ++_it;
+            if (_eof) return {};
+
+            const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(_txn);
+            Records::Node* node = _node ? _node->next() : _records.first();
+            for (RecordData data; node; node = node->next()) {
+                if (_rs._isCapped && _rs.isCappedHidden(node->key)) break;
+
+                if (node->value.read(snapshot, &data)) {
+                    _node = node;
+                    return {{node->key, data}};
+                }
+
+                // A capped collection's records become visible in order. Rather than skip one
+                // which was committed after our snapshot, stop so that a later scan picks it up.
+                if (_rs._isCapped && node->value.changedSince(snapshot)) break;
             }
-            _lastMoveWasRestore = false;
 
-            if (_it == _records.end()) return {};
-            return {{_it->first, _it->second.toRecordData()}};
+            // Stay on the last record returned, which is where tailing scans continue from.
+            _eof = true;
+            return {};
         }
 
         boost::optional<Record> seekExact(const RecordId& id) final {
-            _lastMoveWasRestore = false;
-            _needFirstSeek = false;
-            _it = _records.find(id);
-            if (_it == _records.end()) return {};
-            return {{_it->first, _it->second.toRecordData()}};
+            _node = _records.find(id);
+            RecordData data;
+            _eof = !_node || !_node->value.read(InMemoryRecoveryUnit::getSnapshot(_txn), &data);
+            if (_eof) return {};
+            return {{id, data}};
         }
 
         void savePositioned() final {
             _txn = nullptr;
-            if (!_needFirstSeek && !_lastMoveWasRestore)
-                _savedId = _it == _records.end() ? RecordId() : _it->first;
         }
 
         void saveUnpositioned() final {
             _txn = nullptr;
-            _savedId = RecordId();
+            _eof = true;
         }
 
         bool restore(OperationContext* txn) final {
             _txn = txn;
-            if (_savedId.isNull()) {
-                _it = _records.end();
-                return true;
-            }
+            if (_eof || !_node) return true;
 
-            _it = _records.lower_bound(_savedId);
-            _lastMoveWasRestore = _it == _records.end() || _it->first != _savedId;
-
-            // Capped iterators die on invalidation rather than advancing.
-            return !(_isCapped && _lastMoveWasRestore);
+            // Nodes are never removed, so we keep our place even if our record was deleted. Capped
+            // iterators die on invalidation rather than advancing.
+            return !_rs._isCapped
+                || _node->value.read(InMemoryRecoveryUnit::getSnapshot(_txn));
         }
 
     private:
         unowned_ptr<OperationContext> _txn;
-        Records::const_iterator _it;
-        bool _needFirstSeek = true;
-        bool _lastMoveWasRestore = false;
-        RecordId _savedId; // Location to restore() to. Null means EOF.
-
-        const InMemoryRecordStore::Records& _records;
-        const bool _isCapped;
+        const InMemoryRecordStore& _rs;
+        const Records& _records;
+        Records::Node* _node = nullptr; // The last record returned.
+        bool _eof = false;
     };
 
     class InMemoryRecordStore::ReverseCursor final : public RecordCursor {
     public:
         ReverseCursor(OperationContext* txn, const InMemoryRecordStore& rs)
                 : _txn(txn)
+                , _rs(rs)
                 , _records(rs._data->records)
-                , _isCapped(rs.isCapped())
         {}
 
         boost::optional<Record> next() final {
-            if (_needFirstSeek) {
-                _needFirstSeek = false;
-                _it = _records.rbegin();
-            }
-            else if (!_lastMoveWasRestore && _it != _records.rend()) {
-                ++_it;
+            if (_eof) return {};
+
+            const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(_txn);
+            Records::Node* node = _node ? _records.lessThan(_node->key) : _records.last();
+            for (RecordData data; node; node = _records.lessThan(node->key)) {
+                if (node->value.read(snapshot, &data)) {
+                    _node = node;
+                    return {{node->key, data}};
+                }
             }
-            _lastMoveWasRestore = false;
 
-            if (_it == _records.rend()) return {};
-            return {{_it->first, _it->second.toRecordData()}};
+            _eof = true;
+            return {};
         }
 
         boost::optional<Record> seekExact(const RecordId& id) final {
-            _lastMoveWasRestore = false;
-            _needFirstSeek = false;
-
-            auto forwardIt = _records.find(id);
-            if (forwardIt == _records.end()) {
-                _it = _records.rend();
-                return {};
-            }
-
-            // The reverse_iterator will point to the preceding element, so increment the base
-            // iterator to make it point past the found element.
-            ++forwardIt;
-            _it = Records::const_reverse_iterator(forwardIt);
-            dassert(_it != _records.rend());
-            dassert(_it->first == id);
-            return {{_it->first, _it->second.toRecordData()}};
+            _node = _records.find(id);
+            RecordData data;
+            _eof = !_node || !_node->value.read(InMemoryRecoveryUnit::getSnapshot(_txn), &data);
+            if (_eof) return {};
+            return {{id, data}};
         }
 
         void savePositioned() final {
             _txn = nullptr;
-            if (!_needFirstSeek && !_lastMoveWasRestore)
-                _savedId = _it == _records.rend() ? RecordId() : _it->first;
         }
 
         void saveUnpositioned() final {
             _txn = nullptr;
-            _savedId = RecordId();
+            _eof = true;
         }
 
         bool restore(OperationContext* txn) final {
             _txn = txn;
-            if (_savedId.isNull()) {
-                _it = _records.rend();
-                return true;
-            }
-
-            // Note: upper_bound returns the first entry > _savedId and reverse_iterators
-            // dereference to the element before their base iterator. This combine to make this
-            // dereference to the first element <= _savedId which is what we want here.
-            _it = Records::const_reverse_iterator(_records.upper_bound(_savedId));
-            _lastMoveWasRestore = _it == _records.rend() || _it->first != _savedId;
+            if (_eof || !_node) return true;
 
             // Capped iterators die on invalidation rather than advancing.
-            return !(_isCapped && _lastMoveWasRestore);
+            return !_rs._isCapped
+                || _node->value.read(InMemoryRecoveryUnit::getSnapshot(_txn));
         }
 
     private:
         unowned_ptr<OperationContext> _txn;
-        Records::const_reverse_iterator _it;
-        bool _needFirstSeek = true;
-        bool _lastMoveWasRestore = false;
-        RecordId _savedId; // Location to restore() to. Null means EOF.
-        const InMemoryRecordStore::Records& _records;
-        const bool _isCapped;
+        const InMemoryRecordStore& _rs;
+        const Records& _records;
+        Records::Node* _node = nullptr; // The last record returned.
+        bool _eof = false;
     };
 
 
@@ -290,52 +246,45 @@ namespace mongo {
     const char* InMemoryRecordStore::name() const { return "InMemory"; }
 
     RecordData InMemoryRecordStore::dataFor( OperationContext* txn, const RecordId& loc ) const {
-        return recordFor(loc)->toRecordData();
+        return recordFor(txn, loc);
     }
 
-    const InMemoryRecordStore::InMemoryRecord* InMemoryRecordStore::recordFor(
-            const RecordId& loc) const {
-        Records::const_iterator it = _data->records.find(loc);
-        if ( it == _data->records.end() ) {
+    RecordData InMemoryRecordStore::recordFor(OperationContext* txn, const RecordId& loc) const {
+        RecordData data;
+        const Records::Node* node = _data->records.find(loc);
+        if (!node || !node->value.read(InMemoryRecoveryUnit::getSnapshot(txn), &data)) {
             error() << "InMemoryRecordStore::recordFor cannot find record for " << ns()
                     << ":" << loc;
+            invariant(false);
         }
-        invariant(it != _data->records.end());
-        return &it->second;
-    }
-
-    InMemoryRecordStore::InMemoryRecord* InMemoryRecordStore::recordFor(const RecordId& loc) {
-        Records::iterator it = _data->records.find(loc);
-        if ( it == _data->records.end() ) {
-            error() << "InMemoryRecordStore::recordFor cannot find record for " << ns()
-                    << ":" << loc;
-        }
-        invariant(it != _data->records.end());
-        return &it->second;
+        return data;
     }
 
     bool InMemoryRecordStore::findRecord( OperationContext* txn,
                                           const RecordId& loc, RecordData* rd ) const {
-        Records::const_iterator it = _data->records.find(loc);
-        if ( it == _data->records.end() ) {
-            return false;
-        }
-        *rd = it->second.toRecordData();
-        return true;
+        const Records::Node* node = _data->records.find(loc);
+        return node && node->value.read(InMemoryRecoveryUnit::getSnapshot(txn), rd);
     }
 
     void InMemoryRecordStore::deleteRecord(OperationContext* txn, const RecordId& loc) {
-        InMemoryRecord* rec = recordFor(loc);
-        txn->recoveryUnit()->registerChange(new RemoveChange(_data, loc, *rec));
-        _data->dataSize -= rec->size;
-        invariant(_data->records.erase(loc) == 1);
+        const RecordData rec = recordFor(txn, loc);
+        InMemoryRecoveryUnit::write(txn, &_data->records.find(loc)->value, false);
+        changeCounts(txn, -1, -rec.size());
+    }
+
+    void InMemoryRecordStore::changeCounts(OperationContext* txn,
+                                           int64_t numRecords,
+                                           int64_t dataSize) {
+        _data->numRecords.fetchAndAdd(numRecords);
+        _data->dataSize.fetchAndAdd(dataSize);
+        txn->recoveryUnit()->registerChange(new CountChange(_data, numRecords, dataSize));
     }
 
     bool InMemoryRecordStore::cappedAndNeedDelete(OperationContext* txn) const {
         if (!_isCapped)
             return false;
 
-        if (_data->dataSize > _cappedMaxSize)
+        if (dataSize(txn) > _cappedMaxSize)
             return true;
 
         if ((_cappedMaxDocs != -1) && (numRecords(txn) > _cappedMaxDocs))
@@ -345,94 +294,162 @@ namespace mongo {
     }
 
     void InMemoryRecordStore::cappedDeleteAsNeeded(OperationContext* txn) {
-        while (cappedAndNeedDelete(txn)) {
-            invariant(!_data->records.empty());
+        if (!cappedAndNeedDelete(txn))
+            return;
+
+        // If another operation is already deleting it will take care of our overflow as well.
+        boost::unique_lock<boost::mutex> lk(_data->cappedDeleterMutex, boost::try_to_lock);
+        if (!lk.owns_lock())
+            return;
+
+        if (!dynamic_cast<InMemoryRecoveryUnit*>(txn->recoveryUnit())) {
+            cappedDeleteAsNeeded_inlock(txn);
+            return;
+        }
+
+        // We delete in a side transaction, as WiredTiger does, so that concurrent inserters do not
+        // all conflict on the oldest records and a failed insert still makes room.
+        RecoveryUnit* realRecoveryUnit = txn->releaseRecoveryUnit();
+        OperationContext::RecoveryUnitState const realRUstate =
+            txn->setRecoveryUnit(new InMemoryRecoveryUnit(), OperationContext::kNotInUnitOfWork);
+
+        try {
+            WriteUnitOfWork wuow(txn);
+            Records::Node* lastDeleted = cappedDeleteAsNeeded_inlock(txn);
+            wuow.commit();
+
+            if (lastDeleted) {
+                _data->cappedDeletedUpTo = lastDeleted;
+                _data->cappedDeletedTimestamp = InMemoryRecoveryUnit::getLastCommitTimestamp();
+            }
+        }
+        catch (const WriteConflictException& wce) {
+            LOG(1) << "got conflict deleting from capped collection " << ns() << ", ignoring";
+        }
+        catch (...) {
+            delete txn->releaseRecoveryUnit();
+            txn->setRecoveryUnit(realRecoveryUnit, realRUstate);
+            throw;
+        }
+
+        delete txn->releaseRecoveryUnit();
+        txn->setRecoveryUnit(realRecoveryUnit, realRUstate);
+    }
+
+    InMemoryRecordStore::Records::Node* InMemoryRecordStore::cappedDeleteAsNeeded_inlock(
+            OperationContext* txn) {
+        const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(txn);
+
+        // Skip the records earlier deletes removed for good, rather than walk over their nodes.
+        Records::Node* node = _data->records.first();
+        if (_data->cappedDeletedUpTo && snapshot.readTimestamp >= _data->cappedDeletedTimestamp)
+            node = _data->cappedDeletedUpTo->next();
 
-            Records::iterator oldest = _data->records.begin();
-            RecordId id = oldest->first;
-            RecordData data = oldest->second.toRecordData();
+        Records::Node* lastDeleted = nullptr;
+        RecordData data;
+        while (cappedAndNeedDelete(txn)) {
+            while (node && !node->value.read(snapshot, &data)) {
+                node = node->next();
+            }
+            if (!node)
+                break;
 
+            const RecordId id = node->key;
             if (_cappedDeleteCallback)
                 uassertStatusOK(_cappedDeleteCallback->aboutToDeleteCapped(txn, id, data));
 
             deleteRecord(txn, id);
+            lastDeleted = node;
+            node = node->next();
         }
+        return lastDeleted;
     }
 
     StatusWith<RecordId> InMemoryRecordStore::extractAndCheckLocForOplog(const char* data,
                                                                         int len) const {
-        StatusWith<RecordId> status = oploghack::extractKey(data, len);
-        if (!status.isOK())
-            return status;
+        return oploghack::extractKey(data, len);
+    }
+
+    void InMemoryRecordStore::addUncommittedId_inlock(OperationContext* txn,
+                                                      const RecordId& loc) {
+        invariant(_data->uncommittedIds.empty() || _data->uncommittedIds.back() < loc);
+        _data->uncommittedIds.push_back(loc);
+        txn->recoveryUnit()->registerChange(new UncommittedIdChange(_data, loc));
+        _data->highestSeen = loc;
+    }
+
+    bool InMemoryRecordStore::isCappedHidden(const RecordId& loc) const {
+        boost::lock_guard<boost::mutex> lk(_data->uncommittedIdsMutex);
+        return !_data->uncommittedIds.empty() && _data->uncommittedIds.front() <= loc;
+    }
 
-        if (!_data->records.empty() && status.getValue() <= _data->records.rbegin()->first)
-            return StatusWith<RecordId>(ErrorCodes::BadValue, "ts not higher than highest");
+    Status InMemoryRecordStore::oplogDiskLocRegister(OperationContext* txn,
+                                                     const Timestamp& opTime) {
+        StatusWith<RecordId> loc = oploghack::keyForOptime(opTime);
+        if (!loc.isOK())
+            return loc.getStatus();
 
-        return status;
+        boost::lock_guard<boost::mutex> lk(_data->uncommittedIdsMutex);
+        addUncommittedId_inlock(txn, loc.getValue());
+        return Status::OK();
     }
 
     StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
                                                           const char* data,
                                                           int len,
                                                           bool enforceQuota) {
-        if (_isCapped && len > _cappedMaxSize) {
-            // We use dataSize for capped rollover and we don't want to delete everything if we know
-            // this won't fit.
-            return StatusWith<RecordId>(ErrorCodes::BadValue,
-                                       "object to insert exceeds cappedMaxSize");
-        }
-
-        InMemoryRecord rec(len);
-        memcpy(rec.data.get(), data, len);
-
-        RecordId loc;
-        if (_data->isOplog) {
-            StatusWith<RecordId> status = extractAndCheckLocForOplog(data, len);
-            if (!status.isOK())
-                return status;
-            loc = status.getValue();
-        }
-        else {
-            loc = allocateLoc();
-        }
-
-        txn->recoveryUnit()->registerChange(new InsertChange(_data, loc));
-        _data->dataSize += len;
-        _data->records[loc] = rec;
-
-        cappedDeleteAsNeeded(txn);
-
-        return StatusWith<RecordId>(loc);
+        SharedBuffer buffer = SharedBuffer::allocate(len);
+        memcpy(buffer.get(), data, len);
+        return insertRecord(txn, RecordData(buffer, len));
     }
 
     StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
                                                           const DocWriter* doc,
                                                           bool enforceQuota) {
         const int len = doc->documentSize();
-        if (_isCapped && len > _cappedMaxSize) {
+        SharedBuffer buffer = SharedBuffer::allocate(len);
+        doc->writeDocument(buffer.get());
+        return insertRecord(txn, RecordData(buffer, len));
+    }
+
+    StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
+                                                          const RecordData& rec) {
+        if (_isCapped && rec.size() > _cappedMaxSize) {
             // We use dataSize for capped rollover and we don't want to delete everything if we know
             // this won't fit.
             return StatusWith<RecordId>(ErrorCodes::BadValue,
                                        "object to insert exceeds cappedMaxSize");
         }
 
-        InMemoryRecord rec(len);
-        doc->writeDocument(rec.data.get());
-
         RecordId loc;
         if (_data->isOplog) {
-            StatusWith<RecordId> status = extractAndCheckLocForOplog(rec.data.get(), len);
+            StatusWith<RecordId> status = extractAndCheckLocForOplog(rec.data(), rec.size());
             if (!status.isOK())
                 return status;
             loc = status.getValue();
+
+            // Entries are normally registered by oplogDiskLocRegister() before being inserted,
+            // possibly out of order.
+            boost::lock_guard<boost::mutex> lk(_data->uncommittedIdsMutex);
+            const std::deque<RecordId>& uncommitted = _data->uncommittedIds;
+            if (std::find(uncommitted.begin(), uncommitted.end(), loc) == uncommitted.end()) {
+                if (loc <= _data->highestSeen)
+                    return StatusWith<RecordId>(ErrorCodes::BadValue,
+                                                "ts not higher than highest");
+                addUncommittedId_inlock(txn, loc);
+            }
+        }
+        else if (_isCapped) {
+            boost::lock_guard<boost::mutex> lk(_data->uncommittedIdsMutex);
+            loc = allocateLoc();
+            addUncommittedId_inlock(txn, loc);
         }
         else {
             loc = allocateLoc();
         }
 
-        txn->recoveryUnit()->registerChange(new InsertChange(_data, loc));
-        _data->dataSize += len;
-        _data->records[loc] = rec;
+        InMemoryRecoveryUnit::write(txn, &_data->records.insert(loc)->value, true, rec);
+        changeCounts(txn, 1, rec.size());
 
         cappedDeleteAsNeeded(txn);
 
@@ -445,8 +462,7 @@ namespace mongo {
                                                           int len,
                                                           bool enforceQuota,
                                                           UpdateNotifier* notifier ) {
-        InMemoryRecord* oldRecord = recordFor( loc );
-        int oldLen = oldRecord->size;
+        const int oldLen = recordFor(txn, loc).size();
 
         if (_isCapped && len > oldLen) {
             return StatusWith<RecordId>( ErrorCodes::InternalError,
@@ -454,21 +470,15 @@ namespace mongo {
                                         10003 );
         }
 
-        if (notifier) {
-            // The in-memory KV engine uses the invalidation framework (does not support
-            // doc-locking), and therefore must notify that it is updating a document.
-            Status callbackStatus = notifier->recordStoreGoingToUpdateInPlace(txn, loc);
-            if (!callbackStatus.isOK()) {
-                return StatusWith<RecordId>(callbackStatus);
-            }
-        }
+        // The notifier is not called: with document-level locking there is no invalidation of
+        // other operations' positions, which see the old version in their snapshots.
 
-        InMemoryRecord newRecord(len);
-        memcpy(newRecord.data.get(), data, len);
+        SharedBuffer buffer = SharedBuffer::allocate(len);
+        memcpy(buffer.get(), data, len);
 
-        txn->recoveryUnit()->registerChange(new RemoveChange(_data, loc, *oldRecord));
-        _data->dataSize += len - oldLen;
-        *oldRecord = newRecord;
+        InMemoryRecoveryUnit::write(txn, &_data->records.find(loc)->value, true,
+                                    RecordData(buffer, len));
+        changeCounts(txn, 0, len - oldLen);
 
         cappedDeleteAsNeeded(txn);
 
@@ -476,44 +486,31 @@ namespace mongo {
     }
 
     bool InMemoryRecordStore::updateWithDamagesSupported() const {
-        // TODO: Currently the UpdateStage assumes that updateWithDamages will apply the
-        // damages directly to the unowned BSONObj containing the record to be modified.
-        // The implementation of updateWithDamages() below copies the old record to a
-        // a new one and then applies the damages.
-        //
-        // We should be able to enable updateWithDamages() here once this assumption is
-        // relaxed.
-        return false;
+        return true;
     }
 
-    Status InMemoryRecordStore::updateWithDamages( OperationContext* txn,
-                                                   const RecordId& loc,
-                                                   const RecordData& oldRec,
-                                                   const char* damageSource,
-                                                   const mutablebson::DamageVector& damages ) {
-        InMemoryRecord* oldRecord = recordFor( loc );
-        const int len = oldRecord->size;
-
-        InMemoryRecord newRecord(len);
-        memcpy(newRecord.data.get(), oldRecord->data.get(), len);
-
-        txn->recoveryUnit()->registerChange(new RemoveChange(_data, loc, *oldRecord));
-        *oldRecord = newRecord;
-
-        cappedDeleteAsNeeded(txn);
-
-        char* root = newRecord.data.get();
-        mutablebson::DamageVector::const_iterator where = damages.begin();
-        const mutablebson::DamageVector::const_iterator end = damages.end();
-        for( ; where != end; ++where ) {
-            const char* sourcePtr = damageSource + where->sourceOffset;
-            char* targetPtr = root + where->targetOffset;
-            std::memcpy(targetPtr, sourcePtr, where->size);
-        }
-
-        *oldRecord = newRecord;
-
-        return Status::OK();
+    StatusWith<RecordData> InMemoryRecordStore::updateWithDamages(
+            OperationContext* txn,
+            const RecordId& loc,
+            const RecordData& oldRec,
+            const char* damageSource,
+            const mutablebson::DamageVector& damages ) {
+        const RecordData oldRecord = recordFor(txn, loc);
+        const int len = mutablebson::sizeAfterDamages(oldRecord.size(), damages);
+
+        // Versions are never changed once written, so the damages are applied to a copy. The
+        // returned record shares ownership of it.
+        SharedBuffer buffer = SharedBuffer::allocate(len);
+        mutablebson::applyDamages(oldRecord.data(), oldRecord.size(), damageSource, damages,
+                                  buffer.get());
+
+        const RecordData newRecord(buffer, len);
+        InMemoryRecoveryUnit::write(txn, &_data->records.find(loc)->value, true, newRecord);
+        if (len != oldRecord.size()) {
+            changeCounts(txn, 0, len - oldRecord.size());
+        }
+
+        return StatusWith<RecordData>(newRecord);
     }
 
     std::unique_ptr<RecordCursor> InMemoryRecordStore::getCursor(OperationContext* txn,
@@ -524,22 +521,41 @@ namespace mongo {
     }
 
     Status InMemoryRecordStore::truncate(OperationContext* txn) {
-        // Unlike other changes, TruncateChange mutates _data on construction to perform the
-        // truncate
-        txn->recoveryUnit()->registerChange(new TruncateChange(_data));
+        const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(txn);
+        RecordData data;
+        for (Records::Node* node = _data->records.first(); node; node = node->next()) {
+            if (node->value.read(snapshot, &data)) {
+                InMemoryRecoveryUnit::write(txn, &node->value, false);
+                changeCounts(txn, -1, -data.size());
+            }
+        }
+
+        if (_isCapped) {
+            boost::lock_guard<boost::mutex> lk(_data->uncommittedIdsMutex);
+            _data->highestSeen = RecordId();
+        }
         return Status::OK();
     }
 
     void InMemoryRecordStore::temp_cappedTruncateAfter(OperationContext* txn,
                                                        RecordId end,
                                                        bool inclusive) {
-        Records::iterator it = inclusive ? _data->records.lower_bound(end)
-                                         : _data->records.upper_bound(end);
-        while(it != _data->records.end()) {
-            txn->recoveryUnit()->registerChange(new RemoveChange(_data, it->first, it->second));
-            _data->dataSize -= it->second.size;
-            _data->records.erase(it++);
+        const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(txn);
+        Records::Node* node = _data->records.lowerBound(end);
+        if (node && !inclusive && node->key == end)
+            node = node->next();
+
+        RecordData data;
+        for (; node; node = node->next()) {
+            if (node->value.read(snapshot, &data)) {
+                InMemoryRecoveryUnit::write(txn, &node->value, false);
+                changeCounts(txn, -1, -data.size());
+            }
         }
+
+        // Entries after the new end of the oplog may be written again.
+        boost::lock_guard<boost::mutex> lk(_data->uncommittedIdsMutex);
+        _data->highestSeen = inclusive ? RecordId(end.repr() - 1) : end;
     }
 
     Status InMemoryRecordStore::validate(OperationContext* txn,
@@ -548,13 +564,18 @@ namespace mongo {
                                          ValidateAdaptor* adaptor,
                                          ValidateResults* results,
                                          BSONObjBuilder* output) {
+        const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(txn);
+        long long nrecords = 0;
         results->valid = true;
-        if (scanData && full) {
-            for (Records::const_iterator it = _data->records.begin();
-                        it != _data->records.end(); ++it) {
-                const InMemoryRecord& rec = it->second;
+        RecordData data;
+        for (Records::Node* node = _data->records.first(); node; node = node->next()) {
+            if (!node->value.read(snapshot, &data))
+                continue;
+
+            nrecords++;
+            if (scanData && full) {
                 size_t dataSize;
-                const Status status = adaptor->validate(rec.toRecordData(), &dataSize);
+                const Status status = adaptor->validate(data, &dataSize);
                 if (!status.isOK()) {
                     results->valid = false;
                     results->errors.push_back("invalid object detected (see logs)");
@@ -563,7 +584,7 @@ namespace mongo {
             }
         }
 
-        output->appendNumber( "nrecords", _data->records.size() );
+        output->appendNumber( "nrecords", nrecords );
 
         return Status::OK();
 
@@ -597,12 +618,12 @@ namespace mongo {
                                              BSONObjBuilder* extraInfo,
                                              int infoLevel) const {
         // Note: not making use of extraInfo or infoLevel since we don't have extents
-        const int64_t recordOverhead = numRecords(txn) * sizeof(InMemoryRecord);
-        return _data->dataSize + recordOverhead;
+        const int64_t recordOverhead = numRecords(txn) * sizeof(Records::Node);
+        return dataSize(txn) + recordOverhead;
     }
 
     RecordId InMemoryRecordStore::allocateLoc() {
-        RecordId out = RecordId(_data->nextId++);
+        RecordId out = RecordId(_data->nextId.fetchAndAdd(1));
         invariant(out < RecordId::max());
         return out;
     }
@@ -614,16 +635,15 @@ namespace mongo {
         if (!_data->isOplog)
             return boost::none;
 
+        const InMemorySnapshot snapshot = InMemoryRecoveryUnit::getSnapshot(txn);
         const Records& records = _data->records;
 
-        if (records.empty())
-            return RecordId();
-
-        Records::const_iterator it = records.lower_bound(startingPosition);
-        if (it == records.end() || it->first > startingPosition)
-            --it;
+        const Records::Node* node = records.lessThanOrEqual(startingPosition);
+        while (node && !node->value.read(snapshot)) {
+            node = records.lessThan(node->key);
+        }
 
-        return it->first;
+        return node ? node->key : RecordId();
     }
 
 } // namespace mongo
@@ -30,17 +30,26 @@
 
 #pragma once
 
-#include <boost/shared_array.hpp>
-#include <map>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <functional>
 
 #include "mongo/db/storage/capped_callback.h"
+#include "mongo/db/storage/in_memory/in_memory_skip_list.h"
+#include "mongo/db/storage/in_memory/in_memory_versioned_value.h"
 #include "mongo/db/storage/record_store.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
     /**
      * A RecordStore that stores all data in-memory.
      *
+     * Records are kept in a skip list which readers and writers share without locking, each
+     * record holding its versions so that every operation sees its own snapshot (see
+     * InMemoryRecoveryUnit). Concurrent writes to the same record are write conflicts.
+     *
      * @param cappedMaxSize - required if isCapped. limit uses dataSize() in this impl.
      */
     class InMemoryRecordStore : public RecordStore {
@@ -78,11 +87,12 @@ namespace mongo {
 
         virtual bool updateWithDamagesSupported() const;
 
-        virtual Status updateWithDamages( OperationContext* txn,
-                                          const RecordId& loc,
-                                          const RecordData& oldRec,
-                                          const char* damageSource,
-                                          const mutablebson::DamageVector& damages );
+        virtual StatusWith<RecordData> updateWithDamages(
+                OperationContext* txn,
+                const RecordId& loc,
+                const RecordData& oldRec,
+                const char* damageSource,
+                const mutablebson::DamageVector& damages );
 
         std::unique_ptr<RecordCursor> getCursor(OperationContext* txn, bool forward) const final;
 
@@ -108,42 +118,34 @@ namespace mongo {
                                      BSONObjBuilder* extraInfo = NULL,
                                      int infoLevel = 0) const;
 
-        virtual long long dataSize( OperationContext* txn ) const { return _data->dataSize; }
+        /**
+         * Like numRecords(), this counts the uncommitted changes of all operations.
+         */
+        virtual long long dataSize( OperationContext* txn ) const {
+            return _data->dataSize.load();
+        }
 
         virtual long long numRecords( OperationContext* txn ) const {
-            return _data->records.size();
+            return _data->numRecords.load();
         }
 
         virtual boost::optional<RecordId> oplogStartHack(OperationContext* txn,
                                                          const RecordId& startingPosition) const;
 
+        virtual Status oplogDiskLocRegister(OperationContext* txn, const Timestamp& opTime);
+
         virtual void updateStatsAfterRepair(OperationContext* txn,
                                             long long numRecords,
                                             long long dataSize) {
-            invariant(_data->records.size() == size_t(numRecords));
-            _data->dataSize = dataSize;
+            _data->numRecords.store(numRecords);
+            _data->dataSize.store(dataSize);
         }
 
-    protected:
-        struct InMemoryRecord {
-            InMemoryRecord() :size(0) {}
-            InMemoryRecord(int size) :size(size), data(new char[size]) {}
-
-            RecordData toRecordData() const { return RecordData(data.get(), size); }
-
-            int size;
-            boost::shared_array<char> data;
-        };
-
-        virtual const InMemoryRecord* recordFor( const RecordId& loc ) const;
-        virtual InMemoryRecord* recordFor( const RecordId& loc );
-
-    public:
         //
         // Not in RecordStore interface
         //
 
-        typedef std::map<RecordId, InMemoryRecord> Records;
+        typedef InMemorySkipList<RecordId, InMemoryVersionedValue, std::less<RecordId> > Records;
 
         bool isCapped() const { return _isCapped; }
         void setCappedDeleteCallback(CappedDocumentDeleteCallback* cb) {
@@ -153,19 +155,43 @@ namespace mongo {
         bool cappedMaxSize() const { invariant(_isCapped); return _cappedMaxSize; }
 
     private:
-        class InsertChange;
-        class RemoveChange;
-        class TruncateChange;
+        class CountChange;
+        class UncommittedIdChange;
 
         class Cursor;
         class ReverseCursor;
 
         StatusWith<RecordId> extractAndCheckLocForOplog(const char* data, int len) const;
 
+        StatusWith<RecordId> insertRecord(OperationContext* txn, const RecordData& rec);
+
+        /**
+         * Returns the record at 'loc' in 'txn's snapshot, which must exist.
+         */
+        RecordData recordFor(OperationContext* txn, const RecordId& loc) const;
+
+        /**
+         * Adjusts the record count and data size now, and back again if 'txn' rolls back.
+         */
+        void changeCounts(OperationContext* txn, int64_t numRecords, int64_t dataSize);
+
+        /**
+         * Capped collections hide the records from the oldest one which is not committed yet on,
+         * so that forward scans, such as those replication uses to tail the oplog, never skip a
+         * record which is committed after readers have moved past it.
+         */
+        void addUncommittedId_inlock(OperationContext* txn, const RecordId& loc);
+        bool isCappedHidden(const RecordId& loc) const;
+
         RecordId allocateLoc();
         bool cappedAndNeedDelete(OperationContext* txn) const;
         void cappedDeleteAsNeeded(OperationContext* txn);
 
+        /**
+         * Deletes the oldest records until the collection fits, returning the last one deleted.
+         */
+        Records::Node* cappedDeleteAsNeeded_inlock(OperationContext* txn);
+
         // TODO figure out a proper solution to metadata
         const bool _isCapped;
         const int64_t _cappedMaxSize;
@@ -174,12 +200,25 @@ namespace mongo {
 
         // This is the "persistent" data.
         struct Data {
-            Data(bool isOplog) :dataSize(0), nextId(1), isOplog(isOplog) {}
+            Data(bool isOplog) :dataSize(0), numRecords(0), nextId(1), isOplog(isOplog) {}
 
-            int64_t dataSize;
+            AtomicInt64 dataSize;
+            AtomicInt64 numRecords;
             Records records;
-            int64_t nextId;
+            AtomicInt64 nextId;
             const bool isOplog;
+
+            // Capped collections only. Sorted.
+            mutable boost::mutex uncommittedIdsMutex;
+            std::deque<RecordId> uncommittedIds;
+            RecordId highestSeen;
+
+            // Only one operation at a time deletes the oldest records of a capped collection.
+            // Every record up to 'cappedDeletedUpTo' is gone for snapshots reading at or after
+            // 'cappedDeletedTimestamp'.
+            boost::mutex cappedDeleterMutex;
+            Records::Node* cappedDeletedUpTo = nullptr;
+            uint64_t cappedDeletedTimestamp = 0;
         };
 
         Data* const _data;
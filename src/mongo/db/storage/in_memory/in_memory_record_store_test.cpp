@@ -31,6 +31,7 @@
 #include "mongo/db/storage/in_memory/in_memory_record_store.h"
 
 
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/unittest/unittest.h"
@@ -50,6 +51,8 @@ namespace mongo {
             return new InMemoryRecoveryUnit();
         }
 
+        virtual bool supportsDocLocking() const { return true; }
+
         std::shared_ptr<void> data;
     };
 
@@ -57,4 +60,96 @@ namespace mongo {
         return new InMemoryHarnessHelper();
     }
 
+    namespace {
+
+        RecordId insertCommitted(HarnessHelper* harnessHelper, RecordStore* rs, const char* str) {
+            std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            WriteUnitOfWork uow(opCtx.get());
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), str, strlen(str) + 1, false);
+            ASSERT_OK(res.getStatus());
+            uow.commit();
+            return res.getValue();
+        }
+
+        std::string readRecord(OperationContext* opCtx, RecordStore* rs, const RecordId& loc) {
+            RecordData data;
+            if (!rs->findRecord(opCtx, loc, &data)) return "<none>";
+            return data.data();
+        }
+
+    } // namespace
+
+    // A snapshot keeps seeing the data as of its first read until it is abandoned.
+    TEST(InMemoryRecordStoreTest, SnapshotIsolation) {
+        std::unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+        std::unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+        const RecordId loc = insertCommitted(harnessHelper.get(), rs.get(), "a");
+
+        std::unique_ptr<OperationContext> reader(harnessHelper->newOperationContext());
+        ASSERT_EQUALS("a", readRecord(reader.get(), rs.get(), loc));
+
+        RecordId inserted;
+        {
+            std::unique_ptr<OperationContext> writer(harnessHelper->newOperationContext());
+            WriteUnitOfWork uow(writer.get());
+            ASSERT_OK(rs->updateRecord(writer.get(), loc, "b", 2, false, NULL).getStatus());
+            inserted = rs->insertRecord(writer.get(), "c", 2, false).getValue();
+
+            // Uncommitted writes are only visible to their own unit of work.
+            ASSERT_EQUALS("b", readRecord(writer.get(), rs.get(), loc));
+            ASSERT_EQUALS("a", readRecord(reader.get(), rs.get(), loc));
+            uow.commit();
+        }
+
+        ASSERT_EQUALS("a", readRecord(reader.get(), rs.get(), loc));
+        ASSERT_EQUALS("<none>", readRecord(reader.get(), rs.get(), inserted));
+
+        reader->recoveryUnit()->abandonSnapshot();
+        ASSERT_EQUALS("b", readRecord(reader.get(), rs.get(), loc));
+        ASSERT_EQUALS("c", readRecord(reader.get(), rs.get(), inserted));
+    }
+
+    // Of two units of work updating the same record, the second one to write conflicts.
+    TEST(InMemoryRecordStoreTest, WriteConflict) {
+        std::unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+        std::unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+        const RecordId loc = insertCommitted(harnessHelper.get(), rs.get(), "a");
+
+        std::unique_ptr<OperationContext> first(harnessHelper->newOperationContext());
+        std::unique_ptr<OperationContext> second(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork firstUow(first.get());
+            WriteUnitOfWork secondUow(second.get());
+            ASSERT_OK(rs->updateRecord(first.get(), loc, "b", 2, false, NULL).getStatus());
+            ASSERT_THROWS(rs->updateRecord(second.get(), loc, "c", 2, false, NULL),
+                          WriteConflictException);
+            firstUow.commit();
+        }
+
+        // A snapshot which started before another unit of work committed conflicts with it too.
+        {
+            WriteUnitOfWork secondUow(second.get());
+            ASSERT_EQUALS("b", readRecord(second.get(), rs.get(), loc));
+            {
+                WriteUnitOfWork firstUow(first.get());
+                ASSERT_OK(rs->updateRecord(first.get(), loc, "c", 2, false, NULL).getStatus());
+                firstUow.commit();
+            }
+            ASSERT_THROWS(rs->updateRecord(second.get(), loc, "d", 2, false, NULL),
+                          WriteConflictException);
+        }
+
+        // Retrying with a new snapshot succeeds.
+        {
+            WriteUnitOfWork secondUow(second.get());
+            ASSERT_EQUALS("c", readRecord(second.get(), rs.get(), loc));
+            ASSERT_OK(rs->updateRecord(second.get(), loc, "d", 2, false, NULL).getStatus());
+            secondUow.commit();
+        }
+
+        ASSERT_EQUALS("d", readRecord(first.get(), rs.get(), loc));
+    }
+
 }
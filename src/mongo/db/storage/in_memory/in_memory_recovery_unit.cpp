@@ -32,13 +32,88 @@
 
 #include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "mongo/db/operation_context.h"
 #include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
 
+namespace {
+
+    // Commits are serialized so that a snapshot sees either all or none of a unit of work's
+    // writes: the versions are stamped with the commit timestamp before it is published.
+    boost::mutex commitMutex;
+
+    // The timestamp of the last commit, and so the read timestamp of new snapshots.
+    AtomicUInt64 lastCommitTimestamp(0);
+
+    // The read timestamps of all open snapshots, and a lower bound of the oldest of them which
+    // writers can read without taking the mutex.
+    boost::mutex snapshotsMutex;
+    std::multiset<uint64_t> activeSnapshots;
+    AtomicUInt64 oldestActiveSnapshot(0);
+
+    AtomicUInt64 nextSnapshotId(1);
+
+    /**
+     * Commits or rolls back a write made through another engine's recovery unit.
+     */
+    class VersionedWriteChange : public RecoveryUnit::Change {
+    public:
+        VersionedWriteChange(InMemoryVersionedValue* value, const void* owner)
+            : _value(value), _owner(owner) {}
+
+        virtual void commit() {
+            boost::lock_guard<boost::mutex> lk(commitMutex);
+            const uint64_t commitTimestamp = lastCommitTimestamp.load() + 1;
+            _value->commit(_owner, commitTimestamp);
+            lastCommitTimestamp.store(commitTimestamp);
+        }
+
+        virtual void rollback() {
+            _value->rollback(_owner);
+        }
+
+    private:
+        InMemoryVersionedValue* const _value;
+        const void* const _owner;
+    };
+
+} // namespace
+
+    InMemoryRecoveryUnit::InMemoryRecoveryUnit()
+        : _inUnitOfWork(false),
+          _hasSnapshot(false),
+          _mySnapshotId(nextSnapshotId.fetchAndAdd(1)) {
+    }
+
+    InMemoryRecoveryUnit::~InMemoryRecoveryUnit() {
+        invariant(!_inUnitOfWork);
+        releaseSnapshot();
+    }
+
+    void InMemoryRecoveryUnit::beginUnitOfWork(OperationContext* opCtx) {
+        invariant(!_inUnitOfWork);
+        _inUnitOfWork = true;
+    }
+
     void InMemoryRecoveryUnit::commitUnitOfWork() {
+        invariant(_inUnitOfWork);
         try {
+            if (!_writes.empty()) {
+                boost::lock_guard<boost::mutex> lk(commitMutex);
+                const uint64_t commitTimestamp = lastCommitTimestamp.load() + 1;
+                for (auto value : _writes) {
+                    value->commit(this, commitTimestamp);
+                }
+                lastCommitTimestamp.store(commitTimestamp);
+            }
+            _writes.clear();
+
             for (Changes::iterator it = _changes.begin(), end = _changes.end(); it != end; ++it) {
                 (*it)->commit();
             }
@@ -47,20 +122,108 @@ namespace mongo {
         catch (...) {
             std::terminate();
         }
+
+        _inUnitOfWork = false;
+        releaseSnapshot();
     }
 
     void InMemoryRecoveryUnit::abortUnitOfWork() {
-         try {
-             for (Changes::reverse_iterator it = _changes.rbegin(), end = _changes.rend();
-                     it != end; ++it) {
-                 ChangePtr change = *it;
-                 LOG(2) << "CUSTOM ROLLBACK " << demangleName(typeid(*change));
-                 change->rollback();
-             }
-             _changes.clear();
+        invariant(_inUnitOfWork);
+        try {
+            for (auto it = _writes.rbegin(); it != _writes.rend(); ++it) {
+                (*it)->rollback(this);
+            }
+            _writes.clear();
+
+            for (Changes::reverse_iterator it = _changes.rbegin(), end = _changes.rend();
+                    it != end; ++it) {
+                ChangePtr change = *it;
+                LOG(2) << "CUSTOM ROLLBACK " << demangleName(typeid(*change));
+                change->rollback();
+            }
+            _changes.clear();
         }
         catch (...) {
             std::terminate();
         }
+
+        _inUnitOfWork = false;
+        releaseSnapshot();
+    }
+
+    void InMemoryRecoveryUnit::abandonSnapshot() {
+        invariant(!_inUnitOfWork);
+        releaseSnapshot();
+    }
+
+    const InMemorySnapshot& InMemoryRecoveryUnit::snapshot() {
+        if (!_hasSnapshot) {
+            boost::lock_guard<boost::mutex> lk(snapshotsMutex);
+            const uint64_t readTimestamp = lastCommitTimestamp.load();
+            if (activeSnapshots.empty()) {
+                oldestActiveSnapshot.store(readTimestamp);
+            }
+            _activeSnapshot = activeSnapshots.insert(readTimestamp);
+            _snapshot.readTimestamp = readTimestamp;
+            _snapshot.owner = this;
+            _hasSnapshot = true;
+        }
+        return _snapshot;
+    }
+
+    void InMemoryRecoveryUnit::releaseSnapshot() {
+        if (!_hasSnapshot) return;
+
+        // Writes made outside of a unit of work are not kept.
+        for (auto it = _writes.rbegin(); it != _writes.rend(); ++it) {
+            (*it)->rollback(this);
+        }
+        _writes.clear();
+
+        {
+            boost::lock_guard<boost::mutex> lk(snapshotsMutex);
+            activeSnapshots.erase(_activeSnapshot);
+            oldestActiveSnapshot.store(activeSnapshots.empty() ? lastCommitTimestamp.load()
+                                                               : *activeSnapshots.begin());
+        }
+        _hasSnapshot = false;
+        _mySnapshotId = nextSnapshotId.fetchAndAdd(1);
+    }
+
+    // static
+    InMemorySnapshot InMemoryRecoveryUnit::getSnapshot(OperationContext* txn) {
+        RecoveryUnit* ru = txn->recoveryUnit();
+        if (InMemoryRecoveryUnit* imru = dynamic_cast<InMemoryRecoveryUnit*>(ru)) {
+            return imru->snapshot();
+        }
+
+        InMemorySnapshot latest;
+        latest.readTimestamp = lastCommitTimestamp.load();
+        latest.owner = ru;
+        return latest;
+    }
+
+    // static
+    void InMemoryRecoveryUnit::write(OperationContext* txn,
+                                     InMemoryVersionedValue* value,
+                                     bool exists,
+                                     const RecordData& data) {
+        RecoveryUnit* ru = txn->recoveryUnit();
+        InMemoryRecoveryUnit* imru = dynamic_cast<InMemoryRecoveryUnit*>(ru);
+        const InMemorySnapshot snapshot = getSnapshot(txn);
+
+        value->write(snapshot, exists, data.getOwned(), oldestActiveSnapshot.load());
+
+        if (imru) {
+            imru->_writes.push_back(value);
+        }
+        else {
+            ru->registerChange(new VersionedWriteChange(value, snapshot.owner));
+        }
+    }
+
+    // static
+    uint64_t InMemoryRecoveryUnit::getLastCommitTimestamp() {
+        return lastCommitTimestamp.load();
     }
 }
@@ -30,18 +30,31 @@
 
 #pragma once
 
+#include <set>
 #include <vector>
 
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/in_memory/in_memory_versioned_value.h"
 #include "mongo/db/storage/recovery_unit.h"
 
 namespace mongo {
 
-    class SortedDataInterface;
+    class OperationContext;
 
+    /**
+     * Gives each operation a snapshot of the versioned inMemory data: it sees everything committed
+     * before its first read or write, and its own writes. The snapshot is kept until the unit of
+     * work ends or, outside of one, until abandonSnapshot().
+     *
+     * On commit every version written in the unit of work becomes visible at once, to the
+     * snapshots taken after it.
+     */
     class InMemoryRecoveryUnit : public RecoveryUnit {
     public:
-        void beginUnitOfWork(OperationContext* opCtx) final { };
+        InMemoryRecoveryUnit();
+        virtual ~InMemoryRecoveryUnit();
+
+        void beginUnitOfWork(OperationContext* opCtx) final;
         void commitUnitOfWork() final;
         void abortUnitOfWork() final;
 
@@ -49,7 +62,7 @@ namespace mongo {
             return true;
         }
 
-        virtual void abandonSnapshot() {}
+        virtual void abandonSnapshot();
 
         virtual void registerChange(Change* change) {
             _changes.push_back(ChangePtr(change));
@@ -61,12 +74,48 @@ namespace mongo {
 
         virtual void setRollbackWritesDisabled() {}
 
-        virtual SnapshotId getSnapshotId() const { return SnapshotId(); }
+        virtual SnapshotId getSnapshotId() const { return SnapshotId(_mySnapshotId); }
+
+        /**
+         * Returns the snapshot 'txn' reads versioned inMemory data through, starting one if
+         * needed.
+         *
+         * Other engines' recovery units, such as the one the devnull engine uses with an
+         * InMemoryRecordStore, keep no snapshot: they read the latest committed data.
+         */
+        static InMemorySnapshot getSnapshot(OperationContext* txn);
+
+        /**
+         * Writes a new version of 'value' in 'txn's snapshot, which becomes visible to others when
+         * 'txn's unit of work commits. Throws WriteConflictException on a write conflict.
+         */
+        static void write(OperationContext* txn,
+                          InMemoryVersionedValue* value,
+                          bool exists,
+                          const RecordData& data = RecordData());
+
+        /**
+         * Returns the timestamp of the last commit, which snapshots started now read at.
+         */
+        static uint64_t getLastCommitTimestamp();
 
     private:
         typedef std::shared_ptr<Change> ChangePtr;
         typedef std::vector<ChangePtr> Changes;
 
+        const InMemorySnapshot& snapshot();
+        void releaseSnapshot();
+
+        bool _inUnitOfWork;
+
+        bool _hasSnapshot;
+        InMemorySnapshot _snapshot;
+        std::multiset<uint64_t>::iterator _activeSnapshot;
+        uint64_t _mySnapshotId;
+
+        // Every value written since the unit of work started, in order. Not owned.
+        std::vector<InMemoryVersionedValue*> _writes;
+
         Changes _changes;
     };
 
@@ -0,0 +1,251 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <new>
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * An ordered set of Keys, each with an associated Value, which can be searched and grown by
+     * any number of threads at once without locking.
+     *
+     * Entries are linked in with compare-and-swap and are never unlinked, so a Node* stays valid,
+     * and keeps its place in the order, for as long as the list exists. Removal is left to the
+     * Value, which for the inMemory engine records deletion as a new version of the entry.
+     * Memory is only given back when the whole list is destroyed.
+     *
+     * Less is a strict weak ordering of Keys, as for std::set.
+     */
+    template <typename Key, typename Value, typename Less>
+    class InMemorySkipList : boost::noncopyable {
+    public:
+        class Node : boost::noncopyable {
+        public:
+            const Key key;
+            Value value;
+
+            /**
+             * Returns the next entry in key order, or NULL if this is the last one.
+             */
+            Node* next() const { return _next[0].load(); }
+
+        private:
+            friend class InMemorySkipList;
+
+            Node(const Key& k, int height) : key(k), _height(height) {}
+
+            const int _height;
+
+            // Links to the next node at every level this node is part of. Allocated with the node
+            // to be '_height' long.
+            AtomicWord<Node*> _next[1];
+        };
+
+        explicit InMemorySkipList(const Less& less = Less()) : _less(less) {
+            for (int i = 0; i < kMaxHeight; i++) {
+                _head[i].store(NULL);
+            }
+        }
+
+        ~InMemorySkipList() {
+            Node* node = _head[0].load();
+            while (node) {
+                Node* next = node->next();
+                freeNode(node);
+                node = next;
+            }
+        }
+
+        /**
+         * Returns the node for 'key', adding one if there isn't one yet.
+         */
+        Node* insert(const Key& key) {
+            Node* preds[kMaxHeight];
+            Node* succs[kMaxHeight];
+            Node* node = NULL;
+
+            while (true) {
+                if (Node* found = findSplice(key, preds, succs)) {
+                    // Another thread got there first.
+                    if (node) freeNode(node);
+                    return found;
+                }
+
+                if (!node) {
+                    node = allocateNode(key, randomHeight());
+                }
+
+                for (int i = 0; i < node->_height; i++) {
+                    node->_next[i].store(succs[i]);
+                }
+
+                // Once it is in the bottom level the node is part of the list. The upper levels
+                // only speed up searches, so they can be linked in one at a time afterwards.
+                if (link(preds[0], 0).compareAndSwap(succs[0], node) != succs[0]) {
+                    continue;
+                }
+
+                for (int i = 1; i < node->_height; i++) {
+                    while (link(preds[i], i).compareAndSwap(succs[i], node) != succs[i]) {
+                        findSplice(key, preds, succs);
+                        node->_next[i].store(succs[i]);
+                    }
+                }
+
+                return node;
+            }
+        }
+
+        /**
+         * Returns the node for 'key', or NULL if there is none.
+         */
+        Node* find(const Key& key) const {
+            Node* node = lowerBound(key);
+            return (node && !_less(key, node->key)) ? node : NULL;
+        }
+
+        /**
+         * Returns the first node which is not less than 'key', or NULL if there is none.
+         */
+        Node* lowerBound(const Key& key) const {
+            Node* pred = NULL;
+            Node* succ = NULL;
+            for (int level = kMaxHeight - 1; level >= 0; level--) {
+                succ = link(pred, level).load();
+                while (succ && _less(succ->key, key)) {
+                    pred = succ;
+                    succ = succ->_next[level].load();
+                }
+            }
+            return succ;
+        }
+
+        /**
+         * Returns the last node which is less than 'key', or NULL if there is none.
+         */
+        Node* lessThan(const Key& key) const {
+            Node* pred = NULL;
+            for (int level = kMaxHeight - 1; level >= 0; level--) {
+                Node* succ = link(pred, level).load();
+                while (succ && _less(succ->key, key)) {
+                    pred = succ;
+                    succ = succ->_next[level].load();
+                }
+            }
+            return pred;
+        }
+
+        /**
+         * Returns the last node which is not greater than 'key', or NULL if there is none.
+         */
+        Node* lessThanOrEqual(const Key& key) const {
+            Node* node = lowerBound(key);
+            return (node && !_less(key, node->key)) ? node : lessThan(key);
+        }
+
+        Node* first() const { return _head[0].load(); }
+
+        Node* last() const {
+            Node* node = NULL;
+            for (int level = kMaxHeight - 1; level >= 0; level--) {
+                while (Node* next = link(node, level).load()) {
+                    node = next;
+                }
+            }
+            return node;
+        }
+
+        const Less& less() const { return _less; }
+
+    private:
+        // With a 1 in 4 chance of a node reaching each next level this is plenty for billions of
+        // entries.
+        static const int kMaxHeight = 16;
+
+        /**
+         * Fills in, for every level, the last node before 'key' (NULL for the head) and the node
+         * after it. Returns the node for 'key' if there is one.
+         */
+        Node* findSplice(const Key& key, Node** preds, Node** succs) const {
+            Node* pred = NULL;
+            for (int level = kMaxHeight - 1; level >= 0; level--) {
+                Node* succ = link(pred, level).load();
+                while (succ && _less(succ->key, key)) {
+                    pred = succ;
+                    succ = succ->_next[level].load();
+                }
+                preds[level] = pred;
+                succs[level] = succ;
+            }
+            return (succs[0] && !_less(key, succs[0]->key)) ? succs[0] : NULL;
+        }
+
+        AtomicWord<Node*>& link(Node* pred, int level) const {
+            return pred ? pred->_next[level] : _head[level];
+        }
+
+        int randomHeight() {
+            // splitmix64, so that concurrent inserters need not share a generator's state.
+            uint64_t z = _seed.fetchAndAdd(0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z ^= z >> 31;
+
+            int height = 1;
+            while (height < kMaxHeight && (z & 3) == 0) {
+                height++;
+                z >>= 2;
+            }
+            return height;
+        }
+
+        static Node* allocateNode(const Key& key, int height) {
+            void* mem = ::operator new(sizeof(Node) + (height - 1) * sizeof(AtomicWord<Node*>));
+            Node* node = new (mem) Node(key, height);
+            for (int i = 1; i < height; i++) {
+                new (&node->_next[i]) AtomicWord<Node*>(NULL);
+            }
+            return node;
+        }
+
+        static void freeNode(Node* node) {
+            node->~Node();
+            ::operator delete(node);
+        }
+
+        const Less _less;
+        mutable AtomicWord<Node*> _head[kMaxHeight];
+        AtomicWord<uint64_t> _seed;
+    };
+
+}  // namespace mongo
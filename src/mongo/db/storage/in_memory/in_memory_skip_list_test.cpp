@@ -0,0 +1,128 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/in_memory/in_memory_skip_list.h"
+
+#include <boost/thread/thread.hpp>
+#include <functional>
+#include <vector>
+
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    typedef InMemorySkipList<int, int, std::less<int>> IntSkipList;
+
+    TEST(InMemorySkipListTest, Empty) {
+        IntSkipList list;
+        ASSERT(list.first() == NULL);
+        ASSERT(list.last() == NULL);
+        ASSERT(list.find(1) == NULL);
+        ASSERT(list.lowerBound(1) == NULL);
+        ASSERT(list.lessThan(1) == NULL);
+        ASSERT(list.lessThanOrEqual(1) == NULL);
+    }
+
+    TEST(InMemorySkipListTest, InsertAndSearch) {
+        IntSkipList list;
+
+        // Insert the even numbers below 1000 out of order.
+        for (int i = 0; i < 500; i++) {
+            IntSkipList::Node* node = list.insert((i * 7 % 500) * 2);
+            node->value = node->key + 1;
+        }
+
+        // Inserting an existing key returns its node.
+        IntSkipList::Node* existing = list.find(10);
+        ASSERT(existing);
+        ASSERT_EQUALS(existing, list.insert(10));
+        ASSERT_EQUALS(11, existing->value);
+
+        int expected = 0;
+        for (IntSkipList::Node* node = list.first(); node; node = node->next()) {
+            ASSERT_EQUALS(expected, node->key);
+            expected += 2;
+        }
+        ASSERT_EQUALS(1000, expected);
+
+        ASSERT_EQUALS(998, list.last()->key);
+        ASSERT(list.find(11) == NULL);
+        ASSERT_EQUALS(12, list.lowerBound(11)->key);
+        ASSERT_EQUALS(12, list.lowerBound(12)->key);
+        ASSERT_EQUALS(10, list.lessThan(12)->key);
+        ASSERT_EQUALS(10, list.lessThan(11)->key);
+        ASSERT_EQUALS(12, list.lessThanOrEqual(12)->key);
+        ASSERT_EQUALS(10, list.lessThanOrEqual(11)->key);
+        ASSERT(list.lessThan(0) == NULL);
+        ASSERT(list.lowerBound(999) == NULL);
+    }
+
+    void insertRange(IntSkipList* list, int begin, int step, int count) {
+        for (int i = 0; i < count; i++) {
+            list->insert(begin + i * step);
+            // Every thread also inserts keys shared with all of the others.
+            list->insert(i);
+        }
+    }
+
+    TEST(InMemorySkipListTest, ConcurrentInsert) {
+        const int numThreads = 8;
+        const int perThread = 10000;
+
+        IntSkipList list;
+        std::vector<boost::thread*> threads;
+        for (int t = 0; t < numThreads; t++) {
+            // Thread 't' inserts the keys congruent to 't' modulo numThreads, starting after the
+            // shared ones.
+            threads.push_back(new boost::thread(stdx::bind(&insertRange, &list,
+                                                           perThread + t, numThreads, perThread)));
+        }
+        for (size_t t = 0; t < threads.size(); t++) {
+            threads[t]->join();
+            delete threads[t];
+        }
+
+        // Every key is there exactly once, in order.
+        int expected = 0;
+        for (IntSkipList::Node* node = list.first(); node; node = node->next()) {
+            ASSERT_EQUALS(expected, node->key);
+            expected++;
+        }
+        ASSERT_EQUALS(perThread + numThreads * perThread, expected);
+
+        for (int i = 0; i < expected; i += 997) {
+            ASSERT_EQUALS(i, list.find(i)->key);
+        }
+    }
+
+} // namespace
+} // namespace mongo
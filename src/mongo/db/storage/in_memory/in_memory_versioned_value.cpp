@@ -0,0 +1,140 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/in_memory/in_memory_versioned_value.h"
+
+#include <limits>
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+
+namespace mongo {
+
+namespace {
+    const uint64_t kUncommitted = std::numeric_limits<uint64_t>::max();
+} // namespace
+
+    struct InMemoryVersionedValue::Version {
+        Version(bool exists, const RecordData& data, const void* owner, uint64_t timestamp)
+            : exists(exists), data(data), owner(owner), timestamp(timestamp) {}
+
+        bool isVisibleTo(const InMemorySnapshot& snapshot) const {
+            return timestamp == kUncommitted ? owner == snapshot.owner
+                                             : timestamp <= snapshot.readTimestamp;
+        }
+
+        bool exists;
+        RecordData data;
+        const void* owner; // Only meaningful while uncommitted.
+        uint64_t timestamp; // Commit timestamp, or kUncommitted.
+        std::unique_ptr<Version> older;
+    };
+
+    InMemoryVersionedValue::InMemoryVersionedValue() {}
+
+    InMemoryVersionedValue::~InMemoryVersionedValue() {
+        // Free the chain iteratively, as it can be long for frequently written entries which
+        // a long running snapshot keeps from being pruned.
+        std::unique_ptr<Version> version = std::move(_newest);
+        while (version) {
+            version = std::move(version->older);
+        }
+    }
+
+    bool InMemoryVersionedValue::read(const InMemorySnapshot& snapshot, RecordData* data) const {
+        scoped_spinlock lk(_lock);
+        for (const Version* version = _newest.get(); version; version = version->older.get()) {
+            if (version->isVisibleTo(snapshot)) {
+                if (data && version->exists) *data = version->data;
+                return version->exists;
+            }
+        }
+        return false;
+    }
+
+    bool InMemoryVersionedValue::changedSince(const InMemorySnapshot& snapshot) const {
+        scoped_spinlock lk(_lock);
+        if (!_newest) return false;
+        if (_newest->timestamp == kUncommitted) return _newest->owner != snapshot.owner;
+        return _newest->timestamp > snapshot.readTimestamp;
+    }
+
+    void InMemoryVersionedValue::write(const InMemorySnapshot& snapshot,
+                                       bool exists,
+                                       const RecordData& data,
+                                       uint64_t oldestReadTimestamp) {
+        scoped_spinlock lk(_lock);
+
+        if (_newest && _newest->timestamp == kUncommitted && _newest->owner == snapshot.owner) {
+            // Overwriting our own uncommitted version.
+            _newest->exists = exists;
+            _newest->data = data;
+            return;
+        }
+
+        if (_newest && (_newest->timestamp == kUncommitted
+                        || _newest->timestamp > snapshot.readTimestamp)) {
+            throw WriteConflictException();
+        }
+
+        std::unique_ptr<Version> version(new Version(exists, data, snapshot.owner, kUncommitted));
+        version->older = std::move(_newest);
+        _newest = std::move(version);
+
+        // The newest version committed at or before the oldest snapshot is the oldest one anyone
+        // can still read.
+        for (Version* v = _newest->older.get(); v; v = v->older.get()) {
+            if (v->timestamp <= oldestReadTimestamp) {
+                v->older.reset();
+                break;
+            }
+        }
+    }
+
+    void InMemoryVersionedValue::commit(const void* owner, uint64_t commitTimestamp) {
+        scoped_spinlock lk(_lock);
+        if (_newest && _newest->timestamp == kUncommitted && _newest->owner == owner) {
+            _newest->timestamp = commitTimestamp;
+            _newest->owner = NULL;
+        }
+    }
+
+    void InMemoryVersionedValue::rollback(const void* owner) {
+        scoped_spinlock lk(_lock);
+        if (_newest && _newest->timestamp == kUncommitted && _newest->owner == owner) {
+            _newest = std::move(_newest->older);
+        }
+    }
+
+    void InMemoryVersionedValue::initialize(const RecordData& data) {
+        scoped_spinlock lk(_lock);
+        _newest.reset(new Version(true, data, NULL, 0));
+    }
+
+}  // namespace mongo
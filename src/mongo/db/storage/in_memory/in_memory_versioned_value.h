@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/db/storage/record_data.h"
+#include "mongo/util/concurrency/spin_lock.h"
+
+namespace mongo {
+
+    /**
+     * What an operation sees of versioned inMemory data: every version committed at or before
+     * 'readTimestamp', and the uncommitted versions written by 'owner'.
+     */
+    struct InMemorySnapshot {
+        uint64_t readTimestamp;
+        const void* owner;
+    };
+
+    /**
+     * The versions of a single record or index entry, newest first. Each version either holds
+     * the entry's contents or records that it was removed.
+     *
+     * An entry has at most one uncommitted version, which is always the newest. Writing to an
+     * entry which has an uncommitted version of another owner, or a version committed after the
+     * writer's snapshot was taken, is a write conflict (first committer wins).
+     */
+    class InMemoryVersionedValue {
+    public:
+        InMemoryVersionedValue();
+        ~InMemoryVersionedValue();
+
+        /**
+         * Returns whether the entry exists in 'snapshot', setting 'data' (if not NULL) to its
+         * contents.
+         */
+        bool read(const InMemorySnapshot& snapshot, RecordData* data = NULL) const;
+
+        /**
+         * Returns true if the entry has been written since 'snapshot' was taken, either by an
+         * uncommitted write of another owner or by a commit later than the snapshot.
+         */
+        bool changedSince(const InMemorySnapshot& snapshot) const;
+
+        /**
+         * Makes 'data', or the entry's removal if 'exists' is false, the uncommitted version of
+         * 'snapshot.owner'. Versions older than the newest one visible at 'oldestReadTimestamp',
+         * which no snapshot can read any more, are freed.
+         *
+         * Throws WriteConflictException, without changing anything, on a write conflict.
+         */
+        void write(const InMemorySnapshot& snapshot,
+                   bool exists,
+                   const RecordData& data,
+                   uint64_t oldestReadTimestamp);
+
+        /**
+         * Makes the uncommitted version of 'owner', if there is one, visible to snapshots reading
+         * at or after 'commitTimestamp'.
+         */
+        void commit(const void* owner, uint64_t commitTimestamp);
+
+        /**
+         * Discards the uncommitted version of 'owner', if there is one.
+         */
+        void rollback(const void* owner);
+
+        /**
+         * Sets the contents of an entry no snapshot can see yet, such as one added by a bulk
+         * build, as if committed before any snapshot was taken.
+         */
+        void initialize(const RecordData& data);
+
+    private:
+        struct Version;
+
+        mutable SpinLock _lock;
+        std::unique_ptr<Version> _newest;
+    };
+
+}  // namespace mongo
@@ -270,6 +270,14 @@ namespace mongo {
         _appendAllElementsForIndexing(obj, ord, discriminator);
     }
 
+    void KeyString::resetToKey(const std::vector<BSONElement>& elements, Ordering ord) {
+        resetToEmpty();
+        for (size_t i = 0; i < elements.size(); i++) {
+            _appendBsonValue(elements[i], ord.get(i) == -1, NULL);
+        }
+        _append(kEnd, false);
+    }
+
     // ----------------------------------------------------------------------
     // -----------   APPEND CODE  -------------------------------------------
     // ----------------------------------------------------------------------
@@ -1018,31 +1026,47 @@ namespace mongo {
             default: invariant(false);
             }
         }
+
+        void toBsonFields(const char* buffer,
+                          size_t len,
+                          Ordering ord,
+                          const KeyString::TypeBits& typeBits,
+                          BSONObjBuilder* builder) {
+            BufReader reader(buffer, len);
+            KeyString::TypeBits::Reader typeBitsReader(typeBits);
+            for (int i = 0; reader.remaining(); i++) {
+                const bool invert = (ord.get(i) == -1);
+                uint8_t ctype = readType<uint8_t>(&reader, invert);
+                if (ctype == kLess || ctype == kGreater) {
+                    // This was just a discriminator which is logically part of the previous field.
+                    // This will only be encountered on queries, not in the keys stored in an index.
+                    // Note: this should probably affect the BSON key name of the last field, but it
+                    // must be read *after* the value so it isn't possible.
+                    ctype = readType<uint8_t>(&reader, invert);
+                }
+
+                if (ctype == kEnd)
+                    break;
+                toBsonValue(ctype, &reader, &typeBitsReader, invert, &(*builder << ""));
+            }
+        }
     } // namespace
 
     BSONObj KeyString::toBson(const char* buffer, size_t len, Ordering ord,
                               const TypeBits& typeBits) {
         BSONObjBuilder builder;
-        BufReader reader(buffer, len);
-        TypeBits::Reader typeBitsReader(typeBits);
-        for (int i = 0; reader.remaining(); i++) {
-            const bool invert = (ord.get(i) == -1);
-            uint8_t ctype = readType<uint8_t>(&reader, invert);
-            if (ctype == kLess || ctype == kGreater) {
-                // This was just a discriminator which is logically part of the previous field. This
-                // will only be encountered on queries, not in the keys stored in an index.
-                // Note: this should probably affect the BSON key name of the last field, but it
-                // must be read *after* the value so it isn't possible.
-                ctype = readType<uint8_t>(&reader, invert);
-            }
-
-            if (ctype == kEnd)
-                break;
-            toBsonValue(ctype, &reader, &typeBitsReader, invert, &(builder << ""));
-        }
+        toBsonFields(buffer, len, ord, typeBits, &builder);
         return builder.obj();
     }
 
+    BSONObj KeyString::toBson(const char* buffer, size_t len, Ordering ord,
+                              const TypeBits& typeBits, BufBuilder* buf) {
+        buf->reset();
+        BSONObjBuilder builder(*buf);
+        toBsonFields(buffer, len, ord, typeBits, &builder);
+        return builder.done();
+    }
+
     BSONObj KeyString::toBson(StringData data, Ordering ord, const TypeBits& typeBits) {
         return toBson(data.rawData(), data.size(), ord, typeBits);
     }
@@ -28,6 +28,10 @@
  *    it in the license file.
  */
 
+#pragma once
+
+#include <vector>
+
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/bsonmisc.h"
@@ -205,6 +209,14 @@ namespace mongo {
         static BSONObj toBson(const char* buffer, size_t len, Ordering ord,
                               const TypeBits& types);
 
+        /**
+         * Decodes into 'buf', which is reset first, and returns a BSONObj pointing into it rather
+         * than one owning its own copy. The result is only valid until 'buf' is next modified.
+         * Lets callers decoding many keys reuse one allocation.
+         */
+        static BSONObj toBson(const char* buffer, size_t len, Ordering ord,
+                              const TypeBits& types, BufBuilder* buf);
+
         /**
          * Decodes a RecordId from the end of a buffer.
          */
@@ -229,6 +241,13 @@ namespace mongo {
 
         void resetToKey(const BSONObj& obj, Ordering ord, RecordId recordId);
         void resetToKey(const BSONObj& obj, Ordering ord, Discriminator discriminator = kInclusive);
+
+        /**
+         * Encodes the key made of 'elements', in order, as if they had been appended with empty
+         * field names to a BSONObj passed to the overload above with kInclusive. Lets index key
+         * generation skip building that BSONObj.
+         */
+        void resetToKey(const std::vector<BSONElement>& elements, Ordering ord);
         void resetFromBuffer(const void* buffer, size_t size) {
             _buffer.reset();
             memcpy(_buffer.skip(size), buffer, size);
@@ -0,0 +1,96 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/key_string_set.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mongo {
+
+    namespace {
+        int compareBytes(const char* l, size_t lSize, const char* r, size_t rSize) {
+            const int cmp = std::memcmp(l, r, std::min(lSize, rSize));
+            if (cmp)
+                return cmp;
+            return lSize < rSize ? -1 : (lSize > rSize ? 1 : 0);
+        }
+    }  // namespace
+
+    KeyString::TypeBits KeyStringSet::Key::getTypeBits() const {
+        BufReader reader(_typeBits, _typeBitsSize);
+        return KeyString::TypeBits::fromBuffer(&reader);
+    }
+
+    BSONObj KeyStringSet::Key::toBson(Ordering ord) const {
+        return KeyString::toBson(_data, _size, ord, getTypeBits());
+    }
+
+    void KeyStringSet::add(const KeyString& key, int bsonSize) {
+        const KeyString::TypeBits& typeBits = key.getTypeBits();
+        const size_t typeBitsSize = typeBits.isAllZeros() ? 0 : typeBits.getSize();
+
+        Entry entry;
+        entry.offset = _buffer.size();
+        entry.size = key.getSize();
+        entry.typeBitsSize = typeBitsSize;
+        entry.bsonSize = bsonSize;
+        _entries.push_back(entry);
+
+        _buffer.insert(_buffer.end(), key.getBuffer(), key.getBuffer() + key.getSize());
+        const char* typeBitsData = reinterpret_cast<const char*>(typeBits.getBuffer());
+        _buffer.insert(_buffer.end(), typeBitsData, typeBitsData + typeBitsSize);
+    }
+
+    void KeyStringSet::sortAndUnique() {
+        if (_entries.size() < 2)
+            return;
+
+        const char* base = _buffer.data();
+        auto less = [base](const Entry& l, const Entry& r) {
+            return compareBytes(base + l.offset, l.size, base + r.offset, r.size) < 0;
+        };
+        auto equal = [base](const Entry& l, const Entry& r) {
+            return compareBytes(base + l.offset, l.size, base + r.offset, r.size) == 0;
+        };
+
+        // Stable so that unique() keeps the first added of equal keys.
+        std::stable_sort(_entries.begin(), _entries.end(), less);
+        _entries.erase(std::unique(_entries.begin(), _entries.end(), equal), _entries.end());
+    }
+
+    int KeyStringSet::compare(size_t i, const KeyStringSet& other, size_t j) const {
+        const Entry& l = _entries[i];
+        const Entry& r = other._entries[j];
+        return compareBytes(_buffer.data() + l.offset, l.size,
+                            other._buffer.data() + r.offset, r.size);
+    }
+
+}  // namespace mongo
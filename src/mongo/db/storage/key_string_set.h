@@ -0,0 +1,130 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/db/storage/key_string.h"
+
+namespace mongo {
+
+    /**
+     * A sorted, duplicate-free set of index keys encoded as KeyStrings without RecordIds, stored
+     * back to back in one flat buffer. This is what index key generation produces for storage
+     * engines whose indexes are keyed by KeyString, so that each key is encoded exactly once and
+     * generating the keys for a document costs a couple of allocations rather than one per key.
+     *
+     * Keys are added in any order with add(), then sortAndUnique() must be called before the set
+     * is read. clear() keeps the memory for reuse.
+     */
+    class KeyStringSet {
+    public:
+        /**
+         * A view of one key in the set, valid until the set is next modified.
+         */
+        class Key {
+        public:
+            const char* getBuffer() const { return _data; }
+            size_t getSize() const { return _size; }
+
+            KeyString::TypeBits getTypeBits() const;
+
+            /**
+             * The size of this key as a BSONObj with empty field names, which is what index key
+             * size limits are expressed in.
+             */
+            int getBsonSize() const { return _bsonSize; }
+
+            BSONObj toBson(Ordering ord) const;
+
+        private:
+            friend class KeyStringSet;
+
+            Key(const char* data, size_t size, const char* typeBits, size_t typeBitsSize,
+                int bsonSize)
+                : _data(data),
+                  _size(size),
+                  _typeBits(typeBits),
+                  _typeBitsSize(typeBitsSize),
+                  _bsonSize(bsonSize) {}
+
+            const char* _data;
+            size_t _size;
+            const char* _typeBits;
+            size_t _typeBitsSize;
+            int _bsonSize;
+        };
+
+        /**
+         * Adds 'key', which must not have a RecordId appended. 'bsonSize' is reported back by
+         * Key::getBsonSize().
+         */
+        void add(const KeyString& key, int bsonSize);
+
+        /**
+         * Sorts the keys in KeyString order and drops all but the first added of equal keys,
+         * matching what inserting them into a BSONObjSet would keep.
+         */
+        void sortAndUnique();
+
+        void clear() {
+            _buffer.clear();
+            _entries.clear();
+        }
+
+        size_t size() const { return _entries.size(); }
+        bool empty() const { return _entries.empty(); }
+
+        Key operator[](size_t i) const {
+            const Entry& entry = _entries[i];
+            const char* data = _buffer.data() + entry.offset;
+            return Key(data, entry.size, data + entry.size, entry.typeBitsSize, entry.bsonSize);
+        }
+
+        /**
+         * Compares the keys at 'i' in this set and 'j' in 'other' the way the index orders them.
+         */
+        int compare(size_t i, const KeyStringSet& other, size_t j) const;
+
+    private:
+        struct Entry {
+            uint32_t offset;
+            uint32_t size;
+            uint32_t typeBitsSize;
+            int32_t bsonSize;
+        };
+
+        // For each key, its KeyString bytes immediately followed by its TypeBits, which are left
+        // out if they are all zeros.
+        std::vector<char> _buffer;
+        std::vector<Entry> _entries;
+    };
+
+}  // namespace mongo
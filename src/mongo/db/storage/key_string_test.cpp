@@ -35,6 +35,7 @@
 #include "mongo/platform/basic.h"
 #include "mongo/config.h"
 #include "mongo/db/storage/key_string.h"
+#include "mongo/db/storage/sortable_key_string.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
@@ -100,6 +101,21 @@ TEST(KeyStringTest, Simple1) {
         }                                                        \
     } while (0)
 
+TEST(KeyStringTest, ToBsonIntoReusedBuffer) {
+    BufBuilder buf(0);
+    const BSONObj keys[] = {BSON("" << "a somewhat longer string value" << "" << 1),
+                            BSON("" << 5.5),
+                            BSON("" << BSON("x" << 1) << "" << BSONNULL)};
+    for (auto&& key : keys) {
+        const KeyString ks(key, ALL_ASCENDING);
+        const BSONObj decoded = KeyString::toBson(ks.getBuffer(), ks.getSize(), ALL_ASCENDING,
+                                                  ks.getTypeBits(), &buf);
+        ASSERT(!decoded.isOwned());
+        ASSERT(decoded.objdata() == buf.buf());
+        ASSERT(decoded.binaryEqual(key));
+    }
+}
+
 TEST(KeyStringTest, ActualBytesDouble) {
     // just one test like this for utter sanity
 
@@ -844,3 +860,58 @@ TEST(KeyStringTest, RecordIds) {
     }
 }
 
+
+TEST(SortableKeyStringTest, CompareAndRoundtrip) {
+    const BSONObj keys[] = {
+        BSON("" << MINKEY << "" << 1),
+        BSON("" << 1 << "" << "b"),
+        BSON("" << 1.5 << "" << "a"),
+        BSON("" << 2LL << "" << BSONNULL),
+        BSON("" << 2 << "" << 3.0),
+        BSON("" << "abc" << "" << BSON("x" << 1)),
+        BSON("" << "abd" << "" << BSON_ARRAY(1 << 2)),
+        BSON("" << OID("abcdefabcdefabcdefabcdef") << "" << true),
+        BSON("" << Date_t::fromMillisSinceEpoch(-1) << "" << MAXKEY),
+        BSON("" << Date_t::fromMillisSinceEpoch(1) << "" << -0.0),
+    };
+    const Ordering orders[] = {
+        Ordering::make(BSON("a" << 1 << "b" << 1)),
+        Ordering::make(BSON("a" << -1 << "b" << 1)),
+        Ordering::make(BSON("a" << 1 << "b" << -1)),
+    };
+
+    for (const Ordering& ord : orders) {
+        for (const BSONObj& l : keys) {
+            const SortableKeyString lKey(l, ord);
+            ASSERT(lKey.toBson(ord).binaryEqual(l));
+
+            for (const BSONObj& r : keys) {
+                const int expected = l.woCompare(r, ord, false);
+                const int actual = lKey.compare(SortableKeyString(r, ord));
+                ASSERT_EQ(expected < 0, actual < 0);
+                ASSERT_EQ(expected == 0, actual == 0);
+            }
+        }
+    }
+}
+
+TEST(SortableKeyStringTest, SerializeForSorter) {
+    const BSONObj key = BSON("" << 1.0 << "" << "foo" << "" << 5LL);
+    const SortableKeyString original(key, ALL_ASCENDING);
+
+    BufBuilder buf;
+    original.serializeForSorter(buf);
+    SortableKeyString().serializeForSorter(buf);
+
+    BufReader reader(buf.buf(), buf.len());
+    const SortableKeyString copy = SortableKeyString::deserializeForSorter(
+        reader, SortableKeyString::SorterDeserializeSettings());
+    const SortableKeyString empty = SortableKeyString::deserializeForSorter(
+        reader, SortableKeyString::SorterDeserializeSettings());
+    ASSERT(reader.atEof());
+
+    ASSERT_EQ(0, copy.compare(original));
+    ASSERT(copy.toBson(ALL_ASCENDING).binaryEqual(key));
+    ASSERT_EQ(0u, empty.getSize());
+    ASSERT_LESS_THAN(empty.compare(original), 0);
+}
@@ -32,6 +32,8 @@
 
 #include "mongo/db/storage/kv/kv_catalog.h"
 
+#include <algorithm>
+#include <boost/thread/locks.hpp>
 #include <stdlib.h>
 
 #include "mongo/db/concurrency/d_concurrency.h"
@@ -49,45 +51,42 @@ namespace {
     // It is never used with KVEngines that support doc-level locking so this should never conflict
     // with anything else.
     //
-    // NOTE: Must be locked *before* _identLock.
+    // NOTE: Must be locked *before* the writeMutex of any cache shard.
     const ResourceId resourceIdCatalogMetadata(RESOURCE_METADATA, 1ULL);
 }
 
     using std::unique_ptr;
     using std::string;
 
-    class KVCatalog::AddIdentChange : public RecoveryUnit::Change {
+    class KVCatalog::EntryChange : public RecoveryUnit::Change {
     public:
-        AddIdentChange(KVCatalog* catalog, StringData ident)
-            :_catalog(catalog), _ident(ident.toString())
+        EntryChange(KVCatalog* catalog, StringData ns, EntryPtr previous)
+            :_catalog(catalog), _ns(ns.toString()), _previous(previous)
         {}
 
         virtual void commit() {}
         virtual void rollback() {
-            boost::lock_guard<boost::mutex> lk(_catalog->_identsLock);
-            _catalog->_idents.erase(_ident);
+            _catalog->_setEntry(_ns, _previous);
         }
 
         KVCatalog* const _catalog;
-        const std::string _ident;
+        const std::string _ns;
+        const EntryPtr _previous;
     };
 
-    class KVCatalog::RemoveIdentChange : public RecoveryUnit::Change {
-    public:
-        RemoveIdentChange(KVCatalog* catalog, StringData ident, const Entry& entry)
-            :_catalog(catalog), _ident(ident.toString()), _entry(entry)
-        {}
-
-        virtual void commit() {}
-        virtual void rollback() {
-            boost::lock_guard<boost::mutex> lk(_catalog->_identsLock);
-            _catalog->_idents[_ident] = _entry;
+    KVCatalog::Entry::Entry( const BSONObj& d, RecordId l )
+        : doc( d.getOwned() ), storedLoc( l ), ident( doc["ident"].String() ) {
+        const BSONElement mdElement = doc["md"];
+        if ( mdElement.isABSONObj() ) {
+            md.parse( mdElement.Obj() );
         }
+    }
 
-        KVCatalog* const _catalog;
-        const std::string _ident;
-        const Entry _entry;
-    };
+    KVCatalog::Entry::Entry( const BSONObj& d,
+                             RecordId l,
+                             const BSONCollectionCatalogEntry::MetaData& m )
+        : doc( d.getOwned() ), storedLoc( l ), ident( doc["ident"].String() ), md( m ) {
+    }
 
     KVCatalog::KVCatalog( RecordStore* rs,
                           bool isRsThreadSafe,
@@ -111,9 +110,12 @@ namespace {
 
     bool KVCatalog::_hasEntryCollidingWithRand() const {
         // Only called from init() so don't need to lock.
-        for (NSToIdentMap::const_iterator it = _idents.begin(); it != _idents.end(); ++it) {
-            if (StringData(it->first).endsWith(_rand))
-                return true;
+        for (size_t i = 0; i < kNumShards; i++) {
+            const NSToEntryMap& entries = *_shards[i].entries;
+            for (NSToEntryMap::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+                if (StringData(it->second->ident).endsWith(_rand))
+                    return true;
+            }
         }
         return false;
     }
@@ -131,15 +133,19 @@ namespace {
     }
 
     void KVCatalog::init( OperationContext* opCtx ) {
-        // No locking needed since called single threaded.
+        // No locking needed since called single threaded. This is the only time the catalog is
+        // read from the RecordStore.
+        std::vector<NSToEntryMap> entries(kNumShards);
         auto cursor = _rs->getCursor(opCtx);
         while (auto record = cursor->next()) {
-            BSONObj obj = record->data.releaseToBson();
-
             // No rollback since this is just loading already committed data.
-            string ns = obj["ns"].String();
-            string ident = obj["ident"].String();
-            _idents[ns] = Entry(ident, record->id);
+            EntryPtr entry = std::make_shared<Entry>( record->data.releaseToBson(), record->id );
+            const string ns = entry->doc["ns"].String();
+            entries[&_shardFor(ns) - _shards][ns] = entry;
+        }
+
+        for (size_t i = 0; i < kNumShards; i++) {
+            _shards[i].entries = std::make_shared<NSToEntryMap>(std::move(entries[i]));
         }
 
         // In the unlikely event that we have used this _rand before generate a new one.
@@ -148,11 +154,66 @@ namespace {
         }
     }
 
+    KVCatalog::Shard& KVCatalog::_shardFor( StringData ns ) const {
+        // FNV-1a
+        uint32_t hash = 2166136261U;
+        for (size_t i = 0; i < ns.size(); i++) {
+            hash = (hash ^ static_cast<unsigned char>(ns[i])) * 16777619U;
+        }
+        return _shards[hash % kNumShards];
+    }
+
+    std::shared_ptr<const KVCatalog::NSToEntryMap> KVCatalog::_entries(
+            const Shard& shard ) const {
+        scoped_spinlock lk( const_cast<Shard&>(shard).lock );
+        return shard.entries;
+    }
+
+    KVCatalog::EntryPtr KVCatalog::_findEntry( StringData ns ) const {
+        const std::shared_ptr<const NSToEntryMap> entries = _entries( _shardFor( ns ) );
+        NSToEntryMap::const_iterator it = entries->find( ns.toString() );
+        return it == entries->end() ? EntryPtr() : it->second;
+    }
+
+    KVCatalog::EntryPtr KVCatalog::_setEntry( StringData ns, EntryPtr entry ) {
+        Shard& shard = _shardFor( ns );
+        boost::lock_guard<boost::mutex> lk( shard.writeMutex );
+
+        // Only writers replace the pointer, so it can be read without the spinlock here.
+        std::shared_ptr<NSToEntryMap> copy = std::make_shared<NSToEntryMap>( *shard.entries );
+        EntryPtr& slot = (*copy)[ns.toString()];
+        EntryPtr previous = slot;
+        if ( entry ) {
+            slot = entry;
+        }
+        else {
+            copy->erase( ns.toString() );
+        }
+
+        std::shared_ptr<const NSToEntryMap> old;
+        {
+            scoped_spinlock spinLk( shard.lock );
+            old = shard.entries;
+            shard.entries = copy;
+        }
+        // 'old' is freed here, outside of the spinlock, unless a reader still has it.
+        return previous;
+    }
+
+    void KVCatalog::_setEntry( OperationContext* opCtx, StringData ns, EntryPtr entry ) {
+        EntryPtr previous = _setEntry( ns, entry );
+        opCtx->recoveryUnit()->registerChange( new EntryChange( this, ns, previous ) );
+    }
+
     void KVCatalog::getAllCollections( std::vector<std::string>* out ) const {
-        boost::lock_guard<boost::mutex> lk( _identsLock );
-        for ( NSToIdentMap::const_iterator it = _idents.begin(); it != _idents.end(); ++it ) {
-            out->push_back( it->first );
+        const size_t first = out->size();
+        for (size_t i = 0; i < kNumShards; i++) {
+            const std::shared_ptr<const NSToEntryMap> entries = _entries( _shards[i] );
+            for ( NSToEntryMap::const_iterator it = entries->begin(); it != entries->end(); ++it ) {
+                out->push_back( it->first );
+            }
         }
+        std::sort( out->begin() + first, out->end() );
     }
 
     Status KVCatalog::newCollection( OperationContext* opCtx,
@@ -168,22 +229,19 @@ namespace {
                                              MODE_X));
         }
 
-        const string ident = _newUniqueIdent(ns, "collection");
-
-        boost::lock_guard<boost::mutex> lk( _identsLock );
-        Entry& old = _idents[ns.toString()];
-        if ( !old.ident.empty() ) {
+        // The X lock on the database keeps others from adding the same namespace meanwhile.
+        if ( _findEntry( ns ) ) {
             return Status( ErrorCodes::NamespaceExists, "collection already exists" );
         }
 
-        opCtx->recoveryUnit()->registerChange(new AddIdentChange(this, ns));
+        const string ident = _newUniqueIdent(ns, "collection");
 
         BSONObj obj;
+        BSONCollectionCatalogEntry::MetaData md;
         {
             BSONObjBuilder b;
             b.append( "ns", ns );
             b.append( "ident", ident );
-            BSONCollectionCatalogEntry::MetaData md;
             md.ns = ns.toString();
             md.options = options;
             b.append( "md", md.toBSON() );
@@ -194,71 +252,32 @@ namespace {
         if ( !res.isOK() )
             return res.getStatus();
 
-        old = Entry( ident, res.getValue() );
+        _setEntry( opCtx, ns, std::make_shared<Entry>( obj, res.getValue(), md ) );
         LOG(1) << "stored meta data for " << ns << " @ " << res.getValue();
         return Status::OK();
     }
 
     std::string KVCatalog::getCollectionIdent( StringData ns ) const {
-        boost::lock_guard<boost::mutex> lk( _identsLock );
-        NSToIdentMap::const_iterator it = _idents.find( ns.toString() );
-        invariant( it != _idents.end() );
-        return it->second.ident;
+        EntryPtr entry = _findEntry( ns );
+        invariant( entry );
+        return entry->ident;
     }
 
     std::string KVCatalog::getIndexIdent( OperationContext* opCtx,
                                           StringData ns,
                                           StringData idxName ) const {
-        BSONObj obj = _findEntry( opCtx, ns );
-        BSONObj idxIdent = obj["idxIdent"].Obj();
+        EntryPtr entry = _findEntry( ns );
+        invariant( entry );
+        BSONObj idxIdent = entry->doc["idxIdent"].Obj();
         return idxIdent[idxName].String();
     }
 
-    BSONObj KVCatalog::_findEntry( OperationContext* opCtx,
-                                   StringData ns,
-                                   RecordId* out ) const {
-
-        std::unique_ptr<Lock::ResourceLock> rLk;
-        if (!_isRsThreadSafe && opCtx->lockState()) {
-            rLk.reset(new Lock::ResourceLock(opCtx->lockState(),
-                                             resourceIdCatalogMetadata,
-                                             MODE_S));
-        }
-
-        RecordId dl;
-        {
-            boost::lock_guard<boost::mutex> lk( _identsLock );
-            NSToIdentMap::const_iterator it = _idents.find( ns.toString() );
-            invariant( it != _idents.end() );
-            dl = it->second.storedLoc;
-        }
-
-        LOG(1) << "looking up metadata for: " << ns << " @ " << dl;
-        RecordData data;
-        if ( !_rs->findRecord( opCtx, dl, &data ) ) {
-            // since the in memory meta data isn't managed with mvcc
-            // its possible for different transactions to see slightly
-            // different things, which is ok via the locking above.
-            return BSONObj();
-        }
-
-        if (out)
-            *out = dl;
-
-        return data.releaseToBson().getOwned();
-    }
-
     const BSONCollectionCatalogEntry::MetaData KVCatalog::getMetaData( OperationContext* opCtx,
                                                                        StringData ns ) {
-        BSONObj obj = _findEntry( opCtx, ns );
-        LOG(3) << " fetched CCE metadata: " << obj;
-        BSONCollectionCatalogEntry::MetaData md;
-        const BSONElement mdElement = obj["md"];
-        if ( mdElement.isABSONObj() ) {
-            LOG(3) << "returning metadata: " << mdElement;
-            md.parse( mdElement.Obj() );
-        }
-        return md;
+        EntryPtr entry = _findEntry( ns );
+        invariant( entry );
+        LOG(3) << "returning cached metadata for " << ns << ": " << entry->doc;
+        return entry->md;
     }
 
     void KVCatalog::putMetaData( OperationContext* opCtx,
@@ -272,8 +291,10 @@ namespace {
                                              MODE_X));
         }
 
-        RecordId loc;
-        BSONObj obj = _findEntry( opCtx, ns, &loc );
+        EntryPtr entry = _findEntry( ns );
+        invariant( entry );
+        const RecordId loc = entry->storedLoc;
+        BSONObj obj = entry->doc;
 
         {
             // rebuilt doc
@@ -312,6 +333,8 @@ namespace {
                                                         NULL );
         fassert( 28521, status.getStatus() );
         invariant( status.getValue() == loc );
+
+        _setEntry( opCtx, ns, std::make_shared<Entry>( obj, loc, md ) );
     }
 
     Status KVCatalog::renameCollection( OperationContext* opCtx,
@@ -326,15 +349,17 @@ namespace {
                                              MODE_X));
         }
 
-        RecordId loc;
-        BSONObj old = _findEntry( opCtx, fromNS, &loc ).getOwned();
+        EntryPtr entry = _findEntry( fromNS );
+        invariant( entry );
+        const RecordId loc = entry->storedLoc;
+        BSONObj old = entry->doc;
+        BSONObj obj;
+        BSONCollectionCatalogEntry::MetaData md = entry->md;
         {
             BSONObjBuilder b;
 
             b.append( "ns", toNS );
 
-            BSONCollectionCatalogEntry::MetaData md;
-            md.parse( old["md"].Obj() );
             md.rename( toNS );
             if ( !stayTemp )
                 md.options.temp = false;
@@ -342,7 +367,7 @@ namespace {
 
             b.appendElementsUnique( old );
 
-            BSONObj obj = b.obj();
+            obj = b.obj();
             StatusWith<RecordId> status = _rs->updateRecord( opCtx,
                                                             loc,
                                                             obj.objdata(),
@@ -353,15 +378,8 @@ namespace {
             invariant( status.getValue() == loc );
         }
 
-        boost::lock_guard<boost::mutex> lk( _identsLock );
-        const NSToIdentMap::iterator fromIt = _idents.find(fromNS.toString());
-        invariant(fromIt != _idents.end());
-
-        opCtx->recoveryUnit()->registerChange(new RemoveIdentChange(this, fromNS, fromIt->second));
-        opCtx->recoveryUnit()->registerChange(new AddIdentChange(this, toNS));
-
-        _idents.erase(fromIt);
-        _idents[toNS.toString()] = Entry( old["ident"].String(), loc );
+        _setEntry( opCtx, fromNS, EntryPtr() );
+        _setEntry( opCtx, toNS, std::make_shared<Entry>( obj, loc, md ) );
 
         return Status::OK();
     }
@@ -377,17 +395,14 @@ namespace {
                                              MODE_X));
         }
 
-        boost::lock_guard<boost::mutex> lk( _identsLock );
-        const NSToIdentMap::iterator it = _idents.find(ns.toString());
-        if (it == _idents.end()) {
+        EntryPtr entry = _findEntry( ns );
+        if ( !entry ) {
             return Status( ErrorCodes::NamespaceNotFound, "collection not found" );
         }
 
-        opCtx->recoveryUnit()->registerChange(new RemoveIdentChange(this, ns, it->second));
-
-        LOG(1) << "deleting metadata for " << ns << " @ " << it->second.storedLoc;
-        _rs->deleteRecord( opCtx, it->second.storedLoc );
-        _idents.erase(it);
+        LOG(1) << "deleting metadata for " << ns << " @ " << entry->storedLoc;
+        _rs->deleteRecord( opCtx, entry->storedLoc );
+        _setEntry( opCtx, ns, EntryPtr() );
 
         return Status::OK();
     }
@@ -395,13 +410,13 @@ namespace {
     std::vector<std::string> KVCatalog::getAllIdentsForDB( StringData db ) const {
         std::vector<std::string> v;
 
-        {
-            boost::lock_guard<boost::mutex> lk( _identsLock );
-            for ( NSToIdentMap::const_iterator it = _idents.begin(); it != _idents.end(); ++it ) {
+        for (size_t i = 0; i < kNumShards; i++) {
+            const std::shared_ptr<const NSToEntryMap> entries = _entries( _shards[i] );
+            for ( NSToEntryMap::const_iterator it = entries->begin(); it != entries->end(); ++it ) {
                 NamespaceString ns( it->first );
                 if ( ns.db() != db )
                     continue;
-                v.push_back( it->second.ident );
+                v.push_back( it->second->ident );
             }
         }
 
@@ -411,20 +426,22 @@ namespace {
     std::vector<std::string> KVCatalog::getAllIdents( OperationContext* opCtx ) const {
         std::vector<std::string> v;
 
-        auto cursor = _rs->getCursor(opCtx);
-        while (auto record = cursor->next()) {
-            BSONObj obj = record->data.releaseToBson();
-            v.push_back( obj["ident"].String() );
-
-            BSONElement e = obj["idxIdent"];
-            if ( !e.isABSONObj() )
-                continue;
-            BSONObj idxIdent = e.Obj();
-
-            BSONObjIterator sub( idxIdent );
-            while ( sub.more() ) {
-                BSONElement e = sub.next();
-                v.push_back( e.String() );
+        for (size_t i = 0; i < kNumShards; i++) {
+            const std::shared_ptr<const NSToEntryMap> entries = _entries( _shards[i] );
+            for ( NSToEntryMap::const_iterator it = entries->begin(); it != entries->end(); ++it ) {
+                const BSONObj& obj = it->second->doc;
+                v.push_back( it->second->ident );
+
+                BSONElement e = obj["idxIdent"];
+                if ( !e.isABSONObj() )
+                    continue;
+                BSONObj idxIdent = e.Obj();
+
+                BSONObjIterator sub( idxIdent );
+                while ( sub.more() ) {
+                    BSONElement e = sub.next();
+                    v.push_back( e.String() );
+                }
             }
         }
 
@@ -31,6 +31,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 
 #include <boost/thread/mutex.hpp>
@@ -39,12 +40,22 @@
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/bson_collection_catalog_entry.h"
+#include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 
     class OperationContext;
     class RecordStore;
 
+    /**
+     * Maps namespaces to the idents and metadata of their collections and indexes, which are
+     * stored as one document per collection in a RecordStore of the engine (_mdb_catalog).
+     *
+     * All of the documents are cached, with their metadata parsed, so that only writes go to the
+     * RecordStore. The cache is updated together with the RecordStore by every write, and put back
+     * if the unit of work rolls back. Readers never wait for writers: the cache is split into
+     * shards which are copied on write, so a reader just takes a reference to the current copy.
+     */
     class KVCatalog {
     public:
         /**
@@ -92,12 +103,54 @@ namespace mongo {
 
         bool isUserDataIdent( StringData ident ) const;
     private:
-        class AddIdentChange;
-        class RemoveIdentChange;
+        class EntryChange;
 
-        BSONObj _findEntry( OperationContext* opCtx,
-                            StringData ns,
-                            RecordId* out=NULL ) const;
+        /**
+         * The cached catalog document of a collection. Immutable once published.
+         */
+        struct Entry {
+            Entry( const BSONObj& d, RecordId l );
+            Entry( const BSONObj& d, RecordId l, const BSONCollectionCatalogEntry::MetaData& m );
+
+            const BSONObj doc; // owned
+            const RecordId storedLoc;
+            const std::string ident;
+            BSONCollectionCatalogEntry::MetaData md; // parsed from doc["md"]
+        };
+        typedef std::shared_ptr<const Entry> EntryPtr;
+        typedef std::map<std::string,EntryPtr> NSToEntryMap;
+
+        /**
+         * A part of the cache, for the namespaces which hash to it. Writers replace 'entries' with
+         * a modified copy, so that the entries a reader took stay unchanged.
+         */
+        struct Shard {
+            Shard() : entries(std::make_shared<NSToEntryMap>()) {}
+
+            boost::mutex writeMutex; // serializes writers of this shard
+            SpinLock lock; // only protects the 'entries' pointer itself
+            std::shared_ptr<const NSToEntryMap> entries;
+        };
+        enum { kNumShards = 64 };
+
+        Shard& _shardFor( StringData ns ) const;
+        std::shared_ptr<const NSToEntryMap> _entries( const Shard& shard ) const;
+
+        /**
+         * Returns the cached entry for 'ns', or NULL if there is no such collection.
+         */
+        EntryPtr _findEntry( StringData ns ) const;
+
+        /**
+         * Publishes 'entry' as the entry for 'ns', or removes it if NULL. Returns the entry it
+         * replaced.
+         */
+        EntryPtr _setEntry( StringData ns, EntryPtr entry );
+
+        /**
+         * Like _setEntry, and puts back the replaced entry if the unit of work rolls back.
+         */
+        void _setEntry( OperationContext* opCtx, StringData ns, EntryPtr entry );
 
         /**
          * Generates a new unique identifier for a new "thing".
@@ -119,16 +172,7 @@ namespace mongo {
         std::string _rand; // effectively const after init() returns
         AtomicUInt64 _next;
 
-        struct Entry {
-            Entry(){}
-            Entry( std::string i, RecordId l )
-                : ident(i), storedLoc( l ) {}
-            std::string ident;
-            RecordId storedLoc;
-        };
-        typedef std::map<std::string,Entry> NSToIdentMap;
-        NSToIdentMap _idents;
-        mutable boost::mutex _identsLock;
+        mutable Shard _shards[kNumShards];
     };
 
 }
@@ -30,7 +30,10 @@
 
 #include "mongo/db/storage/kv/kv_collection_catalog_entry.h"
 
+#include <boost/thread/locks.hpp>
+
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/operation_context_noop.h"
 #include "mongo/db/storage/kv/kv_catalog.h"
 #include "mongo/db/storage/kv/kv_engine.h"
 
@@ -89,7 +92,32 @@ namespace mongo {
           _engine( engine ),
           _catalog( catalog ),
           _ident( ident.toString() ),
-          _recordStore( rs ) {
+          _recordStore( rs ),
+          _openPending( false ) {
+    }
+
+    KVCollectionCatalogEntry::KVCollectionCatalogEntry( KVEngine* engine,
+                                                        KVCatalog* catalog,
+                                                        StringData ns,
+                                                        StringData ident )
+        : BSONCollectionCatalogEntry( ns ),
+          _engine( engine ),
+          _catalog( catalog ),
+          _ident( ident.toString() ),
+          _openPending( true ) {
+    }
+
+    void KVCollectionCatalogEntry::_openRecordStore() const {
+        boost::lock_guard<boost::mutex> lk( _openMutex );
+        if ( !_openPending.load() )
+            return;
+
+        // The caller may be in the middle of its own unit of work, so open with a separate one.
+        OperationContextNoop txn( _engine->newRecoveryUnit() );
+        MetaData md = _catalog->getMetaData( &txn, ns().toString() );
+        _recordStore.reset( _engine->getRecordStore( &txn, ns().toString(), _ident, md.options ) );
+        invariant( _recordStore );
+        _openPending.store( false );
     }
 
     KVCollectionCatalogEntry::~KVCollectionCatalogEntry() {
@@ -30,9 +30,12 @@
 
 #pragma once
 
+#include <boost/thread/mutex.hpp>
+
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/storage/bson_collection_catalog_entry.h"
 #include "mongo/db/storage/record_store.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -47,6 +50,15 @@ namespace mongo {
                                   StringData ident,
                                   RecordStore* rs );
 
+        /**
+         * Makes an entry whose RecordStore is only opened the first time getRecordStore() is
+         * called, so that startup does not pay for collections nobody uses (storageLazyOpen).
+         */
+        KVCollectionCatalogEntry( KVEngine* engine,
+                                  KVCatalog* catalog,
+                                  StringData ns,
+                                  StringData ident );
+
         ~KVCollectionCatalogEntry() final;
 
         int getMaxAllowedIndexes() const final { return 64; };
@@ -76,8 +88,17 @@ namespace mongo {
 
         void updateValidator(OperationContext* txn, const BSONObj& validator) final;
 
-        RecordStore* getRecordStore() { return _recordStore.get(); }
-        const RecordStore* getRecordStore() const { return _recordStore.get(); }
+        RecordStore* getRecordStore() {
+            if (_openPending.load())
+                _openRecordStore();
+            return _recordStore.get();
+        }
+
+        const RecordStore* getRecordStore() const {
+            if (_openPending.load())
+                _openRecordStore();
+            return _recordStore.get();
+        }
 
     protected:
         MetaData _getMetaData( OperationContext* txn ) const final;
@@ -86,10 +107,20 @@ namespace mongo {
         class AddIndexChange;
         class RemoveIndexChange;
 
+        /**
+         * Opens the RecordStore of a lazily opened entry. Safe to call from several threads.
+         */
+        void _openRecordStore() const;
+
         KVEngine* _engine; // not owned
         KVCatalog* _catalog; // not owned
         std::string _ident;
-        std::unique_ptr<RecordStore> _recordStore; // owned
+        mutable std::unique_ptr<RecordStore> _recordStore; // owned
+
+        // True until the RecordStore of a lazily opened entry is opened. _recordStore is only
+        // written under _openMutex, before this is cleared.
+        mutable AtomicWord<bool> _openPending;
+        mutable boost::mutex _openMutex;
     };
 
 }
@@ -235,10 +235,22 @@ namespace mongo {
     void KVDatabaseCatalogEntry::initCollection( OperationContext* opCtx,
                                                  const std::string& ns,
                                                  bool forRepair ) {
-        invariant(!_collections.count(ns));
+        initCollection(openCollection(opCtx, ns, forRepair, false));
+    }
 
+    KVCollectionCatalogEntry* KVDatabaseCatalogEntry::openCollection( OperationContext* opCtx,
+                                                                      const std::string& ns,
+                                                                      bool forRepair,
+                                                                      bool lazy ) const {
         const std::string ident = _engine->getCatalog()->getCollectionIdent( ns );
 
+        if (lazy && !forRepair) {
+            return new KVCollectionCatalogEntry( _engine->getEngine(),
+                                                 _engine->getCatalog(),
+                                                 ns,
+                                                 ident );
+        }
+
         RecordStore* rs;
         if (forRepair) {
             // Using a NULL rs since we don't want to open this record store before it has been
@@ -251,12 +263,19 @@ namespace mongo {
             invariant( rs );
         }
 
+        return new KVCollectionCatalogEntry( _engine->getEngine(),
+                                             _engine->getCatalog(),
+                                             ns,
+                                             ident,
+                                             rs );
+    }
+
+    void KVDatabaseCatalogEntry::initCollection( KVCollectionCatalogEntry* entry ) {
+        const std::string ns = entry->ns().toString();
+        invariant(!_collections.count(ns));
+
         // No change registration since this is only for committed collections
-        _collections[ns] = new KVCollectionCatalogEntry( _engine->getEngine(),
-                                                         _engine->getCatalog(),
-                                                         ns,
-                                                         ident,
-                                                         rs );
+        _collections[ns] = entry;
     }
 
     void KVDatabaseCatalogEntry::reinitCollectionAfterRepair(OperationContext* opCtx,
@@ -89,6 +89,22 @@ namespace mongo {
                              const std::string& ns,
                              bool forRepair );
 
+        /**
+         * Makes the entry for committed collection 'ns' without adding it to this database. Its
+         * RecordStore is opened now, when the first caller asks for it if 'lazy', or never if
+         * 'forRepair'. Does not modify this object, so startup calls it from several threads at
+         * once and then hands the results to initCollection() below one at a time.
+         */
+        KVCollectionCatalogEntry* openCollection( OperationContext* opCtx,
+                                                  const std::string& ns,
+                                                  bool forRepair,
+                                                  bool lazy ) const;
+
+        /**
+         * Takes ownership of 'entry', which must come from openCollection().
+         */
+        void initCollection( KVCollectionCatalogEntry* entry );
+
         void initCollectionBeforeRepair(OperationContext* opCtx, const std::string& ns);
         void reinitCollectionAfterRepair(OperationContext* opCtx, const std::string& ns);
 
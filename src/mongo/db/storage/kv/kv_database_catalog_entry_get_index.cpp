@@ -41,6 +41,7 @@
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index/s2_access_method.h"
+#include "mongo/db/index/summary_access_method.h"
 #include "mongo/db/storage/kv/kv_collection_catalog_entry.h"
 #include "mongo/db/storage/kv/kv_engine.h"
 #include "mongo/db/storage/kv/kv_storage_engine.h"
@@ -81,6 +82,9 @@ namespace mongo {
         if (IndexNames::GEO_2D == type)
             return new TwoDAccessMethod( index, sdi );
 
+        if (IndexNames::SUMMARY == type)
+            return new SummaryAccessMethod( index, sdi );
+
         log() << "Can't find index for keyPattern " << desc->keyPattern();
         invariant( false );
     }
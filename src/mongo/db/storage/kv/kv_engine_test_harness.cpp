@@ -34,6 +34,7 @@
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/storage/kv/kv_catalog.h"
+#include "mongo/db/storage/kv/kv_collection_catalog_entry.h"
 #include "mongo/db/storage/kv/kv_engine.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/sorted_data_interface.h"
@@ -408,5 +409,105 @@ namespace mongo {
 
     }
 
+    // The cached catalog entries are put back when a unit of work rolls back.
+    TEST( KVCatalogTest, Rollback ) {
+        unique_ptr<KVHarnessHelper> helper( KVHarnessHelper::create() );
+        KVEngine* engine = helper->getEngine();
+
+        unique_ptr<RecordStore> rs;
+        unique_ptr<KVCatalog> catalog;
+        {
+            MyOperationContext opCtx( engine );
+            WriteUnitOfWork uow( &opCtx );
+            ASSERT_OK( engine->createRecordStore( &opCtx, "catalog", "catalog", CollectionOptions() ) );
+            rs.reset( engine->getRecordStore( &opCtx, "catalog", "catalog", CollectionOptions() ) );
+            catalog.reset( new KVCatalog( rs.get(), true, false, false) );
+            uow.commit();
+        }
+
+        {
+            MyOperationContext opCtx( engine );
+            WriteUnitOfWork uow( &opCtx );
+            ASSERT_OK( catalog->newCollection( &opCtx, "a.b", CollectionOptions() ) );
+            ASSERT_OK( catalog->newCollection( &opCtx, "a.c", CollectionOptions() ) );
+            uow.commit();
+        }
+        const string ident = catalog->getCollectionIdent( "a.b" );
+
+        {
+            MyOperationContext opCtx( engine );
+            WriteUnitOfWork uow( &opCtx );
+            ASSERT_OK( catalog->newCollection( &opCtx, "a.d", CollectionOptions() ) );
+            ASSERT_OK( catalog->dropCollection( &opCtx, "a.c" ) );
+
+            BSONCollectionCatalogEntry::MetaData md;
+            md.ns = "a.b";
+            md.indexes.push_back( BSONCollectionCatalogEntry::IndexMetaData( BSON( "name" << "foo" ),
+                                                                             false,
+                                                                             RecordId(),
+                                                                             false ) );
+            catalog->putMetaData( &opCtx, "a.b", md );
+            ASSERT_EQUALS( 1U, catalog->getMetaData( &opCtx, "a.b" ).indexes.size() );
+
+            ASSERT_OK( catalog->renameCollection( &opCtx, "a.b", "a.e", false ) );
+            ASSERT_EQUALS( ident, catalog->getCollectionIdent( "a.e" ) );
+
+            std::vector<std::string> collections;
+            catalog->getAllCollections( &collections );
+            ASSERT_EQUALS( 2U, collections.size() );
+            ASSERT_EQUALS( "a.d", collections[0] );
+            ASSERT_EQUALS( "a.e", collections[1] );
+            // not committed
+        }
+
+        std::vector<std::string> collections;
+        catalog->getAllCollections( &collections );
+        ASSERT_EQUALS( 2U, collections.size() );
+        ASSERT_EQUALS( "a.b", collections[0] );
+        ASSERT_EQUALS( "a.c", collections[1] );
+        ASSERT_EQUALS( ident, catalog->getCollectionIdent( "a.b" ) );
+
+        MyOperationContext opCtx( engine );
+        ASSERT_EQUALS( 0U, catalog->getMetaData( &opCtx, "a.b" ).indexes.size() );
+        ASSERT_EQUALS( "a.b", catalog->getMetaData( &opCtx, "a.b" ).ns );
+    }
+
+
+    TEST( KVCatalogTest, LazyOpen ) {
+        unique_ptr<KVHarnessHelper> helper( KVHarnessHelper::create() );
+        KVEngine* engine = helper->getEngine();
+
+        unique_ptr<RecordStore> rs;
+        unique_ptr<KVCatalog> catalog;
+        {
+            MyOperationContext opCtx( engine );
+            WriteUnitOfWork uow( &opCtx );
+            ASSERT_OK( engine->createRecordStore( &opCtx, "catalog", "catalog", CollectionOptions() ) );
+            rs.reset( engine->getRecordStore( &opCtx, "catalog", "catalog", CollectionOptions() ) );
+            catalog.reset( new KVCatalog( rs.get(), true, false, false) );
+            uow.commit();
+        }
+
+        {
+            MyOperationContext opCtx( engine );
+            WriteUnitOfWork uow( &opCtx );
+            ASSERT_OK( catalog->newCollection( &opCtx, "a.b", CollectionOptions() ) );
+            const string ident = catalog->getCollectionIdent( "a.b" );
+            ASSERT_OK( engine->createRecordStore( &opCtx, "a.b", ident, CollectionOptions() ) );
+            unique_ptr<RecordStore> collRs( engine->getRecordStore( &opCtx, "a.b", ident,
+                                                                    CollectionOptions() ) );
+            ASSERT_OK( collRs->insertRecord( &opCtx, "abc", 4, false ).getStatus() );
+            uow.commit();
+        }
+
+        KVCollectionCatalogEntry entry( engine, catalog.get(), "a.b",
+                                        catalog->getCollectionIdent( "a.b" ) );
+        RecordStore* opened = entry.getRecordStore();
+        ASSERT( opened );
+        ASSERT_EQUALS( opened, entry.getRecordStore() );
+
+        MyOperationContext opCtx( engine );
+        ASSERT_EQUALS( 1, opened->numRecords( &opCtx ) );
+    }
 
 }
@@ -33,11 +33,14 @@
 #include "mongo/db/storage/kv/kv_storage_engine.h"
 
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/kv/kv_collection_catalog_entry.h"
 #include "mongo/db/storage/kv/kv_database_catalog_entry.h"
 #include "mongo/db/storage/kv/kv_engine.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -46,6 +49,40 @@ namespace mongo {
 
     namespace {
         const std::string catalogInfo = "_mdb_catalog";
+
+        /**
+         * A committed collection found in the catalog at startup, and what opening it produced.
+         */
+        struct CollectionToOpen {
+            std::string ns;
+            KVDatabaseCatalogEntry* db = nullptr;
+            KVCollectionCatalogEntry* entry = nullptr;
+            std::string error;
+        };
+
+        void openCollection(OperationContext* opCtx,
+                            CollectionToOpen* toOpen,
+                            bool forRepair,
+                            bool lazy) {
+            toOpen->entry = toOpen->db->openCollection(opCtx, toOpen->ns, forRepair, lazy);
+        }
+
+        void openCollectionTask(KVEngine* engine,
+                                CollectionToOpen* toOpen,
+                                bool forRepair,
+                                bool lazy) {
+            // ThreadPool only logs exceptions, so keep the error for the starting thread
+            try {
+                OperationContextNoop opCtx(engine->newRecoveryUnit());
+                openCollection(&opCtx, toOpen, forRepair, lazy);
+            }
+            catch (const DBException& e) {
+                toOpen->error = e.toString();
+            }
+            catch (const std::exception& e) {
+                toOpen->error = e.what();
+            }
+        }
     }
 
     class KVStorageEngine::RemoveDBChange : public RecoveryUnit::Change {
@@ -109,11 +146,18 @@ namespace mongo {
                                            _supportsDocLocking,
                                            _options.directoryPerDB,
                                            _options.directoryForIndexes) );
+            Timer catalogTimer;
             _catalog->init( &opCtx );
 
             std::vector<std::string> collections;
             _catalog->getAllCollections( &collections );
+            log() << "loaded the catalog of " << collections.size() << " collection(s) in "
+                  << catalogTimer.millis() << "ms";
 
+            // Creating the database entries changes _dbs, so that happens here. Opening the
+            // collections only reads the catalog and the engine, and is spread over
+            // startupThreads threads since each open may have to read the collection's files.
+            std::vector<CollectionToOpen> toOpen(collections.size());
             for ( size_t i = 0; i < collections.size(); i++ ) {
                 std::string coll = collections[i];
                 NamespaceString nss( coll );
@@ -125,7 +169,48 @@ namespace mongo {
                     db = new KVDatabaseCatalogEntry( dbName, this );
                 }
 
-                db->initCollection( &opCtx, coll, options.forRepair );
+                toOpen[i].ns = coll;
+                toOpen[i].db = db;
+            }
+
+            Timer openTimer;
+            const int nThreads =
+                std::min(std::max(options.startupThreads, 1), static_cast<int>(toOpen.size()));
+            if ( nThreads <= 1 || options.lazyOpen ) {
+                for ( size_t i = 0; i < toOpen.size(); i++ ) {
+                    openCollection( &opCtx, &toOpen[i], options.forRepair, options.lazyOpen );
+                }
+            }
+            else {
+                ThreadPool pool( nThreads, "storageStartup" );
+                for ( size_t i = 0; i < toOpen.size(); i++ ) {
+                    pool.schedule( &openCollectionTask,
+                                   _engine.get(),
+                                   &toOpen[i],
+                                   options.forRepair,
+                                   options.lazyOpen );
+                }
+                pool.join();
+            }
+
+            std::string firstError;
+            for ( size_t i = 0; i < toOpen.size(); i++ ) {
+                if ( toOpen[i].entry ) {
+                    toOpen[i].db->initCollection( toOpen[i].entry );
+                }
+                else if ( firstError.empty() ) {
+                    firstError = str::stream() << "failed to open collection " << toOpen[i].ns
+                                               << ": " << toOpen[i].error;
+                }
+            }
+            uassert( 28708, firstError, firstError.empty() );
+
+            if ( options.lazyOpen ) {
+                log() << "deferred opening " << toOpen.size() << " collection(s) until first use";
+            }
+            else {
+                log() << "opened " << toOpen.size() << " collection(s) in " << openTimer.millis()
+                      << "ms using " << std::max(nThreads, 1) << " thread(s)";
             }
 
             uow.commit();
@@ -136,6 +221,7 @@ namespace mongo {
         // now clean up orphaned idents
 
         {
+            Timer cleanupTimer;
             // get all idents
             std::set<std::string> allIdents;
             {
@@ -163,6 +249,8 @@ namespace mongo {
                 _engine->dropIdent( &opCtx, toRemove );
                 wuow.commit();
             }
+
+            LOG(1) << "checked for unused idents in " << cleanupTimer.millis() << "ms";
         }
 
     }
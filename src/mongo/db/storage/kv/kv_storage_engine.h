@@ -49,11 +49,20 @@ namespace mongo {
         KVStorageEngineOptions() :
             directoryPerDB(false),
             directoryForIndexes(false),
-            forRepair(false) {}
+            forRepair(false),
+            startupThreads(1),
+            lazyOpen(false) {}
 
         bool directoryPerDB;
         bool directoryForIndexes;
         bool forRepair;
+
+        // Number of threads which open the collections at startup.
+        int startupThreads;
+
+        // Whether the RecordStores of the collections are opened on first use rather than at
+        // startup.
+        bool lazyOpen;
     };
 
     class KVStorageEngine : public StorageEngine {
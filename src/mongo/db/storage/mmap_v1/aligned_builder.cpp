@@ -32,6 +32,11 @@
 
 #include "mongo/db/storage/mmap_v1/aligned_builder.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
 
@@ -125,8 +130,33 @@ namespace mongo {
         _realloc(newSize, oldLen);
     }
 
+    bool AlignedBuilder::_mallocHugeTLB(unsigned sz) {
+#if defined(__linux__) && defined(MAP_HUGETLB)
+        void *p = mmap(0, sz, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if ( p == MAP_FAILED ) {
+            LOG(1) << "no huge pages for a journal buffer of " << sz << " bytes: "
+                   << errnoWithDescription();
+            return false;
+        }
+        _p._allocationAddress = p;
+        _p._data = (char *) p;
+        _p._hugeTLB = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
     void AlignedBuilder::_malloc(unsigned sz) {
         _p._size = sz;
+        _p._hugeTLB = false;
+
+        // Journal buffers are sized in multiples of 32MB, so the large ones fill whole huge pages
+        const bool huge = MmapHugePages::policy != MmapHugePages::Off &&
+                          sz % MmapHugePages::kPageSize == 0;
+        if ( huge && MmapHugePages::policy == MmapHugePages::HugeTLB && _mallocHugeTLB(sz) ) {
+            return;
+        }
 #if defined(_WIN32)
         void *p = VirtualAlloc(0, sz, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
         _p._allocationAddress = p;
@@ -135,10 +165,13 @@ namespace mongo {
         // in theory #ifdef _POSIX_VERSION should work, but it doesn't on OS X 10.4, and needs to be tested on solaris.
         // so for now, linux only for this.
         void *p = 0;
-        int res = posix_memalign(&p, Alignment, sz);
+        int res = posix_memalign(&p, huge ? MmapHugePages::kPageSize : Alignment, sz);
         massert(13524, "out of memory AlignedBuilder", res == 0);
         _p._allocationAddress = p;
         _p._data = (char *) p;
+        if ( huge ) {
+            adviseHugePages(p, sz);
+        }
 #else
         mallocSelfAligned(sz);
         verify( ((size_t) _p._data) % Alignment == 0 );
@@ -151,21 +184,28 @@ namespace mongo {
         _malloc(newSize);
         verify( oldLen <= _len );
         memcpy(_p._data, old._data, oldLen);
-        _free(old._allocationAddress);
+        _free(old);
     }
 
-    void AlignedBuilder::_free(void *p) {
+    void AlignedBuilder::_free(const AllocationInfo& a) {
 #if defined(_WIN32)
-        VirtualFree(p, 0, MEM_RELEASE);
+        VirtualFree(a._allocationAddress, 0, MEM_RELEASE);
 #else
-        free(p);
+#if defined(__linux__)
+        if ( a._hugeTLB ) {
+            munmap(a._allocationAddress, a._size);
+            return;
+        }
+#endif
+        free(a._allocationAddress);
 #endif
     }
 
     void AlignedBuilder::kill() {
-        _free(_p._allocationAddress);
+        _free(_p);
         _p._allocationAddress = 0;
         _p._data = 0;
+        _p._hugeTLB = false;
     }
 
 }
@@ -123,13 +123,18 @@ namespace mongo {
         void mallocSelfAligned(unsigned sz);
         void _malloc(unsigned sz);
         void _realloc(unsigned newSize, unsigned oldLenInUse);
-        void _free(void*);
+
+        /** maps a buffer from the hugetlbfs pool, see MmapHugePages. @return false if it can't */
+        bool _mallocHugeTLB(unsigned sz);
 
         struct AllocationInfo {
             char *_data;
             void *_allocationAddress;
             unsigned _size;
+            bool _hugeTLB; // mapped by _mallocHugeTLB rather than allocated
         } _p;
+
+        void _free(const AllocationInfo& a);
         unsigned _len;  // bytes in use
     };
 
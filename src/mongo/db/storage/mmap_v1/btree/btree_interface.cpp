@@ -54,6 +54,10 @@ namespace {
             return _builder->addKey(key, DiskLoc::fromRecordId(loc));
         }
 
+        void commit(bool mayInterrupt) {
+            _builder->commit(mayInterrupt);
+        }
+
     private:
         std::unique_ptr<typename BtreeLogic<OnDiskFormat>::Builder> _builder;
 
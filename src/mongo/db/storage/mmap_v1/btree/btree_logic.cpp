@@ -32,6 +32,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/btree/btree_logic.h"
 #include "mongo/db/storage/mmap_v1/btree/key.h"
 #include "mongo/db/storage/mmap_v1/diskloc.h"
@@ -52,6 +53,10 @@ namespace mongo {
     using std::stringstream;
     using std::vector;
 
+    // How many of the buckets an index scan is about to move into are requested ahead of time
+    // whenever it climbs back up to a parent bucket. 0 turns read-ahead off for index scans.
+    MONGO_EXPORT_SERVER_PARAMETER(mmapv1IndexReadAheadBuckets, int, 8);
+
     // BtreeLogic::Builder algorithm
     //
     // Phase 1:
@@ -62,9 +67,15 @@ namespace mongo {
     //   nextChild pointer of the bucket to the prevChild of the popped key), add the popped key to
     //   a parent bucket, and create a new right sibling bucket to add the new key to. If the parent
     //   bucket is full, this same operation is performed on the parent and all full ancestors. If
-    //   we get to the root and it is full, a new root is created above the current root. When
-    //   creating a new right sibling, it is set as its parent's nextChild as all keys in the right
-    //   sibling will be higher than all keys currently in the parent.
+    //   we get to the root and it is full, a new root is created above the current root.
+    //
+    //   Only the right-most bucket of each level ever changes, so those are kept in memory. A
+    //   bucket is written to disk, with one write intent for the whole bucket, when it is done:
+    //   when its highest key has been moved up and the parent which took that key is known.
+    //
+    // Phase 3 (commit):
+    //   Write out the right-most bucket of every level. Each is its parent's nextChild, as all
+    //   keys in it are higher than all keys in the parent. The highest one becomes the head.
 
     //
     // Public Builder logic
@@ -87,30 +98,20 @@ namespace mongo {
         // The normal bulk building path calls initAsEmpty, so we already have an empty root bucket.
         // This isn't the case in some unit tests that use the Builder directly rather than going
         // through an IndexAccessMethod.
-        _rightLeafLoc = DiskLoc::fromRecordId(_logic->_headManager->getHead(txn));
-        if (_rightLeafLoc.isNull()) {
-            _rightLeafLoc = _logic->_addBucket(txn);
-            _logic->_headManager->setHead(_txn, _rightLeafLoc.toRecordId());
+        DiskLoc rootLoc = DiskLoc::fromRecordId(_logic->_headManager->getHead(txn));
+        if (rootLoc.isNull()) {
+            rootLoc = _logic->_addBucket(txn);
+            _logic->_headManager->setHead(_txn, rootLoc.toRecordId());
         }
 
         // must be empty when starting
-        invariant(_getBucket(_rightLeafLoc)->n == 0);
-    }
+        invariant(_getBucket(rootLoc)->n == 0);
 
-    template <class BtreeLayout>
-    class BtreeLogic<BtreeLayout>::Builder::SetRightLeafLocChange : public RecoveryUnit::Change {
-    public:
-        SetRightLeafLocChange(Builder* builder, DiskLoc oldLoc)
-            : _builder(builder)
-            , _oldLoc(oldLoc)
-        {}
-
-        virtual void commit() {}
-        virtual void rollback() { _builder->_rightLeafLoc = _oldLoc; }
-
-        Builder* _builder;
-        const DiskLoc _oldLoc;
-    };
+        // The empty root becomes the first leaf.
+        _pending.push_back(std::unique_ptr<PendingBucket>(new PendingBucket()));
+        _pending.back()->loc = rootLoc;
+        init(_pending.back()->bucket());
+    }
 
     template <class BtreeLayout>
     Status BtreeLogic<BtreeLayout>::Builder::addKey(const BSONObj& keyObj, const DiskLoc& loc) {
@@ -138,74 +139,89 @@ namespace mongo {
                 return Status(ErrorCodes::DuplicateKey, _logic->dupKeyError(*_keyLast));
             }
         }
-        
-        BucketType* rightLeaf = _getModifiableBucket(_rightLeafLoc);
-        if (!_logic->pushBack(rightLeaf, loc, *key, DiskLoc())) {
-            // bucket was full, so split and try with the new node.
-            _txn->recoveryUnit()->registerChange(new SetRightLeafLocChange(this, _rightLeafLoc));
-            _rightLeafLoc = newBucket(rightLeaf, _rightLeafLoc);
-            rightLeaf = _getModifiableBucket(_rightLeafLoc);
-            invariant(_logic->pushBack(rightLeaf, loc, *key, DiskLoc()));
-        }
+
+        addToLevel(0, loc, *key, DiskLoc());
 
         _keyLast = std::move(key);
         return Status::OK();
     }
 
+    template <class BtreeLayout>
+    void BtreeLogic<BtreeLayout>::Builder::commit(bool mayInterrupt) {
+        if (mayInterrupt) {
+            _txn->checkForInterrupt();
+        }
+
+        WriteUnitOfWork wunit(_txn);
+
+        // Every pending bucket is the right-most child of the pending bucket above it.
+        for (size_t level = 0; level < _pending.size(); level++) {
+            BucketType* bucket = _pending[level]->bucket();
+            if (level > 0) {
+                bucket->nextChild = _pending[level - 1]->loc;
+            }
+            if (level + 1 < _pending.size()) {
+                bucket->parent = _pending[level + 1]->loc;
+            }
+            writeBucket(_pending[level]->loc, bucket);
+        }
+
+        _logic->_headManager->setHead(_txn, _pending.back()->loc.toRecordId());
+        wunit.commit();
+    }
+
     //
     // Private Builder logic
     //
 
     template <class BtreeLayout>
-    DiskLoc BtreeLogic<BtreeLayout>::Builder::newBucket(BucketType* leftSib,
-                                                        DiskLoc leftSibLoc) {
-        invariant(leftSib->n >= 2); // Guaranteed by sufficiently small KeyMax.
-
-        if (leftSib->parent.isNull()) {
-            // Making a new root
-            invariant(leftSibLoc.toRecordId() == _logic->_headManager->getHead(_txn));
-            const DiskLoc newRootLoc = _logic->_addBucket(_txn);
-            leftSib->parent = newRootLoc;
-            _logic->_headManager->setHead(_txn, newRootLoc.toRecordId());
+    DiskLoc BtreeLogic<BtreeLayout>::Builder::addToLevel(size_t level,
+                                                         const DiskLoc& recordLoc,
+                                                         const KeyDataType& key,
+                                                         const DiskLoc& prevChild) {
+        if (level == _pending.size()) {
+            // Making a new root. It is only linked into the tree, and made the head, by commit().
+            _pending.push_back(std::unique_ptr<PendingBucket>(new PendingBucket()));
+            _pending.back()->loc = _logic->_addBucket(_txn);
+            init(_pending.back()->bucket());
+        }
 
-            // Set the newRoot's nextChild to point to leftSib for the invariant below.
-            BucketType* newRoot = _getBucket(newRootLoc);
-            *_txn->recoveryUnit()->writing(&newRoot->nextChild) = leftSibLoc;
+        if (!_logic->pushBack(_pending[level]->bucket(), recordLoc, key, prevChild)) {
+            // bucket was full, so finish it and try with the new one.
+            finishBucket(level);
+            invariant(_logic->pushBack(_pending[level]->bucket(), recordLoc, key, prevChild));
         }
 
-        DiskLoc parentLoc = leftSib->parent;
-        BucketType* parent = _getModifiableBucket(parentLoc);
+        return _pending[level]->loc;
+    }
 
-        // For the pushBack below to be correct, leftSib must be the right-most child of parent.
-        invariant(parent->nextChild == leftSibLoc);
+    template <class BtreeLayout>
+    void BtreeLogic<BtreeLayout>::Builder::finishBucket(size_t level) {
+        PendingBucket* pending = _pending[level].get();
+        BucketType* bucket = pending->bucket();
+        invariant(bucket->n >= 2); // Guaranteed by sufficiently small KeyMax.
 
-        // Pull right-most key out of leftSib and move to parent, splitting parent if necessary.
-        // Note that popBack() handles setting leftSib's nextChild to the former prevChildNode of
-        // the popped key.
+        // Pull the right-most key out of the bucket and move it up a level. popBack() sets the
+        // bucket's nextChild to the former prevChild of the popped key. The popped key still
+        // points into this bucket, so it has to be moved before the bucket is reused.
         KeyDataType key;
         DiskLoc val;
-        _logic->popBack(leftSib, &val, &key);
-        if (!_logic->pushBack(parent, val, key, leftSibLoc)) {
-            // parent is full, so split it.
-            parentLoc = newBucket(parent, parentLoc);
-            parent = _getModifiableBucket(parentLoc);
-            invariant(_logic->pushBack(parent, val, key, leftSibLoc));
-            leftSib->parent = parentLoc;
-        }
+        _logic->popBack(bucket, &val, &key);
+        bucket->parent = addToLevel(level + 1, val, key, pending->loc);
 
-        // Create a new bucket to the right of leftSib and set its parent pointer and the downward
-        // nextChild pointer from the parent.
-        DiskLoc newBucketLoc = _logic->_addBucket(_txn);
-        BucketType* newBucket = _getBucket(newBucketLoc);
-        *_txn->recoveryUnit()->writing(&newBucket->parent) = parentLoc;
-        *_txn->recoveryUnit()->writing(&parent->nextChild) = newBucketLoc;
-        return newBucketLoc;
+        writeBucket(pending->loc, bucket);
+
+        pending->loc = _logic->_addBucket(_txn);
+        init(bucket);
     }
 
     template <class BtreeLayout>
-    typename BtreeLogic<BtreeLayout>::BucketType*
-    BtreeLogic<BtreeLayout>::Builder::_getModifiableBucket(DiskLoc loc) {
-        return _logic->btreemod(_txn, _logic->getBucket(_txn, loc));
+    void BtreeLogic<BtreeLayout>::Builder::writeBucket(const DiskLoc& loc,
+                                                       const BucketType* bucket) {
+        BucketType* onDisk = _getBucket(loc);
+        memcpy(_txn->recoveryUnit()->writingPtr(onDisk, BtreeLayout::BucketSize),
+               bucket,
+               BtreeLayout::BucketSize);
     }
 
     template <class BtreeLayout>
@@ -2256,6 +2272,7 @@ namespace mongo {
             for (int i = 0; i < an->n; i++) {
                 if (childLocForPos(an, i + adj) == childLoc) {
                     *posInOut = i;
+                    readAheadChildren(an, i, direction);
                     return ancestor;
                 }
             }
@@ -2268,6 +2285,34 @@ namespace mongo {
         return DiskLoc();
     }
 
+    template <class BtreeLayout>
+    void BtreeLogic<BtreeLayout>::readAheadChildren(BucketType* bucket,
+                                                    int pos,
+                                                    int direction) const {
+        // From key 'pos' of 'bucket', a scan descends into the children on its side of 'pos',
+        // one after the other. These are usually leaves, which are where index scans fault.
+        const int nBuckets = mmapv1IndexReadAheadBuckets;
+        if (direction > 0) {
+            const int last = std::min<int>(bucket->n, pos + nBuckets);
+            for (int i = pos + 1; i <= last; i++) {
+                readAheadBucket(childLocForPos(bucket, i));
+            }
+        }
+        else {
+            const int last = std::max(0, pos - nBuckets + 1);
+            for (int i = pos; i >= last; i--) {
+                readAheadBucket(childLocForPos(bucket, i));
+            }
+        }
+    }
+
+    template <class BtreeLayout>
+    void BtreeLogic<BtreeLayout>::readAheadBucket(const DiskLoc& loc) const {
+        if (!loc.isNull()) {
+            _recordStore->readAhead(loc.toRecordId(), BtreeLayout::BucketSize);
+        }
+    }
+
     template <class BtreeLayout>
     bool BtreeLogic<BtreeLayout>::keyIsUsed(OperationContext* txn,
                                             const DiskLoc& loc,
@@ -99,27 +99,57 @@ namespace mongo {
 
             Status addKey(const BSONObj& key, const DiskLoc& loc);
 
+            /**
+             * Writes out the right-most bucket of every level and makes the highest one the root.
+             * Must be called, outside of any WriteUnitOfWork, once all keys have been added.
+             */
+            void commit(bool mayInterrupt);
+
         private:
             friend class BtreeLogic;
 
-            class SetRightLeafLocChange;
+            /**
+             * The right-most bucket of one level of the tree, which is the only bucket of that
+             * level still receiving keys. It is filled in memory and written to its on-disk bucket
+             * with a single write intent once it is complete, rather than declaring the whole
+             * bucket as written on every key.
+             */
+            struct PendingBucket {
+                DiskLoc loc;
+                char data[BtreeLayout::BucketSize];
+
+                BucketType* bucket() { return reinterpret_cast<BucketType*>(data); }
+            };
 
             Builder(BtreeLogic* logic, OperationContext* txn, bool dupsAllowed);
 
             /**
-             * Creates and returns a new empty bucket to the right of leftSib, maintaining the
-             * internal consistency of the tree. leftSib must be the right-most child of its parent
-             * or it must be the root.
+             * Appends a key to the pending bucket of 'level', starting a new bucket on that level
+             * if it is full and a new level above the current root if there is none.
+             *
+             * Returns the location of the bucket which received the key.
              */
-            DiskLoc newBucket(BucketType* leftSib, DiskLoc leftSibLoc);
+            DiskLoc addToLevel(size_t level,
+                               const DiskLoc& recordLoc,
+                               const KeyDataType& key,
+                               const DiskLoc& prevChild);
+
+            /**
+             * Moves the highest key of the full pending bucket of 'level' up a level, writes the
+             * bucket out and replaces it with a new empty one.
+             */
+            void finishBucket(size_t level);
+
+            void writeBucket(const DiskLoc& loc, const BucketType* bucket);
 
-            BucketType* _getModifiableBucket(DiskLoc loc);
             BucketType* _getBucket(DiskLoc loc);
 
             // Not owned.
             BtreeLogic* _logic;
 
-            DiskLoc _rightLeafLoc; // DiskLoc of right-most (highest) leaf bucket.
+            // The pending bucket of every level, leaves first. The last one is the root.
+            std::vector<std::unique_ptr<PendingBucket>> _pending;
+
             bool _dupsAllowed;
             std::unique_ptr<KeyDataOwnedType> _keyLast;
 
@@ -390,6 +420,14 @@ namespace mongo {
                         int* posInOut,
                         int direction) const;
 
+        /**
+         * Asks the record store to read ahead the children of 'bucket' which a scan in
+         * 'direction' positioned at key 'pos' will visit next.
+         */
+        void readAheadChildren(BucketType* bucket, int pos, int direction) const;
+
+        void readAheadBucket(const DiskLoc& loc) const;
+
         DiskLoc _locate(OperationContext* txn,
                         const DiskLoc& bucketLoc,
                         const KeyDataType& key,
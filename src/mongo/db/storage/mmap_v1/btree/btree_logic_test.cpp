@@ -2086,6 +2086,41 @@ namespace mongo {
     };
 
 
+    template<class OnDiskFormat>
+    class BuilderMultiLevel : public BtreeLogicTestBase<OnDiskFormat> {
+    public:
+        void run() {
+            typedef typename BtreeLogic<OnDiskFormat>::Builder Builder;
+
+            OperationContextNoop txn;
+            this->_helper.btree.initAsEmpty(&txn);
+
+            // Large keys, so that there are several levels of interior buckets above the leaves.
+            const int nKeys = 2000;
+            std::unique_ptr<Builder> builder(this->_helper.btree.newBuilder(&txn, false));
+            for (int i = 0; i < nKeys; i++) {
+                const BSONObj k = BSON("" << bigNumString(i, 800));
+                ASSERT_OK(builder->addKey(k, this->_helper.dummyDiskLoc));
+            }
+            builder->commit(false);
+
+            // Strict validation also checks the parent pointer of every bucket.
+            this->checkValidNumKeys(nKeys);
+            ASSERT(this->head()->parent.isNull());
+            ASSERT(!this->head()->nextChild.isNull());
+            ASSERT(!this->child(this->head(), this->head()->n)->nextChild.isNull());
+
+            for (int i = 0; i < nKeys; i += 97) {
+                const BSONObj k = BSON("" << bigNumString(i, 800));
+                int pos;
+                DiskLoc loc;
+                ASSERT(this->_helper.btree.locate(&txn, k, this->_helper.dummyDiskLoc, 1,
+                                                  &pos, &loc));
+            }
+        }
+    };
+
+
     /* This test requires the entire server to be linked-in and it is better implemented using
        the JS framework. Disabling here and will put in jsCore.
 
@@ -2315,6 +2350,7 @@ namespace mongo {
             add< LocateEmptyReverse<OnDiskFormat> >();
 
             add< DuplicateKeys<OnDiskFormat> >();
+            add< BuilderMultiLevel<OnDiskFormat> >();
         }
     };
 
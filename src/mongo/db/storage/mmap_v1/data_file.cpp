@@ -38,12 +38,14 @@
 #include <utility>
 #include <vector>
 
+#include "mongo/db/curop.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/storage/mmap_v1/durable_mapped_file.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/storage/mmap_v1/file_allocator.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -178,10 +180,14 @@ namespace {
         {
             invariant(_mb == 0);
             unsigned long long sz = size;
+            Timer t;
             if (mmf.create(filename, sz, false)) {
                 _mb = mmf.getView();
             }
 
+            // Unless the file was preallocated, this waited for the FileAllocator to make it.
+            CurOp::get(txn)->debug().fileAllocationMicros += t.micros();
+
             invariant(sz <= 0x7fffffff);
             size = (int)sz;
         }
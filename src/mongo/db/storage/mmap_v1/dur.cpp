@@ -83,6 +83,7 @@
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/aligned_builder.h"
 #include "mongo/db/storage/mmap_v1/durable_mapped_file.h"
 #include "mongo/db/storage/mmap_v1/dur_commitjob.h"
@@ -133,12 +134,18 @@ namespace {
         // How many commit cycles to do before considering doing a remap
         NumCommitsBeforeRemap = 10,
 
-        // How many outstanding journal flushes should be allowed before applying writer back
-        // pressure. Size of 1 allows two journal blocks to be in the process of being written -
-        // one on the journal writer's buffer and one blocked waiting to be picked up.
-        NumAsyncJournalWrites = 1,
+        // How many journal buffers there are, which bounds how many commits can be in progress
+        // before applying writer back pressure. Three buffers let a commit be prepared while the
+        // previous one is being written to the journal and the one before that is being applied
+        // to the shared view. Each buffer is as large as the biggest commit it has held (up to
+        // 128MB), so 32-bit builds keep a single one and do the three stages in turn.
+        NumAsyncJournalWrites = (sizeof(void*) == 4) ? 1 : 3,
     };
 
+    // Number of threads waiting for the journal (j:true) at which the durability thread starts a
+    // group commit right away, instead of at its next periodic check. 0 disables this.
+    MONGO_EXPORT_SERVER_PARAMETER(journalEarlyCommitWaiters, int, 4);
+
     // Remap loop state
     unsigned remapFileToStartAt;
 
@@ -453,7 +460,7 @@ namespace {
            << _journaledBytes / 1000000.0 << '\t'
            << _writeToDataFilesBytes / 1000000.0 << '\t'
            << _commitsInWriteLock << '\t'
-           << 0 << '\t'
+           << _earlyCommits << '\t'
            << (unsigned) (_prepLogBufferMicros / 1000) << '\t'
            << (unsigned) (_writeToJournalMicros / 1000) << '\t'
            << (unsigned) (_writeToDataFilesMicros / 1000) << '\t'
@@ -471,9 +478,11 @@ namespace {
           << "writeToDataFilesMB" << _writeToDataFilesBytes / 1000000.0
           << "compression" << _journaledBytes / (_uncompressedBytes + 1.0)
           << "commitsInWriteLock" << _commitsInWriteLock
-          << "earlyCommits" << 0
+          << "earlyCommits" << _earlyCommits
           << "timeMs" << BSON("dt" << _durationMillis <<
                               "prepLogBuffer" << (unsigned) (_prepLogBufferMicros / 1000) <<
+                              "waitForJournalBuffer"
+                                    << (unsigned) (_waitForJournalBufferMicros / 1000) <<
                               "writeToJournal" << (unsigned) (_writeToJournalMicros / 1000) <<
                               "writeToDataFiles" << (unsigned) (_writeToDataFilesMicros / 1000) <<
                               "remapPrivateView" << (unsigned) (_remapPrivateViewMicros / 1000) <<
@@ -521,6 +530,14 @@ namespace {
     }
 
     bool DurableImpl::waitUntilDurable() {
+        // Once this many writers are waiting, having them wait for more to join the group commit
+        // costs more latency than the batching saves.
+        const int earlyCommitWaiters = journalEarlyCommitWaiters;
+        if (earlyCommitWaiters > 0 &&
+                commitNotify.nWaiting() + 1 >= static_cast<unsigned>(earlyCommitWaiters)) {
+            flushRequested.notify_one();
+        }
+
         commitNotify.awaitBeyondNow();
         return true;
     }
@@ -699,6 +716,8 @@ namespace {
             try {
                 boost::unique_lock<boost::mutex> lock(flushMutex);
 
+                // Whether the commit starts before the full commit interval has passed
+                bool earlyCommit = true;
                 for (unsigned i = 0; i <= 2; i++) {
                     if (boost::cv_status::no_timeout == flushRequested.wait_for(
                                 lock, Milliseconds(oneThird))) {
@@ -706,6 +725,12 @@ namespace {
                         break;
                     }
 
+                    if (i == 2) {
+                        // The whole commit interval has passed
+                        earlyCommit = false;
+                        break;
+                    }
+
                     if (commitNotify.nWaiting()) {
                         // One or more getLastError j:true is pending
                         break;
@@ -745,8 +770,12 @@ namespace {
                     journalWriter.writeBuffer(buffer, commitNumber);
                 }
                 else {
-                    // This copies all the in-memory changes into the journal writer's buffer.
+                    // This blocks if all buffers are still being written or applied.
+                    Timer bufferTimer;
                     JournalWriter::Buffer* const buffer = journalWriter.newBuffer();
+                    stats.curr()->_waitForJournalBufferMicros += bufferTimer.micros();
+
+                    // This copies all the in-memory changes into the journal writer's buffer.
                     PREPLOGBUFFER(buffer->getHeader(), buffer->getBuilder());
 
                     estimatedPrivateMapSize += commitJob.bytes();
@@ -842,6 +871,9 @@ namespace {
 
                 stats.curr()->_commits++;
                 stats.curr()->_commitsMicros += t.micros();
+                if (earlyCommit) {
+                    stats.curr()->_earlyCommits++;
+                }
 
                 LOG(4) << "groupCommit end";
             }
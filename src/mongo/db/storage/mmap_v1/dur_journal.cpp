@@ -748,7 +748,17 @@ namespace mongo {
 
             {
                 dassert( h.sectionLen() == (unsigned) 0xffffffff ); // we will backfill later
-                b.appendStruct(h);
+                JSectHeader header = h;
+
+                // The section may have been prepared while the previous one was still being
+                // written, and that write may have rotated the journal file since. Recovery stops
+                // reading a file at a section with another file's id, so use the file this section
+                // is actually going to. Only this thread rotates the file.
+                {
+                    SimpleMutex::scoped_lock lk(_curLogFileMutex);
+                    header.fileId = _curFileId;
+                }
+                b.appendStruct(header);
             }
 
             size_t compressedLength = 0;
@@ -69,11 +69,45 @@ namespace {
         LOG(4) << "journal WRITETODATAFILES " << m / 1000.0 << "ms";
     }
 
+    /**
+     * Runs the loop of one of the journal threads. An exception escaping either of them leaves the
+     * journal in an unknown state, so it terminates the process.
+     */
+    void runJournalThreadLoop(const char* threadName, const stdx::function<void()>& loop) {
+        try {
+            loop();
+        }
+        catch (const DBException& e) {
+            severe() << "dbexception in " << threadName << " causing immediate shutdown: "
+                     << e.toString();
+            invariant(false);
+        }
+        catch (const std::ios_base::failure& e) {
+            severe() << "ios_base exception in " << threadName << " causing immediate shutdown: "
+                     << e.what();
+            invariant(false);
+        }
+        catch (const std::bad_alloc& e) {
+            severe() << "bad_alloc exception in " << threadName << " causing immediate shutdown: "
+                     << e.what();
+            invariant(false);
+        }
+        catch (const std::exception& e) {
+            severe() << "exception in " << threadName << " causing immediate shutdown: "
+                     << e.what();
+            invariant(false);
+        }
+        catch (...) {
+            severe() << "unhandled exception in " << threadName << " causing immediate shutdown";
+            invariant(false);
+        }
+    }
+
 } // namespace
 
 
     /**
-     * Used inside the journal writer thread to ensure that used buffers are cleaned up properly.
+     * Used inside the apply thread to ensure that used buffers are cleaned up properly.
      */
     class BufferGuard {
         MONGO_DISALLOW_COPYING(BufferGuard);
@@ -117,14 +151,17 @@ namespace {
           _shutdownRequested(false),
           _journalQueue(numBuffers),
           _lastCommitNumber(0),
+          _applyQueue(numBuffers),
           _readyQueue(numBuffers) {
 
         invariant(_journalQueue.maxSize() == _readyQueue.maxSize());
+        invariant(_applyQueue.maxSize() == _readyQueue.maxSize());
     }
 
     JournalWriter::~JournalWriter() {
         // Never close the journal writer with outstanding or unaccounted writes
         invariant(_journalQueue.empty());
+        invariant(_applyQueue.empty());
         invariant(_readyQueue.empty());
     }
 
@@ -137,7 +174,10 @@ namespace {
             _readyQueue.push(new Buffer(InitialBufferSizeBytes));
         }
 
-        // Start the thread
+        // Start the threads
+        boost::thread applyThread(stdx::bind(&JournalWriter::_applyThread, this));
+        _applyThreadHandle.swap(applyThread);
+
         boost::thread t(stdx::bind(&JournalWriter::_journalWriterThread, this));
         _journalWriterThreadHandle.swap(t);
     }
@@ -153,12 +193,14 @@ namespace {
         Buffer* const shutdownBuffer = newBuffer();
         shutdownBuffer->_setShutdown();
 
-        // This will terminate the journal thread. No need to specify commit number, since we are
-        // shutting down and nothing will be notified anyways.
+        // This will terminate the journal thread, which passes it on to terminate the apply thread.
+        // No need to specify commit number, since we are shutting down and nothing will be
+        // notified anyways.
         writeBuffer(shutdownBuffer, 0);
 
-        // Ensure the journal thread has stopped and everything accounted for.
+        // Ensure both threads have stopped and everything accounted for.
         _journalWriterThreadHandle.join();
+        _applyThreadHandle.join();
         assertIdle();
 
         // Delete the buffers (this deallocates the journal buffer memory)
@@ -171,6 +213,7 @@ namespace {
     void JournalWriter::assertIdle() {
         // All buffers are in the ready queue means there is nothing pending.
         invariant(_journalQueue.empty());
+        invariant(_applyQueue.empty());
         invariant(_readyQueue.count() == _readyQueue.maxSize());
     }
 
@@ -211,74 +254,75 @@ namespace {
 
         log() << "Journal writer thread started";
 
-        try {
+        runJournalThreadLoop("journalWriterThread", [this] {
             while (true) {
                 Buffer* const buffer = _journalQueue.blockingPop();
-                BufferGuard bufferGuard(buffer, &_readyQueue);
 
                 if (buffer->_isShutdown) {
                     invariant(buffer->_builder.len() == 0);
 
-                    // The journal writer thread is terminating. Nothing to notify or write.
+                    // The journal writer thread is terminating. Nothing to notify or write, but
+                    // the apply thread has to terminate too, once it has applied everything before.
+                    _applyQueue.push(buffer);
                     break;
                 }
 
                 if (buffer->_isNoop) {
                     invariant(buffer->_builder.len() == 0);
-
-                    // There's nothing to be writen, but we still need to notify this commit number
-                    _commitNotify->notifyAll(buffer->_commitNumber);
-                    _applyToDataFilesNotify->notifyAll(buffer->_commitNumber);
-                    continue;
                 }
-
-                LOG(4) << "Journaling commit number " << buffer->_commitNumber
-                       << " (journal file " << buffer->_header.fileId
-                       << ", sequence " << buffer->_header.seqNumber
-                       << ", size " << buffer->_builder.len() << " bytes)";
-
-                // This performs synchronous I/O to the journal file and will block.
-                WRITETOJOURNAL(buffer->_header, buffer->_builder);
+                else {
+                    LOG(4) << "Journaling commit number " << buffer->_commitNumber
+                           << " (journal file " << buffer->_header.fileId
+                           << ", sequence " << buffer->_header.seqNumber
+                           << ", size " << buffer->_builder.len() << " bytes)";
+
+                    // This performs synchronous I/O to the journal file and will block.
+                    WRITETOJOURNAL(buffer->_header, buffer->_builder);
+                }
 
                 // Data is now persisted in the journal, which is sufficient for acknowledging
                 // getLastError
                 _commitNotify->notifyAll(buffer->_commitNumber);
 
-                // Apply the journal entries on top of the shared view so that when flush is
-                // requested it would write the latest.
-                WRITETODATAFILES(buffer->_header, buffer->_builder);
+                // Noop buffers also go through the apply thread, so that their notification is
+                // ordered after the application of all buffers before them. This never blocks,
+                // because there are no more buffers than the apply queue can hold.
+                invariant(_applyQueue.count() < _applyQueue.maxSize());
+                _applyQueue.push(buffer);
+            }
+        });
+
+        log() << "Journal writer thread stopped";
+    }
+
+    void JournalWriter::_applyThread() {
+        Client::initThread("journal apply");
+
+        log() << "Journal apply thread started";
+
+        runJournalThreadLoop("journalApplyThread", [this] {
+            while (true) {
+                Buffer* const buffer = _applyQueue.blockingPop();
+                BufferGuard bufferGuard(buffer, &_readyQueue);
+
+                if (buffer->_isShutdown) {
+                    // The shutdown buffer is the last one, so everything has been applied.
+                    break;
+                }
+
+                if (!buffer->_isNoop) {
+                    // Apply the journal entries on top of the shared view so that when flush is
+                    // requested it would write the latest.
+                    WRITETODATAFILES(buffer->_header, buffer->_builder);
+                }
 
                 // Data is now persisted on the shared view, so notify any potential journal file
                 // cleanup waiters.
                 _applyToDataFilesNotify->notifyAll(buffer->_commitNumber);
             }
-        }
-        catch (const DBException& e) {
-            severe() << "dbexception in journalWriterThread causing immediate shutdown: "
-                     << e.toString();
-            invariant(false);
-        }
-        catch (const std::ios_base::failure& e) {
-            severe() << "ios_base exception in journalWriterThread causing immediate shutdown: "
-                     << e.what();
-            invariant(false);
-        }
-        catch (const std::bad_alloc& e) {
-            severe() << "bad_alloc exception in journalWriterThread causing immediate shutdown: "
-                     << e.what();
-            invariant(false);
-        }
-        catch (const std::exception& e) {
-            severe() << "exception in journalWriterThread causing immediate shutdown: "
-                     << e.what();
-            invariant(false);
-        }
-        catch (...) {
-            severe() << "unhandled exception in journalWriterThread causing immediate shutdown";
-            invariant(false);
-        }
+        });
 
-        log() << "Journal writer thread stopped";
+        log() << "Journal apply thread stopped";
     }
 
 
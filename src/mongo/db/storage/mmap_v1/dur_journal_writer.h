@@ -40,9 +40,14 @@ namespace mongo {
 namespace dur {
 
     /**
-     * Manages the thread and queues used for writing the journal to disk and notify parties with
+     * Manages the threads and queues used for writing the journal to disk and notify parties with
      * are waiting on the write concern.
      *
+     * Buffers go through two threads in turn: the journal writer thread writes them to the journal
+     * and the apply thread then applies them to the shared view. With enough buffers the caller
+     * can prepare one buffer while the previous one is being written and the one before that is
+     * being applied.
+     *
      * NOTE: Not thread-safe and must not be used from more than one thread.
      */
     class JournalWriter {
@@ -109,13 +114,13 @@ namespace dur {
         ~JournalWriter();
 
         /**
-         * Allocates buffer memory and starts the journal writer thread.
+         * Allocates buffer memory and starts the journal writer and apply threads.
          */
         void start();
 
         /**
-         * Terminates the journal writer thread and frees memory for the buffers. Must not be
-         * called if there are any pending journal writes.
+         * Terminates the journal writer and apply threads and frees memory for the buffers. Must
+         * not be called if there are any pending journal writes.
          */
         void shutdown();
 
@@ -147,7 +152,8 @@ namespace dur {
         void writeBuffer(Buffer* buffer, NotifyAll::When commitNumber);
 
         /**
-         * Ensures that all previously submitted write requests complete. This call is blocking.
+         * Ensures that all previously submitted write requests complete, including being applied
+         * to the shared view. This call is blocking.
          */
         void flush();
 
@@ -161,6 +167,7 @@ namespace dur {
 
 
         void _journalWriterThread();
+        void _applyThread();
 
 
         // This gets notified as journal buffers are written. It is not owned and needs to outlive
@@ -173,6 +180,9 @@ namespace dur {
         // Wraps and controls the journal writer thread
         boost::thread _journalWriterThreadHandle;
 
+        // Wraps and controls the thread, which applies written buffers to the shared view
+        boost::thread _applyThreadHandle;
+
         // Indicates that shutdown has been requested. Used for idempotency of the shutdown call.
         bool _shutdownRequested;
 
@@ -180,7 +190,11 @@ namespace dur {
         BufferQueue _journalQueue;
         NotifyAll::When _lastCommitNumber;
 
-        // Queue of buffers, whose write has been completed by the journal writer thread.
+        // Queue of buffers, which have been written to the journal and need to be applied to the
+        // shared view by the apply thread
+        BufferQueue _applyQueue;
+
+        // Queue of buffers, which have been both written and applied, and are free to be reused.
         BufferQueue _readyQueue;
     };
 
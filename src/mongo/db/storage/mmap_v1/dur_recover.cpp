@@ -40,6 +40,7 @@
 #include <sys/stat.h>
 
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/compress.h"
 #include "mongo/db/storage/mmap_v1/dur_commitjob.h"
 #include "mongo/db/storage/mmap_v1/dur_journal.h"
@@ -50,11 +51,13 @@
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/checksum.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/startup_test.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -78,6 +81,11 @@ namespace mongo {
      */
     class JournalSectionCorruptException {};
 
+    // Number of threads which apply the writes of a journal section during recovery. Writes to
+    // different data files are independent, so each file of a section gets its own worker. 1 or
+    // less applies everything on the recovering thread, as before.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalRecoveryThreads, int, 4);
+
     namespace dur {
 
         // The singleton recovery job object
@@ -255,7 +263,9 @@ namespace mongo {
         RecoveryJob::RecoveryJob()
             : _recovering(false),
               _lastDataSyncedFromLastRun(0),
-              _lastSeqMentionedInConsoleLog(1) {
+              _lastSeqMentionedInConsoleLog(1),
+              _sectionsApplied(0),
+              _bytesApplied(0) {
 
         }
 
@@ -321,16 +331,126 @@ namespace mongo {
 
             DurableMappedFile *mmf = last.newEntry(entry, *this);
 
+            const unsigned len = write(mmf, entry);
+            stats.curr()->_writeToDataFilesBytes += len;
+            if (_recovering) {
+                _bytesApplied += len;
+            }
+        }
+
+        /** @return the number of bytes written. touches no state, so it is safe in the workers */
+        unsigned RecoveryJob::write(DurableMappedFile* mmf, const ParsedJournalEntry& entry) {
             if ((entry.e->ofs + entry.e->len) <= mmf->length()) {
                 verify(mmf->view_write());
                 verify(entry.e->srcData());
 
                 void* dest = (char*)mmf->view_write() + entry.e->ofs;
                 memcpy(dest, entry.e->srcData(), entry.e->len);
-                stats.curr()->_writeToDataFilesBytes += entry.e->len;
+                return entry.e->len;
+            }
+
+            massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
+            return 0;
+        }
+
+        void RecoveryJob::applyFileWrites(FileWrites* fileWrites) {
+            DurableMappedFile* mmf = fileWrites->mmf;
+            const char* view = static_cast<const char*>(mmf->view_write());
+            const vector<const ParsedJournalEntry*>& entries = fileWrites->entries;
+
+            // After a crash the pages being written are usually not in memory. Hint the whole
+            // batch up front, merging nearby writes, so that the reads are issued together rather
+            // than one page fault at a time from the memcpy below.
+            const unsigned long long maxGap = 64 * 1024;
+            unsigned long long runStart = 0;
+            unsigned long long runEnd = 0;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                const unsigned long long ofs = entries[i]->e->ofs;
+                const unsigned long long end = ofs + entries[i]->e->len;
+                if (end > mmf->length()) {
+                    continue;
+                }
+                if (runEnd != 0 && ofs >= runStart && ofs <= runEnd + maxGap) {
+                    runEnd = std::max(runEnd, end);
+                    continue;
+                }
+                if (runEnd != 0) {
+                    prefetchMappedRange(view + runStart, runEnd - runStart);
+                }
+                runStart = ofs;
+                runEnd = end;
+            }
+            if (runEnd != 0) {
+                prefetchMappedRange(view + runStart, runEnd - runStart);
+            }
+
+            for (size_t i = 0; i < entries.size(); ++i) {
+                fileWrites->bytesWritten += write(mmf, *entries[i]);
+            }
+        }
+
+        void RecoveryJob::applyFileWritesTask(FileWrites* fileWrites) {
+            // ThreadPool only logs exceptions, so keep the error for the recovering thread
+            try {
+                applyFileWrites(fileWrites);
+            }
+            catch (const DBException& e) {
+                fileWrites->error = e.toString();
+            }
+            catch (const std::exception& e) {
+                fileWrites->error = e.what();
+            }
+        }
+
+        /** apply the basic writes entries[begin, end), which contain no DurOps, file by file */
+        void RecoveryJob::applyWritesByFile(const vector<ParsedJournalEntry>& entries,
+                                            size_t begin,
+                                            size_t end) {
+            if (begin == end) {
+                return;
+            }
+
+            // Opening files changes _mmfs and the global file list, so the target files are all
+            // resolved here before any worker starts. A section rarely touches more than a few
+            // files, which makes a linear search the cheapest lookup.
+            Last last;
+            vector<FileWrites> files;
+            for (size_t i = begin; i != end; ++i) {
+                const ParsedJournalEntry& entry = entries[i];
+                verify(entry.e);
+                verify(entry.dbName);
+
+                DurableMappedFile* mmf = last.newEntry(entry, *this);
+                size_t f = 0;
+                while (f < files.size() && files[f].mmf != mmf) {
+                    ++f;
+                }
+                if (f == files.size()) {
+                    files.push_back(FileWrites());
+                    files.back().mmf = mmf;
+                }
+                files[f].entries.push_back(&entry);
+            }
+
+            if (files.size() == 1) {
+                applyFileWrites(&files[0]);
             }
             else {
-                massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
+                for (size_t f = 0; f < files.size(); ++f) {
+                    _applyPool->schedule(&RecoveryJob::applyFileWritesTask, this, &files[f]);
+                }
+                _applyPool->join();
+            }
+
+            for (size_t f = 0; f < files.size(); ++f) {
+                const FileWrites& fileWrites = files[f];
+                if (!fileWrites.error.empty()) {
+                    msgasserted(28707, str::stream() << "journal recovery failed applying "
+                                                     << "writes to " << fileWrites.mmf->filename()
+                                                     << ": " << fileWrites.error);
+                }
+                stats.curr()->_writeToDataFilesBytes += fileWrites.bytesWritten;
+                _bytesApplied += fileWrites.bytesWritten;
             }
         }
 
@@ -376,8 +496,27 @@ namespace mongo {
             }
 
             Last last;
-            for (vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
-                applyEntry(last, *i, apply, dump);
+            if (_applyPool && apply && !dump) {
+                // DurOps may create, drop or close files, so they are applied on their own, in
+                // order, and split the basic writes around them into independent batches.
+                size_t batchBegin = 0;
+                for (size_t i = 0; i <= entries.size(); ++i) {
+                    if (i < entries.size() && entries[i].e) {
+                        continue;
+                    }
+                    applyWritesByFile(entries, batchBegin, i);
+                    if (i < entries.size()) {
+                        applyEntry(last, entries[i], apply, dump);
+                    }
+                    batchBegin = i + 1;
+                }
+            }
+            else {
+                for (vector<ParsedJournalEntry>::const_iterator i = entries.begin();
+                     i != entries.end();
+                     ++i) {
+                    applyEntry(last, *i, apply, dump);
+                }
             }
 
             if (dump) {
@@ -442,6 +581,9 @@ namespace mongo {
 
             // got all the entries for one group commit.  apply them:
             applyEntries(entries);
+            if (_recovering) {
+                _sectionsApplied++;
+            }
         }
 
         /** apply a specific journal file, that is already mmap'd
@@ -548,6 +690,16 @@ namespace mongo {
             _lastDataSyncedFromLastRun = journalReadLSN();
             log() << "recover lsn: " << _lastDataSyncedFromLastRun << endl;
 
+            // dumping logs entries in journal order, and scanning applies nothing
+            const bool serial = (mmapv1GlobalOptions.journalOptions &
+                                 (MMAPV1Options::JournalDumpJournal |
+                                  MMAPV1Options::JournalScanOnly));
+            const int nThreads = serial ? 1 : journalRecoveryThreads;
+            if (nThreads > 1) {
+                _applyPool.reset(new ThreadPool(nThreads, "journalRecovery"));
+            }
+
+            Timer t;
             for( unsigned i = 0; i != files.size(); ++i ) {
                 bool abruptEnd = processFile(files[i]);
                 if( abruptEnd && i+1 < files.size() ) {
@@ -558,6 +710,13 @@ namespace mongo {
             }
 
             close();
+            _applyPool.reset();
+
+            const long long millis = t.millis();
+            const unsigned long long mb = _bytesApplied / (1024 * 1024);
+            log() << "recover applied " << _sectionsApplied << " sections, " << mb << "MB, in "
+                  << millis << "ms (" << (millis > 0 ? mb * 1000 / millis : mb) << " MB/s) using "
+                  << std::max(nThreads, 1) << " thread(s)" << endl;
 
             if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalScanOnly) {
                 uasserted(13545, str::stream() << "--durOptions "
@@ -32,6 +32,8 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <list>
+#include <memory>
+#include <vector>
 
 #include "mongo/db/storage/mmap_v1/dur_journalformat.h"
 #include "mongo/util/concurrency/mutex.h"
@@ -40,6 +42,10 @@ namespace mongo {
 
     class DurableMappedFile;
 
+    namespace threadpool {
+        class ThreadPool;
+    }
+
     namespace dur {
 
         struct ParsedJournalEntry;
@@ -76,9 +82,28 @@ namespace mongo {
             };
 
 
+            /**
+             * The basic writes of a section which go to one data file, in journal order. During
+             * recovery each of these is applied by its own worker thread.
+             */
+            struct FileWrites {
+                FileWrites() : mmf(NULL), bytesWritten(0) {}
+
+                DurableMappedFile* mmf;
+                std::vector<const ParsedJournalEntry*> entries;
+                unsigned long long bytesWritten;
+                std::string error; // set if applying the writes threw
+            };
+
             void write(Last& last, const ParsedJournalEntry& entry); // actually writes to the file
+            unsigned write(DurableMappedFile* mmf, const ParsedJournalEntry& entry);
             void applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump);
             void applyEntries(const std::vector<ParsedJournalEntry> &entries);
+            void applyWritesByFile(const std::vector<ParsedJournalEntry>& entries,
+                                   size_t begin,
+                                   size_t end);
+            void applyFileWrites(FileWrites* fileWrites);
+            void applyFileWritesTask(FileWrites* fileWrites); // doesn't throw
             bool processFileBuffer(const void *, unsigned len);
             bool processFile(boost::filesystem::path journalfile);
             void _close(); // doesn't lock
@@ -94,6 +119,14 @@ namespace mongo {
             unsigned long long _lastDataSyncedFromLastRun;
             unsigned long long _lastSeqMentionedInConsoleLog;
 
+            // Workers which apply the writes of a section to different data files concurrently.
+            // Only exists during recovery, and only if journalRecoveryThreads is more than 1.
+            std::unique_ptr<threadpool::ThreadPool> _applyPool;
+
+            // What recovery has applied so far, for the summary logged at the end of go()
+            unsigned long long _sectionsApplied;
+            unsigned long long _bytesApplied;
+
 
             static RecoveryJob& _instance;
         };
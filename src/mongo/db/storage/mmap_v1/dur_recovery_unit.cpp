@@ -77,6 +77,24 @@ namespace mongo {
         // no-op since we have no transaction
     }
 
+    bool DurRecoveryUnit::prepareForReuse() {
+        if (_inUnitOfWork) {
+            return false;
+        }
+
+        resetChanges();
+
+        // Only keep as much pre-image memory as small operations need
+        const size_t kMaxRetainedBytes = 64 * 1024;
+        if (_preimageBuffer.capacity() > kMaxRetainedBytes) {
+            std::string().swap(_preimageBuffer);
+        }
+        if (_initialWrites.capacity() * sizeof(Write) > kMaxRetainedBytes) {
+            InitialWrites().swap(_initialWrites);
+        }
+        return true;
+    }
+
     void DurRecoveryUnit::commitChanges() {
         if (getDur().isDurable())
             markWritesForJournaling();
@@ -280,6 +298,7 @@ namespace mongo {
 
         _writeCount++;
         _writeBytes += len;
+        storageStats()->bytesWritten += len;
         char* const data = static_cast<char*>(addr);
 
         //  The initial writes are stored in a faster, but less memory-efficient way. This will
@@ -63,6 +63,8 @@ namespace mongo {
 
         virtual SnapshotId getSnapshotId() const { return SnapshotId(); }
 
+        virtual bool prepareForReuse();
+
     private:
         /**
          * Marks writes for journaling, if enabled, and then commits all other Changes in order.
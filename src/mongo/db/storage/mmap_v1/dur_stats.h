@@ -59,12 +59,18 @@ namespace mongo {
 
                 unsigned _commits;
                 unsigned _commitsInWriteLock;
+                // Commits started before the commit interval was up, because of waiting writers
+                // or a growing amount of uncommitted data.
+                unsigned _earlyCommits;
 
                 uint64_t _journaledBytes;
                 uint64_t _uncompressedBytes;
                 uint64_t _writeToDataFilesBytes;
 
                 uint64_t _prepLogBufferMicros;
+                // Time the durability thread waited for a journal buffer to be written and applied
+                // before it could prepare the next commit.
+                uint64_t _waitForJournalBufferMicros;
                 uint64_t _writeToJournalMicros;
                 uint64_t _writeToDataFilesMicros;
                 uint64_t _remapPrivateViewMicros;
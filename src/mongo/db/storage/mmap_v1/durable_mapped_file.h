@@ -57,6 +57,7 @@ namespace mongo {
         std::string filename() const { return MemoryMappedFile::filename(); }
 
         void flush(bool sync)   { MemoryMappedFile::flush(sync); }
+        void setAccessAdvice(MAdvise::Advice a) { MemoryMappedFile::setAccessAdvice(a); }
 
         /* Creates with length if DNE, otherwise uses existing file length,
            passed length.
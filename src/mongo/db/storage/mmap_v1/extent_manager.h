@@ -175,6 +175,12 @@ namespace mongo {
          * Caller takes owernship of CacheHint
          */
         virtual CacheHint* cacheHint( const DiskLoc& extentLoc, const HintType& hint ) = 0;
+
+        /**
+         * Tell the system that the 'len' bytes starting at 'loc' will be read soon, so that it
+         * can start reading them in without blocking the caller. Purely advisory.
+         */
+        virtual void readAhead( const DiskLoc& loc, int len ) const { }
     };
 
 }
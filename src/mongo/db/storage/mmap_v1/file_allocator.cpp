@@ -250,11 +250,38 @@ namespace mongo {
 #endif
 
 #if defined(__linux__)
+        // fallocate() reserves the blocks without writing them, and fails right away where the
+        // filesystem cannot do that, while posix_fallocate() would then write to every block.
+        if (fallocate(fd, 0, 0, size) == 0)
+            return;
+
+        const int fallocateErrno = errno;
+        if (fallocateErrno == EOPNOTSUPP || fallocateErrno == ENOSYS) {
+            LOG(1) << "FileAllocator: fallocate not supported, falling back" << endl;
+        }
+        else {
+            log() << "FileAllocator: fallocate failed: " << errnoWithDescription( fallocateErrno )
+                  << " falling back" << endl;
+        }
+
         int ret = posix_fallocate(fd,0,size);
         if ( ret == 0 )
             return;
 
         log() << "FileAllocator: posix_fallocate failed: " << errnoWithDescription( ret ) << " falling back" << endl;
+#elif defined(__APPLE__)
+        // Prefer one contiguous run of blocks, but take any.
+        fstore_t store = { F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, size, 0 };
+        int ret = fcntl(fd, F_PREALLOCATE, &store);
+        if (ret == -1) {
+            store.fst_flags = F_ALLOCATEALL;
+            ret = fcntl(fd, F_PREALLOCATE, &store);
+        }
+        if (ret != -1 && ftruncate(fd, size) == 0)
+            return;
+
+        log() << "FileAllocator: F_PREALLOCATE failed: " << errnoWithDescription()
+              << " falling back" << endl;
 #endif
 
         off_t filelen = lseek( fd, 0, SEEK_END );
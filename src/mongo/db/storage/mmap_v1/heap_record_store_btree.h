@@ -85,11 +85,12 @@ namespace mongo {
             return true;
         }
 
-        virtual Status updateWithDamages(OperationContext* txn,
-                                         const RecordId& loc,
-                                         const RecordData& oldRec,
-                                         const char* damageSource,
-                                         const mutablebson::DamageVector& damages) {
+        virtual StatusWith<RecordData> updateWithDamages(
+                OperationContext* txn,
+                const RecordId& loc,
+                const RecordData& oldRec,
+                const char* damageSource,
+                const mutablebson::DamageVector& damages) {
             invariant(false);
         }
 
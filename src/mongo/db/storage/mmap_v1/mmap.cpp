@@ -53,6 +53,9 @@ namespace mongo {
     using std::stringstream;
     using std::vector;
 
+    MmapHugePages::Policy MmapHugePages::policy = MmapHugePages::Off;
+    const size_t MmapHugePages::kPageSize;
+
     void minOSPageSizeBytesTest(size_t minOSPageSizeBytes) {
         fassert( 16325, minOSPageSizeBytes > 0 );
         fassert( 16326, minOSPageSizeBytes < 1000000 );
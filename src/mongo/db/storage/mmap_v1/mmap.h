@@ -50,14 +50,48 @@ namespace mongo {
     class MAdvise {
         MONGO_DISALLOW_COPYING(MAdvise);
     public:
-        enum Advice { Sequential=1 , Random=2 };
-        MAdvise(void *p, unsigned len, Advice a);
-        ~MAdvise(); // destructor resets the range to MADV_NORMAL
+        enum Advice { Normal=0, Sequential=1 , Random=2 };
+        /** @param restoreTo is the advice the destructor puts back on the range */
+        MAdvise(void *p, unsigned len, Advice a, Advice restoreTo = Normal);
+        ~MAdvise();
     private:
         void *_p;
         unsigned _len;
+        Advice _restoreTo;
     };
 
+    /**
+     * Gives the OS advice about how the mapped range [p, p+len) will be read, which stays in
+     * place until other advice replaces it. Failures are logged and otherwise ignored.
+     */
+    void adviseMappedRange(void *p, size_t len, MAdvise::Advice a);
+
+    /**
+     * Whether the private views of data files and the journal's buffers ask for huge pages, set
+     * at startup by the mmapv1HugePages server parameter. Transparent uses MADV_HUGEPAGE. HugeTLB
+     * maps anonymous buffers from the hugetlbfs pool, falling back to Transparent when the pool
+     * is empty; file backed views can only be Transparent.
+     */
+    struct MmapHugePages {
+        enum Policy { Off=0, Transparent=1, HugeTLB=2 };
+        static Policy policy;
+
+        // size of the huge pages asked for; buffers smaller than this do not ask for them
+        static const size_t kPageSize = 2 * 1024 * 1024;
+    };
+
+    /**
+     * Asks for transparent huge pages for [p, p+len) if MmapHugePages::policy is not Off and the
+     * OS supports them. Only hugepage-aligned parts of the range can be backed by huge pages.
+     */
+    void adviseHugePages(void *p, size_t len);
+
+    /**
+     * Hints to the OS that the pages of the mapped range [p, p+len) will be written to soon, so
+     * that it can start reading them in ahead of use. Does nothing where this is not supported.
+     */
+    void prefetchMappedRange(const void *p, size_t len);
+
     // lock order: lock dbMutex before this if you lock both
     class LockMongoFilesShared {
         friend class LockMongoFilesExclusive;
@@ -223,6 +257,12 @@ namespace mongo {
         void* createReadOnlyMap();
         void* createPrivateMap();
 
+        /**
+         * Gives 'a' as advice about the access pattern for all the views of this file, including
+         * ones created or remapped later.
+         */
+        void setAccessAdvice(MAdvise::Advice a);
+
         virtual uint64_t getUniqueId() const { return _uniqueId; }
 
     private:
@@ -233,6 +273,7 @@ namespace mongo {
         std::vector<void *> views;
         unsigned long long len;
         const uint64_t _uniqueId;
+        MAdvise::Advice _accessAdvice;
 #ifdef _WIN32
         // flush Mutex
         //
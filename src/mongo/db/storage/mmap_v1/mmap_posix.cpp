@@ -66,7 +66,9 @@ namespace mongo {
         
     
 
-    MemoryMappedFile::MemoryMappedFile() : _uniqueId(mmfNextId.fetchAndAdd(1)) {
+    MemoryMappedFile::MemoryMappedFile()
+        : _uniqueId(mmfNextId.fetchAndAdd(1)),
+          _accessAdvice(MAdvise::Normal) {
         fd = 0;
         maphandle = 0;
         len = 0;
@@ -125,33 +127,74 @@ namespace mongo {
     }
 
 #if defined(__sun)
-    MAdvise::MAdvise(void *,unsigned, Advice) { }
+    MAdvise::MAdvise(void *,unsigned, Advice, Advice) { }
     MAdvise::~MAdvise() { }
+    void adviseMappedRange(void *, size_t, MAdvise::Advice) { }
+    void adviseHugePages(void *, size_t) { }
+    void prefetchMappedRange(const void *, size_t) { }
 #else
-    MAdvise::MAdvise(void *p, unsigned len, Advice a) {
+    namespace {
+        int toMadvise(MAdvise::Advice a) {
+            switch ( a ) {
+            case MAdvise::Sequential:
+                return MADV_SEQUENTIAL;
+            case MAdvise::Random:
+                return MADV_RANDOM;
+            case MAdvise::Normal:
+                break;
+            }
+            return MADV_NORMAL;
+        }
+    }
+
+    MAdvise::MAdvise(void *p, unsigned len, Advice a, Advice restoreTo)
+        : _restoreTo(restoreTo) {
 
         _p = _pageAlign( p );
 
         _len = len + static_cast<unsigned>( reinterpret_cast<size_t>(p) -
                                             reinterpret_cast<size_t>(_p)  );
 
-        int advice = 0;
-        switch ( a ) {
-        case Sequential:
-            advice = MADV_SEQUENTIAL;
-            break;
-        case Random:
-            advice = MADV_RANDOM;
-            break;
-        }
-
-        if ( madvise(_p,_len,advice ) ) {
+        if ( madvise(_p,_len,toMadvise(a) ) ) {
             error() << "madvise failed: " << errnoWithDescription();
         }
 
     }
     MAdvise::~MAdvise() {
-        madvise(_p,_len,MADV_NORMAL);
+        madvise(_p,_len,toMadvise(_restoreTo));
+    }
+
+    void adviseMappedRange(void *p, size_t len, MAdvise::Advice a) {
+        void *start = _pageAlign( p );
+        len += reinterpret_cast<size_t>(p) - reinterpret_cast<size_t>(start);
+
+        if ( madvise( start, len, toMadvise(a) ) ) {
+            warning() << "madvise failed: " << errnoWithDescription();
+        }
+    }
+
+    void adviseHugePages(void *p, size_t len) {
+        if ( MmapHugePages::policy == MmapHugePages::Off )
+            return;
+#if defined(MADV_HUGEPAGE)
+        void *start = _pageAlign( p );
+        len += reinterpret_cast<size_t>(p) - reinterpret_cast<size_t>(start);
+
+        // kernels built without transparent huge pages say EINVAL, which is not worth a warning
+        if ( madvise( start, len, MADV_HUGEPAGE ) ) {
+            LOG(1) << "madvise HUGEPAGE failed: " << errnoWithDescription();
+        }
+#endif
+    }
+
+    void prefetchMappedRange(const void *p, size_t len) {
+        void *start = _pageAlign( const_cast<void*>( p ) );
+        len += reinterpret_cast<size_t>(p) - reinterpret_cast<size_t>(start);
+
+        // only a hint, so a failure here is not worth more than a debug message
+        if ( madvise( start, len, MADV_WILLNEED ) ) {
+            LOG(1) << "madvise WILLNEED failed: " << errnoWithDescription();
+        }
     }
 #endif
 
@@ -195,6 +238,9 @@ namespace mongo {
                 warning() << "map: madvise failed for " << filename << ' ' << errnoWithDescription() << endl;
             }
         }
+        else if ( _accessAdvice != MAdvise::Normal ) {
+            adviseMappedRange( view, length, _accessAdvice );
+        }
 #endif
 
         views.push_back( view );
@@ -233,10 +279,22 @@ namespace mongo {
             return 0;
         }
 
+        if ( _accessAdvice != MAdvise::Normal ) {
+            adviseMappedRange( x, len, _accessAdvice );
+        }
+        adviseHugePages( x, len );
+
         views.push_back(x);
         return x;
     }
 
+    void MemoryMappedFile::setAccessAdvice(MAdvise::Advice a) {
+        _accessAdvice = a;
+        for( vector<void*>::iterator i = views.begin(); i != views.end(); i++ ) {
+            adviseMappedRange( *i, len, a );
+        }
+    }
+
     void* MemoryMappedFile::remapPrivateView(void *oldPrivateAddr) {
 #if defined(__sun) // SERVER-8795
         LockMongoFilesExclusive lockMongoFiles;
@@ -252,6 +310,12 @@ namespace mongo {
             abort();
         }
         verify( x == oldPrivateAddr );
+
+        // the new mapping starts out without the advice given to the one it replaced
+        if ( _accessAdvice != MAdvise::Normal ) {
+            adviseMappedRange( x, len, _accessAdvice );
+        }
+        adviseHugePages( x, len );
         return x;
     }
 
@@ -42,6 +42,7 @@
 #include "mongo/db/index/hash_access_method.h"
 #include "mongo/db/index/haystack_access_method.h"
 #include "mongo/db/index/s2_access_method.h"
+#include "mongo/db/index/summary_access_method.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/btree/btree_interface.h"
@@ -804,6 +805,9 @@ namespace {
         if (IndexNames::GEO_2D == type)
             return new TwoDAccessMethod( entry, btree.release() );
 
+        if (IndexNames::SUMMARY == type)
+            return new SummaryAccessMethod( entry, btree.release() );
+
         log() << "Can't find index for keyPattern " << entry->descriptor()->keyPattern();
         fassertFailed(17489);
     }
@@ -37,6 +37,7 @@
 #include <fstream>
 
 #include "mongo/db/mongod_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/db/storage/mmap_v1/data_file_sync.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
@@ -61,6 +62,42 @@ namespace mongo {
 
 namespace {
 
+    /**
+     * "off", "transparent" or "hugetlb", see MmapHugePages.
+     */
+    class HugePagesParameter : public ExportedServerParameter<std::string> {
+    public:
+        HugePagesParameter()
+            : ExportedServerParameter<std::string>(ServerParameterSet::getGlobal(),
+                                                   "mmapv1HugePages",
+                                                   &_value,
+                                                   true,
+                                                   false),
+              _value("off") {
+        }
+
+        virtual Status validate(const std::string& potentialNewValue) {
+            if (potentialNewValue == "off") {
+                MmapHugePages::policy = MmapHugePages::Off;
+            }
+            else if (potentialNewValue == "transparent") {
+                MmapHugePages::policy = MmapHugePages::Transparent;
+            }
+            else if (potentialNewValue == "hugetlb") {
+                MmapHugePages::policy = MmapHugePages::HugeTLB;
+            }
+            else {
+                return Status(ErrorCodes::BadValue,
+                              "mmapv1HugePages must be one of \"off\", \"transparent\" or "
+                              "\"hugetlb\"");
+            }
+            return Status::OK();
+        }
+
+    private:
+        std::string _value;
+    } hugePagesParameter;
+
 #if !defined(__sun)
     // if doingRepair is true don't consider unclean shutdown an error
     void acquirePathLock(MMAPV1Engine* storageEngine,
@@ -31,12 +31,15 @@
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
 
 #include <boost/filesystem/operations.hpp>
+#include <map>
 
 #include "mongo/db/storage/mmap_v1/mmap_v1_extent_manager.h"
 
 #include "mongo/base/counter.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/storage/mmap_v1/data_file.h"
@@ -52,6 +55,8 @@
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/file.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -68,6 +73,186 @@ namespace mongo {
     static Counter64 needsFetchFailCounter;
     MONGO_FP_DECLARE(recordNeedsFetchFail);
 
+    // Most bytes per second that readAhead() may hint to the OS, across all scans. 0 turns
+    // read-ahead off.
+    MONGO_EXPORT_SERVER_PARAMETER(mmapv1ReadAheadMaxMBPerSec, int, 64);
+
+    // Once this fraction of the last data file is used, the next file is allocated in the
+    // background, so that the write which fills the last file does not wait for a new one.
+    // Values outside (0, 1) leave allocation to the write which needs the space.
+    MONGO_EXPORT_SERVER_PARAMETER(mmapv1PreallocateNextFileRatio, double, 0.5);
+
+    static Counter64 accessAdviceChanges;
+    static ServerStatusMetricField<Counter64> dAccessAdvice( "storage.accessPattern.adviceChanges",
+                                                             &accessAdviceChanges );
+
+    static Counter64 readAheadHintedBytes;
+    static Counter64 readAheadResidentBytes;
+    static Counter64 readAheadThrottledBytes;
+
+    static ServerStatusMetricField<Counter64> dReadAhead1( "storage.readAhead.hintedBytes",
+                                                           &readAheadHintedBytes );
+    static ServerStatusMetricField<Counter64> dReadAhead2( "storage.readAhead.residentBytes",
+                                                           &readAheadResidentBytes );
+    static ServerStatusMetricField<Counter64> dReadAhead3( "storage.readAhead.throttledBytes",
+                                                           &readAheadThrottledBytes );
+
+    namespace {
+        /**
+         * Budget of read-ahead bytes, refilled continuously at mmapv1ReadAheadMaxMBPerSec and
+         * never holding more than one second's worth.
+         */
+        class ReadAheadThrottle {
+        public:
+            ReadAheadThrottle()
+                : _mutex( "ReadAheadThrottle" ),
+                  _available( 0 ),
+                  _lastRefillMillis( curTimeMillis64() ) {
+            }
+
+            bool tryAcquire( long long bytes ) {
+                const long long perSec = mmapv1ReadAheadMaxMBPerSec * 1024LL * 1024LL;
+                if ( perSec <= 0 )
+                    return false;
+
+                SimpleMutex::scoped_lock lk( _mutex );
+                const unsigned long long now = curTimeMillis64();
+                if ( now > _lastRefillMillis ) {
+                    const long long refill = ( now - _lastRefillMillis ) * perSec / 1000;
+                    _available = std::min( perSec, _available + refill );
+                    _lastRefillMillis = now;
+                }
+                if ( _available < bytes )
+                    return false;
+                _available -= bytes;
+                return true;
+            }
+
+            void release( long long bytes ) {
+                SimpleMutex::scoped_lock lk( _mutex );
+                _available += bytes;
+            }
+
+        private:
+            SimpleMutex _mutex;
+            long long _available;
+            unsigned long long _lastRefillMillis;
+        };
+
+        ReadAheadThrottle readAheadThrottle;
+
+        // The RecordAccessTracker is consulted once per chunk of this size.
+        const int kReadAheadChunkSize = 64 * 1024;
+
+        enum AccessPattern { kNormalAccess, kRandomAccess, kSequentialAccess, kAutoAccess };
+
+        bool parseAccessPattern( StringData name, AccessPattern* out ) {
+            if ( name == "normal" )
+                *out = kNormalAccess;
+            else if ( name == "random" )
+                *out = kRandomAccess;
+            else if ( name == "sequential" )
+                *out = kSequentialAccess;
+            else if ( name == "auto" )
+                *out = kAutoAccess;
+            else
+                return false;
+            return true;
+        }
+
+        MAdvise::Advice toAdvice( AccessPattern pattern ) {
+            switch ( pattern ) {
+            case kRandomAccess:
+                return MAdvise::Random;
+            case kSequentialAccess:
+                return MAdvise::Sequential;
+            case kNormalAccess:
+            case kAutoAccess:
+                break;
+            }
+            return MAdvise::Normal;
+        }
+
+        /**
+         * mmapv1AccessPattern: the access pattern of the data files of databases without one of
+         * their own, "normal", "random", "sequential" or "auto", followed by those of particular
+         * databases, as in "auto,logs:sequential,sessions:random". The data files of a database
+         * are given the matching madvise() advice at its next record access after a change.
+         * "auto" picks the advice from the accesses recordNeedsFetch() sees.
+         */
+        class AccessPatternParameter : public ExportedServerParameter<std::string> {
+        public:
+            AccessPatternParameter()
+                : ExportedServerParameter<std::string>(ServerParameterSet::getGlobal(),
+                                                       "mmapv1AccessPattern",
+                                                       &_value,
+                                                       true,
+                                                       true),
+                  _value( "normal" ),
+                  _mutex( "AccessPatternParameter" ),
+                  _default( kNormalAccess ),
+                  _version( 1 ) {
+            }
+
+            virtual Status validate( const std::string& potentialNewValue ) {
+                AccessPattern defaultPattern = kNormalAccess;
+                std::map<std::string, AccessPattern> perDb;
+
+                size_t begin = 0;
+                while ( begin <= potentialNewValue.size() ) {
+                    size_t end = potentialNewValue.find( ',', begin );
+                    if ( end == std::string::npos )
+                        end = potentialNewValue.size();
+                    const std::string item = potentialNewValue.substr( begin, end - begin );
+                    begin = end + 1;
+
+                    const size_t colon = item.find( ':' );
+                    AccessPattern pattern;
+                    if ( !parseAccessPattern( colon == std::string::npos ?
+                                              item : item.substr( colon + 1 ),
+                                              &pattern ) ) {
+                        return Status( ErrorCodes::BadValue, str::stream() <<
+                                       "bad mmapv1AccessPattern '" << item << "', expected "
+                                       "normal, random, sequential or auto, or <db>:<pattern>" );
+                    }
+                    if ( colon == std::string::npos )
+                        defaultPattern = pattern;
+                    else
+                        perDb[item.substr( 0, colon )] = pattern;
+                }
+
+                SimpleMutex::scoped_lock lk( _mutex );
+                _default = defaultPattern;
+                _perDb.swap( perDb );
+                _version.fetchAndAdd( 1 );
+                return Status::OK();
+            }
+
+            /** changes every time the parameter is set */
+            unsigned version() const { return _version.load(); }
+
+            AccessPattern patternFor( const std::string& dbname ) {
+                SimpleMutex::scoped_lock lk( _mutex );
+                std::map<std::string, AccessPattern>::const_iterator it = _perDb.find( dbname );
+                return it == _perDb.end() ? _default : it->second;
+            }
+
+        private:
+            std::string _value;
+
+            SimpleMutex _mutex; // protects _default and _perDb
+            AccessPattern _default;
+            std::map<std::string, AccessPattern> _perDb;
+            AtomicUInt32 _version;
+        } accessPatternParameter;
+
+        // "auto" chooses the advice once per this many sampled accesses
+        const unsigned kAccessSampleWindow = 4096;
+
+        // accesses at most this far from the one before them count as sequential
+        const long long kSequentialAccessDistance = 64 * 1024;
+    }
+
     // Used to make sure the compiler doesn't get too smart on us when we're
     // trying to touch records.
     volatile int __record_touch_dummy = 1;
@@ -114,7 +299,9 @@ namespace mongo {
         : _dbname(dbname.toString()),
           _path(path.toString()),
           _directoryPerDB(directoryPerDB),
-          _rid(RESOURCE_METADATA, dbname) {
+          _rid(RESOURCE_METADATA, dbname),
+          _accessAdvice(MAdvise::Normal),
+          _accessAdviceMutex("MmapV1ExtentManager::_accessAdvice") {
         StorageEngine* engine = getGlobalServiceContext()->getGlobalStorageEngine();
         invariant(engine->isMmapV1());
         MMAPV1Engine* mmapEngine = static_cast<MMAPV1Engine*>(engine);
@@ -248,6 +435,8 @@ namespace mongo {
                       << allocFileName;
             }
 
+            allocFile->mmf.setAccessAdvice(static_cast<MAdvise::Advice>(_accessAdvice.load()));
+
             // It's all good
             _files.push_back(allocFile.release());
         }
@@ -257,7 +446,7 @@ namespace mongo {
             unique_ptr<DataFile> nextFile(new DataFile(allocFileId + 1));
             const string nextFileName = _fileName(allocFileId + 1).string();
 
-            nextFile->open(txn, nextFileName.c_str(), minSize, false);
+            nextFile->open(txn, nextFileName.c_str(), minSize, true);
         }
 
         // Returns the last file added
@@ -308,13 +497,76 @@ namespace mongo {
             }
         }
 
-        if ( !_recordAccessTracker->checkAccessedAndMark( record ) ) {
+        const bool inMemory = _recordAccessTracker->checkAccessedAndMark( record );
+        _sampleAccess( loc, inMemory );
+        if ( !inMemory ) {
             return stdx::make_unique<MmapV1RecordFetcher>( record );
         }
 
         return {};
     }
 
+    void MmapV1ExtentManager::_sampleAccess( const DiskLoc& loc, bool inMemory ) const {
+        const unsigned version = accessPatternParameter.version();
+        if ( version != _accessPatternVersion.load() ) {
+            const AccessPattern pattern = accessPatternParameter.patternFor( _dbname );
+            _accessPatternVersion.store( version );
+            _accessPatternAuto.store( pattern == kAutoAccess );
+            if ( pattern != kAutoAccess ) {
+                _setAccessAdvice( toAdvice( pattern ) );
+            }
+        }
+
+        if ( !_accessPatternAuto.load() )
+            return;
+
+        // Samples race with each other, which only blurs the statistics a little
+        const unsigned long long access =
+            ( static_cast<unsigned long long>( loc.a() ) << 32 ) |
+            static_cast<unsigned>( loc.getOfs() );
+        const unsigned long long last = _lastAccess.swap( access );
+        const long long distance = static_cast<long long>( access & 0xffffffffULL ) -
+                                   static_cast<long long>( last & 0xffffffffULL );
+        if ( ( access >> 32 ) == ( last >> 32 ) &&
+             distance >= -kSequentialAccessDistance && distance <= kSequentialAccessDistance ) {
+            _accessSequential.fetchAndAdd( 1 );
+        }
+        if ( !inMemory ) {
+            _accessMisses.fetchAndAdd( 1 );
+        }
+
+        if ( _accessSamples.addAndFetch( 1 ) != kAccessSampleWindow )
+            return;
+        const unsigned misses = _accessMisses.swap( 0 );
+        const unsigned sequential = _accessSequential.swap( 0 );
+        _accessSamples.store( 0 );
+
+        // While the accesses are mostly to memory, read-ahead costs little either way, so the
+        // advice is left as it is rather than flapping with the last few misses.
+        if ( misses * 10 < kAccessSampleWindow )
+            return;
+        _setAccessAdvice( sequential * 2 > kAccessSampleWindow ? MAdvise::Sequential :
+                                                                 MAdvise::Random );
+    }
+
+    void MmapV1ExtentManager::_setAccessAdvice( MAdvise::Advice advice ) const {
+        if ( static_cast<MAdvise::Advice>( _accessAdvice.load() ) == advice )
+            return;
+
+        SimpleMutex::scoped_lock lk( _accessAdviceMutex );
+        if ( static_cast<MAdvise::Advice>( _accessAdvice.load() ) == advice )
+            return;
+
+        LockMongoFilesShared filesLock;
+        for ( int i = 0; i < _files.size(); i++ ) {
+            _files[i]->mmf.setAccessAdvice( advice );
+        }
+        _accessAdvice.store( advice );
+        accessAdviceChanges.increment();
+        LOG(1) << "data files of " << _dbname << " now have access advice "
+               << static_cast<int>( advice );
+    }
+
     DiskLoc MmapV1ExtentManager::extentLocForV1( const DiskLoc& loc ) const {
         MmapV1RecordHeader* record = recordForV1( loc );
         return DiskLoc( loc.a(), record->extentOfs() );
@@ -370,9 +622,34 @@ namespace mongo {
         *txn->recoveryUnit()->writing(&e->myLoc) = loc;
         *txn->recoveryUnit()->writing(&e->length) = size;
 
+        if ( fileNo == numFiles() - 1 ) {
+            _preallocateNextFileIfFilling( txn, f, size );
+        }
+
         return loc;
     }
 
+    void MmapV1ExtentManager::_preallocateNextFileIfFilling( OperationContext* txn,
+                                                             DataFile* f,
+                                                             int extentSize ) {
+        const double ratio = mmapv1PreallocateNextFileRatio;
+        if ( !mmapv1GlobalOptions.prealloc || ratio <= 0 || ratio >= 1 )
+            return;
+
+        // Only the extent which takes the file past the ratio asks, so this is once per file.
+        const DataFileHeader* h = f->getHeader();
+        const double threshold = ratio * ( h->fileLength - DataFileHeader::HeaderSize );
+        const double usedAfter = h->fileLength - DataFileHeader::HeaderSize - h->unusedLength;
+        if ( usedAfter < threshold || usedAfter - extentSize >= threshold )
+            return;
+
+        // Asks for the size _addAFile() will open the next file with, so that it finds the
+        // allocation FileAllocator already has under way.
+        const int nextFileId = numFiles();
+        DataFile nextFile( nextFileId );
+        nextFile.open( txn, _fileName( nextFileId ).string().c_str(), h->fileLength, true );
+    }
+
 
     DiskLoc MmapV1ExtentManager::_createExtent( OperationContext* txn,
                                                 int size,
@@ -635,8 +912,8 @@ namespace mongo {
     namespace {
         class CacheHintMadvise : public ExtentManager::CacheHint {
         public:
-            CacheHintMadvise(void *p, unsigned len, MAdvise::Advice a)
-                : _advice( p, len, a ) {
+            CacheHintMadvise(void *p, unsigned len, MAdvise::Advice a, MAdvise::Advice restoreTo)
+                : _advice( p, len, a, restoreTo ) {
             }
         private:
             MAdvise _advice;
@@ -649,7 +926,52 @@ namespace mongo {
         Extent* e = getExtent( extentLoc );
         return new CacheHintMadvise( reinterpret_cast<void*>( e ),
                                      e->length,
-                                     MAdvise::Sequential );
+                                     MAdvise::Sequential,
+                                     static_cast<MAdvise::Advice>( _accessAdvice.load() ) );
+    }
+
+    void MmapV1ExtentManager::readAhead( const DiskLoc& loc, int len ) const {
+        if ( loc.isNull() || len <= 0 || mmapv1ReadAheadMaxMBPerSec <= 0 )
+            return;
+
+        const DataFile* df = _getOpenFile( loc.a() );
+        const long long begin = std::max<long long>( loc.getOfs(), DataFileHeader::HeaderSize );
+        const long long end = std::min<long long>( loc.getOfs() + static_cast<long long>( len ),
+                                                   df->length() );
+        if ( begin >= end )
+            return;
+
+        // Take the budget before asking the tracker, which marks what it is asked about as
+        // accessed: pages that end up not being hinted must not look like they are in memory.
+        if ( !readAheadThrottle.tryAcquire( end - begin ) ) {
+            readAheadThrottledBytes.increment( end - begin );
+            return;
+        }
+
+        // Pages which scans have touched, or which have already been hinted, are known to the
+        // tracker. Hint the runs of chunks it does not know about, checking each chunk once.
+        long long runBegin = begin;
+        long long residentBytes = 0;
+        for ( long long chunk = begin; chunk < end; chunk += kReadAheadChunkSize ) {
+            const long long chunkEnd = std::min<long long>( chunk + kReadAheadChunkSize, end );
+            const bool resident = _recordAccessTracker->checkAccessedAndMark( df->p() + chunk );
+            if ( resident ) {
+                residentBytes += chunkEnd - chunk;
+            }
+            if ( resident || chunkEnd == end ) {
+                const long long runEnd = resident ? chunk : end;
+                if ( runEnd > runBegin ) {
+                    prefetchMappedRange( df->p() + runBegin, runEnd - runBegin );
+                    readAheadHintedBytes.increment( runEnd - runBegin );
+                }
+                runBegin = chunkEnd;
+            }
+        }
+
+        if ( residentBytes ) {
+            readAheadResidentBytes.increment( residentBytes );
+            readAheadThrottle.release( residentBytes );
+        }
     }
 
     MmapV1ExtentManager::FilesArray::~FilesArray() {
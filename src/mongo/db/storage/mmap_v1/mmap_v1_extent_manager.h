@@ -39,6 +39,7 @@
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/db/storage/mmap_v1/diskloc.h"
 #include "mongo/db/storage/mmap_v1/extent_manager.h"
+#include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/db/storage/mmap_v1/record_access_tracker.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
@@ -155,6 +156,14 @@ namespace mongo {
 
         virtual CacheHint* cacheHint( const DiskLoc& extentLoc, const HintType& hint );
 
+        /**
+         * Skips the parts of the range which the RecordAccessTracker believes are in memory and
+         * hints the rest to the OS, within a read-ahead budget shared by all scans
+         * (mmapv1ReadAheadMaxMBPerSec) so that read-ahead cannot push the hot set out of memory
+         * faster than that.
+         */
+        virtual void readAhead( const DiskLoc& loc, int len ) const;
+
     private:
         /**
          * will return NULL if nothing suitable in free list
@@ -188,8 +197,26 @@ namespace mongo {
                                      int size,
                                      bool enforceQuota );
 
+        /**
+         * Asks the FileAllocator for the file after 'f', the last file, if the extent of
+         * 'extentSize' bytes just taken from 'f' made it cross mmapv1PreallocateNextFileRatio.
+         */
+        void _preallocateNextFileIfFilling( OperationContext* txn, DataFile* f, int extentSize );
+
         boost::filesystem::path _fileName(int n) const;
 
+        /**
+         * Counts an access to 'loc' for the "auto" mmapv1AccessPattern, and brings the advice
+         * given to the OS about the data files up to date with the parameter and the accesses.
+         */
+        void _sampleAccess( const DiskLoc& loc, bool inMemory ) const;
+
+        /**
+         * Gives 'advice' about the access pattern for all the open data files, unless they
+         * already have it.
+         */
+        void _setAccessAdvice( MAdvise::Advice advice ) const;
+
 // -----
 
         const std::string _dbname; // i.e. "test"
@@ -201,6 +228,19 @@ namespace mongo {
         // engine is valid. Not owned here.
         RecordAccessTracker* _recordAccessTracker;
 
+        // Access pattern for the data files: the version of mmapv1AccessPattern last applied,
+        // whether it is "auto" for this database, and the MAdvise::Advice the files have.
+        mutable AtomicUInt32 _accessPatternVersion;
+        mutable AtomicUInt32 _accessPatternAuto;
+        mutable AtomicUInt32 _accessAdvice;
+        mutable SimpleMutex _accessAdviceMutex; // serializes changes of the advice
+
+        // Accesses sampled since the "auto" pattern last chose advice
+        mutable AtomicUInt32 _accessSamples;
+        mutable AtomicUInt32 _accessMisses;
+        mutable AtomicUInt32 _accessSequential;
+        mutable AtomicUInt64 _lastAccess; // file number and offset of the last sampled access
+
         /**
          * Simple wrapper around an array object to allow append-only modification of the array,
          * as well as concurrent read-accesses. This class has a minimal interface to keep
@@ -71,8 +71,13 @@ namespace mongo {
     //  - If taken, must be after previewViews._m to prevent deadlocks
     mutex mapViewMutex;
 
-    MAdvise::MAdvise(void *,unsigned, Advice) { }
+    MAdvise::MAdvise(void *,unsigned, Advice, Advice) { }
     MAdvise::~MAdvise() { }
+    void adviseMappedRange(void *, size_t, MAdvise::Advice) { }
+    void adviseHugePages(void *, size_t) { }
+
+    // PrefetchVirtualMemory requires Windows 8, so there is no prefetching here.
+    void prefetchMappedRange(const void *, size_t) { }
 
     const unsigned long long memoryMappedFileLocationFloor = 256LL * 1024LL * 1024LL * 1024LL;
     static unsigned long long _nextMemoryMappedFileLocation = memoryMappedFileLocationFloor;
@@ -153,11 +158,17 @@ namespace mongo {
         : _uniqueId(mmfNextId.fetchAndAdd(1)),
           fd(0),
           maphandle(0),
-          len(0) {
+          len(0),
+          _accessAdvice(MAdvise::Normal) {
 
         created();
     }
 
+    void MemoryMappedFile::setAccessAdvice(MAdvise::Advice a) {
+        // Windows only takes access hints when a file is opened
+        _accessAdvice = a;
+    }
+
     void MemoryMappedFile::close() {
         LockMongoFilesShared::assertExclusivelyLocked();
 
@@ -413,24 +413,56 @@ namespace mongo {
         return true;
     }
 
-    Status RecordStoreV1Base::updateWithDamages( OperationContext* txn,
-                                                 const RecordId& loc,
-                                                 const RecordData& oldRec,
-                                                 const char* damageSource,
-                                                 const mutablebson::DamageVector& damages ) {
+    bool RecordStoreV1Base::updateWithSplicesSupported() const {
+        return true;
+    }
+
+    StatusWith<RecordData> RecordStoreV1Base::updateWithDamages(
+            OperationContext* txn,
+            const RecordId& loc,
+            const RecordData& oldRec,
+            const char* damageSource,
+            const mutablebson::DamageVector& damages ) {
         MmapV1RecordHeader* rec = recordFor( DiskLoc::fromRecordId(loc) );
         char* root = rec->data();
 
-        // All updates were in place. Apply them via durability and writing pointer.
+        const int oldSize = oldRec.size();
+        const int newSize = mutablebson::sizeAfterDamages(oldSize, damages);
+        if ( newSize > rec->netLength() ) {
+            return StatusWith<RecordData>( ErrorCodes::NeedsDocumentMove,
+                                           "spliced record does not fit in its allocation" );
+        }
+
+        // Apply the damages that come before the first splice via durability and writing
+        // pointer, like an in place update.
         mutablebson::DamageVector::const_iterator where = damages.begin();
         const mutablebson::DamageVector::const_iterator end = damages.end();
-        for( ; where != end; ++where ) {
+        for( ; where != end && where->growth == 0; ++where ) {
             const char* sourcePtr = damageSource + where->sourceOffset;
             void* targetPtr = txn->recoveryUnit()->writingPtr(root + where->targetOffset, where->size);
             std::memcpy(targetPtr, sourcePtr, where->size);
         }
 
-        return Status::OK();
+        if ( where != end ) {
+            // Everything from the first splice on moves, so build the new tail of the record
+            // from the remaining damages off to the side and write it out in one go. A push onto
+            // an array near the end of a large document only writes that far.
+            const int tailOffset = where->targetOffset;
+            mutablebson::DamageVector tailDamages(where, end);
+            for ( mutablebson::DamageVector::iterator it = tailDamages.begin();
+                  it != tailDamages.end(); ++it ) {
+                it->targetOffset -= tailOffset;
+            }
+
+            std::unique_ptr<char[]> tail( new char[newSize - tailOffset] );
+            mutablebson::applyDamages( root + tailOffset, oldSize - tailOffset, damageSource,
+                                       tailDamages, tail.get() );
+            void* targetPtr = txn->recoveryUnit()->writingPtr(root + tailOffset,
+                                                              newSize - tailOffset);
+            std::memcpy(targetPtr, tail.get(), newSize - tailOffset);
+        }
+
+        return StatusWith<RecordData>(RecordData(root, newSize));
     }
 
     void RecordStoreV1Base::deleteRecord( OperationContext* txn, const RecordId& rid ) {
@@ -917,6 +949,37 @@ namespace mongo {
         return Status::OK();
     }
 
+    void RecordStoreV1Base::readAhead( const RecordId& loc, int len ) const {
+        _extentManager->readAhead( DiskLoc::fromRecordId( loc ), len );
+    }
+
+    namespace {
+        // How much of each record readAheadRecords() asks for. Record sizes aren't known without
+        // reading the record headers, which is what the read-ahead must not wait for.
+        const long long kReadAheadRecordBytes = 4096;
+    }
+
+    void RecordStoreV1Base::readAheadRecords( const std::vector<RecordId>& ids ) const {
+        DiskLoc begin;
+        long long end = 0;
+        for ( const RecordId& id : ids ) {
+            const DiskLoc loc = DiskLoc::fromRecordId( id );
+            const long long ofs = loc.getOfs();
+            if ( !begin.isNull() && loc.a() == begin.a() && ofs <= end ) {
+                end = std::max( end, ofs + kReadAheadRecordBytes );
+                continue;
+            }
+            if ( !begin.isNull() ) {
+                _extentManager->readAhead( begin, static_cast<int>( end - begin.getOfs() ) );
+            }
+            begin = loc;
+            end = ofs + kReadAheadRecordBytes;
+        }
+        if ( !begin.isNull() ) {
+            _extentManager->readAhead( begin, static_cast<int>( end - begin.getOfs() ) );
+        }
+    }
+
     boost::optional<Record> RecordStoreV1Base::IntraExtentIterator::next() {
         if (_curr.isNull()) return {};
         auto out = _curr.toRecordId();
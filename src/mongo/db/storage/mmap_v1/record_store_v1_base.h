@@ -206,11 +206,14 @@ namespace mongo {
 
         virtual bool updateWithDamagesSupported() const;
 
-        virtual Status updateWithDamages( OperationContext* txn,
-                                          const RecordId& loc,
-                                          const RecordData& oldRec,
-                                          const char* damageSource,
-                                          const mutablebson::DamageVector& damages );
+        virtual bool updateWithSplicesSupported() const;
+
+        virtual StatusWith<RecordData> updateWithDamages(
+                OperationContext* txn,
+                const RecordId& loc,
+                const RecordData& oldRec,
+                const char* damageSource,
+                const mutablebson::DamageVector& damages );
 
         virtual std::unique_ptr<RecordCursor> getCursorForRepair( OperationContext* txn ) const;
 
@@ -227,6 +230,14 @@ namespace mongo {
 
         virtual Status touch( OperationContext* txn, BSONObjBuilder* output ) const;
 
+        virtual void readAhead( const RecordId& loc, int len ) const;
+
+        /**
+         * Reads ahead the start of each of these records, given in ascending order, merging the
+         * ranges of records which are close together in a file. Used by RecordCursor::prefetch().
+         */
+        void readAheadRecords( const std::vector<RecordId>& ids ) const;
+
         const RecordStoreV1MetaData* details() const { return _details.get(); }
 
         // This keeps track of cursors saved during yielding, for invalidation purposes.
@@ -213,4 +213,8 @@ namespace mongo {
         return _recordStore->_extentManager->recordNeedsFetch(DiskLoc::fromRecordId(id));
     }
 
+    void CappedRecordStoreV1Iterator::prefetch(const std::vector<RecordId>& ids) {
+        _recordStore->readAheadRecords(ids);
+    }
+
 }  // namespace mongo
@@ -54,6 +54,7 @@ namespace mongo {
         void invalidate(const RecordId& dl) final;
         std::unique_ptr<RecordFetcher> fetcherForNext() const final;
         std::unique_ptr<RecordFetcher> fetcherForId(const RecordId& id) const final;
+        void prefetch(const std::vector<RecordId>& ids) final;
 
     private:
         void advance();
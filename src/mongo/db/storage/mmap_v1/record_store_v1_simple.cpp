@@ -261,6 +261,11 @@ namespace mongo {
         return cursors;
     }
 
+    std::unique_ptr<RecordCursor> SimpleRecordStoreV1::getRandomCursor(
+            OperationContext* txn) const {
+        return stdx::make_unique<SimpleRecordStoreV1RandomCursor>(txn, this);
+    }
+
     class CompactDocWriter : public DocWriter {
     public:
         /**
@@ -56,6 +56,8 @@ namespace mongo {
         std::vector<std::unique_ptr<RecordCursor>> getManyCursors(
             OperationContext* txn) const final;
 
+        std::unique_ptr<RecordCursor> getRandomCursor(OperationContext* txn) const final;
+
         virtual Status truncate(OperationContext* txn);
 
         virtual void temp_cappedTruncateAfter(OperationContext* txn, RecordId end, bool inclusive) {
@@ -95,6 +97,7 @@ namespace mongo {
         bool _normalCollection;
 
         friend class SimpleRecordStoreV1Iterator;
+        friend class SimpleRecordStoreV1RandomCursor;
     };
 
 }
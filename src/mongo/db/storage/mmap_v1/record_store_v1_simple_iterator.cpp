@@ -28,13 +28,23 @@
 
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple_iterator.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/extent.h"
 #include "mongo/db/storage/mmap_v1/extent_manager.h"
+#include "mongo/db/storage/mmap_v1/record.h"
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple.h"
+#include "mongo/platform/random.h"
 
 namespace mongo {
 
+    // How far ahead of a collection scan, in its data file, read-ahead is requested. 0 turns it
+    // off for collection scans.
+    MONGO_EXPORT_SERVER_PARAMETER(mmapv1ScanReadAheadKB, int, 1024);
+
     //
     // Regular / non-capped collection traversal
     //
@@ -79,6 +89,8 @@ namespace mongo {
             // valid e->xprev
             _curr = e->lastRecord;
         }
+
+        readAhead();
     }
 
     boost::optional<Record> SimpleRecordStoreV1Iterator::next() {
@@ -103,9 +115,44 @@ namespace mongo {
             else {
                 _curr = _recordStore->getPrevRecord( _txn, _curr );
             }
+            readAhead();
         }
     }
 
+    void SimpleRecordStoreV1Iterator::readAhead() {
+        const long long window = mmapv1ScanReadAheadKB * 1024LL;
+        if (isEOF() || window <= 0) {
+            return;
+        }
+
+        // Keep the requested range at least half a window ahead of the scan. The range restarts
+        // at the current record when the scan moves to another file or outside of the range,
+        // which records reused from the freelist make common.
+        const long long ofs = _curr.getOfs();
+        long long from = ofs;
+        if (!_readAheadEnd.isNull() && _readAheadEnd.a() == _curr.a()) {
+            const long long end = _readAheadEnd.getOfs();
+            const long long ahead = _forward ? end - ofs : ofs - end;
+            if (ahead >= 0 && ahead <= window) {
+                if (ahead > window / 2) {
+                    return;
+                }
+                from = end;
+            }
+        }
+
+        const long long to = _forward
+            ? std::min<long long>(from + window, std::numeric_limits<int>::max())
+            : std::max<long long>(from - window, 0);
+        if (to == from) {
+            return;
+        }
+        const long long begin = std::min(from, to);
+        _recordStore->_extentManager->readAhead(DiskLoc(_curr.a(), begin),
+                                                std::max(from, to) - begin);
+        _readAheadEnd = DiskLoc(_curr.a(), to);
+    }
+
     void SimpleRecordStoreV1Iterator::invalidate(const RecordId& dl) {
         // Just move past the thing being deleted.
         if (dl == _curr.toRecordId()) {
@@ -131,4 +178,141 @@ namespace mongo {
             const RecordId& id) const {
         return _recordStore->_extentManager->recordNeedsFetch(DiskLoc::fromRecordId(id));
     }
+
+    void SimpleRecordStoreV1Iterator::prefetch(const std::vector<RecordId>& ids) {
+        _recordStore->readAheadRecords(ids);
+    }
+
+    //
+    // Random records of a non-capped collection
+    //
+
+namespace {
+    // How many random offsets are tried before settling for the first record of an extent,
+    // should they all fall in deleted space.
+    const int kMaxRandomCursorAttempts = 100;
+}
+
+    SimpleRecordStoreV1RandomCursor::SimpleRecordStoreV1RandomCursor(
+            OperationContext* txn,
+            const SimpleRecordStoreV1* records)
+        : _txn(txn)
+        , _recordStore(records)
+        , _random(std::unique_ptr<SecureRandom>(SecureRandom::create())->nextInt64()) {
+    }
+
+    boost::optional<Record> SimpleRecordStoreV1RandomCursor::next() {
+        const DiskLoc loc = pick();
+        if (loc.isNull()) return {};
+        auto id = loc.toRecordId();
+        return {{id, _recordStore->RecordStore::dataFor(_txn, id)}};
+    }
+
+    boost::optional<Record> SimpleRecordStoreV1RandomCursor::seekExact(const RecordId& id) {
+        invariant(!"seekExact not supported");
+    }
+
+    void SimpleRecordStoreV1RandomCursor::savePositioned() {
+        _txn = nullptr;
+        _spansLoaded = false;
+    }
+
+    bool SimpleRecordStoreV1RandomCursor::restore(OperationContext* txn) {
+        _txn = txn;
+        // if the collection is dropped, then the cursor should be destroyed
+        return true;
+    }
+
+    void SimpleRecordStoreV1RandomCursor::loadSpans() {
+        const ExtentManager* em = _recordStore->_extentManager;
+        _spans.clear();
+        _totalSpan = 0;
+
+        const Extent* e;
+        for (DiskLoc extLoc = _recordStore->details()->firstExtent(_txn);
+                !extLoc.isNull();
+                extLoc = e->xnext) {
+            e = em->getExtent(extLoc);
+            if (e->firstRecord.isNull())
+                continue;
+
+            // Records are allocated at offsets that are a multiple of 4 from the start of the
+            // extent's data, and mostly appended after each other, so the space after the record
+            // ending last is all deleted.
+            ExtentSpan span;
+            span.extent = extLoc;
+            span.begin = extLoc.getOfs() + Extent::HeaderSize();
+            span.end = span.begin;
+            const DiskLoc ends[] = {e->firstRecord, e->lastRecord};
+            for (const DiskLoc& loc : ends) {
+                span.end = std::max(span.end,
+                                    loc.getOfs() + em->recordForV1(loc)->lengthWithHeaders());
+            }
+            _totalSpan += span.end - span.begin;
+            span.cumulativeEnd = _totalSpan;
+            _spans.push_back(span);
+        }
+        _spansLoaded = true;
+    }
+
+    DiskLoc SimpleRecordStoreV1RandomCursor::pick() {
+        if (!_spansLoaded) {
+            loadSpans();
+        }
+        if (_spans.empty()) {
+            return DiskLoc();
+        }
+
+        const ExtentManager* em = _recordStore->_extentManager;
+        for (int attempt = 0; attempt < kMaxRandomCursorAttempts; attempt++) {
+            const long long point =
+                static_cast<unsigned long long>(_random.nextInt64()) % _totalSpan;
+            const auto it = std::upper_bound(_spans.begin(), _spans.end(), point,
+                                             [](long long p, const ExtentSpan& span) {
+                                                 return p < span.cumulativeEnd;
+                                             });
+            invariant(it != _spans.end());
+            const Extent* e = em->getExtent(it->extent);
+            const long long extentEnd = it->extent.getOfs() + e->length;
+
+            // Walk back from the offset to the start of the record it falls in, which is at most
+            // the largest allocation away.
+            const long long intoSpan = point - (it->cumulativeEnd - (it->end - it->begin));
+            long long ofs = std::min<long long>(it->begin + (intoSpan & ~3LL),
+                                                extentEnd - MmapV1RecordHeader::HeaderSize);
+            const long long lowest =
+                std::max<long long>(it->begin, ofs - RecordStoreV1Base::MaxAllowedAllocation);
+            for (; ofs >= lowest; ofs -= 4) {
+                if (isRecordStart(e, it->extent, ofs)) {
+                    return DiskLoc(it->extent.a(), ofs);
+                }
+            }
+        }
+
+        const size_t i = static_cast<uint32_t>(_random.nextInt32()) % _spans.size();
+        return em->getExtent(_spans[i].extent)->firstRecord;
+    }
+
+    bool SimpleRecordStoreV1RandomCursor::isRecordStart(const Extent* e,
+                                                        const DiskLoc& extentLoc,
+                                                        int ofs) const {
+        // Deleted space holds stale headers, and documents can hold anything, but the record before
+        // a record in its extent's list is the only one to point at it.
+        const ExtentManager* em = _recordStore->_extentManager;
+        const DiskLoc loc(extentLoc.a(), ofs);
+        const MmapV1RecordHeader* r = em->recordForV1(loc);
+        if (r->extentOfs() != extentLoc.getOfs()) {
+            return false;
+        }
+
+        const int prevOfs = r->prevOfs();
+        if (prevOfs == DiskLoc::NullOfs) {
+            return e->firstRecord == loc;
+        }
+        if (prevOfs < extentLoc.getOfs() + Extent::HeaderSize() ||
+                prevOfs > extentLoc.getOfs() + e->length - MmapV1RecordHeader::HeaderSize) {
+            return false;
+        }
+        return em->recordForV1(DiskLoc(extentLoc.a(), prevOfs))->nextOfs() == ofs;
+    }
 }
@@ -28,12 +28,16 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/db/storage/mmap_v1/diskloc.h"
 #include "mongo/db/storage/record_store.h"
+#include "mongo/platform/random.h"
 
 namespace mongo {
 
     class SimpleRecordStoreV1;
+    struct Extent;
 
     /**
      * This class iterates over a non-capped collection identified by 'ns'.
@@ -54,9 +58,11 @@ namespace mongo {
         void invalidate(const RecordId& dl) final;
         std::unique_ptr<RecordFetcher> fetcherForNext() const final;
         std::unique_ptr<RecordFetcher> fetcherForId(const RecordId& id) const final;
+        void prefetch(const std::vector<RecordId>& ids) final;
 
     private:
         void advance();
+        void readAhead();
         bool isEOF() { return _curr.isNull(); }
 
          // for getNext, not owned
@@ -66,6 +72,55 @@ namespace mongo {
         DiskLoc _curr;
         const SimpleRecordStoreV1* const _recordStore;
         const bool _forward;
+
+        // Where the range last handed to ExtentManager::readAhead() ends, in scan direction.
+        DiskLoc _readAheadEnd;
+    };
+
+    /**
+     * Returns records of a non-capped collection picked at random, by picking a random offset in
+     * a random extent, extents being weighted by the space their records span, and returning the
+     * record found at that offset. A record is thus about as likely to be picked as its size in
+     * the extent, including the deleted space right after it.
+     */
+    class SimpleRecordStoreV1RandomCursor final : public RecordCursor {
+    public:
+        SimpleRecordStoreV1RandomCursor(OperationContext* txn,
+                                        const SimpleRecordStoreV1* records);
+
+        boost::optional<Record> next() final;
+        boost::optional<Record> seekExact(const RecordId& id) final;
+        void savePositioned() final;
+        bool restore(OperationContext* txn) final;
+
+    private:
+        // The span of an extent, in its file, from its first byte of data to the end of its
+        // first or last record, whichever ends later.
+        struct ExtentSpan {
+            DiskLoc extent;
+            int begin;
+            int end;
+            long long cumulativeEnd; // of the spans up to this one
+        };
+
+        // Recomputes _spans, which can change whenever the collection isn't locked.
+        void loadSpans();
+
+        // Picks the record to return next, or DiskLoc() if the collection is empty.
+        DiskLoc pick();
+
+        // Returns whether a record of the extent starts at 'ofs'.
+        bool isRecordStart(const Extent* e, const DiskLoc& extentLoc, int ofs) const;
+
+        // for next(), not owned
+        OperationContext* _txn;
+
+        const SimpleRecordStoreV1* const _recordStore;
+        PseudoRandom _random;
+
+        std::vector<ExtentSpan> _spans;
+        long long _totalSpan = 0;
+        bool _spansLoaded = false;
     };
 
 }  // namespace mongo
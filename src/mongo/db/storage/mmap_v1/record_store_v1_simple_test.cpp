@@ -30,6 +30,8 @@
 
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple.h"
 
+#include <set>
+
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/storage/mmap_v1/extent.h"
 #include "mongo/db/storage/mmap_v1/record.h"
@@ -41,6 +43,20 @@ using namespace mongo;
 namespace {
 
     using std::string;
+    using std::vector;
+
+    /**
+     * Remembers the ranges it is asked to read ahead.
+     */
+    class ReadAheadRecordingExtentManager : public DummyExtentManager {
+    public:
+        virtual void readAhead( const DiskLoc& loc, int len ) const {
+            LocAndSize request = {loc, len};
+            requests.push_back( request );
+        }
+
+        mutable vector<LocAndSize> requests;
+    };
 
     TEST( SimpleRecordStoreV1, quantizeAllocationSpaceSimple ) {
         ASSERT_EQUALS(RecordStoreV1Base::quantizeAllocationSpace(33), 64);
@@ -537,4 +553,105 @@ namespace {
             assertStateV1RS(&txn, recs, drecs, NULL, &em, md);
         }
     }
+
+    /**
+     * Scans request read-ahead from the records they reach, once per window and file, in the
+     * direction of the scan.
+     */
+    TEST( SimpleRecordStoreV1, ScanReadsAhead ) {
+        OperationContextNoop txn;
+        ReadAheadRecordingExtentManager em;
+        DummyRecordStoreV1MetaData* md = new DummyRecordStoreV1MetaData( false, 0 );
+        SimpleRecordStoreV1 rs( &txn, "test.foo", md, &em, false );
+
+        {
+            LocAndSize recs[] = {
+                {DiskLoc(0, 1000), 100},
+                {DiskLoc(0, 1100), 100},
+                {DiskLoc(0, 1300), 100},
+                {DiskLoc(2, 1100), 100},
+                {}
+            };
+            initializeV1RS(&txn, recs, NULL, NULL, &em, md);
+        }
+
+        const int window = 1024 * 1024;
+
+        auto cursor = rs.getCursor( &txn, true );
+        int n = 0;
+        while ( cursor->next() ) {
+            n++;
+        }
+        ASSERT_EQUALS( 4, n );
+        ASSERT_EQUALS( 2U, em.requests.size() );
+        ASSERT_EQUALS( DiskLoc(0, 1000), em.requests[0].loc );
+        ASSERT_EQUALS( window, em.requests[0].size );
+        ASSERT_EQUALS( DiskLoc(2, 1100), em.requests[1].loc );
+        ASSERT_EQUALS( window, em.requests[1].size );
+
+        em.requests.clear();
+        cursor = rs.getCursor( &txn, false );
+        n = 0;
+        while ( cursor->next() ) {
+            n++;
+        }
+        ASSERT_EQUALS( 4, n );
+        ASSERT_EQUALS( 2U, em.requests.size() );
+        ASSERT_EQUALS( DiskLoc(2, 0), em.requests[0].loc );
+        ASSERT_EQUALS( 1100, em.requests[0].size );
+        ASSERT_EQUALS( DiskLoc(0, 0), em.requests[1].loc );
+        ASSERT_EQUALS( 1300, em.requests[1].size );
+    }
+
+    /**
+     * Random cursors only return records of the collection, sooner or later every one of them,
+     * including past deleted space, and are at EOF on an empty collection.
+     */
+    TEST( SimpleRecordStoreV1, RandomCursor ) {
+        OperationContextNoop txn;
+        DummyExtentManager em;
+        DummyRecordStoreV1MetaData* md = new DummyRecordStoreV1MetaData( false, 0 );
+        SimpleRecordStoreV1 rs( &txn, "test.foo", md, &em, false );
+
+        ASSERT_FALSE( rs.getRandomCursor( &txn )->next() );
+
+        {
+            LocAndSize recs[] = {
+                {DiskLoc(0, 1000), 100},
+                {DiskLoc(0, 1100), 100},
+                {DiskLoc(0, 1300), 100},
+                {DiskLoc(2, 1100), 100},
+                {}
+            };
+            LocAndSize drecs[] = {
+                {DiskLoc(0, 1200), 100},
+                {DiskLoc(2, 1000), 100},
+                {DiskLoc(1, 1000), 1000},
+                {}
+            };
+            initializeV1RS(&txn, recs, drecs, NULL, &em, md);
+        }
+
+        std::set<RecordId> expected;
+        expected.insert( DiskLoc(0, 1000).toRecordId() );
+        expected.insert( DiskLoc(0, 1100).toRecordId() );
+        expected.insert( DiskLoc(0, 1300).toRecordId() );
+        expected.insert( DiskLoc(2, 1100).toRecordId() );
+
+        auto cursor = rs.getRandomCursor( &txn );
+        std::set<RecordId> seen;
+        for ( int i = 0; i < 1000; i++ ) {
+            auto record = cursor->next();
+            ASSERT( record );
+            ASSERT_EQUALS( 1U, expected.count( record->id ) );
+            seen.insert( record->id );
+
+            // The cursor starts over from the extents after yielding.
+            if ( i == 500 ) {
+                cursor->savePositioned();
+                ASSERT( cursor->restore( &txn ) );
+            }
+        }
+        ASSERT_EQUALS( expected.size(), seen.size() );
+    }
 }
@@ -31,6 +31,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -189,6 +190,28 @@ namespace mongo {
          */
         virtual void invalidate(const RecordId& id) {};
 
+        /**
+         * Lets next() and seekExact() return record data straight from the storage engine's
+         * memory, which is only valid until the next call on this cursor, rather than a copy.
+         * Returns true if the cursor will do so. Callers that get true back must copy any
+         * unowned record data they keep past their next call on the cursor.
+         *
+         * Returns false, changing nothing, if the unowned data this cursor returns already
+         * stays valid until the cursor is saved, or if it can't avoid copying.
+         */
+        virtual bool allowShortLivedData() { return false; }
+
+        /**
+         * Hints that the records with these ids, given in ascending order, are about to be read
+         * with seekExact(), so that the storage engine can start reading them in, in the order
+         * they are stored, before they are asked for one by one. Ids of records that don't exist
+         * are allowed.
+         *
+         * The cursor's position afterwards is unspecified, as after saveUnpositioned(): the
+         * next call must be seekExact().
+         */
+        virtual void prefetch(const std::vector<RecordId>& ids) {}
+
         //
         // RecordFetchers
         //
@@ -214,6 +237,31 @@ namespace mongo {
         virtual std::unique_ptr<RecordFetcher> fetcherForId(const RecordId& id) const { return {}; }
     };
 
+    /**
+     * Appends records to an empty RecordStore without a transaction per record, for populating
+     * newly created collections, e.g. during initial sync.
+     *
+     * Records are written outside of any WriteUnitOfWork and are not removed if the operation
+     * fails part way, so the caller has to drop the collection in that case. Records may not be
+     * visible to readers until commit() is called, and nothing else may write to the RecordStore
+     * while a loader for it exists.
+     */
+    class RecordStoreBulkLoader {
+    public:
+        virtual ~RecordStoreBulkLoader() { }
+
+        /**
+         * Appends a record, which is assigned a RecordId greater than any added before it.
+         */
+        virtual StatusWith<RecordId> addRecord(const char* data, int len) = 0;
+
+        /**
+         * Makes all added records visible. No more records may be added afterwards. Destroying a
+         * loader commits it if this hasn't been called.
+         */
+        virtual void commit() = 0;
+    };
+
     /**
      * A RecordStore provides an abstraction used for storing documents in a collection,
      * or entries in an index. In storage engines implementing the KVEngine, record stores
@@ -316,6 +364,53 @@ namespace mongo {
                                                   const DocWriter* doc,
                                                   bool enforceQuota ) = 0;
 
+        /**
+         * Inserts 'records' in order and sets their ids, stopping at the first failure. Record
+         * stores can override this to share the work of inserting them, by default they are
+         * inserted one at a time.
+         */
+        virtual Status insertRecords(OperationContext* txn,
+                                     std::vector<Record>* records,
+                                     bool enforceQuota) {
+            for (auto& record : *records) {
+                StatusWith<RecordId> res =
+                    insertRecord(txn, record.data.data(), record.data.size(), enforceQuota);
+                if (!res.isOK())
+                    return res.getStatus();
+                record.id = res.getValue();
+            }
+            return Status::OK();
+        }
+
+        /**
+         * Returns whether insertRecordWithId() is supported.
+         */
+        virtual bool supportsInsertWithId() const {
+            return false;
+        }
+
+        /**
+         * Inserts a record at 'id', which must be a normal RecordId. Fails with DuplicateKey if
+         * there is a record at 'id' already.
+         */
+        virtual Status insertRecordWithId(OperationContext* txn,
+                                          const RecordId& id,
+                                          const char* data,
+                                          int len,
+                                          bool enforceQuota) {
+            return Status(ErrorCodes::CommandNotSupported,
+                          "this record store can't insert records with a given id");
+        }
+
+        /**
+         * Returns a loader for appending records to this RecordStore, which must be empty, or
+         * nothing if bulk loading isn't supported, in which case records have to be inserted with
+         * insertRecord().
+         */
+        virtual std::unique_ptr<RecordStoreBulkLoader> makeBulkLoader(OperationContext* txn) {
+            return {};
+        }
+
         /**
          * @param notifier - Only used by record stores which do not support doc-locking.
          *                   In the case of a document move, this is called after the document
@@ -341,11 +436,31 @@ namespace mongo {
          */
         virtual bool updateWithDamagesSupported() const = 0;
 
-        virtual Status updateWithDamages( OperationContext* txn,
-                                          const RecordId& loc,
-                                          const RecordData& oldRec,
-                                          const char* damageSource,
-                                          const mutablebson::DamageVector& damages ) = 0;
+        /**
+         * @return Returns 'true' if 'updateWithDamages' also accepts damage vectors containing
+         * splices, which change the size of the record (see DamageEvent). Record stores that
+         * rewrite the whole record for every update gain nothing from them and return 'false';
+         * size changing updates then go through 'updateRecord'.
+         */
+        virtual bool updateWithSplicesSupported() const { return false; }
+
+        /**
+         * Updates the record at 'loc', whose current contents are 'oldRec', by copying the byte
+         * ranges described by 'damages' from 'damageSource' over it. The size of the record only
+         * changes if 'damages' contains splices, which may only be passed if
+         * 'updateWithSplicesSupported' returns true.
+         *
+         * @return the updated record. It refers to the same memory as 'oldRec' if the record
+         * store modifies records where they live, and to a new buffer otherwise. Fails with
+         * NeedsDocumentMove, without modifying the record, if the spliced record does not fit
+         * where the record lives; callers must then fall back to 'updateRecord'.
+         */
+        virtual StatusWith<RecordData> updateWithDamages(
+                OperationContext* txn,
+                const RecordId& loc,
+                const RecordData& oldRec,
+                const char* damageSource,
+                const mutablebson::DamageVector& damages ) = 0;
 
         /**
          * Returns a new cursor over this record store.
@@ -388,6 +503,19 @@ namespace mongo {
             return out;
         }
 
+        /**
+         * Constructs a cursor whose next() returns Records picked at random, for sampling the
+         * store in time proportional to the sample size. The same Record may be returned more
+         * than once, and the cursor only reaches EOF if the store is empty. Returns NULL if not
+         * supported, in which case callers sample a regular cursor instead.
+         *
+         * Random cursors are only required to support next(), so it is illegal to call
+         * seekExact() on the returned cursor.
+         */
+        virtual std::unique_ptr<RecordCursor> getRandomCursor(OperationContext* txn) const {
+            return {};
+        }
+
         // higher level
 
 
@@ -421,6 +549,20 @@ namespace mongo {
          */
         virtual bool compactsInPlace() const { invariant(false); }
 
+        /**
+         * Can compact() run with only an intent lock on the collection, stopping after
+         * CompactOptions::timeSliceSecs when CompactOptions::online is set?
+         *
+         * Only called if compactsInPlace() returns true.
+         */
+        virtual bool compactsOnline() const { return false; }
+
+        /**
+         * How many bytes of storageSize() are free space that compact() could give back, or 0 if
+         * the RecordStore doesn't know.
+         */
+        virtual int64_t freeStorageSize( OperationContext* txn ) const { return 0; }
+
         /**
          * Attempt to reduce the storage space used by this RecordStore.
          *
@@ -468,6 +610,13 @@ namespace mongo {
                           "this storage engine does not support touch");
         }
 
+        /**
+         * Hints that the first 'len' bytes of the record at 'loc' will be read soon, so that a
+         * storage engine which can fetch data ahead of use does so without blocking the caller.
+         * Purely advisory; does nothing by default.
+         */
+        virtual void readAhead(const RecordId& loc, int len) const { }
+
         /**
          * Return the RecordId of an oplog entry as close to startingPosition as possible without
          * being higher. If there are no entries <= startingPosition, return RecordId().
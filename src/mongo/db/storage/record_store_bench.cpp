@@ -0,0 +1,154 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/initializer.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/record_store_test_harness.h"
+#include "mongo/db/storage/storage_bench.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/signal_handlers_synchronous.h"
+
+/**
+ * Benchmarks the RecordStore of the engine whose record_store_test_harness HarnessHelper this is
+ * linked with. See storage_bench.h.
+ */
+
+namespace mongo {
+namespace {
+
+    using std::unique_ptr;
+    using std::vector;
+
+    const int kRecordSize = 100;
+    const int kScanLength = 100;
+
+    void benchRecordStore(StorageBenchmark* bench, int threads) {
+        unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+        unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+        const bool serialize = !harnessHelper->supportsDocLocking();
+        const int ops = bench->opsPerThread();
+        const auto newTxn = [&] { return harnessHelper->newOperationContext(); };
+
+        const vector<char> record(kRecordSize, 'x');
+        vector<vector<RecordId>> ids(threads, vector<RecordId>(ops));
+
+        // Each thread works on the records it inserted, so writes only conflict in the engine's
+        // own data structures, and the lookups are spread over all threads' records.
+        const auto idFor = [&](int thread, int op) -> const RecordId& {
+            const int which = (thread * 7919 + op * 104729) % (threads * ops);
+            return ids[which % threads][which / threads];
+        };
+
+        bench->run("insert", threads, serialize, newTxn,
+                   [&](OperationContext* txn, int thread, int op) {
+            WriteUnitOfWork wuow(txn);
+            StatusWith<RecordId> res = rs->insertRecord(txn, &record[0], kRecordSize, false);
+            uassertStatusOK(res.getStatus());
+            wuow.commit();
+            ids[thread][op] = res.getValue();
+        });
+
+        if (ids.back().back().isNull()) {
+            // The inserts were filtered out, but the other workloads still need the records.
+            unique_ptr<OperationContext> txn(newTxn());
+            for (int op = 0; op < ops; op++) {
+                for (int thread = 0; thread < threads; thread++) {
+                    WriteUnitOfWork wuow(txn.get());
+                    ids[thread][op] = uassertStatusOK(rs->insertRecord(txn.get(), &record[0],
+                                                                       kRecordSize, false));
+                    wuow.commit();
+                }
+            }
+        }
+
+        bench->run("update", threads, serialize, newTxn,
+                   [&](OperationContext* txn, int thread, int op) {
+            WriteUnitOfWork wuow(txn);
+            StatusWith<RecordId> res = rs->updateRecord(txn, ids[thread][op], &record[0],
+                                                        kRecordSize, false, NULL);
+            uassertStatusOK(res.getStatus());
+            wuow.commit();
+            ids[thread][op] = res.getValue();
+        });
+
+        bench->run("pointLookup", threads, serialize, newTxn,
+                   [&](OperationContext* txn, int thread, int op) {
+            RecordData data;
+            rs->findRecord(txn, idFor(thread, op), &data);
+            txn->recoveryUnit()->abandonSnapshot();
+        });
+
+        bench->run("rangeScan", threads, serialize, newTxn,
+                   [&](OperationContext* txn, int thread, int op) {
+            auto cursor = rs->getCursor(txn);
+            bool more = bool(cursor->seekExact(idFor(thread, op)));
+            for (int i = 1; more && i < kScanLength; i++) {
+                more = bool(cursor->next());
+            }
+            cursor.reset();
+            txn->recoveryUnit()->abandonSnapshot();
+        });
+
+        // Yields between every record, as a query does when it is interrupted by lock
+        // contention, restarting each cursor when it hits the end.
+        vector<unique_ptr<RecordCursor>> cursors(threads);
+        bench->run("cursorSaveRestore", threads, serialize, newTxn,
+                   [&](OperationContext* txn, int thread, int op) {
+            unique_ptr<RecordCursor>& cursor = cursors[thread];
+            if (!cursor) cursor = rs->getCursor(txn);
+            if (!cursor->next()) cursor = rs->getCursor(txn);
+
+            cursor->savePositioned();
+            txn->recoveryUnit()->abandonSnapshot();
+            if (!cursor->restore(txn)) cursor.reset();
+
+            // The cursor must not outlive the OperationContext of its thread.
+            if (op == ops - 1) cursor.reset();
+        });
+    }
+
+} // namespace
+} // namespace mongo
+
+int main(int argc, char** argv, char** envp) {
+    ::mongo::setupSynchronousSignalHandlers();
+    ::mongo::runGlobalInitializersOrDie(argc, argv, envp);
+
+    ::mongo::StorageBenchmark bench("recordStore", argc, argv);
+    for (int threads : bench.threadCounts()) {
+        ::mongo::benchRecordStore(&bench, threads);
+    }
+    return bench.report();
+}
@@ -46,6 +46,12 @@ namespace mongo {
         virtual RecordStore* newNonCappedRecordStore() = 0;
         virtual RecoveryUnit* newRecoveryUnit() = 0;
 
+        /**
+         * Whether several threads may write to the same record store at once, without a
+         * collection lock around them. Used by the storage benchmarks.
+         */
+        virtual bool supportsDocLocking() const { return false; }
+
         virtual OperationContext* newOperationContext() {
             return new OperationContextNoop(_client.get(), 1, newRecoveryUnit());
         }
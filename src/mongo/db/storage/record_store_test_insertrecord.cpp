@@ -182,4 +182,56 @@ namespace mongo {
         }
     }
 
+    // Bulk load records into an empty record store and verify that they can be read back in the
+    // order they were added.
+    TEST( RecordStoreTestHarness, BulkLoadRecords ) {
+        unique_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+        unique_ptr<RecordStore> rs( harnessHelper->newNonCappedRecordStore() );
+
+        const int nToInsert = 10;
+        RecordId locs[nToInsert];
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            unique_ptr<RecordStoreBulkLoader> loader = rs->makeBulkLoader( opCtx.get() );
+            if ( !loader )
+                return;
+
+            for ( int i = 0; i < nToInsert; i++ ) {
+                stringstream ss;
+                ss << "record " << i;
+                string data = ss.str();
+
+                StatusWith<RecordId> res = loader->addRecord( data.c_str(), data.size() + 1 );
+                ASSERT_OK( res.getStatus() );
+                locs[i] = res.getValue();
+                if ( i > 0 )
+                    ASSERT_LESS_THAN( locs[i - 1], locs[i] );
+            }
+            loader->commit();
+        }
+
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            ASSERT_EQUALS( nToInsert, rs->numRecords( opCtx.get() ) );
+
+            auto cursor = rs->getCursor( opCtx.get() );
+            for ( int i = 0; i < nToInsert; i++ ) {
+                stringstream ss;
+                ss << "record " << i;
+
+                auto record = cursor->next();
+                ASSERT( record );
+                ASSERT_EQUALS( locs[i], record->id );
+                ASSERT_EQUALS( ss.str(), record->data.data() );
+            }
+            ASSERT( !cursor->next() );
+        }
+
+        // Only empty record stores can be bulk loaded.
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            ASSERT( !rs->makeBulkLoader( opCtx.get() ) );
+        }
+    }
+
 } // namespace mongo
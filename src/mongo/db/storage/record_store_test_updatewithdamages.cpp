@@ -91,7 +91,10 @@ namespace mongo {
                 dv[2].size = 3;
 
                 WriteUnitOfWork uow( opCtx.get() );
-                ASSERT_OK( rs->updateWithDamages( opCtx.get(), loc, rec, data.c_str(), dv ) );
+                StatusWith<RecordData> newRec =
+                    rs->updateWithDamages( opCtx.get(), loc, rec, data.c_str(), dv );
+                ASSERT_OK( newRec.getStatus() );
+                ASSERT_EQUALS( string( "11101000" ), newRec.getValue().data() );
                 uow.commit();
             }
         }
@@ -154,7 +157,9 @@ namespace mongo {
                 dv[1].size = 5;
 
                 WriteUnitOfWork uow( opCtx.get() );
-                ASSERT_OK( rs->updateWithDamages( opCtx.get(), loc, rec, data.c_str(), dv ) );
+                StatusWith<RecordData> newRec =
+                    rs->updateWithDamages( opCtx.get(), loc, rec, data.c_str(), dv );
+                ASSERT_OK( newRec.getStatus() );
                 uow.commit();
             }
         }
@@ -218,7 +223,9 @@ namespace mongo {
                 dv[1].size = 5;
 
                 WriteUnitOfWork uow( opCtx.get() );
-                ASSERT_OK( rs->updateWithDamages( opCtx.get(), loc, rec, data.c_str(), dv ) );
+                StatusWith<RecordData> newRec =
+                    rs->updateWithDamages( opCtx.get(), loc, rec, data.c_str(), dv );
+                ASSERT_OK( newRec.getStatus() );
                 uow.commit();
             }
         }
@@ -274,7 +281,9 @@ namespace mongo {
                 mutablebson::DamageVector dv;
 
                 WriteUnitOfWork uow( opCtx.get() );
-                ASSERT_OK( rs->updateWithDamages( opCtx.get(), loc, rec, "", dv ) );
+                StatusWith<RecordData> newRec =
+                    rs->updateWithDamages( opCtx.get(), loc, rec, "", dv );
+                ASSERT_OK( newRec.getStatus() );
                 uow.commit();
             }
         }
@@ -288,4 +297,121 @@ namespace mongo {
         }
     }
 
+    // Insert a record and splice a part of it out, shrinking it.
+    TEST( RecordStoreTestHarness, UpdateWithShrinkingSplice ) {
+        unique_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+        unique_ptr<RecordStore> rs( harnessHelper->newNonCappedRecordStore() );
+
+        if (!rs->updateWithSplicesSupported())
+            return;
+
+        string data = "abcdefgh";
+        RecordId loc;
+        const RecordData rec(data.c_str(), data.size() + 1);
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            WriteUnitOfWork uow( opCtx.get() );
+            StatusWith<RecordId> res = rs->insertRecord( opCtx.get(),
+                                                        rec.data(),
+                                                        rec.size(),
+                                                        false );
+            ASSERT_OK( res.getStatus() );
+            loc = res.getValue();
+            uow.commit();
+        }
+
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            {
+                // Overwrite "a" with "X", drop "cde", and replace "g" with "YZ".
+                const string source = "XYZ";
+                mutablebson::DamageVector dv( 3 );
+                dv[0].sourceOffset = 0;
+                dv[0].targetOffset = 0;
+                dv[0].size = 1;
+                dv[1].sourceOffset = 0;
+                dv[1].targetOffset = 2;
+                dv[1].size = 0;
+                dv[1].growth = -3;
+                dv[2].sourceOffset = 1;
+                dv[2].targetOffset = 6;
+                dv[2].size = 2;
+                dv[2].growth = 1;
+
+                WriteUnitOfWork uow( opCtx.get() );
+                StatusWith<RecordData> newRec =
+                    rs->updateWithDamages( opCtx.get(), loc, rec, source.c_str(), dv );
+                ASSERT_OK( newRec.getStatus() );
+                ASSERT_EQUALS( 7, newRec.getValue().size() );
+                ASSERT_EQUALS( string( "XbfYZh" ), newRec.getValue().data() );
+                uow.commit();
+            }
+        }
+
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            RecordData record = rs->dataFor( opCtx.get(), loc );
+            ASSERT_EQUALS( 7, record.size() );
+            ASSERT_EQUALS( string( "XbfYZh" ), record.data() );
+        }
+    }
+
+    // Insert a record and splice data into it, growing it. A record store that can't grow the
+    // record where it lives refuses without changing it.
+    TEST( RecordStoreTestHarness, UpdateWithGrowingSplice ) {
+        unique_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+        unique_ptr<RecordStore> rs( harnessHelper->newNonCappedRecordStore() );
+
+        if (!rs->updateWithSplicesSupported())
+            return;
+
+        string data = "abcd";
+        RecordId loc;
+        const RecordData rec(data.c_str(), data.size() + 1);
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            WriteUnitOfWork uow( opCtx.get() );
+            StatusWith<RecordId> res = rs->insertRecord( opCtx.get(),
+                                                        rec.data(),
+                                                        rec.size(),
+                                                        false );
+            ASSERT_OK( res.getStatus() );
+            loc = res.getValue();
+            uow.commit();
+        }
+
+        string expected = data;
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            {
+                // Insert "XYZ" after "ab".
+                const string source = "XYZ";
+                mutablebson::DamageVector dv( 1 );
+                dv[0].sourceOffset = 0;
+                dv[0].targetOffset = 2;
+                dv[0].size = 3;
+                dv[0].growth = 3;
+
+                WriteUnitOfWork uow( opCtx.get() );
+                StatusWith<RecordData> newRec =
+                    rs->updateWithDamages( opCtx.get(), loc, rec, source.c_str(), dv );
+                if ( newRec.isOK() ) {
+                    expected = "abXYZcd";
+                    ASSERT_EQUALS( 8, newRec.getValue().size() );
+                    ASSERT_EQUALS( expected, newRec.getValue().data() );
+                }
+                else {
+                    ASSERT_EQUALS( ErrorCodes::NeedsDocumentMove, newRec.getStatus() );
+                }
+                uow.commit();
+            }
+        }
+
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            RecordData record = rs->dataFor( opCtx.get(), loc );
+            ASSERT_EQUALS( expected, record.data() );
+        }
+    }
+
 } // namespace mongo
@@ -51,9 +51,53 @@ namespace mongo {
 
         virtual void reportState( BSONObjBuilder* b ) const { }
 
+        /**
+         * Counts of what the storage engine did for the operations which used this RecoveryUnit.
+         * They only grow, so an operation's share is the difference between their values at its
+         * start and at its end. They follow the OperationContext when it swaps RecoveryUnits. An
+         * engine counts what it can measure and leaves the rest at 0.
+         */
+        struct StorageStats {
+            StorageStats() : bytesRead(0), pagesRead(0), cacheWaitMicros(0), bytesWritten(0) { }
+
+            StorageStats since(const StorageStats& start) const {
+                StorageStats delta;
+                delta.bytesRead = bytesRead - start.bytesRead;
+                delta.pagesRead = pagesRead - start.pagesRead;
+                delta.cacheWaitMicros = cacheWaitMicros - start.cacheWaitMicros;
+                delta.bytesWritten = bytesWritten - start.bytesWritten;
+                return delta;
+            }
+
+            bool isEmpty() const {
+                return !bytesRead && !pagesRead && !cacheWaitMicros && !bytesWritten;
+            }
+
+            long long bytesRead;        // read from disk into the engine's cache
+            long long pagesRead;        // read from disk
+            long long cacheWaitMicros;  // waiting for pages to be read in, or for room in the cache
+            long long bytesWritten;     // of records and index entries
+        };
+
+        const StorageStats& getStorageStats() const { return _storageStats; }
+
+        /**
+         * For the storage engine to count what it does, and for the OperationContext to carry the
+         * counts over to the RecoveryUnit it swaps in.
+         */
+        StorageStats* storageStats() { return &_storageStats; }
+
         virtual void beingReleasedFromOperationContext() {}
         virtual void beingSetOnOperationContext() {}
 
+        /**
+         * Called at the end of an operation, so that the Client can use this RecoveryUnit for its
+         * next operation instead of creating a new one. Must return it to the state it was
+         * constructed in, though it may keep memory it allocated. Returns false if it can't be
+         * reused, in which case it gets destroyed.
+         */
+        virtual bool prepareForReuse() { return false; }
+
         /**
          * These should be called through WriteUnitOfWork rather than directly.
          *
@@ -89,6 +133,28 @@ namespace mongo {
 
         virtual SnapshotId getSnapshotId() const = 0;
 
+        /**
+         * Opens the snapshot which the next reads will use now, if there isn't one open already,
+         * rather than when the storage engine is first accessed. Lets the caller pick the point in
+         * time its reads see, for example while it holds a lock which keeps writers out. Must be
+         * called outside of a WriteUnitOfWork.
+         */
+        virtual void preallocateSnapshot(OperationContext* opCtx) { }
+
+        /**
+         * Asks to keep the open transaction, and the positions of the cursors in it, after the
+         * operation using this RecoveryUnit ends, so that a ClientCursor's next getMore can carry
+         * on without repositioning its cursors. Must be called outside of a WriteUnitOfWork,
+         * before the ClientCursor's PlanExecutor is saved.
+         *
+         * Returns false if there is no open transaction, if the storage engine does not support
+         * this, or if it is limiting the number of pinned snapshots. The pin is released by the
+         * next abandonSnapshot().
+         */
+        virtual bool pinSnapshot() { return false; }
+
+        virtual bool isSnapshotPinned() const { return false; }
+
         /**
          * A Change is an action that is registerChange()'d while a WriteUnitOfWork exists. The
          * change is either rollback()'d or commit()'d when the WriteUnitOfWork goes out of scope.
@@ -165,6 +231,9 @@ namespace mongo {
 
     protected:
         RecoveryUnit() { }
+
+    private:
+        StorageStats _storageStats;
     };
 
 }  // namespace mongo
@@ -0,0 +1,83 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/sortable_key_string.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mongo {
+
+    SortableKeyString::SortableKeyString(const char* key, uint32_t keySize,
+                                         const char* typeBits, uint32_t typeBitsSize)
+        : _buffer(SharedBuffer::allocate(keySize + typeBitsSize)),
+          _keySize(keySize),
+          _typeBitsSize(typeBitsSize) {
+        memcpy(_buffer.get(), key, keySize);
+        memcpy(_buffer.get() + keySize, typeBits, typeBitsSize);
+    }
+
+    SortableKeyString::SortableKeyString(const BSONObj& key, Ordering ord) {
+        const KeyString ks(key, ord);
+        const KeyString::TypeBits& typeBits = ks.getTypeBits();
+        *this = SortableKeyString(ks.getBuffer(), ks.getSize(),
+                                  reinterpret_cast<const char*>(typeBits.getBuffer()),
+                                  typeBits.isAllZeros() ? 0 : typeBits.getSize());
+    }
+
+    int SortableKeyString::compare(const SortableKeyString& other) const {
+        const int cmp = memcmp(getBuffer(), other.getBuffer(),
+                               std::min(_keySize, other._keySize));
+        if (cmp)
+            return cmp;
+        return _keySize < other._keySize ? -1 : (_keySize > other._keySize ? 1 : 0);
+    }
+
+    BSONObj SortableKeyString::toBson(Ordering ord) const {
+        BufReader reader(getBuffer() + _keySize, _typeBitsSize);
+        return KeyString::toBson(getBuffer(), _keySize, ord,
+                                 KeyString::TypeBits::fromBuffer(&reader));
+    }
+
+    void SortableKeyString::serializeForSorter(BufBuilder& buf) const {
+        buf.appendNum(_keySize);
+        buf.appendNum(_typeBitsSize);
+        buf.appendBuf(getBuffer(), _keySize + _typeBitsSize);
+    }
+
+    SortableKeyString SortableKeyString::deserializeForSorter(BufReader& buf,
+                                                              const SorterDeserializeSettings&) {
+        const uint32_t keySize = buf.read<uint32_t>();
+        const uint32_t typeBitsSize = buf.read<uint32_t>();
+        const char* data = static_cast<const char*>(buf.skip(keySize + typeBitsSize));
+        return SortableKeyString(data, keySize, data + keySize, typeBitsSize);
+    }
+
+}  // namespace mongo
@@ -0,0 +1,91 @@
+// sortable_key_string.h
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "mongo/bson/ordering.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+
+    /**
+     * An index key encoded as a KeyString, together with its TypeBits, in one immutable shared
+     * buffer. Keys compare with a single memcmp in the order the index stores them, which makes
+     * this the key type for sorting index keys, for instance in bulk index builds.
+     *
+     * Copies share the buffer, so they are cheap.
+     */
+    class SortableKeyString {
+    public:
+        SortableKeyString() = default;
+
+        /**
+         * Encodes 'key', which must have empty field names, in the order given by 'ord'.
+         */
+        SortableKeyString(const BSONObj& key, Ordering ord);
+
+        /**
+         * Orders keys like the index does, i.e. like woCompare() on the keys with 'ord'.
+         */
+        int compare(const SortableKeyString& other) const;
+
+        /**
+         * Decodes the key. 'ord' must be the ordering the key was encoded with.
+         */
+        BSONObj toBson(Ordering ord) const;
+
+        const char* getBuffer() const { return _buffer.get(); }
+        size_t getSize() const { return _keySize; }
+
+        /// members for Sorter
+        struct SorterDeserializeSettings {}; // unused
+        void serializeForSorter(BufBuilder& buf) const;
+        static SortableKeyString deserializeForSorter(BufReader& buf,
+                                                      const SorterDeserializeSettings&);
+        int memUsageForSorter() const {
+            return sizeof(SortableKeyString) + _keySize + _typeBitsSize;
+        }
+        SortableKeyString getOwned() const { return *this; }
+
+    private:
+        SortableKeyString(const char* key, uint32_t keySize,
+                          const char* typeBits, uint32_t typeBitsSize);
+
+        // The KeyString bytes immediately followed by the TypeBits, which are left out if they
+        // are all zeros.
+        SharedBuffer _buffer;
+        uint32_t _keySize = 0;
+        uint32_t _typeBitsSize = 0;
+    };
+
+}  // namespace mongo
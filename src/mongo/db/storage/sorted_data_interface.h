@@ -29,11 +29,13 @@
 #include <boost/optional/optional.hpp>
 #include <boost/optional/optional_io.hpp>
 #include <memory>
+#include <vector>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/key_string_set.h"
 
 #pragma once
 
@@ -43,6 +45,17 @@ namespace mongo {
     class BucketDeletionNotification;
     class SortedDataBuilderInterface;
 
+    /**
+     * A key encoded as a KeyString and the RecordId it points to, for
+     * SortedDataInterface::insertManyKeyStrings().
+     */
+    struct KeyStringEntry {
+        KeyStringEntry(const KeyStringSet::Key& key, const RecordId& loc) : key(key), loc(loc) {}
+
+        KeyStringSet::Key key;
+        RecordId loc;
+    };
+
     /**
      * This interface is a work in progress.  Notes below:
      *
@@ -112,6 +125,70 @@ namespace mongo {
                              const RecordId& loc,
                              bool dupsAllowed) = 0;
 
+        /**
+         * Returns true if this index stores its keys as KeyStrings and accepts keys already
+         * encoded that way through insertKeyString() and unindexKeyString(). Index access methods
+         * then generate keys directly as KeyStrings rather than as BSONObjs.
+         */
+        virtual bool supportsKeyStrings() const { return false; }
+
+        /**
+         * Like insert(), for a key encoded under this index's Ordering, without a RecordId.
+         * Only called if supportsKeyStrings() is true.
+         */
+        virtual Status insertKeyString(OperationContext* txn,
+                                       const KeyStringSet::Key& key,
+                                       const RecordId& loc,
+                                       bool dupsAllowed) {
+            invariant(false);
+        }
+
+        /**
+         * Inserts all of 'entries' as if insert() were called for each of them in turn.
+         * 'entries' must be sorted in index order, equal keys by RecordId, so that
+         * implementations can insert them through a single cursor and find duplicates within
+         * them by comparing neighbours.
+         *
+         * Returns the first error, after which the caller must abandon the write unit of work
+         * since the entries before it may have been inserted.
+         */
+        virtual Status insertMany(OperationContext* txn,
+                                  const std::vector<IndexKeyEntry>& entries,
+                                  bool dupsAllowed) {
+            for (size_t i = 0; i < entries.size(); i++) {
+                Status status = insert(txn, entries[i].key, entries[i].loc, dupsAllowed);
+                if (!status.isOK())
+                    return status;
+            }
+            return Status::OK();
+        }
+
+        /**
+         * Like insertMany(), for keys encoded under this index's Ordering, in KeyString order.
+         * Only called if supportsKeyStrings() is true.
+         */
+        virtual Status insertManyKeyStrings(OperationContext* txn,
+                                            const std::vector<KeyStringEntry>& entries,
+                                            bool dupsAllowed) {
+            for (size_t i = 0; i < entries.size(); i++) {
+                Status status = insertKeyString(txn, entries[i].key, entries[i].loc, dupsAllowed);
+                if (!status.isOK())
+                    return status;
+            }
+            return Status::OK();
+        }
+
+        /**
+         * Like unindex(), for a key encoded under this index's Ordering, without a RecordId.
+         * Only called if supportsKeyStrings() is true.
+         */
+        virtual void unindexKeyString(OperationContext* txn,
+                                      const KeyStringSet::Key& key,
+                                      const RecordId& loc,
+                                      bool dupsAllowed) {
+            invariant(false);
+        }
+
         /**
          * Return ErrorCodes::DuplicateKey if 'key' already exists in 'this'
          * index at a RecordId other than 'loc', and Status::OK() otherwise.
@@ -168,6 +245,17 @@ namespace mongo {
                           "this storage engine does not support touch");
         }
 
+        /**
+         * Appends up to 'numKeys' keys picked at random from the whole index to 'keys', some
+         * possibly more than once, and returns true. Returns false if the storage engine can't
+         * pick keys at random.
+         */
+        virtual bool sampleKeys(OperationContext* txn,
+                                int numKeys,
+                                std::vector<BSONObj>* keys) const {
+            return false;
+        }
+
         /**
          * Return the number of entries in 'this' index.
          *
@@ -249,6 +337,16 @@ namespace mongo {
              */
             virtual void setEndPosition(const BSONObj& key, bool inclusive) = 0;
 
+            /**
+             * Allows keys returned by this cursor to point into memory owned by the cursor rather
+             * than each holding its own copy. Such a key is only valid until the cursor is next
+             * moved or destroyed, so callers must call getOwned() on the keys they keep.
+             *
+             * This is for callers which look at many keys but keep few of them. Implementations
+             * which already return keys pointing into their own storage can ignore it.
+             */
+            virtual void allowUnownedKeys() {}
+
             /**
              * Moves forward and returns the new data or boost::none if there is no more data.
              * If not positioned, returns boost::none.
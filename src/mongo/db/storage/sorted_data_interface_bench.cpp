@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/initializer.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/db/storage/sorted_data_interface_test_harness.h"
+#include "mongo/db/storage/storage_bench.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/signal_handlers_synchronous.h"
+
+/**
+ * Benchmarks the SortedDataInterface of the engine whose sorted_data_interface_test_harness
+ * HarnessHelper this is linked with. See storage_bench.h.
+ */
+
+namespace mongo {
+namespace {
+
+    using std::unique_ptr;
+    using std::vector;
+
+    const int kScanLength = 100;
+
+    BSONObj keyFor(long long n) {
+        return BSON("" << n);
+    }
+
+    RecordId locFor(long long n) {
+        return RecordId(n + 1);
+    }
+
+    void benchBulkBuild(StorageBenchmark* bench) {
+        unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+        unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(false));
+        unique_ptr<SortedDataBuilderInterface> builder;
+        const int ops = bench->opsPerThread();
+
+        // A bulk builder has a single writer, so the index build is only run on one thread.
+        bench->run("bulkBuild", 1, false,
+                   [&] { return harnessHelper->newOperationContext().release(); },
+                   [&](OperationContext* txn, int thread, int op) {
+            if (!builder) builder.reset(sorted->getBulkBuilder(txn, true));
+            uassertStatusOK(builder->addKey(keyFor(op), locFor(op)));
+            if (op == ops - 1) {
+                builder->commit(false);
+                builder.reset();
+            }
+        });
+    }
+
+    void benchSortedDataInterface(StorageBenchmark* bench, int threads) {
+        unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+        unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(false));
+
+        const bool serialize = !harnessHelper->supportsDocLocking();
+        const long long numKeys = static_cast<long long>(threads) * bench->opsPerThread();
+        const int ops = bench->opsPerThread();
+        const auto newTxn = [&] { return harnessHelper->newOperationContext().release(); };
+
+        const auto lookupFor = [&](int thread, int op) {
+            return (thread * 7919LL + op * 104729LL) % numKeys;
+        };
+
+        const auto insert = [&](OperationContext* txn, long long n) {
+            WriteUnitOfWork wuow(txn);
+            uassertStatusOK(sorted->insert(txn, keyFor(n), locFor(n), true));
+            wuow.commit();
+        };
+
+        // Thread 'thread' inserts the keys congruent to it modulo 'threads', so that concurrent
+        // inserts interleave across the whole key space.
+        bench->run("insert", threads, serialize, newTxn,
+                   [&](OperationContext* txn, int thread, int op) {
+            insert(txn, static_cast<long long>(op) * threads + thread);
+        });
+
+        {
+            unique_ptr<OperationContext> txn(newTxn());
+            if (sorted->isEmpty(txn.get())) {
+                // The inserts were filtered out, but the other workloads still need the keys.
+                for (long long n = 0; n < numKeys; n++) {
+                    insert(txn.get(), n);
+                }
+            }
+        }
+
+        bench->run("pointLookup", threads, serialize, newTxn,
+                   [&](OperationContext* txn, int thread, int op) {
+            auto cursor = sorted->newCursor(txn);
+            cursor->seekExact(keyFor(lookupFor(thread, op)));
+            cursor.reset();
+            txn->recoveryUnit()->abandonSnapshot();
+        });
+
+        bench->run("rangeScan", threads, serialize, newTxn,
+                   [&](OperationContext* txn, int thread, int op) {
+            const long long start = lookupFor(thread, op);
+            auto cursor = sorted->newCursor(txn);
+            cursor->setEndPosition(keyFor(start + kScanLength - 1), true);
+            for (auto entry = cursor->seek(keyFor(start), true); entry; entry = cursor->next()) {
+            }
+            cursor.reset();
+            txn->recoveryUnit()->abandonSnapshot();
+        });
+
+        // Yields between every key, as a query does when it is interrupted by lock contention,
+        // restarting each cursor when it hits the end.
+        vector<unique_ptr<SortedDataInterface::Cursor>> cursors(threads);
+        bench->run("cursorSaveRestore", threads, serialize, newTxn,
+                   [&](OperationContext* txn, int thread, int op) {
+            unique_ptr<SortedDataInterface::Cursor>& cursor = cursors[thread];
+            if (!cursor) cursor = sorted->newCursor(txn);
+            if (!cursor->next()) cursor = sorted->newCursor(txn);
+
+            cursor->savePositioned();
+            txn->recoveryUnit()->abandonSnapshot();
+            cursor->restore(txn);
+
+            // The cursor must not outlive the OperationContext of its thread.
+            if (op == ops - 1) cursor.reset();
+        });
+    }
+
+} // namespace
+} // namespace mongo
+
+int main(int argc, char** argv, char** envp) {
+    ::mongo::setupSynchronousSignalHandlers();
+    ::mongo::runGlobalInitializersOrDie(argc, argv, envp);
+
+    ::mongo::StorageBenchmark bench("sortedDataInterface", argc, argv);
+    ::mongo::benchBulkBuild(&bench);
+    for (int threads : bench.threadCounts()) {
+        ::mongo::benchSortedDataInterface(&bench, threads);
+    }
+    return bench.report();
+}
@@ -31,6 +31,7 @@
 #include "mongo/db/storage/sorted_data_interface_test_harness.h"
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/unittest/unittest.h"
@@ -121,6 +122,43 @@ namespace mongo {
         }
     }
 
+    // Keys returned by a cursor allowed to return unowned keys are correct while it is
+    // positioned on them, and copies taken with getOwned() stay correct as the cursor moves.
+    TEST( SortedDataInterface, ExhaustCursorWithUnownedKeys ) {
+        const std::unique_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+        const std::unique_ptr<SortedDataInterface> sorted( harnessHelper->newSortedDataInterface( false ) );
+
+        int nToInsert = 10;
+        for ( int i = 0; i < nToInsert; i++ ) {
+            const std::unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            {
+                WriteUnitOfWork uow( opCtx.get() );
+                BSONObj key = BSON( "" << i );
+                RecordId loc( 42, i * 2 );
+                ASSERT_OK( sorted->insert( opCtx.get(), key, loc, true ) );
+                uow.commit();
+            }
+        }
+
+        {
+            const std::unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            const std::unique_ptr<SortedDataInterface::Cursor> cursor( sorted->newCursor(opCtx.get()) );
+            cursor->allowUnownedKeys();
+
+            std::vector<BSONObj> kept;
+            for ( int i = 0; i < nToInsert; i++ ) {
+                auto entry = i == 0 ? cursor->seek(minKey, true) : cursor->next();
+                ASSERT_EQ(entry, IndexKeyEntry(BSON("" << i), RecordId(42, i * 2)));
+                kept.push_back(entry->key.getOwned());
+            }
+            ASSERT( !cursor->next() );
+
+            for ( int i = 0; i < nToInsert; i++ ) {
+                ASSERT_EQ(kept[i], BSON("" << i));
+            }
+        }
+    }
+
     // Call advance() on a reverse cursor until it is exhausted.
     // When a cursor positioned at EOF is advanced, it stays at EOF.
     TEST( SortedDataInterface, ExhaustCursorReversed ) {
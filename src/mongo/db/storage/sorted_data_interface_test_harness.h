@@ -80,6 +80,12 @@ namespace mongo {
         virtual std::unique_ptr<SortedDataInterface> newSortedDataInterface( bool unique ) = 0;
         virtual std::unique_ptr<RecoveryUnit> newRecoveryUnit() = 0;
 
+        /**
+         * Whether several threads may write to the same index at once, without a
+         * collection lock around them. Used by the storage benchmarks.
+         */
+        virtual bool supportsDocLocking() const { return false; }
+
         virtual std::unique_ptr<OperationContext> newOperationContext() {
             return stdx::make_unique<OperationContextNoop>(newRecoveryUnit().release());
         }
@@ -0,0 +1,134 @@
+// sorted_data_interface_test_insertmany.cpp
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/storage/sorted_data_interface_test_harness.h"
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+    // Insert a sorted run of keys, including equal keys with different RecordIds,
+    // into a non-unique index and verify that they all end up in it.
+    TEST( SortedDataInterface, InsertMany ) {
+        const std::unique_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+        const std::unique_ptr<SortedDataInterface> sorted( harnessHelper->newSortedDataInterface( false ) );
+
+        std::vector<IndexKeyEntry> entries;
+        entries.push_back( IndexKeyEntry( key1, loc1 ) );
+        entries.push_back( IndexKeyEntry( key2, loc1 ) );
+        entries.push_back( IndexKeyEntry( key2, loc2 ) );
+        entries.push_back( IndexKeyEntry( key3, loc3 ) );
+
+        {
+            const std::unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            {
+                WriteUnitOfWork uow( opCtx.get() );
+                ASSERT_OK( sorted->insertMany( opCtx.get(), entries, true ) );
+                uow.commit();
+            }
+        }
+
+        {
+            const std::unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            ASSERT_EQUALS( 4, sorted->numEntries( opCtx.get() ) );
+
+            const std::unique_ptr<SortedDataInterface::Cursor> cursor( sorted->newCursor( opCtx.get() ) );
+            for ( size_t i = 0; i < entries.size(); i++ ) {
+                ASSERT_EQ( i == 0 ? cursor->seek( minKey, true ) : cursor->next(), entries[i] );
+            }
+            ASSERT( !cursor->next() );
+        }
+    }
+
+    // Insert a sorted run of keys with a duplicate among them into a unique index
+    // and verify that the duplicate is reported.
+    TEST( SortedDataInterface, InsertManyDuplicateWithinBatch ) {
+        const std::unique_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+        const std::unique_ptr<SortedDataInterface> sorted( harnessHelper->newSortedDataInterface( true ) );
+
+        std::vector<IndexKeyEntry> entries;
+        entries.push_back( IndexKeyEntry( key1, loc1 ) );
+        entries.push_back( IndexKeyEntry( key2, loc2 ) );
+        entries.push_back( IndexKeyEntry( key2, loc3 ) );
+
+        {
+            const std::unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            {
+                WriteUnitOfWork uow( opCtx.get() );
+                Status status = sorted->insertMany( opCtx.get(), entries, false );
+                ASSERT_EQUALS( ErrorCodes::DuplicateKey, status.code() );
+            }
+        }
+
+        {
+            const std::unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            ASSERT( sorted->isEmpty( opCtx.get() ) );
+        }
+    }
+
+    // Insert a sorted run of keys into a unique index where one of them is
+    // already present and verify that the duplicate is reported.
+    TEST( SortedDataInterface, InsertManyDuplicateOfExistingKey ) {
+        const std::unique_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+        const std::unique_ptr<SortedDataInterface> sorted( harnessHelper->newSortedDataInterface( true ) );
+
+        {
+            const std::unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            {
+                WriteUnitOfWork uow( opCtx.get() );
+                ASSERT_OK( sorted->insert( opCtx.get(), key2, loc1, false ) );
+                uow.commit();
+            }
+        }
+
+        std::vector<IndexKeyEntry> entries;
+        entries.push_back( IndexKeyEntry( key1, loc2 ) );
+        entries.push_back( IndexKeyEntry( key2, loc3 ) );
+
+        {
+            const std::unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            {
+                WriteUnitOfWork uow( opCtx.get() );
+                Status status = sorted->insertMany( opCtx.get(), entries, false );
+                ASSERT_EQUALS( ErrorCodes::DuplicateKey, status.code() );
+            }
+        }
+
+        {
+            const std::unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            ASSERT_EQUALS( 1, sorted->numEntries( opCtx.get() ) );
+        }
+    }
+
+} // namespace mongo
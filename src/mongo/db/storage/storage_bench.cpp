@@ -0,0 +1,204 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/storage_bench.h"
+
+#include <algorithm>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <iostream>
+#include <memory>
+
+#include "mongo/base/parse_number.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/log.h"
+#include "mongo/util/quick_exit.h"
+#include "mongo/util/stringutils.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+namespace {
+
+    void usage(const string& program, const string& error) {
+        std::cerr << program << ": " << error << std::endl
+                  << "usage: " << program << " [--threads=1,2,4,8] [--ops=N] [--filter=S]"
+                  << std::endl;
+        quickExit(EXIT_BADOPTIONS);
+    }
+
+    int parsePositive(const string& program, StringData value) {
+        int result;
+        if (!parseNumberFromString(value, &result).isOK() || result <= 0) {
+            usage(program, "expected a positive number: " + value.toString());
+        }
+        return result;
+    }
+
+    // Returns the latency below which 'percentile' percent of the sorted 'latencies' fall.
+    long long percentile(const vector<long long>& latencies, double percentile) {
+        if (latencies.empty()) return 0;
+        size_t index = static_cast<size_t>(latencies.size() * percentile / 100);
+        return latencies[std::min(index, latencies.size() - 1)];
+    }
+
+} // namespace
+
+    StorageBenchmark::StorageBenchmark(const string& suite, int argc, char** argv)
+        : _suite(suite),
+          _program(argc > 0 ? argv[0] : suite),
+          _opsPerThread(10000) {
+
+        _threadCounts.push_back(1);
+        _threadCounts.push_back(2);
+        _threadCounts.push_back(4);
+        _threadCounts.push_back(8);
+
+        for (int i = 1; i < argc; i++) {
+            const StringData arg(argv[i]);
+            if (arg.startsWith("--threads=")) {
+                vector<string> counts;
+                splitStringDelim(arg.substr(strlen("--threads=")).toString(), &counts, ',');
+                _threadCounts.clear();
+                for (size_t j = 0; j < counts.size(); j++) {
+                    _threadCounts.push_back(parsePositive(_program, counts[j]));
+                }
+            }
+            else if (arg.startsWith("--ops=")) {
+                _opsPerThread = parsePositive(_program, arg.substr(strlen("--ops=")));
+            }
+            else if (arg.startsWith("--filter=")) {
+                _filter = arg.substr(strlen("--filter=")).toString();
+            }
+            else {
+                usage(_program, "unknown option " + arg.toString());
+            }
+        }
+    }
+
+    bool StorageBenchmark::enabled(StringData workload) const {
+        return workload.find(_filter) != string::npos;
+    }
+
+    void StorageBenchmark::run(StringData workload,
+                               int threads,
+                               bool serialize,
+                               const OperationContextFactory& newTxn,
+                               const Op& op) {
+        if (!enabled(workload)) return;
+
+        boost::mutex serializeMutex;
+        vector<vector<long long> > latencies(threads);
+        AtomicUInt64 writeConflicts;
+
+        const auto body = [&](int thread) {
+            std::unique_ptr<OperationContext> txn(newTxn());
+            vector<long long>& threadLatencies = latencies[thread];
+            threadLatencies.reserve(_opsPerThread);
+
+            for (int i = 0; i < _opsPerThread; i++) {
+                Timer timer;
+                while (true) {
+                    try {
+                        if (serialize) {
+                            boost::lock_guard<boost::mutex> lk(serializeMutex);
+                            op(txn.get(), thread, i);
+                        }
+                        else {
+                            op(txn.get(), thread, i);
+                        }
+                        break;
+                    }
+                    catch (const WriteConflictException&) {
+                        writeConflicts.fetchAndAdd(1);
+                        txn->recoveryUnit()->abandonSnapshot();
+                    }
+                }
+                threadLatencies.push_back(timer.micros());
+            }
+        };
+
+        Timer elapsed;
+        vector<stdx::thread*> workers;
+        for (int t = 1; t < threads; t++) {
+            workers.push_back(new stdx::thread([&body, t] { body(t); }));
+        }
+        body(0);
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t]->join();
+            delete workers[t];
+        }
+        const long long elapsedMicros = std::max(elapsed.micros(), 1LL);
+
+        vector<long long> all;
+        all.reserve(threads * _opsPerThread);
+        for (int t = 0; t < threads; t++) {
+            all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+        }
+        std::sort(all.begin(), all.end());
+
+        const long long ops = all.size();
+        BSONObjBuilder result(_results.subobjStart());
+        result.append("workload", workload);
+        result.append("threads", threads);
+        result.append("ops", ops);
+        result.append("opsPerSec", ops * 1000 * 1000.0 / elapsedMicros);
+        result.append("writeConflicts", static_cast<long long>(writeConflicts.load()));
+        {
+            BSONObjBuilder latency(result.subobjStart("latencyMicros"));
+            latency.append("p50", percentile(all, 50));
+            latency.append("p95", percentile(all, 95));
+            latency.append("p99", percentile(all, 99));
+            latency.append("max", all.empty() ? 0 : all.back());
+        }
+        result.doneFast();
+
+        log() << _suite << " " << workload << " with " << threads << " thread(s): "
+              << ops * 1000 * 1000 / elapsedMicros << " ops/sec";
+    }
+
+    int StorageBenchmark::report() {
+        BSONObjBuilder out;
+        out.append("suite", _suite);
+        out.append("program", _program);
+        out.append("opsPerThread", _opsPerThread);
+        out.append("results", _results.arr());
+        std::cout << out.obj().jsonString(Strict, 1) << std::endl;
+        return EXIT_CLEAN;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/stdx/functional.h"
+
+namespace mongo {
+
+    class OperationContext;
+
+    /**
+     * Drives the workloads of the storage engine benchmark programs, which run an engine through
+     * the same harness helpers as its conformance tests (record_store_test_harness.h and
+     * sorted_data_interface_test_harness.h).
+     *
+     * Each workload is run at every requested thread count, and its throughput and latency
+     * percentiles are reported as one JSON document on stdout, so that runs of different builds
+     * can be compared by a script.
+     *
+     * Command line:
+     *     --threads=1,2,4,8    thread counts to run every workload at
+     *     --ops=N              operations per thread for every workload
+     *     --filter=S           only run workloads whose name contains S
+     */
+    class StorageBenchmark {
+        MONGO_DISALLOW_COPYING(StorageBenchmark);
+    public:
+        /**
+         * Runs operation number 'op' of thread 'thread', with the OperationContext of the thread.
+         */
+        typedef stdx::function<void (OperationContext* txn, int thread, int op)> Op;
+
+        typedef stdx::function<OperationContext* ()> OperationContextFactory;
+
+        StorageBenchmark(const std::string& suite, int argc, char** argv);
+
+        const std::vector<int>& threadCounts() const { return _threadCounts; }
+
+        int opsPerThread() const { return _opsPerThread; }
+
+        bool enabled(StringData workload) const;
+
+        /**
+         * Runs 'op' opsPerThread() times on each of 'threads' threads, each with its own
+         * OperationContext made by 'newTxn', and records the results. Write conflicts are retried.
+         *
+         * Engines without document-level locking are run with 'serialize', which makes the
+         * operations take turns on one mutex, as they would on the collection lock in mongod.
+         */
+        void run(StringData workload,
+                 int threads,
+                 bool serialize,
+                 const OperationContextFactory& newTxn,
+                 const Op& op);
+
+        /**
+         * Prints the results of all workloads run so far. Returns the exit code for main.
+         */
+        int report();
+
+    private:
+        const std::string _suite;
+        std::string _program;
+        std::vector<int> _threadCounts;
+        int _opsPerThread;
+        std::string _filter;
+
+        BSONArrayBuilder _results;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,200 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_cache_residency_command.h"
+
+#include <algorithm>
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/kv/kv_catalog.h"
+#include "mongo/db/storage/kv/kv_storage_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    namespace {
+
+        typedef WiredTigerUtil::CacheResidency CacheResidency;
+
+        struct TableResidency {
+            std::string ns;
+            // Empty for the collection itself.
+            std::string index;
+            CacheResidency residency;
+        };
+
+        const struct {
+            const char* name;
+            long long CacheResidency::*field;
+        } sortFields[] = {
+            {"bytesReadIntoCache", &CacheResidency::bytesReadIntoCache},
+            {"bytesWrittenFromCache", &CacheResidency::bytesWrittenFromCache},
+            {"pagesReadIntoCache", &CacheResidency::pagesReadIntoCache},
+            {"pagesEvicted", &CacheResidency::pagesEvicted},
+        };
+
+        const long long kDefaultLimit = 10;
+
+    }  // namespace
+
+    WiredTigerCacheResidencyCommand::WiredTigerCacheResidencyCommand(WiredTigerKVEngine* engine)
+        : Command("wiredTigerCacheResidency"),
+          _engine(engine) { }
+
+    void WiredTigerCacheResidencyCommand::help(std::stringstream& help) const {
+        help << "collections and indexes ranked by WiredTiger cache activity\n"
+             << "{ wiredTigerCacheResidency: 1, sortBy: 'bytesReadIntoCache', limit: 10 }";
+    }
+
+    void WiredTigerCacheResidencyCommand::addRequiredPrivileges(const std::string& dbname,
+                                                                const BSONObj& cmdObj,
+                                                                std::vector<Privilege>* out) {
+        ActionSet actions;
+        actions.addAction(ActionType::top);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+
+    bool WiredTigerCacheResidencyCommand::run(OperationContext* txn,
+                                              const std::string& db,
+                                              BSONObj& cmdObj,
+                                              int options,
+                                              std::string& errmsg,
+                                              BSONObjBuilder& result) {
+        long long limit = kDefaultLimit;
+        if (BSONElement limitElt = cmdObj["limit"]) {
+            if (!limitElt.isNumber() || limitElt.numberLong() < 0) {
+                return appendCommandStatus(result, Status(ErrorCodes::BadValue,
+                    "limit must be a non-negative number"));
+            }
+            limit = limitElt.numberLong();
+        }
+
+        std::string sortBy = sortFields[0].name;
+        long long CacheResidency::*sortField = sortFields[0].field;
+        if (BSONElement sortByElt = cmdObj["sortBy"]) {
+            if (sortByElt.type() != String) {
+                return appendCommandStatus(result, Status(ErrorCodes::TypeMismatch,
+                    "sortBy must be a string"));
+            }
+            sortBy = sortByElt.String();
+            sortField = nullptr;
+            for (auto&& sortFieldEntry : sortFields) {
+                if (sortBy == sortFieldEntry.name) {
+                    sortField = sortFieldEntry.field;
+                }
+            }
+            if (!sortField) {
+                return appendCommandStatus(result, Status(ErrorCodes::BadValue, str::stream()
+                    << "cannot sort by '" << sortBy << "'"));
+            }
+        }
+
+        StorageEngine* storageEngine = txn->getServiceContext()->getGlobalStorageEngine();
+        KVCatalog* catalog = checked_cast<KVStorageEngine*>(storageEngine)->getCatalog();
+
+        std::vector<std::string> collections;
+        catalog->getAllCollections(&collections);
+
+        std::vector<TableResidency> tables;
+        auto addTable = [&](const std::string& ns,
+                            const std::string& index,
+                            const std::string& ident) {
+            StatusWith<CacheResidency> residency = _engine->getCacheResidency(txn, ident);
+            if (residency.isOK()) {
+                tables.push_back({ns, index, residency.getValue()});
+            }
+        };
+
+        ScopedTransaction transaction(txn, MODE_IS);
+        for (const auto& ns : collections) {
+            // The locks keep the collection and its indexes from being dropped while their idents
+            // are looked up. Reading the statistics doesn't need them.
+            Lock::DBLock dbLock(txn->lockState(), nsToDatabaseSubstring(ns), MODE_IS);
+            Lock::CollectionLock collLock(txn->lockState(), ns, MODE_IS);
+
+            Database* database = dbHolder().get(txn, ns);
+            if (!database || !database->getCollection(ns)) {
+                // Dropped since the list of collections was taken.
+                continue;
+            }
+
+            addTable(ns, "", catalog->getCollectionIdent(ns));
+            const BSONCollectionCatalogEntry::MetaData md = catalog->getMetaData(txn, ns);
+            for (const auto& index : md.indexes) {
+                addTable(ns, index.name(), catalog->getIndexIdent(txn, ns, index.name()));
+            }
+        }
+
+        CacheResidency totals;
+        for (const auto& table : tables) {
+            totals.bytesReadIntoCache += table.residency.bytesReadIntoCache;
+            totals.bytesWrittenFromCache += table.residency.bytesWrittenFromCache;
+            totals.pagesReadIntoCache += table.residency.pagesReadIntoCache;
+            totals.pagesEvicted += table.residency.pagesEvicted;
+        }
+
+        const size_t numReturned = limit == 0 ? tables.size()
+                                              : std::min(tables.size(), size_t(limit));
+        std::partial_sort(tables.begin(), tables.begin() + numReturned, tables.end(),
+                          [sortField](const TableResidency& a, const TableResidency& b) {
+                              return a.residency.*sortField > b.residency.*sortField;
+                          });
+
+        result.append("sortBy", sortBy);
+        result.appendNumber("tables", static_cast<long long>(tables.size()));
+        {
+            BSONObjBuilder totalsBuilder(result.subobjStart("totals"));
+            totals.appendTo(&totalsBuilder);
+        }
+        BSONArrayBuilder top(result.subarrayStart("top"));
+        for (size_t i = 0; i < numReturned; i++) {
+            BSONObjBuilder entry(top.subobjStart());
+            entry.append("ns", tables[i].ns);
+            if (!tables[i].index.empty()) {
+                entry.append("index", tables[i].index);
+            }
+            tables[i].residency.appendTo(&entry);
+        }
+        top.done();
+        return true;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,68 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/commands.h"
+
+namespace mongo {
+
+    class WiredTigerKVEngine;
+
+    /**
+     * The wiredTigerCacheResidency command ranks collections and indexes by their use of the
+     * WiredTiger cache, as a top-style view of what makes up the working set.
+     *
+     * { wiredTigerCacheResidency: 1, sortBy: <field>, limit: <n> }
+     *
+     * 'sortBy' is one of the fields of WiredTigerUtil::CacheResidency and defaults to
+     * "bytesReadIntoCache". 'limit' defaults to 10, and 0 returns every table.
+     */
+    class WiredTigerCacheResidencyCommand : public Command {
+    public:
+        WiredTigerCacheResidencyCommand(WiredTigerKVEngine* engine);
+
+        virtual bool slaveOk() const { return true; }
+        virtual bool adminOnly() const { return true; }
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual void help(std::stringstream& help) const;
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out);
+        virtual bool run(OperationContext* txn,
+                         const std::string& db,
+                         BSONObj& cmdObj,
+                         int options,
+                         std::string& errmsg,
+                         BSONObjBuilder& result);
+
+    private:
+        WiredTigerKVEngine* _engine;
+    };
+
+}  // namespace mongo
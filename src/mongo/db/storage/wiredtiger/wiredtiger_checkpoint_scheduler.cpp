@@ -0,0 +1,253 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_checkpoint_scheduler.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    namespace {
+        const long long kBytesPerMB = 1024 * 1024;
+
+        /**
+         * Reads a connection statistic, or returns 0 if it is unavailable.
+         */
+        long long connectionStatistic(WT_SESSION* session, int key) {
+            StatusWith<long long> value = WiredTigerUtil::getStatisticsValueAs<long long>(
+                session, "statistics:", "statistics=(fast)", key);
+            if (!value.isOK()) {
+                LOG(1) << "unable to read WiredTiger statistic " << key << ": "
+                       << value.getStatus();
+                return 0;
+            }
+            return value.getValue();
+        }
+    }
+
+    WiredTigerCheckpointScheduler::WiredTigerCheckpointScheduler(WT_CONNECTION* conn,
+                                                                 bool journaled)
+        : _conn(conn),
+          _journaled(journaled),
+          _journalBytesAtCheckpoint(0),
+          _shuttingDown(false) {
+        _settings[kDelaySecs].store(60);
+        _settings[kDirtyTriggerMB].store(0);
+        _settings[kJournalTriggerMB].store(2048);
+        _settings[kMinIntervalSecs].store(10);
+    }
+
+    WiredTigerCheckpointScheduler::~WiredTigerCheckpointScheduler() {
+        shutdown();
+    }
+
+    void WiredTigerCheckpointScheduler::start() {
+        invariant(!_thread.joinable());
+        _thread = stdx::thread(&WiredTigerCheckpointScheduler::_run, this);
+    }
+
+    void WiredTigerCheckpointScheduler::shutdown() {
+        if (!_thread.joinable()) {
+            return;
+        }
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _shuttingDown = true;
+        }
+        _cv.notify_one();
+        _thread.join();
+    }
+
+    long long WiredTigerCheckpointScheduler::getSetting(Setting setting) const {
+        invariant(setting >= 0 && setting < kNumSettings);
+        return _settings[setting].load();
+    }
+
+    void WiredTigerCheckpointScheduler::setSetting(Setting setting, long long value) {
+        invariant(setting >= 0 && setting < kNumSettings);
+        invariant(value >= 0);
+        _settings[setting].store(value);
+    }
+
+    // static
+    const char* WiredTigerCheckpointScheduler::settingName(Setting setting) {
+        switch (setting) {
+        case kDelaySecs: return "wiredTigerCheckpointDelaySecs";
+        case kDirtyTriggerMB: return "wiredTigerCheckpointDirtyTriggerMB";
+        case kJournalTriggerMB: return "wiredTigerCheckpointJournalTriggerMB";
+        case kMinIntervalSecs: return "wiredTigerCheckpointMinIntervalSecs";
+        case kNumSettings: break;
+        }
+        invariant(false);
+        return NULL;
+    }
+
+    // static
+    const char* WiredTigerCheckpointScheduler::triggerName(Trigger trigger) {
+        switch (trigger) {
+        case kNone: return "none";
+        case kTime: return "time";
+        case kDirtyBytes: return "dirtyBytes";
+        case kJournalBytes: return "journalBytes";
+        case kNumTriggers: break;
+        }
+        invariant(false);
+        return NULL;
+    }
+
+    WiredTigerCheckpointScheduler::Trigger WiredTigerCheckpointScheduler::decide(
+            const State& state) const {
+        const long long delaySecs = getSetting(kDelaySecs);
+        if (delaySecs > 0 && state.millisSinceCheckpoint >= delaySecs * 1000) {
+            return kTime;
+        }
+
+        if (state.millisSinceCheckpoint < getSetting(kMinIntervalSecs) * 1000) {
+            return kNone;
+        }
+
+        const long long dirtyTriggerMB = getSetting(kDirtyTriggerMB);
+        if (dirtyTriggerMB > 0 && state.dirtyBytes >= dirtyTriggerMB * kBytesPerMB) {
+            return kDirtyBytes;
+        }
+
+        const long long journalTriggerMB = getSetting(kJournalTriggerMB);
+        if (_journaled && journalTriggerMB > 0 &&
+            state.journalBytesSinceCheckpoint >= journalTriggerMB * kBytesPerMB) {
+            return kJournalBytes;
+        }
+
+        return kNone;
+    }
+
+    void WiredTigerCheckpointScheduler::appendStats(BSONObjBuilder* builder) const {
+        {
+            BSONObjBuilder checkpoints(builder->subobjStart("checkpoints"));
+            for (int i = kNone + 1; i < kNumTriggers; i++) {
+                checkpoints.append(triggerName(static_cast<Trigger>(i)),
+                                   static_cast<long long>(_checkpoints[i].load()));
+            }
+        }
+        {
+            BSONObjBuilder settings(builder->subobjStart("settings"));
+            for (int i = 0; i < kNumSettings; i++) {
+                settings.append(settingName(static_cast<Setting>(i)),
+                                getSetting(static_cast<Setting>(i)));
+            }
+        }
+        {
+            BSONObjBuilder duration(builder->subobjStart("durationMicros"));
+            _durationMicros.append(&duration);
+        }
+        {
+            BSONObjBuilder bytesWritten(builder->subobjStart("bytesWritten"));
+            _bytesWritten.append(&bytesWritten, "totalBytes");
+        }
+    }
+
+    void WiredTigerCheckpointScheduler::_run() {
+        WiredTigerSession session(_conn);
+        WT_SESSION* s = session.getSession();
+
+        if (_journaled) {
+            _journalBytesAtCheckpoint = connectionStatistic(s, WT_STAT_CONN_LOG_BYTES_WRITTEN);
+        }
+        Date_t lastCheckpoint = Date_t::now();
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (!_shuttingDown) {
+            _cv.wait_for(lk, Seconds(1));
+            if (_shuttingDown) {
+                break;
+            }
+
+            // Don't hold up shutdown() while reading statistics or checkpointing.
+            lk.unlock();
+            const Date_t now = Date_t::now();
+            const State state = _readState(s, (now - lastCheckpoint).count());
+            const Trigger trigger = decide(state);
+            if (trigger != kNone) {
+                _checkpoint(s, trigger);
+                lastCheckpoint = Date_t::now();
+            }
+            lk.lock();
+        }
+    }
+
+    WiredTigerCheckpointScheduler::State WiredTigerCheckpointScheduler::_readState(
+            WT_SESSION* session, long long millisSinceCheckpoint) const {
+        State state;
+        state.millisSinceCheckpoint = millisSinceCheckpoint;
+        state.dirtyBytes = connectionStatistic(session, WT_STAT_CONN_CACHE_BYTES_DIRTY);
+        state.journalBytesSinceCheckpoint = _journaled ?
+            connectionStatistic(session, WT_STAT_CONN_LOG_BYTES_WRITTEN) -
+                _journalBytesAtCheckpoint :
+            0;
+        return state;
+    }
+
+    void WiredTigerCheckpointScheduler::_checkpoint(WT_SESSION* session, Trigger trigger) {
+        LOG(1) << "taking a WiredTiger checkpoint, triggered by " << triggerName(trigger);
+
+        if (_journaled) {
+            _journalBytesAtCheckpoint =
+                connectionStatistic(session, WT_STAT_CONN_LOG_BYTES_WRITTEN);
+        }
+        const long long bytesBefore = connectionStatistic(session,
+                                                          WT_STAT_CONN_BLOCK_BYTE_WRITE);
+        Timer timer;
+
+        int ret = session->checkpoint(session, NULL);
+        if (ret != 0) {
+            warning() << "WiredTiger checkpoint failed: " << wtRCToStatus(ret);
+            return;
+        }
+
+        // Eviction writes concurrently with a checkpoint, so this includes some bytes which are
+        // not the checkpoint's own.
+        const long long bytesWritten =
+            connectionStatistic(session, WT_STAT_CONN_BLOCK_BYTE_WRITE) - bytesBefore;
+
+        _checkpoints[trigger].fetchAndAdd(1);
+        _durationMicros.record(timer.micros());
+        _bytesWritten.record(std::max(0LL, bytesWritten));
+    }
+
+}  // namespace mongo
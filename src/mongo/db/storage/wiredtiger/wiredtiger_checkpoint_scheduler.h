@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <wiredtiger.h>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Takes WiredTiger checkpoints from a mongod thread in place of WiredTiger's own
+     * 'checkpoint=(wait=...)' thread, so that checkpoints follow the write load instead of
+     * only the clock.
+     *
+     * A checkpoint is taken when any enabled trigger fires:
+     *  - the time since the last checkpoint reaches the checkpoint delay;
+     *  - the dirty bytes in the WiredTiger cache reach the dirty trigger;
+     *  - the journal bytes written since the last checkpoint reach the journal trigger.
+     *
+     * The dirty and journal triggers are rate limited by a minimum interval between
+     * checkpoints, so a sustained burst of writes results in regular checkpoints no larger
+     * than needed rather than one checkpoint after another. A setting of zero disables the
+     * corresponding trigger or limit. All settings can be changed while the scheduler runs.
+     */
+    class WiredTigerCheckpointScheduler {
+        MONGO_DISALLOW_COPYING(WiredTigerCheckpointScheduler);
+    public:
+        enum Setting {
+            kDelaySecs,
+            kDirtyTriggerMB,
+            kJournalTriggerMB,
+            kMinIntervalSecs,
+            kNumSettings
+        };
+
+        enum Trigger {
+            kNone,
+            kTime,
+            kDirtyBytes,
+            kJournalBytes,
+            kNumTriggers
+        };
+
+        /**
+         * The inputs to a scheduling decision.
+         */
+        struct State {
+            long long millisSinceCheckpoint;
+            long long dirtyBytes;
+            long long journalBytesSinceCheckpoint;
+        };
+
+        /**
+         * 'journaled' tells whether the connection has a journal, without which the journal
+         * trigger never fires. Nothing runs until start() is called.
+         */
+        WiredTigerCheckpointScheduler(WT_CONNECTION* conn, bool journaled);
+        ~WiredTigerCheckpointScheduler();
+
+        void start();
+
+        /**
+         * Stops the scheduler thread and waits for any checkpoint in progress to finish.
+         */
+        void shutdown();
+
+        long long getSetting(Setting setting) const;
+        void setSetting(Setting setting, long long value);
+
+        /**
+         * Returns the server parameter name of 'setting'.
+         */
+        static const char* settingName(Setting setting);
+
+        static const char* triggerName(Trigger trigger);
+
+        /**
+         * Returns which trigger, if any, calls for a checkpoint in 'state'.
+         */
+        Trigger decide(const State& state) const;
+
+        /**
+         * Appends the number of checkpoints taken for each trigger, the current settings and
+         * histograms of checkpoint durations and of bytes written by checkpoints.
+         */
+        void appendStats(BSONObjBuilder* builder) const;
+
+    private:
+        void _run();
+
+        State _readState(WT_SESSION* session, long long millisSinceCheckpoint) const;
+
+        void _checkpoint(WT_SESSION* session, Trigger trigger);
+
+        WT_CONNECTION* const _conn;
+        const bool _journaled;
+
+        AtomicInt64 _settings[kNumSettings];
+
+        long long _journalBytesAtCheckpoint;  // Only used by the scheduler thread.
+        AtomicUInt64 _checkpoints[kNumTriggers];
+        LatencyHistogram _durationMicros;
+        LatencyHistogram _bytesWritten;
+
+        stdx::thread _thread;
+        stdx::mutex _mutex;
+        stdx::condition_variable _cv;
+        bool _shuttingDown;  // Guarded by _mutex.
+    };
+
+}  // namespace mongo
@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_checkpoint_scheduler.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    typedef WiredTigerCheckpointScheduler Scheduler;
+
+    const long long kMB = 1024 * 1024;
+
+    Scheduler::State makeState(long long millis, long long dirtyMB, long long journalMB) {
+        Scheduler::State state;
+        state.millisSinceCheckpoint = millis;
+        state.dirtyBytes = dirtyMB * kMB;
+        state.journalBytesSinceCheckpoint = journalMB * kMB;
+        return state;
+    }
+
+    void configure(Scheduler* scheduler) {
+        scheduler->setSetting(Scheduler::kDelaySecs, 60);
+        scheduler->setSetting(Scheduler::kDirtyTriggerMB, 100);
+        scheduler->setSetting(Scheduler::kJournalTriggerMB, 200);
+        scheduler->setSetting(Scheduler::kMinIntervalSecs, 10);
+    }
+
+    TEST(WiredTigerCheckpointSchedulerTest, TimeTrigger) {
+        Scheduler scheduler(NULL, true);
+        configure(&scheduler);
+
+        ASSERT_EQUALS(Scheduler::kNone, scheduler.decide(makeState(59 * 1000, 0, 0)));
+        ASSERT_EQUALS(Scheduler::kTime, scheduler.decide(makeState(60 * 1000, 0, 0)));
+
+        scheduler.setSetting(Scheduler::kDelaySecs, 0);
+        ASSERT_EQUALS(Scheduler::kNone, scheduler.decide(makeState(3600 * 1000, 0, 0)));
+    }
+
+    TEST(WiredTigerCheckpointSchedulerTest, DirtyBytesTrigger) {
+        Scheduler scheduler(NULL, true);
+        configure(&scheduler);
+
+        ASSERT_EQUALS(Scheduler::kNone, scheduler.decide(makeState(20 * 1000, 99, 0)));
+        ASSERT_EQUALS(Scheduler::kDirtyBytes, scheduler.decide(makeState(20 * 1000, 100, 0)));
+
+        scheduler.setSetting(Scheduler::kDirtyTriggerMB, 0);
+        ASSERT_EQUALS(Scheduler::kNone, scheduler.decide(makeState(20 * 1000, 1000, 0)));
+    }
+
+    TEST(WiredTigerCheckpointSchedulerTest, JournalBytesTrigger) {
+        Scheduler scheduler(NULL, true);
+        configure(&scheduler);
+
+        ASSERT_EQUALS(Scheduler::kNone, scheduler.decide(makeState(20 * 1000, 0, 199)));
+        ASSERT_EQUALS(Scheduler::kJournalBytes, scheduler.decide(makeState(20 * 1000, 0, 200)));
+
+        // Without a journal the journal trigger never fires.
+        Scheduler notJournaled(NULL, false);
+        configure(&notJournaled);
+        ASSERT_EQUALS(Scheduler::kNone, notJournaled.decide(makeState(20 * 1000, 0, 1000)));
+    }
+
+    TEST(WiredTigerCheckpointSchedulerTest, MinIntervalLimitsLoadTriggers) {
+        Scheduler scheduler(NULL, true);
+        configure(&scheduler);
+
+        ASSERT_EQUALS(Scheduler::kNone, scheduler.decide(makeState(9 * 1000, 1000, 1000)));
+        ASSERT_EQUALS(Scheduler::kDirtyBytes, scheduler.decide(makeState(10 * 1000, 1000, 1000)));
+
+        // The time trigger is not limited.
+        scheduler.setSetting(Scheduler::kDelaySecs, 5);
+        ASSERT_EQUALS(Scheduler::kTime, scheduler.decide(makeState(5 * 1000, 0, 0)));
+    }
+
+    TEST(WiredTigerCheckpointSchedulerTest, AppendStats) {
+        Scheduler scheduler(NULL, true);
+        configure(&scheduler);
+
+        BSONObjBuilder builder;
+        scheduler.appendStats(&builder);
+        BSONObj stats = builder.obj();
+
+        ASSERT_EQUALS(0, stats["checkpoints"]["time"].numberLong());
+        ASSERT_EQUALS(0, stats["checkpoints"]["dirtyBytes"].numberLong());
+        ASSERT_EQUALS(0, stats["checkpoints"]["journalBytes"].numberLong());
+        ASSERT_EQUALS(100, stats["settings"]["wiredTigerCheckpointDirtyTriggerMB"].numberLong());
+        ASSERT_EQUALS(0, stats["durationMicros"]["count"].numberLong());
+        ASSERT_EQUALS(0, stats["bytesWritten"]["totalBytes"].numberLong());
+    }
+
+}  // namespace
+}  // namespace mongo
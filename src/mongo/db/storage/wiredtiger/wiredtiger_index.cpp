@@ -54,6 +54,7 @@
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 #define TRACING_ENABLED 0
 
@@ -238,7 +239,9 @@ namespace {
         curwrap.assertInActiveTxn();
         WT_CURSOR *c = curwrap.get();
 
-        return _insert( c, key, loc, dupsAllowed );
+        const KeyString data( key, _ordering );
+        txn->recoveryUnit()->storageStats()->bytesWritten += data.getSize();
+        return _insert( c, data.getBuffer(), data.getSize(), data.getTypeBits(), loc, dupsAllowed );
     }
 
     void WiredTigerIndex::unindex(OperationContext* txn,
@@ -253,7 +256,113 @@ namespace {
         WT_CURSOR *c = curwrap.get();
         invariant( c );
 
-        _unindex( c, key, loc, dupsAllowed );
+        const KeyString data( key, _ordering );
+        _unindex( c, data.getBuffer(), data.getSize(), data.getTypeBits(), loc, dupsAllowed );
+    }
+
+    Status WiredTigerIndex::insertKeyString(OperationContext* txn,
+                                            const KeyStringSet::Key& key,
+                                            const RecordId& loc,
+                                            bool dupsAllowed) {
+        invariant(loc.isNormal());
+
+        if (key.getBsonSize() >= TempKeyMaxSize) {
+            // Only decode the key for the error message.
+            return checkKeySize(key.toBson(_ordering));
+        }
+
+        WiredTigerCursor curwrap(_uri, _instanceId, false, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+
+        txn->recoveryUnit()->storageStats()->bytesWritten += key.getSize();
+        return _insert( c, key.getBuffer(), key.getSize(), key.getTypeBits(), loc, dupsAllowed );
+    }
+
+    Status WiredTigerIndex::insertMany(OperationContext* txn,
+                                       const std::vector<IndexKeyEntry>& entries,
+                                       bool dupsAllowed) {
+        WiredTigerCursor curwrap(_uri, _instanceId, false, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+
+        const bool checkDups = unique() && !dupsAllowed;
+        KeyString data;
+        for (size_t i = 0; i < entries.size(); i++) {
+            const IndexKeyEntry& entry = entries[i];
+            invariant(entry.loc.isNormal());
+            dassert(!hasFieldNames(entry.key));
+
+            // Duplicates within the batch are next to each other and need no search
+            if (checkDups && i > 0 && entry.loc != entries[i - 1].loc &&
+                    entry.key.woCompare(entries[i - 1].key, _ordering, false) == 0) {
+                return dupKeyError(entry.key);
+            }
+
+            Status s = checkKeySize(entry.key);
+            if (!s.isOK())
+                return s;
+
+            data.resetToKey(entry.key, _ordering);
+            txn->recoveryUnit()->storageStats()->bytesWritten += data.getSize();
+            s = _insert(c, data.getBuffer(), data.getSize(), data.getTypeBits(), entry.loc,
+                        dupsAllowed);
+            if (!s.isOK())
+                return s;
+        }
+
+        return Status::OK();
+    }
+
+    Status WiredTigerIndex::insertManyKeyStrings(OperationContext* txn,
+                                                 const std::vector<KeyStringEntry>& entries,
+                                                 bool dupsAllowed) {
+        WiredTigerCursor curwrap(_uri, _instanceId, false, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+
+        const bool checkDups = unique() && !dupsAllowed;
+        for (size_t i = 0; i < entries.size(); i++) {
+            const KeyStringSet::Key& key = entries[i].key;
+            const RecordId& loc = entries[i].loc;
+            invariant(loc.isNormal());
+
+            // Duplicates within the batch are next to each other and need no search
+            if (checkDups && i > 0 && loc != entries[i - 1].loc) {
+                const KeyStringSet::Key& prev = entries[i - 1].key;
+                if (key.getSize() == prev.getSize() &&
+                        memcmp(key.getBuffer(), prev.getBuffer(), key.getSize()) == 0) {
+                    return dupKeyError(key.toBson(_ordering));
+                }
+            }
+
+            if (key.getBsonSize() >= TempKeyMaxSize) {
+                // Only decode the key for the error message.
+                return checkKeySize(key.toBson(_ordering));
+            }
+
+            txn->recoveryUnit()->storageStats()->bytesWritten += key.getSize();
+            Status s = _insert(c, key.getBuffer(), key.getSize(), key.getTypeBits(), loc,
+                               dupsAllowed);
+            if (!s.isOK())
+                return s;
+        }
+
+        return Status::OK();
+    }
+
+    void WiredTigerIndex::unindexKeyString(OperationContext* txn,
+                                           const KeyStringSet::Key& key,
+                                           const RecordId& loc,
+                                           bool dupsAllowed) {
+        invariant(loc.isNormal());
+
+        WiredTigerCursor curwrap(_uri, _instanceId, false, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+        invariant( c );
+
+        _unindex( c, key.getBuffer(), key.getSize(), key.getTypeBits(), loc, dupsAllowed );
     }
 
     void WiredTigerIndex::fullValidate(OperationContext* txn, bool full, long long *numKeysOut,
@@ -348,6 +457,13 @@ namespace {
             output->append("code", static_cast<int>(status.code()));
             output->append("reason", status.reason());
         }
+
+        StatusWith<WiredTigerUtil::CacheResidency> residency =
+            WiredTigerUtil::getCacheResidency(s, uri());
+        if (residency.isOK()) {
+            BSONObjBuilder residencyBuilder(output->subobjStart("cacheResidency"));
+            residency.getValue().appendTo(&residencyBuilder, scale);
+        }
         return true;
     }
 
@@ -383,6 +499,72 @@ namespace {
                                                                      _uri ) );
     }
 
+    bool WiredTigerIndex::sampleKeys(OperationContext* txn,
+                                     int numKeys,
+                                     std::vector<BSONObj>* keys) const {
+        WT_SESSION* session = WiredTigerRecoveryUnit::get(txn)->getSession(txn)->getSession();
+        WT_CURSOR* c;
+        invariantWTOK(session->open_cursor(session, _uri.c_str(), NULL, "next_random=true", &c));
+        ON_BLOCK_EXIT(c->close, c);
+
+        for (int i = 0; i < numKeys; i++) {
+            int ret = WT_OP_CHECK(c->next(c));
+            if (ret == WT_NOTFOUND) {
+                break;
+            }
+            invariantWTOK(ret);
+
+            WT_ITEM key;
+            WT_ITEM value;
+            invariantWTOK(c->get_key(c, &key));
+            invariantWTOK(c->get_value(c, &value));
+
+            // Unique indexes keep the RecordId in the value, ahead of the type bits
+            BufReader br(value.data, value.size);
+            if (unique()) {
+                KeyString::decodeRecordId(&br);
+            }
+            KeyString::TypeBits typeBits;
+            typeBits.resetFromBuffer(&br);
+            keys->push_back(KeyString::toBson(static_cast<const char*>(key.data), key.size,
+                                              _ordering, typeBits));
+        }
+        return true;
+    }
+
+    Status WiredTigerIndex::touch(OperationContext* txn) const {
+        WiredTigerTouchThrottle throttle(txn);
+        WiredTigerCursor curwrap(_uri, _instanceId, false, txn);
+        WT_CURSOR* c = curwrap.get();
+
+        int ret;
+        while ((ret = WT_OP_CHECK(c->next(c))) == 0) {
+            WT_ITEM key;
+            WT_ITEM value;
+            invariantWTOK(c->get_key(c, &key));
+            invariantWTOK(c->get_value(c, &value));
+            if (!throttle.hit(key.size + value.size)) {
+                continue;
+            }
+
+            // The key points into the cursor's page, which pausing lets go of.
+            const std::string savedKey(static_cast<const char*>(key.data), key.size);
+            throttle.pause();
+
+            WiredTigerItem item(savedKey);
+            c->set_key(c, item.Get());
+            int cmp;
+            ret = WT_OP_CHECK(c->search_near(c, &cmp));
+            if (ret != 0) {
+                break;
+            }
+        }
+        if (ret != WT_NOTFOUND) {
+            return wtRCToStatus(ret);
+        }
+        return Status::OK();
+    }
+
     bool WiredTigerIndex::isDup(WT_CURSOR *c, const BSONObj& key, const RecordId& loc ) {
         invariant( unique() );
         // First check whether the key exists.
@@ -606,7 +788,8 @@ namespace {
            : _txn(txn),
              _cursor(idx.uri(), idx.instanceId(), false, txn),
              _idx(idx),
-             _forward(forward) {
+             _forward(forward),
+             _keyBuffer(0) {
         }
 
         boost::optional<IndexKeyEntry> next(RequestedInfo parts) override {
@@ -618,6 +801,10 @@ namespace {
             return curr(parts);
         }
 
+        void allowUnownedKeys() override {
+            _allowUnownedKeys = true;
+        }
+
         void setEndPosition(const BSONObj& key, bool inclusive) override {
             TRACE_CURSOR << "setEndPosition inclusive: " << inclusive << ' ' << key;
             if (key.isEmpty()) {
@@ -666,8 +853,10 @@ namespace {
             if (!_txn) return; // still saved
 
             _savedForCheck = _txn->recoveryUnit();
+            _savedSnapshotId = _savedForCheck->getSnapshotId();
 
-            if (!wt_keeptxnopen()) {
+            // A pinned snapshot outlives this save, so keep our position in it.
+            if (!wt_keeptxnopen() && !_savedForCheck->isSnapshotPinned()) {
                 try {
                     _cursor.reset();
                 }
@@ -696,7 +885,15 @@ namespace {
             if (!wt_keeptxnopen()) {
                 if (!_eof) {
                     // Ensure an active session exists, so any restored cursors will bind to it
-                    WiredTigerRecoveryUnit::get(txn)->getSession(txn);
+                    WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(txn);
+                    ru->getSession(txn);
+
+                    if (ru->isPositionRetained(_savedSnapshotId)) {
+                        // The WT cursor hasn't moved, so neither has _lastMoveWasRestore.
+                        WiredTigerRecoveryUnit::noteReseekAvoided();
+                        return;
+                    }
+
                     _lastMoveWasRestore = !seekWTCursor(_key);
                     TRACE_CURSOR << "restore _lastMoveWasRestore:" << _lastMoveWasRestore;
                 }
@@ -715,8 +912,14 @@ namespace {
 
             BSONObj bson;
             if (TRACING_ENABLED || (parts & kWantKey)) {
-                bson = KeyString::toBson(_key.getBuffer(), _key.getSize(), _idx.ordering(),
-                                         _typeBits);
+                if (_allowUnownedKeys) {
+                    bson = KeyString::toBson(_key.getBuffer(), _key.getSize(), _idx.ordering(),
+                                             _typeBits, &_keyBuffer);
+                }
+                else {
+                    bson = KeyString::toBson(_key.getBuffer(), _key.getSize(), _idx.ordering(),
+                                             _typeBits);
+                }
 
                 TRACE_CURSOR << " returning " << bson << ' ' << _loc;
             }
@@ -824,6 +1027,9 @@ namespace {
         // Ensures we have the same RU at restore time.
         RecoveryUnit* _savedForCheck;
 
+        // The snapshot at the last save, to tell whether restore() needs to reposition the cursor.
+        SnapshotId _savedSnapshotId;
+
         // These are where this cursor instance is. They are not changed in the face of a failing
         // next().
         KeyString _key;
@@ -842,6 +1048,10 @@ namespace {
         KeyString _query;
 
         std::unique_ptr<KeyString> _endPosition;
+
+        // Keys are decoded into _keyBuffer instead of their own allocations if this is set.
+        bool _allowUnownedKeys = false;
+        mutable BufBuilder _keyBuffer;
     };
 
     class WiredTigerIndexStandardCursor final : public WiredTigerIndexCursorBase {
@@ -952,16 +1162,17 @@ namespace {
     }
 
     Status WiredTigerIndexUnique::_insert( WT_CURSOR* c,
-                                           const BSONObj& key,
+                                           const char* keyData,
+                                           size_t keySize,
+                                           const KeyString::TypeBits& typeBits,
                                            const RecordId& loc,
                                            bool dupsAllowed ) {
 
-        const KeyString data( key, _ordering );
-        WiredTigerItem keyItem( data.getBuffer(), data.getSize() );
+        WiredTigerItem keyItem( keyData, keySize );
 
         KeyString value(loc);
-        if (!data.getTypeBits().isAllZeros())
-            value.appendTypeBits(data.getTypeBits());
+        if (!typeBits.isAllZeros())
+            value.appendTypeBits(typeBits);
 
         WiredTigerItem valueItem(value.getBuffer(), value.getSize());
         c->set_key( c, keyItem.Get() );
@@ -993,7 +1204,7 @@ namespace {
 
             if (!insertedLoc && loc < locInIndex) {
                 value.appendRecordId(loc);
-                value.appendTypeBits(data.getTypeBits());
+                value.appendTypeBits(typeBits);
                 insertedLoc = true;
             }
 
@@ -1003,12 +1214,12 @@ namespace {
         }
 
         if (!dupsAllowed)
-            return dupKeyError(key);
+            return dupKeyError(KeyString::toBson(keyData, keySize, _ordering, typeBits));
 
         if (!insertedLoc) {
             // This loc is higher than all currently in the index for this key
             value.appendRecordId(loc);
-            value.appendTypeBits(data.getTypeBits());
+            value.appendTypeBits(typeBits);
         }
 
         valueItem = WiredTigerItem(value.getBuffer(), value.getSize());
@@ -1017,11 +1228,12 @@ namespace {
     }
 
     void WiredTigerIndexUnique::_unindex( WT_CURSOR* c,
-                                          const BSONObj& key,
+                                          const char* keyData,
+                                          size_t keySize,
+                                          const KeyString::TypeBits& typeBits,
                                           const RecordId& loc,
                                           bool dupsAllowed ) {
-        KeyString data( key, _ordering );
-        WiredTigerItem keyItem( data.getBuffer(), data.getSize() );
+        WiredTigerItem keyItem( keyData, keySize );
         c->set_key( c, keyItem.Get() );
 
         if ( !dupsAllowed ) {
@@ -1068,7 +1280,8 @@ namespace {
         }
 
         if (!foundLoc) {
-            warning().stream() << loc << " not found in the index for key " << key;
+            warning().stream() << loc << " not found in the index for key "
+                               << KeyString::toBson(keyData, keySize, _ordering, typeBits);
             return; // nothing to do
         }
 
@@ -1111,20 +1324,24 @@ namespace {
     }
 
     Status WiredTigerIndexStandard::_insert( WT_CURSOR* c,
-                                             const BSONObj& keyBson,
+                                             const char* keyData,
+                                             size_t keySize,
+                                             const KeyString::TypeBits& typeBits,
                                              const RecordId& loc,
                                              bool dupsAllowed ) {
         invariant( dupsAllowed );
 
-        TRACE_INDEX << " key: " << keyBson << " loc: " << loc;
+        TRACE_INDEX << " key: " << KeyString::toBson(keyData, keySize, _ordering, typeBits)
+                    << " loc: " << loc;
 
-        KeyString key( keyBson, _ordering, loc );
+        KeyString key;
+        key.resetFromBuffer( keyData, keySize );
+        key.appendRecordId( loc );
         WiredTigerItem keyItem( key.getBuffer(), key.getSize() );
 
         WiredTigerItem valueItem = 
-            key.getTypeBits().isAllZeros() ? emptyItem
-                                           : WiredTigerItem(key.getTypeBits().getBuffer(),
-                                                            key.getTypeBits().getSize());
+            typeBits.isAllZeros() ? emptyItem
+                                  : WiredTigerItem(typeBits.getBuffer(), typeBits.getSize());
 
         c->set_key(c, keyItem.Get());
         c->set_value(c, valueItem.Get());
@@ -1139,11 +1356,15 @@ namespace {
     }
 
     void WiredTigerIndexStandard::_unindex( WT_CURSOR* c,
-                                            const BSONObj& key,
+                                            const char* keyData,
+                                            size_t keySize,
+                                            const KeyString::TypeBits& typeBits,
                                             const RecordId& loc,
                                             bool dupsAllowed ) {
         invariant( dupsAllowed );
-        KeyString data( key, _ordering, loc );
+        KeyString data;
+        data.resetFromBuffer( keyData, keySize );
+        data.appendRecordId( loc );
         WiredTigerItem item( data.getBuffer(), data.getSize() );
         c->set_key(c, item.Get() );
         int ret = WT_OP_CHECK(c->remove(c));
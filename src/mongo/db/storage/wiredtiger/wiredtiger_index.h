@@ -32,6 +32,7 @@
 
 #include "mongo/base/status_with.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 
@@ -41,6 +42,23 @@ namespace mongo {
     class IndexDescriptor;
     struct WiredTigerItem;
 
+    /**
+     * Index entries are stored in tables with key_format=u,value_format=u.
+     *
+     * Standard indexes use KeyString(key, RecordId) as the WT key. The WT value holds the
+     * key's TypeBits, and it is empty when all of the key's components are type-canonical. For
+     * example, a key made only of strings and 32-bit integers takes no space in the value.
+     *
+     * Unique indexes use KeyString(key) as the WT key. The WT value holds the RecordId. If
+     * there is exactly one RecordId, its TypeBits follow only when they are not all zeros.
+     * If there are several RecordIds (possible only while duplicates are allowed), each is
+     * followed by its TypeBits.
+     *
+     * Long shared key prefixes, such as a tenant id followed by a path, are best handled by WT
+     * prefix compression. It is on by default through
+     * storage.wiredTiger.indexConfig.prefixCompression. Since WT keeps keys prefix compressed in
+     * cache as well as on disk, it also lets more of an index fit in cache.
+     */
     class WiredTigerIndex : public SortedDataInterface {
     public:
 
@@ -91,6 +109,26 @@ namespace mongo {
                              const RecordId& loc,
                              bool dupsAllowed);
 
+        virtual bool supportsKeyStrings() const { return true; }
+
+        virtual Status insertKeyString(OperationContext* txn,
+                                       const KeyStringSet::Key& key,
+                                       const RecordId& loc,
+                                       bool dupsAllowed);
+
+        virtual void unindexKeyString(OperationContext* txn,
+                                      const KeyStringSet::Key& key,
+                                      const RecordId& loc,
+                                      bool dupsAllowed);
+
+        virtual Status insertMany(OperationContext* txn,
+                                  const std::vector<IndexKeyEntry>& entries,
+                                  bool dupsAllowed);
+
+        virtual Status insertManyKeyStrings(OperationContext* txn,
+                                            const std::vector<KeyStringEntry>& entries,
+                                            bool dupsAllowed);
+
         virtual void fullValidate(OperationContext* txn, bool full, long long *numKeysOut,
                                   BSONObjBuilder* output) const;
         virtual bool appendCustomStats(OperationContext* txn, BSONObjBuilder* output, double scale)
@@ -101,6 +139,12 @@ namespace mongo {
 
         virtual long long getSpaceUsedBytes( OperationContext* txn ) const;
 
+        virtual Status touch(OperationContext* txn) const;
+
+        virtual bool sampleKeys(OperationContext* txn,
+                                int numKeys,
+                                std::vector<BSONObj>* keys) const;
+
         bool isDup(WT_CURSOR *c, const BSONObj& key, const RecordId& loc );
 
         virtual Status initAsEmpty(OperationContext* txn);
@@ -116,13 +160,21 @@ namespace mongo {
 
     protected:
 
+        /**
+         * 'keyData' and 'keySize' hold the key encoded as a KeyString under _ordering, without a
+         * RecordId, and 'typeBits' its TypeBits.
+         */
         virtual Status _insert( WT_CURSOR* c,
-                                const BSONObj& key,
+                                const char* keyData,
+                                size_t keySize,
+                                const KeyString::TypeBits& typeBits,
                                 const RecordId& loc,
                                 bool dupsAllowed ) = 0;
 
         virtual void _unindex( WT_CURSOR* c,
-                               const BSONObj& key,
+                               const char* keyData,
+                               size_t keySize,
+                               const KeyString::TypeBits& typeBits,
                                const RecordId& loc,
                                bool dupsAllowed ) = 0;
 
@@ -153,12 +205,16 @@ namespace mongo {
         bool unique() const override { return true; }
 
         Status _insert(WT_CURSOR* c,
-                       const BSONObj& key,
+                       const char* keyData,
+                       size_t keySize,
+                       const KeyString::TypeBits& typeBits,
                        const RecordId& loc,
                        bool dupsAllowed) override;
 
         void _unindex(WT_CURSOR* c,
-                      const BSONObj& key,
+                      const char* keyData,
+                      size_t keySize,
+                      const KeyString::TypeBits& typeBits,
                       const RecordId& loc,
                       bool dupsAllowed) override;
     };
@@ -178,12 +234,16 @@ namespace mongo {
         bool unique() const override { return false; }
 
         Status _insert(WT_CURSOR* c,
-                       const BSONObj& key,
+                       const char* keyData,
+                       size_t keySize,
+                       const KeyString::TypeBits& typeBits,
                        const RecordId& loc,
                        bool dupsAllowed) override;
 
         void _unindex(WT_CURSOR* c,
-                      const BSONObj& key,
+                      const char* keyData,
+                      size_t keySize,
+                      const KeyString::TypeBits& typeBits,
                       const RecordId& loc,
                       bool dupsAllowed) override;
 
@@ -36,7 +36,9 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/sorted_data_interface_test_harness.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
@@ -44,6 +46,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -90,6 +93,31 @@ namespace mongo {
             return stdx::make_unique<WiredTigerRecoveryUnit>( _sessionCache );
         }
 
+        bool supportsDocLocking() const final { return true; }
+
+        /**
+         * Returns the size of the WT value stored under 'key' in the index created by
+         * newSortedDataInterface(), or -1 if there is none.
+         */
+        int valueSize(const KeyString& key) {
+            WiredTigerSession session(_conn);
+            WT_SESSION* s = session.getSession();
+            WT_CURSOR* c;
+            invariantWTOK(s->open_cursor(s, "table:test.wt", NULL, NULL, &c));
+            ON_BLOCK_EXIT(c->close, c);
+
+            WiredTigerItem keyItem(key.getBuffer(), key.getSize());
+            c->set_key(c, keyItem.Get());
+            int ret = c->search(c);
+            if (ret == WT_NOTFOUND)
+                return -1;
+            invariantWTOK(ret);
+
+            WT_ITEM value;
+            invariantWTOK(c->get_value(c, &value));
+            return value.size;
+        }
+
     private:
         unittest::TempDir _dbpath;
         WT_CONNECTION* _conn;
@@ -139,4 +167,65 @@ namespace mongo {
         ASSERT_EQ(result.getValue(), "abc=def,");
     }
 
+    TEST(WiredTigerIndexTest, GenerateCreateStringPrefixCompression) {
+        BSONObj spec = BSON("key" << BSON("a" << 1) << "name" << "testIndex" << "ns" << "test.wt");
+        IndexDescriptor desc(NULL, "", spec);
+
+        const bool oldPrefixCompression = wiredTigerGlobalOptions.useIndexPrefixCompression;
+        ON_BLOCK_EXIT([oldPrefixCompression] {
+            wiredTigerGlobalOptions.useIndexPrefixCompression = oldPrefixCompression;
+        });
+
+        wiredTigerGlobalOptions.useIndexPrefixCompression = true;
+        StatusWith<std::string> result = WiredTigerIndex::generateCreateString("", desc);
+        ASSERT_OK(result.getStatus());
+        ASSERT_NOT_EQUALS(std::string::npos, result.getValue().find("prefix_compression=true"));
+
+        wiredTigerGlobalOptions.useIndexPrefixCompression = false;
+        result = WiredTigerIndex::generateCreateString("", desc);
+        ASSERT_OK(result.getStatus());
+        ASSERT_EQUALS(std::string::npos, result.getValue().find("prefix_compression=true"));
+    }
+
+    TEST(WiredTigerIndexTest, StandardIndexOmitsCanonicalTypeBits) {
+        MyHarnessHelper harnessHelper;
+        std::unique_ptr<SortedDataInterface> sorted(harnessHelper.newSortedDataInterface(false));
+        const Ordering ordering = Ordering::make(BSON("a" << 1));
+
+        const BSONObj canonicalKey = BSON("" << "tenant/path");
+        const BSONObj doubleKey = BSON("" << 2.0);
+        {
+            OperationContextNoop txn(harnessHelper.newRecoveryUnit().release());
+            WriteUnitOfWork uow(&txn);
+            ASSERT_OK(sorted->insert(&txn, canonicalKey, RecordId(1), true));
+            ASSERT_OK(sorted->insert(&txn, doubleKey, RecordId(2), true));
+            uow.commit();
+        }
+
+        ASSERT_EQUALS(0, harnessHelper.valueSize(KeyString(canonicalKey, ordering, RecordId(1))));
+        ASSERT_GREATER_THAN(harnessHelper.valueSize(KeyString(doubleKey, ordering, RecordId(2))),
+                            0);
+    }
+
+    TEST(WiredTigerIndexTest, UniqueIndexOmitsCanonicalTypeBits) {
+        MyHarnessHelper harnessHelper;
+        std::unique_ptr<SortedDataInterface> sorted(harnessHelper.newSortedDataInterface(true));
+        const Ordering ordering = Ordering::make(BSON("a" << 1));
+
+        const BSONObj canonicalKey = BSON("" << 5);
+        const BSONObj doubleKey = BSON("" << 2.0);
+        {
+            OperationContextNoop txn(harnessHelper.newRecoveryUnit().release());
+            WriteUnitOfWork uow(&txn);
+            ASSERT_OK(sorted->insert(&txn, canonicalKey, RecordId(1), false));
+            ASSERT_OK(sorted->insert(&txn, doubleKey, RecordId(2), false));
+            uow.commit();
+        }
+
+        const int recordIdSize = static_cast<int>(KeyString(RecordId(1)).getSize());
+        ASSERT_EQUALS(recordIdSize, harnessHelper.valueSize(KeyString(canonicalKey, ordering)));
+        ASSERT_GREATER_THAN(harnessHelper.valueSize(KeyString(doubleKey, ordering)),
+                            recordIdSize);
+    }
+
 }  // namespace mongo
@@ -39,6 +39,7 @@
 #include "mongo/db/storage/kv/kv_storage_engine.h"
 #include "mongo/db/storage/storage_engine_lock_file.h"
 #include "mongo/db/storage/storage_engine_metadata.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_cache_residency_command.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
@@ -69,12 +70,25 @@ namespace mongo {
                 kv->setSortedDataInterfaceExtraOptions( wiredTigerGlobalOptions.indexConfig );
                 // Intentionally leaked.
                 new WiredTigerServerStatusSection(kv);
+                new WiredTigerCacheResidencyCommand(kv);
                 new WiredTigerEngineRuntimeConfigParameter(kv);
+                for (int i = 0; i < WiredTigerCheckpointScheduler::kNumSettings; i++) {
+                    new WiredTigerCheckpointSchedulerParameter(
+                        kv->getCheckpointScheduler(),
+                        static_cast<WiredTigerCheckpointScheduler::Setting>(i));
+                }
+                for (int i = 0; i < WiredTigerTicketController::kNumSettings; i++) {
+                    new WiredTigerTicketControllerParameter(
+                        kv->getTicketController(),
+                        static_cast<WiredTigerTicketController::Setting>(i));
+                }
 
                 KVStorageEngineOptions options;
                 options.directoryPerDB = params.directoryperdb;
                 options.directoryForIndexes = wiredTigerGlobalOptions.directoryForIndexes;
                 options.forRepair = params.repair;
+                options.startupThreads = params.startupThreads;
+                options.lazyOpen = params.lazyOpen;
                 return new KVStorageEngine( kv, options );
             }
 
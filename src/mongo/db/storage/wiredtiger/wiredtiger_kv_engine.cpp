@@ -67,8 +67,7 @@ namespace mongo {
                                             bool repair )
         : _eventHandler(WiredTigerUtil::defaultEventHandlers()),
           _path( path ),
-          _durable( durable ),
-          _sizeStorerSyncTracker( 100000, 60 * 1000 ) {
+          _durable( durable ) {
 
         size_t cacheSizeGB = wiredTigerGlobalOptions.cacheSizeGB;
         if (cacheSizeGB == 0) {
@@ -108,8 +107,6 @@ namespace mongo {
             ss << wiredTigerGlobalOptions.journalCompressor << "),";
         }
         ss << "file_manager=(close_idle_time=100000),"; //~28 hours, will put better fix in 3.1.x
-        ss << "checkpoint=(wait=" << wiredTigerGlobalOptions.checkpointDelaySecs;
-        ss << ",log_size=2GB),";
         ss << "statistics_log=(wait=" << wiredTigerGlobalOptions.statisticsLogDelaySecs << "),";
         ss << WiredTigerCustomizationHooks::get(
                 getGlobalServiceContext())->getOpenConfig("metadata");
@@ -138,7 +135,26 @@ namespace mongo {
             }
             _sizeStorer.reset(new WiredTigerSizeStorer(_conn, _sizeStorerUri));
             _sizeStorer->fillCache();
+            _sizeStorer->startBackgroundFlusher(Seconds(1));
         }
+
+        // Checkpoints are scheduled by _checkpointScheduler rather than by WiredTiger's own
+        // checkpoint thread.
+        _checkpointScheduler.reset(new WiredTigerCheckpointScheduler(_conn, _durable));
+        _checkpointScheduler->setSetting(WiredTigerCheckpointScheduler::kDelaySecs,
+                                         wiredTigerGlobalOptions.checkpointDelaySecs);
+        _checkpointScheduler->setSetting(WiredTigerCheckpointScheduler::kDirtyTriggerMB,
+                                         cacheSizeGB * 1024 / 2);
+        _checkpointScheduler->start();
+
+        _ticketController.reset(new WiredTigerTicketController(
+            _conn,
+            WiredTigerRecoveryUnit::getWriteTicketHolder(),
+            WiredTigerRecoveryUnit::getReadTicketHolder()));
+        _ticketController->start();
+
+        _idleSessionSweeperShutdown = false;
+        _idleSessionSweeperThread = stdx::thread(&WiredTigerKVEngine::_idleSessionSweeper, this);
     }
 
 
@@ -153,6 +169,20 @@ namespace mongo {
     void WiredTigerKVEngine::cleanShutdown() {
         log() << "WiredTigerKVEngine shutting down";
         syncSizeInfo(true);
+        if (_idleSessionSweeperThread.joinable()) {
+            {
+                stdx::lock_guard<stdx::mutex> lk(_idleSessionSweeperMutex);
+                _idleSessionSweeperShutdown = true;
+            }
+            _idleSessionSweeperCV.notify_one();
+            _idleSessionSweeperThread.join();
+        }
+        if (_checkpointScheduler) {
+            _checkpointScheduler->shutdown();
+        }
+        if (_ticketController) {
+            _ticketController->shutdown();
+        }
         if (_conn) {
             // these must be the last things we do before _conn->close();
             _sizeStorer.reset( NULL );
@@ -168,6 +198,21 @@ namespace mongo {
         }
     }
 
+    void WiredTigerKVEngine::_idleSessionSweeper() {
+        stdx::unique_lock<stdx::mutex> lk(_idleSessionSweeperMutex);
+        while (!_idleSessionSweeperShutdown) {
+            _idleSessionSweeperCV.wait_for(lk, Seconds(10));
+            if (_idleSessionSweeperShutdown) {
+                break;
+            }
+
+            const int idleTimeSecs = wiredTigerSessionCloseIdleTimeSecs;
+            if (idleTimeSecs > 0) {
+                _sessionCache->closeExpiredIdleSessions(idleTimeSecs * 1000LL);
+            }
+        }
+    }
+
     Status WiredTigerKVEngine::okToRename( OperationContext* opCtx,
                                            StringData fromNS,
                                            StringData toNS,
@@ -186,6 +231,13 @@ namespace mongo {
         return WiredTigerUtil::getIdentSize(session->getSession(), _uri(ident) );
     }
 
+    StatusWith<WiredTigerUtil::CacheResidency> WiredTigerKVEngine::getCacheResidency(
+            OperationContext* opCtx,
+            StringData ident) {
+        WiredTigerSession* session = WiredTigerRecoveryUnit::get(opCtx)->getSession(opCtx);
+        return WiredTigerUtil::getCacheResidency(session->getSession(), _uri(ident));
+    }
+
     Status WiredTigerKVEngine::repairIdent( OperationContext* opCtx,
                                             StringData ident ) {
         WiredTigerSession* session = WiredTigerRecoveryUnit::get(opCtx)->getSession(opCtx);
@@ -354,10 +406,6 @@ namespace mongo {
     }
 
     bool WiredTigerKVEngine::haveDropsQueued() const {
-        if ( _sizeStorerSyncTracker.intervalHasElapsed() ) {
-            _sizeStorerSyncTracker.resetLastTime();
-            syncSizeInfo(false);
-        }
         boost::lock_guard<boost::mutex> lk( _identToDropMutex );
         return !_identToDrop.empty();
     }
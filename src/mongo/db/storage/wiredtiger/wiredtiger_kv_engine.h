@@ -40,8 +40,13 @@
 
 #include "mongo/bson/ordering.h"
 #include "mongo/db/storage/kv/kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_checkpoint_scheduler.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
-#include "mongo/util/elapsed_tracker.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 
 namespace mongo {
 
@@ -114,6 +119,18 @@ namespace mongo {
         int reconfigure(const char* str);
 
         WT_CONNECTION* getConnection() { return _conn; }
+
+        WiredTigerCheckpointScheduler* getCheckpointScheduler() {
+            return _checkpointScheduler.get();
+        }
+
+        WiredTigerTicketController* getTicketController() {
+            return _ticketController.get();
+        }
+
+        StatusWith<WiredTigerUtil::CacheResidency> getCacheResidency(OperationContext* opCtx,
+                                                                     StringData ident);
+
         void dropAllQueued();
         bool haveDropsQueued() const;
 
@@ -127,6 +144,13 @@ namespace mongo {
          */
         static bool initRsOplogBackgroundThread(StringData ns);
 
+        /**
+         * Asks the background capped deleter, which is started by the first request, to delete
+         * the excess documents of the capped collection 'ns'. Returns false if there is no
+         * background capped deleter, in which case the caller must delete them itself.
+         */
+        static bool requestCappedDelete(StringData ns);
+
     private:
 
         Status _salvageIfNeeded(const char* uri);
@@ -137,9 +161,17 @@ namespace mongo {
         std::string _uri( StringData ident ) const;
         bool _drop( StringData ident );
 
+        /**
+         * Body of the thread which periodically closes sessions that have sat unused in the
+         * session cache for longer than wiredTigerSessionCloseIdleTimeSecs.
+         */
+        void _idleSessionSweeper();
+
         WT_CONNECTION* _conn;
         WT_EVENT_HANDLER _eventHandler;
         std::unique_ptr<WiredTigerSessionCache> _sessionCache;
+        std::unique_ptr<WiredTigerCheckpointScheduler> _checkpointScheduler;
+        std::unique_ptr<WiredTigerTicketController> _ticketController;
         std::string _path;
         bool _durable;
 
@@ -151,7 +183,11 @@ namespace mongo {
 
         std::unique_ptr<WiredTigerSizeStorer> _sizeStorer;
         std::string _sizeStorerUri;
-        mutable ElapsedTracker _sizeStorerSyncTracker;
+
+        stdx::thread _idleSessionSweeperThread;
+        stdx::mutex _idleSessionSweeperMutex;
+        stdx::condition_variable _idleSessionSweeperCV;
+        bool _idleSessionSweeperShutdown;  // Guarded by _idleSessionSweeperMutex.
     };
 
 }
@@ -31,6 +31,7 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_parameters.h"
 
+#include "mongo/base/parse_number.h"
 #include "mongo/logger/parse_log_component_settings.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -85,4 +86,101 @@ Status WiredTigerEngineRuntimeConfigParameter::setFromString(const std::string&
     return Status::OK();
 }
 
+WiredTigerCheckpointSchedulerParameter::WiredTigerCheckpointSchedulerParameter(
+    WiredTigerCheckpointScheduler* scheduler,
+    WiredTigerCheckpointScheduler::Setting setting)
+    : ServerParameter(ServerParameterSet::getGlobal(),
+        WiredTigerCheckpointScheduler::settingName(setting), false, true),
+        _scheduler(scheduler),
+        _setting(setting) {}
+
+void WiredTigerCheckpointSchedulerParameter::append(OperationContext* txn, BSONObjBuilder& b,
+                    const std::string& name) {
+    b << name << _scheduler->getSetting(_setting);
+}
+
+Status WiredTigerCheckpointSchedulerParameter::set(const BSONElement& newValueElement) {
+    const long long value = newValueElement.safeNumberLong();
+    if (!newValueElement.isNumber() ||
+        static_cast<double>(value) != newValueElement.numberDouble()) {
+        return Status(ErrorCodes::BadValue, mongoutils::str::stream() <<
+                name() << " must be an integer, not " << newValueElement);
+    }
+    return _set(value);
+}
+
+Status WiredTigerCheckpointSchedulerParameter::setFromString(const std::string& str) {
+    long long value;
+    Status status = parseNumberFromString(str, &value);
+    if (!status.isOK()) {
+        return Status(ErrorCodes::BadValue, mongoutils::str::stream() <<
+                name() << " must be an integer, not \"" << str << "\"");
+    }
+    return _set(value);
+}
+
+Status WiredTigerCheckpointSchedulerParameter::_set(long long value) {
+    if (value < 0) {
+        return Status(ErrorCodes::BadValue, mongoutils::str::stream() <<
+                name() << " must be greater than or equal to 0, not " << value);
+    }
+
+    log() << "Setting " << name() << " to " << value;
+    _scheduler->setSetting(_setting, value);
+    return Status::OK();
+}
+
+WiredTigerTicketControllerParameter::WiredTigerTicketControllerParameter(
+    WiredTigerTicketController* controller,
+    WiredTigerTicketController::Setting setting)
+    : ServerParameter(ServerParameterSet::getGlobal(),
+        WiredTigerTicketController::settingName(setting), false, true),
+        _controller(controller),
+        _setting(setting) {}
+
+void WiredTigerTicketControllerParameter::append(OperationContext* txn, BSONObjBuilder& b,
+                    const std::string& name) {
+    b << name << _controller->getSetting(_setting);
+}
+
+Status WiredTigerTicketControllerParameter::set(const BSONElement& newValueElement) {
+    if (newValueElement.type() == Bool) {
+        return _set(newValueElement.boolean() ? 1 : 0);
+    }
+    const long long value = newValueElement.safeNumberLong();
+    if (!newValueElement.isNumber() ||
+        static_cast<double>(value) != newValueElement.numberDouble()) {
+        return Status(ErrorCodes::BadValue, mongoutils::str::stream() <<
+                name() << " must be an integer, not " << newValueElement);
+    }
+    return _set(value);
+}
+
+Status WiredTigerTicketControllerParameter::setFromString(const std::string& str) {
+    long long value;
+    Status status = parseNumberFromString(str, &value);
+    if (!status.isOK()) {
+        return Status(ErrorCodes::BadValue, mongoutils::str::stream() <<
+                name() << " must be an integer, not \"" << str << "\"");
+    }
+    return _set(value);
+}
+
+Status WiredTigerTicketControllerParameter::_set(long long value) {
+    if (_setting == WiredTigerTicketController::kEnabled) {
+        if (value != 0 && value != 1) {
+            return Status(ErrorCodes::BadValue, mongoutils::str::stream() <<
+                    name() << " must be 0 or 1, not " << value);
+        }
+    }
+    else if (value <= 0) {
+        return Status(ErrorCodes::BadValue, mongoutils::str::stream() <<
+                name() << " must be greater than 0, not " << value);
+    }
+
+    log() << "Setting " << name() << " to " << value;
+    _controller->setSetting(_setting, value);
+    return Status::OK();
+}
+
 }
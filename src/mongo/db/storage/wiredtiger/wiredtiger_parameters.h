@@ -49,4 +49,50 @@ namespace mongo {
     private:
         WiredTigerKVEngine* _engine;
     };
+
+    /**
+     * get/setParameter support for one of the WiredTigerCheckpointScheduler settings. Values
+     * must be non-negative integers.
+     */
+    class WiredTigerCheckpointSchedulerParameter : public ServerParameter {
+        MONGO_DISALLOW_COPYING(WiredTigerCheckpointSchedulerParameter);
+    public:
+        WiredTigerCheckpointSchedulerParameter(WiredTigerCheckpointScheduler* scheduler,
+                                               WiredTigerCheckpointScheduler::Setting setting);
+
+        virtual void append(OperationContext* txn, BSONObjBuilder& b,
+                            const std::string& name);
+        virtual Status set(const BSONElement& newValueElement);
+
+        virtual Status setFromString(const std::string& str);
+
+    private:
+        Status _set(long long value);
+
+        WiredTigerCheckpointScheduler* _scheduler;
+        const WiredTigerCheckpointScheduler::Setting _setting;
+    };
+
+    /**
+     * get/setParameter support for one of the WiredTigerTicketController settings. The enabled
+     * setting must be 0 or 1, and the others positive integers.
+     */
+    class WiredTigerTicketControllerParameter : public ServerParameter {
+        MONGO_DISALLOW_COPYING(WiredTigerTicketControllerParameter);
+    public:
+        WiredTigerTicketControllerParameter(WiredTigerTicketController* controller,
+                                            WiredTigerTicketController::Setting setting);
+
+        virtual void append(OperationContext* txn, BSONObjBuilder& b,
+                            const std::string& name);
+        virtual Status set(const BSONElement& newValueElement);
+
+        virtual Status setFromString(const std::string& str);
+
+    private:
+        Status _set(long long value);
+
+        WiredTigerTicketController* _controller;
+        const WiredTigerTicketController::Setting _setting;
+    };
 }
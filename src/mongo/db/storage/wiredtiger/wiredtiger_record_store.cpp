@@ -35,18 +35,25 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 
+#include <algorithm>
 #include <boost/shared_array.hpp>
+#include <cmath>
 #include <wiredtiger.h>
 
 #include "mongo/base/checked_cast.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/concurrency/locker.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
@@ -84,6 +91,14 @@ namespace {
         return (appMetadata.getValue().getIntField("oplogKeyExtractionVersion") == 1);
     }
 
+    // Whether capped collections created or opened from now on leave deleting their excess
+    // documents to a background thread. Those with a maximum number of documents never do.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCappedDeleteInBackground, bool, false);
+
+    // Whether RecordCursor::prefetch() reads the pages of the given records into the cache in
+    // RecordId order. This only pays off when those pages are mostly not in the cache already.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerPrefetchRecords, bool, false);
+
 } // namespace
 
     MONGO_FP_DECLARE(WTWriteConflictException);
@@ -134,7 +149,7 @@ namespace {
             WT_ITEM value;
             invariantWTOK(c->get_value(c, &value));
             auto data = RecordData(static_cast<const char*>(value.data), value.size);
-            data.makeOwned(); // TODO delete this line once safe.
+            if (!_shortLivedDataOk) data.makeOwned();
 
             _lastReturnedId = id;
             return {{id, std::move(data)}};
@@ -159,12 +174,35 @@ namespace {
             WT_ITEM value;
             invariantWTOK(c->get_value(c, &value));
             auto data = RecordData(static_cast<const char*>(value.data), value.size);
-            data.makeOwned(); // TODO delete this line once safe.
+            if (!_shortLivedDataOk) data.makeOwned();
 
             _lastReturnedId = id;
             return {{id, std::move(data)}};
         }
 
+        bool allowShortLivedData() final {
+            // The WT_ITEM is only valid until the WT_CURSOR is next used.
+            _shortLivedDataOk = true;
+            return true;
+        }
+
+        void prefetch(const std::vector<RecordId>& ids) final {
+            if (!wiredTigerPrefetchRecords) return;
+
+            // Searching for each record in key order reads the pages holding them into the cache
+            // before the caller's seekExact() calls, which come in whatever order it needs.
+            WT_CURSOR* c = _cursor->get();
+            for (const RecordId& id : ids) {
+                if (!isVisible(id)) continue;
+                c->set_key(c, _makeKey(id));
+                // Any error, e.g. a write conflict, just ends the hint. Fetching reports it.
+                int ret = c->search(c);
+                if (ret != 0 && ret != WT_NOTFOUND) break;
+            }
+            // Don't keep the last page pinned.
+            c->reset(c);
+        }
+
         void savePositioned() final {
             // It must be safe to call save() twice in a row without calling restore().
             if (!_txn) return;
@@ -172,7 +210,10 @@ namespace {
             // the cursor and recoveryUnit are valid on restore
             // so we just record the recoveryUnit to make sure
             _savedRecoveryUnit = _txn->recoveryUnit();
-            if ( _cursor && !wt_keeptxnopen() ) {
+            _savedSnapshotId = _savedRecoveryUnit->getSnapshotId();
+
+            // A pinned snapshot outlives this save, so keep our position in it.
+            if ( _cursor && !wt_keeptxnopen() && !_savedRecoveryUnit->isSnapshotPinned() ) {
                 try {
                     _cursor->reset();
                 }
@@ -213,6 +254,13 @@ namespace {
             if (!needRestore && wt_keeptxnopen()) return true;
             if (_lastReturnedId.isNull()) return true;
 
+            WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(txn);
+            if (!needRestore && ru->isPositionRetained(_savedSnapshotId)) {
+                invariant(ru->getSession(txn) == _cursor->getSession());
+                WiredTigerRecoveryUnit::noteReseekAvoided();
+                return true;
+            }
+
             // This will ensure an active session exists, so any restored cursors will bind to it
             invariant(WiredTigerRecoveryUnit::get(txn)->getSession(txn) == _cursor->getSession());
 
@@ -273,14 +321,439 @@ namespace {
         const WiredTigerRecordStore& _rs;
         OperationContext* _txn;
         RecoveryUnit* _savedRecoveryUnit; // only used to sanity check between save/restore.
+        SnapshotId _savedSnapshotId;
         const bool _forward;
         bool _forParallelCollectionScan; // This can go away once SERVER-17364 is resolved.
         std::unique_ptr<WiredTigerCursor> _cursor;
         bool _eof = false;
+        bool _shortLivedDataOk = false;
         RecordId _lastReturnedId;
         const RecordId _readUntilForOplog;
     };
 
+    /**
+     * Returns random records from a "next_random" WT_CURSOR, which descends the tree to a random
+     * leaf page every call to next(). Such cursors can't be cached in the session, so this opens
+     * its own and closes it across yields, where there is no position worth keeping anyway.
+     */
+    class WiredTigerRecordStore::RandomCursor final : public RecordCursor {
+    public:
+        RandomCursor(OperationContext* txn, const WiredTigerRecordStore& rs)
+            : _rs(rs)
+            , _txn(txn)
+        {}
+
+        ~RandomCursor() {
+            _close();
+        }
+
+        boost::optional<Record> next() final {
+            if (!_cursor) {
+                _open();
+            }
+
+            WT_CURSOR* c = _cursor;
+            {
+                // Nothing after the next line can throw WCEs.
+                int advanceRet = WT_OP_CHECK(c->next(c));
+                if (advanceRet == WT_NOTFOUND) {
+                    return {};
+                }
+                invariantWTOK(advanceRet);
+            }
+
+            int64_t key;
+            invariantWTOK(c->get_key(c, &key));
+            const RecordId id = _fromKey(key);
+
+            WT_ITEM value;
+            invariantWTOK(c->get_value(c, &value));
+            auto data = RecordData(static_cast<const char*>(value.data), value.size);
+            if (!_shortLivedDataOk) data.makeOwned();
+            return {{id, std::move(data)}};
+        }
+
+        boost::optional<Record> seekExact(const RecordId& id) final {
+            invariant(!"seekExact not supported");
+        }
+
+        bool allowShortLivedData() final {
+            // The WT_ITEM is only valid until the WT_CURSOR is next used.
+            _shortLivedDataOk = true;
+            return true;
+        }
+
+        void savePositioned() final {
+            // It must be safe to call save() twice in a row without calling restore().
+            _close();
+            _txn = nullptr;
+        }
+
+        bool restore(OperationContext* txn) final {
+            _txn = txn;
+            return true;
+        }
+
+    private:
+        void _open() {
+            // This will ensure an active session exists, which the cursor then belongs to.
+            WT_SESSION* session =
+                WiredTigerRecoveryUnit::get(_txn)->getSession(_txn)->getSession();
+            invariantWTOK(session->open_cursor(session,
+                                               _rs.getURI().c_str(),
+                                               NULL,
+                                               "next_random=true",
+                                               &_cursor));
+        }
+
+        void _close() {
+            if (_cursor) {
+                invariantWTOK(_cursor->close(_cursor));
+                _cursor = nullptr;
+            }
+        }
+
+        const WiredTigerRecordStore& _rs;
+        OperationContext* _txn;
+        WT_CURSOR* _cursor = nullptr;
+        bool _shortLivedDataOk = false;
+    };
+
+    class WiredTigerRecordStore::OplogStones::InsertChange final : public RecoveryUnit::Change {
+    public:
+        InsertChange(OplogStones* oplogStones,
+                     int64_t bytesInserted,
+                     RecordId highestInserted,
+                     int64_t countInserted)
+            : _oplogStones(oplogStones),
+              _bytesInserted(bytesInserted),
+              _highestInserted(highestInserted),
+              _countInserted(countInserted) { }
+
+        void commit() final {
+            invariant(_bytesInserted >= 0);
+            invariant(_highestInserted.isNormal());
+
+            _oplogStones->_currentRecords.addAndFetch(_countInserted);
+            int64_t newCurrentBytes = _oplogStones->_currentBytes.addAndFetch(_bytesInserted);
+            if (newCurrentBytes >= _oplogStones->_minBytesPerStone) {
+                _oplogStones->createNewStoneIfNeeded(_highestInserted);
+            }
+        }
+
+        void rollback() final { }
+
+    private:
+        OplogStones* _oplogStones;
+        int64_t _bytesInserted;
+        RecordId _highestInserted;
+        int64_t _countInserted;
+    };
+
+    class WiredTigerRecordStore::OplogStones::TruncateChange final : public RecoveryUnit::Change {
+    public:
+        TruncateChange(OplogStones* oplogStones) : _oplogStones(oplogStones) { }
+
+        void commit() final {
+            _oplogStones->_currentRecords.store(0);
+            _oplogStones->_currentBytes.store(0);
+
+            stdx::lock_guard<stdx::mutex> lk(_oplogStones->_mutex);
+            _oplogStones->_stones.clear();
+        }
+
+        void rollback() final { }
+
+    private:
+        OplogStones* _oplogStones;
+    };
+
+    WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* txn,
+                                                    WiredTigerRecordStore* rs)
+        : _rs(rs) {
+        invariant(rs->isCapped());
+        invariant(rs->cappedMaxSize() > 0);
+        const uint64_t maxSize = rs->cappedMaxSize();
+
+        // Keep between 10 and 100 stones, of at least 16MB each where the oplog is large enough,
+        // so that a truncation removes a sizeable chunk without overshooting the cap by much.
+        const uint64_t kMinStonesToKeep = 10;
+        const uint64_t kMaxStonesToKeep = 100;
+
+        const uint64_t numStones = maxSize / BSONObjMaxInternalSize;
+        _numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
+        _minBytesPerStone = maxSize / _numStonesToKeep;
+        invariant(_minBytesPerStone > 0);
+
+        _calculateStones(txn);
+        _pokeReclaimThreadIfNeeded();  // Reclaim stones if over the limit.
+    }
+
+    bool WiredTigerRecordStore::OplogStones::isDead() {
+        stdx::lock_guard<stdx::mutex> lk(_oplogReclaimMutex);
+        return _isDead;
+    }
+
+    void WiredTigerRecordStore::OplogStones::kill() {
+        stdx::lock_guard<stdx::mutex> lk(_oplogReclaimMutex);
+        _isDead = true;
+        _oplogReclaimCv.notify_one();
+    }
+
+    bool WiredTigerRecordStore::OplogStones::hasExcessStones() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _stones.size() > _numStonesToKeep;
+    }
+
+    void WiredTigerRecordStore::OplogStones::awaitHasExcessStonesOrDead() {
+        stdx::unique_lock<stdx::mutex> lk(_oplogReclaimMutex);
+        if (!_isDead && !hasExcessStones()) {
+            _oplogReclaimCv.wait_for(lk, Seconds(1));
+        }
+    }
+
+    boost::optional<WiredTigerRecordStore::OplogStones::Stone>
+    WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        if (_stones.size() <= _numStonesToKeep) {
+            return {};
+        }
+
+        return _stones.front();
+    }
+
+    void WiredTigerRecordStore::OplogStones::popOldestStone() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stones.pop_front();
+    }
+
+    void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRecord) {
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex, stdx::try_to_lock);
+            if (!lk) {
+                // Someone else is either already creating a new stone or popping the oldest one.
+                // In the latter case, we let the next insert trigger the new stone's creation.
+                return;
+            }
+
+            if (_currentBytes.load() < _minBytesPerStone) {
+                // Someone else created a new stone since our caller checked.
+                return;
+            }
+
+            LOG(2) << "create new oplogStone, current stones:" << _stones.size();
+
+            OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), lastRecord};
+            _stones.push_back(stone);
+        }
+
+        _pokeReclaimThreadIfNeeded();
+    }
+
+    void WiredTigerRecordStore::OplogStones::updateCurrentStoneAfterInsertOnCommit(
+            OperationContext* txn,
+            int64_t bytesInserted,
+            RecordId highestInserted,
+            int64_t countInserted) {
+        txn->recoveryUnit()->registerChange(
+            new InsertChange(this, bytesInserted, highestInserted, countInserted));
+    }
+
+    void WiredTigerRecordStore::OplogStones::clearStonesOnCommit(OperationContext* txn) {
+        txn->recoveryUnit()->registerChange(new TruncateChange(this));
+    }
+
+    void WiredTigerRecordStore::OplogStones::updateStonesAfterCappedTruncateAfter(
+            int64_t recordsRemoved,
+            int64_t bytesRemoved,
+            RecordId firstRemovedId) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        int64_t numStonesToRemove = 0;
+        int64_t recordsInStonesToRemove = 0;
+        int64_t bytesInStonesToRemove = 0;
+
+        // Compute the number and associated sizes of the records from stones that are either
+        // fully or partially truncated.
+        for (auto it = _stones.rbegin(); it != _stones.rend(); ++it) {
+            if (it->lastRecord < firstRemovedId) {
+                break;
+            }
+            numStonesToRemove++;
+            recordsInStonesToRemove += it->records;
+            bytesInStonesToRemove += it->bytes;
+        }
+
+        // Remove the stones corresponding to the records that were deleted.
+        _stones.resize(_stones.size() - numStonesToRemove);
+
+        // Account for any remaining records from a partially truncated stone in the stone
+        // currently being filled.
+        _currentRecords.addAndFetch(recordsInStonesToRemove - recordsRemoved);
+        _currentBytes.addAndFetch(bytesInStonesToRemove - bytesRemoved);
+    }
+
+    size_t WiredTigerRecordStore::OplogStones::numStones() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _stones.size();
+    }
+
+    void WiredTigerRecordStore::OplogStones::setMinBytesPerStone(int64_t size) {
+        invariant(size > 0);
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        // Only allow changing the minimum bytes per stone if no data has been inserted.
+        invariant(_stones.size() == 0 && _currentRecords.load() == 0);
+        _minBytesPerStone = size;
+    }
+
+    void WiredTigerRecordStore::OplogStones::setNumStonesToKeep(size_t numStones) {
+        invariant(numStones > 0);
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        // Only allow changing the number of stones to keep if no data has been inserted.
+        invariant(_stones.size() == 0 && _currentRecords.load() == 0);
+        _numStonesToKeep = numStones;
+    }
+
+    void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* txn) {
+        const long long numRecords = _rs->numRecords(txn);
+        const long long dataSize = _rs->dataSize(txn);
+
+        log() << "The size storer reports that the oplog contains " << numRecords
+              << " records totaling to " << dataSize << " bytes";
+
+        // Only use sampling to estimate where to place the oplog stones if the number of samples
+        // drawn is less than 5% of the collection.
+        const uint64_t kMinSampleRatioForRandCursor = 20;
+
+        // If the oplog doesn't contain enough records to make sampling more efficient, then scan
+        // the oplog to determine where to put down stones.
+        if (numRecords <= 0 || dataSize <= 0 ||
+            uint64_t(numRecords) <
+                kMinSampleRatioForRandCursor * kRandomSamplesPerStone * _numStonesToKeep) {
+            _calculateStonesByScanning(txn);
+            return;
+        }
+
+        // Use the oplog's average record size to estimate the number of records in each stone,
+        // and thus estimate the combined size of the records.
+        const double avgRecordSize = double(dataSize) / double(numRecords);
+        const double estRecordsPerStone = std::ceil(_minBytesPerStone / avgRecordSize);
+        const double estBytesPerStone = estRecordsPerStone * avgRecordSize;
+
+        if (!_calculateStonesBySampling(txn,
+                                        int64_t(estRecordsPerStone),
+                                        int64_t(estBytesPerStone))) {
+            _calculateStonesByScanning(txn);
+        }
+    }
+
+    void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationContext* txn) {
+        log() << "Scanning the oplog to determine where to place markers for truncation";
+
+        _stones.clear();
+        _currentRecords.store(0);
+        _currentBytes.store(0);
+
+        long long numRecords = 0;
+        long long dataSize = 0;
+
+        auto cursor = _rs->getCursor(txn, true);
+        while (auto record = cursor->next()) {
+            _currentRecords.addAndFetch(1);
+            int64_t newCurrentBytes = _currentBytes.addAndFetch(record->data.size());
+            if (newCurrentBytes >= _minBytesPerStone) {
+                LOG(1) << "Placing a marker at optime "
+                       << Timestamp(record->id.repr()).toStringPretty();
+
+                OplogStones::Stone stone = {
+                    _currentRecords.swap(0), _currentBytes.swap(0), record->id};
+                _stones.push_back(stone);
+            }
+
+            numRecords++;
+            dataSize += record->data.size();
+        }
+
+        // The scan gives exact counts, so correct whatever the size storer had.
+        _rs->_numRecords.store(numRecords);
+        _rs->_dataSize.store(dataSize);
+        if (_rs->_sizeStorer) {
+            _rs->_sizeStorer->storeToCache(_rs->_uri, numRecords, dataSize);
+        }
+    }
+
+    bool WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(
+            OperationContext* txn,
+            int64_t estRecordsPerStone,
+            int64_t estBytesPerStone) {
+        log() << "Sampling the oplog to determine where to place markers for truncation";
+
+        const long long numRecords = _rs->numRecords(txn);
+        const int64_t wholeStones = numRecords / estRecordsPerStone;
+        const uint64_t numSamples = kRandomSamplesPerStone * numRecords / estRecordsPerStone;
+
+        // A random cursor returns records in no particular order, and may return some more than
+        // once. Sorting enough of them gives a good estimate of where every stone ends.
+        WT_SESSION* session = WiredTigerRecoveryUnit::get(txn)->getSession(txn)->getSession();
+        WT_CURSOR* cursor;
+        invariantWTOK(session->open_cursor(session,
+                                           _rs->_uri.c_str(),
+                                           NULL,
+                                           "next_random=true",
+                                           &cursor));
+        ON_BLOCK_EXIT(cursor->close, cursor);
+
+        std::vector<RecordId> oplogEstimates;
+        oplogEstimates.reserve(numSamples);
+        for (uint64_t i = 0; i < numSamples; ++i) {
+            int ret = cursor->next(cursor);
+            if (ret == WT_NOTFOUND) {
+                // The oplog was emptied since its size was looked up.
+                return false;
+            }
+            invariantWTOK(ret);
+
+            int64_t key;
+            invariantWTOK(cursor->get_key(cursor, &key));
+            oplogEstimates.push_back(_fromKey(key));
+        }
+        std::sort(oplogEstimates.begin(), oplogEstimates.end());
+
+        for (int64_t i = 1; i <= wholeStones; ++i) {
+            // Use every (kRandomSamplesPerStone)th sample, starting with the
+            // (kRandomSamplesPerStone - 1)th, as the last record for each stone.
+            const size_t sampleIndex = kRandomSamplesPerStone * i - 1;
+            if (sampleIndex >= oplogEstimates.size()) {
+                break;
+            }
+            const RecordId lastRecord = oplogEstimates[sampleIndex];
+
+            LOG(1) << "Placing a marker at optime "
+                   << Timestamp(lastRecord.repr()).toStringPretty();
+
+            OplogStones::Stone stone = {estRecordsPerStone, estBytesPerStone, lastRecord};
+            _stones.push_back(stone);
+        }
+
+        // Account for the partially filled chunk.
+        const int64_t numStones = _stones.size();
+        _currentRecords.store(numRecords - estRecordsPerStone * numStones);
+        _currentBytes.store(_rs->dataSize(txn) - estBytesPerStone * numStones);
+        return true;
+    }
+
+    void WiredTigerRecordStore::OplogStones::_pokeReclaimThreadIfNeeded() {
+        if (hasExcessStones()) {
+            stdx::lock_guard<stdx::mutex> lk(_oplogReclaimMutex);
+            _oplogReclaimCv.notify_one();
+        }
+    }
+
     StatusWith<std::string> WiredTigerRecordStore::parseOptionsField(const BSONObj options) {
         StringBuilder ss;
         BSONForEach(elem, options) {
@@ -384,8 +857,8 @@ namespace {
               _cappedDeleteCheckCount(0),
               _useOplogHack(shouldUseOplogHack(ctx, _uri)),
               _sizeStorer( sizeStorer ),
-              _sizeStorerCounter(0),
-              _shuttingDown(false)
+              _shuttingDown(false),
+              _cappedDeleteRequested(false)
     {
         Status versionStatus = WiredTigerUtil::checkApplicationMetadataFormatVersion(
             ctx, uri, kMinimumRecordStoreVersion, kMaximumRecordStoreVersion);
@@ -445,6 +918,15 @@ namespace {
         }
 
         _hasBackgroundThread = WiredTigerKVEngine::initRsOplogBackgroundThread(ns);
+
+        // The oplog is truncated in whole stones by its background thread rather than having
+        // inserters delete the oldest documents one at a time.
+        if (_hasBackgroundThread && _isCapped) {
+            _oplogStones = std::make_shared<OplogStones>(ctx, this);
+        }
+
+        _cappedDeleteInBackground = _isCapped && !_hasBackgroundThread && _cappedMaxDocs == -1 &&
+                                    wiredTigerCappedDeleteInBackground;
     }
 
     WiredTigerRecordStore::~WiredTigerRecordStore() {
@@ -453,6 +935,10 @@ namespace {
             _shuttingDown = true;
         }
 
+        if (_oplogStones) {
+            _oplogStones->kill();
+        }
+
         LOG(1) << "~WiredTigerRecordStore for: " << ns();
         if ( _sizeStorer ) {
             _sizeStorer->onDestroy( this );
@@ -508,6 +994,15 @@ namespace {
         return size;
     }
 
+    int64_t WiredTigerRecordStore::freeStorageSize( OperationContext* txn ) const {
+        WiredTigerSession* session = WiredTigerRecoveryUnit::get(txn)->getSession(txn);
+        StatusWith<int64_t> result = WiredTigerUtil::getStatisticsValueAs<int64_t>(
+            session->getSession(),
+            "statistics:" + getURI(), "statistics=(size)", WT_STAT_DSRC_BLOCK_REUSE_BYTES);
+        uassertStatusOK(result.getStatus());
+        return result.getValue();
+    }
+
     // Retrieve the value from a positioned cursor.
     RecordData WiredTigerRecordStore::_getData(const WiredTigerCursor& cursor) const {
         WT_ITEM value;
@@ -618,6 +1113,19 @@ namespace {
             return 0;
         }
         else {
+            // Leave the deletes to the background capped deleter unless it fell so far behind
+            // that the lag has to be bounded by applying back-pressure, or deleting right here.
+            if (_cappedDeleteInBackground) {
+                if (!_cappedDeleteRequested.swap(true) &&
+                    !WiredTigerKVEngine::requestCappedDelete(ns())) {
+                    // There is no background capped deleter in this process after all.
+                    _cappedDeleteRequested.store(false);
+                }
+                else if ((_dataSize.load() - _cappedMaxSize) < (2 * _cappedMaxSizeSlack)) {
+                    return 0;
+                }
+            }
+
             if (!lock.try_lock()) {
                 // Someone else is deleting old records. Apply back-pressure if too far behind,
                 // otherwise continue.
@@ -643,6 +1151,18 @@ namespace {
         return cappedDeleteAsNeeded_inlock(txn, justInserted);
     }
 
+    void WiredTigerRecordStore::reclaimCappedSpace(OperationContext* txn) {
+        // Requests made from now on are for documents inserted after this.
+        _cappedDeleteRequested.store(false);
+
+        boost::lock_guard<boost::timed_mutex> lock(_cappedDeleterMutex);
+        while (!_shuttingDown && cappedAndNeedDelete()) {
+            if (cappedDeleteAsNeeded_inlock(txn, RecordId::max()) == 0) {
+                break;
+            }
+        }
+    }
+
     int64_t WiredTigerRecordStore::cappedDeleteAsNeeded_inlock(OperationContext* txn,
                                                                const RecordId& justInserted) {
         // we do this is a side transaction in case it aborts
@@ -756,6 +1276,69 @@ namespace {
         return oploghack::extractKey(data, len);
     }
 
+    bool WiredTigerRecordStore::yieldAndAwaitOplogDeletionRequest(OperationContext* txn) {
+        // Create another reference to the oplog stones while holding a lock on the collection to
+        // prevent it from being destructed.
+        std::shared_ptr<OplogStones> oplogStones = _oplogStones;
+
+        Locker* locker = txn->lockState();
+        Locker::LockSnapshot snapshot;
+
+        // Release any locks before waiting on the condition variable. It is illegal to access any
+        // methods or members of this record store after this line because it could be deleted.
+        bool releasedAnyLocks = locker->saveLockStateAndUnlock(&snapshot);
+        invariant(releasedAnyLocks);
+
+        // Don't keep a storage engine snapshot open while waiting.
+        txn->recoveryUnit()->abandonSnapshot();
+
+        oplogStones->awaitHasExcessStonesOrDead();
+
+        // Reacquire the locks that were released.
+        locker->restoreLockState(snapshot);
+
+        return !oplogStones->isDead();
+    }
+
+    void WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
+        while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
+            invariant(stone->lastRecord.isNormal());
+
+            LOG(1) << "Truncating the oplog up to " << stone->lastRecord
+                   << " to remove approximately " << stone->records
+                   << " records totaling to " << stone->bytes << " bytes";
+
+            WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(txn);
+            WT_SESSION* session = ru->getSession(txn)->getSession();
+
+            try {
+                WriteUnitOfWork wuow(txn);
+
+                WiredTigerCursor endwrap(_uri, _instanceId, true, txn);
+                WT_CURSOR* end = endwrap.get();
+                end->set_key(end, _makeKey(stone->lastRecord));
+
+                // Remove everything up to and including the last record of the oldest stone with
+                // a single range truncate. The oplog has no indexes, and capped cursors detect
+                // that their position was removed when they are restored.
+                invariantWTOK(session->truncate(session, NULL, NULL, end, NULL));
+                _changeNumRecords(txn, -stone->records);
+                _increaseDataSize(txn, -stone->bytes);
+
+                wuow.commit();
+
+                // Remove the stone after a successful truncation.
+                _oplogStones->popOldestStone();
+            }
+            catch (const WriteConflictException& wce) {
+                LOG(1) << "Caught WriteConflictException while truncating oplog entries, retrying";
+            }
+        }
+
+        LOG(1) << "Finished truncating the oplog, it now contains approximately "
+               << _numRecords.load() << " records totaling to " << _dataSize.load() << " bytes";
+    }
+
     StatusWith<RecordId> WiredTigerRecordStore::insertRecord( OperationContext* txn,
                                                               const char* data,
                                                               int len,
@@ -802,12 +1385,106 @@ namespace {
 
         _changeNumRecords( txn, 1 );
         _increaseDataSize( txn, len );
+        txn->recoveryUnit()->storageStats()->bytesWritten += len;
 
-        cappedDeleteAsNeeded(txn, loc);
+        if (_oplogStones) {
+            _oplogStones->updateCurrentStoneAfterInsertOnCommit(txn, len, loc, 1);
+        }
+        else {
+            cappedDeleteAsNeeded(txn, loc);
+        }
 
         return StatusWith<RecordId>( loc );
     }
 
+    /**
+     * Appends records to a newly created table through a WiredTiger bulk cursor. The cursor is
+     * opened on a session of its own, so that the inserts happen outside of any transaction.
+     */
+    class WiredTigerRecordStore::BulkLoader final : public RecordStoreBulkLoader {
+    public:
+        BulkLoader(WiredTigerRecordStore* rs,
+                   WiredTigerSessionCache* sessionCache,
+                   WiredTigerSession* session,
+                   WT_CURSOR* cursor)
+            : _rs(rs), _sessionCache(sessionCache), _session(session), _cursor(cursor) { }
+
+        ~BulkLoader() {
+            commit();
+        }
+
+        StatusWith<RecordId> addRecord(const char* data, int len) final {
+            invariant(_cursor);
+
+            const RecordId loc = _rs->_nextId();
+            _cursor->set_key(_cursor, _makeKey(loc));
+            WiredTigerItem value(data, len);
+            _cursor->set_value(_cursor, value.Get());
+            int ret = WT_OP_CHECK(_cursor->insert(_cursor));
+            if (ret) {
+                return StatusWith<RecordId>(
+                    wtRCToStatus(ret, "WiredTigerRecordStore::BulkLoader::addRecord"));
+            }
+
+            // The records are on disk whether or not the caller's unit of work commits.
+            _rs->_changeNumRecords(NULL, 1);
+            _rs->_increaseDataSize(NULL, len);
+
+            return StatusWith<RecordId>(loc);
+        }
+
+        void commit() final {
+            if (!_cursor) {
+                return;
+            }
+
+            // Closing a bulk cursor is what makes the loaded records visible.
+            invariantWTOK(_cursor->close(_cursor));
+            _cursor = NULL;
+            _sessionCache->releaseSession(_session);
+
+            if (_rs->_sizeStorer) {
+                _rs->_sizeStorer->storeToCache(_rs->_uri,
+                                               _rs->_numRecords.load(),
+                                               _rs->_dataSize.load());
+            }
+        }
+
+    private:
+        WiredTigerRecordStore* const _rs;
+        WiredTigerSessionCache* const _sessionCache;
+        WiredTigerSession* const _session;
+        WT_CURSOR* _cursor;
+    };
+
+    std::unique_ptr<RecordStoreBulkLoader> WiredTigerRecordStore::makeBulkLoader(
+            OperationContext* txn) {
+        // Bulk cursors only work on newly created tables. Capped collections and the oplog need
+        // every insert to go through insertRecord().
+        if (_isCapped || _useOplogHack || numRecords(txn) != 0) {
+            return {};
+        }
+
+        // Open cursors can cause bulk open_cursor to fail with EBUSY.
+        WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(txn);
+        ru->getSession(txn)->closeAllCursors();
+
+        // Not using the cursor cache since we need to set "bulk".
+        WiredTigerSessionCache* sessionCache = ru->getSessionCache();
+        WiredTigerSession* session = sessionCache->getSession();
+        WT_SESSION* s = session->getSession();
+        WT_CURSOR* cursor;
+        int ret = s->open_cursor(s, _uri.c_str(), NULL, "bulk", &cursor);
+        if (ret) {
+            LOG(1) << "not bulk loading " << ns() << ", failed to open a WiredTiger bulk cursor: "
+                   << wiredtiger_strerror(ret);
+            sessionCache->releaseSession(session);
+            return {};
+        }
+
+        return stdx::make_unique<BulkLoader>(this, sessionCache, session, cursor);
+    }
+
     void WiredTigerRecordStore::dealtWithCappedLoc( const RecordId& loc ) {
         boost::lock_guard<boost::mutex> lk( _uncommittedDiskLocsMutex );
         SortedDiskLocs::iterator it = std::find(_uncommittedDiskLocs.begin(),
@@ -817,6 +1494,17 @@ namespace {
         _uncommittedDiskLocs.erase(it);
     }
 
+    void WiredTigerRecordStore::_dealtWithCappedLocs(const std::vector<RecordId>& locs) {
+        boost::lock_guard<boost::mutex> lk(_uncommittedDiskLocsMutex);
+        for (const RecordId& loc : locs) {
+            SortedDiskLocs::iterator it = std::find(_uncommittedDiskLocs.begin(),
+                                                    _uncommittedDiskLocs.end(),
+                                                    loc);
+            invariant(it != _uncommittedDiskLocs.end());
+            _uncommittedDiskLocs.erase(it);
+        }
+    }
+
     bool WiredTigerRecordStore::isCappedHidden( const RecordId& loc ) const {
         boost::lock_guard<boost::mutex> lk( _uncommittedDiskLocsMutex );
         if (_uncommittedDiskLocs.empty()) {
@@ -836,6 +1524,58 @@ namespace {
         return insertRecord( txn, buf.get(), len, enforceQuota );
     }
 
+    bool WiredTigerRecordStore::supportsInsertWithId() const {
+        return !_isCapped;
+    }
+
+    Status WiredTigerRecordStore::insertRecordWithId(OperationContext* txn,
+                                                     const RecordId& id,
+                                                     const char* data,
+                                                     int len,
+                                                     bool enforceQuota) {
+        invariant(supportsInsertWithId());
+        invariant(id.isNormal());
+
+        WiredTigerCursor curwrap( _uri, _instanceId, true, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+        invariant( c );
+
+        // Record store cursors overwrite, so look for the record first. Concurrent inserts of the
+        // same id conflict when the second one writes.
+        c->set_key(c, _makeKey(id));
+        int ret = WT_OP_CHECK(c->search(c));
+        if (ret == 0) {
+            return Status(ErrorCodes::DuplicateKey, "there is a record with this id already");
+        }
+        if (ret != WT_NOTFOUND) {
+            return wtRCToStatus(ret, "WiredTigerRecordStore::insertRecordWithId");
+        }
+
+        c->set_key(c, _makeKey(id));
+        WiredTigerItem value(data, len);
+        c->set_value(c, value.Get());
+        ret = WT_OP_CHECK(c->insert(c));
+        if (ret) {
+            return wtRCToStatus(ret, "WiredTigerRecordStore::insertRecordWithId");
+        }
+
+        // Records inserted with insertRecord() must not land on this one.
+        long long next = _nextIdNum.load();
+        while (next <= id.repr()) {
+            const long long seen = _nextIdNum.compareAndSwap(next, id.repr() + 1);
+            if (seen == next) {
+                break;
+            }
+            next = seen;
+        }
+
+        _changeNumRecords( txn, 1 );
+        _increaseDataSize( txn, len );
+        txn->recoveryUnit()->storageStats()->bytesWritten += len;
+        return Status::OK();
+    }
+
     StatusWith<RecordId> WiredTigerRecordStore::updateRecord( OperationContext* txn,
                                                               const RecordId& loc,
                                                               const char* data,
@@ -863,22 +1603,51 @@ namespace {
         invariantWTOK(ret);
 
         _increaseDataSize(txn, len - old_length);
+        txn->recoveryUnit()->storageStats()->bytesWritten += len;
 
-        cappedDeleteAsNeeded(txn, loc);
+        if (!_oplogStones) {
+            cappedDeleteAsNeeded(txn, loc);
+        }
 
         return StatusWith<RecordId>( loc );
     }
 
     bool WiredTigerRecordStore::updateWithDamagesSupported() const {
-        return false;
+        return true;
     }
 
-    Status WiredTigerRecordStore::updateWithDamages( OperationContext* txn,
-                                                     const RecordId& loc,
-                                                     const RecordData& oldRec,
-                                                     const char* damageSource,
-                                                     const mutablebson::DamageVector& damages ) {
-        invariant(false);
+    StatusWith<RecordData> WiredTigerRecordStore::updateWithDamages(
+            OperationContext* txn,
+            const RecordId& loc,
+            const RecordData& oldRec,
+            const char* damageSource,
+            const mutablebson::DamageVector& damages ) {
+        // WiredTiger values can't be modified where they live, so apply the damages to a copy of
+        // the record as of this snapshot and write that back. Any concurrent change to the record
+        // makes the write below conflict.
+        const int len = mutablebson::sizeAfterDamages(oldRec.size(), damages);
+        SharedBuffer data = SharedBuffer::allocate(len);
+        mutablebson::applyDamages(oldRec.data(), oldRec.size(), damageSource, damages, data.get());
+
+        WiredTigerCursor curwrap( _uri, _instanceId, true, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+        invariant( c );
+        c->set_key(c, _makeKey(loc));
+        WiredTigerItem value(data.get(), len);
+        c->set_value(c, value.Get());
+        int ret = WT_OP_CHECK(c->insert(c));
+        if (ret) {
+            return StatusWith<RecordData>(
+                wtRCToStatus(ret, "WiredTigerRecordStore::updateWithDamages"));
+        }
+
+        if (len != oldRec.size()) {
+            _increaseDataSize(txn, len - oldRec.size());
+        }
+        txn->recoveryUnit()->storageStats()->bytesWritten += len;
+
+        return StatusWith<RecordData>(RecordData(std::move(data), len));
     }
 
     void WiredTigerRecordStore::_oplogSetStartHack( WiredTigerRecoveryUnit* wru ) const {
@@ -913,6 +1682,15 @@ namespace {
         return cursors;
     }
 
+    std::unique_ptr<RecordCursor> WiredTigerRecordStore::getRandomCursor(
+            OperationContext* txn) const {
+        // Capped collections hide their uncommitted records, which a random cursor can't skip.
+        if (_isCapped) {
+            return {};
+        }
+        return stdx::make_unique<RandomCursor>(txn, *this);
+    }
+
     Status WiredTigerRecordStore::truncate( OperationContext* txn ) {
         WiredTigerCursor startWrap( _uri, _instanceId, true, txn);
         WT_CURSOR* start = startWrap.get();
@@ -928,6 +1706,10 @@ namespace {
         _changeNumRecords(txn, -numRecords(txn));
         _increaseDataSize(txn, -dataSize(txn));
 
+        if (_oplogStones) {
+            _oplogStones->clearStonesOnCommit(txn);
+        }
+
         return Status::OK();
     }
 
@@ -938,9 +1720,60 @@ namespace {
         WiredTigerSessionCache* cache = WiredTigerRecoveryUnit::get(txn)->getSessionCache();
         WiredTigerSession* session = cache->getSession();
         WT_SESSION *s = session->getSession();
-        int ret = s->compact(s, getURI().c_str(), "timeout=0");
-        invariantWTOK(ret);
+        const int64_t sizeBefore = storageSize(txn);
+
+        // WiredTiger compacts a file a slice at a time and checks its timeout, in seconds, in
+        // between, giving up with ETIMEDOUT. It can also be EBUSY with a checkpoint underway.
+        const std::string config = options->online && options->timeSliceSecs > 0 ?
+            std::string(str::stream() << "timeout=" << options->timeSliceSecs) :
+            std::string("timeout=0");
+        int ret = s->compact(s, getURI().c_str(), config.c_str());
+        if (options->online && (ret == ETIMEDOUT || ret == EBUSY)) {
+            stats->finished = false;
+        }
+        else {
+            invariantWTOK(ret);
+        }
         cache->releaseSession(session);
+
+        stats->bytesFreed = std::max(sizeBefore - storageSize(txn), int64_t(0));
+        return Status::OK();
+    }
+
+    Status WiredTigerRecordStore::touch( OperationContext* txn, BSONObjBuilder* output ) const {
+        WiredTigerTouchThrottle throttle(txn);
+        WiredTigerCursor cursor( _uri, _instanceId, true, txn );
+        WT_CURSOR* c = cursor.get();
+
+        int ret;
+        while ((ret = WT_OP_CHECK(c->next(c))) == 0) {
+            WT_ITEM value;
+            invariantWTOK(c->get_value(c, &value));
+            if (!throttle.hit(value.size)) {
+                continue;
+            }
+
+            int64_t key;
+            invariantWTOK(c->get_key(c, &key));
+            throttle.pause();
+
+            // Lands on the record or, if it went away, a neighbour of it.
+            c->set_key(c, key);
+            int cmp;
+            ret = WT_OP_CHECK(c->search_near(c, &cmp));
+            if (ret != 0) {
+                break;
+            }
+        }
+        if (ret != WT_NOTFOUND) {
+            return wtRCToStatus(ret);
+        }
+
+        if (output) {
+            output->appendNumber("numRecords", throttle.numEntries());
+            output->appendNumber("bytes", throttle.numBytes());
+            output->append("millis", static_cast<int>(throttle.millis()));
+        }
         return Status::OK();
     }
 
@@ -1064,6 +1897,12 @@ namespace {
             bob.append("reason", status.reason());
         }
 
+        StatusWith<WiredTigerUtil::CacheResidency> residency =
+            WiredTigerUtil::getCacheResidency(s, getURI());
+        if (residency.isOK()) {
+            BSONObjBuilder residencyBuilder(bob.subobjStart("cacheResidency"));
+            residency.getValue().appendTo(&residencyBuilder, scale);
+        }
     }
 
     Status WiredTigerRecordStore::oplogDiskLocRegister( OperationContext* txn,
@@ -1080,20 +1919,24 @@ namespace {
     class WiredTigerRecordStore::CappedInsertChange : public RecoveryUnit::Change {
     public:
         CappedInsertChange( WiredTigerRecordStore* rs, const RecordId& loc )
-            : _rs( rs ), _loc( loc ) {
+            : _rs( rs ), _locs( 1, loc ) {
+        }
+
+        CappedInsertChange(WiredTigerRecordStore* rs, std::vector<RecordId> locs)
+            : _rs(rs), _locs(std::move(locs)) {
         }
 
         virtual void commit() {
-            _rs->dealtWithCappedLoc( _loc );
+            _rs->_dealtWithCappedLocs( _locs );
         }
 
         virtual void rollback() {
-            _rs->dealtWithCappedLoc( _loc );
+            _rs->_dealtWithCappedLocs( _locs );
         }
 
     private:
         WiredTigerRecordStore* _rs;
-        RecordId _loc;
+        std::vector<RecordId> _locs;
     };
 
     void WiredTigerRecordStore::_addUncommitedDiskLoc_inlock( OperationContext* txn,
@@ -1106,6 +1949,73 @@ namespace {
         _oplog_highestSeen = loc;
     }
 
+    Status WiredTigerRecordStore::insertRecords(OperationContext* txn,
+                                                std::vector<Record>* records,
+                                                bool enforceQuota) {
+        // Oplog entries come with their own ids, and are truncated in stones.
+        if (_useOplogHack || _oplogStones || records->empty())
+            return RecordStore::insertRecords(txn, records, enforceQuota);
+
+        for (const Record& record : *records) {
+            if (_isCapped && record.data.size() > _cappedMaxSize) {
+                return Status(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+            }
+        }
+
+        // The ids of a capped collection only become visible once the unit of work commits, so
+        // take them all at once and have them released together.
+        if (_isCapped) {
+            std::vector<RecordId> locs;
+            locs.reserve(records->size());
+            boost::lock_guard<boost::mutex> lk(_uncommittedDiskLocsMutex);
+            for (Record& record : *records) {
+                record.id = _nextId();
+                invariant(_uncommittedDiskLocs.empty() ||
+                          _uncommittedDiskLocs.back() < record.id);
+                _uncommittedDiskLocs.push_back(record.id);
+                locs.push_back(record.id);
+            }
+            _oplog_highestSeen = locs.back();
+            txn->recoveryUnit()->registerChange(new CappedInsertChange(this, std::move(locs)));
+        }
+        else {
+            for (Record& record : *records) {
+                record.id = _nextId();
+            }
+        }
+
+        WiredTigerCursor curwrap( _uri, _instanceId, true, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+        invariant( c );
+
+        Status status = Status::OK();
+        int64_t numInserted = 0;
+        int64_t sizeInserted = 0;
+        for (const Record& record : *records) {
+            c->set_key(c, _makeKey(record.id));
+            WiredTigerItem value(record.data.data(), record.data.size());
+            c->set_value(c, value.Get());
+            int ret = WT_OP_CHECK(c->insert(c));
+            if (ret) {
+                status = wtRCToStatus(ret, "WiredTigerRecordStore::insertRecords");
+                break;
+            }
+            ++numInserted;
+            sizeInserted += record.data.size();
+        }
+
+        _changeNumRecords(txn, numInserted);
+        _increaseDataSize(txn, sizeInserted);
+        txn->recoveryUnit()->storageStats()->bytesWritten += sizeInserted;
+        if (!status.isOK())
+            return status;
+
+        // Capped deletes stop short of the first record of the batch.
+        cappedDeleteAsNeeded(txn, records->front().id);
+        return Status::OK();
+    }
+
     boost::optional<RecordId> WiredTigerRecordStore::oplogStartHack(
             OperationContext* txn,
             const RecordId& startingPosition) const {
@@ -1167,7 +2077,8 @@ namespace {
     };
 
     void WiredTigerRecordStore::_changeNumRecords( OperationContext* txn, int64_t diff ) {
-        txn->recoveryUnit()->registerChange(new NumRecordsChange(this, diff));
+        if ( txn )
+            txn->recoveryUnit()->registerChange(new NumRecordsChange(this, diff));
         if ( diff > 0 ) {
             if ( _numRecords.fetchAndAdd( diff ) < diff )
                     _numRecords.store( diff );
@@ -1201,10 +2112,6 @@ namespace {
                 _dataSize.store( 0 );
             }
         }
-
-        if ( _sizeStorer && _sizeStorerCounter++ % 1000 == 0 ) {
-            _sizeStorer->storeToCache( _uri, _numRecords.load(), _dataSize.load() );
-        }
     }
 
     int64_t WiredTigerRecordStore::_makeKey( const RecordId& loc ) {
@@ -1219,12 +2126,27 @@ namespace {
                                                           bool inclusive ) {
         WriteUnitOfWork wuow(txn);
         Cursor cursor(txn, *this);
+
+        int64_t recordsRemoved = 0;
+        int64_t bytesRemoved = 0;
+        RecordId firstRemovedId;
+
         while (auto record = cursor.next()) {
             RecordId loc = record->id;
             if ( end < loc || ( inclusive && end == loc ) ) {
+                if (!firstRemovedId.isNormal()) {
+                    firstRemovedId = loc;
+                }
+                recordsRemoved++;
+                bytesRemoved += record->data.size();
                 deleteRecord( txn, loc );
             }
         }
         wuow.commit();
+
+        if (_oplogStones && recordsRemoved > 0) {
+            _oplogStones->updateStonesAfterCappedTruncateAfter(
+                    recordsRemoved, bytesRemoved, firstRemovedId);
+        }
     }
 }
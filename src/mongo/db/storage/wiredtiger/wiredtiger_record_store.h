@@ -31,6 +31,7 @@
 
 #pragma once
 
+#include <memory>
 #include <set>
 #include <string>
 
@@ -59,6 +60,7 @@ namespace mongo {
 
     class WiredTigerRecordStore : public RecordStore {
     public:
+        class OplogStones;
 
         /**
          * During record store creation, if size storer reports a record count under
@@ -130,6 +132,20 @@ namespace mongo {
                                                   const DocWriter* doc,
                                                   bool enforceQuota );
 
+        Status insertRecords(OperationContext* txn,
+                             std::vector<Record>* records,
+                             bool enforceQuota) final;
+
+        bool supportsInsertWithId() const final;
+
+        Status insertRecordWithId(OperationContext* txn,
+                                  const RecordId& id,
+                                  const char* data,
+                                  int len,
+                                  bool enforceQuota) final;
+
+        std::unique_ptr<RecordStoreBulkLoader> makeBulkLoader(OperationContext* txn) final;
+
         virtual StatusWith<RecordId> updateRecord( OperationContext* txn,
                                                   const RecordId& oldLocation,
                                                   const char* data,
@@ -139,26 +155,33 @@ namespace mongo {
 
         virtual bool updateWithDamagesSupported() const;
 
-        virtual Status updateWithDamages( OperationContext* txn,
-                                          const RecordId& loc,
-                                          const RecordData& oldRec,
-                                          const char* damageSource,
-                                          const mutablebson::DamageVector& damages );
+        virtual StatusWith<RecordData> updateWithDamages(
+                OperationContext* txn,
+                const RecordId& loc,
+                const RecordData& oldRec,
+                const char* damageSource,
+                const mutablebson::DamageVector& damages );
 
         std::unique_ptr<RecordCursor> getCursor(OperationContext* txn, bool forward) const final;
         std::vector<std::unique_ptr<RecordCursor>> getManyCursors(
             OperationContext* txn) const final;
+        std::unique_ptr<RecordCursor> getRandomCursor(OperationContext* txn) const final;
 
         virtual Status truncate( OperationContext* txn );
 
         virtual bool compactSupported() const { return true; }
         virtual bool compactsInPlace() const { return true; }
+        virtual bool compactsOnline() const { return true; }
+
+        virtual int64_t freeStorageSize( OperationContext* txn ) const;
 
         virtual Status compact( OperationContext* txn,
                                 RecordStoreCompactAdaptor* adaptor,
                                 const CompactOptions* options,
                                 CompactStats* stats );
 
+        virtual Status touch( OperationContext* txn, BSONObjBuilder* output ) const;
+
         virtual Status validate( OperationContext* txn,
                                  bool full,
                                  bool scanData,
@@ -210,12 +233,35 @@ namespace mongo {
 
         boost::timed_mutex& cappedDeleterMutex() { return _cappedDeleterMutex; }
 
+        /**
+         * Deletes the oldest documents until the collection is back within its limits. Only
+         * called by the background capped deleter, see cappedDeleteAsNeeded().
+         */
+        void reclaimCappedSpace(OperationContext* txn);
+
+        /**
+         * Releases the oplog's locks and waits until there are oplog stones to reclaim. Returns
+         * false if the record store was destroyed while waiting, in which case it must not be used
+         * again. Only called by the oplog's background thread.
+         */
+        bool yieldAndAwaitOplogDeletionRequest(OperationContext* txn);
+
+        /**
+         * Truncates the oldest oplog stones until no more than the number to keep are left.
+         */
+        void reclaimOplog(OperationContext* txn);
+
+        // Non-NULL only for the oplog. Exposed for testing.
+        OplogStones* oplogStones() { return _oplogStones.get(); }
+
     private:
         class Cursor;
+        class RandomCursor;
 
         class CappedInsertChange;
         class NumRecordsChange;
         class DataSizeChange;
+        class BulkLoader;
 
         static WiredTigerRecoveryUnit* _getRecoveryUnit( OperationContext* txn );
 
@@ -223,6 +269,7 @@ namespace mongo {
         static RecordId _fromKey(int64_t k);
 
         void _addUncommitedDiskLoc_inlock( OperationContext* txn, const RecordId& loc );
+        void _dealtWithCappedLocs(const std::vector<RecordId>& locs);
 
         RecordId _nextId();
         void _setId(RecordId loc);
@@ -261,10 +308,18 @@ namespace mongo {
         AtomicInt64 _numRecords;
 
         WiredTigerSizeStorer* _sizeStorer; // not owned, can be NULL
-        int _sizeStorerCounter;
 
         bool _shuttingDown;
         bool _hasBackgroundThread;
+
+        // Whether excess documents are deleted by the background capped deleter rather than by
+        // the inserters, and whether it was already asked to since it last ran.
+        bool _cappedDeleteInBackground;
+        AtomicWord<bool> _cappedDeleteRequested;
+
+        // Shared with the background thread, which must be able to tell that the record store was
+        // destroyed while it waited without holding any locks.
+        std::shared_ptr<OplogStones> _oplogStones;
     };
 
     // WT failpoint to throw write conflict exceptions randomly
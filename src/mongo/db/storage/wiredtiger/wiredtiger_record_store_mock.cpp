@@ -32,6 +32,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/init.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
@@ -41,6 +42,11 @@ namespace mongo {
 
     // static
     bool WiredTigerKVEngine::initRsOplogBackgroundThread(StringData ns) {
+        return NamespaceString::oplog(ns);
+    }
+
+    // static
+    bool WiredTigerKVEngine::requestCappedDelete(StringData ns) {
         return false;
     }
 
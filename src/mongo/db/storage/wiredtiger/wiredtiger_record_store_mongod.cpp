@@ -31,6 +31,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
 #include <set>
 
@@ -69,12 +70,16 @@ namespace mongo {
             }
 
             /**
-             * @return Number of documents deleted.
+             * Waits for the oplog to accumulate more stones than it keeps and then truncates the
+             * excess ones.
+             *
+             * @return false if the oplog went away or could not be found, in which case the caller
+             * should back off before trying again.
              */
-            int64_t _deleteExcessDocuments() {
+            bool _deleteExcessDocuments() {
                 if (!getGlobalServiceContext()->getGlobalStorageEngine()) {
                     LOG(1) << "no global storage engine yet";
-                    return 0;
+                    return false;
                 }
 
                 OperationContextImpl txn;
@@ -87,24 +92,28 @@ namespace mongo {
                     Database* db = autoDb.getDb();
                     if (!db) {
                         LOG(2) << "no local database yet";
-                        return 0;
+                        return false;
                     }
 
                     Lock::CollectionLock collectionLock(txn.lockState(), _ns.ns(), MODE_IX);
                     Collection* collection = db->getCollection(_ns);
                     if (!collection) {
                         LOG(2) << "no collection " << _ns;
-                        return 0;
+                        return false;
                     }
 
                     OldClientContext ctx(&txn, _ns, false);
                     WiredTigerRecordStore* rs =
                         checked_cast<WiredTigerRecordStore*>(collection->getRecordStore());
-                    WriteUnitOfWork wuow(&txn);
-                    boost::lock_guard<boost::timed_mutex> lock(rs->cappedDeleterMutex());
-                    int64_t removed = rs->cappedDeleteAsNeeded_inlock(&txn, RecordId::max());
-                    wuow.commit();
-                    return removed;
+                    if (!rs->oplogStones()) {
+                        LOG(2) << "no oplog stones for " << _ns;
+                        return false;
+                    }
+
+                    if (!rs->yieldAndAwaitOplogDeletionRequest(&txn)) {
+                        return false;  // The oplog went away.
+                    }
+                    rs->reclaimOplog(&txn);
                 }
                 catch (const std::exception& e) {
                     severe() << "error in WiredTigerRecordStoreThread: " << e.what();
@@ -113,24 +122,18 @@ namespace mongo {
                 catch (...) {
                     fassertFailedNoTrace(!"unknown error in WiredTigerRecordStoreThread");
                 }
+
+                return true;
             }
 
             virtual void run() {
                 Client::initThread(_name.c_str());
 
                 while (!inShutdown()) {
-                    int64_t removed = _deleteExcessDocuments();
-                    LOG(2) << "WiredTigerRecordStoreThread deleted " << removed;
-                    if (removed == 0) {
-                        // If we removed 0 documents, sleep a bit in case we're on a laptop
-                        // or something to be nice.
+                    if (!_deleteExcessDocuments()) {
+                        // Back off in case the oplog doesn't exist yet or went away.
                         sleepmillis(1000);
                     }
-                    else if(removed < 1000) {
-                        // 1000 is the batch size, so we didn't even do a full batch,
-                        // which is the most efficient.
-                        sleepmillis(10);
-                    }
                 }
 
                 log() << "shutting down";
@@ -141,6 +144,81 @@ namespace mongo {
             std::string _name;
         };
 
+        bool _cappedDeleterStarted = false;
+        std::set<NamespaceString> _cappedDeleteRequests;
+        boost::mutex _cappedDeleteRequestsMutex;
+        boost::condition_variable _cappedDeleteRequestsNotifier;
+
+        /**
+         * Deletes the excess documents of the capped collections which have their inserters
+         * leave that to the background, one collection at a time.
+         */
+        class WiredTigerCappedDeleterThread : public BackgroundJob {
+        public:
+            WiredTigerCappedDeleterThread() : BackgroundJob(true /* deleteSelf */) { }
+
+            virtual std::string name() const {
+                return "WiredTigerCappedDeleter";
+            }
+
+            void _deleteExcessDocuments(const NamespaceString& ns) {
+                OperationContextImpl txn;
+                checked_cast<WiredTigerRecoveryUnit*>(txn.recoveryUnit())->markNoTicketRequired();
+
+                try {
+                    ScopedTransaction transaction(&txn, MODE_IX);
+
+                    AutoGetDb autoDb(&txn, ns.db(), MODE_IX);
+                    Database* db = autoDb.getDb();
+                    if (!db) {
+                        return;
+                    }
+
+                    Lock::CollectionLock collectionLock(txn.lockState(), ns.ns(), MODE_IX);
+                    Collection* collection = db->getCollection(ns);
+                    if (!collection) {
+                        // Dropped since, or not yet visible to others when it was requested.
+                        LOG(2) << "no collection " << ns;
+                        return;
+                    }
+
+                    OldClientContext ctx(&txn, ns, false);
+                    WiredTigerRecordStore* rs =
+                        checked_cast<WiredTigerRecordStore*>(collection->getRecordStore());
+                    rs->reclaimCappedSpace(&txn);
+                }
+                catch (const std::exception& e) {
+                    severe() << "error in WiredTigerCappedDeleter: " << e.what();
+                    fassertFailedNoTrace(!"error in WiredTigerCappedDeleter");
+                }
+                catch (...) {
+                    fassertFailedNoTrace(!"unknown error in WiredTigerCappedDeleter");
+                }
+            }
+
+            virtual void run() {
+                Client::initThread(name().c_str());
+
+                while (!inShutdown()) {
+                    NamespaceString ns;
+                    {
+                        boost::unique_lock<boost::mutex> lock(_cappedDeleteRequestsMutex);
+                        if (_cappedDeleteRequests.empty()) {
+                            // Wake up now and then to notice shutdown.
+                            _cappedDeleteRequestsNotifier.timed_wait(
+                                lock, boost::posix_time::seconds(1));
+                            continue;
+                        }
+                        ns = *_cappedDeleteRequests.begin();
+                        _cappedDeleteRequests.erase(_cappedDeleteRequests.begin());
+                    }
+                    _deleteExcessDocuments(ns);
+                }
+
+                log() << "shutting down";
+            }
+        };
+
     }  // namespace
 
     // static
@@ -169,4 +247,18 @@ namespace mongo {
         return true;
     }
 
+    // static
+    bool WiredTigerKVEngine::requestCappedDelete(StringData ns) {
+        boost::lock_guard<boost::mutex> lock(_cappedDeleteRequestsMutex);
+        if (!_cappedDeleterStarted) {
+            log() << "Starting WiredTigerCappedDeleter";
+            BackgroundJob* backgroundThread = new WiredTigerCappedDeleterThread();
+            backgroundThread->go();
+            _cappedDeleterStarted = true;
+        }
+        _cappedDeleteRequests.insert(NamespaceString(ns));
+        _cappedDeleteRequestsNotifier.notify_one();
+        return true;
+    }
+
 }  // namespace mongo
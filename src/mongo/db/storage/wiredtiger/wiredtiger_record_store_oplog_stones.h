@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <deque>
+
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+    class OperationContext;
+
+    /**
+     * Tracks the RecordId space of the oplog in coarse, size-bounded "stones", so that space can
+     * be reclaimed by truncating whole stones at once instead of deleting the oldest documents
+     * one at a time.
+     *
+     * Inserts accumulate into the stone currently being filled. Once it holds at least
+     * _minBytesPerStone bytes it is closed off, remembering the last RecordId it covers, and a new
+     * one is started. When more than _numStonesToKeep stones exist, the oplog's background thread
+     * truncates everything up to the end of the oldest stone with a single range truncate.
+     *
+     * Stones are only kept in memory. On startup they are rebuilt by scanning the oplog, or, for
+     * large oplogs, estimated by sampling it with a random cursor.
+     */
+    class WiredTigerRecordStore::OplogStones {
+    public:
+        struct Stone {
+            int64_t records;        // Approximate number of records in a chunk of the oplog.
+            int64_t bytes;          // Approximate size of records in a chunk of the oplog.
+            RecordId lastRecord;    // RecordId of the last record in a chunk of the oplog.
+        };
+
+        OplogStones(OperationContext* txn, WiredTigerRecordStore* rs);
+
+        bool isDead();
+
+        /**
+         * Marks the oplog as gone, e.g. because the "local" database was repaired, and wakes up
+         * the background thread so it stops waiting on it.
+         */
+        void kill();
+
+        bool hasExcessStones() const;
+
+        /**
+         * Waits until there are stones to reclaim, kill() was called, or a second has passed, so
+         * that the caller can check for shutdown.
+         */
+        void awaitHasExcessStonesOrDead();
+
+        /**
+         * Returns the oldest stone if there are more than _numStonesToKeep of them.
+         */
+        boost::optional<OplogStones::Stone> peekOldestStoneIfNeeded() const;
+
+        void popOldestStone();
+
+        /**
+         * Closes off the stone being filled at "lastRecord", if it has grown large enough.
+         */
+        void createNewStoneIfNeeded(RecordId lastRecord);
+
+        /**
+         * Adds the inserted records to the stone being filled once the unit of work commits.
+         */
+        void updateCurrentStoneAfterInsertOnCommit(OperationContext* txn,
+                                                   int64_t bytesInserted,
+                                                   RecordId highestInserted,
+                                                   int64_t countInserted);
+
+        /**
+         * Forgets all stones once the unit of work truncating the oplog commits.
+         */
+        void clearStonesOnCommit(OperationContext* txn);
+
+        /**
+         * Drops the stones covering records removed by rolling back the end of the oplog.
+         */
+        void updateStonesAfterCappedTruncateAfter(int64_t recordsRemoved,
+                                                  int64_t bytesRemoved,
+                                                  RecordId firstRemovedId);
+
+        // Returns the number of records and bytes in the stone being filled.
+        int64_t currentRecords() const { return _currentRecords.load(); }
+        int64_t currentBytes() const { return _currentBytes.load(); }
+
+        size_t numStones() const;
+
+        //
+        // The following methods are public only for use in tests.
+        //
+
+        void setMinBytesPerStone(int64_t size);
+
+        void setNumStonesToKeep(size_t numStones);
+
+    private:
+        class InsertChange;
+        class TruncateChange;
+
+        void _calculateStones(OperationContext* txn);
+        void _calculateStonesByScanning(OperationContext* txn);
+        bool _calculateStonesBySampling(OperationContext* txn,
+                                        int64_t estRecordsPerStone,
+                                        int64_t estBytesPerStone);
+
+        void _pokeReclaimThreadIfNeeded();
+
+        // How many random samples are drawn from the oplog for each stone when estimating them.
+        static const uint64_t kRandomSamplesPerStone = 10;
+
+        WiredTigerRecordStore* _rs;
+
+        stdx::mutex _oplogReclaimMutex;
+        stdx::condition_variable _oplogReclaimCv;
+
+        // True once the record store has been destroyed. Protected by _oplogReclaimMutex.
+        bool _isDead = false;
+
+        // Maximum number of stones to keep before the background thread starts reclaiming space.
+        size_t _numStonesToKeep;
+
+        // Minimum number of bytes the stone being filled has to hold before it is added to
+        // _stones.
+        int64_t _minBytesPerStone;
+
+        AtomicInt64 _currentRecords;    // Number of records in the stone being filled.
+        AtomicInt64 _currentBytes;      // Number of bytes in the stone being filled.
+
+        // Protects _stones, _numStonesToKeep and _minBytesPerStone. _oplogReclaimMutex may be held
+        // while acquiring _mutex, but not the other way around.
+        mutable stdx::mutex _mutex;
+        std::deque<OplogStones::Stone> _stones;     // front = oldest, back = newest.
+    };
+
+}  // namespace mongo
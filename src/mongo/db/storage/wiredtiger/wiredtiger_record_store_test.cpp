@@ -42,11 +42,13 @@
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -137,6 +139,8 @@ namespace mongo {
             return new WiredTigerRecoveryUnit( _sessionCache );
         }
 
+        virtual bool supportsDocLocking() const { return true; }
+
         WT_CONNECTION* conn() const { return _conn; }
 
     private:
@@ -188,6 +192,36 @@ namespace mongo {
         ASSERT_EQ(result.getValue(), "abc=def,");
     }
 
+    TEST(WiredTigerRecordStoreTest, InsertRecordWithId) {
+        unique_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+        unique_ptr<RecordStore> rs( harnessHelper->newNonCappedRecordStore() );
+        ASSERT( rs->supportsInsertWithId() );
+
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            WriteUnitOfWork uow( opCtx.get() );
+            ASSERT_OK( rs->insertRecordWithId( opCtx.get(), RecordId(100), "a", 2, false ) );
+            ASSERT_EQUALS( ErrorCodes::DuplicateKey,
+                           rs->insertRecordWithId( opCtx.get(), RecordId(100), "b", 2, false ) );
+            ASSERT_OK( rs->insertRecordWithId( opCtx.get(), RecordId(5), "c", 2, false ) );
+            uow.commit();
+        }
+
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            ASSERT_EQUALS( 2, rs->numRecords( opCtx.get() ) );
+            ASSERT_EQUALS( string("a"), rs->dataFor( opCtx.get(), RecordId(100) ).data() );
+            ASSERT_EQUALS( string("c"), rs->dataFor( opCtx.get(), RecordId(5) ).data() );
+
+            // records inserted without an id come after those inserted with one
+            WriteUnitOfWork uow( opCtx.get() );
+            StatusWith<RecordId> res = rs->insertRecord( opCtx.get(), "d", 2, false );
+            ASSERT_OK( res.getStatus() );
+            ASSERT_GREATER_THAN( res.getValue(), RecordId(100) );
+            uow.commit();
+        }
+    }
+
     TEST(WiredTigerRecordStoreTest, Isolation1 ) {
         unique_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
         unique_ptr<RecordStore> rs( harnessHelper->newNonCappedRecordStore() );
@@ -370,6 +404,47 @@ namespace mongo {
         rs.reset( NULL ); // this has to be deleted before ss
     }
 
+    TEST(WiredTigerRecordStoreTest, SizeStorerBackgroundFlush) {
+        unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+        unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+        string uri = checked_cast<WiredTigerRecordStore*>(rs.get())->getURI();
+
+        string sizeStorerUri = "table:mySizeStorer";
+        WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri);
+        {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            rs.reset(new WiredTigerRecordStore(opCtx.get(), "a.b", uri,
+                                               false, -1, -1, NULL, &ss));
+        }
+
+        // Inserts only update the record store's own counters.
+        int N = 12;
+        {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            WriteUnitOfWork uow(opCtx.get());
+            for (int i = 0; i < N; i++) {
+                ASSERT_OK(rs->insertRecord(opCtx.get(), "a", 2, false).getStatus());
+            }
+            uow.commit();
+        }
+
+        ss.startBackgroundFlusher(Milliseconds(10));
+
+        // The flusher picks the new counts up from the record store and writes them out.
+        long long numRecords = 0;
+        long long dataSize = 0;
+        for (int attempt = 0; attempt < 1000 && numRecords != N; attempt++) {
+            sleepmillis(10);
+            WiredTigerSizeStorer ss2(harnessHelper->conn(), sizeStorerUri);
+            ss2.fillCache();
+            ss2.loadFromCache(uri, &numRecords, &dataSize);
+        }
+        ASSERT_EQUALS(N, numRecords);
+        ASSERT_EQUALS(N * 2, dataSize);
+
+        rs.reset(NULL); // this has to be deleted before ss
+    }
+
 namespace {
 
     class GoodValidateAdaptor : public ValidateAdaptor {
@@ -737,6 +812,80 @@ namespace {
         ASSERT(!cursor->next());
     }
 
+    TEST(WiredTigerRecordStoreTest, CappedInsertRecordsVisibleOnCommit) {
+        unique_ptr<WiredTigerHarnessHelper> harnessHelper( new WiredTigerHarnessHelper() );
+        unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.b", 100000, -1));
+
+        std::vector<Record> records;
+        for (const char* data : {"a", "b", "c"}) {
+            records.push_back(Record{RecordId(), RecordData(data, 2)});
+        }
+
+        unique_ptr<OperationContext> t1( harnessHelper->newOperationContext() );
+        unique_ptr<WriteUnitOfWork> w1( new WriteUnitOfWork( t1.get() ) );
+        ASSERT_OK(rs->insertRecords(t1.get(), &records, false));
+        ASSERT(records[0].id < records[1].id);
+        ASSERT(records[1].id < records[2].id);
+
+        { // none of them is visible before the commit
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            auto cursor = rs->getCursor(opCtx.get());
+            ASSERT(!cursor->next());
+        }
+
+        w1->commit();
+
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            auto cursor = rs->getCursor(opCtx.get());
+            for (const Record& record : records) {
+                auto next = cursor->next();
+                ASSERT(next);
+                ASSERT_EQ(record.id, next->id);
+                ASSERT_EQUALS(std::string(record.data.data()), next->data.data());
+            }
+            ASSERT(!cursor->next());
+            ASSERT_EQUALS(3, rs->numRecords(opCtx.get()));
+            ASSERT_EQUALS(6, rs->dataSize(opCtx.get()));
+        }
+    }
+
+    TEST(WiredTigerRecordStoreTest, CappedInsertRecordsDeletesOlderRecords) {
+        unique_ptr<WiredTigerHarnessHelper> harnessHelper( new WiredTigerHarnessHelper() );
+        unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.b", 10000, 5));
+
+        std::vector<RecordId> locs;
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            for ( int i = 0; i < 5; ++i ) {
+                WriteUnitOfWork uow( opCtx.get() );
+                StatusWith<RecordId> res = rs->insertRecord( opCtx.get(), "a", 2, false );
+                ASSERT_OK( res.getStatus() );
+                locs.push_back(res.getValue());
+                uow.commit();
+            }
+        }
+
+        std::vector<Record> records(3, Record{RecordId(), RecordData("b", 2)});
+        {
+            unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            WriteUnitOfWork uow( opCtx.get() );
+            ASSERT_OK(rs->insertRecords(opCtx.get(), &records, false));
+            uow.commit();
+        }
+
+        // The three oldest records made room for the batch
+        unique_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+        ASSERT_EQUALS(5, rs->numRecords(opCtx.get()));
+        auto cursor = rs->getCursor(opCtx.get());
+        ASSERT_EQ(locs[3], cursor->next()->id);
+        ASSERT_EQ(locs[4], cursor->next()->id);
+        for (const Record& record : records) {
+            ASSERT_EQ(record.id, cursor->next()->id);
+        }
+        ASSERT(!cursor->next());
+    }
+
     RecordId _oplogOrderInsertOplog( OperationContext* txn,
                                     unique_ptr<RecordStore>& rs,
                                     int inc ) {
@@ -879,4 +1028,287 @@ namespace {
         ASSERT(!cursor->next());
     }
 
+
+    // Inserts an oplog entry with the given timestamp whose BSON representation is 'size' bytes.
+    RecordId _insertOplogRecord(OperationContext* txn,
+                                RecordStore* rs,
+                                Timestamp opTime,
+                                int size) {
+        // A document with just a Timestamp "ts" field and a string "s" field is 25 bytes plus the
+        // length of the string.
+        invariant(size >= 25);
+        BSONObj obj = BSON("ts" << opTime << "s" << std::string(size - 25, 'x'));
+        invariant(obj.objsize() == size);
+
+        WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs);
+        ASSERT_OK(wrs->oplogDiskLocRegister(txn, opTime));
+        StatusWith<RecordId> res = rs->insertRecord(txn, obj.objdata(), obj.objsize(), false);
+        ASSERT_OK(res.getStatus());
+        return res.getValue();
+    }
+
+    WiredTigerRecordStore::OplogStones* _stonesFor(const unique_ptr<RecordStore>& rs) {
+        WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+        WiredTigerRecordStore::OplogStones* oplogStones = wrs->oplogStones();
+        invariant(oplogStones);
+        return oplogStones;
+    }
+
+    TEST(WiredTigerRecordStoreTest, OplogStonesOnlyForTheOplog) {
+        unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+        unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.b", 10000, -1));
+        ASSERT(!checked_cast<WiredTigerRecordStore*>(rs.get())->oplogStones());
+    }
+
+    // Stones are only created once enough bytes have been committed to fill one.
+    TEST(WiredTigerRecordStoreTest, OplogStonesCreateNewStone) {
+        unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+        unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("local.oplog.stones",
+                                                                       10000,
+                                                                       -1));
+        WiredTigerRecordStore::OplogStones* oplogStones = _stonesFor(rs);
+        oplogStones->setMinBytesPerStone(100);
+
+        {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+
+            // Uncommitted inserts aren't counted.
+            {
+                WriteUnitOfWork wuow(opCtx.get());
+                _insertOplogRecord(opCtx.get(), rs.get(), Timestamp(1, 1), 80);
+            }
+            ASSERT_EQ(0U, oplogStones->numStones());
+            ASSERT_EQ(0, oplogStones->currentRecords());
+            ASSERT_EQ(0, oplogStones->currentBytes());
+        }
+
+        {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            WriteUnitOfWork wuow(opCtx.get());
+            _insertOplogRecord(opCtx.get(), rs.get(), Timestamp(1, 2), 50);
+            wuow.commit();
+
+            ASSERT_EQ(0U, oplogStones->numStones());
+            ASSERT_EQ(1, oplogStones->currentRecords());
+            ASSERT_EQ(50, oplogStones->currentBytes());
+        }
+
+        {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            WriteUnitOfWork wuow(opCtx.get());
+            _insertOplogRecord(opCtx.get(), rs.get(), Timestamp(1, 3), 50);
+            wuow.commit();
+
+            ASSERT_EQ(1U, oplogStones->numStones());
+            ASSERT_EQ(0, oplogStones->currentRecords());
+            ASSERT_EQ(0, oplogStones->currentBytes());
+        }
+
+        {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            WriteUnitOfWork wuow(opCtx.get());
+            _insertOplogRecord(opCtx.get(), rs.get(), Timestamp(1, 4), 120);
+            wuow.commit();
+
+            ASSERT_EQ(2U, oplogStones->numStones());
+            ASSERT_EQ(0, oplogStones->currentRecords());
+            ASSERT_EQ(0, oplogStones->currentBytes());
+        }
+    }
+
+    // Truncating the oplog in whole stones removes the records they cover and only those.
+    TEST(WiredTigerRecordStoreTest, OplogStonesReclaim) {
+        unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+        unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("local.oplog.stones",
+                                                                       10000,
+                                                                       -1));
+        WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+        WiredTigerRecordStore::OplogStones* oplogStones = _stonesFor(rs);
+        oplogStones->setMinBytesPerStone(100);
+        oplogStones->setNumStonesToKeep(2);
+
+        std::vector<RecordId> ids;
+        for (int i = 1; i <= 7; ++i) {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            WriteUnitOfWork wuow(opCtx.get());
+            ids.push_back(_insertOplogRecord(opCtx.get(), rs.get(), Timestamp(1, i), 50));
+            wuow.commit();
+        }
+
+        ASSERT_EQ(3U, oplogStones->numStones());
+        ASSERT_TRUE(oplogStones->hasExcessStones());
+
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQ(7, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(350, rs->dataSize(opCtx.get()));
+
+        wrs->reclaimOplog(opCtx.get());
+
+        ASSERT_EQ(2U, oplogStones->numStones());
+        ASSERT_FALSE(oplogStones->hasExcessStones());
+        ASSERT_EQ(5, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(250, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(1, oplogStones->currentRecords());
+        ASSERT_EQ(50, oplogStones->currentBytes());
+
+        auto cursor = rs->getCursor(opCtx.get());
+        ASSERT_FALSE(cursor->seekExact(ids[0]));
+        ASSERT_FALSE(cursor->seekExact(ids[1]));
+        for (size_t i = 2; i < ids.size(); ++i) {
+            auto record = cursor->seekExact(ids[i]);
+            ASSERT(record);
+            ASSERT_EQ(ids[i], record->id);
+        }
+
+        // Nothing further is truncated while the oplog doesn't have excess stones.
+        wrs->reclaimOplog(opCtx.get());
+        ASSERT_EQ(5, rs->numRecords(opCtx.get()));
+    }
+
+    // Truncating the whole oplog discards all stones.
+    TEST(WiredTigerRecordStoreTest, OplogStonesTruncate) {
+        unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+        unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("local.oplog.stones",
+                                                                       10000,
+                                                                       -1));
+        WiredTigerRecordStore::OplogStones* oplogStones = _stonesFor(rs);
+        oplogStones->setMinBytesPerStone(100);
+
+        for (int i = 1; i <= 3; ++i) {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            WriteUnitOfWork wuow(opCtx.get());
+            _insertOplogRecord(opCtx.get(), rs.get(), Timestamp(1, i), 50);
+            wuow.commit();
+        }
+        ASSERT_EQ(1U, oplogStones->numStones());
+        ASSERT_EQ(1, oplogStones->currentRecords());
+
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork wuow(opCtx.get());
+            ASSERT_OK(rs->truncate(opCtx.get()));
+            wuow.commit();
+        }
+
+        ASSERT_EQ(0U, oplogStones->numStones());
+        ASSERT_EQ(0, oplogStones->currentRecords());
+        ASSERT_EQ(0, oplogStones->currentBytes());
+        ASSERT_EQ(0, rs->numRecords(opCtx.get()));
+    }
+
+    // Removing the newest records drops the stones they belonged to and credits whatever remains
+    // of them to the stone being filled.
+    TEST(WiredTigerRecordStoreTest, OplogStonesCappedTruncateAfter) {
+        unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+        unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("local.oplog.stones",
+                                                                       10000,
+                                                                       -1));
+        WiredTigerRecordStore::OplogStones* oplogStones = _stonesFor(rs);
+        oplogStones->setMinBytesPerStone(100);
+
+        std::vector<RecordId> ids;
+        for (int i = 1; i <= 5; ++i) {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            WriteUnitOfWork wuow(opCtx.get());
+            ids.push_back(_insertOplogRecord(opCtx.get(), rs.get(), Timestamp(1, i), 50));
+            wuow.commit();
+        }
+        ASSERT_EQ(2U, oplogStones->numStones());
+        ASSERT_EQ(1, oplogStones->currentRecords());
+        ASSERT_EQ(50, oplogStones->currentBytes());
+
+        // Removes all of the second stone and the partially filled one.
+        {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            rs->temp_cappedTruncateAfter(opCtx.get(), ids[2], true);
+            ASSERT_EQ(2, rs->numRecords(opCtx.get()));
+        }
+        ASSERT_EQ(1U, oplogStones->numStones());
+        ASSERT_EQ(0, oplogStones->currentRecords());
+        ASSERT_EQ(0, oplogStones->currentBytes());
+
+        // Removes part of the first stone, leaving the remainder in the stone being filled.
+        {
+            unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+            rs->temp_cappedTruncateAfter(opCtx.get(), ids[0], false);
+            ASSERT_EQ(1, rs->numRecords(opCtx.get()));
+        }
+        ASSERT_EQ(0U, oplogStones->numStones());
+        ASSERT_EQ(1, oplogStones->currentRecords());
+        ASSERT_EQ(50, oplogStones->currentBytes());
+    }
+
+    TEST(WiredTigerRecordStoreTest, NoBulkLoaderForCappedCollections) {
+        unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+        unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.b", 10000, -1));
+
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT(!rs->makeBulkLoader(opCtx.get()));
+    }
+
+    TEST(WiredTigerRecordStoreTest, SessionCursorCacheEvictsLeastRecentlyUsed) {
+        WiredTigerHarnessHelper harnessHelper;
+        unique_ptr<RecordStore> rs(harnessHelper.newNonCappedRecordStore());
+
+        const int oldCacheSize = wiredTigerCursorCacheSize;
+        ON_BLOCK_EXIT([oldCacheSize] { wiredTigerCursorCacheSize = oldCacheSize; });
+        wiredTigerCursorCacheSize = 2;
+
+        WiredTigerSession session(harnessHelper.conn());
+        const uint64_t ids[] = {WiredTigerSession::genCursorId(),
+                                WiredTigerSession::genCursorId(),
+                                WiredTigerSession::genCursorId()};
+        WT_CURSOR* cursors[3];
+        for (int i = 0; i < 3; i++) {
+            cursors[i] = session.getCursor("table:a.b", ids[i], true);
+            ASSERT(cursors[i]);
+        }
+        for (int i = 0; i < 3; i++) {
+            session.releaseCursor(ids[i], cursors[i]);
+        }
+        ASSERT_EQUALS(0, session.cursorsOut());
+        ASSERT_EQUALS(2, session.cursorsCached());
+
+        // The first cursor released was evicted, so getting it again opens a new one.
+        WT_CURSOR* c = session.getCursor("table:a.b", ids[0], true);
+        ASSERT_EQUALS(2, session.cursorsCached());
+        session.releaseCursor(ids[0], c);
+
+        // The most recently released cursor is still cached.
+        c = session.getCursor("table:a.b", ids[0], true);
+        ASSERT_EQUALS(1, session.cursorsCached());
+        session.releaseCursor(ids[0], c);
+
+        session.closeAllCursors();
+        ASSERT_EQUALS(0, session.cursorsCached());
+    }
+
+    TEST(WiredTigerRecordStoreTest, SessionCacheClosesIdleSessions) {
+        WiredTigerHarnessHelper harnessHelper;
+        WiredTigerSessionCache sessionCache(harnessHelper.conn());
+
+        WiredTigerSession* first = sessionCache.getSession();
+        WiredTigerSession* second = sessionCache.getSession();
+        sessionCache.releaseSession(first);
+        sessionCache.releaseSession(second);
+
+        BSONObjBuilder before;
+        WiredTigerSessionCache::appendGlobalStats(before);
+        const long long closedBefore =
+            before.obj()["session cache"]["idle sessions closed"].numberLong();
+
+        // Nothing has been idle for an hour.
+        sessionCache.closeExpiredIdleSessions(60 * 60 * 1000);
+        BSONObjBuilder notIdle;
+        WiredTigerSessionCache::appendGlobalStats(notIdle);
+        ASSERT_EQUALS(closedBefore,
+                      notIdle.obj()["session cache"]["idle sessions closed"].numberLong());
+
+        sessionCache.closeExpiredIdleSessions(0);
+        BSONObjBuilder after;
+        WiredTigerSessionCache::appendGlobalStats(after);
+        ASSERT_EQUALS(closedBefore + 2,
+                      after.obj()["session cache"]["idle sessions closed"].numberLong());
+    }
+
 }  // namespace mongo
@@ -37,11 +37,12 @@
 #include "mongo/base/init.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/concurrency/admission_context.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
-#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/concurrency/priority_ticketholder.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/stacktrace.h"
@@ -77,6 +78,14 @@ namespace mongo {
             boost::condition condvar;
             long long lastSyncTime;
         } waitUntilDurableData;
+
+        // Each pinned snapshot keeps a WT transaction open while its ClientCursor is idle, which
+        // keeps WT from discarding old versions of documents, so their number is bounded.
+        MONGO_EXPORT_SERVER_PARAMETER(wiredTigerMaxPinnedCursorSnapshots, int, 0);
+
+        AtomicInt64 pinnedSnapshots;
+        AtomicInt64 snapshotPinsRefused;
+        AtomicInt64 reseeksAvoided;
     }
 
     WiredTigerRecoveryUnit::WiredTigerRecoveryUnit(WiredTigerSessionCache* sc) :
@@ -88,6 +97,7 @@ namespace mongo {
         _everStartedWrite( false ),
         _currentlySquirreled( false ),
         _syncing( false ),
+        _snapshotPinned( false ),
         _noTicketNeeded( false ) {
     }
 
@@ -110,6 +120,28 @@ namespace mongo {
             b->append("wt_millisSinceCommit", _timer.millis());
     }
 
+    bool WiredTigerRecoveryUnit::prepareForReuse() {
+        if (_inUnitOfWork || _snapshotPinned) {
+            return false;
+        }
+
+        _abort();
+        _ticket.reset(NULL);
+
+        // The session goes back to the cache, so idle clients don't hold on to sessions
+        if ( _session ) {
+            _sessionCache->releaseSession( _session );
+            _session = NULL;
+        }
+
+        _everStartedWrite = false;
+        _currentlySquirreled = false;
+        _syncing = false;
+        _oplogReadTill = RecordId();
+        _noTicketNeeded = false;
+        return true;
+    }
+
     void WiredTigerRecoveryUnit::_commit() {
         try {
             if ( _session && _active ) {
@@ -210,6 +242,10 @@ namespace mongo {
         if ( !_active ) {
             _txnOpen(opCtx);
         }
+        else if ( _snapshotPinned && !_ticket.hasTicket() ) {
+            // Resuming a pinned snapshot, which gave up its ticket while it was idle.
+            _getTicket(opCtx);
+        }
         return _session;
     }
 
@@ -221,6 +257,34 @@ namespace mongo {
         }
     }
 
+    void WiredTigerRecoveryUnit::preallocateSnapshot(OperationContext* opCtx) {
+        invariant(!_inUnitOfWork);
+        // Beginning a transaction with snapshot isolation takes its snapshot.
+        getSession(opCtx);
+    }
+
+    bool WiredTigerRecoveryUnit::pinSnapshot() {
+        invariant(!_inUnitOfWork);
+        if (!_active || wiredTigerMaxPinnedCursorSnapshots <= 0) {
+            return false;
+        }
+
+        if (!_snapshotPinned) {
+            if (pinnedSnapshots.addAndFetch(1) > wiredTigerMaxPinnedCursorSnapshots) {
+                pinnedSnapshots.subtractAndFetch(1);
+                snapshotPinsRefused.fetchAndAdd(1);
+                return false;
+            }
+            _snapshotPinned = true;
+        }
+        return true;
+    }
+
+    // static
+    void WiredTigerRecoveryUnit::noteReseekAvoided() {
+        reseeksAvoided.fetchAndAdd(1);
+    }
+
     void WiredTigerRecoveryUnit::setOplogReadTill( const RecordId& loc ) {
         _oplogReadTill = loc;
     }
@@ -231,7 +295,7 @@ namespace mongo {
         class TicketServerParameter : public ServerParameter {
             MONGO_DISALLOW_COPYING(TicketServerParameter);
         public:
-            TicketServerParameter(TicketHolder* holder, const std::string& name)
+            TicketServerParameter(PriorityTicketHolder* holder, const std::string& name)
                 : ServerParameter(ServerParameterSet::getGlobal(),
                                   name,
                                   true,
@@ -268,36 +332,67 @@ namespace mongo {
             }
 
         private:
-            TicketHolder* _holder;
+            PriorityTicketHolder* _holder;
         };
 
-        TicketHolder openWriteTransaction(128);
+        PriorityTicketHolder openWriteTransaction(128);
         TicketServerParameter openWriteTransactionParam(&openWriteTransaction,
                                                         "wiredTigerConcurrentWriteTransactions");
 
-        TicketHolder openReadTransaction(128);
+        PriorityTicketHolder openReadTransaction(128);
         TicketServerParameter openReadTransactionParam(&openReadTransaction,
                                                        "wiredTigerConcurrentReadTransactions");
 
+        void appendTicketHolderStats(const PriorityTicketHolder& holder, BSONObjBuilder* b) {
+            b->append("out", holder.used());
+            b->append("available", holder.available());
+            b->append("totalTickets", holder.outof());
+
+            BSONObjBuilder lanesBuilder(b->subobjStart("priorities"));
+            for (int i = 0; i < kNumAdmissionPriorities; i++) {
+                const AdmissionPriority priority = static_cast<AdmissionPriority>(i);
+                const PriorityTicketHolder::LaneStats stats = holder.getLaneStats(priority);
+
+                BSONObjBuilder laneBuilder(lanesBuilder.subobjStart(
+                                               admissionPriorityName(priority)));
+                laneBuilder.append("queued", stats.queued);
+                laneBuilder.append("admitted", stats.admitted);
+                laneBuilder.append("queuedMicros", stats.queuedMicros);
+            }
+        }
+
+    }
+
+    // static
+    PriorityTicketHolder* WiredTigerRecoveryUnit::getWriteTicketHolder() {
+        return &openWriteTransaction;
+    }
+
+    // static
+    PriorityTicketHolder* WiredTigerRecoveryUnit::getReadTicketHolder() {
+        return &openReadTransaction;
     }
 
     void WiredTigerRecoveryUnit::appendGlobalStats(BSONObjBuilder& b) {
         BSONObjBuilder bb(b.subobjStart("concurrentTransactions"));
         {
             BSONObjBuilder bbb(bb.subobjStart("write"));
-            bbb.append("out", openWriteTransaction.used());
-            bbb.append("available", openWriteTransaction.available());
-            bbb.append("totalTickets", openWriteTransaction.outof());
+            appendTicketHolderStats(openWriteTransaction, &bbb);
             bbb.done();
         }
         {
             BSONObjBuilder bbb(bb.subobjStart("read"));
-            bbb.append("out", openReadTransaction.used());
-            bbb.append("available", openReadTransaction.available());
-            bbb.append("totalTickets", openReadTransaction.outof());
+            appendTicketHolderStats(openReadTransaction, &bbb);
             bbb.done();
         }
         bb.done();
+
+        BSONObjBuilder pinned(b.subobjStart("pinnedCursorSnapshots"));
+        pinned.append("current", pinnedSnapshots.load());
+        pinned.append("maximum", wiredTigerMaxPinnedCursorSnapshots);
+        pinned.append("refused", snapshotPinsRefused.load());
+        pinned.append("reseeksAvoided", reseeksAvoided.load());
+        pinned.done();
     }
 
     void WiredTigerRecoveryUnit::_txnClose( bool commit ) {
@@ -316,6 +411,11 @@ namespace mongo {
         _active = false;
         _myTransactionCount++;
         _ticket.reset(NULL);
+
+        if (_snapshotPinned) {
+            _snapshotPinned = false;
+            pinnedSnapshots.subtractAndFetch(1);
+        }
     }
 
     SnapshotId WiredTigerRecoveryUnit::getSnapshotId() const {
@@ -349,10 +449,20 @@ namespace mongo {
             writeLocked = _everStartedWrite;
         }
 
-        TicketHolder* holder = writeLocked ? &openWriteTransaction : &openReadTransaction;
+        PriorityTicketHolder* holder = writeLocked ? &openWriteTransaction : &openReadTransaction;
 
-        holder->waitForTicket();
+        AdmissionPriority priority = AdmissionPriority::kSystem;
+        if (opCtx != NULL) {
+            priority = AdmissionContext::getPriority(opCtx);
+        }
+
+        Timer waitTimer;
+        holder->waitForTicket(priority);
         _ticket.reset(holder);
+
+        if (opCtx != NULL) {
+            AdmissionContext::get(opCtx).recordTicketWait(waitTimer.micros());
+        }
     }
 
     void WiredTigerRecoveryUnit::_txnOpen(OperationContext* opCtx) {
@@ -373,6 +483,12 @@ namespace mongo {
         if ( _active == false && !wt_keeptxnopen() ) {
             _commit();
         }
+
+        if ( _snapshotPinned ) {
+            // Don't hold a ticket while the ClientCursor which owns us is idle. getSession() takes
+            // one again when the snapshot is used.
+            _ticket.reset(NULL);
+        }
     }
     void WiredTigerRecoveryUnit::beingSetOnOperationContext() {
         LOG(2) << "WiredTigerRecoveryUnit::broughtBack";
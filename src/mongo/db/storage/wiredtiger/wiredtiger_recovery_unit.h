@@ -39,7 +39,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/recovery_unit.h"
-#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/concurrency/priority_ticketholder.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -56,6 +56,8 @@ namespace mongo {
 
         virtual void reportState( BSONObjBuilder* b ) const;
 
+        virtual bool prepareForReuse();
+
         void beginUnitOfWork(OperationContext* opCtx) final;
         void commitUnitOfWork() final;
         void abortUnitOfWork() final;
@@ -77,6 +79,12 @@ namespace mongo {
 
         virtual SnapshotId getSnapshotId() const;
 
+        virtual void preallocateSnapshot(OperationContext* opCtx);
+
+        virtual bool pinSnapshot();
+
+        virtual bool isSnapshotPinned() const { return _snapshotPinned; }
+
         // ---- WT STUFF
 
         WiredTigerSession* getSession(OperationContext* opCtx);
@@ -91,9 +99,30 @@ namespace mongo {
 
         void markNoTicketRequired();
 
+        /**
+         * Returns true if a cursor saved while the snapshot was 'savedSnapshotId' is still where
+         * it was left, because the snapshot has been pinned since. Such a cursor does not need to
+         * be repositioned on restore.
+         */
+        bool isPositionRetained(SnapshotId savedSnapshotId) const {
+            return _snapshotPinned && _active && getSnapshotId() == savedSnapshotId;
+        }
+
+        /**
+         * Counts a cursor restore which could skip repositioning thanks to a pinned snapshot.
+         */
+        static void noteReseekAvoided();
+
         static WiredTigerRecoveryUnit* get(OperationContext *txn);
 
         static void appendGlobalStats(BSONObjBuilder& b);
+
+        /**
+         * The tickets which limit the number of concurrent write and read transactions, sized by
+         * wiredTigerConcurrentWriteTransactions and wiredTigerConcurrentReadTransactions.
+         */
+        static PriorityTicketHolder* getWriteTicketHolder();
+        static PriorityTicketHolder* getReadTicketHolder();
     private:
 
         void _abort();
@@ -117,9 +146,12 @@ namespace mongo {
         typedef OwnedPointerVector<Change> Changes;
         Changes _changes;
 
+        // Whether the open transaction is being kept across getMores. See pinSnapshot().
+        bool _snapshotPinned;
+
         bool _noTicketNeeded;
         void _getTicket(OperationContext* opCtx);
-        TicketHolderReleaser _ticket;
+        PriorityTicketHolderReleaser _ticket;
     };
 
     /**
@@ -77,6 +77,17 @@ namespace mongo {
         }
 
         WiredTigerRecoveryUnit::appendGlobalStats(bob);
+        WiredTigerSessionCache::appendGlobalStats(bob);
+
+        if (WiredTigerCheckpointScheduler* scheduler = _engine->getCheckpointScheduler()) {
+            BSONObjBuilder schedulerBuilder(bob.subobjStart("checkpoint scheduler"));
+            scheduler->appendStats(&schedulerBuilder);
+        }
+
+        if (WiredTigerTicketController* controller = _engine->getTicketController()) {
+            BSONObjBuilder controllerBuilder(bob.subobjStart("ticket controller"));
+            controller->appendStats(&controllerBuilder);
+        }
 
         return bob.obj();
     }
@@ -35,12 +35,24 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
 
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCursorCacheSize, int, 100);
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerSessionCloseIdleTimeSecs, int, 300);
+
+    namespace {
+        AtomicInt64 sessionsOpen;
+        AtomicInt64 sessionsClosedIdle;
+        AtomicInt64 totalCursorsCached;
+        AtomicInt64 cursorsEvicted;
+    }
+
     WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn, int cachePartition, int epoch)
         : _cachePartition(cachePartition),
           _epoch(epoch),
@@ -49,23 +61,28 @@ namespace mongo {
 
         int ret = conn->open_session(conn, NULL, "isolation=snapshot", &_session);
         invariantWTOK(ret);
+        sessionsOpen.fetchAndAdd(1);
     }
 
     WiredTigerSession::~WiredTigerSession() {
         if (_session) {
+            closeAllCursors();
             int ret = _session->close(_session, NULL);
             invariantWTOK(ret);
+            sessionsOpen.fetchAndSubtract(1);
         }
     }
 
     WT_CURSOR* WiredTigerSession::getCursor(const std::string& uri,
                                             uint64_t id,
                                             bool forRecordStore) {
-        {
-            Cursors& cursors = _curmap[id];
-            if ( !cursors.empty() ) {
-                WT_CURSOR* save = cursors.back();
-                cursors.pop_back();
+        // The cache is small enough for a linear search, and the cursor wanted is usually one of
+        // the most recently released ones.
+        for (Cursors::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
+            if (i->id == id) {
+                WT_CURSOR* save = i->cursor;
+                _cursors.erase(i);
+                totalCursorsCached.fetchAndSubtract(1);
                 _cursorsOut++;
                 return save;
             }
@@ -87,34 +104,39 @@ namespace mongo {
         invariant( cursor );
         _cursorsOut--;
 
-        Cursors& cursors = _curmap[id];
-        if ( cursors.size() > 10u ) {
-            invariantWTOK( cursor->close(cursor) );
-        }
-        else {
-            invariantWTOK( cursor->reset( cursor ) );
-            cursors.push_back( cursor );
+        invariantWTOK( cursor->reset( cursor ) );
+        CachedCursor cached = {id, cursor};
+        _cursors.push_front(cached);
+        totalCursorsCached.fetchAndAdd(1);
+
+        // Evict the least recently used cursors beyond the limit.
+        const size_t maxCached = std::max(0, wiredTigerCursorCacheSize);
+        while (_cursors.size() > maxCached) {
+            WT_CURSOR* evicted = _cursors.back().cursor;
+            _cursors.pop_back();
+            totalCursorsCached.fetchAndSubtract(1);
+            cursorsEvicted.fetchAndAdd(1);
+            invariantWTOK( evicted->close(evicted) );
         }
     }
 
     void WiredTigerSession::closeAllCursors() {
         invariant( _session );
-        for (CursorMap::iterator i = _curmap.begin(); i != _curmap.end(); ++i ) {
-            Cursors& cursors = i->second;
-            for ( size_t j = 0; j < cursors.size(); j++ ) {
-                WT_CURSOR *cursor = cursors[j];
-                if (cursor) {
-                    int ret = cursor->close(cursor);
-                    invariantWTOK(ret);
-                }
+        for (Cursors::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
+            WT_CURSOR *cursor = i->cursor;
+            if (cursor) {
+                int ret = cursor->close(cursor);
+                invariantWTOK(ret);
             }
         }
-        _curmap.clear();
+        totalCursorsCached.fetchAndSubtract(_cursors.size());
+        _cursors.clear();
     }
 
     namespace {
         AtomicUInt64 nextCursorId(1);
         AtomicUInt64 cachePartitionGen(0);
+        SpinLockStats sessionCacheSpinLockStats("wiredTigerSessionCache");
     }
     // static
     uint64_t WiredTigerSession::genCursorId() {
@@ -123,6 +145,11 @@ namespace mongo {
 
     // -----------------------
 
+    WiredTigerSessionCache::SessionCachePartition::SessionCachePartition()
+        : lock(&sessionCacheSpinLockStats),
+          epoch(0) {
+    }
+
     WiredTigerSessionCache::WiredTigerSessionCache( WiredTigerKVEngine* engine )
         : _engine( engine ), _conn( engine->getConnection() ), _shuttingDown(0) {
 
@@ -170,6 +197,51 @@ namespace mongo {
         }
     }
 
+    void WiredTigerSessionCache::closeExpiredIdleSessions(int64_t idleTimeMillis) {
+        // Don't pull sessions out from under a shutdown.
+        boost::shared_lock<boost::shared_mutex> shutdownLock(_shutdownLock);
+        if (_shuttingDown.loadRelaxed()) {
+            return;
+        }
+
+        const long long cutoff = Date_t::now().toMillisSinceEpoch() - idleTimeMillis;
+
+        for (int i = 0; i < NumSessionCachePartitions; i++) {
+            SessionPool expired;
+
+            {
+                boost::unique_lock<SpinLock> scopedLock(_cache[i].lock);
+
+                // Sessions are taken from and returned to the back of the pool, so the ones at
+                // the front have been idle the longest.
+                SessionPool& pool = _cache[i].pool;
+                SessionPool::iterator firstKept = pool.begin();
+                while (firstKept != pool.end() &&
+                       (*firstKept)->_idleSince.toMillisSinceEpoch() <= cutoff) {
+                    ++firstKept;
+                }
+                expired.assign(pool.begin(), firstKept);
+                pool.erase(pool.begin(), firstKept);
+            }
+
+            // Close the sessions outside of the lock.
+            for (size_t j = 0; j < expired.size(); j++) {
+                delete expired[j];
+            }
+            sessionsClosedIdle.fetchAndAdd(expired.size());
+        }
+    }
+
+    // static
+    void WiredTigerSessionCache::appendGlobalStats(BSONObjBuilder& b) {
+        BSONObjBuilder bb(b.subobjStart("session cache"));
+        bb.append("open sessions", sessionsOpen.load());
+        bb.append("idle sessions closed", sessionsClosedIdle.load());
+        bb.append("cached cursors", totalCursorsCached.load());
+        bb.append("cached cursors evicted", cursorsEvicted.load());
+        bb.done();
+    }
+
     WiredTigerSession* WiredTigerSessionCache::getSession() {
         boost::shared_lock<boost::shared_mutex> shutdownLock(_shutdownLock);
 
@@ -229,6 +301,7 @@ namespace mongo {
             invariant(session->_getEpoch() <= _cache[cachePartition].epoch);
 
             if (session->_getEpoch() == _cache[cachePartition].epoch) {
+                session->_idleSince = Date_t::now();
                 _cache[cachePartition].pool.push_back(session);
                 returnedToCache = true;
             }
@@ -31,7 +31,7 @@
 
 #pragma once
 
-#include <map>
+#include <list>
 #include <string>
 #include <vector>
 
@@ -42,13 +42,27 @@
 
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
+    class BSONObjBuilder;
     class WiredTigerKVEngine;
 
     /**
-     * This is a structure that caches 1 cursor for each uri.
+     * Maximum number of cursors each WiredTigerSession keeps open for reuse. The least recently
+     * used cursor is closed when the limit is exceeded.
+     */
+    extern int wiredTigerCursorCacheSize;
+
+    /**
+     * Number of seconds after which sessions sitting unused in the WiredTigerSessionCache are
+     * closed. Zero or less disables closing idle sessions.
+     */
+    extern int wiredTigerSessionCloseIdleTimeSecs;
+
+    /**
+     * This is a structure that caches recently used cursors, in least recently used order.
      * The idea is that there is a pool of these somewhere.
      * NOT THREADSAFE
      */
@@ -80,6 +94,8 @@ namespace mongo {
 
         int cursorsOut() const { return _cursorsOut; }
 
+        int cursorsCached() const { return _cursors.size(); }
+
         static uint64_t genCursorId();
 
         /**
@@ -90,8 +106,13 @@ namespace mongo {
     private:
         friend class WiredTigerSessionCache;
 
-        typedef std::vector<WT_CURSOR*> Cursors;
-        typedef std::map<uint64_t, Cursors> CursorMap;
+        struct CachedCursor {
+            uint64_t id;
+            WT_CURSOR* cursor;
+        };
+
+        // Most recently released cursors are at the front.
+        typedef std::list<CachedCursor> Cursors;
 
 
         // Used internally by WiredTigerSessionCache
@@ -102,8 +123,11 @@ namespace mongo {
         const int _cachePartition;
         const int _epoch;
         WT_SESSION* _session; // owned
-        CursorMap _curmap; // owned
+        Cursors _cursors; // owned
         int _cursorsOut;
+
+        // When this session was last returned to the session cache.
+        Date_t _idleSince;
     };
 
     class WiredTigerSessionCache {
@@ -118,8 +142,19 @@ namespace mongo {
 
         void closeAll();
 
+        /**
+         * Closes the cached sessions which have been idle for at least 'idleTimeMillis'.
+         */
+        void closeExpiredIdleSessions(int64_t idleTimeMillis);
+
         void shuttingDown();
 
+        /**
+         * Reports the number of open sessions and cursors and how many were closed for being
+         * idle or evicted from a cursor cache.
+         */
+        static void appendGlobalStats(BSONObjBuilder& b);
+
         WT_CONNECTION* conn() const { return _conn; }
 
     private:
@@ -128,7 +163,7 @@ namespace mongo {
         enum { NumSessionCachePartitions = 64 };
 
         struct SessionCachePartition {
-            SessionCachePartition() : epoch(0) { }
+            SessionCachePartition();
             ~SessionCachePartition() {
                 invariant(pool.empty());
             }
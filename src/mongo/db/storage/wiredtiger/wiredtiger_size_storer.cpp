@@ -36,6 +36,7 @@
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -54,7 +55,8 @@ namespace mongo {
     }
 
     WiredTigerSizeStorer::WiredTigerSizeStorer(WT_CONNECTION* conn, const std::string& storageUri)
-            : _session(conn)
+            : _session(conn),
+              _flusherShutdown(false)
     {
         WT_SESSION* session = _session.getSession();
         int ret = session->open_cursor(session, storageUri.c_str(), NULL,
@@ -73,6 +75,15 @@ namespace mongo {
     }
 
     WiredTigerSizeStorer::~WiredTigerSizeStorer() {
+        if (_flusherThread.joinable()) {
+            {
+                stdx::lock_guard<stdx::mutex> lk(_flusherMutex);
+                _flusherShutdown = true;
+            }
+            _flusherCV.notify_one();
+            _flusherThread.join();
+        }
+
         // This shouldn't be necessary, but protects us if we screw up.
         boost::lock_guard<boost::mutex> cursorLock( _cursorMutex );
 
@@ -231,10 +242,41 @@ namespace mongo {
         invariantWTOK(session->commit_transaction(session, NULL));
 
         {
+            // Entries which changed while they were being written stay dirty for the next sync.
             boost::lock_guard<boost::mutex> lk( _entriesMutex );
-            for (Map::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-                it->second.dirty = false;
+            for (Map::iterator it = myMap.begin(); it != myMap.end(); ++it) {
+                Map::iterator current = _entries.find(it->first);
+                if (current != _entries.end() &&
+                    current->second.numRecords == it->second.numRecords &&
+                    current->second.dataSize == it->second.dataSize) {
+                    current->second.dirty = false;
+                }
+            }
+        }
+    }
+
+    void WiredTigerSizeStorer::startBackgroundFlusher(Milliseconds period) {
+        invariant(!_flusherThread.joinable());
+        _flusherThread = stdx::thread(&WiredTigerSizeStorer::_backgroundFlusher, this, period);
+    }
+
+    void WiredTigerSizeStorer::_backgroundFlusher(Milliseconds period) {
+        stdx::unique_lock<stdx::mutex> lk(_flusherMutex);
+        while (!_flusherShutdown) {
+            _flusherCV.wait_for(lk, period);
+            if (_flusherShutdown) {
+                break;
+            }
+
+            lk.unlock();
+            try {
+                syncCache(false);
+            }
+            catch (const WriteConflictException&) {
+                // Ignore, we'll try again next time.
+                LOG(1) << "WiredTigerSizeStorer background flush hit a write conflict";
             }
+            lk.lock();
         }
     }
 
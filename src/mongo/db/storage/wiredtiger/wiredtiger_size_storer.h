@@ -38,12 +38,24 @@
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
     class WiredTigerRecordStore;
     class WiredTigerSession;
 
+    /**
+     * Persists the number of records and data size of each collection to a WT table.
+     *
+     * Record stores registered with onCreate() are not told about every change: their own
+     * atomic counters are read when the cache is synced, so inserts and deletes never take the
+     * size storer's locks. syncCache() writes only the entries which changed since the last
+     * sync, all in one WT transaction.
+     */
     class WiredTigerSizeStorer {
     public:
         WiredTigerSizeStorer(WT_CONNECTION* conn, const std::string& storageUri);
@@ -66,9 +78,17 @@ namespace mongo {
          */
         void syncCache(bool syncToDisk);
 
+        /**
+         * Starts a thread which calls syncCache(false) every 'period', so that no user operation
+         * has to pay for writing the sizes. The thread is stopped by the destructor.
+         */
+        void startBackgroundFlusher(Milliseconds period);
+
     private:
         void _checkMagic() const;
 
+        void _backgroundFlusher(Milliseconds period);
+
         struct Entry {
             Entry() : numRecords(0), dataSize(0), dirty(false), rs(NULL){}
             long long numRecords;
@@ -88,6 +108,10 @@ namespace mongo {
         Map _entries;
         mutable boost::mutex _entriesMutex;
 
+        stdx::thread _flusherThread;
+        stdx::mutex _flusherMutex;
+        stdx::condition_variable _flusherCV;
+        bool _flusherShutdown;  // Guarded by _flusherMutex.
     };
 
 }
@@ -0,0 +1,334 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/priority_ticketholder.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    namespace {
+        // WiredTiger's default eviction_trigger: application threads start evicting pages once
+        // the cache is this full.
+        const long long kEvictionTriggerPercent = 95;
+
+        // An increase is kept if it raises the transactions finished per interval by at least
+        // this much, or if the average time a ticket is held rises by no more than this much.
+        const long long kMinGainPercent = 5;
+        const long long kMaxLatencyRisePercent = 10;
+
+        // Intervals to leave a holder alone after undoing an increase which didn't pay off.
+        const int kHoldIntervals = 10;
+
+        /**
+         * Reads a connection statistic, or returns 0 if it is unavailable.
+         */
+        long long connectionStatistic(WT_SESSION* session, int key) {
+            StatusWith<long long> value = WiredTigerUtil::getStatisticsValueAs<long long>(
+                session, "statistics:", "statistics=(fast)", key);
+            if (!value.isOK()) {
+                LOG(1) << "unable to read WiredTiger statistic " << key << ": "
+                       << value.getStatus();
+                return 0;
+            }
+            return value.getValue();
+        }
+    }
+
+    WiredTigerTicketController::Policy::Policy()
+        : _judgingIncrease(false),
+          _lastIncrease(0),
+          _releasedBeforeIncrease(0),
+          _heldMicrosBeforeIncrease(0),
+          _intervalsToHold(0) { }
+
+    int WiredTigerTicketController::Policy::decide(int tickets,
+                                                   const Sample& sample,
+                                                   const CacheState& cache,
+                                                   int minTickets,
+                                                   int maxTickets,
+                                                   Reason* reason) {
+        *reason = kNone;
+
+        if (tickets < minTickets || tickets > maxTickets) {
+            _judgingIncrease = false;
+            *reason = kBounds;
+            return std::min(std::max(tickets, minTickets), maxTickets);
+        }
+
+        const bool evictionPressure = cache.appEvictions > 0 ||
+            (cache.bytesMax > 0 &&
+             cache.bytesInUse * 100 >= cache.bytesMax * kEvictionTriggerPercent);
+        if (evictionPressure) {
+            _judgingIncrease = false;
+            const int shrunk = std::max(minTickets, tickets - std::max(1, tickets / 4));
+            if (shrunk != tickets) {
+                *reason = kEvictionPressure;
+            }
+            return shrunk;
+        }
+
+        const long long heldMicros =
+            sample.released > 0 ? sample.heldMicros / sample.released : 0;
+
+        if (_judgingIncrease) {
+            _judgingIncrease = false;
+            const bool moreThroughput = sample.released * 100 >=
+                _releasedBeforeIncrease * (100 + kMinGainPercent);
+            const bool steadyLatency = heldMicros * 100 <=
+                _heldMicrosBeforeIncrease * (100 + kMaxLatencyRisePercent);
+            if (!moreThroughput && !steadyLatency) {
+                _intervalsToHold = kHoldIntervals;
+                *reason = kNoGain;
+                return std::max(minTickets, tickets - _lastIncrease);
+            }
+        }
+
+        if (_intervalsToHold > 0) {
+            _intervalsToHold--;
+            return tickets;
+        }
+
+        if (sample.queuedMicros > 0 && tickets < maxTickets) {
+            const int grown = std::min(maxTickets, tickets + std::max(1, tickets / 8));
+            _judgingIncrease = true;
+            _lastIncrease = grown - tickets;
+            _releasedBeforeIncrease = sample.released;
+            _heldMicrosBeforeIncrease = heldMicros;
+            *reason = kQueued;
+            return grown;
+        }
+
+        return tickets;
+    }
+
+    WiredTigerTicketController::WiredTigerTicketController(WT_CONNECTION* conn,
+                                                           PriorityTicketHolder* writeTickets,
+                                                           PriorityTicketHolder* readTickets)
+        : _conn(conn),
+          _lastAppEvictions(0),
+          _shuttingDown(false) {
+        _holders[kWrite].name = "wiredTigerConcurrentWriteTransactions";
+        _holders[kWrite].tickets = writeTickets;
+        _holders[kRead].name = "wiredTigerConcurrentReadTransactions";
+        _holders[kRead].tickets = readTickets;
+
+        _settings[kEnabled].store(0);
+        _settings[kMinTickets].store(16);
+        _settings[kMaxTickets].store(256);
+        _settings[kIntervalMillis].store(1000);
+    }
+
+    WiredTigerTicketController::~WiredTigerTicketController() {
+        shutdown();
+    }
+
+    void WiredTigerTicketController::start() {
+        invariant(!_thread.joinable());
+        _thread = stdx::thread(&WiredTigerTicketController::_run, this);
+    }
+
+    void WiredTigerTicketController::shutdown() {
+        if (!_thread.joinable()) {
+            return;
+        }
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _shuttingDown = true;
+        }
+        _cv.notify_one();
+        _thread.join();
+    }
+
+    long long WiredTigerTicketController::getSetting(Setting setting) const {
+        invariant(setting >= 0 && setting < kNumSettings);
+        return _settings[setting].load();
+    }
+
+    void WiredTigerTicketController::setSetting(Setting setting, long long value) {
+        invariant(setting >= 0 && setting < kNumSettings);
+        invariant(value >= 0);
+        _settings[setting].store(value);
+    }
+
+    // static
+    const char* WiredTigerTicketController::settingName(Setting setting) {
+        switch (setting) {
+        case kEnabled: return "wiredTigerTicketControllerEnabled";
+        case kMinTickets: return "wiredTigerTicketControllerMinTickets";
+        case kMaxTickets: return "wiredTigerTicketControllerMaxTickets";
+        case kIntervalMillis: return "wiredTigerTicketControllerIntervalMillis";
+        case kNumSettings: break;
+        }
+        invariant(false);
+        return NULL;
+    }
+
+    // static
+    const char* WiredTigerTicketController::reasonName(Reason reason) {
+        switch (reason) {
+        case kNone: return "none";
+        case kQueued: return "queued";
+        case kNoGain: return "noGain";
+        case kEvictionPressure: return "evictionPressure";
+        case kBounds: return "bounds";
+        case kNumReasons: break;
+        }
+        invariant(false);
+        return NULL;
+    }
+
+    void WiredTigerTicketController::appendStats(BSONObjBuilder* builder) const {
+        {
+            BSONObjBuilder settings(builder->subobjStart("settings"));
+            for (int i = 0; i < kNumSettings; i++) {
+                settings.append(settingName(static_cast<Setting>(i)),
+                                getSetting(static_cast<Setting>(i)));
+            }
+        }
+        for (int i = 0; i < kNumHolders; i++) {
+            const Holder& holder = _holders[i];
+            BSONObjBuilder holderBuilder(builder->subobjStart(holder.name));
+            holderBuilder.append("tickets", holder.tickets->outof());
+            BSONObjBuilder adjustments(holderBuilder.subobjStart("adjustments"));
+            for (int j = kNone + 1; j < kNumReasons; j++) {
+                adjustments.append(reasonName(static_cast<Reason>(j)),
+                                   holder.adjustments[j].load());
+            }
+        }
+    }
+
+    void WiredTigerTicketController::_run() {
+        WiredTigerSession session(_conn);
+        WT_SESSION* s = session.getSession();
+
+        // Whether the last interval was sampled, so that this one can be compared with it.
+        bool sampled = false;
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (!_shuttingDown) {
+            _cv.wait_for(lk, Milliseconds(std::max(1LL, getSetting(kIntervalMillis))));
+            if (_shuttingDown) {
+                break;
+            }
+
+            if (!getSetting(kEnabled)) {
+                sampled = false;
+                continue;
+            }
+
+            // Don't hold up shutdown() while reading statistics.
+            lk.unlock();
+            const CacheState cache = _readCacheState(s);
+            for (int i = 0; i < kNumHolders; i++) {
+                Holder* holder = &_holders[i];
+                const Totals totals = _readTotals(*holder->tickets);
+                if (sampled) {
+                    Sample sample;
+                    sample.queuedMicros = totals.queuedMicros - holder->lastTotals.queuedMicros;
+                    sample.released = totals.released - holder->lastTotals.released;
+                    sample.heldMicros = totals.heldMicros - holder->lastTotals.heldMicros;
+                    _adjust(holder, sample, cache);
+                }
+                else {
+                    holder->policy = Policy();
+                }
+                holder->lastTotals = totals;
+            }
+            sampled = true;
+            lk.lock();
+        }
+    }
+
+    // static
+    WiredTigerTicketController::Totals WiredTigerTicketController::_readTotals(
+            const PriorityTicketHolder& tickets) {
+        Totals totals;
+        for (int i = 0; i < kNumAdmissionPriorities; i++) {
+            totals.queuedMicros +=
+                tickets.getLaneStats(static_cast<AdmissionPriority>(i)).queuedMicros;
+        }
+        const PriorityTicketHolder::HoldStats holdStats = tickets.getHoldStats();
+        totals.released = holdStats.released;
+        totals.heldMicros = holdStats.heldMicros;
+        return totals;
+    }
+
+    WiredTigerTicketController::CacheState WiredTigerTicketController::_readCacheState(
+            WT_SESSION* session) {
+        CacheState cache;
+        cache.bytesInUse = connectionStatistic(session, WT_STAT_CONN_CACHE_BYTES_INUSE);
+        cache.bytesMax = connectionStatistic(session, WT_STAT_CONN_CACHE_BYTES_MAX);
+
+        const long long appEvictions =
+            connectionStatistic(session, WT_STAT_CONN_CACHE_EVICTION_APP);
+        cache.appEvictions = std::max(0LL, appEvictions - _lastAppEvictions);
+        _lastAppEvictions = appEvictions;
+        return cache;
+    }
+
+    void WiredTigerTicketController::_adjust(Holder* holder,
+                                             const Sample& sample,
+                                             const CacheState& cache) {
+        const int minTickets = static_cast<int>(std::max(1LL, getSetting(kMinTickets)));
+        const int maxTickets = static_cast<int>(std::max<long long>(minTickets,
+                                                                    getSetting(kMaxTickets)));
+        const int tickets = holder->tickets->outof();
+
+        Reason reason;
+        const int newTickets =
+            holder->policy.decide(tickets, sample, cache, minTickets, maxTickets, &reason);
+        if (newTickets == tickets) {
+            return;
+        }
+
+        invariantOK(holder->tickets->resize(newTickets));
+        holder->adjustments[reason].fetchAndAdd(1);
+
+        log() << "resizing " << holder->name << " from " << tickets << " to " << newTickets
+              << " (" << reasonName(reason) << "): " << sample.released
+              << " transactions finished, holding tickets for "
+              << (sample.released > 0 ? sample.heldMicros / sample.released : 0)
+              << " micros on average and queueing for " << sample.queuedMicros
+              << " micros in total; cache " << cache.bytesInUse << " of " << cache.bytesMax
+              << " bytes, " << cache.appEvictions << " pages evicted by application threads";
+    }
+
+}  // namespace mongo
@@ -0,0 +1,195 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <wiredtiger.h>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+    class PriorityTicketHolder;
+
+    /**
+     * Resizes the tickets which limit concurrent WiredTiger read and write transactions, in
+     * place of the fixed wiredTigerConcurrentReadTransactions and
+     * wiredTigerConcurrentWriteTransactions, to follow the workload. Disabled by default.
+     *
+     * Once per interval, each ticket holder is sized by its own Policy from what it did during
+     * the interval and from the state of the WiredTiger cache:
+     *  - while the cache is full enough for application threads to do eviction, the holder
+     *    shrinks by a quarter, since more concurrent transactions only make eviction harder;
+     *  - otherwise, if transactions queued for tickets, it grows by an eighth;
+     *  - an increase which neither raised the number of transactions finished per interval nor
+     *    kept the time they hold a ticket steady is undone, and the holder is left alone for a
+     *    while before growing again.
+     * The result is always kept within the minimum and maximum settings. Changes are logged and
+     * counted by reason. Setting the parameters for the tickets directly still works, and is
+     * where the controller carries on from.
+     */
+    class WiredTigerTicketController {
+        MONGO_DISALLOW_COPYING(WiredTigerTicketController);
+    public:
+        enum Setting {
+            kEnabled,
+            kMinTickets,
+            kMaxTickets,
+            kIntervalMillis,
+            kNumSettings
+        };
+
+        enum Reason {
+            kNone,
+            kQueued,
+            kNoGain,
+            kEvictionPressure,
+            kBounds,
+            kNumReasons
+        };
+
+        /**
+         * What one ticket holder did during an interval.
+         */
+        struct Sample {
+            long long queuedMicros;   // Time spent waiting for tickets.
+            long long released;       // Tickets released, i.e. transactions finished.
+            long long heldMicros;     // Time the released tickets were held.
+        };
+
+        /**
+         * The state of the WiredTiger cache at the end of an interval.
+         */
+        struct CacheState {
+            long long bytesInUse;
+            long long bytesMax;
+            long long appEvictions;   // Pages evicted by application threads in the interval.
+        };
+
+        /**
+         * Decides the size of one ticket holder, remembering whether its last increase is still
+         * to be judged.
+         */
+        class Policy {
+        public:
+            Policy();
+
+            /**
+             * Returns the number of tickets to use for the next interval, given the current
+             * number and the last interval, and sets "reason" to why it differs.
+             */
+            int decide(int tickets,
+                       const Sample& sample,
+                       const CacheState& cache,
+                       int minTickets,
+                       int maxTickets,
+                       Reason* reason);
+
+        private:
+            bool _judgingIncrease;
+            int _lastIncrease;
+            long long _releasedBeforeIncrease;
+            long long _heldMicrosBeforeIncrease;  // Average per ticket.
+            int _intervalsToHold;
+        };
+
+        /**
+         * Nothing runs until start() is called.
+         */
+        WiredTigerTicketController(WT_CONNECTION* conn,
+                                   PriorityTicketHolder* writeTickets,
+                                   PriorityTicketHolder* readTickets);
+        ~WiredTigerTicketController();
+
+        void start();
+
+        void shutdown();
+
+        long long getSetting(Setting setting) const;
+        void setSetting(Setting setting, long long value);
+
+        /**
+         * Returns the server parameter name of "setting".
+         */
+        static const char* settingName(Setting setting);
+
+        static const char* reasonName(Reason reason);
+
+        /**
+         * Appends the settings, and for each ticket holder its current size and the number of
+         * adjustments made to it for each reason.
+         */
+        void appendStats(BSONObjBuilder* builder) const;
+
+    private:
+        struct Totals {
+            long long queuedMicros = 0;
+            long long released = 0;
+            long long heldMicros = 0;
+        };
+
+        struct Holder {
+            const char* name;
+            PriorityTicketHolder* tickets;
+            Policy policy;                      // Only used by the controller thread.
+            Totals lastTotals;                  // Only used by the controller thread.
+            AtomicInt64 adjustments[kNumReasons];
+        };
+
+        void _run();
+
+        static Totals _readTotals(const PriorityTicketHolder& tickets);
+
+        CacheState _readCacheState(WT_SESSION* session);
+
+        /**
+         * Resizes "holder" as its Policy decides, and logs the change.
+         */
+        void _adjust(Holder* holder, const Sample& sample, const CacheState& cache);
+
+        WT_CONNECTION* const _conn;
+
+        enum { kWrite, kRead, kNumHolders };
+        Holder _holders[kNumHolders];
+
+        AtomicInt64 _settings[kNumSettings];
+
+        long long _lastAppEvictions;  // Only used by the controller thread.
+
+        stdx::thread _thread;
+        stdx::mutex _mutex;
+        stdx::condition_variable _cv;
+        bool _shuttingDown;  // Guarded by _mutex.
+    };
+
+}  // namespace mongo
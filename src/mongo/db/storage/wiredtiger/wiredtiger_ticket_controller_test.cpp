@@ -0,0 +1,167 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/priority_ticketholder.h"
+
+namespace mongo {
+namespace {
+
+    typedef WiredTigerTicketController Controller;
+
+    const int kMin = 16;
+    const int kMax = 256;
+
+    Controller::Sample makeSample(long long queuedMicros, long long released,
+                                  long long heldMicrosEach) {
+        Controller::Sample sample;
+        sample.queuedMicros = queuedMicros;
+        sample.released = released;
+        sample.heldMicros = released * heldMicrosEach;
+        return sample;
+    }
+
+    Controller::CacheState makeCache(int percentFull, long long appEvictions) {
+        Controller::CacheState cache;
+        cache.bytesMax = 1000;
+        cache.bytesInUse = percentFull * 10;
+        cache.appEvictions = appEvictions;
+        return cache;
+    }
+
+    TEST(WiredTigerTicketControllerTest, GrowsWhileTransactionsQueue) {
+        Controller::Policy policy;
+        Controller::Reason reason;
+
+        ASSERT_EQUALS(128, policy.decide(128, makeSample(0, 1000, 100), makeCache(50, 0),
+                                         kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kNone, reason);
+
+        ASSERT_EQUALS(144, policy.decide(128, makeSample(5000, 1000, 100), makeCache(50, 0),
+                                         kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kQueued, reason);
+
+        // More throughput keeps the increase, and growth goes on while transactions queue, up
+        // to the maximum.
+        ASSERT_EQUALS(162, policy.decide(144, makeSample(5000, 1100, 150), makeCache(50, 0),
+                                         kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kQueued, reason);
+        ASSERT_EQUALS(256, policy.decide(250, makeSample(5000, 1200, 150), makeCache(50, 0),
+                                         kMin, kMax, &reason));
+        ASSERT_EQUALS(256, policy.decide(256, makeSample(5000, 1300, 150), makeCache(50, 0),
+                                         kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kNone, reason);
+    }
+
+    TEST(WiredTigerTicketControllerTest, UndoesIncreasesWhichDontPayOff) {
+        Controller::Policy policy;
+        Controller::Reason reason;
+
+        ASSERT_EQUALS(144, policy.decide(128, makeSample(5000, 1000, 100), makeCache(50, 0),
+                                         kMin, kMax, &reason));
+
+        // The same throughput with transactions holding their tickets for longer.
+        ASSERT_EQUALS(128, policy.decide(144, makeSample(5000, 1000, 120), makeCache(50, 0),
+                                         kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kNoGain, reason);
+
+        // Left alone for a while, even though transactions still queue.
+        for (int i = 0; i < 10; i++) {
+            ASSERT_EQUALS(128, policy.decide(128, makeSample(5000, 1000, 100),
+                                             makeCache(50, 0), kMin, kMax, &reason));
+            ASSERT_EQUALS(Controller::kNone, reason);
+        }
+        ASSERT_EQUALS(144, policy.decide(128, makeSample(5000, 1000, 100), makeCache(50, 0),
+                                         kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kQueued, reason);
+
+        // Steady latency keeps an increase which didn't raise throughput.
+        ASSERT_EQUALS(162, policy.decide(144, makeSample(5000, 1000, 105), makeCache(50, 0),
+                                         kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kQueued, reason);
+    }
+
+    TEST(WiredTigerTicketControllerTest, ShrinksUnderEvictionPressure) {
+        Controller::Policy policy;
+        Controller::Reason reason;
+
+        ASSERT_EQUALS(96, policy.decide(128, makeSample(5000, 1000, 100), makeCache(95, 0),
+                                        kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kEvictionPressure, reason);
+
+        ASSERT_EQUALS(72, policy.decide(96, makeSample(5000, 1000, 100), makeCache(80, 10),
+                                        kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kEvictionPressure, reason);
+
+        ASSERT_EQUALS(kMin, policy.decide(20, makeSample(5000, 1000, 100), makeCache(99, 10),
+                                          kMin, kMax, &reason));
+        ASSERT_EQUALS(kMin, policy.decide(kMin, makeSample(5000, 1000, 100), makeCache(99, 10),
+                                          kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kNone, reason);
+
+        // Without the pressure, queued transactions grow the tickets again.
+        ASSERT_EQUALS(kMin + 2, policy.decide(kMin, makeSample(5000, 1000, 100),
+                                              makeCache(80, 0), kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kQueued, reason);
+    }
+
+    TEST(WiredTigerTicketControllerTest, KeepsWithinBounds) {
+        Controller::Policy policy;
+        Controller::Reason reason;
+
+        ASSERT_EQUALS(kMax, policy.decide(1000, makeSample(0, 1000, 100), makeCache(50, 0),
+                                          kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kBounds, reason);
+        ASSERT_EQUALS(kMin, policy.decide(1, makeSample(0, 1000, 100), makeCache(99, 10),
+                                          kMin, kMax, &reason));
+        ASSERT_EQUALS(Controller::kBounds, reason);
+    }
+
+    TEST(WiredTigerTicketControllerTest, Stats) {
+        PriorityTicketHolder writeTickets(10);
+        PriorityTicketHolder readTickets(20);
+        Controller controller(NULL, &writeTickets, &readTickets);
+        controller.setSetting(Controller::kEnabled, 1);
+
+        BSONObjBuilder builder;
+        controller.appendStats(&builder);
+        const BSONObj stats = builder.obj();
+        ASSERT_EQUALS(1, stats["settings"]["wiredTigerTicketControllerEnabled"].numberLong());
+        ASSERT_EQUALS(10, stats["wiredTigerConcurrentWriteTransactions"]["tickets"].numberInt());
+        ASSERT_EQUALS(20, stats["wiredTigerConcurrentReadTransactions"]["tickets"].numberInt());
+        ASSERT_EQUALS(0, stats["wiredTigerConcurrentReadTransactions"]["adjustments"]["queued"]
+                             .numberLong());
+    }
+
+}  // namespace
+}  // namespace mongo
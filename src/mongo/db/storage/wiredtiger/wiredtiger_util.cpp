@@ -39,6 +39,8 @@
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/platform/unordered_set.h"
@@ -46,11 +48,19 @@
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
     using std::string;
 
+    // The most bytes a touch reads into the cache per second, or 0 for no limit.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerTouchMaxBytesPerSecond, long long, 0);
+
+    namespace {
+        const long long kTouchEntriesPerPause = 4096;
+    } // namespace
+
     Status wtRCToStatus_slow(int retCode, const char* prefix ) {
         if (retCode == 0)
             return Status::OK();
@@ -289,6 +299,64 @@ namespace mongo {
         return result.getValue();
     }
 
+    void WiredTigerUtil::CacheResidency::appendTo(BSONObjBuilder* bob, double scale) const {
+        bob->appendNumber("bytesReadIntoCache",
+                          static_cast<long long>(bytesReadIntoCache / scale));
+        bob->appendNumber("bytesWrittenFromCache",
+                          static_cast<long long>(bytesWrittenFromCache / scale));
+        bob->appendNumber("pagesReadIntoCache", pagesReadIntoCache);
+        bob->appendNumber("pagesEvicted", pagesEvicted);
+    }
+
+    StatusWith<WiredTigerUtil::CacheResidency> WiredTigerUtil::getCacheResidency(
+            WT_SESSION* s,
+            const std::string& uri) {
+        invariant(s);
+        const std::string statsURI = "statistics:" + uri;
+        WT_CURSOR* cursor = NULL;
+        int ret = s->open_cursor(s, statsURI.c_str(), NULL, "statistics=(fast)", &cursor);
+        if (ret != 0) {
+            return StatusWith<CacheResidency>(ErrorCodes::CursorNotFound, str::stream()
+                << "unable to open cursor at URI " << statsURI
+                << ". reason: " << wiredtiger_strerror(ret));
+        }
+        invariant(cursor);
+        ON_BLOCK_EXIT(cursor->close, cursor);
+
+        const struct {
+            int key;
+            long long CacheResidency::*field;
+        } stats[] = {
+            {WT_STAT_DSRC_CACHE_BYTES_READ, &CacheResidency::bytesReadIntoCache},
+            {WT_STAT_DSRC_CACHE_BYTES_WRITE, &CacheResidency::bytesWrittenFromCache},
+            {WT_STAT_DSRC_CACHE_READ, &CacheResidency::pagesReadIntoCache},
+            {WT_STAT_DSRC_CACHE_EVICTION_CLEAN, &CacheResidency::pagesEvicted},
+            {WT_STAT_DSRC_CACHE_EVICTION_DIRTY, &CacheResidency::pagesEvicted},
+        };
+
+        CacheResidency residency;
+        for (auto&& stat : stats) {
+            cursor->set_key(cursor, stat.key);
+            ret = cursor->search(cursor);
+            if (ret != 0) {
+                return StatusWith<CacheResidency>(ErrorCodes::NoSuchKey, str::stream()
+                    << "unable to find key " << stat.key << " at URI " << statsURI
+                    << ". reason: " << wiredtiger_strerror(ret));
+            }
+
+            uint64_t value;
+            ret = cursor->get_value(cursor, NULL, NULL, &value);
+            if (ret != 0) {
+                return StatusWith<CacheResidency>(ErrorCodes::BadValue, str::stream()
+                    << "unable to get value for key " << stat.key << " at URI " << statsURI
+                    << ". reason: " << wiredtiger_strerror(ret));
+            }
+            residency.*stat.field += _castStatisticsValue<long long>(value);
+        }
+
+        return StatusWith<CacheResidency>(residency);
+    }
+
 namespace {
     int mdb_handle_error(WT_EVENT_HANDLER *handler, WT_SESSION *session,
                          int errorCode, const char *message) {
@@ -448,4 +516,34 @@ namespace {
         return Status::OK();
     }
 
+    WiredTigerTouchThrottle::WiredTigerTouchThrottle(OperationContext* txn)
+        : _txn(txn),
+          _numEntries(0),
+          _numBytes(0) {
+    }
+
+    bool WiredTigerTouchThrottle::hit(size_t bytes) {
+        _numEntries++;
+        _numBytes += bytes;
+        return _numEntries % kTouchEntriesPerPause == 0;
+    }
+
+    void WiredTigerTouchThrottle::pause() {
+        _txn->recoveryUnit()->abandonSnapshot();
+
+        const long long maxBytesPerSecond = wiredTigerTouchMaxBytesPerSecond;
+        if (maxBytesPerSecond > 0) {
+            const long long dueMillis = _numBytes * 1000 / maxBytesPerSecond;
+            const long long elapsedMillis = _timer.millis();
+            if (dueMillis > elapsedMillis) {
+                sleepmillis(dueMillis - elapsedMillis);
+            }
+        }
+
+        _txn->checkForInterrupt();
+
+        // Opens the new snapshot the caller's cursor goes on reading in.
+        WiredTigerRecoveryUnit::get(_txn)->getSession(_txn);
+    }
+
 }  // namespace mongo
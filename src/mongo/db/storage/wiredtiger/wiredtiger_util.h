@@ -38,6 +38,7 @@
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -166,6 +167,30 @@ namespace mongo {
 
         static int64_t getIdentSize(WT_SESSION* s, const std::string& uri );
 
+        /**
+         * Cache activity of a single table, from its statistics cursor. This version of
+         * WiredTiger doesn't count the bytes a table currently has in cache, so what has been read
+         * in and evicted is what shows a table's share of the cache.
+         */
+        struct CacheResidency {
+            long long bytesReadIntoCache = 0;
+            long long bytesWrittenFromCache = 0;
+            long long pagesReadIntoCache = 0;
+            long long pagesEvicted = 0;
+
+            /**
+             * Appends the fields above to 'bob', dividing the byte counts by 'scale'.
+             */
+            void appendTo(BSONObjBuilder* bob, double scale = 1) const;
+        };
+
+        /**
+         * Reads the cache statistics of the table at 'uri' with a single statistics cursor.
+         * Returns CursorNotFound if the table doesn't exist.
+         */
+        static StatusWith<CacheResidency> getCacheResidency(WT_SESSION* s,
+                                                            const std::string& uri);
+
         /**
          * Returns a WT_EVENT_HANDER with MongoDB's default handlers.
          * The default handlers just log so it is recommended that you consider calling them even if
@@ -201,6 +226,36 @@ namespace mongo {
         static T _castStatisticsValue(uint64_t statisticsValue, T maximumResultType);
     };
 
+    /**
+     * Paces a touch, a read of every entry of a table into the cache. Every few thousand
+     * entries it checks for interrupts, lets go of the snapshot so that a long scan doesn't keep
+     * old versions pinned in the cache, and sleeps to stay under
+     * wiredTigerTouchMaxBytesPerSecond.
+     */
+    class WiredTigerTouchThrottle {
+        MONGO_DISALLOW_COPYING(WiredTigerTouchThrottle);
+    public:
+        explicit WiredTigerTouchThrottle(OperationContext* txn);
+
+        /**
+         * Counts an entry just read. Returns true if the caller should pause(): save the
+         * cursor's key, pause() and search for the key again, as pausing resets the cursor.
+         */
+        bool hit(size_t bytes);
+
+        void pause();
+
+        long long numEntries() const { return _numEntries; }
+        long long numBytes() const { return _numBytes; }
+        long long millis() const { return _timer.millis(); }
+
+    private:
+        OperationContext* const _txn;
+        Timer _timer;
+        long long _numEntries;
+        long long _numBytes;
+    };
+
     class WiredTigerConfigParser {
         MONGO_DISALLOW_COPYING(WiredTigerConfigParser);
     public:
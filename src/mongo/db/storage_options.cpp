@@ -69,4 +69,26 @@ namespace mongo {
                                                      true,
                                                      true);
 
+    /**
+     * Number of threads which open the databases, and for KV engines the collections, at
+     * startup. 1 opens them one at a time.
+     */
+    ExportedServerParameter<int> StartupThreadsSetting(ServerParameterSet::getGlobal(),
+                                                       "storageStartupThreads",
+                                                       &storageGlobalParams.startupThreads,
+                                                       true,
+                                                       false);
+
+    /**
+     * If true, startup only opens the local database, so that connections are accepted sooner,
+     * and other databases and their collections are opened when they are first used. The startup
+     * checks of those databases are skipped, and their temporary collections are not dropped.
+     * Ignored by mmapv1, which has to check the file version of every database at startup.
+     */
+    ExportedServerParameter<bool> LazyOpenSetting(ServerParameterSet::getGlobal(),
+                                                  "storageLazyOpen",
+                                                  &storageGlobalParams.lazyOpen,
+                                                  true,
+                                                  false);
+
 } // namespace mongo
@@ -56,7 +56,9 @@ namespace mongo {
             repair(false),
             noTableScan(false),
             directoryperdb(false),
-            syncdelay(60.0) {
+            syncdelay(60.0),
+            startupThreads(8),
+            lazyOpen(false) {
             dur = false;
             if (sizeof(void*) == 8)
                 dur = true;
@@ -106,6 +108,12 @@ namespace mongo {
         // Do not set this value on production systems.
         // In almost every situation, you should use the default setting.
         double syncdelay;      // seconds between fsyncs
+
+        // Number of threads which open databases and collections at startup.
+        int startupThreads;
+
+        // Whether startup leaves databases and collections to be opened on first access.
+        bool lazyOpen;
     };
 
     extern StorageGlobalParams storageGlobalParams;
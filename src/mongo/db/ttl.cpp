@@ -34,6 +34,8 @@
 
 #include "mongo/db/ttl.h"
 
+#include <algorithm>
+
 #include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
@@ -57,6 +59,7 @@
 #include "mongo/util/background.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -69,16 +72,33 @@ namespace mongo {
 
     Counter64 ttlPasses;
     Counter64 ttlDeletedDocuments;
+    Counter64 ttlDeletedBatches;
+
+    // Documents found expired when their index was last visited by a pass and not deleted since.
+    // Counts index keys, so a document expired under several keys of an array counts that many
+    // times.
+    Counter64 ttlExpiredBacklog;
 
     ServerStatusMetricField<Counter64> ttlPassesDisplay("ttl.passes", &ttlPasses);
     ServerStatusMetricField<Counter64> ttlDeletedDocumentsDisplay("ttl.deletedDocuments", &ttlDeletedDocuments);
+    ServerStatusMetricField<Counter64> ttlDeletedBatchesDisplay("ttl.deletedBatches",
+                                                                &ttlDeletedBatches);
+    ServerStatusMetricField<Counter64> ttlExpiredBacklogDisplay("ttl.expiredBacklog",
+                                                                &ttlExpiredBacklog);
 
     MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorEnabled, bool, true );
     MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorSleepSecs, int, 60 ); //used for testing
 
+    // How many expired documents are deleted in one storage transaction.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorDeleteBatchSize, int, 100 );
+
+    // The most documents a pass deletes per second, or 0 for no limit. A pass sleeps between
+    // batches, with its locks released, to stay under the limit.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorMaxDeletesPerSec, int, 0 );
+
     class TTLMonitor : public BackgroundJob {
     public:
-        TTLMonitor(){}
+        TTLMonitor() : _passDeleted(0) {}
         virtual ~TTLMonitor(){}
 
         virtual string name() const { return "TTLMonitor"; }
@@ -133,6 +153,11 @@ namespace mongo {
 
             ttlPasses.increment();
 
+            // Each index's share of the backlog is counted afresh when this pass gets to it.
+            ttlExpiredBacklog.decrement(ttlExpiredBacklog.get());
+            _passTimer.reset();
+            _passDeleted = 0;
+
             for ( set<string>::const_iterator i=dbs.begin(); i!=dbs.end(); ++i ) {
                 string db = *i;
 
@@ -235,9 +260,32 @@ namespace mongo {
             // bounds after every WriteConflictException.
             const Date_t now = Date_t::now();
 
+            const size_t batchSize = std::max(ttlMonitorDeleteBatchSize, 1);
+
+            // Where the next batch starts. The index is scanned from the oldest key the first
+            // time, and from the last key deleted afterwards, so the keys of documents deleted by
+            // earlier batches are not walked over again.
+            const Date_t kDawnOfTime =
+                Date_t::fromMillisSinceEpoch(std::numeric_limits<long long>::min());
+            BSONObj startKey = BSON("" << kDawnOfTime);
+
             long long numDeleted = 0;
+            long long backlog = -1;
             int attempt = 1;
             while (1) {
+                // Stay under the pass's deletion rate, with no locks held.
+                if (ttlMonitorMaxDeletesPerSec > 0) {
+                    const long long dueMillis = _passDeleted * 1000 / ttlMonitorMaxDeletesPerSec;
+                    const long long elapsedMillis = _passTimer.millis();
+                    if (dueMillis > elapsedMillis) {
+                        sleepmillis(dueMillis - elapsedMillis);
+                    }
+                }
+
+                if (inShutdown()) {
+                    return false;
+                }
+
                 ScopedTransaction scopedXact(txn, MODE_IX);
                 AutoGetDb autoDb(txn, dbName, MODE_IX);
                 Database* db = autoDb.getDb();
@@ -286,9 +334,6 @@ namespace mongo {
                     return true;
                 }
 
-                const Date_t kDawnOfTime =
-                    Date_t::fromMillisSinceEpoch(std::numeric_limits<long long>::min());
-                const BSONObj startKey = BSON("" << kDawnOfTime);
                 const BSONObj endKey =
                     BSON("" << now - Seconds(secondsExpireElt.numberLong()));
                 const bool endKeyInclusive = true;
@@ -297,34 +342,40 @@ namespace mongo {
                 const InternalPlanner::Direction direction =
                     (key.firstElement().number() >= 0) ? InternalPlanner::Direction::FORWARD
                                                        : InternalPlanner::Direction::BACKWARD;
-                unique_ptr<PlanExecutor> exec(InternalPlanner::indexScan(txn,
-                                                                         collection,
-                                                                         desc,
-                                                                         startKey,
-                                                                         endKey,
-                                                                         endKeyInclusive,
-                                                                         direction));
-                exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
 
                 try {
+                    if (backlog < 0) {
+                        // The count yields, so our collection and index are only known to
+                        // still exist if it ran to the end. Start over with them looked up again.
+                        backlog = countExpiredKeys(txn, collection, desc, startKey, endKey,
+                                                   direction);
+                        ttlExpiredBacklog.increment(backlog);
+                        continue;
+                    }
+
+                    // The batch is collected without yielding, so that none of its documents can
+                    // change or go away before we delete them.
+                    unique_ptr<PlanExecutor> exec(InternalPlanner::indexScan(txn,
+                                                                             collection,
+                                                                             desc,
+                                                                             startKey,
+                                                                             endKey,
+                                                                             endKeyInclusive,
+                                                                             direction));
+
                     PlanExecutor::ExecState state;
                     BSONObj obj;
                     RecordId rid;
-                    while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &rid))) {
-                        exec->saveState();
-                        {
-                            WriteUnitOfWork wunit(txn);
-                            collection->deleteDocument(txn, rid);
-                            wunit.commit();
-                        }
-                        ++numDeleted;
-                        ttlDeletedDocuments.increment();
-                        if (!exec->restoreState(txn)) {
-                            return true;
-                        }
+                    BSONObj lastKey;
+                    vector<RecordId> batch;
+                    while (batch.size() < batchSize
+                            && PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &rid))) {
+                        batch.push_back(rid);
+                        lastKey = obj.getOwned();
                     }
 
-                    if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
+                    if (batch.size() < batchSize
+                            && (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state)) {
                         if (WorkingSetCommon::isValidStatusMemberObject(obj)) {
                             error() << "ttl query execution for index " << idx << " failed with: "
                                     << WorkingSetCommon::getMemberObjectStatus(obj);
@@ -335,8 +386,34 @@ namespace mongo {
                         return true;
                     }
 
-                    invariant(PlanExecutor::IS_EOF == state);
-                    break;
+                    if (!batch.empty()) {
+                        exec->saveState();
+
+                        WriteUnitOfWork wunit(txn);
+                        for (size_t i = 0; i < batch.size(); ++i) {
+                            collection->deleteDocument(txn, batch[i]);
+                        }
+                        wunit.commit();
+
+                        // Documents left under the last key come after the ones just deleted.
+                        startKey = lastKey;
+
+                        numDeleted += batch.size();
+                        _passDeleted += batch.size();
+                        ttlDeletedDocuments.increment(batch.size());
+                        ttlDeletedBatches.increment();
+
+                        const long long backlogDeleted =
+                            std::min(backlog, static_cast<long long>(batch.size()));
+                        backlog -= backlogDeleted;
+                        ttlExpiredBacklog.decrement(backlogDeleted);
+                    }
+
+                    if (batch.size() < batchSize) {
+                        invariant(PlanExecutor::IS_EOF == state);
+                        break;
+                    }
+                    attempt = 1;
                 }
                 catch (const WriteConflictException& dle) {
                     WriteConflictException::logAndBackoff(attempt++, "ttl", ns);
@@ -346,6 +423,39 @@ namespace mongo {
             LOG(1) << "\tTTL deleted: " << numDeleted << endl;
             return true;
         }
+
+        /**
+         * Counts the keys of 'desc' between 'startKey' and 'endKey' (inclusive), yielding as it
+         * goes.  Returns 0 if the scan was killed, in which case the caller's collection and index
+         * may be gone.
+         */
+        long long countExpiredKeys(OperationContext* txn,
+                                   Collection* collection,
+                                   IndexDescriptor* desc,
+                                   const BSONObj& startKey,
+                                   const BSONObj& endKey,
+                                   InternalPlanner::Direction direction) {
+            unique_ptr<PlanExecutor> exec(InternalPlanner::indexScan(txn,
+                                                                     collection,
+                                                                     desc,
+                                                                     startKey,
+                                                                     endKey,
+                                                                     true,
+                                                                     direction));
+            exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
+
+            long long count = 0;
+            PlanExecutor::ExecState state;
+            while (PlanExecutor::ADVANCED == (state = exec->getNext(NULL, NULL))) {
+                ++count;
+            }
+            return PlanExecutor::IS_EOF == state ? count : 0;
+        }
+
+        // When the current pass started, and how many documents it has deleted, for
+        // ttlMonitorMaxDeletesPerSec.
+        Timer _passTimer;
+        long long _passDeleted;
     };
 
     void startTTLBackgroundJob() {
@@ -556,6 +556,155 @@ namespace AccumulatorTests {
         
     } // namespace Max
 
+    namespace Push {
+
+        class Base : public AccumulatorTests::Base {
+        protected:
+            /** Creates a $push with the $sort and $slice in 'modifiers'. */
+            void createAccumulator( const BSONObj& modifiers ) {
+                _accumulator = AccumulatorPushSorted::parseModifiers( modifiers["$sort"],
+                                                                      modifiers["$slice"] )();
+                ASSERT_EQUALS(string("$push"), _accumulator->getOpName());
+            }
+            void processAll( const BSONArray& values ) {
+                BSONForEach( value, values ) {
+                    accumulator()->process(Value(value), false);
+                }
+            }
+            Accumulator *accumulator() { return _accumulator.get(); }
+        private:
+            intrusive_ptr<Accumulator> _accumulator;
+        };
+
+        /** $slice without $sort keeps the first values. */
+        class First : public Base {
+        public:
+            void run() {
+                createAccumulator( BSON( "$slice" << 2 ) );
+                processAll( BSON_ARRAY( 3 << 1 << 2 ) );
+                ASSERT_EQUALS( Value(BSON_ARRAY( 3 << 1 )), accumulator()->getValue(false) );
+            }
+        };
+
+        /** $sort and $slice keep the top values. */
+        class Top : public Base {
+        public:
+            void run() {
+                createAccumulator( BSON( "$sort" << -1 << "$slice" << 3 ) );
+                processAll( BSON_ARRAY( 5 << 1 << 9 << 3 << 7 ) );
+                ASSERT_EQUALS( Value(BSON_ARRAY( 9 << 7 << 5 )), accumulator()->getValue(false) );
+            }
+        };
+
+        /** $sort alone sorts all the values. */
+        class SortOnly : public Base {
+        public:
+            void run() {
+                createAccumulator( BSON( "$sort" << 1 ) );
+                processAll( BSON_ARRAY( 5 << 1 << 9 << "a" ) );
+                ASSERT_EQUALS( Value(BSON_ARRAY( 1 << 5 << 9 << "a" )),
+                               accumulator()->getValue(false) );
+            }
+        };
+
+        /** Documents are sorted by the fields of $sort, other values as if missing them. */
+        class SortByFields : public Base {
+        public:
+            void run() {
+                createAccumulator( fromjson( "{$sort: {'a.b': 1, c: -1}, $slice: 3}" ) );
+                processAll( BSON_ARRAY( fromjson( "{a: {b: 2}, c: 1}" )
+                                     << fromjson( "{a: {b: 1}, c: 1}" )
+                                     << fromjson( "{a: {b: 1}, c: 2}" )
+                                     << fromjson( "{c: 5}" )
+                                     << 7 ) );
+                ASSERT_EQUALS( Value(BSON_ARRAY( fromjson( "{c: 5}" ) << 7
+                                                 << fromjson( "{a: {b: 1}, c: 2}" ) )),
+                               accumulator()->getValue(false) );
+            }
+        };
+
+        /** Merging the capped arrays of several sources keeps the top values of all of them. */
+        class Merge : public Base {
+        public:
+            void run() {
+                createAccumulator( BSON( "$sort" << 1 << "$slice" << 2 ) );
+                processAll( BSON_ARRAY( 4 << 8 << 6 ) );
+                const Value first = accumulator()->getValue(true);
+                ASSERT_EQUALS( Value(BSON_ARRAY( 4 << 6 )), first );
+
+                accumulator()->reset();
+                processAll( BSON_ARRAY( 5 << 9 ) );
+                const Value second = accumulator()->getValue(true);
+
+                accumulator()->reset();
+                accumulator()->process(first, true);
+                accumulator()->process(second, true);
+                ASSERT_EQUALS( Value(BSON_ARRAY( 4 << 5 )), accumulator()->getValue(false) );
+            }
+        };
+
+        /** A capped $push holds on to the memory of only the kept values. */
+        class MemUsage : public Base {
+        public:
+            void run() {
+                const Value big (string(1000, 'x'));
+                intrusive_ptr<Accumulator> push = AccumulatorPush::create();
+                createAccumulator( BSON( "$slice" << 10 ) );
+                for ( int i = 0; i < 1000; i++ ) {
+                    push->process(big, false);
+                    accumulator()->process(big, false);
+                }
+                ASSERT_GREATER_THAN( push->memUsageForSorter(), 1000 * 1000 );
+                ASSERT_LESS_THAN( accumulator()->memUsageForSorter(), 20 * 1000 );
+
+                createAccumulator( BSON( "$sort" << 1 << "$slice" << 10 ) );
+                for ( int i = 0; i < 1000; i++ ) {
+                    accumulator()->process(Value(string(1000, 'a' + i % 26)), false);
+                }
+                ASSERT_LESS_THAN( accumulator()->memUsageForSorter(), 20 * 1000 );
+
+                // Duplicates add nothing to a set.
+                intrusive_ptr<Accumulator> set = AccumulatorAddToSet::create();
+                set->process(big, false);
+                const int usage = set->memUsageForSorter();
+                ASSERT_GREATER_THAN( usage, 1000 );
+                set->process(big, false);
+                ASSERT_EQUALS( usage, set->memUsageForSorter() );
+            }
+        };
+
+        /** The modifiers are serialized with the $push. */
+        class Serialize : public Base {
+        public:
+            void run() {
+                createAccumulator( fromjson( "{$sort: {a: -1}, $slice: 3}" ) );
+                ASSERT_EQUALS( fromjson( "{$push: '$x', $sort: {a: -1}, $slice: 3}" ),
+                               fromDocument( accumulator()->serialize(Value("$x")) ) );
+
+                intrusive_ptr<Accumulator> push = AccumulatorPush::create();
+                ASSERT_EQUALS( fromjson( "{$push: '$x'}" ),
+                               fromDocument( push->serialize(Value("$x")) ) );
+            }
+        };
+
+        /** Invalid modifiers are rejected. */
+        class BadModifiers : public Base {
+        public:
+            void run() {
+                ASSERT_THROWS( createAccumulator( BSON( "$slice" << 0 ) ), UserException );
+                ASSERT_THROWS( createAccumulator( BSON( "$slice" << 1.5 ) ), UserException );
+                ASSERT_THROWS( createAccumulator( BSON( "$slice" << "a" ) ), UserException );
+                ASSERT_THROWS( createAccumulator( BSON( "$sort" << 2 ) ), UserException );
+                ASSERT_THROWS( createAccumulator( BSON( "$sort" << BSONObj() ) ), UserException );
+                ASSERT_THROWS( createAccumulator( fromjson( "{$sort: {a: 'x'}}" ) ),
+                               UserException );
+                ASSERT_THROWS( createAccumulator( fromjson( "{$sort: {'$a': 1}}" ) ),
+                               UserException );
+            }
+        };
+
+    } // namespace Push
+
     namespace Sum {
 
         class Base : public AccumulatorTests::Base {
@@ -889,6 +1038,15 @@ namespace AccumulatorTests {
             add<Max::Two>();
             add<Max::LastMissing>();
 
+            add<Push::First>();
+            add<Push::Top>();
+            add<Push::SortOnly>();
+            add<Push::SortByFields>();
+            add<Push::Merge>();
+            add<Push::MemUsage>();
+            add<Push::Serialize>();
+            add<Push::BadModifiers>();
+
             add<Sum::None>();
             add<Sum::OneInt>();
             add<Sum::OneLong>();
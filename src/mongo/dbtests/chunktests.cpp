@@ -67,6 +67,7 @@ namespace mongo {
             }
             
             _chunkRanges.reloadAll(_chunkMap);
+            _routingTable.reloadAll(_chunkMap, _keyPattern);
         }
     };
     
@@ -246,6 +247,88 @@ namespace ChunkTests {
             }
         };
 
+        /** Each shard key is routed to the chunk of the shard it is paired with. */
+        class FindIntersectingChunkBase {
+        public:
+            virtual ~FindIntersectingChunkBase() {}
+            void run() {
+                ShardKeyPattern shardKeyPattern(shardKey());
+                ChunkManager chunkManager("", shardKeyPattern, false);
+                chunkManager.setSingleChunkForShards(splitPoints());
+
+                BSONObjIterator i(keysAndShardNames());
+                while (i.more()) {
+                    BSONObj keyAndShardName = i.next().Obj();
+                    BSONObj key = keyAndShardName["key"].Obj();
+                    ChunkPtr chunk = chunkManager.findIntersectingChunk(key);
+                    ASSERT_EQUALS(keyAndShardName["shard"].String(), chunk->getShardId());
+                }
+            }
+        protected:
+            virtual BSONObj shardKey() const = 0;
+            virtual vector<BSONObj> splitPoints() const = 0;
+            virtual BSONArray keysAndShardNames() const = 0;
+        };
+
+        class FindIntersectingChunkMixedTypes : public FindIntersectingChunkBase {
+            virtual BSONObj shardKey() const { return BSON( "a" << 1 ); }
+            virtual vector<BSONObj> splitPoints() const {
+                vector<BSONObj> ret;
+                ret.push_back( BSON( "a" << 5 ) );
+                ret.push_back( BSON( "a" << "x" ) );
+                ret.push_back( BSON( "a" << "y" ) );
+                return ret;
+            }
+            virtual BSONArray keysAndShardNames() const {
+                return BSON_ARRAY( BSON( "key" << BSON( "a" << MINKEY ) << "shard" << "0" ) <<
+                                   BSON( "key" << BSON( "a" << 4.5 ) << "shard" << "0" ) <<
+                                   BSON( "key" << BSON( "a" << 5.0 ) << "shard" << "1" ) <<
+                                   BSON( "key" << BSON( "a" << 6LL ) << "shard" << "1" ) <<
+                                   BSON( "key" << BSON( "a" << "w" ) << "shard" << "1" ) <<
+                                   BSON( "key" << BSON( "a" << "x" ) << "shard" << "2" ) <<
+                                   BSON( "key" << BSON( "a" << "xa" ) << "shard" << "2" ) <<
+                                   BSON( "key" << BSON( "a" << "y" ) << "shard" << "3" ) <<
+                                   BSON( "key" << BSON( "a" << true ) << "shard" << "3" ) );
+            }
+        };
+
+        class FindIntersectingChunkCompoundKey : public FindIntersectingChunkBase {
+            virtual BSONObj shardKey() const { return BSON( "a" << 1 << "b" << 1 ); }
+            virtual vector<BSONObj> splitPoints() const {
+                vector<BSONObj> ret;
+                ret.push_back( BSON( "a" << 5 << "b" << 10 ) );
+                ret.push_back( BSON( "a" << 5 << "b" << 20 ) );
+                return ret;
+            }
+            virtual BSONArray keysAndShardNames() const {
+                return BSON_ARRAY(
+                    BSON( "key" << BSON( "a" << 4 << "b" << 100 ) << "shard" << "0" ) <<
+                    BSON( "key" << BSON( "a" << 5 << "b" << 9 ) << "shard" << "0" ) <<
+                    BSON( "key" << BSON( "a" << 5 << "b" << 10 ) << "shard" << "1" ) <<
+                    BSON( "key" << BSON( "a" << 5 << "b" << "s" ) << "shard" << "2" ) <<
+                    BSON( "key" << BSON( "a" << 6 << "b" << MINKEY ) << "shard" << "2" ) );
+            }
+        };
+
+        class FindIntersectingChunkHashedKey : public FindIntersectingChunkBase {
+            virtual BSONObj shardKey() const { return BSON( "a" << "hashed" ); }
+            virtual vector<BSONObj> splitPoints() const {
+                vector<BSONObj> ret;
+                ret.push_back( BSON( "a" << -100LL ) );
+                ret.push_back( BSON( "a" << 0LL ) );
+                ret.push_back( BSON( "a" << 100LL ) );
+                return ret;
+            }
+            virtual BSONArray keysAndShardNames() const {
+                return BSON_ARRAY( BSON( "key" << BSON( "a" << MINKEY ) << "shard" << "0" ) <<
+                                   BSON( "key" << BSON( "a" << -101LL ) << "shard" << "0" ) <<
+                                   BSON( "key" << BSON( "a" << -100LL ) << "shard" << "1" ) <<
+                                   BSON( "key" << BSON( "a" << 0LL ) << "shard" << "2" ) <<
+                                   BSON( "key" << BSON( "a" << 50 ) << "shard" << "2" ) <<
+                                   BSON( "key" << BSON( "a" << 100LL ) << "shard" << "3" ) );
+            }
+        };
+
     } // namespace ChunkManagerTests
     
     class All : public Suite {
@@ -273,6 +356,9 @@ namespace ChunkTests {
             add<ChunkManagerTests::InequalityThenUnsatisfiable>();
             add<ChunkManagerTests::OrEqualityUnsatisfiableInequality>();
             add<ChunkManagerTests::InMultiShard>();
+            add<ChunkManagerTests::FindIntersectingChunkMixedTypes>();
+            add<ChunkManagerTests::FindIntersectingChunkCompoundKey>();
+            add<ChunkManagerTests::FindIntersectingChunkHashedKey>();
         }
     };
 
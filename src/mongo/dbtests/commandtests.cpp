@@ -32,6 +32,9 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/rpc/command_reply.h"
+#include "mongo/rpc/command_request_builder.h"
+#include "mongo/util/net/message.h"
 
 using namespace mongo;
 
@@ -248,6 +251,108 @@ namespace SymbolArgument {
 
 }  // SymbolArgument
 
+namespace InputDocs {
+    // Write commands sent as OP_COMMAND may carry their write operations as input documents
+    // following the command arguments, rather than as an array in the command object.
+
+    class Base {
+    public:
+        Base() : db(&_txn) {
+            db.dropCollection(ns());
+        }
+
+        const char* ns() { return "test.inputdocs"; }
+        const char* nsDb() { return "test"; }
+        const char* nsColl() { return "inputdocs"; }
+
+        BSONObj runWithInputDocs(const BSONObj& cmdObj, const std::vector<BSONObj>& inputDocs) {
+            rpc::CommandRequestBuilder requestBuilder;
+            requestBuilder.setDatabase(nsDb())
+                          .setCommandName(cmdObj.firstElementFieldName())
+                          .setMetadata(BSONObj())
+                          .setCommandArgs(cmdObj);
+            for (const BSONObj& doc : inputDocs) {
+                requestBuilder.addInputDoc(doc);
+            }
+            std::unique_ptr<Message> request = requestBuilder.done();
+
+            Message response;
+            ASSERT(db.call(*request, response));
+            return rpc::CommandReply(&response).getCommandReply().getOwned();
+        }
+
+        OperationContextImpl _txn;
+        DBDirectClient db;
+    };
+
+    class Insert : Base {
+    public:
+        void run() {
+            std::vector<BSONObj> docs;
+            for (int i = 0; i < 10; i++) {
+                docs.push_back(BSON("_id" << i));
+            }
+
+            BSONObj result = runWithInputDocs(BSON("insert" << nsColl()), docs);
+            ASSERT_EQUALS(1.0, result["ok"].numberDouble());
+            ASSERT_EQUALS(10, result["n"].numberInt());
+            ASSERT_EQUALS(10U, db.count(ns()));
+        }
+    };
+
+    class UpdateAndDelete : Base {
+    public:
+        void run() {
+            db.insert(ns(), BSON("_id" << 1 << "x" << 1));
+
+            std::vector<BSONObj> updates;
+            updates.push_back(BSON("q" << BSON("_id" << 1)
+                                    << "u" << BSON("$set" << BSON("x" << 2))));
+            updates.push_back(BSON("q" << BSON("_id" << 2) << "u" << BSON("x" << 3)
+                                    << "upsert" << true));
+            BSONObj result = runWithInputDocs(BSON("update" << nsColl()), updates);
+            ASSERT_EQUALS(1.0, result["ok"].numberDouble());
+            ASSERT_EQUALS(2, result["n"].numberInt());
+            ASSERT_EQUALS(2, db.findOne(ns(), BSON("_id" << 1))["x"].numberInt());
+            ASSERT_EQUALS(3, db.findOne(ns(), BSON("_id" << 2))["x"].numberInt());
+
+            std::vector<BSONObj> deletes;
+            deletes.push_back(BSON("q" << BSON("_id" << 1) << "limit" << 1));
+            result = runWithInputDocs(BSON("delete" << nsColl()), deletes);
+            ASSERT_EQUALS(1.0, result["ok"].numberDouble());
+            ASSERT_EQUALS(1, result["n"].numberInt());
+            ASSERT_EQUALS(1U, db.count(ns()));
+        }
+    };
+
+    class RejectsOpsInBothPlaces : Base {
+    public:
+        void run() {
+            std::vector<BSONObj> docs;
+            docs.push_back(BSON("_id" << 1));
+            BSONObj cmdObj = BSON("insert" << nsColl()
+                                  << "documents" << BSON_ARRAY(BSON("_id" << 2)));
+
+            BSONObj result = runWithInputDocs(cmdObj, docs);
+            ASSERT_EQUALS(0.0, result["ok"].numberDouble());
+            ASSERT_EQUALS(ErrorCodes::FailedToParse, result["code"].numberInt());
+            ASSERT_EQUALS(0U, db.count(ns()));
+        }
+    };
+
+    class RejectedByOtherCommands : Base {
+    public:
+        void run() {
+            std::vector<BSONObj> docs;
+            docs.push_back(BSON("_id" << 1));
+
+            BSONObj result = runWithInputDocs(BSON("count" << nsColl()), docs);
+            ASSERT_EQUALS(0.0, result["ok"].numberDouble());
+        }
+    };
+
+}  // InputDocs
+
     class All : public Suite {
     public:
         All() : Suite( "commands" ) {
@@ -262,6 +367,10 @@ namespace SymbolArgument {
             add< SymbolArgument::Touch >();
             add< SymbolArgument::Drop >();
             add< SymbolArgument::GeoSearch >();
+            add< InputDocs::Insert >();
+            add< InputDocs::UpdateAndDelete >();
+            add< InputDocs::RejectsOpsInBothPlaces >();
+            add< InputDocs::RejectedByOtherCommands >();
         }
 
     };
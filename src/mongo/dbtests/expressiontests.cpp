@@ -32,6 +32,7 @@
 
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_compiled.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace ExpressionTests {
@@ -887,6 +888,172 @@ namespace ExpressionTests {
         
     } // namespace Compare
     
+    namespace Compiled {
+
+        /**
+         * Checks that the compiled form of an expression returns the same results, of the same
+         * types, as the tree for each of a set of documents, and fails where the tree fails.
+         */
+        class ExpectedResultBase {
+        public:
+            virtual ~ExpectedResultBase() {}
+            void run() {
+                VariablesIdGenerator idGenerator;
+                VariablesParseState vps(&idGenerator);
+                BSONObj specObject = BSON("" << spec());
+                intrusive_ptr<Expression> tree =
+                        Expression::parseOperand(specObject.firstElement(), vps)->optimize();
+                intrusive_ptr<Expression> compiled = ExpressionCompiled::compile(tree);
+                ASSERT_EQUALS(expectCompiled(), compiled != tree);
+
+                const vector<BSONObj> inputs = documents();
+                for (size_t i = 0; i < inputs.size(); i++) {
+                    const Document doc(inputs[i]);
+                    bool treeFailed = false;
+                    BSONObj expected;
+                    try {
+                        expected = toBson(tree->evaluate(doc));
+                    }
+                    catch (const UserException&) {
+                        treeFailed = true;
+                    }
+
+                    if (treeFailed) {
+                        ASSERT_THROWS(compiled->evaluate(doc), UserException);
+                    }
+                    else {
+                        assertBinaryEqual(expected, toBson(compiled->evaluate(doc)));
+                    }
+                }
+            }
+        protected:
+            virtual BSONObj spec() = 0;
+            virtual vector<BSONObj> documents() = 0;
+            virtual bool expectCompiled() { return true; }
+        };
+
+        /** Inputs covering each type the compiled operations specialize, and some they don't. */
+        static vector<BSONObj> mixedDocuments() {
+            vector<BSONObj> docs;
+            docs.push_back(BSON("a" << 1 << "b" << 2));
+            docs.push_back(BSON("a" << 3 << "b" << 0));
+            docs.push_back(BSON("a" << numeric_limits<int>::max() << "b" << 1));
+            docs.push_back(BSON("a" << 5LL << "b" << 2));
+            docs.push_back(BSON("a" << 2.5 << "b" << -1.5));
+            docs.push_back(BSON("a" << 7 << "b" << 2.0));
+            docs.push_back(BSON("a" << "abc" << "b" << "aBd"));
+            docs.push_back(BSON("a" << true << "b" << false));
+            docs.push_back(BSON("a" << BSONNULL << "b" << 1));
+            docs.push_back(BSON("b" << 1));
+            docs.push_back(BSON("a" << Date_t::fromMillisSinceEpoch(1000) << "b" << 10));
+            docs.push_back(BSON("a" << BSON_ARRAY(1 << 2) << "b" << BSON("c" << 1)));
+            return docs;
+        }
+
+        class Arithmetic : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON("$add" << BSON_ARRAY(
+                                BSON("$multiply" << BSON_ARRAY("$a" << "$b" << 2))
+                                << BSON("$subtract" << BSON_ARRAY("$a" << "$b"))
+                                << 1));
+            }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        class Divide : public ExpectedResultBase {
+            BSONObj spec() { return BSON("$divide" << BSON_ARRAY("$a" << "$b")); }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        class Mod : public ExpectedResultBase {
+            BSONObj spec() { return BSON("$mod" << BSON_ARRAY("$a" << "$b")); }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        class Compare : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON("$and" << BSON_ARRAY(BSON("$gte" << BSON_ARRAY("$a" << "$b"))
+                                                 << BSON("$ne" << BSON_ARRAY("$a" << 3))));
+            }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        class Cmp : public ExpectedResultBase {
+            BSONObj spec() { return BSON("$cmp" << BSON_ARRAY("$a" << "$b")); }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        class OrNot : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON("$or" << BSON_ARRAY(BSON("$not" << BSON_ARRAY("$a"))
+                                                << BSON("$lt" << BSON_ARRAY("$b" << 1))));
+            }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        /** $and doesn't evaluate the operands after a false one, whose errors aren't raised. */
+        class ShortCircuit : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON("$and" << BSON_ARRAY("$b"
+                                                 << BSON("$divide" << BSON_ARRAY("$a" << "$b"))));
+            }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        class Cond : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON("$cond" << BSON_ARRAY(BSON("$gt" << BSON_ARRAY("$a" << "$b"))
+                                                  << BSON("$add" << BSON_ARRAY("$a" << 1))
+                                                  << "$b"));
+            }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        class IfNull : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON("$concat" << BSON_ARRAY(BSON("$ifNull" << BSON_ARRAY("$a" << "none"))
+                                                    << "-"
+                                                    << BSON("$toUpper" << BSON_ARRAY("$b"))));
+            }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        class Strings : public ExpectedResultBase {
+            BSONObj spec() {
+                return BSON("$concat" << BSON_ARRAY(
+                                BSON("$toLower" << BSON_ARRAY("$a"))
+                                << BSON("$substr" << BSON_ARRAY("$b" << 1 << 5))
+                                << BSON("$substr" << BSON_ARRAY("$a" << "$c" << 1))));
+            }
+            vector<BSONObj> documents() {
+                vector<BSONObj> docs;
+                docs.push_back(BSON("a" << "ABC" << "b" << "xyz" << "c" << 0));
+                docs.push_back(BSON("a" << "a very long string, stored out of line" << "b" << ""
+                                    << "c" << 40));
+                docs.push_back(BSON("a" << "\xc3\xa9t\xc3\xa9" << "b" << "\xc3\xa9t\xc3\xa9"
+                                    << "c" << 1.5));
+                docs.push_back(BSON("a" << "abc" << "b" << "xyz" << "c" << "1"));
+                docs.push_back(BSON("a" << BSONNULL << "c" << 2LL));
+                docs.push_back(BSON("a" << 12 << "b" << 3 << "c" << 1));
+                return docs;
+            }
+        };
+
+        /** Dates are left to the tree. */
+        class DateFallback : public ExpectedResultBase {
+            BSONObj spec() { return BSON("$add" << BSON_ARRAY("$a" << "$b" << 1)); }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+        };
+
+        /** An operation that isn't compiled is just evaluated through the tree. */
+        class SizeNotCompiled : public ExpectedResultBase {
+            BSONObj spec() { return BSON("$size" << BSON_ARRAY("$a")); }
+            vector<BSONObj> documents() { return mixedDocuments(); }
+            bool expectCompiled() { return false; }
+        };
+
+    } // namespace Compiled
+
     namespace Constant {
 
         /** Create an ExpressionConstant from a Value. */
@@ -3543,6 +3710,19 @@ namespace ExpressionTests {
             add<Compare::OptimizeGte>();
             add<Compare::OptimizeGteReverse>();
 
+            add<Compiled::Arithmetic>();
+            add<Compiled::Divide>();
+            add<Compiled::Mod>();
+            add<Compiled::Compare>();
+            add<Compiled::Cmp>();
+            add<Compiled::OrNot>();
+            add<Compiled::ShortCircuit>();
+            add<Compiled::Cond>();
+            add<Compiled::IfNull>();
+            add<Compiled::Strings>();
+            add<Compiled::DateFallback>();
+            add<Compiled::SizeNotCompiled>();
+
             add<Constant::Create>();
             add<Constant::CreateFromBsonElement>();
             add<Constant::Optimize>();
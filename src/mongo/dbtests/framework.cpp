@@ -111,7 +111,6 @@ namespace mongo {
         };
 
         int runDbTests(int argc, char** argv) {
-            frameworkGlobalParams.perfHist = 1;
             frameworkGlobalParams.seed = time( 0 );
             frameworkGlobalParams.runsPerTest = 1;
 
@@ -83,8 +83,8 @@ namespace mongo {
 
         options->addOptionChaining("runs", "runs", moe::Int, "number of times to run each test");
 
-        options->addOptionChaining("perfHist", "perfHist", moe::Unsigned,
-                "number of back runs of perf stats to display");
+        options->addOptionChaining("perfReport", "perfReport", moe::String,
+                "file to write the results of the perf suite to, as JSON");
 
         options->addOptionChaining("storage.engine", "storageEngine", moe::String,
                                    "what storage engine to use")
@@ -144,8 +144,8 @@ namespace mongo {
             frameworkGlobalParams.runsPerTest = params["runs"].as<int>();
         }
 
-        if (params.count("perfHist")) {
-            frameworkGlobalParams.perfHist = params["perfHist"].as<unsigned>();
+        if (params.count("perfReport")) {
+            frameworkGlobalParams.perfReportFile = params["perfReport"].as<std::string>();
         }
 
         bool nodur = false;
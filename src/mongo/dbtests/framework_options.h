@@ -43,7 +43,7 @@ namespace mongo {
     namespace moe = mongo::optionenvironment;
 
     struct FrameworkGlobalParams {
-        unsigned perfHist;
+        std::string perfReportFile;
         unsigned long long seed;
         int runsPerTest;
         std::string dbpathSpec;
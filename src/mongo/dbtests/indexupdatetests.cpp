@@ -461,6 +461,76 @@ namespace IndexUpdateTests {
         }
     };
 
+    /** A hybrid build applies the writes made while it was in progress. */
+    class InsertBuildHybridSideWrites : public IndexBuildBase {
+    public:
+        void run() {
+            // Create a new collection.
+            Database* db = _ctx.db();
+            Collection* coll;
+            RecordId loc1;
+            {
+                WriteUnitOfWork wunit(&_txn);
+                db->dropCollection( &_txn, _ns );
+                coll = db->createCollection( &_txn, _ns );
+
+                for ( int i = 1; i <= 10; i++ ) {
+                    StatusWith<RecordId> swLoc =
+                        coll->insertDocument( &_txn, BSON( "_id" << i << "a" << i ), true );
+                    ASSERT_OK( swLoc.getStatus() );
+                    if ( i == 1 )
+                        loc1 = swLoc.getValue();
+                }
+                wunit.commit();
+            }
+
+            MultiIndexBlock indexer(&_txn, coll);
+            indexer.allowBackgroundBuilding();
+            indexer.allowHybridBuilding();
+            indexer.allowInterruption();
+
+            const BSONObj spec = BSON("name" << "a"
+                                   << "ns" << coll->ns().ns()
+                                   << "key" << BSON("a" << 1)
+                                   << "background" << true);
+
+            ASSERT_OK(indexer.init(spec));
+            ASSERT(indexer.getBuildHybrid());
+
+            // Writes made before the collection scan are seen by it and captured as well.
+            {
+                WriteUnitOfWork wunit(&_txn);
+                ASSERT_OK( coll->insertDocument( &_txn, BSON( "_id" << 11 << "a" << 11 ),
+                                                 true ).getStatus() );
+                coll->deleteDocument( &_txn, loc1 );
+                wunit.commit();
+            }
+            {
+                // Rolled back
+                WriteUnitOfWork wunit(&_txn);
+                ASSERT_OK( coll->insertDocument( &_txn, BSON( "_id" << 12 << "a" << 12 ),
+                                                 true ).getStatus() );
+            }
+
+            ASSERT_OK(indexer.insertAllDocumentsInCollection());
+            ASSERT_OK(indexer.drainSideWrites());
+
+            WriteUnitOfWork wunit(&_txn);
+            indexer.commit();
+            wunit.commit();
+
+            IndexDescriptor* desc = coll->getIndexCatalog()->findIndexByName( &_txn, "a" );
+            ASSERT( desc );
+            IndexAccessMethod* iam = coll->getIndexCatalog()->getIndex( desc );
+            int64_t numKeys;
+            ASSERT_OK( iam->validate( &_txn, false, &numKeys, NULL ) );
+            ASSERT_EQUALS( 10, numKeys );
+            ASSERT( iam->findSingle( &_txn, BSON( "" << 1 ) ).isNull() );
+            ASSERT( !iam->findSingle( &_txn, BSON( "" << 11 ) ).isNull() );
+            ASSERT( iam->findSingle( &_txn, BSON( "" << 12 ) ).isNull() );
+        }
+    };
+
     /** Index creation is killed if mayInterrupt is true. */
     class InsertBuildIndexInterrupt : public IndexBuildBase {
     public:
@@ -918,6 +988,7 @@ namespace IndexUpdateTests {
             add<InsertBuildEnforceUnique<false> >();
             add<InsertBuildFillDups<true> >();
             add<InsertBuildFillDups<false> >();
+            add<InsertBuildHybridSideWrites>();
             add<InsertBuildIndexInterrupt>();
             add<InsertBuildIndexInterruptDisallowed>();
             add<InsertBuildIdIndexInterrupt>();
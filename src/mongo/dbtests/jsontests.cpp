@@ -758,6 +758,50 @@ namespace JsonTests {
             }
         };
 
+        class IntegerLimits : public Base {
+            virtual BSONObj bson() const {
+                BSONObjBuilder b;
+                b.append( "a", std::numeric_limits<int>::max() );
+                b.append( "b", std::numeric_limits<int>::min() );
+                b.append( "c", 2147483648LL );
+                b.append( "d", -2147483649LL );
+                b.append( "e", 999999999999999999LL );
+                b.append( "f", 1000000000000000000LL );
+                b.append( "g", -9223372036854775807LL );
+                b.append( "h", 0 );
+                b.append( "i", 7 );
+                b.append( "j", strtod( "1e3", 0 ) );
+                return b.obj();
+            }
+            virtual string json() const {
+                return "{ \"a\" : 2147483647, \"b\" : -2147483648, \"c\" : 2147483648, "
+                       "\"d\" : -2147483649, \"e\" : 999999999999999999, "
+                       "\"f\" : 1000000000000000000, \"g\" : -9223372036854775807, "
+                       "\"h\" : -0, \"i\" : 007, \"j\" : 1e3 }";
+            }
+        };
+
+        class ManyStrings : public Base {
+            virtual BSONObj bson() const {
+                BSONObjBuilder b;
+                b.append( "plain", "abc def" );
+                b.append( "escaped", "abc\ndef\"" );
+                b.append( "empty", "" );
+                b.append( "single", "it's" );
+                b.append( "_$mixed1", "\xc3\xa9t\xc3\xa9" );
+                BSONObjBuilder sub( b.subobjStart( "sub" ) );
+                sub.append( "x", "y" );
+                sub.append( "n", 12 );
+                sub.done();
+                return b.obj();
+            }
+            virtual string json() const {
+                return "{ plain : \"abc def\", escaped: \"abc\\ndef\\\"\", \"empty\":\"\","
+                       "single : \"it's\", _$mixed1 : '\xc3\xa9t\xc3\xa9',"
+                       "sub:{x:'y',n:12} }";
+            }
+        };
+
         class TwoElements : public Base {
             virtual BSONObj bson() const {
                 BSONObjBuilder b;
@@ -2729,6 +2773,8 @@ namespace JsonTests {
             add< FromJsonTests::SingleNumber >();
             add< FromJsonTests::RealNumber >();
             add< FromJsonTests::FancyNumber >();
+            add< FromJsonTests::IntegerLimits >();
+            add< FromJsonTests::ManyStrings >();
             add< FromJsonTests::TwoElements >();
             add< FromJsonTests::Subobject >();
             add< FromJsonTests::DeeplyNestedObject >();
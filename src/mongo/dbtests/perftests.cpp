@@ -38,7 +38,6 @@
 
 #include "mongo/platform/basic.h"
 
-#include <boost/filesystem/operations.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/version.hpp>
@@ -47,42 +46,70 @@
 #include <fstream>
 #include <mutex>
 
+#include "mongo/bson/bson_validate.h"
 #include "mongo/config.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/and_hash.h"
+#include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/index_scan.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/exec/sort.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/geo/geometry_container.h"
+#include "mongo/db/geo/hash.h"
+#include "mongo/db/geo/r2_region_coverer.h"
 #include "mongo/db/json.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/expression_index_knobs.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/db/storage/mmap_v1/btree/key.h"
 #include "mongo/db/storage/mmap_v1/compress.h"
 #include "mongo/db/storage/mmap_v1/durable_mapped_file.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
+#include "mongo/platform/random.h"
 #include "mongo/util/allocator.h"
 #include "mongo/util/checksum.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log.h"
+#include "mongo/util/string_map.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/version.h"
+#include "mongo/util/net/sock.h"
 #include "mongo/db/concurrency/lock_state.h"
 
 namespace PerfTests {
 
+    using boost::intrusive_ptr;
     using std::shared_ptr;
     using std::cout;
     using std::endl;
     using std::fixed;
-    using std::ifstream;
     using std::left;
     using std::min;
     using std::right;
     using std::setprecision;
     using std::setw;
     using std::string;
+    using std::unique_ptr;
     using std::vector;
 
     const bool profiling = false;
@@ -115,74 +142,8 @@ namespace PerfTests {
         DBDirectClient _client;
     };
 
-    /* if you want recording of the timings, place the password for the perf database
-        in ./../settings.py:
-            pstatspassword="<pwd>"
-    */
-    static std::shared_ptr<DBClientConnection> conn;
-    static string _perfhostname;
-    void pstatsConnect() {
-        // no writing to perf db if this is a debug build
-        DEV return;
-
-        const char *fn = "../../settings.py";
-        if( !boost::filesystem::exists(fn) ) {
-            if( boost::filesystem::exists("settings.py") )
-                fn = "settings.py";
-            else {
-                cout << "no ../../settings.py or ./settings.py file found. will not write perf stats to pstats db." << endl;
-                cout << "it is recommended this be enabled even on dev boxes" << endl;
-                return;
-            }
-        }
-
-        try {
-            if( conn == 0 ) {
-                MemoryMappedFile f;
-                const char *p = (const char *) f.mapWithOptions(fn, MongoFile::READONLY);
-                string pwd;
-
-                {
-                    const char *q = str::after(p, "pstatspassword=\"");
-                    if( *q == 0 ) {
-                        cout << "info perftests.cpp: no pstatspassword= in settings.py" << endl;
-                        return;
-                    }
-                    else {
-                        pwd = str::before(q, '\"');
-                    }
-                }
-
-                std::shared_ptr<DBClientConnection> c(new DBClientConnection(false, 60));
-                string err;
-                if( c->connect(HostAndPort("perfdb.10gen.cc"), err) ) {
-                    if( !c->auth("perf", "perf", pwd, err) ) {
-                        cout << "info: authentication with stats db failed: " << err << endl;
-                        verify(false);
-                    }
-                    conn = c;
-
-                    // override the hostname with the buildbot hostname, if present
-                    ifstream hostf( "../../info/host" );
-                    if ( hostf.good() ) {
-                        char buf[1024];
-                        hostf.getline(buf, sizeof(buf));
-                        _perfhostname = buf;
-                    }
-                    else {
-                        _perfhostname = getHostName();
-                    }
-                }
-                else {
-                    cout << err << " (to log perfstats)" << endl;
-                }
-            }
-        }
-        catch(...) { 
-            cout << "pstatsConnect() didn't work; ignoring" << endl;
-        }
-    }
-
+    // The results of every test run, which All writes to --perfReport.
+    static vector<BSONObj> perfResults;
 
     class B : public ClientBase {
         string _ns;
@@ -217,90 +178,95 @@ namespace PerfTests {
     public:
         virtual unsigned batchSize() { return 50; }
 
-        void say(unsigned long long n, long long us, string s) {
-            unsigned long long rps = (n*1000*1000)/(us > 0 ? us : 1);
-            cout << "stats " << setw(42) << left << s << ' ' << right << setw(9) << rps << ' ' << right << setw(5) << us/1000 << "ms ";
+        // Each test is timed this many times after warming up, to tell how much it varies.
+        static const int kRepetitions = 5;
+
+        /**
+         * Prints the median rate of the repetitions 'rates' of test 's', which took 'us' in all,
+         * and how much the rates vary. Keeps all of it for the report.
+         */
+        void say(const vector<double>& rates, long long us, const string& s) {
+            vector<double> sorted(rates);
+            std::sort(sorted.begin(), sorted.end());
+            const size_t n = sorted.size();
+            const double median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+            double mean = 0;
+            for (size_t i = 0; i < n; i++) {
+                mean += sorted[i];
+            }
+            mean /= n;
+            double variance = 0;
+            for (size_t i = 0; i < n; i++) {
+                variance += (sorted[i] - mean) * (sorted[i] - mean);
+            }
+            const double stddev = n > 1 ? sqrt(variance / (n - 1)) : 0;
+
+            cout << "stats " << setw(42) << left << s << ' ' << right << setw(9)
+                 << (unsigned long long) median << ' ' << right << setw(5)
+                 << fixed << setprecision(1) << (mean > 0 ? 100 * stddev / mean : 0) << "% "
+                 << right << setw(5) << us/1000 << "ms ";
             if (showDurStats()) {
                 cout << dur::stats.curr()->_asCSV();
             }
             cout << endl;
 
-            if( conn && !conn->isFailed() ) {
-                const char *ns = "perf.pstats";
-                if(frameworkGlobalParams.perfHist) {
-                    static bool needver = true;
-                    try {
-                        // try to report rps from last time */
-                        Query q;
-                        {
-                            BSONObjBuilder b;
-                            b.append("host", _perfhostname);
-                            b.append("test", s);
-                            b.append("dur", storageGlobalParams.dur);
-                            DEV { b.append("info.DEBUG",true); }
-                            else b.appendNull("info.DEBUG");
-                            if( sizeof(int*) == 4 )
-                                b.append("info.bits", 32);
-                            else
-                                b.appendNull("info.bits");
-                            q = Query(b.obj()).sort("when",-1);
-                        }
-                        BSONObj fields = BSON( "rps" << 1 << "info" << 1 );
-                        vector<BSONObj> v;
-                        conn->findN(v, ns, q, frameworkGlobalParams.perfHist, 0, &fields);
-                        for( vector<BSONObj>::iterator i = v.begin(); i != v.end(); i++ ) {
-                            BSONObj o = *i;
-                            double lastrps = o["rps"].Number();
-                            if( 0 && lastrps ) {
-                                cout << "stats " << setw(42) << right << "new/old:" << ' ' << setw(9);
-                                cout << fixed << setprecision(2) << rps / lastrps;
-                                if( needver ) {
-                                    cout << "         " << o.getFieldDotted("info.git").toString();
-                                }
-                                cout << '\n';
-                            }
-                        }
-                    } catch(...) { }
-                    cout.flush();
-                    needver = false;
+            BSONObjBuilder b;
+            b.append("test", s);
+            b.append("repetitions", static_cast<int>(n));
+            b.append("millis", us/1000);
+            BSONObjBuilder rps(b.subobjStart("opsPerSecond"));
+            rps.append("median", median);
+            rps.append("mean", mean);
+            rps.append("min", sorted.front());
+            rps.append("max", sorted.back());
+            rps.append("stddev", stddev);
+            rps.done();
+            if (showDurStats() && storageGlobalParams.dur) {
+                b.append("durStats", dur::stats.asObj());
+            }
+            perfResults.push_back(b.obj());
+        }
+
+        /**
+         * Runs timed(), or timed2() if 'second', in batches for at least 'millis'. Returns how
+         * many times it ran.
+         */
+        unsigned long long runFor(bool second, int millis) {
+            const unsigned int Batch = batchSize();
+            mongo::Timer t;
+            unsigned long long n = 0;
+            do {
+                if (second) {
+                    for (unsigned int i = 0; i < Batch; i++)
+                        timed2(client());
                 }
-                {
-                    bob b;
-                    b.append("host", _perfhostname);
-                    b.appendTimeT("when", time(0));
-                    b.append("test", s);
-                    b.append("rps", (int) rps);
-                    b.append("millis", us/1000);
-                    b.appendBool("dur", storageGlobalParams.dur);
-                    if (showDurStats() && storageGlobalParams.dur) {
-                        b.append("durStats", dur::stats.asObj());
-                    }
-
-                    {
-                        bob inf;
-                        inf.append("version", versionString);
-                        if( sizeof(int*) == 4 ) inf.append("bits", 32);
-                        DEV inf.append("DEBUG", true);
-#if defined(_WIN32)
-                        inf.append("os", "win");
-#endif
-                        inf.append("git", gitVersion());
-#ifdef MONGO_CONFIG_SSL
-                        inf.append("OpenSSL", openSSLVersion());
-#endif
-                        inf.append("boost", BOOST_VERSION);
-                        b.append("info", inf.obj());
-                    }
-                    BSONObj o = b.obj();
-                    //cout << "inserting " << o.toString() << endl;
-                    try {
-                        conn->insert(ns, o);
-                    }
-                    catch ( std::exception& e ) {
-                        warning() << "couldn't save perf results: " << e.what() << endl;
-                    }
+                else {
+                    for (unsigned int i = 0; i < Batch; i++)
+                        timed();
                 }
+                n += Batch;
+            } while (t.micros() < (millis * 1000LL));
+            return n;
+        }
+
+        /**
+         * Warms up for a tenth of 'millis', then spends 'millis' timing kRepetitions runs of
+         * timed(), or timed2() if 'second', and reports their rates as test 's'.
+         */
+        void measure(bool second, int millis, const string& s) {
+            runFor(second, millis / 10);
+            client()->getLastError();
+            dur::stats.curr()->reset();
+
+            vector<double> rates;
+            mongo::Timer total;
+            for (int rep = 0; rep < kRepetitions; rep++) {
+                mongo::Timer t;
+                const unsigned long long n = runFor(second, millis / kRepetitions);
+                client()->getLastError(); // block until all ops are finished
+                rates.push_back(n * 1000.0 * 1000.0 / std::max(t.micros(), 1LL));
             }
+            say(rates, total.micros(), s);
         }
 
         /** if true runs timed2() again with several threads (8 at time of this writing).
@@ -317,52 +283,28 @@ namespace PerfTests {
         }
 
         void run() {
-
-            unsigned long long n = 0;
-
             _ns = string("perftest.") + name();
             client()->dropCollection(ns());
             prep();
             int hlm = howLong();
-            mongo::Timer t;
-            n = 0;
-            const unsigned int Batch = batchSize();
 
             if( hlm == 0 ) {
                 // means just do once
+                mongo::Timer t;
                 timed();
+                client()->getLastError(); // block until all ops are finished
+                long long us = t.micros();
+                say(vector<double>(1, 1000.0 * 1000.0 / std::max(us, 1LL)), us, name());
             }
             else {
-                do {
-                    unsigned int i;
-                    for( i = 0; i < Batch; i++ )
-                        timed();
-                    n += i;
-                } while( t.micros() < (hlm * 1000) );
+                measure(false, hlm, name());
             }
 
-            client()->getLastError(); // block until all ops are finished
-
-            say(n, t.micros(), name());
-
             post();
 
             string test2name = name2();
-            {
-                if( test2name != name() ) {
-                    dur::stats.curr()->reset();
-                    mongo::Timer t;
-                    unsigned long long n = 0;
-                    while( 1 ) {
-                        unsigned int i;
-                        for( i = 0; i < Batch; i++ )
-                            timed2(client());
-                        n += i;
-                        if( t.millis() > hlm )
-                            break;
-                    }
-                    say(n, t.micros(), test2name);
-                }
+            if( test2name != name() ) {
+                measure(true, hlm, test2name);
             }
 
             if( testThreaded() ) {
@@ -370,7 +312,9 @@ namespace PerfTests {
                 //cout << "testThreaded nThreads:" << nThreads << endl;
                 mongo::Timer t;
                 const unsigned long long result = launchThreads(nThreads);
-                say(result/nThreads, t.micros(), test2name+"-threaded");
+                long long us = t.micros();
+                say(vector<double>(1, (result / nThreads) * 1000.0 * 1000.0 / std::max(us, 1LL)),
+                    us, test2name+"-threaded");
             }
         }
 
@@ -442,6 +386,280 @@ namespace PerfTests {
         }
     };
 
+    /** validateBSON over insert-sized documents, as done for every inbound message with objcheck */
+    class ValidateBSON : public NonDurTest {
+    public:
+        int n;
+        bo b;
+        string name() { return "validateBSON"; }
+        ValidateBSON() {
+            n = 0;
+            bob o;
+            o.append("_id", OID::gen());
+            o.append("customerName", "a customer name of typical length");
+            o.appendDate("createdAt", Date_t::now());
+            for( int i = 0; i < 20; i++ ) {
+                bob item(o.subobjStart(BSONObjBuilder::numStr(i)));
+                item.append("sku", i * 7919);
+                item.append("description", "an item description that takes a little room");
+                item.append("price", i * 1.25);
+                item.append("quantity", (long long) i);
+                item.appendBool("inStock", i % 3 != 0);
+                bob tags(item.subarrayStart("tags"));
+                tags.append("0", "red");
+                tags.append("1", "large");
+                tags.done();
+                item.done();
+            }
+            b = o.obj();
+            verify( b.objsize() > 2048 && b.objsize() < 4096 );
+        }
+        void timed() {
+            if( validateBSON(b.objdata(), b.objsize()).isOK() )
+                n++;
+        }
+    };
+
+    class FromJson : public NonDurTest {
+    public:
+        int n;
+        string json;
+        string name() { return "fromjson"; }
+        FromJson() {
+            n = 0;
+            mongo::StringBuilder s;
+            s << "{ \"_id\" : { \"$oid\" : \"" << OID::gen().toString() << "\" }, "
+              << "\"customerName\" : \"a customer name of typical length\", "
+              << "\"createdAt\" : { \"$date\" : 1420070400000 }, \"items\" : [ ";
+            for( int i = 0; i < 20; i++ ) {
+                if( i )
+                    s << ", ";
+                s << "{ sku : " << i * 7919 << ", "
+                  << "description : \"an item description that takes a little room\", "
+                  << "price : " << i * 1.25 << ", "
+                  << "quantity : { \"$numberLong\" : \"" << i << "\" }, "
+                  << "inStock : " << (i % 3 != 0 ? "true" : "false") << ", "
+                  << "tags : [ \"red\", \"large\" ] }";
+            }
+            s << " ] }";
+            json = s.str();
+        }
+        void timed() {
+            if( fromjson(json).nFields() == 4 )
+                n++;
+        }
+    };
+
+    /** build and throw away a reply sized buffer, as each request does */
+    template <class Builder>
+    class BuildReply : public NonDurTest {
+    public:
+        int n;
+        BSONObj doc;
+        string name() {
+            return Builder::pooled ? "buildreply-pooled" : "buildreply";
+        }
+        BuildReply() : n(0), doc(BSON("ok" << 1 << "payload" << string(3000, 'x'))) { }
+        void timed() {
+            typename Builder::type b(512);
+            for( int i = 0; i < 4; i++ )
+                b.appendBuf(doc.objdata(), doc.objsize());
+            n += b.len();
+        }
+    };
+    struct MallocBuilder { typedef BufBuilder type; static const bool pooled = false; };
+    struct PooledBuilder { typedef PooledBufBuilder type; static const bool pooled = true; };
+
+    /** look up database names, as DatabaseHolder::get does for each operation */
+    template <class Map>
+    class DBNameLookup : public NonDurTest {
+    public:
+        int n;
+        Map m;
+        string names[64];
+        string name() {
+            return Map::flat ? "dbname-lookup-flat" : "dbname-lookup";
+        }
+        DBNameLookup() : n(0) {
+            for( int i = 0; i < 64; i++ ) {
+                names[i] = str::stream() << "db" << i;
+                if( i % 2 == 0 )
+                    m.map[names[i]] = i;
+            }
+        }
+        void timed() {
+            for( int i = 0; i < 64; i++ ) {
+                if( m.map.find(names[i]) != m.map.end() )
+                    n++;
+            }
+        }
+    };
+    struct UnorderedDBMap { StringMap<int> map; static const bool flat = false; };
+    struct FlatDBMap { FlatStringMap<int> map; static const bool flat = true; };
+
+    // hashing the points of a legacy 2d index
+    class GeoHashPoints : public NonDurTest {
+    public:
+        unsigned x, y;
+        long long n;
+        string name() { return "GeoHash-points"; }
+        GeoHashPoints() : x(0x12345678), y(0x9abcdef0), n(0) { }
+        void timed() {
+            for( int i = 0; i < 64; i++ ) {
+                GeoHash h(x, y, 26);
+                n += h.getHash();
+                unsigned ux, uy;
+                h.unhash(&ux, &uy);
+                x = ux * 2654435761U + 1;
+                y = uy ^ x;
+            }
+        }
+    };
+
+    // covering a $within:$box query on a legacy 2d index, as ExpressionMapping::cover2d does
+    class R2BoxCovering : public NonDurTest {
+    public:
+        GeometryContainer box;
+        GeoHashConverter::Parameters params;
+        size_t n;
+        string name() { return "R2RegionCoverer-box"; }
+        R2BoxCovering() : n(0) {
+            BSONObj q = fromjson("{$box: [[-73.99, 40.73], [-73.95, 40.77]]}");
+            verify(box.parseFromQuery(q.firstElement()).isOK());
+            verify(GeoHashConverter::parseParameters(BSONObj(), &params).isOK());
+        }
+        void timed() {
+            GeoHashConverter converter(params);
+            R2RegionCoverer coverer(&converter);
+            coverer.setMaxLevel(converter.getBits());
+            coverer.setMaxCells(internalGeoPredicateQuery2DMaxCoveringCells);
+            vector<GeoHash> covering;
+            coverer.getCovering(box.getR2Region(), &covering);
+            n += covering.size();
+        }
+    };
+
+    // encoding and decoding a compound index key
+    class KeyStringRoundTrip : public NonDurTest {
+    public:
+        BSONObj key;
+        Ordering ord;
+        size_t n;
+        string name() { return "KeyString-roundtrip"; }
+        KeyStringRoundTrip()
+            : key(BSON("" << 12345 << "" << "a string a string" << "" << 3.25)),
+              ord(Ordering::make(BSON("a" << 1 << "b" << -1 << "c" << 1))),
+              n(0) { }
+        void timed() {
+            KeyString ks(key, ord);
+            n += KeyString::toBson(ks.getBuffer(), ks.getSize(), ord, ks.getTypeBits()).objsize();
+        }
+    };
+
+    // matching a document against a query's filter
+    class MatcherMatch : public NonDurTest {
+    public:
+        BSONObj query, doc;
+        unique_ptr<MatchExpression> expr;
+        size_t n;
+        string name() { return "MatchExpression-match"; }
+        MatcherMatch() : n(0) {
+            query = fromjson("{a: {$gt: 5}, b: 'abc', 'c.d': {$in: [1, 2, 3]},"
+                             " e: {$exists: true}}");
+            StatusWithMatchExpression swme = MatchExpressionParser::parse(query);
+            verify(swme.isOK());
+            expr.reset(swme.getValue());
+            doc = fromjson("{a: 10, b: 'abc', c: [{d: 5}, {d: 3}], e: null, f: 'filler'}");
+        }
+        void timed() {
+            if( expr->matchesBSON(doc) )
+                n++;
+        }
+    };
+
+    // planning a query which a few indexes could answer
+    class PlannerPlan : public NonDurTest {
+    public:
+        BSONObj query;
+        QueryPlannerParams params;
+        size_t n;
+        string name() { return "QueryPlanner-plan"; }
+        PlannerPlan() : n(0) {
+            query = fromjson("{a: {$gt: 5}, b: {$in: [1, 2, 3]}, c: 'x'}");
+            params.indices.push_back(IndexEntry(BSON("a" << 1), false, false, false, "a_1",
+                                                NULL, BSONObj()));
+            params.indices.push_back(IndexEntry(BSON("b" << 1 << "c" << 1), false, false, false,
+                                                "b_1_c_1", NULL, BSONObj()));
+            params.indices.push_back(IndexEntry(BSON("c" << 1 << "a" << -1), false, false, false,
+                                                "c_1_a_-1", NULL, BSONObj()));
+        }
+        void timed() {
+            CanonicalQuery* rawCq;
+            verify(CanonicalQuery::canonicalize("perftest.planner", query, &rawCq).isOK());
+            unique_ptr<CanonicalQuery> cq(rawCq);
+            vector<QuerySolution*> solutions;
+            verify(QueryPlanner::plan(*cq, params, &solutions).isOK());
+            n += solutions.size();
+            for (size_t i = 0; i < solutions.size(); i++) {
+                delete solutions[i];
+            }
+        }
+    };
+
+    struct PerfSortComparator {
+        int operator()(const std::pair<BSONObj, RecordId>& lhs,
+                       const std::pair<BSONObj, RecordId>& rhs) const {
+            return lhs.first.woCompare(rhs.first, BSONObj(), false);
+        }
+    };
+
+    // sorting keys in memory, as an index build or a blocking sort does
+    class SorterSort : public NonDurTest {
+    public:
+        typedef Sorter<BSONObj, RecordId> KeySorter;
+        vector<BSONObj> keys;
+        long long n;
+        string name() { return "Sorter-10k-keys"; }
+        virtual unsigned batchSize() { return 1; }
+        SorterSort() : n(0) {
+            PseudoRandom random(1);
+            for( int i = 0; i < 10000; i++ ) {
+                keys.push_back(BSON("" << random.nextInt32() << "" << i));
+            }
+        }
+        void timed() {
+            unique_ptr<KeySorter> sorter(KeySorter::make(SortOptions(), PerfSortComparator()));
+            for( size_t i = 0; i < keys.size(); i++ ) {
+                sorter->add(keys[i], RecordId(static_cast<long long>(i) + 1));
+            }
+            unique_ptr<KeySorter::Iterator> it(sorter->done());
+            while( it->more() ) {
+                n += it->next().second.repr();
+            }
+        }
+    };
+
+    // evaluating an aggregation expression on a document
+    class PipelineExpression : public NonDurTest {
+    public:
+        VariablesIdGenerator idGenerator;
+        boost::intrusive_ptr<Expression> expr;
+        Document doc;
+        size_t n;
+        string name() { return "Expression-evaluate"; }
+        PipelineExpression() : n(0) {
+            BSONObj spec = fromjson("{'': {$cond: [{$gt: ['$a', 5]},"
+                                    "              {$add: ['$a', '$b.c', 1]},"
+                                    "              {$concat: ['$s', '-', '$s']}]}}");
+            VariablesParseState vps(&idGenerator);
+            expr = Expression::parseOperand(spec.firstElement(), vps)->optimize();
+            doc = Document(fromjson("{a: 10, b: {c: 2}, s: 'x'}"));
+        }
+        void timed() {
+            n += expr->evaluate(doc).getType();
+        }
+    };
+
     class BSONGetFields1 : public NonDurTest {
     public:
         int n;
@@ -1204,6 +1422,262 @@ namespace PerfTests {
         }
     };
 
+    /**
+     * The shape of the synthetic collections the stage benchmarks run over: 'numDocs' documents
+     * with integer fields f0, f1, ... each holding one of 'cardinality' values, an array "arr"
+     * of 'arrayFanout' of them, and a string "pad" of 'padBytes' to make the documents bigger.
+     */
+    struct CollectionShape {
+        int numDocs;
+        int numFields;
+        int cardinality;
+        int arrayFanout;
+        int padBytes;
+    };
+
+    struct SmallDocs {
+        static const char* name() { return "small"; }
+        static CollectionShape shape() {
+            CollectionShape s = { 20000, 4, 100, 0, 0 };
+            return s;
+        }
+    };
+
+    struct WideDocs {
+        static const char* name() { return "wide"; }
+        static CollectionShape shape() {
+            CollectionShape s = { 20000, 16, 1000, 8, 512 };
+            return s;
+        }
+    };
+
+    BSONObj syntheticDoc(const CollectionShape& shape, int i, PseudoRandom* random) {
+        BSONObjBuilder b;
+        b.append("_id", i);
+        for( int f = 0; f < shape.numFields; f++ ) {
+            b.append(string(str::stream() << "f" << f), random->nextInt32(shape.cardinality));
+        }
+        if( shape.arrayFanout ) {
+            BSONArrayBuilder arr(b.subarrayStart("arr"));
+            for( int j = 0; j < shape.arrayFanout; j++ ) {
+                arr.append(random->nextInt32(shape.cardinality));
+            }
+            arr.done();
+        }
+        if( shape.padBytes ) {
+            b.append("pad", string(shape.padBytes, 'x'));
+        }
+        return b.obj();
+    }
+
+    /**
+     * Times a tree of plan stages over a synthetic collection of shape Shape. Each timed() runs
+     * the tree to EOF, so the rate reported is of whole plans. After the timed runs, reports how
+     * long each stage took, including its children, per document the plan returned.
+     *
+     * Runs on whichever storage engine perftest was started with; --storageEngine=
+     * inMemoryExperiment leaves disk out of it.
+     */
+    template <typename Shape>
+    class StageBench : public B {
+    public:
+        StageBench() : _results(0) { }
+        virtual int howLongMillis() { return 3000; }
+        virtual unsigned batchSize() { return 1; }
+        virtual bool showDurStats() { return false; }
+
+    protected:
+        // Name of the stage tree.
+        virtual string plan() = 0;
+
+        // The indexes makeStages() uses.
+        virtual vector<BSONObj> indexes() = 0;
+
+        // Builds the stage tree to time, over 'coll'.
+        virtual PlanStage* makeStages(Collection* coll, WorkingSet* ws) = 0;
+
+        string name() { return string("stage-") + plan() + "-" + Shape::name(); }
+
+        void prep() {
+            const CollectionShape shape = Shape::shape();
+            PseudoRandom random(17);
+            for( int i = 0; i < shape.numDocs; i++ ) {
+                insert(ns(), syntheticDoc(shape, i, &random));
+            }
+            vector<BSONObj> keyPatterns = indexes();
+            for( size_t i = 0; i < keyPatterns.size(); i++ ) {
+                ASSERT_OK(dbtests::createIndex(txn(), ns(), keyPatterns[i]));
+            }
+        }
+
+        IndexDescriptor* index(Collection* coll, const BSONObj& keyPattern) {
+            IndexDescriptor* descriptor =
+                coll->getIndexCatalog()->findIndexByKeyPattern(txn(), keyPattern);
+            verify(descriptor);
+            return descriptor;
+        }
+
+        // A scan of 'keyPattern' over the keys from 'start' to 'end', inclusive.
+        PlanStage* scan(Collection* coll, WorkingSet* ws, const BSONObj& keyPattern,
+                        int start, int end) {
+            IndexScanParams params;
+            params.descriptor = index(coll, keyPattern);
+            params.bounds.isSimpleRange = true;
+            params.bounds.startKey = BSON("" << start);
+            params.bounds.endKey = BSON("" << end);
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            return new IndexScan(txn(), params, ws, NULL);
+        }
+
+        void timed() {
+            AutoGetCollectionForRead ctx(txn(), ns());
+            WorkingSet ws;
+            unique_ptr<PlanStage> root(makeStages(ctx.getCollection(), &ws));
+            while( 1 ) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = root->work(&id);
+                if( PlanStage::IS_EOF == state )
+                    break;
+                verify(PlanStage::FAILURE != state && PlanStage::DEAD != state);
+                if( PlanStage::ADVANCED == state ) {
+                    _results++;
+                    ws.free(id);
+                }
+            }
+            unique_ptr<PlanStageStats> stats(root->getStats());
+            addStageTimes(stats.get(), "");
+        }
+
+        void post() {
+            BSONObjBuilder b;
+            b.append("test", name() + "-stages");
+            BSONArrayBuilder stages(b.subarrayStart("nanosPerDoc"));
+            for( size_t i = 0; i < _stages.size(); i++ ) {
+                const double nanosPerDoc =
+                    static_cast<double>(_stageNanos[_stages[i]]) / std::max(_results, 1LL);
+                cout << "stats " << setw(42) << left << ("  " + _stages[i]) << ' ' << right
+                     << setw(9) << (long long) nanosPerDoc << " ns/doc" << endl;
+                stages.append(BSON("stage" << _stages[i] << "nanos" << nanosPerDoc));
+            }
+            stages.done();
+            perfResults.push_back(b.obj());
+        }
+
+    private:
+        // Adds up the time of each stage by its path from the root, as in "FETCH/IXSCAN".
+        void addStageTimes(const PlanStageStats* stats, const string& parent) {
+            string path = parent + stats->common.stageTypeStr;
+            if( _stageNanos.find(path) == _stageNanos.end() ) {
+                _stages.push_back(path);
+            }
+            _stageNanos[path] += stats->common.executionTimeNanos;
+            for( size_t i = 0; i < stats->children.size(); i++ ) {
+                addStageTimes(stats->children[i], path + "/");
+            }
+        }
+
+        long long _results;
+        vector<string> _stages;
+        std::map<string, long long> _stageNanos;
+    };
+
+    // a tenth of f0's values by index, then their documents
+    template <typename Shape>
+    class IxscanFetch : public StageBench<Shape> {
+    public:
+        string plan() { return "ixscan-fetch"; }
+        vector<BSONObj> indexes() { return vector<BSONObj>(1, BSON("f0" << 1)); }
+        PlanStage* makeStages(Collection* coll, WorkingSet* ws) {
+            const int tenth = Shape::shape().cardinality / 10;
+            PlanStage* ixscan = this->scan(coll, ws, BSON("f0" << 1), 0, tenth);
+            return new FetchStage(this->txn(), ws, ixscan, NULL, coll);
+        }
+    };
+
+    // an intersection of ranges of f0 and f1, each holding half of their values
+    template <typename Shape>
+    class AndHashFetch : public StageBench<Shape> {
+    public:
+        string plan() { return "andhash-fetch"; }
+        vector<BSONObj> indexes() {
+            vector<BSONObj> keyPatterns;
+            keyPatterns.push_back(BSON("f0" << 1));
+            keyPatterns.push_back(BSON("f1" << 1));
+            return keyPatterns;
+        }
+        PlanStage* makeStages(Collection* coll, WorkingSet* ws) {
+            const int half = Shape::shape().cardinality / 2;
+            AndHashStage* andHash = new AndHashStage(ws, NULL, coll);
+            andHash->addChild(this->scan(coll, ws, BSON("f0" << 1), 0, half));
+            andHash->addChild(this->scan(coll, ws, BSON("f1" << 1), half, 2 * half));
+            return new FetchStage(this->txn(), ws, andHash, NULL, coll);
+        }
+    };
+
+    // a tenth of f0's documents, sorted by f1
+    template <typename Shape>
+    class FetchSort : public StageBench<Shape> {
+    public:
+        string plan() { return "ixscan-fetch-sort"; }
+        vector<BSONObj> indexes() { return vector<BSONObj>(1, BSON("f0" << 1)); }
+        PlanStage* makeStages(Collection* coll, WorkingSet* ws) {
+            const int tenth = Shape::shape().cardinality / 10;
+            PlanStage* ixscan = this->scan(coll, ws, BSON("f0" << 1), 0, tenth);
+            SortStageParams params;
+            params.collection = coll;
+            params.pattern = BSON("f1" << 1);
+            return new SortStage(params, ws,
+                                 new FetchStage(this->txn(), ws, ixscan, NULL, coll));
+        }
+    };
+
+    // $group of synthetic documents, fed from memory so that only the pipeline is timed
+    template <typename Shape>
+    class PipelineGroup : public NonDurTest {
+    public:
+        BSONObj docs;
+        BSONObj group;
+        long long inputs, nanos;
+        string name() { return string("pipeline-group-") + Shape::name(); }
+        virtual unsigned batchSize() { return 1; }
+        PipelineGroup() : inputs(0), nanos(0) {
+            group = fromjson("{$group: {_id: '$f0', n: {$sum: 1}, m: {$max: '$f1'},"
+                             "          a: {$avg: '$f2'}}}");
+        }
+        void prep() {
+            const CollectionShape shape = Shape::shape();
+            PseudoRandom random(17);
+            BSONArrayBuilder arr;
+            // within the limit on the size of one object
+            for( int i = 0; i < shape.numDocs && arr.len() < 15 * 1024 * 1024; i++ ) {
+                arr.append(syntheticDoc(shape, i, &random));
+            }
+            docs = arr.obj();
+        }
+        void timed() {
+            intrusive_ptr<ExpressionContext> expCtx(
+                new ExpressionContext(txn(), NamespaceString(ns())));
+            intrusive_ptr<DocumentSourceBsonArray> source =
+                DocumentSourceBsonArray::create(docs, expCtx);
+            intrusive_ptr<DocumentSource> stage =
+                DocumentSourceGroup::createFromBson(group.firstElement(), expCtx);
+            stage->setSource(source.get());
+            stage->enableTiming();
+            while( stage->getNext() ) { }
+            inputs += source->getStats().nReturned;
+            nanos += stage->getStats().executionMicros * 1000;
+        }
+        void post() {
+            const double nanosPerDoc = static_cast<double>(nanos) / std::max(inputs, 1LL);
+            cout << "stats " << setw(42) << left << "  $group" << ' ' << right << setw(9)
+                 << (long long) nanosPerDoc << " ns/doc" << endl;
+            perfResults.push_back(BSON("test" << name() + "-stages" << "nanosPerDoc"
+                                       << BSON_ARRAY(BSON("stage" << "$group"
+                                                          << "nanos" << nanosPerDoc))));
+        }
+    };
+
     // Tests what the worst case is for the overhead of enabling a fail point. If 'fpInjected'
     // is false, then the fail point will be compiled out. If 'fpInjected' is true, then the
     // fail point will be compiled in. Since the conditioned block is more or less trivial, any
@@ -1406,13 +1880,52 @@ namespace PerfTests {
             boost::thread a(t);
             Result * res = Suite::run(filter, runsPerTest);
             a.join();
+            writeReport();
             return res;
         }
 
+        /**
+         * Writes the results to --perfReport, if given, along with what they were measured on,
+         * so that runs of different commits can be compared.
+         */
+        void writeReport() {
+            const string& file = frameworkGlobalParams.perfReportFile;
+            if (file.empty()) {
+                return;
+            }
+
+            BSONObjBuilder b;
+            b.append("git", gitVersion());
+            b.append("version", versionString);
+            b.append("host", getHostName());
+            b.appendTimeT("when", time(0));
+            {
+                BSONObjBuilder info(b.subobjStart("info"));
+                info.append("bits", static_cast<int>(sizeof(int*) * 8));
+                info.append("debug", static_cast<bool>(kDebugBuild));
+#if defined(_WIN32)
+                info.append("os", "win");
+#endif
+#ifdef MONGO_CONFIG_SSL
+                info.append("OpenSSL", openSSLVersion());
+#endif
+                info.append("boost", BOOST_VERSION);
+                info.append("storageEngine", storageGlobalParams.engine);
+                info.append("dur", storageGlobalParams.dur);
+                info.done();
+            }
+            b.append("results", perfResults);
+
+            std::ofstream out(file.c_str());
+            out << b.obj().jsonString(Strict, 1) << endl;
+            if (!out.good()) {
+                warning() << "couldn't write perf results to " << file;
+            }
+        }
+
         void setupTests() {
-            pstatsConnect();
             cout
-                << "stats test                                       rps------  time-- "
+                << "stats test                                    median-rps stddev  time-- "
                 << dur::stats.curr()->_CSVHeader() << endl;
             if( profiling ) {
                 add< Insert1 >();
@@ -1460,6 +1973,19 @@ namespace PerfTests {
                 add< Bldr >();
                 add< StkBldr >();
                 add< BSONIter >();
+                add< ValidateBSON >();
+                add< FromJson >();
+                add< BuildReply<MallocBuilder> >();
+                add< BuildReply<PooledBuilder> >();
+                add< DBNameLookup<UnorderedDBMap> >();
+                add< DBNameLookup<FlatDBMap> >();
+                add< GeoHashPoints >();
+                add< R2BoxCovering >();
+                add< KeyStringRoundTrip >();
+                add< MatcherMatch >();
+                add< PlannerPlan >();
+                add< SorterSort >();
+                add< PipelineExpression >();
                 add< BSONGetFields1 >();
                 add< BSONGetFields2 >();
                 //add< TaskQueueTest >();
@@ -1470,6 +1996,14 @@ namespace PerfTests {
                 add< Update1 >();
                 add< MoreIndexes<Update1> >();
                 add< InsertBig >();
+                add< IxscanFetch<SmallDocs> >();
+                add< IxscanFetch<WideDocs> >();
+                add< AndHashFetch<SmallDocs> >();
+                add< AndHashFetch<WideDocs> >();
+                add< FetchSort<SmallDocs> >();
+                add< FetchSort<WideDocs> >();
+                add< PipelineGroup<SmallDocs> >();
+                add< PipelineGroup<WideDocs> >();
                 add< FailPointTest<false, false> >();
                 add< FailPointTest<true, false> >();
                 add< FailPointTest<true, true> >();
@@ -1484,3 +2018,6 @@ namespace PerfTests {
         }
     } myall;
 }
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
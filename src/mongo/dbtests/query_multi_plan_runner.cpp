@@ -282,6 +282,90 @@ namespace QueryMultiPlanRunner {
         }
     };
 
+    // Two candidates scan the same index with the same bounds. They share the keys read while
+    // both are worked, and the one which never produces anything is abandoned early.
+    class MPRShareScanAndAbandon : public MultiPlanRunnerBase {
+    public:
+        void run() {
+            const int N = 5000;
+            for (int i = 0; i < N; ++i) {
+                insert(BSON("foo" << (i % 10)));
+            }
+
+            addIndex(BSON("foo" << 1));
+
+            AutoGetCollectionForRead ctx(&_txn, ns());
+            const Collection* coll = ctx.getCollection();
+
+            IndexScanParams ixparams;
+            ixparams.descriptor = coll->getIndexCatalog()->findIndexByKeyPattern(&_txn, BSON("foo" << 1));
+            ixparams.bounds.isSimpleRange = true;
+            ixparams.bounds.startKey = BSON("" << 7);
+            ixparams.bounds.endKey = BSON("" << 7);
+            ixparams.bounds.endKeyInclusive = true;
+            ixparams.direction = 1;
+
+            unique_ptr<WorkingSet> sharedWs(new WorkingSet());
+
+            // Plan 0: every call to work() returns something.
+            IndexScan* firstIx = new IndexScan(&_txn, ixparams, sharedWs.get(), NULL);
+            unique_ptr<PlanStage> firstRoot(new FetchStage(&_txn, sharedWs.get(), firstIx, NULL,
+                                                         coll));
+
+            // Plan 1: the same scan, but no document passes the filter.
+            StatusWithMatchExpression swme = MatchExpressionParser::parse(BSON("bar" << 1));
+            verify(swme.isOK());
+            unique_ptr<MatchExpression> filter(swme.getValue());
+            IndexScan* secondIx = new IndexScan(&_txn, ixparams, sharedWs.get(), NULL);
+            unique_ptr<PlanStage> secondRoot(new FetchStage(&_txn, sharedWs.get(), secondIx,
+                                                          filter.get(), coll));
+
+            CanonicalQuery* cq = NULL;
+            verify(CanonicalQuery::canonicalize(ns(), BSON("foo" << 7), &cq).isOK());
+            verify(NULL != cq);
+
+            MultiPlanStage* mps = new MultiPlanStage(&_txn, ctx.getCollection(), cq);
+            mps->addPlan(createQuerySolution(), firstRoot.release(), sharedWs.get());
+            mps->addPlan(createQuerySolution(), secondRoot.release(), sharedWs.get());
+
+            PlanYieldPolicy yieldPolicy(NULL, PlanExecutor::YIELD_MANUAL);
+            mps->pickBestPlan(&yieldPolicy);
+            ASSERT(mps->bestPlanChosen());
+            ASSERT_EQUALS(0, mps->bestPlanIdx());
+
+            const MultiPlanStats* stats =
+                static_cast<const MultiPlanStats*>(mps->getSpecificStats());
+            ASSERT_EQUALS(stats->sharedIndexScans, 1U);
+            ASSERT_EQUALS(stats->plansAbandoned, 1U);
+
+            // The first plan to need a key reads it, and the other takes it from the buffer.
+            const IndexScanStats* firstStats =
+                static_cast<const IndexScanStats*>(firstIx->getSpecificStats());
+            const IndexScanStats* secondStats =
+                static_cast<const IndexScanStats*>(secondIx->getSpecificStats());
+            ASSERT_EQUALS(firstStats->keysShared, 0U);
+            ASSERT_EQUALS(secondStats->keysShared, secondStats->keysExamined);
+            ASSERT_GREATER_THAN(secondStats->keysShared, 0U);
+
+            // Takes ownership of arguments other than 'collection'.
+            PlanExecutor* rawExec;
+            Status status = PlanExecutor::make(&_txn, sharedWs.release(), mps, cq, coll,
+                                               PlanExecutor::YIELD_MANUAL, &rawExec);
+            ASSERT_OK(status);
+            std::unique_ptr<PlanExecutor> exec(rawExec);
+
+            // The winner goes on alone and still gets all the results.
+            int results = 0;
+            BSONObj obj;
+            while (PlanExecutor::ADVANCED == exec->getNext(&obj, NULL)) {
+                ASSERT_EQUALS(obj["foo"].numberInt(), 7);
+                ++results;
+            }
+
+            ASSERT_EQUALS(results, N / 10);
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "query_multi_plan_runner" ) { }
@@ -289,6 +373,7 @@ namespace QueryMultiPlanRunner {
         void setupTests() {
             add<MPRCollectionScanVsHighlySelectiveIXScan>();
             add<MPRBackupPlan>();
+            add<MPRShareScanAndAbandon>();
         }
     };
 
@@ -30,6 +30,7 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/clientcursor.h"
+#include "mongo/db/cursor_prefetcher.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/exec/collection_scan.h"
@@ -43,8 +44,11 @@
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/find.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/query_solution.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace QueryPlanExecutor {
@@ -507,6 +511,109 @@ namespace QueryPlanExecutor {
             }
         };
 
+        /**
+         * Test that many cursors, spread over the cursor manager's partitions, can each be found
+         * by id and are all invalidated together.
+         */
+        class ManyCursors : public PlanExecutorBase {
+        public:
+            void run() {
+                OldClientWriteContext ctx(&_txn, ns());
+                insert(BSON("a" << 1 << "b" << 1));
+
+                Collection* collection = ctx.getCollection();
+                CursorManager* cursorManager = collection->getCursorManager();
+                BSONObj filterObj = fromjson("{_id: {$gt: 0}, b: {$gt: 0}}");
+
+                const size_t kNumCursors = 100;
+                std::set<CursorId> ids;
+                for (size_t i = 0; i < kNumCursors; ++i) {
+                    PlanExecutor* exec = makeCollScanExec(collection, filterObj);
+                    ClientCursor* cc = new ClientCursor(cursorManager, exec, ns(), 0, BSONObj());
+                    ASSERT(cursorManager->ownsCursorId(cc->cursorid()));
+                    ids.insert(cc->cursorid());
+                }
+                ASSERT_EQUALS(kNumCursors, ids.size());
+                ASSERT_EQUALS(kNumCursors, numCursors());
+
+                std::set<CursorId> openCursors;
+                cursorManager->getCursorIds(&openCursors);
+                ASSERT(ids == openCursors);
+
+                for (std::set<CursorId>::const_iterator it = ids.begin(); it != ids.end(); ++it) {
+                    ClientCursor* cc = cursorManager->find(*it, false);
+                    ASSERT(cc);
+                    ASSERT_EQUALS(*it, cc->cursorid());
+                }
+
+                cursorManager->invalidateAll(false, "ManyCursors Test");
+                ASSERT_EQUALS(0U, numCursors());
+            }
+        };
+
+        /**
+         * Test that a getMore following a prefetch, or a cancelled one, returns the rest of the
+         * results in order and exactly once.
+         */
+        class Prefetch : public PlanExecutorBase {
+        public:
+            void run() {
+                {
+                    OldClientWriteContext ctx(&_txn, ns());
+                    for (int i = 0; i < 10; ++i) {
+                        insert(BSON("_id" << i));
+                    }
+                }
+
+                StorageEngine* engine = getGlobalServiceContext()->getGlobalStorageEngine();
+                CursorId cursorId;
+                BSONObj obj;
+                {
+                    AutoGetCollectionForRead ctx(&_txn, ns());
+                    Collection* collection = ctx.getCollection();
+
+                    BSONObj filterObj = fromjson("{_id: {$gte: 0}}");
+                    PlanExecutor* exec = makeCollScanExec(collection, filterObj);
+                    ClientCursor* cc =
+                        new ClientCursor(collection->getCursorManager(), exec, ns(), 0, BSONObj());
+                    cc->setPrefetchNextBatch(true);
+                    cursorId = cc->cursorid();
+
+                    // Return a first batch, then save the cursor as the find command does.
+                    for (int i = 0; i < 3; ++i) {
+                        ASSERT_EQUALS(PlanExecutor::ADVANCED, exec->getNext(&obj, NULL));
+                        ASSERT_EQUALS(i, obj["_id"].numberInt());
+                    }
+                    exec->saveState();
+                    _txn.recoveryUnit()->abandonSnapshot();
+                    cc->setOwnedRecoveryUnit(_txn.releaseRecoveryUnit());
+                    _txn.setRecoveryUnit(engine->newRecoveryUnit(),
+                                         OperationContext::kNotInUnitOfWork);
+                }
+
+                CursorPrefetcher::get()->schedule(NamespaceString(ns()), cursorId, 4);
+                CursorPrefetcher::get()->waitFor(cursorId);
+
+                AutoGetCollectionForRead ctx(&_txn, ns());
+                ClientCursorPin ccPin(ctx.getCollection()->getCursorManager(), cursorId);
+                ClientCursor* cc = ccPin.c();
+                ASSERT(cc);
+                if (!cc->hasRecoveryUnit()) {
+                    cc->setOwnedRecoveryUnit(engine->newRecoveryUnit());
+                }
+                ScopedRecoveryUnitSwapper ruSwapper(cc, &_txn);
+
+                PlanExecutor* exec = cc->getExecutor();
+                ASSERT(exec->restoreState(&_txn));
+                for (int i = 3; i < 10; ++i) {
+                    ASSERT_EQUALS(PlanExecutor::ADVANCED, exec->getNext(&obj, NULL));
+                    ASSERT_EQUALS(i, obj["_id"].numberInt());
+                }
+                ASSERT_EQUALS(PlanExecutor::IS_EOF, exec->getNext(&obj, NULL));
+                exec->saveState();
+            }
+        };
+
     } // namespace ClientCursor
 
     class All : public Suite {
@@ -522,6 +629,8 @@ namespace QueryPlanExecutor {
             add<ClientCursor::Invalidate>();
             add<ClientCursor::InvalidatePinned>();
             add<ClientCursor::Timeout>();
+            add<ClientCursor::ManyCursors>();
+            add<ClientCursor::Prefetch>();
         }
     };
 
@@ -624,6 +624,122 @@ namespace QueryStageAnd {
         }
     };
 
+    // An AND with two children whose first child's keys exceed the buffer limit, allowed to
+    // keep only the RecordIds of the first child instead of failing.
+    class QueryStageAndHashTwoLeafFirstChildLargeKeysCompact : public QueryStageAndBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = ctx.getCollection();
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            std::string big(512, 'a');
+            for (int i = 0; i < 50; ++i) {
+                insert(BSON("foo" << i << "bar" << i << "big" << big));
+            }
+
+            addIndex(BSON("foo" << 1 << "big" << 1));
+            addIndex(BSON("bar" << 1));
+
+            WorkingSet ws;
+            unique_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll, 20 * big.size()));
+            ah->allowCompactBuildSide();
+
+            // Foo <= 20
+            IndexScanParams params;
+            params.descriptor = getIndex(BSON("foo" << 1 << "big" << 1), coll);
+            params.bounds.isSimpleRange = true;
+            params.bounds.startKey = BSON("" << 20 << "" << big);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = -1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // Bar >= 10
+            params.descriptor = getIndex(BSON("bar" << 1), coll);
+            params.bounds.startKey = BSON("" << 10);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // foo == bar and 10 <= bar <= 20
+            ASSERT_EQUALS(11, countResults(ah.get()));
+            ASSERT_LESS_THAN_OR_EQUALS(ah->getMemUsage(), 20 * big.size());
+
+            unique_ptr<PlanStageStats> stats(ah->getStats());
+            const AndHashStats* specific = static_cast<const AndHashStats*>(stats->specific.get());
+            ASSERT(specific->compact);
+        }
+    };
+
+    // An AND with three children whose second child's keys exceed the buffer limit, allowed to
+    // keep only the RecordIds of the intersection instead of failing.
+    class QueryStageAndHashThreeLeafMiddleChildLargeKeysCompact : public QueryStageAndBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = ctx.getCollection();
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            std::string big(512, 'a');
+            for (int i = 0; i < 50; ++i) {
+                insert(BSON("foo" << i << "bar" << i << "baz" << i << "big" << big));
+            }
+
+            addIndex(BSON("foo" << 1));
+            addIndex(BSON("bar" << 1 << "big" << 1));
+            addIndex(BSON("baz" << 1));
+
+            WorkingSet ws;
+            unique_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll, 10 * big.size()));
+            ah->allowCompactBuildSide();
+
+            // Foo <= 20
+            IndexScanParams params;
+            params.descriptor = getIndex(BSON("foo" << 1), coll);
+            params.bounds.isSimpleRange = true;
+            params.bounds.startKey = BSON("" << 20);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = -1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // Bar >= 10
+            params.descriptor = getIndex(BSON("bar" << 1 << "big" << 1), coll);
+            params.bounds.startKey = BSON("" << 10 << "" << big);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // 5 <= baz <= 15
+            params.descriptor = getIndex(BSON("baz" << 1), coll);
+            params.bounds.startKey = BSON("" << 5);
+            params.bounds.endKey = BSON("" << 15);
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // foo == bar == baz and 10 <= baz <= 15
+            ASSERT_EQUALS(6, countResults(ah.get()));
+
+            unique_ptr<PlanStageStats> stats(ah->getStats());
+            const AndHashStats* specific = static_cast<const AndHashStats*>(stats->specific.get());
+            ASSERT(specific->compact);
+        }
+    };
+
     // An AND with an index scan that returns nothing.
     class QueryStageAndHashWithNothing : public QueryStageAndBase {
     public:
@@ -1538,6 +1654,8 @@ namespace QueryStageAnd {
             add<QueryStageAndHashTwoLeafLastChildLargeKeys>();
             add<QueryStageAndHashThreeLeaf>();
             add<QueryStageAndHashThreeLeafMiddleChildLargeKeys>();
+            add<QueryStageAndHashTwoLeafFirstChildLargeKeysCompact>();
+            add<QueryStageAndHashThreeLeafMiddleChildLargeKeysCompact>();
             add<QueryStageAndHashWithNothing>();
             add<QueryStageAndHashProducesNothing>();
             add<QueryStageAndHashWithMatcher>();
@@ -39,6 +39,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_registry.h"
@@ -624,6 +625,93 @@ namespace QueryStageCountScan {
         }
     };
 
+    //
+    // Counts over index bounds with several intervals, skipping the keys in between
+    //
+    class QueryStageCountScanMultipleIntervals : public CountBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+
+            // Insert documents, add index
+            for (int i = 0; i < 10; ++i) {
+                for (int j = 0; j < 10; ++j) {
+                    insert(BSON("a" << i << "b" << j));
+                }
+            }
+            addIndex(BSON("a" << 1 << "b" << 1));
+
+            // Count {a: {$in: [2, 5]}, b: 3} and {b: 7} without a predicate on a
+            CountScanParams params;
+            params.descriptor = getIndex(ctx.db(), BSON("a" << 1 << "b" << 1));
+            params.useBounds = true;
+            OrderedIntervalList aOil("a");
+            aOil.intervals.push_back(Interval(BSON("" << 2 << "" << 2), true, true));
+            aOil.intervals.push_back(Interval(BSON("" << 5 << "" << 5), true, true));
+            params.bounds.fields.push_back(aOil);
+            OrderedIntervalList bOil("b");
+            bOil.intervals.push_back(Interval(BSON("" << 3 << "" << 3), true, true));
+            params.bounds.fields.push_back(bOil);
+
+            WorkingSet ws;
+            CountScan count(&_txn, params, &ws);
+            ASSERT_EQUALS(2, runCount(&count));
+
+            CountScanParams trailingParams;
+            trailingParams.descriptor = params.descriptor;
+            trailingParams.useBounds = true;
+            OrderedIntervalList allA("a");
+            allA.intervals.push_back(IndexBoundsBuilder::allValues());
+            trailingParams.bounds.fields.push_back(allA);
+            OrderedIntervalList bSeven("b");
+            bSeven.intervals.push_back(Interval(BSON("" << 7 << "" << 7), true, true));
+            trailingParams.bounds.fields.push_back(bSeven);
+
+            WorkingSet trailingWs;
+            CountScan trailingCount(&_txn, trailingParams, &trailingWs);
+            ASSERT_EQUALS(10, runCount(&trailingCount));
+
+            // Each value of a is seeked to rather than every key being examined.
+            const CountScanStats* stats =
+                static_cast<const CountScanStats*>(trailingCount.getSpecificStats());
+            ASSERT_LESS_THAN(stats->keysExamined, 100U);
+        }
+    };
+
+    //
+    // Only counts the keys which pass the filter
+    //
+    class QueryStageCountScanKeyFilter : public CountBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+
+            // Insert documents, add index
+            for (int i = 0; i < 10; ++i) {
+                insert(BSON("a" << 1 << "b" << i));
+            }
+            addIndex(BSON("a" << 1 << "b" << 1));
+
+            BSONObj filterObj = BSON("b" << BSON("$mod" << BSON_ARRAY(3 << 0)));
+            StatusWithMatchExpression swme = MatchExpressionParser::parse(filterObj);
+            verify(swme.isOK());
+            std::unique_ptr<MatchExpression> filter(swme.getValue());
+
+            // Set up count stage
+            CountScanParams params;
+            params.descriptor = getIndex(ctx.db(), BSON("a" << 1 << "b" << 1));
+            params.startKey = BSON("" << 1 << "" << MINKEY);
+            params.startKeyInclusive = true;
+            params.endKey = BSON("" << 1 << "" << MAXKEY);
+            params.endKeyInclusive = true;
+            params.filter = filter.get();
+
+            WorkingSet ws;
+            CountScan count(&_txn, params, &ws);
+            ASSERT_EQUALS(4, runCount(&count));
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite("query_stage_count_scan") { }
@@ -640,6 +728,8 @@ namespace QueryStageCountScan {
             add<QueryStageCountScanInsertNewDocsDuringYield>();
             add<QueryStageCountScanBecomesMultiKeyDuringYield>();
             add<QueryStageCountScanUnusedKeys>();
+            add<QueryStageCountScanMultipleIntervals>();
+            add<QueryStageCountScanKeyFilter>();
         }
     };
 
@@ -44,11 +44,28 @@
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 
+namespace mongo {
+    // How many documents a multi-delete deletes in one WriteUnitOfWork.
+    extern int internalDeleteMaxBatchSize;
+} // namespace mongo
+
 namespace QueryStageDelete {
 
     using std::unique_ptr;
     using std::vector;
 
+    class SetDeleteMaxBatchSize {
+    public:
+        SetDeleteMaxBatchSize(int size) : _old(internalDeleteMaxBatchSize) {
+            internalDeleteMaxBatchSize = size;
+        }
+        ~SetDeleteMaxBatchSize() {
+            internalDeleteMaxBatchSize = _old;
+        }
+    private:
+        const int _old;
+    };
+
     //
     // Stage-specific tests.
     //
@@ -123,6 +140,8 @@ namespace QueryStageDelete {
     class QueryStageDeleteInvalidateUpcomingObject : public QueryStageDeleteBase {
     public:
         void run() {
+            // Delete one document at a time.
+            SetDeleteMaxBatchSize batchSize(1);
             OldClientWriteContext ctx(&_txn, ns());
 
             Collection* coll = ctx.getCollection();
@@ -176,6 +195,76 @@ namespace QueryStageDelete {
         }
     };
 
+    //
+    // Test invalidation of an object waiting in a batch of the delete stage.  Fill part of a
+    // batch, then invalidate and remove one of its objects, then expect the delete stage to skip
+    // over it when deleting the batch and successfully delete the rest.
+    //
+    class QueryStageDeleteInvalidateBatchedObject : public QueryStageDeleteBase {
+    public:
+        void run() {
+            SetDeleteMaxBatchSize batchSize(20);
+            OldClientWriteContext ctx(&_txn, ns());
+
+            Collection* coll = ctx.getCollection();
+
+            // Get the RecordIds that would be returned by an in-order scan.
+            vector<RecordId> locs;
+            getLocs(coll, CollectionScanParams::FORWARD, &locs);
+
+            // Configure the scan.
+            CollectionScanParams collScanParams;
+            collScanParams.collection = coll;
+            collScanParams.direction = CollectionScanParams::FORWARD;
+            collScanParams.tailable = false;
+
+            // Configure the delete stage.
+            DeleteStageParams deleteStageParams;
+            deleteStageParams.isMulti = true;
+            deleteStageParams.shouldCallLogOp = false;
+
+            WorkingSet ws;
+            DeleteStage deleteStage(&_txn, deleteStageParams, &ws, coll,
+                                    new CollectionScan(&_txn, collScanParams, &ws, NULL));
+
+            const DeleteStats* stats =
+                static_cast<const DeleteStats*>(deleteStage.getSpecificStats());
+
+            // The first batch is deleted once the stage has its 20 documents.
+            while (stats->docsDeleted == 0) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = deleteStage.work(&id);
+                ASSERT_EQUALS(PlanStage::NEED_TIME, state);
+            }
+            ASSERT_EQUALS(20U, stats->docsDeleted);
+
+            // Take 5 of the next batch, then remove one of them.
+            for (int i = 0; i < 5; i++) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                ASSERT_EQUALS(PlanStage::NEED_TIME, deleteStage.work(&id));
+            }
+            ASSERT_EQUALS(20U, stats->docsDeleted);
+
+            const size_t targetDocIndex = 22;
+            deleteStage.saveState();
+            deleteStage.invalidate(&_txn, locs[targetDocIndex], INVALIDATION_DELETION);
+            BSONObj targetDoc = coll->docFor(&_txn, locs[targetDocIndex]).value();
+            ASSERT(!targetDoc.isEmpty());
+            remove(targetDoc);
+            deleteStage.restoreState(&_txn);
+
+            // Remove the rest.
+            while (!deleteStage.isEOF()) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = deleteStage.work(&id);
+                invariant(PlanStage::NEED_TIME == state || PlanStage::IS_EOF == state);
+            }
+
+            ASSERT_EQUALS(numObj() - 1, stats->docsDeleted);
+            ASSERT_EQUALS(0U, coll->numRecords(&_txn));
+        }
+    };
+
     /**
      * Test that the delete stage returns an owned copy of the original document if returnDeleted is
      * specified.
@@ -297,6 +386,7 @@ namespace QueryStageDelete {
         void setupTests() {
             // Stage-specific tests below.
             add<QueryStageDeleteInvalidateUpcomingObject>();
+            add<QueryStageDeleteInvalidateBatchedObject>();
             add<QueryStageDeleteReturnOldDoc>();
             add<QueryStageDeleteSkipOwnedObjects>();
         }
@@ -79,6 +79,15 @@ namespace {
         return count;
     }
 
+    int countBatchResults(PlanStage* stage, size_t batchSize) {
+        std::vector<WorkingSetID> results;
+        while (!stage->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            stage->workBatch(batchSize, &results, &id);
+        }
+        return results.size();
+    }
+
     //
     // Insert 50 objects.  Filter/skip 0, 1, 2, ..., 100 objects and expect the right # of results.
     //
@@ -97,12 +106,36 @@ namespace {
         }
     };
 
+    //
+    // The same, working the stages a batch at a time.
+    //
+    class QueryStageLimitSkipBatchTest {
+    public:
+        void run() {
+            const size_t batchSizes[] = {1, 2, 7, 1000};
+            for (size_t batchSize : batchSizes) {
+                for (int i = 0; i < 2 * N; ++i) {
+                    WorkingSet ws;
+
+                    unique_ptr<PlanStage> skip(new SkipStage(i, &ws, getMS(&ws)));
+                    ASSERT_EQUALS(max(0, N - i), countBatchResults(skip.get(), batchSize));
+                    ASSERT_EQUALS(size_t(max(0, N - i)), skip->getCommonStats()->advanced);
+
+                    unique_ptr<PlanStage> limit(new LimitStage(i, &ws, getMS(&ws)));
+                    ASSERT_EQUALS(min(N, i), countBatchResults(limit.get(), batchSize));
+                    ASSERT_EQUALS(size_t(min(N, i)), limit->getCommonStats()->advanced);
+                }
+            }
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "query_stage_limit_skip" ) { }
 
         void setupTests() {
             add<QueryStageLimitSkipBasicTest>();
+            add<QueryStageLimitSkipBatchTest>();
         }
     };
 
@@ -0,0 +1,195 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file tests db/exec/parallel_filter.cpp.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/parallel_filter.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/queued_data_stage.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/dbtests/dbtests.h"
+
+namespace QueryStageParallelFilter {
+
+    using std::unique_ptr;
+    using std::vector;
+
+    static const int N = 5000;
+
+    class QueryStageParallelFilterBase {
+    public:
+        QueryStageParallelFilterBase() : _oldMorselDocs(internalQueryExecParallelMorselDocs) {
+            // Small morsels, so that several are out at once.
+            internalQueryExecParallelMorselDocs = 64;
+        }
+
+        virtual ~QueryStageParallelFilterBase() {
+            internalQueryExecParallelMorselDocs = _oldMorselDocs;
+        }
+
+        unique_ptr<MatchExpression> parse(const char* filter) {
+            StatusWithMatchExpression swme = MatchExpressionParser::parse(fromjson(filter));
+            ASSERT_OK(swme.getStatus());
+            return unique_ptr<MatchExpression>(swme.getValue());
+        }
+
+        /**
+         * Returns a QueuedDataStage of N documents {x: i}, with a NEED_TIME now and then.
+         */
+        QueuedDataStage* makeChild(WorkingSet* ws) {
+            unique_ptr<QueuedDataStage> child(new QueuedDataStage(ws));
+            for (int i = 0; i < N; ++i) {
+                if (0 == i % 100) {
+                    child->pushBack(PlanStage::NEED_TIME);
+                }
+                WorkingSetMember member;
+                member.state = WorkingSetMember::OWNED_OBJ;
+                member.obj = Snapshotted<BSONObj>(SnapshotId(), BSON("x" << i));
+                child->pushBack(member);
+            }
+            return child.release();
+        }
+
+        /**
+         * Works 'stage' to EOF and returns the x values of its results, in order. Saves and
+         * restores its state every 'yieldEvery' works if that isn't 0.
+         */
+        vector<int> run(PlanStage* stage, WorkingSet* ws, int yieldEvery) {
+            vector<int> xs;
+            for (int works = 1; !stage->isEOF(); ++works) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = stage->work(&id);
+                ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+                if (PlanStage::ADVANCED == state) {
+                    xs.push_back(ws->get(id)->obj.value()["x"].numberInt());
+                    ws->free(id);
+                }
+
+                if (yieldEvery && 0 == works % yieldEvery) {
+                    stage->saveState();
+                    stage->restoreState(&_txn);
+                }
+            }
+            return xs;
+        }
+
+    protected:
+        OperationContextImpl _txn;
+
+    private:
+        const int _oldMorselDocs;
+    };
+
+    //
+    // The matching documents come back in the order of the child, whatever the degree.
+    //
+    class ParallelFilterMatchesInOrder : public QueryStageParallelFilterBase {
+    public:
+        void run() {
+            unique_ptr<MatchExpression> filter(parse("{x: {$mod: [3, 0]}}"));
+            ASSERT_TRUE(ParallelFilterStage::canRunInParallel(filter.get()));
+
+            vector<int> expected;
+            for (int i = 0; i < N; i += 3) {
+                expected.push_back(i);
+            }
+
+            for (size_t degree = 2; degree <= 8; degree *= 2) {
+                WorkingSet ws;
+                ParallelFilterStage stage(&ws, makeChild(&ws), filter.get(), NULL, degree);
+                ASSERT_TRUE(expected == QueryStageParallelFilterBase::run(&stage, &ws, 0));
+
+                const ParallelFilterStats* stats =
+                    static_cast<const ParallelFilterStats*>(stage.getSpecificStats());
+                ASSERT_EQUALS(degree, stats->degree);
+                ASSERT_EQUALS(size_t(N), stats->docsTested);
+                ASSERT_EQUALS(size_t((N + 63) / 64), stats->morsels);
+                ASSERT_EQUALS(expected.size(), stage.getCommonStats()->advanced);
+            }
+        }
+    };
+
+    //
+    // Yielding while morsels are out doesn't lose or reorder any results.
+    //
+    class ParallelFilterYield : public QueryStageParallelFilterBase {
+    public:
+        void run() {
+            unique_ptr<MatchExpression> filter(parse("{x: {$gte: 1000, $lt: 4000}}"));
+
+            vector<int> expected;
+            for (int i = 1000; i < 4000; ++i) {
+                expected.push_back(i);
+            }
+
+            WorkingSet ws;
+            ParallelFilterStage stage(&ws, makeChild(&ws), filter.get(), NULL, 4);
+            ASSERT_TRUE(expected == QueryStageParallelFilterBase::run(&stage, &ws, 37));
+        }
+    };
+
+    //
+    // A stage destroyed before EOF waits for its workers.
+    //
+    class ParallelFilterDestroyedEarly : public QueryStageParallelFilterBase {
+    public:
+        void run() {
+            unique_ptr<MatchExpression> filter(parse("{x: {$exists: true}}"));
+
+            WorkingSet ws;
+            unique_ptr<ParallelFilterStage> stage(
+                new ParallelFilterStage(&ws, makeChild(&ws), filter.get(), NULL, 4));
+            for (int i = 0; i < 500; ++i) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                stage->work(&id);
+            }
+            stage.reset();
+        }
+    };
+
+    class All : public Suite {
+    public:
+        All() : Suite( "query_stage_parallel_filter" ) { }
+
+        void setupTests() {
+            add<ParallelFilterMatchesInOrder>();
+            add<ParallelFilterYield>();
+            add<ParallelFilterDestroyedEarly>();
+        }
+    };
+
+    SuiteInstance<All> queryStageParallelFilterAll;
+
+}  // namespace QueryStageParallelFilter
@@ -0,0 +1,232 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/point_lookup.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/dbtests/dbtests.h"
+
+/**
+ * This file tests db/exec/point_lookup.cpp
+ */
+
+namespace QueryStagePointLookup {
+
+    using std::unique_ptr;
+    using std::vector;
+
+    static const int kNumDocs = 100;
+
+    class PointLookupBase {
+    public:
+        PointLookupBase() : _client(&_txn) {
+            OldClientWriteContext ctx(&_txn, ns());
+
+            for (int i = 0; i < kNumDocs; ++i) {
+                _client.insert(ns(), BSON("_id" << i << "odd" << (i % 2 == 1)));
+            }
+        }
+
+        virtual ~PointLookupBase() {
+            OldClientWriteContext ctx(&_txn, ns());
+            _client.dropCollection(ns());
+        }
+
+        void remove(const BSONObj& obj) {
+            _client.remove(ns(), obj);
+        }
+
+        /**
+         * Parameters looking up each of 'ids' in the _id index.
+         */
+        PointLookupParams makeParams(Collection* coll, const vector<int>& ids) {
+            PointLookupParams params;
+            params.collection = coll;
+            params.descriptor = coll->getIndexCatalog()->findIdIndex(&_txn);
+            ASSERT(params.descriptor);
+            for (size_t i = 0; i < ids.size(); ++i) {
+                params.keys.push_back(BSON("" << ids[i]));
+            }
+            return params;
+        }
+
+        /**
+         * Runs 'stage' to completion, returning the _id of each document it returns and checking
+         * that they come in RecordId order.
+         */
+        static vector<int> getIds(PlanStage* stage, WorkingSet* ws) {
+            vector<int> ids;
+            RecordId lastLoc;
+            WorkingSetID wsid;
+            PlanStage::StageState state;
+            while (PlanStage::IS_EOF != (state = stage->work(&wsid))) {
+                if (PlanStage::ADVANCED != state) {
+                    continue;
+                }
+
+                WorkingSetMember* member = ws->get(wsid);
+                ASSERT_TRUE(member->hasObj());
+                if (member->hasLoc()) {
+                    ASSERT_LESS_THAN(lastLoc, member->loc);
+                    lastLoc = member->loc;
+                }
+                ids.push_back(member->obj.value()["_id"].numberInt());
+                ws->free(wsid);
+            }
+            return ids;
+        }
+
+        static const char* ns() { return "unittests.QueryStagePointLookup"; }
+
+    protected:
+        OperationContextImpl _txn;
+
+    private:
+        DBDirectClient _client;
+    };
+
+    // Returns each document found, once, and skips the keys that are missing.
+    class QueryStagePointLookupBasic : public PointLookupBase {
+    public:
+        void run() {
+            AutoGetCollectionForRead ctx(&_txn, ns());
+            Collection* coll = ctx.getCollection();
+
+            vector<int> keys;
+            keys.push_back(3);
+            keys.push_back(7);
+            keys.push_back(40);
+            keys.push_back(500);
+
+            WorkingSet ws;
+            PointLookupStage stage(&_txn, makeParams(coll, keys), &ws, NULL);
+            vector<int> ids = getIds(&stage, &ws);
+
+            ASSERT_EQUALS(3U, ids.size());
+            std::sort(ids.begin(), ids.end());
+            ASSERT_EQUALS(3, ids[0]);
+            ASSERT_EQUALS(7, ids[1]);
+            ASSERT_EQUALS(40, ids[2]);
+
+            const PointLookupStats* stats =
+                static_cast<const PointLookupStats*>(stage.getSpecificStats());
+            ASSERT_EQUALS(4U, stats->keysRequested);
+            ASSERT_EQUALS(3U, stats->keysExamined);
+            ASSERT_EQUALS(3U, stats->docsExamined);
+        }
+    };
+
+    // Only documents which pass the filter are returned.
+    class QueryStagePointLookupFilter : public PointLookupBase {
+    public:
+        void run() {
+            AutoGetCollectionForRead ctx(&_txn, ns());
+            Collection* coll = ctx.getCollection();
+
+            vector<int> keys;
+            for (int i = 10; i < 20; ++i) {
+                keys.push_back(i);
+            }
+
+            BSONObj filterObj = BSON("odd" << true);
+            StatusWithMatchExpression swme = MatchExpressionParser::parse(filterObj);
+            ASSERT_OK(swme.getStatus());
+            unique_ptr<MatchExpression> filter(swme.getValue());
+
+            WorkingSet ws;
+            PointLookupStage stage(&_txn, makeParams(coll, keys), &ws, filter.get());
+            vector<int> ids = getIds(&stage, &ws);
+
+            ASSERT_EQUALS(5U, ids.size());
+            for (size_t i = 0; i < ids.size(); ++i) {
+                ASSERT_EQUALS(1, ids[i] % 2);
+            }
+        }
+    };
+
+    // A document deleted after its key was looked up is still returned, as it was before the
+    // deletion.
+    class QueryStagePointLookupInvalidate : public PointLookupBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Collection* coll = ctx.getCollection();
+
+            vector<int> keys;
+            keys.push_back(1);
+            keys.push_back(2);
+            keys.push_back(3);
+
+            WorkingSet ws;
+            PointLookupStage stage(&_txn, makeParams(coll, keys), &ws, NULL);
+
+            // The first call looks up every key.
+            WorkingSetID wsid;
+            ASSERT_EQUALS(PlanStage::NEED_TIME, stage.work(&wsid));
+
+            RecordId loc = Helpers::findById(&_txn, coll, BSON("_id" << 2));
+            ASSERT_FALSE(loc.isNull());
+
+            stage.saveState();
+            stage.invalidate(&_txn, loc, INVALIDATION_DELETION);
+            remove(BSON("_id" << 2));
+            stage.restoreState(&_txn);
+
+            vector<int> ids = getIds(&stage, &ws);
+            ASSERT_EQUALS(3U, ids.size());
+            std::sort(ids.begin(), ids.end());
+            ASSERT_EQUALS(1, ids[0]);
+            ASSERT_EQUALS(2, ids[1]);
+            ASSERT_EQUALS(3, ids[2]);
+        }
+    };
+
+    class All : public Suite {
+    public:
+        All() : Suite( "query_stage_point_lookup" ) { }
+
+        void setupTests() {
+            add<QueryStagePointLookupBasic>();
+            add<QueryStagePointLookupFilter>();
+            add<QueryStagePointLookupInvalidate>();
+        }
+    };
+
+    SuiteInstance<All> queryStagePointLookupAll;
+
+}  // namespace QueryStagePointLookup
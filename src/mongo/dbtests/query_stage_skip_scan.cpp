@@ -0,0 +1,165 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/skip_scan.h"
+#include "mongo/db/json.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/dbtests/dbtests.h"
+
+/**
+ * This file tests db/exec/skip_scan.cpp
+ */
+
+namespace QueryStageSkipScan {
+
+    static const int kNumTenants = 5;
+    static const int kDocsPerTenant = 200;
+
+    class SkipScanBase {
+    public:
+        SkipScanBase() : _client(&_txn) {
+            for (int tenant = 0; tenant < kNumTenants; ++tenant) {
+                for (int ts = 0; ts < kDocsPerTenant; ++ts) {
+                    _client.insert(ns(), BSON("tenant" << tenant << "ts" << ts));
+                }
+            }
+            ASSERT_OK(dbtests::createIndex(&_txn, ns(), BSON("tenant" << 1 << "ts" << 1)));
+        }
+
+        virtual ~SkipScanBase() {
+            _client.dropCollection(ns());
+        }
+
+        /**
+         * Runs a skip scan over every tenant with 'tsInterval' as the bounds on 'ts', checking
+         * that each result is within them. Returns the number of results.
+         */
+        int countResults(const Interval& tsInterval, SkipScanStats* statsOut) {
+            AutoGetCollectionForRead ctx(&_txn, ns());
+            Collection* coll = ctx.getCollection();
+
+            SkipScanParams params;
+            params.descriptor = coll->getIndexCatalog()->findIndexByKeyPattern(
+                &_txn, BSON("tenant" << 1 << "ts" << 1));
+            ASSERT(params.descriptor);
+            params.bounds.isSimpleRange = false;
+            OrderedIntervalList tenantOil("tenant");
+            tenantOil.intervals.push_back(IndexBoundsBuilder::allValues());
+            params.bounds.fields.push_back(tenantOil);
+            OrderedIntervalList tsOil("ts");
+            tsOil.intervals.push_back(tsInterval);
+            params.bounds.fields.push_back(tsOil);
+
+            WorkingSet ws;
+            SkipScan scan(&_txn, params, &ws);
+
+            int count = 0;
+            WorkingSetID wsid;
+            PlanStage::StageState state;
+            while (PlanStage::IS_EOF != (state = scan.work(&wsid))) {
+                if (PlanStage::ADVANCED != state) {
+                    continue;
+                }
+
+                WorkingSetMember* member = ws.get(wsid);
+                ASSERT_FALSE(member->hasObj());
+                BSONElement tsElt;
+                ASSERT_TRUE(member->getFieldDotted("ts", &tsElt));
+                ASSERT_GREATER_THAN_OR_EQUALS(tsElt.woCompare(tsInterval.start, false), 0);
+                ASSERT_LESS_THAN_OR_EQUALS(tsElt.woCompare(tsInterval.end, false), 0);
+                ws.free(wsid);
+                ++count;
+            }
+
+            *statsOut = *static_cast<const SkipScanStats*>(scan.getSpecificStats());
+            return count;
+        }
+
+        static const char* ns() { return "unittests.QueryStageSkipScan"; }
+
+    protected:
+        OperationContextImpl _txn;
+
+    private:
+        DBDirectClient _client;
+    };
+
+    // Returns the keys in bounds for every tenant, reading only a few keys per tenant.
+    class QueryStageSkipScanBasic : public SkipScanBase {
+    public:
+        void run() {
+            SkipScanStats stats;
+            int count = countResults(IndexBoundsBuilder::makeRangeInterval(
+                                         BSON("" << 190 << "" << 195), true, true),
+                                     &stats);
+
+            ASSERT_EQUALS(kNumTenants * 6, count);
+            ASSERT_EQUALS(static_cast<size_t>(kNumTenants), stats.prefixes);
+
+            // Each tenant needs its keys in bounds, plus about one key to find the start of the
+            // bounds and one to find that they ended.
+            ASSERT_LESS_THAN_OR_EQUALS(stats.keysExamined,
+                                       static_cast<size_t>(kNumTenants * (6 + 2) + 1));
+        }
+    };
+
+    // No tenant has keys in the bounds.
+    class QueryStageSkipScanEmpty : public SkipScanBase {
+    public:
+        void run() {
+            SkipScanStats stats;
+            int count = countResults(IndexBoundsBuilder::makeRangeInterval(
+                                         BSON("" << 1000 << "" << 2000), true, true),
+                                     &stats);
+
+            ASSERT_EQUALS(0, count);
+            ASSERT_EQUALS(0U, stats.prefixes);
+            ASSERT_LESS_THAN_OR_EQUALS(stats.keysExamined,
+                                       static_cast<size_t>(kNumTenants + 1));
+        }
+    };
+
+    class All : public Suite {
+    public:
+        All() : Suite( "query_stage_skip_scan" ) { }
+
+        void setupTests() {
+            add<QueryStageSkipScanBasic>();
+            add<QueryStageSkipScanEmpty>();
+        }
+    };
+
+    SuiteInstance<All> queryStageSkipScanAll;
+
+}  // namespace QueryStageSkipScan
@@ -38,6 +38,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 
 /**
@@ -282,6 +283,71 @@ namespace QueryStageSortTests {
         }
     };
 
+    // Sort more data than fits under the memory limit, forcing the stage to spill to disk.
+    template <int LIMIT>
+    class QueryStageSortSpill : public QueryStageSortTestBase {
+    public:
+        QueryStageSortSpill() : _oldMaxBytes(internalQueryExecMaxBlockingSortBytes) {
+            internalQueryExecMaxBlockingSortBytes = 16 * 1024;
+        }
+
+        virtual ~QueryStageSortSpill() {
+            internalQueryExecMaxBlockingSortBytes = _oldMaxBytes;
+        }
+
+        virtual int numObj() { return 5000; }
+        virtual int limit() const { return LIMIT; }
+
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = db->getCollection(ns());
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            fillData();
+
+            WorkingSet ws;
+            QueuedDataStage* ms = new QueuedDataStage(&ws);
+            insertVarietyOfObjects(ms, coll);
+
+            SortStageParams params;
+            params.collection = coll;
+            params.pattern = BSON("foo" << -1);
+            params.limit = limit();
+            SortStage ss(params, &ws, ms);
+
+            int count = 0;
+            int last = numObj();
+            while (!ss.isEOF()) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState status = ss.work(&id);
+                ASSERT_NOT_EQUALS(PlanStage::FAILURE, status);
+                if (PlanStage::ADVANCED != status) { continue; }
+
+                WorkingSetMember* member = ws.get(id);
+                ASSERT(member->hasObj());
+                ASSERT(member->hasLoc());
+                int current = member->obj.value()["foo"].numberInt();
+                ASSERT_LESS_THAN(current, last);
+                last = current;
+                ++count;
+            }
+
+            checkCount(count);
+
+            const SortStats* stats = static_cast<const SortStats*>(ss.getSpecificStats());
+            ASSERT_GREATER_THAN(stats->spills, 0U);
+            ASSERT_GREATER_THAN(stats->spilledBytes, 0ULL);
+        }
+
+    private:
+        int _oldMaxBytes;
+    };
+
     // Mutation invalidation of docs fed to sort.
     class QueryStageSortMutationInvalidation : public QueryStageSortTestBase {
     public:
@@ -552,6 +618,8 @@ namespace QueryStageSortTests {
             // and a special case for limit == 1
             add<QueryStageSortDecWithLimit<1> >();
             add<QueryStageSortExt>();
+            add<QueryStageSortSpill<0> >();
+            add<QueryStageSortSpill<1000> >();
             add<QueryStageSortMutationInvalidation>();
             add<QueryStageSortDeletionInvalidation>();
             add<QueryStageSortDeletionInvalidationWithLimit<10> >();
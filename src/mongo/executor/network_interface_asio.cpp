@@ -0,0 +1,590 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/network_interface_asio.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/db/auth/authorization_manager.h"
+#include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/auth/internal_user_auth.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/rpc/factory.h"
+#include "mongo/rpc/metadata.h"
+#include "mongo/rpc/reply_interface.h"
+#include "mongo/rpc/request_builder_interface.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/sock.h"
+#include "mongo/util/net/socket_poll.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace executor {
+
+namespace {
+
+    const int kSetupThreads = 8;
+    const Minutes kCleanUpInterval(5); // Note: Must be larger than kMaxConnectionAge below)
+    const Seconds kMaxConnectionAge(30);
+
+    /**
+     * Returns true if the remote end of an idle connection has closed it or sent unsolicited
+     * data, either of which makes the connection unusable.
+     */
+    bool isIdleConnectionBroken(int fd) {
+        pollfd pollInfo;
+        pollInfo.fd = fd;
+        pollInfo.events = POLLRDNORM;
+        pollInfo.revents = 0;
+        return socketPoll(&pollInfo, 1, 0) != 0;
+    }
+
+}  // namespace
+
+    NetworkInterfaceASIO::AsyncConnection::AsyncConnection(asio::io_service* service,
+                                                           const HostAndPort& theTarget,
+                                                           Date_t theCreationDate)
+        : sock(*service),
+          target(theTarget),
+          creationDate(theCreationDate),
+          clientProtocols(rpc::supports::kOpQueryOnly),
+          serverProtocols(rpc::supports::kOpQueryOnly),
+          compressor(MessageCompressorId::kNoop) {}
+
+    NetworkInterfaceASIO::AsyncOp::AsyncOp(asio::io_service* service,
+                                           const TaskExecutor::CallbackHandle& theCbHandle,
+                                           const RemoteCommandRequest& theRequest,
+                                           const RemoteCommandCompletionFn& theOnFinish,
+                                           Date_t theStart)
+        : cbHandle(theCbHandle),
+          request(theRequest),
+          onFinish(theOnFinish),
+          start(theStart),
+          timeoutTimer(*service) {}
+
+    NetworkInterfaceASIO::AsyncOp::~AsyncOp() {
+        free(replyBuf);
+    }
+
+    NetworkInterfaceASIO::NetworkInterfaceASIO()
+        : _setupPool(ThreadPool::DoNotStartThreadsTag(),
+                     kSetupThreads,
+                     "NetworkInterfaceASIO-setup-"),
+          _lastCleanUpDate(),
+          _isExecutorRunnable(false),
+          _inShutdown(false),
+          _started(false) {}
+
+    NetworkInterfaceASIO::~NetworkInterfaceASIO() = default;
+
+    std::string NetworkInterfaceASIO::getDiagnosticString() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        str::stream output;
+        output << "NetworkInterfaceASIO";
+        output << " inShutdown:" << _inShutdown;
+        output << " inProgress:" << _inProgress.size();
+        output << " execRunable:" << _isExecutorRunnable;
+        return output;
+    }
+
+    void NetworkInterfaceASIO::startup() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        invariant(!_inShutdown);
+        if (_started) {
+            return;
+        }
+        _started = true;
+        _setupPool.startThreads();
+        _serviceRunner = stdx::thread([this]() {
+            setThreadName("NetworkInterfaceASIO");
+            LOG(1) << "thread starting";
+            asio::io_service::work work(_io_service);
+            _io_service.run();
+            LOG(1) << "thread shutting down";
+        });
+    }
+
+    void NetworkInterfaceASIO::shutdown() {
+        using std::swap;
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _inShutdown = true;
+        const bool started = _started;
+        lk.unlock();
+
+        _io_service.stop();
+        if (started) {
+            _serviceRunner.join();
+            _setupPool.join();
+        }
+
+        // Nothing runs on the I/O thread any more, so operations which have not completed yet
+        // never will.
+        AsyncOpList abandoned;
+        lk.lock();
+        swap(abandoned, _inProgress);
+        lk.unlock();
+        for (auto&& op : abandoned) {
+            op->onFinish(TaskExecutor::ResponseStatus(ErrorCodes::ShutdownInProgress,
+                                                      "Shutting down the network interface"));
+        }
+        _idleConnections.clear();
+    }
+
+    void NetworkInterfaceASIO::signalWorkAvailable() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _signalWorkAvailable_inlock();
+    }
+
+    void NetworkInterfaceASIO::_signalWorkAvailable_inlock() {
+        if (!_isExecutorRunnable) {
+            _isExecutorRunnable = true;
+            _isExecutorRunnableCondition.notify_one();
+        }
+    }
+
+    void NetworkInterfaceASIO::waitForWork() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (!_isExecutorRunnable) {
+            _isExecutorRunnableCondition.wait(lk);
+        }
+        _isExecutorRunnable = false;
+    }
+
+    void NetworkInterfaceASIO::waitForWorkUntil(Date_t when) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (!_isExecutorRunnable) {
+            const Milliseconds waitTime(when - now());
+            if (waitTime <= Milliseconds(0)) {
+                break;
+            }
+            _isExecutorRunnableCondition.wait_for(lk, waitTime);
+        }
+        _isExecutorRunnable = false;
+    }
+
+    Date_t NetworkInterfaceASIO::now() {
+        return Date_t::now();
+    }
+
+    void NetworkInterfaceASIO::startCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                                            const RemoteCommandRequest& request,
+                                            const RemoteCommandCompletionFn& onFinish) {
+        LOG(2) << "Scheduling " << request.cmdObj.firstElementFieldName() << " to " <<
+            request.target;
+        auto op = std::make_shared<AsyncOp>(&_io_service, cbHandle, request, onFinish, now());
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        if (_inShutdown) {
+            lk.unlock();
+            onFinish(TaskExecutor::ResponseStatus(ErrorCodes::ShutdownInProgress,
+                                                  "Shutting down the network interface"));
+            return;
+        }
+        _inProgress.push_back(op);
+        _io_service.post([this, op]() { _startOp(op); });
+    }
+
+    void NetworkInterfaceASIO::cancelCommand(const TaskExecutor::CallbackHandle& cbHandle) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (auto&& op : _inProgress) {
+            if (op->cbHandle != cbHandle) {
+                continue;
+            }
+            LOG(2) << "Canceling sending " << op->request.cmdObj.firstElementFieldName() <<
+                " to " << op->request.target;
+            AsyncOpPtr toCancel = op;
+            _io_service.post([this, toCancel]() {
+                _completeOp(toCancel, TaskExecutor::ResponseStatus(ErrorCodes::CallbackCanceled,
+                                                                   "Callback canceled"));
+            });
+            return;
+        }
+    }
+
+    void NetworkInterfaceASIO::_startOp(const AsyncOpPtr& op) {
+        const Date_t nowDate = now();
+        const Date_t expirationDate = op->request.expirationDate;
+        if (expirationDate != RemoteCommandRequest::kNoExpirationDate) {
+            if (expirationDate <= nowDate) {
+                _completeOp(op, TaskExecutor::ResponseStatus(
+                    ErrorCodes::ExceededTimeLimit,
+                    str::stream() << "Went to run command, but it was too late. "
+                                     "Expiration was set to "
+                                  << dateToISOStringUTC(expirationDate)));
+                return;
+            }
+            const Milliseconds timeout(expirationDate - nowDate);
+            op->timeoutTimer.expires_from_now(std::chrono::milliseconds(timeout.count()));
+            op->timeoutTimer.async_wait([this, op](const asio::error_code& ec) {
+                if (ec == asio::error::operation_aborted) {
+                    return;
+                }
+                _completeOp(op, TaskExecutor::ResponseStatus(
+                    ErrorCodes::ExceededTimeLimit,
+                    str::stream() << "Operation timed out, request was " <<
+                        op->request.toString()));
+            });
+        }
+
+        _cleanUpIdleConnections(nowDate);
+        op->connection = _takeIdleConnection(op->request.target, nowDate);
+        if (op->connection) {
+            _sendRequest(op);
+            return;
+        }
+        _setupPool.schedule([this, op, expirationDate]() {
+            _setupConnection(op, expirationDate);
+        });
+    }
+
+    void NetworkInterfaceASIO::_setupConnection(const AsyncOpPtr& op, Date_t expirationDate) {
+        const HostAndPort& target = op->request.target;
+        ConnectionSetupResult result;
+        try {
+            DBClientConnection conn;
+            if (expirationDate != RemoteCommandRequest::kNoExpirationDate) {
+                // setSoTimeout takes a double representing the number of seconds for send and
+                // receive timeouts, and 0 means no timeout at all.
+                const Milliseconds timeout(expirationDate - now());
+                conn.setSoTimeout(std::max<long long>(timeout.count(), 1) / 1000.0);
+            }
+            std::string errmsg;
+            uassert(28703,
+                    str::stream() << "Failed attempt to connect to " << target.toString()
+                                  << "; " << errmsg,
+                    conn.connect(target, errmsg));
+
+            conn.port().tag |= kMessagingPortKeepOpen;
+
+            if (getGlobalAuthorizationManager()->isAuthEnabled()) {
+                uassert(ErrorCodes::AuthenticationFailed,
+                        "Missing credentials for authenticating as internal user",
+                        isInternalAuthSet());
+                conn.auth(getInternalUserAuthParamsWithFallback());
+            }
+
+            result.clientProtocols = conn.getClientRPCProtocols();
+            result.serverProtocols = conn.getServerRPCProtocols();
+            result.compressor = conn.port().getMessageCompressor();
+            result.family = conn.port().psock->remoteAddr().getType();
+            result.fd = conn.port().psock->releaseFD();
+        }
+        catch (const DBException& ex) {
+            result.status = ex.toStatus();
+        }
+        catch (const std::exception& ex) {
+            result.status = Status(ErrorCodes::UnknownError,
+                                   str::stream() << "Connecting to " << target.toString()
+                                                 << " received exception " << ex.what());
+        }
+        _io_service.post([this, op, result]() { _onConnectionSetUp(op, result); });
+    }
+
+    void NetworkInterfaceASIO::_onConnectionSetUp(const AsyncOpPtr& op,
+                                                  const ConnectionSetupResult& result) {
+        if (!result.status.isOK()) {
+            _completeOp(op, result.status);
+            return;
+        }
+
+        const Date_t nowDate = now();
+        AsyncConnectionPtr conn(new AsyncConnection(&_io_service, op->request.target, nowDate));
+        asio::error_code ec;
+        conn->sock.assign(asio::generic::stream_protocol(result.family, SOCK_STREAM),
+                          result.fd,
+                          ec);
+        if (ec) {
+            closesocket(result.fd);
+            _failOp(op, "adopting a new connection", ec);
+            return;
+        }
+        conn->clientProtocols = result.clientProtocols;
+        conn->serverProtocols = result.serverProtocols;
+        conn->compressor = result.compressor;
+
+        if (op->completed) {
+            // Canceled or timed out while connecting; the connection is still good for others.
+            _returnConnection(std::move(conn), nowDate);
+            return;
+        }
+        op->connection = std::move(conn);
+        _sendRequest(op);
+    }
+
+    void NetworkInterfaceASIO::_sendRequest(const AsyncOpPtr& op) {
+        AsyncConnection& conn = *op->connection;
+        try {
+            uassert(ErrorCodes::InvalidNamespace,
+                    str::stream() << "Database name '" << op->request.dbname << "' is not valid.",
+                    NamespaceString::validDBName(op->request.dbname));
+
+            BSONObj upconvertedCmd;
+            BSONObj upconvertedMetadata;
+            std::tie(upconvertedCmd, upconvertedMetadata) = uassertStatusOK(
+                rpc::upconvertRequestMetadata(op->request.cmdObj, 0)
+            );
+
+            auto requestBuilder =
+                rpc::makeRequestBuilder(conn.clientProtocols, conn.serverProtocols);
+            op->toSend = requestBuilder->setDatabase(op->request.dbname)
+                                        .setCommandName(upconvertedCmd.firstElementFieldName())
+                                        .setMetadata(upconvertedMetadata)
+                                        .setCommandArgs(upconvertedCmd)
+                                        .done();
+        }
+        catch (const DBException& ex) {
+            _completeOp(op, ex.toStatus());
+            return;
+        }
+
+        op->requestId = nextMessageId();
+        op->toSend->header().setId(op->requestId);
+        op->toSend->header().setResponseTo(0);
+
+        if (conn.compressor != MessageCompressorId::kNoop) {
+            Message compressed;
+            if (compressMessage(conn.compressor, *op->toSend, &compressed)) {
+                op->toSend->reset();
+                *op->toSend = compressed;
+            }
+        }
+
+        asio::async_write(conn.sock,
+                          asio::buffer(op->toSend->singleData().view2ptr(), op->toSend->size()),
+                          [this, op](const asio::error_code& ec, std::size_t) {
+                              _onRequestSent(op, ec);
+                          });
+    }
+
+    void NetworkInterfaceASIO::_onRequestSent(const AsyncOpPtr& op, const asio::error_code& ec) {
+        if (op->completed) {
+            return;
+        }
+        if (ec) {
+            _failOp(op, "sending the request", ec);
+            return;
+        }
+        op->toSend.reset();
+        asio::async_read(op->connection->sock,
+                         asio::buffer(reinterpret_cast<char*>(&op->replyHeader),
+                                      sizeof(op->replyHeader)),
+                         [this, op](const asio::error_code& ec, std::size_t) {
+                             _onReplyHeaderRead(op, ec);
+                         });
+    }
+
+    void NetworkInterfaceASIO::_onReplyHeaderRead(const AsyncOpPtr& op,
+                                                  const asio::error_code& ec) {
+        if (op->completed) {
+            return;
+        }
+        if (ec) {
+            _failOp(op, "receiving the reply", ec);
+            return;
+        }
+
+        const int len = op->replyHeader.constView().getMessageLength();
+        if (static_cast<size_t>(len) < sizeof(MSGHEADER::Value) ||
+            static_cast<size_t>(len) > MaxMessageSizeBytes) {
+            _completeOp(op, Status(ErrorCodes::ProtocolError,
+                                   str::stream() << "Reply message length " << len
+                                                 << " from " << op->request.target.toString()
+                                                 << " is invalid"));
+            return;
+        }
+
+        op->replyBuf = static_cast<char*>(mongoMalloc(len));
+        memcpy(op->replyBuf, &op->replyHeader, sizeof(op->replyHeader));
+        asio::async_read(op->connection->sock,
+                         asio::buffer(op->replyBuf + sizeof(op->replyHeader),
+                                      len - sizeof(op->replyHeader)),
+                         [this, op](const asio::error_code& ec, std::size_t) {
+                             _onReplyRead(op, ec);
+                         });
+    }
+
+    void NetworkInterfaceASIO::_onReplyRead(const AsyncOpPtr& op, const asio::error_code& ec) {
+        if (op->completed) {
+            return;
+        }
+        if (ec) {
+            _failOp(op, "receiving the reply", ec);
+            return;
+        }
+
+        Message reply;
+        reply.setData(op->replyBuf, true);
+        op->replyBuf = nullptr;
+
+        if (reply.header().getResponseTo() != op->requestId) {
+            _completeOp(op, Status(ErrorCodes::ProtocolError,
+                                   str::stream() << "Reply from "
+                                                 << op->request.target.toString()
+                                                 << " is to request "
+                                                 << reply.header().getResponseTo()
+                                                 << " rather than " << op->requestId));
+            return;
+        }
+
+        if (reply.operation() == dbCompressed) {
+            Message decompressed;
+            Status status = decompressMessage(reply, &decompressed);
+            if (!status.isOK()) {
+                _completeOp(op, status);
+                return;
+            }
+            reply.reset();
+            reply = decompressed;
+        }
+
+        AsyncConnection& conn = *op->connection;
+        BSONObj output;
+        try {
+            auto commandReply = rpc::makeReply(&reply, conn.clientProtocols, conn.serverProtocols);
+            output = commandReply->getCommandReply().getOwned();
+        }
+        catch (const DBException& ex) {
+            _completeOp(op, ex.toStatus());
+            return;
+        }
+
+        const Date_t finishDate = now();
+        _returnConnection(std::move(op->connection), finishDate);
+        _completeOp(op, RemoteCommandResponse(output, Milliseconds(finishDate - op->start)));
+    }
+
+    void NetworkInterfaceASIO::_failOp(const AsyncOpPtr& op,
+                                       const char* during,
+                                       const asio::error_code& ec) {
+        _completeOp(op, Status(ErrorCodes::HostUnreachable,
+                               str::stream() << "network error while " << during
+                                             << " for command '"
+                                             << op->request.cmdObj.firstElementFieldName()
+                                             << "' on host '" << op->request.target.toString()
+                                             << "': " << ec.message()));
+    }
+
+    void NetworkInterfaceASIO::_completeOp(const AsyncOpPtr& op,
+                                           const TaskExecutor::ResponseStatus& result) {
+        if (op->completed) {
+            return;
+        }
+        op->completed = true;
+
+        asio::error_code ignored;
+        op->timeoutTimer.cancel(ignored);
+        if (op->connection) {
+            // The connection is part way through an exchange, so it cannot be reused. Closing it
+            // aborts any pending reads or writes, whose handlers then find the operation
+            // completed; the connection itself lives on in "op" until they have run.
+            op->connection->sock.close(ignored);
+        }
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            auto iter = std::find(_inProgress.begin(), _inProgress.end(), op);
+            if (iter != _inProgress.end()) {
+                _inProgress.erase(iter);
+            }
+        }
+
+        LOG(2) << "Network status of sending " << op->request.cmdObj.firstElementFieldName() <<
+            " to " << op->request.target << " was " << result.getStatus();
+        op->onFinish(result);
+        signalWorkAvailable();
+    }
+
+    NetworkInterfaceASIO::AsyncConnectionPtr NetworkInterfaceASIO::_takeIdleConnection(
+            const HostAndPort& target,
+            Date_t now) {
+        IdleConnectionMap::iterator hostConns = _idleConnections.find(target);
+        if (hostConns == _idleConnections.end()) {
+            return AsyncConnectionPtr();
+        }
+
+        // Prefer the most recently used connection.
+        IdleConnectionList& conns = hostConns->second;
+        AsyncConnectionPtr conn;
+        while (!conn && !conns.empty()) {
+            conn = std::move(conns.back());
+            conns.pop_back();
+            if (conn->creationDate + kMaxConnectionAge <= now ||
+                isIdleConnectionBroken(conn->sock.native_handle())) {
+                conn.reset();
+            }
+        }
+        if (conns.empty()) {
+            _idleConnections.erase(hostConns);
+        }
+        return conn;
+    }
+
+    void NetworkInterfaceASIO::_returnConnection(AsyncConnectionPtr conn, Date_t now) {
+        if (conn->creationDate + kMaxConnectionAge <= now) {
+            return;
+        }
+        _idleConnections[conn->target].push_back(std::move(conn));
+    }
+
+    void NetworkInterfaceASIO::_cleanUpIdleConnections(Date_t now) {
+        if (now - _lastCleanUpDate < kCleanUpInterval) {
+            return;
+        }
+        _lastCleanUpDate = now;
+
+        IdleConnectionMap::iterator hostConns = _idleConnections.begin();
+        while (hostConns != _idleConnections.end()) {
+            IdleConnectionList& conns = hostConns->second;
+            conns.erase(std::remove_if(conns.begin(),
+                                       conns.end(),
+                                       [now](const AsyncConnectionPtr& conn) {
+                                           return conn->creationDate + kMaxConnectionAge <= now;
+                                       }),
+                        conns.end());
+            if (conns.empty()) {
+                _idleConnections.erase(hostConns++);
+            }
+            else {
+                ++hostConns;
+            }
+        }
+    }
+
+} // namespace executor
+} // namespace mongo
@@ -0,0 +1,215 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <asio.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/executor/network_interface.h"
+#include "mongo/rpc/protocol.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/list.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
+
+namespace mongo {
+namespace executor {
+
+    /**
+     * Implementation of the network interface for use by classes implementing TaskExecutor,
+     * which performs all network operations asynchronously on a single I/O thread.
+     *
+     * Each call to startCommand() becomes an operation driven by an asio reactor: the request is
+     * written and the reply read with non-blocking socket calls, and the request's expiration
+     * date is enforced with a timer rather than with socket timeouts. Any number of commands may
+     * be in flight at once, independently of the number of threads in the process, and a slow
+     * command to one host never delays a command to another.
+     *
+     * Connections are kept in a per-host pool owned by the I/O thread and are retired once they
+     * have been connected for a certain maximum period. A connection which is in an unknown
+     * state, because its command failed, timed out or was canceled part way through, is closed
+     * rather than returned to the pool.
+     *
+     * Establishing a new connection (connecting, negotiating the wire protocol and compression,
+     * and authenticating as the internal user) is a multi-round conversation which is
+     * implemented synchronously by DBClientConnection, so it is handed to a small pool of setup
+     * threads. Once set up, the socket is detached from the DBClientConnection and adopted by the
+     * reactor. This happens once per pooled connection, not once per command.
+     *
+     * SSL connections are not supported, because the SSL session state lives in the blocking
+     * Socket; makeNetworkInterface() selects NetworkInterfaceImpl instead when SSL is enabled.
+     */
+    class NetworkInterfaceASIO final : public NetworkInterface {
+    public:
+        NetworkInterfaceASIO();
+        ~NetworkInterfaceASIO();
+        std::string getDiagnosticString() override;
+        void startup() override;
+        void shutdown() override;
+        void waitForWork() override;
+        void waitForWorkUntil(Date_t when) override;
+        void signalWorkAvailable() override;
+        Date_t now() override;
+        void startCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                          const RemoteCommandRequest& request,
+                          const RemoteCommandCompletionFn& onFinish) override;
+        void cancelCommand(const TaskExecutor::CallbackHandle& cbHandle) override;
+
+    private:
+        /**
+         * A connection to a remote host which has been set up and is ready to run commands.
+         * Only ever used on the I/O thread.
+         */
+        struct AsyncConnection {
+            AsyncConnection(asio::io_service* service,
+                            const HostAndPort& theTarget,
+                            Date_t theCreationDate);
+
+            asio::generic::stream_protocol::socket sock;
+            HostAndPort target;
+            Date_t creationDate;
+            rpc::ProtocolSet clientProtocols;
+            rpc::ProtocolSet serverProtocols;
+            MessageCompressorId compressor;
+        };
+        using AsyncConnectionPtr = std::unique_ptr<AsyncConnection>;
+
+        /**
+         * The result of setting up a connection on a setup thread, handed back to the I/O thread.
+         */
+        struct ConnectionSetupResult {
+            Status status = Status::OK();
+            int fd = -1;
+            int family = 0;
+            rpc::ProtocolSet clientProtocols = rpc::supports::kOpQueryOnly;
+            rpc::ProtocolSet serverProtocols = rpc::supports::kOpQueryOnly;
+            MessageCompressorId compressor = MessageCompressorId::kNoop;
+        };
+
+        /**
+         * State of one command from startCommand() until its completion function runs. Shared
+         * between the I/O thread, which owns all of the fields but the constant ones, and the
+         * pending asio handlers for the operation.
+         */
+        struct AsyncOp {
+            AsyncOp(asio::io_service* service,
+                    const TaskExecutor::CallbackHandle& theCbHandle,
+                    const RemoteCommandRequest& theRequest,
+                    const RemoteCommandCompletionFn& theOnFinish,
+                    Date_t theStart);
+            ~AsyncOp();
+
+            const TaskExecutor::CallbackHandle cbHandle;
+            const RemoteCommandRequest request;
+            const RemoteCommandCompletionFn onFinish;
+            const Date_t start;
+
+            // Set once the command has completed, from which point pending handlers for this
+            // operation must do nothing.
+            bool completed = false;
+
+            asio::steady_timer timeoutTimer;
+            AsyncConnectionPtr connection;
+            std::unique_ptr<Message> toSend;
+            MSGID requestId = 0;
+            MSGHEADER::Value replyHeader;
+            char* replyBuf = nullptr;
+        };
+        using AsyncOpPtr = std::shared_ptr<AsyncOp>;
+        using AsyncOpList = stdx::list<AsyncOpPtr>;
+        using IdleConnectionList = std::vector<AsyncConnectionPtr>;
+        using IdleConnectionMap = std::map<HostAndPort, IdleConnectionList>;
+
+        // The steps of an operation, in order. All but _setupConnection(), which runs on a setup
+        // thread, run on the I/O thread.
+        void _startOp(const AsyncOpPtr& op);
+        void _setupConnection(const AsyncOpPtr& op, Date_t expirationDate);
+        void _onConnectionSetUp(const AsyncOpPtr& op, const ConnectionSetupResult& result);
+        void _sendRequest(const AsyncOpPtr& op);
+        void _onRequestSent(const AsyncOpPtr& op, const asio::error_code& ec);
+        void _onReplyHeaderRead(const AsyncOpPtr& op, const asio::error_code& ec);
+        void _onReplyRead(const AsyncOpPtr& op, const asio::error_code& ec);
+        void _completeOp(const AsyncOpPtr& op, const TaskExecutor::ResponseStatus& result);
+
+        /**
+         * Completes "op" with a network error described by "ec".
+         */
+        void _failOp(const AsyncOpPtr& op, const char* during, const asio::error_code& ec);
+
+        /**
+         * Pool management, on the I/O thread.
+         */
+        AsyncConnectionPtr _takeIdleConnection(const HostAndPort& target, Date_t now);
+        void _returnConnection(AsyncConnectionPtr conn, Date_t now);
+        void _cleanUpIdleConnections(Date_t now);
+
+        void _signalWorkAvailable_inlock();
+
+        asio::io_service _io_service;
+
+        // Runs _io_service, and thereby every handler of every operation.
+        stdx::thread _serviceRunner;
+
+        // Threads which set up new connections, see the class comment.
+        ThreadPool _setupPool;
+
+        // Pooled connections, only accessed on the I/O thread.
+        IdleConnectionMap _idleConnections;
+        Date_t _lastCleanUpDate;
+
+        // Mutex guarding the members below.
+        stdx::mutex _mutex;
+
+        // Operations which have been started but whose completion function has not yet run.
+        AsyncOpList _inProgress;
+
+        // Condition signaled to indicate that the executor, blocked in waitForWorkUntil or
+        // waitForWork, should wake up.
+        stdx::condition_variable _isExecutorRunnableCondition;
+
+        // Flag indicating whether or not the executor associated with this interface is runnable.
+        bool _isExecutorRunnable;
+
+        // Flag indicating when this interface is being shut down (because shutdown() has executed).
+        bool _inShutdown;
+
+        // Flag indicating that startup() has run.
+        bool _started;
+    };
+
+} // namespace executor
+} // namespace mongo
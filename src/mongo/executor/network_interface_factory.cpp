@@ -0,0 +1,99 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/network_interface_factory.h"
+
+#include <string>
+
+#include "mongo/base/status.h"
+#include "mongo/config.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/executor/network_interface_asio.h"
+#include "mongo/executor/network_interface_impl.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/ssl_options.h"
+
+namespace mongo {
+namespace executor {
+
+namespace {
+
+    const char kThreadPoolNetworkInterface[] = "threadPool";
+    const char kASIONetworkInterface[] = "asio";
+
+    std::string taskExecutorNetworkInterface = kThreadPoolNetworkInterface;
+
+    class ExportedNetworkInterfaceParameter : public ExportedServerParameter<std::string> {
+    public:
+        ExportedNetworkInterfaceParameter() :
+            ExportedServerParameter<std::string>(ServerParameterSet::getGlobal(),
+                                                 "taskExecutorNetworkInterface",
+                                                 &taskExecutorNetworkInterface,
+                                                 true,
+                                                 false) {}
+
+        virtual Status validate(const std::string& potentialNewValue) {
+            if (potentialNewValue != kThreadPoolNetworkInterface &&
+                potentialNewValue != kASIONetworkInterface) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "taskExecutorNetworkInterface must be either '"
+                                            << kThreadPoolNetworkInterface << "' or '"
+                                            << kASIONetworkInterface << "'");
+            }
+            return Status::OK();
+        }
+    } exportedNetworkInterfaceParam;
+
+}  // namespace
+
+    std::unique_ptr<NetworkInterface> makeNetworkInterface() {
+        if (taskExecutorNetworkInterface == kASIONetworkInterface) {
+#ifdef MONGO_CONFIG_SSL
+            // Outgoing connections are only secured in these modes, see DBClientConnection.
+            const int sslMode = sslGlobalParams.sslMode.load();
+            if (sslMode == SSLParams::SSLMode_preferSSL ||
+                sslMode == SSLParams::SSLMode_requireSSL) {
+                warning() << "taskExecutorNetworkInterface=" << kASIONetworkInterface
+                          << " does not support SSL; using " << kThreadPoolNetworkInterface
+                          << " instead";
+                return stdx::make_unique<NetworkInterfaceImpl>();
+            }
+#endif
+            return stdx::make_unique<NetworkInterfaceASIO>();
+        }
+        return stdx::make_unique<NetworkInterfaceImpl>();
+    }
+
+} // namespace executor
+} // namespace mongo
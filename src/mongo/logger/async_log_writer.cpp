@@ -0,0 +1,256 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/logger/async_log_writer.h"
+
+#include <set>
+#include <sstream>
+
+#include "mongo/logger/message_event.h"
+#include "mongo/logger/message_event_utf8_encoder.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace logger {
+
+namespace {
+
+    // Every AsyncLogWriter, for flushAll() and getCombinedStats().  Function statics, as log
+    // writers may be made during static initialization.
+    stdx::mutex& registryMutex() {
+        static stdx::mutex mutex;
+        return mutex;
+    }
+
+    std::set<AsyncLogWriter*>& registry() {
+        static std::set<AsyncLogWriter*> writers;
+        return writers;
+    }
+
+}  // namespace
+
+    AsyncLogWriter::AsyncLogWriter(RotatableFileWriter* writer,
+                                   size_t maxQueuedBytes,
+                                   OverflowPolicy policy) :
+        _writer(writer),
+        _maxQueuedBytes(maxQueuedBytes),
+        _policy(policy),
+        _running(false),
+        _inShutdown(false),
+        _droppedReported(0) {
+
+        stdx::lock_guard<stdx::mutex> lk(registryMutex());
+        registry().insert(this);
+    }
+
+    AsyncLogWriter::~AsyncLogWriter() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(registryMutex());
+            registry().erase(this);
+        }
+        shutdown();
+    }
+
+    void AsyncLogWriter::start() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        invariant(!_running && !_inShutdown);
+        _running = true;
+        _thread = stdx::thread(&AsyncLogWriter::_run, this);
+    }
+
+    void AsyncLogWriter::shutdown() {
+        bool wasRunning;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            wasRunning = _running;
+            _running = false;
+            _inShutdown = true;
+            _queueNotEmpty.notify_all();
+            _queueNotFull.notify_all();
+        }
+        if (wasRunning) {
+            _thread.join();
+        }
+        flush();
+    }
+
+    Status AsyncLogWriter::append(std::string line) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        if (!_running) {
+            lk.unlock();
+            return writeThrough(line);
+        }
+
+        // A line longer than the whole queue is still taken once nothing is queued or being
+        // written.
+        if (_stats.queuedBytes != 0 && _stats.queuedBytes + line.size() > _maxQueuedBytes) {
+            if (_policy == kDrop) {
+                ++_stats.dropped;
+                return Status::OK();
+            }
+            ++_stats.blocked;
+            while (_running && _stats.queuedBytes != 0 &&
+                   _stats.queuedBytes + line.size() > _maxQueuedBytes) {
+                _queueNotFull.wait(lk);
+            }
+            if (!_running) {
+                lk.unlock();
+                return writeThrough(line);
+            }
+        }
+
+        _stats.queuedBytes += line.size();
+        _queue.push_back(std::string());
+        _queue.back().swap(line);
+        if (_queue.size() == 1) {
+            _queueNotEmpty.notify_one();
+        }
+        return Status::OK();
+    }
+
+    Status AsyncLogWriter::writeThrough(StringData line) {
+        RotatableFileWriter::Use useWriter(_writer);
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _writeQueued(&useWriter, lk);
+        lk.unlock();
+
+        Status status = useWriter.status();
+        if (!status.isOK())
+            return status;
+        useWriter.stream().write(line.rawData(), line.size()).flush();
+        status = useWriter.status();
+
+        lk.lock();
+        if (status.isOK()) {
+            ++_stats.written;
+        }
+        return status;
+    }
+
+    Status AsyncLogWriter::flush() {
+        RotatableFileWriter::Use useWriter(_writer);
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        return _writeQueued(&useWriter, lk);
+    }
+
+    AsyncLogWriter::Stats AsyncLogWriter::getStats() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _stats;
+    }
+
+    void AsyncLogWriter::flushAll() {
+        stdx::lock_guard<stdx::mutex> lk(registryMutex());
+        for (std::set<AsyncLogWriter*>::const_iterator it = registry().begin();
+             it != registry().end(); ++it) {
+            (*it)->flush();
+        }
+    }
+
+    AsyncLogWriter::Stats AsyncLogWriter::getCombinedStats() {
+        Stats combined;
+        stdx::lock_guard<stdx::mutex> lk(registryMutex());
+        for (std::set<AsyncLogWriter*>::const_iterator it = registry().begin();
+             it != registry().end(); ++it) {
+            const Stats stats = (*it)->getStats();
+            combined.queuedBytes += stats.queuedBytes;
+            combined.written += stats.written;
+            combined.dropped += stats.dropped;
+            combined.blocked += stats.blocked;
+        }
+        return combined;
+    }
+
+    void AsyncLogWriter::_run() {
+        setThreadName("AsyncLogWriter");
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (true) {
+            while (_queue.empty() && !_inShutdown) {
+                _queueNotEmpty.wait(lk);
+            }
+            // shutdown() writes out the rest.
+            if (_inShutdown)
+                return;
+
+            lk.unlock();
+            RotatableFileWriter::Use useWriter(_writer);
+            lk.lock();
+            _writeQueued(&useWriter, lk);
+        }
+    }
+
+    Status AsyncLogWriter::_writeQueued(RotatableFileWriter::Use* useWriter,
+                                        stdx::unique_lock<stdx::mutex>& lk) {
+        std::vector<std::string> lines;
+        lines.swap(_queue);
+        const unsigned long long dropped = _stats.dropped - _droppedReported;
+        _droppedReported = _stats.dropped;
+        if (lines.empty() && !dropped)
+            return Status::OK();
+        lk.unlock();
+
+        Status status = useWriter->status();
+        if (status.isOK()) {
+            std::ostream& os = useWriter->stream();
+            if (dropped) {
+                std::ostringstream note;
+                note << dropped << " log lines were dropped, the log queue was full";
+                const std::string noteStr = note.str();
+                MessageEventDetailsEncoder().encode(
+                        MessageEventEphemeral(Date_t::now(),
+                                              LogSeverity::Warning(),
+                                              "AsyncLogWriter",
+                                              noteStr),
+                        os);
+            }
+            for (size_t i = 0; i < lines.size(); ++i) {
+                os.write(lines[i].data(), lines[i].size());
+            }
+            os.flush();
+            status = useWriter->status();
+        }
+
+        size_t bytes = 0;
+        for (size_t i = 0; i < lines.size(); ++i) {
+            bytes += lines[i].size();
+        }
+
+        lk.lock();
+        _stats.queuedBytes -= bytes;
+        if (status.isOK()) {
+            _stats.written += lines.size();
+        }
+        _queueNotFull.notify_all();
+        return status;
+    }
+
+}  // namespace logger
+}  // namespace mongo
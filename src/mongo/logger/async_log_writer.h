@@ -0,0 +1,154 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/logger/rotatable_file_writer.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+namespace logger {
+
+    /**
+     * Writes already encoded log lines to a RotatableFileWriter from a background thread, so that
+     * the threads which log don't wait for the file.
+     *
+     * Lines are queued, up to a bound in bytes.  When the queue is full, appending either waits
+     * for the writer thread to make room (kBlock), or drops the line (kDrop), counting it; the
+     * number of lines dropped is noted in the log once there is room again.
+     *
+     * Lines written through writeThrough() and flush() go out on the calling thread, after every
+     * line queued before them, so messages logged just before the process exits are not lost.
+     * Until start() and after shutdown(), append() also writes through.
+     *
+     * Self-synchronizing.  The writer's lock is always taken before the queue's.
+     */
+    class AsyncLogWriter {
+        MONGO_DISALLOW_COPYING(AsyncLogWriter);
+    public:
+        enum OverflowPolicy { kBlock, kDrop };
+
+        struct Stats {
+            Stats() : queuedBytes(0), written(0), dropped(0), blocked(0) {}
+
+            size_t queuedBytes;
+            unsigned long long written;
+            unsigned long long dropped;
+            unsigned long long blocked;
+        };
+
+        /**
+         * Constructs a writer that queues up to "maxQueuedBytes" for "writer", which it does not
+         * own.  The caller must keep "writer" in scope at least as long as the constructed object.
+         */
+        AsyncLogWriter(RotatableFileWriter* writer, size_t maxQueuedBytes, OverflowPolicy policy);
+
+        /**
+         * Writes whatever is still queued, stopping the writer thread if it runs.
+         */
+        ~AsyncLogWriter();
+
+        /**
+         * Starts the writer thread.  Call at most once.
+         */
+        void start();
+
+        /**
+         * Writes out what is queued and stops the writer thread.  Later lines all write through.
+         */
+        void shutdown();
+
+        /**
+         * Queues "line" for the writer thread.
+         */
+        Status append(std::string line);
+
+        /**
+         * Writes out what is queued, then "line", on the calling thread.
+         */
+        Status writeThrough(StringData line);
+
+        /**
+         * Writes out what is queued on the calling thread.
+         */
+        Status flush();
+
+        Stats getStats() const;
+
+        /**
+         * Flushes every AsyncLogWriter in the process.  Call before exiting.
+         */
+        static void flushAll();
+
+        /**
+         * Returns the sum of the stats of every AsyncLogWriter in the process.
+         */
+        static Stats getCombinedStats();
+
+    private:
+        void _run();
+
+        /**
+         * Writes out the queue through "useWriter".  Call holding "lk" on _mutex, which is
+         * released while writing.
+         */
+        Status _writeQueued(RotatableFileWriter::Use* useWriter,
+                            stdx::unique_lock<stdx::mutex>& lk);
+
+        RotatableFileWriter* const _writer;
+        const size_t _maxQueuedBytes;
+        const OverflowPolicy _policy;
+
+        // Guards the members below.
+        mutable stdx::mutex _mutex;
+
+        // Signaled when there is something to write, or on shutdown.
+        stdx::condition_variable _queueNotEmpty;
+
+        // Signaled when queued lines were written, or on shutdown.
+        stdx::condition_variable _queueNotFull;
+
+        std::vector<std::string> _queue;
+        bool _running;
+        bool _inShutdown;
+        unsigned long long _droppedReported;
+        Stats _stats;
+
+        stdx::thread _thread;
+    };
+
+}  // namespace logger
+}  // namespace mongo
@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mongo/logger/async_log_writer.h"
+#include "mongo/logger/rotatable_file_writer.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+    using namespace mongo;
+    using namespace mongo::logger;
+
+    const std::string logFileName("LogTest_AsyncLogWriter.txt");
+
+    class AsyncLogWriterTest : public mongo::unittest::Test {
+    public:
+        AsyncLogWriterTest() {
+            unlink(logFileName.c_str());
+            ASSERT_OK(RotatableFileWriter::Use(&_file).setFileName(logFileName, false));
+        }
+
+        virtual ~AsyncLogWriterTest() {
+            unlink(logFileName.c_str());
+        }
+
+    protected:
+        std::vector<std::string> readLines() {
+            std::vector<std::string> lines;
+            std::ifstream ifs(logFileName.c_str());
+            std::string line;
+            while (std::getline(ifs, line)) {
+                lines.push_back(line);
+            }
+            return lines;
+        }
+
+        RotatableFileWriter _file;
+    };
+
+    TEST_F(AsyncLogWriterTest, WritesInOrder) {
+        AsyncLogWriter writer(&_file, 1024 * 1024, AsyncLogWriter::kBlock);
+        writer.start();
+        ASSERT_OK(writer.append("line 1\n"));
+        ASSERT_OK(writer.append("line 2\n"));
+        ASSERT_OK(writer.writeThrough("line 3\n"));
+        ASSERT_OK(writer.append("line 4\n"));
+        ASSERT_OK(writer.flush());
+
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(4U, lines.size());
+        ASSERT_EQUALS("line 1", lines[0]);
+        ASSERT_EQUALS("line 2", lines[1]);
+        ASSERT_EQUALS("line 3", lines[2]);
+        ASSERT_EQUALS("line 4", lines[3]);
+
+        AsyncLogWriter::Stats stats = writer.getStats();
+        ASSERT_EQUALS(4U, stats.written);
+        ASSERT_EQUALS(0U, stats.dropped);
+        ASSERT_EQUALS(0U, stats.queuedBytes);
+    }
+
+    TEST_F(AsyncLogWriterTest, WritesThroughWhenNotRunning) {
+        AsyncLogWriter writer(&_file, 1024 * 1024, AsyncLogWriter::kBlock);
+        ASSERT_OK(writer.append("before start\n"));
+        ASSERT_EQUALS(1U, readLines().size());
+
+        writer.start();
+        writer.shutdown();
+        ASSERT_OK(writer.append("after shutdown\n"));
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(2U, lines.size());
+        ASSERT_EQUALS("after shutdown", lines[1]);
+    }
+
+    TEST_F(AsyncLogWriterTest, ShutdownWritesQueuedLines) {
+        {
+            AsyncLogWriter writer(&_file, 1024 * 1024, AsyncLogWriter::kBlock);
+            writer.start();
+            for (int i = 0; i < 1000; i++) {
+                ASSERT_OK(writer.append("queued\n"));
+            }
+        }
+        ASSERT_EQUALS(1000U, readLines().size());
+    }
+
+    TEST_F(AsyncLogWriterTest, BlockingKeepsEveryLine) {
+        AsyncLogWriter writer(&_file, 64, AsyncLogWriter::kBlock);
+        writer.start();
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_OK(writer.append("a line of 20 bytes.\n"));
+        }
+        ASSERT_OK(writer.flush());
+        ASSERT_EQUALS(1000U, readLines().size());
+        ASSERT_EQUALS(0U, writer.getStats().dropped);
+    }
+
+    TEST_F(AsyncLogWriterTest, DropsWhenFullAndNotesIt) {
+        AsyncLogWriter writer(&_file, 64, AsyncLogWriter::kDrop);
+        writer.start();
+        {
+            // Holding the file keeps the writer thread from emptying the queue.
+            RotatableFileWriter::Use useFile(&_file);
+            for (int i = 0; i < 10; i++) {
+                ASSERT_OK(writer.append("a line of 20 bytes.\n"));
+            }
+        }
+        ASSERT_OK(writer.flush());
+
+        AsyncLogWriter::Stats stats = writer.getStats();
+        ASSERT_GREATER_THAN(stats.dropped, 0U);
+        ASSERT_EQUALS(10U, stats.written + stats.dropped);
+
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(stats.written + 1, lines.size());
+        bool noted = false;
+        for (size_t i = 0; i < lines.size(); i++) {
+            noted = noted || lines[i].find("log lines were dropped") != std::string::npos;
+        }
+        ASSERT_TRUE(noted);
+    }
+
+    TEST_F(AsyncLogWriterTest, LongLineIsNotDropped) {
+        AsyncLogWriter writer(&_file, 8, AsyncLogWriter::kDrop);
+        writer.start();
+        ASSERT_OK(writer.append("a line longer than the queue\n"));
+        ASSERT_OK(writer.flush());
+        ASSERT_EQUALS(1U, readLines().size());
+        ASSERT_EQUALS(0U, writer.getStats().dropped);
+    }
+
+}  // namespace
@@ -89,10 +89,9 @@ namespace rpc {
         qr.setCursorId(0);
         qr.setStartingFrom(0);
         qr.setNReturned(1);
+        message->setPooledData(qr.view2ptr(), _builder.getSize());
         _builder.decouple();
 
-        message->setData(qr.view2ptr(), true);
-
         _state = State::kDone;
         return std::move(message);
     }
@@ -56,7 +56,7 @@ namespace rpc {
         std::unique_ptr<Message> done() final;
 
     private:
-        BufBuilder _builder{};
+        PooledBufBuilder _builder{};
         std::unique_ptr<Message> _message;
         State _state{State::kMetadata};
     };
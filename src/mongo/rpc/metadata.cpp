@@ -31,8 +31,11 @@
 #include "mongo/rpc/metadata.h"
 
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/admission_context.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
+#include "mongo/rpc/metadata/trace_metadata.h"
 
 namespace mongo {
 namespace rpc {
@@ -48,7 +51,12 @@ namespace rpc {
         }
         ServerSelectionMetadata::get(txn) = std::move(swServerSelectionMetadata.getValue());
 
-        return Status::OK();
+        auto traceStatus = TraceMetadata::readFromMetadata(txn->getClient(), metadataObj);
+        if (!traceStatus.isOK()) {
+            return traceStatus;
+        }
+
+        return AdmissionContext::readFromMetadata(txn, metadataObj);
     }
 
     Status writeRequestMetadata(OperationContext* txn, BSONObjBuilder* metadataBob) {
@@ -59,6 +67,9 @@ namespace rpc {
         if (!ssStatus.isOK()) {
             return ssStatus;
         }
+        AdmissionContext::writeToMetadata(txn, metadataBob);
+        const TraceMetadata& trace = TraceMetadata::get(txn->getClient());
+        trace.writeToMetadata(trace.getCurrentSpanId(), metadataBob);
         return Status::OK();
     }
 
@@ -66,6 +77,13 @@ namespace rpc {
         BSONObjBuilder commandBob;
         BSONObjBuilder metadataBob;
 
+        // The trace of a request from mongos sits at the top level, wrapped command or not.
+        BSONElement traceEl = legacyCmdObj[TraceMetadata::kFieldName];
+        if (!traceEl.eoo()) {
+            metadataBob.append(traceEl);
+            legacyCmdObj = legacyCmdObj.removeField(TraceMetadata::kFieldName);
+        }
+
         auto upconvertStatus = ServerSelectionMetadata::upconvert(legacyCmdObj,
                                                                   queryFlags,
                                                                   &commandBob,
@@ -74,6 +92,15 @@ namespace rpc {
             return upconvertStatus;
         }
 
+        // Like $readPreference, an admission priority can be sent next to a wrapped command.
+        const auto firstElFieldName = legacyCmdObj.firstElementFieldName();
+        if (firstElFieldName == StringData("$query") || firstElFieldName == StringData("query")) {
+            BSONElement priorityEl = legacyCmdObj[AdmissionContext::kMetadataFieldName];
+            if (!priorityEl.eoo()) {
+                metadataBob.append(priorityEl);
+            }
+        }
+
         return std::make_tuple(commandBob.obj(), metadataBob.obj());
     }
 
@@ -89,6 +116,11 @@ namespace rpc {
             return downconvertStatus;
         }
 
+        BSONElement traceEl = metadata[TraceMetadata::kFieldName];
+        if (!traceEl.eoo()) {
+            legacyCommandBob.append(traceEl);
+        }
+
         return std::make_tuple(legacyCommandBob.obj(), std::move(legacyQueryFlags));
     }
 
@@ -0,0 +1,297 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/rpc/metadata/trace_metadata.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/profile_ring_buffer.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/sock.h"
+
+namespace mongo {
+namespace rpc {
+
+    // mongos traces one in 'traceSampleRate' of the operations it routes. 0 turns tracing off.
+    MONGO_EXPORT_SERVER_PARAMETER(traceSampleRate, int, 0);
+
+    // The number of spans the buffer holds.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(traceSpanBufferSize, int, 10000);
+
+    const ClientBasic::Decoration<TraceMetadata> TraceMetadata::get =
+        ClientBasic::declareDecoration<TraceMetadata>();
+
+    const char TraceMetadata::kFieldName[] = "$trace";
+
+namespace {
+
+    const char kIdFieldName[] = "id";
+    const char kSpanFieldName[] = "span";
+
+    AtomicUInt64 operationCounter;
+
+    ProfileRingBuffer* getSpanBuffer() {
+        static ProfileRingBuffer* const buffer =
+            new ProfileRingBuffer(std::max(traceSpanBufferSize, 1));
+        return buffer;
+    }
+
+    const std::string& thisHost() {
+        static const std::string host =
+            str::stream() << getHostNameCached() << ":" << serverGlobalParams.port;
+        return host;
+    }
+
+    void recordSpan(long long traceId,
+                    long long spanId,
+                    long long parentSpanId,
+                    StringData name,
+                    Date_t start,
+                    long long micros,
+                    const BSONObj& info) {
+        BSONObjBuilder span;
+        span.append("trace", traceId);
+        span.append("span", spanId);
+        span.append("parent", parentSpanId);
+        span.append("name", name);
+        span.append("host", thisHost());
+        span.append("start", start);
+        span.append("micros", micros);
+        span.appendElements(info);
+        getSpanBuffer()->record(span.obj());
+    }
+
+}  // namespace
+
+    void TraceMetadata::startOperation(ClientBasic* client) {
+        TraceMetadata& trace = get(client);
+        trace.reset();
+
+        const int rate = traceSampleRate;
+        if (rate > 0 && operationCounter.fetchAndAdd(1) % rate == 0) {
+            trace._traceId = newId();
+        }
+    }
+
+    Status TraceMetadata::readFromMetadata(ClientBasic* client, const BSONObj& metadataObj) {
+        const BSONElement traceElt = metadataObj[kFieldName];
+        if (traceElt.eoo()) {
+            return Status::OK();
+        }
+        if (traceElt.type() != Object) {
+            return Status(ErrorCodes::TypeMismatch,
+                          str::stream() << kFieldName << " must be an object");
+        }
+
+        const BSONObj traceObj = traceElt.Obj();
+        const BSONElement idElt = traceObj[kIdFieldName];
+        const BSONElement spanElt = traceObj[kSpanFieldName];
+        if (!idElt.isNumber() || !spanElt.isNumber()) {
+            return Status(ErrorCodes::TypeMismatch,
+                          str::stream() << kFieldName << " must have numeric " << kIdFieldName
+                                        << " and " << kSpanFieldName << " fields");
+        }
+
+        TraceMetadata& trace = get(client);
+        trace._traceId = idElt.numberLong();
+        trace._currentSpanId = spanElt.numberLong();
+        return Status::OK();
+    }
+
+    long long TraceMetadata::newId() {
+        static SimpleMutex mutex("traceIds");
+        static PseudoRandom random(std::unique_ptr<SecureRandom>(SecureRandom::create())
+                                       ->nextInt64());
+
+        SimpleMutex::scoped_lock lk(mutex);
+        long long id;
+        do {
+            // Positive, so the ids read the same in every client
+            id = random.nextInt64() & std::numeric_limits<long long>::max();
+        } while (id == 0);
+        return id;
+    }
+
+    void TraceMetadata::reset() {
+        _traceId = 0;
+        _currentSpanId = 0;
+    }
+
+    void TraceMetadata::writeToMetadata(long long spanId, BSONObjBuilder* metadataBob) const {
+        if (!isTraced()) {
+            return;
+        }
+
+        BSONObjBuilder traceBob(metadataBob->subobjStart(kFieldName));
+        traceBob.append(kIdFieldName, _traceId);
+        traceBob.append(kSpanFieldName, spanId);
+    }
+
+    void TraceSpan::start(ClientBasic* client, StringData name) {
+        finish();
+        if (!client) {
+            return;
+        }
+
+        const TraceMetadata& trace = TraceMetadata::get(client);
+        if (!trace.isTraced()) {
+            return;
+        }
+
+        _traceId = trace.getTraceId();
+        _spanId = TraceMetadata::newId();
+        _parentSpanId = trace.getCurrentSpanId();
+        _name = name.toString();
+        _start = Date_t::now();
+        _timer.reset();
+    }
+
+    void TraceSpan::finish(const BSONObj& info) {
+        if (!isActive()) {
+            return;
+        }
+
+        recordSpan(_traceId, _spanId, _parentSpanId, _name, _start, _timer.micros(), info);
+        _spanId = 0;
+    }
+
+    void TraceSpan::writeToMetadata(BSONObjBuilder* metadataBob) const {
+        if (!isActive()) {
+            return;
+        }
+
+        BSONObjBuilder traceBob(metadataBob->subobjStart(TraceMetadata::kFieldName));
+        traceBob.append(kIdFieldName, _traceId);
+        traceBob.append(kSpanFieldName, _spanId);
+    }
+
+    BSONObj TraceSpan::addToQuery(const BSONObj& query) const {
+        if (!isActive()) {
+            return query;
+        }
+
+        BSONObjBuilder wrapped;
+        StringData first = query.firstElementFieldName();
+        if (first == "$query" || first == "query") {
+            wrapped.appendElements(query);
+        }
+        else {
+            wrapped.append("$query", query);
+        }
+        writeToMetadata(&wrapped);
+        return wrapped.obj();
+    }
+
+    ScopedTraceSpan::ScopedTraceSpan(ClientBasic* client, StringData name)
+        : _client(client), _span(client, name) {
+        if (_span.isActive()) {
+            TraceMetadata& trace = TraceMetadata::get(_client);
+            _parentSpanId = trace._currentSpanId;
+            trace._currentSpanId = _span.getId();
+        }
+    }
+
+    ScopedTraceSpan::~ScopedTraceSpan() {
+        finish();
+    }
+
+    void ScopedTraceSpan::finish(const BSONObj& info) {
+        if (_finished) {
+            return;
+        }
+        _finished = true;
+
+        if (_span.isActive()) {
+            // The trace may have been reset under us, by an operation nested in this one.
+            TraceMetadata& trace = TraceMetadata::get(_client);
+            if (trace._currentSpanId == _span.getId()) {
+                trace._currentSpanId = _parentSpanId;
+            }
+            _span.finish(info);
+        }
+    }
+
+    void recordTraceSpan(ClientBasic* client,
+                         StringData name,
+                         Date_t start,
+                         long long micros,
+                         const BSONObj& info) {
+        if (!client) {
+            return;
+        }
+
+        const TraceMetadata& trace = TraceMetadata::get(client);
+        if (!trace.isTraced()) {
+            return;
+        }
+
+        recordSpan(trace.getTraceId(),
+                   TraceMetadata::newId(),
+                   trace.getCurrentSpanId(),
+                   name,
+                   start,
+                   micros,
+                   info);
+    }
+
+    long long appendTraceSpans(long long traceId,
+                               long long afterSeq,
+                               int maxBytes,
+                               BSONArrayBuilder* spans) {
+        std::vector<ProfileRingBuffer::Sample> samples;
+        long long lastSeq = getSpanBuffer()->getSince(afterSeq, &samples);
+
+        for (const ProfileRingBuffer::Sample& sample : samples) {
+            if (traceId != 0 && sample.entry["trace"].numberLong() != traceId) {
+                continue;
+            }
+            if (spans->len() + sample.entry.objsize() > maxBytes) {
+                return sample.seq - 1;
+            }
+            spans->append(sample.entry);
+        }
+        return lastSeq;
+    }
+
+    long long numTraceSpansRecorded() {
+        return getSpanBuffer()->numRecorded();
+    }
+
+}  // namespace rpc
+}  // namespace mongo
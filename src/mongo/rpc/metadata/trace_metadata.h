@@ -0,0 +1,201 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/client_basic.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+    class Status;
+
+namespace rpc {
+
+    /**
+     * The distributed trace a client's current operation belongs to, if it is being traced.
+     *
+     * mongos traces one in traceSampleRate of the operations it routes. Each of its requests to a
+     * shard carries the trace id and the id of the mongos span that made the request, as the
+     * request metadata field {$trace: {id: <trace id>, span: <span id>}}. Legacy requests carry it
+     * next to the $query of a wrapped query or command. The shard files the spans of its work
+     * under that span, so the spans of one trace from every node make up a tree.
+     *
+     * Kept on the Client rather than the OperationContext, as mongos has no OperationContext
+     * for the operations it routes.
+     */
+    class TraceMetadata {
+    public:
+        static const ClientBasic::Decoration<TraceMetadata> get;
+
+        static const char kFieldName[];
+
+        /**
+         * Called as mongos starts routing an operation for "client": starts a new trace for one in
+         * traceSampleRate operations, and forgets any earlier one otherwise.
+         */
+        static void startOperation(ClientBasic* client);
+
+        /**
+         * Reads the trace sent in "metadataObj", or in a legacy query, into "client". Leaves the
+         * client's trace alone when there is none, so nested operations keep their parent's.
+         */
+        static Status readFromMetadata(ClientBasic* client, const BSONObj& metadataObj);
+
+        /**
+         * Returns a new id for a span, or a trace. Never 0.
+         */
+        static long long newId();
+
+        void reset();
+
+        bool isTraced() const { return _traceId != 0; }
+
+        long long getTraceId() const { return _traceId; }
+
+        /**
+         * The span which new spans of this client are children of.
+         */
+        long long getCurrentSpanId() const { return _currentSpanId; }
+
+        /**
+         * Appends the $trace field which makes "spanId" the parent of the receiver's spans, if the
+         * operation is traced.
+         */
+        void writeToMetadata(long long spanId, BSONObjBuilder* metadataBob) const;
+
+    private:
+        friend class ScopedTraceSpan;
+
+        long long _traceId = 0;
+        long long _currentSpanId = 0;
+    };
+
+    /**
+     * One timed piece of a traced operation. When finished it is recorded into this node's span
+     * buffer as {trace, span, parent, name, host, start, micros}, plus any fields given to
+     * finish(). Does nothing if the operation isn't traced.
+     *
+     * Its id is known once it starts, so it can be sent along with a request before the reply is
+     * back, and several can be open at once, as for the requests to each shard.
+     */
+    class TraceSpan {
+        MONGO_DISALLOW_COPYING(TraceSpan);
+    public:
+        TraceSpan() = default;
+
+        /**
+         * Starts the span as a child of the current span of "client".
+         */
+        TraceSpan(ClientBasic* client, StringData name) { start(client, name); }
+
+        ~TraceSpan() { finish(); }
+
+        void start(ClientBasic* client, StringData name);
+
+        /**
+         * Records the span, with the fields of "info". Later calls do nothing.
+         */
+        void finish(const BSONObj& info = BSONObj());
+
+        bool isActive() const { return _spanId != 0; }
+
+        long long getId() const { return _spanId; }
+
+        /**
+         * Appends the $trace field which makes this span the parent of the receiver's spans.
+         */
+        void writeToMetadata(BSONObjBuilder* metadataBob) const;
+
+        /**
+         * Returns "query", a legacy query or command, with this span's $trace field added next to
+         * its $query, wrapping it first if needed. Returns "query" if the span isn't active.
+         */
+        BSONObj addToQuery(const BSONObj& query) const;
+
+    private:
+        long long _traceId = 0;
+        long long _spanId = 0;
+        long long _parentSpanId = 0;
+        std::string _name;
+        Date_t _start;
+        Timer _timer;
+    };
+
+    /**
+     * A TraceSpan which is the current span of its client while in scope, so that the spans
+     * started within it are its children.
+     */
+    class ScopedTraceSpan {
+        MONGO_DISALLOW_COPYING(ScopedTraceSpan);
+    public:
+        ScopedTraceSpan(ClientBasic* client, StringData name);
+        ~ScopedTraceSpan();
+
+        /**
+         * Records the span with the fields of "info" and makes its parent current again.
+         */
+        void finish(const BSONObj& info = BSONObj());
+
+    private:
+        ClientBasic* const _client;
+        TraceSpan _span;
+        long long _parentSpanId = 0;
+        bool _finished = false;
+    };
+
+    /**
+     * Records a span that was timed elsewhere, such as a whole operation on mongod, as a child of
+     * the current span of "client", if its operation is traced.
+     */
+    void recordTraceSpan(ClientBasic* client,
+                         StringData name,
+                         Date_t start,
+                         long long micros,
+                         const BSONObj& info);
+
+    /**
+     * Appends the spans in this node's buffer recorded after sequence number "afterSeq" to
+     * "spans", those of trace "traceId" only unless it is 0. Stops short of "maxBytes". Returns
+     * the sequence number of the last span looked at, for the next call's "afterSeq".
+     */
+    long long appendTraceSpans(long long traceId,
+                               long long afterSeq,
+                               int maxBytes,
+                               BSONArrayBuilder* spans);
+
+    /**
+     * The number of spans this node has ever recorded.
+     */
+    long long numTraceSpansRecorded();
+
+}  // namespace rpc
+}  // namespace mongo
@@ -0,0 +1,177 @@
+/*
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <tuple>
+
+#include "mongo/base/status.h"
+#include "mongo/db/client.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/service_context_noop.h"
+#include "mongo/rpc/metadata.h"
+#include "mongo/rpc/metadata/trace_metadata.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+    using namespace mongo;
+    using namespace mongo::rpc;
+    using mongo::unittest::assertGet;
+
+    TEST(TraceMetadata, ReadFromMetadata) {
+        auto service = stdx::make_unique<ServiceContextNoop>();
+        auto client = service->makeClient("TraceMetadataTest");
+        TraceMetadata& trace = TraceMetadata::get(client.get());
+
+        // No $trace field - not traced.
+        ASSERT_OK(TraceMetadata::readFromMetadata(client.get(), BSONObj()));
+        ASSERT_FALSE(trace.isTraced());
+
+        ASSERT_OK(TraceMetadata::readFromMetadata(client.get(),
+                                                  BSON("$trace" << BSON("id" << 12LL <<
+                                                                        "span" << 34LL))));
+        ASSERT_TRUE(trace.isTraced());
+        ASSERT_EQ(12LL, trace.getTraceId());
+        ASSERT_EQ(34LL, trace.getCurrentSpanId());
+
+        BSONObjBuilder metadataBob;
+        trace.writeToMetadata(56LL, &metadataBob);
+        ASSERT_EQ(BSON("$trace" << BSON("id" << 12LL << "span" << 56LL)), metadataBob.obj());
+
+        ASSERT_EQ(ErrorCodes::TypeMismatch,
+                  TraceMetadata::readFromMetadata(client.get(), BSON("$trace" << 1)).code());
+        ASSERT_EQ(ErrorCodes::TypeMismatch,
+                  TraceMetadata::readFromMetadata(client.get(),
+                                                  BSON("$trace" << BSON("id" << 1))).code());
+
+        trace.reset();
+        ASSERT_FALSE(trace.isTraced());
+        BSONObjBuilder untracedBob;
+        trace.writeToMetadata(56LL, &untracedBob);
+        ASSERT_EQ(BSONObj(), untracedBob.obj());
+    }
+
+    TEST(TraceMetadata, Upconvert) {
+        const BSONObj traceObj = BSON("id" << 1LL << "span" << 2LL);
+
+        // Next to a wrapped command
+        auto wrapped = assertGet(upconvertRequestMetadata(
+            BSON("$query" << BSON("ping" << 1) << "$trace" << traceObj), 0));
+        ASSERT_EQ(BSON("ping" << 1), std::get<0>(wrapped));
+        ASSERT_EQ(BSON("$trace" << traceObj), std::get<1>(wrapped));
+
+        // At the top level of an unwrapped command
+        auto unwrapped = assertGet(upconvertRequestMetadata(
+            BSON("count" << "foo" << "query" << BSONObj() << "$trace" << traceObj), 0));
+        ASSERT_EQ(BSON("count" << "foo" << "query" << BSONObj()), std::get<0>(unwrapped));
+        ASSERT_EQ(BSON("$trace" << traceObj), std::get<1>(unwrapped));
+    }
+
+    TEST(TraceMetadata, Downconvert) {
+        const BSONObj traceObj = BSON("id" << 1LL << "span" << 2LL);
+        auto legacy = assertGet(downconvertRequestMetadata(BSON("ping" << 1),
+                                                           BSON("$trace" << traceObj)));
+        ASSERT_EQ(BSON("ping" << 1 << "$trace" << traceObj), std::get<0>(legacy));
+        ASSERT_EQ(0, std::get<1>(legacy));
+    }
+
+    TEST(TraceSpan, AddToQuery) {
+        auto service = stdx::make_unique<ServiceContextNoop>();
+        auto client = service->makeClient("TraceSpanTest");
+        const BSONObj query = BSON("x" << 1);
+
+        // Untraced - the query is sent as is.
+        {
+            TraceSpan span(client.get(), "untraced");
+            ASSERT_FALSE(span.isActive());
+            ASSERT_EQ(query, span.addToQuery(query));
+        }
+
+        ASSERT_OK(TraceMetadata::readFromMetadata(client.get(),
+                                                  BSON("$trace" << BSON("id" << 7LL <<
+                                                                        "span" << 8LL))));
+        TraceSpan span(client.get(), "traced");
+        ASSERT_TRUE(span.isActive());
+        const BSONObj traceObj = BSON("id" << 7LL << "span" << span.getId());
+
+        // A bare query is wrapped
+        ASSERT_EQ(BSON("$query" << query << "$trace" << traceObj), span.addToQuery(query));
+
+        // A wrapped query gets the field next to its $query
+        const BSONObj wrapped = BSON("query" << query << "orderby" << BSON("x" << 1));
+        ASSERT_EQ(BSON("query" << query << "orderby" << BSON("x" << 1) << "$trace" << traceObj),
+                  span.addToQuery(wrapped));
+    }
+
+    TEST(TraceSpan, RecordsSpans) {
+        auto service = stdx::make_unique<ServiceContextNoop>();
+        auto client = service->makeClient("TraceSpanTest");
+        ASSERT_OK(TraceMetadata::readFromMetadata(client.get(),
+                                                  BSON("$trace" << BSON("id" << 99LL <<
+                                                                        "span" << 5LL))));
+        const long long numRecorded = numTraceSpansRecorded();
+
+        long long outerId;
+        {
+            ScopedTraceSpan outer(client.get(), "outer");
+            outerId = TraceMetadata::get(client.get()).getCurrentSpanId();
+            ASSERT_NOT_EQUALS(5LL, outerId);
+
+            TraceSpan inner(client.get(), "inner");
+            inner.finish(BSON("n" << 3));
+            // Finishing again does nothing
+            inner.finish(BSON("n" << 4));
+        }
+        ASSERT_EQ(5LL, TraceMetadata::get(client.get()).getCurrentSpanId());
+        ASSERT_EQ(numRecorded + 2, numTraceSpansRecorded());
+
+        // Recorded as they finish, under the span that was current when they started
+        BSONArrayBuilder spansBuilder;
+        appendTraceSpans(99LL, 0, BSONObjMaxUserSize, &spansBuilder);
+        const BSONArray spans = spansBuilder.arr();
+        ASSERT_EQ(2, spans.nFields());
+
+        const BSONObj inner = spans["0"].Obj();
+        ASSERT_EQ("inner", inner["name"].str());
+        ASSERT_EQ(99LL, inner["trace"].numberLong());
+        ASSERT_EQ(outerId, inner["parent"].numberLong());
+        ASSERT_EQ(3, inner["n"].numberInt());
+
+        const BSONObj outer = spans["1"].Obj();
+        ASSERT_EQ("outer", outer["name"].str());
+        ASSERT_EQ(outerId, outer["span"].numberLong());
+        ASSERT_EQ(5LL, outer["parent"].numberLong());
+
+        // Spans of other traces are left out
+        BSONArrayBuilder otherBuilder;
+        appendTraceSpans(98LL, 0, BSONObjMaxUserSize, &otherBuilder);
+        ASSERT_EQ(0, otherBuilder.arr().nFields());
+    }
+
+}
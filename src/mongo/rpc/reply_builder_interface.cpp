@@ -46,6 +46,12 @@ namespace rpc {
         // similar to appendCommandStatus (duplicating logic here to avoid cyclic library
         // dependency)
         BSONObj augmentReplyWithStatus(const Status& status, const BSONObj& reply) {
+            // A successful reply that already carries "ok" needs nothing added, so avoid copying
+            // what may be a large result set into a new object.
+            if (status.isOK() && reply.hasField(kOKField)) {
+                return reply;
+            }
+
             BSONObjBuilder bob;
             bob.appendElements(reply);
 
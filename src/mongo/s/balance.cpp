@@ -46,9 +46,11 @@
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_actionlog.h"
 #include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/catalog/type_chunk_load.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/catalog/type_settings.h"
 #include "mongo/s/catalog/type_tags.h"
+#include "mongo/s/chunk_load_tracker.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/config.h"
 #include "mongo/s/catalog/dist_lock_manager.h"
@@ -74,6 +76,12 @@ namespace mongo {
 
     MONGO_FP_DECLARE(skipBalanceRound);
 
+    // How many of its hottest chunks each mongos reports the operation rates of per round.
+    static const size_t kMaxChunkLoadsReported = 1000;
+
+    // Reports older than this are from mongoses which went away and are ignored.
+    static const int kChunkLoadExpirationSecs = 60;
+
     Balancer balancer;
 
     Balancer::Balancer()
@@ -318,7 +326,87 @@ namespace mongo {
         }        
     }
 
-    void Balancer::_doBalanceRound(vector<shared_ptr<MigrateInfo>>* candidateChunks) {
+    /**
+     * Sums up the operation rates the mongoses recently reported for each chunk of 'ns', keyed by
+     * chunk min. Reports for ranges which have since been split or merged are dropped.
+     */
+    static void loadChunkOpsPerSec(const string& ns,
+                            const vector<ChunkType>& chunks,
+                            map<BSONObj, double>* chunkOpsPerSec) {
+        vector<ChunkLoadType> loads;
+        Status status = grid.catalogManager()->getChunkLoads(
+                                ns, jsTime() - Seconds(kChunkLoadExpirationSecs), &loads);
+        if (!status.isOK()) {
+            warning() << "could not load chunk operation rates for " << ns << causedBy(status);
+            return;
+        }
+
+        map<BSONObj, BSONObj> chunkMaxes;
+        for (const ChunkType& chunk : chunks) {
+            chunkMaxes[chunk.getMin()] = chunk.getMax();
+        }
+
+        for (const ChunkLoadType& load : loads) {
+            map<BSONObj, BSONObj>::const_iterator i = chunkMaxes.find(load.getMin());
+            if (i == chunkMaxes.end() || i->second != load.getMax()) {
+                continue;
+            }
+
+            (*chunkOpsPerSec)[load.getMin()] += load.getReadsPerSec() + load.getWritesPerSec();
+        }
+    }
+
+    /**
+     * Asks each shard for the size of 'ns' with collStats. Shards which can't tell are left out.
+     */
+    static void loadShardDataSizes(const NamespaceString& ns,
+                            const ShardInfoMap& shardInfo,
+                            map<ShardId, long long>* shardDataSizes) {
+        for (ShardInfoMap::const_iterator i = shardInfo.begin(); i != shardInfo.end(); ++i) {
+            std::shared_ptr<Shard> shard = grid.shardRegistry()->findIfExists(i->first);
+            if (!shard) {
+                continue;
+            }
+
+            try {
+                BSONObj res;
+                if (!shard->runCommand(ns.db().toString(), BSON("collStats" << ns.coll()), res)) {
+                    // A shard which never owned a chunk may not have the collection at all.
+                    if (res["errmsg"].str().find("not found") != string::npos) {
+                        (*shardDataSizes)[i->first] = 0;
+                    }
+                    else {
+                        warning() << "collStats failed on " << i->first << " for " << ns
+                                  << ": " << res;
+                    }
+                    continue;
+                }
+
+                (*shardDataSizes)[i->first] = res["size"].numberLong();
+            }
+            catch (const DBException& ex) {
+                warning() << "could not get size of " << ns << " from " << i->first
+                          << causedBy(ex);
+            }
+        }
+    }
+
+    void Balancer::_reportChunkLoads(bool loadAware) {
+        vector<ChunkLoadType> loads;
+        chunkLoadTracker.takeLoads(_myid, kMaxChunkLoadsReported, &loads);
+
+        if (!loadAware) {
+            return;
+        }
+
+        Status status = grid.catalogManager()->reportChunkLoads(_myid, loads);
+        if (!status.isOK()) {
+            warning() << "could not report chunk operation rates" << causedBy(status);
+        }
+    }
+
+    void Balancer::_doBalanceRound(bool loadAware,
+                                   vector<shared_ptr<MigrateInfo>>* candidateChunks) {
         invariant(candidateChunks);
 
         vector<CollectionType> collections;
@@ -464,6 +552,34 @@ namespace mongo {
                 continue;
             }
 
+            if (loadAware) {
+                map<BSONObj, double> chunkOpsPerSec;
+                loadChunkOpsPerSec(ns.ns(), allNsChunks, &chunkOpsPerSec);
+
+                map<ShardId, long long> shardDataSizes;
+                loadShardDataSizes(ns, shardInfo, &shardDataSizes);
+
+                status.setLoad(chunkOpsPerSec, shardDataSizes);
+
+                // A chunk too hot to move is split instead, so that its halves can be spread out
+                // in the rounds to come.
+                ChunkType hotChunk;
+                if (BalancerPolicy::findHotChunkToSplit(ns, status, &hotChunk)) {
+                    ChunkPtr c = cm->findIntersectingChunk(hotChunk.getMin());
+                    if (c->getMin() == hotChunk.getMin() && c->getMax() == hotChunk.getMax()) {
+                        Status splitStatus = c->split(Chunk::normal, NULL, NULL);
+                        if (!splitStatus.isOK()) {
+                            warning() << "could not split hot chunk " << hotChunk
+                                      << causedBy(splitStatus);
+                        }
+                        else {
+                            // State change, just wait till next round
+                            continue;
+                        }
+                    }
+                }
+            }
+
             shared_ptr<MigrateInfo> migrateInfo(_policy->balance(ns, status, _balancedLastTime));
             if (migrateInfo) {
                 candidateChunks->push_back(migrateInfo);
@@ -548,6 +664,12 @@ namespace mongo {
                 const SettingsType& balancerConfig = isBalSettingsAbsent ?
                     SettingsType{} : balSettingsResult.getValue();
 
+                const bool loadAware = balancerConfig.isLoadAwareSet() &&
+                                       balancerConfig.getLoadAware();
+
+                // Every mongos reports the load it routed, not only the one which balances.
+                _reportChunkLoads(loadAware);
+
                 // now make sure we should even be running
                 if ((!isBalSettingsAbsent && !grid.shouldBalance(balancerConfig)) ||
                     MONGO_FAIL_POINT(skipBalanceRound)) {
@@ -590,10 +712,11 @@ namespace mongo {
                            << "waitForDelete: " << waitForDelete
                            << ", secondaryThrottle: "
                            << (writeConcern.get() ? writeConcern->toBSON().toString() : "default")
+                           << ", loadAware: " << loadAware
                           ;
 
                     vector<shared_ptr<MigrateInfo>> candidateChunks;
-                    _doBalanceRound(&candidateChunks);
+                    _doBalanceRound(loadAware, &candidateChunks);
 
                     if ( candidateChunks.size() == 0 ) {
                         LOG(1) << "no need to move any chunk";
@@ -86,10 +86,17 @@ namespace mongo {
          * Gathers all the necessary information about shards and chunks, and decides whether there are candidate chunks to
          * be moved.
          *
-         * @param conn is the connection with the config server(s)
+         * @param loadAware balance by operation rates and data sizes rather than chunk counts
          * @param candidateChunks (IN/OUT) filled with candidate chunks, one per collection, that could possibly be moved
          */
-        void _doBalanceRound(std::vector<std::shared_ptr<MigrateInfo>>* candidateChunks);
+        void _doBalanceRound(bool loadAware,
+                             std::vector<std::shared_ptr<MigrateInfo>>* candidateChunks);
+
+        /**
+         * Hands the chunk operation rates this mongos sampled since the last round to the config
+         * server, if the load-aware balancer needs them. Otherwise they are dropped.
+         */
+        void _reportChunkLoads(bool loadAware);
 
         /**
          * Issues chunk migration request, one at a time.
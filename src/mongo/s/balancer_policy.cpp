@@ -34,6 +34,7 @@
 #include "mongo/s/balancer_policy.h"
 
 #include <algorithm>
+#include <cmath>
 
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_shard.h"
@@ -52,6 +53,119 @@ namespace mongo {
     using std::string;
     using std::vector;
 
+namespace {
+
+    // Below this many operations per second on the shards of a tag, load is not worth balancing.
+    const double kMinOpsPerSecToBalance = 1.0;
+
+    // The busiest shard of a tag is overloaded once it sees this many times the average rate.
+    const double kLoadImbalanceRatio = 1.5;
+
+    // The largest shard of a tag is overloaded once it holds this many times the average size.
+    const double kDataSizeImbalanceRatio = 1.25;
+
+    /**
+     * The busiest shard of a tag and the least busy one which can take chunks of it.
+     */
+    struct TagLoad {
+        ShardId from;
+        double fromOpsPerSec;
+        ShardId to;
+        double toOpsPerSec;
+    };
+
+    /**
+     * @return true and fills 'load' if the operation rates of the shards with 'tag' are out of
+     *         balance and another shard can take some of the load of the busiest one
+     */
+    bool findLoadImbalance(const DistributionStatus& distribution,
+                           const string& tag,
+                           TagLoad* load) {
+        double totalOpsPerSec = 0;
+        unsigned numShards = 0;
+        load->fromOpsPerSec = -1;
+        load->toOpsPerSec = numeric_limits<double>::max();
+
+        for (const ShardId& shardId : distribution.shardIds()) {
+            const ShardInfo& info = distribution.shardInfo(shardId);
+            if (!info.hasTag(tag)) {
+                continue;
+            }
+
+            const double opsPerSec = distribution.opsPerSecForShardWithTag(shardId, tag);
+            totalOpsPerSec += opsPerSec;
+            numShards++;
+
+            if (opsPerSec > load->fromOpsPerSec) {
+                load->from = shardId;
+                load->fromOpsPerSec = opsPerSec;
+            }
+
+            if (!info.isDraining() && !info.isSizeMaxed() && opsPerSec < load->toOpsPerSec) {
+                load->to = shardId;
+                load->toOpsPerSec = opsPerSec;
+            }
+        }
+
+        if (numShards < 2 || load->to.empty() || load->from == load->to) {
+            return false;
+        }
+
+        if (totalOpsPerSec < kMinOpsPerSecToBalance) {
+            return false;
+        }
+
+        return load->fromOpsPerSec > kLoadImbalanceRatio * (totalOpsPerSec / numShards);
+    }
+
+    /**
+     * @return the chunk with 'tag' on the busiest shard which moved to the receiver brings the
+     *         two closest to an even load, or NULL if every chunk is either idle or so hot that
+     *         the receiver would end up the busier one
+     */
+    const ChunkType* findChunkToShed(const DistributionStatus& distribution,
+                                     const string& tag,
+                                     const TagLoad& load) {
+        const double gap = load.fromOpsPerSec - load.toOpsPerSec;
+        const ChunkType* best = NULL;
+        double bestDistance = numeric_limits<double>::max();
+
+        const vector<ChunkType>& chunks = distribution.getChunks(load.from);
+        for (const ChunkType& chunk : chunks) {
+            if (chunk.getJumbo() || distribution.getTagForChunk(chunk) != tag) {
+                continue;
+            }
+
+            const double opsPerSec = distribution.opsPerSecForChunk(chunk);
+            if (opsPerSec <= 0 || opsPerSec >= gap) {
+                continue;
+            }
+
+            const double distance = std::fabs(gap / 2 - opsPerSec);
+            if (distance < bestDistance) {
+                best = &chunk;
+                bestDistance = distance;
+            }
+        }
+
+        return best;
+    }
+
+    vector<string> getTagsInRandomOrder(const DistributionStatus& distribution) {
+        // randomize the order in which we balance the tags
+        // this is so that one bad tag doesn't prevent others from getting balanced
+        vector<string> tags;
+        set<string> t = distribution.tags();
+        for ( set<string>::const_iterator i = t.begin(); i != t.end(); ++i )
+            tags.push_back( *i );
+        tags.push_back( "" );
+
+        std::random_shuffle( tags.begin(), tags.end() );
+        return tags;
+    }
+
+} // namespace
+
     string TagRange::toString() const {
         return str::stream() << min << " -->> " << max << "  on  " << tag;
     }
@@ -59,7 +173,8 @@ namespace mongo {
     DistributionStatus::DistributionStatus(const ShardInfoMap& shardInfo,
                                            const ShardToChunksMap& shardToChunksMap)
             : _shardInfo(shardInfo),
-              _shardChunks(shardToChunksMap) {
+              _shardChunks(shardToChunksMap),
+              _hasLoad(false) {
 
         for (ShardInfoMap::const_iterator i = _shardInfo.begin(); i != _shardInfo.end(); ++i) {
             _shardIds.insert(i->first);
@@ -72,6 +187,48 @@ namespace mongo {
         return i->second;
     }
 
+    void DistributionStatus::setLoad(const map<BSONObj, double>& chunkOpsPerSec,
+                                     const map<ShardId, long long>& shardDataSizes) {
+        _hasLoad = true;
+        _chunkOpsPerSec = chunkOpsPerSec;
+        _shardDataSizes = shardDataSizes;
+    }
+
+    double DistributionStatus::opsPerSecForChunk(const ChunkType& chunk) const {
+        map<BSONObj, double>::const_iterator i = _chunkOpsPerSec.find(chunk.getMin());
+        if (i == _chunkOpsPerSec.end()) {
+            return 0;
+        }
+
+        return i->second;
+    }
+
+    double DistributionStatus::opsPerSecForShardWithTag(const ShardId& shardId,
+                                                        const string& tag) const {
+        ShardToChunksMap::const_iterator i = _shardChunks.find(shardId);
+        if (i == _shardChunks.end()) {
+            return 0;
+        }
+
+        double total = 0;
+        for (const ChunkType& chunk : i->second) {
+            if (tag == getTagForChunk(chunk)) {
+                total += opsPerSecForChunk(chunk);
+            }
+        }
+
+        return total;
+    }
+
+    long long DistributionStatus::dataSizeForShard(const ShardId& shardId) const {
+        map<ShardId, long long>::const_iterator i = _shardDataSizes.find(shardId);
+        if (i == _shardDataSizes.end()) {
+            return -1;
+        }
+
+        return i->second;
+    }
+
     unsigned DistributionStatus::totalChunks() const {
         unsigned total = 0;
 
@@ -325,7 +482,8 @@ namespace mongo {
         // 1) check for shards that policy require to us to move off of:
         //    draining only
         // 2) check tag policy violations
-        // 3) then we make sure chunks are balanced for each tag
+        // 3) with load, balance the operation rates and then the data sizes for each tag
+        // 4) otherwise we make sure chunks are balanced for each tag
 
         // ----
 
@@ -414,7 +572,17 @@ namespace mongo {
             }
         }
 
-        // 3) for each tag balance
+        // 3) load
+        if (distribution.hasLoad()) {
+            MigrateInfo* migrate = _balanceLoad(ns, distribution);
+            if (migrate || _knowsAllDataSizes(distribution)) {
+                return migrate;
+            }
+
+            LOG(1) << "ns: " << ns << " data sizes unknown, balancing by chunk counts";
+        }
+
+        // 4) for each tag balance
 
         int threshold = 8;
         if ( balancedLastTime || distribution.totalChunks() < 20 )
@@ -422,17 +590,7 @@ namespace mongo {
         else if ( distribution.totalChunks() < 80 )
             threshold = 4;
 
-        // randomize the order in which we balance the tags
-        // this is so that one bad tag doesn't prevent others from getting balanced
-        vector<string> tags;
-        {
-            set<string> t = distribution.tags();
-            for ( set<string>::const_iterator i = t.begin(); i != t.end(); ++i )
-                tags.push_back( *i );
-            tags.push_back( "" );
-
-            std::random_shuffle( tags.begin(), tags.end() );
-        }
+        const vector<string> tags = getTagsInRandomOrder(distribution);
 
         for ( unsigned i=0; i<tags.size(); i++ ) {
             string tag = tags[i];
@@ -496,6 +654,167 @@ namespace mongo {
         return NULL;
     }
 
+    MigrateInfo* BalancerPolicy::_balanceLoad(const string& ns,
+                                              const DistributionStatus& distribution) {
+        const vector<string> tags = getTagsInRandomOrder(distribution);
+
+        // First take load off the busiest shards, as that is what the users notice.
+        for (const string& tag : tags) {
+            TagLoad load;
+            if (!findLoadImbalance(distribution, tag, &load)) {
+                continue;
+            }
+
+            const ChunkType* chunk = findChunkToShed(distribution, tag, load);
+            if (!chunk) {
+                continue;
+            }
+
+            log() << " ns: " << ns << " going to move hot " << *chunk
+                  << " (" << distribution.opsPerSecForChunk(*chunk) << " ops/sec)"
+                  << " from: " << load.from << " (" << load.fromOpsPerSec << " ops/sec)"
+                  << " to: " << load.to << " (" << load.toOpsPerSec << " ops/sec)"
+                  << " tag [" << tag << "]";
+            return new MigrateInfo(ns, load.to, load.from, chunk->toBSON());
+        }
+
+        if (!_knowsAllDataSizes(distribution)) {
+            return NULL;
+        }
+
+        // Then even out the data, moving the coldest chunks so as not to upset the load.
+        for (const string& tag : tags) {
+            ShardId from;
+            ShardId to;
+            long long fromSize = -1;
+            long long toSize = numeric_limits<long long>::max();
+            long long totalSize = 0;
+            unsigned numShards = 0;
+
+            for (const ShardId& shardId : distribution.shardIds()) {
+                const ShardInfo& info = distribution.shardInfo(shardId);
+                if (!info.hasTag(tag)) {
+                    continue;
+                }
+
+                const long long size = distribution.dataSizeForShard(shardId);
+                totalSize += size;
+                numShards++;
+
+                if (size > fromSize && distribution.numberOfChunksInShardWithTag(shardId, tag)) {
+                    from = shardId;
+                    fromSize = size;
+                }
+
+                if (!info.isDraining() && !info.isSizeMaxed() && size < toSize) {
+                    to = shardId;
+                    toSize = size;
+                }
+            }
+
+            if (from.empty() || to.empty() || from == to) {
+                continue;
+            }
+
+            // Moving a chunk of average size must leave the donor at least as big as the receiver.
+            const long long avgChunkSize = fromSize / distribution.numberOfChunksInShard(from);
+            if (fromSize - toSize <= 2 * avgChunkSize) {
+                continue;
+            }
+
+            if (fromSize <= kDataSizeImbalanceRatio * (totalSize / numShards)) {
+                continue;
+            }
+
+            const ChunkType* coldest = NULL;
+            for (const ChunkType& chunk : distribution.getChunks(from)) {
+                if (chunk.getJumbo() || distribution.getTagForChunk(chunk) != tag) {
+                    continue;
+                }
+
+                if (!coldest ||
+                    distribution.opsPerSecForChunk(chunk) <
+                        distribution.opsPerSecForChunk(*coldest)) {
+                    coldest = &chunk;
+                }
+            }
+
+            if (!coldest) {
+                error() << "shard: " << from << " ns: " << ns
+                        << " holds too much data, but its chunks are all jumbo";
+                continue;
+            }
+
+            log() << " ns: " << ns << " going to move " << *coldest
+                  << " from: " << from << " (" << fromSize << " bytes)"
+                  << " to: " << to << " (" << toSize << " bytes)"
+                  << " tag [" << tag << "]";
+            return new MigrateInfo(ns, to, from, coldest->toBSON());
+        }
+
+        return NULL;
+    }
+
+    bool BalancerPolicy::_knowsAllDataSizes(const DistributionStatus& distribution) {
+        long long totalSize = 0;
+        for (const ShardId& shardId : distribution.shardIds()) {
+            const long long size = distribution.dataSizeForShard(shardId);
+            if (size < 0) {
+                return false;
+            }
+
+            totalSize += size;
+        }
+
+        // An empty collection has nothing to weigh its chunks by.
+        return totalSize > 0;
+    }
+
+    bool BalancerPolicy::findHotChunkToSplit(const string& ns,
+                                             const DistributionStatus& distribution,
+                                             ChunkType* chunk) {
+        if (!distribution.hasLoad()) {
+            return false;
+        }
+
+        for (const string& tag : getTagsInRandomOrder(distribution)) {
+            TagLoad load;
+            if (!findLoadImbalance(distribution, tag, &load)) {
+                continue;
+            }
+
+            if (findChunkToShed(distribution, tag, load)) {
+                continue;
+            }
+
+            const ChunkType* hottest = NULL;
+            for (const ChunkType& candidate : distribution.getChunks(load.from)) {
+                if (candidate.getJumbo() || distribution.getTagForChunk(candidate) != tag) {
+                    continue;
+                }
+
+                if (!hottest ||
+                    distribution.opsPerSecForChunk(candidate) >
+                        distribution.opsPerSecForChunk(*hottest)) {
+                    hottest = &candidate;
+                }
+            }
+
+            if (!hottest) {
+                continue;
+            }
+
+            log() << " ns: " << ns << " chunk " << *hottest << " is too hot to move"
+                  << " (" << distribution.opsPerSecForChunk(*hottest) << " ops/sec)"
+                  << " from: " << load.from << " (" << load.fromOpsPerSec << " ops/sec)"
+                  << " to: " << load.to << " (" << load.toOpsPerSec << " ops/sec)";
+            *chunk = *hottest;
+            return true;
+        }
+
+        return false;
+    }
+
 
     ShardInfo::ShardInfo(long long maxSizeMB,
                          long long currSizeMB,
@@ -186,6 +186,27 @@ namespace mongo {
 
         /** @return the ShardInfo for the shard */
         const ShardInfo& shardInfo(const ShardId& shardId) const;
+
+        // ---- load, only known to the load-aware balancer
+
+        /**
+         * Sets the operations per second the mongoses routed to each chunk, keyed by chunk min,
+         * and the bytes of the collection on each shard. Once set, BalancerPolicy balances the
+         * operation rates and data sizes of the shards instead of their chunk counts.
+         */
+        void setLoad(const std::map<BSONObj, double>& chunkOpsPerSec,
+                     const std::map<ShardId, long long>& shardDataSizes);
+
+        bool hasLoad() const { return _hasLoad; }
+
+        /** @return operations per second on the chunk, 0 if none were reported */
+        double opsPerSecForChunk(const ChunkType& chunk) const;
+
+        /** @return operations per second on the chunks of this shard with the given tag */
+        double opsPerSecForShardWithTag(const ShardId& shardId, const std::string& tag) const;
+
+        /** @return bytes of the collection on this shard, or -1 if unknown */
+        long long dataSizeForShard(const ShardId& shardId) const;
         
         /** writes all state to log() */
         void dump() const;
@@ -209,6 +230,10 @@ namespace mongo {
         std::map<BSONObj,TagRange> _tagRanges;
         std::set<std::string> _allTags;
         std::set<ShardId> _shardIds;
+
+        bool _hasLoad;
+        std::map<BSONObj, double> _chunkOpsPerSec;
+        std::map<ShardId, long long> _shardDataSizes;
     };
 
 
@@ -229,6 +254,26 @@ namespace mongo {
         static MigrateInfo* balance( const std::string& ns,
                                      const DistributionStatus& distribution,
                                      int balancedLastTime );
+
+        /**
+         * With load in the distribution, finds a chunk on the busiest shard which is so hot that
+         * moving it would only make the receiver the busiest shard, so it should be split instead.
+         *
+         * @return true and sets 'chunk' if there is such a chunk
+         */
+        static bool findHotChunkToSplit(const std::string& ns,
+                                        const DistributionStatus& distribution,
+                                        ChunkType* chunk);
+
+    private:
+        /**
+         * Balances the operation rates of the shards first and their data sizes second.
+         */
+        static MigrateInfo* _balanceLoad(const std::string& ns,
+                                         const DistributionStatus& distribution);
+
+        /** @return true if the distribution knows the data size on every shard */
+        static bool _knowsAllDataSizes(const DistributionStatus& distribution);
     };
 
 }  // namespace mongo
@@ -627,4 +627,134 @@ namespace {
         }
     }
 
+    /**
+     * Sets the operations per second on the chunks of 'shardId', in chunk order.
+     */
+    void setChunkOps(const ShardToChunksMap& shardToChunks,
+                     const string& shardId,
+                     const vector<double>& opsPerSec,
+                     map<BSONObj, double>* chunkOpsPerSec) {
+        const vector<ChunkType>& chunks = shardToChunks.find(shardId)->second;
+        invariant(chunks.size() == opsPerSec.size());
+
+        for (size_t i = 0; i < chunks.size(); i++) {
+            (*chunkOpsPerSec)[chunks[i].getMin()] = opsPerSec[i];
+        }
+    }
+
+    TEST(BalancerPolicyTests, LoadMovesWarmChunkOffHotShard) {
+        ShardToChunksMap chunks;
+        addShard(chunks, 4, false);
+        addShard(chunks, 4, true);
+
+        ShardInfoMap shards;
+        shards["shard0"] = ShardInfo(0, 0, false);
+        shards["shard1"] = ShardInfo(0, 0, false);
+
+        map<BSONObj, double> chunkOps;
+        setChunkOps(chunks, "shard0", {10, 30, 20, 0}, &chunkOps);
+        setChunkOps(chunks, "shard1", {1, 1, 1, 1}, &chunkOps);
+
+        map<ShardId, long long> sizes;
+        sizes["shard0"] = 1000;
+        sizes["shard1"] = 1000;
+
+        DistributionStatus status(shards, chunks);
+        status.setLoad(chunkOps, sizes);
+        ASSERT_EQUALS(60, status.opsPerSecForShardWithTag("shard0", ""));
+
+        // The chunk which comes closest to evening out 60 against 4 ops/sec.
+        std::unique_ptr<MigrateInfo> m(BalancerPolicy::balance("ns", status, 0));
+        ASSERT(m);
+        ASSERT_EQUALS("shard0", m->from);
+        ASSERT_EQUALS("shard1", m->to);
+        ASSERT_EQUALS(BSON("x" << 1), m->chunk.min);
+
+        ChunkType hotChunk;
+        ASSERT(!BalancerPolicy::findHotChunkToSplit("ns", status, &hotChunk));
+    }
+
+    TEST(BalancerPolicyTests, LoadSplitsChunkTooHotToMove) {
+        ShardToChunksMap chunks;
+        addShard(chunks, 4, false);
+        addShard(chunks, 4, true);
+
+        ShardInfoMap shards;
+        shards["shard0"] = ShardInfo(0, 0, false);
+        shards["shard1"] = ShardInfo(0, 0, false);
+
+        map<BSONObj, double> chunkOps;
+        setChunkOps(chunks, "shard0", {0, 100, 0, 0}, &chunkOps);
+        setChunkOps(chunks, "shard1", {1, 1, 1, 1}, &chunkOps);
+
+        map<ShardId, long long> sizes;
+        sizes["shard0"] = 1000;
+        sizes["shard1"] = 1000;
+
+        DistributionStatus status(shards, chunks);
+        status.setLoad(chunkOps, sizes);
+
+        // Moving the hot chunk would just move the hot spot.
+        std::unique_ptr<MigrateInfo> m(BalancerPolicy::balance("ns", status, 0));
+        ASSERT(!m);
+
+        ChunkType hotChunk;
+        ASSERT(BalancerPolicy::findHotChunkToSplit("ns", status, &hotChunk));
+        ASSERT_EQUALS(BSON("x" << 1), hotChunk.getMin());
+    }
+
+    TEST(BalancerPolicyTests, LoadMovesColdChunkToEvenDataSizes) {
+        ShardToChunksMap chunks;
+        addShard(chunks, 4, false);
+        addShard(chunks, 4, true);
+
+        ShardInfoMap shards;
+        shards["shard0"] = ShardInfo(0, 0, false);
+        shards["shard1"] = ShardInfo(0, 0, false);
+
+        // Too little load to be worth balancing.
+        map<BSONObj, double> chunkOps;
+        setChunkOps(chunks, "shard0", {0.3, 0.2, 0.1, 0.3}, &chunkOps);
+
+        map<ShardId, long long> sizes;
+        sizes["shard0"] = 8000;
+        sizes["shard1"] = 0;
+
+        DistributionStatus status(shards, chunks);
+        status.setLoad(chunkOps, sizes);
+
+        std::unique_ptr<MigrateInfo> m(BalancerPolicy::balance("ns", status, 0));
+        ASSERT(m);
+        ASSERT_EQUALS("shard0", m->from);
+        ASSERT_EQUALS("shard1", m->to);
+        ASSERT_EQUALS(BSON("x" << 2), m->chunk.min);
+
+        // Even chunk counts don't matter once the data sizes are even.
+        sizes["shard1"] = 7000;
+        status.setLoad(chunkOps, sizes);
+        m.reset(BalancerPolicy::balance("ns", status, 0));
+        ASSERT(!m);
+    }
+
+    TEST(BalancerPolicyTests, LoadWithoutDataSizesBalancesChunkCounts) {
+        ShardToChunksMap chunks;
+        addShard(chunks, 10, true);
+        addShard(chunks, 0, false);
+
+        ShardInfoMap shards;
+        shards["shard0"] = ShardInfo(0, 0, false);
+        shards["shard1"] = ShardInfo(0, 0, false);
+
+        map<ShardId, long long> sizes;
+        sizes["shard0"] = 8000;
+
+        DistributionStatus status(shards, chunks);
+        status.setLoad(map<BSONObj, double>(), sizes);
+
+        std::unique_ptr<MigrateInfo> m(BalancerPolicy::balance("ns", status, 0));
+        ASSERT(m);
+        ASSERT_EQUALS("shard0", m->from);
+        ASSERT_EQUALS("shard1", m->to);
+    }
+
 } // namespace
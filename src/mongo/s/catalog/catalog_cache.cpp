@@ -26,21 +26,32 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/s/catalog/catalog_cache.h"
 
 
+#include <vector>
+
 #include "mongo/base/status_with.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_database.h"
 #include "mongo/s/config.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
     using std::shared_ptr;
     using std::string;
+    using std::vector;
 
+    // How long the cached metadata of a database is used before it is reloaded from the config
+    // servers. Reloads start in the background once half of it has gone by. 0 disables them.
+    MONGO_EXPORT_SERVER_PARAMETER(catalogCacheLeaseSecs, int, 30);
 
     CatalogCache::CatalogCache(CatalogManager* catalogManager)
             : _catalogManager(catalogManager) {
@@ -49,14 +60,17 @@ namespace mongo {
     }
 
     StatusWith<shared_ptr<DBConfig>> CatalogCache::getDatabase(const string& dbName) {
-        boost::lock_guard<boost::mutex> guard(_mutex);
+        {
+            boost::lock_guard<boost::mutex> guard(_mutex);
 
-        ShardedDatabasesMap::iterator it = _databases.find(dbName);
-        if (it != _databases.end()) {
-            return it->second;
+            ShardedDatabasesMap::iterator it = _databases.find(dbName);
+            if (it != _databases.end()) {
+                return it->second;
+            }
         }
 
-        // Need to load from the store
+        // Need to load from the store, which is done without the mutex so that lookups of the
+        // other databases don't wait for it
         StatusWith<DatabaseType> status = _catalogManager->getDatabase(dbName);
         if (!status.isOK()) {
             return status.getStatus();
@@ -65,9 +79,11 @@ namespace mongo {
         shared_ptr<DBConfig> db = std::make_shared<DBConfig>(dbName, status.getValue());
         db->load();
 
-        invariant(_databases.insert(std::make_pair(dbName, db)).second);
+        boost::lock_guard<boost::mutex> guard(_mutex);
 
-        return db;
+        // Another thread may have loaded the database in the meantime, in which case its entry
+        // is kept and ours is discarded
+        return _databases.insert(std::make_pair(dbName, db)).first->second;
     }
 
     void CatalogCache::invalidate(const string& dbName) {
@@ -85,4 +101,47 @@ namespace mongo {
         _databases.clear();
     }
 
+    void CatalogCache::refreshExpiring() {
+        const int leaseSecs = catalogCacheLeaseSecs;
+        if (leaseSecs <= 0) {
+            return;
+        }
+
+        const Date_t renewBefore = Date_t::now() - Milliseconds(leaseSecs * 1000 / 2);
+
+        vector<shared_ptr<DBConfig>> expiring;
+        {
+            boost::lock_guard<boost::mutex> guard(_mutex);
+
+            for (const auto& entry : _databases) {
+                if (entry.second->getLoadedAt() < renewBefore) {
+                    expiring.push_back(entry.second);
+                }
+            }
+        }
+
+        for (const auto& db : expiring) {
+            bool exists;
+            try {
+                exists = db->refreshIfNotInProgress();
+            }
+            catch (const DBException& e) {
+                // The cached metadata is still used, so try again on the next round
+                warning() << "could not renew the cached metadata of database " << db->name()
+                          << causedBy(e);
+                continue;
+            }
+
+            if (!exists) {
+                boost::lock_guard<boost::mutex> guard(_mutex);
+
+                // Only drop the entry we reloaded, not one which replaced it in the meantime
+                ShardedDatabasesMap::iterator it = _databases.find(db->name());
+                if (it != _databases.end() && it->second == db) {
+                    _databases.erase(it);
+                }
+            }
+        }
+    }
+
 } // namespace mongo
@@ -73,6 +73,14 @@ namespace mongo {
          */
         void invalidateAll();
 
+        /**
+         * Renews the lease of the databases which were loaded more than half of
+         * catalogCacheLeaseSecs ago by reloading their metadata, and drops the ones which no
+         * longer exist. Operations keep using the cached metadata while it is being reloaded.
+         * Called periodically by a background thread on mongos.
+         */
+        void refreshExpiring();
+
     private:
         typedef std::map<std::string, std::shared_ptr<DBConfig>> ShardedDatabasesMap;
 
@@ -43,10 +43,12 @@ namespace mongo {
     struct BSONArray;
     class BSONObj;
     class BSONObjBuilder;
+    class ChunkLoadType;
     class ChunkType;
     class CollectionType;
     class ConnectionString;
     class DatabaseType;
+    class Date_t;
     class DistLockManager;
     class OperationContext;
     class Query;
@@ -256,6 +258,21 @@ namespace mongo {
         virtual StatusWith<std::string> getTagForChunk(const std::string& collectionNs,
                                                        const ChunkType& chunk) = 0;
 
+        /**
+         * Replaces the chunk loads reported by the given mongos with 'loads', which all have the
+         * same lastmod. The earlier loads of the mongos for chunks not in 'loads' are removed.
+         */
+        virtual Status reportChunkLoads(const std::string& mongosId,
+                                        const std::vector<ChunkLoadType>& loads) = 0;
+
+        /**
+         * Retrieves the chunk loads all mongoses reported for the specified collection at or
+         * after 'since'.
+         */
+        virtual Status getChunkLoads(const std::string& collectionNs,
+                                     Date_t since,
+                                     std::vector<ChunkLoadType>* loads) = 0;
+
         /**
          * Retrieves all shards in this sharded cluster.
          * Returns a !OK status if an error occurs.
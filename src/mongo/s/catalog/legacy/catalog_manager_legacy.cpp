@@ -53,6 +53,7 @@
 #include "mongo/s/catalog/type_actionlog.h"
 #include "mongo/s/catalog/type_changelog.h"
 #include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/catalog/type_chunk_load.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/catalog/type_database.h"
 #include "mongo/s/catalog/type_settings.h"
@@ -1318,6 +1319,87 @@ namespace {
         return status.getStatus();
     }
 
+    Status CatalogManagerLegacy::reportChunkLoads(const std::string& mongosId,
+                                                  const std::vector<ChunkLoadType>& loads) {
+        for (const ChunkLoadType& load : loads) {
+            fassert(28773, load.validate());
+
+            const BSONObj loadObj = load.toBSON();
+
+            BatchedCommandResponse response;
+            Status status = update(ChunkLoadType::ConfigNS,
+                                   BSON("_id" << loadObj["_id"]),
+                                   loadObj,
+                                   true,     // upsert
+                                   false,    // multi
+                                   &response);
+            if (!status.isOK()) {
+                return Status(status.code(),
+                              str::stream() << "chunk load write failed: " << response.toBSON()
+                                            << "; status: " << status.toString());
+            }
+        }
+
+        // Whatever the mongos didn't report this time, it didn't route operations to.
+        BSONObjBuilder staleQuery;
+        staleQuery.append(ChunkLoadType::mongos(), mongosId);
+        if (!loads.empty()) {
+            staleQuery.append(ChunkLoadType::lastmod.name(),
+                              BSON("$lt" << loads.front().getLastmod()));
+        }
+
+        BatchedCommandResponse response;
+        Status status = remove(ChunkLoadType::ConfigNS, staleQuery.obj(), 0, &response);
+        if (!status.isOK()) {
+            return Status(status.code(),
+                          str::stream() << "stale chunk load removal failed: "
+                                        << response.toBSON() << "; status: "
+                                        << status.toString());
+        }
+
+        return Status::OK();
+    }
+
+    Status CatalogManagerLegacy::getChunkLoads(const std::string& collectionNs,
+                                               Date_t since,
+                                               std::vector<ChunkLoadType>* loads) {
+        loads->clear();
+
+        try {
+            ScopedDbConnection conn(_configServerConnectionString, 30);
+            std::unique_ptr<DBClientCursor> cursor(_safeCursor(
+                                conn->query(ChunkLoadType::ConfigNS,
+                                            Query(BSON(ChunkLoadType::ns(collectionNs) <<
+                                                       ChunkLoadType::lastmod() <<
+                                                           BSON("$gte" << since))))));
+            if (!cursor.get()) {
+                conn.done();
+                return Status(ErrorCodes::HostUnreachable, "unable to open chunk loads cursor");
+            }
+
+            while (cursor->more()) {
+                BSONObj loadObj = cursor->nextSafe();
+
+                StatusWith<ChunkLoadType> loadRes = ChunkLoadType::fromBSON(loadObj);
+                if (!loadRes.isOK()) {
+                    conn.done();
+                    return Status(ErrorCodes::FailedToParse,
+                                  str::stream() << "Failed to parse chunk load BSONObj: "
+                                                << loadRes.getStatus().reason());
+                }
+
+                loads->push_back(loadRes.getValue());
+            }
+
+            conn.done();
+        }
+        catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+
+        return Status::OK();
+    }
+
     Status CatalogManagerLegacy::getAllShards(vector<ShardType>* shards) {
         ScopedDbConnection conn(_configServerConnectionString, 30.0);
         std::unique_ptr<DBClientCursor> cursor(_safeCursor(conn->query(ShardType::ConfigNS,
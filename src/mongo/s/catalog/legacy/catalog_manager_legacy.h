@@ -101,6 +101,13 @@ namespace mongo {
         StatusWith<std::string> getTagForChunk(const std::string& collectionNs,
                                                const ChunkType& chunk) override;
 
+        Status reportChunkLoads(const std::string& mongosId,
+                                const std::vector<ChunkLoadType>& loads) override;
+
+        Status getChunkLoads(const std::string& collectionNs,
+                             Date_t since,
+                             std::vector<ChunkLoadType>* loads) override;
+
         Status getAllShards(std::vector<ShardType>* shards) override;
 
         bool isShardHost(const ConnectionString& shardConnectionString) override;
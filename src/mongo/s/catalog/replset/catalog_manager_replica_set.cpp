@@ -217,6 +217,17 @@ namespace {
         return notYetImplemented;
     }
 
+    Status CatalogManagerReplicaSet::reportChunkLoads(const std::string& mongosId,
+                                                      const std::vector<ChunkLoadType>& loads) {
+        return notYetImplemented;
+    }
+
+    Status CatalogManagerReplicaSet::getChunkLoads(const std::string& collectionNs,
+                                                   Date_t since,
+                                                   std::vector<ChunkLoadType>* loads) {
+        return notYetImplemented;
+    }
+
     Status CatalogManagerReplicaSet::getAllShards(vector<ShardType>* shards) {
         return notYetImplemented;
     }
@@ -0,0 +1,259 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/catalog/type_chunk_load.h"
+
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using std::string;
+
+    const std::string ChunkLoadType::ConfigNS = "config.chunkLoad";
+
+    const BSONField<std::string> ChunkLoadType::mongos("mongos");
+    const BSONField<std::string> ChunkLoadType::ns("ns");
+    const BSONField<BSONObj> ChunkLoadType::min("min");
+    const BSONField<BSONObj> ChunkLoadType::max("max");
+    const BSONField<std::string> ChunkLoadType::shard("shard");
+    const BSONField<double> ChunkLoadType::readsPerSec("readsPerSec");
+    const BSONField<double> ChunkLoadType::writesPerSec("writesPerSec");
+    const BSONField<Date_t> ChunkLoadType::lastmod("lastmod");
+
+namespace {
+
+    Status extractRate(const BSONObj& source, StringData fieldName, double* rate) {
+        BSONElement rateElem;
+        Status status = bsonExtractField(source, fieldName, &rateElem);
+        if (!status.isOK()) return status;
+
+        if (!rateElem.isNumber()) {
+            return Status(ErrorCodes::TypeMismatch,
+                          str::stream() << fieldName << " must be a number");
+        }
+
+        *rate = rateElem.numberDouble();
+        return Status::OK();
+    }
+
+} // namespace
+
+    StatusWith<ChunkLoadType> ChunkLoadType::fromBSON(const BSONObj& source) {
+        ChunkLoadType load;
+
+        {
+            std::string loadMongos;
+            Status status = bsonExtractStringField(source, mongos.name(), &loadMongos);
+            if (!status.isOK()) return status;
+
+            load._mongos = loadMongos;
+        }
+
+        {
+            std::string loadNs;
+            Status status = bsonExtractStringField(source, ns.name(), &loadNs);
+            if (!status.isOK()) return status;
+
+            load._ns = loadNs;
+        }
+
+        {
+            BSONElement loadMin;
+            Status status = bsonExtractTypedField(source, min.name(), Object, &loadMin);
+            if (!status.isOK()) return status;
+
+            load._min = loadMin.Obj().getOwned();
+        }
+
+        {
+            BSONElement loadMax;
+            Status status = bsonExtractTypedField(source, max.name(), Object, &loadMax);
+            if (!status.isOK()) return status;
+
+            load._max = loadMax.Obj().getOwned();
+        }
+
+        {
+            std::string loadShard;
+            Status status = bsonExtractStringField(source, shard.name(), &loadShard);
+            if (!status.isOK()) return status;
+
+            load._shard = loadShard;
+        }
+
+        {
+            double loadReadsPerSec;
+            Status status = extractRate(source, readsPerSec.name(), &loadReadsPerSec);
+            if (!status.isOK()) return status;
+
+            load._readsPerSec = loadReadsPerSec;
+        }
+
+        {
+            double loadWritesPerSec;
+            Status status = extractRate(source, writesPerSec.name(), &loadWritesPerSec);
+            if (!status.isOK()) return status;
+
+            load._writesPerSec = loadWritesPerSec;
+        }
+
+        {
+            BSONElement loadLastmod;
+            Status status = bsonExtractTypedField(source, lastmod.name(), Date, &loadLastmod);
+            if (!status.isOK()) return status;
+
+            load._lastmod = loadLastmod.date();
+        }
+
+        return load;
+    }
+
+    Status ChunkLoadType::validate() const {
+        if (!_mongos.is_initialized() || _mongos->empty()) {
+            return Status(ErrorCodes::NoSuchKey,
+                          str::stream() << "missing " << mongos.name() << " field");
+        }
+
+        if (!_ns.is_initialized() || _ns->empty()) {
+            return Status(ErrorCodes::NoSuchKey,
+                          str::stream() << "missing " << ns.name() << " field");
+        }
+
+        if (!_min.is_initialized() || _min->isEmpty()) {
+            return Status(ErrorCodes::NoSuchKey,
+                          str::stream() << "missing " << min.name() << " field");
+        }
+
+        if (!_max.is_initialized() || _max->isEmpty()) {
+            return Status(ErrorCodes::NoSuchKey,
+                          str::stream() << "missing " << max.name() << " field");
+        }
+
+        if (!_shard.is_initialized() || _shard->empty()) {
+            return Status(ErrorCodes::NoSuchKey,
+                          str::stream() << "missing " << shard.name() << " field");
+        }
+
+        if (!_readsPerSec.is_initialized()) {
+            return Status(ErrorCodes::NoSuchKey,
+                          str::stream() << "missing " << readsPerSec.name() << " field");
+        }
+
+        if (!_writesPerSec.is_initialized()) {
+            return Status(ErrorCodes::NoSuchKey,
+                          str::stream() << "missing " << writesPerSec.name() << " field");
+        }
+
+        if (!_lastmod.is_initialized()) {
+            return Status(ErrorCodes::NoSuchKey,
+                          str::stream() << "missing " << lastmod.name() << " field");
+        }
+
+        // 'max' should be greater than 'min'.
+        if (_min->woCompare(_max.get()) >= 0) {
+            return Status(ErrorCodes::BadValue, "max key must be greater than min key");
+        }
+
+        if (getReadsPerSec() < 0 || getWritesPerSec() < 0) {
+            return Status(ErrorCodes::BadValue, "operation rates can't be negative");
+        }
+
+        return Status::OK();
+    }
+
+    BSONObj ChunkLoadType::toBSON() const {
+        BSONObjBuilder builder;
+
+        if (_mongos && _ns && _min) {
+            builder.append("_id", BSON(mongos.name() << getMongos() <<
+                                       ns.name() << getNS() <<
+                                       min.name() << getMin()));
+        }
+        if (_mongos) builder.append(mongos.name(), getMongos());
+        if (_ns) builder.append(ns.name(), getNS());
+        if (_min) builder.append(min.name(), getMin());
+        if (_max) builder.append(max.name(), getMax());
+        if (_shard) builder.append(shard.name(), getShard());
+        if (_readsPerSec) builder.append(readsPerSec.name(), getReadsPerSec());
+        if (_writesPerSec) builder.append(writesPerSec.name(), getWritesPerSec());
+        if (_lastmod) builder.append(lastmod.name(), getLastmod());
+
+        return builder.obj();
+    }
+
+    std::string ChunkLoadType::toString() const {
+        return toBSON().toString();
+    }
+
+    void ChunkLoadType::setMongos(const std::string& mongos) {
+        invariant(!mongos.empty());
+        _mongos = mongos;
+    }
+
+    void ChunkLoadType::setNS(const std::string& ns) {
+        invariant(!ns.empty());
+        _ns = ns;
+    }
+
+    void ChunkLoadType::setMin(const BSONObj& min) {
+        invariant(!min.isEmpty());
+        _min = min.getOwned();
+    }
+
+    void ChunkLoadType::setMax(const BSONObj& max) {
+        invariant(!max.isEmpty());
+        _max = max.getOwned();
+    }
+
+    void ChunkLoadType::setShard(const std::string& shard) {
+        invariant(!shard.empty());
+        _shard = shard;
+    }
+
+    void ChunkLoadType::setReadsPerSec(double readsPerSec) {
+        invariant(readsPerSec >= 0);
+        _readsPerSec = readsPerSec;
+    }
+
+    void ChunkLoadType::setWritesPerSec(double writesPerSec) {
+        invariant(writesPerSec >= 0);
+        _writesPerSec = writesPerSec;
+    }
+
+    void ChunkLoadType::setLastmod(Date_t lastmod) {
+        _lastmod = lastmod;
+    }
+
+} // namespace mongo
@@ -0,0 +1,137 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    class BSONObj;
+    class Status;
+    template<typename T> class StatusWith;
+
+
+    /**
+     * This class represents the layout and contents of documents contained in the config.chunkLoad
+     * collection. Each document holds the operation rates one mongos routed to one chunk over its
+     * last report. All manipulation of documents coming from that collection should be done with
+     * this class.
+     */
+    class ChunkLoadType {
+    public:
+        // Name of the chunkLoad collection in the config server.
+        static const std::string ConfigNS;
+
+        // Field names and types in the chunkLoad collection type.
+        static const BSONField<std::string> mongos;
+        static const BSONField<std::string> ns;
+        static const BSONField<BSONObj> min;
+        static const BSONField<BSONObj> max;
+        static const BSONField<std::string> shard;
+        static const BSONField<double> readsPerSec;
+        static const BSONField<double> writesPerSec;
+        static const BSONField<Date_t> lastmod;
+
+
+        /**
+         * Constructs a new ChunkLoadType object from BSON. Validates that all required fields are
+         * present.
+         */
+        static StatusWith<ChunkLoadType> fromBSON(const BSONObj& source);
+
+        /**
+         * Returns OK if all fields have been set. Otherwise returns NoSuchKey and information
+         * about what is the first field which is missing.
+         */
+        Status validate() const;
+
+        /**
+         * Returns the BSON representation of the entry. The _id is made of the mongos, the
+         * namespace and the chunk's min, so that each mongos has one document per chunk.
+         */
+        BSONObj toBSON() const;
+
+        /**
+         * Returns a std::string representation of the current internal state.
+         */
+        std::string toString() const;
+
+        const std::string& getMongos() const { return _mongos.get(); }
+        void setMongos(const std::string& mongos);
+
+        const std::string& getNS() const { return _ns.get(); }
+        void setNS(const std::string& ns);
+
+        const BSONObj& getMin() const { return _min.get(); }
+        void setMin(const BSONObj& min);
+
+        const BSONObj& getMax() const { return _max.get(); }
+        void setMax(const BSONObj& max);
+
+        const std::string& getShard() const { return _shard.get(); }
+        void setShard(const std::string& shard);
+
+        double getReadsPerSec() const { return _readsPerSec.get(); }
+        void setReadsPerSec(double readsPerSec);
+
+        double getWritesPerSec() const { return _writesPerSec.get(); }
+        void setWritesPerSec(double writesPerSec);
+
+        Date_t getLastmod() const { return _lastmod.get(); }
+        void setLastmod(Date_t lastmod);
+
+    private:
+        // Required host:port of the mongos which routed the operations
+        boost::optional<std::string> _mongos;
+
+        // Required namespace of the chunk
+        boost::optional<std::string> _ns;
+
+        // Required first key of the chunk (inclusive)
+        boost::optional<BSONObj> _min;
+
+        // Required last key of the chunk (not-inclusive)
+        boost::optional<BSONObj> _max;
+
+        // Required shard the chunk was on when the operations were routed
+        boost::optional<std::string> _shard;
+
+        // Required rates of the reads and of the writes, in operations per second
+        boost::optional<double> _readsPerSec;
+        boost::optional<double> _writesPerSec;
+
+        // Required time the rates were reported
+        boost::optional<Date_t> _lastmod;
+    };
+
+} // namespace mongo
@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/catalog/type_chunk_load.h"
+
+#include "mongo/base/status_with.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    using std::string;
+
+    TEST(ChunkLoadType, Valid) {
+        BSONObj obj = BSON(ChunkLoadType::mongos("host:27017") <<
+                           ChunkLoadType::ns("test.mycol") <<
+                           ChunkLoadType::min(BSON("a" << 10)) <<
+                           ChunkLoadType::max(BSON("a" << 20)) <<
+                           ChunkLoadType::shard("shard0000") <<
+                           ChunkLoadType::readsPerSec(12.5) <<
+                           ChunkLoadType::writesPerSec(3) <<
+                           ChunkLoadType::lastmod(Date_t::fromMillisSinceEpoch(1000)));
+
+        StatusWith<ChunkLoadType> status = ChunkLoadType::fromBSON(obj);
+        ASSERT_TRUE(status.isOK());
+
+        ChunkLoadType load = status.getValue();
+        ASSERT_OK(load.validate());
+
+        ASSERT_EQUALS(load.getMongos(), "host:27017");
+        ASSERT_EQUALS(load.getNS(), "test.mycol");
+        ASSERT_EQUALS(load.getMin(), BSON("a" << 10));
+        ASSERT_EQUALS(load.getMax(), BSON("a" << 20));
+        ASSERT_EQUALS(load.getShard(), "shard0000");
+        ASSERT_EQUALS(load.getReadsPerSec(), 12.5);
+        ASSERT_EQUALS(load.getWritesPerSec(), 3.0);
+        ASSERT_EQUALS(load.getLastmod(), Date_t::fromMillisSinceEpoch(1000));
+    }
+
+    TEST(ChunkLoadType, RoundTrip) {
+        ChunkLoadType load;
+        load.setMongos("host:27017");
+        load.setNS("test.mycol");
+        load.setMin(BSON("a" << 10));
+        load.setMax(BSON("a" << 20));
+        load.setShard("shard0000");
+        load.setReadsPerSec(1);
+        load.setWritesPerSec(2);
+        load.setLastmod(Date_t::fromMillisSinceEpoch(1000));
+
+        BSONObj obj = load.toBSON();
+        ASSERT_EQUALS(obj["_id"].Obj(), BSON("mongos" << "host:27017" <<
+                                              "ns" << "test.mycol" <<
+                                              "min" << BSON("a" << 10)));
+
+        StatusWith<ChunkLoadType> status = ChunkLoadType::fromBSON(obj);
+        ASSERT_TRUE(status.isOK());
+        ASSERT_EQUALS(obj, status.getValue().toBSON());
+    }
+
+    TEST(ChunkLoadType, MissingRate) {
+        BSONObj obj = BSON(ChunkLoadType::mongos("host:27017") <<
+                           ChunkLoadType::ns("test.mycol") <<
+                           ChunkLoadType::min(BSON("a" << 10)) <<
+                           ChunkLoadType::max(BSON("a" << 20)) <<
+                           ChunkLoadType::shard("shard0000") <<
+                           ChunkLoadType::readsPerSec(12.5) <<
+                           ChunkLoadType::lastmod(Date_t::fromMillisSinceEpoch(1000)));
+
+        StatusWith<ChunkLoadType> status = ChunkLoadType::fromBSON(obj);
+        ASSERT_FALSE(status.isOK());
+        ASSERT_EQUALS(ErrorCodes::NoSuchKey, status.getStatus());
+    }
+
+    TEST(ChunkLoadType, RateNotANumber) {
+        BSONObj obj = BSON(ChunkLoadType::mongos("host:27017") <<
+                           ChunkLoadType::ns("test.mycol") <<
+                           ChunkLoadType::min(BSON("a" << 10)) <<
+                           ChunkLoadType::max(BSON("a" << 20)) <<
+                           ChunkLoadType::shard("shard0000") <<
+                           ChunkLoadType::readsPerSec(12.5) <<
+                           "writesPerSec" << "fast" <<
+                           ChunkLoadType::lastmod(Date_t::fromMillisSinceEpoch(1000)));
+
+        StatusWith<ChunkLoadType> status = ChunkLoadType::fromBSON(obj);
+        ASSERT_FALSE(status.isOK());
+        ASSERT_EQUALS(ErrorCodes::TypeMismatch, status.getStatus());
+    }
+
+    TEST(ChunkLoadType, MinNotLessThanMax) {
+        BSONObj obj = BSON(ChunkLoadType::mongos("host:27017") <<
+                           ChunkLoadType::ns("test.mycol") <<
+                           ChunkLoadType::min(BSON("a" << 20)) <<
+                           ChunkLoadType::max(BSON("a" << 10)) <<
+                           ChunkLoadType::shard("shard0000") <<
+                           ChunkLoadType::readsPerSec(12.5) <<
+                           ChunkLoadType::writesPerSec(3) <<
+                           ChunkLoadType::lastmod(Date_t::fromMillisSinceEpoch(1000)));
+
+        StatusWith<ChunkLoadType> status = ChunkLoadType::fromBSON(obj);
+        ASSERT_TRUE(status.isOK());
+        ASSERT_EQUALS(ErrorCodes::BadValue, status.getValue().validate());
+    }
+
+} // namespace
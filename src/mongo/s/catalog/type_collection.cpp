@@ -34,7 +34,9 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/hasher.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -47,6 +49,7 @@ namespace mongo {
     const BSONField<bool> CollectionType::unique("unique");
     const BSONField<bool> CollectionType::noBalance("noBalance");
     const BSONField<bool> CollectionType::dropped("dropped");
+    const BSONField<int> CollectionType::hashVersion("hashVersion");
 
 
     StatusWith<CollectionType> CollectionType::fromBSON(const BSONObj& source) {
@@ -131,6 +134,28 @@ namespace mongo {
             coll._allowBalance = !collNoBalance;
         }
 
+        {
+            long long collHashVersion;
+
+            // Hash version can be missing in which case the hashed key uses version 0
+            Status status = bsonExtractIntegerFieldWithDefault(source,
+                                                               hashVersion.name(),
+                                                               0,
+                                                               &collHashVersion);
+            if (!status.isOK()) return status;
+
+            if (!BSONElementHasher::isValidHashVersion(collHashVersion)) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "invalid hash version " << collHashVersion);
+            }
+
+            // Collections sharded before hash versions could be chosen have no such field, and
+            // it is left out again when writing them back
+            if (source.hasField(hashVersion.name())) {
+                coll._hashVersion = static_cast<int>(collHashVersion);
+            }
+        }
+
         return StatusWith<CollectionType>(coll);
     }
 
@@ -200,6 +225,10 @@ namespace mongo {
             builder.append(noBalance.name(), !_allowBalance.get());
         }
 
+        if (_hashVersion.is_initialized()) {
+            builder.append(hashVersion.name(), _hashVersion.get());
+        }
+
         return builder.obj();
     }
 
@@ -225,4 +254,9 @@ namespace mongo {
         _keyPattern = keyPattern;
     }
 
+    void CollectionType::setHashVersion(int hashVersion) {
+        invariant(BSONElementHasher::isValidHashVersion(hashVersion));
+        _hashVersion = hashVersion;
+    }
+
 } // namespace mongo
@@ -58,6 +58,7 @@ namespace mongo {
         static const BSONField<bool> unique;
         static const BSONField<bool> noBalance;
         static const BSONField<bool> dropped;
+        static const BSONField<int> hashVersion;
 
 
         /**
@@ -101,6 +102,9 @@ namespace mongo {
 
         bool getAllowBalance() const { return _allowBalance.get_value_or(true); }
 
+        int getHashVersion() const { return _hashVersion.get_value_or(0); }
+        void setHashVersion(int hashVersion);
+
     private:
         // Required full namespace (with the database prefix).
         boost::optional<NamespaceString> _fullNs;
@@ -122,6 +126,9 @@ namespace mongo {
 
         // Optional whether balancing is allowed for this collection. If missing, implies true.
         boost::optional<bool> _allowBalance;
+
+        // Optional hash function version of a hashed sharding key. If missing, implies 0.
+        boost::optional<int> _hashVersion;
     };
 
 } // namespace mongo
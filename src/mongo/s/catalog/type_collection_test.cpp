@@ -90,4 +90,29 @@ namespace {
         ASSERT_FALSE(status.isOK());
     }
 
+    TEST(CollectionType, HashVersion) {
+        const OID oid = OID::gen();
+        BSONObj withoutVersion =
+                BSON(CollectionType::fullNs("db.coll") <<
+                     CollectionType::epoch(oid) <<
+                     CollectionType::updatedAt(Date_t::fromMillisSinceEpoch(1)) <<
+                     CollectionType::keyPattern(BSON("a" << "hashed")));
+        StatusWith<CollectionType> status = CollectionType::fromBSON(withoutVersion);
+        ASSERT_TRUE(status.isOK());
+        ASSERT_EQUALS(status.getValue().getHashVersion(), 0);
+        ASSERT_FALSE(status.getValue().toBSON().hasField(CollectionType::hashVersion()));
+
+        status = CollectionType::fromBSON(
+                BSONObjBuilder().appendElements(withoutVersion)
+                                .append(CollectionType::hashVersion(), 1).obj());
+        ASSERT_TRUE(status.isOK());
+        ASSERT_EQUALS(status.getValue().getHashVersion(), 1);
+        ASSERT_EQUALS(status.getValue().toBSON()[CollectionType::hashVersion()].numberInt(), 1);
+
+        status = CollectionType::fromBSON(
+                BSONObjBuilder().appendElements(withoutVersion)
+                                .append(CollectionType::hashVersion(), 2).obj());
+        ASSERT_FALSE(status.isOK());
+    }
+
 } // namespace
@@ -57,6 +57,7 @@ namespace mongo {
     const BSONField<bool> SettingsType::deprecated_secondaryThrottle("_secondaryThrottle");
     const BSONField<BSONObj> SettingsType::migrationWriteConcern("_secondaryThrottle");
     const BSONField<bool> SettingsType::waitForDelete("_waitForDelete");
+    const BSONField<bool> SettingsType::loadAware("_loadAware");
 
     StatusWith<SettingsType> SettingsType::fromBSON(const BSONObj& source) {
         SettingsType settings;
@@ -138,6 +139,17 @@ namespace mongo {
                     settings._waitForDelete = settingsWaitForDelete;
                 }
             }
+
+            {
+                bool settingsLoadAware;
+                Status status = bsonExtractBooleanField(source,
+                                                        loadAware.name(),
+                                                        &settingsLoadAware);
+                if (status != ErrorCodes::NoSuchKey) {
+                    if (!status.isOK()) return status;
+                    settings._loadAware = settingsLoadAware;
+                }
+            }
         }
 
         return settings;
@@ -185,6 +197,7 @@ namespace mongo {
             builder.append(migrationWriteConcern(), getMigrationWriteConcern().toBSON());
         }
         if (_waitForDelete) builder.append(waitForDelete(), getWaitForDelete());
+        if (_loadAware) builder.append(loadAware(), getLoadAware());
 
         return builder.obj();
     }
@@ -303,4 +316,9 @@ namespace mongo {
         _waitForDelete = waitForDelete;
     }
 
+    void SettingsType::setLoadAware(const bool loadAware) {
+        invariant(_key == BalancerDocKey);
+        _loadAware = loadAware;
+    }
+
 } // namespace mongo
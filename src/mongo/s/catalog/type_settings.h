@@ -83,6 +83,7 @@ namespace mongo {
         static const BSONField<bool> deprecated_secondaryThrottle;
         static const BSONField<BSONObj> migrationWriteConcern;
         static const BSONField<bool> waitForDelete;
+        static const BSONField<bool> loadAware;
 
         /**
          * Returns OK if all mandatory fields have been set and their corresponding
@@ -148,6 +149,10 @@ namespace mongo {
         bool getWaitForDelete() const { return _waitForDelete.get(); }
         void setWaitForDelete(const bool waitForDelete);
 
+        bool isLoadAwareSet() const { return _loadAware.is_initialized(); }
+        bool getLoadAware() const { return _loadAware.get(); }
+        void setLoadAware(const bool loadAware);
+
     private:
 
         /**
@@ -185,6 +190,10 @@ namespace mongo {
 
         // (O)  synchronous migration cleanup.
         boost::optional<bool> _waitForDelete;
+
+        // (O)  balance by the operation rates and data sizes of the shards rather than by their
+        //      numbers of chunks.
+        boost::optional<bool> _loadAware;
     };
 
 } // namespace mongo
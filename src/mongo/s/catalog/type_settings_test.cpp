@@ -132,6 +132,25 @@ namespace {
         ASSERT(settings.getSecondaryThrottle());
     }
 
+    TEST(SettingsType, LoadAware) {
+        BSONObj objBalancer = BSON(SettingsType::key(SettingsType::BalancerDocKey) <<
+                                   SettingsType::loadAware(true));
+        StatusWith<SettingsType> result = SettingsType::fromBSON(objBalancer);
+        ASSERT_OK(result.getStatus());
+        SettingsType settings = result.getValue();
+        ASSERT(settings.isLoadAwareSet());
+        ASSERT(settings.getLoadAware());
+        ASSERT_EQUALS(objBalancer, settings.toBSON());
+
+        result = SettingsType::fromBSON(BSON(SettingsType::key(SettingsType::BalancerDocKey)));
+        ASSERT_OK(result.getStatus());
+        ASSERT_FALSE(result.getValue().isLoadAwareSet());
+
+        result = SettingsType::fromBSON(BSON(SettingsType::key(SettingsType::BalancerDocKey) <<
+                                             "_loadAware" << "yes"));
+        ASSERT_FALSE(result.isOK());
+    }
+
     TEST(SettingsType, BadType) {
         BSONObj badTypeObj = BSON(SettingsType::key() << 0);
         StatusWith<SettingsType> result = SettingsType::fromBSON(badTypeObj);
@@ -69,6 +69,19 @@ namespace {
 
     const int kTooManySplitPoints = 4;
 
+    /**
+     * How long a splitVector command took, whether it sampled the keys, and how many keys it
+     * looked at, for the changelog entry of the split. Empty if the shard did not say.
+     */
+    BSONObj getSplitVectorStats(const BSONObj& splitVectorResult) {
+        if (!splitVectorResult.hasField("timeMillis")) {
+            return BSONObj();
+        }
+        return BSON("millis" << splitVectorResult["timeMillis"].numberLong()
+                    << "sampled" << splitVectorResult["sampled"].trueValue()
+                    << "keysExamined" << splitVectorResult["keysExamined"].numberLong());
+    }
+
     /**
      * Attempts to move the given chunk to another shard.
      *
@@ -279,7 +292,7 @@ namespace {
         return _manager->getShardKeyPattern().extractShardKeyFromDoc(end);
     }
 
-    void Chunk::pickMedianKey( BSONObj& medianKey ) const {
+    void Chunk::pickMedianKey( BSONObj& medianKey, BSONObj* splitVectorStats ) const {
         // Ask the mongod holding this chunk to figure out the split points.
         ScopedDbConnection conn(_getShardConnectionString());
         BSONObj result;
@@ -302,6 +315,9 @@ namespace {
         if ( it.more() ) {
             medianKey = it.next().Obj().getOwned();
         }
+        if ( splitVectorStats ) {
+            *splitVectorStats = getSplitVectorStats(result);
+        }
 
         conn.done();
     }
@@ -309,7 +325,8 @@ namespace {
     void Chunk::pickSplitVector(vector<BSONObj>& splitPoints,
                                 long long chunkSize /* bytes */,
                                 int maxPoints,
-                                int maxObjs) const {
+                                int maxObjs,
+                                BSONObj* splitVectorStats) const {
         // Ask the mongod holding this chunk to figure out the split points.
         ScopedDbConnection conn(_getShardConnectionString());
         BSONObj result;
@@ -334,16 +351,21 @@ namespace {
         while ( it.more() ) {
             splitPoints.push_back( it.next().Obj().getOwned() );
         }
+        if ( splitVectorStats ) {
+            *splitVectorStats = getSplitVectorStats(result);
+        }
         conn.done();
     }
 
-    void Chunk::determineSplitPoints(bool atMedian, vector<BSONObj>* splitPoints) const {
+    void Chunk::determineSplitPoints(bool atMedian,
+                                     vector<BSONObj>* splitPoints,
+                                     BSONObj* splitVectorStats) const {
         // if splitting is not obligatory we may return early if there are not enough data
         // we cap the number of objects that would fall in the first half (before the split point)
         // the rationale is we'll find a split point without traversing all the data
         if ( atMedian ) {
             BSONObj medianKey;
-            pickMedianKey( medianKey );
+            pickMedianKey( medianKey, splitVectorStats );
             if ( ! medianKey.isEmpty() )
                 splitPoints->push_back( medianKey );
         }
@@ -360,7 +382,7 @@ namespace {
                 chunkSize = std::min(_dataWritten, Chunk::MaxChunkSize);
             }
 
-            pickSplitVector(*splitPoints, chunkSize, 0, MaxObjectPerChunk);
+            pickSplitVector(*splitPoints, chunkSize, 0, MaxObjectPerChunk, splitVectorStats);
 
             if ( splitPoints->size() <= 1 ) {
                 // no split points means there isn't enough data to split on
@@ -380,7 +402,8 @@ namespace {
         bool atMedian = mode == Chunk::atMedian;
         vector<BSONObj> splitPoints;
 
-        determineSplitPoints( atMedian, &splitPoints );
+        BSONObj splitVectorStats;
+        determineSplitPoints( atMedian, &splitPoints, &splitVectorStats );
         if (splitPoints.empty()) {
             string msg;
             if (atMedian) {
@@ -435,12 +458,14 @@ namespace {
             return Status(ErrorCodes::CannotSplit, msg);
         }
 
-        Status status = multiSplit(splitPoints, res);
+        Status status = multiSplit(splitPoints, res, splitVectorStats);
         *resultingSplits = splitPoints.size();
         return status;
     }
 
-    Status Chunk::multiSplit(const vector<BSONObj>& m, BSONObj* res) const {
+    Status Chunk::multiSplit(const vector<BSONObj>& m,
+                             BSONObj* res,
+                             const BSONObj& splitVectorStats) const {
         const size_t maxSplitPoints = 8192;
 
         uassert( 10165 , "can't split as shard doesn't have a manager" , _manager );
@@ -459,6 +484,9 @@ namespace {
         cmd.append( "splitKeys" , m );
         cmd.append("configdb", grid.catalogManager()->connectionString().toString());
         cmd.append("epoch", _manager->getVersion().epoch());
+        if (!splitVectorStats.isEmpty()) {
+            cmd.append("splitVectorStats", splitVectorStats);
+        }
         BSONObj cmdObj = cmd.obj();
 
         BSONObj dummy;
@@ -141,28 +141,34 @@ namespace mongo {
          *
          * @param splitPoints the vector of keys that should be used to divide this chunk
          * @param res the object containing details about the split execution
+         * @param splitVectorStats how the split points were found, for the changelog (optional)
          *
          * @throws UserException
          */
-        Status multiSplit(const std::vector<BSONObj>& splitPoints, BSONObj* res) const;
+        Status multiSplit(const std::vector<BSONObj>& splitPoints,
+                          BSONObj* res,
+                          const BSONObj& splitVectorStats = BSONObj()) const;
 
         /**
          * Asks the mongod holding this chunk to find a key that approximately divides this chunk in two
          *
          * @param medianKey the key that divides this chunk, if there is one, or empty
+         * @param splitVectorStats set to how the shard found the key, if not null
          */
-        void pickMedianKey( BSONObj& medianKey ) const;
+        void pickMedianKey( BSONObj& medianKey, BSONObj* splitVectorStats = NULL ) const;
 
         /**
          * @param splitPoints vector to be filled in
          * @param chunkSize chunk size to target in bytes
          * @param maxPoints limits the number of split points that are needed, zero is max (optional)
          * @param maxObjs limits the number of objects in each chunk, zero is as max (optional)
+         * @param splitVectorStats set to how the shard found the points, if not null (optional)
          */
         void pickSplitVector(std::vector<BSONObj>& splitPoints,
                              long long chunkSize,
                              int maxPoints = 0,
-                             int maxObjs = 0) const;
+                             int maxObjs = 0,
+                             BSONObj* splitVectorStats = NULL) const;
 
         //
         // migration support
@@ -280,8 +286,11 @@ namespace mongo {
          *
          * @param atMedian perform a single split at the middle of this chunk.
          * @param splitPoints out parameter containing the chosen split points. Can be empty.
+         * @param splitVectorStats out parameter saying how the shard found them.
          */
-        void determineSplitPoints(bool atMedian, std::vector<BSONObj>* splitPoints) const;
+        void determineSplitPoints(bool atMedian,
+                                  std::vector<BSONObj>* splitPoints,
+                                  BSONObj* splitVectorStats) const;
 
         /** initializes _dataWritten with a random value so that a mongos restart wouldn't cause delay in splitting */
         static int mkDataWritten();
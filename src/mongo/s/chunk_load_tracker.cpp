@@ -0,0 +1,133 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_load_tracker.h"
+
+#include <algorithm>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/catalog/type_chunk_load.h"
+#include "mongo/s/chunk.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+    // One of how many routed operations is sampled, or 0 to sample none.
+    MONGO_EXPORT_SERVER_PARAMETER(chunkLoadSampleInterval, int, 100);
+
+    ChunkLoadTracker chunkLoadTracker;
+
+    ChunkLoadTracker::ChunkLoadTracker() : _opCount(0) { }
+
+    bool ChunkLoadTracker::shouldSample() {
+        const int interval = chunkLoadSampleInterval;
+        if (interval <= 0) {
+            return false;
+        }
+
+        return _opCount.addAndFetch(1) % static_cast<unsigned>(interval) == 0;
+    }
+
+    void ChunkLoadTracker::noteRead(const Chunk& chunk) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _getSampledOps_inlock(chunk)->reads += std::max(chunkLoadSampleInterval, 1);
+    }
+
+    void ChunkLoadTracker::noteWrite(const Chunk& chunk) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _getSampledOps_inlock(chunk)->writes += std::max(chunkLoadSampleInterval, 1);
+    }
+
+    ChunkLoadTracker::SampledOps* ChunkLoadTracker::_getSampledOps_inlock(const Chunk& chunk) {
+        SampledOps& ops = _sampledOps[std::make_pair(chunk.getns(), chunk.getMin())];
+        if (ops.max.isEmpty()) {
+            ops.max = chunk.getMax();
+            ops.shardId = chunk.getShardId();
+        }
+        return &ops;
+    }
+
+    void ChunkLoadTracker::takeLoads(const string& mongosId,
+                                     size_t maxChunks,
+                                     vector<ChunkLoadType>* loads) {
+        loads->clear();
+
+        const Date_t now = jsTime();
+
+        SampledOpsMap sampledOps;
+        Date_t lastTaken;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            sampledOps.swap(_sampledOps);
+            lastTaken = _lastTaken;
+            _lastTaken = now;
+        }
+
+        // The first time around, there is nothing to tell how long the operations took to come.
+        if (lastTaken == Date_t()) {
+            return;
+        }
+
+        const double elapsedSecs =
+            std::max(durationCount<Milliseconds>(now - lastTaken) / 1000.0, 1.0);
+
+        vector<SampledOpsMap::const_iterator> hottest;
+        hottest.reserve(sampledOps.size());
+        for (SampledOpsMap::const_iterator it = sampledOps.begin(); it != sampledOps.end(); ++it) {
+            hottest.push_back(it);
+        }
+
+        std::sort(hottest.begin(), hottest.end(),
+                  [](SampledOpsMap::const_iterator lhs, SampledOpsMap::const_iterator rhs) {
+                      return lhs->second.reads + lhs->second.writes
+                             > rhs->second.reads + rhs->second.writes;
+                  });
+        if (hottest.size() > maxChunks) {
+            hottest.resize(maxChunks);
+        }
+
+        for (SampledOpsMap::const_iterator it : hottest) {
+            ChunkLoadType load;
+            load.setMongos(mongosId);
+            load.setNS(it->first.first);
+            load.setMin(it->first.second);
+            load.setMax(it->second.max);
+            load.setShard(it->second.shardId);
+            load.setReadsPerSec(it->second.reads / elapsedSecs);
+            load.setWritesPerSec(it->second.writes / elapsedSecs);
+            load.setLastmod(now);
+            loads->push_back(load);
+        }
+    }
+
+} // namespace mongo
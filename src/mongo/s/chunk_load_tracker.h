@@ -0,0 +1,105 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    class Chunk;
+    class ChunkLoadType;
+
+    /**
+     * Samples the operations this mongos routes to each chunk, so that the load-aware balancer can
+     * tell the hot chunks and shards from the cold ones. One of every chunkLoadSampleInterval
+     * routed operations is recorded, and counts for chunkLoadSampleInterval operations.
+     *
+     * Every mongos reports the rates it sampled to config.chunkLoad at each balancer round, so the
+     * active balancer sees the load routed by all of them.
+     */
+    class ChunkLoadTracker {
+        MONGO_DISALLOW_COPYING(ChunkLoadTracker);
+    public:
+        ChunkLoadTracker();
+
+        /**
+         * Returns true if the operation about to be routed should be recorded with noteRead or
+         * noteWrite. Cheap enough to call for every operation.
+         */
+        bool shouldSample();
+
+        void noteRead(const Chunk& chunk);
+        void noteWrite(const Chunk& chunk);
+
+        /**
+         * Fills 'loads' with the operation rates of at most 'maxChunks' of the chunks operations
+         * were recorded for since the previous call, hottest first, and forgets them.
+         */
+        void takeLoads(const std::string& mongosId,
+                       size_t maxChunks,
+                       std::vector<ChunkLoadType>* loads);
+
+    private:
+        struct SampledOps {
+            SampledOps(): reads(0), writes(0) { }
+
+            BSONObj max;
+            std::string shardId;
+            long long reads;
+            long long writes;
+        };
+
+        // (ns, chunk min) -> operations routed to the chunk
+        typedef std::map<std::pair<std::string, BSONObj>, SampledOps> SampledOpsMap;
+
+        SampledOps* _getSampledOps_inlock(const Chunk& chunk);
+
+        AtomicUInt32 _opCount;
+
+        // Protects everything below.
+        stdx::mutex _mutex;
+
+        SampledOpsMap _sampledOps;
+
+        // When takeLoads was last called, or Date_t() if it never was.
+        Date_t _lastTaken;
+    };
+
+    extern ChunkLoadTracker chunkLoadTracker;
+
+} // namespace mongo
@@ -32,7 +32,9 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <algorithm>
 #include <boost/next_prior.hpp>
+#include <cstring>
 #include <map>
 #include <set>
 
@@ -40,12 +42,14 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_diff.h"
+#include "mongo/s/chunk_load_tracker.h"
 #include "mongo/s/client/shard_connection.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/config.h"
@@ -145,7 +149,7 @@ namespace {
 
     ChunkManager::ChunkManager(const string& ns, const ShardKeyPattern& pattern, bool unique)
         : _ns( ns ),
-          _keyPattern( pattern.getKeyPattern() ),
+          _keyPattern( pattern.getKeyPattern(), pattern.getHashVersion() ),
           _unique( unique ),
           _sequenceNumber(NextSequenceNumber.addAndFetch(1)),
           _chunkRanges() {
@@ -154,7 +158,7 @@ namespace {
 
     ChunkManager::ChunkManager(const CollectionType& coll)
         : _ns(coll.getNs()),
-          _keyPattern(coll.getKeyPattern()),
+          _keyPattern(coll.getKeyPattern(), coll.getHashVersion()),
           _unique(coll.getUnique()),
           _sequenceNumber(NextSequenceNumber.addAndFetch(1)),
           _chunkRanges() {
@@ -187,6 +191,9 @@ namespace {
                     _shardIds.swap(shardIds);
                     _shardVersions.swap(shardVersions);
                     _chunkRanges.reloadAll(_chunkMap);
+                    _routingTable.reloadAll(_chunkMap,
+                                            _keyPattern,
+                                            oldManager ? &oldManager->_routingTable : NULL);
 
                     return;
                 }
@@ -431,22 +438,14 @@ namespace {
 
     ChunkPtr ChunkManager::findIntersectingChunk( const BSONObj& shardKey ) const {
         {
-            BSONObj chunkMin;
-            ChunkPtr chunk;
-            {
-                ChunkMap::const_iterator it = _chunkMap.upper_bound( shardKey );
-                if (it != _chunkMap.end()) {
-                    chunkMin = it->first;
-                    chunk = it->second;
-                }
-            }
+            ChunkPtr chunk = _routingTable.upperBound( shardKey );
 
             if ( chunk ) {
                 if ( chunk->containsKey( shardKey ) ){
                     return chunk;
                 }
 
-                log() << chunkMin;
+                log() << chunk->getMax();
                 log() << *chunk;
                 log() << shardKey;
 
@@ -485,7 +484,9 @@ namespace {
         //   Query { a : { $gte : 1, $lt : 2 },
         //            b : { $gte : 3, $lt : 4 } }
         //   => Bounds { a : [1, 2), b : [3, 4) }
-        IndexBounds bounds = getIndexBoundsForQuery(_keyPattern.toBSON(), canonicalQuery);
+        IndexBounds bounds = getIndexBoundsForQuery(_keyPattern.toBSON(),
+                                                    canonicalQuery,
+                                                    _keyPattern.getHashVersion());
 
         // Transforms bounds for each shard key field into full shard key ranges
         // for example :
@@ -494,6 +495,15 @@ namespace {
         //   => Ranges { a : 1, b : 3 } => { a : 2, b : 4 }
         BoundList ranges = _keyPattern.flattenBounds(bounds);
 
+        // Sampled for the load-aware balancer. Only the queries for a single chunk are counted,
+        // the ones which can't tell hot chunks from cold ones are left out.
+        if (ranges.size() == 1 && chunkLoadTracker.shouldSample()) {
+            ChunkPtr chunk = findIntersectingChunk(ranges.front().first);
+            if (chunk == findIntersectingChunk(ranges.front().second)) {
+                chunkLoadTracker.noteRead(*chunk);
+            }
+        }
+
         for (BoundList::const_iterator it = ranges.begin(); it != ranges.end();
             ++it) {
 
@@ -539,7 +549,9 @@ namespace {
         all->insert(_shardIds.begin(), _shardIds.end());
     }
 
-    IndexBounds ChunkManager::getIndexBoundsForQuery(const BSONObj& key, const CanonicalQuery* canonicalQuery) {
+    IndexBounds ChunkManager::getIndexBoundsForQuery(const BSONObj& key,
+                                                     const CanonicalQuery* canonicalQuery,
+                                                     int hashVersion) {
         // $text is not allowed in planning since we don't have text index on mongos.
         //
         // TODO: Treat $text query as a no-op in planning. So with shard key {a: 1},
@@ -559,7 +571,8 @@ namespace {
         // Must use "shard key" index
         plannerParams.options = QueryPlannerParams::NO_TABLE_SCAN;
         IndexEntry indexEntry(key, accessMethod, false /* multiKey */, false /* sparse */,
-                              false /* unique */, "shardkey", NULL /* filterExpr */, BSONObj());
+                              false /* unique */, "shardkey", NULL /* filterExpr */,
+                              BSON("hashVersion" << hashVersion));
         plannerParams.indices.push_back(indexEntry);
 
         OwnedPointerVector<QuerySolution> solutions;
@@ -779,6 +792,112 @@ namespace {
         }
     }
 
+    void ChunkRoutingTable::reloadAll(const ChunkMap& chunks,
+                                      const ShardKeyPattern& pattern,
+                                      const ChunkRoutingTable* previous) {
+        _ordering = Ordering::make(pattern.toBSON());
+        if (previous && (previous == this ||
+                         previous->_ordering.descending(~0U) != _ordering.descending(~0U))) {
+            previous = NULL;
+        }
+        _keys.clear();
+        _offsets.clear();
+        _chunks.clear();
+        _hashedMaxes.clear();
+
+        _keys.reserve(previous ? previous->_keys.size() : 0);
+        _offsets.reserve(chunks.size() + 1);
+        _chunks.reserve(chunks.size());
+
+        _hashed = pattern.isHashedPattern();
+        if (_hashed) {
+            _hashedMaxes.reserve(chunks.size());
+        }
+
+        size_t previousIndex = 0;
+        for (ChunkMap::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            _offsets.push_back(_keys.size());
+
+            // A chunk copied from the previous version shares the BSON of its max with it
+            if (previous && previousIndex < previous->_chunks.size() &&
+                    previous->_chunks[previousIndex]->getMax().objdata() == it->first.objdata()) {
+                _keys.append(previous->_keys.data() + previous->_offsets[previousIndex],
+                             previous->_offsets[previousIndex + 1] -
+                                 previous->_offsets[previousIndex]);
+                ++previousIndex;
+            }
+            else {
+                const KeyString max(it->first, _ordering);
+                _keys.append(max.getBuffer(), max.getSize());
+
+                // Skip the previous chunks this one replaced
+                while (previous && previousIndex < previous->_chunks.size() &&
+                       previous->_compareMax(previousIndex, max.getBuffer(), max.getSize()) <= 0) {
+                    ++previousIndex;
+                }
+            }
+            _chunks.push_back(it->second);
+
+            if (_hashed) {
+                const BSONElement maxElt = it->first.firstElement();
+                if (maxElt.type() == NumberLong) {
+                    _hashedMaxes.push_back(maxElt._numberLong());
+                }
+                else if (maxElt.type() != MaxKey || boost::next(it) != chunks.end()) {
+                    // Not the bounds of hashed values, so only use the KeyStrings
+                    _hashed = false;
+                    _hashedMaxes.clear();
+                }
+            }
+        }
+        _offsets.push_back(_keys.size());
+    }
+
+    ChunkPtr ChunkRoutingTable::upperBound(const BSONObj& shardKey) const {
+        size_t index;
+
+        const BSONElement keyElt = shardKey.firstElement();
+        if (_hashed && keyElt.type() == NumberLong) {
+            index = std::upper_bound(_hashedMaxes.begin(), _hashedMaxes.end(),
+                                     keyElt._numberLong()) - _hashedMaxes.begin();
+        }
+        else {
+            const KeyString key(shardKey, _ordering);
+
+            size_t low = 0;
+            size_t high = _chunks.size();
+            while (low < high) {
+                const size_t middle = low + (high - low) / 2;
+                if (_compareMax(middle, key.getBuffer(), key.getSize()) <= 0) {
+                    low = middle + 1;
+                }
+                else {
+                    high = middle;
+                }
+            }
+            index = low;
+        }
+
+        if (index == _chunks.size()) {
+            return ChunkPtr();
+        }
+        return _chunks[index];
+    }
+
+    int ChunkRoutingTable::_compareMax(size_t index, const char* key, size_t keySize) const {
+        const size_t maxSize = _offsets[index + 1] - _offsets[index];
+        const int cmp = memcmp(_keys.data() + _offsets[index], key, std::min(maxSize, keySize));
+        if (cmp) {
+            return cmp;
+        }
+
+        // A KeyString that is a prefix of another sorts before it
+        if (maxSize == keySize) {
+            return 0;
+        }
+        return maxSize < keySize ? -1 : 1;
+    }
+
     int ChunkManager::getCurrentDesiredChunkSize() const {
         // split faster in early chunks helps spread out an initial load better
         const int minChunkSize = 1 << 20;  // 1 MBytes
@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 
+#include "mongo/bson/ordering.h"
 #include "mongo/s/chunk.h"
 
 namespace mongo {
@@ -102,6 +103,49 @@ namespace mongo {
     };
 
 
+    /**
+     * An immutable copy of a ChunkMap laid out for finding the chunk that owns a shard key: the
+     * chunk maxes are KeyString-encoded back to back in one buffer, so a lookup is a binary search
+     * comparing bytes instead of a walk down the map comparing BSON. For hashed shard keys the
+     * maxes are also kept as plain 64-bit integers.
+     */
+    class ChunkRoutingTable {
+    public:
+        ChunkRoutingTable() : _ordering(Ordering::make(BSONObj())), _hashed(false) {}
+
+        /**
+         * Builds the table for 'chunks'. The chunks carried over from the table 'previous' of an
+         * older version of the collection, if given, take their key from it instead of encoding it
+         * again, so refreshing a large table after a migration or a split is mostly a copy.
+         */
+        void reloadAll(const ChunkMap& chunks,
+                       const ShardKeyPattern& pattern,
+                       const ChunkRoutingTable* previous = NULL);
+
+        /**
+         * Returns the first chunk whose max is greater than 'shardKey', like
+         * ChunkMap::upper_bound, or a null pointer if there is none.
+         */
+        ChunkPtr upperBound(const BSONObj& shardKey) const;
+
+    private:
+        // Compares the max of the chunk at 'index' with 'key', like memcmp
+        int _compareMax(size_t index, const char* key, size_t keySize) const;
+
+        Ordering _ordering;
+
+        // The KeyString of each chunk max, in order. The max of the chunk at index i is
+        // _keys[_offsets[i], _offsets[i + 1]).
+        std::string _keys;
+        std::vector<size_t> _offsets;
+        std::vector<ChunkPtr> _chunks;
+
+        // For a hashed shard key, the maxes of all chunks but a last one with a MaxKey max
+        bool _hashed;
+        std::vector<long long> _hashedMaxes;
+    };
+
+
     /* config.sharding
          { ns: 'alleyinsider.fs.chunks' ,
            key: { ts : 1 } ,
@@ -177,7 +221,11 @@ namespace mongo {
         //   Query { a : { $gte : 1, $lt : 2 },
         //            b : { $gte : 3, $lt : 4 } }
         //   => Bounds { a : [1, 2), b : [3, 4) }
-        static IndexBounds getIndexBoundsForQuery(const BSONObj& key, const CanonicalQuery* canonicalQuery);
+        // A hashed key hashes equalities with 'hashVersion'.
+        static IndexBounds getIndexBoundsForQuery(
+                const BSONObj& key,
+                const CanonicalQuery* canonicalQuery,
+                int hashVersion = BSONElementHasher::DEFAULT_HASH_VERSION);
 
         // Collapse query solution tree.
         //
@@ -227,6 +275,7 @@ namespace mongo {
 
         ChunkMap _chunkMap;
         ChunkRangeManager _chunkRanges;
+        ChunkRoutingTable _routingTable;
 
         std::set<ShardId> _shardIds;
 
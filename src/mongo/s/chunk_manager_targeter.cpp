@@ -32,6 +32,7 @@
 
 #include "mongo/s/chunk_manager_targeter.h"
 
+#include "mongo/s/chunk_load_tracker.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/config.h"
@@ -543,6 +544,11 @@ namespace {
             _stats.chunkSizeDelta[chunk->getMin()] += estDataSize;
         }
 
+        // Sampled for the load-aware balancer.
+        if (chunkLoadTracker.shouldSample()) {
+            chunkLoadTracker.noteWrite(*chunk);
+        }
+
         *endpoint = new ShardEndpoint(chunk->getShardId(),
                                       _manager->getVersion(chunk->getShardId()));
 
@@ -30,19 +30,26 @@
 
 #include "mongo/s/client/dbclient_multi_command.h"
 
+#include <set>
+#include <vector>
 
 #include "mongo/db/audit.h"
+#include "mongo/db/client_basic.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/s/client/shard_connection.h"
 #include "mongo/s/write_ops/batched_command_request.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/sock.h"
+#include "mongo/util/net/socket_poll.h"
 
 namespace mongo {
 
     using std::unique_ptr;
     using std::deque;
+    using std::set;
     using std::string;
+    using std::vector;
 
     DBClientMultiCommand::PendingCommand::PendingCommand( const ConnectionString& endpoint,
                                                           StringData dbName,
@@ -51,6 +58,7 @@ namespace mongo {
         dbName( dbName.toString() ),
         cmdObj( cmdObj ),
         conn( NULL ),
+        sent( false ),
         status( Status::OK() ) {
     }
 
@@ -58,6 +66,7 @@ namespace mongo {
                                            StringData dbName,
                                            const BSONSerializable& request ) {
         PendingCommand* command = new PendingCommand( endpoint, dbName, request.toBSON() );
+        command->traceSpan.start( ClientBasic::getCurrent(), "shardRequest" );
         _pendingCommands.push_back( command );
     }
 
@@ -86,19 +95,23 @@ namespace mongo {
     }
 
     // THROWS
-    static void sayAsCmd( DBClientBase* conn, StringData dbName, const BSONObj& cmdObj ) {
+    static void sayAsCmd( DBClientBase* conn,
+                          StringData dbName,
+                          const BSONObj& cmdObj,
+                          const rpc::TraceSpan& traceSpan ) {
         Message toSend;
         BSONObjBuilder usersBuilder;
         usersBuilder.appendElements(cmdObj);
         audit::appendImpersonatedUsers(&usersBuilder);
-        
+        BSONObj cmdToSend = traceSpan.addToQuery(usersBuilder.obj());
+
         // see query.h for the protocol we are using here.
         BufBuilder bufB;
         bufB.appendNum( 0 ); // command/query options
         bufB.appendStr( dbName.toString() + ".$cmd" ); // write command ns
         bufB.appendNum( 0 ); // ntoskip (0 for command)
         bufB.appendNum( 1 ); // ntoreturn (1 for command)
-        usersBuilder.obj().appendSelfToBufBuilder( bufB );
+        cmdToSend.appendSelfToBufBuilder( bufB );
         toSend.setData( dbQuery, bufB.buf(), bufB.len() );
 
         // Send our command
@@ -125,6 +138,11 @@ namespace mongo {
             it != _pendingCommands.end(); ++it ) {
 
             PendingCommand* command = *it;
+
+            // Sent by an earlier sendAll
+            if ( command->sent ) continue;
+            command->sent = true;
+
             dassert( NULL == command->conn );
 
             try {
@@ -142,7 +160,7 @@ namespace mongo {
                        !isBatchWriteCommand(command->cmdObj) ||
                        hasBatchWriteFeature(command->conn));
 
-                sayAsCmd( command->conn, command->dbName, command->cmdObj );
+                sayAsCmd( command->conn, command->dbName, command->cmdObj, command->traceSpan );
             }
             catch ( const DBException& ex ) {
                 command->status = ex.toStatus();
@@ -153,6 +171,8 @@ namespace mongo {
                     // invalidate other connections which might be bad.  But if the connection
                     // doesn't seem bad, don't send it back, because we don't want to reuse it.
                     if ( !command->conn->isFailed() ) {
+                        shardConnectionPool.decrementEgress( command->endpoint.toString(),
+                                                             command->conn );
                         delete command->conn;
                     }
                     else {
@@ -169,10 +189,56 @@ namespace mongo {
         return static_cast<int>( _pendingCommands.size() );
     }
 
+    DBClientMultiCommand::PendingQueue::iterator DBClientMultiCommand::_nextReceivable() {
+
+        if ( _pendingCommands.size() == 1 || !isPollSupported() ) {
+            return _pendingCommands.begin();
+        }
+
+        // Only the oldest command to each endpoint can be received
+        vector<PendingQueue::iterator> candidates;
+        vector<pollfd> pollInfos;
+        set<string> endpoints;
+        for ( PendingQueue::iterator it = _pendingCommands.begin();
+            it != _pendingCommands.end(); ++it ) {
+
+            PendingCommand* command = *it;
+            dassert( command->sent );
+            if ( !endpoints.insert( command->endpoint.toString() ).second ) continue;
+
+            // Failed sends are returned right away
+            if ( !command->status.isOK() ) return it;
+
+            // Only plain connections can be polled
+            DBClientConnection* conn = dynamic_cast<DBClientConnection*>( command->conn );
+            if ( NULL == conn || conn->port().psock->hasBufferedInput() ) return it;
+
+            pollfd pollInfo;
+            pollInfo.fd = conn->port().psock->rawFD();
+            pollInfo.events = POLLIN;
+            pollInfo.revents = 0;
+
+            candidates.push_back( it );
+            pollInfos.push_back( pollInfo );
+        }
+
+        // Past the timeout, receiving the oldest command times out as usual
+        int pollTimeoutMillis = _timeoutMillis > 0 ? _timeoutMillis : -1;
+        int numReady = socketPoll( &pollInfos[0], pollInfos.size(), pollTimeoutMillis );
+        if ( numReady > 0 ) {
+            for ( size_t i = 0; i < pollInfos.size(); ++i ) {
+                if ( pollInfos[i].revents != 0 ) return candidates[i];
+            }
+        }
+
+        return _pendingCommands.begin();
+    }
+
     Status DBClientMultiCommand::recvAny( ConnectionString* endpoint, BSONSerializable* response ) {
 
-        unique_ptr<PendingCommand> command( _pendingCommands.front() );
-        _pendingCommands.pop_front();
+        PendingQueue::iterator next = _nextReceivable();
+        unique_ptr<PendingCommand> command( *next );
+        _pendingCommands.erase( next );
 
         *endpoint = command->endpoint;
         if ( !command->status.isOK() ) return command->status;
@@ -186,6 +252,7 @@ namespace mongo {
             BSONObj result;
 
             recvAsCmd( command->conn, &toRecv, &result );
+            command->traceSpan.finish( BSON( "host" << command->endpoint.toString() ) );
 
             shardConnectionPool.release( command->endpoint.toString(), command->conn );
             command->conn = NULL;
@@ -201,6 +268,8 @@ namespace mongo {
             // invalidate other connections which might be bad.  But if the connection doesn't seem
             // bad, don't send it back, because we don't want to reuse it.
             if ( !command->conn->isFailed() ) {
+                shardConnectionPool.decrementEgress( command->endpoint.toString(),
+                                                     command->conn );
                 delete command->conn;
             }
             else {
@@ -31,6 +31,7 @@
 #include <deque>
 
 #include "mongo/bson/bsonobj.h"
+#include "mongo/rpc/metadata/trace_metadata.h"
 #include "mongo/s/client/multi_command_dispatch.h"
 
 namespace mongo {
@@ -77,11 +78,25 @@ namespace mongo {
             // Where to send it
             DBClientBase* conn;
 
+            // Whether sendAll has sent it
+            bool sent;
+
             // If anything goes wrong
             Status status;
+
+            // Times the command from when it is added until its response is received
+            rpc::TraceSpan traceSpan;
         };
 
         typedef std::deque<PendingCommand*> PendingQueue;
+
+        /**
+         * Returns the sent command whose response can be received first, waiting for one to be
+         * readable if needed. Commands to the same endpoint are received in the order they were
+         * added.
+         */
+        PendingQueue::iterator _nextReceivable();
+
         PendingQueue _pendingCommands;
         int _timeoutMillis;
     };
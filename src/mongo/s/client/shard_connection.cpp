@@ -178,6 +178,7 @@ namespace {
                             versionManager.resetShardVersionCB(ss->avail);
                         }
 
+                        shardConnectionPool.decrementEgress(addr, ss->avail);
                         delete ss->avail;
                     }
                     else {
@@ -243,6 +244,7 @@ namespace {
                 }
 
                 if (!isConnGood) {
+                    shardConnectionPool.decrementEgress(addr, s->avail);
                     delete s->avail;
                     s->avail = NULL;
                 }
@@ -357,6 +359,7 @@ namespace {
         void clearPool() {
             for(HostMap::iterator iter = _hosts.begin(); iter != _hosts.end(); ++iter) {
                 if (iter->second->avail != NULL) {
+                    shardConnectionPool.decrementEgress(iter->first, iter->second->avail);
                     delete iter->second->avail;
                 }
                 delete iter->second;
@@ -490,6 +493,7 @@ namespace {
                 ClientConnections::threadInstance()->done(_cs.toString(), _conn);
             }
             else {
+                shardConnectionPool.decrementEgress(_cs.toString(), _conn);
                 delete _conn;
             }
 
@@ -66,7 +66,10 @@ namespace mongo {
          * Constructs the BSON specification document for the given namespace, index key
          * and options.
          */
-        BSONObj createIndexDoc(const string& ns, const BSONObj& keys, bool unique) {
+        BSONObj createIndexDoc(const string& ns,
+                               const BSONObj& keys,
+                               bool unique,
+                               const BSONObj& extraOptions) {
             BSONObjBuilder indexDoc;
             indexDoc.append("ns", ns);
             indexDoc.append("key", keys);
@@ -99,6 +102,8 @@ namespace mongo {
                 indexDoc.appendBool("unique", unique);
             }
 
+            indexDoc.appendElements(extraOptions);
+
             return indexDoc.obj();
         }
 
@@ -158,12 +163,13 @@ namespace mongo {
     Status clusterCreateIndex( const string& ns,
                                BSONObj keys,
                                bool unique,
-                               BatchedCommandResponse* response ) {
+                               BatchedCommandResponse* response,
+                               const BSONObj& extraOptions ) {
 
         const NamespaceString nss(ns);
         const std::string dbName = nss.db().toString();
 
-        BSONObj indexDoc = createIndexDoc(ns, keys, unique);
+        BSONObj indexDoc = createIndexDoc(ns, keys, unique, extraOptions);
 
         // Go through the shard insert path
         std::unique_ptr<BatchedInsertRequest> insert(new BatchedInsertRequest());
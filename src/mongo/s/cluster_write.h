@@ -74,11 +74,13 @@ namespace mongo {
     /**
      * Used only for writes to the config server, config and admin databases.
      *
-     * Note: response can be NULL if you don't care about the write statistics.
+     * Note: response can be NULL if you don't care about the write statistics. Any fields of
+     * extraOptions, e.g. the hashVersion of a hashed index, are added to the index spec.
      */
     Status clusterCreateIndex( const std::string& ns,
                                BSONObj keys,
                                bool unique,
-                               BatchedCommandResponse* response );
+                               BatchedCommandResponse* response,
+                               const BSONObj& extraOptions = BSONObj() );
 
 } // namespace mongo
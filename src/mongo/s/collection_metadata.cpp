@@ -33,6 +33,7 @@
 #include "mongo/s/collection_metadata.h"
 
 #include "mongo/bson/util/builder.h"
+#include "mongo/db/hasher.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -46,7 +47,8 @@ namespace mongo {
 
     using mongoutils::str::stream;
 
-    CollectionMetadata::CollectionMetadata() { }
+    CollectionMetadata::CollectionMetadata()
+        : _hashVersion(BSONElementHasher::DEFAULT_HASH_VERSION) { }
 
     CollectionMetadata::~CollectionMetadata() { }
 
@@ -107,6 +109,7 @@ namespace mongo {
         unique_ptr<CollectionMetadata> metadata( new CollectionMetadata );
         metadata->_keyPattern = this->_keyPattern;
         metadata->_keyPattern.getOwned();
+        metadata->_hashVersion = this->_hashVersion;
         metadata->fillKeyPatternFields();
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
@@ -160,6 +163,7 @@ namespace mongo {
         unique_ptr<CollectionMetadata> metadata( new CollectionMetadata );
         metadata->_keyPattern = this->_keyPattern;
         metadata->_keyPattern.getOwned();
+        metadata->_hashVersion = this->_hashVersion;
         metadata->fillKeyPatternFields();
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
@@ -204,6 +208,7 @@ namespace mongo {
         unique_ptr<CollectionMetadata> metadata( new CollectionMetadata );
         metadata->_keyPattern = this->_keyPattern;
         metadata->_keyPattern.getOwned();
+        metadata->_hashVersion = this->_hashVersion;
         metadata->fillKeyPatternFields();
         metadata->_pendingMap = this->_pendingMap;
         metadata->_pendingMap.erase( pending.getMin() );
@@ -240,6 +245,7 @@ namespace mongo {
         unique_ptr<CollectionMetadata> metadata( new CollectionMetadata );
         metadata->_keyPattern = this->_keyPattern;
         metadata->_keyPattern.getOwned();
+        metadata->_hashVersion = this->_hashVersion;
         metadata->fillKeyPatternFields();
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
@@ -341,6 +347,7 @@ namespace mongo {
         unique_ptr<CollectionMetadata> metadata(new CollectionMetadata);
         metadata->_keyPattern = this->_keyPattern;
         metadata->_keyPattern.getOwned();
+        metadata->_hashVersion = this->_hashVersion;
         metadata->fillKeyPatternFields();
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
@@ -430,6 +437,7 @@ namespace mongo {
         unique_ptr<CollectionMetadata> metadata( new CollectionMetadata );
         metadata->_keyPattern = this->_keyPattern;
         metadata->_keyPattern.getOwned();
+        metadata->_hashVersion = this->_hashVersion;
         metadata->fillKeyPatternFields();
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
@@ -558,6 +566,9 @@ namespace mongo {
         _collVersion.addToBSON( bb, "collVersion" );
         _shardVersion.addToBSON( bb, "shardVersion" );
         bb.append( "keyPattern", _keyPattern );
+        if ( _hashVersion != BSONElementHasher::DEFAULT_HASH_VERSION ) {
+            bb.append( "hashVersion", _hashVersion );
+        }
 
         BSONArrayBuilder chunksBB( bb.subarrayStart( "chunks" ) );
         toBSONChunks( chunksBB );
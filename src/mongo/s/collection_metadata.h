@@ -194,6 +194,11 @@ namespace mongo {
             return _keyPattern;
         }
 
+        // Hash function version of a hashed shard key, see BSONElementHasher.
+        int getHashVersion() const {
+            return _hashVersion;
+        }
+
         const std::vector<FieldRef*>& getKeyPatternFields() const {
             return _keyFields.vector();
         }
@@ -280,6 +285,9 @@ namespace mongo {
         // key pattern for chunks under this range
         BSONObj _keyPattern;
 
+        // hash version of a hashed _keyPattern
+        int _hashVersion;
+
         // A vector owning the FieldRefs parsed from the shard-key pattern of field names.
         OwnedPointerVector<FieldRef> _keyFields;
 
@@ -0,0 +1,136 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/commands.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/s/catalog/catalog_cache.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/s/chunk_version.h"
+#include "mongo/s/config.h"
+#include "mongo/s/grid.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+    using std::shared_ptr;
+    using std::string;
+
+namespace {
+
+    /**
+     * Sent by a shard after it committed a migration, with the new version of the collection, so
+     * that this router refreshes its routing table now rather than on the next stale config error.
+     * Does nothing if the routing table is already at that version or the collection isn't loaded.
+     */
+    class NoteCollectionVersionCmd : public Command {
+    public:
+        NoteCollectionVersionCmd() : Command("_noteCollectionVersion", false) { }
+
+        virtual bool slaveOk() const {
+            return true;
+        }
+
+        virtual bool adminOnly() const {
+            return true;
+        }
+
+        virtual bool isWriteCommandForConfigServer() const {
+            return false;
+        }
+
+        virtual void help(std::stringstream& help) const {
+            help << "internal";
+        }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::internal);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const std::string& dbname,
+                         BSONObj& cmdObj,
+                         int options,
+                         std::string& errmsg,
+                         BSONObjBuilder& result) {
+
+            const NamespaceString nss(cmdObj.firstElement().valuestrsafe());
+            if (!nss.isValid()) {
+                return appendCommandStatus(result,
+                                           Status(ErrorCodes::InvalidNamespace,
+                                                  str::stream() << "invalid namespace "
+                                                                << cmdObj.firstElement()));
+            }
+
+            bool canParse;
+            const ChunkVersion version = ChunkVersion::fromBSON(cmdObj, "version", &canParse);
+            if (!canParse || !version.isSet()) {
+                return appendCommandStatus(result,
+                                           Status(ErrorCodes::BadValue,
+                                                  str::stream() << "no valid version in "
+                                                                << cmdObj));
+            }
+
+            bool refreshed = false;
+
+            auto status = grid.catalogCache()->getDatabase(nss.db().toString());
+            if (status.isOK()) {
+                shared_ptr<DBConfig> config = status.getValue();
+
+                ChunkManagerPtr manager;
+                if (config->isSharded(nss.ns())) {
+                    manager = config->getChunkManagerIfExists(nss.ns());
+                }
+
+                // A version of another epoch may be older or newer, so only skip the same epoch
+                if (manager && !(version.hasEqualEpoch(manager->getVersion()) &&
+                                 version <= manager->getVersion())) {
+                    LOG(1) << "refreshing routing table of " << nss.ns() << " at version "
+                           << manager->getVersion() << " after notification of version "
+                           << version;
+
+                    refreshed = config->getChunkManagerIfExists(nss.ns(), true) != manager;
+                }
+            }
+
+            result.appendBool("refreshed", refreshed);
+            return true;
+        }
+
+    } noteCollectionVersionCmd;
+
+} // namespace
+} // namespace mongo
@@ -249,6 +249,11 @@ namespace {
             // 2. Check for a useful index
             bool hasUsefulIndexForKey = false;
 
+            // An existing hashed index keeps the hash function it was built with; otherwise the
+            // shard key and the index created below use the latest one.
+            int hashVersion = BSONElementHasher::LATEST_HASH_VERSION;
+            bool hasHashedIndexForKey = false;
+
             for (list<BSONObj>::iterator it = indexes.begin(); it != indexes.end(); ++it) {
                 BSONObj idx = *it;
                 BSONObj currentKey = idx["key"].embeddedObject();
@@ -273,6 +278,20 @@ namespace {
                         return false;
                     }
 
+                    if (isHashedShardKey) {
+                        const int indexHashVersion = idx["hashVersion"].numberInt();
+                        if (hasHashedIndexForKey && indexHashVersion != hashVersion) {
+                            errmsg = str::stream() << "can't shard collection " << ns
+                                                   << " with hashed shard key " << proposedKey
+                                                   << " because there are hashed indexes with"
+                                                   << " different hashVersions on it";
+                            conn.done();
+                            return false;
+                        }
+                        hasHashedIndexForKey = true;
+                        hashVersion = indexHashVersion;
+                    }
+
                     hasUsefulIndexForKey = true;
                 }
             }
@@ -336,7 +355,15 @@ namespace {
                 // 5. If no useful index exists, and collection empty, create one on proposedKey.
                 //    Only need to call ensureIndex on primary shard, since indexes get copied to
                 //    receiving shard whenever a migrate occurs.
-                Status status = clusterCreateIndex(ns, proposedKey, careAboutUnique, NULL);
+                BSONObj indexOptions;
+                if (isHashedShardKey) {
+                    indexOptions = BSON("hashVersion" << hashVersion);
+                }
+                Status status = clusterCreateIndex(ns,
+                                                   proposedKey,
+                                                   careAboutUnique,
+                                                   NULL,
+                                                   indexOptions);
                 if (!status.isOK()) {
                     errmsg = str::stream() << "ensureIndex failed to create index on "
                         << "primary shard: " << status.reason();
@@ -413,8 +440,11 @@ namespace {
                                       proposedKey,
                                       careAboutUnique);
 
+            ShardKeyPattern shardKey(proposedKey,
+                                     isHashedShardKey ? hashVersion
+                                                      : BSONElementHasher::DEFAULT_HASH_VERSION);
             Status status = grid.catalogManager()->shardCollection(ns,
-                                                                   proposedShardKey,
+                                                                   shardKey,
                                                                    careAboutUnique,
                                                                    &initSplits);
             if (!status.isOK()) {
@@ -70,6 +70,23 @@ namespace mongo {
         _dirty = false;
     }
 
+    CollectionInfo::CollectionInfo(const CollectionType& coll, const ChunkManager* previous) {
+        invariant(previous);
+        invariant(previous->getVersion().epoch() == coll.getEpoch());
+        _dropped = coll.getDropped();
+
+        shard(new ChunkManager(previous->getns(),
+                               previous->getShardKeyPattern(),
+                               previous->isUnique()),
+              previous);
+        _dirty = false;
+    }
+
+    CollectionInfo::CollectionInfo(ChunkManagerPtr manager) {
+        useChunkManager(manager);
+        _dirty = false;
+    }
+
     CollectionInfo::~CollectionInfo() {
 
     }
@@ -81,9 +98,9 @@ namespace mongo {
         _cm.reset(cm);
     }
     
-    void CollectionInfo::shard(ChunkManager* manager) {
+    void CollectionInfo::shard(ChunkManager* manager, const ChunkManager* previous) {
         // Do this *first* so we're invisible to everyone else
-        manager->loadExistingRanges(nullptr);
+        manager->loadExistingRanges(previous);
 
         //
         // Collections with no chunks are unsharded, no matter what the collections entry says
@@ -127,6 +144,10 @@ namespace mongo {
             coll.setUpdatedAt(Date_t::fromMillisSinceEpoch(_cm->getVersion().toLong()));
             coll.setKeyPattern(_cm->getShardKeyPattern().toBSON());
             coll.setUnique(_cm->isUnique());
+            if (_cm->getShardKeyPattern().getHashVersion() !=
+                    BSONElementHasher::DEFAULT_HASH_VERSION) {
+                coll.setHashVersion(_cm->getShardKeyPattern().getHashVersion());
+            }
         }
         else {
             invariant(_dropped);
@@ -281,14 +302,20 @@ namespace mongo {
         ChunkVersion oldVersion;
         ChunkManagerPtr oldManager;
 
+        bool earlyReload;
         {
             boost::lock_guard<boost::mutex> lk(_lock);
+            earlyReload = !_collections[ns].isSharded() && (shouldReload || forceReload);
+        }
 
-            bool earlyReload = !_collections[ns].isSharded() && (shouldReload || forceReload);
-            if (earlyReload) {
-                // This is to catch cases where there this is a new sharded collection
-                _reload();
-            }
+        if (earlyReload) {
+            // This is to catch cases where there this is a new sharded collection. The reload
+            // doesn't hold _lock while it reads from the config servers.
+            load();
+        }
+
+        {
+            boost::lock_guard<boost::mutex> lk(_lock);
 
             CollectionInfo& ci = _collections[ns];
             uassert(10181, str::stream() << "not sharded:" << ns, ci.isSharded());
@@ -430,10 +457,76 @@ namespace mongo {
     }
 
     bool DBConfig::load() {
-        boost::lock_guard<boost::mutex> lk( _lock );
+        boost::lock_guard<boost::mutex> lk(_refreshLock);
+        return _load();
+    }
+
+    bool DBConfig::refreshIfNotInProgress() {
+        boost::unique_lock<boost::mutex> lk(_refreshLock, boost::try_to_lock);
+        if (!lk.owns_lock()) {
+            // Whoever holds the lock is loading the same metadata
+            return true;
+        }
+
         return _load();
     }
 
+    Date_t DBConfig::getLoadedAt() {
+        boost::lock_guard<boost::mutex> lk(_lock);
+        return _loadedAt;
+    }
+
+namespace {
+
+    /**
+     * Returns the namespaces out of 'collections' whose chunks have changed since the chunk
+     * managers in 'managers' were loaded, with a single query to the config servers for the
+     * whole database. Collections without a chunk manager of the same epoch are not included,
+     * since they have to be loaded from scratch anyway.
+     */
+    set<string> findChangedCollections(const vector<CollectionType>& collections,
+                                       const std::map<string, ChunkManagerPtr>& managers) {
+        BSONArrayBuilder changedB;
+
+        for (const auto& coll : collections) {
+            if (coll.getDropped()) {
+                continue;
+            }
+
+            auto it = managers.find(coll.getNs());
+            if (it == managers.end() || it->second->getVersion().epoch() != coll.getEpoch()) {
+                continue;
+            }
+
+            // Any split, merge or migration increments the version of the collection
+            BSONObjBuilder collB(changedB.subobjStart());
+            collB.append(ChunkType::ns(), coll.getNs());
+            {
+                BSONObjBuilder tsB(collB.subobjStart(ChunkType::DEPRECATED_lastmod()));
+                tsB.appendTimestamp("$gt", it->second->getVersion().toLong());
+                tsB.done();
+            }
+            collB.done();
+        }
+
+        set<string> changed;
+        if (changedB.arrSize() == 0) {
+            return changed;
+        }
+
+        vector<ChunkType> chunks;
+        uassertStatusOK(grid.catalogManager()->getChunks(Query(BSON("$or" << changedB.arr())),
+                                                         0,
+                                                         &chunks));
+        for (const auto& chunk : chunks) {
+            changed.insert(chunk.getNS());
+        }
+
+        return changed;
+    }
+
+} // namespace
+
     bool DBConfig::_load() {
         StatusWith<DatabaseType> status = grid.catalogManager()->getDatabase(_name);
         if (status == ErrorCodes::DatabaseNotFound) {
@@ -445,29 +538,80 @@ namespace mongo {
 
         DatabaseType dbt = status.getValue();
         invariant(_name == dbt.getName());
-        _primaryId = dbt.getPrimary();
-        _shardingEnabled = dbt.getSharded();
 
         // Load all collections
         vector<CollectionType> collections;
         uassertStatusOK(grid.catalogManager()->getCollections(&_name, &collections));
 
-        int numCollsErased = 0;
-        int numCollsSharded = 0;
+        // The chunk managers in use, so that unchanged collections can keep theirs and changed
+        // ones only need to load the chunks which are newer
+        std::map<string, ChunkManagerPtr> previousManagers;
+        {
+            boost::lock_guard<boost::mutex> lk(_lock);
+            for (const auto& entry : _collections) {
+                if (entry.second.isSharded()) {
+                    previousManagers[entry.first] = entry.second.getCM();
+                }
+            }
+        }
+
+        const set<string> changed = findChangedCollections(collections, previousManagers);
+
+        CollectionInfoMap loaded;
+        vector<string> dropped;
+        int numCollsReused = 0;
 
         for (const auto& coll : collections) {
             if (coll.getDropped()) {
-                _collections.erase(coll.getNs());
-                numCollsErased++;
+                dropped.push_back(coll.getNs());
+                continue;
+            }
+
+            auto it = previousManagers.find(coll.getNs());
+            if (it == previousManagers.end() ||
+                    it->second->getVersion().epoch() != coll.getEpoch()) {
+                loaded[coll.getNs()] = CollectionInfo(coll);
+            }
+            else if (!changed.count(coll.getNs())) {
+                loaded[coll.getNs()] = CollectionInfo(it->second);
+                numCollsReused++;
             }
             else {
-                _collections[coll.getNs()] = CollectionInfo(coll);
-                numCollsSharded++;
+                loaded[coll.getNs()] = CollectionInfo(coll, it->second.get());
             }
         }
 
-        LOG(2) << "found " << numCollsSharded << " collections left and "
-                           << numCollsErased << " collections dropped for database " << _name;
+        boost::lock_guard<boost::mutex> lk(_lock);
+
+        _primaryId = dbt.getPrimary();
+        _shardingEnabled = dbt.getSharded();
+
+        for (const auto& ns : dropped) {
+            _collections.erase(ns);
+        }
+
+        for (auto& entry : loaded) {
+            CollectionInfo& current = _collections[entry.first];
+
+            // A concurrent getChunkManager() may have installed a newer chunk manager while the
+            // config servers were being read
+            if (current.isSharded() && entry.second.isSharded()) {
+                const ChunkVersion currentVersion = current.getCM()->getVersion();
+                const ChunkVersion loadedVersion = entry.second.getCM()->getVersion();
+                if (currentVersion.hasEqualEpoch(loadedVersion) &&
+                        loadedVersion < currentVersion) {
+                    continue;
+                }
+            }
+
+            current = entry.second;
+        }
+
+        _loadedAt = Date_t::now();
+
+        LOG(2) << "found " << loaded.size() << " collections left (" << numCollsReused
+               << " unchanged) and " << dropped.size() << " collections dropped for database "
+               << _name;
 
         return true;
     }
@@ -497,12 +641,7 @@ namespace mongo {
     }
 
     bool DBConfig::reload() {
-        bool successful = false;
-
-        {
-            boost::lock_guard<boost::mutex> lk( _lock );
-            successful = _reload();
-        }
+        bool successful = load();
 
         // If we aren't successful loading the database entry, we don't want to keep the stale
         // object around which has invalid data.
@@ -513,11 +652,6 @@ namespace mongo {
         return successful;
     }
 
-    bool DBConfig::_reload() {
-        // TODO: i don't think is 100% correct
-        return _load();
-    }
-
     bool DBConfig::dropDatabase(string& errmsg) {
         /**
          * 1) update config server
@@ -33,6 +33,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -50,6 +51,18 @@ namespace mongo {
         }
 
         CollectionInfo(const CollectionType& in);
+
+        /**
+         * Loads the chunks of 'in' incrementally, starting from the chunks of 'previous', which
+         * must be a chunk manager of the same epoch.
+         */
+        CollectionInfo(const CollectionType& in, const ChunkManager* previous);
+
+        /**
+         * Reuses a chunk manager which is known to still be current.
+         */
+        explicit CollectionInfo(std::shared_ptr<ChunkManager> manager);
+
         ~CollectionInfo();
 
         bool isSharded() const {
@@ -62,7 +75,7 @@ namespace mongo {
 
         void resetCM(ChunkManager * cm);
 
-        void shard(ChunkManager* cm);
+        void shard(ChunkManager* cm, const ChunkManager* previous = nullptr);
         void unshard();
 
         bool isDirty() const { return _dirty; }
@@ -133,6 +146,19 @@ namespace mongo {
         bool load();
         bool reload();
 
+        /**
+         * Reloads the database and collection metadata unless another thread is already doing
+         * so. The metadata in use stays available to other operations during the reload.
+         *
+         * @return false if the database no longer exists.
+         */
+        bool refreshIfNotInProgress();
+
+        /**
+         * Time at which the metadata was last loaded from the config servers.
+         */
+        Date_t getLoadedAt();
+
         bool dropDatabase( std::string& errmsg );
 
         void getAllShardIds(std::set<ShardId>* shardIds);
@@ -149,8 +175,12 @@ namespace mongo {
 
         bool _dropShardedCollections(int& num, std::set<ShardId>& shardIds, std::string& errmsg);
 
+        /**
+         * Reads the database and collection entries from the config servers without holding
+         * _lock, then installs them. Collections whose chunks haven't changed keep their chunk
+         * manager and the others are reloaded incrementally. Must be called with _refreshLock.
+         */
         bool _load();
-        bool _reload();
         void _save( bool db = true, bool coll = true );
 
 
@@ -163,6 +193,12 @@ namespace mongo {
         // Whether sharding has been enabled for this database
         bool _shardingEnabled;
 
+        // When the metadata was last loaded, protected by _lock
+        Date_t _loadedAt;
+
+        // Ensures that only one thread at a time reloads the metadata of the database
+        mongo::mutex _refreshLock;
+
         // Set of collections and lock to protect access
         mongo::mutex _lock;
         CollectionInfoMap _collections;
@@ -102,10 +102,10 @@ namespace mongo {
         _id = 0;
 
         if ( q.queryOptions & QueryOption_NoCursorTimeout ) {
-            _lastAccessMillis = 0;
+            _lastAccessMillis.store(0);
         }
         else
-            _lastAccessMillis = Listener::getElapsedTimeMillis();
+            _lastAccessMillis.store(Listener::getElapsedTimeMillis());
 
         cursorStatsMultiTarget.increment();
     }
@@ -130,14 +130,15 @@ namespace mongo {
     }
 
     void ShardedClientCursor::accessed() {
-        if ( _lastAccessMillis > 0 )
-            _lastAccessMillis = Listener::getElapsedTimeMillis();
+        if ( _lastAccessMillis.load() > 0 )
+            _lastAccessMillis.store(Listener::getElapsedTimeMillis());
     }
 
     long long ShardedClientCursor::idleTime( long long now ) {
-        if ( _lastAccessMillis == 0 )
+        long long lastAccessMillis = _lastAccessMillis.load();
+        if ( lastAccessMillis == 0 )
             return 0;
-        return now - _lastAccessMillis;
+        return now - lastAccessMillis;
     }
 
     bool ShardedClientCursor::sendNextBatch(int ntoreturn, BufBuilder& buffer, int& docCount) {
@@ -238,33 +239,49 @@ namespace mongo {
     CursorCache::~CursorCache() {
         // TODO: delete old cursors?
         bool print = shouldLog(logger::LogSeverity::Debug(1));
-        if ( _cursors.size() || _refs.size() )
+        size_t numCursors = 0;
+        size_t numRefs = 0;
+        for (const Partition& partition : _partitions) {
+            numCursors += partition.cursors.size();
+            numRefs += partition.refs.size();
+        }
+        if ( numCursors || numRefs )
             print = true;
-        verify(_refs.size() == _refsNS.size());
-        
+
         if ( print ) 
             log() << " CursorCache at shutdown - "
-                  << " sharded: " << _cursors.size()
-                  << " passthrough: " << _refs.size()
+                  << " sharded: " << numCursors
+                  << " passthrough: " << numRefs
                   << endl;
     }
 
+    CursorCache::Partition& CursorCache::_partitionFor(long long id) {
+        // the low bits of the ids mongos and mongod generate are random
+        return _partitions[static_cast<unsigned long long>(id) & (kNumPartitions - 1)];
+    }
+
+    const CursorCache::Partition& CursorCache::_partitionFor(long long id) const {
+        return _partitions[static_cast<unsigned long long>(id) & (kNumPartitions - 1)];
+    }
+
     ShardedClientCursorPtr CursorCache::get( long long id ) const {
         LOG(_myLogLevel) << "CursorCache::get id: " << id << endl;
-        boost::lock_guard<boost::mutex> lk( _mutex );
-        MapSharded::const_iterator i = _cursors.find( id );
-        if ( i == _cursors.end() ) {
+        const Partition& partition = _partitionFor(id);
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        auto i = partition.cursors.find( id );
+        if ( i == partition.cursors.end() ) {
             return ShardedClientCursorPtr();
         }
-        i->second->accessed();
-        return i->second;
+        i->second.cursor->accessed();
+        return i->second.cursor;
     }
 
     int CursorCache::getMaxTimeMS( long long id ) const {
         verify( id );
-        boost::lock_guard<boost::mutex> lk( _mutex );
-        MapShardedInt::const_iterator i = _cursorsMaxTimeMS.find( id );
-        return ( i != _cursorsMaxTimeMS.end() ) ? i->second : 0;
+        const Partition& partition = _partitionFor(id);
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        auto i = partition.cursors.find( id );
+        return ( i != partition.cursors.end() ) ? i->second.maxTimeMS : 0;
     }
 
     void CursorCache::store( ShardedClientCursorPtr cursor, int maxTimeMS ) {
@@ -276,10 +293,15 @@ namespace mongo {
         verify( maxTimeMS == kMaxTimeCursorTimeLimitExpired
                 || maxTimeMS == kMaxTimeCursorNoTimeLimit
                 || maxTimeMS > 0 );
-        boost::lock_guard<boost::mutex> lk( _mutex );
-        _cursorsMaxTimeMS[cursor->getId()] = maxTimeMS;
-        _cursors[cursor->getId()] = cursor;
-        _shardedTotal++;
+        const long long id = cursor->getId();
+        Partition& partition = _partitionFor(id);
+        {
+            stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+            ShardedCursorEntry& entry = partition.cursors[id];
+            entry.cursor = std::move(cursor);
+            entry.maxTimeMS = maxTimeMS;
+        }
+        _shardedTotal.fetchAndAdd(1);
     }
 
     void CursorCache::updateMaxTimeMS( long long id, int maxTimeMS ) {
@@ -287,66 +309,82 @@ namespace mongo {
         verify( maxTimeMS == kMaxTimeCursorTimeLimitExpired
                 || maxTimeMS == kMaxTimeCursorNoTimeLimit
                 || maxTimeMS > 0 );
-        boost::lock_guard<boost::mutex> lk( _mutex );
-        _cursorsMaxTimeMS[id] = maxTimeMS;
+        Partition& partition = _partitionFor(id);
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        auto i = partition.cursors.find( id );
+        if ( i != partition.cursors.end() ) {
+            i->second.maxTimeMS = maxTimeMS;
+        }
     }
 
     void CursorCache::remove( long long id ) {
         verify( id );
-        boost::lock_guard<boost::mutex> lk( _mutex );
-        _cursorsMaxTimeMS.erase( id );
-        _cursors.erase( id );
+        ShardedClientCursorPtr removed;
+        Partition& partition = _partitionFor(id);
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        auto i = partition.cursors.find( id );
+        if ( i != partition.cursors.end() ) {
+            // the last reference may destroy the cursor, which is done after unlocking
+            removed = std::move(i->second.cursor);
+            partition.cursors.erase( i );
+        }
     }
     
     void CursorCache::removeRef( long long id ) {
         verify( id );
-        boost::lock_guard<boost::mutex> lk( _mutex );
-        _refs.erase( id );
-        _refsNS.erase( id );
+        Partition& partition = _partitionFor(id);
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        partition.refs.erase( id );
         cursorStatsSingleTarget.decrement();
     }
 
     void CursorCache::storeRef(const std::string& server, long long id, const std::string& ns) {
         LOG(_myLogLevel) << "CursorCache::storeRef server: " << server << " id: " << id << endl;
         verify( id );
-        boost::lock_guard<boost::mutex> lk( _mutex );
-        _refs[id] = server;
-        _refsNS[id] = ns;
+        Partition& partition = _partitionFor(id);
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        RefEntry& entry = partition.refs[id];
+        entry.server = server;
+        entry.ns = ns;
         cursorStatsSingleTarget.increment();
     }
 
     string CursorCache::getRef( long long id ) const {
         verify( id );
-        boost::lock_guard<boost::mutex> lk( _mutex );
-        MapNormal::const_iterator i = _refs.find( id );
+        const Partition& partition = _partitionFor(id);
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        auto i = partition.refs.find( id );
 
-        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == _refs.end() ? " NONE " : i->second ) << endl;
+        LOG(_myLogLevel) << "CursorCache::getRef id: " << id
+                << " out: " << ( i == partition.refs.end() ? " NONE " : i->second.server ) << endl;
 
-        if ( i == _refs.end() )
+        if ( i == partition.refs.end() )
             return "";
-        return i->second;
+        return i->second.server;
     }
 
     std::string CursorCache::getRefNS(long long id) const {
         verify(id);
-        boost::lock_guard<boost::mutex> lk(_mutex);
-        MapNormal::const_iterator i = _refsNS.find(id);
+        const Partition& partition = _partitionFor(id);
+        stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+        auto i = partition.refs.find(id);
 
         LOG(_myLogLevel) << "CursorCache::getRefNs id: " << id
-                << " out: " << ( i == _refsNS.end() ? " NONE " : i->second ) << std::endl;
+                << " out: " << ( i == partition.refs.end() ? " NONE " : i->second.ns ) << std::endl;
 
-        if ( i == _refsNS.end() )
+        if ( i == partition.refs.end() )
             return "";
-        return i->second;
+        return i->second.ns;
     }
 
 
     long long CursorCache::genId() {
         while ( true ) {
-            boost::lock_guard<boost::mutex> lk( _mutex );
-
             long long x = Listener::getElapsedTimeMillis() << 32;
-            x |= _random.nextInt32();
+            {
+                stdx::lock_guard<stdx::mutex> lk(_randomMutex);
+                x |= _random.nextInt32();
+            }
 
             if ( x == 0 )
                 continue;
@@ -354,12 +392,13 @@ namespace mongo {
             if ( x < 0 )
                 x *= -1;
 
-            MapSharded::iterator i = _cursors.find( x );
-            if ( i != _cursors.end() )
+            const Partition& partition = _partitionFor(x);
+            stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+
+            if ( partition.cursors.count( x ) )
                 continue;
 
-            MapNormal::iterator j = _refs.find( x );
-            if ( j != _refs.end() )
+            if ( partition.refs.count( x ) )
                 continue;
 
             return x;
@@ -395,45 +434,45 @@ namespace mongo {
             }
 
             string server;
+            ShardedClientCursorPtr killed;
             {
-                boost::lock_guard<boost::mutex> lk( _mutex );
+                Partition& partition = _partitionFor(id);
+                stdx::lock_guard<stdx::mutex> lk(partition.mutex);
 
-                MapSharded::iterator i = _cursors.find( id );
-                if ( i != _cursors.end() ) {
-                    Status authorizationStatus = authSession->checkAuthForKillCursors(
-                            NamespaceString(i->second->getNS()), id);
+                auto i = partition.cursors.find( id );
+                if ( i != partition.cursors.end() ) {
+                    const NamespaceString nss(i->second.cursor->getNS());
+                    Status authorizationStatus = authSession->checkAuthForKillCursors(nss, id);
                     audit::logKillCursorsAuthzCheck(
                             client,
-                            NamespaceString(i->second->getNS()),
+                            nss,
                             id,
                             authorizationStatus.isOK() ? ErrorCodes::OK : ErrorCodes::Unauthorized);
                     if (authorizationStatus.isOK()) {
-                        _cursorsMaxTimeMS.erase( i->second->getId() );
-                        _cursors.erase( i );
+                        // destroyed once the partition is unlocked
+                        killed = std::move(i->second.cursor);
+                        partition.cursors.erase( i );
                     }
                     continue;
                 }
 
-                MapNormal::iterator refsIt = _refs.find(id);
-                MapNormal::iterator refsNSIt = _refsNS.find(id);
-                if (refsIt == _refs.end()) {
+                auto refsIt = partition.refs.find(id);
+                if (refsIt == partition.refs.end()) {
                     warning() << "can't find cursor: " << id << endl;
                     continue;
                 }
-                verify(refsNSIt != _refsNS.end());
                 Status authorizationStatus = authSession->checkAuthForKillCursors(
-                        NamespaceString(refsNSIt->second), id);
+                        NamespaceString(refsIt->second.ns), id);
                 audit::logKillCursorsAuthzCheck(
                         client,
-                        NamespaceString(refsNSIt->second),
+                        NamespaceString(refsIt->second.ns),
                         id,
                         authorizationStatus.isOK() ? ErrorCodes::OK : ErrorCodes::Unauthorized);
                 if (!authorizationStatus.isOK()) {
                     continue;
                 }
-                server = refsIt->second;
-                _refs.erase(refsIt);
-                _refsNS.erase(refsNSIt);
+                server = std::move(refsIt->second.server);
+                partition.refs.erase(refsIt);
                 cursorStatsSingleTarget.decrement();
             }
 
@@ -447,28 +486,34 @@ namespace mongo {
     }
 
     void CursorCache::appendInfo( BSONObjBuilder& result ) const {
-        boost::lock_guard<boost::mutex> lk( _mutex );
         result.append( "sharded", static_cast<int>(cursorStatsMultiTarget.get()));
-        result.appendNumber( "shardedEver" , _shardedTotal );
+        result.appendNumber( "shardedEver" , _shardedTotal.load() );
         result.append( "refs", static_cast<int>(cursorStatsSingleTarget.get()));
         result.append( "totalOpen", static_cast<int>(cursorStatsTotalOpen.get()));
     }
 
     void CursorCache::doTimeouts() {
-        long long now = Listener::getElapsedTimeMillis();
-        boost::lock_guard<boost::mutex> lk( _mutex );
-        for ( MapSharded::iterator i=_cursors.begin(); i!=_cursors.end(); ++i ) {
-            // Note: cursors with no timeout will always have an idleTime of 0
-            long long idleFor = i->second->idleTime( now );
-            if ( idleFor < TIMEOUT ) {
-                continue;
+        // Sweeps one partition at a time, and destroys the timed out cursors of each only after
+        // unlocking it, so getMores aren't held up by the whole cache being swept.
+        for (Partition& partition : _partitions) {
+            std::vector<ShardedClientCursorPtr> timedOut;
+            {
+                long long now = Listener::getElapsedTimeMillis();
+                stdx::lock_guard<stdx::mutex> lk(partition.mutex);
+                for (auto i = partition.cursors.begin(); i != partition.cursors.end(); ) {
+                    // Note: cursors with no timeout will always have an idleTime of 0
+                    long long idleFor = i->second.cursor->idleTime( now );
+                    if ( idleFor < TIMEOUT ) {
+                        ++i;
+                        continue;
+                    }
+                    // TODO: make LOG(1)
+                    log() << "killing old cursor " << i->first
+                          << " idle for: " << idleFor << "ms" << endl;
+                    timedOut.push_back(std::move(i->second.cursor));
+                    i = partition.cursors.erase( i );
+                }
             }
-            log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make LOG(1)
-            _cursorsMaxTimeMS.erase( i->second->getId() );
-            _cursors.erase( i );
-            i = _cursors.begin(); // possible 2nd entry will get skipped, will get on next pass
-            if ( i == _cursors.end() )
-                break;
         }
     }
 
@@ -34,7 +34,10 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/client/parallel.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
@@ -87,7 +90,10 @@ namespace mongo {
         bool _done;
 
         long long _id;
-        long long _lastAccessMillis; // 0 means no timeout
+
+        // 0 means no timeout. Atomic because getMores mark the cursor accessed while the timeout
+        // sweep reads its idle time.
+        AtomicInt64 _lastAccessMillis;
 
     };
 
@@ -98,10 +104,6 @@ namespace mongo {
 
         static long long TIMEOUT;
 
-        typedef std::map<long long,ShardedClientCursorPtr> MapSharded;
-        typedef std::map<long long,int> MapShardedInt;
-        typedef std::map<long long,std::string> MapNormal;
-
         CursorCache();
         ~CursorCache();
 
@@ -128,26 +130,45 @@ namespace mongo {
         void doTimeouts();
         void startTimeoutThread();
     private:
-        mutable mongo::mutex _mutex;
+        // The cursors are spread by id over this many partitions, a power of two, each with its
+        // own mutex so that getMores on different cursors rarely wait for each other.
+        static const size_t kNumPartitions = 32;
 
-        PseudoRandom _random;
+        struct ShardedCursorEntry {
+            ShardedClientCursorPtr cursor;
 
-        // Maps sharded cursor ID to ShardedClientCursorPtr.
-        MapSharded _cursors;
+            // Remaining max time.  Value can be any of:
+            // - the constant "kMaxTimeCursorNoTimeLimit", or
+            // - the constant "kMaxTimeCursorTimeLimitExpired", or
+            // - a positive integer representing milliseconds of remaining time
+            int maxTimeMS;
+        };
 
-        // Maps sharded cursor ID to remaining max time.  Value can be any of:
-        // - the constant "kMaxTimeCursorNoTimeLimit", or
-        // - the constant "kMaxTimeCursorTimeLimitExpired", or
-        // - a positive integer representing milliseconds of remaining time
-        MapShardedInt _cursorsMaxTimeMS;
+        struct RefEntry {
+            // The shard the passthrough cursor is on, and its namespace.
+            std::string server;
+            std::string ns;
+        };
 
-        // Maps passthrough cursor ID to shard name.
-        MapNormal _refs;
+        struct Partition {
+            mutable stdx::mutex mutex;
 
-        // Maps passthrough cursor ID to namespace.
-        MapNormal _refsNS;
-        
-        long long _shardedTotal;
+            // Maps sharded cursor ID to the cursor and its remaining max time.
+            unordered_map<long long, ShardedCursorEntry> cursors;
+
+            // Maps passthrough cursor ID to shard name and namespace.
+            unordered_map<long long, RefEntry> refs;
+        };
+
+        Partition& _partitionFor(long long id);
+        const Partition& _partitionFor(long long id) const;
+
+        stdx::mutex _randomMutex;
+        PseudoRandom _random;
+
+        Partition _partitions[kNumPartitions];
+
+        AtomicInt64 _shardedTotal;
 
         static const int _myLogLevel;
     };
@@ -67,6 +67,7 @@
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/logger/ramlog.h"
@@ -76,6 +77,7 @@
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
 #include "mongo/s/d_state.h"
+#include "mongo/s/type_mongos.h"
 #include "mongo/s/catalog/dist_lock_manager.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/client/shard.h"
@@ -123,6 +125,62 @@ namespace {
         return WriteConcernOptions(1, WriteConcernOptions::NONE, 0);
     }
 
+    // The most memory, in MB, the donor of a migration may use to remember the documents written
+    // since the clone began, before it aborts the migration
+    MONGO_EXPORT_SERVER_PARAMETER(migrationMaxModsMemoryMB, int, 500);
+
+    // Whether the donor of a migration tells the routers about the new collection version
+    MONGO_EXPORT_SERVER_PARAMETER(notifyRoutersOfMigrations, bool, true);
+
+    /**
+     * Sends the new 'version' of the collection 'ns' to every router that pinged the config servers
+     * in the last five minutes, so that they refresh their routing table now instead of on their
+     * next stale config error. This is best effort: a router that misses it still finds out from
+     * the shards.
+     */
+    void notifyRoutersOfCollectionVersion(std::string ns, ChunkVersion version) {
+        Client::initThread("notifyRouters");
+
+        vector<string> routers;
+        try {
+            ScopedDbConnection conn(grid.catalogManager()->connectionString(), 30);
+            std::unique_ptr<DBClientCursor> cursor(
+                    conn->query(MongosType::ConfigNS,
+                                QUERY(MongosType::ping() << GT << jsTime() - Minutes(5))));
+            uassert(28772, "could not query " + MongosType::ConfigNS, cursor.get());
+            while (cursor->more()) {
+                routers.push_back(cursor->nextSafe()[MongosType::name()].str());
+            }
+            conn.done();
+        }
+        catch (const DBException& e) {
+            warning() << "could not find the routers to notify of version " << version << " of "
+                      << ns << causedBy(e);
+            return;
+        }
+
+        BSONObjBuilder cmdBuilder;
+        cmdBuilder.append("_noteCollectionVersion", ns);
+        version.addToBSON(cmdBuilder, "version");
+        const BSONObj cmdObj = cmdBuilder.obj();
+
+        for (vector<string>::const_iterator it = routers.begin(); it != routers.end(); ++it) {
+            try {
+                ScopedDbConnection conn(*it, 10);
+                BSONObj res;
+                if (!conn->runCommand("admin", cmdObj, res)) {
+                    LOG(1) << "router " << *it << " failed to note version " << version << " of "
+                           << ns << ": " << res;
+                }
+                conn.done();
+            }
+            catch (const DBException& e) {
+                LOG(1) << "could not notify router " << *it << " of version " << version
+                       << " of " << ns << causedBy(e);
+            }
+        }
+    }
+
 } // namespace
 
     MONGO_FP_DECLARE(failMigrationCommit);
@@ -236,8 +294,9 @@ namespace {
     bool isInRange( const BSONObj& obj ,
                     const BSONObj& min ,
                     const BSONObj& max ,
-                    const BSONObj& shardKeyPattern ) {
-        ShardKeyPattern shardKey( shardKeyPattern );
+                    const BSONObj& shardKeyPattern ,
+                    int hashVersion = BSONElementHasher::DEFAULT_HASH_VERSION ) {
+        ShardKeyPattern shardKey( shardKeyPattern , hashVersion );
         BSONObj k = shardKey.extractShardKeyFromDoc( obj );
         return k.woCompare( min ) >= 0 && k.woCompare( max ) < 0;
     }
@@ -247,7 +306,8 @@ namespace {
         MigrateFromStatus():
             _inCriticalSection(false),
             _memoryUsed(0),
-            _active(false) {
+            _active(false),
+            _hashVersion(BSONElementHasher::DEFAULT_HASH_VERSION) {
         }
 
         /**
@@ -258,7 +318,8 @@ namespace {
                    const std::string& ns,
                    const BSONObj& min,
                    const BSONObj& max,
-                   const BSONObj& shardKeyPattern) {
+                   const BSONObj& shardKeyPattern,
+                   int hashVersion) {
             verify(!min.isEmpty());
             verify(!max.isEmpty());
             verify(!ns.empty());
@@ -276,6 +337,7 @@ namespace {
             _min = min;
             _max = max;
             _shardKeyPattern = shardKeyPattern;
+            _hashVersion = hashVersion;
 
             verify(_deleted.size() == 0);
             verify(_reload.size() == 0);
@@ -355,7 +417,7 @@ namespace {
                 return;
             }
 
-            if (op == 'i' && (!isInRange(obj, _min, _max, _shardKeyPattern))) {
+            if (op == 'i' && (!isInRange(obj, _min, _max, _shardKeyPattern, _hashVersion))) {
                 return;
             }
 
@@ -371,7 +433,7 @@ namespace {
                     return;
                 }
 
-                if (!isInRange(fullDoc, _min, _max, _shardKeyPattern)) {
+                if (!isInRange(fullDoc, _min, _max, _shardKeyPattern, _hashVersion)) {
                     return;
                 }
             }
@@ -392,7 +454,7 @@ namespace {
         void xfer(OperationContext* txn,
                   const string& ns,
                   Database* db,
-                  list<BSONObj> *docIdList,
+                  BSONObjSet* docIdList,
                   BSONObjBuilder& builder,
                   const char* fieldName,
                   long long& size,
@@ -404,7 +466,7 @@ namespace {
 
             BSONArrayBuilder arr(builder.subarrayStart(fieldName));
 
-            list<BSONObj>::iterator docIdIter = docIdList->begin();
+            BSONObjSet::iterator docIdIter = docIdList->begin();
             while (docIdIter != docIdList->end() && size < maxSize) {
                 BSONObj idDoc = *docIdIter;
                 if (explode) {
@@ -419,7 +481,8 @@ namespace {
                     size += idDoc.objsize();
                 }
 
-                docIdIter = docIdList->erase(docIdIter);
+                _memoryUsed -= modMemoryUsed(idDoc);
+                docIdList->erase(docIdIter++);
             }
 
             arr.done();
@@ -741,8 +804,9 @@ namespace {
                 switch (_op) {
                 case 'd': {
                     boost::lock_guard<boost::mutex> sl(_migrateFromStatus->_mutex);
-                    _migrateFromStatus->_deleted.push_back(_idObj);
-                    _migrateFromStatus->_memoryUsed += _idObj.firstElement().size() + 5;
+                    if (_migrateFromStatus->_deleted.insert(_idObj).second) {
+                        _migrateFromStatus->_memoryUsed += modMemoryUsed(_idObj);
+                    }
                     break;
                 }
 
@@ -750,8 +814,9 @@ namespace {
                 case 'u':
                 {
                     boost::lock_guard<boost::mutex> sl(_migrateFromStatus->_mutex);
-                    _migrateFromStatus->_reload.push_back(_idObj);
-                    _migrateFromStatus->_memoryUsed += _idObj.firstElement().size() + 5;
+                    if (_migrateFromStatus->_reload.insert(_idObj).second) {
+                        _migrateFromStatus->_memoryUsed += modMemoryUsed(_idObj);
+                    }
                     break;
                 }
 
@@ -838,11 +903,17 @@ namespace {
 
         std::unique_ptr<PlanExecutor> _deleteNotifyExec;                                 // (M)
 
-        // List of _id of documents that were modified that must be re-cloned.
-        list<BSONObj> _reload;                                                           // (M)
+        // Approximate bytes an _id takes in _reload or _deleted
+        static long long modMemoryUsed(const BSONObj& idObj) {
+            return sizeof(BSONObjSet::value_type) + 4 * sizeof(void*) + idObj.objsize();
+        }
 
-        // List of _id of documents that were deleted during clone that should be deleted later.
-        list<BSONObj> _deleted;                                                          // (M)
+        // Set of _id of documents that were modified that must be re-cloned. Each document is
+        // re-cloned once however often it changes, since the current version is sent.
+        BSONObjSet _reload;                                                              // (M)
+
+        // Set of _id of documents that were deleted during clone that should be deleted later.
+        BSONObjSet _deleted;                                                             // (M)
 
         // bytes in _reload + _deleted
         long long _memoryUsed;                                                           // (M)
@@ -854,6 +925,7 @@ namespace {
         BSONObj _min;                                                                    // (MG)
         BSONObj _max;                                                                    // (MG)
         BSONObj _shardKeyPattern;                                                        // (MG)
+        int _hashVersion;                                                                // (MG)
 
         mutable mongo::mutex _cloneLocsMutex;
 
@@ -875,10 +947,11 @@ namespace {
                              const std::string& ns ,
                              const BSONObj& min ,
                              const BSONObj& max ,
-                             const BSONObj& shardKeyPattern )
+                             const BSONObj& shardKeyPattern ,
+                             int hashVersion )
                 : _txn(txn) {
             _isAnotherMigrationActive =
-                    !migrateFromStatus.start(txn, ns, min, max, shardKeyPattern);
+                    !migrateFromStatus.start(txn, ns, min, max, shardKeyPattern, hashVersion);
         }
         ~MigrateStatusHolder() {
             if (!_isAnotherMigrationActive) {
@@ -1260,7 +1333,12 @@ namespace {
             MONGO_FP_PAUSE_WHILE(moveChunkHangAtStep2);
 
             // 3.
-            MigrateStatusHolder statusHolder(txn, ns, min, max, shardKeyPattern);
+            MigrateStatusHolder statusHolder(txn,
+                                             ns,
+                                             min,
+                                             max,
+                                             shardKeyPattern,
+                                             origCollMetadata->getHashVersion());
             
             if (statusHolder.isAnotherMigrationActive()) {
                 errmsg = "moveChunk is already in progress from this shard";
@@ -1313,6 +1391,11 @@ namespace {
                 recvChunkStartBuilder.append("min", min);
                 recvChunkStartBuilder.append("max", max);
                 recvChunkStartBuilder.append("shardKeyPattern", shardKeyPattern);
+                if (origCollMetadata->getHashVersion() !=
+                        BSONElementHasher::DEFAULT_HASH_VERSION) {
+                    recvChunkStartBuilder.append("hashVersion",
+                                                 origCollMetadata->getHashVersion());
+                }
                 recvChunkStartBuilder.append("configServer", shardingState.getConfigServer());
                 recvChunkStartBuilder.append("secondaryThrottle", isSecondaryThrottle);
 
@@ -1401,7 +1484,7 @@ namespace {
                 if ( res["state"].String() == "steady" )
                     break;
 
-                if ( migrateFromStatus.mbUsed() > (500 * 1024 * 1024) ) {
+                if (migrateFromStatus.mbUsed() > migrationMaxModsMemoryMB) {
                     // This is too much memory for us to use for this so we're going to abort
                     // the migrate
                     ScopedDbConnection conn(toShardCS);
@@ -1735,6 +1818,10 @@ namespace {
                 }
 
                 grid.catalogManager()->logChange(txn, "moveChunk.commit", ns, commitInfo.obj());
+
+                if (notifyRoutersOfMigrations) {
+                    boost::thread notifyRouters(notifyRoutersOfCollectionVersion, ns, nextVersion);
+                }
             }
 
             migrateFromStatus.done(txn);
@@ -1815,6 +1902,69 @@ namespace {
     MONGO_FP_DECLARE(migrateThreadHangAtStep4);
     MONGO_FP_DECLARE(migrateThreadHangAtStep5);
 
+    /**
+     * Runs the recipient's _migrateClone requests on a background thread, so that the donor
+     * gathers the next batch of documents while the recipient inserts the current one.
+     */
+    class CloneBatchFetcher {
+        MONGO_DISALLOW_COPYING(CloneBatchFetcher);
+    public:
+        explicit CloneBatchFetcher(DBClientBase* conn) : _conn(conn), _status(Status::OK()) {}
+
+        ~CloneBatchFetcher() {
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+        }
+
+        /**
+         * Starts fetching the next batch.
+         */
+        void start() {
+            invariant(!_thread.joinable());
+            _thread = boost::thread(&CloneBatchFetcher::_fetch, this);
+        }
+
+        /**
+         * Waits for the batch being fetched and returns the response of _migrateClone.
+         */
+        Status wait(BSONObj* res) {
+            invariant(_thread.joinable());
+            _thread.join();
+            *res = _res;
+            return _status;
+        }
+
+    private:
+        void _fetch() {
+            Client::initThread("migrateCloneFetcher");
+            try {
+                // gets array of objects to copy, in disk order
+                if (_conn->runCommand("admin", BSON("_migrateClone" << 1), _res)) {
+                    _status = Status::OK();
+                }
+                else {
+                    _status = Status(ErrorCodes::OperationFailed,
+                                     "_migrateClone failed: " + _res.toString());
+                }
+            }
+            catch (const DBException& e) {
+                _status = e.toStatus("_migrateClone failed");
+            }
+        }
+
+        DBClientBase* const _conn;
+        boost::thread _thread;
+
+        // Written by the fetching thread, read once it is joined
+        Status _status;
+        BSONObj _res;
+    };
+
+    // The most documents the recipient of a migration inserts into the collection under one lock
+    // acquisition while cloning
+    const int kCloneInsertGroupSize = 64;
+
     class MigrateStatus {
     public:
         enum State {
@@ -1830,6 +1980,7 @@ namespace {
 
         MigrateStatus():
             _active(false),
+            _hashVersion(BSONElementHasher::DEFAULT_HASH_VERSION),
             _numCloned(0),
             _clonedBytes(0),
             _numCatchup(0),
@@ -1854,7 +2005,8 @@ namespace {
                        const std::string& fromShard,
                        const BSONObj& min,
                        const BSONObj& max,
-                       const BSONObj& shardKeyPattern) {
+                       const BSONObj& shardKeyPattern,
+                       int hashVersion) {
             boost::lock_guard<boost::mutex> lk(_mutex);
 
             if (_active) {
@@ -1874,6 +2026,7 @@ namespace {
             _min = min;
             _max = max;
             _shardKeyPattern = shardKeyPattern;
+            _hashVersion = hashVersion;
 
             _numCloned = 0;
             _clonedBytes = 0;
@@ -2137,64 +2290,77 @@ namespace {
                 // 3. initial bulk clone
                 setState(CLONE);
 
+                // The next batch is fetched while the current one is inserted
+                CloneBatchFetcher fetcher(conn.get());
+                fetcher.start();
+
                 while ( true ) {
                     BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
+                    Status fetchStatus = fetcher.wait(&res);
+                    if (!fetchStatus.isOK()) {
                         setState(FAIL);
-                        errmsg = "_migrateClone failed: ";
-                        errmsg += res.toString();
+                        errmsg = fetchStatus.reason();
                         error() << errmsg << migrateLog;
                         conn.done();
                         return;
                     }
 
                     BSONObj arr = res["objects"].Obj();
-                    int thisTime = 0;
+                    if (arr.isEmpty())
+                        break;
+
+                    fetcher.start();
 
                     BSONObjIterator i( arr );
                     while( i.more() ) {
-                        txn->checkForInterrupt();
+                        int thisTime = 0;
+                        long long thisTimeBytes = 0;
 
-                        if ( getState() == ABORT ) {
-                            errmsg = str::stream() << "Migration abort requested while "
-                                                   << "copying documents";
-                            error() << errmsg << migrateLog;
-                            return;
-                        }
-
-                        BSONObj docToClone = i.next().Obj();
                         {
                             OldClientWriteContext cx(txn, ns );
 
-                            BSONObj localDoc;
-                            if (willOverrideLocalId(txn,
-                                                    ns,
-                                                    min,
-                                                    max,
-                                                    shardKeyPattern,
-                                                    cx.db(),
-                                                    docToClone,
-                                                    &localDoc)) {
-                                string errMsg =
-                                    str::stream() << "cannot migrate chunk, local document "
-                                    << localDoc
-                                    << " has same _id as cloned "
-                                    << "remote document " << docToClone;
-
-                                warning() << errMsg;
-
-                                // Exception will abort migration cleanly
-                                uasserted( 16976, errMsg );
+                            for (; i.more() && thisTime < kCloneInsertGroupSize; ++thisTime) {
+                                txn->checkForInterrupt();
+
+                                if ( getState() == ABORT ) {
+                                    errmsg = str::stream() << "Migration abort requested while "
+                                                           << "copying documents";
+                                    error() << errmsg << migrateLog;
+                                    return;
+                                }
+
+                                BSONObj docToClone = i.next().Obj();
+
+                                BSONObj localDoc;
+                                if (willOverrideLocalId(txn,
+                                                        ns,
+                                                        min,
+                                                        max,
+                                                        shardKeyPattern,
+                                                        cx.db(),
+                                                        docToClone,
+                                                        &localDoc)) {
+                                    string errMsg =
+                                        str::stream() << "cannot migrate chunk, local document "
+                                        << localDoc
+                                        << " has same _id as cloned "
+                                        << "remote document " << docToClone;
+
+                                    warning() << errMsg;
+
+                                    // Exception will abort migration cleanly
+                                    uasserted( 16976, errMsg );
+                                }
+
+                                Helpers::upsert( txn, ns, docToClone, true );
+                                thisTimeBytes += docToClone.objsize();
                             }
-
-                            Helpers::upsert( txn, ns, docToClone, true );
                         }
-                        thisTime++;
 
                         {
                             boost::lock_guard<boost::mutex> statsLock(_mutex);
-                            _numCloned++;
-                            _clonedBytes += docToClone.objsize();
+                            _numCloned += thisTime;
+                            _clonedBytes += thisTimeBytes;
                         }
 
                         if (writeConcern.shouldWaitForOtherNodes()) {
@@ -2213,9 +2379,6 @@ namespace {
                             }
                         }
                     }
-
-                    if ( thisTime == 0 )
-                        break;
                 }
 
                 timing.done(3);
@@ -2420,7 +2583,7 @@ namespace {
                     // do not apply deletes if they do not belong to the chunk being migrated
                     BSONObj fullObj;
                     if (Helpers::findById(txn, ctx.db(), ns.c_str(), id, fullObj)) {
-                        if (!isInRange(fullObj , min , max , shardKeyPattern)) {
+                        if (!isInRange(fullObj , min , max , shardKeyPattern , _hashVersion)) {
                             log() << "not applying out of range deletion: " << fullObj << migrateLog;
 
                             continue;
@@ -2501,7 +2664,7 @@ namespace {
 
             *localDoc = BSONObj();
             if ( Helpers::findById( txn, db, ns.c_str(), remoteDoc, *localDoc ) ) {
-                return !isInRange( *localDoc , min , max , shardKeyPattern );
+                return !isInRange( *localDoc , min , max , shardKeyPattern , _hashVersion );
             }
 
             return false;
@@ -2633,6 +2796,8 @@ namespace {
         BSONObj _min;
         BSONObj _max;
         BSONObj _shardKeyPattern;
+        // Only set by prepare(), before the migration thread that reads it is started.
+        int _hashVersion;
 
         long long _numCloned;
         long long _clonedBytes;
@@ -2818,10 +2983,22 @@ namespace {
                 shardKeyPattern = keya.getOwned();
             }
 
+            // Missing unless the collection was sharded with a hashVersion other than the default
+            const int hashVersion = cmdObj["hashVersion"].numberInt();
+            if (!BSONElementHasher::isValidHashVersion(hashVersion)) {
+                errmsg = str::stream() << "unknown hashVersion " << hashVersion;
+                return false;
+            }
+
             const string fromShard(cmdObj["from"].String());
 
             // Set the TO-side migration to active
-            Status prepareStatus = migrateStatus.prepare(ns, fromShard, min, max, shardKeyPattern);
+            Status prepareStatus = migrateStatus.prepare(ns,
+                                                         fromShard,
+                                                         min,
+                                                         max,
+                                                         shardKeyPattern,
+                                                         hashVersion);
 
             if (!prepareStatus.isOK()) {
                 return appendCommandStatus(result, prepareStatus);
@@ -48,11 +48,15 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/index_legacy.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/chunk.h"
@@ -236,6 +240,138 @@ namespace mongo {
         return key.replaceFieldNames(keyPattern).clientReadable();
     }
 
+    // splitVector picks the split points of chunks from a random sample of the keys of the shard
+    // key index, rather than by counting all the keys of the chunk, when the collection has at
+    // least this many documents and the storage engine can pick index keys at random. 0 turns
+    // sampling off.
+    MONGO_EXPORT_SERVER_PARAMETER(splitVectorSamplingMinDocs, long long, 1000000);
+
+    // Most keys splitVector samples for a chunk. Chunks which would need more to place every split
+    // point within the error bound are scanned instead.
+    MONGO_EXPORT_SERVER_PARAMETER(splitVectorMaxSamples, int, 100000);
+
+    // Number and time of the splitVector runs which counted keys and which sampled them, and the
+    // index keys they looked at
+    static TimerStats splitVectorScanStats;
+    static ServerStatusMetricField<TimerStats> displaySplitVectorScans( "splitVector.scans",
+                                                                        &splitVectorScanStats );
+    static TimerStats splitVectorSampleStats;
+    static ServerStatusMetricField<TimerStats> displaySplitVectorSamples(
+                                                    "splitVector.samplings",
+                                                    &splitVectorSampleStats );
+    static Counter64 splitVectorKeysStats;
+    static ServerStatusMetricField<Counter64> displaySplitVectorKeys( "splitVector.keysExamined",
+                                                                      &splitVectorKeysStats );
+
+namespace {
+
+    // Sampled keys between consecutive split points. With n of them, the documents in a chunk
+    // are off from the target by about 1/sqrt(n) of it.
+    const long long kMinSamplesPerSplit = 100;
+
+    // Keys sampled to find the median of a chunk, about 3% off
+    const long long kMedianSamples = 1000;
+
+    /**
+     * Picks the split points of the chunk [min, max) of 'idx' from a random sample of the keys of
+     * the whole index, every 'keyCount' keys or at the median if 'forceMedianSplit', and appends
+     * them to 'splitKeys'. Returns false, having appended nothing, if the storage engine can't
+     * sample keys or if counting the keys of the chunk would not cost more than sampling.
+     */
+    bool sampleSplitKeys(OperationContext* txn,
+                         Collection* collection,
+                         IndexDescriptor* idx,
+                         const BSONObj& keyPattern,
+                         const BSONObj& min,
+                         const BSONObj& max,
+                         long long recCount,
+                         long long keyCount,
+                         bool forceMedianSplit,
+                         long long maxSplitPoints,
+                         vector<BSONObj>* splitKeys,
+                         set<BSONObj>* tooFrequentKeys,
+                         long long* keysSampled) {
+        long long numSamples = std::min<long long>(splitVectorMaxSamples, kMedianSamples);
+        if (!forceMedianSplit) {
+            // Enough samples for kMinSamplesPerSplit of them in every 'keyCount' keys of the index
+            const long long needed = kMinSamplesPerSplit * recCount / keyCount + 1;
+            if (needed > splitVectorMaxSamples) {
+                return false;
+            }
+            numSamples = needed;
+        }
+        if (numSamples >= recCount) {
+            return false;
+        }
+
+        std::vector<BSONObj> samples;
+        const IndexAccessMethod* iam = collection->getIndexCatalog()->getIndex(idx);
+        if (!iam->sampleKeys(txn, numSamples, &samples)) {
+            return false;
+        }
+        *keysSampled = samples.size();
+        if (samples.empty()) {
+            return false;
+        }
+
+        const Ordering ordering = Ordering::make(idx->keyPattern());
+        std::vector<BSONObj> inRange;
+        for (size_t i = 0; i < samples.size(); i++) {
+            if (samples[i].woCompare(min, ordering, false) >= 0 &&
+                samples[i].woCompare(max, ordering, false) < 0) {
+                inRange.push_back(samples[i]);
+            }
+        }
+
+        // The keys of a chunk which holds few of the samples are cheaper to count than to sample
+        const long long estimatedKeys = static_cast<long long>(inRange.size()) * recCount /
+                                        static_cast<long long>(samples.size());
+        if (static_cast<long long>(inRange.size()) < kMinSamplesPerSplit ||
+            estimatedKeys <= static_cast<long long>(samples.size())) {
+            return false;
+        }
+
+        std::sort(inRange.begin(), inRange.end(), BSONObjCmp(idx->keyPattern()));
+
+        if (forceMedianSplit) {
+            splitKeys->push_back(prettyKey(idx->keyPattern(), inRange[inRange.size() / 2])
+                                     .extractFields(keyPattern).getOwned());
+            return true;
+        }
+
+        // Every 'keyCount' keys of the chunk are about this many of its samples
+        const double samplesPerChunk = static_cast<double>(keyCount) * samples.size() / recCount;
+        BSONObj lastKey = prettyKey(idx->keyPattern(), inRange.front()).extractFields(keyPattern);
+        for (double next = samplesPerChunk; next < inRange.size(); next += samplesPerChunk) {
+            // Split on the first key after the point which differs from the last split key.
+            size_t i = static_cast<size_t>(next);
+            BSONObj key;
+            for (; i < inRange.size(); i++) {
+                key = prettyKey(idx->keyPattern(), inRange[i]).extractFields(keyPattern);
+                if (key.woCompare(lastKey) != 0) {
+                    break;
+                }
+                tooFrequentKeys->insert(key.getOwned());
+            }
+            if (i == inRange.size()) {
+                break;
+            }
+
+            lastKey = key.getOwned();
+            splitKeys->push_back(lastKey);
+            next = std::max(next, static_cast<double>(i));
+            LOG(4) << "picked a sampled split key: " << lastKey;
+
+            if (maxSplitPoints &&
+                static_cast<long long>(splitKeys->size()) >= maxSplitPoints) {
+                break;
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
     class SplitVector : public Command {
     public:
         SplitVector() : Command( "splitVector" , false ) {}
@@ -300,6 +436,9 @@ namespace mongo {
                 maxSplitPoints = maxSplitPointsElem.numberLong();
             }
 
+            // 'sample' chooses whether to sample the keys, whatever splitVectorSamplingMinDocs
+            BSONElement sampleElem = jsobj["sample"];
+
             long long maxChunkObjects = Chunk::MaxObjectPerChunk;
             BSONElement MaxChunkObjectsElem = jsobj[ "maxChunkObjects" ];
             if ( MaxChunkObjectsElem.isNumber() ) {
@@ -408,7 +547,41 @@ namespace mongo {
                 //
                 
                 Timer timer;
+                set<BSONObj> tooFrequentKeys;
+
+                const bool sample = sampleElem.eoo() ?
+                    splitVectorSamplingMinDocs > 0 && recCount >= splitVectorSamplingMinDocs :
+                    sampleElem.trueValue();
+                long long keysSampled = 0;
+                if (sample && sampleSplitKeys(txn, collection, idx, keyPattern, min, max,
+                                              recCount, keyCount, forceMedianSplit,
+                                              maxSplitPoints, &splitKeys, &tooFrequentKeys,
+                                              &keysSampled)) {
+                    for (set<BSONObj>::const_iterator it = tooFrequentKeys.begin();
+                         it != tooFrequentKeys.end();
+                         ++it) {
+                        warning() << "possible low cardinality key detected in " << ns
+                                  << " - key is " << *it;
+                    }
+
+                    splitVectorSampleStats.record(timer);
+                    splitVectorKeysStats.increment(keysSampled);
+                    if (timer.millis() > serverGlobalParams.slowMS) {
+                        warning() << "Sampling the split vector for " << ns << " over "
+                                  << keyPattern << " keyCount: " << keyCount << " numSplits: "
+                                  << splitKeys.size() << " sampled: " << keysSampled << " took "
+                                  << timer.millis() << "ms";
+                    }
+
+                    result.append( "timeMillis", timer.millis() );
+                    result.appendBool( "sampled", true );
+                    result.append( "keysExamined", keysSampled );
+                    result.append( "splitKeys" , splitKeys );
+                    return true;
+                }
+
                 long long currCount = 0;
+                long long keysExamined = keysSampled;
                 long long numChunks = 0;
                 
                 unique_ptr<PlanExecutor> exec(
@@ -425,13 +598,13 @@ namespace mongo {
                 // Use every 'keyCount'-th key as a split point. We add the initial key as a sentinel, to be removed
                 // at the end. If a key appears more times than entries allowed on a chunk, we issue a warning and
                 // split on the following key.
-                set<BSONObj> tooFrequentKeys;
                 splitKeys.push_back(prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields( keyPattern ) );
 
                 exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
                 while ( 1 ) {
                     while (PlanExecutor::ADVANCED == state) {
                         currCount++;
+                        keysExamined++;
                         
                         if ( currCount > keyCount && !forceMedianSplit ) {
                             currKey = prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields(keyPattern);
@@ -502,7 +675,12 @@ namespace mongo {
                 // Warning: we are sending back an array of keys but are currently limited to
                 // 4MB work of 'result' size. This should be okay for now.
 
+                splitVectorScanStats.record(timer);
+                splitVectorKeysStats.increment(keysExamined);
+
                 result.append( "timeMillis", timer.millis() );
+                result.appendBool( "sampled", false );
+                result.append( "keysExamined", keysExamined );
             }
 
             result.append( "splitKeys" , splitKeys );
@@ -705,6 +883,12 @@ namespace mongo {
 
             BSONObjBuilder logDetail;
             appendShortVersion(logDetail.subobjStart("before"), origChunk);
+
+            // how long mongos's splitVector took to find the split points, and how
+            BSONElement splitVectorStats = cmdObj["splitVectorStats"];
+            if (splitVectorStats.type() == Object) {
+                logDetail.append("splitVector", splitVectorStats.Obj());
+            }
             LOG(1) << "before split on " << origChunk << endl;
             OwnedPointerVector<ChunkType> newChunks;
 
@@ -66,6 +66,7 @@
 #include "mongo/s/stale_exception.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stringutils.h"
@@ -91,17 +92,17 @@ namespace mongo {
 
     ShardingState::ShardingState()
         : _enabled(false),
-          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ) {
+          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ),
+          _collMetadataSnapshot(std::make_shared<CollectionMetadataMap>()) {
     }
 
     bool ShardingState::enabled() {
-        boost::lock_guard<boost::mutex> lk(_mutex);
-        return _enabled;
+        return _enabled.load();
     }
 
     string ShardingState::getConfigServer() {
         boost::lock_guard<boost::mutex> lk(_mutex);
-        invariant(_enabled);
+        invariant(_enabled.load());
 
         return grid.catalogManager()->connectionString().toString();
     }
@@ -175,21 +176,38 @@ namespace mongo {
     void ShardingState::clearCollectionMetadata() {
         boost::lock_guard<boost::mutex> lk(_mutex);
         _collMetadata.clear();
+        _publishCollMetadata_inlock();
+    }
+
+    ShardingState::CollectionMetadataMapPtr ShardingState::_getCollMetadataSnapshot() const {
+        scoped_spinlock lk(_collMetadataSnapshotLock);
+        return _collMetadataSnapshot;
+    }
+
+    void ShardingState::_publishCollMetadata_inlock() {
+        CollectionMetadataMapPtr snapshot(std::make_shared<CollectionMetadataMap>(_collMetadata));
+
+        {
+            scoped_spinlock lk(_collMetadataSnapshotLock);
+            _collMetadataSnapshot.swap(snapshot);
+        }
+
+        // The previous snapshot, if this was its last reference, is freed here, outside the lock.
     }
 
     // TODO we shouldn't need three ways for checking the version. Fix this.
     bool ShardingState::hasVersion( const string& ns ) {
-        boost::lock_guard<boost::mutex> lk(_mutex);
+        const CollectionMetadataMapPtr collMetadata = _getCollMetadataSnapshot();
 
-        CollectionMetadataMap::const_iterator it = _collMetadata.find(ns);
-        return it != _collMetadata.end();
+        CollectionMetadataMap::const_iterator it = collMetadata->find(ns);
+        return it != collMetadata->end();
     }
 
     bool ShardingState::hasVersion( const string& ns , ChunkVersion& version ) {
-        boost::lock_guard<boost::mutex> lk(_mutex);
+        const CollectionMetadataMapPtr collMetadata = _getCollMetadataSnapshot();
 
-        CollectionMetadataMap::const_iterator it = _collMetadata.find(ns);
-        if ( it == _collMetadata.end() )
+        CollectionMetadataMap::const_iterator it = collMetadata->find(ns);
+        if ( it == collMetadata->end() )
             return false;
 
         CollectionMetadataPtr p = it->second;
@@ -198,10 +216,10 @@ namespace mongo {
     }
 
     ChunkVersion ShardingState::getVersion(const string& ns) {
-        boost::lock_guard<boost::mutex> lk(_mutex);
+        const CollectionMetadataMapPtr collMetadata = _getCollMetadataSnapshot();
 
-        CollectionMetadataMap::const_iterator it = _collMetadata.find( ns );
-        if ( it != _collMetadata.end() ) {
+        CollectionMetadataMap::const_iterator it = collMetadata->find( ns );
+        if ( it != collMetadata->end() ) {
             CollectionMetadataPtr p = it->second;
             return p->getShardVersion();
         }
@@ -240,6 +258,7 @@ namespace mongo {
         // TODO: a bit dangerous to have two different zero-version states - no-metadata and
         // no-version
         _collMetadata[ns] = cloned;
+        _publishCollMetadata_inlock();
     }
 
     void ShardingState::undoDonateChunk(OperationContext* txn,
@@ -254,6 +273,7 @@ namespace mongo {
         CollectionMetadataMap::iterator it = _collMetadata.find( ns );
         verify( it != _collMetadata.end() );
         it->second = prevMetadata;
+        _publishCollMetadata_inlock();
     }
 
     bool ShardingState::notePending(OperationContext* txn,
@@ -298,6 +318,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _publishCollMetadata_inlock();
         return true;
     }
 
@@ -343,6 +364,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _publishCollMetadata_inlock();
         return true;
     }
 
@@ -369,6 +391,7 @@ namespace mongo {
         uassert( 16857, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _publishCollMetadata_inlock();
     }
 
     void ShardingState::mergeChunks(OperationContext* txn,
@@ -393,6 +416,7 @@ namespace mongo {
         uassert( 17004, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _publishCollMetadata_inlock();
     }
 
     void ShardingState::resetMetadata( const string& ns ) {
@@ -402,6 +426,7 @@ namespace mongo {
                   << endl;
 
         _collMetadata.erase( ns );
+        _publishCollMetadata_inlock();
     }
 
     Status ShardingState::refreshMetadataIfNeeded( OperationContext* txn,
@@ -480,7 +505,7 @@ namespace mongo {
         // Ensure only one caller at a time initializes
         boost::lock_guard<boost::mutex> lk(_mutex);
 
-        if (_enabled) {
+        if (_enabled.load()) {
             // TODO: Do we need to throw exception if the config servers have changed from what we
             // already have in place? How do we test for that?
             return;
@@ -505,7 +530,7 @@ namespace mongo {
 
         grid.init(std::move(catalogManager), std::move(shardRegistry));
 
-        _enabled = true;
+        _enabled.store(true);
     }
 
     Status ShardingState::doRefreshMetadata( OperationContext* txn,
@@ -529,7 +554,7 @@ namespace mongo {
             boost::lock_guard<boost::mutex> lk( _mutex );
 
             // We can't reload if sharding is not enabled - i.e. without a config server location
-            if (!_enabled) {
+            if (!_enabled.load()) {
                 string errMsg = str::stream() << "cannot refresh metadata for " << ns
                                               << " before sharding has been enabled";
 
@@ -651,7 +676,7 @@ namespace mongo {
             boost::lock_guard<boost::mutex> lk( _mutex );
 
             // Don't reload if our config server has changed or sharding is no longer enabled
-            if (!_enabled) {
+            if (!_enabled.load()) {
                 string errMsg = str::stream() << "could not refresh metadata for " << ns
                                               << ", sharding is no longer enabled";
 
@@ -732,6 +757,7 @@ namespace mongo {
                     _collMetadata.erase( it );
                 }
 
+                _publishCollMetadata_inlock();
                 *latestShardVersion = remoteShardVersion;
             }
         }
@@ -805,8 +831,8 @@ namespace mongo {
     void ShardingState::appendInfo(BSONObjBuilder& builder) {
         boost::lock_guard<boost::mutex> lk(_mutex);
 
-        builder.appendBool("enabled", _enabled);
-        if (!_enabled) {
+        builder.appendBool("enabled", _enabled.load());
+        if (!_enabled.load()) {
             return;
         }
 
@@ -826,7 +852,7 @@ namespace mongo {
     }
 
     bool ShardingState::needCollectionMetadata( Client* client, const string& ns ) const {
-        if ( ! _enabled )
+        if ( ! _enabled.load() )
             return false;
 
         if ( ! ShardedConnectionInfo::get( client, false ) )
@@ -836,10 +862,10 @@ namespace mongo {
     }
 
     CollectionMetadataPtr ShardingState::getCollectionMetadata( const string& ns ) {
-        boost::lock_guard<boost::mutex> lk( _mutex );
+        const CollectionMetadataMapPtr collMetadata = _getCollMetadataSnapshot();
 
-        CollectionMetadataMap::const_iterator it = _collMetadata.find( ns );
-        if ( it == _collMetadata.end() ) {
+        CollectionMetadataMap::const_iterator it = collMetadata->find( ns );
+        if ( it == collMetadata->end() ) {
             return CollectionMetadataPtr();
         }
         else {
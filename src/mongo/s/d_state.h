@@ -32,7 +32,9 @@
 #include "mongo/db/client.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/s/collection_metadata.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/chunk_version.h"
+#include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/net/message.h"
 
@@ -279,11 +281,26 @@ namespace mongo {
                                   bool useRequestedVersion,
                                   ChunkVersion* latestShardVersion );
 
+        // Map from a namespace into the metadata we need for each collection on this shard
+        typedef std::map<std::string,CollectionMetadataPtr> CollectionMetadataMap;
+        typedef std::shared_ptr<const CollectionMetadataMap> CollectionMetadataMapPtr;
+
+        /**
+         * Returns the metadata of all collections as of the last change, without taking _mutex.
+         */
+        CollectionMetadataMapPtr _getCollMetadataSnapshot() const;
+
+        /**
+         * Makes the current _collMetadata what _getCollMetadataSnapshot returns. Must be called
+         * with _mutex held after every change of _collMetadata.
+         */
+        void _publishCollMetadata_inlock();
+
         // protects state below
         mongo::mutex _mutex;
 
-        // Whether ::initialize has been called
-        bool _enabled;
+        // Whether ::initialize has been called. Only set under _mutex, but read without it.
+        AtomicWord<bool> _enabled;
 
         // Sets the shard name for this host (comes through setShardVersion)
         std::string _shardName;
@@ -292,9 +309,15 @@ namespace mongo {
         // Using a ticket holder so we can have multiple redundant tries at any given time
         mutable TicketHolder _configServerTickets;
 
-        // Map from a namespace into the metadata we need for each collection on this shard
-        typedef std::map<std::string,CollectionMetadataPtr> CollectionMetadataMap;
+        // The metadata of the collections, as updated by the writers
         CollectionMetadataMap _collMetadata;
+
+        // A read-only copy of _collMetadata, replaced as a whole on every change. Versioned
+        // operations look up their metadata in it, so that they neither wait on nor serialize
+        // behind _mutex. The spin lock is held only while the pointer itself is copied or
+        // swapped.
+        mutable SpinLock _collMetadataSnapshotLock;
+        CollectionMetadataMapPtr _collMetadataSnapshot;
     };
 
     extern ShardingState shardingState;
@@ -120,6 +120,7 @@ namespace mongo {
         }
 
         metadata->_keyPattern = collInfo.getKeyPattern().toBSON();
+        metadata->_hashVersion = collInfo.getHashVersion();
         metadata->fillKeyPatternFields();
         metadata->_shardVersion = ChunkVersion(0, 0, collInfo.getEpoch());
         metadata->_collVersion = ChunkVersion(0, 0, collInfo.getEpoch());
@@ -39,6 +39,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/rpc/metadata/trace_metadata.h"
 #include "mongo/s/cluster_last_error_info.h"
 #include "mongo/s/cursors.h"
 #include "mongo/s/grid.h"
@@ -103,6 +104,10 @@ namespace mongo {
 
         _d.markSet();
 
+        // The root of the trace, if this operation is sampled for tracing
+        rpc::TraceMetadata::startOperation(_clientInfo);
+        rpc::ScopedTraceSpan traceSpan(_clientInfo, "mongos");
+
         bool iscmd = false;
         if ( op == dbKillCursors ) {
             cursorCache.gotKillCursors( _m );
@@ -135,6 +140,8 @@ namespace mongo {
             // globalOpCounters are handled by write commands.
         }
 
+        traceSpan.finish(BSON("op" << opToString(op) << "ns" << getns()));
+
         LOG(3) << "Request::process end ns: " << getns()
                << " msg id: " << msgId
                << " op: " << op
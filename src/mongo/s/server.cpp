@@ -34,6 +34,7 @@
 
 #include <boost/thread/thread.hpp>
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/init.h"
 #include "mongo/base/initializer.h"
 #include "mongo/base/status.h"
@@ -59,8 +60,10 @@
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/startup_warnings_common.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/balance.h"
+#include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/catalog/legacy/catalog_manager_legacy.h"
 #include "mongo/s/client/sharding_connection_hook.h"
 #include "mongo/s/client/shard_registry.h"
@@ -73,6 +76,8 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/util/admin_access.h"
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
+#include "mongo/util/coarse_clock.h"
+#include "mongo/util/concurrency/task.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/exception_filter_win32.h"
 #include "mongo/util/exit.h"
@@ -135,6 +140,16 @@ namespace mongo {
             Client::initThread("conn", getGlobalServiceContext(), p);
         }
 
+        virtual bool supportsSuspend() const { return true; }
+
+        virtual std::unique_ptr<ConnectionState> suspend(AbstractMessagingPort* p) {
+            return stdx::make_unique<SuspendedClient>(Client::releaseCurrent());
+        }
+
+        virtual void resume(AbstractMessagingPort* p, std::unique_ptr<ConnectionState> state) {
+            Client::setCurrent(std::move(checked_cast<SuspendedClient*>(state.get())->client));
+        }
+
         virtual void process(Message& m, AbstractMessagingPort* p) {
             verify( p );
             Request r( m , p );
@@ -175,11 +190,35 @@ namespace mongo {
             // Release connections back to pool, if any still cached
             ShardConnection::releaseMyConnections();
         }
+
+    private:
+        // Shard connections are released back to the pool at the end of every request, so
+        // the Client is the only per-connection state that has to follow a suspended connection.
+        struct SuspendedClient : public ConnectionState {
+            explicit SuspendedClient(ServiceContext::UniqueClient c) : client(std::move(c)) {}
+            ServiceContext::UniqueClient client;
+        };
+    };
+
+    /**
+     * Renews the leases of the database metadata cached by mongos before they expire.
+     */
+    class CatalogCacheRefreshTask : public task::Task {
+    public:
+        virtual std::string name() const { return "catalogCacheRefresher"; }
+        virtual void setUp() {
+            Client::initThread("catalogCacheRefresher");
+        }
+        virtual void doWork() {
+            grid.catalogCache()->refreshExpiring();
+        }
     };
 
     void start( const MessageServer::Options& opts ) {
+        CoarseClock::start();
         balancer.go();
         cursorCache.startTimeoutThread();
+        task::repeat(new CatalogCacheRefreshTask, 1000);
         UserCacheInvalidator cacheInvalidatorThread(getGlobalAuthorizationManager());
         cacheInvalidatorThread.go();
 
@@ -471,5 +510,6 @@ void mongo::dbexit(ExitCode rc, const char *why) {
 #endif
 
     log() << "dbexit: " << why << " rc:" << rc;
+    logger::AsyncLogWriter::flushAll();
     quickExit(rc);
 }
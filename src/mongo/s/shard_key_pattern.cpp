@@ -112,14 +112,18 @@ namespace mongo {
         return parsedPaths.release();
     }
 
-    ShardKeyPattern::ShardKeyPattern(const BSONObj& keyPattern)
+    ShardKeyPattern::ShardKeyPattern(const BSONObj& keyPattern, int hashVersion)
         : _keyPatternPaths(parseShardKeyPattern(keyPattern)),
-          _keyPattern(_keyPatternPaths.empty() ? BSONObj() : keyPattern) {
+          _keyPattern(_keyPatternPaths.empty() ? BSONObj() : keyPattern),
+          _hashVersion(hashVersion) {
+        invariant(BSONElementHasher::isValidHashVersion(_hashVersion));
     }
 
-    ShardKeyPattern::ShardKeyPattern(const KeyPattern& keyPattern)
+    ShardKeyPattern::ShardKeyPattern(const KeyPattern& keyPattern, int hashVersion)
         : _keyPatternPaths(parseShardKeyPattern(keyPattern.toBSON())),
-          _keyPattern(_keyPatternPaths.empty() ? KeyPattern(BSONObj()) : keyPattern) {
+          _keyPattern(_keyPatternPaths.empty() ? KeyPattern(BSONObj()) : keyPattern),
+          _hashVersion(hashVersion) {
+        invariant(BSONElementHasher::isValidHashVersion(_hashVersion));
     }
 
     bool ShardKeyPattern::isValid() const {
@@ -239,7 +243,8 @@ namespace mongo {
             if (isHashedPatternEl(patternEl)) {
                 keyBuilder.append(patternEl.fieldName(),
                                   BSONElementHasher::hash64(matchEl,
-                                                            BSONElementHasher::DEFAULT_HASH_SEED));
+                                                            BSONElementHasher::DEFAULT_HASH_SEED,
+                                                            _hashVersion));
             }
             else {
                 // NOTE: The matched element may *not* have the same field name as the path -
@@ -320,7 +325,8 @@ namespace mongo {
             if (isHashedPattern()) {
                 keyBuilder.append(patternPath.dottedField(),
                                   BSONElementHasher::hash64(equalEl,
-                                                            BSONElementHasher::DEFAULT_HASH_SEED));
+                                                            BSONElementHasher::DEFAULT_HASH_SEED,
+                                                            _hashVersion));
             }
             else {
                 // NOTE: The equal element may *not* have the same field name as the path -
@@ -31,6 +31,7 @@
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/matcher/matchable.h"
@@ -76,18 +77,24 @@ namespace mongo {
         /**
          * Constructs a shard key pattern from a BSON pattern document.  If the document is not a
          * valid shard key pattern, !isValid() will be true and key extraction will fail.
+         *
+         * A hashed pattern hashes values with the hashVersion of the collection's hashed index.
          */
-        explicit ShardKeyPattern(const BSONObj& keyPattern);
+        explicit ShardKeyPattern(const BSONObj& keyPattern,
+                                 int hashVersion = BSONElementHasher::DEFAULT_HASH_VERSION);
 
         /**
          * Constructs a shard key pattern from a key pattern, see above.
          */
-        explicit ShardKeyPattern(const KeyPattern& keyPattern);
+        explicit ShardKeyPattern(const KeyPattern& keyPattern,
+                                 int hashVersion = BSONElementHasher::DEFAULT_HASH_VERSION);
 
         bool isValid() const;
 
         bool isHashedPattern() const;
 
+        int getHashVersion() const { return _hashVersion; }
+
         const KeyPattern& getKeyPattern() const;
 
         const BSONObj& toBSON() const;
@@ -224,6 +231,8 @@ namespace mongo {
         const OwnedPointerVector<FieldRef> _keyPatternPaths;
 
         const KeyPattern _keyPattern;
+
+        const int _hashVersion;
     };
 
 }
@@ -246,6 +246,26 @@ namespace {
         ASSERT_EQUALS(docKey(pattern, BSON("a" << BSON_ARRAY(BSON("b" << value)))), BSONObj());
     }
 
+    TEST(ShardKeyPattern, ExtractDocShardKeyHashVersion) {
+
+        //
+        // Hashed ShardKeyPattern of a collection sharded with the newer hash function
+        //
+
+        const BSONObj bsonValue = BSON("" << "12345");
+        const long long hashValue =
+                BSONElementHasher::hash64(bsonValue.firstElement(),
+                                          BSONElementHasher::DEFAULT_HASH_SEED,
+                                          1);
+        ASSERT_NOT_EQUALS(hashValue,
+                          BSONElementHasher::hash64(bsonValue.firstElement(),
+                                                    BSONElementHasher::DEFAULT_HASH_SEED));
+
+        ShardKeyPattern pattern(BSON("a" << "hashed"), 1);
+        ASSERT_EQUALS(pattern.getHashVersion(), 1);
+        ASSERT_EQUALS(docKey(pattern, BSON("a" << "12345")), BSON("a" << hashValue));
+    }
+
     static BSONObj queryKey(const ShardKeyPattern& pattern, const BSONObj& query) {
         StatusWith<BSONObj> status = pattern.extractShardKeyFromQuery(query);
         if (!status.isOK())
@@ -409,6 +429,17 @@ namespace {
         ASSERT_EQUALS(queryKey(pattern, BSON("a" << BSON_ARRAY(BSON("b" << value)))), BSONObj());
     }
 
+    TEST(ShardKeyPattern, ExtractQueryShardKeyHashVersion) {
+        const BSONObj bsonValue = BSON("" << "12345");
+        const long long hashValue =
+                BSONElementHasher::hash64(bsonValue.firstElement(),
+                                          BSONElementHasher::DEFAULT_HASH_SEED,
+                                          1);
+
+        ShardKeyPattern pattern(BSON("a" << "hashed"), 1);
+        ASSERT_EQUALS(queryKey(pattern, BSON("a" << "12345")), BSON("a" << hashValue));
+    }
+
     static bool indexComp(const ShardKeyPattern& pattern, const BSONObj& indexPattern) {
         return pattern.isUniqueIndexCompatible(indexPattern);
     }
@@ -140,6 +140,89 @@ namespace mongo {
         return true;
     }
 
+    /**
+     * Returns true if the query targets a single shard, in which case it has been forwarded to
+     * that shard as is and the shard's reply returned to the client as is, without setting up a
+     * ParallelSortClusteredCursor. The pooled ShardConnection only sends setShardVersion when the
+     * version it last set is behind.
+     *
+     * Returns false, having replied nothing, if the query may need more than one shard, reads
+     * from secondaries, or the shard found the version stale. It must then go the general way,
+     * which also takes care of refreshing the routing information.
+     */
+    static bool doTargetedQuery(Request& r, const QuerySpec& qSpec) {
+        if (qSpec.isExplain() ||
+            (qSpec.options() & (QueryOption_SlaveOk | QueryOption_PartialResults)) ||
+            qSpec.query().hasField("$readPreference")) {
+            return false;
+        }
+
+        const NamespaceString nss(qSpec.ns());
+
+        auto status = grid.catalogCache()->getDatabase(nss.db().toString());
+        if (!status.isOK()) {
+            return false;
+        }
+
+        ShardPtr shard;
+        ChunkManagerPtr cm;
+        status.getValue()->getChunkManagerOrPrimary(nss.ns(), cm, shard);
+        if (cm) {
+            // Spares parsing the queries which can't have a shard key equality, so that those
+            // pay for one parse only, in the general path.
+            BSONForEach(keyField, cm->getShardKeyPattern().toBSON()) {
+                if (!qSpec.filter().hasField(keyField.fieldName())) {
+                    return false;
+                }
+            }
+
+            StatusWith<BSONObj> shardKey =
+                cm->getShardKeyPattern().extractShardKeyFromQuery(qSpec.filter());
+            if (!shardKey.isOK() || shardKey.getValue().isEmpty()) {
+                return false;
+            }
+
+            ChunkPtr chunk = cm->findIntersectingChunk(shardKey.getValue());
+            shard = grid.shardRegistry()->findIfExists(chunk->getShardId());
+        }
+
+        if (!shard) {
+            return false;
+        }
+
+        ShardConnection dbcon(shard->getConnString(), nss.ns(), cm);
+
+        string actualServer;
+        Message response;
+        try {
+            DBClientBase &c = dbcon.conn();
+            bool ok = c.call( r.m(), response, true , &actualServer );
+            uassert( 28774 , "mongos: error calling db", ok );
+            if (actualServer.empty()) {
+                actualServer = c.getServerAddress();
+            }
+        }
+        catch (const StaleConfigException& e) {
+            LOG(1) << "targeted query on " << nss.ns() << " found a stale version, retrying"
+                   << " through the general path" << causedBy(e);
+            dbcon.done();
+            return false;
+        }
+
+        {
+            QueryResult::View qr = response.singleData().view2ptr();
+            if ( qr.getResultFlags() & ResultFlag_ShardConfigStale ) {
+                dbcon.done();
+                return false;
+            }
+        }
+
+        dbcon.done();
+        r.reply( response , actualServer );
+
+        return true;
+    }
+
     void Strategy::queryOp( Request& r ) {
 
         verify( !NamespaceString( r.getns() ).isCommand() );
@@ -179,6 +262,10 @@ namespace mongo {
             return;
         }
 
+        if ( !_isSystemIndexes( q.ns ) && doTargetedQuery( r, qSpec ) ) {
+            return;
+        }
+
         ParallelSortClusteredCursor * cursor = new ParallelSortClusteredCursor( qSpec, CommandInfo() );
         verify( cursor );
 
@@ -32,15 +32,22 @@
 
 #include "mongo/s/write_ops/batch_write_exec.h"
 
+#include <algorithm>
+#include <deque>
+
 #include "mongo/base/error_codes.h"
-#include "mongo/base/owned_pointer_map.h"
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/dbclientinterface.h" // ConnectionString (header-only)
+#include "mongo/db/client_basic.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/rpc/metadata/trace_metadata.h"
 #include "mongo/s/client/multi_command_dispatch.h"
 #include "mongo/s/write_ops/batch_write_op.h"
 #include "mongo/s/write_ops/write_error_detail.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -60,13 +67,40 @@ namespace mongo {
 
     namespace {
 
+        // The most child batches sent to a host at once, before waiting for one of them to come
+        // back.  Only unordered writes keep more than one batch out for the same endpoint.
+        MONGO_EXPORT_SERVER_PARAMETER(internalBatchWriteMaxInFlightPerShard, int, 1);
+
+        // A child batch out on the network, and the time it has been out
+        struct PendingBatch {
+
+            explicit PendingBatch( TargetedWriteBatch* batch ) :
+                batch( batch ) {
+            }
+
+            // Owned by the childBatches of the round
+            TargetedWriteBatch* batch;
+            Timer timer;
+        };
+
         //
         // Map which allows associating ConnectionString hosts with TargetedWriteBatches
         // This is needed since the dispatcher only returns hosts with responses.
         //
 
+        typedef std::deque<PendingBatch> PendingBatchQueue;
+
         // TODO: Unordered map?
-        typedef OwnedPointerMap<ConnectionString, TargetedWriteBatch> OwnedHostBatchMap;
+        typedef std::map<ConnectionString, PendingBatchQueue> HostBatchQueueMap;
+
+        bool hasBatchForShard( const std::deque<TargetedWriteBatch*>& batches,
+                               const std::string& shardName ) {
+            for ( std::deque<TargetedWriteBatch*>::const_iterator it = batches.begin();
+                it != batches.end(); ++it ) {
+                if ( ( *it )->getEndpoint().shardName == shardName ) return true;
+            }
+            return false;
+        }
     }
 
     static void buildErrorFrom( const Status& status, WriteErrorDetail* error ) {
@@ -143,9 +177,11 @@ namespace mongo {
             // If we've already had a targeting error, we've refreshed the metadata once and can
             // record target errors definitively.
             bool recordTargetErrors = refreshedTargeter;
+            rpc::ScopedTraceSpan targetingSpan( ClientBasic::getCurrent(), "targeting" );
             Status targetStatus = batchOp.targetBatch( *_targeter,
                                                        recordTargetErrors,
                                                        &childBatches );
+            targetingSpan.finish( BSON( "nBatches" << static_cast<int>( childBatches.size() ) ) );
             if ( !targetStatus.isOK() ) {
                 // Don't do anything until a targeter refresh
                 _targeter->noteCouldNotTarget();
@@ -157,31 +193,41 @@ namespace mongo {
             //
             // Send all child batches
             //
+            // Up to internalBatchWriteMaxInFlightPerShard child batches are out on the network to
+            // each host at once, and a host gets its next batch as soon as a previous one comes
+            // back, without waiting for the other hosts.  Unordered writes are also targeted a
+            // few at a time, so the writes left over once a child batch is full are sent to the
+            // shards that answered instead of waiting for the next round.
+            //
 
-            size_t numSent = 0;
-            size_t numToSend = childBatches.size();
-            bool remoteMetadataChanging = false;
-            while ( numSent != numToSend ) {
+            // Batches not yet sent, in targeting order
+            std::deque<TargetedWriteBatch*> unsentBatches( childBatches.begin(),
+                                                           childBatches.end() );
+
+            // Batches out on the network, mapped by host in the order they were sent, which is
+            // the order the dispatcher returns their responses in
+            HostBatchQueueMap pendingBatches;
 
-                // Collect batches out on the network, mapped by endpoint
-                OwnedHostBatchMap ownedPendingBatches;
-                OwnedHostBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
+            const size_t maxInFlightPerHost =
+                static_cast<size_t>( std::max( 1, internalBatchWriteMaxInFlightPerShard ) );
+
+            bool canTargetMore = targetStatus.isOK() && !clientRequest.getOrdered();
+            bool remoteMetadataChanging = false;
+            while ( true ) {
 
                 //
                 // Send side
                 //
 
-                // Get as many batches as we can at once
-                for ( vector<TargetedWriteBatch*>::iterator it = childBatches.begin();
-                    it != childBatches.end(); ++it ) {
+                // Send every batch whose host has room for it
+                for ( std::deque<TargetedWriteBatch*>::iterator it = unsentBatches.begin();
+                    it != unsentBatches.end(); ) {
 
                     //
                     // Collect the info needed to dispatch our targeted batch
                     //
 
                     TargetedWriteBatch* nextBatch = *it;
-                    // If the batch is NULL, we sent it previously, so skip
-                    if ( nextBatch == NULL ) continue;
 
                     // Figure out what host we need to dispatch our targeted batch
                     ConnectionString shardHost;
@@ -204,16 +250,18 @@ namespace mongo {
                         batchOp.noteBatchError( *nextBatch, error );
 
                         // We're done with this batch
-                        // Clean up when we can't resolve a host
-                        delete *it;
-                        *it = NULL;
-                        --numToSend;
+                        it = unsentBatches.erase( it );
                         continue;
                     }
 
-                    // If we already have a batch for this host, wait until the next time
-                    OwnedHostBatchMap::MapType::iterator pendingIt = pendingBatches.find( shardHost );
-                    if ( pendingIt != pendingBatches.end() ) continue;
+                    // If the host has enough batches already, wait until one comes back
+                    // We'll only get several batches for the same host at once if we have
+                    // broadcast and non-broadcast endpoints for it, or if writes are pipelined.
+                    PendingBatchQueue& hostBatches = pendingBatches[shardHost];
+                    if ( hostBatches.size() >= maxInFlightPerHost ) {
+                        ++it;
+                        continue;
+                    }
 
                     //
                     // We now have all the info needed to dispatch the batch
@@ -232,87 +280,119 @@ namespace mongo {
 
                     _dispatcher->addCommand( shardHost, nss.db(), request );
 
-                    // Indicate we're done by setting the batch to NULL
-                    // We'll only get duplicate hostEndpoints if we have broadcast and non-broadcast
-                    // endpoints for the same host, so this should be pretty efficient without
-                    // moving stuff around.
-                    *it = NULL;
-
-                    // Recv-side is responsible for cleaning up the nextBatch when used
-                    pendingBatches.insert( make_pair( shardHost, nextBatch ) );
+                    hostBatches.push_back( PendingBatch( nextBatch ) );
+                    it = unsentBatches.erase( it );
                 }
 
                 // Send them all out
                 _dispatcher->sendAll();
-                numSent += pendingBatches.size();
+
+                // Every unsent batch waits for a host with a batch out, so this is the end of the
+                // round
+                if ( _dispatcher->numPending() == 0 ) {
+                    dassert( unsentBatches.empty() );
+                    break;
+                }
 
                 //
                 // Recv side
                 //
 
-                while ( _dispatcher->numPending() > 0 ) {
+                // Get the response
+                ConnectionString shardHost;
+                BatchedCommandResponse response;
+                Status dispatchStatus = _dispatcher->recvAny( &shardHost, &response );
 
-                    // Get the response
-                    ConnectionString shardHost;
-                    BatchedCommandResponse response;
-                    Status dispatchStatus = _dispatcher->recvAny( &shardHost, &response );
-
-                    // Get the TargetedWriteBatch to find where to put the response
-                    dassert( pendingBatches.find( shardHost ) != pendingBatches.end() );
-                    TargetedWriteBatch* batch = pendingBatches.find( shardHost )->second;
-
-                    if ( dispatchStatus.isOK() ) {
-
-                        TrackedErrors trackedErrors;
-                        trackedErrors.startTracking( ErrorCodes::StaleShardVersion );
-
-                        LOG( 4 ) << "write results received from " << shardHost.toString() << ": "
-                                 << response.toString() << endl;
-
-                        // Dispatch was ok, note response
-                        batchOp.noteBatchResponse( *batch, response, &trackedErrors );
-
-                        // Note if anything was stale
-                        const vector<ShardError*>& staleErrors =
-                            trackedErrors.getErrors( ErrorCodes::StaleShardVersion );
-
-                        if ( staleErrors.size() > 0 ) {
-                            noteStaleResponses( staleErrors, _targeter );
-                            ++_stats->numStaleBatches;
-                        }
-
-                        // Remember if the shard is actively changing metadata right now
-                        if ( isShardMetadataChanging( staleErrors ) ) {
-                            remoteMetadataChanging = true;
-                        }
-
-                        // Remember that we successfully wrote to this shard
-                        // NOTE: This will record lastOps for shards where we actually didn't update
-                        // or delete any documents, which preserves old behavior but is conservative
-                        _stats->noteWriteAt( shardHost,
-                                             response.isLastOpSet() ? 
-                                             response.getLastOp() : Timestamp(),
-                                             response.isElectionIdSet() ?
-                                             response.getElectionId() : OID());
-                    }
-                    else {
+                // Get the TargetedWriteBatch to find where to put the response
+                PendingBatchQueue& hostBatches = pendingBatches[shardHost];
+                dassert( !hostBatches.empty() );
+                TargetedWriteBatch* batch = hostBatches.front().batch;
+                _stats->noteBatchLatency( shardHost, hostBatches.front().timer.micros() );
+                hostBatches.pop_front();
 
-                        // Error occurred dispatching, note it
+                if ( dispatchStatus.isOK() ) {
 
-                        stringstream msg;
-                        msg << "write results unavailable from " << shardHost.toString()
-                            << causedBy( dispatchStatus.toString() );
+                    TrackedErrors trackedErrors;
+                    trackedErrors.startTracking( ErrorCodes::StaleShardVersion );
 
-                        WriteErrorDetail error;
-                        buildErrorFrom( Status( ErrorCodes::RemoteResultsUnavailable, msg.str() ),
-                                        &error );
+                    LOG( 4 ) << "write results received from " << shardHost.toString() << ": "
+                             << response.toString() << endl;
+
+                    // Dispatch was ok, note response
+                    batchOp.noteBatchResponse( *batch, response, &trackedErrors );
+
+                    // Note if anything was stale
+                    const vector<ShardError*>& staleErrors =
+                        trackedErrors.getErrors( ErrorCodes::StaleShardVersion );
 
-                        LOG( 4 ) << "unable to receive write results from " << shardHost.toString()
-                                 << causedBy( dispatchStatus.toString() ) << endl;
+                    if ( staleErrors.size() > 0 ) {
+                        noteStaleResponses( staleErrors, _targeter );
+                        ++_stats->numStaleBatches;
 
-                        batchOp.noteBatchError( *batch, error );
+                        // The targeter needs a refresh, so finish the round with what we have
+                        canTargetMore = false;
                     }
+
+                    // Remember if the shard is actively changing metadata right now
+                    if ( isShardMetadataChanging( staleErrors ) ) {
+                        remoteMetadataChanging = true;
+                    }
+
+                    // Remember that we successfully wrote to this shard
+                    // NOTE: This will record lastOps for shards where we actually didn't update
+                    // or delete any documents, which preserves old behavior but is conservative
+                    _stats->noteWriteAt( shardHost,
+                                         response.isLastOpSet() ?
+                                         response.getLastOp() : Timestamp(),
+                                         response.isElectionIdSet() ?
+                                         response.getElectionId() : OID());
+                }
+                else {
+
+                    // Error occurred dispatching, note it
+
+                    stringstream msg;
+                    msg << "write results unavailable from " << shardHost.toString()
+                        << causedBy( dispatchStatus.toString() );
+
+                    WriteErrorDetail error;
+                    buildErrorFrom( Status( ErrorCodes::RemoteResultsUnavailable, msg.str() ),
+                                    &error );
+
+                    LOG( 4 ) << "unable to receive write results from " << shardHost.toString()
+                             << causedBy( dispatchStatus.toString() ) << endl;
+
+                    batchOp.noteBatchError( *batch, error );
+                }
+
+                //
+                // Target more of the remaining unordered writes, unless the shard that answered
+                // still has batches to send
+                //
+
+                if ( !canTargetMore ||
+                     hasBatchForShard( unsentBatches, batch->getEndpoint().shardName ) ) {
+                    continue;
+                }
+
+                vector<TargetedWriteBatch*> nextBatches;
+                rpc::ScopedTraceSpan nextTargetingSpan( ClientBasic::getCurrent(), "targeting" );
+                Status nextTargetStatus = batchOp.targetBatch( *_targeter,
+                                                               recordTargetErrors,
+                                                               &nextBatches );
+                nextTargetingSpan.finish(
+                    BSON( "nBatches" << static_cast<int>( nextBatches.size() ) ) );
+                if ( !nextTargetStatus.isOK() ) {
+                    // Don't target anything else until a targeter refresh
+                    _targeter->noteCouldNotTarget();
+                    refreshedTargeter = true;
+                    ++_stats->numTargetErrors;
+                    dassert( nextBatches.size() == 0u );
                 }
+
+                canTargetMore = nextTargetStatus.isOK() && !nextBatches.empty();
+                childBatches.insert( childBatches.end(), nextBatches.begin(), nextBatches.end() );
+                unsentBatches.insert( unsentBatches.end(), nextBatches.begin(), nextBatches.end() );
             }
 
             ++rounds;
@@ -369,6 +449,17 @@ namespace mongo {
 
         batchOp.buildClientResponse( clientResponse );
 
+        if ( shouldLog( logger::LogSeverity::Debug( 2 ) ) ) {
+            const HostWriteLatencyMap& latencies = _stats->getBatchLatencies();
+            for ( HostWriteLatencyMap::const_iterator it = latencies.begin();
+                it != latencies.end(); ++it ) {
+                LOG( 2 ) << "write batch for " << clientRequest.getNS() << " sent "
+                         << it->second.numBatches << " child batches to " << it->first.toString()
+                         << " taking " << it->second.totalMicros / 1000 << "ms in total and "
+                         << it->second.maxMicros / 1000 << "ms at most" << endl;
+            }
+        }
+
         LOG( 4 ) << "finished execution of write batch"
                  << ( clientResponse->isErrDetailsSet() ? " with write errors" : "")
                  << ( clientResponse->isErrDetailsSet() &&
@@ -394,4 +485,16 @@ namespace mongo {
     const HostOpTimeMap& BatchWriteExecStats::getWriteOpTimes() const {
         return _writeOpTimes;
     }
+
+    void BatchWriteExecStats::noteBatchLatency(const ConnectionString& host,
+                                               long long micros) {
+        HostWriteLatency& latency = _batchLatencies[host];
+        ++latency.numBatches;
+        latency.totalMicros += micros;
+        latency.maxMicros = std::max(latency.maxMicros, micros);
+    }
+
+    const HostWriteLatencyMap& BatchWriteExecStats::getBatchLatencies() const {
+        return _batchLatencies;
+    }
 }
@@ -104,6 +104,16 @@ namespace mongo {
 
     typedef std::map<ConnectionString, HostOpTime> HostOpTimeMap;
 
+    // Round trip times of the child batches sent to a host
+    struct HostWriteLatency {
+        HostWriteLatency() : numBatches(0), totalMicros(0), maxMicros(0) {}
+        int numBatches;
+        long long totalMicros;
+        long long maxMicros;
+    };
+
+    typedef std::map<ConnectionString, HostWriteLatency> HostWriteLatencyMap;
+
     class BatchWriteExecStats {
     public:
 
@@ -115,6 +125,10 @@ namespace mongo {
 
         const HostOpTimeMap& getWriteOpTimes() const;
 
+        void noteBatchLatency(const ConnectionString& host, long long micros);
+
+        const HostWriteLatencyMap& getBatchLatencies() const;
+
         // Expose via helpers if this gets more complex
 
         // Number of round trips required for the batch
@@ -129,5 +143,6 @@ namespace mongo {
     private:
 
         HostOpTimeMap _writeOpTimes;
+        HostWriteLatencyMap _batchLatencies;
     };
 }
@@ -312,4 +312,57 @@ namespace {
         ASSERT_EQUALS( stats.numStaleBatches, 10 );
     }
 
+    TEST(BatchWriteExecTests, UnorderedPipelinedAcrossShards) {
+
+        //
+        // An unordered batch too big for one child batch per shard is sent in one round, each
+        // shard getting its next child batch as soon as the previous one comes back
+        //
+
+        NamespaceString nss( "foo.bar" );
+
+        ShardEndpoint endpointA( "shardA", ChunkVersion::IGNORED() );
+        ShardEndpoint endpointB( "shardB", ChunkVersion::IGNORED() );
+        vector<MockRange*> mockRanges;
+        mockRanges.push_back( new MockRange( endpointA,
+                                             nss,
+                                             BSON( "x" << MINKEY ),
+                                             BSON( "x" << 0 ) ) );
+        mockRanges.push_back( new MockRange( endpointB,
+                                             nss,
+                                             BSON( "x" << 0 ),
+                                             BSON( "x" << MAXKEY ) ) );
+
+        MockNSTargeter targeter;
+        targeter.init( mockRanges );
+        MockShardResolver resolver;
+        MockMultiWriteCommand dispatcher;
+        BatchWriteExec exec( &targeter, &resolver, &dispatcher );
+
+        // Alternate the shards, with 1500 writes for each
+        BatchedCommandRequest request( BatchedCommandRequest::BatchType_Insert );
+        request.setNS( nss.ns() );
+        request.setOrdered( false );
+        request.setWriteConcern( BSONObj() );
+        for ( int i = 0; i < 3000; ++i ) {
+            request.getInsertRequest()->addToDocuments( BSON( "x" << ( i % 2 ? 1 : -1 ) ) );
+        }
+
+        BatchedCommandResponse response;
+        exec.executeBatch( request, &response );
+        ASSERT( response.getOk() );
+        ASSERT( !response.isErrDetailsSet() );
+
+        const BatchWriteExecStats& stats = exec.getStats();
+        ASSERT_EQUALS( stats.numRounds, 1 );
+
+        const HostWriteLatencyMap& latencies = stats.getBatchLatencies();
+        ASSERT_EQUALS( latencies.size(), 2u );
+        for ( HostWriteLatencyMap::const_iterator it = latencies.begin(); it != latencies.end();
+            ++it ) {
+            ASSERT_EQUALS( it->second.numBatches, 2 );
+            ASSERT_GREATER_THAN_OR_EQUALS( it->second.totalMicros, it->second.maxMicros );
+        }
+    }
+
 } // unnamed namespace
@@ -40,10 +40,17 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/platform/unordered_set.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/exit.h"
 #include "mongo/util/file.h"
 #include "mongo/util/log.h"
 #include "mongo/util/text.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -56,9 +63,36 @@ namespace mongo {
 
     AtomicInt64 Scope::_lastVersion(1);
 
+    Counter64 ScriptEngine::scopesCreated;
+    Counter64 ScriptEngine::warmScopesUsed;
+    Counter64 ScriptEngine::functionsCompiled;
+    Counter64 ScriptEngine::functionCacheHits;
+
 namespace {
     // 2 GB is the largest support Javascript file size.
     const fileofs kMaxJsFileLength = fileofs(2) * 1024 * 1024 * 1024;
+
+    // Number of new scopes kept ready for getPooledScope, so that a burst of JS operations
+    // doesn't wait for their creation
+    int scriptingMinWarmScopes = 2;
+
+    class ExportedMinWarmScopesParameter : public ExportedServerParameter<int> {
+    public:
+        ExportedMinWarmScopesParameter() :
+            ExportedServerParameter<int>(ServerParameterSet::getGlobal(),
+                                         "scriptingMinWarmScopes",
+                                         &scriptingMinWarmScopes,
+                                         true,
+                                         true) {}
+
+        virtual Status validate(const int& potentialNewValue) {
+            if (potentialNewValue < 0 || potentialNewValue > 100) {
+                return Status(ErrorCodes::BadValue,
+                              "scriptingMinWarmScopes must be between 0 and 100");
+            }
+            return Status::OK();
+        }
+    } exportedMinWarmScopesParameter;
 }  // namespace
 
     ScriptEngine::ScriptEngine() : _scopeInitCallback() {
@@ -256,6 +290,15 @@ namespace {
         }
     }
 
+    int Scope::invokePredicate(ScriptingFunction func, const BSONObj& obj, int timeoutMs,
+                               bool* result) {
+        setObject("obj", obj);
+        const int err = invoke(func, 0, &obj, timeoutMs, false);
+        if (err == 0)
+            *result = getBoolean("__returnValue");
+        return err;
+    }
+
     ScriptingFunction Scope::createFunction(const char* code) {
         if (code[0] == '/' && code [1] == '*') {
             code += 2;
@@ -269,8 +312,11 @@ namespace {
         }
 
         FunctionCacheMap::iterator i = _cachedFunctions.find(code);
-        if (i != _cachedFunctions.end())
+        if (i != _cachedFunctions.end()) {
+            ScriptEngine::functionCacheHits.increment();
             return i->second;
+        }
+        ScriptEngine::functionsCompiled.increment();
         // NB: we calculate the function number for v8 so the cache can be utilized to
         //     lookup the source on an exception, but SpiderMonkey uses the value
         //     returned by JS_CompileFunction.
@@ -313,6 +359,8 @@ namespace {
 namespace {
     class ScopeCache {
     public:
+        ScopeCache() : _warmerStarted(false) {}
+
         void release(const string& poolName, const std::shared_ptr<Scope>& scope) {
             boost::lock_guard<boost::mutex> lk(_mutex);
 
@@ -320,6 +368,7 @@ namespace {
                 // make some room
                 log() << "Clearing all idle JS contexts due to out of memory" << endl;
                 _pools.clear();
+                _warm.clear();
                 return;
             }
 
@@ -353,7 +402,16 @@ namespace {
                 }
             }
 
-            return std::shared_ptr<Scope>();
+            std::shared_ptr<Scope> scope;
+            if (!_warm.empty()) {
+                // a scope which was never used belongs to no pool yet
+                scope = _warm.front();
+                _warm.pop_front();
+                scope->registerOperation(txn);
+                ScriptEngine::warmScopesUsed.increment();
+            }
+            _requestWarmingIfNeeded_inlock();
+            return scope;
         }
 
     private:
@@ -362,15 +420,68 @@ namespace {
             string poolName;
         };
 
+        void _requestWarmingIfNeeded_inlock() {
+            if (_warm.size() >= static_cast<size_t>(scriptingMinWarmScopes))
+                return;
+
+            if (!_warmerStarted) {
+                stdx::thread(stdx::bind(&ScopeCache::_warmLoop, this)).detach();
+                _warmerStarted = true;
+            }
+            _warmingRequested.notify_one();
+        }
+
+        /**
+         * Creates scopes in the background until there are scriptingMinWarmScopes of them. This
+         * doesn't start before the first getPooledScope, so processes which never run JS don't
+         * pay for it.
+         */
+        void _warmLoop() {
+            while (!inShutdown()) {
+                {
+                    boost::unique_lock<boost::mutex> lk(_mutex);
+                    while (_warm.size() >= static_cast<size_t>(scriptingMinWarmScopes) &&
+                           !inShutdown()) {
+                        _warmingRequested.wait_for(lk, kWarmingInterval);
+                    }
+                }
+
+                if (inShutdown()) {
+                    break;
+                }
+
+                try {
+                    std::shared_ptr<Scope> scope(globalScriptEngine->newScope());
+                    boost::lock_guard<boost::mutex> lk(_mutex);
+                    _warm.push_back(scope);
+                }
+                catch (const std::exception& ex) {
+                    warning() << "failed to create a JS scope in advance" << causedBy(ex);
+                    sleepsecs(1);
+                }
+            }
+        }
+
         // Note: if these numbers change, reconsider choice of datastructure for _pools
         static const unsigned kMaxPoolSize = 10;
         static const int kMaxScopeReuse = 10;
 
+        // How often the warming thread checks for shutdown when it has nothing to do
+        static const stdx::chrono::seconds kWarmingInterval;
+
         typedef std::deque<ScopeAndPool> Pools; // More-recently used Scopes are kept at the front.
         Pools _pools;    // protected by _mutex
+
+        // Scopes of no pool which were created ahead of need, protected by _mutex
+        std::deque<std::shared_ptr<Scope> > _warm;
+        bool _warmerStarted;
+        stdx::condition_variable _warmingRequested;
+
         mongo::mutex _mutex;
     };
 
+    const stdx::chrono::seconds ScopeCache::kWarmingInterval(10);
+
     ScopeCache scopeCache;
 } // anonymous namespace
 
@@ -427,6 +538,10 @@ namespace {
             return _real->invoke(func, args, recv, timeoutMs, ignoreReturn,
                                  readOnlyArgs, readOnlyRecv);
         }
+        int invokePredicate(ScriptingFunction func, const BSONObj& obj, int timeoutMs,
+                            bool* result) {
+            return _real->invokePredicate(func, obj, timeoutMs, result);
+        }
         bool exec(StringData code, const string& name, bool printResult, bool reportError,
                   bool assertOnError, int timeoutMs = 0) {
             return _real->exec(code, name, printResult, reportError, assertOnError, timeoutMs);
@@ -461,6 +576,7 @@ namespace {
         const string fullPoolName = db + scopeType;
         std::shared_ptr<Scope> s = scopeCache.tryAcquire(txn, fullPoolName);
         if (!s) {
+            // nothing pooled or warm: create the scope inline
             s.reset(newScope());
             s->registerOperation(txn);
         }
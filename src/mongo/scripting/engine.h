@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include "mongo/base/counter.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/atomic_word.h"
@@ -108,6 +109,14 @@ namespace mongo {
                            int timeoutMs = 0, bool ignoreReturn = false, bool readOnlyArgs = false,
                            bool readOnlyRecv = false) = 0;
 
+        /**
+         * Calls a predicate the way $where does: 'obj' is both the receiver and the global
+         * 'obj', and the truth of the return value goes to 'result'.
+         * @return 0 on success
+         */
+        virtual int invokePredicate(ScriptingFunction func, const BSONObj& obj, int timeoutMs,
+                                    bool* result);
+
         void invokeSafe(ScriptingFunction func, const BSONObj* args, const BSONObj* recv,
                         int timeoutMs = 0, bool ignoreReturn = false, bool readOnlyArgs = false,
                         bool readOnlyRecv = false) {
@@ -205,6 +214,7 @@ namespace mongo {
         virtual ~ScriptEngine();
 
         virtual Scope* newScope() {
+            scopesCreated.increment();
             return createScope();
         }
 
@@ -214,7 +224,8 @@ namespace mongo {
 
         static void setup();
 
-        /** gets a scope from the pool or a new one if pool is empty
+        /** gets a scope from the pool, or a warm one which hasn't been used yet, or a new one
+         * if both are empty
          * @param db The db name
          * @param scopeType A unique id to limit scope sharing.
          *                  This must include authenticated users.
@@ -240,6 +251,12 @@ namespace mongo {
 
         static std::string getInterpreterVersionString();
 
+        // reported by serverStatus under metrics.scripting
+        static Counter64 scopesCreated;
+        static Counter64 warmScopesUsed;
+        static Counter64 functionsCompiled;
+        static Counter64 functionCacheHits;
+
     protected:
         virtual Scope* createScope() = 0;
         void (*_scopeInitCallback)(Scope&);
@@ -1082,6 +1082,55 @@ namespace mongo {
         global->ForceSet(f, v8::Undefined(_isolate));
     }
 
+    v8::Local<v8::Value> V8Scope::callFunction(v8::Local<v8::Value> funcValue,
+                                               v8::Local<v8::Object> recv,
+                                               int nargs,
+                                               v8::Local<v8::Value>* args,
+                                               int timeoutMs) {
+        v8::TryCatch try_catch;
+
+        if (!nativeEpilogue()) {
+            _error = "JavaScript execution terminated";
+            error() << _error << endl;
+            uasserted(16711, _error);
+        }
+
+        if (timeoutMs)
+            // start the deadline timer for this script
+            _engine->getDeadlineMonitor()->startDeadline(this, timeoutMs);
+
+        v8::Local<v8::Value> result =
+                ((v8::Function*)(*funcValue))->Call(recv, nargs, nargs ? args : NULL);
+
+        if (timeoutMs)
+            // stop the deadline timer for this script
+            _engine->getDeadlineMonitor()->stopDeadline(this);
+
+        if (!nativePrologue()) {
+            _error = "JavaScript execution terminated";
+            error() << _error << endl;
+            uasserted(16712, _error);
+        }
+
+        // throw on error
+        checkV8ErrorState(result, try_catch);
+        return result;
+    }
+
+    int V8Scope::invokePredicate(ScriptingFunction func, const BSONObj& obj, int timeoutMs,
+                                 bool* result) {
+        // one entry into the isolate instead of one for each of setObject(), invoke() and
+        // getBoolean(), and no round trip of the result through __returnValue
+        V8_SIMPLE_HEADER
+        v8::Local<v8::Value> funcValue = _funcs[func-1].Get(_isolate);
+
+        getGlobal()->ForceSet(strLitToV8("obj"), mongoToLZV8(obj, true));
+        v8::Local<v8::Object> v8recv = mongoToLZV8(obj, false);
+
+        *result = callFunction(funcValue, v8recv, 0, NULL, timeoutMs)->BooleanValue();
+        return 0;
+    }
+
     int V8Scope::invoke(ScriptingFunction func, const BSONObj* argsObject, const BSONObj* recv,
                         int timeoutMs, bool ignoreReturn, bool readOnlyArgs, bool readOnlyRecv) {
         V8_SIMPLE_HEADER
@@ -1110,30 +1159,7 @@ namespace mongo {
         else
             v8recv = getGlobal();
 
-        if (!nativeEpilogue()) {
-            _error = "JavaScript execution terminated";
-            error() << _error << endl;
-            uasserted(16711, _error);
-        }
-
-        if (timeoutMs)
-            // start the deadline timer for this script
-            _engine->getDeadlineMonitor()->startDeadline(this, timeoutMs);
-
-        result = ((v8::Function*)(*funcValue))->Call(v8recv, nargs, nargs ? args : NULL);
-
-        if (timeoutMs)
-            // stop the deadline timer for this script
-            _engine->getDeadlineMonitor()->stopDeadline(this);
-
-        if (!nativePrologue()) {
-            _error = "JavaScript execution terminated";
-            error() << _error << endl;
-            uasserted(16712, _error);
-        }
-
-        // throw on error
-        checkV8ErrorState(result, try_catch);
+        result = callFunction(funcValue, v8recv, nargs, args, timeoutMs);
 
         if (!ignoreReturn) {
             v8::Local<v8::Object> resultObject = result->ToObject();
@@ -227,6 +227,9 @@ namespace mongo {
                            int timeoutMs = 0, bool ignoreReturn = false,
                            bool readOnlyArgs = false, bool readOnlyRecv = false);
 
+        virtual int invokePredicate(ScriptingFunction func, const BSONObj& obj, int timeoutMs,
+                                    bool* result);
+
         virtual bool exec(StringData code, const std::string& name, bool printResult,
                           bool reportError, bool assertOnError, int timeoutMs);
 
@@ -422,6 +425,15 @@ namespace mongo {
          */
         bool nativeEpilogue();
 
+        /**
+         * Calls a function under the deadline of 'timeoutMs', throwing if it fails.
+         */
+        v8::Local<v8::Value> callFunction(v8::Handle<v8::Value> funcValue,
+                                          v8::Handle<v8::Object> recv,
+                                          int nargs,
+                                          v8::Handle<v8::Value>* args,
+                                          int timeoutMs);
+
         /**
          * Create a new function; primarily used for BSON/V8 conversion.
          */
@@ -38,6 +38,8 @@
 
 #include <boost/noncopyable.hpp>
 #include <boost/thread/thread.hpp>
+#include <cmath>
+#include <fstream>
 #include <iostream>
 
 #include "mongo/db/namespace_string.h"
@@ -88,11 +90,20 @@ namespace mongo {
     void BenchRunEventCounter::reset() {
         _numEvents = 0;
         _totalTimeMicros = 0;
+        _maxTimeMicros = 0;
+        _latencies.reset();
     }
 
     void BenchRunEventCounter::updateFrom(const BenchRunEventCounter &other) {
         _numEvents += other._numEvents;
         _totalTimeMicros += other._totalTimeMicros;
+        _maxTimeMicros = std::max(_maxTimeMicros, other._maxTimeMicros);
+        _latencies.merge(other._latencies);
+    }
+
+    void BenchRunEventCounter::appendLatencies(BSONObjBuilder* builder) const {
+        builder->append("maxMicros", _maxTimeMicros);
+        _latencies.append(builder);
     }
 
     BenchRunStats::BenchRunStats() {
@@ -112,6 +123,7 @@ namespace mongo {
         queryCounter.reset();
 
         trappedErrors.clear();
+        opsPerInterval.clear();
     }
 
     void BenchRunStats::updateFrom(const BenchRunStats &other) {
@@ -127,6 +139,11 @@ namespace mongo {
 
         for (size_t i = 0; i < other.trappedErrors.size(); ++i)
             trappedErrors.push_back(other.trappedErrors[i]);
+
+        if (other.opsPerInterval.size() > opsPerInterval.size())
+            opsPerInterval.resize(other.opsPerInterval.size(), 0);
+        for (size_t i = 0; i < other.opsPerInterval.size(); ++i)
+            opsPerInterval[i] += other.opsPerInterval[i];
     }
 
     BenchRunConfig::BenchRunConfig() {
@@ -155,6 +172,10 @@ namespace mongo {
         throwGLE = false;
         breakOnTrap = true;
         randomSeed = 1314159265358979323;
+        throughputIntervalSeconds = 1;
+        reportFile = "";
+        opsPerSecond = 0;
+        arrivals = CONSTANT_ARRIVALS;
     }
 
     BenchRunConfig *BenchRunConfig::createFromBson( const BSONObj &args ) {
@@ -191,6 +212,26 @@ namespace mongo {
             this->throwGLE = args["throwGLE"].trueValue();
         if ( ! args["breakOnTrap"].eoo() )
             this->breakOnTrap = args["breakOnTrap"].trueValue();
+        if ( args["throughputIntervalSeconds"].isNumber() ) {
+            this->throughputIntervalSeconds = args["throughputIntervalSeconds"].number();
+            uassert(28781, "throughputIntervalSeconds can't be negative",
+                    this->throughputIntervalSeconds >= 0);
+        }
+        if ( args["reportFile"].type() == String )
+            this->reportFile = args["reportFile"].String();
+        if ( args["opsPerSecond"].isNumber() ) {
+            this->opsPerSecond = args["opsPerSecond"].number();
+            uassert(28782, "opsPerSecond can't be negative", this->opsPerSecond >= 0);
+        }
+        if ( ! args["arrivals"].eoo() ) {
+            const std::string arrivals = args["arrivals"].str();
+            if ( arrivals == "constant" )
+                this->arrivals = CONSTANT_ARRIVALS;
+            else if ( arrivals == "poisson" )
+                this->arrivals = POISSON_ARRIVALS;
+            else
+                uasserted(28783, "arrivals must be \"constant\" or \"poisson\"");
+        }
 
         uassert(16164, "loopCommands config not supported", args["loopCommands"].eoo());
 
@@ -337,12 +378,48 @@ namespace mongo {
         return _brState->shouldWorkerFinish();
     }
 
+    long long BenchRunWorker::waitForNextSend(const Timer& timer,
+                                              double* nextSendMicros,
+                                              PseudoRandom* rng) {
+        // sleep in short steps, so that a low rate doesn't keep the worker from stopping
+        const long long kMaxSleepMicros = 100 * 1000;
+        long long now = timer.micros();
+        while (now < *nextSendMicros) {
+            if (shouldStop())
+                return -1;
+            sleepmicros(std::min(static_cast<long long>(*nextSendMicros) - now, kMaxSleepMicros));
+            now = timer.micros();
+        }
+        const long long lateMicros = now - static_cast<long long>(*nextSendMicros);
+
+        // each worker takes an equal share of the rate
+        const double meanGapMicros = 1000 * 1000 * _config->parallel / _config->opsPerSecond;
+        if (_config->arrivals == BenchRunConfig::POISSON_ARRIVALS) {
+            // uniform in (0, 1) from the top 53 bits
+            const double uniform =
+                ((static_cast<uint64_t>(rng->nextInt64()) >> 11) + 0.5) / (1ULL << 53);
+            *nextSendMicros += -std::log(uniform) * meanGapMicros;
+        }
+        else {
+            *nextSendMicros += meanGapMicros;
+        }
+        return lateMicros;
+    }
+
     void doNothing(const BSONObj&) { }
 
     void BenchRunWorker::generateLoadOnConnection( DBClientBase* conn ) {
         verify( conn );
         long long count = 0;
         mongo::Timer timer;
+        const long long throughputIntervalMicros =
+            static_cast<long long>(_config->throughputIntervalSeconds * 1000 * 1000);
+
+        // with a target rate, when the next operation is due and how late the current one is
+        const bool openLoop = _config->opsPerSecond > 0;
+        double nextSendMicros = 0;
+        long long lateMicros = 0;
+        PseudoRandom arrivalRandom(static_cast<int64_t>(_randomSeed + _id));
 
         BsonTemplateEvaluator bsonTemplateEvaluator(_randomSeed);
         invariant(bsonTemplateEvaluator.setId(_id) == BsonTemplateEvaluator::StatusSuccess);
@@ -365,6 +442,12 @@ namespace mongo {
                 string ns = e["ns"].String();
                 string op = e["op"].String();
 
+                // setting a variable isn't an operation on the server, so takes no turn
+                if ( openLoop && op != "let" ) {
+                    lateMicros = waitForNextSend(timer, &nextSendMicros, &arrivalRandom);
+                    if ( lateMicros < 0 ) break;
+                }
+
                 int delay = e["delay"].eoo() ? 0 : e["delay"].Int();
 
                 // Let's default to writeCmd == false.
@@ -408,7 +491,7 @@ namespace mongo {
 
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.findOneCounter);
+                            BenchRunEventTrace _bret(&_stats.findOneCounter, lateMicros);
                             result = conn->findOne( ns , fixQuery( e["query"].Obj(),
                                                                    bsonTemplateEvaluator ) );
                         }
@@ -463,12 +546,12 @@ namespace mongo {
 
                         // use special query function for exhaust query option
                         if (options & QueryOption_Exhaust) {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, lateMicros);
                             stdx::function<void (const BSONObj&)> castedDoNothing(doNothing);
                             count =  conn->query(castedDoNothing, ns, fixedQuery, &filter, options);
                         }
                         else {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, lateMicros);
                             cursor = conn->query(ns, fixedQuery, limit, skip, &filter, options,
                                                  batchSize);
                             count = cursor->itcount();
@@ -504,7 +587,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
 
                         {
-                            BenchRunEventTrace _bret(&_stats.updateCounter);
+                            BenchRunEventTrace _bret(&_stats.updateCounter, lateMicros);
                             BSONObj query = fixQuery(queryOrginal, bsonTemplateEvaluator);
                             BSONObj update = fixQuery(updateOriginal, bsonTemplateEvaluator);
 
@@ -556,7 +639,7 @@ namespace mongo {
                         BSONObj result;
 
                         {
-                            BenchRunEventTrace _bret(&_stats.insertCounter);
+                            BenchRunEventTrace _bret(&_stats.insertCounter, lateMicros);
 
                             BSONObj insertDoc = fixQuery(e["doc"].Obj(), bsonTemplateEvaluator);
 
@@ -605,7 +688,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.deleteCounter);
+                            BenchRunEventTrace _bret(&_stats.deleteCounter, lateMicros);
                             BSONObj predicate = fixQuery(query, bsonTemplateEvaluator);
                             if (useWriteCmd) {
 
@@ -705,6 +788,9 @@ namespace mongo {
                     _stats.errCount++;
                 }
 
+                if (throughputIntervalMicros > 0)
+                    _stats.countOpInInterval(timer.micros(), throughputIntervalMicros);
+
                 if (++count % 100 == 0 && !useWriteCmd) {
                     conn->getLastError();
                 }
@@ -871,6 +957,15 @@ namespace mongo {
                         static_cast<double>(counter.getTotalTimeMicros()) / counter.getNumEvents());
      }
 
+     static void appendLatenciesIfAvailable(
+             BSONObjBuilder* buf, StringData name, const BenchRunEventCounter &counter) {
+
+         if (counter.getNumEvents() > 0) {
+             BSONObjBuilder latencies(buf->subobjStart(name));
+             counter.appendLatencies(&latencies);
+         }
+     }
+
      BSONObj BenchRunner::finish( BenchRunner* runner ) {
 
          runner->stop();
@@ -898,6 +993,23 @@ namespace mongo {
          appendAverageMicrosIfAvailable(buf, "updateLatencyAverageMicros", stats.updateCounter);
          appendAverageMicrosIfAvailable(buf, "queryLatencyAverageMicros", stats.queryCounter);
 
+         {
+             BSONObjBuilder latencies(buf.subobjStart("latencies"));
+             appendLatenciesIfAvailable(&latencies, "findOne", stats.findOneCounter);
+             appendLatenciesIfAvailable(&latencies, "insert", stats.insertCounter);
+             appendLatenciesIfAvailable(&latencies, "delete", stats.deleteCounter);
+             appendLatenciesIfAvailable(&latencies, "update", stats.updateCounter);
+             appendLatenciesIfAvailable(&latencies, "query", stats.queryCounter);
+         }
+
+         if (runner->config().throughputIntervalSeconds > 0) {
+             BSONObjBuilder throughput(buf.subobjStart("throughput"));
+             throughput.append("intervalSeconds", runner->config().throughputIntervalSeconds);
+             BSONArrayBuilder ops(throughput.subarrayStart("ops"));
+             for (size_t i = 0; i < stats.opsPerInterval.size(); i++)
+                 ops.append(static_cast<long long>(stats.opsPerInterval[i]));
+         }
+
          {
              BSONObjIterator i( after );
              while ( i.more() ) {
@@ -911,6 +1023,14 @@ namespace mongo {
 
          BSONObj zoo = buf.obj();
 
+         if (!runner->config().reportFile.empty()) {
+             const std::string& path = runner->config().reportFile;
+             std::ofstream report(path.c_str(), std::ios::out | std::ios::trunc);
+             report << zoo.jsonString(Strict, 1) << endl;
+             if (!report.good())
+                 warning() << "couldn't write the benchRun report to " << path << endl;
+         }
+
          delete runner;
          return zoo;
      }
@@ -36,7 +36,9 @@
 
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/random.h"
 #include "mongo/util/timer.h"
 
 namespace pcrecpp {
@@ -103,6 +105,31 @@ namespace mongo {
         /// Base random seed for threads
         int64_t randomSeed;
 
+        /**
+         * Length of the intervals that the operations of all threads are counted in, for the
+         * "throughput" series of the result. Zero leaves the series out.
+         */
+        double throughputIntervalSeconds;
+
+        /// If set, the result is also written to this file as JSON.
+        std::string reportFile;
+
+        /**
+         * Target rate of operations per second, shared by all threads. Zero runs closed loop,
+         * where each thread sends its next operation as soon as the previous one returned.
+         *
+         * Otherwise each thread sends its operations on a schedule, and their latencies count
+         * from the scheduled time. An operation that has to wait for a slow one before it can be
+         * sent is then reported with that wait, rather than as if it hadn't been due yet.
+         */
+        double opsPerSecond;
+
+        enum Arrivals {
+            CONSTANT_ARRIVALS, // equally spaced
+            POISSON_ARRIVALS // exponentially distributed gaps, with the same mean
+        };
+        Arrivals arrivals;
+
         bool hideResults;
         bool handleErrors;
         bool hideErrors;
@@ -160,6 +187,9 @@ namespace mongo {
         void countOne(long long timeMicros) {
             ++_numEvents;
             _totalTimeMicros += timeMicros;
+            _latencies.record(timeMicros);
+            if (timeMicros > _maxTimeMicros)
+                _maxTimeMicros = timeMicros;
         }
 
         /**
@@ -172,9 +202,17 @@ namespace mongo {
          */
         unsigned long long getNumEvents() const { return _numEvents; }
 
+        /**
+         * Appends the latency percentiles and histogram of the observed events, and the longest
+         * of them as "maxMicros".
+         */
+        void appendLatencies(BSONObjBuilder* builder) const;
+
     private:
         unsigned long long _numEvents;
         long long _totalTimeMicros;
+        long long _maxTimeMicros;
+        LatencyHistogram _latencies;
     };
 
     /**
@@ -192,18 +230,24 @@ namespace mongo {
      */
     class BenchRunEventTrace : private boost::noncopyable {
     public:
-        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter) {
+        /**
+         * "lateMicros" is added to the measured duration, for events which were due to start
+         * that long ago.
+         */
+        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter, long long lateMicros = 0) {
             initialize(eventCounter, eventCounter, false);
+            _lateMicros = lateMicros;
         }
 
         BenchRunEventTrace(BenchRunEventCounter *successCounter,
                            BenchRunEventCounter *failCounter,
                            bool defaultToFailure=true) {
             initialize(successCounter, failCounter, defaultToFailure);
+            _lateMicros = 0;
         }
 
         ~BenchRunEventTrace() {
-            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros());
+            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros() + _lateMicros);
         }
 
         void succeed() { _succeeded = true; }
@@ -219,6 +263,7 @@ namespace mongo {
         }
 
         Timer _timer;
+        long long _lateMicros;
         BenchRunEventCounter *_successCounter;
         BenchRunEventCounter *_failCounter;
         bool _succeeded;
@@ -236,6 +281,16 @@ namespace mongo {
 
         void updateFrom( const BenchRunStats &other );
 
+        /**
+         * Counts one operation of any type in the interval that "elapsedMicros" falls in.
+         */
+        void countOpInInterval(long long elapsedMicros, long long intervalMicros) {
+            const size_t interval = elapsedMicros / intervalMicros;
+            if (interval >= opsPerInterval.size())
+                opsPerInterval.resize(interval + 1, 0);
+            ++opsPerInterval[interval];
+        }
+
         bool error;
         unsigned long long errCount;
 
@@ -247,6 +302,9 @@ namespace mongo {
 
         std::map<std::string, long long> opcounters;
         std::vector<BSONObj> trappedErrors;
+
+        // operations completed in each throughputIntervalSeconds since the workers started
+        std::vector<unsigned long long> opsPerInterval;
     };
 
     /**
@@ -353,6 +411,15 @@ namespace mongo {
         /// Predicate, used to decide whether or not it's time to terminate the worker.
         bool shouldStop() const;
 
+        /**
+         * With a target rate, waits until the next operation is due, "timer" having started
+         * with the worker, and schedules the one after it.
+         *
+         * @return how late, in microseconds, the operation is sent, or -1 if the worker should
+         * stop instead.
+         */
+        long long waitForNextSend(const Timer& timer, double* nextSendMicros, PseudoRandom* rng);
+
         size_t _id;
         const BenchRunConfig *_config;
         BenchRunState *_brState;
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * ftdcdump prints the diagnostic data samples that mongod writes to the diagnostic.data
+ * directory of its dbpath, one sample per line as extended JSON.
+ *
+ *     ftdcdump [--metadata] <file or directory>...
+ *
+ * A directory is read oldest file first, ending with the samples of its interim file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mongo/db/ftdc/ftdc_compressor.h"
+#include "mongo/db/ftdc/ftdc_file_manager.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/quick_exit.h"
+
+using namespace mongo;
+
+namespace {
+
+    namespace fs = boost::filesystem;
+
+    void usage() {
+        std::cerr << "usage: ftdcdump [--metadata] <file or directory>..." << std::endl;
+        std::cerr << "prints the samples of mongod diagnostic data files as extended JSON"
+                  << std::endl;
+        std::cerr << "  --metadata  also print the document describing the server at the start"
+                  << " of each file" << std::endl;
+    }
+
+    /**
+     * Prints the samples of "file". Returns false if any of it could not be read.
+     */
+    bool dumpFile(const fs::path& file, bool printMetadata) {
+        std::vector<BSONObj> docs;
+        Status status = readFTDCFile(file, &docs);
+
+        for (const BSONObj& doc : docs) {
+            const int type = doc["type"].numberInt();
+            if (type == static_cast<int>(FTDCType::kMetadata)) {
+                if (printMetadata) {
+                    std::cout << doc.jsonString(Strict) << std::endl;
+                }
+                continue;
+            }
+            if (type != static_cast<int>(FTDCType::kMetricChunk)) {
+                continue;
+            }
+
+            auto samples = decompressFTDCChunk(doc);
+            if (!samples.isOK()) {
+                std::cerr << file.string() << ": " << samples.getStatus() << std::endl;
+                status = samples.getStatus();
+                continue;
+            }
+            for (const BSONObj& sample : samples.getValue()) {
+                std::cout << sample.jsonString(Strict) << std::endl;
+            }
+        }
+
+        if (!status.isOK()) {
+            std::cerr << status << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool dumpPath(const fs::path& path, bool printMetadata) {
+        if (!fs::is_directory(path)) {
+            return dumpFile(path, printMetadata);
+        }
+
+        bool ok = true;
+        for (const fs::path& file : FTDCFileManager::listFiles(path)) {
+            ok = dumpFile(file, printMetadata) && ok;
+        }
+        const fs::path interim = path / FTDCFileManager::kInterimFileName;
+        if (fs::exists(interim)) {
+            ok = dumpFile(interim, printMetadata) && ok;
+        }
+        return ok;
+    }
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    bool printMetadata = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--metadata") {
+            printMetadata = true;
+        }
+        else if (arg == "--help" || arg == "-h" || (!arg.empty() && arg[0] == '-')) {
+            usage();
+            quickExit(arg == "--help" || arg == "-h" ? 0 : 2);
+        }
+        else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        usage();
+        quickExit(2);
+    }
+
+    bool ok = true;
+    for (const std::string& path : paths) {
+        ok = dumpPath(path, printMetadata) && ok;
+    }
+    quickExit(ok ? 0 : 1);
+}
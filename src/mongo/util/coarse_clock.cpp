@@ -0,0 +1,74 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/coarse_clock.h"
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/compiler.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+namespace {
+
+    // Zero until the clock thread runs
+    AtomicInt64 coarseNowMillis;
+
+    void coarseClockThread() {
+        setThreadName("coarseClock");
+        while (true) {
+            coarseNowMillis.store(curTimeMillis64());
+            sleepmillis(CoarseClock::kResolutionMillis);
+        }
+    }
+
+} // namespace
+
+    long long CoarseClock::nowMillis() {
+        const long long now = coarseNowMillis.loadRelaxed();
+        if (MONGO_unlikely(now == 0)) {
+            return curTimeMillis64();
+        }
+        return now;
+    }
+
+    void CoarseClock::start() {
+        invariant(coarseNowMillis.load() == 0);
+        coarseNowMillis.store(curTimeMillis64());
+
+        boost::thread thread(coarseClockThread);
+        thread.detach();
+    }
+
+}  // namespace mongo
@@ -0,0 +1,62 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+namespace mongo {
+
+    /**
+     * A process-wide wall clock with millisecond units, which a background thread refreshes every
+     * kResolutionMillis, so reading it is a single atomic load rather than a system call.
+     *
+     * Until start() is called, for example in tools and unit tests, nowMillis() reads the precise
+     * clock instead.
+     */
+    class CoarseClock {
+    public:
+        static const int kResolutionMillis = 10;
+
+        /**
+         * An upper bound on how far nowMillis() is behind curTimeMillis64(), unless the clock thread
+         * is kept from running for longer than that.
+         */
+        static const int kMaxLagMillis = 2 * kResolutionMillis;
+
+        /**
+         * Milliseconds since the epoch, which may be behind curTimeMillis64() by up to
+         * kMaxLagMillis.
+         */
+        static long long nowMillis();
+
+        /**
+         * Starts the thread which refreshes the clock. Must be called at most once.
+         */
+        static void start();
+    };
+
+}  // namespace mongo
@@ -0,0 +1,204 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/priority_ticketholder.h"
+
+#include <algorithm>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    namespace {
+
+        // Indexed by AdmissionPriority.
+        const char* const kPriorityNames[kNumAdmissionPriorities] = {
+            "system",
+            "interactive",
+            "batch",
+        };
+
+        // How far admitting one waiter advances its lane's pass. The lane weights are 16, 4 and
+        // 1, and the strides are inversely proportional to them.
+        const unsigned long long kStrides[kNumAdmissionPriorities] = {1, 4, 16};
+
+    }  // namespace
+
+    StringData admissionPriorityName(AdmissionPriority priority) {
+        return kPriorityNames[static_cast<int>(priority)];
+    }
+
+    bool parseAdmissionPriority(StringData name, AdmissionPriority* priority) {
+        for (int i = 0; i < kNumAdmissionPriorities; i++) {
+            if (name == kPriorityNames[i]) {
+                *priority = static_cast<AdmissionPriority>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct PriorityTicketHolder::Waiter {
+        stdx::condition_variable admittedCV;
+        bool admitted = false;
+    };
+
+    PriorityTicketHolder::PriorityTicketHolder(int num)
+        : _outof(num),
+          _available(num),
+          _virtualTime(0) {
+        std::fill(_pass, _pass + kNumAdmissionPriorities, 0);
+    }
+
+    PriorityTicketHolder::~PriorityTicketHolder() {
+        for (int i = 0; i < kNumAdmissionPriorities; i++) {
+            invariant(_queues[i].empty());
+        }
+    }
+
+    bool PriorityTicketHolder::tryAcquire() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_available <= 0) {
+            return false;
+        }
+        _available--;
+        return true;
+    }
+
+    void PriorityTicketHolder::waitForTicket(AdmissionPriority priority) {
+        const int lane = static_cast<int>(priority);
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+
+        if (_available > 0) {
+            _available--;
+            _stats[lane].admitted++;
+            return;
+        }
+
+        Timer queuedTimer;
+        Waiter waiter;
+        if (_queues[lane].empty()) {
+            _pass[lane] = std::max(_pass[lane], _virtualTime);
+        }
+        _queues[lane].push_back(&waiter);
+        _stats[lane].queued++;
+
+        // The ticket is handed over by _admitWaiters_inlock, so there is nothing to take here.
+        while (!waiter.admitted) {
+            waiter.admittedCV.wait(lk);
+        }
+
+        _stats[lane].queued--;
+        _stats[lane].admitted++;
+        _stats[lane].queuedMicros += queuedTimer.micros();
+    }
+
+    void PriorityTicketHolder::release() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _available++;
+        _admitWaiters_inlock();
+    }
+
+    void PriorityTicketHolder::release(long long heldMicros) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _holdStats.released++;
+        _holdStats.heldMicros += heldMicros;
+        _available++;
+        _admitWaiters_inlock();
+    }
+
+    Status PriorityTicketHolder::resize(int newSize) {
+        if (newSize <= 0) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "Number of tickets has to be > 0; given " << newSize);
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _available += newSize - _outof;
+        _outof = newSize;
+        _admitWaiters_inlock();
+        return Status::OK();
+    }
+
+    void PriorityTicketHolder::_admitWaiters_inlock() {
+        while (_available > 0) {
+            int lane = -1;
+            for (int i = 0; i < kNumAdmissionPriorities; i++) {
+                // Ties go to the higher priority lane.
+                if (!_queues[i].empty() && (lane < 0 || _pass[i] < _pass[lane])) {
+                    lane = i;
+                }
+            }
+            if (lane < 0) {
+                return;
+            }
+
+            Waiter* waiter = _queues[lane].front();
+            _queues[lane].pop_front();
+            _virtualTime = _pass[lane];
+            _pass[lane] += kStrides[lane];
+            _available--;
+
+            // Notify while still holding the mutex: the waiter lives on its thread's stack and
+            // may be destroyed as soon as that thread can observe "admitted".
+            waiter->admitted = true;
+            waiter->admittedCV.notify_one();
+        }
+    }
+
+    int PriorityTicketHolder::available() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return std::max(_available, 0);
+    }
+
+    int PriorityTicketHolder::used() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _outof - _available;
+    }
+
+    int PriorityTicketHolder::outof() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _outof;
+    }
+
+    PriorityTicketHolder::LaneStats PriorityTicketHolder::getLaneStats(
+            AdmissionPriority priority) const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _stats[static_cast<int>(priority)];
+    }
+
+    PriorityTicketHolder::HoldStats PriorityTicketHolder::getHoldStats() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _holdStats;
+    }
+
+}  // namespace mongo
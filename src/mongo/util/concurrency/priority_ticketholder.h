@@ -0,0 +1,192 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    /**
+     * The lanes an operation can queue in when waiting for a PriorityTicketHolder ticket, from
+     * highest to lowest priority.
+     */
+    enum class AdmissionPriority {
+        kSystem,        // Replication and other internal work.
+        kInteractive,   // Latency sensitive client operations. The default for clients.
+        kBatch,         // Analytic scans and other throughput oriented client operations.
+    };
+
+    const int kNumAdmissionPriorities = 3;
+
+    /**
+     * Returns the name clients use for "priority", e.g. "interactive".
+     */
+    StringData admissionPriorityName(AdmissionPriority priority);
+
+    /**
+     * Parses a name returned by admissionPriorityName(). Returns false if "name" is unknown.
+     */
+    bool parseAdmissionPriority(StringData name, AdmissionPriority* priority);
+
+    /**
+     * A counting semaphore like TicketHolder, where waiters queue in one lane per
+     * AdmissionPriority and free tickets are shared between the lanes by weighted fair queuing.
+     *
+     * While tickets are available they are handed out immediately, whatever the priority. Once
+     * they run out, each released ticket goes to the head of the lane whose virtual pass is
+     * lowest, and admitting a waiter advances its lane's pass by a stride inversely proportional
+     * to the lane's weight. Under contention the system, interactive and batch lanes therefore
+     * get tickets in the ratio 16:4:1, so a flood of batch work slows itself down rather than
+     * starving the other lanes, and no lane is ever starved completely. A lane which was idle
+     * starts again from the current virtual time, rather than from the credit it built up while
+     * idle.
+     */
+    class PriorityTicketHolder {
+        MONGO_DISALLOW_COPYING(PriorityTicketHolder);
+    public:
+        struct LaneStats {
+            int queued = 0;             // Waiters currently queued in this lane.
+            long long admitted = 0;     // Tickets handed out to this lane, with or without waiting.
+            long long queuedMicros = 0; // Total time waiters in this lane spent queued.
+        };
+
+        struct HoldStats {
+            long long released = 0;     // Tickets released through release(heldMicros).
+            long long heldMicros = 0;   // Total time those tickets were held.
+        };
+
+        explicit PriorityTicketHolder(int num);
+        ~PriorityTicketHolder();
+
+        /**
+         * Takes a ticket if one is free, without waiting.
+         */
+        bool tryAcquire();
+
+        /**
+         * Takes a ticket, queueing in the lane for "priority" until one is available.
+         */
+        void waitForTicket(AdmissionPriority priority);
+
+        void release();
+
+        /**
+         * Like release(), and also accounts for the ticket having been held for "heldMicros".
+         */
+        void release(long long heldMicros);
+
+        /**
+         * Changes the number of tickets. When shrinking below the number in use, tickets are
+         * only handed out again once enough of them have been released.
+         */
+        Status resize(int newSize);
+
+        int available() const;
+
+        int used() const;
+
+        int outof() const;
+
+        LaneStats getLaneStats(AdmissionPriority priority) const;
+
+        HoldStats getHoldStats() const;
+
+    private:
+        struct Waiter;
+
+        /**
+         * Hands free tickets to queued waiters, in weighted fair order.
+         */
+        void _admitWaiters_inlock();
+
+        mutable stdx::mutex _mutex;
+
+        int _outof;
+
+        // Can go negative after a resize to fewer tickets than are in use. Only positive when no
+        // waiters are queued.
+        int _available;
+
+        std::deque<Waiter*> _queues[kNumAdmissionPriorities];
+
+        // Virtual time at which each lane's next waiter is due, and the pass of the last admitted
+        // waiter.
+        unsigned long long _pass[kNumAdmissionPriorities];
+        unsigned long long _virtualTime;
+
+        LaneStats _stats[kNumAdmissionPriorities];
+        HoldStats _holdStats;
+    };
+
+    /**
+     * Releases a PriorityTicketHolder ticket when it goes out of scope, like
+     * TicketHolderReleaser, and reports how long the ticket was held to the holder.
+     */
+    class PriorityTicketHolderReleaser {
+        MONGO_DISALLOW_COPYING(PriorityTicketHolderReleaser);
+    public:
+        PriorityTicketHolderReleaser() : _holder(NULL), _acquiredMicros(0) { }
+
+        explicit PriorityTicketHolderReleaser(PriorityTicketHolder* holder)
+            : _holder(holder),
+              _acquiredMicros(curTimeMicros64()) { }
+
+        ~PriorityTicketHolderReleaser() {
+            _release();
+        }
+
+        bool hasTicket() const { return _holder != NULL; }
+
+        void reset(PriorityTicketHolder* holder = NULL) {
+            _release();
+            _holder = holder;
+            if (_holder) {
+                _acquiredMicros = curTimeMicros64();
+            }
+        }
+
+    private:
+        void _release() {
+            if (_holder) {
+                _holder->release(static_cast<long long>(curTimeMicros64() - _acquiredMicros));
+            }
+        }
+
+        PriorityTicketHolder* _holder;
+        unsigned long long _acquiredMicros;
+    };
+
+}  // namespace mongo
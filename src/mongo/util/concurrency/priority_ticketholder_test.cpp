@@ -0,0 +1,201 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/priority_ticketholder.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+    using namespace mongo;
+
+    TEST(PriorityTicketHolderTest, PriorityNames) {
+        for (int i = 0; i < kNumAdmissionPriorities; i++) {
+            const AdmissionPriority priority = static_cast<AdmissionPriority>(i);
+            AdmissionPriority parsed;
+            ASSERT_TRUE(parseAdmissionPriority(admissionPriorityName(priority), &parsed));
+            ASSERT(parsed == priority);
+        }
+
+        AdmissionPriority parsed;
+        ASSERT_FALSE(parseAdmissionPriority("urgent", &parsed));
+    }
+
+    TEST(PriorityTicketHolderTest, FreeTicketsAreHandedOutImmediately) {
+        PriorityTicketHolder holder(2);
+        holder.waitForTicket(AdmissionPriority::kBatch);
+        ASSERT_TRUE(holder.tryAcquire());
+        ASSERT_FALSE(holder.tryAcquire());
+        ASSERT_EQUALS(0, holder.available());
+        ASSERT_EQUALS(2, holder.used());
+
+        holder.release();
+        holder.release();
+        ASSERT_EQUALS(2, holder.available());
+        ASSERT_EQUALS(1, holder.getLaneStats(AdmissionPriority::kBatch).admitted);
+    }
+
+    TEST(PriorityTicketHolderTest, Resize) {
+        PriorityTicketHolder holder(2);
+        ASSERT_NOT_OK(holder.resize(0));
+
+        holder.waitForTicket(AdmissionPriority::kInteractive);
+        holder.waitForTicket(AdmissionPriority::kInteractive);
+
+        // Shrinking below the number in use holds back tickets until enough are released.
+        ASSERT_OK(holder.resize(1));
+        holder.release();
+        ASSERT_FALSE(holder.tryAcquire());
+        holder.release();
+        ASSERT_TRUE(holder.tryAcquire());
+        holder.release();
+
+        ASSERT_OK(holder.resize(3));
+        ASSERT_EQUALS(3, holder.available());
+    }
+
+    TEST(PriorityTicketHolderTest, HoldStats) {
+        PriorityTicketHolder holder(2);
+        holder.waitForTicket(AdmissionPriority::kInteractive);
+        holder.waitForTicket(AdmissionPriority::kInteractive);
+        holder.release(100);
+        holder.release();
+        ASSERT_EQUALS(1, holder.getHoldStats().released);
+        ASSERT_EQUALS(100, holder.getHoldStats().heldMicros);
+
+        {
+            holder.waitForTicket(AdmissionPriority::kBatch);
+            PriorityTicketHolderReleaser releaser(&holder);
+            sleepmillis(2);
+        }
+        ASSERT_EQUALS(2, holder.getHoldStats().released);
+        ASSERT_GREATER_THAN_OR_EQUALS(holder.getHoldStats().heldMicros, 2100);
+        ASSERT_EQUALS(2, holder.available());
+    }
+
+    /**
+     * Queues waiters in several lanes of a holder with a single ticket, then hands the ticket
+     * out one release at a time and records which lane got it each time.
+     */
+    class AdmissionOrderTester {
+    public:
+        AdmissionOrderTester() : _holder(1) {
+            _holder.waitForTicket(AdmissionPriority::kInteractive);
+        }
+
+        void queue(AdmissionPriority priority, int count) {
+            const int alreadyQueued = _holder.getLaneStats(priority).queued;
+            for (int i = 0; i < count; i++) {
+                _threads.emplace_back(stdx::bind(&AdmissionOrderTester::_wait, this, priority));
+            }
+            // Make sure the waiters are queued, so that the order they were queued in is known.
+            while (_holder.getLaneStats(priority).queued < alreadyQueued + count) {
+                sleepmillis(1);
+            }
+        }
+
+        std::vector<AdmissionPriority> admitAll() {
+            const size_t total = _threads.size();
+            for (size_t i = 0; i < total; i++) {
+                // Release on behalf of the previous holder, then wait for the next one.
+                _holder.release();
+                while (_admittedCount() < i + 1) {
+                    sleepmillis(1);
+                }
+            }
+            for (auto& thread : _threads) {
+                thread.join();
+            }
+            _holder.release();
+            ASSERT_EQUALS(1, _holder.available());
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            return _admitted;
+        }
+
+    private:
+        void _wait(AdmissionPriority priority) {
+            _holder.waitForTicket(priority);
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _admitted.push_back(priority);
+        }
+
+        size_t _admittedCount() {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            return _admitted.size();
+        }
+
+        PriorityTicketHolder _holder;
+        std::vector<stdx::thread> _threads;
+        stdx::mutex _mutex;
+        std::vector<AdmissionPriority> _admitted;
+    };
+
+    TEST(PriorityTicketHolderTest, LanesShareTicketsByWeight) {
+        AdmissionOrderTester tester;
+        tester.queue(AdmissionPriority::kBatch, 4);
+        tester.queue(AdmissionPriority::kInteractive, 4);
+
+        // Interactive waiters get four tickets for each one a batch waiter gets, but the batch
+        // lane is not starved while interactive waiters are queued.
+        const AdmissionPriority I = AdmissionPriority::kInteractive;
+        const AdmissionPriority B = AdmissionPriority::kBatch;
+        const std::vector<AdmissionPriority> expected = {I, B, I, I, I, B, B, B};
+        const std::vector<AdmissionPriority> admitted = tester.admitAll();
+
+        ASSERT_EQUALS(expected.size(), admitted.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            ASSERT(expected[i] == admitted[i]);
+        }
+    }
+
+    TEST(PriorityTicketHolderTest, SystemLaneHasTheMostWeight) {
+        AdmissionOrderTester tester;
+        tester.queue(AdmissionPriority::kInteractive, 4);
+        tester.queue(AdmissionPriority::kSystem, 4);
+
+        // System waiters get four tickets for each one an interactive waiter gets.
+        const AdmissionPriority I = AdmissionPriority::kInteractive;
+        const AdmissionPriority S = AdmissionPriority::kSystem;
+        const std::vector<AdmissionPriority> expected = {S, I, S, S, S, I, I, I};
+        const std::vector<AdmissionPriority> admitted = tester.admitAll();
+
+        ASSERT_EQUALS(expected.size(), admitted.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            ASSERT(expected[i] == admitted[i]);
+        }
+    }
+
+} // namespace
@@ -34,13 +34,43 @@
 
 #include <time.h>
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "mongo/bson/inline_decls.h"
 
 namespace mongo {
 
+    namespace {
+        // Only changed during static initialization, when groups register themselves.
+        const SpinLockStats* firstSpinLockStats = NULL;
+
+        SpinLockStats otherSpinLockStats("other");
+    }
+
+    SpinLockStats::SpinLockStats(const char* name)
+        : _name(name),
+          _next(firstSpinLockStats) {
+        firstSpinLockStats = this;
+    }
+
+    // static
+    SpinLockStats* SpinLockStats::other() {
+        return &otherSpinLockStats;
+    }
+
+    // static
+    const SpinLockStats* SpinLockStats::first() {
+        return firstSpinLockStats;
+    }
+
     SpinLock::~SpinLock() {
 #if defined(_WIN32)
         DeleteCriticalSection(&_cs);
+#elif defined(__linux__)
 #elif defined(__USE_XOPEN2K)
         pthread_spin_destroy(&_lock);
 #endif
@@ -49,6 +79,8 @@ namespace mongo {
     SpinLock::SpinLock()
 #if defined(_WIN32)
     { InitializeCriticalSectionAndSpinCount(&_cs, 4000); }
+#elif defined(__linux__)
+    : _state(0), _stats(SpinLockStats::other()) { }
 #elif defined(__USE_XOPEN2K)
     { pthread_spin_init( &_lock , 0 ); }
 #elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
@@ -57,7 +89,65 @@ namespace mongo {
     : _mutex( "SpinLock" ) { }
 #endif
 
-#if defined(__USE_XOPEN2K)
+    SpinLock::SpinLock(SpinLockStats* stats)
+#if defined(_WIN32)
+    { InitializeCriticalSectionAndSpinCount(&_cs, 4000); }
+#elif defined(__linux__)
+    : _state(0), _stats(stats) { }
+#elif defined(__USE_XOPEN2K)
+    { pthread_spin_init( &_lock , 0 ); }
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+    : _locked( false ) { }
+#else
+    : _mutex( "SpinLock" ) { }
+#endif
+
+#if defined(__linux__)
+    namespace {
+        // The longest run of pauses between two attempts to take a contended lock before
+        // sleeping. Each run is twice as long as the one before, so this spins for roughly 2000
+        // pauses in all: about as long as a short critical section on a busy lock.
+        const int kMaxPauses = 1024;
+
+        long long monotonicMicros() {
+            struct timespec t;
+            clock_gettime(CLOCK_MONOTONIC, &t);
+            return t.tv_sec * 1000LL * 1000 + t.tv_nsec / 1000;
+        }
+    }
+
+    NOINLINE_DECL void SpinLock::_lockContended() {
+        _stats->contended.fetchAndAdd(1);
+
+        for (int pauses = 1; pauses <= kMaxPauses; pauses *= 2) {
+            for (int i = 0; i < pauses; i++) {
+#if defined(__i386__) || defined(__x86_64__)
+                asm volatile ( "pause" ) ;
+#endif
+            }
+            int unlocked = 0;
+            if (__atomic_load_n(&_state, __ATOMIC_RELAXED) == 0 &&
+                __atomic_compare_exchange_n(&_state, &unlocked, 1, false,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                return;
+            }
+        }
+
+        // Sleep until unlock() sees that there may be waiters and wakes one. A thread which
+        // takes the lock this way leaves it marked as having waiters, since it can't tell
+        // whether others are still asleep.
+        const long long start = monotonicMicros();
+        while (__atomic_exchange_n(&_state, 2, __ATOMIC_ACQUIRE) != 0) {
+            syscall(SYS_futex, &_state, FUTEX_WAIT_PRIVATE, 2, NULL, NULL, 0);
+        }
+        _stats->parked.fetchAndAdd(1);
+        _stats->parkedMicros.fetchAndAdd(monotonicMicros() - start);
+    }
+
+    NOINLINE_DECL void SpinLock::_wakeWaiter() {
+        syscall(SYS_futex, &_state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+#elif defined(__USE_XOPEN2K)
     NOINLINE_DECL void SpinLock::_lk() {
         /**
          * this is designed to perform close to the default spin lock
@@ -116,7 +206,8 @@ namespace mongo {
 #endif
 
     bool SpinLock::isfast() {
-#if defined(_WIN32) || defined(__USE_XOPEN2K) || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#if defined(_WIN32) || defined(__linux__) || defined(__USE_XOPEN2K) || \
+    defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
         return true;
 #else
         return false;
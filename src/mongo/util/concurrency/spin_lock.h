@@ -36,17 +36,53 @@
 
 #include <boost/noncopyable.hpp>
 
+#include "mongo/platform/atomic_word.h"
 #include "mutex.h"
 
 namespace mongo {
 
+    /**
+     * Contention counters shared by a group of SpinLocks, e.g. all the partitions of one cache.
+     * Only acquisitions which find the lock held update them, so uncontended locks cost nothing.
+     *
+     * Groups must have static storage duration: they register themselves on construction, are
+     * never unregistered, and are listed from SpinLockStats::first().
+     */
+    class SpinLockStats : boost::noncopyable {
+    public:
+        explicit SpinLockStats(const char* name);
+
+        const char* name() const { return _name; }
+
+        /**
+         * The group of locks which weren't given one.
+         */
+        static SpinLockStats* other();
+
+        static const SpinLockStats* first();
+        const SpinLockStats* next() const { return _next; }
+
+        AtomicInt64 contended;     // Acquisitions which found the lock held.
+        AtomicInt64 parked;        // Contended acquisitions which gave up spinning and slept.
+        AtomicInt64 parkedMicros;  // Time spent sleeping by those.
+
+    private:
+        const char* const _name;
+        const SpinLockStats* _next;
+    };
+
     /**
      * The spinlock currently requires late GCC support routines to be efficient.
      * Other platforms default to a mutex implemenation.
+     *
+     * On Linux, a contended lock() first spins, pausing for exponentially longer between
+     * attempts, and then sleeps on a futex until unlock() wakes it, rather than sleeping for a
+     * fixed time. Contention is counted in the lock's SpinLockStats.
      */
     class SpinLock : boost::noncopyable {
     public:
         SpinLock();
+        explicit SpinLock(SpinLockStats* stats);
         ~SpinLock();
 
         static bool isfast(); // true if a real spinlock on this platform
@@ -57,6 +93,27 @@ namespace mongo {
     public:
         void lock() {EnterCriticalSection(&_cs); }
         void unlock() { LeaveCriticalSection(&_cs); }
+#elif defined(__linux__)
+        // 0 if unlocked, 1 if locked, and 2 if locked and there may be threads asleep waiting
+        // for it.
+        int _state;
+        SpinLockStats* _stats;
+
+        void _lockContended();
+        void _wakeWaiter();
+    public:
+        void lock() {
+            int unlocked = 0;
+            if (MONGO_likely(__atomic_compare_exchange_n(&_state, &unlocked, 1, false,
+                                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)))
+                return;
+            _lockContended();
+        }
+        void unlock() {
+            if (MONGO_likely(__atomic_exchange_n(&_state, 0, __ATOMIC_RELEASE) == 1))
+                return;
+            _wakeWaiter();
+        }
 #elif defined(__USE_XOPEN2K)
         pthread_spinlock_t _lock;
         void _lk();
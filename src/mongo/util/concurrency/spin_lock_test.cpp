@@ -31,11 +31,13 @@
 #include "mongo/stdx/functional.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace {
 
     using mongo::SpinLock;
+    using mongo::SpinLockStats;
     using mongo::Timer;
 
     class LockTester {
@@ -110,4 +112,45 @@ namespace {
 #endif
     }
 
+    SpinLockStats testSpinLockStats("test");
+
+    TEST(Concurrency, SpinLockStatsGroups) {
+        bool foundTest = false;
+        bool foundOther = false;
+        for (const SpinLockStats* stats = SpinLockStats::first(); stats; stats = stats->next()) {
+            foundTest = foundTest || stats == &testSpinLockStats;
+            foundOther = foundOther || stats == SpinLockStats::other();
+        }
+        ASSERT( foundTest );
+        ASSERT( foundOther );
+        ASSERT_EQUALS( std::string("test"), testSpinLockStats.name() );
+    }
+
+#if defined(__linux__)
+    TEST(Concurrency, SpinLockCountsContention) {
+        SpinLock spin(&testSpinLockStats);
+        int counter = 0;
+
+        spin.lock();
+        LockTester tester( &spin, &counter );
+        tester.start( 1 );
+
+        // Long enough for the tester to give up spinning and sleep.
+        mongo::sleepmillis( 50 );
+        ASSERT_EQUALS( 0, counter );
+        spin.unlock();
+        tester.join();
+
+        ASSERT_EQUALS( 1, counter );
+        ASSERT_EQUALS( 1, testSpinLockStats.contended.load() );
+        ASSERT_EQUALS( 1, testSpinLockStats.parked.load() );
+        ASSERT( testSpinLockStats.parkedMicros.load() > 0 );
+
+        // Uncontended acquisitions aren't counted.
+        spin.lock();
+        spin.unlock();
+        ASSERT_EQUALS( 1, testSpinLockStats.contended.load() );
+    }
+#endif
+
 } // namespace
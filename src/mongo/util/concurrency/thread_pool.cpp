@@ -37,6 +37,7 @@
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/numa.h"
 
 namespace mongo {
     namespace threadpool {
@@ -73,6 +74,7 @@ namespace mongo {
 
             void loop(const std::string& threadName) {
                 setThreadName(threadName);
+                NumaThreadPlacement numaPlacement;
                 while (true) {
                     Task task = _task.take();
                     if (!task)
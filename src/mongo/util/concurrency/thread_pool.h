@@ -85,6 +85,8 @@ namespace mongo {
 
             int tasks_remaining() { return _tasksRemaining; }
 
+            int getNumThreads() const { return _nThreads; }
+
         private:
             boost::mutex _mutex;
             boost::condition _condition;
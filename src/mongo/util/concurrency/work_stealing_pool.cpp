@@ -0,0 +1,244 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/work_stealing_pool.h"
+
+#include "mongo/stdx/functional.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    WorkStealingPool::TaskGroup::TaskGroup() : _pending(0) { }
+
+    WorkStealingPool::TaskGroup::~TaskGroup() {
+        invariant(_pending == 0);
+    }
+
+    void WorkStealingPool::TaskGroup::join() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (_pending > 0) {
+            _allDone.wait(lk);
+        }
+    }
+
+    void WorkStealingPool::TaskGroup::_taskScheduled() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _pending++;
+    }
+
+    void WorkStealingPool::TaskGroup::_taskDone() {
+        // Counted down under the mutex, so that join() can't return and the group go away
+        // before the notification.
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (--_pending == 0) {
+            _allDone.notify_all();
+        }
+    }
+
+
+    class WorkStealingPool::WorkerQueue {
+        MONGO_DISALLOW_COPYING(WorkerQueue);
+    public:
+        WorkerQueue() : _tasks(kInitialCapacity), _head(0), _size(0) { }
+
+        void push(const Task& task) {
+            scoped_spinlock lk(_lock);
+            if (_size == _tasks.size()) {
+                _grow();
+            }
+            _tasks[(_head + _size) % _tasks.size()] = task;
+            _size++;
+        }
+
+        bool popFront(Task* task) {
+            scoped_spinlock lk(_lock);
+            if (_size == 0) {
+                return false;
+            }
+            *task = _tasks[_head];
+            _head = (_head + 1) % _tasks.size();
+            _size--;
+            return true;
+        }
+
+        bool popBack(Task* task) {
+            scoped_spinlock lk(_lock);
+            if (_size == 0) {
+                return false;
+            }
+            _size--;
+            *task = _tasks[(_head + _size) % _tasks.size()];
+            return true;
+        }
+
+    private:
+        static const size_t kInitialCapacity = 64;
+
+        void _grow() {
+            std::vector<Task> tasks(_tasks.size() * 2);
+            for (size_t i = 0; i < _size; i++) {
+                tasks[i] = _tasks[(_head + i) % _tasks.size()];
+            }
+            _tasks.swap(tasks);
+            _head = 0;
+        }
+
+        SpinLock _lock;
+        std::vector<Task> _tasks;
+        size_t _head;
+        size_t _size;
+    };
+
+
+    WorkStealingPool::WorkStealingPool(int numThreads,
+                                       const std::string& threadNamePrefix,
+                                       Stats* stats)
+        : _numThreads(numThreads),
+          _stats(stats ? stats : &_ownStats),
+          _inShutdown(false) {
+
+        invariant(numThreads > 0);
+
+        for (int i = 0; i < _numThreads; i++) {
+            _queues.emplace_back(new WorkerQueue());
+        }
+
+        for (int i = 0; i < _numThreads; i++) {
+            const std::string threadName = str::stream() << threadNamePrefix << i;
+            _threads.emplace_back(new stdx::thread(
+                stdx::bind(&WorkStealingPool::_workerLoop, this, i, threadName)));
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool() {
+        invariant(_numQueued.load() == 0);
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(_sleepMutex);
+            _inShutdown = true;
+            _workAvailable.notify_all();
+        }
+
+        for (size_t i = 0; i < _threads.size(); i++) {
+            _threads[i]->join();
+        }
+    }
+
+    void WorkStealingPool::schedule(TaskGroup* group, TaskFn fn, void* arg) {
+        invariant(group);
+        invariant(fn);
+
+        group->_taskScheduled();
+
+        Task task;
+        task.fn = fn;
+        task.arg = arg;
+        task.group = group;
+
+        _queues[_nextQueue.fetchAndAdd(1) % _numThreads]->push(task);
+        _stats->queued.fetchAndAdd(1);
+        _numQueued.fetchAndAdd(1);
+
+        // Whichever thread wakes up takes the task, from its own queue or by stealing it
+        if (_numSleeping.load() > 0) {
+            stdx::lock_guard<stdx::mutex> lk(_sleepMutex);
+            _workAvailable.notify_one();
+        }
+    }
+
+    void WorkStealingPool::_workerLoop(int workerId, const std::string& threadName) {
+        setThreadName(threadName);
+
+        while (true) {
+            Task task;
+            if (_takeTask(workerId, &task)) {
+                _runTask(task);
+                continue;
+            }
+
+            // A scheduler either sees this thread counted as sleeping and wakes it up, or this
+            // thread sees the task it queued, so no wakeup gets lost. The count of queued tasks
+            // can briefly be negative when a task is taken before it was counted.
+            stdx::unique_lock<stdx::mutex> lk(_sleepMutex);
+            _numSleeping.fetchAndAdd(1);
+            while (_numQueued.load() <= 0 && !_inShutdown) {
+                _workAvailable.wait(lk);
+            }
+            _numSleeping.fetchAndSubtract(1);
+
+            if (_inShutdown && _numQueued.load() <= 0) {
+                return;
+            }
+        }
+    }
+
+    bool WorkStealingPool::_takeTask(int workerId, Task* task) {
+        bool found = _queues[workerId]->popFront(task);
+
+        for (int i = 1; !found && i < _numThreads; i++) {
+            found = _queues[(workerId + i) % _numThreads]->popBack(task);
+            if (found) {
+                _stats->steals.fetchAndAdd(1);
+            }
+        }
+
+        if (found) {
+            _numQueued.fetchAndSubtract(1);
+            _stats->queued.fetchAndSubtract(1);
+        }
+
+        return found;
+    }
+
+    void WorkStealingPool::_runTask(const Task& task) {
+        try {
+            task.fn(task.arg);
+        }
+        catch (const DBException& e) {
+            log() << "Unhandled DBException: " << e.toString();
+        }
+        catch (const std::exception& e) {
+            log() << "Unhandled std::exception in worker thread: " << e.what();
+        }
+        catch (...) {
+            log() << "Unhandled non-exception in worker thread";
+        }
+
+        _stats->tasksRun.fetchAndAdd(1);
+        task.group->_taskDone();
+    }
+
+}  // namespace mongo
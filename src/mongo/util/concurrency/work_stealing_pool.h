@@ -0,0 +1,158 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+    /**
+     * A fixed size pool of threads, each with its own queue of tasks. Idle threads steal tasks
+     * from the front of the other threads' queues, so a few long tasks don't hold up the tasks
+     * queued behind them while other threads have nothing to do.
+     *
+     * Unlike ThreadPool, there is no queue shared by all threads and tasks are a function pointer
+     * with an argument, so scheduling doesn't allocate unless a queue has to grow past the most
+     * tasks it ever held. The caller owns whatever the argument points to, and has to keep it
+     * alive until the task ran, which TaskGroup::join() makes easy.
+     *
+     * Exceptions escaping a task are logged and swallowed, as by ThreadPool.
+     */
+    class WorkStealingPool {
+        MONGO_DISALLOW_COPYING(WorkStealingPool);
+    public:
+        typedef void (*TaskFn)(void* arg);
+
+        /**
+         * Tasks which are waited for together. A group may be reused once joined.
+         */
+        class TaskGroup {
+            MONGO_DISALLOW_COPYING(TaskGroup);
+        public:
+            TaskGroup();
+
+            // The group must have been joined.
+            ~TaskGroup();
+
+            /**
+             * Blocks until all tasks scheduled in this group so far have run.
+             */
+            void join();
+
+        private:
+            friend class WorkStealingPool;
+
+            void _taskScheduled();
+            void _taskDone();
+
+            stdx::mutex _mutex;
+            stdx::condition_variable _allDone;
+            int _pending;
+        };
+
+        /**
+         * Counters for a pool, which may be shared by pools replacing each other. The pool never
+         * resets them.
+         */
+        struct Stats {
+            AtomicInt64 queued;         // Tasks scheduled, which no thread has taken yet.
+            AtomicInt64 tasksRun;       // Tasks which ran.
+            AtomicInt64 steals;         // Tasks a thread took from another thread's queue.
+        };
+
+        /**
+         * Starts 'numThreads' threads, named 'threadNamePrefix' followed by their number. If
+         * 'stats' is not NULL, the pool also counts into it, and it must outlive the pool.
+         */
+        WorkStealingPool(int numThreads, const std::string& threadNamePrefix, Stats* stats = NULL);
+
+        // Stops the threads. All task groups must have been joined.
+        ~WorkStealingPool();
+
+        /**
+         * Queues fn(arg) as part of 'group'. Successive tasks go to successive threads' queues.
+         */
+        void schedule(TaskGroup* group, TaskFn fn, void* arg);
+
+        int getNumThreads() const { return _numThreads; }
+
+        const Stats& getStats() const { return *_stats; }
+
+    private:
+        struct Task {
+            TaskFn fn;
+            void* arg;
+            TaskGroup* group;
+        };
+
+        /**
+         * A ring buffer of tasks. Its thread takes tasks from the front, in the order they were
+         * scheduled, and other threads steal from the back the tasks it would get to last.
+         */
+        class WorkerQueue;
+
+        void _workerLoop(int workerId, const std::string& threadName);
+
+        /**
+         * Takes a task from the queue of 'workerId', or else from another queue.
+         */
+        bool _takeTask(int workerId, Task* task);
+
+        void _runTask(const Task& task);
+
+        const int _numThreads;
+
+        Stats _ownStats;
+        Stats* const _stats;
+
+        std::vector<std::unique_ptr<WorkerQueue>> _queues;
+        std::vector<std::unique_ptr<stdx::thread>> _threads;
+
+        AtomicUInt32 _nextQueue;
+
+        // Tasks in all the queues. Threads only sleep when it is zero.
+        AtomicInt64 _numQueued;
+
+        // Idle threads sleep on _workAvailable. Schedulers only take _sleepMutex to wake them up
+        // if _numSleeping is not zero.
+        stdx::mutex _sleepMutex;
+        stdx::condition_variable _workAvailable;
+        AtomicInt32 _numSleeping;
+        bool _inShutdown;
+    };
+
+}  // namespace mongo
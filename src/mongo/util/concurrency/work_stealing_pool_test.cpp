@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/stdx/mutex.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/work_stealing_pool.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+    using namespace mongo;
+
+    void increment(void* arg) {
+        static_cast<AtomicInt64*>(arg)->fetchAndAdd(1);
+    }
+
+    TEST(WorkStealingPool, RunsAllTasksBeforeJoinReturns) {
+        WorkStealingPool pool(4, "WorkStealingPoolTest");
+        WorkStealingPool::TaskGroup group;
+        AtomicInt64 counter;
+
+        for (int round = 0; round < 10; round++) {
+            for (int i = 0; i < 1000; i++) {
+                pool.schedule(&group, increment, &counter);
+            }
+            group.join();
+            ASSERT_EQUALS((round + 1) * 1000, counter.load());
+        }
+
+        ASSERT_EQUALS(10000, pool.getStats().tasksRun.load());
+        ASSERT_EQUALS(0, pool.getStats().queued.load());
+    }
+
+    TEST(WorkStealingPool, JoinOnlyWaitsForItsGroup) {
+        WorkStealingPool pool(2, "WorkStealingPoolTest");
+        WorkStealingPool::TaskGroup groupA;
+        WorkStealingPool::TaskGroup groupB;
+        AtomicInt64 counterA;
+        AtomicInt64 counterB;
+
+        for (int i = 0; i < 100; i++) {
+            pool.schedule(&groupA, increment, &counterA);
+            pool.schedule(&groupB, increment, &counterB);
+        }
+
+        groupA.join();
+        ASSERT_EQUALS(100, counterA.load());
+        groupB.join();
+        ASSERT_EQUALS(100, counterB.load());
+    }
+
+    // Blocks on the mutex passed in, which the test holds
+    void blockOn(void* arg) {
+        stdx::lock_guard<stdx::mutex> lk(*static_cast<stdx::mutex*>(arg));
+    }
+
+    TEST(WorkStealingPool, IdleThreadsStealQueuedTasks) {
+        WorkStealingPool::Stats stats;
+        WorkStealingPool pool(2, "WorkStealingPoolTest", &stats);
+        WorkStealingPool::TaskGroup group;
+        AtomicInt64 counter;
+        stdx::mutex blocker;
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(blocker);
+
+            // The first task goes to the first thread's queue and blocks that thread. Every other
+            // task queued behind it can only run by the second thread stealing it.
+            pool.schedule(&group, blockOn, &blocker);
+            for (int i = 0; i < 20; i++) {
+                pool.schedule(&group, increment, &counter);
+            }
+
+            for (int i = 0; i < 1000 && counter.load() < 20; i++) {
+                sleepmillis(10);
+            }
+            ASSERT_EQUALS(20, counter.load());
+        }
+
+        group.join();
+        ASSERT_GREATER_THAN_OR_EQUALS(stats.steals.load(), 10);
+        ASSERT_EQUALS(21, stats.tasksRun.load());
+    }
+
+    TEST(WorkStealingPool, StatsOutliveThePool) {
+        WorkStealingPool::Stats stats;
+        AtomicInt64 counter;
+
+        for (int i = 0; i < 3; i++) {
+            WorkStealingPool pool(i + 1, "WorkStealingPoolTest", &stats);
+            WorkStealingPool::TaskGroup group;
+            pool.schedule(&group, increment, &counter);
+            group.join();
+        }
+
+        ASSERT_EQUALS(3, stats.tasksRun.load());
+        ASSERT_EQUALS(3, counter.load());
+    }
+
+}  // namespace
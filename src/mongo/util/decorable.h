@@ -109,6 +109,13 @@ namespace mongo {
         Decorable() : _decorations(getRegistry()) {}
         ~Decorable() = default;
 
+        /**
+         * Returns the size of the decorations that each object carries.
+         */
+        static size_t getDecorationsSizeBytes() {
+            return getRegistry()->getDecorationBufferSizeBytes();
+        }
+
     private:
         static DecorationRegistry* getRegistry() {
             static DecorationRegistry* theRegistry = new DecorationRegistry();
@@ -0,0 +1,293 @@
+// flat_fast_key_table.h
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "mongo/platform/cstdint.h"
+#include "mongo/util/unordered_fast_key_table.h"
+
+namespace mongo {
+
+    /**
+     * The control bytes of one probing group of a FlatFastKeyTable. Bit i of each match mask
+     * stands for slot i of the group.
+     */
+    class FlatFastKeyTableGroup {
+    public:
+        static const unsigned kSize = 16;
+
+        static const int8_t kEmpty = -128;
+        static const int8_t kDeleted = -2;
+
+#if defined(__SSE2__)
+        explicit FlatFastKeyTableGroup( const int8_t* ctrl )
+            : _ctrl( _mm_loadu_si128( reinterpret_cast<const __m128i*>( ctrl ) ) ) {
+        }
+
+        uint32_t match( int8_t h2 ) const {
+            return _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_set1_epi8( h2 ), _ctrl ) );
+        }
+
+        uint32_t matchEmptyOrDeleted() const {
+            // Only kEmpty and kDeleted have the sign bit set.
+            return _mm_movemask_epi8( _ctrl );
+        }
+
+    private:
+        __m128i _ctrl;
+#else
+        explicit FlatFastKeyTableGroup( const int8_t* ctrl ) : _ctrl( ctrl ) {}
+
+        uint32_t match( int8_t h2 ) const {
+            uint32_t mask = 0;
+            for ( unsigned i = 0; i < kSize; i++ ) {
+                if ( _ctrl[i] == h2 )
+                    mask |= 1U << i;
+            }
+            return mask;
+        }
+
+        uint32_t matchEmptyOrDeleted() const {
+            uint32_t mask = 0;
+            for ( unsigned i = 0; i < kSize; i++ ) {
+                if ( _ctrl[i] < 0 )
+                    mask |= 1U << i;
+            }
+            return mask;
+        }
+
+    private:
+        const int8_t* _ctrl;
+#endif
+
+    public:
+        uint32_t matchEmpty() const { return match( kEmpty ); }
+    };
+
+    /**
+     * An open addressing hash table with the same interface as UnorderedFastKeyTable, laid out
+     * for fast lookups.
+     *
+     * Next to the slots, the table keeps one control byte per slot: either kEmpty, kDeleted or
+     * the low 7 bits of the hash of the key in the slot. Slots are probed a group of kGroupSize
+     * at a time; the control bytes of a group are compared against the hash bits of the key
+     * with a single SSE2 comparison (or a plain loop on other platforms), so keys are only
+     * compared, and slots only touched, for the few entries whose hash bits match. This makes
+     * lookups of absent keys and lookups in busy tables much cheaper than in
+     * UnorderedFastKeyTable, which compares the full hash slot by slot.
+     *
+     * Erased entries leave a kDeleted marker behind; they are dropped when the table is next
+     * rehashed. Iterators are invalidated by insertions, but not by erasures.
+     */
+    template< typename K_L, // key lookup
+              typename K_S, // key storage
+              typename V, // value
+              typename H , // hash of K_L
+              typename E, // equal of K_L
+              typename C, // convertor from K_S -> K_L
+              typename C_LS=UnorderedFastKeyTable_LS_C<K_L,K_S> // convertor from K_L -> K_S
+              >
+    class FlatFastKeyTable {
+    public:
+        typedef std::pair<K_S, V> value_type;
+        typedef K_L key_type;
+        typedef V mapped_type;
+
+        static const unsigned kGroupSize = FlatFastKeyTableGroup::kSize;
+
+    private:
+        struct Area {
+            explicit Area( unsigned capacity );
+            Area( const Area& other );
+
+            /**
+             * @param insertPos, if we return -1 and insertPos != NULL, this will be set to the
+             *                   first empty or deleted slot on the probe sequence of 'key'
+             * @return offset into _slots or -1 if not there
+             */
+            int find( const K_L& key,
+                      size_t hash,
+                      int* insertPos,
+                      const FlatFastKeyTable& sm ) const;
+
+            void swap( Area* other ) {
+                using std::swap;
+                swap( _capacity, other->_capacity );
+                swap( _growthLeft, other->_growthLeft );
+                swap( _ctrl, other->_ctrl );
+                swap( _slots, other->_slots );
+            }
+
+            // A power of two, at least kGroupSize.
+            unsigned _capacity;
+            // How many more empty slots may be filled before the table has to be rehashed.
+            unsigned _growthLeft;
+            std::unique_ptr<int8_t[]> _ctrl;
+            std::unique_ptr<value_type[]> _slots;
+        };
+
+    public:
+        static const unsigned DEFAULT_STARTING_CAPACITY = kGroupSize;
+
+        /**
+         * @param startingCapacity how many slots should exist on initial creation, rounded up
+         *                         to a power of two of at least kGroupSize
+         */
+        explicit FlatFastKeyTable( unsigned startingCapacity = DEFAULT_STARTING_CAPACITY );
+
+        FlatFastKeyTable( const FlatFastKeyTable& other );
+
+        FlatFastKeyTable& operator=( const FlatFastKeyTable& other ) {
+            other.copyTo( this );
+            return *this;
+        }
+
+        void copyTo( FlatFastKeyTable* out ) const;
+
+        /**
+         * @return number of elements in map
+         */
+        size_t size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        /*
+         * @return storage space
+         */
+        size_t capacity() const { return _area._capacity; }
+
+        V& operator[]( const K_L& key ) { return get( key ); }
+
+        V& get( const K_L& key );
+
+        /**
+         * @return number of elements removed
+         */
+        size_t erase( const K_L& key );
+
+        class const_iterator {
+            friend class FlatFastKeyTable;
+
+        public:
+            const_iterator() { _position = -1; }
+            const_iterator( const Area* area ) {
+                _area = area;
+                _position = 0;
+                _max = _area->_capacity - 1;
+                _skip();
+            }
+            const_iterator( const Area* area, int pos ) {
+                _area = area;
+                _position = pos;
+                _max = pos;
+            }
+
+            const value_type* operator->() const { return &_area->_slots[_position]; }
+
+            const value_type& operator*() const { return _area->_slots[_position]; }
+
+            const_iterator operator++() {
+                if ( _position < 0 )
+                    return *this;
+                _position++;
+                if ( _position > _max )
+                    _position = -1;
+                else
+                    _skip();
+                return *this;
+            }
+
+            bool operator==( const const_iterator& other ) const {
+                return _position == other._position;
+            }
+            bool operator!=( const const_iterator& other ) const {
+                return _position != other._position;
+            }
+
+        private:
+
+            void _skip() {
+                while ( true ) {
+                    if ( _area->_ctrl[_position] >= 0 )
+                        break;
+                    if ( _position >= _max ) {
+                        _position = -1;
+                        break;
+                    }
+                    ++_position;
+                }
+            }
+
+            const Area* _area;
+            int _position;
+            int _max; // inclusive
+        };
+
+        void erase( const_iterator it );
+
+        /**
+         * @return either a one-shot iterator with the key, or end()
+         */
+        const_iterator find( const K_L& key ) const;
+
+        const_iterator begin() const;
+
+        const_iterator end() const;
+
+    private:
+        void _eraseAt( int pos );
+
+        /**
+         * Rebuilds the table without kDeleted markers, doubling its capacity if live entries
+         * take up more than 7/16 of it.
+         */
+        void _rehash();
+
+        // ----
+
+        size_t _size;
+        Area _area;
+
+        H _hash;
+        E _equals;
+        C _convertor;
+        C_LS _convertorOther;
+    };
+
+}
+
+#include "mongo/util/flat_fast_key_table_internal.h"
@@ -0,0 +1,279 @@
+// flat_fast_key_table_internal.h
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include <cstring>
+#include <utility>
+
+#include "mongo/platform/bits.h"
+#include "mongo/util/assert_util.h"
+
+#define MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE \
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, \
+              typename C_LS >
+
+namespace mongo {
+
+namespace flat_fast_key_table_detail {
+
+    /**
+     * The low 7 bits of a hash are kept in the control byte of the slot, the remaining bits pick
+     * the group where probing starts.
+     */
+    inline int8_t h2( size_t hash ) {
+        return static_cast<int8_t>( hash & 0x7F );
+    }
+
+    inline size_t h1( size_t hash ) {
+        return hash >> 7;
+    }
+
+    inline unsigned roundUpCapacity( unsigned capacity ) {
+        unsigned rounded = FlatFastKeyTableGroup::kSize;
+        while ( rounded < capacity )
+            rounded *= 2;
+        return rounded;
+    }
+
+    /**
+     * Keeps one slot in eight empty, so that every probe sequence ends at a group with an
+     * empty slot.
+     */
+    inline unsigned maxLoad( unsigned capacity ) {
+        return capacity - capacity / 8;
+    }
+
+} // namespace flat_fast_key_table_detail
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::Area( unsigned capacity )
+        : _capacity( flat_fast_key_table_detail::roundUpCapacity( capacity ) ),
+          _growthLeft( flat_fast_key_table_detail::maxLoad( _capacity ) ),
+          _ctrl( new int8_t[_capacity] ),
+          _slots( new value_type[_capacity] ) {
+        memset( _ctrl.get(), FlatFastKeyTableGroup::kEmpty, _capacity );
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::Area( const Area& other )
+        : _capacity( other._capacity ),
+          _growthLeft( other._growthLeft ),
+          _ctrl( new int8_t[_capacity] ),
+          _slots( new value_type[_capacity] ) {
+        memcpy( _ctrl.get(), other._ctrl.get(), _capacity );
+        for ( unsigned i = 0; i < _capacity; i++ ) {
+            if ( _ctrl[i] >= 0 )
+                _slots[i] = other._slots[i];
+        }
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline int FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::find(
+            const K_L& key,
+            size_t hash,
+            int* insertPos,
+            const FlatFastKeyTable& sm ) const {
+        if ( insertPos )
+            *insertPos = -1;
+
+        const int8_t h2 = flat_fast_key_table_detail::h2( hash );
+        const size_t numGroups = _capacity / kGroupSize;
+        const size_t mask = numGroups - 1;
+        size_t group = flat_fast_key_table_detail::h1( hash ) & mask;
+
+        // Triangular probing over groups visits every group once when their number is a power of
+        // two.
+        for ( size_t probe = 1; probe <= numGroups; probe++ ) {
+            const int base = static_cast<int>( group * kGroupSize );
+            const FlatFastKeyTableGroup g( &_ctrl[base] );
+
+            for ( uint32_t m = g.match( h2 ); m; m &= m - 1 ) {
+                const int pos = base + countTrailingZeros64( m );
+                if ( sm._equals( key, sm._convertor( _slots[pos].first ) ) )
+                    return pos;
+            }
+
+            if ( insertPos && *insertPos < 0 ) {
+                const uint32_t free = g.matchEmptyOrDeleted();
+                if ( free )
+                    *insertPos = base + countTrailingZeros64( free );
+            }
+
+            // The key would have been stored in this group or an earlier one, as a group which
+            // still has an empty slot has never been full.
+            if ( g.matchEmpty() )
+                return -1;
+
+            group = ( group + probe ) & mask;
+        }
+
+        return -1;
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::FlatFastKeyTable(
+            unsigned startingCapacity )
+        : _size( 0 ), _area( startingCapacity ) {
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::FlatFastKeyTable(
+            const FlatFastKeyTable& other )
+        : _size( other._size ),
+          _area( other._area ),
+          _hash( other._hash ),
+          _equals( other._equals ),
+          _convertor( other._convertor ),
+          _convertorOther( other._convertorOther ) {
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline void FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::copyTo(
+            FlatFastKeyTable* out ) const {
+        out->_size = _size;
+        Area x( _area );
+        out->_area.swap( &x );
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline V& FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::get( const K_L& key ) {
+        const size_t hash = _hash( key );
+
+        int insertPos;
+        int pos = _area.find( key, hash, &insertPos, *this );
+        if ( pos >= 0 )
+            return _area._slots[pos].second;
+
+        // key not in map, need to add
+        if ( insertPos < 0 ||
+             ( _area._ctrl[insertPos] == FlatFastKeyTableGroup::kEmpty &&
+               _area._growthLeft == 0 ) ) {
+            _rehash();
+            _area.find( key, hash, &insertPos, *this );
+            invariant( insertPos >= 0 );
+        }
+
+        // Reusing a kDeleted slot leaves the number of empty slots as it is.
+        if ( _area._ctrl[insertPos] == FlatFastKeyTableGroup::kEmpty )
+            _area._growthLeft--;
+
+        _size++;
+        _area._ctrl[insertPos] = flat_fast_key_table_detail::h2( hash );
+        _area._slots[insertPos].first = _convertorOther( key );
+        return _area._slots[insertPos].second;
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline size_t FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::erase( const K_L& key ) {
+        if ( _size == 0 )
+            return 0;
+
+        int pos = _area.find( key, _hash( key ), NULL, *this );
+        if ( pos < 0 )
+            return 0;
+
+        _eraseAt( pos );
+        return 1;
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    void FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::erase( const_iterator it ) {
+        dassert( it._position >= 0 );
+        dassert( it._area == &_area );
+
+        _eraseAt( it._position );
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline void FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::_eraseAt( int pos ) {
+        --_size;
+        _area._slots[pos] = value_type();
+
+        // If the group still has an empty slot, no probe sequence ever went past it, so the slot
+        // can be made empty again instead of leaving a kDeleted marker behind.
+        const int base = pos - pos % kGroupSize;
+        if ( FlatFastKeyTableGroup( &_area._ctrl[base] ).matchEmpty() ) {
+            _area._ctrl[pos] = FlatFastKeyTableGroup::kEmpty;
+            _area._growthLeft++;
+        }
+        else {
+            _area._ctrl[pos] = FlatFastKeyTableGroup::kDeleted;
+        }
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline void FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::_rehash() {
+        unsigned capacity = _area._capacity;
+        if ( ( _size + 1 ) * 16 > capacity * 7 )
+            capacity *= 2;
+
+        Area newArea( capacity );
+        for ( unsigned i = 0; i < _area._capacity; i++ ) {
+            if ( _area._ctrl[i] < 0 )
+                continue;
+
+            const size_t hash = _hash( _convertor( _area._slots[i].first ) );
+            int insertPos;
+            newArea.find( _convertor( _area._slots[i].first ), hash, &insertPos, *this );
+            invariant( insertPos >= 0 );
+
+            newArea._growthLeft--;
+            newArea._ctrl[insertPos] = flat_fast_key_table_detail::h2( hash );
+            using std::swap;
+            swap( newArea._slots[insertPos], _area._slots[i] );
+        }
+        _area.swap( &newArea );
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline typename FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::const_iterator
+    FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::find( const K_L& key ) const {
+        if ( _size == 0 )
+            return const_iterator();
+        int pos = _area.find( key, _hash( key ), NULL, *this );
+        if ( pos < 0 )
+            return const_iterator();
+        return const_iterator( &_area, pos );
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline typename FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::const_iterator
+    FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::end() const {
+        return const_iterator();
+    }
+
+    MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
+    inline typename FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::const_iterator
+    FlatFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::begin() const {
+        return const_iterator( &_area );
+    }
+
+}
+
+#undef MONGO_FLAT_FAST_KEY_TABLE_TEMPLATE
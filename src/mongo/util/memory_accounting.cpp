@@ -0,0 +1,91 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/memory_accounting.h"
+
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+namespace {
+
+    // Accounts constructed on first use, like those of templates, register at any time
+    stdx::mutex& accountsMutex() {
+        static stdx::mutex* mutex = new stdx::mutex();
+        return *mutex;
+    }
+
+    std::vector<const MemoryAccount*>& accounts() {
+        static std::vector<const MemoryAccount*>* all = new std::vector<const MemoryAccount*>();
+        return *all;
+    }
+
+}  // namespace
+
+    const long long MemoryAccount::kUpdateGranularityBytes;
+
+    MemoryAccount::Charge::Charge(MemoryAccount* account)
+        : _account(account), _bytes(0), _charged(0) {
+        _account->_objects.fetchAndAdd(1);
+    }
+
+    MemoryAccount::Charge::~Charge() {
+        _account->_bytes.fetchAndSubtract(_charged);
+        _account->_objects.fetchAndSubtract(1);
+    }
+
+    void MemoryAccount::Charge::set(long long bytes) {
+        _bytes = bytes;
+        if (_charged != bytes) {
+            _account->_bytes.fetchAndAdd(bytes - _charged);
+            _charged = bytes;
+        }
+    }
+
+    void MemoryAccount::Charge::update(long long bytes) {
+        _bytes = bytes;
+        const long long change = bytes - _charged;
+        if (change >= kUpdateGranularityBytes || change <= -kUpdateGranularityBytes) {
+            _account->_bytes.fetchAndAdd(change);
+            _charged = bytes;
+        }
+    }
+
+    MemoryAccount::MemoryAccount(const std::string& name) : _name(name) {
+        stdx::lock_guard<stdx::mutex> lk(accountsMutex());
+        accounts().push_back(this);
+    }
+
+    std::vector<const MemoryAccount*> MemoryAccount::getAll() {
+        stdx::lock_guard<stdx::mutex> lk(accountsMutex());
+        return accounts();
+    }
+
+}  // namespace mongo
@@ -0,0 +1,117 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * The memory held by one subsystem, such as the plan caches or the open cursors, as counted
+     * by the objects holding it through a MemoryAccount::Charge each. The counts are the objects'
+     * estimates of what they hold, not what the allocator gave them, and are reported under
+     * serverStatus mem.accounted.
+     *
+     * Accounts live as long as the process, and are usually globals:
+     *
+     *     MemoryAccount planCacheMemory("planCache");
+     */
+    class MemoryAccount {
+        MONGO_DISALLOW_COPYING(MemoryAccount);
+    public:
+        /**
+         * The share of an account held by one object, which adds its bytes and itself to the
+         * account, and removes them when destroyed. Like the object holding it, it is not safe
+         * to change from more than one thread at once.
+         */
+        class Charge {
+            MONGO_DISALLOW_COPYING(Charge);
+        public:
+            explicit Charge(MemoryAccount* account);
+            ~Charge();
+
+            /**
+             * Sets the bytes held by the object.
+             */
+            void set(long long bytes);
+
+            /**
+             * Like set(), but only passes the change on to the account once it adds up to
+             * kUpdateGranularityBytes, for objects whose size changes with every document they
+             * process.
+             */
+            void update(long long bytes);
+
+            /**
+             * Adds to the bytes held by the object, or with a negative "bytes" takes from them.
+             */
+            void add(long long bytes) { set(_bytes + bytes); }
+
+            long long get() const { return _bytes; }
+
+        private:
+            MemoryAccount* const _account;
+            long long _bytes;
+
+            // What the account has been told, which update() lets lag behind _bytes
+            long long _charged;
+        };
+
+        static const long long kUpdateGranularityBytes = 64 * 1024;
+
+        explicit MemoryAccount(const std::string& name);
+
+        const std::string& getName() const { return _name; }
+
+        /**
+         * Returns the bytes held by the objects charged to this account.
+         */
+        long long getBytes() const { return _bytes.load(); }
+
+        /**
+         * Returns how many objects hold a Charge to this account.
+         */
+        long long getObjects() const { return _objects.load(); }
+
+        /**
+         * Returns every account, in the order they were constructed.
+         */
+        static std::vector<const MemoryAccount*> getAll();
+
+    private:
+        const std::string _name;
+        AtomicInt64 _bytes;
+        AtomicInt64 _objects;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,99 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/memory_accounting.h"
+
+namespace {
+
+    using namespace mongo;
+
+    MemoryAccount testMemory("test");
+
+    TEST(MemoryAccount, ChargesAddUp) {
+        ASSERT_EQUALS(0, testMemory.getBytes());
+        ASSERT_EQUALS(0, testMemory.getObjects());
+        {
+            MemoryAccount::Charge first(&testMemory);
+            ASSERT_EQUALS(1, testMemory.getObjects());
+            first.set(100);
+
+            std::unique_ptr<MemoryAccount::Charge> second(new MemoryAccount::Charge(&testMemory));
+            second->add(50);
+            second->add(-20);
+            ASSERT_EQUALS(30, second->get());
+            ASSERT_EQUALS(130, testMemory.getBytes());
+            ASSERT_EQUALS(2, testMemory.getObjects());
+
+            first.set(10);
+            ASSERT_EQUALS(40, testMemory.getBytes());
+
+            second.reset();
+            ASSERT_EQUALS(10, testMemory.getBytes());
+            ASSERT_EQUALS(1, testMemory.getObjects());
+        }
+        ASSERT_EQUALS(0, testMemory.getBytes());
+        ASSERT_EQUALS(0, testMemory.getObjects());
+    }
+
+    TEST(MemoryAccount, UpdatesAreCoarse) {
+        const long long granularity = MemoryAccount::kUpdateGranularityBytes;
+        {
+            MemoryAccount::Charge charge(&testMemory);
+            charge.update(granularity - 1);
+            ASSERT_EQUALS(granularity - 1, charge.get());
+            ASSERT_EQUALS(0, testMemory.getBytes());
+
+            charge.update(granularity);
+            ASSERT_EQUALS(granularity, testMemory.getBytes());
+            charge.update(1);
+            ASSERT_EQUALS(granularity, testMemory.getBytes());
+            charge.update(0);
+            ASSERT_EQUALS(0, testMemory.getBytes());
+
+            // set() always passes the change on
+            charge.update(granularity / 2);
+            charge.set(granularity / 2);
+            ASSERT_EQUALS(granularity / 2, testMemory.getBytes());
+            charge.update(3 * granularity);
+        }
+        ASSERT_EQUALS(0, testMemory.getBytes());
+    }
+
+    TEST(MemoryAccount, AccountsAreListed) {
+        const std::vector<const MemoryAccount*> all = MemoryAccount::getAll();
+        ASSERT(std::find(all.begin(), all.end(), &testMemory) != all.end());
+        ASSERT_EQUALS("test", testMemory.getName());
+    }
+
+}  // namespace
@@ -36,6 +36,7 @@
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/encoded_value_storage.h"
+#include "mongo/bson/util/buffer_pool.h"
 #include "mongo/util/allocator.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/hostandport.h"
@@ -67,6 +68,7 @@ namespace mongo {
         dbKillCursors = 2007,
         dbCommand = 2008,
         dbCommandReply = 2009,
+        dbCompressed = 2012, /* envelope around another message, see message_compressor.h */
     };
 
     bool doesOpGetAResponse( int op );
@@ -84,6 +86,7 @@ namespace mongo {
         case dbKillCursors: return "killcursors";
         case dbCommand: return "command";
         case dbCommandReply: return "commandReply";
+        case dbCompressed: return "compressed";
         default:
             massert( 16141, str::stream() << "cannot translate opcode " << op, !op );
             return "";
@@ -99,6 +102,7 @@ namespace mongo {
         case dbQuery:
         case dbGetMore:
         case dbKillCursors:
+        case dbCompressed:
             return false;
 
         case dbUpdate:
@@ -329,12 +333,12 @@ namespace mongo {
     class Message {
     public:
         // we assume here that a vector with initial size 0 does no allocation (0 is the default, but wanted to make it explicit).
-        Message() : _buf( 0 ), _data( 0 ), _freeIt( false ) {}
+        Message() : _buf( 0 ), _data( 0 ), _freeIt( false ), _pooledSize( 0 ) {}
         Message( void * data , bool freeIt ) :
-            _buf( 0 ), _data( 0 ), _freeIt( false ) {
+            _buf( 0 ), _data( 0 ), _freeIt( false ), _pooledSize( 0 ) {
             _setData( reinterpret_cast< char* >( data ), freeIt );
         };
-        Message(Message& r) : _buf( 0 ), _data( 0 ), _freeIt( false ) {
+        Message(Message& r) : _buf( 0 ), _data( 0 ), _freeIt( false ), _pooledSize( 0 ) {
             *this = r;
         }
         ~Message() {
@@ -402,6 +406,8 @@ namespace mongo {
             verify( r._freeIt );
             _buf = r._buf;
             r._buf = 0;
+            _pooledSize = r._pooledSize;
+            r._pooledSize = 0;
             if ( r._data.size() > 0 ) {
                 _data.swap( r._data );
             }
@@ -413,7 +419,12 @@ namespace mongo {
         void reset() {
             if ( _freeIt ) {
                 if ( _buf ) {
-                    free( _buf );
+                    if ( _pooledSize ) {
+                        BufferPool::release( _buf, _pooledSize );
+                    }
+                    else {
+                        free( _buf );
+                    }
                 }
                 for (std::vector< std::pair< char *, int > >::const_iterator i = _data.begin();
                      i != _data.end(); ++i) {
@@ -423,6 +434,7 @@ namespace mongo {
             _buf = 0;
             _data.clear();
             _freeIt = false;
+            _pooledSize = 0;
         }
 
         // use to add a buffer
@@ -439,8 +451,10 @@ namespace mongo {
             }
             verify( _freeIt );
             if ( _buf ) {
+                // pooled buffers are plain malloc() blocks, so once in _data they are just free()d
                 _data.push_back(std::make_pair(_buf, MsgData::ConstView(_buf).getLen()));
                 _buf = 0;
+                _pooledSize = 0;
             }
             _data.push_back(std::make_pair(d, size));
             header().setLen(header().getLen() + size);
@@ -451,6 +465,13 @@ namespace mongo {
             verify( empty() );
             _setData( d, freeIt );
         }
+        // use to set first buffer if empty, adopting the buffer of a PooledBufBuilder of size
+        // 'pooledSize' (which then must be decouple()d); reset() gives it back to the BufferPool
+        void setPooledData(char* d, int pooledSize) {
+            verify( empty() );
+            _setData( d, true );
+            _pooledSize = pooledSize;
+        }
         void setData(int operation, const char *msgtxt) {
             setData(operation, msgtxt, strlen(msgtxt)+1);
         }
@@ -476,6 +497,7 @@ namespace mongo {
         void _setData( char* d, bool freeIt ) {
             _freeIt = freeIt;
             _buf = d;
+            _pooledSize = 0;
         }
         // if just one buffer, keep it in _buf, otherwise keep a sequence of buffers in _data
         char* _buf;
@@ -483,6 +505,8 @@ namespace mongo {
         typedef std::vector< std::pair< char*, int > > MsgVec;
         MsgVec _data;
         bool _freeIt;
+        // if non-zero, _buf came from a PooledBufBuilder of this size
+        size_t _pooledSize;
     };
 
 
@@ -0,0 +1,368 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor.h"
+
+#include <algorithm>
+#include <snappy.h>
+#include <zlib.h>
+
+#include "mongo/base/data_view.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/stringutils.h"
+
+namespace mongo {
+
+namespace {
+
+    /**
+     * The body of a dbCompressed message, following the standard message header, is
+     *
+     *     int32 originalOpCode;    // opCode of the wrapped message
+     *     int32 uncompressedSize;  // size of the wrapped message, excluding its header
+     *     uint8 compressorId;      // a MessageCompressorId
+     *     char  compressed[];      // body of the wrapped message, compressed
+     */
+    const int kOriginalOpCodeOffset = 0;
+    const int kUncompressedSizeOffset = 4;
+    const int kCompressorIdOffset = 8;
+    const int kEnvelopeSize = 9;
+
+    const char kCompressionFieldName[] = "compression";
+
+    std::vector<MessageCompressorId> configuredCompressors;
+    std::string networkMessageCompressors;
+
+    Status parseCompressorList(const std::string& str, std::vector<MessageCompressorId>* out) {
+        std::vector<std::string> names;
+        splitStringDelim(str, &names, ',');
+
+        out->clear();
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i].empty()) {
+                continue;
+            }
+
+            MessageCompressorId id;
+            if (!parseMessageCompressorName(names[i], &id) || id == MessageCompressorId::kNoop) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "unknown network message compressor '"
+                                            << names[i] << "'");
+            }
+            out->push_back(id);
+        }
+        return Status::OK();
+    }
+
+    /**
+     * Comma-separated list of compressors, in order of preference, that this process offers
+     * as a client and accepts as a server. Compression is disabled if empty.
+     */
+    class ExportedCompressorsParameter : public ExportedServerParameter<std::string> {
+    public:
+        ExportedCompressorsParameter() :
+            ExportedServerParameter<std::string>(ServerParameterSet::getGlobal(),
+                                                 "networkMessageCompressors",
+                                                 &networkMessageCompressors,
+                                                 true,
+                                                 false) {}
+
+        virtual Status validate(const std::string& potentialNewValue) {
+            std::vector<MessageCompressorId> ids;
+            return parseCompressorList(potentialNewValue, &ids);
+        }
+
+        using ExportedServerParameter<std::string>::set;
+
+        virtual Status set(const std::string& newValue) {
+            Status status = ExportedServerParameter<std::string>::set(newValue);
+            if (status.isOK()) {
+                invariantOK(parseCompressorList(newValue, &configuredCompressors));
+            }
+            return status;
+        }
+    } exportedCompressorsParam;
+
+    bool isConfigured(MessageCompressorId id) {
+        return std::find(configuredCompressors.begin(), configuredCompressors.end(), id) !=
+            configuredCompressors.end();
+    }
+
+    /**
+     * Compresses "len" bytes at "input" into "output", which must have room for
+     * maxCompressedLength() bytes. Returns the compressed length, or 0 on failure.
+     */
+    size_t compressBody(MessageCompressorId id, const char* input, size_t len, char* output,
+                        size_t outputCapacity) {
+        switch (id) {
+        case MessageCompressorId::kSnappy: {
+            size_t compressedLen = 0;
+            snappy::RawCompress(input, len, output, &compressedLen);
+            return compressedLen;
+        }
+        case MessageCompressorId::kZlib: {
+            uLongf compressedLen = outputCapacity;
+            if (compress2(reinterpret_cast<Bytef*>(output), &compressedLen,
+                          reinterpret_cast<const Bytef*>(input), len,
+                          Z_DEFAULT_COMPRESSION) != Z_OK) {
+                return 0;
+            }
+            return compressedLen;
+        }
+        case MessageCompressorId::kNoop:
+            break;
+        }
+        invariant(false);
+        return 0;
+    }
+
+    size_t maxCompressedLength(MessageCompressorId id, size_t len) {
+        switch (id) {
+        case MessageCompressorId::kSnappy:
+            return snappy::MaxCompressedLength(len);
+        case MessageCompressorId::kZlib:
+            return compressBound(len);
+        case MessageCompressorId::kNoop:
+            break;
+        }
+        invariant(false);
+        return 0;
+    }
+
+}  // namespace
+
+    StringData messageCompressorName(MessageCompressorId id) {
+        switch (id) {
+        case MessageCompressorId::kNoop: return "noop";
+        case MessageCompressorId::kSnappy: return "snappy";
+        case MessageCompressorId::kZlib: return "zlib";
+        }
+        return "unknown";
+    }
+
+    bool parseMessageCompressorName(StringData name, MessageCompressorId* out) {
+        const MessageCompressorId all[] = {
+            MessageCompressorId::kNoop,
+            MessageCompressorId::kSnappy,
+            MessageCompressorId::kZlib,
+        };
+        for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); ++i) {
+            if (name == messageCompressorName(all[i])) {
+                *out = all[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const std::vector<MessageCompressorId>& getConfiguredMessageCompressors() {
+        return configuredCompressors;
+    }
+
+    bool compressMessage(MessageCompressorId id, const Message& source, Message* out) {
+        invariant(out->empty());
+        invariant(id != MessageCompressorId::kNoop);
+
+        const MsgData::View sourceData = source.singleData();
+        const size_t sourceLen = sourceData.dataLen();
+
+        const size_t capacity = maxCompressedLength(id, sourceLen);
+        const size_t maxLen = MsgData::MsgDataHeaderSize + kEnvelopeSize + capacity;
+        MsgData::View md = reinterpret_cast<char*>(mongoMalloc(maxLen));
+        ScopeGuard guard = MakeGuard(free, md.view2ptr());
+
+        char* const envelope = md.data();
+        const size_t compressedLen = compressBody(id, sourceData.data(), sourceLen,
+                                                  envelope + kEnvelopeSize, capacity);
+        if (compressedLen == 0 || compressedLen + kEnvelopeSize >= sourceLen) {
+            return false;
+        }
+
+        DataView(envelope).write<LittleEndian<int32_t>>(sourceData.getOperation(),
+                                                        kOriginalOpCodeOffset);
+        DataView(envelope).write<LittleEndian<int32_t>>(sourceLen, kUncompressedSizeOffset);
+        DataView(envelope).write<uint8_t>(static_cast<uint8_t>(id), kCompressorIdOffset);
+
+        md.setLen(MsgData::MsgDataHeaderSize + kEnvelopeSize + compressedLen);
+        md.setId(sourceData.getId());
+        md.setResponseTo(sourceData.getResponseTo());
+        md.setOperation(dbCompressed);
+
+        guard.Dismiss();
+        out->setData(md.view2ptr(), true);
+        return true;
+    }
+
+    Status decompressMessage(const Message& source, Message* out) {
+        invariant(out->empty());
+
+        const MsgData::View sourceData = source.singleData();
+        invariant(sourceData.getOperation() == dbCompressed);
+
+        if (sourceData.dataLen() < kEnvelopeSize) {
+            return Status(ErrorCodes::BadValue, "compressed message is too short");
+        }
+
+        const char* const envelope = sourceData.data();
+        const int32_t originalOpCode =
+            ConstDataView(envelope).read<LittleEndian<int32_t>>(kOriginalOpCodeOffset);
+        const int32_t uncompressedSize =
+            ConstDataView(envelope).read<LittleEndian<int32_t>>(kUncompressedSizeOffset);
+        const uint8_t compressorId = ConstDataView(envelope).read<uint8_t>(kCompressorIdOffset);
+
+        if (originalOpCode == dbCompressed) {
+            return Status(ErrorCodes::BadValue, "compressed message wraps a compressed message");
+        }
+        if (uncompressedSize < 0 || static_cast<size_t>(uncompressedSize) >
+                MaxMessageSizeBytes - MsgData::MsgDataHeaderSize) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "invalid uncompressed message size "
+                                        << uncompressedSize);
+        }
+
+        const char* const compressed = envelope + kEnvelopeSize;
+        const size_t compressedLen = sourceData.dataLen() - kEnvelopeSize;
+
+        MsgData::View md =
+            reinterpret_cast<char*>(mongoMalloc(MsgData::MsgDataHeaderSize + uncompressedSize));
+        ScopeGuard guard = MakeGuard(free, md.view2ptr());
+
+        switch (static_cast<MessageCompressorId>(compressorId)) {
+        case MessageCompressorId::kSnappy: {
+            size_t actualSize;
+            if (!snappy::GetUncompressedLength(compressed, compressedLen, &actualSize) ||
+                actualSize != static_cast<size_t>(uncompressedSize) ||
+                !snappy::RawUncompress(compressed, compressedLen, md.data())) {
+                return Status(ErrorCodes::BadValue, "invalid snappy compressed message");
+            }
+            break;
+        }
+        case MessageCompressorId::kZlib: {
+            uLongf actualSize = uncompressedSize;
+            if (uncompress(reinterpret_cast<Bytef*>(md.data()), &actualSize,
+                           reinterpret_cast<const Bytef*>(compressed), compressedLen) != Z_OK ||
+                actualSize != static_cast<uLongf>(uncompressedSize)) {
+                return Status(ErrorCodes::BadValue, "invalid zlib compressed message");
+            }
+            break;
+        }
+        default:
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "unsupported message compressor "
+                                        << static_cast<int>(compressorId));
+        }
+
+        md.setLen(MsgData::MsgDataHeaderSize + uncompressedSize);
+        md.setId(sourceData.getId());
+        md.setResponseTo(sourceData.getResponseTo());
+        md.setOperation(originalOpCode);
+
+        guard.Dismiss();
+        out->setData(md.view2ptr(), true);
+        return Status::OK();
+    }
+
+    void appendMessageCompressionRequest(BSONObjBuilder* isMasterCmd) {
+        if (configuredCompressors.empty()) {
+            return;
+        }
+
+        BSONArrayBuilder names(isMasterCmd->subarrayStart(kCompressionFieldName));
+        for (size_t i = 0; i < configuredCompressors.size(); ++i) {
+            names.append(messageCompressorName(configuredCompressors[i]));
+        }
+        names.doneFast();
+    }
+
+    void finishMessageCompressionNegotiation(const BSONObj& isMasterResponse,
+                                             AbstractMessagingPort* port) {
+        BSONElement chosen = isMasterResponse[kCompressionFieldName];
+        if (chosen.type() != Array) {
+            return;
+        }
+
+        BSONObjIterator it(chosen.Obj());
+        if (!it.more()) {
+            return;
+        }
+
+        BSONElement name = it.next();
+        MessageCompressorId id;
+        if (name.type() != String || !parseMessageCompressorName(name.valueStringData(), &id) ||
+            !isConfigured(id)) {
+            warning() << "server " << port->remote() << " chose an unexpected network message "
+                      << "compressor: " << name;
+            return;
+        }
+
+        LOG(1) << "compressing messages to " << port->remote() << " with "
+               << messageCompressorName(id);
+        port->setMessageCompressor(id);
+    }
+
+    void negotiateMessageCompression(const BSONObj& cmdObj,
+                                     AbstractMessagingPort* port,
+                                     BSONObjBuilder* response) {
+        BSONElement offered = cmdObj[kCompressionFieldName];
+        if (!port || offered.type() != Array) {
+            return;
+        }
+
+        // Walk our own list so that our preference order wins.
+        for (size_t i = 0; i < configuredCompressors.size(); ++i) {
+            const StringData name = messageCompressorName(configuredCompressors[i]);
+
+            BSONObjIterator it(offered.Obj());
+            while (it.more()) {
+                BSONElement e = it.next();
+                if (e.type() == String && e.valueStringData() == name) {
+                    port->setMessageCompressor(configuredCompressors[i]);
+                    response->append(kCompressionFieldName, BSON_ARRAY(name));
+                    return;
+                }
+            }
+        }
+
+        // None of the offered compressors are acceptable; answer with an empty list so the
+        // client knows the request was understood.
+        response->append(kCompressionFieldName, BSONArray());
+    }
+
+}  // namespace mongo
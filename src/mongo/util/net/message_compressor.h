@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+    class AbstractMessagingPort;
+    class BSONObj;
+    class BSONObjBuilder;
+    class Message;
+
+    /**
+     * Identifies the algorithm used for the body of a dbCompressed message. These values go on
+     * the wire and must never be reused.
+     */
+    enum class MessageCompressorId : unsigned char {
+        kNoop = 0,
+        kSnappy = 1,
+        kZlib = 2,
+    };
+
+    /**
+     * Name of "id" as used in the isMaster compression handshake and in the
+     * networkMessageCompressors server parameter.
+     */
+    StringData messageCompressorName(MessageCompressorId id);
+
+    /**
+     * Parses a compressor name, as produced by messageCompressorName(). Returns false if "name"
+     * does not name a known compressor.
+     */
+    bool parseMessageCompressorName(StringData name, MessageCompressorId* out);
+
+    /**
+     * The compressors this process is willing to use, in order of preference, as configured by
+     * the networkMessageCompressors startup parameter. Empty, the default, means compression is
+     * disabled in both directions.
+     */
+    const std::vector<MessageCompressorId>& getConfiguredMessageCompressors();
+
+    /**
+     * Wraps "source" in a dbCompressed envelope compressed with "id" and stores the result in
+     * "out", which must be empty. The envelope keeps the id and responseTo of "source".
+     *
+     * Returns false, leaving "out" empty, if compression would not make the message smaller;
+     * the caller should send "source" unchanged in that case.
+     */
+    bool compressMessage(MessageCompressorId id, const Message& source, Message* out);
+
+    /**
+     * Unwraps the dbCompressed message "source" into "out", which must be empty. The result
+     * keeps the id and responseTo of the envelope.
+     */
+    Status decompressMessage(const Message& source, Message* out);
+
+    /**
+     * Client side of the handshake: appends the configured compressors to an outgoing isMaster
+     * command. Appends nothing if compression is disabled.
+     */
+    void appendMessageCompressionRequest(BSONObjBuilder* isMasterCmd);
+
+    /**
+     * Client side of the handshake: enables on "port" the compressor the server picked in its
+     * isMaster response, if any.
+     */
+    void finishMessageCompressionNegotiation(const BSONObj& isMasterResponse,
+                                             AbstractMessagingPort* port);
+
+    /**
+     * Server side of the handshake: if the isMaster command "cmdObj" offers compressors, picks
+     * the first one this process is configured to use, enables it on "port" and reports it in the
+     * response. "port" may be NULL (e.g. for DBDirectClient), in which case nothing is done.
+     *
+     * Compression is enabled immediately, so the isMaster response itself may be compressed. This
+     * is safe because a client announcing a compressor is able to decompress with it.
+     */
+    void negotiateMessageCompression(const BSONObj& cmdObj,
+                                     AbstractMessagingPort* port,
+                                     BSONObjBuilder* response);
+
+}  // namespace mongo
@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
+
+namespace mongo {
+namespace {
+
+    // A compressible query message with a known id and responseTo.
+    void makeQueryMessage(Message* out, int numDocs) {
+        BufBuilder b;
+        b.appendNum(0);  // flags
+        b.appendStr("test.coll");
+        b.appendNum(0);  // nToSkip
+        b.appendNum(0);  // nToReturn
+        for (int i = 0; i < numDocs; ++i) {
+            BSONObj doc = BSON("_id" << i << "payload" << std::string(100, 'x'));
+            b.appendBuf(doc.objdata(), doc.objsize());
+        }
+        out->setData(dbQuery, b.buf(), b.len());
+        out->header().setId(1234);
+        out->header().setResponseTo(5678);
+    }
+
+    void assertSameMessage(const Message& expected, const Message& actual) {
+        ASSERT_EQUALS(expected.operation(), actual.operation());
+        ASSERT_EQUALS(expected.header().getId(), actual.header().getId());
+        ASSERT_EQUALS(expected.header().getResponseTo(), actual.header().getResponseTo());
+        ASSERT_EQUALS(expected.size(), actual.size());
+        ASSERT_EQUALS(0, memcmp(expected.header().data(),
+                                actual.header().data(),
+                                expected.dataSize()));
+    }
+
+    void checkRoundTrip(MessageCompressorId id) {
+        Message original;
+        makeQueryMessage(&original, 100);
+
+        Message compressed;
+        ASSERT_TRUE(compressMessage(id, original, &compressed));
+        ASSERT_EQUALS(dbCompressed, compressed.operation());
+        ASSERT_EQUALS(original.header().getId(), compressed.header().getId());
+        ASSERT_EQUALS(original.header().getResponseTo(), compressed.header().getResponseTo());
+        ASSERT_LESS_THAN(compressed.size(), original.size());
+
+        Message decompressed;
+        ASSERT_OK(decompressMessage(compressed, &decompressed));
+        assertSameMessage(original, decompressed);
+    }
+
+    TEST(MessageCompressor, SnappyRoundTrip) {
+        checkRoundTrip(MessageCompressorId::kSnappy);
+    }
+
+    TEST(MessageCompressor, ZlibRoundTrip) {
+        checkRoundTrip(MessageCompressorId::kZlib);
+    }
+
+    TEST(MessageCompressor, IncompressibleMessageIsLeftAlone) {
+        Message original;
+        original.setData(dbQuery, "x");
+
+        Message compressed;
+        ASSERT_FALSE(compressMessage(MessageCompressorId::kSnappy, original, &compressed));
+        ASSERT_TRUE(compressed.empty());
+    }
+
+    TEST(MessageCompressor, CorruptMessageIsRejected) {
+        Message original;
+        makeQueryMessage(&original, 100);
+
+        Message compressed;
+        ASSERT_TRUE(compressMessage(MessageCompressorId::kZlib, original, &compressed));
+
+        // Flip some bits in the compressed body.
+        char* body = compressed.header().data();
+        for (int i = 20; i < 40; ++i) {
+            body[i] = ~body[i];
+        }
+
+        Message decompressed;
+        ASSERT_NOT_OK(decompressMessage(compressed, &decompressed));
+        ASSERT_TRUE(decompressed.empty());
+    }
+
+    TEST(MessageCompressor, TruncatedEnvelopeIsRejected) {
+        Message compressed;
+        compressed.setData(dbCompressed, "abc");
+
+        Message decompressed;
+        ASSERT_NOT_OK(decompressMessage(compressed, &decompressed));
+    }
+
+    TEST(MessageCompressor, CompressorNames) {
+        MessageCompressorId id;
+        ASSERT_TRUE(parseMessageCompressorName("snappy", &id));
+        ASSERT(MessageCompressorId::kSnappy == id);
+        ASSERT_TRUE(parseMessageCompressorName("zlib", &id));
+        ASSERT(MessageCompressorId::kZlib == id);
+        ASSERT_FALSE(parseMessageCompressorName("lz4", &id));
+        ASSERT_EQUALS("snappy", messageCompressorName(MessageCompressorId::kSnappy));
+    }
+
+}  // namespace
+}  // namespace mongo
@@ -243,6 +243,18 @@ again:
 
             guard.Dismiss();
             m.setData(md.view2ptr(), true);
+
+            if (m.operation() == dbCompressed) {
+                Message decompressed;
+                Status status = decompressMessage(m, &decompressed);
+                if (!status.isOK()) {
+                    LOG(0) << "recv(): invalid compressed message: " << status;
+                    m.reset();
+                    return false;
+                }
+                m.reset();
+                m = decompressed;
+            }
             return true;
 
         }
@@ -315,6 +327,15 @@ again:
             }
         }
 
+        if (getMessageCompressor() != MessageCompressorId::kNoop) {
+            toSend.concat();
+            Message compressed;
+            if (compressMessage(getMessageCompressor(), toSend, &compressed)) {
+                compressed.send(*this, "say");
+                return;
+            }
+        }
+
         toSend.send( *this, "say" );
     }
 
@@ -34,6 +34,7 @@
 
 #include "mongo/config.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/sock.h"
 
 namespace mongo {
@@ -43,7 +44,8 @@ namespace mongo {
 
     class AbstractMessagingPort : boost::noncopyable {
     public:
-        AbstractMessagingPort() : tag(0), _connectionId(0) {}
+        AbstractMessagingPort()
+            : tag(0), _connectionId(0), _compressor(MessageCompressorId::kNoop) {}
         virtual ~AbstractMessagingPort() { }
         virtual void reply(Message& received, Message& response, MSGID responseTo) = 0; // like the reply below, but doesn't rely on received.data still being available
         virtual void reply(Message& received, Message& response) = 0;
@@ -64,6 +66,13 @@ namespace mongo {
         long long connectionId() const { return _connectionId; }
         void setConnectionId( long long connectionId );
 
+        /**
+         * The compressor applied to outgoing messages, as negotiated during the isMaster
+         * handshake. Incoming compressed messages are always accepted.
+         */
+        MessageCompressorId getMessageCompressor() const { return _compressor; }
+        void setMessageCompressor(MessageCompressorId id) { _compressor = id; }
+
     public:
         // TODO make this private with some helpers
 
@@ -73,6 +82,7 @@ namespace mongo {
     private:
         long long _connectionId;
         std::string _x509SubjectName;
+        MessageCompressorId _compressor;
     };
 
     class MessagingPort : public AbstractMessagingPort {
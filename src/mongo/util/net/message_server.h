@@ -36,12 +36,23 @@
 
 #include "mongo/platform/basic.h"
 
+#include <memory>
+
 namespace mongo {
 
     class MessageHandler {
     public:
+        /**
+         * Per-connection state which a handler has detached from the thread that was servicing
+         * the connection. See suspend() and resume().
+         */
+        class ConnectionState {
+        public:
+            virtual ~ConnectionState() {}
+        };
+
         virtual ~MessageHandler() {}
-        
+
         /**
          * called once when a socket is connected
          */
@@ -52,6 +63,27 @@ namespace mongo {
          * handler is responsible for responding to client
          */
         virtual void process(Message& m, AbstractMessagingPort* p) = 0;
+
+        /**
+         * Returns true if this handler supports moving a connection between threads via
+         * suspend() and resume(). Servers must not park connections of handlers that do not.
+         */
+        virtual bool supportsSuspend() const { return false; }
+
+        /**
+         * Called on the servicing thread when a connection goes idle and the server is about to
+         * park it. The handler must detach whatever per-connection state it keeps in thread-local
+         * storage and return it. The connection may subsequently be resumed on any thread.
+         */
+        virtual std::unique_ptr<ConnectionState> suspend(AbstractMessagingPort* p) {
+            return std::unique_ptr<ConnectionState>();
+        }
+
+        /**
+         * Called on the thread that is about to service a previously suspended connection, with
+         * the state returned by suspend().
+         */
+        virtual void resume(AbstractMessagingPort* p, std::unique_ptr<ConnectionState> state) {}
     };
 
     class MessageServer {
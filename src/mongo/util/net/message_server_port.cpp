@@ -32,14 +32,20 @@
 #include "mongo/platform/basic.h"
 
 #include <boost/thread/thread.hpp>
+#include <deque>
 #include <memory>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/config.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/stdx/chrono.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/synchronization.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/concurrency/ticketholder.h"
@@ -51,13 +57,20 @@
 #include "mongo/util/net/message.h"
 #include "mongo/util/net/message_port.h"
 #include "mongo/util/net/message_server.h"
+#include "mongo/util/net/socket_poll.h"
 #include "mongo/util/net/ssl_manager.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/scopeguard.h"
 
 #ifdef __linux__  // TODO: consider making this ifndef _WIN32
 # include <sys/resource.h>
 #endif
 
+#ifndef _WIN32
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
 #if !defined(__has_feature)
 #define __has_feature(x) 0
 #endif
@@ -69,6 +82,49 @@ namespace mongo {
 
 namespace {
 
+    const char kThreadPerConnectionIngress[] = "threadPerConnection";
+    const char kReactorIngress[] = "reactor";
+
+    /**
+     * How accepted connections are serviced. "threadPerConnection" dedicates a thread to every
+     * connection for its whole life. "reactor" parks idle connections on a few poller threads
+     * and services the ones with pending requests from a worker pool whose size follows load.
+     */
+    std::string messageServerIngressMode = kThreadPerConnectionIngress;
+
+    class ExportedIngressModeParameter : public ExportedServerParameter<std::string> {
+    public:
+        ExportedIngressModeParameter() :
+            ExportedServerParameter<std::string>(ServerParameterSet::getGlobal(),
+                                                 "messageServerIngressMode",
+                                                 &messageServerIngressMode,
+                                                 true,
+                                                 false) {}
+
+        virtual Status validate(const std::string& potentialNewValue) {
+            if (potentialNewValue != kThreadPerConnectionIngress &&
+                potentialNewValue != kReactorIngress) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "messageServerIngressMode must be either '"
+                                            << kThreadPerConnectionIngress << "' or '"
+                                            << kReactorIngress << "'");
+            }
+            return Status::OK();
+        }
+    } exportedIngressModeParam;
+
+    // Number of threads polling idle connections in reactor mode.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(messageServerReactorThreads, int, 1);
+
+    // Upper bound on the number of threads servicing ready connections in reactor mode.
+    // Connections that become ready while all of them are busy wait in a queue.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(messageServerMaxWorkerThreads, int, 512);
+
+    // How long an idle reactor worker thread lingers before exiting.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(messageServerWorkerIdleMillis, int, 30 * 1000);
+
+    const size_t kConnectionThreadStackSize = 1024 * 1024;
+
     class MessagingPortWithHandler : public MessagingPort {
         MONGO_DISALLOW_COPYING(MessagingPortWithHandler);
 
@@ -82,11 +138,231 @@ namespace {
 
         MessageHandler* getHandler() const { return _handler; }
 
+        // Used only in reactor mode, by whichever thread currently owns the port.
+
+        // Whether the handler has seen connected() for this port yet.
+        bool handlerConnected = false;
+
+        // Handler state of a parked connection, as returned by MessageHandler::suspend().
+        std::unique_ptr<MessageHandler::ConnectionState> suspendedState;
+
     private:
         // Not owned.
         MessageHandler* const _handler;
     };
 
+    /**
+     * Pool of threads servicing ready connections in reactor mode. Threads are started on demand,
+     * up to a maximum, and exit after sitting idle, so the number of threads follows the number
+     * of connections with outstanding requests rather than the number of open connections.
+     */
+    class IngressWorkerPool {
+        MONGO_DISALLOW_COPYING(IngressWorkerPool);
+    public:
+        typedef stdx::function<void()> Task;
+
+        IngressWorkerPool(size_t maxThreads, Milliseconds idleTimeout)
+            : _maxThreads(maxThreads), _idleTimeout(idleTimeout) {}
+
+        /**
+         * Queues "task" to run on a worker thread, starting a new thread if all existing ones are
+         * busy and the maximum has not been reached. Never blocks waiting for a thread.
+         *
+         * Throws boost::thread_resource_error if no worker thread exists and none could be
+         * started, in which case "task" has not been queued.
+         */
+        void schedule(Task task) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _tasks.push_back(std::move(task));
+
+            if (_tasks.size() > _numIdle && _numThreads < _maxThreads) {
+                try {
+                    boost::thread::attributes attrs;
+                    attrs.set_stack_size(kConnectionThreadStackSize);
+                    boost::thread(attrs, stdx::bind(&IngressWorkerPool::_workerLoop, this))
+                        .detach();
+                    ++_numThreads;
+                }
+                catch (const boost::thread_resource_error&) {
+                    if (_numThreads == 0) {
+                        _tasks.pop_back();
+                        throw;
+                    }
+                    // Existing workers will get to the task eventually.
+                    warning() << "can't start new connection worker thread, "
+                              << _tasks.size() << " ready connections waiting";
+                }
+            }
+
+            _condition.notify_one();
+        }
+
+    private:
+        void _workerLoop() {
+            setThreadName("connworker");
+            NumaThreadPlacement numaPlacement;
+
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            while (true) {
+                if (_tasks.empty()) {
+                    lk.unlock();
+                    markThreadIdle();
+                    lk.lock();
+                }
+
+                while (_tasks.empty()) {
+                    ++_numIdle;
+                    const stdx::cv_status waitStatus = _condition.wait_for(lk, _idleTimeout);
+                    --_numIdle;
+
+                    if (waitStatus == stdx::cv_status::timeout && _tasks.empty()) {
+                        --_numThreads;
+                        lk.unlock();
+#ifdef MONGO_CONFIG_SSL
+                        SSLManagerInterface* manager = getSSLManager();
+                        if (manager)
+                            manager->cleanupThreadLocals();
+#endif
+                        return;
+                    }
+                }
+
+                Task task = std::move(_tasks.front());
+                _tasks.pop_front();
+
+                lk.unlock();
+                task();
+                lk.lock();
+            }
+        }
+
+        const size_t _maxThreads;
+        const Milliseconds _idleTimeout;
+
+        stdx::mutex _mutex;
+        stdx::condition_variable _condition;
+
+        // Everything below is protected by _mutex.
+        std::deque<Task> _tasks;
+        size_t _numThreads = 0;
+        size_t _numIdle = 0;
+    };
+
+#ifndef _WIN32
+    /**
+     * A poller thread for reactor mode. Parked connections are idle connections that are not
+     * being serviced by any thread; once one of them becomes readable (or is closed by the
+     * peer) the reactor hands it to the ready callback, transferring ownership.
+     */
+    class IngressReactor {
+        MONGO_DISALLOW_COPYING(IngressReactor);
+    public:
+        typedef stdx::function<void(MessagingPortWithHandler*)> ReadyCallback;
+
+        explicit IngressReactor(ReadyCallback onReady) : _onReady(std::move(onReady)) {
+            fassert(28700, pipe(_wakePipe) == 0);
+            for (int i = 0; i < 2; ++i) {
+                fassert(28701, fcntl(_wakePipe[i], F_SETFL, O_NONBLOCK) == 0);
+                fassert(28702, fcntl(_wakePipe[i], F_SETFD, FD_CLOEXEC) == 0);
+            }
+        }
+
+        void start() {
+            boost::thread(stdx::bind(&IngressReactor::_run, this)).detach();
+        }
+
+        /**
+         * Hands "port" over to the reactor until data is available on it.
+         */
+        void park(MessagingPortWithHandler* port) {
+            bool needWake;
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                needWake = _incoming.empty();
+                _incoming.push_back(port);
+            }
+
+            if (needWake) {
+                const char byte = 0;
+                if (write(_wakePipe[1], &byte, 1) < 0) {
+                    // The pipe is full, so the reactor is already due to wake up.
+                }
+            }
+        }
+
+    private:
+        void _run() {
+            setThreadName("connreactor");
+
+            std::vector<MessagingPortWithHandler*> parked;
+            std::vector<MessagingPortWithHandler*> ready;
+            std::vector<pollfd> pollFds;
+
+            while (!inShutdown()) {
+                {
+                    stdx::lock_guard<stdx::mutex> lk(_mutex);
+                    parked.insert(parked.end(), _incoming.begin(), _incoming.end());
+                    _incoming.clear();
+                }
+
+                pollFds.resize(parked.size() + 1);
+                pollFds[0].fd = _wakePipe[0];
+                pollFds[0].events = POLLIN;
+                pollFds[0].revents = 0;
+                for (size_t i = 0; i < parked.size(); ++i) {
+                    pollFds[i + 1].fd = parked[i]->psock->rawFD();
+                    pollFds[i + 1].events = POLLIN;
+                    pollFds[i + 1].revents = 0;
+                }
+
+                // The timeout only bounds how long it takes to notice shutdown.
+                const int nEvents = socketPoll(&pollFds[0], pollFds.size(), 1000);
+                if (nEvents < 0) {
+                    const int pollErrno = errno;
+                    if (pollErrno != EINTR) {
+                        error() << "poll() failed on parked connections: "
+                                << errnoWithDescription(pollErrno);
+                        sleepmillis(10);
+                    }
+                    continue;
+                }
+                if (nEvents == 0) {
+                    continue;
+                }
+
+                if (pollFds[0].revents) {
+                    char buf[64];
+                    while (read(_wakePipe[0], buf, sizeof(buf)) > 0) {
+                    }
+                }
+
+                // Any event, including POLLHUP and POLLERR, means a recv() will not block.
+                size_t numStillParked = 0;
+                for (size_t i = 0; i < parked.size(); ++i) {
+                    if (pollFds[i + 1].revents) {
+                        ready.push_back(parked[i]);
+                    }
+                    else {
+                        parked[numStillParked++] = parked[i];
+                    }
+                }
+                parked.resize(numStillParked);
+
+                for (size_t i = 0; i < ready.size(); ++i) {
+                    _onReady(ready[i]);
+                }
+                ready.clear();
+            }
+        }
+
+        const ReadyCallback _onReady;
+        int _wakePipe[2];
+
+        stdx::mutex _mutex;
+        std::vector<MessagingPortWithHandler*> _incoming;  // protected by _mutex
+    };
+#endif  // ndef _WIN32
+
 }  // namespace
 
     class PortMessageServer : public MessageServer , public Listener {
@@ -112,6 +388,21 @@ namespace {
                 return;
             }
 
+            if (_workers) {
+                try {
+                    _workers->schedule(stdx::bind(&PortMessageServer::serviceReadyConnection,
+                                                  this,
+                                                  portWithHandler.get()));
+                    portWithHandler.release();
+                    sleepAfterClosingPort.Dismiss();
+                }
+                catch (const boost::thread_resource_error&) {
+                    Listener::globalTicketHolder.release();
+                    log() << "can't create new thread, closing connection" << endl;
+                }
+                return;
+            }
+
             try {
 #ifndef __linux__  // TODO: consider making this ifdef _WIN32
                 {
@@ -122,12 +413,11 @@ namespace {
                 pthread_attr_init(&attrs);
                 pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
 
-                static const size_t STACK_SIZE = 1024*1024; // if we change this we need to update the warning
-
+                // if we change kConnectionThreadStackSize we need to update the warning
                 struct rlimit limits;
                 verify(getrlimit(RLIMIT_STACK, &limits) == 0);
-                if (limits.rlim_cur > STACK_SIZE) {
-                    size_t stackSizeToSet = STACK_SIZE;
+                if (limits.rlim_cur > kConnectionThreadStackSize) {
+                    size_t stackSizeToSet = kConnectionThreadStackSize;
 #if !__has_feature(address_sanitizer)
                     if (kDebugBuild)
                         stackSizeToSet /= 2;
@@ -172,6 +462,9 @@ namespace {
         }
 
         void run() {
+            if (messageServerIngressMode == kReactorIngress) {
+                startReactorIngress();
+            }
             initAndListen();
         }
 
@@ -180,6 +473,163 @@ namespace {
     private:
         MessageHandler* _handler;
 
+        // Set only in reactor mode, before the first connection is accepted.
+        std::unique_ptr<IngressWorkerPool> _workers;
+#ifndef _WIN32
+        std::vector<std::unique_ptr<IngressReactor>> _reactors;
+#endif
+
+        void startReactorIngress() {
+#ifdef _WIN32
+            warning() << "messageServerIngressMode '" << kReactorIngress << "' is not supported "
+                      << "on this platform, using one thread per connection";
+#else
+            if (!_handler->supportsSuspend()) {
+                warning() << "messageServerIngressMode '" << kReactorIngress << "' is not "
+                          << "supported by this server, using one thread per connection";
+                return;
+            }
+
+            const int numReactors = std::max(1, messageServerReactorThreads);
+            const int maxWorkers = std::max(1, messageServerMaxWorkerThreads);
+            log() << "servicing connections with " << numReactors << " reactor thread(s) and "
+                  << "up to " << maxWorkers << " worker threads";
+
+            _workers.reset(new IngressWorkerPool(
+                maxWorkers, Milliseconds(std::max(0, messageServerWorkerIdleMillis))));
+            for (int i = 0; i < numReactors; ++i) {
+                _reactors.emplace_back(new IngressReactor(
+                    stdx::bind(&PortMessageServer::scheduleParkedConnection, this,
+                               stdx::placeholders::_1)));
+                _reactors.back()->start();
+            }
+#endif
+        }
+
+        static void logEndConnection(MessagingPortWithHandler* portWithHandler) {
+            if (!serverGlobalParams.quiet) {
+                int conns = Listener::globalTicketHolder.used()-1;
+                const char* word = (conns == 1 ? " connection" : " connections");
+                log() << "end connection " << portWithHandler->psock->remoteString()
+                      << " (" << conns << word << " now open)" << endl;
+            }
+        }
+
+#ifndef _WIN32
+        /**
+         * Returns true if a recv() on the port would not block, i.e. the client has already
+         * sent (part of) its next request or closed the connection.
+         */
+        static bool hasPendingInput(MessagingPortWithHandler* portWithHandler) {
+            if (portWithHandler->psock->hasBufferedInput()) {
+                return true;
+            }
+
+            pollfd pollInfo;
+            pollInfo.fd = portWithHandler->psock->rawFD();
+            pollInfo.events = POLLIN;
+            pollInfo.revents = 0;
+            // Errors are reported by the recv() that follows.
+            return socketPoll(&pollInfo, 1, 0) != 0;
+        }
+
+        /**
+         * Reactor callback for a parked connection which became readable.
+         */
+        void scheduleParkedConnection(MessagingPortWithHandler* arg) {
+            try {
+                _workers->schedule(
+                    stdx::bind(&PortMessageServer::serviceReadyConnection, this, arg));
+            }
+            catch (const boost::thread_resource_error&) {
+                unique_ptr<MessagingPortWithHandler> portWithHandler(arg);
+                log() << "can't create new thread, closing connection " << endl;
+                portWithHandler->shutdown();
+                Listener::globalTicketHolder.release();
+            }
+        }
+#endif
+
+        /**
+         * Reactor mode counterpart of handleIncomingMsg(). Runs on a worker thread and handles
+         * requests from the connection until it goes idle, at which point the connection is
+         * suspended and parked on its reactor. Terminates the connection under the same
+         * conditions as handleIncomingMsg().
+         *
+         * @param arg this method takes ownership of the arg object.
+         */
+        void serviceReadyConnection(MessagingPortWithHandler* arg) {
+            invariant(arg);
+            unique_ptr<MessagingPortWithHandler> portWithHandler(arg);
+            MessageHandler* const handler = portWithHandler->getHandler();
+
+            // Whether the handler's per-connection state is bound to this thread.
+            bool stateOnThisThread = false;
+
+            Message m;
+            try {
+                if (!portWithHandler->handlerConnected) {
+                    portWithHandler->psock->setLogLevel(logger::LogSeverity::Debug(1));
+                    handler->connected(portWithHandler.get());
+                    portWithHandler->handlerConnected = true;
+                }
+                else {
+                    handler->resume(portWithHandler.get(),
+                                    std::move(portWithHandler->suspendedState));
+                }
+                stateOnThisThread = true;
+
+                while ( ! inShutdown() ) {
+                    m.reset();
+                    portWithHandler->psock->clearCounters();
+
+                    if (!portWithHandler->recv(m)) {
+                        logEndConnection(portWithHandler.get());
+                        portWithHandler->shutdown();
+                        break;
+                    }
+
+                    handler->process(m, portWithHandler.get());
+                    networkCounter.hit(portWithHandler->psock->getBytesIn(),
+                                       portWithHandler->psock->getBytesOut());
+
+#ifndef _WIN32
+                    if (!hasPendingInput(portWithHandler.get())) {
+                        portWithHandler->suspendedState = handler->suspend(portWithHandler.get());
+                        stateOnThisThread = false;
+
+                        const size_t reactor = portWithHandler->connectionId() % _reactors.size();
+                        _reactors[reactor]->park(portWithHandler.release());
+                        return;
+                    }
+#endif
+                }
+            }
+            catch ( AssertionException& e ) {
+                log() << "AssertionException handling request, closing client connection: " << e << endl;
+                portWithHandler->shutdown();
+            }
+            catch ( SocketException& e ) {
+                log() << "SocketException handling request, closing client connection: " << e << endl;
+                portWithHandler->shutdown();
+            }
+            catch ( const DBException& e ) { // must be right above std::exception to avoid catching subclasses
+                log() << "DBException handling request, closing client connection: " << e << endl;
+                portWithHandler->shutdown();
+            }
+            catch ( std::exception &e ) {
+                error() << "Uncaught std::exception: " << e.what() << ", terminating" << endl;
+                dbexit( EXIT_UNCAUGHT );
+            }
+
+            // The connection is done. Detach and discard its state so the thread can go on to
+            // service other connections.
+            if (stateOnThisThread) {
+                handler->suspend(portWithHandler.get());
+            }
+            Listener::globalTicketHolder.release();
+        }
+
         /**
          * Handles incoming messages from a given socket.
          *
@@ -201,6 +651,7 @@ namespace {
             MessageHandler* const handler = portWithHandler->getHandler();
 
             setThreadName(std::string(str::stream() << "conn" << portWithHandler->connectionId()));
+            NumaThreadPlacement numaPlacement;
             portWithHandler->psock->setLogLevel(logger::LogSeverity::Debug(1));
 
             Message m;
@@ -213,12 +664,7 @@ namespace {
                     portWithHandler->psock->clearCounters();
 
                     if (!portWithHandler->recv(m)) {
-                        if (!serverGlobalParams.quiet) {
-                            int conns = Listener::globalTicketHolder.used()-1;
-                            const char* word = (conns == 1 ? " connection" : " connections");
-                            log() << "end connection " << portWithHandler->psock->remoteString()
-                                  << " (" << conns << word << " now open)" << endl;
-                        }
+                        logEndConnection(portWithHandler.get());
                         portWithHandler->shutdown();
                         break;
                     }
@@ -846,8 +846,28 @@ namespace mongo {
     // -1 : never check
     const int Socket::errorPollIntervalSecs( 5 );
 
+    bool Socket::hasBufferedInput() const {
+#ifdef MONGO_CONFIG_SSL
+        if (_sslConnection) {
+            return SSL_pending(_sslConnection->ssl) > 0 ||
+                BIO_ctrl_pending(_sslConnection->internalBIO) > 0;
+        }
+#endif
+        return false;
+    }
+
+    int Socket::releaseFD() {
+#ifdef MONGO_CONFIG_SSL
+        invariant(!_sslConnection);
+#endif
+        const int fd = _fd;
+        _fd = -1;
+        return fd;
+    }
+
     // Patch to allow better tolerance of flaky network connections that get broken
     // while we aren't looking.
+
     // TODO: Remove when better async changes come.
     //
     // isStillConnected() polls the socket at max every Socket::errorPollIntervalSecs to determine
@@ -245,6 +245,20 @@ namespace mongo {
         void setTimeout( double secs );
         bool isStillConnected();
 
+        /**
+         * Returns true if input has already been read off the wire and is buffered inside this
+         * Socket (e.g. by the SSL layer), in which case the readiness of rawFD() does not reflect
+         * whether a recv() would block.
+         */
+        bool hasBufferedInput() const;
+
+        /**
+         * Relinquishes ownership of the underlying file descriptor to the caller, who becomes
+         * responsible for closing it, and leaves this Socket closed. Only valid for sockets
+         * which have not been secured with SSL.
+         */
+        int releaseFD();
+
         void setHandshakeReceived() {
             _awaitingHandshake = false;
         }
@@ -32,9 +32,12 @@
 #include "mongo/util/net/ssl_manager.h"
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/tss.hpp>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -157,6 +160,15 @@ namespace mongo {
         static const int BUFFER_SIZE = 8*1024;
         static const int DATE_LEN = 128;
 
+        // The most remote addresses for which outgoing connections remember a session to resume
+        const size_t kMaxCachedClientSessions = 1000;
+
+        // Handshakes completed, by whether they resumed an earlier session, for serverStatus
+        AtomicInt64 serverFullHandshakes;
+        AtomicInt64 serverResumedHandshakes;
+        AtomicInt64 clientFullHandshakes;
+        AtomicInt64 clientResumedHandshakes;
+
         class SSLManager : public SSLManagerInterface {
         public:
             explicit SSLManager(const SSLParams& params, bool isServer);
@@ -199,6 +211,24 @@ namespace mongo {
             bool _allowInvalidHostnames;
             SSLConfiguration _sslConfiguration;
 
+            // Most recent session established by an outgoing connection to each remote address.
+            // Each holds a reference which is released when it is replaced or the manager is
+            // destroyed.
+            boost::mutex _clientSessionsMutex;
+            std::map<std::string, SSL_SESSION*> _clientSessions;
+
+            /**
+             * Offers the session remembered for the remote address of 'conn', if any, for
+             * resumption by the handshake which is about to start.
+             */
+            void _setClientSession(SSLConnection* conn);
+
+            /**
+             * Remembers 'session', taking over the caller's reference, as the one to resume with
+             * the next outgoing connection to 'remote'.
+             */
+            void _storeClientSession(const std::string& remote, SSL_SESSION* session);
+
             /**
              * creates an SSL object to be used for this file descriptor.
              * caller must SSL_free it.
@@ -272,6 +302,7 @@ namespace mongo {
              */
             static int password_cb( char *buf,int num, int rwflag,void *userdata );
             static int verify_cb(int ok, X509_STORE_CTX *ctx);
+            static int newClientSession_cb(SSL* ssl, SSL_SESSION* session);
 
         };
 
@@ -407,6 +438,14 @@ namespace mongo {
                             hasCA);
         security.appendDate("SSLServerCertificateExpirationDate",
                             serverCertificateExpirationDate);
+
+        BSONObjBuilder handshakes(security.subobjStart("SSLHandshakes"));
+        handshakes.appendNumber("serverFull", serverFullHandshakes.load());
+        handshakes.appendNumber("serverResumed", serverResumedHandshakes.load());
+        handshakes.appendNumber("clientFull", clientFullHandshakes.load());
+        handshakes.appendNumber("clientResumed", clientResumedHandshakes.load());
+        handshakes.done();
+
         return security.obj();
     }
 
@@ -423,6 +462,14 @@ namespace mongo {
             uasserted(16768, "ssl initialization problem"); 
         }
 
+        // Outgoing connections resume the last session established with the same remote address
+        // when they can, which spares both sides the full handshake when reconnecting. OpenSSL
+        // hands each new session to newClientSession_cb, which keeps it in _clientSessions.
+        SSL_CTX_set_session_cache_mode(_clientContext,
+                                       SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_set_app_data(_clientContext, this);
+        SSL_CTX_sess_set_new_cb(_clientContext, &SSLManager::newClientSession_cb);
+
         // pick the certificate for use in outgoing connections,
         std::string clientPEM;
         if (!isServer || params.sslClusterFile.empty()) {
@@ -447,6 +494,10 @@ namespace mongo {
                 uasserted(16562, "ssl initialization problem");
             }
 
+            // Let clients resume their sessions, by session ID from the server side cache or with
+            // a session ticket (which OpenSSL enables by default).
+            SSL_CTX_set_session_cache_mode(_serverContext, SSL_SESS_CACHE_SERVER);
+
             if (!_parseAndValidateCertificate(params.sslPEMKeyFile,
                                               &_sslConfiguration.serverSubjectName,
                                               &_sslConfiguration.serverCertificateExpirationDate)) {
@@ -459,6 +510,10 @@ namespace mongo {
     }
 
     SSLManager::~SSLManager() {
+        for (const auto& remoteAndSession : _clientSessions) {
+            SSL_SESSION_free(remoteAndSession.second);
+        }
+
         if (NULL != _serverContext) {
             SSL_CTX_free(_serverContext);
         }
@@ -480,6 +535,44 @@ namespace mongo {
 	return 1; // always succeed; we will catch the error in our get_verify_result() call
     }
 
+    int SSLManager::newClientSession_cb(SSL* ssl, SSL_SESSION* session) {
+        SSLManager* manager = static_cast<SSLManager*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+        SSLConnection* conn = static_cast<SSLConnection*>(SSL_get_app_data(ssl));
+        if (!manager || !conn) {
+            return 0;
+        }
+
+        manager->_storeClientSession(conn->socket->remoteString(), session);
+        return 1; // we keep the reference to the session
+    }
+
+    void SSLManager::_setClientSession(SSLConnection* conn) {
+        SSL_set_app_data(conn->ssl, conn);
+
+        boost::lock_guard<boost::mutex> lk(_clientSessionsMutex);
+        auto it = _clientSessions.find(conn->socket->remoteString());
+        if (it != _clientSessions.end()) {
+            // Takes its own reference
+            SSL_set_session(conn->ssl, it->second);
+        }
+    }
+
+    void SSLManager::_storeClientSession(const std::string& remote, SSL_SESSION* session) {
+        boost::lock_guard<boost::mutex> lk(_clientSessionsMutex);
+        auto it = _clientSessions.find(remote);
+        if (it != _clientSessions.end()) {
+            SSL_SESSION_free(it->second);
+            it->second = session;
+            return;
+        }
+
+        if (_clientSessions.size() >= kMaxCachedClientSessions) {
+            SSL_SESSION_free(_clientSessions.begin()->second);
+            _clientSessions.erase(_clientSessions.begin());
+        }
+        _clientSessions[remote] = session;
+    }
+
     int SSLManager::SSL_read(SSLConnection* conn, void* buf, int num) {
         int status;
         do {
@@ -845,6 +938,7 @@ namespace mongo {
 
     SSLConnection* SSLManager::connect(Socket* socket) {
         std::unique_ptr<SSLConnection> sslConn = stdx::make_unique<SSLConnection>(_clientContext, socket, (const char*)NULL, 0);
+        _setClientSession(sslConn.get());
  
         int ret;
         do {
@@ -853,6 +947,13 @@ namespace mongo {
  
         if (ret != 1)
             _handleSSLError(SSL_get_error(sslConn.get(), ret), ret);
+
+        if (SSL_session_reused(sslConn->ssl)) {
+            clientResumedHandshakes.fetchAndAdd(1);
+        }
+        else {
+            clientFullHandshakes.fetchAndAdd(1);
+        }
  
         return sslConn.release();
     }
@@ -867,6 +968,13 @@ namespace mongo {
  
         if (ret != 1)
             _handleSSLError(SSL_get_error(sslConn.get(), ret), ret);
+
+        if (SSL_session_reused(sslConn->ssl)) {
+            serverResumedHandshakes.fetchAndAdd(1);
+        }
+        else {
+            serverFullHandshakes.fetchAndAdd(1);
+        }
  
         return sslConn.release();
     }
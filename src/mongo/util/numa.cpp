@@ -0,0 +1,298 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/numa.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+    bool NumaOptions::threadPlacement(false);
+    bool NumaOptions::interleaveMemory(false);
+
+namespace {
+
+    const int kMaxNumaNodes = 64;
+
+    struct NumaNode {
+        int id;
+        vector<int> cpus;
+    };
+
+    struct NumaTopology {
+        vector<NumaNode> nodes;
+    };
+
+    AtomicUInt32 nextNode;
+    AtomicInt32 threadsOnNode[kMaxNumaNodes];
+
+#if defined(__linux__)
+    const char kNodeDir[] = "/sys/devices/system/node/node";
+
+    /**
+     * Parses a kernel CPU list such as "0-7,16-23".
+     */
+    vector<int> parseCpuList(const string& list) {
+        vector<int> cpus;
+        std::istringstream in(list);
+        string range;
+        while (std::getline(in, range, ',')) {
+            int first;
+            int last;
+            char dash;
+            std::istringstream r(range);
+            if (!(r >> first)) {
+                continue;
+            }
+            if (!(r >> dash >> last) || dash != '-') {
+                last = first;
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    NumaTopology readTopology() {
+        NumaTopology topology;
+        for (int id = 0; id < kMaxNumaNodes; ++id) {
+            const string path = str::stream() << kNodeDir << id << "/cpulist";
+            std::ifstream in(path.c_str());
+            if (!in) {
+                continue;
+            }
+            string list;
+            std::getline(in, list);
+
+            NumaNode node;
+            node.id = id;
+            node.cpus = parseCpuList(list);
+            if (!node.cpus.empty()) {
+                topology.nodes.push_back(node);
+            }
+        }
+        return topology;
+    }
+
+    /**
+     * Reads the "MemTotal" and "MemFree" lines, in kB, of a node's meminfo.
+     */
+    void appendNodeMemory(int id, BSONObjBuilder* b) {
+        const string path = str::stream() << kNodeDir << id << "/meminfo";
+        std::ifstream in(path.c_str());
+        string line;
+        while (std::getline(in, line)) {
+            // "Node 0 MemTotal:       32849436 kB"
+            std::istringstream fields(line);
+            string nodeWord;
+            int nodeId;
+            string name;
+            long long kb;
+            if (!(fields >> nodeWord >> nodeId >> name >> kb)) {
+                continue;
+            }
+            if (name == "MemTotal:") {
+                b->appendNumber("memTotalMB", kb / 1024);
+            }
+            else if (name == "MemFree:") {
+                b->appendNumber("memFreeMB", kb / 1024);
+            }
+        }
+    }
+
+    /**
+     * Sums up the "N<node>=<pages>" counts of /proc/self/numa_maps, in bytes per node.
+     */
+    std::map<int, long long> processMemoryByNode() {
+        std::map<int, long long> bytes;
+        std::ifstream in("/proc/self/numa_maps");
+        string line;
+        while (std::getline(in, line)) {
+            long long pageKB = 4;
+            std::map<int, long long> pages;
+            std::istringstream fields(line);
+            string field;
+            while (fields >> field) {
+                if (field.compare(0, 18, "kernelpagesize_kB=") == 0) {
+                    pageKB = atoll(field.c_str() + 18);
+                }
+                else if (field.size() > 2 && field[0] == 'N' && isdigit(field[1])) {
+                    const string::size_type eq = field.find('=');
+                    if (eq != string::npos) {
+                        pages[atoi(field.c_str() + 1)] += atoll(field.c_str() + eq + 1);
+                    }
+                }
+            }
+            for (std::map<int, long long>::const_iterator it = pages.begin();
+                 it != pages.end(); ++it) {
+                bytes[it->first] += it->second * pageKB * 1024;
+            }
+        }
+        return bytes;
+    }
+
+    bool bindCurrentThread(const NumaNode& node) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (size_t i = 0; i < node.cpus.size(); ++i) {
+            if (node.cpus[i] < CPU_SETSIZE) {
+                CPU_SET(node.cpus[i], &set);
+            }
+        }
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+
+    bool interleaveAllNodes(const NumaTopology& topology) {
+        const int kMpolInterleave = 3;  // from linux/mempolicy.h
+        unsigned long mask = 0;
+        for (size_t i = 0; i < topology.nodes.size(); ++i) {
+            mask |= 1UL << topology.nodes[i].id;
+        }
+        return syscall(SYS_set_mempolicy, kMpolInterleave, &mask, sizeof(mask) * 8 + 1) == 0;
+    }
+#else
+    NumaTopology readTopology() {
+        return NumaTopology();
+    }
+
+    void appendNodeMemory(int id, BSONObjBuilder* b) {}
+
+    std::map<int, long long> processMemoryByNode() {
+        return std::map<int, long long>();
+    }
+
+    bool bindCurrentThread(const NumaNode& node) {
+        return false;
+    }
+
+    bool interleaveAllNodes(const NumaTopology& topology) {
+        return false;
+    }
+#endif
+
+    const NumaTopology& topology() {
+        static const NumaTopology topology = readTopology();
+        return topology;
+    }
+
+} // namespace
+
+    NumaThreadPlacement::NumaThreadPlacement() : _node(-1) {
+        if (!NumaOptions::threadPlacement) {
+            return;
+        }
+
+        const vector<NumaNode>& nodes = topology().nodes;
+        if (nodes.size() < 2) {
+            return;
+        }
+
+        const NumaNode& node = nodes[nextNode.fetchAndAdd(1) % nodes.size()];
+        if (!bindCurrentThread(node)) {
+            LOG(1) << "could not bind thread to NUMA node " << node.id;
+            return;
+        }
+        _node = node.id;
+        threadsOnNode[_node].fetchAndAdd(1);
+    }
+
+    NumaThreadPlacement::~NumaThreadPlacement() {
+        if (_node >= 0) {
+            threadsOnNode[_node].fetchAndSubtract(1);
+        }
+    }
+
+    void initializeNumaMemoryPolicy() {
+        if (!NumaOptions::interleaveMemory) {
+            return;
+        }
+
+        if (topology().nodes.size() < 2) {
+            log() << "numaInterleaveMemory is set but this host has one NUMA node";
+            return;
+        }
+
+        if (!interleaveAllNodes(topology())) {
+            warning() << "could not interleave memory over the NUMA nodes";
+            return;
+        }
+        log() << "interleaving memory over " << topology().nodes.size() << " NUMA nodes";
+    }
+
+    void appendNumaInfo(BSONObjBuilder* b, bool includeProcessMemory) {
+        const vector<NumaNode>& nodes = topology().nodes;
+        b->append("threadPlacement", NumaOptions::threadPlacement);
+        b->append("interleaveMemory", NumaOptions::interleaveMemory);
+
+        std::map<int, long long> processBytes;
+        if (includeProcessMemory) {
+            processBytes = processMemoryByNode();
+        }
+
+        BSONArrayBuilder arr(b->subarrayStart("nodes"));
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const NumaNode& node = nodes[i];
+            BSONObjBuilder nb(arr.subobjStart());
+            nb.append("node", node.id);
+            nb.append("numCpus", static_cast<int>(node.cpus.size()));
+            appendNodeMemory(node.id, &nb);
+            nb.append("threadsPlaced", threadsOnNode[node.id].load());
+            if (includeProcessMemory) {
+                nb.appendNumber("residentMB", processBytes[node.id] / (1024 * 1024));
+            }
+            nb.doneFast();
+        }
+        arr.doneFast();
+    }
+
+} // namespace mongo
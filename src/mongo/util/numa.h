@@ -0,0 +1,82 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Struct namespace for the NUMA options, set by the numaThreadPlacement and
+     * numaInterleaveMemory startup parameters of mongod.
+     */
+    struct NumaOptions {
+        static bool threadPlacement;
+        static bool interleaveMemory;
+    };
+
+    /**
+     * Spreads the threads that create one over the NUMA nodes of the host, when
+     * NumaOptions::threadPlacement is set. The calling thread is bound to the CPUs of
+     * the next node in turn for as long as the object lives, so that it stays near the memory it
+     * first touches, its stack and allocator caches included. Does nothing on hosts with one node
+     * or where binding isn't supported.
+     */
+    class NumaThreadPlacement {
+        MONGO_DISALLOW_COPYING(NumaThreadPlacement);
+    public:
+        NumaThreadPlacement();
+        ~NumaThreadPlacement();
+
+        /**
+         * The node the thread was bound to, or -1.
+         */
+        int node() const { return _node; }
+
+    private:
+        int _node;
+    };
+
+    /**
+     * Interleaves the memory of the process over all nodes if NumaOptions::interleaveMemory is
+     * set, as "numactl --interleave=all" does. Threads inherit the policy of the
+     * thread that starts them, so this must run before the server starts its threads.
+     */
+    void initializeNumaMemoryPolicy();
+
+    /**
+     * Appends the NUMA nodes of the host, with their CPUs, memory and the threads placed on them.
+     * With 'includeProcessMemory', also appends how much of this process' memory is on each node,
+     * which takes a walk over all its mappings.
+     */
+    void appendNumaInfo(BSONObjBuilder* b, bool includeProcessMemory);
+
+} // namespace mongo
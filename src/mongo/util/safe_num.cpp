@@ -79,6 +79,22 @@ namespace mongo {
         return os.str();
     }
 
+    void SafeNum::appendTo(BSONObjBuilder* builder, StringData fieldName) const {
+        switch (_type) {
+        case NumberInt:
+            builder->append(fieldName, _value.int32Val);
+            break;
+        case NumberLong:
+            builder->append(fieldName, _value.int64Val);
+            break;
+        case NumberDouble:
+            builder->append(fieldName, _value.doubleVal);
+            break;
+        default:
+            invariant(false);
+        }
+    }
+
     std::ostream& operator<<(std::ostream& os, const SafeNum& snum) {
         return os << snum.debugString();
     }
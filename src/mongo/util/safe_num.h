@@ -151,7 +151,10 @@ namespace mutablebson {
         friend class mutablebson::Element;
         friend class mutablebson::Document;
 
-        // TODO: output to builder
+        /**
+         * Appends the number to 'builder' as 'fieldName', which must be valid.
+         */
+        void appendTo(BSONObjBuilder* builder, StringData fieldName) const;
 
         //
         // accessors
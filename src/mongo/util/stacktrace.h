@@ -31,6 +31,8 @@
 
 #pragma once
 
+#include <string>
+
 #include "mongo/logger/log_severity.h"
 #include "mongo/logger/logger.h"
 #include "mongo/logger/logstream_builder.h"
@@ -56,6 +58,28 @@ namespace mongo {
     // Print stack trace information to "os", default to the log stream.
     void printStackTrace(std::ostream &os=getStackTraceLogger().stream());
 
+#if !defined(_WIN32)
+    /**
+     * Stores up to "maxFrames" return addresses of the current thread's stack in "addresses",
+     * innermost first, and returns how many it stored.
+     *
+     * Does not malloc once it has been called, so it can be called from a signal handler after a
+     * first call outside of one.
+     */
+    int rawBacktrace(void** addresses, int maxFrames);
+
+    /**
+     * Returns the demangled name of the function holding "address", or if it has no symbol the
+     * name of the object holding it and the offset in that object, like "mongod+0x1F2A". Mallocs.
+     */
+    std::string getStackFrameName(void* address);
+
+    /**
+     * Returns the address at which the function holding "address" starts, or NULL if unknown.
+     */
+    void* getStackFrameFunction(void* address);
+#endif
+
 #if defined(_WIN32)
     // Print stack trace (using a specified stack context) to "os", default to the log stream.
     void printWindowsStackTrace(CONTEXT &context, std::ostream &os=getStackTraceLogger().stream());
@@ -32,6 +32,7 @@
 #include "mongo/util/stacktrace.h"
 
 #include <cstdlib>
+#include <cxxabi.h>
 #include <dlfcn.h>
 #include <iostream>
 #include <string>
@@ -42,6 +43,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/version.h"
 
 #if defined(MONGO_CONFIG_HAVE_EXECINFO_BACKTRACE)
@@ -134,6 +136,10 @@ namespace {
         os << "This platform does not support printing stacktraces" << std::endl;
     }
 
+    int rawBacktrace(void** addresses, int maxFrames) {
+        return 0;
+    }
+
 #else
     /**
      * Prints a stack backtrace for the current thread to the specified ostream.
@@ -240,8 +246,41 @@ namespace {
         os << "-----  END BACKTRACE  -----" << std::endl;
     }
 
+
+    int rawBacktrace(void** addresses, int maxFrames) {
+        return backtrace(addresses, maxFrames);
+    }
+
 #endif
 
+    std::string getStackFrameName(void* address) {
+        Dl_info dlinfo;
+        if (!dladdr(address, &dlinfo) || !dlinfo.dli_fbase) {
+            return "???";
+        }
+        if (dlinfo.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(dlinfo.dli_sname, NULL, NULL, &status);
+            if (status == 0 && demangled) {
+                std::string name(demangled);
+                free(demangled);
+                return name;
+            }
+            return dlinfo.dli_sname;
+        }
+        const uintptr_t offset = uintptr_t(address) - uintptr_t(dlinfo.dli_fbase);
+        return str::stream() << getBaseName(dlinfo.dli_fname) << "+0x"
+                             << integerToHex(offset);
+    }
+
+    void* getStackFrameFunction(void* address) {
+        Dl_info dlinfo;
+        if (!dladdr(address, &dlinfo)) {
+            return NULL;
+        }
+        return dlinfo.dli_saddr;
+    }
+
 namespace {
 
     void addOSComponentsToSoMap(BSONObjBuilder* soMap);
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/base/string_data.h"
+#include "mongo/util/flat_fast_key_table.h"
 #include "mongo/util/unordered_fast_key_table.h"
 
 namespace mongo {
@@ -63,5 +64,19 @@ namespace mongo {
                                                     StringMapDefaultConvertor,
                                                     StringMapDefaultConvertorOther > {
     };
+
+    /**
+     * A StringMap backed by a FlatFastKeyTable, for maps which are looked up much more often
+     * than they are changed.
+     */
+    template< typename V >
+    class FlatStringMap : public FlatFastKeyTable< StringData, // K_L
+                                                   std::string, // K_S
+                                                   V,           // V
+                                                   StringMapDefaultHash,
+                                                   StringMapDefaultEqual,
+                                                   StringMapDefaultConvertor,
+                                                   StringMapDefaultConvertorOther > {
+    };
 }
 
@@ -205,4 +205,179 @@ namespace {
         y = m;
         ASSERT_EQUALS( 5, y["eliot"] );
     }
+
+    TEST( FlatStringMapTest, Basic1 ) {
+        FlatStringMap<int> m;
+        ASSERT_EQUALS( 0U, m.size() );
+        ASSERT_EQUALS( true, m.empty() );
+        m["eliot"] = 5;
+        ASSERT_EQUALS( 5, m["eliot"] );
+        ASSERT_EQUALS( 1U, m.size() );
+        ASSERT_EQUALS( false, m.empty() );
+    }
+
+    TEST( FlatStringMapTest, Big1 ) {
+        FlatStringMap<int> m;
+        char buf[64];
+
+        for ( int i=0; i<10000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+        }
+        ASSERT_EQUALS( 10000U, m.size() );
+
+        for ( int i=0; i<10000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            ASSERT_EQUALS( m[buf], i );
+        }
+        ASSERT_EQUALS( 10000U, m.size() );
+        ASSERT_TRUE( m.end() == m.find( "foo10000" ) );
+    }
+
+    TEST( FlatStringMapTest, Find1 ) {
+        FlatStringMap<int> m;
+
+        ASSERT_TRUE( m.end() == m.find( "foo" ) );
+
+        m["foo"] = 5;
+        FlatStringMap<int>::const_iterator i = m.find( "foo" );
+        ASSERT_TRUE( i != m.end() );
+        ASSERT_EQUALS( 5, i->second );
+        ASSERT_EQUALS( "foo", i->first );
+        ++i;
+        ASSERT_TRUE( i == m.end() );
+    }
+
+    TEST( FlatStringMapTest, Erase1 ) {
+        FlatStringMap<int> m;
+        char buf[64];
+
+        m["eliot"] = 5;
+        ASSERT_EQUALS( 1U, m.erase( "eliot" ) );
+        ASSERT( m.end() == m.find( "eliot" ) );
+        ASSERT_EQUALS( 0U, m.size() );
+        ASSERT_EQUALS( 0, m["eliot"] );
+        ASSERT_EQUALS( 1U, m.size() );
+        ASSERT_EQUALS( 1U, m.erase( "eliot" ) );
+        ASSERT_EQUALS( 0U, m.erase( "eliot" ) );
+
+        size_t before = m.capacity();
+        for ( int i = 0; i < 10000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+            ASSERT_EQUALS( i, m[buf] );
+            ASSERT_EQUALS( 1U, m.erase( buf ) );
+            ASSERT( m.end() == m.find( buf ) );
+        }
+        ASSERT_EQUALS( before, m.capacity() );
+    }
+
+    TEST( FlatStringMapTest, Erase2 ) {
+        FlatStringMap<int> m;
+        m["eliot"] = 5;
+        FlatStringMap<int>::const_iterator i = m.find( "eliot" );
+        ASSERT_EQUALS( 5, i->second );
+        m.erase( i );
+        ASSERT_EQUALS( 0U, m.size() );
+        ASSERT_EQUALS( true, m.empty() );
+        ASSERT( m.begin() == m.end() );
+    }
+
+    TEST( FlatStringMapTest, EraseWhileIterating ) {
+        FlatStringMap<int> m;
+        char buf[64];
+        for ( int i = 0; i < 100; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+        }
+
+        int sum = 0;
+        for ( FlatStringMap<int>::const_iterator i = m.begin(); i != m.end(); ++i ) {
+            sum += i->second;
+            if ( i->second % 2 )
+                m.erase( i );
+        }
+        ASSERT_EQUALS( 4950, sum );
+        ASSERT_EQUALS( 50U, m.size() );
+        for ( FlatStringMap<int>::const_iterator i = m.begin(); i != m.end(); ++i ) {
+            ASSERT_EQUALS( 0, i->second % 2 );
+        }
+    }
+
+    TEST( FlatStringMapTest, Iterator1 ) {
+        FlatStringMap<int> m;
+        ASSERT( m.begin() == m.end() );
+
+        m["eliot"] = 5;
+        m["bob"] = 6;
+        int sum = 0;
+        for ( FlatStringMap<int>::const_iterator i = m.begin(); i != m.end(); ++i ) {
+            sum += i->second;
+        }
+        ASSERT_EQUALS( 11, sum );
+    }
+
+    TEST( FlatStringMapTest, Copy1 ) {
+        FlatStringMap<int> m;
+        m["eliot"] = 5;
+        FlatStringMap<int> y = m;
+        ASSERT_EQUALS( 5, y["eliot"] );
+
+        m["eliot"] = 6;
+        ASSERT_EQUALS( 6, m["eliot"] );
+        ASSERT_EQUALS( 5, y["eliot"] );
+    }
+
+    TEST( FlatStringMapTest, Assign ) {
+        FlatStringMap<int> m;
+        m["eliot"] = 5;
+
+        FlatStringMap<int> y;
+        y["eliot"] = 6;
+        y["bob"] = 7;
+
+        y = m;
+        ASSERT_EQUALS( 1U, y.size() );
+        ASSERT_EQUALS( 5, y["eliot"] );
+        ASSERT( y.end() == y.find( "bob" ) );
+    }
+
+    // Mixes inserts, lookups and erasures over a small key space, so that slots are reused and
+    // the table is rehashed both in place and to a larger size, and checks every step against
+    // unordered_map.
+    TEST( FlatStringMapTest, MatchesUnorderedMap ) {
+        FlatStringMap<int> m;
+        unordered_map<std::string, int> expected;
+        PseudoRandom rand( 1234 );
+        char buf[64];
+
+        for ( int i = 0; i < 100000; i++ ) {
+            sprintf( buf, "key%d", rand.nextInt32( i < 50000 ? 500 : 5000 ) );
+            switch ( rand.nextInt32( 3 ) ) {
+            case 0:
+                m[buf] = i;
+                expected[buf] = i;
+                break;
+            case 1:
+                ASSERT_EQUALS( expected.erase( buf ), m.erase( buf ) );
+                break;
+            default: {
+                FlatStringMap<int>::const_iterator it = m.find( buf );
+                unordered_map<std::string, int>::const_iterator e = expected.find( buf );
+                ASSERT_EQUALS( e == expected.end(), it == m.end() );
+                if ( e != expected.end() )
+                    ASSERT_EQUALS( e->second, it->second );
+                break;
+            }
+            }
+            ASSERT_EQUALS( expected.size(), m.size() );
+        }
+
+        size_t count = 0;
+        for ( FlatStringMap<int>::const_iterator i = m.begin(); i != m.end(); ++i ) {
+            ASSERT_EQUALS( expected[i->first], i->second );
+            count++;
+        }
+        ASSERT_EQUALS( expected.size(), count );
+    }
 }